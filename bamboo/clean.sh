@@ -18,6 +18,11 @@ rm -rf ${LBANN_DIR}/bamboo/integration_tests/__pycache__
 rm -f ${LBANN_DIR}/bamboo/integration_tests/*.tfevents.*
 rm -rf ${LBANN_DIR}/bamboo/integration_tests/experiments/*
 
+# Performance Tests
+rm -f ${LBANN_DIR}/bamboo/performance_tests/*.pyc
+rm -rf ${LBANN_DIR}/bamboo/performance_tests/__pycache__
+rm -rf ${LBANN_DIR}/bamboo/performance_tests/experiments/*
+
 # Unit Tests
 rm -rf ${LBANN_DIR}/bamboo/unit_tests/ckpt*
 rm -rf ${LBANN_DIR}/bamboo/unit_tests/lbann2_*
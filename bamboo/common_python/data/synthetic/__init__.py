@@ -0,0 +1,35 @@
+def make_data_reader(lbann,
+                     num_samples,
+                     sample_dims,
+                     num_labels=0,
+                     response_dims=None):
+    """Make Protobuf message for a synthetic training data reader.
+
+    Samples are random values generated on the fly, so no data set
+    needs to be staged and I/O costs are negligible.
+
+    Args:
+        lbann (module): Module for LBANN Python frontend
+        num_samples (int): Samples per epoch.
+        sample_dims (iterable of int): Dimensions of one sample.
+        num_labels (int, optional): Number of classification labels
+            (default: 0, i.e. no labels).
+        response_dims (iterable of int, optional): Dimensions of
+            regression responses (default: no responses).
+
+    """
+    message = lbann.reader_pb2.DataReader()
+    reader = message.reader.add()
+    reader.name = 'synthetic'
+    reader.role = 'train'
+    reader.shuffle = False
+    reader.num_samples = num_samples
+    reader.synth_dimensions = ' '.join(str(d) for d in sample_dims)
+    if num_labels:
+        reader.num_labels = num_labels
+    if response_dims:
+        reader.synth_response_dimensions = ' '.join(str(d) for d in response_dims)
+    reader.validation_percent = 0.0
+    reader.absolute_sample_count = 0
+    reader.percent_of_data_to_use = 1.0
+    return message
@@ -0,0 +1,223 @@
+"""Utilities for end-to-end training throughput tests.
+
+A performance test trains a canonical model for a fixed number of
+steps, parses the timer and GPU memory callbacks from the LBANN log,
+and compares the results against baselines stored in a JSON file.
+
+"""
+import functools
+import json
+import os
+import os.path
+import re
+import socket
+
+import pytest
+
+import tools
+
+# GPUs per node on the systems we benchmark
+gpus_per_node = {
+    'lassen': 4,
+    'pascal': 2,
+    'ray':    4,
+}
+
+# Number of GPUs for each test
+gpu_counts = (1, 8, 64)
+
+# Regular expressions for LBANN log output
+_float = r'([0-9.]+(?:e[+-]?[0-9]+)?)'
+_batch_time_re = re.compile(
+    r'\(instance 0\) training epoch ([0-9]+) mini-batch time statistics : '
+    + _float + 's mean')
+_breakdown_re = re.compile(
+    r'\(instance 0\) training epoch ([0-9]+) step time breakdown : '
+    + _float + 's forward prop, '
+    + _float + 's backward prop, '
+    + _float + 's other')
+_memory_re = re.compile(
+    r'GPU memory usage statistics : .* ' + _float + ' GiB max')
+
+def parse_log(log_file, epoch):
+    """Parse throughput, step time breakdown and memory from a log.
+
+    Args:
+        log_file (str): LBANN stdout log.
+        epoch (int): Training epoch to report. Earlier epochs are
+            treated as warm-up.
+
+    Returns:
+        dict: Mean mini-batch time, step time breakdown and peak GPU
+            memory. Missing measurements are omitted.
+
+    """
+    results = {}
+    with open(log_file) as f:
+        for line in f:
+            match = _batch_time_re.search(line)
+            if match and int(match.group(1)) == epoch:
+                results['mini_batch_time'] = float(match.group(2))
+            match = _breakdown_re.search(line)
+            if match and int(match.group(1)) == epoch:
+                results['forward_prop_time'] = float(match.group(2))
+                results['backward_prop_time'] = float(match.group(3))
+                results['other_time'] = float(match.group(4))
+            match = _memory_re.search(line)
+            if match:
+                results['peak_gpu_memory_gib'] = max(
+                    float(match.group(1)),
+                    results.get('peak_gpu_memory_gib', 0.0))
+    return results
+
+def load_baselines(baseline_file):
+    with open(baseline_file) as f:
+        return json.load(f)
+
+def save_baselines(baseline_file, baselines):
+    with open(baseline_file, 'w') as f:
+        json.dump(baselines, f, indent=4, sort_keys=True)
+        f.write('\n')
+
+def check_against_baseline(results, baseline, tolerances):
+    """Assert that results have not regressed past the tolerances.
+
+    Throughput may not drop, and peak memory may not grow, by more
+    than the relative tolerance for that metric.
+
+    """
+    errors = []
+    tol = tolerances.get('samples_per_sec', 0.1)
+    if 'samples_per_sec' in baseline:
+        lower = (1 - tol) * baseline['samples_per_sec']
+        if results['samples_per_sec'] < lower:
+            errors.append('throughput {:.2f} samples/s is below {:.2f} '
+                          '(baseline {:.2f}, tolerance {:.0%})'
+                          .format(results['samples_per_sec'], lower,
+                                  baseline['samples_per_sec'], tol))
+    tol = tolerances.get('peak_gpu_memory_gib', 0.1)
+    if ('peak_gpu_memory_gib' in baseline
+        and 'peak_gpu_memory_gib' in results):
+        upper = (1 + tol) * baseline['peak_gpu_memory_gib']
+        if results['peak_gpu_memory_gib'] > upper:
+            errors.append('peak GPU memory {:.3f} GiB is above {:.3f} '
+                          '(baseline {:.3f}, tolerance {:.0%})'
+                          .format(results['peak_gpu_memory_gib'], upper,
+                                  baseline['peak_gpu_memory_gib'], tol))
+    assert not errors, '; '.join(errors)
+
+def create_tests(setup_func,
+                 test_file,
+                 mini_batch_size_per_gpu,
+                 num_steps):
+    """Create performance tests at each GPU count.
+
+    `setup_func` takes the LBANN Python module, the global mini-batch
+    size and the number of samples per epoch, and returns a
+    `(lbann.Trainer, lbann.Model, lbann.reader_pb2.DataReader,
+    lbann.Optimizer)`. The model should train for two epochs with
+    `lbann.CallbackTimer` and `lbann.CallbackGPUMemoryUsage`; the
+    first epoch is a warm-up and the second is measured.
+
+    Mini-batches are weak-scaled with the number of GPUs. Baselines
+    are stored in "baselines.json" next to `test_file`, keyed by test
+    name, cluster and GPU count. A test without a baseline is skipped
+    after reporting its measurements; run with --update-baselines to
+    record them.
+
+    Returns:
+        Iterable of function: Tests that can interact with PyTest.
+
+    """
+    test_file = os.path.realpath(test_file)
+    test_name_base = os.path.splitext(os.path.basename(test_file))[0]
+    baseline_file = os.path.join(os.path.dirname(test_file),
+                                 'baselines.json')
+    cluster = re.sub('[0-9]+', '', socket.gethostname())
+    node_gpus = gpus_per_node.get(cluster, 1)
+
+    tests = []
+    for num_gpus in gpu_counts:
+        mini_batch_size = mini_batch_size_per_gpu * num_gpus
+        num_samples = mini_batch_size * num_steps
+        name = '{}_{}gpu'.format(test_name_base, num_gpus)
+        _setup = functools.partial(setup_func,
+                                   mini_batch_size=mini_batch_size,
+                                   num_samples=num_samples)
+        for _test_func in tools.create_tests(
+                _setup,
+                test_file,
+                test_name_base=name,
+                nodes=max(num_gpus // node_gpus, 1),
+                procs_per_node=min(num_gpus, node_gpus)):
+            tests.append(_augment_test_func(_test_func,
+                                            test_name_base,
+                                            num_gpus,
+                                            mini_batch_size,
+                                            baseline_file))
+    return tests
+
+def _augment_test_func(test_func,
+                       baseline_name,
+                       num_gpus,
+                       mini_batch_size,
+                       baseline_file):
+    """Augment test function to measure and check performance.
+
+    See `augment_test_func` in the integration tests for why this is
+    defined in the local scope of another function.
+
+    """
+    test_name = test_func.__name__
+
+    def func(cluster, exes, dirname, weekly, update_baselines):
+
+        # Skip test with nightly builds and on CPU systems
+        if not weekly:
+            pytest.skip('only run {} with weekly builds'.format(test_name))
+        if cluster not in gpus_per_node:
+            pytest.skip('only run {} on GPU systems'.format(test_name))
+
+        # Run LBANN experiment
+        experiment_output = test_func(cluster, exes, dirname)
+
+        # Parse LBANN log file; epoch 0 is a warm-up
+        results = parse_log(experiment_output['stdout_log_file'], epoch=1)
+        assert 'mini_batch_time' in results, \
+            'could not find mini-batch time in log'
+        results['num_gpus'] = num_gpus
+        results['mini_batch_size'] = mini_batch_size
+        results['samples_per_sec'] = (mini_batch_size
+                                      / results['mini_batch_time'])
+        results_file = os.path.join(experiment_output['work_dir'],
+                                    'performance.json')
+        with open(results_file, 'w') as f:
+            json.dump(results, f, indent=4, sort_keys=True)
+        print('{} performance: {}'.format(test_name,
+                                          json.dumps(results, sort_keys=True)))
+
+        # Compare against baseline
+        data = load_baselines(baseline_file)
+        key = str(num_gpus)
+        if update_baselines:
+            entry = data['baselines'].setdefault(baseline_name, {})
+            entry.setdefault(cluster, {})[key] = {
+                k: results[k] for k in ('samples_per_sec',
+                                        'mini_batch_time',
+                                        'peak_gpu_memory_gib')
+                if k in results
+            }
+            save_baselines(baseline_file, data)
+            return
+        baseline = (data['baselines']
+                    .get(baseline_name, {})
+                    .get(cluster, {})
+                    .get(key))
+        if baseline is None:
+            pytest.skip('no baseline for {} on {} with {} GPUs'
+                        .format(baseline_name, cluster, num_gpus))
+        check_against_baseline(results, baseline, data['tolerances'])
+
+    # Return test function from factory function
+    func.__name__ = test_name
+    return func
@@ -0,0 +1,117 @@
+import os.path
+import sys
+
+# Local files
+current_file = os.path.realpath(__file__)
+current_dir = os.path.dirname(current_file)
+root_dir = os.path.dirname(os.path.dirname(current_dir))
+sys.path.insert(0, os.path.join(os.path.dirname(current_dir), 'common_python'))
+import performance
+import data.synthetic
+
+# ==============================================
+# Options
+# ==============================================
+
+mini_batch_size_per_gpu = 128
+num_steps = 100
+
+# JAG samples are 64x64x4 images, 15 scalars and 5 input parameters
+y_dim = 16399
+x_dim = 5
+z_dim = 20
+
+# ==============================================
+# Setup LBANN experiment
+# ==============================================
+
+def setup_experiment(lbann, mini_batch_size, num_samples):
+    """Construct LBANN experiment.
+
+    Args:
+        lbann (module): Module for LBANN Python frontend
+        mini_batch_size (int): Global mini-batch size.
+        num_samples (int): Samples per epoch.
+
+    """
+    trainer = lbann.Trainer(mini_batch_size=mini_batch_size)
+    model = construct_model(lbann)
+    data_reader = data.synthetic.make_data_reader(lbann,
+                                                  num_samples,
+                                                  (y_dim + x_dim,))
+    optimizer = lbann.Adam(learn_rate=0.0001, beta1=0.9, beta2=0.99, eps=1e-8)
+    return trainer, model, data_reader, optimizer
+
+def construct_model(lbann):
+    """Construct LBANN model.
+
+    Same layer graph as applications/physics/ICF/train_jag_wae.py.
+
+    Args:
+        lbann (module): Module for LBANN Python frontend
+
+    """
+    sys.path.insert(0, os.path.join(root_dir, 'applications', 'physics', 'ICF'))
+    import jag_models
+
+    # Layer graph
+    input_ = lbann.Input(target_mode='N/A')
+    inp_slice = lbann.Slice(input_, axis=0,
+                            slice_points=f'0 {y_dim} {y_dim + x_dim}')
+    gt_y = lbann.Identity(inp_slice)
+    gt_x = lbann.Identity(inp_slice)
+    zero = lbann.Constant(value=0.0, num_neurons='1')
+    one = lbann.Constant(value=1.0, num_neurons='1')
+    z = lbann.Gaussian(mean=0.0, stdev=1.0, neuron_dims=str(z_dim))
+    d1_real, d1_fake, d_adv, pred_y = jag_models.WAE(z_dim, y_dim)(z, gt_y)
+    d1_real_bce = lbann.SigmoidBinaryCrossEntropy([d1_real, one])
+    d1_fake_bce = lbann.SigmoidBinaryCrossEntropy([d1_fake, zero])
+    d_adv_bce = lbann.SigmoidBinaryCrossEntropy([d_adv, one])
+    img_loss = lbann.MeanSquaredError([pred_y, gt_y])
+    rec_error = lbann.L2Norm2(lbann.WeightedSum([pred_y, gt_y],
+                                                scaling_factors='1 -1'))
+    layers = list(lbann.traverse_layer_graph(input_))
+
+    # Freeze the stacked discriminator, which copies its weights from
+    # the trained one
+    weights = set()
+    src_layers = []
+    dst_layers = []
+    for l in layers:
+        if l.weights and 'disc0' in l.name and 'instance1' in l.name:
+            src_layers.append(l.name)
+        if l.weights and 'disc1' in l.name:
+            dst_layers.append(l.name)
+            for w in l.weights:
+                w.optimizer = lbann.NoOptimizer()
+        weights.update(l.weights)
+    l2_reg = lbann.L2WeightRegularization(weights=weights, scale=1e-4)
+    obj = lbann.ObjectiveFunction([d1_real_bce, d1_fake_bce,
+                                   lbann.LayerTerm(d_adv_bce, scale=0.01),
+                                   img_loss, rec_error, l2_reg])
+
+    # Objects for LBANN model
+    callbacks = [lbann.CallbackTimer(),
+                 lbann.CallbackGPUMemoryUsage(),
+                 lbann.CallbackReplaceWeights(
+                     source_layers=' '.join(src_layers),
+                     destination_layers=' '.join(dst_layers),
+                     batch_interval=2)]
+
+    # Construct model
+    return lbann.Model(2,
+                       weights=weights,
+                       layers=layers,
+                       objective_function=obj,
+                       callbacks=callbacks)
+
+# ==============================================
+# Setup PyTest
+# ==============================================
+
+# Create test functions that can interact with PyTest
+for _test_func in performance.create_tests(setup_experiment,
+                                           __file__,
+                                           mini_batch_size_per_gpu,
+                                           num_steps):
+    globals()[_test_func.__name__] = _test_func
@@ -0,0 +1,79 @@
+import os.path
+import sys
+
+# Local files
+current_file = os.path.realpath(__file__)
+current_dir = os.path.dirname(current_file)
+sys.path.insert(0, os.path.join(os.path.dirname(current_dir), 'common_python'))
+import performance
+import data.synthetic
+
+# ==============================================
+# Options
+# ==============================================
+
+mini_batch_size_per_gpu = 64
+num_steps = 50
+
+# ==============================================
+# Setup LBANN experiment
+# ==============================================
+
+def setup_experiment(lbann, mini_batch_size, num_samples):
+    """Construct LBANN experiment.
+
+    Args:
+        lbann (module): Module for LBANN Python frontend
+        mini_batch_size (int): Global mini-batch size.
+        num_samples (int): Samples per epoch.
+
+    """
+    trainer = lbann.Trainer(mini_batch_size=mini_batch_size)
+    model = construct_model(lbann)
+    data_reader = data.synthetic.make_data_reader(lbann,
+                                                  num_samples,
+                                                  (3, 224, 224),
+                                                  num_labels=1000)
+    optimizer = lbann.SGD(learn_rate=0.1, momentum=0.9)
+    return trainer, model, data_reader, optimizer
+
+def construct_model(lbann):
+    """Construct LBANN model.
+
+    Args:
+        lbann (module): Module for LBANN Python frontend
+
+    """
+
+    # TODO (tym): Figure out how to switch between LBANN builds. See
+    # GitHub Issue #1289.
+    import lbann.models
+
+    # Layer graph
+    input_ = lbann.Input()
+    images = lbann.Identity(input_)
+    labels = lbann.Identity(input_)
+    x = lbann.models.ResNet50(1000, bn_statistics_group_size=-1)(images)
+    probs = lbann.Softmax(x)
+    cross_entropy = lbann.CrossEntropy(probs, labels)
+    layers = list(lbann.traverse_layer_graph(x))
+
+    # Objects for LBANN model
+    callbacks = [lbann.CallbackTimer(), lbann.CallbackGPUMemoryUsage()]
+
+    # Construct model
+    return lbann.Model(2,
+                       layers=layers,
+                       objective_function=cross_entropy,
+                       callbacks=callbacks)
+
+# ==============================================
+# Setup PyTest
+# ==============================================
+
+# Create test functions that can interact with PyTest
+for _test_func in performance.create_tests(setup_experiment,
+                                           __file__,
+                                           mini_batch_size_per_gpu,
+                                           num_steps):
+    globals()[_test_func.__name__] = _test_func
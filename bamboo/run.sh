@@ -47,6 +47,13 @@ else
 fi
 cd ..
 
+if [ ${WEEKLY} -ne 0 ]; then
+    echo "Task: Performance Tests"
+    cd performance_tests
+    $PYTHON -m pytest -s -vv --durations=0 --weekly --junitxml=results.xml
+    cd ..
+fi
+
 echo "Task: Unit Tests"
 cd unit_tests
 OMP_NUM_THREADS=10 $PYTHON -m pytest -s -vv --durations=0 --junitxml=results.xml
@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#define CATCH_CONFIG_RUNNER
+#include <catch2/catch.hpp>
+
+// Utilities
+#include "CommBenchmark.hpp"
+#include "LayerBenchmark.hpp"
+
+#include <lbann/base.hpp>
+
+#include <fstream>
+#include <iostream>
+
+// Stand up MPI, run the selected benchmarks, then write the report.
+using namespace benchmark::utilities;
+int main(int argc, char* argv[])
+{
+  // Set up the communication domain
+  auto world_comm = lbann::initialize(argc, argv, /*seed=*/13);
+  auto& opts = settings();
+  opts.comm = world_comm.get();
+
+  // Initialize Catch2 with the benchmark options
+  Catch::Session session;
+  using namespace Catch::clara;
+  auto cli = session.cli()
+    | Opt(opts.json_file, "file")
+        ["--benchmark-json"]
+        ("write results as JSON to this file")
+    | Opt(opts.iterations, "count")
+        ["--benchmark-iterations"]
+        ("number of timed iterations per configuration")
+    | Opt(opts.warmup_iterations, "count")
+        ["--benchmark-warmup"]
+        ("number of untimed iterations per configuration")
+    | Opt(opts.max_bytes, "bytes")
+        ["--benchmark-max-bytes"]
+        ("largest message in the collective sweeps")
+    | Opt(opts.procs_per_trainer, "count")
+        ["--procs-per-trainer"]
+        ("split the world into trainers of this size");
+  session.cli(cli);
+
+  // Parse the command line
+  int return_code = session.applyCommandLine(argc, argv);
+  if (return_code != 0) // Indicates a command line error
+    return return_code;
+
+  // Split the world so the trainer and intertrainer communicators differ
+  if (opts.procs_per_trainer > 0) {
+    world_comm->split_trainers(opts.procs_per_trainer);
+  }
+
+  // Run the benchmarks
+  int num_failed = session.run();
+
+  // Suggest a hierarchical allreduce threshold from the sweeps
+  if (world_comm->am_world_master()) {
+    for (auto const& r : recorded_comm_results()) {
+      if (r.operation == to_string(collective::hierarchical_allreduce)
+          && r.communicator == to_string(communicator::world)
+          && r.data_type == "float" && r.device == "CPU") {
+        std::cout << "suggested --hierarchical_allreduce_min_bytes="
+                  << suggest_hierarchical_min_bytes("world", "float", "CPU")
+                  << std::endl;
+        break;
+      }
+    }
+  }
+
+  // Only one rank writes the report
+  if (!opts.json_file.empty() && world_comm->am_world_master()) {
+    std::ofstream ofs(opts.json_file);
+    if (!ofs) {
+      std::cerr << "failed to open " << opts.json_file << " for writing"
+                << std::endl;
+      ++num_failed;
+    }
+    else {
+      write_json(ofs);
+    }
+  }
+
+  // Shut down the communication domain
+  opts.comm = nullptr;
+  world_comm.reset(); // Force MPI_Finalize, et al, before return.
+
+  return num_failed;
+}
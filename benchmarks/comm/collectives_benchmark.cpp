@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <catch2/catch.hpp>
+
+#include "CommBenchmark.hpp"
+
+using namespace benchmark::utilities;
+
+namespace {
+
+// Run a sweep and check every result it recorded
+void run_and_check(collective op, communicator which)
+{
+  const auto first = recorded_comm_results().size();
+  CHECK_NOTHROW(run_all(op, which));
+  auto const& results = recorded_comm_results();
+  for (size_t i = first; i < results.size(); ++i) {
+    INFO(results[i].operation << " on " << results[i].communicator
+         << " with " << results[i].bytes << " bytes");
+    CHECK(results[i].valid);
+  }
+}
+
+} // namespace
+
+TEST_CASE("Allreduce", "[benchmark][comm][allreduce]")
+{
+  const auto which = GENERATE(communicator::trainer,
+                              communicator::intertrainer,
+                              communicator::world);
+  run_and_check(collective::allreduce, which);
+}
+
+TEST_CASE("Hierarchical allreduce", "[benchmark][comm][allreduce]")
+{
+  const auto which = GENERATE(communicator::trainer,
+                              communicator::intertrainer,
+                              communicator::world);
+  run_and_check(collective::hierarchical_allreduce, which);
+}
+
+TEST_CASE("Non-blocking allreduce", "[benchmark][comm][allreduce]")
+{
+  const auto which = GENERATE(communicator::trainer,
+                              communicator::intertrainer,
+                              communicator::world);
+  run_and_check(collective::nb_allreduce, which);
+}
+
+TEST_CASE("MPI allreduce", "[benchmark][comm][allreduce][mpi]")
+{
+  const auto which = GENERATE(communicator::trainer,
+                              communicator::intertrainer,
+                              communicator::world);
+  run_and_check(collective::mpi_allreduce, which);
+}
+
+TEST_CASE("Broadcast", "[benchmark][comm][broadcast]")
+{
+  const auto which = GENERATE(communicator::trainer,
+                              communicator::intertrainer,
+                              communicator::world);
+  run_and_check(collective::broadcast, which);
+}
+
+TEST_CASE("All-gather", "[benchmark][comm][all_gather]")
+{
+  const auto which = GENERATE(communicator::trainer,
+                              communicator::intertrainer,
+                              communicator::world);
+  run_and_check(collective::all_gather, which);
+}
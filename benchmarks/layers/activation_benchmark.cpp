@@ -0,0 +1,55 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <catch2/catch.hpp>
+
+#include "LayerBenchmark.hpp"
+
+using namespace benchmark::utilities;
+
+TEST_CASE("ReLU layer", "[benchmark][layer][relu]")
+{
+  const auto mini_batch_size = GENERATE(32, 256);
+  const auto sample_size = GENERATE(4096, 1 << 18);
+  const double n = double(mini_batch_size) * sample_size;
+
+  layer_config config;
+  config.name = "relu/mb" + std::to_string(mini_batch_size)
+    + "/" + std::to_string(sample_size);
+  config.layer.mutable_relu();
+  config.input_dims = {sample_size};
+  config.mini_batch_size = mini_batch_size;
+
+  // Entry-wise and memory-bound; back prop reads the input and the
+  // output gradient
+  config.fp_flops = n;
+  config.bp_flops = n;
+  config.fp_entries = 2*n;
+  config.bp_entries = 3*n;
+
+  CHECK_NOTHROW(run_all(config));
+}
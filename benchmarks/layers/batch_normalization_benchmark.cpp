@@ -0,0 +1,65 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <catch2/catch.hpp>
+
+#include "LayerBenchmark.hpp"
+
+#include <utility>
+
+using namespace benchmark::utilities;
+
+TEST_CASE("Batch normalization layer",
+          "[benchmark][layer][batch_normalization]")
+{
+  const auto mini_batch_size = GENERATE(32, 128);
+  // (channels, spatial size)
+  const auto shape = GENERATE(std::make_pair(64, 56),
+                              std::make_pair(512, 7));
+  const int channels = shape.first;
+  const int size = shape.second;
+  const double n = double(mini_batch_size) * channels * size * size;
+
+  layer_config config;
+  config.name = "batch_normalization/mb" + std::to_string(mini_batch_size)
+    + "/" + std::to_string(channels) + "x" + std::to_string(size)
+    + "x" + std::to_string(size);
+  auto* params = config.layer.mutable_batch_normalization();
+  params->set_decay(0.9);
+  params->set_epsilon(1e-5);
+  config.input_dims = {channels, size, size};
+  config.mini_batch_size = mini_batch_size;
+
+  // Statistics pass then normalization pass over the input; back prop
+  // reduces two gradient terms before writing the input gradient
+  config.fp_flops = 6*n;
+  config.bp_flops = 10*n;
+  config.fp_entries = 3*n;
+  config.bp_entries = 5*n;
+
+  CHECK_NOTHROW(run_all(config));
+}
@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <catch2/catch.hpp>
+
+#include "LayerBenchmark.hpp"
+
+#include <tuple>
+
+using namespace benchmark::utilities;
+
+TEST_CASE("Convolution layer", "[benchmark][layer][convolution]")
+{
+  const auto mini_batch_size = GENERATE(32, 128);
+  const auto kernel_size = GENERATE(1, 3);
+  // (channels, spatial size, output channels)
+  const auto shape = GENERATE(std::make_tuple(64, 56, 64),
+                              std::make_tuple(256, 14, 256));
+  const int channels = std::get<0>(shape);
+  const int size = std::get<1>(shape);
+  const int filters = std::get<2>(shape);
+  const double n = mini_batch_size;
+  const double c = channels;
+  const double hw = size * size;
+  const double f = filters;
+  const double k2 = kernel_size * kernel_size;
+
+  layer_config config;
+  config.name = "convolution/mb" + std::to_string(mini_batch_size)
+    + "/" + std::to_string(channels) + "x" + std::to_string(size)
+    + "x" + std::to_string(size) + "/k" + std::to_string(kernel_size)
+    + "/f" + std::to_string(filters);
+  auto* params = config.layer.mutable_convolution();
+  params->set_num_dims(2);
+  params->set_num_output_channels(filters);
+  params->set_conv_dims_i(kernel_size);
+  params->set_conv_pads_i(kernel_size / 2);
+  params->set_conv_strides_i(1);
+  params->set_has_bias(true);
+  config.input_dims = {channels, size, size};
+  config.mini_batch_size = mini_batch_size;
+
+  // Direct convolution count; back prop computes both the data and
+  // filter gradients
+  config.fp_flops = 2*n*f*hw*c*k2;
+  config.bp_flops = 4*n*f*hw*c*k2;
+  config.fp_entries = n*c*hw + f*c*k2 + n*f*hw;
+  config.bp_entries = 2*n*f*hw + 2*n*c*hw + 2*f*c*k2;
+
+  CHECK_NOTHROW(run_all(config));
+}
@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <catch2/catch.hpp>
+
+#include "LayerBenchmark.hpp"
+
+#include <utility>
+
+using namespace benchmark::utilities;
+
+TEST_CASE("Fully-connected layer", "[benchmark][layer][fully_connected]")
+{
+  const auto mini_batch_size = GENERATE(32, 256);
+  const auto shape = GENERATE(std::make_pair(1024, 1024),
+                              std::make_pair(4096, 1024),
+                              std::make_pair(4096, 4096));
+  const double n = mini_batch_size;
+  const double in = shape.first;
+  const double out = shape.second;
+
+  layer_config config;
+  config.name = "fully_connected/mb" + std::to_string(mini_batch_size)
+    + "/" + std::to_string(shape.first) + "x" + std::to_string(shape.second);
+  auto* params = config.layer.mutable_fully_connected();
+  params->set_num_neurons(shape.second);
+  params->set_has_bias(true);
+  config.input_dims = {shape.first};
+  config.mini_batch_size = mini_batch_size;
+
+  // GEMM plus bias; back prop is one GEMM for each of the input and
+  // weight gradients plus the bias reduction
+  config.fp_flops = 2*n*in*out + n*out;
+  config.bp_flops = 4*n*in*out + n*out;
+  config.fp_entries = n*in + in*out + n*out;
+  config.bp_entries = 2*n*out + 2*n*in + 2*in*out;
+
+  CHECK_NOTHROW(run_all(config));
+}
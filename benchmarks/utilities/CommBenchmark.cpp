@@ -0,0 +1,216 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "CommBenchmark.hpp"
+
+#include <lbann/utils/exception.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+namespace benchmark {
+namespace utilities {
+namespace {
+
+std::vector<comm_result> comm_results_;
+
+/** Types and devices with both allreduce algorithms measured. */
+struct allreduce_group
+{
+  std::string communicator;
+  std::string data_type;
+  std::string device;
+};
+
+std::vector<allreduce_group> allreduce_groups()
+{
+  std::vector<allreduce_group> groups;
+  for (auto const& r : comm_results_) {
+    if (r.operation != to_string(collective::hierarchical_allreduce)) {
+      continue;
+    }
+    bool found = false;
+    for (auto const& g : groups) {
+      found = found || (g.communicator == r.communicator
+                        && g.data_type == r.data_type
+                        && g.device == r.device);
+    }
+    if (!found) {
+      groups.push_back({r.communicator, r.data_type, r.device});
+    }
+  }
+  return groups;
+}
+
+} // namespace
+
+std::string to_string(collective op)
+{
+  switch (op) {
+  case collective::allreduce: return "allreduce";
+  case collective::hierarchical_allreduce: return "hierarchical_allreduce";
+  case collective::nb_allreduce: return "nb_allreduce";
+  case collective::mpi_allreduce: return "mpi_allreduce";
+  case collective::broadcast: return "broadcast";
+  case collective::all_gather: return "all_gather";
+  }
+  return "unknown";
+}
+
+std::string to_string(communicator c)
+{
+  switch (c) {
+  case communicator::trainer: return "trainer";
+  case communicator::intertrainer: return "intertrainer";
+  case communicator::world: return "world";
+  }
+  return "unknown";
+}
+
+El::mpi::Comm const& get_comm(lbann::lbann_comm& comm, communicator c)
+{
+  switch (c) {
+  case communicator::trainer: return comm.get_trainer_comm();
+  case communicator::intertrainer: return comm.get_intertrainer_comm();
+  case communicator::world: return comm.get_world_comm();
+  }
+  LBANN_ERROR("invalid communicator");
+}
+
+double bus_bandwidth_factor(collective op, int num_procs)
+{
+  const double n = num_procs;
+  switch (op) {
+  case collective::allreduce:
+  case collective::hierarchical_allreduce:
+  case collective::nb_allreduce:
+  case collective::mpi_allreduce:
+    return 2 * (n - 1) / n;
+  case collective::all_gather:
+    return (n - 1) / n;
+  case collective::broadcast:
+    return 1.0;
+  }
+  return 1.0;
+}
+
+void record(comm_result result)
+{
+  if (settings().comm->am_world_master()) {
+    std::cout << std::left << std::setw(24) << result.operation
+              << std::setw(14) << result.communicator
+              << std::setw(8) << result.data_type
+              << std::setw(5) << result.device
+              << std::right << std::setw(6) << result.num_procs << " procs"
+              << std::setw(12) << result.bytes << " B"
+              << std::fixed << std::setprecision(3)
+              << "  p50 " << std::setw(10) << result.timing.p50 * 1e6 << " us"
+              << "  busbw " << std::setw(8) << result.timing.gbytes_per_sec
+              << " GB/s"
+              << (result.valid ? "" : "  INVALID RESULT")
+              << std::defaultfloat << std::endl;
+  }
+  comm_results_.emplace_back(std::move(result));
+}
+
+std::vector<comm_result> const& recorded_comm_results() noexcept
+{
+  return comm_results_;
+}
+
+size_t suggest_hierarchical_min_bytes(std::string const& comm_name,
+                                      std::string const& data_type,
+                                      std::string const& device)
+{
+  // Median latencies of each algorithm by size
+  std::map<size_t, double> flat, hierarchical;
+  for (auto const& r : comm_results_) {
+    if (r.communicator != comm_name || r.data_type != data_type
+        || r.device != device) {
+      continue;
+    }
+    if (r.operation == to_string(collective::allreduce)) {
+      flat[r.bytes] = r.timing.p50;
+    }
+    if (r.operation == to_string(collective::hierarchical_allreduce)) {
+      hierarchical[r.bytes] = r.timing.p50;
+    }
+  }
+
+  // Walk down from the largest size while hierarchical wins
+  size_t min_bytes = 0;
+  for (auto it = hierarchical.rbegin(); it != hierarchical.rend(); ++it) {
+    const auto flat_it = flat.find(it->first);
+    if (flat_it == flat.end() || it->second >= flat_it->second) { break; }
+    min_bytes = it->first;
+  }
+  return min_bytes;
+}
+
+void write_comm_json(std::ostream& os)
+{
+  os << "[";
+  for (size_t i = 0; i < comm_results_.size(); ++i) {
+    auto const& r = comm_results_[i];
+    auto const& t = r.timing;
+    os << (i > 0 ? "," : "") << "\n  "
+       << "{\"operation\":\"" << r.operation << "\""
+       << ",\"communicator\":\"" << r.communicator << "\""
+       << ",\"data_type\":\"" << r.data_type << "\""
+       << ",\"device\":\"" << r.device << "\""
+       << ",\"num_procs\":" << r.num_procs
+       << ",\"count\":" << r.count
+       << ",\"bytes\":" << r.bytes
+       << ",\"iterations\":" << r.iterations
+       << ",\"latency\":{\"mean\":" << t.mean
+       << ",\"min\":" << t.min
+       << ",\"p50\":" << t.p50
+       << ",\"p90\":" << t.p90
+       << ",\"p99\":" << t.p99
+       << ",\"max\":" << t.max << "}"
+       << ",\"algorithm_gbytes_per_sec\":" << r.algorithm_gbytes_per_sec
+       << ",\"bus_gbytes_per_sec\":" << t.gbytes_per_sec
+       << ",\"valid\":" << (r.valid ? "true" : "false") << "}";
+  }
+  os << "\n],\"hierarchical_allreduce_min_bytes\":[";
+  const auto groups = allreduce_groups();
+  for (size_t i = 0; i < groups.size(); ++i) {
+    auto const& g = groups[i];
+    os << (i > 0 ? "," : "") << "\n  "
+       << "{\"communicator\":\"" << g.communicator << "\""
+       << ",\"data_type\":\"" << g.data_type << "\""
+       << ",\"device\":\"" << g.device << "\""
+       << ",\"min_bytes\":"
+       << suggest_hierarchical_min_bytes(g.communicator, g.data_type, g.device)
+       << "}";
+  }
+  os << "\n]";
+}
+
+} // namespace utilities
+} // namespace benchmark
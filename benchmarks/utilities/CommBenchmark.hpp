@@ -0,0 +1,240 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_BENCHMARKS_COMM_BENCHMARK_HPP_
+#define LBANN_BENCHMARKS_COMM_BENCHMARK_HPP_
+
+#include "LayerBenchmark.hpp"
+
+#include <lbann/comm.hpp>
+#include <lbann/utils/timer.hpp>
+#include <lbann/utils/typename.hpp>
+
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace benchmark {
+namespace utilities {
+
+/** @brief Collective operations that can be benchmarked. */
+enum class collective {
+  /** lbann_comm matrix allreduce with the flat algorithm. */
+  allreduce,
+  /** lbann_comm matrix allreduce with the hierarchical algorithm. */
+  hierarchical_allreduce,
+  /** lbann_comm non-blocking matrix allreduce and wait. */
+  nb_allreduce,
+  /** MPI_Allreduce on host memory, bypassing Aluminum. */
+  mpi_allreduce,
+  broadcast,
+  all_gather
+};
+
+/** @brief Communicators of an lbann_comm. */
+enum class communicator { trainer, intertrainer, world };
+
+std::string to_string(collective op);
+std::string to_string(communicator c);
+
+/** @brief Outcome of benchmarking one collective at one size. */
+struct comm_result
+{
+  std::string operation;
+  std::string communicator;
+  std::string data_type;
+  std::string device;
+  int num_procs = 0;
+  /** Entries on each process. */
+  size_t count = 0;
+  /** Bytes of the message, e.g. the whole gathered buffer. */
+  size_t bytes = 0;
+  size_t iterations = 0;
+  /** Latency of the slowest process; gbytes_per_sec is the bus
+   *  bandwidth. */
+  timing_summary timing;
+  /** Bytes over the median latency. */
+  double algorithm_gbytes_per_sec = 0.0;
+  /** Whether the results had the expected values. */
+  bool valid = true;
+};
+
+/** @brief Store a result for the JSON report and print it on the
+ *  world master. */
+void record(comm_result result);
+
+/** @brief Results recorded so far in this session. */
+std::vector<comm_result> const& recorded_comm_results() noexcept;
+
+/** @brief Write recorded collective results as a JSON array, with the
+ *  suggested hierarchical allreduce thresholds. */
+void write_comm_json(std::ostream& os);
+
+/** @brief Smallest message size at which the hierarchical allreduce
+ *  beat the flat one at that size and all larger sizes.
+ *
+ *  Suitable for @c --hierarchical_allreduce_min_bytes. Zero if the
+ *  hierarchical allreduce was never faster or not measured.
+ */
+size_t suggest_hierarchical_min_bytes(std::string const& comm_name,
+                                      std::string const& data_type,
+                                      std::string const& device);
+
+/** @brief Get one of the communicators of an lbann_comm. */
+El::mpi::Comm const& get_comm(lbann::lbann_comm& comm, communicator c);
+
+/** @brief Ratio of bus bandwidth to algorithm bandwidth.
+ *
+ *  Accounts for the data each link must carry, as in nccl-tests, so
+ *  results are comparable across process counts.
+ */
+double bus_bandwidth_factor(collective op, int num_procs);
+
+/** @brief Time one collective over a sweep of message sizes.
+ *
+ *  Message sizes are powers of four from 4 entries up to the
+ *  session's maximum. Inputs are reset before every iteration, so
+ *  the results can be checked. Each iteration's latency is the
+ *  maximum over the processes.
+ */
+template <typename T, El::Device Dev>
+void run_comm_benchmark(collective op, communicator which)
+{
+  using namespace lbann;
+  const auto& opts = settings();
+  auto& comm = *opts.comm;
+  const auto& c = get_comm(comm, which);
+  const int num_procs = El::mpi::Size(c);
+  const int rank = El::mpi::Rank(c);
+  if (num_procs < 2) { return; }
+  if (op == collective::mpi_allreduce && Dev != El::Device::CPU) { return; }
+
+  const auto old_algorithm = comm.get_allreduce_algorithm();
+  if (op == collective::hierarchical_allreduce) {
+    comm.set_allreduce_algorithm(allreduce_algorithm::hierarchical, 0);
+  }
+  else {
+    comm.set_allreduce_algorithm(allreduce_algorithm::flat);
+  }
+
+  for (size_t count = 4; count * sizeof(T) <= opts.max_bytes; count *= 4) {
+    const bool gather = (op == collective::all_gather);
+    El::Matrix<T, Dev> data(count, 1);
+    El::Matrix<T, Dev> gathered(gather ? count * num_procs : 1, 1);
+    const auto sync_info = El::SyncInfoFromMatrix(data);
+
+    std::vector<double> times;
+    times.reserve(opts.iterations);
+    const size_t total = opts.warmup_iterations + opts.iterations;
+    for (size_t i = 0; i < total; ++i) {
+      El::Fill(data, T(rank + 1));
+      synchronize<Dev>();
+      comm.barrier(c);
+      const auto start = get_time();
+      switch (op) {
+      case collective::allreduce:
+      case collective::hierarchical_allreduce:
+        comm.allreduce(static_cast<El::AbstractMatrix<T>&>(data), c);
+        break;
+      case collective::nb_allreduce:
+        {
+          Al::request req;
+          comm.nb_allreduce(static_cast<El::AbstractMatrix<T>&>(data), c, req);
+          comm.wait(req);
+        }
+        break;
+      case collective::mpi_allreduce:
+        MPI_Allreduce(MPI_IN_PLACE, data.Buffer(), count,
+                      std::is_same<T, double>::value ? MPI_DOUBLE : MPI_FLOAT,
+                      MPI_SUM, c.GetMPIComm());
+        break;
+      case collective::broadcast:
+        comm.broadcast(0, data.Buffer(), count, c, sync_info);
+        break;
+      case collective::all_gather:
+        comm.all_gather(data.LockedBuffer(), count,
+                        gathered.Buffer(), count, c, sync_info);
+        break;
+      }
+      synchronize<Dev>();
+      const auto time = get_time() - start;
+      if (i >= opts.warmup_iterations) { times.push_back(time); }
+    }
+    comm.allreduce(times.data(), times.size(), c, El::mpi::MAX);
+
+    // Check the last entry of the result
+    T expected = T(num_procs * (num_procs + 1) / 2);
+    El::Int check_row = count - 1;
+    const El::Matrix<T, Dev>* result = &data;
+    if (op == collective::broadcast) { expected = T(1); }
+    if (op == collective::all_gather) {
+      expected = T(num_procs);
+      check_row = count * num_procs - 1;
+      result = &gathered;
+    }
+    El::Matrix<T, El::Device::CPU> host;
+    El::Copy(*result, host);
+    const int valid = comm.allreduce(host(check_row, 0) == expected ? 1 : 0,
+                                     c, El::mpi::MIN);
+
+    comm_result r;
+    r.operation = to_string(op);
+    r.communicator = to_string(which);
+    r.data_type = TypeName<T>();
+    r.device = (Dev == El::Device::CPU ? "CPU" : "GPU");
+    r.num_procs = num_procs;
+    r.count = count;
+    r.bytes = count * sizeof(T) * (gather ? num_procs : 1);
+    r.iterations = opts.iterations;
+    r.timing = summarize(std::move(times), 0.0,
+                         r.bytes * bus_bandwidth_factor(op, num_procs));
+    if (r.timing.p50 > 0.0) {
+      r.algorithm_gbytes_per_sec = r.bytes / r.timing.p50 / 1e9;
+    }
+    r.valid = (valid != 0);
+    record(std::move(r));
+  }
+
+  comm.set_allreduce_algorithm(old_algorithm);
+}
+
+/** @brief Benchmark a collective with each data type and device this
+ *  build supports, recording every result.
+ */
+inline void run_all(collective op, communicator which)
+{
+  run_comm_benchmark<float, El::Device::CPU>(op, which);
+  run_comm_benchmark<double, El::Device::CPU>(op, which);
+#ifdef LBANN_HAS_GPU
+  run_comm_benchmark<float, El::Device::GPU>(op, which);
+#endif // LBANN_HAS_GPU
+}
+
+} // namespace utilities
+} // namespace benchmark
+#endif // LBANN_BENCHMARKS_COMM_BENCHMARK_HPP_
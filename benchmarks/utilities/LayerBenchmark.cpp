@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "LayerBenchmark.hpp"
+#include "CommBenchmark.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+
+namespace benchmark {
+namespace utilities {
+namespace {
+
+std::vector<benchmark_result> results_;
+
+/** Nearest-rank quantile of sorted values. */
+double quantile(std::vector<double> const& sorted, double q)
+{
+  if (sorted.empty()) { return 0.0; }
+  const size_t k = std::min(sorted.size() - 1,
+                            static_cast<size_t>(q * (sorted.size() - 1) + 0.5));
+  return sorted[k];
+}
+
+void write_dims(std::ostream& os, std::vector<int> const& dims)
+{
+  os << "[";
+  for (size_t i = 0; i < dims.size(); ++i) {
+    os << (i > 0 ? "," : "") << dims[i];
+  }
+  os << "]";
+}
+
+void write_timing(std::ostream& os, timing_summary const& t)
+{
+  os << "{\"mean\":" << t.mean
+     << ",\"min\":" << t.min
+     << ",\"p50\":" << t.p50
+     << ",\"p90\":" << t.p90
+     << ",\"p99\":" << t.p99
+     << ",\"max\":" << t.max
+     << ",\"gflops\":" << t.gflops
+     << ",\"gbytes_per_sec\":" << t.gbytes_per_sec << "}";
+}
+
+} // namespace
+
+benchmark_settings& settings() noexcept
+{
+  static benchmark_settings settings_;
+  return settings_;
+}
+
+timing_summary summarize(std::vector<double> times,
+                         double flops,
+                         double bytes)
+{
+  timing_summary t;
+  if (times.empty()) { return t; }
+  std::sort(times.begin(), times.end());
+  t.mean = std::accumulate(times.begin(), times.end(), 0.0) / times.size();
+  t.min = times.front();
+  t.max = times.back();
+  t.p50 = quantile(times, 0.5);
+  t.p90 = quantile(times, 0.9);
+  t.p99 = quantile(times, 0.99);
+  if (t.p50 > 0.0) {
+    t.gflops = flops / t.p50 / 1e9;
+    t.gbytes_per_sec = bytes / t.p50 / 1e9;
+  }
+  return t;
+}
+
+void record(benchmark_result result)
+{
+  std::cout << std::left << std::setw(32) << result.name
+            << std::setw(8) << result.data_type
+            << std::setw(5) << result.device
+            << std::right << std::fixed << std::setprecision(3)
+            << "  fp p50 " << std::setw(9) << result.fp.p50 * 1e3 << " ms"
+            << " (" << std::setw(8) << result.fp.gflops << " GFLOP/s, "
+            << std::setw(7) << result.fp.gbytes_per_sec << " GB/s)"
+            << "  bp p50 " << std::setw(9) << result.bp.p50 * 1e3 << " ms"
+            << " (" << std::setw(8) << result.bp.gflops << " GFLOP/s, "
+            << std::setw(7) << result.bp.gbytes_per_sec << " GB/s)"
+            << std::defaultfloat << std::endl;
+  results_.emplace_back(std::move(result));
+}
+
+std::vector<benchmark_result> const& recorded_results() noexcept
+{
+  return results_;
+}
+
+void write_json(std::ostream& os)
+{
+  os << "{\"benchmarks\":[";
+  for (size_t i = 0; i < results_.size(); ++i) {
+    auto const& r = results_[i];
+    os << (i > 0 ? "," : "") << "\n  "
+       << "{\"name\":\"" << r.name << "\""
+       << ",\"layer_type\":\"" << r.layer_type << "\""
+       << ",\"data_type\":\"" << r.data_type << "\""
+       << ",\"device\":\"" << r.device << "\""
+       << ",\"mini_batch_size\":" << r.mini_batch_size
+       << ",\"input_dims\":";
+    write_dims(os, r.input_dims);
+    os << ",\"output_dims\":";
+    write_dims(os, r.output_dims);
+    os << ",\"iterations\":" << r.iterations
+       << ",\"forward_prop\":";
+    write_timing(os, r.fp);
+    os << ",\"backward_prop\":";
+    write_timing(os, r.bp);
+    os << "}";
+  }
+  os << "\n],\"collectives\":";
+  write_comm_json(os);
+  os << "}" << std::endl;
+}
+
+} // namespace utilities
+} // namespace benchmark
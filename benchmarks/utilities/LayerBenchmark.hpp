@@ -0,0 +1,307 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_BENCHMARKS_LAYER_BENCHMARK_HPP_
+#define LBANN_BENCHMARKS_LAYER_BENCHMARK_HPP_
+
+#include <lbann/comm.hpp>
+#include <lbann/data_coordinator/data_coordinator_metadata.hpp>
+#include <lbann/execution_contexts/sgd_execution_context.hpp>
+#include <lbann/layers/transform/gaussian.hpp>
+#include <lbann/layers/transform/transform.hpp>
+#include <lbann/models/directed_acyclic_graph.hpp>
+#include <lbann/objective_functions/objective_function.hpp>
+#include <lbann/proto/factories.hpp>
+#include <lbann/trainers/trainer.hpp>
+#include <lbann/training_algorithms/sgd_training_algorithm.hpp>
+#include <lbann/utils/memory.hpp>
+#include <lbann/utils/random.hpp>
+#include <lbann/utils/timer.hpp>
+#include <lbann/utils/typename.hpp>
+
+#include <lbann.pb.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace benchmark {
+namespace utilities {
+
+/** @brief One point in a layer benchmark sweep. */
+struct layer_config
+{
+  /** Label for this configuration, e.g. "fc/1024x1024". */
+  std::string name;
+  /** Prototext for the layer under test. */
+  lbann_data::Layer layer;
+  /** Dimensions of one input sample. */
+  std::vector<int> input_dims;
+  /** Number of samples per mini-batch. */
+  int mini_batch_size = 64;
+  /** Floating-point operations per forward pass (0 if unknown). */
+  double fp_flops = 0.0;
+  /** Floating-point operations per backward pass (0 if unknown). */
+  double bp_flops = 0.0;
+  /** Tensor entries read or written per forward pass (0 if unknown).
+   *  Scaled by the size of the data type to get bytes. */
+  double fp_entries = 0.0;
+  /** Tensor entries read or written per backward pass (0 if unknown). */
+  double bp_entries = 0.0;
+};
+
+/** @brief Latency summary for one propagation direction. */
+struct timing_summary
+{
+  double mean = 0.0;
+  double min = 0.0;
+  double p50 = 0.0;
+  double p90 = 0.0;
+  double p99 = 0.0;
+  double max = 0.0;
+  /** Achieved rate based on the median latency. */
+  double gflops = 0.0;
+  /** Achieved bandwidth based on the median latency. */
+  double gbytes_per_sec = 0.0;
+};
+
+/** @brief Outcome of benchmarking one layer configuration. */
+struct benchmark_result
+{
+  std::string name;
+  std::string layer_type;
+  std::string data_type;
+  std::string device;
+  int mini_batch_size = 0;
+  std::vector<int> input_dims;
+  std::vector<int> output_dims;
+  size_t iterations = 0;
+  timing_summary fp;
+  timing_summary bp;
+};
+
+/** @brief Iteration counts shared by all benchmarks in a session. */
+struct benchmark_settings
+{
+  size_t warmup_iterations = 5;
+  size_t iterations = 50;
+  std::string json_file;
+  /** Largest message in the collective sweeps. */
+  size_t max_bytes = 64 << 20;
+  /** Trainer size for the collective sweeps (0: one trainer). */
+  int procs_per_trainer = 0;
+  /** World communicator, owned by main(). */
+  lbann::lbann_comm* comm = nullptr;
+};
+
+/** @brief Session-wide benchmark settings, set from the command line. */
+benchmark_settings& settings() noexcept;
+
+/** @brief Summarize latencies (in seconds) and derived rates. */
+timing_summary summarize(std::vector<double> times,
+                         double flops,
+                         double bytes);
+
+/** @brief Store a result for the JSON report and print it. */
+void record(benchmark_result result);
+
+/** @brief Results recorded so far in this session. */
+std::vector<benchmark_result> const& recorded_results() noexcept;
+
+/** @brief Write all recorded results as a JSON document. */
+void write_json(std::ostream& os);
+
+/** @brief Layer with no children that injects random error signals.
+ *
+ *  Stands in for the rest of the network so the layer under test
+ *  sees realistic, non-zero gradients during back prop.
+ */
+template <typename TensorDataType, El::Device Dev>
+class synthetic_sink_layer : public lbann::transform_layer<TensorDataType>
+{
+public:
+  synthetic_sink_layer(lbann::lbann_comm* comm)
+    : lbann::transform_layer<TensorDataType>(comm)
+  {
+    this->m_expected_num_child_layers = 0;
+  }
+  synthetic_sink_layer* copy() const override
+  {
+    return new synthetic_sink_layer(*this);
+  }
+  std::string get_type() const override { return "synthetic sink"; }
+  lbann::data_layout get_data_layout() const override
+  {
+    return lbann::data_layout::DATA_PARALLEL;
+  }
+  El::Device get_device_allocation() const override { return Dev; }
+  bool supports_cuda_graph() const override { return false; }
+
+protected:
+  void fp_compute() override {}
+  void bp_compute() override
+  {
+    auto& gradient_wrt_input = this->get_error_signals();
+    lbann::uniform_fill(gradient_wrt_input,
+                        gradient_wrt_input.Height(),
+                        gradient_wrt_input.Width(),
+                        El::TypeTraits<TensorDataType>::Zero(),
+                        El::TypeTraits<TensorDataType>::One());
+  }
+};
+
+/** @brief Wait for all work queued on the device. */
+template <El::Device Dev>
+inline void synchronize()
+{
+#ifdef LBANN_HAS_GPU
+  if (Dev == El::Device::GPU) {
+    El::GPUManager::SynchronizeDevice();
+  }
+#endif // LBANN_HAS_GPU
+}
+
+/** @brief Time forward and backward prop of a single layer.
+ *
+ *  The layer is built with @c lbann::proto::construct_layer and
+ *  placed in a three-layer model: a Gaussian source providing
+ *  synthetic activations, the layer under test, and a sink providing
+ *  synthetic error signals. Only the layer under test is timed;
+ *  weight gradients are cleared between iterations.
+ */
+template <typename TensorDataType, El::Device Dev>
+benchmark_result run_layer_benchmark(layer_config const& config)
+{
+  using namespace lbann;
+  const auto& opts = settings();
+  auto& comm = *opts.comm;
+
+  // Stand up a trainer and execution context
+  trainer t(&comm, config.mini_batch_size, {});
+  sgd_training_algorithm alg;
+  sgd_execution_context context(t, alg, &comm, execution_mode::training,
+                                config.mini_batch_size);
+  context.set_current_mini_batch_size(config.mini_batch_size);
+
+  // Plain SGD so learning layers compute weight gradients
+  auto opt_msg = make_unique<lbann_data::Optimizer>();
+  opt_msg->mutable_sgd()->set_learn_rate(0.01);
+  directed_acyclic_graph_model m(&comm, new objective_function(),
+                                 std::move(opt_msg));
+  m.set_name("benchmark");
+
+  // Source -> layer under test -> sink
+  auto source = make_unique<gaussian_layer<TensorDataType,
+                                           data_layout::DATA_PARALLEL,
+                                           Dev>>(&comm, config.input_dims);
+  auto target = proto::construct_layer<TensorDataType,
+                                       data_layout::DATA_PARALLEL,
+                                       Dev>(&comm, 0, 1, config.layer);
+  auto sink = make_unique<synthetic_sink_layer<TensorDataType, Dev>>(&comm);
+  source->set_name("source");
+  target->set_name(config.name);
+  sink->set_name("sink");
+  target->add_parent_layer(source.get());
+  sink->add_parent_layer(target.get());
+  auto* source_ptr = source.get();
+  auto* target_ptr = target.get();
+  auto* sink_ptr = sink.get();
+  m.add_layer(std::move(source));
+  m.add_layer(std::move(target));
+  m.add_layer(std::move(sink));
+
+  m.reset_mode(context, execution_mode::training);
+  DataReaderMetaData dr_metadata;
+  m.setup(config.mini_batch_size, dr_metadata);
+
+  // The source only needs to produce activations once
+  source_ptr->forward_prop();
+  synchronize<Dev>();
+
+  std::vector<double> fp_times, bp_times;
+  fp_times.reserve(opts.iterations);
+  bp_times.reserve(opts.iterations);
+  const size_t total = opts.warmup_iterations + opts.iterations;
+  for (size_t i = 0; i < total; ++i) {
+    const auto fp_start = get_time();
+    target_ptr->forward_prop();
+    synchronize<Dev>();
+    const auto fp_time = get_time() - fp_start;
+
+    sink_ptr->forward_prop();
+    sink_ptr->back_prop();
+    synchronize<Dev>();
+
+    const auto bp_start = get_time();
+    target_ptr->back_prop();
+    synchronize<Dev>();
+    const auto bp_time = get_time() - bp_start;
+
+    m.clear_gradients();
+    if (i >= opts.warmup_iterations) {
+      fp_times.push_back(fp_time);
+      bp_times.push_back(bp_time);
+    }
+  }
+
+  benchmark_result result;
+  result.name = config.name;
+  result.layer_type = target_ptr->get_type();
+  result.data_type = TypeName<TensorDataType>();
+  result.device = (Dev == El::Device::CPU ? "CPU" : "GPU");
+  result.mini_batch_size = config.mini_batch_size;
+  result.input_dims = config.input_dims;
+  result.output_dims = target_ptr->get_output_dims();
+  result.iterations = opts.iterations;
+  constexpr double entry_size = sizeof(TensorDataType);
+  result.fp = summarize(std::move(fp_times),
+                        config.fp_flops,
+                        config.fp_entries * entry_size);
+  result.bp = summarize(std::move(bp_times),
+                        config.bp_flops,
+                        config.bp_entries * entry_size);
+  return result;
+}
+
+/** @brief Benchmark a configuration with each data type and device
+ *  this build supports, recording every result.
+ */
+inline void run_all(layer_config const& config)
+{
+  record(run_layer_benchmark<float, El::Device::CPU>(config));
+  record(run_layer_benchmark<double, El::Device::CPU>(config));
+#ifdef LBANN_HAS_GPU
+  record(run_layer_benchmark<float, El::Device::GPU>(config));
+#ifdef LBANN_HAS_GPU_FP16
+  record(run_layer_benchmark<lbann::fp16, El::Device::GPU>(config));
+#endif // LBANN_HAS_GPU_FP16
+#endif // LBANN_HAS_GPU
+}
+
+} // namespace utilities
+} // namespace benchmark
+#endif // LBANN_BENCHMARKS_LAYER_BENCHMARK_HPP_
@@ -0,0 +1,40 @@
+# Sets the following variables
+#
+#   LIBURING_FOUND
+#   LIBURING_INCLUDE_PATH
+#   LIBURING_LIBRARY
+#
+# Defines the following imported target:
+#
+#   liburing::liburing
+#
+
+find_path(LIBURING_INCLUDE_PATH liburing.h
+  HINTS ${LIBURING_DIR} $ENV{LIBURING_DIR}
+  PATH_SUFFIXES include
+  DOC "The liburing include directory."
+  NO_DEFAULT_PATH)
+find_path(LIBURING_INCLUDE_PATH liburing.h)
+
+find_library(LIBURING_LIBRARY uring
+  HINTS ${LIBURING_DIR} $ENV{LIBURING_DIR}
+  PATH_SUFFIXES lib64 lib
+  DOC "The liburing library."
+  NO_DEFAULT_PATH)
+find_library(LIBURING_LIBRARY uring)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(Liburing
+  DEFAULT_MSG LIBURING_LIBRARY LIBURING_INCLUDE_PATH)
+
+if (NOT TARGET liburing::liburing)
+
+  add_library(liburing::liburing INTERFACE IMPORTED)
+
+  set_property(TARGET liburing::liburing PROPERTY
+    INTERFACE_INCLUDE_DIRECTORIES "${LIBURING_INCLUDE_PATH}")
+
+  set_property(TARGET liburing::liburing PROPERTY
+    INTERFACE_LINK_LIBRARIES "${LIBURING_LIBRARY}")
+
+endif (NOT TARGET liburing::liburing)
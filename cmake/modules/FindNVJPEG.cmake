@@ -0,0 +1,32 @@
+# Sets the following variables
+#
+#   NVJPEG_FOUND
+#   NVJPEG_LIBRARY
+#
+# Defines the following imported target:
+#
+#   cuda::nvjpeg
+#
+
+find_library(NVJPEG_LIBRARY nvjpeg
+  HINTS ${NVJPEG_DIR} $ENV{NVJPEG_DIR} ${CUDA_TOOLKIT_ROOT_DIR} ${CUDA_SDK_ROOT_DIR}
+  PATH_SUFFIXES lib64
+  DOC "The nvJPEG library."
+  NO_DEFAULT_PATH)
+find_library(NVJPEG_LIBRARY nvjpeg)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(NVJPEG
+  DEFAULT_MSG NVJPEG_LIBRARY)
+
+if (NOT TARGET cuda::nvjpeg)
+
+  add_library(cuda::nvjpeg INTERFACE IMPORTED)
+
+  set_property(TARGET cuda::nvjpeg PROPERTY
+    INTERFACE_INCLUDE_DIRECTORIES "${CUDA_INCLUDE_DIRS}")
+
+  set_property(TARGET cuda::nvjpeg PROPERTY
+    INTERFACE_LINK_LIBRARIES "${NVJPEG_LIBRARY}")
+
+endif (NOT TARGET cuda::nvjpeg)
@@ -0,0 +1,40 @@
+# Sets the following variables
+#
+#   CUFILE_FOUND
+#   CUFILE_INCLUDE_PATH
+#   CUFILE_LIBRARY
+#
+# Defines the following imported target:
+#
+#   cuda::cufile
+#
+
+find_path(CUFILE_INCLUDE_PATH cufile.h
+  HINTS ${CUFILE_DIR} $ENV{CUFILE_DIR} ${CUDA_TOOLKIT_ROOT_DIR} ${CUDA_SDK_ROOT_DIR}
+  PATH_SUFFIXES include targets/x86_64-linux/include
+  DOC "The cuFile include directory."
+  NO_DEFAULT_PATH)
+find_path(CUFILE_INCLUDE_PATH cufile.h)
+
+find_library(CUFILE_LIBRARY cufile
+  HINTS ${CUFILE_DIR} $ENV{CUFILE_DIR} ${CUDA_TOOLKIT_ROOT_DIR} ${CUDA_SDK_ROOT_DIR}
+  PATH_SUFFIXES lib64 targets/x86_64-linux/lib
+  DOC "The cuFile library."
+  NO_DEFAULT_PATH)
+find_library(CUFILE_LIBRARY cufile)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(cuFile
+  DEFAULT_MSG CUFILE_LIBRARY CUFILE_INCLUDE_PATH)
+
+if (NOT TARGET cuda::cufile)
+
+  add_library(cuda::cufile INTERFACE IMPORTED)
+
+  set_property(TARGET cuda::cufile PROPERTY
+    INTERFACE_INCLUDE_DIRECTORIES "${CUFILE_INCLUDE_PATH}")
+
+  set_property(TARGET cuda::cufile PROPERTY
+    INTERFACE_LINK_LIBRARIES "${CUFILE_LIBRARY}")
+
+endif (NOT TARGET cuda::cufile)
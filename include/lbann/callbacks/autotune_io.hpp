@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_CALLBACKS_CALLBACK_AUTOTUNE_IO_HPP_INCLUDED
+#define LBANN_CALLBACKS_CALLBACK_AUTOTUNE_IO_HPP_INCLUDED
+
+#include "lbann/callbacks/callback.hpp"
+
+namespace lbann {
+namespace callback {
+
+/** @brief Tune the number of I/O threads and the prefetch depth
+ *  during the first training steps.
+ *
+ *  Every @c interval steps, the fraction of time the model waited on
+ *  its input layers and the utilization of the I/O threads (see
+ *  @c lbann::io_profile) are reduced over the trainer, taking the
+ *  slowest process, and one setting is changed:
+ *
+ *  - While the wait fraction exceeds @c wait_threshold, an I/O
+ *    thread is added if the threads are busy. If they are not, the
+ *    fetches are not issued early enough, so the prefetch depth is
+ *    increased.
+ *  - Once the wait is negligible, I/O threads are removed as long as
+ *    the remaining threads could absorb their work. A removal that
+ *    brings the wait back is undone.
+ *
+ *  Tuning stops when no change helps or after @c max_steps steps,
+ *  and the trainer master prints the settings it chose.
+ *
+ *  The thread pool never grows past the size it had when training
+ *  started. Data readers size their per-thread state at setup. The
+ *  ring of I/O buffers is grown to @c max_prefetch_depth when the
+ *  callback is set up. Threads are replaced with
+ *  @c thread_pool::relaunch_pinned_threads after the background
+ *  fetches have been collected.
+ */
+class autotune_io : public callback_base {
+public:
+  /** @param interval Training steps measured per setting.
+   *  @param max_steps Training steps after which tuning stops.
+   *  @param max_prefetch_depth Largest prefetch depth to try.
+   *  @param wait_threshold Fraction of time waiting on data that is
+   *                        considered negligible.
+   */
+  autotune_io(size_t interval = 20,
+              size_t max_steps = 1000,
+              int max_prefetch_depth = 4,
+              double wait_threshold = 0.02)
+    : callback_base(1),
+      m_interval(interval),
+      m_max_steps(max_steps),
+      m_max_prefetch_depth(max_prefetch_depth),
+      m_wait_threshold(wait_threshold) {}
+  autotune_io(const autotune_io&) = default;
+  autotune_io& operator=(const autotune_io&) = default;
+  autotune_io* copy() const override { return new autotune_io(*this); }
+  std::string name() const override { return "autotune I/O"; }
+  void setup(model *m) override;
+  void on_train_begin(model *m) override;
+  void on_batch_end(model *m) override;
+
+private:
+
+  /** Changes made by the tuner. */
+  enum class action { none, add_thread, remove_thread, deepen_prefetch };
+
+  /** Measure the last window and change one setting. */
+  void tune(model& m);
+  /** Start measuring a window of steps. */
+  void start_window(model& m);
+  /** Fetch with a different number of I/O threads. */
+  void set_num_io_threads(model& m, int num_threads);
+
+  /** Training steps measured per setting. */
+  size_t m_interval;
+  /** Training steps after which tuning stops. */
+  size_t m_max_steps;
+  /** Largest prefetch depth to try. */
+  int m_max_prefetch_depth;
+  /** Fraction of time waiting on data that is considered negligible. */
+  double m_wait_threshold;
+
+  /** I/O threads when training started. */
+  int m_max_threads = 0;
+  /** Training steps seen while tuning. */
+  size_t m_num_steps = 0;
+  /** Whether the first window, which includes warm-up, is over. */
+  bool m_warmed_up = false;
+  /** Whether tuning has finished. */
+  bool m_done = false;
+  /** Last change made. */
+  action m_last_action = action::none;
+
+  /** Counters at the start of the current window. */
+  size_t m_window_steps = 0;
+  double m_window_start = 0.0;
+  double m_wait_start = 0.0;
+  double m_busy_start = 0.0;
+
+};
+
+// Builder function
+std::unique_ptr<callback_base>
+build_autotune_io_callback_from_pbuf(
+  const google::protobuf::Message&, std::shared_ptr<lbann_summary> const&);
+
+} // namespace callback
+} // namespace lbann
+
+#endif  // LBANN_CALLBACKS_CALLBACK_AUTOTUNE_IO_HPP_INCLUDED
@@ -92,6 +92,14 @@ public:
    */
   virtual void setup(model *m) {};
 
+  /** @brief Whether setup on the model will overwrite all of its
+   *         weights values, e.g. from a checkpoint.
+   *
+   *  Called on every process of the trainer before the weights are
+   *  set up. Weights initialization is skipped if this returns true.
+   */
+  virtual bool restores_weights(model *m) { return false; }
+
   ///@}
   /** @name Callback hooks */
   ///@{
@@ -31,22 +31,39 @@
 
 #include "lbann/callbacks/callback.hpp"
 
+#include <memory>
+
 namespace lbann {
 namespace callback {
 
 /**
  * Check matrices for whether they include any NaNs or infs to help debugging.
  * This will kill the rank if such values are discovered.
+ *
+ * In deferred mode, GPU matrices are not copied to the host. A kernel
+ * per matrix sets a device flag on any non-finite entry, and the flag
+ * is read back asynchronously once per step. When it trips, the
+ * weights and gradients are checked on the host and the callback
+ * falls back to the full checks, which locate the offending layer
+ * at the next occurrence. CPU matrices are always checked directly.
  */
 class check_nan : public callback_base {
  public:
   using callback_base::on_forward_prop_end;
   using callback_base::on_backward_prop_end;
 
-  check_nan() = default;
-  check_nan(const check_nan&) = default;
-  check_nan& operator=(
-    const check_nan&) = default;
+  /** @param deferred Flag non-finite GPU entries without syncing. */
+  check_nan(bool deferred = false) : m_deferred(deferred) {}
+  check_nan(const check_nan& other)
+    : callback_base(other), m_deferred(other.m_deferred) {}
+  check_nan& operator=(const check_nan& other) {
+    callback_base::operator=(other);
+    m_deferred = other.m_deferred;
+#ifdef LBANN_HAS_GPU
+    m_device.reset();
+#endif // LBANN_HAS_GPU
+    return *this;
+  }
   check_nan* copy() const override {
     return new check_nan(*this);
   }
@@ -58,13 +75,39 @@ class check_nan : public callback_base {
   void on_backward_prop_end(model *m) override;
   /** Check that weights are good. */
   void on_batch_end(model *m) override;
+  /** Read the last deferred flag. */
+  void on_train_end(model *m) override;
   std::string name() const override { return "check_nan"; }
 
+private:
+
+  /** Whether GPU matrices are flagged on the device. */
+  bool m_deferred;
+
+#ifdef LBANN_HAS_GPU
+  /** Device flag, its host copy and the event of the copy. */
+  struct device_state;
+  std::shared_ptr<device_state> m_device;
+
+  /** Set the device flag if @c mat has a non-finite entry. */
+  void flag_nonfinite_gpu(const El::AbstractMatrix<DataType>& mat);
+  /** Start copying the device flag to the host, unless a copy is
+   *  already in flight. */
+  void start_flag_read();
+  /** Whether a completed flag read found a non-finite entry.
+   *  @param wait Wait for the copy in flight, if any. */
+  bool poll_flag(bool wait);
+#endif // LBANN_HAS_GPU
+
+  /** Locate non-finite values after the deferred flag tripped. */
+  void handle_deferred_flag(model *m);
+
 };
 
 // Builder function
-LBANN_ADD_DEFAULT_CALLBACK_BUILDER(
-  check_nan, build_check_nan_callback_from_pbuf)
+std::unique_ptr<callback_base>
+build_check_nan_callback_from_pbuf(
+  const google::protobuf::Message&, std::shared_ptr<lbann_summary> const&);
 
 } // namespace callback
 } // namespace lbann
@@ -60,6 +60,14 @@ class check_small : public callback_base {
   /** Check that weights are good. */
   void on_batch_end(model *m) override;
   std::string name() const override { return "check_small"; }
+
+ private:
+#ifdef LBANN_HAS_GPU
+  /** Count small entries of a GPU matrix on the device. */
+  static El::Int count_small_gpu(const El::AbstractMatrix<DataType>& mat);
+#endif // LBANN_HAS_GPU
+  /** Whether a matrix has no small values. */
+  static bool is_good(const El::AbstractDistMatrix<DataType>& m);
 };
 
 // Builder function
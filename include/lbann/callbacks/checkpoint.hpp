@@ -31,6 +31,10 @@
 #include "lbann/callbacks/callback.hpp"
 #include "lbann/io/persist.hpp"
 #include "lbann/training_algorithms/training_algorithm.hpp"
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <vector>
 
 namespace lbann {
 namespace callback {
@@ -61,6 +65,42 @@ class checkpoint : public callback_base {
    *  @param per_rank_dir The directory into which to dump distributed checkpoints
    *  @param ckpt_dist_epochs The frequency of distributed checkpoints in epochs
    *  @param ckpt_dist_steps The frequence of distributed checkpoints in steps
+   *  @param async_writes Whether to write checkpoint files in the
+   *                      background. Matrices are copied to host
+   *                      memory and training continues while the
+   *                      files are written. At most one checkpoint is
+   *                      written at a time and the "last checkpoint"
+   *                      files are only updated once every process
+   *                      has finished.
+   *  @param io_aggregators_per_node Number of processes per node
+   *                      that write shared checkpoint files. Each
+   *                      matrix is written in parallel stripes by
+   *                      these processes. If zero, the trainer root
+   *                      writes each file.
+   *  @param full_checkpoint_interval Number of checkpoints between
+   *                      full checkpoints. The checkpoints in between
+   *                      are deltas, which only write weights and
+   *                      optimizer state that have changed since the
+   *                      last full checkpoint. Restarting from a
+   *                      delta reads the rest from the full
+   *                      checkpoint. If one or less, every checkpoint
+   *                      is full.
+   *  @param buddy_checkpoint Whether to copy each distributed
+   *                      checkpoint to a buddy process on another
+   *                      node. Intended for a node-local
+   *                      @c per_rank_dir (e.g. /dev/shm). When
+   *                      restarting, processes whose checkpoint is
+   *                      missing (e.g. on a replacement node) get it
+   *                      back from their buddy.
+   *  @param gpu_direct_storage Whether to read and write GPU
+   *                      matrices in distributed checkpoints
+   *                      directly between storage and GPU memory
+   *                      with cuFile. Requires LBANN to be built
+   *                      with cuFile.
+   *  @param compress     Space-separated persist types ("train",
+   *                      "model") whose distributed checkpoint files
+   *                      are compressed in parallel blocks. Requires
+   *                      LBANN to be built with zlib.
    */
   checkpoint(std::string checkpoint_dir,
              std::string restart_dir,
@@ -69,7 +109,13 @@ class checkpoint : public callback_base {
              int checkpoint_secs,
              std::string per_rank_dir,
              int ckpt_dist_epochs,
-             int ckpt_dist_steps) :
+             int ckpt_dist_steps,
+             bool async_writes = false,
+             int io_aggregators_per_node = 0,
+             int full_checkpoint_interval = 0,
+             bool buddy_checkpoint = false,
+             bool gpu_direct_storage = false,
+             std::string compress = "") :
     callback_base(),
     m_active_trainer(nullptr),
     m_active_training_algorithm(nullptr),
@@ -80,16 +126,25 @@ class checkpoint : public callback_base {
     m_checkpoint_secs(checkpoint_secs),
     m_per_rank_dir(per_rank_dir),
     m_ckpt_dist_epochs(ckpt_dist_epochs),
-    m_ckpt_dist_steps(ckpt_dist_steps) {}
+    m_ckpt_dist_steps(ckpt_dist_steps),
+    m_async_writes(async_writes),
+    m_io_aggregators_per_node(io_aggregators_per_node),
+    m_full_checkpoint_interval(full_checkpoint_interval),
+    m_buddy_checkpoint(buddy_checkpoint),
+    m_gpu_direct_storage(gpu_direct_storage),
+    m_compress(std::move(compress)) {}
   checkpoint(const checkpoint&) = default;
   checkpoint& operator=(const checkpoint&) = default;
   checkpoint* copy() const override { return new checkpoint(*this); }
   void setup(model *m) override;
   void setup(trainer *t) override;
+  /** Whether there is a checkpoint to reload the model from. */
+  bool restores_weights(model *m) override;
   void on_train_begin(model *m) override;
   void on_epoch_end(model *m) override;
   void on_batch_end(model *m) override;
   void on_validation_end(model *m) override;
+  void on_train_end(model *m) override;
 
   inline void set_checkpoint_dir(const std::string& dir){
     m_checkpoint_dir = dir;
@@ -196,6 +251,13 @@ class checkpoint : public callback_base {
   std::string name() const override { return "checkpoint"; }
  protected:
   bool do_checkpoint(model *m);
+  /** @brief Finish background checkpoint writes.
+   *  @details Updates the "last checkpoint" files once all processes
+   *  have written their files. If @c wait is false, returns
+   *  immediately if any process is still writing. Collective over
+   *  the trainer.
+   */
+  void finish_async_writes(model *m, bool wait);
  private:
   trainer* m_active_trainer;
   training_algorithm* m_active_training_algorithm;
@@ -212,6 +274,33 @@ class checkpoint : public callback_base {
   EvalType m_checkpoint_last;
   bool m_checkpoint_dist;
   bool m_checkpoint_shared;
+  bool m_async_writes;
+  int m_io_aggregators_per_node;
+  int m_full_checkpoint_interval;
+  /** Checkpoints written since the last full checkpoint. */
+  int m_checkpoints_since_full = 0;
+  /** Last full shared checkpoint, the base for shared deltas. */
+  std::string m_shared_base_dir;
+  /** Last full distributed checkpoint, the base for distributed deltas. */
+  std::string m_dist_base_dir;
+  bool m_buddy_checkpoint;
+  /** Distributed checkpoint to copy to the buddy once written. */
+  std::string m_pending_buddy_dir;
+  bool m_gpu_direct_storage;
+  /** Persist types to compress in distributed checkpoints. */
+  std::string m_compress;
+
+  /** "Last checkpoint" file to write once a checkpoint is complete. */
+  struct latest_marker {
+    std::string filename;
+    execution_mode mode;
+    size_t epoch;
+    size_t step;
+  };
+  /** Background checkpoint writes. Null if none are in flight. */
+  std::shared_ptr<std::future<void>> m_async_writes_done;
+  /** Markers for the checkpoint being written in the background. */
+  std::vector<latest_marker> m_pending_markers;
 
   template<size_t _max_dir_len>
   struct header_t {
@@ -265,15 +354,19 @@ inline std::string get_distributed_checkpoint_dirname(const std::string& trainer
 }
 
 // Print last checkpoint to file, used to determine which checkpoint to load from.
+// The file is written under a temporary name and renamed, so readers
+// never see a partially written file.
 inline bool write_latest(std::string filename, execution_mode mode, size_t epoch, size_t train) {
   // open the file for writing
-  int fd = openwrite(filename.c_str());
+  const std::string tmp_filename = filename + ".tmp";
+  int fd = openwrite(tmp_filename.c_str());
   if (fd != -1) {
     char field[256];
     sprintf(field, "mode=%s epoch=%ld step=%ld\n", to_string(mode).c_str(), epoch, train);
-    write_string(fd, filename.c_str(), field, strlen(field));
+    write_string(fd, tmp_filename.c_str(), field, strlen(field));
     // close our file
-    closewrite(fd, filename.c_str());
+    closewrite(fd, tmp_filename.c_str());
+    return std::rename(tmp_filename.c_str(), filename.c_str()) == 0;
   }
   return true;
 }
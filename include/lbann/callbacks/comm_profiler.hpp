@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_CALLBACKS_CALLBACK_COMM_PROFILER_HPP_INCLUDED
+#define LBANN_CALLBACKS_CALLBACK_COMM_PROFILER_HPP_INCLUDED
+
+#include "lbann/callbacks/callback.hpp"
+
+namespace lbann {
+namespace callback {
+
+/** @brief Report how well communication overlaps with compute.
+ *
+ *  Enables @c lbann::comm_profile during training. At the end of
+ *  each training epoch, the trainer master reports:
+ *  - Total and exposed (non-overlapped) communication time.
+ *  - The spread of exposed communication time across the processes
+ *    in the trainer. Since collectives synchronize the processes,
+ *    the process with the most exposed communication bounds the
+ *    critical path of each step.
+ *  - Count, time, and bus bandwidth of operations grouped by kind,
+ *    algorithm, and power-of-two message size.
+ *  - The layers and weights that trigger the most exposed
+ *    communication.
+ *
+ *  This is intended for tuning gradient bucketing and allreduce
+ *  settings.
+ */
+class comm_profiler : public callback_base {
+public:
+  /** @param num_contexts Number of layers and weights to report. */
+  comm_profiler(size_t num_contexts = 10)
+    : callback_base(1), m_num_contexts(num_contexts) {}
+  comm_profiler(const comm_profiler&) = default;
+  comm_profiler& operator=(const comm_profiler&) = default;
+  comm_profiler* copy() const override { return new comm_profiler(*this); }
+  std::string name() const override { return "comm profiler"; }
+  void on_train_begin(model *m) override;
+  void on_train_end(model *m) override;
+  void on_epoch_begin(model *m) override;
+  void on_epoch_end(model *m) override;
+
+private:
+  /** Number of layers and weights to report. */
+  size_t m_num_contexts;
+};
+
+// Builder function
+std::unique_ptr<callback_base>
+build_comm_profiler_callback_from_pbuf(
+  const google::protobuf::Message&, std::shared_ptr<lbann_summary> const&);
+
+} // namespace callback
+} // namespace lbann
+
+#endif  // LBANN_CALLBACKS_CALLBACK_COMM_PROFILER_HPP_INCLUDED
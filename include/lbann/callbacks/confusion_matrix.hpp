@@ -99,6 +99,22 @@ private:
    */
   std::unique_ptr<AbsDistMatType> m_labels_v;
 
+#ifdef LBANN_HAS_GPU
+  /** Confusion matrix counts accumulated on GPU.
+   *  Used when the prediction and label layers keep all rows of
+   *  their outputs on the GPU. The (j,i)-entry is the number of
+   *  samples with prediction i and label j, as for @c m_counts. The
+   *  counts are added to @c m_counts before they could lose
+   *  precision and when the confusion matrix is saved.
+   */
+  std::map<execution_mode,GPUMat> m_device_counts;
+  /** Samples counted in @c m_device_counts since the last flush. */
+  std::map<execution_mode,El::Int> m_device_num_samples;
+
+  /** Add the GPU counts to @c m_counts and zero them. */
+  void flush_device_counts(execution_mode mode);
+#endif // LBANN_HAS_GPU
+
   /** Get prediction matrix. */
   const AbsDistMatType& get_predictions(const model& m) const;
   /** Get label matrix. */
@@ -117,6 +133,17 @@ private:
 };
 
 // Builder function
+#ifdef LBANN_HAS_GPU
+/** @brief Count one-hot predictions and labels on the GPU
+ *
+ *  Adds 1 to entry (label, prediction) of @c counts for each column
+ *  with a nonzero prediction and label.
+ */
+void update_confusion_matrix_counts_gpu(const GPUMat& predictions,
+                                        const GPUMat& labels,
+                                        GPUMat& counts);
+#endif // LBANN_HAS_GPU
+
 std::unique_ptr<callback_base>
 build_confusion_matrix_callback_from_pbuf(
   const google::protobuf::Message&, std::shared_ptr<lbann_summary> const&);
@@ -29,22 +29,29 @@
 
 #include "lbann/callbacks/callback.hpp"
 
+#include <memory>
+
 namespace lbann {
 namespace callback {
 
+class shard_writer;
+
 /** Dump gradients w.r.t. inputs to file.
  *  After each layer performs a backward prop step, this callback will
  *  dump the gradients w.r.t. inputs (the "error signals") to a
  *  human-readable ASCII file. This is slow and produces a lot of output.
+ *  In sharded mode, each rank writes its local block in the background
+ *  to "<file>_rank<#>.txt" instead of gathering the matrix.
  */
 class dump_error_signals : public callback_base {
  public:
 
   /** Constructor.
    *  @param basename The basename for output files.
+   *  @param sharded Whether each rank writes its local block.
    */
-  dump_error_signals(std::string basename = "")
-    : callback_base(), m_basename(basename) {}
+  dump_error_signals(std::string basename = "", bool sharded = false)
+    : callback_base(), m_basename(basename), m_sharded(sharded) {}
   dump_error_signals* copy() const override {
     return new dump_error_signals(*this);
   }
@@ -52,10 +59,16 @@ class dump_error_signals : public callback_base {
 
   /** Write error signals to file after each backward prop step. */
   void on_backward_prop_end(model *m, Layer *l) override;
+  /** Wait for background writes. */
+  void on_train_end(model *m) override;
 
  private:
   /** Basename for output files. */
   std::string m_basename;
+  /** Whether each rank writes its local block. */
+  bool m_sharded;
+  /** Background writer for sharded output. */
+  std::shared_ptr<shard_writer> m_writer;
 
 };
 
@@ -29,12 +29,15 @@
 
 #include "lbann/callbacks/callback.hpp"
 
+#include <memory>
 #include <set>
 #include <string>
 
 namespace lbann {
 namespace callback {
 
+class shard_writer;
+
 /** @brief Dump layer output tensors to files.
  *
  *  Saves a file for each output tensor of each selected layer,
@@ -50,6 +53,12 @@ namespace callback {
  *  we use internally).
  *
  *  CNPY is required to export to NumPy file formats (npy and npz).
+ *
+ *  In sharded mode, nothing is gathered. Each rank writes its local
+ *  block to "<...>-output<#>_rank<#>.<format>" from a background
+ *  thread, alongside a "<file>.index" text file with the block's
+ *  place in the global matrix (see @c shard_writer). Training only
+ *  waits for the writes at the end of training or testing.
  */
 class dump_outputs : public callback_base {
 public:
@@ -66,13 +75,17 @@ public:
    *                        working directory).
    *  @param file_format    Output file format. Options are csv, tsv,
    *                        npy, npz (default: csv).
+   *  @param sharded        Whether each rank writes its local data
+   *                        in the background (default: gather to
+   *                        one rank).
    */
   dump_outputs(
     std::set<std::string> layer_names,// = std::set<std::string>(),
     std::set<execution_mode> modes, // = std::set<std::string>(),
     El::Int batch_interval = 0,
     std::string directory = "",
-    std::string file_format = "");
+    std::string file_format = "",
+    bool sharded = false);
 
   dump_outputs* copy() const override {
     return new dump_outputs(*this);
@@ -88,6 +101,8 @@ public:
       do_dump_outputs(*m, *l);
     }
   }
+  void on_train_end(model* m) override { wait_for_writes(); }
+  void on_test_end(model* m) override { wait_for_writes(); }
 
 private:
 
@@ -109,11 +124,20 @@ private:
   /** @brief Output file format. */
   std::string m_file_format;
 
+  /** @brief Whether each rank writes its local data. */
+  bool m_sharded;
+
+  /** @brief Background writer for sharded output. */
+  std::shared_ptr<shard_writer> m_writer;
+
   /** @brief   Dump outputs to file.
    *  @details Returns immediately if an output dump is not needed.
    */
   void do_dump_outputs(const model& m, const Layer& l);
 
+  /** @brief Wait for background writes, if any. */
+  void wait_for_writes();
+
 };
 
 // Builder function
@@ -29,6 +29,7 @@
 #ifndef LBANN_CALLBACKS_CALLBACK_DUMP_WEIGHTS_HPP_INCLUDED
 #define LBANN_CALLBACKS_CALLBACK_DUMP_WEIGHTS_HPP_INCLUDED
 
+#include <memory>
 #include <utility>
 
 #include "lbann/callbacks/callback.hpp"
@@ -36,21 +37,29 @@
 namespace lbann {
 namespace callback {
 
+class shard_writer;
+
 /**
  * Dump weight matrices to files.
  * This will dump each hidden layer's weight/bias matrix after specified epoch interval.
  * The matrices are written to files using Elemental's simple ASCII format. This
  * is not meant for checkpointing, but for exporting weight matrices for
  * analysis that isn't easily done in LBANN.
+ *
+ * In sharded mode, each rank writes its local block in the background
+ * to "<file>_rank<#>.txt" instead of gathering the matrix.
  */
 class dump_weights : public callback_base {
  public:
   /**
    * @param basename The basename for writing files.
+   * @param sharded Whether each rank writes its local block.
    */
-  dump_weights(std::string basename, El::Int epoch_interval=1) :
+  dump_weights(std::string basename, El::Int epoch_interval=1,
+               bool sharded=false) :
     callback_base(), m_basename(std::move(basename)),
-    m_epoch_interval(std::max(El::Int(1),epoch_interval)) {}
+    m_epoch_interval(std::max(El::Int(1),epoch_interval)),
+    m_sharded(sharded) {}
   dump_weights(const dump_weights&) = default;
   dump_weights& operator=(
     const dump_weights&) = default;
@@ -59,6 +68,7 @@ class dump_weights : public callback_base {
   }
   void on_train_begin(model *m) override;
   void on_epoch_end(model *m) override;
+  void on_train_end(model *m) override;
   std::string name() const override { return "dump weights"; }
   void set_target_dir(const std::string& basename) { m_basename = basename; }
   const std::string& get_target_dir() { return m_basename; }
@@ -67,6 +77,10 @@ class dump_weights : public callback_base {
   std::string m_basename;
   /** Interval at which to dump weights */
   El::Int m_epoch_interval;
+  /** Whether each rank writes its local block. */
+  bool m_sharded;
+  /** Background writer for sharded output. */
+  std::shared_ptr<shard_writer> m_writer;
   /// Dump weights from learning layers.
   void do_dump_weights(model *m, std::string s = "");
 };
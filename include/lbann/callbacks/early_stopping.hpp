@@ -32,19 +32,25 @@
 #include <unordered_set>
 #include <unordered_map>
 #include "lbann/callbacks/callback.hpp"
+#include "lbann/callbacks/weights_snapshot.hpp"
 
 namespace lbann {
 namespace callback {
 
 /**
  * Stop training after validation error stops improving.
+ *
+ * With @c restore_best, the weights are copied to host memory whenever
+ * the score improves and copied back when training ends, so later
+ * callbacks (e.g. save_model) and testing see the best model without
+ * any intermediate files. Place this callback before save_model.
  */
 class early_stopping : public callback_base {
  public:
   /**
    * Continue training until score has not improved for patience epochs.
    */
-  early_stopping(int64_t patience);
+  early_stopping(int64_t patience, bool restore_best = false);
   early_stopping(const early_stopping&) = default;
   early_stopping& operator=(
     const early_stopping&) = default;
@@ -53,6 +59,8 @@ class early_stopping : public callback_base {
   }
   /** Update validation score and check for early stopping. */
   void on_validation_end(model *m) override;
+  /** Restore the best weights, if requested. */
+  void on_train_end(model *m) override;
   std::string name() const override { return "early stopping"; }
  private:
   /** Number of epochs to wait for improvements. */
@@ -61,6 +69,10 @@ class early_stopping : public callback_base {
   EvalType m_last_score = std::numeric_limits<EvalType>::max();
   /** Current number of epochs without improvement. */
   int64_t m_wait = 0;
+  /** Whether to restore the best weights when training ends. */
+  bool m_restore_best;
+  /** Weights with the best score. */
+  weights_snapshot m_best;
 };
 
 // Builder function
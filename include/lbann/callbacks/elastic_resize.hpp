@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_CALLBACKS_CALLBACK_ELASTIC_RESIZE_HPP_INCLUDED
+#define LBANN_CALLBACKS_CALLBACK_ELASTIC_RESIZE_HPP_INCLUDED
+
+#include "lbann/callbacks/callback.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace lbann {
+namespace callback {
+
+/** @brief Stop training when the trainers should be regrouped.
+ *
+ *  At the end of every epoch the world master checks for
+ *  @c request_file. A job launcher writes the number of processes
+ *  per trainer it wants into this file. The file is removed, and the
+ *  request is broadcast to the world. If the number differs from the
+ *  current one and divides the world size, training stops.
+ *
+ *  The driver then calls @c lbann::resize_trainer. It regroups the
+ *  processes and rebuilds the model, and training resumes at the
+ *  same epoch. No checkpoint is written or read.
+ *
+ *  The processes of the job are fixed by MPI. When a node fails,
+ *  the job still has to be restarted from a checkpoint. Growing the
+ *  job to more nodes also needs a restart.
+ */
+class elastic_resize : public callback_base {
+public:
+  /** @param request_file File polled for a new number of processes
+   *                      per trainer.
+   */
+  elastic_resize(std::string request_file)
+    : callback_base(1), m_request_file(std::move(request_file)) {}
+  elastic_resize(const elastic_resize&) = default;
+  elastic_resize& operator=(const elastic_resize&) = default;
+  elastic_resize* copy() const override { return new elastic_resize(*this); }
+  std::string name() const override { return "elastic resize"; }
+  void on_epoch_end(model *m) override;
+
+  /** Processes per trainer requested, or 0 if there is no request. */
+  int get_requested_procs_per_trainer() const noexcept {
+    return m_requested_procs_per_trainer;
+  }
+
+private:
+
+  /** File polled for a new number of processes per trainer. */
+  std::string m_request_file;
+  /** Processes per trainer requested, or 0 if there is no request. */
+  int m_requested_procs_per_trainer = 0;
+
+};
+
+/** @brief Host copy of a model's weights and optimizer state that is
+ *  replicated on every process.
+ *
+ *  Unlike @c weights_snapshot, the copy does not depend on how the
+ *  matrices are distributed, so it can be restored into a model
+ *  built on a different grid. Optimizer state is kept for SGD and
+ *  Adam, and the learning rate is kept for every optimizer. Each
+ *  process holds the full state, so the copy needs as much host
+ *  memory as the whole model.
+ */
+class replicated_model_state {
+public:
+
+  /** Copy the state of @c m. Collective over the trainer of @c m. */
+  void save(model& m);
+  /** Copy the state into @c m. The copy held by the trainer master
+   *  is used, so all processes of a trainer agree. Collective over
+   *  the trainer of @c m, which must already be set up.
+   */
+  void restore(model& m) const;
+
+  bool empty() const noexcept { return m_state.empty(); }
+  void clear() { m_state.clear(); }
+
+private:
+
+  /** State of one weights object. */
+  struct entry {
+    /** Weight values. */
+    CPUMat values;
+    /** Optimizer state matrices, e.g., SGD velocity. */
+    std::vector<CPUMat> optimizer_state;
+    /** Optimizer learning rate, followed by other scalars. */
+    std::vector<DataType> hyperparameters;
+  };
+
+  /** State by weights name. */
+  std::map<std::string, entry> m_state;
+
+};
+
+// Builder function
+std::unique_ptr<callback_base>
+build_elastic_resize_callback_from_pbuf(
+  const google::protobuf::Message&, std::shared_ptr<lbann_summary> const&);
+
+} // namespace callback
+} // namespace lbann
+
+#endif  // LBANN_CALLBACKS_CALLBACK_ELASTIC_RESIZE_HPP_INCLUDED
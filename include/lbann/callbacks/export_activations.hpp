@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_CALLBACKS_CALLBACK_EXPORT_ACTIVATIONS_HPP_INCLUDED
+#define LBANN_CALLBACKS_CALLBACK_EXPORT_ACTIVATIONS_HPP_INCLUDED
+
+#include "lbann/callbacks/callback.hpp"
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+namespace lbann {
+namespace callback {
+
+class shard_writer;
+
+/** @brief Export layer outputs for every test sample.
+ *
+ *  Meant for feature extraction: run a trained model over a data set
+ *  in testing mode (with a large mini-batch size) and stream the
+ *  selected layers' outputs to disk. Each rank appends its local
+ *  samples to one set of files per layer:
+ *
+ *  - "<model>_<layer>_rank<#>.bin": raw @c DataType values, one
+ *    contiguous record of the flattened output tensor per sample.
+ *  - "<model>_<layer>_rank<#>.idx": one int64 data reader sample
+ *    index per record.
+ *  - "<model>_<layer>_rank<#>.meta": tensor dims, record count and
+ *    value size, written when testing ends.
+ *
+ *  Device-to-host copies and file writes run in the background, so
+ *  forward prop overlaps with I/O. Exported layers must have
+ *  data-parallel outputs and only the first output is exported.
+ */
+class export_activations : public callback_base {
+public:
+  using callback_base::on_evaluate_forward_prop_end;
+
+  /** @param layer_names Layers to export.
+   *  @param directory   Directory for output files (default: current
+   *                     working directory).
+   */
+  export_activations(std::set<std::string> layer_names,
+                     std::string directory = "");
+  export_activations* copy() const override {
+    return new export_activations(*this);
+  }
+  std::string name() const override { return "export activations"; }
+
+  void on_test_begin(model* m) override;
+  void on_evaluate_forward_prop_end(model* m, Layer* l) override;
+  void on_test_end(model* m) override;
+
+private:
+
+  /** Open output files of one layer on this rank. */
+  struct shard;
+
+  /** Names of exported layers. */
+  std::set<std::string> m_layer_names;
+  /** Directory for output files, with trailing '/'. */
+  std::string m_directory;
+
+  /** Output files by layer name. */
+  std::map<std::string, std::shared_ptr<shard>> m_shards;
+  /** Background copies and writes. */
+  std::shared_ptr<shard_writer> m_writer;
+
+};
+
+// Builder function
+std::unique_ptr<callback_base>
+build_export_activations_callback_from_pbuf(
+  const google::protobuf::Message&, std::shared_ptr<lbann_summary> const&);
+
+} // namespace callback
+} // namespace lbann
+
+#endif // LBANN_CALLBACKS_CALLBACK_EXPORT_ACTIVATIONS_HPP_INCLUDED
@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_CALLBACKS_CALLBACK_GPU_LAYER_TIMER_HPP_INCLUDED
+#define LBANN_CALLBACKS_CALLBACK_GPU_LAYER_TIMER_HPP_INCLUDED
+
+#include "lbann/callbacks/callback.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace lbann {
+namespace callback {
+
+/** @brief Measure device time of layers and optimizers.
+ *
+ *  Host timers only measure kernel launch time for GPU layers unless
+ *  the device is synchronized after each layer (see @c sync_layers),
+ *  which perturbs the measurement. This callback instead records a
+ *  pair of CUDA events on the compute stream around each layer's
+ *  forward and backward prop and each weights' optimization step.
+ *  Event pairs are resolved without blocking once they are at least
+ *  @c lag mini-batches old, so the step is never synchronized. At the
+ *  end of each training epoch the remaining events are resolved and
+ *  the mean device time per mini-batch is reported for each layer
+ *  and weights.
+ *
+ *  Layers that do not use GPUs are skipped. Does nothing in builds
+ *  without GPU support.
+ */
+class gpu_layer_timer : public callback_base {
+public:
+  /** @param lag Mini-batches to wait before querying events. */
+  gpu_layer_timer(size_t lag = 2) : callback_base(1), m_lag(lag) {}
+  /** Copies configuration but not events, which are owned by a
+   *  single instance. */
+  gpu_layer_timer(const gpu_layer_timer& other)
+    : callback_base(other), m_lag(other.m_lag) {}
+  gpu_layer_timer& operator=(const gpu_layer_timer& other);
+  ~gpu_layer_timer() override;
+  gpu_layer_timer* copy() const override {
+    return new gpu_layer_timer(*this);
+  }
+  std::string name() const override { return "GPU layer timer"; }
+
+  void setup(model *m) override;
+  void on_batch_end(model *m) override;
+  void on_epoch_end(model *m) override;
+
+  using callback_base::on_forward_prop_begin;
+  using callback_base::on_forward_prop_end;
+  using callback_base::on_backward_prop_begin;
+  using callback_base::on_backward_prop_end;
+  using callback_base::on_optimize_begin;
+  using callback_base::on_optimize_end;
+
+  void on_forward_prop_begin(model *m, Layer *l) override;
+  void on_forward_prop_end(model *m, Layer *l) override;
+  void on_backward_prop_begin(model *m, Layer *l) override;
+  void on_backward_prop_end(model *m, Layer *l) override;
+  void on_optimize_begin(model *m, weights *w) override;
+  void on_optimize_end(model *m, weights *w) override;
+
+private:
+
+  /** Mini-batches to wait before querying events. */
+  size_t m_lag;
+  /** Mini-batches seen in the current epoch. */
+  size_t m_step = 0;
+
+  /** Names of timed regions ("fp-<layer>", "bp-<layer>",
+   *  "opt-<weights>"). */
+  std::vector<std::string> m_region_names;
+  /** Region indices, keyed by name. */
+  std::unordered_map<std::string, size_t> m_region_index;
+  /** Accumulated device time of each region in the current epoch
+   *  (milliseconds). */
+  std::vector<double> m_region_times;
+
+#ifdef LBANN_HAS_GPU
+  /** Event pair around one pass of a region. */
+  struct record {
+    size_t region;
+    size_t step;
+    cudaEvent_t begin;
+    cudaEvent_t end;
+  };
+  /** Event pairs that have not been resolved, in recording order. */
+  std::deque<record> m_pending;
+  /** Event pairs opened by a begin hook, keyed by region. */
+  std::unordered_map<size_t, record> m_open;
+  /** Recycled events. */
+  std::vector<cudaEvent_t> m_free_events;
+
+  cudaEvent_t get_event();
+  void begin_region(const std::string& name);
+  void end_region(const std::string& name);
+  /** Resolve pending event pairs.
+   *  @param blocking Whether to wait for events that are not yet
+   *                  complete.
+   */
+  void resolve(bool blocking);
+  void release_events();
+#endif // LBANN_HAS_GPU
+
+  size_t get_region(const std::string& name);
+
+};
+
+// Builder function
+std::unique_ptr<callback_base>
+build_gpu_layer_timer_callback_from_pbuf(
+  const google::protobuf::Message&, std::shared_ptr<lbann_summary> const&);
+
+} // namespace callback
+} // namespace lbann
+
+#endif  // LBANN_CALLBACKS_CALLBACK_GPU_LAYER_TIMER_HPP_INCLUDED
@@ -34,7 +34,11 @@
 namespace lbann {
 namespace callback {
 
-/** Callback hooks for printing GPU memory usage. */
+/** Callback hooks for printing GPU memory usage.
+ *  With @c --gpu_caching_allocator, the caching allocator's live,
+ *  cached, and peak bytes, fragmentation, and cudaMalloc calls are
+ *  printed too.
+ */
 class gpu_memory_usage : public callback_base {
  public:
 
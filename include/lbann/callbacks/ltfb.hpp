@@ -33,6 +33,9 @@
 #include <vector>
 
 namespace lbann {
+
+template <typename> class data_type_weights;
+
 namespace callback {
 
 /** @brief Tournament training.
@@ -76,8 +79,12 @@ public:
      *    - Requires all models to be identical aside from their
      *      weights values, so this is not suitable for hyperparameter
      *      or model architecture exploration.
-     *    - Optimizer state is not exchanged, so there may be wonky
-     *      learning behavior immediately after a tournament.
+     *    - SGD and Adam optimizer state is exchanged unless disabled.
+     *      Otherwise there may be wonky learning behavior immediately
+     *      after a tournament.
+     *    - With NCCL support in Aluminum, GPU data moves directly
+     *      between devices and all matrices are exchanged
+     *      concurrently.
      *    - Optimal if communication performance between ranks is
      *      uniform and independent. If intra-trainer communication is
      *      fast or if communication performance is sensitive to
@@ -113,6 +120,16 @@ public:
    *  @param low_score_wins Whether low-scoring or high-scoring models
    *                        survive a tournament.
    *  @param comm_algo      Inter-trainer communication scheme.
+   *  @param exchange_optimizer_state Whether to exchange optimizer
+   *                        state with the weights values. Only
+   *                        applies to @c sendrecv_weights.
+   *  @param async_evaluation_steps If positive, tournaments do not
+   *                        stall training. The local and partner
+   *                        models are evaluated on weight snapshots,
+   *                        this many validation mini-batches after
+   *                        each training mini-batch, and the decision
+   *                        is applied at the next tournament. The
+   *                        winner's current model is taken.
    *  @param summarizer     The summarizer to use for this callback
    */
   ltfb(
@@ -122,7 +139,9 @@ public:
     bool low_score_wins = false,
     communication_algorithm comm_algo = communication_algorithm::sendrecv_weights,
     const std::string& ckptdir = "",
-    bool exchange_hyperparameters = false);
+    bool exchange_hyperparameters = false,
+    bool exchange_optimizer_state = true,
+    El::Int async_evaluation_steps = 0);
   ltfb(const ltfb& other);
   ltfb& operator=(const ltfb& other);
   ltfb* copy() const override { return new ltfb(*this); }
@@ -131,6 +150,8 @@ public:
   void setup(model *m) override;
   void on_train_begin(model *m) override;
   void on_batch_begin(model *m) override;
+  void on_batch_end(model *m) override;
+  void on_train_end(model *m) override;
 
   /** Convert string to LTFB communication algorithm.
    *
@@ -144,6 +165,20 @@ public:
 
 private:
 
+  /** Stage of an asynchronous tournament evaluation. */
+  enum class async_phase { none, partner, local };
+
+  /** Apply the last asynchronous tournament and start a new one. */
+  void start_async_tournament(model& m, const std::string& message_prefix);
+  /** Start evaluating a snapshot of the model weights. */
+  void begin_async_evaluation(model& m);
+  /** Evaluate up to @c num_batches mini-batches of the asynchronous
+   *  tournament (all remaining if zero). */
+  void continue_async_evaluation(model& m, El::Int num_batches);
+
+  /** Number of training mini-batch steps between tournaments. */
+  El::Int m_tournament_interval;
+
   /** Metric for tournament evaluation. */
   std::string m_metric_name;
 
@@ -167,13 +202,65 @@ private:
   */
   bool m_exchange_hyperparameters;
 
+  /** Whether to exchange optimizer state with the weights values. */
+  bool m_exchange_optimizer_state;
+
+  /** Validation mini-batches per training mini-batch in asynchronous
+   *  tournaments. Tournaments are synchronous if not positive. */
+  El::Int m_async_evaluation_steps;
+  /** Stage of the asynchronous tournament. */
+  async_phase m_async_phase = async_phase::none;
+  /** Partner in the asynchronous tournament. */
+  El::Int m_async_partner = -1;
+  /** Partner model score in the asynchronous tournament. */
+  EvalType m_async_partner_score = 0;
+  /** Local model score in the asynchronous tournament. */
+  EvalType m_async_local_score = 0;
+  /** Whether an asynchronous tournament is waiting to be applied. */
+  bool m_async_decision_pending = false;
+
   /** Workspace weights.
    *
    *  Used to temporarily store local weights during a tournament.
    */
   std::vector<std::unique_ptr<weights>> m_workspace_weights;
+
+  /** Workspace weights for asynchronous tournaments.
+   *
+   *  Used to temporarily store the current weights while taking a
+   *  snapshot of the weights from the start of the tournament.
+   */
+  std::vector<std::unique_ptr<weights>> m_stash_weights;
 };
 
+/** @brief Exchange weights with the corresponding process in a
+ *  partner trainer.
+ *
+ *  Uses the @c ltfb::communication_algorithm::sendrecv_weights
+ *  scheme, so GPU data moves directly between devices when Aluminum
+ *  supports it. Both trainers must call this with each other as
+ *  partner.
+ *
+ *  @param weights_names    Names of weights to exchange. If empty,
+ *                          then all weights are exchanged.
+ *  @param send_weights     Weights values sent to partner.
+ *  @param recv_weights     Weights values recieved from partner.
+ *                          Must not alias @c send_weights.
+ *  @param exchange_hyperparameters Whether to exchange SGD and Adam
+ *                          hyperparameters. Only applies if
+ *                          @c exchange_optimizer_state is set.
+ *  @param exchange_optimizer_state Whether to exchange optimizer
+ *                          state along with weights values.
+ */
+void ltfb_exchange_weights(
+  lbann_comm& comm,
+  El::Int partner_trainer,
+  const std::set<std::string>& weights_names,
+  const std::vector<data_type_weights<DataType>*>& send_weights,
+  std::vector<data_type_weights<DataType>*>& recv_weights,
+  bool exchange_hyperparameters,
+  bool exchange_optimizer_state);
+
 // Builder function
 std::unique_ptr<callback_base>
 build_ltfb_callback_from_pbuf(
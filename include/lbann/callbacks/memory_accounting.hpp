@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_CALLBACKS_CALLBACK_MEMORY_ACCOUNTING_HPP_INCLUDED
+#define LBANN_CALLBACKS_CALLBACK_MEMORY_ACCOUNTING_HPP_INCLUDED
+
+#include "lbann/callbacks/callback.hpp"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lbann {
+namespace callback {
+
+/** @brief Attribute device memory to the objects that own it.
+ *
+ *  Unlike @c gpu_memory_usage, which only reports device-wide usage,
+ *  this samples the memory owned by each layer's activations and
+ *  error signals, each weights' values, each optimizer's gradient and
+ *  state, the input layers' mini-batch data, the model's tensor
+ *  arena, and the shared cuDNN workspace. Samples are taken after
+ *  forward prop, after backward prop, and after the optimization
+ *  step of training mini-batches (subject to the batch interval).
+ *
+ *  At the end of each training epoch, the trainer master reports the
+ *  peak of each category and of the largest owners, along with each
+ *  new high-water mark of the tracked total: when it happened, the
+ *  device-wide usage at the time, and the largest owner.
+ *
+ *  GPU memory is tracked in GPU builds and host memory otherwise.
+ *  Memory that Hydrogen's pool has cached but not handed out, and
+ *  transient allocations inside layers, are not attributed; they show
+ *  up as the difference between the device-wide and tracked usage.
+ */
+class memory_accounting : public callback_base {
+public:
+  /** @param batch_interval Mini-batches between samples.
+   *  @param num_owners     Number of largest owners to report.
+   */
+  memory_accounting(int batch_interval = 1, size_t num_owners = 20)
+    : callback_base(batch_interval), m_num_owners(num_owners) {}
+  memory_accounting(const memory_accounting&) = default;
+  memory_accounting& operator=(const memory_accounting&) = default;
+  memory_accounting* copy() const override {
+    return new memory_accounting(*this);
+  }
+  std::string name() const override { return "memory accounting"; }
+
+  using callback_base::on_forward_prop_end;
+  using callback_base::on_backward_prop_end;
+
+  void on_forward_prop_end(model *m) override { sample(*m, "forward prop"); }
+  void on_backward_prop_end(model *m) override { sample(*m, "backward prop"); }
+  void on_batch_end(model *m) override { sample(*m, "optimization"); }
+  void on_epoch_end(model *m) override;
+
+private:
+
+  /** Kind of memory. */
+  enum class category {
+    activations,
+    error_signals,
+    data,
+    weights,
+    optimizer,
+    workspace,
+    tensor_arena
+  };
+  static std::string to_string(category c);
+
+  /** Owner of memory. */
+  using owner = std::pair<category, std::string>;
+
+  /** A new peak of the tracked total. */
+  struct high_water_mark {
+    size_t epoch;
+    size_t step;
+    std::string phase;
+    /** Tracked bytes. */
+    size_t tracked;
+    /** Device-wide bytes in use, if known. */
+    size_t device_used;
+    /** Largest owner and its bytes. */
+    owner largest;
+    size_t largest_bytes;
+  };
+
+  /** Number of largest owners to report. */
+  size_t m_num_owners;
+  /** Peak bytes of each owner. */
+  std::map<owner, size_t> m_owner_peaks;
+  /** Peak bytes of each category. */
+  std::map<category, size_t> m_category_peaks;
+  /** Largest tracked total so far. */
+  size_t m_high_water = 0;
+  /** High-water marks not yet reported. */
+  std::vector<high_water_mark> m_high_water_marks;
+
+  /** Record the memory owned by every object in the model. */
+  void sample(model& m, const std::string& phase);
+
+};
+
+// Builder function
+std::unique_ptr<callback_base>
+build_memory_accounting_callback_from_pbuf(
+  const google::protobuf::Message&, std::shared_ptr<lbann_summary> const&);
+
+} // namespace callback
+} // namespace lbann
+
+#endif  // LBANN_CALLBACKS_CALLBACK_MEMORY_ACCOUNTING_HPP_INCLUDED
@@ -54,15 +54,41 @@ namespace callback {
  * This recommendation comes from https://docs.fast.ai/callbacks.mixup.html
  *
  * The recommended default alpha (from the paper) is 0.4.
+ *
+ * With cutmix, a box of the partner image replaces the same region
+ * of the image instead of blending the whole images, and the labels
+ * are mixed by the box area. See:
+ *
+ *     Yun, S. et al. "CutMix: Regularization Strategy to Train Strong
+ *     Classifiers with Localizable Features." ICCV, 2019.
+ *
+ * Cutout holes (square regions set to zero, as in the cutout
+ * transform) can be applied to every image in the same pass.
+ *
+ * The mixing partners, boxes and holes are drawn on the host for the
+ * whole mini-batch, then applied in one pass over the mini-batch:
+ * on the GPU if the input layer's outputs are on the GPU, so the
+ * data does not return to the host.
  */
 class mixup : public callback_base {
 public:
-  /** Apply mixup to layers named in layers with mixup parameter alpha. */
-  mixup(std::unordered_set<std::string> layers, float alpha) :
-    callback_base(), m_layers(layers), m_alpha(alpha) {
+  /** Apply mixup to layers named in layers with mixup parameter alpha.
+   *  @param cutmix        Paste boxes instead of blending images.
+   *  @param cutout_holes  Holes to cut out of each image.
+   *  @param cutout_length Side length of the cutout holes.
+   */
+  mixup(std::unordered_set<std::string> layers, float alpha,
+        bool cutmix = false,
+        size_t cutout_holes = 0, size_t cutout_length = 0) :
+    callback_base(), m_layers(layers), m_alpha(alpha),
+    m_cutmix(cutmix),
+    m_cutout_holes(cutout_holes), m_cutout_length(cutout_length) {
     if (alpha < 0.0f) {
       LBANN_ERROR("Mixup alpha must be non-negative.");
     }
+    if (cutout_holes > 0 && cutout_length == 0) {
+      LBANN_ERROR("Mixup cutout holes must have a positive length.");
+    }
   }
 
   mixup* copy() const override { return new mixup(*this); }
@@ -75,8 +101,38 @@ private:
   std::unordered_set<std::string> m_layers;
   /** mixup parameter. */
   float m_alpha;
+  /** Whether to paste a box of the partner image (cutmix). */
+  bool m_cutmix;
+  /** Number of holes cut out of each image. */
+  size_t m_cutout_holes;
+  /** Side length of the cutout holes. */
+  size_t m_cutout_length;
+
+  /** @brief Draw how each sample of the mini-batch is augmented
+   *
+   *  Column i of @c plan is: the mixing partner of sample i, the
+   *  weight of sample i, the cutmix box and then the cutout holes.
+   *  Boxes and holes are stored as (y0, x0, y1, x1), exclusive.
+   */
+  void make_plan(El::Int mbsize, El::Int height, El::Int width,
+                 CPUMat& plan) const;
 };
 
+/** Rows of a mixup plan before the cutout holes. */
+constexpr El::Int mixup_plan_header_size = 6;
+
+#ifdef LBANN_HAS_GPU
+/** @brief Apply a mixup plan to a mini-batch on the GPU
+ *
+ *  Reads the original samples and labels and writes the mixed ones.
+ */
+void apply_mixup_plan_gpu(const GPUMat& plan, El::Int num_holes,
+                          El::Int image_height, El::Int image_width,
+                          const GPUMat& samples_in, const GPUMat& labels_in,
+                          GPUMat& samples, GPUMat& labels,
+                          bool cutmix);
+#endif // LBANN_HAS_GPU
+
 // Builder function
 std::unique_ptr<callback_base>
 build_mixup_callback_from_pbuf(
@@ -30,6 +30,7 @@
 #define LBANN_CALLBACKS_IO_HPP_INCLUDED
 
 #include "lbann/callbacks/callback.hpp"
+#include "lbann/utils/io_profile.hpp"
 
 #include <google/protobuf/message.h>
 
@@ -41,6 +42,14 @@ namespace callback {
 
 /**
  * Print information on the amount of IO that layers do.
+ *
+ * At the end of each training epoch, each process also reports on
+ * its data pipeline: samples fetched per second, how long the model
+ * waited on data, how many fetches were queued ahead of the model,
+ * and the utilization of each I/O thread with the time it spent
+ * reading, decoding, and transforming samples (see
+ * @c lbann::io_profile). From these it gives a verdict on whether
+ * training is I/O-bound or compute-bound.
  */
 class monitor_io : public callback_base {
  public:
@@ -54,13 +63,26 @@ class monitor_io : public callback_base {
   monitor_io* copy() const override {
     return new monitor_io(*this);
   }
+  void on_train_begin(model *m) override;
+  void on_train_end(model *m) override;
+  void on_epoch_begin(model *m) override;
   /** Report how much I/O has occured per data reader */
   void on_epoch_end(model *m) override;
   void on_test_end(model *m) override;
   std::string name() const override { return "monitor_io"; }
  private:
+  /** Report on the data pipeline during the last training epoch. */
+  void report_pipeline(model& m);
+
   /** Indicies of layers to monitor. */
   std::unordered_set<std::string> m_layers;
+  /** Pipeline counters at the start of the epoch. */
+  double m_epoch_start = 0.0;
+  double m_wait_start = 0.0;
+  double m_copy_start = 0.0;
+  size_t m_batches_start = 0;
+  size_t m_queue_depth_start = 0;
+  std::vector<io_profile::thread_stats> m_threads_start;
 };
 
 // Builder function
@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_CALLBACKS_CALLBACK_PARALLEL_PLAN_HPP_INCLUDED
+#define LBANN_CALLBACKS_CALLBACK_PARALLEL_PLAN_HPP_INCLUDED
+
+#include "lbann/callbacks/callback.hpp"
+#include "lbann/utils/parallel_plan.hpp"
+
+#include <string>
+#include <vector>
+
+namespace lbann {
+namespace callback {
+
+/** @brief Search for per-layer data layouts and spatial
+ *  decompositions.
+ *
+ *  Describes each layer to the cost model in
+ *  @c lbann::parallel_plan (FLOPs, weights, tensor sizes, halo
+ *  width) and searches for the data-parallel, model-parallel or
+ *  spatially decomposed distribution of each layer that minimizes the
+ *  estimated step time, including redistributions between layers
+ *  with different distributions. If @c profile_steps is positive, the
+ *  layers' forward and backward prop times measured over that many
+ *  training steps (after the first) replace the FLOP estimates for
+ *  their current distribution.
+ *
+ *  The world master prints the current and planned distribution of
+ *  each layer with its estimated cost and writes the plan to
+ *  @c output_file as a partial prototext, which can be inspected,
+ *  edited and frozen with @c --parallel_plan on the next run. A
+ *  layer's distribution is fixed when it is constructed, so the plan
+ *  does not change the running model.
+ */
+class parallel_plan : public callback_base {
+public:
+  /** @param profile_steps Training steps to measure layer times over
+   *                       (0 to use FLOP estimates only).
+   *  @param output_file   Prototext file to write the plan to.
+   *  @param flop_rate     Sustained FLOP/s per process (0 for a
+   *                       device-dependent default).
+   *  @param bandwidth     Bytes/s per process (0 for default).
+   *  @param latency       Seconds per message (0 for default).
+   */
+  parallel_plan(size_t profile_steps = 0,
+                std::string output_file = "parallel_plan.prototext",
+                double flop_rate = 0.0,
+                double bandwidth = 0.0,
+                double latency = 0.0)
+    : callback_base(1),
+      m_profile_steps(profile_steps),
+      m_output_file(std::move(output_file)),
+      m_flop_rate(flop_rate),
+      m_bandwidth(bandwidth),
+      m_latency(latency) {}
+  parallel_plan(const parallel_plan&) = default;
+  parallel_plan& operator=(const parallel_plan&) = default;
+  parallel_plan* copy() const override { return new parallel_plan(*this); }
+  std::string name() const override { return "parallel plan"; }
+  void on_train_begin(model *m) override;
+  void on_batch_begin(model *m) override;
+  void on_batch_end(model *m) override;
+
+private:
+
+  /** Describe the layers, search, report and write the plan. */
+  void make_plan(model& m);
+
+  /** Training steps to measure layer times over. */
+  size_t m_profile_steps;
+  /** Prototext file to write the plan to. */
+  std::string m_output_file;
+  /** Machine parameters (0 for defaults). */
+  double m_flop_rate;
+  double m_bandwidth;
+  double m_latency;
+
+  /** Whether the plan has been made. */
+  bool m_done = false;
+  /** Steps seen so far. */
+  size_t m_num_steps = 0;
+  /** Layer forward plus backward prop times at the start of a step. */
+  std::vector<double> m_start_times;
+  /** Layer times accumulated over profiled steps. */
+  std::vector<double> m_layer_times;
+
+};
+
+/** @brief Describe a layer to the cost model in
+ *  @c lbann::parallel_plan.
+ *
+ *  FLOPs are estimated from the layer type, weights and tensor
+ *  sizes. The layer must be set up.
+ */
+::lbann::parallel_plan::layer_info describe_layer_for_plan(const Layer& l);
+
+// Builder function
+std::unique_ptr<callback_base>
+build_parallel_plan_callback_from_pbuf(
+  const google::protobuf::Message&, std::shared_ptr<lbann_summary> const&);
+
+} // namespace callback
+} // namespace lbann
+
+#endif  // LBANN_CALLBACKS_CALLBACK_PARALLEL_PLAN_HPP_INCLUDED
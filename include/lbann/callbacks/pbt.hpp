@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_CALLBACKS_CALLBACK_PBT_HPP_INCLUDED
+#define LBANN_CALLBACKS_CALLBACK_PBT_HPP_INCLUDED
+
+#include "lbann/callbacks/callback.hpp"
+#include "lbann/comm.hpp"
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace lbann {
+namespace callback {
+
+/** @brief Population-based training.
+ *
+ *  Each trainer trains its own model and is a member of the
+ *  population. Periodically, every trainer evaluates its model on
+ *  its validation set and the scores are shared with a non-blocking
+ *  allreduce across trainers. At the next round, trainers are ranked
+ *  by those scores and the bottom fraction ("exploit") copies the
+ *  weights, optimizer state, and hyperparameters of a randomly
+ *  chosen trainer in the top fraction. A trainer that copied a model
+ *  then perturbs its hyperparameters ("explore") through the @c
+ *  perturb_adam and @c perturb_dropout callbacks attached to its
+ *  model.
+ *
+ *  There are no global barriers: the scores are one round stale, and
+ *  only paired trainers communicate, with the same pairwise exchange
+ *  LTFB uses.
+ *
+ *  Every trainer must use the same batch interval, fraction, and
+ *  model architecture.
+ */
+class pbt : public callback_base {
+public:
+
+  /** @param batch_interval      Number of training mini-batch steps
+   *                             between rounds.
+   *  @param metric_name         Metric used to rank trainers.
+   *  @param weights_names       Weights copied from a better trainer.
+   *                             If empty, all weights are copied.
+   *  @param low_score_wins      Whether low or high scores are better.
+   *  @param truncation_fraction Fraction of trainers that copy a
+   *                             model each round, and fraction of
+   *                             trainers they copy from.
+   */
+  pbt(El::Int batch_interval,
+      std::string metric_name,
+      std::set<std::string> weights_names = std::set<std::string>(),
+      bool low_score_wins = false,
+      EvalType truncation_fraction = 0.2);
+  pbt(const pbt& other);
+  pbt& operator=(const pbt& other);
+  pbt* copy() const override { return new pbt(*this); }
+  std::string name() const override { return "PBT"; }
+
+  void setup(model* m) override;
+  void on_batch_begin(model* m) override;
+  void on_train_end(model* m) override;
+
+private:
+
+  /** Copy a model from a better trainer if this trainer ranked low
+   *  in the last round. Returns the donor trainer, or -1. */
+  El::Int exploit(model& m, const std::string& message_prefix);
+  /** Perturb hyperparameters after copying a model. */
+  void explore(model& m);
+  /** Wait for the last round's scores. */
+  void wait_for_scores(lbann_comm& comm);
+
+  /** Metric used to rank trainers. */
+  std::string m_metric_name;
+
+  /** Weights copied from a better trainer.
+   *
+   *  If empty, then all weights are copied.
+   */
+  std::set<std::string> m_weights_names;
+
+  /** Whether low or high scores are better. */
+  bool m_low_score_wins;
+
+  /** Fraction of trainers that copy a model each round. */
+  EvalType m_truncation_fraction;
+
+  /** Number of rounds so far.
+   *
+   *  Seeds the pairing of trainers, so all trainers agree on it
+   *  without communicating.
+   */
+  El::Int m_round = 0;
+
+  /** Score of every trainer in the last round.
+   *
+   *  Each trainer fills in its own entry and the rest are zero until
+   *  the allreduce completes.
+   */
+  std::vector<EvalType> m_scores;
+  /** Request for the scores allreduce. */
+  Al::request m_scores_req;
+  /** Whether the scores allreduce is in flight. */
+  bool m_scores_pending = false;
+  /** Whether the scores of the last round are available. */
+  bool m_scores_ready = false;
+
+  /** Workspace weights.
+   *
+   *  Receive buffers for the values a donor trainer gets back from
+   *  its partner, and send buffers for the trainer copying a model.
+   */
+  std::vector<std::unique_ptr<weights>> m_workspace_weights;
+};
+
+// Builder function
+std::unique_ptr<callback_base>
+build_pbt_callback_from_pbuf(
+  const google::protobuf::Message&, std::shared_ptr<lbann_summary> const&);
+
+} // namespace callback
+} // namespace lbann
+
+#endif // LBANN_CALLBACKS_CALLBACK_PBT_HPP_INCLUDED
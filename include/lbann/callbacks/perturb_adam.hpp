@@ -82,6 +82,13 @@ public:
   void setup(model* m) override;
   void on_batch_begin(model* m) override;
 
+  /** Perturb Adam optimizers in model.
+   *
+   *  Also used by population-based training to explore after a
+   *  trainer has copied a better model.
+   */
+  void perturb(model& m) const;
+
 private:
 
   /** Standard deviation of learning rate perturbation.
@@ -117,8 +124,6 @@ private:
    */
   std::set<std::string> m_weights_names;
 
-  /** Perturb Adam optimizers in model. */
-  void perturb(model& m) const;
   /** Perturb Adam optimizer hyperparameters. */
   void perturb(lbann_comm& comm, adam<DataType>& m) const;
 
@@ -55,6 +55,13 @@ public:
 
   void setup(model* m) override;
 
+  /** Perturb dropout keep prob in model.
+   *
+   *  Also used by population-based training to explore after a
+   *  trainer has copied a better model.
+   */
+  void perturb(model& m);
+
 private:
 
   /** Standard deviation of keep probability  perturbation.
@@ -72,9 +79,6 @@ private:
   template <typename TensorDataType, data_layout T_layout, El::Device Dev>
   dropout<TensorDataType, T_layout, Dev>* get_dropout_layer(Layer* l);
 
-  /** Perturb dropout keep prob in model. */
-  void perturb(model& m);
-
 };
 
 // Builder function
@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_CALLBACKS_CALLBACK_QUANTIZE_INT8_HPP_INCLUDED
+#define LBANN_CALLBACKS_CALLBACK_QUANTIZE_INT8_HPP_INCLUDED
+
+#include "lbann/callbacks/callback.hpp"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace lbann {
+namespace callback {
+
+/** @brief Post-training int8 quantization.
+ *
+ *  Calibrates on the first evaluation mini-batches, then quantizes
+ *  the weights of fully-connected and convolution layers to a
+ *  symmetric int8 grid with one scale per output channel. During
+ *  later evaluations, each quantized layer's input is rounded to an
+ *  int8 grid whose scale is the largest magnitude seen during
+ *  calibration, so the model computes what int8 kernels with fp32
+ *  accumulation and rescaling would. At the end of each evaluation,
+ *  the metrics are reported next to the fp32 metrics measured during
+ *  calibration.
+ *
+ *  Rounded values are stored in the existing weights, so they can be
+ *  saved and converted to int8 by dividing by the scales. Inputs are
+ *  rounded in place in the parent's output, which is skipped if that
+ *  output is a view of another tensor.
+ */
+class quantize_int8 : public callback_base {
+public:
+
+  /** @param layer_names          Layers to quantize. If empty, all
+   *                              fully-connected and convolution
+   *                              layers.
+   *  @param calibration_batches  Evaluation mini-batches used to
+   *                              calibrate input scales.
+   */
+  quantize_int8(std::set<std::string> layer_names,
+                El::Int calibration_batches);
+  quantize_int8* copy() const override { return new quantize_int8(*this); }
+  std::string name() const override { return "quantize int8"; }
+
+  void setup(model* m) override;
+  void on_evaluate_forward_prop_begin(model* m, Layer* l) override;
+  void on_evaluate_forward_prop_end(model* m, Layer* l) override;
+  void on_evaluate_forward_prop_end(model* m) override;
+  void on_validation_end(model* m) override { end_evaluation(*m); }
+  void on_test_end(model* m) override { end_evaluation(*m); }
+
+private:
+
+  /** Names of layers to quantize. */
+  std::set<std::string> m_layer_names;
+  /** Number of mini-batches to calibrate on. */
+  El::Int m_calibration_batches;
+  /** Number of mini-batches calibrated on so far. */
+  El::Int m_num_calibrated_batches = 0;
+  /** Whether the weights have been quantized. */
+  bool m_quantized = false;
+
+  /** Largest input magnitude of each quantized layer. */
+  std::map<std::string, EvalType> m_input_ranges;
+
+  /** Sums of metric values over fp32 evaluations. */
+  std::vector<EvalType> m_fp32_metrics;
+  El::Int m_num_fp32_evaluations = 0;
+  /** Sums of metric values over int8 evaluations. */
+  std::vector<EvalType> m_int8_metrics;
+  El::Int m_num_int8_evaluations = 0;
+
+  /** Round weights to int8 grids and report the rounding error. */
+  void quantize_weights(model& m);
+  /** Record metrics and quantize once calibration is done. */
+  void end_evaluation(model& m);
+
+};
+
+// Builder function
+std::unique_ptr<callback_base>
+build_quantize_int8_callback_from_pbuf(
+  const google::protobuf::Message&, std::shared_ptr<lbann_summary> const&);
+
+} // namespace callback
+} // namespace lbann
+
+#endif // LBANN_CALLBACKS_CALLBACK_QUANTIZE_INT8_HPP_INCLUDED
@@ -30,6 +30,7 @@
 #define LBANN_CALLBACKS_CALLBACK_SAVE_TOPK_MODELS_HPP_INCLUDED
 
 #include "lbann/callbacks/save_model.hpp"
+#include "lbann/callbacks/weights_snapshot.hpp"
 
 namespace lbann {
 namespace callback {
@@ -40,23 +41,47 @@ namespace callback {
    * @param metric_name, evaluation metric
    * @ordering for the topk, descending order is default
    * Note: may end up saving more than k models if multiple models (trainers) have the same metric score
+   *
+   * In in-memory mode, each trainer keeps a host copy of the weights
+   * with its best validation score instead of saving after tests.
+   * When training ends, the trainers with the top k best scores save
+   * those copies. If @c flush_signal is set, receiving that signal
+   * makes every trainer save its best copy at the next step.
  */
 class save_topk_models : public save_model {
  public:
-  save_topk_models(std::string dir, int k, std::string metric_name, bool ascending_ordering=false) :
-  save_model(dir,true), m_k(k),m_metric_name(metric_name),m_ascending_ordering(ascending_ordering) {}
+  save_topk_models(std::string dir, int k, std::string metric_name, bool ascending_ordering=false,
+                   bool in_memory=false, int flush_signal=0) :
+  save_model(dir,true), m_k(k),m_metric_name(metric_name),m_ascending_ordering(ascending_ordering),
+  m_in_memory(in_memory), m_flush_signal(flush_signal) {}
   save_topk_models(const save_topk_models&) = default;
   save_topk_models& operator=(const save_topk_models&) = default;
   save_topk_models* copy() const override { return new save_topk_models(*this); }
+  void on_train_begin(model *m) override;
+  void on_batch_end(model *m) override;
+  void on_validation_end(model *m) override;
+  void on_train_end(model *m) override;
   void on_test_end(model *m) override;
   std::string name() const override { return "save_topk_models"; }
 
  private:
   /*determine if a trainer's model is in top k, computation done by trainer master processes*/
-  bool am_in_topk(model *m);
+  bool am_in_topk(model *m, EvalType score);
+  /** Mean value of the metric in the current execution mode. */
+  EvalType get_score(model *m) const;
+  /** Save the best snapshot without changing the model's weights. */
+  void save_best_snapshot(model *m);
   int m_k ;
   std::string m_metric_name;
   bool m_ascending_ordering;
+  /** Keep the best weights in memory until training ends. */
+  bool m_in_memory;
+  /** Signal that saves the best weights early (0 for none). */
+  int m_flush_signal;
+  /** Weights with the best validation score. */
+  weights_snapshot m_best;
+  /** Best validation score. */
+  EvalType m_best_score = 0;
 
 };
 
@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_CALLBACKS_CALLBACK_STRAGGLER_DETECTION_HPP_INCLUDED
+#define LBANN_CALLBACKS_CALLBACK_STRAGGLER_DETECTION_HPP_INCLUDED
+
+#include "lbann/callbacks/callback.hpp"
+
+#include <string>
+#include <vector>
+
+namespace lbann {
+namespace callback {
+
+/** @brief Find processes that slow down the trainer.
+ *
+ *  Each process times its training steps and splits them into time
+ *  waiting for the input layer's background fetch, time blocked in
+ *  communication (@c lbann_comm::get_wait_time), and the remainder,
+ *  which is mostly compute. Every @c interval steps the per-step
+ *  averages are gathered on the trainer master.
+ *
+ *  Since collectives synchronize the trainer, every process has
+ *  about the same step time and a straggler instead shows up as a
+ *  process with unusually high compute or I/O wait time (and
+ *  unusually low communication wait, since it is the process the
+ *  others wait for). A process is reported if its compute or I/O
+ *  wait time has a robust z-score,
+ *  @f$ 0.6745 (x - \mathrm{median}) / \mathrm{MAD} @f$, above
+ *  @c threshold and exceeds the median by at least a factor of
+ *  @c min_ratio. Unlike means and standard deviations, the median
+ *  and the median absolute deviation are not pulled toward the
+ *  outliers being searched for.
+ *
+ *  Reports name the rank and host. If @c output_file is set, the
+ *  trainer master also appends one line per flagged process with
+ *  whitespace-separated fields
+ *  @verbatim <step> <rank> <host> <metric> <value> <median> <z-score> @endverbatim
+ *  which a job scheduler or health-check script can use to drain
+ *  slow nodes.
+ */
+class straggler_detection : public callback_base {
+public:
+  /** @param interval Training steps between gathers.
+   *  @param threshold Robust z-score above which a process is flagged.
+   *  @param min_ratio Minimum ratio to the median for a flag.
+   *  @param output_file File to append flagged processes to (may be
+   *                     empty).
+   */
+  straggler_detection(size_t interval = 100,
+                      double threshold = 3.5,
+                      double min_ratio = 1.1,
+                      std::string output_file = "")
+    : callback_base(1),
+      m_interval(interval),
+      m_threshold(threshold),
+      m_min_ratio(min_ratio),
+      m_output_file(std::move(output_file)) {}
+  straggler_detection(const straggler_detection&) = default;
+  straggler_detection& operator=(const straggler_detection&) = default;
+  straggler_detection* copy() const override {
+    return new straggler_detection(*this);
+  }
+  std::string name() const override { return "straggler detection"; }
+  void on_train_begin(model *m) override;
+  void on_batch_begin(model *m) override;
+  void on_batch_end(model *m) override;
+
+private:
+
+  /** Gather per-step averages and report outliers. */
+  void analyze(model& m);
+
+  /** Training steps between gathers. */
+  size_t m_interval;
+  /** Robust z-score above which a process is flagged. */
+  double m_threshold;
+  /** Minimum ratio to the median for a flag. */
+  double m_min_ratio;
+  /** File to append flagged processes to. */
+  std::string m_output_file;
+
+  /** Host name of each process in the trainer. */
+  std::vector<std::string> m_hosts;
+
+  /** Counters at the start of the current step. */
+  double m_step_start = 0.0;
+  double m_io_wait_start = 0.0;
+  double m_comm_wait_start = 0.0;
+
+  /** Totals since the last gather. */
+  size_t m_num_steps = 0;
+  double m_step_time = 0.0;
+  double m_io_wait_time = 0.0;
+  double m_comm_wait_time = 0.0;
+
+};
+
+// Builder function
+std::unique_ptr<callback_base>
+build_straggler_detection_callback_from_pbuf(
+  const google::protobuf::Message&, std::shared_ptr<lbann_summary> const&);
+
+} // namespace callback
+} // namespace lbann
+
+#endif  // LBANN_CALLBACKS_CALLBACK_STRAGGLER_DETECTION_HPP_INCLUDED
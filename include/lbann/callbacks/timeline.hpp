@@ -40,7 +40,8 @@ namespace callback {
  * logfile for external processing.
  * The logfile is named timeline.m\<model-rank\>.\<rank\>.txt.
  * Each line is a separate event, written as name:start-time:end-time.
- * Times are relative to the beginning of training.
+ * Times are relative to the beginning of training. Passes of
+ * independent layers may overlap.
  */
 class timeline : public callback_base {
  public:
@@ -76,13 +77,11 @@ class timeline : public callback_base {
   std::string m_outdir;
   /// Time training started; all times are relative to this.
   EvalType m_start_time = EvalType(0);
-  /// Time the current layer's forward pass started.
-  EvalType m_fp_start_time = EvalType(0);
-  /// Time the current layer's backward pass started.
-  EvalType m_bp_start_time = EvalType(0);
   /// Time the current weights' optimization pass started.
   EvalType m_opt_start_time = EvalType(0);
   /// Store (relative) timing information.
+  /// Layer passes are recorded when they start, since independent
+  /// layers may overlap (see --parallel_layer_execution).
   std::unordered_map<std::string, std::vector<std::pair<EvalType, EvalType>>> m_fp_times;
   std::unordered_map<std::string, std::vector<std::pair<EvalType, EvalType>>> m_bp_times;
   std::unordered_map<std::string, std::vector<std::pair<EvalType, EvalType>>> m_opt_times;
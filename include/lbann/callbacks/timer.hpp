@@ -30,6 +30,7 @@
 #include "lbann/callbacks/callback.hpp"
 #include <chrono>
 #include <map>
+#include <utility>
 #include <vector>
 
 namespace lbann {
@@ -38,7 +39,16 @@ namespace callback {
 /** Record and report model timing results.
  *  Reports the total time and mini-batch time statistics for training
  *  epochs and for model evaluations. This reports times for the
- *  master process in each model.
+ *  master process in each model. Training epochs also report how the
+ *  mean mini-batch time splits into layer forward prop, layer backward
+ *  prop, and everything else (optimizer steps, gradient allreduces
+ *  outside layers, waiting on data).
+ *
+ *  With --pipeline_stages=N, training epochs also report how the
+ *  layers would be split into N pipeline stages with balanced
+ *  forward and backward prop times, and the step time estimated for
+ *  GPipe and 1F1B micro-batch schedules with --num_micro_batches
+ *  micro-batches.
  */
 class timer : public callback_base {
 public:
@@ -83,6 +93,9 @@ private:
   std::map<execution_mode,EvalType> m_batch_start_times;
   /** Mini-batch times. */
   std::map<execution_mode,std::vector<EvalType>> m_batch_times;
+  /** Layer forward and backward prop times at the start of the
+   *  training epoch. */
+  std::vector<std::pair<EvalType,EvalType>> m_layer_start_times;
 
   /** Start timing session. */
   void timing_begin(const model& m);
@@ -90,6 +103,14 @@ private:
    *  Prints results to standard output.
    */
   void timing_end(model& m);
+  /** Report the mean mini-batch time split into forward prop,
+   *  backward prop, and other time for the last training epoch.
+   */
+  void report_step_breakdown(model& m, const std::string& mode_string);
+  /** Report a balanced split of the layers into pipeline stages.
+   *  Uses the layer times from the last training epoch.
+   */
+  void report_pipeline_stages(model& m, int num_stages);
   /** Start mini-batch timing session. */
   void batch_timing_begin(const model& m);
   /** End mini-batch timing session.
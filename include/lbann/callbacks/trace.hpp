@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_CALLBACKS_CALLBACK_TRACE_HPP_INCLUDED
+#define LBANN_CALLBACKS_CALLBACK_TRACE_HPP_INCLUDED
+
+#include "lbann/callbacks/callback.hpp"
+#include <string>
+
+namespace lbann {
+namespace callback {
+
+/** @brief Record a low-overhead trace of training.
+ *
+ *  Enables @c lbann::telemetry while training. Layer forward and
+ *  backward passes, optimizer steps, data reader I/O tasks, and
+ *  allreduces, waits, and barriers are recorded on every rank. The
+ *  trace is written in Chrome trace format to
+ *  trace.t\<trainer-rank\>.\<rank\>.json. Unlike the @c timeline
+ *  callback, memory use is bounded and events are written by a
+ *  background thread, so it can be left on for production runs.
+ */
+class trace : public callback_base {
+public:
+  /** @param outdir         Directory to write traces to.
+   *  @param ring_capacity  Events buffered per thread. Events are
+   *                        dropped while a buffer is full.
+   *  @param flush_interval Seconds between writes of the buffers.
+   */
+  trace(std::string outdir,
+        size_t ring_capacity = 1 << 16,
+        double flush_interval = 0.1)
+    : callback_base(1),
+      m_outdir(std::move(outdir)),
+      m_ring_capacity(ring_capacity),
+      m_flush_interval(flush_interval) {}
+  trace(const trace&) = default;
+  trace& operator=(const trace&) = default;
+  trace* copy() const override { return new trace(*this); }
+  std::string name() const override { return "trace"; }
+  void on_train_begin(model *m) override;
+  void on_train_end(model *m) override;
+
+private:
+  /** Directory to write traces to. */
+  std::string m_outdir;
+  /** Events buffered per thread. */
+  size_t m_ring_capacity;
+  /** Seconds between writes of the buffers. */
+  double m_flush_interval;
+};
+
+// Builder function
+std::unique_ptr<callback_base>
+build_trace_callback_from_pbuf(
+  const google::protobuf::Message&, std::shared_ptr<lbann_summary> const&);
+
+} // namespace callback
+} // namespace lbann
+
+#endif  // LBANN_CALLBACKS_CALLBACK_TRACE_HPP_INCLUDED
@@ -154,6 +154,74 @@ std::unique_ptr<callback_base>
 build_minibatch_schedule_callback_from_pbuf(
   const google::protobuf::Message&, std::shared_ptr<lbann_summary> const&);
 
+/**
+ * Double the mini-batch size, and the learning rate, while the
+ * gradient noise scale allows it.
+ *
+ * The simple noise scale of McCandlish et al. (2018),
+ * @f$ B_{noise} = \mathrm{tr}(\Sigma) / |G|^2 @f$, is the batch size
+ * up to which larger batches still reduce the number of steps
+ * almost proportionally. It is estimated from gradients at two batch
+ * sizes that data-parallel training already has: each rank's local
+ * gradient, from @f$ B_{small} = B/P @f$ samples, and the allreduced
+ * gradient, from @f$ B_{big} = B @f$ samples. For squared norms
+ * @f$ S @f$,
+ * @f[
+ *   |G|^2 \approx \frac{B_{big} S_{big} - B_{small} S_{small}}
+ *                         {B_{big} - B_{small}}, \qquad
+ *   \mathrm{tr}(\Sigma) \approx \frac{S_{small} - S_{big}}
+ *                                   {1/B_{small} - 1/B_{big}}.
+ * @f]
+ * The norms are recorded by the optimizers (see
+ * @c optimizer::set_track_gradient_norms) every @c interval steps,
+ * with @f$ S_{small} @f$ averaged over the ranks, and both estimates
+ * are smoothed with an exponential moving average since they are
+ * noisy individually.
+ *
+ * At the end of each epoch, if the noise scale is at least twice the
+ * current mini-batch size, the mini-batch size and learning rate are
+ * doubled. The learning rate is ramped over @c ramp_time epochs.
+ * Assumes data-parallel weights; needs more than one process per
+ * trainer.
+ */
+class noise_scale_minibatch : public variable_minibatch {
+ public:
+  noise_scale_minibatch(size_t starting_mbsize, size_t interval = 10,
+                        size_t ramp_time = 0, double ema_decay = 0.95);
+  noise_scale_minibatch(const noise_scale_minibatch&) = default;
+  noise_scale_minibatch& operator=(
+    const noise_scale_minibatch&) = delete;
+  noise_scale_minibatch* copy() const override {
+    return new noise_scale_minibatch(*this);
+  }
+  std::string name() const override { return "noise scale minibatch"; }
+  void on_batch_begin(model *m) override;
+  void on_batch_end(model *m) override;
+ protected:
+  bool schedule(model *m, size_t& new_mbsize, float& new_lr, size_t& ramp_time) override;
+ private:
+  /// Training steps between measurements.
+  size_t m_interval;
+  /// Number of epochs to ramp the learning rate over.
+  size_t m_ramp_time;
+  /// Weight of the previous estimate in the moving averages.
+  double m_ema_decay;
+  /// Training steps seen.
+  size_t m_num_steps = 0;
+  /// Whether the optimizers record gradient norms this step.
+  bool m_tracking = false;
+  /// Moving averages of the estimates of |G|^2 and tr(Sigma).
+  double m_gradient_norm2 = 0.0;
+  double m_trace_sigma = 0.0;
+  /// Number of measurements in the moving averages.
+  size_t m_num_measurements = 0;
+};
+
+// Builder function
+std::unique_ptr<callback_base>
+build_noise_scale_minibatch_callback_from_pbuf(
+  const google::protobuf::Message&, std::shared_ptr<lbann_summary> const&);
+
 } // namespace callback
 } // namespace lbann
 
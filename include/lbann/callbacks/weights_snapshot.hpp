@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_CALLBACKS_WEIGHTS_SNAPSHOT_HPP_INCLUDED
+#define LBANN_CALLBACKS_WEIGHTS_SNAPSHOT_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+#include <map>
+#include <string>
+
+namespace lbann {
+
+class model;
+
+namespace callback {
+
+/** @brief Host copy of a model's weight values.
+ *
+ *  Each rank keeps its local blocks, in pinned memory if the weights
+ *  are on the GPU. Saving and restoring only copy memory and never
+ *  touch the file system, so a snapshot can be taken every epoch.
+ *  Optimizer state is not included.
+ */
+class weights_snapshot {
+public:
+
+  /** Copy the weight values of @c m. */
+  void save(model& m);
+  /** Copy the saved values back into the weights of @c m. */
+  void restore(model& m) const;
+
+  bool empty() const noexcept { return m_values.empty(); }
+  void clear() { m_values.clear(); }
+
+private:
+
+  /** Local weight values by weights name. */
+  std::map<std::string, CPUMat> m_values;
+
+};
+
+} // namespace callback
+} // namespace lbann
+
+#endif // LBANN_CALLBACKS_WEIGHTS_SNAPSHOT_HPP_INCLUDED
@@ -38,6 +38,7 @@
 #include <Al.hpp>
 #endif // LBANN_HAS_ALUMINUM
 #include "detect_El_mpi.hpp"
+#include "lbann/utils/comm_profile.hpp"
 
 namespace lbann {
 
@@ -85,6 +86,8 @@ struct request {
   mpi_req_type mpi_req = mpi_null_req;
   nccl_req_type nccl_req = nccl_null_req;
   mpicuda_req_type mpicuda_req = mpicuda_null_req;
+  /** Communication profile record (see @c lbann::comm_profile). */
+  uint64_t profile_id = 0;
 };
 
 } // namespace Al
@@ -124,6 +127,28 @@ struct request {
  */
 
 
+/** @brief Algorithm for matrix allreduces. */
+enum class allreduce_algorithm {
+  /** Single allreduce over the whole communicator. */
+  flat,
+  /** Reduce-scatter within each compute node, allreduce of each
+   *  shard across nodes, then allgather within each node. */
+  hierarchical
+};
+
+/** @brief Assignment of processes to trainers. */
+enum class trainer_placement {
+  /** Each trainer is a block of consecutive world ranks. */
+  contiguous,
+  /** Processes are ordered by compute node, then by NUMA domain
+   *  (with hwloc), then by world rank, and each trainer is a block
+   *  in that order. Nodes are taken in natural hostname order
+   *  (node2 before node10), which usually follows rack and switch
+   *  position. Trainers thus span as few nodes and switches as
+   *  possible, however the job launcher ordered the ranks. */
+  topology
+};
+
 /**
  * Manage communication.
  * This supports separate trainers, each of which are split over potentially
@@ -154,6 +179,21 @@ class lbann_comm {
    */
   void split_trainers(int procs_per_trainer);
 
+  /** Set how processes are assigned to trainers by the next
+   *  split_trainers call. */
+  void set_trainer_placement(trainer_placement placement) {
+    m_trainer_placement = placement;
+  }
+  trainer_placement get_trainer_placement() const {
+    return m_trainer_placement;
+  }
+  /** @brief Describe the nodes each trainer runs on.
+   *
+   *  Collective over the world. The description is only returned on
+   *  the world master.
+   */
+  std::string describe_trainer_placement() const;
+
   /** Get which trainer this process is in. */
   inline int get_trainer_rank() const {
     return trainer_rank;
@@ -168,7 +208,8 @@ class lbann_comm {
   }
   /** Return the COMM_WORLD rank of the rank'th processor in trainer. */
   inline int get_world_rank(int trainer, int rank) const {
-    return procs_per_trainer * trainer + rank;
+    const int pos = procs_per_trainer * trainer + rank;
+    return m_placement_order.empty() ? pos : m_placement_order[pos];
   }
   /** Return the rank of the master process in this trainer. */
   inline int get_trainer_master() const {
@@ -236,10 +277,20 @@ class lbann_comm {
 
   /** Reset the number of threads per process to the default. */
   void reset_threads();
+  /** Change the default number of threads per process and apply it. */
+  void set_default_threads_per_proc(int num_threads) {
+    threads_per_proc = num_threads;
+    reset_threads();
+  }
 
   /** Perform a sum reduction of mat over the inter-trainer communicator. */
   void intertrainer_sum_matrix(AbsMat& mat);
   void intertrainer_sum_matrix(AbsDistMat& mat);
+  /** Non-blocking sum reduction of mat over the inter-trainer
+   *  communicator; complete it with @c wait(req). mat must not be
+   *  accessed until then. Blocking without Aluminum. */
+  void nb_intertrainer_sum_matrix(AbsMat& mat, Al::request& req);
+  void nb_intertrainer_sum_matrix(AbsDistMat& mat, Al::request& req);
   /** Broadcast mat over the inter-trainer communicator starting from root. */
   void intertrainer_broadcast_matrix(AbsMat& mat, int root);
   void intertrainer_broadcast_matrix(AbsDistMat& mat, int root);
@@ -426,6 +477,32 @@ class lbann_comm {
     all_gather(src, data, get_trainer_comm());
   }
 
+  /**
+   * All-to-all with per-rank counts over an arbitrary communicator.
+   * Counts are in elements of T and buffers must be in host memory.
+   */
+  template <typename T>
+  void all_to_all(const T* src, const std::vector<int>& src_counts,
+                  T* rcv, const std::vector<int>& rcv_counts,
+                  const El::mpi::Comm& c) {
+    const int procs = El::mpi::Size(c);
+    std::vector<int> src_bytes(procs), src_displs(procs, 0);
+    std::vector<int> rcv_bytes(procs), rcv_displs(procs, 0);
+    for (int i = 0; i < procs; ++i) {
+      src_bytes[i] = src_counts[i] * sizeof(T);
+      rcv_bytes[i] = rcv_counts[i] * sizeof(T);
+      if (i > 0) {
+        src_displs[i] = src_displs[i-1] + src_bytes[i-1];
+        rcv_displs[i] = rcv_displs[i-1] + rcv_bytes[i-1];
+      }
+    }
+    MPI_Alltoallv(src, src_bytes.data(), src_displs.data(), MPI_BYTE,
+                  rcv, rcv_bytes.data(), rcv_displs.data(), MPI_BYTE,
+                  c.GetMPIComm());
+    bytes_sent += src_displs.back() + src_bytes.back();
+    bytes_received += rcv_displs.back() + rcv_bytes.back();
+  }
+
   /** Within-trainer scalar gather (for non-root processes). */
   template <typename T>
   void trainer_gather(T snd, int root) {
@@ -672,13 +749,11 @@ class lbann_comm {
   template <typename T>
   void allreduce(T *snd, int count, T *rcv, const El::mpi::Comm& c, El::mpi::Op op = El::mpi::SUM) {
     auto const size_c = El::mpi::Size(c);
+    comm_profile::blocking_op profile(comm_profile::collective::allreduce,
+                                      count * sizeof(T), size_c, "mpi");
     bytes_sent += count * sizeof(T);
 #ifdef LBANN_HAS_ALUMINUM
-#ifdef LBANN_ALUMINUM_MPI_PASSTHROUGH
-    ::Al::MPIAllreduceAlgorithm algo = ::Al::MPIAllreduceAlgorithm::mpi_passthrough;
-#else
-    ::Al::MPIAllreduceAlgorithm algo = ::Al::MPIAllreduceAlgorithm::automatic;
-#endif
+    const auto algo = get_mpi_allreduce_algorithm();
     ::Al::Allreduce<::Al::MPIBackend>(
         snd, rcv, count, mpi_op_to_al_op(op), c.template GetComm<::Al::MPIBackend>(El::SyncInfo<El::Device::CPU>{}), algo);
 #else
@@ -691,13 +766,11 @@ class lbann_comm {
   template <typename T>
   void allreduce(T *data, int count, const El::mpi::Comm& c, El::mpi::Op op = El::mpi::SUM) {
     auto const size_c = El::mpi::Size(c);
+    comm_profile::blocking_op profile(comm_profile::collective::allreduce,
+                                      count * sizeof(T), size_c, "mpi");
     bytes_sent += count * sizeof(T);
 #ifdef LBANN_HAS_ALUMINUM
-#ifdef LBANN_ALUMINUM_MPI_PASSTHROUGH
-    ::Al::MPIAllreduceAlgorithm algo = ::Al::MPIAllreduceAlgorithm::mpi_passthrough;
-#else
-    ::Al::MPIAllreduceAlgorithm algo = ::Al::MPIAllreduceAlgorithm::automatic;
-#endif
+    const auto algo = get_mpi_allreduce_algorithm();
     ::Al::Allreduce<::Al::MPIBackend>(
       data, count, mpi_op_to_al_op(op), c.template GetComm<::Al::MPIBackend>(El::SyncInfo<El::Device::CPU>{}), algo);
 #else
@@ -745,14 +818,63 @@ class lbann_comm {
 #ifdef LBANN_HAS_ALUMINUM
     bytes_sent += count * sizeof(T);
     req.mpi_req = Al::mpi_null_req;
+    req.profile_id = comm_profile::launch_begin(
+      comm_profile::collective::nb_allreduce, count * sizeof(T),
+      El::mpi::Size(c), "mpi");
     ::Al::NonblockingAllreduce<::Al::MPIBackend>(
-      data, count, mpi_op_to_al_op(op), c.template GetComm<::Al::MPIBackend>(El::SyncInfo<El::Device::CPU>{}), req.mpi_req);
+      data, count, mpi_op_to_al_op(op), c.template GetComm<::Al::MPIBackend>(El::SyncInfo<El::Device::CPU>{}), req.mpi_req,
+      get_mpi_allreduce_algorithm());
+    comm_profile::launch_end(req.profile_id);
     bytes_received += count * sizeof(T) * (El::mpi::Size(c) - 1);
 #else
     allreduce(data, count, c, op);
 #endif  // LBANN_HAS_ALUMINUM
   }
 
+  /** @brief Set the algorithm for matrix allreduces.
+   *
+   *  The hierarchical algorithm is only used for messages of at
+   *  least @c min_bytes over communicators that span several compute
+   *  nodes with the same number of processes on each. It is blocking,
+   *  even when called through @c nb_allreduce.
+   */
+  void set_allreduce_algorithm(allreduce_algorithm algo,
+                               size_t min_bytes = 1 << 20) {
+    m_allreduce_algorithm = algo;
+    m_hierarchical_allreduce_min_bytes = min_bytes;
+  }
+  allreduce_algorithm get_allreduce_algorithm() const {
+    return m_allreduce_algorithm;
+  }
+
+  /** @brief Make allreduces sum in the same order on every run.
+   *
+   *  Host allreduces use Aluminum's ring algorithm instead of letting
+   *  Aluminum or MPI pick one by message size and timing. GPU
+   *  allreduces already have a fixed order for a given communicator
+   *  and message size (NCCL, or host transfer with MPI-CUDA).
+   */
+  void set_deterministic_reductions(bool flag) {
+    m_deterministic_reductions = flag;
+  }
+  bool get_deterministic_reductions() const {
+    return m_deterministic_reductions;
+  }
+
+#ifdef LBANN_HAS_ALUMINUM
+  /** @brief Aluminum algorithm for host allreduces. */
+  ::Al::MPIAllreduceAlgorithm get_mpi_allreduce_algorithm() const {
+    if (m_deterministic_reductions) {
+      return ::Al::MPIAllreduceAlgorithm::mpi_ring;
+    }
+#ifdef LBANN_ALUMINUM_MPI_PASSTHROUGH
+    return ::Al::MPIAllreduceAlgorithm::mpi_passthrough;
+#else
+    return ::Al::MPIAllreduceAlgorithm::automatic;
+#endif // LBANN_ALUMINUM_MPI_PASSTHROUGH
+  }
+#endif // LBANN_HAS_ALUMINUM
+
   /** Wait for a all non-blocking requests to complete. */
   template <typename T>
   void wait_all(std::vector<El::mpi::Request<T>>& req) {
@@ -921,6 +1043,8 @@ class lbann_comm {
                 El::SyncInfo<D> const& syncInfo) {
     bytes_sent += sizeof(T) * send_count;
     bytes_received += sizeof(T) * recv_count;
+    comm_profile::blocking_op profile(comm_profile::collective::sendrecv,
+                                      sizeof(T) * send_count, 2, "mpi");
     El::mpi::SendRecv(snd, send_count, get_world_rank(send_trainer, send_rank),
                       rcv, recv_count, get_world_rank(recv_trainer, recv_rank),
                       get_world_comm(), syncInfo);
@@ -965,6 +1089,17 @@ class lbann_comm {
   inline size_t get_bytes_received() const {
     return bytes_received;
   }
+  /** Return the host time (seconds) spent blocked in matrix
+   *  allreduces, waits on non-blocking requests and barriers.
+   *
+   *  This accumulates from construction and is not cleared by
+   *  reset_stats_counters, so callers should difference it. GPU
+   *  collectives that do not block the host contribute only their
+   *  launch cost.
+   */
+  inline double get_wait_time() const {
+    return wait_time;
+  }
 
   inline void reset_stats_counters() {
     num_trainer_barriers = 0;
@@ -1038,6 +1173,27 @@ class lbann_comm {
   El::mpi::Comm node_comm;
   /** Packed group communicators. */
   mutable std::unordered_map<int, El::mpi::Comm> group_communicators;
+  /** Communicators for hierarchical allreduces. */
+  struct hierarchical_comms {
+    hierarchical_comms(MPI_Comm local_comm, MPI_Comm cross_comm, bool use)
+      : local(local_comm), cross(cross_comm), usable(use) {}
+    /** Processes of the parent communicator on this compute node. */
+    El::mpi::Comm local;
+    /** Processes of the parent communicator with the same rank in
+     *  @c local. */
+    El::mpi::Comm cross;
+    /** Whether the parent communicator spans several nodes with the
+     *  same number of processes on each. */
+    bool usable;
+  };
+  /** Hierarchical allreduce communicators, keyed by parent. */
+  std::unordered_map<MPI_Comm, hierarchical_comms> hierarchical_communicators;
+  /** Algorithm for matrix allreduces. */
+  allreduce_algorithm m_allreduce_algorithm = allreduce_algorithm::flat;
+  /** Smallest message for the hierarchical allreduce. */
+  size_t m_hierarchical_allreduce_min_bytes = 1 << 20;
+  /** Whether allreduces use fixed-order algorithms. */
+  bool m_deterministic_reductions = false;
   /** Grid for this trainer. */
   Grid *grid;
   /** Number of trainers. */
@@ -1048,6 +1204,12 @@ class lbann_comm {
   int trainer_rank;
   /** Rank of this process within its trainer. */
   int rank_in_trainer;
+  /** Assignment of processes to trainers. */
+  trainer_placement m_trainer_placement = trainer_placement::contiguous;
+  /** World ranks in placement order: trainer t holds positions
+   *  [t*procs_per_trainer, (t+1)*procs_per_trainer). Empty for the
+   *  contiguous placement. */
+  std::vector<int> m_placement_order;
   /** Number of processers per compute node. */
   int procs_per_node;
   /** Rank of this process within its compute node. */
@@ -1067,10 +1229,19 @@ class lbann_comm {
   size_t num_global_barriers;
   size_t bytes_sent;
   size_t bytes_received;
+  double wait_time = 0.0;
 
   /** Setup communicator for processes in the same compute node. */
   void setup_node_comm();
 
+  /** Get communicators for a hierarchical allreduce over @c c.
+   *
+   *  Returns null if a flat allreduce should be used. Must be called
+   *  by all processes in @c c the first time.
+   */
+  const hierarchical_comms* get_hierarchical_comms(const El::mpi::Comm& c,
+                                                   size_t bytes);
+
   /** Initialize the default number of threads per process.
    *  This is the number of OpenMP threads to use for parallel
    *  regions, provided omp_set_num_threads has not been called or the
@@ -1114,6 +1285,8 @@ void lbann_comm::broadcast(const int root, T* data, const int count, const El::m
   const int size = static_cast<int>(S? count : sizeof(T)*count);
   // Avoid linking error from uninstantiated El::mpi routine if !S by converting T to El::byte
   using TT = typename interpret_as_byte_if_needed<S, T>::type;
+  comm_profile::blocking_op profile(comm_profile::collective::broadcast,
+                                    sizeof(T)*count, El::mpi::Size(c), "mpi");
   El::mpi::Broadcast<TT>(reinterpret_cast<TT*>(data), size, root, c, syncInfo);
   count_bytes_broadcast(sizeof(T)*count, rank_c, root);
 }
@@ -107,6 +107,15 @@ class data_coordinator {
 
   void setup(int max_mini_batch_size);
 
+  /** @brief Repartition the data after the trainers are regrouped
+   *
+   *  Collective over the world; call after lbann_comm::split_trainers
+   *  has changed the number of processes per trainer. The data
+   *  readers are given their new ranks and strides, and their data
+   *  stores are rebalanced in memory.
+   */
+  void resize_trainer();
+
   /** Check to see if there is a valid training context for the data coordinator */
   bool has_valid_execution_context() const {
     return (m_execution_context != nullptr);
@@ -196,6 +205,7 @@ class data_coordinator {
     DataReaderMetaData drm;
     drm.data_dims = get_data_dims();
     drm.slice_points = get_slice_points();
+    drm.effective_length = m_effective_length;
     return drm;
   }
 
@@ -273,6 +283,16 @@ class data_coordinator {
   //
   //************************************************************************
 
+  /** @brief Number of mini-batches the input layers fetch ahead
+   *
+   *  Set with --prefetch_depth (default 1). Each input layer keeps a
+   *  ring of prefetch_depth+1 pre-allocated I/O buffers, so at most
+   *  this many mini-batches are fetched before they are consumed;
+   *  deeper rings absorb transient I/O latency at the cost of host
+   *  memory. Prefetching never crosses the end of an epoch.
+   */
+  static int get_prefetch_depth();
+
   void calculate_num_iterations_per_epoch(int max_mini_batch_size, generic_data_reader *data_reader);
   void calculate_num_iterations_per_epoch(int mini_batch_size);
 
@@ -330,19 +350,12 @@ class data_coordinator {
         (it->second)->load_from_checkpoint_shared(p, execution_mode::validation);
       }
 
-      std::string buf;
       if (this->m_comm->am_trainer_master()) {
         read_cereal_archive<data_coordinator>(*this, p, execution_mode::training, "_dc.xml");
-        buf = create_cereal_archive_binary_string<data_coordinator>(*this);
       }
 
-      // TODO: this assumes homogeneous processors
       // broadcast state from rank 0
-      this->m_comm->trainer_broadcast(0, buf);
-
-      if (!this->m_comm->am_trainer_master()) {
-        unpack_cereal_archive_binary_string<data_coordinator>(*this, buf);
-      }
+      broadcast_cereal_archive_binary<data_coordinator>(*this, *this->m_comm);
     }
 
     return true;
@@ -403,6 +416,8 @@ class data_coordinator {
   dataset m_validation_dataset;
 
   data_reader_map_t m_data_readers;
+  /** Effective length of the current mini-batch; see DataReaderMetaData */
+  std::shared_ptr<int> m_effective_length = std::make_shared<int>(0);
  //  std::map<execution_mode, dataset_stats> m_dataset_stats;
 public:  // @todo BVE FIXME
   bool m_data_set_processed;
@@ -31,6 +31,7 @@
 
 #include "lbann/utils/enum_iterator.hpp"
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -57,6 +58,12 @@ using slice_points_mode_iterator = enum_iterator<slice_points_mode, slice_points
 struct DataReaderMetaData {
   TargetModeDimMap data_dims;
   SPModeSlicePoints slice_points;
+  /** Padded sequence length the current mini-batch actually needs, when
+   *  the reader buckets samples by length (--bucket_by_length); 0 when
+   *  every sample uses the full data dims. The input layer updates it
+   *  each forward prop; layers may keep the pointer to shrink their work.
+   */
+  std::shared_ptr<int> effective_length;
 };
 
 } // namespace lbann
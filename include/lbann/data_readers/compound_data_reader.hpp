@@ -106,6 +106,18 @@ class generic_compound_data_reader : public generic_data_reader {
     }
   }
 
+  /** Subsidiary readers share the I/O thread pool and set up their
+   *  per-thread state. Samples are only drawn from this reader's
+   *  indices, so subsidiary readers are not shuffled.
+   */
+  void setup(int num_io_threads, observer_ptr<thread_pool> io_thread_pool) override {
+    generic_data_reader::setup(num_io_threads, io_thread_pool);
+    for (auto&& reader : m_data_readers) {
+      reader->set_shuffle(false);
+      reader->setup(num_io_threads, io_thread_pool);
+    }
+  }
+
   /// needed to support data_store_merge_samples
   std::vector<generic_data_reader*> & get_data_readers() {
     return m_data_readers;
@@ -114,6 +126,17 @@ class generic_compound_data_reader : public generic_data_reader {
   //************************************************************************
 
  protected:
+  void preprocess_data_source(int tid) override {
+    for (auto&& reader : m_data_readers) {
+      reader->preprocess_data_source(tid);
+    }
+  }
+  void postprocess_data_source(int tid) override {
+    for (auto&& reader : m_data_readers) {
+      reader->postprocess_data_source(tid);
+    }
+  }
+
   /// List of readers providing data.
   std::vector<generic_data_reader*> m_data_readers;
 };
@@ -45,10 +45,16 @@
 #include <vector>
 #include <unistd.h>
 #include <unordered_set>
+#include <functional>
+#include <memory>
 #include <cereal/types/utility.hpp>
 #include <cereal/types/unordered_map.hpp>
 #include <cereal/types/vector.hpp>
 
+namespace conduit {
+class Node;
+}
+
 #define NOT_IMPLEMENTED(n) { \
   std::stringstream s; \
   s << "the method " << n << " has not been implemented"; \
@@ -108,14 +114,19 @@ class generic_data_reader {
   generic_data_reader(const generic_data_reader&) = default;
   generic_data_reader& operator=(const generic_data_reader&) = default;
 
-  virtual ~generic_data_reader() {}
+  virtual ~generic_data_reader();
   virtual generic_data_reader* copy() const = 0;
 
-  /** Archive for checkpoint and restart */
+  /** Archive for checkpoint and restart
+   *
+   *  The shuffled indices are not stored. They are regenerated from
+   *  the shuffle seed and count (see regenerate_shuffled_indices).
+   */
   template <class Archive> void serialize( Archive & ar ) {
     ar(CEREAL_NVP(m_current_mini_batch_idx),
        CEREAL_NVP(m_current_pos),
-       CEREAL_NVP(m_shuffled_indices));
+       CEREAL_NVP(m_shuffle_seed),
+       CEREAL_NVP(m_shuffle_count));
   }
 
   /// set the comm object
@@ -290,6 +301,21 @@ class generic_data_reader {
 
   /// Fetch this mini-batch's samples into X.
   virtual int fetch_data(CPUMat& X, El::Matrix<El::Int>& indices_fetched);
+#ifdef LBANN_HAS_GPU
+  /**
+   * Whether this reader can decode samples straight into device
+   * memory with fetch_data_on_device().
+   */
+  virtual bool supports_device_fetch() const { return false; }
+  /**
+   * Fetch this mini-batch's samples into device matrix X, with the
+   * work queued on stream. Labels and responses are still fetched on
+   * the host.
+   */
+  int fetch_data_on_device(El::Matrix<DataType, El::Device::GPU>& X,
+                           El::Matrix<El::Int>& indices_fetched,
+                           cudaStream_t stream);
+#endif // LBANN_HAS_GPU
   /// Fetch this mini-batch's labels into Y.
   virtual int fetch_labels(CPUMat& Y);
   /// Fetch this mini-batch's responses into Y.
@@ -360,7 +386,7 @@ class generic_data_reader {
   /// True if the data reader's current position is not valid but within # ranks per model
   /// of the end of the data set (e.g. it is a rank with no valid data on the last iteration)
   virtual bool position_is_overrun() const {
-    int end_pos = (int)m_shuffled_indices.size();
+    int end_pos = get_num_data();
     return (m_current_pos >= end_pos && (m_current_pos - end_pos) < m_comm->get_procs_per_trainer());
   }
   /// True if the data reader is at the start of an epoch.
@@ -376,6 +402,17 @@ class generic_data_reader {
   int get_mini_batch_size() const {
     return m_mini_batch_size;
   }
+  /** @brief Temporarily move the loading position k mini-batches ahead
+   *
+   *  Moves the position as k calls to update() would, but without
+   *  their end-of-epoch side effects, so that a mini-batch beyond the
+   *  next one can be fetched. Returns false, without moving, if that
+   *  would pass the end of the epoch. end_lookahead() restores the
+   *  position. The caller must hold the data coordinator's dr_mutex.
+   */
+  bool begin_lookahead(int k);
+  /// Restore the position saved by begin_lookahead()
+  void end_lookahead();
   /// Get the loaded mini-batch size
   int get_loaded_mini_batch_size() const;
   /// Get the current mini-batch size.
@@ -521,6 +558,14 @@ class generic_data_reader {
   virtual int get_num_data() const {
     return (int)m_shuffled_indices.size();
   }
+  /** @brief Padded length the mini-batch holding these samples needs.
+   *
+   *  With --bucket_by_length, each mini-batch is formed from samples of
+   *  similar length, and this returns the longest sample length in the
+   *  whole (global) mini-batch, which is the same on every rank. Returns
+   *  0 when the reader is not bucketing.
+   */
+  int get_effective_length(const El::Matrix<El::Int>& indices) const;
   /// Get the number of unused samples in this dataset.
   int get_num_unused_data() const {
     return (int)m_unused_indices.size();
@@ -661,6 +706,40 @@ class generic_data_reader {
     m_transform_pipeline = std::move(tp);
   }
 
+  /** Whether the reader can read only part of each sample (see
+   *  set_spatial_partition). */
+  virtual bool supports_spatial_partitions() const { return false; }
+
+  /**
+   * Read only one partition of each sample, for spatially-parallel
+   * input (see dc::is_spatial_parallel_io_enabled). Samples are split
+   * into num_partitions equal slabs along their outermost spatial
+   * dimension (the depth of a C x D x H x W volume) and only slab
+   * index is read, so each process of a spatially partitioned input
+   * layer reads its own sub-volume instead of whole samples that are
+   * then shuffled. The sample dimensions are unchanged. Slabs are
+   * packed from the start of the fetch buffer, one after another in
+   * mini-batch order, which is the layout of the local sub-volumes.
+   * Must be called before load().
+   */
+  void set_spatial_partition(int num_partitions, int index) {
+    if (num_partitions < 1 || index < 0 || index >= num_partitions) {
+      LBANN_ERROR("invalid spatial partition ", index,
+                  " of ", num_partitions);
+    }
+    if (num_partitions > 1 && !supports_spatial_partitions()) {
+      LBANN_ERROR(get_type(), " cannot read partial samples");
+    }
+    m_num_spatial_partitions = num_partitions;
+    m_spatial_partition = index;
+  }
+  int get_num_spatial_partitions() const noexcept {
+    return m_num_spatial_partitions;
+  }
+  int get_spatial_partition() const noexcept {
+    return m_spatial_partition;
+  }
+
  protected:
 
   // For use with conduit when samples are corrupt.
@@ -690,6 +769,34 @@ class generic_data_reader {
 
   virtual bool fetch_data_block(CPUMat& X, El::Int thread_index, El::Int mb_size, El::Matrix<El::Int>& indices_fetched);
 
+  /**
+   * True if fetch_datum writes the output of the transform pipeline
+   * to the whole column of X, so that fetch_data_block can apply the
+   * pipeline's batchable transforms to each chunk of columns at once.
+   */
+  virtual bool supports_batched_transforms() const { return false; }
+
+  /**
+   * Called by fetch_data_block before columns [begin, end) of the
+   * mini-batch are fetched, on the thread that fetches them, so a
+   * reader can issue the file reads of the whole chunk at once.
+   */
+  virtual void prefetch_data_chunk(size_t begin, size_t end) {}
+
+#ifdef LBANN_HAS_GPU
+  /**
+   * Fetch the first mb_size samples from the current position into
+   * columns of X on the device; called by fetch_data_on_device().
+   */
+  virtual bool fetch_data_block_on_device(El::Matrix<DataType, El::Device::GPU>& X,
+                                          El::Int mb_size,
+                                          El::Matrix<El::Int>& indices_fetched,
+                                          cudaStream_t stream) {
+    NOT_IMPLEMENTED("fetch_data_block_on_device");
+    return false;
+  }
+#endif // LBANN_HAS_GPU
+
   /**
    * Fetch a single sample into a matrix.
    * @param X The matrix to load data into.
@@ -732,13 +839,43 @@ class generic_data_reader {
    */
   virtual void postprocess_data_source(int tid) {};
 
-  /// Shuffle indices (uses the data_seq_generator)
+  /** @brief Sample index at position @c pos of the epoch.
+   *
+   *  Readers that do not enumerate their samples up front (see
+   *  data_reader_stream) override this and get_num_data().
+   */
+  virtual int get_shuffled_index(int pos) const { return m_shuffled_indices[pos]; }
+
+  /** @brief Length of a variable-length sample, e.g. its token count.
+   *
+   *  Used by --bucket_by_length; readers of fixed-size samples leave the
+   *  default, which returns -1 and disables bucketing.
+   */
+  virtual int get_sample_length(int data_id) const { return -1; }
+
+  /** @brief Shuffle indices for the next epoch.
+   *
+   *  Each shuffle starts over from the sorted indices with a
+   *  generator seeded by the reader's shuffle seed and the number of
+   *  shuffles so far. The seed is drawn from the data_seq_generator
+   *  at the first shuffle.
+   */
   virtual void shuffle_indices();
+  /** @brief Recompute the order of the last shuffle.
+   *
+   *  Used after restoring the shuffle seed and count from a
+   *  checkpoint, since the indices themselves are not stored.
+   */
+  void regenerate_shuffled_indices();
   /// Shuffle indices and profide a random number generator
   virtual void shuffle_indices(rng_gen& gen);
 
   int m_mini_batch_size;
   int m_current_pos;
+  /// Number of slabs each sample is split into (see set_spatial_partition)
+  int m_num_spatial_partitions = 1;
+  /// Slab of each sample that is read
+  int m_spatial_partition = 0;
   /// Batch Stride is typically batch_size, but may be a multiple of batch size if there are multiple readers
   int m_stride_to_next_mini_batch;
   /// If there are multiple instances of the reader,
@@ -755,6 +892,16 @@ class generic_data_reader {
   int m_iteration_stride;
 
   std::vector<int> m_shuffled_indices;
+  /// Seed of the per-epoch shuffle generators
+  uint32_t m_shuffle_seed = 0;
+  /// Number of times the indices have been shuffled
+  uint64_t m_shuffle_count = 0;
+  /// With rank-local shards, rank r's samples are the indices in
+  /// [m_shard_offsets[r], m_shard_offsets[r+1]), and preloading the data
+  /// store gives each rank its own shard; empty otherwise
+  std::vector<int> m_shard_offsets;
+  /// Effective length of each sample's mini-batch (--bucket_by_length)
+  std::vector<int> m_bucket_lengths;
   /// Record of the indicies that are not being used for training
   std::vector<int> m_unused_indices;
 
@@ -764,6 +911,10 @@ class generic_data_reader {
   int m_reset_mini_batch_index;
   /// The index of the current mini-batch that has been loaded
   int m_loaded_mini_batch_idx;
+  /// Positions saved by begin_lookahead()
+  int m_saved_current_pos = 0;
+  int m_saved_current_mini_batch_idx = 0;
+  int m_saved_loaded_mini_batch_idx = 0;
   /// The index of the current mini-batch that is being processed (train/test/validate)
   int m_current_mini_batch_idx;
   int m_num_iterations_per_epoch; /// How many iterations all readers will execute
@@ -804,16 +955,64 @@ class generic_data_reader {
    */
   size_t get_num_indices_to_use() const;
 
+  friend class generic_compound_data_reader;
   friend class data_reader_merge_features;
   friend class data_reader_merge_samples;
 
 private:
 
+  /** Reorder m_shuffled_indices so each mini-batch holds samples of
+   *  similar length: windows of --bucket_window mini-batches are sorted
+   *  by length and cut into mini-batches, whose order is then shuffled.
+   *  A trailing partial mini-batch stays last. */
+  void bucket_by_length(rng_gen& gen);
+
+  /** Starts loading the samples this rank fetches in the first epoch
+   *  into the data store, on a background thread and in the order they
+   *  will be fetched; see --data_store_background_preload. */
+  void start_background_preload();
+
+  /** Stops and joins the background preload, and rethrows its error. */
+  void finish_background_preload();
+
+  /// State of the background preload; readers are copied before
+  /// it starts
+  struct background_preload_state;
+  std::shared_ptr<background_preload_state> m_background_preload;
+
   virtual void do_preload_data_store() {
     LBANN_ERROR("Not implemented.");
   }
 
  protected :
+  /** @brief Loads the samples this rank owns into the data store, in parallel
+   *
+   * For use in do_preload_data_store(), by readers that only need to
+   * load each owned sample: 'loader(data_id, node)' must fill in 'node'
+   * for the data_id, and must be thread safe. The node is reused for
+   * the samples loaded by a thread, so the loader should reset it.
+   * Samples are handed out one at a time, so threads that get cheap
+   * samples are not left idle, and at most min(number of I/O threads,
+   * --data_store_preload_max_in_flight=<n>) samples are being read at
+   * once. Progress is reported on the trainer master. Samples are loaded
+   * serially when the cmd line flag --data_store_no_thread is passed.
+   */
+  void parallel_preload_data_store(const std::function<void(int, conduit::Node&)> &loader);
+
+  /** @brief Returns true if the reader implements load_data_store_node() */
+  virtual bool supports_background_preload() const { return false; }
+
+  /** @brief Loads one sample for the background preload
+   *
+   * Fills in 'node' as fetch_datum() stores the sample in the data
+   * store while priming it, and must be thread safe. For readers that
+   * support --data_store_background_preload; see
+   * supports_background_preload().
+   */
+  virtual void load_data_store_node(int data_id, conduit::Node& node) {
+    LBANN_ERROR("Not implemented.");
+  }
+
   //var to support GAN
   bool m_gan_labelling; //boolean flag of whether its GAN binary label, default is false
   int m_gan_label_value; //zero(0) or 1 label value for discriminator, default is 0
@@ -30,6 +30,9 @@
 #define LBANN_DATA_READER_CIFAR10_HPP
 
 #include "data_reader_image.hpp"
+#include "lbann/utils/mapped_file.hpp"
+
+#include <memory>
 
 namespace lbann {
 
@@ -39,6 +42,8 @@ namespace lbann {
  * This requires the binary distributions of the datasets, which
  * must retain their original filenames.
  * CIFAR-10 vs -100 is inferred by the number of labels set.
+ * The files are memory-mapped read-only, so processes on a node share
+ * one copy in the page cache; reader copies share the mappings.
  * @note This does not store the coarse labels from CIFAR-100.
  *
  * See:
@@ -64,16 +69,21 @@ class cifar10_reader : public image_data_reader {
  protected:
   void set_defaults() override;
   bool fetch_datum(CPUMat& X, int data_id, int mb_idx) override;
+  bool supports_batched_transforms() const override { return true; }
   bool fetch_label(CPUMat& Y, int data_id, int mb_idx) override;
 
  private:
-  /**
-   * Loaded image data.
-   * This will be stored in "OpenCV" format for ease of preprocessing.
-   */
-  std::vector<std::vector<unsigned char>> m_images;
-  /** Loaded label information. */
-  std::vector<uint8_t> m_labels;
+  /** Start of the record (label bytes, then planar RGB) of a sample. */
+  const uint8_t* get_record(int data_id) const;
+
+  /** Memory-mapped dataset files, in sample order. */
+  std::vector<std::shared_ptr<mapped_file>> m_files;
+  /** Number of records in each file. */
+  size_t m_images_per_file = 0;
+  /** Bytes per record: the label bytes and the image. */
+  size_t m_record_size = 0;
+  /** Offset of the label used within a record. */
+  size_t m_label_offset = 0;
 };
 
 }  // namespace lbann
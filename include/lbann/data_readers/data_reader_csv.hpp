@@ -30,6 +30,8 @@
 #define LBANN_DATA_READER_CSV_HPP
 
 #include "data_reader.hpp"
+#include "lbann/utils/mapped_file.hpp"
+#include <memory>
 #include <unordered_map>
 
 namespace lbann {
@@ -39,6 +41,9 @@ namespace lbann {
  * This will parse a header to determine how many columns of data there are, and
  * will return each row split based on a separator. This does not handle quotes
  * or escape sequences. The label column is by default converted to an integer.
+ * With --csv_mmap, the file is memory-mapped: the line index is built by
+ * scanning chunks in parallel (or read from --csv_index_file, which is
+ * written on the first run), and samples are parsed in place.
  * @note This does not currently support comments or blank lines.
  */
 class csv_reader : public generic_data_reader {
@@ -150,6 +155,15 @@ class csv_reader : public generic_data_reader {
   /// Initialize the ifstreams vector.
   void setup_ifstreams();
 
+  /** Set the column count and the label/response columns from the
+   *  first line of the file. */
+  void parse_header_line(const std::string& line);
+  /** Build the line index, labels and responses from the mapped file.
+   *  Counterpart of the ifstream scan in load(). */
+  void build_mapped_index(std::vector<long long>& index);
+  /// Parse the line of data_id in the mapped file straight into X.
+  void fetch_mapped_datum(CPUMat& X, int data_id, int mb_idx);
+
   /** Return a raw line from the CSV file.
    *  (Made public to support data store functionality)
    */
@@ -183,6 +197,8 @@ class csv_reader : public generic_data_reader {
   int m_num_labels = 0;
   /// Input file streams (per-thread).
   std::vector<std::ifstream*> m_ifstreams;
+  /// The mapped file with --csv_mmap, shared by copies of this reader.
+  std::shared_ptr<mapped_file> m_file;
   /**
    * Index mapping lines (samples) to their start offset within the file.
    * This excludes the header, but includes a final entry indicating the length
@@ -31,6 +31,9 @@
 
 #include "data_reader.hpp"
 #include "lbann/data_store/data_store_conduit.hpp"
+#include "lbann/data_readers/decoded_image_cache.hpp"
+
+#include <memory>
 
 namespace lbann {
 class image_data_reader : public generic_data_reader {
@@ -106,6 +109,17 @@ class image_data_reader : public generic_data_reader {
   bool fetch_label(Mat& Y, int data_id, int mb_idx) override;
   void set_linearized_image_size();
 
+  /** @brief Read only this rank's shard of the image list (--image_list_shards).
+   *
+   *  Rank r in the trainer reads <list>.p<r>, as written by
+   *  tools/partition_input_list. Shard sizes and labels are exchanged
+   *  so every rank can index and label the whole dataset, but image
+   *  paths are kept for the local shard only: the data store is
+   *  preloaded with each rank owning its shard, and serves samples to
+   *  the other ranks, so no rank opens another shard's files.
+   */
+  void load_list_shard(const std::string& list_file);
+
   std::string m_image_dir; ///< where images are stored
   std::vector<sample_t> m_image_list; ///< list of image files and labels
   int m_image_width; ///< image width
@@ -113,8 +127,10 @@ class image_data_reader : public generic_data_reader {
   int m_image_num_channels; ///< number of image channels
   int m_image_linearized_size; ///< linearized image size
   int m_num_labels; ///< number of labels
-
-  bool  load_conduit_nodes_from_file(const std::unordered_set<int> &data_ids);
+  /// Decoded images, after the deterministic transforms, sized with
+  /// --decoded_image_cache_mb; shared by copies of this reader, which
+  /// index the same image list.
+  std::shared_ptr<decoded_image_cache> m_decoded_cache;
 
 };
 
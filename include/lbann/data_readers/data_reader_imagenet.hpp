@@ -45,10 +45,45 @@ class imagenet_reader : public image_data_reader {
     return "imagenet_reader";
   }
 
+  void setup(int num_io_threads, observer_ptr<thread_pool> io_thread_pool) override;
+
+#ifdef LBANN_HAS_NVJPEG
+  /**
+   * Samples are decoded with nvJPEG and transformed on the GPU when
+   * --gpu_image_decode is given and the transform pipeline can be fused.
+   */
+  bool supports_device_fetch() const override;
+#endif // LBANN_HAS_NVJPEG
+
  protected:
   void set_defaults() override;
   virtual CPUMat create_datum_view(CPUMat& X, const int mb_idx) const;
   bool fetch_datum(CPUMat& X, int data_id, int mb_idx) override;
+  bool supports_batched_transforms() const override { return true; }
+  /** With --async_file_reads and no data store, read the files of the
+   *  chunk together with a file::batch_file_reader. */
+  void prefetch_data_chunk(size_t begin, size_t end) override;
+  /** Load and decode the image of data_id, from the data store if it
+   *  is in use, otherwise from its file. */
+  void decode_datum(int data_id, El::Matrix<uint8_t>& image,
+                    std::vector<size_t>& dims);
+  /** Decode the image of data_id if prefetch_data_chunk read it into
+   *  column mb_idx on this thread.
+   *  @return Whether the image was prefetched. */
+  bool decode_prefetched(int data_id, int mb_idx, El::Matrix<uint8_t>& image,
+                         std::vector<size_t>& dims);
+#ifdef LBANN_HAS_NVJPEG
+  bool fetch_data_block_on_device(El::Matrix<DataType, El::Device::GPU>& X,
+                                  El::Int mb_size,
+                                  El::Matrix<El::Int>& indices_fetched,
+                                  cudaStream_t stream) override;
+  /** Get the node holding the encoded image, from the data store if
+   *  it is in use, otherwise from the file. */
+  void get_encoded_image(int data_id, conduit::Node& node);
+#endif // LBANN_HAS_NVJPEG
+
+  /** Whether files are read a chunk at a time (--async_file_reads). */
+  bool m_async_file_reads = false;
 };
 
 }  // namespace lbann
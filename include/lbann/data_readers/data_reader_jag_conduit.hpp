@@ -357,6 +357,15 @@ class data_reader_jag_conduit : public generic_data_reader {
    *  the data_store (if --use_data_store) and return false.
    */
   bool load_conduit_node(const size_t i, const std::string& key, conduit::Node& node) const;
+  /**
+   * Read every field that the variables in vars need for sample i into
+   * sample, at the paths the get_* accessors look them up. Scalars and
+   * inputs are read one group per call rather than one key per call.
+   * Fields that cannot be read are left empty, so the accessors fall
+   * back to load_conduit_node and its error handling.
+   */
+  void read_sample_fields(const size_t i, const std::vector<variable_t>& vars,
+                          conduit::Node& sample) const;
   /// Check if a key exist for sample i
   bool has_conduit_path(const size_t i, const std::string& key) const;
 
@@ -457,6 +466,34 @@ class data_reader_jag_conduit : public generic_data_reader {
   int m_cached_response_mb_size;
   int m_cached_label_mb_size;
 
+  /**
+   * Dense per-sample copies of one kind of normalized variable, filled on
+   * first fetch, so later fetches are a memcpy without conduit lookups.
+   * Each sample is fetched by one I/O thread at a time, and samples own
+   * disjoint slots, so no locking is needed.
+   */
+  struct variable_cache {
+    variable_cache(size_t num_samples, size_t width)
+      : m_width(width), m_values(num_samples * width), m_filled(num_samples, 0) {}
+    /// Copy sample data_id into column mb_idx of X if it is cached
+    bool get(CPUMat& X, size_t data_id, int mb_idx) const;
+    /// Cache column mb_idx of X as sample data_id
+    void put(const CPUMat& X, size_t data_id, int mb_idx);
+    bool has(size_t data_id) const { return m_filled[data_id] != 0; }
+
+    size_t m_width;
+    std::vector<DataType> m_values;
+    std::vector<char> m_filled;
+  };
+  /// Create the variable caches if requested (--jag_variable_cache)
+  void setup_variable_caches();
+  /// Whether every variable in vars can be fetched from the caches
+  bool are_variables_cached(size_t data_id, const std::vector<variable_t>& vars) const;
+  /// Cached scalar outputs, shared by copies of this reader
+  std::shared_ptr<variable_cache> m_scalar_cache;
+  /// Cached inputs, shared by copies of this reader
+  std::shared_ptr<variable_cache> m_input_cache;
+
   /// temporary normalization parameters based on linear transforms
   std::vector<linear_transform_t> m_image_normalization_params;
   std::vector<linear_transform_t> m_scalar_normalization_params;
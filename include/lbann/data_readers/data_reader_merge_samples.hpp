@@ -83,6 +83,11 @@ class data_reader_merge_samples : public generic_compound_data_reader {
   /// Partial sums of the number of samples in each reader.
   std::vector<int> m_num_samples_psum;
 
+  /** Find the reader holding a sample.
+   *  @c data_id is converted to an index within that reader.
+   */
+  generic_data_reader& get_reader(int& data_id) const;
+
   /// code common to both load() and load_using_data_store()
   void setup_indices(int num_samples);
 
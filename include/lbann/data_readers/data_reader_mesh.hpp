@@ -30,6 +30,7 @@
 #define LBANN_DATA_READER_MESH_HPP
 
 #include "data_reader.hpp"
+#include "conduit/conduit.hpp"
 
 namespace lbann {
 
@@ -38,6 +39,12 @@ namespace lbann {
  * Provide the directory containing all the channel subdirectories.
  * This assumes the data is stored as floats in row-major order.
  * The channels to load are currently hardcoded. This only supports regression.
+ *
+ * The channel files of a sample are read together, or a sample is read
+ * from one packed file holding its channels and then its target, if
+ * every sample has one. With --mesh_pack_channels, the packed files are
+ * written at load time when they are missing. Samples can be preloaded
+ * into the data store.
  */
 class mesh_reader : public generic_data_reader {
  public:
@@ -77,20 +84,33 @@ class mesh_reader : public generic_data_reader {
   bool fetch_datum(CPUMat& X, int data_id, int mb_idx) override;
   bool fetch_response(CPUMat& Y, int data_id, int mb_idx) override;
 
+  void do_preload_data_store() override;
+  /// Fill node with the sample's channels and target, as in the files.
+  void load_conduit_node(int data_id, conduit::Node& node);
+
+  bool supports_background_preload() const override { return true; }
+  void load_data_store_node(int data_id, conduit::Node& node) override {
+    load_conduit_node(data_id, node);
+  }
+
   /**
-   * Load filename into mat.
-   * This may do datatype conversion if DataType is not float.
-   * mat should be of size (m_data_height, m_data_width).
+   * Read the channels of a sample, and its target if with_target.
+   * The planes are row-major floats in thread-local buffers, valid
+   * until the thread reads another sample.
    */
-  void load_file(int data_id, const std::string channel, Mat& mat);
+  std::vector<const float*> read_planes(int data_id, bool with_target);
+  /// Read the target of a sample into a thread-local buffer.
+  const float* read_response(int data_id);
+  /**
+   * Write one row-major plane into a column of the output, transposing
+   * it and applying the sample's flips.
+   */
+  void copy_plane(const float* src, DataType* dst, int data_id) const;
+  /// Write a packed file for each sample, striped over all ranks.
+  void pack_samples();
   /// Return the full path to the data file for datum data_id's channel.
   std::string construct_filename(std::string channel, int data_id);
 
-  /// Flip mat horizontally (i.e. about its vertical axis).
-  void horizontal_flip(CPUMat& mat);
-  /// Flip mat vertically (i.e. about its horizontal axis).
-  void vertical_flip(CPUMat& mat);
-
   /// A suffix to append to each channel directory (e.g. "128").
   std::string m_suffix = "128";
   /// Target channel; contains the relaxation information.
@@ -131,8 +151,10 @@ class mesh_reader : public generic_data_reader {
   int m_data_width = 128;
   /// Number of samples.
   int m_num_samples = 0;
-  /// Buffers for loading data into.
-  std::vector<std::vector<DataType>> m_load_bufs;
+  /// Name of the packed channel directory and files.
+  std::string m_packed_name = "packed";
+  /// Whether samples are read from packed files.
+  bool m_packed = false;
   /// Whether to do random horizontal/vertical flips.
   bool m_random_flips = false;
   /**
@@ -30,9 +30,18 @@
 #define LBANN_DATA_READER_MNIST_HPP
 
 #include "data_reader_image.hpp"
+#include "lbann/utils/mapped_file.hpp"
+
+#include <memory>
 
 namespace lbann {
 
+/**
+ * A data reader for the MNIST dataset in its IDX format.
+ * The image and label files are memory-mapped read-only, so processes
+ * on a node share one copy in the page cache; reader copies share the
+ * mappings.
+ */
 class mnist_reader : public image_data_reader {
  public:
   mnist_reader(bool shuffle = true);
@@ -54,10 +63,21 @@ class mnist_reader : public image_data_reader {
  protected:
   void set_defaults() override;
   bool fetch_datum(CPUMat& X, int data_id, int mb_idx) override;
+  bool supports_batched_transforms() const override { return true; }
   bool fetch_label(CPUMat& Y, int data_id, int mb_idx) override;
 
  protected:
-  std::vector<std::vector<unsigned char>> m_image_data;
+  /** Memory-mapped image file. */
+  std::shared_ptr<mapped_file> m_image_file;
+  /** Memory-mapped label file. */
+  std::shared_ptr<mapped_file> m_label_file;
+  /** Number of samples used. */
+  size_t m_num_images = 0;
+
+  /** Pixels of a sample in the mapped image file. */
+  const uint8_t* get_image(int data_id) const;
+  /** Label of a sample in the mapped label file. */
+  uint8_t get_label(int data_id) const;
 };
 
 }  // namespace lbann
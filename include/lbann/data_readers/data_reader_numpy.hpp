@@ -30,6 +30,7 @@
 #define LBANN_DATA_READER_NUMPY_HPP
 
 #include "data_reader.hpp"
+#include "lbann/utils/cnpy_utils.hpp"
 #include <cnpy.h>
 
 namespace lbann {
@@ -40,6 +41,11 @@ namespace lbann {
  * axes can be flattened to form a sample.
  * This supports fetching labels, but only from the last column. (This can be
  * relaxed if necessary.) Ditto responses.
+ * With --numpy_mmap, the file is memory-mapped instead of loaded, so
+ * arrays larger than memory can be read. Samples of at least three
+ * dimensions (C x D x ...) without labels or responses can be read one
+ * depth slab at a time (see set_spatial_partition), which together
+ * with --numpy_mmap only touches the pages of each process's slab.
  */
 class numpy_reader : public generic_data_reader {
  public:
@@ -63,6 +69,10 @@ class numpy_reader : public generic_data_reader {
 
   void load() override;
 
+  bool supports_spatial_partitions() const override {
+    return !m_has_labels && !m_has_responses;
+  }
+
   int get_num_labels() const override { return m_num_labels; }
   int get_linearized_data_size() const override { return m_num_features; }
   int get_linearized_label_size() const override { return m_num_labels; }
@@ -91,11 +101,11 @@ class numpy_reader : public generic_data_reader {
   /// Whether to fetch a response from the last column.
   bool m_has_responses = false;
   /**
-   * Underlying numpy data.
+   * Underlying numpy data, loaded or memory-mapped.
    * Note raw data is managed with shared smart pointer semantics (relevant
    * for copying).
    */
-  cnpy::NpyArray m_data;
+  cnpy_utils::npy_view m_data;
 };
 
 }  // namespace lbann
@@ -93,11 +93,11 @@ namespace lbann {
     /// Whether to fetch a response from the last column.
     bool m_has_responses = false;
     /**
-     * Underlying numpy data.
+     * Underlying numpy data, loaded or memory-mapped (--numpy_mmap).
      * Note raw data is managed with shared smart pointer semantics (relevant
      * for copying).
      */
-    cnpy::NpyArray m_data, m_labels, m_responses;
+    cnpy_utils::npy_view m_data, m_labels, m_responses;
 
     // A constant to be multiplied when data is converted
     // from int16 to DataType.
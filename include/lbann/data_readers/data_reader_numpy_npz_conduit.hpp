@@ -108,8 +108,6 @@ class numpy_npz_conduit_reader : public generic_data_reader {
 
     std::vector<std::string> m_filenames;
 
-    bool load_numpy_npz_from_file(const std::unordered_set<int> &data_ids, std::unordered_set<int>& label_classes); 
-
     void load_conduit_node(const std::string filename, int data_id, conduit::Node &output, bool reset = true);
 
     std::unordered_map<int, std::map<std::string, cnpy::NpyArray>> m_npz_cache;
@@ -30,12 +30,21 @@
 #define LBANN_DATA_READER_PILOT2_MOLECULAR_HPP
 
 #include "data_reader.hpp"
+#include "conduit/conduit.hpp"
 #include <cnpy.h>
+#include <cstdint>
 
 namespace lbann {
 
 /**
  * Data reader for loading Pilot 2 molecular data.
+ *
+ * The neighbors of every molecule are resolved once at load time into
+ * a table of int32 sample ids (-1 for none). They come from the
+ * "neighbors" array of the npz file if it has one; otherwise the
+ * num_neighbors nearest molecules of the same frame are found with a
+ * cell-list spatial hash over the molecules' bead centroids. Samples
+ * can be preloaded into the data store.
  */
 class pilot2_molecular_reader : public generic_data_reader {
  public:
@@ -137,6 +146,24 @@ class pilot2_molecular_reader : public generic_data_reader {
   bool fetch_datum(CPUMat& X, int data_id, int mb_idx) override;
   /// Fetch molecule data_id into X at molecule offset idx.
   void fetch_molecule(CPUMat& X, int data_id, int idx, int mb_idx);
+  /// Write the scaled features of molecule data_id to dst.
+  void copy_molecule(int data_id, DataType* dst) const;
+  /// Write a molecule and its neighbors to dst; missing neighbors are zero.
+  void copy_sample(int data_id, DataType* dst) const;
+
+  void do_preload_data_store() override;
+  /// Fill node with the sample as fetch_datum writes it.
+  void load_conduit_node(int data_id, conduit::Node& node);
+
+  bool supports_background_preload() const override { return true; }
+  void load_data_store_node(int data_id, conduit::Node& node) override {
+    load_conduit_node(data_id, node);
+  }
+
+  /// Fill m_neighbor_ids from the neighbors array of the npz file.
+  void build_neighbor_ids_from_file();
+  /// Fill m_neighbor_ids with a cell-list search of each frame.
+  void build_neighbor_ids_from_positions();
 
   /// Number of samples.
   int m_num_samples = 0;
@@ -150,8 +177,12 @@ class pilot2_molecular_reader : public generic_data_reader {
   int m_max_neighborhood;
   /// Molecular features.
   cnpy::NpyArray m_features;
-  /// Neighbor information (adjacency matrix).
+  /// Neighbor information (adjacency matrix), if in the file.
   cnpy::NpyArray m_neighbors;
+  /// Neighbors of each sample as sample ids, m_num_neighbors per sample.
+  std::vector<int32_t> m_neighbor_ids;
+  /// Per-feature factors applied by scale_data.
+  std::vector<DataType> m_feature_scales;
 
   DataType position_scale_factor = 320.0;
   DataType bond_len_scale_factor = 10.0;
@@ -84,28 +84,65 @@ private:
    *
    *  This function will be executed on worker processes (see @c
    *  m_process_pool). It will obtain a data sample from @c
-   *  m_sample_function and copy it into a @c m_shared_memory_array.
+   *  m_sample_function, copy it into its slot of @c
+   *  m_shared_memory_array and then publish the slot generation in
+   *  @c m_ready_flags.
    */
   python::object m_sample_function_wrapper;
-
   /** @brief Pool of worker processes.
    *
    *  From the Python @c multiprocessing module.
    */
   python::object m_process_pool;
-
+  /** @brief Number of worker processes in @c m_process_pool. */
+  El::Int m_num_workers = 1;
   /** @brief Shared memory array.
    *
-   *  @c RawArray from the Python @c multiprocessing module.
+   *  @c RawArray from the Python @c multiprocessing module. Holds a
+   *  ring of mini-batch slots, each with room for the max mini-batch.
    */
   python::object m_shared_memory_array;
-
   /** @brief Pointer into shared memory array.
    *
    *  Points to buffer for @c m_shared_memory_array.
    */
   DataType* m_shared_memory_array_ptr = nullptr;
-
+  /** @brief Per-sample ready flags, a @c RawArray of bytes.
+   *
+   *  A worker writes the generation of a sample's slot after copying
+   *  the sample, so completion is observed without the GIL.
+   */
+  python::object m_ready_flags;
+  volatile unsigned char* m_ready_flags_ptr = nullptr;
+
+  /** @brief A mini-batch being assembled in shared memory. */
+  struct batch_slot {
+    /** Samples requested for the slot; empty if the slot is free. */
+    std::vector<El::Int> indices;
+    /** @c AsyncResult of the @c starmap_async call filling the slot. */
+    python::object result;
+    /** Value the workers write to the ready flags; never 0. */
+    unsigned char generation = 0;
+    /** The slot's samples have not been waited for yet. */
+    bool pending = false;
+  };
+  std::vector<batch_slot> m_slots;
+  /** @brief Slot for the next submission; slots are filled in order. */
+  size_t m_next_slot = 0;
+  /** @brief Max mini-batch size; the size of a slot, in samples. */
+  El::Int m_slot_capacity = 0;
+
+  /** @brief Samples of the mini-batch starting at position @c pos. */
+  std::vector<El::Int> get_batch_indices(El::Int pos, El::Int mb_size) const;
+  /** @brief Return the slot holding these samples, submitting them to
+   *  the process pool if no slot does. Must not hold the GIL. */
+  size_t request_batch(const std::vector<El::Int>& indices);
+  /** @brief Block until the workers have filled a pending slot.
+   *
+   *  Polls the ready flags without the GIL; the GIL is only taken
+   *  occasionally to surface errors raised by the workers.
+   */
+  void wait_for_batch(size_t slot);
 };
 
 } // namespace lbann
@@ -31,6 +31,7 @@
 #include "conduit/conduit.hpp"
 #include "lbann/utils/options.hpp"
 #include "lbann/data_readers/data_reader.hpp"
+#include "lbann/utils/mapped_file.hpp"
 
 namespace lbann {
   /**
@@ -70,6 +71,28 @@ public:
   void set_num_samples(int n) { m_num_samples = n; }
   int get_num_samples() { return m_num_samples; }
 
+  /** @brief Read a vocabulary file: one "<token> <id>" pair per line.
+   *
+   *  Single-character tokens go into @c vocab; the ids of the special
+   *  tokens <pad>, <unk>, <bos> and <eos> are returned separately.
+   */
+  static void read_vocab(const std::string &fn,
+                         std::unordered_map<char, short> &vocab,
+                         short &pad, short &unk, short &bos, short &eos);
+
+  /** @brief Tokenize a SMILES text file into a binary token cache.
+   *
+   *  The cache holds the vocabulary ids of every SMILES string, without
+   *  <bos>/<eos> and untruncated, followed by an offset index, so it does
+   *  not depend on --sequence_length. It is stamped with the size and
+   *  mtime of @c text_file and a hash of the vocabulary; readers rebuild
+   *  it when either changes. Returns the number of samples written.
+   */
+  static size_t write_token_cache(const std::string &text_file,
+                                  const std::string &cache_file,
+                                  const std::unordered_map<char, short> &vocab,
+                                  short unk, char delimiter, bool has_header);
+
 private:
 
   //==== start hack to make it work fast ====
@@ -135,6 +158,8 @@ private:
   bool fetch_datum(CPUMat& X, int data_id, int mb_idx) override;
   bool fetch_label(CPUMat& Y, int data_id, int mb_idx) override;
   bool fetch_response(CPUMat& Y, int data_id, int mb_idx) override;
+  /** Encoded length, including <bos> and <eos>, after truncation */
+  int get_sample_length(int data_id) const override;
 
   void print_statistics() const;
   void load_vocab();
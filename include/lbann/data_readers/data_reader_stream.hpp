@@ -0,0 +1,165 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_DATA_READER_STREAM_HPP
+#define LBANN_DATA_READER_STREAM_HPP
+
+#include "data_reader.hpp"
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace lbann {
+
+/** @brief Source of samples for data_reader_stream.
+ *
+ *  A producer hands out fixed-size records, one sample each: the data
+ *  values followed by the label (as a value) or the response values.
+ */
+class sample_producer {
+ public:
+  virtual ~sample_producer() = default;
+  /** @brief Copy the next record into @c record.
+   *  @returns false once the stream has ended.
+   */
+  virtual bool next(float* record) = 0;
+};
+
+/** @brief Producer reading binary float32 records from a file or FIFO.
+ *
+ *  Suited to coupling with a simulation that writes samples into a
+ *  named pipe as it produces them; reads block until data arrives.
+ */
+class fifo_sample_producer : public sample_producer {
+ public:
+  fifo_sample_producer(const std::string& path, size_t record_size);
+  bool next(float* record) override;
+ private:
+  std::ifstream m_in;
+  std::string m_path;
+  size_t m_record_size;
+};
+
+/**
+ * Data reader for unbounded streams of samples, e.g. data produced on
+ * the fly by a coupled simulation. No index over the dataset is built:
+ * an "epoch" is a fixed number of samples, and each rank pulls its
+ * samples from its own producer through a shuffle buffer of
+ * --stream_shuffle_buffer=<n> records (default 1024), so memory is
+ * O(buffer) however long the stream is. The data filename may contain
+ * "{rank}", which is replaced by the rank in the world, so ranks read
+ * separate streams.
+ */
+class data_reader_stream : public generic_data_reader {
+ public:
+  data_reader_stream(int samples_per_epoch, std::vector<int> dims,
+                     int num_labels, bool shuffle = true);
+  data_reader_stream(int samples_per_epoch, std::vector<int> dims,
+                     std::vector<int> response_dims, bool shuffle = true);
+  data_reader_stream(const data_reader_stream&) = default;
+  data_reader_stream& operator=(const data_reader_stream&) = default;
+  ~data_reader_stream() override {}
+  data_reader_stream* copy() const override {
+    return new data_reader_stream(*this);
+  }
+
+  std::string get_type() const override {
+    return "data_reader_stream";
+  }
+
+  void load() override;
+
+  /** @brief Use @c producer instead of opening the data file. */
+  void set_producer(std::unique_ptr<sample_producer> producer);
+
+  int get_linearized_data_size() const override {
+    return std::accumulate(m_dimensions.begin(), m_dimensions.end(), 1,
+                           std::multiplies<int>());
+  }
+  int get_linearized_label_size() const override {
+    return m_num_labels;
+  }
+  int get_linearized_response_size() const override {
+    return std::accumulate(m_response_dimensions.begin(),
+                           m_response_dimensions.end(), 1,
+                           std::multiplies<int>());
+  }
+  const std::vector<int> get_data_dims() const override {
+    return m_dimensions;
+  }
+  int get_num_labels() const override { return m_num_labels; }
+  int get_num_responses() const override {
+    return get_linearized_response_size();
+  }
+
+  /** The epoch length; there is no index to take the size of. */
+  int get_num_data() const override { return m_samples_per_epoch; }
+
+  int fetch_data(CPUMat& X, El::Matrix<El::Int>& indices_fetched) override;
+
+ protected:
+  /** Samples are identified by their position in the epoch. */
+  int get_shuffled_index(int pos) const override { return pos; }
+  bool fetch_datum(CPUMat& X, int data_id, int mb_idx) override;
+  bool fetch_label(CPUMat& Y, int data_id, int mb_idx) override;
+  bool fetch_response(CPUMat& Y, int data_id, int mb_idx) override;
+
+ private:
+  /** Records: data values, then the label or the response values. */
+  size_t get_record_size() const {
+    return get_linearized_data_size()
+      + (m_num_labels > 0 ? 1 : get_linearized_response_size());
+  }
+
+  /** @brief Producer and shuffle buffer; shared by copies of the reader. */
+  struct stream_state {
+    std::mutex mutex;
+    std::unique_ptr<sample_producer> producer;
+    /** Up to capacity records, stored contiguously */
+    std::vector<float> buffer;
+    size_t size = 0;
+    size_t capacity = 0;
+    bool ended = false;
+  };
+  /** @brief Take a record from the shuffle buffer, refilling it. */
+  void take_record(float* record);
+
+  int m_samples_per_epoch;
+  int m_num_labels;
+  /** Shape of the data. */
+  std::vector<int> m_dimensions;
+  /** Shape of the responses. */
+  std::vector<int> m_response_dimensions;
+  std::shared_ptr<stream_state> m_stream;
+  /** Label or responses of each sample in the current mini-batch,
+   *  saved by fetch_datum for fetch_label and fetch_response. */
+  std::vector<float> m_staged;
+};
+
+}  // namespace lbann
+
+#endif  // LBANN_DATA_READER_STREAM_HPP
@@ -35,6 +35,12 @@ namespace lbann {
 /**
  * Data reader for generating random samples.
  * Samples are different every time.
+ *
+ * With --synthetic_on_device, samples for GPU input layers are
+ * generated straight into device memory by a CUDA kernel, so the host
+ * RNG and the host-to-device copy of the samples are taken out of
+ * the measurement. Labels and responses are still generated on the
+ * host.
  */
 class data_reader_synthetic : public generic_data_reader {
  public:
@@ -78,10 +84,21 @@ class data_reader_synthetic : public generic_data_reader {
     return get_linearized_response_size();
   }
 
+#ifdef LBANN_HAS_GPU
+  /** True if --synthetic_on_device is given. */
+  bool supports_device_fetch() const override;
+#endif // LBANN_HAS_GPU
+
  protected:
   bool fetch_datum(CPUMat& X, int data_id, int mb_idx) override;
   bool fetch_label(CPUMat& Y, int data_id, int mb_idx) override;
   bool fetch_response(CPUMat& Y, int data_id, int mb_idx) override;
+#ifdef LBANN_HAS_GPU
+  bool fetch_data_block_on_device(El::Matrix<DataType, El::Device::GPU>& X,
+                                  El::Int mb_size,
+                                  El::Matrix<El::Int>& indices_fetched,
+                                  cudaStream_t stream) override;
+#endif // LBANN_HAS_GPU
 
  private:
   /** Number of samples in the dataset. */
@@ -92,6 +109,11 @@ class data_reader_synthetic : public generic_data_reader {
   std::vector<int> m_dimensions;
   /** Shape of the responses. */
   std::vector<int> m_response_dimensions;
+#ifdef LBANN_HAS_GPU
+  /** Number of mini-batches generated on the device, so that each
+   *  one gets different random values. */
+  uint64_t m_num_device_fetches = 0;
+#endif // LBANN_HAS_GPU
 };
 
 }  // namespace lbann
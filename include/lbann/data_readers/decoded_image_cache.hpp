@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_DATA_READERS_DECODED_IMAGE_CACHE_HPP
+#define LBANN_DATA_READERS_DECODED_IMAGE_CACHE_HPP
+
+#include "lbann/base.hpp"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace lbann {
+
+/**
+ * Fixed-size, thread-safe cache of decoded uint8 images, keyed by
+ * sample index.
+ *
+ * Images are inserted until the capacity is reached and never
+ * evicted: with samples reshuffled every epoch, a fixed subset hits as
+ * often as any eviction policy would, without the bookkeeping.
+ */
+class decoded_image_cache {
+public:
+  /** @param capacity Maximum number of bytes of image data. */
+  explicit decoded_image_cache(size_t capacity) : m_capacity(capacity) {}
+  decoded_image_cache(const decoded_image_cache&) = delete;
+  decoded_image_cache& operator=(const decoded_image_cache&) = delete;
+
+  /**
+   * Copy the image of data_id, if cached, into image (resizing it)
+   * and its dims into dims.
+   * @return Whether the image was cached.
+   */
+  bool get(int data_id, El::Matrix<uint8_t>& image,
+           std::vector<size_t>& dims) const;
+  /**
+   * Cache a copy of image, if it fits.
+   * @return Whether the image was cached.
+   */
+  bool insert(int data_id, const El::Matrix<uint8_t>& image,
+              const std::vector<size_t>& dims);
+  /** Whether the image of data_id is cached. */
+  bool contains(int data_id) const;
+
+  /** Number of bytes of image data cached. */
+  size_t size() const;
+  /** Whether no more images fit. */
+  bool full() const;
+
+private:
+  struct entry {
+    std::vector<uint8_t> data;
+    std::vector<size_t> dims;
+  };
+
+  const size_t m_capacity;
+  size_t m_size = 0;
+  /** Set once an image did not fit, so misses skip the copy. */
+  bool m_full = false;
+  std::unordered_map<int, entry> m_images;
+  mutable std::mutex m_mutex;
+};
+
+} // namespace lbann
+
+#endif // LBANN_DATA_READERS_DECODED_IMAGE_CACHE_HPP
@@ -9,6 +9,7 @@
 #include "lbann/comm.hpp"
 
 #include "lbann/utils/file_utils.hpp"
+#include "lbann/data_readers/sample_list_binary.hpp"
 #include <cereal/types/unordered_map.hpp>
 #include <cereal/types/deque.hpp>
 #include <cereal/types/vector.hpp>
@@ -64,7 +65,7 @@ class sample_list {
 
   void copy_members(const sample_list& rhs);
 
-  /// Load a sample list file
+  /// Load a sample list file, either text or binary (sample_list_binary)
   void load(const std::string& samplelist_file, size_t stride=1, size_t offset=0);
 
   /// Load the header of a sample list file
@@ -118,9 +119,15 @@ class sample_list {
   /// Reads the header of a sample list
   sample_list_header read_header(std::istream& istrm, const std::string& filename) const;
 
+  /// Builds the header of a binary sample list
+  sample_list_header binary_header(const sample_list_binary& bin, const std::string& filename) const;
+
   /// read the body of a sample list, which is the list of sample files, where each file contains a single sample.
   virtual void read_sample_list(std::istream& istrm, size_t stride=1, size_t offset=0);
 
+  /// Populate the list from the files of a binary sample list, strided like read_sample_list
+  virtual void read_binary_sample_list(const sample_list_binary& bin, size_t stride=1, size_t offset=0);
+
   /// Assign names to samples when there is only one sample per file without a name.
   virtual void assign_samples_name();
 
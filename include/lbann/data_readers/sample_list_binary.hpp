@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_DATA_READERS_SAMPLE_LIST_BINARY_HPP_INCLUDED
+#define LBANN_DATA_READERS_SAMPLE_LIST_BINARY_HPP_INCLUDED
+
+#include "lbann/utils/mapped_file.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lbann {
+
+/** @brief Read-only view of a binary, indexed sample list.
+ *
+ *  The file is memory-mapped and accessed in place, so opening a list
+ *  costs O(1) regardless of its size, and every rank can read it
+ *  directly instead of receiving it from the trainer master. The layout
+ *  (all integers native little-endian) is:
+ *
+ *  - header: magic, version, flags, counts and section offsets
+ *  - file table: one fixed-width record per bundle file holding its
+ *    name, its range in the sample table, and its total sample count
+ *  - sample table: one fixed-width record per included sample, grouped
+ *    by file
+ *  - string table: the file directory, file names and sample names
+ *
+ *  Files are written by @c tools/convert_sample_list.
+ */
+class sample_list_binary {
+ public:
+  /// Per-file record of the file table
+  struct file_record {
+    uint64_t name_offset;
+    uint64_t name_length;
+    /// Index of the file's first sample in the sample table
+    uint64_t first_sample;
+    /// Number of included samples
+    uint64_t num_samples;
+    /// Number of samples in the bundle, included or not
+    uint64_t total_samples;
+  };
+
+  /// Per-sample record of the sample table
+  struct sample_record {
+    uint64_t name_offset;
+    uint64_t name_length;
+  };
+
+  /// Input to write() describing one bundle file
+  struct file_entry {
+    std::string name;
+    uint64_t total_samples;
+    std::vector<std::string> samples;
+  };
+
+  /// Whether @c filename starts with the binary sample list magic
+  static bool is_binary(const std::string& filename);
+
+  /// Write a binary sample list
+  static void write(const std::string& filename,
+                    const std::string& file_dir,
+                    const std::vector<file_entry>& files);
+
+  /// Map @c filename and validate its header and tables
+  explicit sample_list_binary(const std::string& filename);
+
+  size_t get_num_files() const { return m_header->num_files; }
+  size_t get_num_samples() const { return m_header->num_samples; }
+  size_t get_num_excluded_samples() const { return m_header->num_excluded; }
+  std::string get_file_dir() const;
+
+  const file_record& get_file(size_t i) const { return m_files[i]; }
+  std::string get_file_name(size_t i) const;
+  std::string get_sample_name(size_t i) const;
+
+ private:
+  struct header_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t num_files;
+    uint64_t num_samples;
+    uint64_t num_excluded;
+    uint64_t file_dir_offset;
+    uint64_t file_dir_length;
+    uint64_t file_table_offset;
+    uint64_t sample_table_offset;
+    uint64_t string_table_offset;
+    uint64_t string_table_size;
+  };
+
+  std::string get_string(uint64_t offset, uint64_t length) const;
+
+  mapped_file m_file;
+  const header_t* m_header;
+  const file_record* m_files;
+  const sample_record* m_samples;
+  const char* m_strings;
+};
+
+} // namespace lbann
+
+#endif // LBANN_DATA_READERS_SAMPLE_LIST_BINARY_HPP_INCLUDED
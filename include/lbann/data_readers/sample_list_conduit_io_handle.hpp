@@ -38,6 +38,7 @@ inline sample_list_conduit_io_handle<sample_name_t>::sample_list_conduit_io_hand
 
 template <typename sample_name_t>
 inline sample_list_conduit_io_handle<sample_name_t>::~sample_list_conduit_io_handle() {
+  this->stop_prefetcher();
   // Close the existing open files
   for(auto& f : this->m_file_id_stats_map) {
     file_handle_t& h = std::get<1>(f);
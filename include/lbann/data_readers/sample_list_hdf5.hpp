@@ -39,6 +39,7 @@ inline sample_list_hdf5<sample_name_t>::sample_list_hdf5()
 
 template <typename sample_name_t>
 inline sample_list_hdf5<sample_name_t>::~sample_list_hdf5() {
+  this->stop_prefetcher();
   // Close the existing open files
   for(auto& f : this->m_file_id_stats_map) {
     file_handle_t& h = std::get<1>(f);
@@ -159,6 +159,12 @@ template <typename sample_name_t>
 inline void sample_list<sample_name_t>
 ::load(const std::string& samplelist_file,
        size_t stride, size_t offset) {
+  if (sample_list_binary::is_binary(samplelist_file)) {
+    const sample_list_binary bin(samplelist_file);
+    m_header = binary_header(bin, samplelist_file);
+    read_binary_sample_list(bin, stride, offset);
+    return;
+  }
   std::ifstream istr(samplelist_file);
   get_samples_per_file(istr, samplelist_file, stride, offset);
   istr.close();
@@ -167,10 +173,26 @@ inline void sample_list<sample_name_t>
 template <typename sample_name_t>
 inline sample_list_header sample_list<sample_name_t>
 ::load_header(const std::string& samplelist_file) const {
+  if (sample_list_binary::is_binary(samplelist_file)) {
+    return binary_header(sample_list_binary(samplelist_file), samplelist_file);
+  }
   std::ifstream istr(samplelist_file);
   return read_header(istr, samplelist_file);
 }
 
+template <typename sample_name_t>
+inline sample_list_header sample_list<sample_name_t>
+::binary_header(const sample_list_binary& bin, const std::string& filename) const {
+  sample_list_header hdr;
+  hdr.m_sample_list_filename = filename;
+  hdr.m_is_exclusive = false;
+  hdr.m_included_sample_count = bin.get_num_samples();
+  hdr.m_excluded_sample_count = bin.get_num_excluded_samples();
+  hdr.m_num_files = bin.get_num_files();
+  hdr.m_file_dir = bin.get_file_dir();
+  return hdr;
+}
+
 template <typename sample_name_t>
 inline void sample_list<sample_name_t>
 ::load_from_string(const std::string& samplelist) {
@@ -320,6 +342,20 @@ inline void sample_list<sample_name_t>
 }
 
 
+template <typename sample_name_t>
+inline void sample_list<sample_name_t>
+::read_binary_sample_list(const sample_list_binary& bin,
+                          size_t stride, size_t offset) {
+  m_sample_list.reserve(bin.get_num_files() / stride + 1u);
+  static const auto sn0 = uninitialized_sample_name<sample_name_t>();
+  for (size_t f = offset; f < bin.get_num_files(); f += stride) {
+    const sample_file_id_t index = m_file_id_stats_map.size();
+    m_sample_list.emplace_back(std::make_pair(index, sn0));
+    m_file_id_stats_map.emplace_back(bin.get_file_name(f));
+  }
+}
+
+
 template <typename sample_name_t>
 inline size_t sample_list<sample_name_t>
 ::get_samples_per_file(std::istream& istrm,
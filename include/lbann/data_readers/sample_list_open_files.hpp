@@ -2,6 +2,13 @@
 #define __SAMPLE_LIST_OPEN_FILES_HPP__
 
 #include "sample_list.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
 
 /// Number of system and other files that may be open during execution
 #define LBANN_MAX_OPEN_FILE_MARGIN 128
@@ -77,6 +84,17 @@ class sample_list_open_files : public sample_list<sample_name_t> {
 
   void compute_epochs_file_usage(const std::vector<int>& shufled_indices, int mini_batch_size, const lbann_comm& comm);
 
+  /** Set the number of upcoming files, in this rank's shuffled order,
+   *  that a helper thread opens ahead of use. Zero disables prefetching. */
+  void set_prefetch_depth(size_t depth);
+  size_t get_prefetch_depth() const { return m_prefetch_depth; }
+
+  /// Number of file opens since the last call to reset_open_file_stats()
+  size_t get_num_file_opens() const { return m_num_file_opens; }
+  /// Average number of samples read per file open since the last reset
+  double get_samples_per_file_open() const;
+  void reset_open_file_stats();
+
   virtual bool is_file_handle_valid(const file_handle_t& h) const = 0;
 
   void all_gather_packed_lists(lbann_comm& comm) override;
@@ -105,6 +123,10 @@ class sample_list_open_files : public sample_list<sample_name_t> {
   /// read the body of a sample list
   void read_sample_list(std::istream& istrm, size_t stride=1, size_t offset=0) override;
 
+  /** Populate the list from a binary sample list. Bundles are not opened
+   *  here; each is opened on first use. */
+  void read_binary_sample_list(const sample_list_binary& bin, size_t stride=1, size_t offset=0) override;
+
   void assign_samples_name() override {}
 
   /// Get the number of total/included/excluded samples
@@ -119,7 +141,20 @@ class sample_list_open_files : public sample_list<sample_name_t> {
   virtual void close_file_handle(file_handle_t& h) = 0;
   virtual void clear_file_handle(file_handle_t& h) = 0;
 
+  /** Join the prefetch thread. It calls the virtual open methods, so
+   *  derived destructors must call this before tearing down. */
+  void stop_prefetcher();
+
  private:
+  /// Drop queued prefetches and wait for any open in flight (lock held)
+  void quiesce_prefetcher(std::unique_lock<std::mutex>& lock);
+  /// Open file @c id unless it is open or being opened (lock held)
+  file_handle_t acquire_file_handle(sample_file_id_t id, bool pre_open_fd,
+                                    std::unique_lock<std::mutex>& lock);
+  /// Queue opens for the files following use position @c pos (lock held)
+  void schedule_prefetch(size_t pos);
+  void prefetch_loop();
+
   using sample_list<sample_name_t>::serialize;
   template <class Archive> void serialize( Archive & ar ) = delete;
 
@@ -140,6 +175,31 @@ class sample_list_open_files : public sample_list<sample_name_t> {
   std::deque<fd_use_map_t> m_open_fd_pq;
 
   size_t m_max_open_files;
+
+  /** Guards the file handles, the priority queue and the prefetch
+   *  state; I/O threads and the prefetcher share the handles. */
+  std::mutex m_open_fd_mutex;
+  /// Signals new prefetch work and completed opens
+  std::condition_variable m_open_fd_cv;
+  /// Files being opened outside the lock
+  std::unordered_set<sample_file_id_t> m_pending_opens;
+  /// Number of I/O threads reading from each file; these are not evicted
+  std::unordered_map<sample_file_id_t, int> m_file_in_use;
+
+  /// Files in the order this rank reads them, with repeats collapsed
+  std::vector<sample_file_id_t> m_file_use_order;
+  /// Position in m_file_use_order of each sample this rank reads
+  std::vector<size_t> m_sample_use_pos;
+  /// Files queued for the prefetcher
+  std::deque<sample_file_id_t> m_prefetch_queue;
+  /// End of the range of m_file_use_order already queued
+  size_t m_prefetch_cursor = 0;
+  size_t m_prefetch_depth = 0;
+  std::thread m_prefetch_thread;
+  bool m_prefetch_stop = false;
+
+  std::atomic<size_t> m_num_file_opens{0};
+  std::atomic<size_t> m_num_sample_reads{0};
 };
 
 template<typename T>
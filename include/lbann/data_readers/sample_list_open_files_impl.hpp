@@ -7,6 +7,7 @@ inline sample_list_open_files<sample_name_t, file_handle_t>::sample_list_open_fi
 
 template <typename sample_name_t, typename file_handle_t>
 inline sample_list_open_files<sample_name_t, file_handle_t>::~sample_list_open_files() {
+  stop_prefetcher();
   m_open_fd_pq.clear();
 }
 
@@ -66,6 +67,16 @@ inline void sample_list_open_files<sample_name_t, file_handle_t>
   /// Do not copy the open file descriptor priority queue
   /// File handle ownership is not transfered in the copy
   m_open_fd_pq.clear();
+  m_pending_opens.clear();
+  m_file_in_use.clear();
+
+  /// The prefetch schedule is shared, but not the prefetch thread
+  m_file_use_order = rhs.m_file_use_order;
+  m_sample_use_pos = rhs.m_sample_use_pos;
+  m_prefetch_queue.clear();
+  m_prefetch_cursor = 0u;
+  m_prefetch_depth = rhs.m_prefetch_depth;
+  reset_open_file_stats();
 }
 
 template <typename sample_name_t, typename file_handle_t>
@@ -275,6 +286,25 @@ inline void sample_list_open_files<sample_name_t, file_handle_t>
 }
 
 
+template <typename sample_name_t, typename file_handle_t>
+inline void sample_list_open_files<sample_name_t, file_handle_t>
+::read_binary_sample_list(const sample_list_binary& bin,
+                          size_t stride, size_t offset) {
+  m_sample_list.reserve(bin.get_num_samples() / stride + 1u);
+  m_file_id_stats_map.reserve(bin.get_num_files() / stride + 1u);
+  for (size_t f = offset; f < bin.get_num_files(); f += stride) {
+    const auto& rec = bin.get_file(f);
+    const std::string filename = bin.get_file_name(f);
+    m_file_map[filename] = rec.total_samples;
+
+    const sample_file_id_t index = m_file_id_stats_map.size();
+    m_file_id_stats_map.emplace_back(std::make_tuple(filename, uninitialized_file_handle<file_handle_t>(), std::deque<std::pair<int,int>>{}));
+    for (size_t i = rec.first_sample; i < rec.first_sample + rec.num_samples; ++i) {
+      m_sample_list.emplace_back(index, to_sample_name_t<sample_name_t>(bin.get_sample_name(i)));
+    }
+  }
+}
+
 template <typename sample_name_t, typename file_handle_t>
 inline void sample_list_open_files<sample_name_t, file_handle_t>
 ::read_sample_list(std::istream& istrm, size_t stride, size_t offset) {
@@ -404,6 +434,7 @@ inline void sample_list_open_files<sample_name_t, file_handle_t>
 template <typename sample_name_t, typename file_handle_t>
 inline void sample_list_open_files<sample_name_t, file_handle_t>
 ::set_files_handle(const std::string& filename, file_handle_t h) {
+  std::lock_guard<std::mutex> lock(m_open_fd_mutex);
   sample_file_id_t id = sample_file_id_t(0);
   for (auto&& e : m_file_id_stats_map) {
     if(std::get<0>(e) == filename) {
@@ -513,6 +544,8 @@ inline void sample_list_open_files<sample_name_t, file_handle_t>
   std::vector<std::unordered_map<std::string, size_t>> per_rank_file_map(num_ranks);
 
   // Close the existing open files
+  std::unique_lock<std::mutex> lock(m_open_fd_mutex);
+  quiesce_prefetcher(lock);
   for(auto&& e : m_file_id_stats_map) {
     auto& h = std::get<1>(e);
     close_file_handle(h);
@@ -521,6 +554,10 @@ inline void sample_list_open_files<sample_name_t, file_handle_t>
     my_files.emplace_back(std::get<0>(e));
   }
   m_open_fd_pq.clear();
+  m_file_in_use.clear();
+  m_file_use_order.clear();
+  m_sample_use_pos.clear();
+  lock.unlock();
 
   size_t num_samples = this->all_gather_field(m_sample_list, per_rank_samples, comm);
   size_t num_ids = this->all_gather_field(my_files, per_rank_files, comm);
@@ -569,6 +606,8 @@ inline void sample_list_open_files<sample_name_t, file_handle_t>
 ::compute_epochs_file_usage(const std::vector<int>& shuffled_indices,
                             int mini_batch_size,
                             const lbann_comm& comm) {
+  std::unique_lock<std::mutex> lock(m_open_fd_mutex);
+  quiesce_prefetcher(lock);
   for (auto&& e : m_file_id_stats_map) {
     auto& h = std::get<1>(e);
     close_file_handle(h);
@@ -577,6 +616,9 @@ inline void sample_list_open_files<sample_name_t, file_handle_t>
   }
   // Once all of the file handles are closed, clear the priority queue
   m_open_fd_pq.clear();
+  m_file_in_use.clear();
+  m_file_use_order.clear();
+  m_sample_use_pos.assign(m_sample_list.size(), std::numeric_limits<size_t>::max());
   for (size_t i = 0; i < shuffled_indices.size(); i++) {
     int idx = shuffled_indices[i];
     const auto& s = m_sample_list[idx];
@@ -587,6 +629,11 @@ inline void sample_list_open_files<sample_name_t, file_handle_t>
       int step = i / mini_batch_size;
       int substep = (i % mini_batch_size) / comm.get_procs_per_trainer();
       std::get<2>(m_file_id_stats_map[index]).emplace_back(std::make_pair(step, substep));
+      /// Record the order in which this rank moves between files
+      if (m_file_use_order.empty() || m_file_use_order.back() != index) {
+        m_file_use_order.push_back(index);
+      }
+      m_sample_use_pos[idx] = m_file_use_order.size() - 1u;
     }
   }
 }
@@ -608,7 +655,10 @@ inline void sample_list_open_files<sample_name_t, file_handle_t>
 ::manage_open_file_handles(sample_file_id_t id, bool pre_open_fd) {
   /// When we enter this function the priority queue is either empty or a heap
   if(!m_open_fd_pq.empty()) {
-    if(m_open_fd_pq.size() > m_max_open_files) {
+    /// A file that an I/O thread is reading from is never closed under it;
+    /// the limit is exceeded until the reader is done with it
+    if(m_open_fd_pq.size() > m_max_open_files
+       && m_file_in_use.count(m_open_fd_pq.front().first) == 0u) {
       auto& f = m_open_fd_pq.front();
       auto& victim = m_file_id_stats_map[f.first];
       auto& victim_fd = std::get<1>(victim);
@@ -622,7 +672,7 @@ inline void sample_list_open_files<sample_name_t, file_handle_t>
   /// Before we can enqueue the any new access times for this descriptor, remove any
   /// earlier descriptor
   std::sort_heap(m_open_fd_pq.begin(), m_open_fd_pq.end(), pq_cmp);
-  if(m_open_fd_pq.front().first == id) {
+  if(!m_open_fd_pq.empty() && m_open_fd_pq.front().first == id) {
     m_open_fd_pq.pop_front();
   }
   std::make_heap(m_open_fd_pq.begin(), m_open_fd_pq.end(), pq_cmp);
@@ -647,27 +697,58 @@ inline void sample_list_open_files<sample_name_t, file_handle_t>
 
 template <typename sample_name_t, typename file_handle_t>
 inline file_handle_t sample_list_open_files<sample_name_t, file_handle_t>
-::open_samples_file_handle(const size_t i, bool pre_open_fd) {
-  const sample_t& s = m_sample_list[i];
-  sample_file_id_t id = s.first;
+::acquire_file_handle(sample_file_id_t id, bool pre_open_fd,
+                      std::unique_lock<std::mutex>& lock) {
+  /// Wait for an open already in flight rather than racing it
+  m_open_fd_cv.wait(lock, [&] { return m_pending_opens.count(id) == 0u; });
   file_handle_t h = get_samples_file_handle(id);
-  if (!is_file_handle_valid(h)) {
-    const std::string& file_name = get_samples_filename(id);
-    const std::string& file_dir = this->get_samples_dirname();
-    const std::string file_path = add_delimiter(file_dir) + file_name;
-    if (file_name.empty() || !check_if_file_exists(file_path)) {
-      LBANN_ERROR(std::string{} + " :: data file '" + file_path + "' does not exist.");
-    }
+  if (is_file_handle_valid(h)) {
+    return h;
+  }
+
+  const std::string file_name = get_samples_filename(id);
+  const std::string file_path = add_delimiter(this->get_samples_dirname()) + file_name;
 
+  /// Open outside the lock so other threads can use the files already open
+  m_pending_opens.insert(id);
+  lock.unlock();
+  const bool exists = !file_name.empty() && check_if_file_exists(file_path);
+  if (exists) {
     h = open_file_handle(file_path);
+  }
+  lock.lock();
+  m_pending_opens.erase(id);
+  m_open_fd_cv.notify_all();
 
-    if (!is_file_handle_valid(h)) {
-      LBANN_ERROR(std::string{} + " :: data file '" + file_path + "' could not be opened.");
+  if (!exists) {
+    LBANN_ERROR(std::string{} + " :: data file '" + file_path + "' does not exist.");
+  }
+  if (!is_file_handle_valid(h)) {
+    LBANN_ERROR(std::string{} + " :: data file '" + file_path + "' could not be opened.");
+  }
+  auto& e = m_file_id_stats_map[id];
+  std::get<1>(e) = h;
+  ++m_num_file_opens;
+  /// If a new file is opened, place it in the priority queue
+  manage_open_file_handles(id, pre_open_fd);
+  return h;
+}
+
+template <typename sample_name_t, typename file_handle_t>
+inline file_handle_t sample_list_open_files<sample_name_t, file_handle_t>
+::open_samples_file_handle(const size_t i, bool pre_open_fd) {
+  const sample_t& s = m_sample_list[i];
+  sample_file_id_t id = s.first;
+  std::unique_lock<std::mutex> lock(m_open_fd_mutex);
+  file_handle_t h = acquire_file_handle(id, pre_open_fd, lock);
+  /// Pin the file until close_if_done_samples_file_handle
+  ++m_file_in_use[id];
+  if (!pre_open_fd) {
+    ++m_num_sample_reads;
+    if ((m_prefetch_depth > 0u) && (i < m_sample_use_pos.size())
+        && (m_sample_use_pos[i] != std::numeric_limits<size_t>::max())) {
+      schedule_prefetch(m_sample_use_pos[i]);
     }
-    auto& e = m_file_id_stats_map[id];
-    std::get<1>(e) = h;
-    /// If a new file is opened, place it in the priority queue
-    manage_open_file_handles(id, pre_open_fd);
   }
   return h;
 }
@@ -677,6 +758,11 @@ inline void sample_list_open_files<sample_name_t, file_handle_t>
 ::close_if_done_samples_file_handle(const size_t i) {
   const sample_t& s = m_sample_list[i];
   sample_file_id_t id = s.first;
+  std::lock_guard<std::mutex> lock(m_open_fd_mutex);
+  auto in_use = m_file_in_use.find(id);
+  if (in_use != m_file_in_use.end() && --(in_use->second) <= 0) {
+    m_file_in_use.erase(in_use);
+  }
   auto h = get_samples_file_handle(id);
   if (!is_file_handle_valid(h)) {
     auto& e = m_file_id_stats_map[id];
@@ -690,6 +776,89 @@ inline void sample_list_open_files<sample_name_t, file_handle_t>
   }
 }
 
+template <typename sample_name_t, typename file_handle_t>
+inline void sample_list_open_files<sample_name_t, file_handle_t>
+::set_prefetch_depth(size_t depth) {
+  std::lock_guard<std::mutex> lock(m_open_fd_mutex);
+  m_prefetch_depth = depth;
+}
+
+template <typename sample_name_t, typename file_handle_t>
+inline double sample_list_open_files<sample_name_t, file_handle_t>
+::get_samples_per_file_open() const {
+  const size_t opens = m_num_file_opens;
+  return (opens == 0u) ? 0.0 : static_cast<double>(m_num_sample_reads) / opens;
+}
+
+template <typename sample_name_t, typename file_handle_t>
+inline void sample_list_open_files<sample_name_t, file_handle_t>
+::reset_open_file_stats() {
+  m_num_file_opens = 0u;
+  m_num_sample_reads = 0u;
+}
+
+template <typename sample_name_t, typename file_handle_t>
+inline void sample_list_open_files<sample_name_t, file_handle_t>
+::schedule_prefetch(size_t pos) {
+  const size_t end = std::min(pos + 1u + m_prefetch_depth, m_file_use_order.size());
+  for (size_t k = std::max(m_prefetch_cursor, pos + 1u); k < end; ++k) {
+    m_prefetch_queue.push_back(m_file_use_order[k]);
+  }
+  m_prefetch_cursor = std::max(m_prefetch_cursor, end);
+  if (!m_prefetch_queue.empty()) {
+    if (!m_prefetch_thread.joinable()) {
+      m_prefetch_thread = std::thread(&sample_list_open_files::prefetch_loop, this);
+    }
+    m_open_fd_cv.notify_all();
+  }
+}
+
+template <typename sample_name_t, typename file_handle_t>
+inline void sample_list_open_files<sample_name_t, file_handle_t>
+::prefetch_loop() {
+  std::unique_lock<std::mutex> lock(m_open_fd_mutex);
+  while (true) {
+    m_open_fd_cv.wait(lock, [&] { return m_prefetch_stop || !m_prefetch_queue.empty(); });
+    if (m_prefetch_stop) {
+      return;
+    }
+    const sample_file_id_t id = m_prefetch_queue.front();
+    m_prefetch_queue.pop_front();
+    try {
+      acquire_file_handle(id, true, lock);
+    } catch (const std::exception&) {
+      /// The fetch path retries the open and reports the failure
+      if (!lock.owns_lock()) {
+        lock.lock();
+      }
+    }
+  }
+}
+
+template <typename sample_name_t, typename file_handle_t>
+inline void sample_list_open_files<sample_name_t, file_handle_t>
+::quiesce_prefetcher(std::unique_lock<std::mutex>& lock) {
+  m_prefetch_queue.clear();
+  m_prefetch_cursor = 0u;
+  m_open_fd_cv.wait(lock, [&] { return m_pending_opens.empty(); });
+}
+
+template <typename sample_name_t, typename file_handle_t>
+inline void sample_list_open_files<sample_name_t, file_handle_t>
+::stop_prefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(m_open_fd_mutex);
+    m_prefetch_stop = true;
+    m_prefetch_queue.clear();
+  }
+  m_open_fd_cv.notify_all();
+  if (m_prefetch_thread.joinable()) {
+    m_prefetch_thread.join();
+  }
+  std::lock_guard<std::mutex> lock(m_open_fd_mutex);
+  m_prefetch_stop = false;
+}
+
 template <typename sample_name_t, typename file_handle_t>
 inline bool sample_list_open_files<sample_name_t, file_handle_t>
 ::is_file_handle_valid(const file_handle_t& h) const {
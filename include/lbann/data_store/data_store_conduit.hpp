@@ -32,11 +32,20 @@
 
 #include "lbann/base.hpp"
 #include "lbann/comm.hpp"
+#include "lbann/data_store/exchange_profiler.hpp"
+#include "lbann/data_store/sample_segment.hpp"
 #include "lbann/utils/exception.hpp"
+#include "lbann/utils/quantization.hpp"
 #include "conduit/conduit_node.hpp"
 #include <unordered_map>
 #include <unordered_set>
 #include <mutex>
+#include <array>
+#include <list>
+#include <memory>
+#include <atomic>
+#include <future>
+#include <fstream>
 
 
 namespace lbann {
@@ -86,7 +95,14 @@ class data_store_conduit {
 
   void setup(int mini_batch_size);
 
-  // TODO FIXME
+  /** @brief Estimates whether the JAG samples will fit in memory
+   *
+   * If they will not, and the cmd line flags
+   * --data_store_tiered=<dir> --data_store_tiered_auto were passed,
+   * the file-backed tier is enabled; otherwise an exception is thrown.
+   *
+   * TODO FIXME
+   */
   void check_mem_capacity(lbann_comm *comm, const std::string sample_list_file, size_t stride, size_t offset);
 
   /** @brief Returns the conduit Node associated with the data_id */
@@ -152,6 +168,20 @@ class data_store_conduit {
   /** @brief Turn on explicit loading */ 
   void set_is_explicitly_loading(bool flag);
 
+  /** @brief Turn background loading on or off
+   *
+   * While on, another thread may add samples during the first epoch
+   * (see --data_store_background_preload), so a sample that is already
+   * present is not an error in set_conduit_node(), and lookups take
+   * the lock.
+   */
+  void set_is_background_loading(bool flag) { m_background_loading = flag; }
+
+  bool is_background_loading() const { return m_background_loading; }
+
+  /** @brief Returns "true" if this rank has the sample in m_data */
+  bool has_conduit_node(int data_id) const;
+
   /** @brief Marks the data_store as fully loaded
    *
    * Fully loaded means that each rank has all the data that it
@@ -166,6 +196,60 @@ class data_store_conduit {
   void set_loading_is_complete(); 
 
 
+  /** @brief Returns "true" if samples are shared by all ranks on a node
+   *
+   * In node shared mode, once loading is complete, the samples owned
+   * by the ranks (in this trainer) on a compute node are moved to a
+   * single POSIX shared memory segment. Ranks read samples that are
+   * owned by a rank on the same node directly from the segment, so
+   * only off-node samples are sent via MPI. Unlike local cache mode,
+   * this works for any reader that stores conduit nodes in the data
+   * store. Node shared mode is activated via the cmd line flag:
+   * --data_store_node_shared
+   */
+  bool is_node_shared() const { return m_node_shared; }
+
+  /** @brief Returns "true" if samples are compressed in memory
+   *
+   * Activated via the cmd line flag: --data_store_compress.
+   * Samples are compressed when they are added to the data store,
+   * are exchanged in compressed form, and are decompressed by
+   * get_conduit_node(), i.e, on the I/O threads. By default every
+   * numeric field of at least m_compress_min_bytes is compressed;
+   * --data_store_compress_fields=<name,name,...> restricts compression
+   * to the named fields, e.g, so that labels and responses are
+   * stored as-is.
+   *
+   * Floating-point fields may also be stored in reduced precision,
+   * via --data_store_quantize=<name:type,name:type,...>, where type is
+   * uint8 (scaled to the sample's range of the field), fp16 or bf16.
+   * Quantized fields are restored to their original type by
+   * get_conduit_node(), and are deflated only if --data_store_compress
+   * is also given.
+   */
+  bool is_compressed() const { return m_compress; }
+
+  /** @brief Returns "true" if shuffles should favor locally owned samples
+   *
+   * Activated via the cmd line flag: --data_store_locality_shuffle.
+   * See localize_shuffled_indices()
+   */
+  bool is_locality_aware_shuffle() const { return m_locality_shuffle; }
+
+  /** @brief Permutes shuffled indices so that ranks consume their own samples
+   *
+   * Within each window of m_owner_map_mb_size positions, samples are
+   * moved to the slots that are consumed by the rank that owns them,
+   * as far as the slots allow; the remaining samples fill the remaining
+   * slots. The set of samples in each window, and hence the statistics
+   * of the global shuffle, are unchanged; only the number of samples that
+   * must be exchanged is reduced. This is a no-op until the owner map is
+   * known (i.e, after preloading, or once the owner maps have been
+   * exchanged when explicitly loading). The result depends only on the
+   * input and the owner map, so all ranks in the trainer agree on it.
+   */
+  void localize_shuffled_indices(std::vector<int> &indices);
+
   /** @brief turns local cache mode on of off */
   void set_is_local_cache(bool flag) { m_is_local_cache = flag; }
 
@@ -179,16 +263,34 @@ class data_store_conduit {
   /// fills in m_owner, which maps index -> owning processor
   void exchange_owner_maps();
 
-  /// fills in m_owner, which maps index -> owning processor
+  /** @brief Rebalances the samples after the trainers are regrouped
+   *
+   * Collective over the world; call after lbann_comm::split_trainers
+   * has changed the number of processes per trainer. Each trainer
+   * keeps one copy of every sample, held by its lowest rank that has
+   * one; samples that no rank of a trainer holds are sent to it from
+   * the memory of another trainer. Other copies are dropped and
+   * m_owner is rebuilt. Requires loading to be complete, and may not
+   * be used when spilling, tiering, or sharing samples on a node.
+   */
+  void rebalance_after_trainer_resize();
+
+  /** @brief Computes the ownership function used when preloading
+   *
+   * P_r owns the next per_rank_list_sizes[r] indices, in sorted order;
+   * this is stored as one index range per rank (m_owner_ranges), so
+   * no map is built or exchanged, and get_index_owner() is a search
+   * over m_np_in_trainer values
+   */
   void build_preloaded_owner_map(const std::vector<int>& per_rank_list_sizes);
 
   /// fills in m_owner, which maps index -> owning processor
-  void set_preloaded_owner_map(const std::unordered_map<int,int> &owner) { m_owner = owner; }
+  void set_preloaded_owner_map(const std::unordered_map<int,int> &owner) { m_owner = owner; m_owner_ranges.clear(); }
 
   /** @brief Special hanling for ras_lipid_conduit_data_reader; may go away in the future */
   void clear_owner_map();
 
-  void set_owner_map(const std::unordered_map<int, int> &m) { m_owner = m; }
+  void set_owner_map(const std::unordered_map<int, int> &m) { m_owner = m; m_owner_ranges.clear(); }
 
   /** @brief Special handling for ras_lipid_conduit_data_reader; may go away in the future */
   void add_owner(int data_id, int owner) { m_owner[data_id] = owner; }
@@ -202,7 +304,7 @@ class data_store_conduit {
 
   /// returns the processor that owns the data associated
   /// with the index
-  int get_index_owner(int idx);
+  int get_index_owner(int idx) const;
 
 
   /** @brief Read the data set into memory
@@ -212,6 +314,13 @@ class data_store_conduit {
    */
   void preload_local_cache();
 
+  /** @brief Fills in m_minibatch_data with the samples needed for a mini-batch
+   *
+   * If pipelining is enabled (cmd line flag: --data_store_pipeline_exchange)
+   * the exchange for the following mini-batch is posted before returning,
+   * and is completed during the next call, so that the communication
+   * overlaps with fetching (and computing on) the current mini-batch.
+   */
   void exchange_mini_batch_data(size_t current_pos, size_t mb_size); 
 
   void set_node_sizes_vary() { m_node_sizes_vary = true; }
@@ -242,10 +351,23 @@ class data_store_conduit {
    */
   void flush_profile_file() const; 
 
-  /** @brief Writes object's state to file */
+  /** @brief Writes object's state to file
+   *
+   * If the cmd line flag --data_store_async_checkpoint was passed, the
+   * metadata is written, and the samples are snapshotted, before this
+   * returns; the samples are then written to a single file per rank
+   * by a background thread. See wait_for_checkpoint()
+   */
   void write_checkpoint(std::string dir_name);
+
+  /** @brief Blocks until a background checkpoint, if any, has been written */
+  void wait_for_checkpoint();
   
-  /** @brief Loads object's state from file */
+  /** @brief Loads object's state from file
+   *
+   * Checkpoints written with --data_store_async_checkpoint are mmap'd,
+   * not parsed; the samples are then viewed directly from the file
+   */
   void load_checkpoint(std::string dir_name, generic_data_reader *reader = nullptr);
 
   /** @brief Add text to the profiling file, if it's opened */
@@ -317,10 +439,67 @@ private :
   /** @brief maps data_id to m_m_cur_spill_dir_integer. */
   map_ii_t m_spilled_nodes;
 
+  /** @brief if true, preloaded samples are stored in a file-backed tier
+   *
+   * Activated via the cmd line flag: --data_store_tiered=<dir>.
+   * Each rank appends its samples to a single mmap'd file in <dir>
+   * (which should be node-local, e.g, NVMe), and only the most
+   * recently used samples are kept in m_data.
+   */
+  bool m_tiered = false;
+
+  /** @brief Directory that contains the file-backed tier */
+  std::string m_tier_dir;
+
+  /** @brief The file-backed tier; opened when the first sample is stored */
+  std::unique_ptr<sample_segment> m_segment;
+
+  /** @brief Max number of tiered samples to keep in m_data
+   *
+   * Set via the cmd line flag: --data_store_tiered_cache=<n>; this is
+   * exceeded, if necessary, by the number of samples that must be
+   * sent for a single mini-batch
+   */
+  size_t m_max_resident = 1024;
+
+  /** @brief data_ids of tiered samples that are in m_data, most recently used first */
+  std::list<int> m_lru;
+  std::unordered_map<int, std::list<int>::iterator> m_lru_pos;
+
   /// used in set_conduit_node(...)
-  std::mutex m_mutex;
+  mutable std::mutex m_mutex;
   std::mutex m_mutex_2;
 
+  /// for use in node shared mode; see is_node_shared()
+  bool m_node_shared = false;
+  bool m_have_trainer_node_comm = false;
+  /// the ranks in this trainer that are on this compute node
+  El::mpi::Comm m_trainer_node_comm;
+  /// m_is_node_local[p] is true if P_p (rank in trainer) is on this node
+  std::vector<bool> m_is_node_local;
+  /// maps data_id -> offset in m_node_seg, for all samples on this node
+  map_is_t m_node_seg_offsets;
+  char *m_node_seg = nullptr;
+  size_t m_node_seg_length = 0;
+  std::string m_node_seg_name;
+
+  /// see write_checkpoint()
+  bool m_async_checkpoint = false;
+  std::future<void> m_checkpoint_writer;
+  /// an asynchronous checkpoint that was loaded; m_data views into it
+  std::unique_ptr<sample_segment> m_checkpoint_segment;
+
+  /// for use in compressed mode; see is_compressed()
+  bool m_compress = false;
+  /// zlib-compress fields; m_compress is also set when only quantizing
+  bool m_deflate = false;
+  std::vector<std::string> m_compress_fields;
+  std::vector<std::pair<std::string, utils::storage_type>> m_quantize_fields;
+  static constexpr size_t m_compress_min_bytes = 1024;
+  /// distinguishes this object's samples in the decompression cache
+  size_t m_instance_id = s_num_instances++;
+  static std::atomic<size_t> s_num_instances;
+
   /// for use in local cache mode
   char *m_mem_seg = 0;
   size_t m_mem_seg_length = 0;
@@ -385,6 +564,12 @@ private :
    */
   bool m_explicitly_loading = false;
 
+  /** @brief Samples are being added by a background thread
+   *
+   * See set_is_background_loading()
+   */
+  bool m_background_loading = false;
+
   /// The size of the mini-batch that was used to calculate ownership
   /// of samples when building the owner map.  This size has to be
   /// used consistently when computing the indices that will be sent
@@ -412,9 +597,23 @@ private :
   int  m_rank_in_world = -1; // -1 for debugging 
   int  m_np_in_trainer;
 
-  /** @brief Maps an index to the processor that owns the associated data */ 
+  /** @brief Maps an index to the processor that owns the associated data
+   *
+   * If m_owner_ranges is non-empty, this only contains the exceptions
+   * to the ownership function, i.e, re-owned samples
+   */
   map_ii_t m_owner;
 
+  /** @brief Index ranges owned by each rank, when ownership is computed
+   *
+   * P_r owns the indices in [m_owner_ranges[r], m_owner_ranges[r+1]),
+   * less those in m_owner; see build_preloaded_owner_map()
+   */
+  std::vector<int> m_owner_ranges;
+
+  /** @brief Returns the owner of the index, or -1 if it has none */
+  int find_index_owner(int idx) const;
+
   /// convenience handle
   const std::vector<int> *m_shuffled_indices;
 
@@ -432,20 +631,92 @@ private :
    */
   std::unordered_map<int, conduit::Node> m_data_cache;
 
-  /// Contains the list of data IDs that will be received
-  std::vector<int> m_recv_data_ids;
   map_ii_t m_recv_sample_sizes;
 
   /// This vector contains Nodes that this processor needs for
   /// the current minibatch; this is filled in by exchange_data()
   std::unordered_map<int, conduit::Node> m_minibatch_data;
 
+  /** @brief Work space for a single (possibly in-flight) sample exchange */
+  struct exchange_workspace {
+    std::vector<El::mpi::Request<El::byte>> send_requests;
+    std::vector<El::mpi::Request<El::byte>> recv_requests;
+    std::vector<conduit::Node> recv_buffer;
+    /// Contains the list of data IDs that will be received
+    std::vector<int> recv_data_ids;
+    /// recv_buffer[recv_buffer_index[j]] + recv_offsets[j] is where
+    /// the sample recv_data_ids[j] starts
+    std::vector<size_t> recv_buffer_index;
+    std::vector<size_t> recv_offsets;
+    /// samples that are read from the node shared segment instead
+    /// of being received
+    std::vector<int> node_local_data_ids;
+    /// packed samples; only used with --data_store_aggregate_exchange
+    std::vector<std::vector<El::byte>> send_buffers;
+    /// the mini-batch for which the exchange was started
+    size_t current_pos = 0;
+    size_t mb_size = 0;
+    /// true if sends and recvs have been posted, but not waited on
+    bool in_flight = false;
+  };
+
+  /** @brief Rotating work spaces for exchange_data_by_sample
+   *
+   * When pipelining, m_exchange_ws[m_cur_exchange_ws] holds the
+   * exchange for the next mini-batch, while the other work space
+   * holds the receive buffers that back the current
+   * m_minibatch_data. Only m_exchange_ws[0] is used otherwise.
+   */
+  std::array<exchange_workspace, 2> m_exchange_ws;
+  int m_cur_exchange_ws = 0;
+
+  /** @brief If true, overlap the exchange for mini-batch N+1 with N
+   *
+   * Set via the cmd line flag: --data_store_pipeline_exchange
+   */
+  bool m_pipeline_exchange = false;
+
+  /// number of mini-batches whose exchange was posted during the
+  /// preceding call to exchange_mini_batch_data
+  size_t m_num_pipelined_exchanges = 0;
+
+  /** @brief If true, all samples bound for a peer are sent in one message
+   *
+   * Set via the cmd line flag: --data_store_aggregate_exchange
+   */
+  bool m_aggregate_exchange = false;
+
+  /// tag used for the per-peer messages when aggregating
+  static constexpr int m_aggregated_exchange_tag = 0;
+
+  /// number of point-to-point messages sent by exchange_data_by_sample
+  size_t m_num_exchange_msgs = 0;
+
+  /** @brief Per-phase and per-peer exchange statistics
+   *
+   * nullptr, so that nothing is recorded, unless the cmd line flag
+   * --data_store_exchange_profile was passed; in that case every rank
+   * appends one JSON line per epoch to m_exchange_profile_filename.
+   */
+  std::unique_ptr<exchange_profiler> m_exchange_profiler;
+  std::unique_ptr<std::ofstream> m_exchange_profile_file;
+  std::string m_exchange_profile_filename;
+  int m_exchange_profile_epoch = 0;
+
+  /// see is_locality_aware_shuffle()
+  bool m_locality_shuffle = false;
+
+  /// samples (and their bytes) this rank needed that it, or a rank on
+  /// this node in node shared mode, owned; i.e, did not cross the network
+  size_t m_num_local_samples = 0;
+  size_t m_num_local_bytes = 0;
+  /// samples (and their bytes) this rank received from off-node peers
+  size_t m_num_remote_samples = 0;
+  size_t m_num_remote_bytes = 0;
+
   /// work space; used in exchange_data
   std::vector<conduit::Node> m_send_buffer;
   std::vector<conduit::Node> m_send_buffer_2;
-  std::vector<El::mpi::Request<El::byte>> m_send_requests;
-  std::vector<El::mpi::Request<El::byte>> m_recv_requests;
-  std::vector<conduit::Node> m_recv_buffer;
   std::vector<size_t> m_outgoing_msg_sizes;
   std::vector<size_t> m_incoming_msg_sizes;
 
@@ -468,12 +739,62 @@ private :
   /// this proc needs to recv from others. (formerly called "needed")
   std::vector<std::unordered_set<int>> m_indices_to_recv;
 
+  /// indices this proc needs that are owned by a rank on the same
+  /// node; only used in node shared mode. This is filled in by
+  /// build_indices_i_will_recv()
+  std::vector<int> m_node_local_indices_to_recv;
+
   //=========================================================================
   // methods follow 
   //=========================================================================
 
   void exchange_data_by_sample(size_t current_pos, size_t mb_size);
 
+  /** @brief Posts the nonblocking sends and recvs for a mini-batch */
+  void start_exchange_data_by_sample(size_t current_pos, size_t mb_size, exchange_workspace &ws);
+
+  /** @brief Packs all samples bound for a peer into a single buffer,
+   *         then posts one send and one recv per peer
+   *
+   * Called by start_exchange_data_by_sample when aggregating; on the
+   * receive side the samples are viewed (not copied) from the
+   * per-peer buffers. Returns the time spent packing.
+   */
+  double start_exchange_data_by_peer(exchange_workspace &ws);
+
+  /** @brief Adds the per-peer traffic for the mini-batch whose indices
+   *         were built last to m_exchange_profiler
+   */
+  void record_exchange_traffic();
+
+  /** @brief Accumulates the local vs remote sample counts for the
+   *         mini-batch whose indices were built last
+   */
+  void count_local_samples();
+
+  /** @brief Returns the number of bytes a sample occupies in a message */
+  size_t get_exchange_sample_size(int data_id) const;
+
+  /** @brief Waits on the sends and recvs posted by start_exchange_data_by_sample,
+   *         then fills in m_minibatch_data from the received buffers
+   */
+  void finish_exchange_data_by_sample(exchange_workspace &ws);
+
+  /** @brief Waits on, and discards, any exchanges that are in flight */
+  void drain_pipelined_exchanges();
+
+  /** @brief Computes the extent of the mini-batch that follows the
+   *         one starting at current_pos
+   *
+   * @return false, if there is no following mini-batch in this epoch
+   */
+  bool get_next_mini_batch_extent(size_t current_pos, size_t &next_pos, size_t &next_mb_size) const;
+
+  /** @brief Returns true if the exchange for the next mini-batch may be
+   *         posted before the current mini-batch has been consumed
+   */
+  bool can_pipeline_exchange() const;
+
   void setup_data_store_buffers();
 
   /// called by exchange_data
@@ -552,6 +873,70 @@ private :
   /** @brief Loads conduit nodes from file into m_data */
   void load_spilled_conduit_nodes();
 
+  /** @brief Moves the samples owned by ranks on this node into a
+   *         shared memory segment; see is_node_shared()
+   */
+  void share_node_local_samples();
+
+  /** @brief Unmaps (and, on the node leader, unlinks) the node shared segment */
+  void free_node_shared_segment();
+
+  /** @brief Copies 'node_in' to 'node_out', replacing fields with
+   *         their compressed bytes; see is_compressed()
+   */
+  void compress_node(const conduit::Node &node_in, conduit::Node &node_out) const;
+
+  /** @brief Recursive helper for compress_node */
+  void compress_subtree(const conduit::Node &node_in, const std::string &path, conduit::Node &node_out, conduit::Node &fields) const;
+
+  /** @brief Returns true if the leaf at 'path' should be compressed */
+  bool is_compressible(const conduit::Node &leaf, const std::string &path) const;
+
+  /** @brief Returns true if the leaf at 'path' should be quantized,
+   *         and the type to store it as in 't'
+   */
+  bool is_quantized(const conduit::Node &leaf, const std::string &path, utils::storage_type &t) const;
+
+  /** @brief Reverses compress_node
+   *
+   * The returned node is cached per thread, so that fetching the
+   * datum and the label for a sample decompresses it only once
+   */
+  const conduit::Node & decompress_node(int data_id, const conduit::Node &node) const;
+
+  /** @brief Snapshots the samples and starts the background writer; see write_checkpoint() */
+  void write_checkpoint_async(const std::string &dir_name);
+
+  /** @brief Returns the pathname of this rank's asynchronous checkpoint */
+  std::string get_checkpoint_segment_fn() const;
+
+  /** @brief Builds a packed node (see build_node_for_sending) that
+   *         references, instead of copies, the bytes in 'buf'
+   */
+  void view_packed_node_for_sending(const conduit::uint8 *buf, conduit::Node &node) const;
+
+  /** @brief Turns on the file-backed tier; see m_tiered */
+  void setup_tier(const std::string &dir);
+
+  /** @brief Returns the pathname of this rank's file-backed tier */
+  std::string get_segment_fn() const;
+
+  /** @brief Stores a preloaded sample in the file-backed tier */
+  void set_preloaded_tiered_conduit_node(int data_id, const conduit::Node &node);
+
+  /** @brief Ensures the samples in m_indices_to_send are in m_data
+   *
+   * Samples are copied from the file-backed tier as needed, then
+   * the least recently used samples are evicted from m_data
+   */
+  void load_tiered_conduit_nodes();
+
+  /** @brief Builds a view of a packed node (see build_node_for_sending)
+   *
+   * On return, n_msg["data"] references (does not copy) the sample in 'buf'
+   */
+  void view_packed_node(const conduit::uint8 *buf, conduit::Node &n_msg) const;
+
   /** @brief Creates directory structure, opens metadata file for output, etc
    *
    * This method is called for both --data_store_spill and 
@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_DATA_STORE_EXCHANGE_PROFILER_HPP_INCLUDED
+#define LBANN_DATA_STORE_EXCHANGE_PROFILER_HPP_INCLUDED
+
+#include <array>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace lbann {
+
+/** @brief Per-step statistics for the data store's mini-batch exchange
+ *
+ * data_store_conduit records the time each exchange spends in each
+ * phase, and the bytes and messages sent to and received from each
+ * peer. write_json() emits a one-line JSON summary (totals, p50, p99
+ * and max for each phase, and the per-peer traffic), then resets the
+ * statistics; data_store_conduit calls it once per epoch, on every
+ * rank, so that stragglers can be identified.
+ */
+class exchange_profiler {
+public:
+  enum phase {
+    /// building the index sets, loading tiered/spilled samples, packing buffers
+    PACK = 0,
+    /// posting the nonblocking sends and recvs
+    POST,
+    /// waiting for the sends and recvs to complete
+    WAIT,
+    /// building views of the received samples
+    UNPACK,
+    NUM_PHASES
+  };
+
+  explicit exchange_profiler(int num_peers);
+
+  /** @brief Records the time spent in a phase by one exchange */
+  void record(phase p, double seconds) { m_times[p].push_back(seconds); }
+
+  void add_sent(int peer, size_t bytes, size_t msgs) {
+    m_peers[peer].bytes_sent += bytes;
+    m_peers[peer].msgs_sent += msgs;
+  }
+
+  void add_received(int peer, size_t bytes, size_t msgs) {
+    m_peers[peer].bytes_rcvd += bytes;
+    m_peers[peer].msgs_rcvd += msgs;
+  }
+
+  /** @brief Returns the number of exchanges recorded for a phase */
+  size_t get_num_steps(phase p) const { return m_times[p].size(); }
+
+  /** @brief Returns the q'th quantile (0 <= q <= 1) of a phase's times */
+  double get_quantile(phase p, double q) const;
+
+  /** @brief Writes the statistics as a single line of JSON, then resets them */
+  void write_json(std::ostream &os, const std::string &role, int rank, int epoch);
+
+  static const char* get_phase_name(phase p);
+
+private:
+  struct peer_traffic {
+    size_t bytes_sent = 0;
+    size_t msgs_sent = 0;
+    size_t bytes_rcvd = 0;
+    size_t msgs_rcvd = 0;
+  };
+
+  std::array<std::vector<double>, NUM_PHASES> m_times;
+  std::vector<peer_traffic> m_peers;
+};
+
+} // namespace lbann
+
+#endif // LBANN_DATA_STORE_EXCHANGE_PROFILER_HPP_INCLUDED
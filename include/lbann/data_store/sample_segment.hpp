@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_DATA_STORE_SAMPLE_SEGMENT_HPP_INCLUDED
+#define LBANN_DATA_STORE_SAMPLE_SEGMENT_HPP_INCLUDED
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
+
+namespace lbann {
+
+/** @brief A single, append-only, memory-mapped file of samples
+ *
+ * Used by data_store_conduit as a file-backed tier for datasets that
+ * do not fit in memory: each rank appends its (compacted) samples to
+ * one large file, ideally on node-local storage, and reads them back
+ * through an mmap'd view of the file. Samples are located via an
+ * index that maps data_id -> (offset, size).
+ *
+ * Appending is not thread safe; callers are expected to serialize
+ * calls to append().
+ *
+ * A segment may also be persisted, i.e, its index written next to it
+ * and the file kept on close(), so that it can later be attached and
+ * read back without parsing; data_store_conduit uses this for its
+ * asynchronous checkpoints.
+ */
+class sample_segment {
+public:
+  sample_segment() = default;
+  ~sample_segment();
+  sample_segment(const sample_segment&) = delete;
+  sample_segment& operator=(const sample_segment&) = delete;
+
+  /** @brief Creates (or truncates) the backing file */
+  void open(const std::string &filename);
+
+  /** @brief Opens an existing, persisted segment for reading */
+  void attach(const std::string &filename);
+
+  /** @brief Unmaps and closes the backing file
+   *
+   * The file is removed, unless the segment was persisted or attached
+   */
+  void close();
+
+  /** @brief Writes the index to <filename>.index and keeps the file on close() */
+  void persist();
+
+  bool is_open() const { return m_fd != -1; }
+
+  /** @brief Writes a sample to the end of the file */
+  void append(int data_id, const void *data, size_t size);
+
+  /** @brief Returns true if the sample has been appended */
+  bool contains(int data_id) const {
+    return m_index.find(data_id) != m_index.end();
+  }
+
+  /** @brief Returns a pointer to the sample's bytes
+   *
+   * The file is (re)mapped if it has grown since it was last mapped;
+   * this invalidates previously returned pointers.
+   */
+  const char* get(int data_id, size_t &size);
+
+  /** @brief Returns the number of samples in the segment */
+  size_t get_num_samples() const { return m_index.size(); }
+
+  /** @brief Returns the number of bytes in the segment */
+  size_t get_num_bytes() const { return m_length; }
+
+  const std::string& get_filename() const { return m_filename; }
+
+  /** @brief Returns the data_ids of the samples in the segment */
+  std::vector<int> get_data_ids() const;
+
+  /** @brief Returns the name of the index file for a persisted segment */
+  static std::string get_index_fn(const std::string &filename) {
+    return filename + ".index";
+  }
+
+private:
+  struct extent {
+    size_t offset;
+    size_t size;
+  };
+
+  std::string m_filename;
+  int m_fd = -1;
+  /// number of bytes written to the file
+  size_t m_length = 0;
+  /// beginning and length of the current mapping, if any
+  char *m_map = nullptr;
+  size_t m_map_length = 0;
+  std::unordered_map<int, extent> m_index;
+  /// if true, the file is not removed by close()
+  bool m_persistent = false;
+
+  void unmap();
+};
+
+} // namespace lbann
+
+#endif // LBANN_DATA_STORE_SAMPLE_SEGMENT_HPP_INCLUDED
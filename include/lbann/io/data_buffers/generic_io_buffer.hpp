@@ -78,6 +78,34 @@ class fetch_data_functor {
     }
     return num_samples_fetched;
   }
+#ifdef LBANN_HAS_GPU
+  /** Whether samples may be fetched to the device while the
+   *  responses are fetched on the host. */
+  bool supports_device_samples() const {
+    return (_target_mode == data_reader_target_mode::CLASSIFICATION
+            || _target_mode == data_reader_target_mode::REGRESSION);
+  }
+  int operator() (El::Matrix<DataType, El::Device::GPU>& samples, CPUMatDT<TensorDataType>& responses, El::Matrix<El::Int>& indices_fetched, generic_data_reader* data_reader, cudaStream_t stream) const {
+    int num_samples_fetched = data_reader->fetch_data_on_device(samples, indices_fetched, stream);
+    int num_responses_fetched;
+    switch(_target_mode) {
+    case data_reader_target_mode::REGRESSION:
+      num_responses_fetched = data_reader->fetch_responses(responses);
+      break;
+    case data_reader_target_mode::CLASSIFICATION:
+      num_responses_fetched = data_reader->fetch_labels(responses);
+      break;
+    default:
+      throw lbann_exception("Invalid data reader target mode for fetching to the device");
+    }
+    if(num_samples_fetched != num_responses_fetched) {
+      std::string err = std::string("Number of samples: ") + std::to_string(num_samples_fetched)
+        + std::string(" does not match the number of responses: ") + std::to_string(num_responses_fetched);
+      throw lbann_exception(err);
+    }
+    return num_samples_fetched;
+  }
+#endif // LBANN_HAS_GPU
  private:
   const data_reader_target_mode _target_mode;
 };
@@ -28,6 +28,10 @@
 #define LBANN_PARTITIONED_IO_BUFFER_HPP_INCLUDED
 
 #include "lbann/io/data_buffers/generic_io_buffer.hpp"
+#ifdef LBANN_HAS_GPU
+#include "lbann/utils/cuda.hpp"
+#include "lbann/utils/pinned_memory.hpp"
+#endif // LBANN_HAS_GPU
 
 namespace lbann {
 
@@ -51,6 +55,18 @@ public:
   std::future<void> m_data_fetch_future;
   /// 1-D Matrix of which indices were fetched in this mini-batch
   El::Matrix<El::Int> m_indices_fetched_per_mb;
+#ifdef LBANN_HAS_GPU
+  /** Device copies of m_input_buffers, filled on the io buffer's copy
+   *  stream as soon as a fetch completes */
+  std::vector<std::unique_ptr<AbsDistMatrixType>> m_device_buffers;
+  /** Recorded on the copy stream after the host-to-device copies */
+  cuda::event_wrapper m_copy_done;
+  /** Pinned memory of m_input_buffers, leased in setup_data. Not
+   *  copied; copies own their memory. */
+  std::vector<pinned_memory_pool::lease> m_input_leases;
+  /** True if m_device_buffers hold the fetched mini-batch */
+  std::atomic<bool> m_device_buffers_ready;
+#endif // LBANN_HAS_GPU
 
   data_buffer(lbann_comm *comm, int num_child_layers) :
     m_num_samples_fetched(0), m_fetch_data_in_background(false)
@@ -60,11 +76,18 @@ public:
     for(int i = 0; i < num_child_layers; i++) {
       m_input_buffers[i].reset(new StarVCMatDT<TensorDataType, El::Device::CPU>(comm->get_trainer_grid()));
     }
+#ifdef LBANN_HAS_GPU
+    m_device_buffers_ready = false;
+#endif // LBANN_HAS_GPU
   }
 
   data_buffer(const data_buffer& other) :
     m_num_samples_fetched(other.m_num_samples_fetched)
   {
+#ifdef LBANN_HAS_GPU
+    // Device buffers are allocated again when they are first needed
+    m_device_buffers_ready = false;
+#endif // LBANN_HAS_GPU
     m_fetch_data_in_background.store(other.m_fetch_data_in_background);
     m_input_buffers.clear();
     m_input_buffers.reserve(other.m_input_buffers.size());
@@ -80,6 +103,9 @@ public:
     for (const auto& ptr : other.m_input_buffers) {
       m_input_buffers.emplace_back(ptr ? ptr->Copy() : nullptr);
     }
+#ifdef LBANN_HAS_GPU
+    m_input_leases.clear();
+#endif // LBANN_HAS_GPU
     return *this;
   }
   data_buffer* copy() const { return new data_buffer(*this); }
@@ -153,6 +179,33 @@ public:
    *  or label or responase.
    */
   data_buffer_map_t m_data_buffers;
+
+private:
+  /** Largest mini-batch, for sizing the device buffers */
+  El::Int m_max_mini_batch_size = 0;
+#ifdef LBANN_HAS_GPU
+  /** @brief Allocate device buffers and start copying mini-batches
+   *         to them as soon as they are fetched
+   *
+   *  Called the first time a mini-batch is distributed to GPU
+   *  matrices, so that CPU models never allocate device memory.
+   */
+  void enable_device_staging();
+  /** @brief Enqueue the host-to-device copies of a fetched mini-batch
+   *         on m_copy_stream
+   *
+   *  Host buffers before first have already been filled on the device.
+   */
+  void copy_to_device(data_buffer<IODataType>& buf, size_t first = 0);
+
+  /** Stream for the host-to-device copies, so they overlap compute */
+  cudaStream_t m_copy_stream;
+  /** The device of the thread that built this object; the copies are
+   *  issued from I/O threads */
+  int m_device;
+  /** True once the input layer's outputs are found to be on the GPU */
+  std::atomic<bool> m_stage_on_device;
+#endif // LBANN_HAS_GPU
 };
 }
 
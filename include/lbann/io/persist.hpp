@@ -37,7 +37,11 @@
 #include <cereal/archives/xml.hpp>
 #include <cereal/types/base_class.hpp>
 #include <cereal/types/polymorphic.hpp>
+#include <functional>
+#include <set>
 #include <sstream>
+#include <streambuf>
+#include <vector>
 
 namespace lbann {
 
@@ -107,11 +111,40 @@ enum class callback_type {
   invalid
 };
 
+/** @brief Role of a checkpoint in a delta checkpoint sequence. */
+enum class checkpoint_delta {
+  /** Write every matrix. */
+  none,
+  /** Write every matrix and remember them for later deltas. */
+  base,
+  /** Only write matrices that have changed since the base. */
+  delta,
+};
+
 class persist {
+ public:
+  /** File write that has been deferred. */
+  using deferred_write = std::function<void()>;
  private:
   std::map<persist_type, uint64_t> m_bytes;
   std::map<persist_type, std::string> m_filenames;
   callback_type ckpt_type;
+  /** Whether matrix writes are deferred. */
+  bool m_defer_writes = false;
+  /** Deferred matrix writes. */
+  std::vector<deferred_write> m_deferred_writes;
+  /** Trainer ranks that write stripes of shared matrix files. */
+  std::vector<int> m_io_aggregators;
+  /** Role of the current checkpoint in a delta sequence. */
+  checkpoint_delta m_delta = checkpoint_delta::none;
+  /** Checkpoint directory holding matrices skipped by a delta. */
+  std::string m_base_dir;
+  /** Checksums of local matrix data in the base checkpoint. */
+  std::map<std::string, uint64_t> m_base_checksums;
+  /** Whether GPU matrices are read and written with cuFile. */
+  bool m_gpu_direct_storage = false;
+  /** Persist types whose rank matrix files are compressed. */
+  std::set<persist_type> m_compressed_types;
  public:
   std::string m_checkpoint_dir;
 
@@ -154,6 +187,84 @@ class persist {
     }
   }
 
+  /** @brief Defer matrix writes.
+   *
+   *  While enabled, write_rank_distmat and write_distmat copy matrix
+   *  data into host memory, which is usually much faster than
+   *  writing it. The files are written when the deferred writes are
+   *  run, which can be on another thread since they do not access
+   *  the matrices or communicate. Other checkpoint data is written
+   *  immediately.
+   */
+  void set_defer_writes(bool defer) { m_defer_writes = defer; }
+  bool get_defer_writes() const noexcept { return m_defer_writes; }
+  /** @brief Take ownership of the deferred writes. */
+  std::vector<deferred_write> take_deferred_writes() {
+    std::vector<deferred_write> writes;
+    std::swap(writes, m_deferred_writes);
+    return writes;
+  }
+
+  /** @brief Write shared matrix files in parallel stripes.
+   *
+   *  Each matrix written with write_distmat is split into contiguous
+   *  column blocks, one per aggregator. Every block is gathered to
+   *  its aggregator, which writes it at its offset in the shared
+   *  file. The file layout is the same as El::Write, so it can be
+   *  read back with any number of processes. If empty, the trainer
+   *  root writes each file.
+   */
+  void set_io_aggregators(std::vector<int> ranks) {
+    m_io_aggregators = std::move(ranks);
+  }
+  const std::vector<int>& get_io_aggregators() const noexcept {
+    return m_io_aggregators;
+  }
+
+  /** @brief Write a delta checkpoint or the base for later deltas.
+   *
+   *  A delta checkpoint skips matrices whose local data matches the
+   *  last base checkpoint and records @c base_dir in the checkpoint
+   *  directory (see write_base_dir). While restarting, matrices that
+   *  are missing from a delta checkpoint are read from its base.
+   */
+  void set_delta(checkpoint_delta delta, std::string base_dir = "") {
+    m_delta = delta;
+    m_base_dir = std::move(base_dir);
+  }
+  checkpoint_delta get_delta() const noexcept { return m_delta; }
+  /** @brief Record the base directory in the checkpoint directory. */
+  void write_base_dir() const;
+
+  /** @brief Move GPU matrix data directly between storage and GPU
+   *  memory.
+   *
+   *  While enabled, write_rank_distmat and read_rank_distmat use
+   *  GPUDirect Storage (cuFile) for contiguous GPU matrices instead
+   *  of going through host memory. The file layout is unchanged.
+   *  Deferred writes still copy to host memory. Ignored if LBANN is
+   *  built without cuFile.
+   */
+  void set_gpu_direct_storage(bool gds) { m_gpu_direct_storage = gds; }
+  bool get_gpu_direct_storage() const noexcept { return m_gpu_direct_storage; }
+
+  /** @brief Compress the rank matrix files of a persist type.
+   *
+   *  While enabled, write_rank_distmat compresses the local data in
+   *  independent blocks on several threads (see
+   *  utils::compress_blocks) and adds a ".z" suffix to the file
+   *  name. read_rank_distmat detects compressed files regardless of
+   *  this setting and decompresses them in parallel. Compressed
+   *  writes skip cuFile.
+   */
+  void set_compressed(persist_type type, bool compress) {
+    if (compress) { m_compressed_types.insert(type); }
+    else { m_compressed_types.erase(type); }
+  }
+  bool is_compressed(persist_type type) const {
+    return m_compressed_types.count(type) > 0;
+  }
+
   template <typename TensorDataType>
   bool write_rank_distmat(persist_type type, const char *name, const El::AbstractDistMatrix<TensorDataType>& M);
   template <typename TensorDataType>
@@ -167,6 +278,18 @@ class persist {
   const std::string& get_checkpoint_dir() const { return m_checkpoint_dir; }
 
   std::string get_filename(persist_type type) const;
+
+ private:
+  /** @brief Whether the current checkpoint can skip a matrix.
+   *
+   *  In a base checkpoint, this records the checksum of the local
+   *  data. If @c collective, every process in the matrix's grid
+   *  must call this and the result is the same on all of them.
+   */
+  template <typename TensorDataType>
+  bool skip_unchanged(const std::string& key,
+                      const El::AbstractDistMatrix<TensorDataType>& M,
+                      bool collective);
 };
 
 bool write_bytes(int fd, const char *name, const void *buf, size_t size);
@@ -251,14 +374,87 @@ void unpack_cereal_archive_binary_string(C& obj, const std::string& buf) {
   } // archive goes out of scope, ensuring all contents are flushed
 }
 
+/** @brief Stream buffer that broadcasts within a trainer.
+ *
+ *  The root writes into a fixed-size chunk, which is broadcast as
+ *  soon as it fills. The other processes read from the last chunk
+ *  they received and wait for the next chunk when it runs out. Thus
+ *  serialization on the root and deserialization on the other
+ *  processes are pipelined, and no process holds more than one chunk
+ *  of the serialized object.
+ *
+ *  Every process must call @c finish once the object is written or
+ *  read.
+ */
+class trainer_broadcast_streambuf : public std::streambuf {
+public:
+  trainer_broadcast_streambuf(lbann_comm& comm,
+                              int root,
+                              size_t chunk_size = 1 << 20);
+  ~trainer_broadcast_streambuf() override = default;
+  trainer_broadcast_streambuf(const trainer_broadcast_streambuf&) = delete;
+  trainer_broadcast_streambuf& operator=(const trainer_broadcast_streambuf&) = delete;
+
+  /** Broadcast the last, partially filled chunk on the root and
+   *  receive any unread chunks on the other processes. */
+  void finish();
+
+protected:
+  int_type overflow(int_type ch) override;
+  int_type underflow() override;
+  int sync() override { return 0; }
+
+private:
+  /** Broadcast a chunk with @c size bytes from the root.
+   *
+   *  @c size is ignored on the other processes. Returns the size of
+   *  the chunk. A chunk that is not full is the last one.
+   */
+  size_t broadcast_chunk(size_t size);
+
+  lbann_comm& m_comm;
+  int m_root;
+  bool m_is_root;
+  size_t m_chunk_size;
+  /** Size of the chunk, followed by its data. */
+  std::vector<char> m_buffer;
+  /** Whether the last chunk has been broadcast. */
+  bool m_done = false;
+};
+
+/** @brief Broadcast an object from a process to the rest of its
+ *  trainer with a binary archive.
+ *
+ *  The archive is streamed in fixed-size chunks, so the whole
+ *  serialized object is never stored.
+ *
+ *  @todo This assumes homogeneous processors.
+ */
+template <typename C>
+void broadcast_cereal_archive_binary(C& obj, lbann_comm& comm, int root = 0) {
+  trainer_broadcast_streambuf buf(comm, root);
+  if (comm.get_rank_in_trainer() == root) {
+    std::ostream os(&buf);
+    {
+      cereal::BinaryOutputArchive archive(os);
+      archive(obj);
+    } // archive goes out of scope, ensuring all contents are flushed
+  } else {
+    std::istream is(&buf);
+    {
+      cereal::BinaryInputArchive archive(is);
+      archive(obj);
+    }
+  }
+  buf.finish();
+}
+
 template <typename C>
 void load_from_shared_cereal_archive(C& obj,
                                      lbann_comm& comm,
                                      const std::string& filename) {
-  std::string buf;
   if (comm.am_trainer_master()) {
     read_cereal_archive<C>(obj, filename);
-    buf = create_cereal_archive_binary_string<C>(obj);
   }else {
     // If you are not the trainer master, still check to see if the file exists
     std::ifstream is(filename);
@@ -267,13 +463,8 @@ void load_from_shared_cereal_archive(C& obj,
     }
   }
 
-  // TODO: this assumes homogeneous processors
   // broadcast state from rank 0
-  comm.trainer_broadcast(0, buf);
-
-  if (!comm.am_trainer_master()) {
-    unpack_cereal_archive_binary_string<C>(obj, buf);
-  }
+  broadcast_cereal_archive_binary<C>(obj, comm);
 }
 
 template <typename C>
@@ -55,6 +55,11 @@ public:
   std::string get_type() const override { return "ELU"; }
   data_layout get_data_layout() const override { return Layout; }
   El::Device get_device_allocation() const override { return Device; }
+  /** In place, backprop recovers the derivative from the output
+   *  (@f$ \alpha e^x = y + \alpha @f$ for @f$ x \leq 0 @f$). */
+  bool supports_in_place() const override {
+    return m_alpha >= El::TypeTraits<TensorDataType>::Zero();
+  }
 
   description get_description() const override {
     auto desc = data_type_layer<TensorDataType>::get_description();
@@ -72,6 +72,11 @@ public:
   std::string get_type() const override { return "leaky ReLU"; }
   data_layout get_data_layout() const override { return Layout; }
   El::Device get_device_allocation() const override { return Device; }
+  /** Backprop only needs the sign of the input, which the output
+   *  preserves if the negative slope is non-negative. */
+  bool supports_in_place() const override {
+    return m_negative_slope >= El::TypeTraits<TensorDataType>::Zero();
+  }
 
   description get_description() const override {
     auto desc = data_type_layer<TensorDataType>::get_description();
@@ -57,6 +57,9 @@ public:
   std::string get_type() const override { return "ReLU"; }
   data_layout get_data_layout() const override { return T_layout; }
   El::Device get_device_allocation() const override { return Dev; }
+  /** Backprop only needs the sign of the input, which the output
+   *  preserves. */
+  bool supports_in_place() const override { return true; }
 
 protected:
   void fp_compute() override;
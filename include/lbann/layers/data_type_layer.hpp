@@ -31,6 +31,7 @@
 #include "lbann/weights/data_type_weights.hpp"
 
 #include "lbann/utils/h2_tmp.hpp"
+#include "lbann/utils/gpu_allocator.hpp"
 
 #ifdef LBANN_HAS_DISTCONV
 #include "lbann/layers/data_type_distconv_adapter.hpp"
@@ -107,6 +108,17 @@ public:
   /** Check that the setup is reasonable. */
   void check_setup() override;
 
+  void release_activations() override;
+  bool has_activation_views() const override;
+
+  size_t get_activations_buffer_size(int child_index) const override;
+  size_t get_error_signals_buffer_size(int parent_index) const override;
+  void set_activations_buffer(int child_index, void* buffer) override;
+  void set_error_signals_buffer(int parent_index, void* buffer) override;
+
+  size_t get_activations_memory_usage(El::Device device) const override;
+  size_t get_error_signals_memory_usage(El::Device device) const override;
+
   // ===========================================================
   // Weights access functions
   // ===========================================================
@@ -125,6 +137,9 @@ public:
   /** @brief Replace weights with another Layer's weights*/
   void replace_weights(Layer* other_layer) override;
 
+  /** @brief Share another Layer's weight matrices */
+  void tie_weights(Layer* other_layer) override;
+
   // ===========================================================
   // Public Tensor access functions
   // ===========================================================
@@ -271,6 +286,12 @@ protected:
 
 private:
 
+  /** @brief Whether an output tensor is in memory from the caching
+   *         GPU allocator.
+   *  @details Such outputs are views but own their memory.
+   */
+  bool is_activations_cached(int child_index) const;
+
   /** @brief Attempt to take ownership of the previous error signal.
    *
    *  If the underlying matrix has the right datatype and
@@ -393,6 +414,35 @@ private:
    */
   bool m_persistent_error_signals = false;
 
+  /** @brief Externally managed memory for output tensors.
+   *  @details Null entries (or missing entries) mean that the tensor
+   *  owns its memory. Not copied with the layer.
+   */
+  std::vector<void*> m_activations_buffers;
+  /** @brief Externally managed memory for error signals. */
+  std::vector<void*> m_error_signals_buffers;
+
+#ifdef LBANN_HAS_GPU
+  /** @brief Memory for GPU output tensors from the caching allocator.
+   *  @details Only used with @c --gpu_caching_allocator, for outputs
+   *  without external memory. Not copied with the layer.
+   */
+  std::vector<cuda::cached_buffer> m_activations_allocations;
+#endif // LBANN_HAS_GPU
+
+  /** @brief Alignment a tensor was last set up with.
+   *  @details Tensors whose shape, memory, and alignment have not
+   *  changed since the last step are not set up again.
+   */
+  struct tensor_setup {
+    bool valid = false;
+    El::DistData alignment;
+  };
+  /** @brief Last setup of output tensors. Not copied with the layer. */
+  std::vector<tensor_setup> m_activations_setups;
+  /** @brief Last setup of error signals. Not copied with the layer. */
+  std::vector<tensor_setup> m_error_signals_setups;
+
 #ifdef LBANN_HAS_DISTCONV
   friend class data_type_distconv_adapter<TensorDataType>;
  public:
@@ -35,6 +35,7 @@
 #include "lbann/models/model.hpp"
 #include "lbann/callbacks/imcomm.hpp"
 #include "lbann/utils/omp_diagnostics.hpp"
+#include "lbann/utils/timer.hpp"
 #include <cereal/types/utility.hpp>
 #include <cereal/types/unordered_map.hpp>
 #include <cereal/types/vector.hpp>
@@ -56,7 +57,8 @@ class generic_input_layer : public io_layer<TensorDataType> {
               int num_parallel_readers,
               data_reader_target_mode dr_mode = data_reader_target_mode::CLASSIFICATION)
     : io_layer<TensorDataType>(comm, dr_mode),
-      m_io_buffers() {
+      m_io_buffers(),
+      m_prefetch_depth(data_coordinator::get_prefetch_depth()) {
       //m_data_sets_span_models(data_sets_span_models) {
     // Input layers have no parents
     this->m_expected_num_parent_layers = 0;
@@ -71,6 +73,7 @@ class generic_input_layer : public io_layer<TensorDataType> {
     this->m_active_buffer[execution_mode::training].store(-1);
     this->m_active_buffer[execution_mode::validation].store(-1);
     this->m_active_buffer[execution_mode::testing].store(-1);
+    init_prefetch_states();
   }
 
   ~generic_input_layer() override {
@@ -94,10 +97,12 @@ class generic_input_layer : public io_layer<TensorDataType> {
   // Input layers copy their datareaders.
   generic_input_layer(const generic_input_layer& other)
     : io_layer<TensorDataType>(other),
-      m_io_buffers(other.m_io_buffers) {
+      m_io_buffers(other.m_io_buffers),
+      m_prefetch_depth(other.m_prefetch_depth) {
     for (auto& io_buffer : m_io_buffers) {
       io_buffer = io_buffer->copy();
     }
+    init_prefetch_states();
   }
 
   generic_input_layer& operator=(const generic_input_layer& other) {
@@ -105,6 +110,7 @@ class generic_input_layer : public io_layer<TensorDataType> {
     for (auto& io_buffer : m_io_buffers) {
       io_buffer = io_buffer->copy();
     }
+    m_prefetch_depth = other.m_prefetch_depth;
     return *this;
   }
 
@@ -119,6 +125,7 @@ class generic_input_layer : public io_layer<TensorDataType> {
   }
 
   std::string get_type() const override { return "generic_input"; }
+  bool can_recompute_activations() const override { return false; }
 
   description get_description() const override {
     auto desc = io_layer<TensorDataType>::get_description();
@@ -128,6 +135,7 @@ class generic_input_layer : public io_layer<TensorDataType> {
 
   void setup_dims(DataReaderMetaData& dr_metadata) override {
     io_layer<TensorDataType>::setup_dims(dr_metadata);
+    m_effective_length = dr_metadata.effective_length;
     for (int i = 0; i < this->get_num_children(); ++i) {
       this->set_output_dims(get_data_dims(dr_metadata, i), i);
     }
@@ -196,18 +204,47 @@ class generic_input_layer : public io_layer<TensorDataType> {
     int active_buffer = future_active_buffer % m_io_buffers.size();
     generic_io_buffer<TensorDataType>* io_buffer = m_io_buffers[active_buffer];
     data_coordinator& dc = this->m_model->get_execution_context().get_trainer().get_data_coordinator();
-    std::lock_guard<std::mutex> guard(dc.dr_mutex);
-    setup_next_io_buffer(io_buffer);
-    io_buffer->fetch_to_local_matrix(get_data_reader(mode), mode);
+    bool last_in_epoch = false;
+    {
+      std::lock_guard<std::mutex> guard(dc.dr_mutex);
+      generic_data_reader *data_reader = get_data_reader(mode);
+      // The reader is positioned at the first mini-batch that has not
+      // been consumed; earlier buffers in the ring may still be ahead
+      const int lookahead = future_active_buffer - m_prefetch[mode].num_updates;
+      if (!data_reader->begin_lookahead(lookahead)) {
+        LBANN_ERROR("cannot prefetch ", lookahead, " mini-batches ahead; the epoch ends first");
+      }
+      setup_next_io_buffer(io_buffer);
+      io_buffer->fetch_to_local_matrix(data_reader, mode);
+      last_in_epoch = (data_reader->get_current_step_in_epoch()
+                       == data_reader->get_num_iterations_per_epoch() - 1);
+      data_reader->end_lookahead();
+    }
+
+    // Keep the ring full, stopping at the end of the epoch
+    std::lock_guard<std::mutex> guard(m_prefetch_mutex);
+    prefetch_state& state = m_prefetch[mode];
+    state.running = false;
+    state.stopped = last_in_epoch;
+    queue_prefetch(mode, true);
     return;
   }
 
   /// Check for each buffer if there is an outstanding fetch request
   void collect_background_data_fetch(execution_mode mode) {
-    for(auto& io_buffer : m_io_buffers) {
-      if(io_buffer->is_data_fetched_in_background(mode)) {
-        io_buffer->get_data_fetch_future(mode).get();
-        io_buffer->set_fetch_data_in_background(false, mode);
+    // A fetch may queue the next one while we wait, so repeat until
+    // none is outstanding
+    bool outstanding = true;
+    while (outstanding) {
+      outstanding = false;
+      for(auto& io_buffer : m_io_buffers) {
+        if(io_buffer->is_data_fetched_in_background(mode)) {
+          const auto wait_start = get_time();
+          io_buffer->get_data_fetch_future(mode).get();
+          m_pipeline_stats.wait_time += get_time() - wait_start;
+          io_buffer->set_fetch_data_in_background(false, mode);
+          outstanding = true;
+        }
       }
     }
   }
@@ -220,17 +257,25 @@ class generic_input_layer : public io_layer<TensorDataType> {
     generic_io_buffer<TensorDataType>* io_buffer = m_io_buffers[get_active_buffer_idx(mode) % m_io_buffers.size()];
 
     // If there is no valid data and there is not already a background
-    // thread to fetch the data, queue up the background thread
-    if(io_buffer->num_samples_ready(mode) == 0 && !io_buffer->is_data_fetched_in_background(mode)) {
-      std::future<void> background_fetch_done = this->m_model->get_execution_context().get_io_thread_pool().submit_job(
-        std::bind(&generic_input_layer::fetch_data_in_background, this, get_active_buffer_idx(mode), mode));
-      io_buffer->set_data_fetch_future(std::move(background_fetch_done), mode);
-      io_buffer->set_fetch_data_in_background(true, mode);
+    // thread to fetch the data, restart the prefetch chain here
+    {
+      std::lock_guard<std::mutex> guard(m_prefetch_mutex);
+      prefetch_state& state = m_prefetch[mode];
+      if(io_buffer->num_samples_ready(mode) == 0 && !io_buffer->is_data_fetched_in_background(mode)) {
+        state.next_buffer = get_active_buffer_idx(mode);
+        state.stopped = false;
+        queue_prefetch(mode, false);
+      }
+      m_pipeline_stats.queue_depth +=
+        std::max(state.next_buffer - get_active_buffer_idx(mode), 0);
+      m_pipeline_stats.num_batches++;
     }
 
     // Wait for the background thread to complete fetching the data
     if(io_buffer->is_data_fetched_in_background(mode)) {
+      const auto wait_start = get_time();
       io_buffer->get_data_fetch_future(mode).get();
+      m_pipeline_stats.wait_time += get_time() - wait_start;
       io_buffer->set_fetch_data_in_background(false, mode);
     }
 
@@ -251,26 +296,71 @@ class generic_input_layer : public io_layer<TensorDataType> {
       num_samples_in_batch = get_current_mini_batch_size();
 
       update_num_samples_processed(num_samples_in_batch);
+      const auto copy_start = get_time();
       if(this->m_expected_num_child_layers == 1) {
         io_buffer->distribute_from_local_matrix(get_data_reader(), mode, this->get_activations(0));
       }else {
         io_buffer->distribute_from_local_matrix(get_data_reader(), mode, this->get_activations(0), this->get_activations(1));
       }
+      m_pipeline_stats.copy_time += get_time() - copy_start;
     }else {
       LBANN_ERROR("could not fp_compute for I/O layers : encoutered generic_io_buffer type");
     }
+    if (m_effective_length != nullptr) {
+      *m_effective_length = get_data_reader()->get_effective_length(*get_sample_indices_per_mb());
+    }
 
     data_coordinator& dc = this->m_model->get_execution_context().get_trainer().get_data_coordinator();
-    dc.m_data_set_processed = io_buffer->update_data_set(get_data_reader(mode), mode);
+    {
+      // A prefetch may be reading the reader's position
+      std::lock_guard<std::mutex> guard(dc.dr_mutex);
+      dc.m_data_set_processed = io_buffer->update_data_set(get_data_reader(mode), mode);
+      m_prefetch[mode].num_updates++;
+    }
+
+    // The buffer has been consumed, so its slot in the ring is free
+    std::lock_guard<std::mutex> guard(m_prefetch_mutex);
+    m_prefetch[mode].num_consumed = get_active_buffer_idx(mode) + 1;
+    if(!dc.m_data_set_processed) {
+      queue_prefetch(mode, true);
+    }
+  }
 
-    if(!dc.m_data_set_processed && this->m_model->get_execution_context().background_io_activity_allowed()) {
-      int next_active_buffer = get_active_buffer_idx(mode) + 1;
-      std::future<void> background_fetch_done = this->m_model->get_execution_context().get_io_thread_pool().submit_job(
-        std::bind(&generic_input_layer::fetch_data_in_background, this, next_active_buffer, mode));
-      generic_io_buffer<TensorDataType>* next_io_buffer = m_io_buffers[next_active_buffer % m_io_buffers.size()];
-      next_io_buffer->set_data_fetch_future(std::move(background_fetch_done), mode);
-      next_io_buffer->set_fetch_data_in_background(true, mode);
+  /** @brief Queue a background fetch of the next buffer in the ring
+   *
+   *  Does nothing if a fetch is already queued (fetches are chained so
+   *  that they run in mini-batch order), if the chain stopped at the
+   *  end of the epoch, or if every buffer in the ring holds a
+   *  mini-batch that has not been consumed yet. The caller must hold
+   *  m_prefetch_mutex.
+   */
+  void queue_prefetch(execution_mode mode, bool check_background_io_allowed) {
+    prefetch_state& state = m_prefetch[mode];
+    if (state.running || state.stopped) {
+      return;
     }
+    if (state.next_buffer >= state.num_consumed + 1 + m_prefetch_depth) {
+      return;
+    }
+    if (check_background_io_allowed
+        && !this->m_model->get_execution_context().background_io_activity_allowed()) {
+      return;
+    }
+    const int buffer = state.next_buffer++;
+    std::future<void> background_fetch_done = this->m_model->get_execution_context().get_io_thread_pool().submit_job(
+      std::bind(&generic_input_layer::fetch_data_in_background, this, buffer, mode));
+    generic_io_buffer<TensorDataType>* next_io_buffer = m_io_buffers[buffer % m_io_buffers.size()];
+    next_io_buffer->set_data_fetch_future(std::move(background_fetch_done), mode);
+    next_io_buffer->set_fetch_data_in_background(true, mode);
+    state.running = true;
+  }
+
+  /// Create the per-mode states up front, so background fetches never
+  /// insert into m_prefetch
+  void init_prefetch_states() {
+    m_prefetch[execution_mode::training];
+    m_prefetch[execution_mode::validation];
+    m_prefetch[execution_mode::testing];
   }
 
   void setup_next_io_buffer(generic_io_buffer<TensorDataType>* io_buffer) {
@@ -597,19 +687,12 @@ class generic_input_layer : public io_layer<TensorDataType> {
     if(p.get_cb_type() == callback_type::execution_context_only
        || p.get_cb_type() == callback_type::full_checkpoint){
 
-      std::string buf;
       if (this->get_comm()->am_trainer_master()) {
         read_cereal_archive<generic_input_layer>(*this, p, execution_mode::training, "_io.xml");
-        buf = create_cereal_archive_binary_string<generic_input_layer>(*this);
       }
 
-      // TODO: this assumes homogeneous processors
       // broadcast state from rank 0
-      this->get_comm()->trainer_broadcast(0, buf);
-
-      if (!this->get_comm()->am_trainer_master()) {
-        unpack_cereal_archive_binary_string<generic_input_layer>(*this, buf);
-      }
+      broadcast_cereal_archive_binary<generic_input_layer>(*this, *this->get_comm());
 
     }
     return true;
@@ -641,9 +724,85 @@ class generic_input_layer : public io_layer<TensorDataType> {
     m_active_buffer[m]++;
   }
 
+  /** @brief Counters of the data pipeline as seen by the model.
+   *
+   *  Accumulated over the lifetime of the layer, so callers should
+   *  difference them.
+   */
+  struct pipeline_stats {
+    /** Time (seconds) spent waiting for background fetches. */
+    double wait_time = 0.0;
+    /** Time (seconds) spent distributing fetched data to the
+     *  activations. */
+    double copy_time = 0.0;
+    /** Number of mini-batches consumed. */
+    size_t num_batches = 0;
+    /** Sum over mini-batches of the number of fetches that had been
+     *  issued (running or done) when the mini-batch was consumed. */
+    size_t queue_depth = 0;
+  };
+  const pipeline_stats& get_pipeline_stats() const { return m_pipeline_stats; }
+
+  /** Time (seconds) spent waiting for background fetches. */
+  double get_io_wait_time() const { return m_pipeline_stats.wait_time; }
+
+  /** @brief Number of mini-batches fetched ahead of the model.
+   *
+   *  Starts at --prefetch_depth and is at most one less than the
+   *  number of I/O buffers in the ring.
+   */
+  int get_prefetch_depth() const noexcept { return m_prefetch_depth; }
+  /** @brief Change how many mini-batches are fetched ahead.
+   *
+   *  Clamped to [1, number of buffers - 1]. Fetches already queued
+   *  beyond a smaller depth are not cancelled. Safe to call during
+   *  training.
+   */
+  void set_prefetch_depth(int depth) {
+    std::lock_guard<std::mutex> guard(m_prefetch_mutex);
+    m_prefetch_depth = std::max(std::min(depth, static_cast<int>(m_io_buffers.size()) - 1), 1);
+  }
+  /** @brief Largest depth the ring of I/O buffers allows. */
+  int get_max_prefetch_depth() const {
+    return static_cast<int>(m_io_buffers.size()) - 1;
+  }
+  /** @brief Grow the ring of I/O buffers to allow a prefetch depth.
+   *
+   *  New buffers are copies of the first one. Since buffers are
+   *  indexed modulo the ring size, this must not be called while a
+   *  background fetch is outstanding, e.g. in a callback's setup.
+   */
+  void reserve_prefetch_depth(int depth) {
+    while (get_max_prefetch_depth() < depth) {
+      m_io_buffers.push_back(m_io_buffers.front()->copy());
+    }
+  }
+
  protected:
   std::vector<generic_io_buffer<TensorDataType>*> m_io_buffers;
   io_buffer_map_t m_active_buffer;
+
+  /** @brief State of the chain of background fetches for a mode */
+  struct prefetch_state {
+    /// Index (as in m_active_buffer) of the next buffer to fetch
+    int next_buffer = 0;
+    /// Buffers with a lower index have been consumed
+    int num_consumed = 0;
+    /// Number of reader updates; only accessed under dr_mutex
+    int num_updates = 0;
+    /// A fetch is queued or running
+    bool running = false;
+    /// The last mini-batch of the epoch has been fetched
+    bool stopped = false;
+  };
+  std::map<execution_mode, prefetch_state> m_prefetch;
+  std::mutex m_prefetch_mutex;
+  /** @see get_prefetch_depth */
+  int m_prefetch_depth;
+  /** Shared with downstream layers through DataReaderMetaData */
+  std::shared_ptr<int> m_effective_length;
+  /** @see get_pipeline_stats */
+  pipeline_stats m_pipeline_stats;
 };
 
 }  // namespace lbann
@@ -30,6 +30,7 @@
 #include "lbann/layers/io/input/generic_input_layer.hpp"
 #include "lbann/utils/exception.hpp"
 #include "lbann/utils/distconv.hpp"
+#include "lbann/utils/pinned_memory.hpp"
 #include "lbann/models/model.hpp"
 #include <string>
 #include <sys/types.h>
@@ -85,8 +86,8 @@ class input_distconv_adapter: public data_type_distconv_adapter<TensorDataType>
   std::unique_ptr<TensorDataType> m_shuffler_dst_buf;
   size_t m_shuffler_dst_buf_size = 0;
 
-  // TODO: Use pinned memory pool
-  TensorDataType *m_copy_pinned_buffer = nullptr;
+  /** Pinned memory of the shuffled host tensors */
+  std::vector<pinned_memory_pool::lease> m_host_tensor_leases;
 };
 #endif // LBANN_HAS_DISTCONV
 
@@ -112,9 +113,12 @@ class input_layer : public generic_input_layer<TensorDataType> {
   input_layer(lbann_comm *comm, int num_parallel_readers,
     data_reader_target_mode target_mode = data_reader_target_mode::CLASSIFICATION)
     : generic_input_layer<TensorDataType>(comm, num_parallel_readers, target_mode) {
-    // Initialize two buffers
-    initialize_io_buffer(comm, std::min(num_parallel_readers, data_type_layer<TensorDataType>::m_comm->get_procs_per_trainer()));
-    initialize_io_buffer(comm, std::min(num_parallel_readers, data_type_layer<TensorDataType>::m_comm->get_procs_per_trainer()));
+    // Initialize a ring of buffers: one being consumed and one per
+    // mini-batch that may be prefetched
+    const int num_buffers = 1 + data_coordinator::get_prefetch_depth();
+    for (int i = 0; i < num_buffers; ++i) {
+      initialize_io_buffer(comm, std::min(num_parallel_readers, data_type_layer<TensorDataType>::m_comm->get_procs_per_trainer()));
+    }
     for (auto io_buffer : this->m_io_buffers) {
       io_buffer->fetch_data_fn = new fetch_data_functor<IODataType>(target_mode);
       io_buffer->update_data_reader_fn = new update_data_reader_functor();
@@ -39,6 +39,7 @@
 #include "lbann/utils/memory.hpp"
 #include "lbann/utils/typename.hpp"
 #include "lbann/utils/distconv.hpp"
+#include "lbann/utils/telemetry.hpp"
 #ifdef LBANN_HAS_DISTCONV
 #include "lbann/layers/distconv_adapter.hpp"
 #endif // LBANN_HAS_DISTCONV
@@ -136,6 +137,15 @@ struct ParallelStrategy {
   }
 };
 
+/** @brief Precision of tensors moved between data distributions.
+ *
+ *  With @c half, redistributions of a layer's inputs and of the
+ *  gradients w.r.t. its outputs (e.g. between data-parallel and
+ *  model-parallel layers) communicate in 16-bit floating point. The
+ *  data is converted back to the layer's data type on arrival.
+ */
+enum class transfer_precision { full, half };
+
 inline std::ostream &operator<<(std::ostream &os,
                                 const ParallelStrategy &ps) {
   os << "{" << ps.sample_groups
@@ -203,7 +213,10 @@ public:
    *  Each layer in a model should have a unique, preferably
    *  human-readable, name.
    */
-  inline void set_name(const std::string name) { m_name = name; }
+  inline void set_name(const std::string name) {
+    m_name = name;
+    m_telemetry_region = telemetry::no_region;
+  }
   /** Get a string representing the layer datatype
    */
   virtual std::string get_datatype_name() const {
@@ -271,6 +284,12 @@ public:
 
   /** Reset layer stat counters. */
   virtual void reset_counters();
+  /** Time spent in forward propagation since the counters were
+   *  reset. */
+  EvalType get_fp_time() const noexcept { return m_fp_time; }
+  /** Time spent in backward propagation since the counters were
+   *  reset. */
+  EvalType get_bp_time() const noexcept { return m_bp_time; }
 
   /** Whether the layer is using a GPU implementation. */
   inline bool using_gpus() const {
@@ -376,6 +395,9 @@ public:
   virtual void set_weights(std::vector<weights*>& w) = 0;
   /** Replace weights with another Layer's weights*/
   virtual void replace_weights(Layer* other_layer) = 0;
+  /** Share another Layer's weight matrices, without copies; see
+   *  data_type_weights::tie_values */
+  virtual void tie_weights(Layer* other_layer) = 0;
 
   // ===========================================================
   // Tensor access functions
@@ -428,6 +450,129 @@ public:
   void unfreeze();
   bool is_frozen() const;
 
+  // ===========================================================
+  // Activation recomputation functions
+  // ===========================================================
+
+  /** @brief Set whether output tensors may be freed after forward
+   *  prop and recomputed during backprop.
+   *  @details The model groups consecutive layers with this flag
+   *  into recomputation segments.
+   */
+  void set_recompute_activations(bool recompute) { m_recompute_activations = recompute; }
+  /** @brief Whether output tensors may be freed after forward prop
+   *  and recomputed during backprop. */
+  bool get_recompute_activations() const noexcept { return m_recompute_activations; }
+
+  /** @brief Precision of redistributed inputs and previous error
+   *  signals (see @c transfer_precision). */
+  void set_transfer_precision(transfer_precision p) { m_transfer_precision = p; }
+  /** @brief Precision of redistributed inputs and previous error
+   *  signals (see @c transfer_precision). */
+  transfer_precision get_transfer_precision() const noexcept { return m_transfer_precision; }
+  /** @brief Whether forward prop can be repeated with the same
+   *  results and without side effects.
+   *  @details Layers that generate random values or update internal
+   *  state in forward prop (e.g. dropout, batch normalization, input
+   *  layers) must return @c false.
+   */
+  virtual bool can_recompute_activations() const { return true; }
+  /** @brief Free the memory of the output tensors.
+   *  @details They are reallocated in the next forward prop. Output
+   *  tensors that are not kept (see @c keep_original_outputs) are
+   *  left alone.
+   */
+  virtual void release_activations() = 0;
+  /** @brief Whether any output tensor is a view of another tensor. */
+  virtual bool has_activation_views() const = 0;
+
+  // ===========================================================
+  // In-place execution functions
+  // ===========================================================
+
+  /** @brief Whether the layer can write its output tensor over its
+   *  input tensor.
+   *  @details Only entry-wise layers with one parent and one child
+   *  whose backprop does not need the original input values should
+   *  return @c true.
+   */
+  virtual bool supports_in_place() const { return false; }
+  /** @brief Whether backprop reads the values of the output tensors.
+   *  @details A child layer may only run in place if this is
+   *  @c false. Layers that do not override it are assumed to need
+   *  their outputs.
+   */
+  virtual bool uses_outputs_in_backprop() const { return true; }
+  /** @brief Whether backprop skips error signals that parents do
+   *  not need.
+   *  @details If @c true, error signals for which
+   *  @c error_signals_needed is @c false are not allocated and
+   *  @c bp_compute must not write to them.
+   */
+  virtual bool can_skip_error_signals() const { return false; }
+  /** @brief Set whether the output tensor is a view of the parent's
+   *  output tensor.
+   *  @details Set by the model (see @c model::setup_in_place_layers).
+   */
+  void set_in_place(bool in_place) { m_in_place = in_place; }
+  /** @brief Whether the output tensor is a view of the parent's
+   *  output tensor. */
+  bool is_in_place() const noexcept { return m_in_place; }
+  /** @brief Set whether backprop must run on this layer.
+   *  @details Set by the model (see @c model::update_backprop_layers).
+   */
+  void set_needs_backprop(bool needs_backprop) { m_needs_backprop = needs_backprop; }
+  /** @brief Whether backprop must run on this layer.
+   *  @details @c false if neither this layer nor any layer it
+   *  depends on has weights with an optimizer, e.g. in the frozen
+   *  part of a fine-tuned model. Error signals are not sent to
+   *  parents that do not need backprop.
+   */
+  bool needs_backprop() const noexcept { return m_needs_backprop; }
+  /** @brief Whether a parent layer needs the error signal this
+   *  layer computes for it.
+   *  @details Layers that override @c can_skip_error_signals may
+   *  leave error signals that are not needed uncomputed.
+   */
+  bool error_signals_needed(int parent_index = 0) const;
+
+  /** @brief Whether the layer's GPU work can be captured into a CUDA
+   *  graph and replayed.
+   *  @details Layers whose forward prop or backprop depends on
+   *  host-side state that changes every step (e.g. random numbers
+   *  generated on the host) should return @c false. See
+   *  @c model::forward_backward_prop_with_graph.
+   */
+  virtual bool supports_cuda_graph() const { return true; }
+
+  // ===========================================================
+  // Memory planning functions
+  // ===========================================================
+
+  /** @brief Bytes of local memory needed by an output tensor.
+   *  @details Computed for the current size of the tensor, which is
+   *  the maximum mini-batch size after setup. Zero if the tensor is a
+   *  view of another tensor or can not use external memory.
+   */
+  virtual size_t get_activations_buffer_size(int child_index) const = 0;
+  /** @brief Bytes of local memory needed by an error signal.
+   *  @details Zero if the error signal can not use external memory,
+   *  e.g. if error signals are persistent.
+   */
+  virtual size_t get_error_signals_buffer_size(int parent_index) const = 0;
+  /** @brief Store an output tensor in externally managed memory.
+   *  @details The buffer must hold @c get_activations_buffer_size
+   *  bytes on the layer's device. A null pointer restores memory
+   *  owned by the tensor.
+   */
+  virtual void set_activations_buffer(int child_index, void* buffer) = 0;
+  /** @brief Store an error signal in externally managed memory.
+   *  @details Parent layers view the error signal instead of taking
+   *  ownership of it, so the buffer must stay valid until the parent
+   *  has finished backprop.
+   */
+  virtual void set_error_signals_buffer(int parent_index, void* buffer) = 0;
+
   /** @brief Set whether to keep or dynamically reallocate error signals.
    *
    *  Passing a value of @c true means to keep the error signals; @c
@@ -435,6 +580,17 @@ public:
    */
   virtual void set_keep_error_signals(bool) = 0;
 
+  /** @brief Bytes of local memory owned by the layer's activations
+   *  on a device.
+   *  @details Includes outputs and any inputs that are copies rather
+   *  than views. Tensors stored in the model's tensor arena are
+   *  views and are not included.
+   */
+  virtual size_t get_activations_memory_usage(El::Device device) const = 0;
+  /** @brief Bytes of local memory owned by the layer's error signals
+   *  on a device. */
+  virtual size_t get_error_signals_memory_usage(El::Device device) const = 0;
+
 protected:
 
   // ===========================================================
@@ -544,6 +700,21 @@ protected:
   /** Avoid back prop if frozen */
   bool m_frozen;
 
+  /** @brief Whether output tensors may be freed after forward prop
+   *  and recomputed during backprop. */
+  bool m_recompute_activations = false;
+
+  /** @brief Precision of redistributed inputs and previous error
+   *  signals. */
+  transfer_precision m_transfer_precision = transfer_precision::full;
+
+  /** @brief Whether the output tensor is a view of the parent's
+   *  output tensor. */
+  bool m_in_place = false;
+
+  /** @brief Whether backprop must run on this layer. */
+  bool m_needs_backprop = true;
+
   /** Time spent in forward propagation. */
   EvalType m_fp_time;
   /** Time spent in the forward propagation computation. */
@@ -561,6 +732,10 @@ protected:
    */
   std::string m_name;
 
+  /** Telemetry region of the layer's name. Interned when first
+   *  recorded. */
+  telemetry::region_id m_telemetry_region = telemetry::no_region;
+
 private:
   /** @name Implementation details of back-prop. */
   ///@{
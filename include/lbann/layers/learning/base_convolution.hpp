@@ -33,10 +33,13 @@
 #include "lbann/weights/initializer.hpp"
 #include "lbann/weights/variance_scaling_initializers.hpp"
 #include "lbann/utils/cudnn.hpp"
+#include "lbann/utils/determinism.hpp"
 #include "lbann/utils/exception.hpp"
 #include "lbann/utils/random.hpp"
 #include "lbann/utils/timer.hpp"
 #include "lbann/utils/im2col.hpp"
+#include "lbann/utils/options.hpp"
+#include "lbann/utils/winograd.hpp"
 #include "lbann/utils/distconv.hpp"
 
 #include <vector>
@@ -125,6 +128,35 @@ protected:
    */
   ScalingType m_bias_scaling_factor;
 
+  /** Number of im2col columns formed at a time in CPU convolution
+   *  during forward prop. Chosen in setup from the convolution
+   *  geometry.
+   */
+  int m_fp_im2col_block_size = 0;
+  /** Number of im2col columns formed at a time in CPU convolution
+   *  during backprop (used by transposed convolution).
+   */
+  int m_bp_im2col_block_size = 0;
+
+  /** Whether CPU forward prop uses Winograd F(4x4,3x3).
+   *  Chosen in setup for 2D 3x3 stride-1 convolutions with floating
+   *  point data. Disabled with --no_winograd.
+   */
+  bool m_use_winograd = false;
+  /** Kernel values used to compute @c m_winograd_filters. */
+  std::vector<TensorDataType> m_winograd_kernel;
+  /** Winograd-transformed kernel. */
+  std::vector<TensorDataType> m_winograd_filters;
+
+  /** @brief Kernel used in forward prop instead of the kernel
+   *  weights, if not empty.
+   *  @details Lets a derived class fold a following layer into the
+   *  convolution (see @c convolution_layer::fuse_batchnorm).
+   */
+  DMatDT<Device> m_fused_kernel;
+  /** Bias that goes with @c m_fused_kernel. */
+  DMatDT<Device> m_fused_bias;
+
 #ifdef LBANN_HAS_CUDNN
 
   /** @brief Math type to use inside cuDNN.
@@ -183,7 +215,12 @@ public:
       m_strides(other.m_strides),
       m_dilations(other.m_dilations),
       m_groups(other.m_groups),
-      m_bias_scaling_factor(other.m_bias_scaling_factor)
+      m_bias_scaling_factor(other.m_bias_scaling_factor),
+      m_fp_im2col_block_size(other.m_fp_im2col_block_size),
+      m_bp_im2col_block_size(other.m_bp_im2col_block_size),
+      m_use_winograd(other.m_use_winograd),
+      m_winograd_kernel(other.m_winograd_kernel),
+      m_winograd_filters(other.m_winograd_filters)
 #ifdef LBANN_HAS_CUDNN
     , m_convolution_math_type(other.m_convolution_math_type),
       m_tensors_cudnn_desc(other.m_tensors_cudnn_desc),
@@ -197,7 +234,7 @@ public:
                            m_kernel_cudnn_desc);
     copy_convolution_cudnn_desc(other.m_convolution_cudnn_desc,
                                 m_convolution_cudnn_desc);
-    if (other.m_bias_scaling_factor != El::TypeTraits<ScalingType>::Zero()) {
+    if (other.m_bias_cudnn_desc != nullptr) {
       cudnn::copy_tensor_desc(other.m_bias_cudnn_desc,
                               m_bias_cudnn_desc);
     }
@@ -214,6 +251,11 @@ public:
     m_dilations = other.m_dilations;
     m_groups = other.m_groups;
     m_bias_scaling_factor = other.m_bias_scaling_factor;
+    m_fp_im2col_block_size = other.m_fp_im2col_block_size;
+    m_bp_im2col_block_size = other.m_bp_im2col_block_size;
+    m_use_winograd = other.m_use_winograd;
+    m_winograd_kernel = other.m_winograd_kernel;
+    m_winograd_filters = other.m_winograd_filters;
 
 #ifdef LBANN_HAS_CUDNN
     // Copy cuDNN objects
@@ -222,7 +264,7 @@ public:
                            m_kernel_cudnn_desc);
     copy_convolution_cudnn_desc(other.m_convolution_cudnn_desc,
                                 m_convolution_cudnn_desc);
-    if (other.m_bias_scaling_factor != El::TypeTraits<ScalingType>::Zero()) {
+    if (other.m_bias_cudnn_desc != nullptr) {
       cudnn::copy_tensor_desc(other.m_bias_cudnn_desc,
                               m_bias_cudnn_desc);
     }
@@ -256,6 +298,14 @@ public:
   }
 #endif // LBANN_HAS_CUDNN
 
+  bool uses_outputs_in_backprop() const override { return false; }
+  bool can_skip_error_signals() const override {
+#ifdef LBANN_HAS_DISTCONV
+    if (this->distconv_enabled()) { return false; }
+#endif // LBANN_HAS_DISTCONV
+    return true;
+  }
+
   description get_description() const override {
     auto desc = data_type_layer<TensorDataType>::get_description();
     std::ostringstream ss;
@@ -471,6 +521,27 @@ public:
       bias_weights.set_matrix_distribution(dist);
     }
 
+    // Choose im2col block sizes for CPU convolution
+    const auto input_size = this->get_input_size();
+    const auto output_size = this->get_output_size();
+    m_fp_im2col_block_size
+      = get_im2col_block_size(kernel_size / output_dims[0],
+                              output_size / output_dims[0],
+                              sizeof(TensorDataType));
+    m_bp_im2col_block_size
+      = get_im2col_block_size(kernel_size / input_dims[0],
+                              input_size / input_dims[0],
+                              sizeof(TensorDataType));
+
+    // Use Winograd F(4x4,3x3) for 2D 3x3 stride-1 convolutions on CPU
+    m_use_winograd = (Device == El::Device::CPU
+                      && std::is_floating_point<TensorDataType>::value
+                      && input_dims.size() == 3
+                      && kernel_dims[2] == 3 && kernel_dims[3] == 3
+                      && m_strides[0] == 1 && m_strides[1] == 1
+                      && m_groups == 1
+                      && !options::get()->get_bool("no_winograd"));
+
     // Initialize freeze state
     for (auto&& w : this->get_data_type_weights()) {
       if (this->m_frozen) {
@@ -525,17 +596,22 @@ public:
                                               m_groups));
 
     // Set bias tensor descriptor
-    if (m_bias_scaling_factor != El::TypeTraits<ScalingType>::Zero()) {
-      std::vector<int> bias_dims(output_dims.size() + 1, 1);
-      bias_dims[1] = output_dims[0];
-      cudnn::set_tensor_desc<TensorDataType>(m_bias_cudnn_desc, bias_dims);
-    }
+    // Note: Also needed without a bias if one is fused in.
+    std::vector<int> bias_dims(output_dims.size() + 1, 1);
+    bias_dims[1] = output_dims[0];
+    cudnn::set_tensor_desc<TensorDataType>(m_bias_cudnn_desc, bias_dims);
 
 #endif // LBANN_HAS_CUDNN
   }
 
 protected:
 
+  /** Local kernel values used in forward prop. */
+  const El::AbstractMatrix<TensorDataType>& get_local_forward_kernel() const {
+    if (!m_fused_kernel.IsEmpty()) { return m_fused_kernel; }
+    return this->get_data_type_weights(0).get_values().LockedMatrix();
+  }
+
   /** Dimensions of convolution kernel. */
   virtual std::vector<int> get_kernel_dims() const = 0;
 
@@ -550,7 +626,7 @@ protected:
     const auto one = El::TypeTraits<ScalingType>::One();
 
     // Matrices
-    const auto& kernel = this->get_data_type_weights(0).get_values();
+    const auto& kernel = get_local_forward_kernel();
     const auto& input = (during_forward_prop ?
                          this->get_local_prev_activations() :
                          this->get_local_prev_error_signals());
@@ -564,15 +640,6 @@ protected:
       return;
     }
 
-    // Initialize GPU workspace
-    El::Matrix<TensorDataType, El::Device::GPU> workspace;
-#ifdef HYDROGEN_HAVE_CUB
-    workspace.SetMemoryMode(1);
-#endif // HYDROGEN_HAVE_CUB
-    size_t workspace_size = 1 << 30; /// @todo Allocate largest free block
-    workspace.Resize(workspace_size / sizeof(TensorDataType), 1);
-    workspace_size = workspace.Height() * sizeof(TensorDataType);
-
     // Convolution parameters
     std::vector<int> input_dims, output_dims;
     cudnnTensorDescriptor_t input_desc, output_desc;
@@ -595,8 +662,16 @@ protected:
       = get_forward_algo_cudnn(input.Width(), input_desc, input.LockedBuffer(),
                                m_kernel_cudnn_desc, kernel.LockedBuffer(),
                                m_convolution_cudnn_desc,
-                               output_desc, output.Buffer(),
-                               workspace_size, workspace.Buffer());
+                               output_desc, output.Buffer());
+
+    // Get GPU workspace
+    size_t workspace_size;
+    CHECK_CUDNN(cudnnGetConvolutionForwardWorkspaceSize(
+                  cudnn::get_handle(),
+                  input_desc, m_kernel_cudnn_desc, m_convolution_cudnn_desc,
+                  output_desc, convolution_cudnn_algorithm,
+                  &workspace_size));
+    auto* workspace = cudnn::get_workspace(workspace_size);
 
     // Apply convolution
     CHECK_CUDNN(cudnnConvolutionForward(cudnn::get_handle(),
@@ -607,7 +682,7 @@ protected:
                                         kernel.LockedBuffer(),
                                         m_convolution_cudnn_desc,
                                         convolution_cudnn_algorithm,
-                                        workspace.Buffer(),
+                                        workspace,
                                         workspace_size,
                                         &zero,
                                         output_desc,
@@ -641,16 +716,6 @@ protected:
       return;
     }
 
-    // Initialize GPU workspace
-    // Note: Use CUB GPU memory pool if possible
-    El::Matrix<TensorDataType, El::Device::GPU> workspace;
-#ifdef HYDROGEN_HAVE_CUB
-    workspace.SetMemoryMode(1);
-#endif // HYDROGEN_HAVE_CUB
-    size_t workspace_size = 1 << 30; /// @todo Allocate largest free block
-    workspace.Resize(workspace_size / sizeof(TensorDataType), 1);
-    workspace_size = workspace.Height() * sizeof(TensorDataType);
-
     // Convolution transpose parameters
     std::vector<int> input_dims, output_dims;
     cudnnTensorDescriptor_t input_desc, output_desc;
@@ -674,8 +739,17 @@ protected:
                                      m_kernel_cudnn_desc, kernel.LockedBuffer(),
                                      input_desc, input.LockedBuffer(),
                                      m_convolution_cudnn_desc,
-                                     output_desc, output.Buffer(),
-                                     workspace_size, workspace.Buffer());
+                                     output_desc, output.Buffer());
+
+    // Get GPU workspace
+    size_t workspace_size;
+    CHECK_CUDNN(cudnnGetConvolutionBackwardDataWorkspaceSize(
+                  cudnn::get_handle(),
+                  m_kernel_cudnn_desc, input_desc, m_convolution_cudnn_desc,
+                  output_desc, transposed_convolution_cudnn_algorithm,
+                  &workspace_size));
+    auto* workspace = cudnn::get_workspace(workspace_size);
+
     // Perform transposed convolution
     CHECK_CUDNN(cudnnConvolutionBackwardData(cudnn::get_handle(),
                                              &one,
@@ -685,7 +759,7 @@ protected:
                                              input.LockedBuffer(),
                                              m_convolution_cudnn_desc,
                                              transposed_convolution_cudnn_algorithm,
-                                             workspace.Buffer(),
+                                             workspace,
                                              workspace_size,
                                              &zero,
                                              output_desc,
@@ -716,6 +790,83 @@ protected:
   #endif // LBANN_HAS_CUDNN
   }
 
+  /** @brief Convolution with cuDNN followed by @c m_fused_bias and an
+   *  optional ReLU.
+   *  @details With a ReLU, the whole sequence is a single call to
+   *  @c cudnnConvolutionBiasActivationForward.
+   */
+  void apply_fused_convolution_cudnn(bool apply_relu) {
+#ifndef LBANN_HAS_CUDNN
+    LBANN_ERROR("cuDNN not detected");
+#else
+    if (!apply_relu) {
+      apply_convolution_cudnn(true);
+      auto& local_output = this->get_local_activations();
+      if (local_output.Height() > 0 && local_output.Width() > 0) {
+        const auto one = El::TypeTraits<ScalingType>::One();
+        CHECK_CUDNN(cudnnAddTensor(cudnn::get_handle(),
+                                   &one,
+                                   m_bias_cudnn_desc,
+                                   m_fused_bias.LockedBuffer(),
+                                   &one,
+                                   m_tensors_cudnn_desc.get_activations(),
+                                   local_output.Buffer()));
+      }
+      return;
+    }
+
+    // Useful constants
+    const auto zero = El::TypeTraits<ScalingType>::Zero();
+    const auto one = El::TypeTraits<ScalingType>::One();
+
+    // Matrices
+    const auto& kernel = get_local_forward_kernel();
+    const auto& input = this->get_local_prev_activations();
+    auto& output = this->get_local_activations();
+    if (input.Height() < 1 || input.Width() < 1
+        || output.Height() < 1 || output.Width() < 1) {
+      return;
+    }
+    auto&& input_desc = m_tensors_cudnn_desc.get_prev_activations();
+    auto&& output_desc = m_tensors_cudnn_desc.get_activations();
+
+    // Convolution algorithm and workspace
+    const auto algo
+      = get_forward_algo_cudnn(input.Width(), input_desc, input.LockedBuffer(),
+                               m_kernel_cudnn_desc, kernel.LockedBuffer(),
+                               m_convolution_cudnn_desc,
+                               output_desc, output.Buffer());
+    size_t workspace_size;
+    CHECK_CUDNN(cudnnGetConvolutionForwardWorkspaceSize(
+                  cudnn::get_handle(),
+                  input_desc, m_kernel_cudnn_desc, m_convolution_cudnn_desc,
+                  output_desc, algo, &workspace_size));
+    auto* workspace = cudnn::get_workspace(workspace_size);
+
+    // Convolution, bias, and ReLU
+    cudnnActivationDescriptor_t relu_desc;
+    CHECK_CUDNN(cudnnCreateActivationDescriptor(&relu_desc));
+    CHECK_CUDNN(cudnnSetActivationDescriptor(relu_desc,
+                                             CUDNN_ACTIVATION_RELU,
+                                             CUDNN_PROPAGATE_NAN,
+                                             0.0));
+    CHECK_CUDNN(cudnnConvolutionBiasActivationForward(
+                  cudnn::get_handle(),
+                  &one,
+                  input_desc, input.LockedBuffer(),
+                  m_kernel_cudnn_desc, kernel.LockedBuffer(),
+                  m_convolution_cudnn_desc, algo,
+                  workspace, workspace_size,
+                  &zero,
+                  output_desc, output.LockedBuffer(),
+                  m_bias_cudnn_desc, m_fused_bias.LockedBuffer(),
+                  relu_desc,
+                  output_desc, output.Buffer()));
+    CHECK_CUDNN(cudnnDestroyActivationDescriptor(relu_desc));
+
+#endif // LBANN_HAS_CUDNN
+  }
+
   void compute_gradients_cudnn(bool using_transposed_convolution) {
 #ifndef LBANN_HAS_CUDNN
     LBANN_ERROR("cuDNN not detected");
@@ -759,15 +910,6 @@ protected:
       auto& kernel_gradient = kernel_optimizer->get_gradient_buffer(
         dst_scale_dt, gradient_scale_dt, true);
       if (has_local_data) {
-        // Initialize GPU workspace
-        El::Matrix<TensorDataType, El::Device::GPU> workspace;
-#ifdef HYDROGEN_HAVE_CUB
-        workspace.SetMemoryMode(1); // CUB GPU memory pool
-#endif // HYDROGEN_HAVE_CUB
-        size_t workspace_size = 1 << 30; /// @todo Allocate largest free block
-        workspace.Resize(workspace_size / sizeof(TensorDataType), 1);
-        workspace_size = workspace.Height() * sizeof(TensorDataType);
-
         // Initialize cuDNN objects
         auto&& input_desc = m_tensors_cudnn_desc.get_prev_activations();
         auto&& gradient_wrt_output_desc = m_tensors_cudnn_desc.get_prev_error_signals();
@@ -782,8 +924,14 @@ protected:
               gradient_wrt_output_desc, local_gradient_wrt_output.LockedBuffer(),
               input_desc, local_input.LockedBuffer(),
               m_convolution_cudnn_desc,
-              m_kernel_cudnn_desc,
-              workspace_size, workspace.Buffer());
+              m_kernel_cudnn_desc);
+          size_t workspace_size;
+          CHECK_CUDNN(cudnnGetConvolutionBackwardFilterWorkspaceSize(
+                        cudnn::get_handle(),
+                        gradient_wrt_output_desc, input_desc,
+                        m_convolution_cudnn_desc, m_kernel_cudnn_desc,
+                        kernel_gradient_cudnn_algorithm, &workspace_size));
+          auto* workspace = cudnn::get_workspace(workspace_size);
           CHECK_CUDNN(cudnnConvolutionBackwardFilter(
                         cudnn::get_handle(),
                         &gradient_scale,
@@ -793,7 +941,7 @@ protected:
                         local_input.LockedBuffer(),
                         m_convolution_cudnn_desc,
                         kernel_gradient_cudnn_algorithm,
-                        workspace.Buffer(),
+                        workspace,
                         workspace_size,
                         &dst_scale,
                         m_kernel_cudnn_desc,
@@ -805,8 +953,14 @@ protected:
               input_desc, local_input.LockedBuffer(),
               gradient_wrt_output_desc, local_gradient_wrt_output.LockedBuffer(),
               m_convolution_cudnn_desc,
-              m_kernel_cudnn_desc,
-              workspace_size, workspace.Buffer());
+              m_kernel_cudnn_desc);
+          size_t workspace_size;
+          CHECK_CUDNN(cudnnGetConvolutionBackwardFilterWorkspaceSize(
+                        cudnn::get_handle(),
+                        input_desc, gradient_wrt_output_desc,
+                        m_convolution_cudnn_desc, m_kernel_cudnn_desc,
+                        kernel_gradient_cudnn_algorithm, &workspace_size));
+          auto* workspace = cudnn::get_workspace(workspace_size);
           CHECK_CUDNN(cudnnConvolutionBackwardFilter(
                         cudnn::get_handle(),
                         &gradient_scale,
@@ -816,7 +970,7 @@ protected:
                         local_gradient_wrt_output.LockedBuffer(),
                         m_convolution_cudnn_desc,
                         kernel_gradient_cudnn_algorithm,
-                        workspace.Buffer(),
+                        workspace,
                         workspace_size,
                         &dst_scale,
                         m_kernel_cudnn_desc,
@@ -834,7 +988,7 @@ protected:
   void apply_convolution_im2col(bool during_forward_prop) {
 
     // Local matrices
-    const auto& local_kernel = this->get_data_type_weights(0).get_values().LockedMatrix();
+    const auto& local_kernel = get_local_forward_kernel();
     const auto& local_input = (during_forward_prop ?
                                this->get_local_prev_activations() :
                                this->get_local_prev_error_signals());
@@ -864,10 +1018,62 @@ protected:
     const int n = output_dims[0];
     const int k = kernel_size / output_dims[0];
     DMatDT<Device> input_col, output_col;
-    DMatDT<Device> im2col_matrix(k, m);
     const DMatDT<Device> kernel_matrix(k, n, local_kernel.LockedBuffer(), k);
 
+    // 1x1 convolution is a GEMM on the input tensor, which is
+    // already laid out as the transposed im2col matrix
+    const bool is_1x1 = (std::all_of(kernel_dims.begin()+2, kernel_dims.end(),
+                                     [](int d) { return d == 1; })
+                         && std::all_of(m_pads.begin(), m_pads.end(),
+                                        [](int p) { return p == 0; })
+                         && std::all_of(m_strides.begin(), m_strides.end(),
+                                        [](int s) { return s == 1; }));
+    if (is_1x1) {
+      for (El::Int col = 0; col < local_width; ++col) {
+        input_col.LockedAttach(m, k, local_input.LockedBuffer(0, col), m);
+        output_col.Attach(m, n, local_output.Buffer(0, col), m);
+        El::Gemm(El::NORMAL, El::NORMAL,
+                 El::TypeTraits<TensorDataType>::One(), input_col, kernel_matrix,
+                 El::TypeTraits<TensorDataType>::Zero(), output_col);
+      }
+      return;
+    }
+
+    // 2D convolution forms im2col blocks that fit in cache and
+    // applies GEMM to each, instead of forming the full im2col matrix
+    if (input_dims.size() == 3) {
+      const int block_size = (during_forward_prop ?
+                              m_fp_im2col_block_size :
+                              m_bp_im2col_block_size);
+      DMatDT<Device> im2col_block(k, block_size);
+      DMatDT<Device> im2col_block_view;
+      for (El::Int col = 0; col < local_width; ++col) {
+        const auto* input_buffer = local_input.LockedBuffer(0, col);
+        for (int offset = 0; offset < m; offset += block_size) {
+          const int num_offsets = std::min(block_size, m - offset);
+          im2col_2d_block<TensorDataType>(input_buffer,
+                                          im2col_block.Buffer(),
+                                          input_dims[2], input_dims[1],
+                                          m_pads[1], m_pads[0],
+                                          input_dims[0],
+                                          kernel_dims[3], kernel_dims[2],
+                                          m_strides[1], m_strides[0],
+                                          offset, num_offsets);
+          El::View(im2col_block_view, im2col_block,
+                   El::ALL, El::IR(0, num_offsets));
+          output_col.Attach(num_offsets, n,
+                            local_output.Buffer(offset, col), m);
+          El::Gemm(El::TRANSPOSE, El::NORMAL,
+                   El::TypeTraits<TensorDataType>::One(),
+                   im2col_block_view, kernel_matrix,
+                   El::TypeTraits<TensorDataType>::Zero(), output_col);
+        }
+      }
+      return;
+    }
+
     // Iterate through input columns
+    DMatDT<Device> im2col_matrix(k, m);
     for (El::Int col = 0; col < local_width; ++col) {
 
       // Construct im2col matrix from current input column
@@ -891,6 +1097,46 @@ protected:
 
   }
 
+  /** Convolution with Winograd F(4x4,3x3) algorithm.
+   *  Transformed filters are cached until the kernel changes.
+   */
+  void apply_convolution_winograd() {
+
+    // Local matrices
+    const auto& local_kernel = get_local_forward_kernel();
+    const auto& local_input = this->get_local_prev_activations();
+    auto& local_output = this->get_local_activations();
+    const auto& input_dims = this->get_input_dims();
+    const int num_input_channels = input_dims[0];
+    const int num_output_channels = this->get_output_dims()[0];
+
+    // Transform filters if the kernel has changed
+    const auto* kernel_buffer = local_kernel.LockedBuffer();
+    const size_t kernel_size = 9 * num_input_channels * num_output_channels;
+    if (m_winograd_kernel.size() != kernel_size
+        || !std::equal(kernel_buffer, kernel_buffer + kernel_size,
+                       m_winograd_kernel.begin())) {
+      m_winograd_kernel.assign(kernel_buffer, kernel_buffer + kernel_size);
+      m_winograd_filters.resize(winograd_f4x4_3x3_tile_size * kernel_size / 9);
+      winograd_f4x4_3x3_transform_filters(kernel_buffer,
+                                          m_winograd_filters.data(),
+                                          num_input_channels,
+                                          num_output_channels);
+    }
+
+    // Apply convolution to each input column
+    for (El::Int col = 0; col < local_input.Width(); ++col) {
+      winograd_f4x4_3x3_convolution(local_input.LockedBuffer(0, col),
+                                    m_winograd_filters.data(),
+                                    local_output.Buffer(0, col),
+                                    num_input_channels,
+                                    num_output_channels,
+                                    input_dims[1], input_dims[2],
+                                    m_pads[0], m_pads[1]);
+    }
+
+  }
+
   /** Transposed convolution with im2col GEMM algorithm. */
   void apply_transposed_convolution_im2col(bool during_forward_prop) {
 
@@ -983,6 +1229,37 @@ protected:
 
   }
 
+  /** Add @c m_fused_bias and optionally apply a ReLU. */
+  void apply_fused_bias_cpu(bool apply_relu) {
+
+    // Local matrices
+    const El::AbstractMatrix<TensorDataType>& local_bias = m_fused_bias;
+    auto& local_output = this->get_local_activations();
+
+    // Matrix parameters
+    const El::Int local_width = local_output.Width();
+    const auto& output_dims = this->get_output_dims();
+    const El::Int num_output_channels = output_dims[0];
+    const El::Int num_per_output_channel = this->get_output_size() / num_output_channels;
+
+    // Apply bias and ReLU to each output channel
+    const TensorDataType zero = El::TypeTraits<TensorDataType>::Zero();
+    LBANN_OMP_PARALLEL_FOR
+    for (El::Int channel = 0; channel < num_output_channels; ++channel) {
+      const El::Int row_start = channel * num_per_output_channel;
+      const El::Int row_end = (channel+1) * num_per_output_channel;
+      const TensorDataType bias_term = local_bias(channel, 0);
+      for (El::Int col = 0; col < local_width; ++col) {
+        for (El::Int row = row_start; row < row_end; ++row) {
+          auto& y = local_output(row, col);
+          y += bias_term;
+          if (apply_relu && y < zero) { y = zero; }
+        }
+      }
+    }
+
+  }
+
   void compute_gradients_im2col(bool using_transposed_convolution) {
 
     // Local matrices
@@ -1204,23 +1481,16 @@ private:
     const TensorDataType* kernel,
     const cudnnConvolutionDescriptor_t& conv_desc,
     const cudnnTensorDescriptor_t& output_desc,
-    TensorDataType* output,
-    size_t ws_size,
-    TensorDataType* ws) {
+    TensorDataType* output) {
     if (m_fwd_cudnn_algos.count(local_mini_batch_size) == 0) {
-#ifdef LBANN_DETERMINISTIC
-      bool deterministic = true;
-#else
-      bool deterministic = false;
-#endif
+      const bool deterministic = deterministic_mode();
       m_fwd_cudnn_algos[local_mini_batch_size] =
         cudnn::get_fwd_algorithm(
           true, deterministic,
           input_desc, input,
           kernel_desc, kernel,
           conv_desc,
-          output_desc, output,
-          ws_size, ws);
+          output_desc, output);
     }
     return m_fwd_cudnn_algos[local_mini_batch_size];
   }
@@ -1234,23 +1504,16 @@ private:
     const TensorDataType* prev_error_signal,
     const cudnnConvolutionDescriptor_t& conv_desc,
     const cudnnTensorDescriptor_t& error_signal_desc,
-    TensorDataType* error_signal,
-    size_t ws_size,
-    TensorDataType* ws) {
+    TensorDataType* error_signal) {
     if (m_bwd_data_cudnn_algos.count(local_mini_batch_size) == 0) {
-#ifdef LBANN_DETERMINISTIC
-      bool deterministic = true;
-#else
-      bool deterministic = false;
-#endif
+      const bool deterministic = deterministic_mode();
       m_bwd_data_cudnn_algos[local_mini_batch_size] =
         cudnn::get_bwd_data_algorithm(
           true, deterministic,
           kernel_desc, kernel,
           prev_error_signal_desc, prev_error_signal,
           conv_desc,
-          error_signal_desc, error_signal,
-          ws_size, ws);
+          error_signal_desc, error_signal);
     }
     return m_bwd_data_cudnn_algos[local_mini_batch_size];
   }
@@ -1266,15 +1529,9 @@ private:
     const cudnnTensorDescriptor_t& prev_error_signal_desc,
     const TensorDataType* prev_error_signal,
     const cudnnConvolutionDescriptor_t& conv_desc,
-    const cudnnFilterDescriptor_t& kernel_gradient_desc,
-    size_t ws_size,
-    TensorDataType* ws) {
+    const cudnnFilterDescriptor_t& kernel_gradient_desc) {
     if (m_bwd_filter_cudnn_algos.count(local_mini_batch_size) == 0) {
-#ifdef LBANN_DETERMINISTIC
-      bool deterministic = true;
-#else
-      bool deterministic = false;
-#endif
+      const bool deterministic = deterministic_mode();
       // Temporary filter gradient buffer.
       El::Matrix<TensorDataType, El::Device::GPU> kernel_gradient;
 #ifdef HYDROGEN_HAVE_CUB
@@ -1288,8 +1545,7 @@ private:
           input_desc, input,
           prev_error_signal_desc, prev_error_signal,
           conv_desc,
-          kernel_gradient_desc, kernel_gradient.Buffer(),
-          ws_size, ws);
+          kernel_gradient_desc, kernel_gradient.Buffer());
     }
     return m_bwd_filter_cudnn_algos[local_mini_batch_size];
   }
@@ -31,6 +31,8 @@
 #include "lbann/utils/exception.hpp"
 #include "lbann/utils/distconv.hpp"
 
+#include <algorithm>
+
 namespace lbann {
 
 // Forward declaration.
@@ -53,6 +55,52 @@ class convolution_distconv_adapter: public base_convolution_adapter<TensorDataTy
 };
 #endif // LBANN_HAS_DISTCONV
 
+/** @brief Fold inference-mode batch normalization into a convolution.
+ *
+ *  With @f$ s = \gamma / \sqrt{\sigma^2 + \epsilon} @f$, output
+ *  channel @f$ k @f$ of the fused kernel is the kernel's channel
+ *  scaled by @f$ s_k @f$ and the fused bias is
+ *  @f$ (c b_k - \mu_k) s_k + \beta_k @f$, where @f$ c @f$ is the
+ *  convolution's bias scaling factor.
+ *
+ *  @param kernel       Convolution kernel, one column per output
+ *                      channel.
+ *  @param bias         Convolution bias, or @c nullptr if there is
+ *                      none.
+ *  @param bias_scale   Convolution bias scaling factor.
+ *  @param scale        Batch normalization scale (@f$ \gamma @f$).
+ *  @param shift        Batch normalization bias (@f$ \beta @f$).
+ *  @param mean         Batch normalization running mean.
+ *  @param var          Batch normalization running variance.
+ *  @param epsilon      Batch normalization variance offset.
+ *  @param fused_kernel Output kernel, resized to match @c kernel.
+ *  @param fused_bias   Output bias, resized to a column vector.
+ */
+template <typename TensorDataType>
+void fold_batchnorm(const El::Matrix<TensorDataType, El::Device::CPU>& kernel,
+                    const El::Matrix<TensorDataType, El::Device::CPU>* bias,
+                    TensorDataType bias_scale,
+                    const El::Matrix<TensorDataType, El::Device::CPU>& scale,
+                    const El::Matrix<TensorDataType, El::Device::CPU>& shift,
+                    const El::Matrix<TensorDataType, El::Device::CPU>& mean,
+                    const El::Matrix<TensorDataType, El::Device::CPU>& var,
+                    TensorDataType epsilon,
+                    El::Matrix<TensorDataType, El::Device::CPU>& fused_kernel,
+                    El::Matrix<TensorDataType, El::Device::CPU>& fused_bias);
+#ifdef LBANN_HAS_GPU
+template <typename TensorDataType>
+void fold_batchnorm(const El::Matrix<TensorDataType, El::Device::GPU>& kernel,
+                    const El::Matrix<TensorDataType, El::Device::GPU>* bias,
+                    TensorDataType bias_scale,
+                    const El::Matrix<TensorDataType, El::Device::GPU>& scale,
+                    const El::Matrix<TensorDataType, El::Device::GPU>& shift,
+                    const El::Matrix<TensorDataType, El::Device::GPU>& mean,
+                    const El::Matrix<TensorDataType, El::Device::GPU>& var,
+                    TensorDataType epsilon,
+                    El::Matrix<TensorDataType, El::Device::GPU>& fused_kernel,
+                    El::Matrix<TensorDataType, El::Device::GPU>& fused_bias);
+#endif // LBANN_HAS_GPU
+
 /** @brief Standard deep learning convolution.
  *
  *  Applies convolution (more precisely, cross-correlation) to input
@@ -119,6 +167,49 @@ public:
 
   El::Device get_device_allocation() const override { return Device; }
 
+  description get_description() const override {
+    auto desc = base_convolution_layer<TensorDataType, Device>::get_description();
+    if (m_fused_batchnorm_index > 0) {
+      desc.add("Fused layers",
+               m_fused_relu ? "batch normalization, ReLU" : "batch normalization");
+    }
+    return desc;
+  }
+
+  /** @brief Fold an inference-mode batch normalization, and
+   *  optionally a following ReLU, into this layer.
+   *
+   *  The batch normalization weights are appended to this layer's
+   *  weights. Every forward prop folds their current values into
+   *  the kernel and bias, so weights loaded after setup are picked
+   *  up. The layer can no longer be trained.
+   *
+   *  @param bn_weights Scale, bias, running mean, and running
+   *                    variance of a batch normalization layer.
+   *  @param epsilon    Batch normalization's variance offset.
+   *  @param fuse_relu  Whether a ReLU follows the batch normalization.
+   */
+  void fuse_batchnorm(const std::vector<data_type_weights<TensorDataType>*>& bn_weights,
+                      TensorDataType epsilon,
+                      bool fuse_relu) {
+    if (m_fused_batchnorm_index > 0) {
+      LBANN_ERROR(this->get_type()," layer \"",this->get_name(),"\" ",
+                  "already has a fused batch normalization");
+    }
+    if (bn_weights.size() != 4
+        || std::find(bn_weights.begin(), bn_weights.end(), nullptr) != bn_weights.end()) {
+      LBANN_ERROR("attempted to fuse batch normalization into ",
+                  this->get_type()," layer \"",this->get_name(),"\" ",
+                  "without its scale, bias, mean, and variance weights");
+    }
+    m_fused_batchnorm_index = this->num_weights();
+    for (auto* w : bn_weights) {
+      this->add_weights(w);
+    }
+    m_fused_batchnorm_epsilon = epsilon;
+    m_fused_relu = fuse_relu;
+  }
+
 protected:
 
   void setup_dims(DataReaderMetaData& dr_metadata) override {
@@ -156,6 +247,10 @@ protected:
   }
 
   void fp_compute() override {
+    if (m_fused_batchnorm_index > 0) {
+      fp_compute_fused();
+      return;
+    }
     if(this->using_gpus()) {
 #ifdef LBANN_HAS_DISTCONV
       if (this->distconv_enabled()) {
@@ -167,12 +262,20 @@ protected:
       base_convolution_layer<TensorDataType, Device>::apply_convolution_cudnn(true);
       base_convolution_layer<TensorDataType, Device>::apply_bias_cudnn();
     } else {
-      base_convolution_layer<TensorDataType, Device>::apply_convolution_im2col(true);
+      if (this->m_use_winograd) {
+        base_convolution_layer<TensorDataType, Device>::apply_convolution_winograd();
+      } else {
+        base_convolution_layer<TensorDataType, Device>::apply_convolution_im2col(true);
+      }
       base_convolution_layer<TensorDataType, Device>::apply_bias_cpu();
     }
   }
 
   void bp_compute() override {
+    if (m_fused_batchnorm_index > 0) {
+      LBANN_ERROR(this->get_type()," layer \"",this->get_name(),"\" ",
+                  "has a fused batch normalization and only supports inference");
+    }
     if(this->using_gpus()) {
 #ifdef LBANN_HAS_DISTCONV
       if (this->distconv_enabled()) {
@@ -186,13 +289,71 @@ protected:
       }
 #endif // LBANN_HAS_DISTCONV
       base_convolution_layer<TensorDataType, Device>::compute_gradients_cudnn(false);
-      base_convolution_layer<TensorDataType, Device>::apply_transposed_convolution_cudnn(false);
+      if (this->error_signals_needed()) {
+        base_convolution_layer<TensorDataType, Device>::apply_transposed_convolution_cudnn(false);
+      }
     } else {
       base_convolution_layer<TensorDataType, Device>::compute_gradients_im2col(false);
-      base_convolution_layer<TensorDataType, Device>::apply_transposed_convolution_im2col(false);
+      if (this->error_signals_needed()) {
+        base_convolution_layer<TensorDataType, Device>::apply_transposed_convolution_im2col(false);
+      }
     }
   }
 
+private:
+
+  /** @brief Index of the first fused batch normalization weights.
+   *  @details Zero if no batch normalization is fused.
+   */
+  size_t m_fused_batchnorm_index = 0;
+  /** Variance offset of the fused batch normalization. */
+  TensorDataType m_fused_batchnorm_epsilon = El::TypeTraits<TensorDataType>::Zero();
+  /** Whether a ReLU is fused after the batch normalization. */
+  bool m_fused_relu = false;
+
+  /** Forward prop with the fused batch normalization and ReLU. */
+  void fp_compute_fused() {
+    using LocalMat = El::Matrix<TensorDataType, Device>;
+    const auto& w = this->get_data_type_weights();
+    auto local_values = [&w](size_t i) -> const LocalMat& {
+      return dynamic_cast<const LocalMat&>(w[i]->get_values().LockedMatrix());
+    };
+
+    // Fold the batch normalization's current values
+    const auto& kernel = local_values(0);
+    LocalMat kernel_view;
+    kernel_view.LockedAttach(kernel.Height() * kernel.Width() / this->m_output_channels,
+                             this->m_output_channels,
+                             kernel.LockedBuffer(),
+                             kernel.Height() * kernel.Width() / this->m_output_channels);
+    const bool has_bias = (this->m_bias_scaling_factor
+                           != El::TypeTraits<typename base_convolution_layer<TensorDataType, Device>::ScalingType>::Zero());
+    const auto i = m_fused_batchnorm_index;
+    fold_batchnorm(kernel_view,
+                   has_bias ? &local_values(1) : nullptr,
+                   TensorDataType(this->m_bias_scaling_factor),
+                   local_values(i),
+                   local_values(i+1),
+                   local_values(i+2),
+                   local_values(i+3),
+                   m_fused_batchnorm_epsilon,
+                   this->m_fused_kernel,
+                   this->m_fused_bias);
+
+    // Apply fused convolution
+    if (this->using_gpus()) {
+      base_convolution_layer<TensorDataType, Device>::apply_fused_convolution_cudnn(m_fused_relu);
+    } else {
+      if (this->m_use_winograd) {
+        base_convolution_layer<TensorDataType, Device>::apply_convolution_winograd();
+      } else {
+        base_convolution_layer<TensorDataType, Device>::apply_convolution_im2col(true);
+      }
+      base_convolution_layer<TensorDataType, Device>::apply_fused_bias_cpu(m_fused_relu);
+    }
+
+  }
+
 #ifdef LBANN_HAS_DISTCONV
   friend class convolution_distconv_adapter<TensorDataType, Layout, Device>;
  protected:
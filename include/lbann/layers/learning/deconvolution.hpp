@@ -200,10 +200,14 @@ protected:
       }
 #endif // LBANN_HAS_DISTCONV
       base_convolution_layer<TensorDataType, Device>::compute_gradients_cudnn(true);
-      base_convolution_layer<TensorDataType, Device>::apply_convolution_cudnn(false);
+      if (this->error_signals_needed()) {
+        base_convolution_layer<TensorDataType, Device>::apply_convolution_cudnn(false);
+      }
     } else {
       base_convolution_layer<TensorDataType, Device>::compute_gradients_im2col(true);
-      base_convolution_layer<TensorDataType, Device>::apply_convolution_im2col(false);
+      if (this->error_signals_needed()) {
+        base_convolution_layer<TensorDataType, Device>::apply_convolution_im2col(false);
+      }
     }
   }
 
@@ -29,7 +29,13 @@
 
 #include "lbann/layers/data_type_layer.hpp"
 #include "lbann/models/model.hpp"
+#include "lbann/optimizers/sparse_gradient.hpp"
 #include "lbann/utils/memory.hpp"
+#ifdef LBANN_HAS_NVSHMEM
+#include "lbann/utils/nvshmem.hpp"
+#endif // LBANN_HAS_NVSHMEM
+#include <cmath>
+#include <numeric>
 
 namespace lbann {
 
@@ -46,6 +52,14 @@ namespace lbann {
  *  @f$ \text{embedding\_dim} \times \text{num\_embeddings} @f$
  *  weights matrix. Note that this is the transpose of the weights in
  *  the PyTorch embedding layer.
+ *
+ *  Tables that are too large for one process can be sharded over the
+ *  trainer: embedding vector @f$ i @f$ is stored on rank
+ *  @f$ i \bmod P @f$. The input and output stay data-parallel, so
+ *  forward prop sends each index to the rank that owns it and
+ *  receives the embedding vector back with all-to-all exchanges.
+ *  Back prop sends the output gradients along the reverse path, so
+ *  each rank only computes the gradient w.r.t. its own vectors.
  */
 template <typename TensorDataType, data_layout Layout, El::Device Device>
 class embedding_layer : public data_type_layer<TensorDataType> {
@@ -76,11 +90,23 @@ public:
    *                        vector is initialized with zeros. The
    *                        objective function gradient w.r.t. this
    *                        embedding vector is always zero.
+   *  @param sparse_gradient Whether to pass the optimizer only the
+   *                        gradient w.r.t. the embedding vectors in
+   *                        the mini-batch (see
+   *                        @c data_type_optimizer::add_to_sparse_gradient).
+   *                        Communication and optimization steps then
+   *                        scale with the number of unique indices
+   *                        rather than with @c num_embeddings.
+   *  @param sharded        Whether the embedding vectors are
+   *                        distributed over the trainer's ranks
+   *                        rather than replicated.
    */
   embedding_layer(lbann_comm* comm,
                   size_t num_embeddings,
                   size_t embedding_dim,
-                  El::Int padding_idx=-1);
+                  El::Int padding_idx=-1,
+                  bool sparse_gradient=false,
+                  bool sharded=false);
 
   embedding_layer(const embedding_layer& other);
   embedding_layer& operator=(const embedding_layer& other);
@@ -90,6 +116,8 @@ public:
   std::string get_type() const override;
   data_layout get_data_layout() const override;
   El::Device get_device_allocation() const override;
+  /** Sparse backprop reads the input indices on the host. */
+  bool supports_cuda_graph() const override { return !m_sparse_gradient; }
 
   description get_description() const override;
 
@@ -104,6 +132,20 @@ protected:
 
 private:
 
+  /** Backprop with a column-sparse gradient w.r.t. embeddings. */
+  void sparse_bp_compute();
+  /** Forward prop with embedding vectors distributed over ranks. */
+  void sharded_fp_compute();
+  /** Backprop with embedding vectors distributed over ranks. */
+  void sharded_bp_compute();
+  /** @brief Exchange matrix columns with all ranks in the trainer.
+   *  @details The matrices are staged through host memory.
+   */
+  void exchange_columns(const El::Matrix<TensorDataType, Device>& send,
+                        const std::vector<int>& send_counts,
+                        El::Matrix<TensorDataType, Device>& recv,
+                        const std::vector<int>& recv_counts);
+
   /** Size of dictionary of embeddings. */
   size_t m_num_embeddings;
   /** Size of embedding vectors. */
@@ -113,8 +155,30 @@ private:
    *  gradient w.r.t. this embedding vector is always zero.
    */
   El::Int m_padding_idx;
+  /** Whether the gradient w.r.t. embeddings is passed to the
+   *  optimizer as a column-sparse matrix.
+   */
+  bool m_sparse_gradient;
+  /** Whether the embedding vectors are distributed over ranks. */
+  bool m_sharded;
+
+  /** @name Lookup exchange for sharded tables
+   *  @details Set in forward prop and reused in backprop.
+   */
+  ///@{
+  /** Number of lookups sent to each rank. */
+  std::vector<int> m_send_counts;
+  /** Number of lookups received from each rank. */
+  std::vector<int> m_recv_counts;
+  /** Output column of each lookup sent, ordered by rank. */
+  std::vector<El::Int> m_send_positions;
+  /** Local embedding vector of each lookup received. */
+  std::vector<El::Int> m_recv_cols;
+  ///@}
 
-  /** Gradient w.r.t. embedding weights. */
+  /** Gradient w.r.t. embedding weights.
+   *  @details Not used with a sparse gradient.
+   */
   std::unique_ptr<AbsDistMatrixType> m_embeddings_grad;
 
 };
@@ -128,11 +192,15 @@ embedding_layer<TensorDataType,Layout,Device>::embedding_layer(
   lbann_comm* comm,
   size_t num_embeddings,
   size_t embedding_dim,
-  El::Int padding_idx)
+  El::Int padding_idx,
+  bool sparse_gradient,
+  bool sharded)
   : data_type_layer<TensorDataType>(comm),
     m_num_embeddings{num_embeddings},
     m_embedding_dim{embedding_dim},
-    m_padding_idx{padding_idx} {}
+    m_padding_idx{padding_idx},
+    m_sparse_gradient{sparse_gradient},
+    m_sharded{sharded} {}
 
 template <typename TensorDataType, data_layout Layout, El::Device Device>
 embedding_layer<TensorDataType,Layout,Device>::embedding_layer(
@@ -141,6 +209,8 @@ embedding_layer<TensorDataType,Layout,Device>::embedding_layer(
     m_num_embeddings{other.m_num_embeddings},
     m_embedding_dim{other.m_embedding_dim},
     m_padding_idx{other.m_padding_idx},
+    m_sparse_gradient{other.m_sparse_gradient},
+    m_sharded{other.m_sharded},
     m_embeddings_grad(other.m_embeddings_grad
                       ? other.m_embeddings_grad->Copy()
                       : nullptr) {}
@@ -152,6 +222,8 @@ embedding_layer<TensorDataType,Layout,Device>& embedding_layer<TensorDataType,La
   m_num_embeddings = other.m_num_embeddings;
   m_embedding_dim = other.m_embedding_dim;
   m_padding_idx = other.m_padding_idx;
+  m_sparse_gradient = other.m_sparse_gradient;
+  m_sharded = other.m_sharded;
   m_embeddings_grad.reset(other.m_embeddings_grad
                           ? other.m_embeddings_grad->Copy()
                           : nullptr);
@@ -184,6 +256,8 @@ description embedding_layer<TensorDataType,Layout,Device>::get_description() con
   desc.add("Num embeddings", m_num_embeddings);
   desc.add("Embedding dim", m_embedding_dim);
   desc.add("Padding index", m_padding_idx);
+  desc.add("Sparse gradient", m_sparse_gradient);
+  desc.add("Sharded", m_sharded);
   return desc;
 }
 
@@ -224,7 +298,7 @@ void embedding_layer<TensorDataType,Layout,Device>::setup_data(size_t max_mini_b
   auto& embeddings = this->get_data_type_weights(0);
   auto matrix_dist = this->get_prev_activations().DistData();
   matrix_dist.colDist = El::STAR;
-  matrix_dist.rowDist = El::STAR;
+  matrix_dist.rowDist = (m_sharded ? El::VC : El::STAR);
   embeddings.set_dims({static_cast<int>(m_embedding_dim)},
                       {static_cast<int>(m_num_embeddings)});
   embeddings.set_matrix_distribution(matrix_dist);
@@ -242,7 +316,261 @@ void embedding_layer<TensorDataType,Layout,Device>::setup_data(size_t max_mini_b
   }
 
   // Initialize gradient w.r.t. embeddings
-  m_embeddings_grad->Resize(m_embedding_dim, m_num_embeddings);
+  if (!m_sparse_gradient) {
+    m_embeddings_grad->Resize(m_embedding_dim, m_num_embeddings);
+  }
+
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void embedding_layer<TensorDataType,Layout,Device>::sparse_bp_compute() {
+  using MatType = El::Matrix<TensorDataType, Device>;
+  using CPUMatType = El::Matrix<TensorDataType, El::Device::CPU>;
+  auto& opt = *this->get_data_type_weights(0).get_optimizer();
+
+  // Find embedding vectors used by the local mini-batch
+  // Note: Indices are needed on the host to build the sparse gradient.
+  CPUMatType local_input;
+  El::Copy(this->get_local_prev_activations(), local_input);
+  const El::Int input_size = this->get_input_size();
+  const El::Int local_mini_batch_size = local_input.Width();
+  std::vector<El::Int> cols, positions;
+  for (El::Int j=0; j<local_mini_batch_size; ++j) {
+    for (El::Int i=0; i<input_size; ++i) {
+      const El::Int ind = static_cast<El::Int>(std::floor(local_input(i, j)));
+      if (0<=ind && ind<static_cast<El::Int>(m_num_embeddings)
+          && ind!=m_padding_idx) {
+        cols.push_back(ind);
+        positions.push_back(i + j*input_size);
+      }
+    }
+  }
+
+  // View output gradient with one column per input index
+  const auto& local_output_grad = dynamic_cast<const MatType&>(this->get_local_prev_error_signals());
+  MatType contiguous_output_grad, output_grad_v;
+  const MatType* output_grad = &local_output_grad;
+  if (local_output_grad.LDim() != local_output_grad.Height()) {
+    El::Copy(local_output_grad, contiguous_output_grad);
+    output_grad = &contiguous_output_grad;
+  }
+  output_grad_v.LockedAttach(m_embedding_dim,
+                             input_size * local_mini_batch_size,
+                             output_grad->LockedBuffer(),
+                             m_embedding_dim);
+
+  // Gradient w.r.t. used embedding vectors
+  MatType embeddings_grad(m_embedding_dim, cols.size());
+  sparse_gradient<TensorDataType>::gather_columns(output_grad_v,
+                                                  positions,
+                                                  embeddings_grad);
+  opt.add_to_sparse_gradient(cols, embeddings_grad,
+                             El::TypeTraits<TensorDataType>::One(), true);
+
+}
+
+namespace details {
+
+/** Exchange GPU columns with NVSHMEM if possible. Sizes are in
+ *  entries. Returns false if the exchange must be staged through the
+ *  host. */
+template <typename T>
+bool nvshmem_exchange_columns(const El::Matrix<T, El::Device::CPU>&,
+                              const std::vector<int>&,
+                              El::Matrix<T, El::Device::CPU>&,
+                              const std::vector<int>&,
+                              const El::mpi::Comm&) {
+  return false;
+}
+#ifdef LBANN_HAS_NVSHMEM
+template <typename T>
+bool nvshmem_exchange_columns(const El::Matrix<T, El::Device::GPU>& send,
+                              const std::vector<int>& send_sizes,
+                              El::Matrix<T, El::Device::GPU>& recv,
+                              const std::vector<int>& recv_sizes,
+                              const El::mpi::Comm& c) {
+  if (!nvshmem::is_initialized()
+      || (send.Width() > 1 && send.LDim() != send.Height())
+      || (recv.Width() > 1 && recv.LDim() != recv.Height())) {
+    return false;
+  }
+  std::vector<size_t> send_bytes(send_sizes.begin(), send_sizes.end());
+  std::vector<size_t> recv_bytes(recv_sizes.begin(), recv_sizes.end());
+  for (auto& b : send_bytes) { b *= sizeof(T); }
+  for (auto& b : recv_bytes) { b *= sizeof(T); }
+  nvshmem::all_to_all(send.LockedBuffer(), send_bytes,
+                      recv.Buffer(), recv_bytes,
+                      c, El::SyncInfoFromMatrix(recv).Stream());
+  return true;
+}
+#endif // LBANN_HAS_NVSHMEM
+
+} // namespace details
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void embedding_layer<TensorDataType,Layout,Device>::exchange_columns(
+  const El::Matrix<TensorDataType, Device>& send,
+  const std::vector<int>& send_counts,
+  El::Matrix<TensorDataType, Device>& recv,
+  const std::vector<int>& recv_counts) {
+  using CPUMatType = El::Matrix<TensorDataType, El::Device::CPU>;
+  auto& comm = *this->get_comm();
+  const El::Int height = m_embedding_dim;
+  std::vector<int> send_sizes(send_counts), recv_sizes(recv_counts);
+  El::Int recv_width = 0;
+  for (size_t i = 0; i < send_sizes.size(); ++i) {
+    recv_width += recv_sizes[i];
+    send_sizes[i] *= height;
+    recv_sizes[i] *= height;
+  }
+  recv.Resize(height, recv_width);
+  if (details::nvshmem_exchange_columns(send, send_sizes,
+                                        recv, recv_sizes,
+                                        comm.get_trainer_comm())) {
+    return;
+  }
+  CPUMatType send_cpu, recv_cpu(height, recv_width);
+  El::Copy(send, send_cpu);
+  comm.all_to_all(send_cpu.LockedBuffer(), send_sizes,
+                  recv_cpu.Buffer(), recv_sizes,
+                  comm.get_trainer_comm());
+  El::Copy(recv_cpu, recv);
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void embedding_layer<TensorDataType,Layout,Device>::sharded_fp_compute() {
+  using MatType = El::Matrix<TensorDataType, Device>;
+  using CPUMatType = El::Matrix<TensorDataType, El::Device::CPU>;
+  auto& comm = *this->get_comm();
+  const int procs = comm.get_procs_per_trainer();
+
+  // Sort lookups by the rank that owns the embedding vector
+  // Note: Embedding vector i is in local column i/procs on rank
+  // i%procs.
+  CPUMatType local_input;
+  El::Copy(this->get_local_prev_activations(), local_input);
+  const El::Int input_size = this->get_input_size();
+  const El::Int local_mini_batch_size = local_input.Width();
+  std::vector<std::vector<El::Int>> send_cols(procs), send_positions(procs);
+  for (El::Int j=0; j<local_mini_batch_size; ++j) {
+    for (El::Int i=0; i<input_size; ++i) {
+      const El::Int ind = static_cast<El::Int>(std::floor(local_input(i, j)));
+      if (0<=ind && ind<static_cast<El::Int>(m_num_embeddings)) {
+        send_cols[ind % procs].push_back(ind / procs);
+        send_positions[ind % procs].push_back(i + j*input_size);
+      }
+    }
+  }
+  std::vector<El::Int> all_send_cols;
+  m_send_counts.assign(procs, 0);
+  m_send_positions.clear();
+  for (int rank = 0; rank < procs; ++rank) {
+    m_send_counts[rank] = send_cols[rank].size();
+    all_send_cols.insert(all_send_cols.end(),
+                         send_cols[rank].begin(), send_cols[rank].end());
+    m_send_positions.insert(m_send_positions.end(),
+                            send_positions[rank].begin(),
+                            send_positions[rank].end());
+  }
+
+  // Send lookups to owners
+  const std::vector<int> ones(procs, 1);
+  m_recv_counts.assign(procs, 0);
+  comm.all_to_all(m_send_counts.data(), ones,
+                  m_recv_counts.data(), ones,
+                  comm.get_trainer_comm());
+  m_recv_cols.resize(std::accumulate(m_recv_counts.begin(),
+                                     m_recv_counts.end(), 0));
+  comm.all_to_all(all_send_cols.data(), m_send_counts,
+                  m_recv_cols.data(), m_recv_counts,
+                  comm.get_trainer_comm());
+
+  // Send requested embedding vectors back
+  const auto& local_embeddings = dynamic_cast<const MatType&>(this->get_data_type_weights(0).get_values().LockedMatrix());
+  MatType requested(m_embedding_dim, m_recv_cols.size()), received;
+  sparse_gradient<TensorDataType>::gather_columns(local_embeddings,
+                                                  m_recv_cols,
+                                                  requested);
+  exchange_columns(requested, m_recv_counts, received, m_send_counts);
+
+  // Write embedding vectors to output
+  // Note: Output is zero for out-of-range indices.
+  auto& local_output = dynamic_cast<MatType&>(this->get_local_activations());
+  MatType contiguous_output, output_v;
+  MatType* output = &local_output;
+  if (local_output.LDim() != local_output.Height()) {
+    contiguous_output.Resize(local_output.Height(), local_output.Width());
+    output = &contiguous_output;
+  }
+  El::Zero(*output);
+  output_v.Attach(m_embedding_dim,
+                  input_size * local_mini_batch_size,
+                  output->Buffer(),
+                  m_embedding_dim);
+  sparse_gradient<TensorDataType>::scatter_columns(received,
+                                                   m_send_positions,
+                                                   output_v);
+  if (output != &local_output) {
+    El::Copy(contiguous_output, local_output);
+  }
+
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void embedding_layer<TensorDataType,Layout,Device>::sharded_bp_compute() {
+  using MatType = El::Matrix<TensorDataType, Device>;
+  const TensorDataType one = El::TypeTraits<TensorDataType>::One();
+  auto& opt = *this->get_data_type_weights(0).get_optimizer();
+  auto& comm = *this->get_comm();
+  const int procs = comm.get_procs_per_trainer();
+  const int rank = comm.get_rank_in_trainer();
+
+  // Send output gradients to owners of the embedding vectors
+  const auto& local_output_grad = dynamic_cast<const MatType&>(this->get_local_prev_error_signals());
+  MatType contiguous_output_grad, output_grad_v;
+  const MatType* output_grad = &local_output_grad;
+  if (local_output_grad.LDim() != local_output_grad.Height()) {
+    El::Copy(local_output_grad, contiguous_output_grad);
+    output_grad = &contiguous_output_grad;
+  }
+  output_grad_v.LockedAttach(m_embedding_dim,
+                             output_grad->Width() * this->get_input_size(),
+                             output_grad->LockedBuffer(),
+                             m_embedding_dim);
+  MatType packed(m_embedding_dim, m_send_positions.size()), received;
+  sparse_gradient<TensorDataType>::gather_columns(output_grad_v,
+                                                  m_send_positions,
+                                                  packed);
+  exchange_columns(packed, m_send_counts, received, m_recv_counts);
+
+  // Don't update gradient for padding index
+  std::vector<El::Int> cols(m_recv_cols);
+  if (0 <= m_padding_idx
+      && m_padding_idx < static_cast<El::Int>(m_num_embeddings)
+      && m_padding_idx % procs == rank) {
+    std::vector<El::Int> keep;
+    cols.clear();
+    for (size_t j = 0; j < m_recv_cols.size(); ++j) {
+      if (m_recv_cols[j] != m_padding_idx / procs) {
+        keep.push_back(j);
+        cols.push_back(m_recv_cols[j]);
+      }
+    }
+    MatType kept(m_embedding_dim, keep.size());
+    sparse_gradient<TensorDataType>::gather_columns(received, keep, kept);
+    El::Copy(kept, received);
+  }
+
+  // Gradient w.r.t. local embedding vectors
+  if (m_sparse_gradient) {
+    opt.add_to_sparse_gradient(cols, received, one, false);
+  } else {
+    auto& local_embeddings_grad = dynamic_cast<MatType&>(this->m_embeddings_grad->Matrix());
+    El::Zero(local_embeddings_grad);
+    sparse_gradient<TensorDataType>::add_columns(received, cols, one,
+                                                 local_embeddings_grad);
+    opt.add_to_gradient(*this->m_embeddings_grad, one, false);
+  }
 
 }
 
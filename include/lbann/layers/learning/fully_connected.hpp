@@ -29,16 +29,35 @@
 
 #include "lbann/layers/learning/learning.hpp"
 #include "lbann/models/model.hpp"
+#include "lbann/utils/sparse.hpp"
 #include "lbann/weights/initializer.hpp"
 #include "lbann/weights/variance_scaling_initializers.hpp"
 
 #include <layers.pb.h>
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <sstream>
 
 namespace lbann {
 
+/** @brief Tensor-parallel role of a model-parallel fully-connected layer
+ *
+ *  A COLUMN layer followed by a ROW layer (e.g. the two GEMMs of a
+ *  transformer MLP block) keeps the intermediate activations sharded
+ *  along features: the COLUMN layer splits its linearity by output
+ *  features and the ROW layer by input features, so each process only
+ *  multiplies local blocks. The ROW layer's forward pass and the
+ *  COLUMN layer's backward pass each need one allreduce of partial
+ *  sums over the process grid columns, issued chunk by chunk
+ *  along the mini-batch so it overlaps the remaining GEMMs. The
+ *  features of the pair's input (forward) and output gradient
+ *  (backward) are gathered once, since model-parallel activations are
+ *  stored sharded.
+ */
+enum class fully_connected_tensor_parallel { NONE, COLUMN, ROW };
+
 /** @brief Affine transformation
  *
  *  Flattens the input tensor, multiplies with a weights matrix, and
@@ -51,6 +70,16 @@ namespace lbann {
  *  applied. If weights aren't provided, the linearity weights are
  *  initialized with He normal initialization and the bias weights are
  *  initialized to zero.
+ *
+ *  With the model-parallel layout, the layer may instead follow a
+ *  tensor-parallel scheme (see @c fully_connected_tensor_parallel).
+ *
+ *  Data-parallel CPU layers can be told to expect sparse inputs,
+ *  e.g. the first layer of a model whose features are mostly zero.
+ *  The local input is then compressed every step, and if few enough
+ *  entries are nonzero the forward GEMM and the linearity gradient
+ *  only touch the nonzeros (see @c sparse_gemm). GPU layers ignore
+ *  the hint.
  */
 template <typename TensorDataType, data_layout T_layout, El::Device Dev>
 class fully_connected_layer : public learning_layer<TensorDataType> {
@@ -76,10 +105,27 @@ public:
                         int output_size,
                         bool transpose = false,
                         WeightsType* weight = nullptr,
-                        bool has_bias = true)
+                        bool has_bias = true,
+                        fully_connected_tensor_parallel tensor_parallel
+                          = fully_connected_tensor_parallel::NONE,
+                        int tensor_parallel_chunks = 1,
+                        bool sparse_input = false)
     : learning_layer<TensorDataType>(comm),
       m_bias_gradient(nullptr),
-      m_transpose(transpose) {
+      m_transpose(transpose),
+      m_tensor_parallel(tensor_parallel),
+      m_tensor_parallel_chunks(std::max(tensor_parallel_chunks, 1)),
+      m_sparse_input(sparse_input) {
+
+    if (m_tensor_parallel != fully_connected_tensor_parallel::NONE
+        && T_layout != data_layout::MODEL_PARALLEL) {
+      LBANN_ERROR("tensor-parallel fully-connected layers "
+                  "require the model-parallel data layout");
+    }
+    if (m_sparse_input && T_layout != data_layout::DATA_PARALLEL) {
+      LBANN_ERROR("fully-connected layers with sparse inputs "
+                  "require the data-parallel data layout");
+    }
 
     // Initialize output tensor dimensions
     this->set_output_dims({output_size});
@@ -92,7 +138,10 @@ public:
   fully_connected_layer(const fully_connected_layer& other) :
     learning_layer<TensorDataType>(other),
     m_bias_scaling_factor(other.m_bias_scaling_factor),
-    m_transpose(other.m_transpose) {
+    m_transpose(other.m_transpose),
+    m_tensor_parallel(other.m_tensor_parallel),
+    m_tensor_parallel_chunks(other.m_tensor_parallel_chunks),
+    m_sparse_input(other.m_sparse_input) {
 
     // Deep matrix copies
     m_bias_gradient = other.m_bias_gradient;
@@ -106,6 +155,9 @@ public:
     learning_layer<TensorDataType>::operator=(other);
     m_bias_scaling_factor = other.m_bias_scaling_factor;
     m_transpose = other.m_transpose;
+    m_tensor_parallel = other.m_tensor_parallel;
+    m_tensor_parallel_chunks = other.m_tensor_parallel_chunks;
+    m_sparse_input = other.m_sparse_input;
 
     // Deep matrix copies
     deallocate_matrices();
@@ -128,12 +180,34 @@ public:
   std::string get_type() const override { return "fully connected"; }
   data_layout get_data_layout() const override { return T_layout; }
   El::Device get_device_allocation() const override { return Dev; }
+  bool uses_outputs_in_backprop() const override { return false; }
+  bool can_skip_error_signals() const override { return true; }
+
+  /** Whether the linearity weights are stored transposed, i.e. with
+   *  one column per output. */
+  bool is_transposed() const noexcept { return m_transpose; }
+  /** Whether an entry-wise bias is applied. */
+  bool has_bias() const noexcept {
+    return m_bias_scaling_factor != El::TypeTraits<TensorDataType>::Zero();
+  }
 
   description get_description() const override {
     auto desc = learning_layer<TensorDataType>::get_description();
     const auto& bias_str = (m_bias_scaling_factor == El::TypeTraits<TensorDataType>::Zero() ?
                             "disabled" : "enabled");
     desc.add("Bias", bias_str);
+    switch (m_tensor_parallel) {
+    case fully_connected_tensor_parallel::COLUMN:
+      desc.add("Tensor parallel", "column");
+      break;
+    case fully_connected_tensor_parallel::ROW:
+      desc.add("Tensor parallel", "row");
+      break;
+    default: break;
+    }
+    if (m_sparse_input) {
+      desc.add("Sparse input", "enabled");
+    }
     return desc;
   }
 
@@ -180,6 +254,15 @@ protected:
       linearity_dist.colDist = El::STAR;
       linearity_dist.rowDist = El::STAR;
     }
+    if (m_tensor_parallel != fully_connected_tensor_parallel::NONE) {
+      // Split output features (column) or input features (row) like
+      // the features of the activations
+      const bool split_rows
+        = ((m_tensor_parallel == fully_connected_tensor_parallel::COLUMN)
+           != m_transpose);
+      linearity_dist.colDist = split_rows ? El::MC : El::STAR;
+      linearity_dist.rowDist = split_rows ? El::STAR : El::MC;
+    }
     if (m_transpose) {
       linearity_weights.set_dims(this->get_input_dims(), this->get_output_dims());
     } else {
@@ -248,6 +331,23 @@ private:
   /** Whether the transpose of the linearity matrix is applied. */
   bool m_transpose;
 
+  /** Tensor-parallel role of the layer. */
+  fully_connected_tensor_parallel m_tensor_parallel;
+  /** Number of mini-batch chunks for overlapping the tensor-parallel
+   *  allreduce with GEMMs. */
+  int m_tensor_parallel_chunks;
+  /** Input with gathered features, kept from forward prop by
+   *  column-parallel layers. */
+  std::unique_ptr<AbsDistMatrixType> m_tensor_parallel_input;
+
+  /** Whether to use sparse GEMMs if the input is mostly zero. */
+  bool m_sparse_input;
+  /** Whether the local input in @c m_sparse_local_input is used for
+   *  the current step. */
+  bool m_use_sparse_local_input = false;
+  /** Compressed local input, kept from forward prop. */
+  sparse_mini_batch<TensorDataType> m_sparse_local_input;
+
   /** Deallocate distributed matrices. */
   void deallocate_matrices() {
     if (m_bias_gradient != nullptr) delete m_bias_gradient;
@@ -257,6 +357,12 @@ private:
   friend void fp_compute_impl(fully_connected_layer<U, T_layout, Dev>& l);
   template <typename U>
   friend void bp_compute_impl(fully_connected_layer<U, T_layout, Dev>& l);
+  template <typename U, El::Device D>
+  friend void fp_compute_tensor_parallel(
+    fully_connected_layer<U, data_layout::MODEL_PARALLEL, D>& l);
+  template <typename U, El::Device D>
+  friend void bp_compute_tensor_parallel(
+    fully_connected_layer<U, data_layout::MODEL_PARALLEL, D>& l);
 };
 
 // Builder function
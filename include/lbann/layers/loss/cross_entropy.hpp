@@ -53,6 +53,17 @@ class cross_entropy_distconv_adapter: public data_type_distconv_adapter<TensorDa
  *  Given a predicted distribution @f$y@f$ and ground truth
  *  distribution @f$\hat{y}@f$,
  *  @f[ CE(y,\hat{y}) = - \sum\limits_{i} \hat{y}_i \log y_i @f]
+ *
+ *  If @c use_logits is set, the first input is instead treated as
+ *  logits @f$x@f$ and softmax is fused into the loss:
+ *  @f[ CE(\text{softmax}(x),\hat{y})
+ *      = \log \left( \sum\limits_j e^{x_j} \right) \sum\limits_i \hat{y}_i
+ *        - \sum\limits_i \hat{y}_i x_i @f]
+ *  The log-sum-exp is computed in one pass with a running maximum
+ *  and the gradient w.r.t. the logits is
+ *  @f$ \text{softmax}(x) \sum_i \hat{y}_i - \hat{y} @f$, so the
+ *  probabilities are never stored. This is more accurate than a
+ *  softmax layer followed by a cross entropy layer.
  */
 template <typename TensorDataType, data_layout T_layout, El::Device Dev>
 class cross_entropy_layer : public data_type_layer<TensorDataType> {
@@ -67,22 +78,32 @@ public:
 
 public:
 
-  cross_entropy_layer(lbann_comm *comm) : data_type_layer<TensorDataType>(comm) {
+  cross_entropy_layer(lbann_comm *comm, bool use_logits = false)
+    : data_type_layer<TensorDataType>(comm),
+      m_use_logits(use_logits) {
     this->m_expected_num_parent_layers = 2;
   }
 
   cross_entropy_layer(const cross_entropy_layer& other)
-    : data_type_layer<TensorDataType>(other) {
+    : data_type_layer<TensorDataType>(other),
+      m_use_logits(other.m_use_logits) {
     m_workspace.reset(other.m_workspace ?
                       other.m_workspace->Copy() :
                       nullptr);
+    m_logits_workspace.reset(other.m_logits_workspace ?
+                             other.m_logits_workspace->Copy() :
+                             nullptr);
   }
 
   cross_entropy_layer& operator=(const cross_entropy_layer& other) {
     data_type_layer<TensorDataType>::operator=(other);
+    m_use_logits = other.m_use_logits;
     m_workspace.reset(other.m_workspace ?
                       other.m_workspace->Copy() :
                       nullptr);
+    m_logits_workspace.reset(other.m_logits_workspace ?
+                             other.m_logits_workspace->Copy() :
+                             nullptr);
     return *this;
   }
 
@@ -91,6 +112,19 @@ public:
   data_layout get_data_layout() const override { return T_layout; }
   El::Device get_device_allocation() const override { return Dev; }
 
+  description get_description() const override {
+    auto desc = data_type_layer<TensorDataType>::get_description();
+    desc.add("Use logits", m_use_logits);
+    return desc;
+  }
+
+  /** @brief Whether the first input is logits rather than a
+   *  probability distribution. */
+  bool get_use_logits() const noexcept { return m_use_logits; }
+  /** @brief Treat the first input as logits and fuse softmax into
+   *  the loss. */
+  void set_use_logits(bool use_logits) { m_use_logits = use_logits; }
+
   void setup_dims(DataReaderMetaData& dr_metadata) override {
     data_type_layer<TensorDataType>::setup_dims(dr_metadata);
     this->set_output_dims({1});
@@ -151,6 +185,15 @@ public:
       m_workspace->Matrix().SetMemoryMode(1); // CUB memory pool
     }
 #endif // HYDROGEN_HAVE_CUB
+    if (m_use_logits) {
+      m_logits_workspace.reset(m_workspace->Construct(m_workspace->Grid(),
+                                                      m_workspace->Root()));
+#ifdef HYDROGEN_HAVE_CUB
+      if (m_logits_workspace->GetLocalDevice() == El::Device::GPU) {
+        m_logits_workspace->Matrix().SetMemoryMode(1); // CUB memory pool
+      }
+#endif // HYDROGEN_HAVE_CUB
+    }
 
   }
 
@@ -167,6 +210,13 @@ public:
     const auto& prediction = this->get_prev_activations(0);
     m_workspace->AlignWith(prediction.DistData());
     m_workspace->Resize(1, prediction.Width());
+    if (m_use_logits) {
+      m_logits_workspace->AlignWith(prediction.DistData());
+      m_logits_workspace->Resize(4, prediction.Width());
+      local_fp_logits_compute();
+      El::Copy(*m_workspace, this->get_activations());
+      return;
+    }
 
     // Compute local contributions and accumulate
     /// @todo Consider reduce rather than allreduce
@@ -191,7 +241,12 @@ public:
     El::Copy(this->get_prev_error_signals(), *m_workspace);
 
     // Compute local gradients
-    local_bp_compute();
+    if (m_use_logits) {
+      local_bp_logits_compute();
+    }
+    else {
+      local_bp_compute();
+    }
   }
 
 private:
@@ -200,15 +255,35 @@ private:
   void local_fp_compute();
   /** Compute local gradients. */
   void local_bp_compute();
+  /** @brief Compute cross entropy loss from logits.
+   *
+   *  Each process finds the maximum, the rescaled sum of
+   *  exponentials, the sum of ground truth entries and the ground
+   *  truth-weighted sum of logits for each local column, and these
+   *  are combined with a max and a sum allreduce. Afterwards, the
+   *  first row of @c m_logits_workspace holds the log-partition
+   *  function and the second row holds the ground truth sums.
+   */
+  void local_fp_logits_compute();
+  /** Compute local gradients w.r.t. logits and ground truth. */
+  void local_bp_logits_compute();
+
+  /** Whether the first input is logits. */
+  bool m_use_logits;
 
   /** Workspace matrix. */
   std::unique_ptr<AbsDistMatrixType> m_workspace;
+  /** @brief Column statistics of logits.
+   *  @details Only used if @c m_use_logits is set.
+   */
+  std::unique_ptr<AbsDistMatrixType> m_logits_workspace;
 
 #ifdef LBANN_HAS_DISTCONV
   friend class cross_entropy_distconv_adapter<TensorDataType, T_layout, Dev>;
  protected:
   bool is_distconv_supported() const override {
-    return Dev == El::Device::GPU && T_layout == data_layout::DATA_PARALLEL;
+    return Dev == El::Device::GPU && T_layout == data_layout::DATA_PARALLEL
+      && !m_use_logits;
   }
 
   void setup_distconv_adapter() override {
@@ -330,6 +405,8 @@ void cross_entropy_distconv_adapter<TensorDataType, T_layout, Dev>::setup_layer(
 }
 #endif // LBANN_HAS_DISTCONV
 
+LBANN_DEFINE_LAYER_BUILDER(cross_entropy);
+
 #ifndef LBANN_CROSS_ENTROPY_LAYER_INSTANTIATE
 
 #define PROTO_DEVICE(T, Device)              \
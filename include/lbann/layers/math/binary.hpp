@@ -28,9 +28,41 @@
 #define LBANN_LAYERS_MATH_BINARY_HPP_INCLUDED
 
 #include "lbann/layers/data_type_layer.hpp"
+#include "lbann/utils/broadcast.hpp"
 
 namespace lbann {
 
+/** @brief Output dimensions of an entry-wise binary layer
+ *
+ *  The input tensors normally have the same dimensions. If @c
+ *  allow_broadcast is set, each dimension of an input can instead be
+ *  1 (or missing from the front), as in NumPy broadcasting. Throws an
+ *  exception if the input dimensions are incompatible.
+ */
+std::vector<int> get_binary_layer_output_dims(const Layer& l,
+                                              bool allow_broadcast);
+
+/** @brief Whether a layer is an entry-wise binary layer
+ *
+ *  These layers can read inputs that are smaller than their output
+ *  (see @c get_binary_layer_broadcast_maps) when they have a
+ *  data-parallel layout.
+ */
+bool is_entrywise_binary_layer(const Layer& l);
+
+/** @brief Index maps for reading the inputs of an entry-wise binary
+ *  layer at its output shape
+ *
+ *  Inputs can be smaller than the output if they are broadcast (see
+ *  @c get_binary_layer_output_dims) or if a tessellate layer has
+ *  been elided (see @c model::setup_lazy_broadcasts).
+ *
+ *  @returns Whether either input is broadcast.
+ */
+bool get_binary_layer_broadcast_maps(const Layer& l,
+                                     broadcast_map& map1,
+                                     broadcast_map& map2);
+
 #define LBANN_DECLARE_ENTRYWISE_BINARY_LAYER(LAYER_NAME, LAYER_STRING)      \
   template <typename TensorDataType, data_layout Layout, El::Device Device> \
   class LAYER_NAME : public data_type_layer<TensorDataType> {               \
@@ -45,26 +77,11 @@ namespace lbann {
     data_layout get_data_layout() const override { return Layout; }         \
     El::Device get_device_allocation() const override { return Device; }    \
   protected:                                                                \
-    void setup_dims(DataReaderMetaData& dr_metadata) override {                                            \
-      data_type_layer<TensorDataType>::setup_dims(dr_metadata);                        \
-      this->set_output_dims(this->get_input_dims());                        \
-      /* Check that input dimensions match */                               \
-      if (this->get_input_dims(0) != this->get_input_dims(1)) {             \
-        const auto& parents = this->get_parent_layers();                    \
-        std::stringstream err;                                              \
-        err << this->get_type() << " layer \"" << this->get_name() << "\" " \
-            << "has input tensors with different dimensions (";             \
-        for (int i = 0; i < this->get_num_parents(); ++i) {                 \
-          const auto& dims = this->get_input_dims(i);                       \
-          err << (i > 0 ? ", " : "")                                        \
-              << "layer \"" << parents[i]->get_name() << "\" outputs ";     \
-          for (size_t j = 0; j < dims.size(); ++j) {                        \
-            err << (j > 0 ? " x " : "") << dims[j];                         \
-          }                                                                 \
-        }                                                                   \
-        err << ")";                                                         \
-        LBANN_ERROR(err.str());                                             \
-      }                                                                     \
+    void setup_dims(DataReaderMetaData& dr_metadata) override {           \
+      data_type_layer<TensorDataType>::setup_dims(dr_metadata);             \
+      this->set_output_dims(                                                \
+        get_binary_layer_output_dims(                                       \
+          *this, Layout == data_layout::DATA_PARALLEL));                    \
     }                                                                       \
     void fp_compute() override;                                             \
     void bp_compute() override;                                             \
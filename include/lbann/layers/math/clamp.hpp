@@ -64,6 +64,11 @@ public:
   data_layout get_data_layout() const override { return Layout; }
   El::Device get_device_allocation() const override { return Device; }
 
+  /** Minimum output. */
+  TensorDataType get_min() const noexcept { return m_min; }
+  /** Maximum output. */
+  TensorDataType get_max() const noexcept { return m_max; }
+
   description get_description() const override {
     auto desc = data_type_layer<TensorDataType>::get_description();
     std::stringstream ss;
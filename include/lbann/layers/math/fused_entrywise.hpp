@@ -0,0 +1,218 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_LAYERS_MATH_FUSED_ENTRYWISE_HPP_INCLUDED
+#define LBANN_LAYERS_MATH_FUSED_ENTRYWISE_HPP_INCLUDED
+
+#include "lbann/layers/data_type_layer.hpp"
+#include "lbann/utils/broadcast.hpp"
+
+namespace lbann {
+
+/** @brief Maximum number of layers in a fused entry-wise chain. */
+constexpr int max_fused_entrywise_steps = 16;
+
+/** @brief Operations supported by @c fused_entrywise_layer. */
+enum class fused_entrywise_op {
+  // Unary operations
+  abs,
+  negative,
+  square,
+  sqrt,
+  rsqrt,
+  reciprocal,
+  exp,
+  log,
+  sin,
+  cos,
+  tanh,
+  relu,
+  clamp,
+  scale_bias,
+  // Binary operations
+  add,
+  subtract,
+  multiply,
+  divide,
+  max,
+  min,
+  squared_difference
+};
+
+/** @brief One layer of a fused entry-wise chain. */
+template <typename TensorDataType>
+struct fused_entrywise_step {
+  fused_entrywise_op op;
+  /** @brief Input index of the other operand of a binary
+   *  operation. */
+  int operand = -1;
+  /** @brief Whether the other operand of a binary operation is its
+   *  first argument. */
+  bool operand_first = false;
+  /** @brief Range of a clamp operation. */
+  TensorDataType min = El::TypeTraits<TensorDataType>::Zero();
+  TensorDataType max = El::TypeTraits<TensorDataType>::Zero();
+  /** @brief Weights index of a scale/bias operation. */
+  int weights = -1;
+};
+
+/** @brief Chain of entry-wise layers applied in one pass.
+ *
+ *  Replaces a chain of entry-wise layers where each layer is the
+ *  only consumer of the previous one's output, so intermediate
+ *  tensors are never written to memory. The first input is the
+ *  input to the chain and any further inputs are the other operands
+ *  of binary operations. With a data-parallel layout, the other
+ *  operands can be smaller tensors that are broadcast to the shape of
+ *  the first input (see @c broadcast_map). Only forward prop is
+ *  supported.
+ *
+ *  Constructed by the inference layer fusion in @c model (see
+ *  --fuse_inference_layers) rather than from the prototext.
+ */
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+class fused_entrywise_layer : public data_type_layer<TensorDataType> {
+public:
+
+  using step_type = fused_entrywise_step<TensorDataType>;
+
+  /** @param steps       Operations applied in order.
+   *  @param fused_names Names of the replaced layers.
+   */
+  fused_entrywise_layer(lbann_comm *comm,
+                        std::vector<step_type> steps,
+                        std::vector<std::string> fused_names)
+    : data_type_layer<TensorDataType>(comm),
+      m_steps(std::move(steps)),
+      m_fused_names(std::move(fused_names)) {
+    if (m_steps.empty()
+        || m_steps.size() > static_cast<size_t>(max_fused_entrywise_steps)) {
+      LBANN_ERROR("fused entry-wise layer needs between 1 and ",
+                  max_fused_entrywise_steps," operations ",
+                  "(got ",m_steps.size(),")");
+    }
+    this->m_expected_num_parent_layers = -1; // No limit on parents
+  }
+
+  fused_entrywise_layer* copy() const override {
+    return new fused_entrywise_layer(*this);
+  }
+  std::string get_type() const override { return "fused entry-wise"; }
+  data_layout get_data_layout() const override { return Layout; }
+  El::Device get_device_allocation() const override { return Device; }
+
+  description get_description() const override {
+    auto desc = data_type_layer<TensorDataType>::get_description();
+    std::stringstream ss;
+    for (size_t i = 0; i < m_fused_names.size(); ++i) {
+      ss << (i > 0 ? ", " : "") << m_fused_names[i];
+    }
+    desc.add("Fused layers", ss.str());
+    return desc;
+  }
+
+protected:
+
+  void setup_dims(DataReaderMetaData& dr_metadata) override {
+    data_type_layer<TensorDataType>::setup_dims(dr_metadata);
+    this->set_output_dims(this->get_input_dims());
+    for (int i = 1; i < this->get_num_parents(); ++i) {
+      if (this->get_input_size(i) != this->get_input_size(0)
+          && (Layout != data_layout::DATA_PARALLEL
+              || !is_broadcastable(this->get_input_dims(i),
+                                   this->get_input_dims(0)))) {
+        LBANN_ERROR(get_type()," layer \"",this->get_name(),"\" ",
+                    "has input tensors with different sizes");
+      }
+    }
+  }
+
+  /** @brief Index map for reading an operand at the output shape. */
+  broadcast_map get_operand_map(int input_index) const {
+    if (this->get_input_size(input_index) == this->get_input_size(0)) {
+      return broadcast_map();
+    }
+    return make_broadcast_map(this->get_input_dims(input_index),
+                              this->get_input_dims(0));
+  }
+
+  void fp_compute() override;
+
+  void bp_compute() override {
+    LBANN_ERROR(get_type()," layer \"",this->get_name(),"\" ",
+                "only supports inference");
+  }
+
+private:
+
+  /** Operations applied in order. */
+  std::vector<step_type> m_steps;
+  /** Names of the replaced layers. */
+  std::vector<std::string> m_fused_names;
+
+};
+
+/** @brief Get the fused operation equivalent to a layer.
+ *
+ *  Recognizes the entry-wise math layers, ReLU, clamp, and
+ *  entry-wise scale/bias. Only @c op, @c min and @c max in @c step
+ *  are set.
+ *
+ *  @returns Whether @c l can be part of a fused entry-wise chain.
+ */
+template <typename TensorDataType>
+bool get_fused_entrywise_op(const Layer& l,
+                            fused_entrywise_step<TensorDataType>& step);
+
+/** @brief Whether a fused entry-wise operation has two inputs. */
+inline bool is_binary_fused_entrywise_op(fused_entrywise_op op) noexcept {
+  return op >= fused_entrywise_op::add;
+}
+
+// Like the entry-wise math layers, only float and double are
+// instantiated
+#ifndef LBANN_FUSED_ENTRYWISE_LAYER_INSTANTIATE
+
+#define PROTO_DEVICE(T, Device)                     \
+  extern template class fused_entrywise_layer<      \
+    T, data_layout::DATA_PARALLEL, Device>;         \
+  extern template class fused_entrywise_layer<      \
+    T, data_layout::MODEL_PARALLEL, Device>
+
+PROTO_DEVICE(float, El::Device::CPU);
+PROTO_DEVICE(double, El::Device::CPU);
+#ifdef LBANN_HAS_GPU
+PROTO_DEVICE(float, El::Device::GPU);
+PROTO_DEVICE(double, El::Device::GPU);
+#endif // LBANN_HAS_GPU
+#undef PROTO_DEVICE
+
+#endif // LBANN_FUSED_ENTRYWISE_LAYER_INSTANTIATE
+
+} // namespace lbann
+
+#endif // LBANN_LAYERS_MATH_FUSED_ENTRYWISE_HPP_INCLUDED
@@ -40,8 +40,6 @@ template <typename TensorDataType, data_layout Layout, El::Device Device>
 class argmax_layer : public data_type_layer<TensorDataType> {
   static_assert(Layout == data_layout::DATA_PARALLEL,
                 "argmax layer only supports data parallel layout");
-  static_assert(Device == El::Device::CPU,
-                "argmax layer only supports CPU");
 public:
 
   argmax_layer(lbann_comm* comm) : data_type_layer<TensorDataType>(comm) { }
@@ -72,13 +70,11 @@ protected:
 };
 
 #ifndef LBANN_ARGMAX_LAYER_INSTANTIATE
-#define PROTO(T) \
-  extern template class argmax_layer<T, data_layout::DATA_PARALLEL, El::Device::CPU>
+#define PROTO_DEVICE(T, Device) \
+  extern template class argmax_layer<T, data_layout::DATA_PARALLEL, Device>
 
-#define LBANN_INSTANTIATE_CPU_HALF
-#include "lbann/macros/instantiate.hpp"
-#undef PROTO
-#undef LBANN_INSTANTIATE_CPU_HALF
+#include "lbann/macros/instantiate_device.hpp"
+#undef PROTO_DEVICE
 #endif // LBANN_ARGMAX_LAYER_INSTANTIATE
 
 } // namespace lbann
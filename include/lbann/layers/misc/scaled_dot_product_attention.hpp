@@ -0,0 +1,209 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_LAYERS_MISC_SCALED_DOT_PRODUCT_ATTENTION_HPP_INCLUDED
+#define LBANN_LAYERS_MISC_SCALED_DOT_PRODUCT_ATTENTION_HPP_INCLUDED
+
+#include "lbann/layers/data_type_layer.hpp"
+
+namespace lbann {
+
+/** @brief Fused multi-head scaled dot-product attention.
+ *
+ *  Expects three 2D input tensors: queries (@f$ L_q \times E @f$),
+ *  keys (@f$ L_k \times E @f$), and values (@f$ L_k \times E_v
+ *  @f$). The embedding dimensions are split evenly into
+ *  @c num_heads heads and each head computes
+ *  @f[ \text{softmax}\left( \frac{Q K^T}{\sqrt{E/\text{num\_heads}}} \right) V @f]
+ *  The head outputs are concatenated into a @f$ L_q \times E_v @f$
+ *  output tensor. If @c causal is set, query @f$ i @f$ only attends
+ *  to keys @f$ j \leq i @f$.
+ *
+ *  The softmax is computed on tiles of keys with a running maximum
+ *  and denominator, so the @f$ L_q \times L_k @f$ score matrix is
+ *  never stored. Only the log-sum-exp of each score row is kept for
+ *  backprop, which recomputes the scores.
+ *
+ *  See:
+ *
+ *  Tri Dao, Daniel Y. Fu, Stefano Ermon, Atri Rudra, and Christopher
+ *  Re. "FlashAttention: Fast and memory-efficient exact attention
+ *  with IO-awareness." arXiv:2205.14135. 2022.
+ *
+ *  @todo The GPU implementation requires head dimensions of at most
+ *  128.
+ */
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+class scaled_dot_product_attention_layer : public data_type_layer<TensorDataType> {
+  static_assert(Layout == data_layout::DATA_PARALLEL,
+                "scaled_dot_product_attention_layer only supports "
+                "data-parallel data layout");
+
+public:
+
+  scaled_dot_product_attention_layer(lbann_comm* comm,
+                                     El::Int num_heads = 1,
+                                     bool causal = false);
+
+  scaled_dot_product_attention_layer(const scaled_dot_product_attention_layer& other) = default;
+  scaled_dot_product_attention_layer& operator=(const scaled_dot_product_attention_layer& other) = default;
+  scaled_dot_product_attention_layer* copy() const override;
+
+  std::string get_type() const override;
+  data_layout get_data_layout() const override;
+  El::Device get_device_allocation() const override;
+
+  description get_description() const override;
+
+protected:
+
+  void setup_dims(DataReaderMetaData& dr_metadata) override;
+
+  void fp_compute() override;
+  void bp_compute() override;
+
+private:
+
+  /** Number of attention heads. */
+  El::Int m_num_heads;
+  /** Whether queries attend only to preceding keys. */
+  bool m_causal;
+
+  /** @brief Log-sum-exp of attention scores.
+   *
+   *  One entry per query and head for each local mini-batch sample,
+   *  computed during forward prop and reused in backprop.
+   */
+  El::Matrix<TensorDataType, Device> m_lse;
+  /** @brief Backprop workspace.
+   *
+   *  Dot product between each output vector and its gradient.
+   */
+  El::Matrix<TensorDataType, Device> m_workspace;
+
+};
+
+// Builder function
+LBANN_DEFINE_LAYER_BUILDER(scaled_dot_product_attention);
+
+// =========================================================
+// Implementation
+// =========================================================
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+scaled_dot_product_attention_layer<TensorDataType,Layout,Device>::scaled_dot_product_attention_layer(
+  lbann_comm* comm,
+  El::Int num_heads,
+  bool causal)
+  : data_type_layer<TensorDataType>(comm),
+    m_num_heads{num_heads},
+    m_causal{causal} {
+  this->m_expected_num_parent_layers = 3;
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+scaled_dot_product_attention_layer<TensorDataType,Layout,Device>* scaled_dot_product_attention_layer<TensorDataType,Layout,Device>::copy() const {
+  return new scaled_dot_product_attention_layer(*this);
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+std::string scaled_dot_product_attention_layer<TensorDataType,Layout,Device>::get_type() const {
+  return "scaled dot-product attention";
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+data_layout scaled_dot_product_attention_layer<TensorDataType,Layout,Device>::get_data_layout() const {
+  return Layout;
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+El::Device scaled_dot_product_attention_layer<TensorDataType,Layout,Device>::get_device_allocation() const {
+  return Device;
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+description scaled_dot_product_attention_layer<TensorDataType,Layout,Device>::get_description() const {
+  auto desc = data_type_layer<TensorDataType>::get_description();
+  desc.add("Heads", m_num_heads);
+  desc.add("Causal", m_causal);
+  return desc;
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void scaled_dot_product_attention_layer<TensorDataType,Layout,Device>::setup_dims(DataReaderMetaData& dr_metadata) {
+  data_type_layer<TensorDataType>::setup_dims(dr_metadata);
+
+  // Check input dimensions
+  const auto& query_dims = this->get_input_dims(0);
+  const auto& key_dims = this->get_input_dims(1);
+  const auto& value_dims = this->get_input_dims(2);
+  if (query_dims.size() != 2 || key_dims.size() != 2 || value_dims.size() != 2) {
+    LBANN_ERROR(this->get_type()," layer \"",this->get_name(),"\" ",
+                "expects 2D input tensors, but got ",
+                query_dims.size(),"-D queries, ",
+                key_dims.size(),"-D keys, and ",
+                value_dims.size(),"-D values");
+  }
+  if (query_dims[1] != key_dims[1]) {
+    LBANN_ERROR(this->get_type()," layer \"",this->get_name(),"\" ",
+                "has queries and keys with different embedding sizes ",
+                "(",query_dims[1]," and ",key_dims[1],")");
+  }
+  if (key_dims[0] != value_dims[0]) {
+    LBANN_ERROR(this->get_type()," layer \"",this->get_name(),"\" ",
+                "has key and value sequences with different lengths ",
+                "(",key_dims[0]," and ",value_dims[0],")");
+  }
+  if (m_num_heads < 1
+      || query_dims[1] % m_num_heads != 0
+      || value_dims[1] % m_num_heads != 0) {
+    LBANN_ERROR(this->get_type()," layer \"",this->get_name(),"\" ",
+                "has ",m_num_heads," heads, which does not evenly divide ",
+                "the query embedding size (",query_dims[1],") ",
+                "and value embedding size (",value_dims[1],")");
+  }
+
+  // Output is a sequence of values for each query
+  this->set_output_dims({query_dims[0], value_dims[1]});
+
+}
+
+// =========================================================
+// Explicit template instantiation
+// =========================================================
+
+#ifndef LBANN_SCALED_DOT_PRODUCT_ATTENTION_LAYER_INSTANTIATE
+#define PROTO_DEVICE(T, Device)                                 \
+  extern template class scaled_dot_product_attention_layer<     \
+    T, data_layout::DATA_PARALLEL, Device>;
+#include "lbann/macros/instantiate_device.hpp"
+#undef PROTO_DEVICE
+#endif // LBANN_SCALED_DOT_PRODUCT_ATTENTION_LAYER_INSTANTIATE
+
+} // namespace lbann
+
+#endif // LBANN_LAYERS_MISC_SCALED_DOT_PRODUCT_ATTENTION_HPP_INCLUDED
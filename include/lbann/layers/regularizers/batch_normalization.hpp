@@ -29,6 +29,7 @@
 
 #include "lbann/layers/regularizers/regularizer.hpp"
 #include "lbann/models/model.hpp"
+#include "lbann/utils/determinism.hpp"
 #include "lbann/utils/distconv.hpp"
 
 namespace lbann {
@@ -163,10 +164,10 @@ public:
       m_decay(decay),
       m_epsilon(epsilon),
       m_statistics_group_size(statistics_group_size) {
-#ifdef LBANN_DETERMINISTIC
-    // Force global computation.
-    m_statistics_group_size = 0;
-#endif
+    if (deterministic_mode()) {
+      // Force global computation.
+      m_statistics_group_size = 0;
+    }
   }
 
   batch_normalization_layer(const batch_normalization_layer& other)
@@ -222,6 +223,8 @@ public:
   std::string get_type() const override { return "batch normalization"; }
   data_layout get_data_layout() const override { return T_layout; }
   El::Device get_device_allocation() const override { return Dev; }
+  bool can_recompute_activations() const override { return false; }
+  bool uses_outputs_in_backprop() const override { return false; }
 
   description get_description() const override {
     auto desc = regularizer_layer<TensorDataType>::get_description();
@@ -231,6 +234,9 @@ public:
     return desc;
   }
 
+  /** Small number added to the variance to avoid division by zero. */
+  TensorDataType get_epsilon() const noexcept { return m_epsilon; }
+
 protected:
 
   void setup_matrices(const El::Grid& grid) override {
@@ -30,6 +30,7 @@
 #include "lbann/layers/regularizers/regularizer.hpp"
 #include "lbann/models/model.hpp"
 #include "lbann/utils/cudnn.hpp"
+#include "lbann/utils/determinism.hpp"
 #include "lbann/utils/random.hpp"
 
 namespace lbann {
@@ -44,6 +45,11 @@ namespace lbann {
  *  Sutskever, and Ruslan Salakhutdinov. "Dropout: a simple way to
  *  prevent neural networks from overfitting." The Journal of Machine
  *  Learning Research 15, no. 1 (2014): 1929-1958.
+ *
+ *  If @c regenerate_mask is set, the mask is not stored. It is
+ *  regenerated in backprop from a counter-based (Philox) RNG seeded
+ *  once per step, so it costs no memory and is independent of the
+ *  process grid. It is always set in deterministic mode.
  */
 template <typename TensorDataType, data_layout T_layout, El::Device Dev>
 class dropout : public regularizer_layer<TensorDataType> {
@@ -59,26 +65,22 @@ public:
 public:
   /** Keep units with probabiliy keep_prob. */
   dropout(lbann_comm *comm,
-          EvalType keep_prob = EvalType(0.5))
+          EvalType keep_prob = EvalType(0.5),
+          bool regenerate_mask = false)
     : regularizer_layer<TensorDataType>(comm),
-      m_keep_prob(keep_prob)
+      m_keep_prob(keep_prob),
+      m_regenerate_mask(regenerate_mask)
 #ifdef LBANN_HAS_CUDNN
     , m_dropout_cudnn_desc(nullptr),
       m_tensors_cudnn_desc(this)
 #endif // LBANN_HAS_CUDNN
-  {
-#if defined(LBANN_HAS_CUDNN) && defined(LBANN_DETERMINISTIC)
-    /// @todo GPU implementation of dropout with sequential consistency
-    if (Dev == El::Device::GPU && this->get_comm()->am_trainer_master()) {
-      std::cerr << "Warning: GPU dropout currently does not guarantee "
-                << "sequential consistency" << std::endl;
-    }
-#endif // defined(LBANN_HAS_CUDNN) && defined(LBANN_DETERMINISTIC)
-  }
+  {}
 
   dropout(const dropout& other)
     : regularizer_layer<TensorDataType>(other),
       m_keep_prob(other.m_keep_prob),
+      m_regenerate_mask(other.m_regenerate_mask),
+      m_mask_seed(other.m_mask_seed),
       m_mask(other.m_mask ? other.m_mask->Copy() : nullptr)
 #ifdef LBANN_HAS_CUDNN
     , m_dropout_cudnn_desc(nullptr),
@@ -98,6 +100,8 @@ public:
   dropout& operator=(const dropout& other) {
     regularizer_layer<TensorDataType>::operator=(other);
     m_keep_prob = other.m_keep_prob;
+    m_regenerate_mask = other.m_regenerate_mask;
+    m_mask_seed = other.m_mask_seed;
     m_mask = other.m_mask ? std::unique_ptr<AbsDistMatrixType>(other.m_mask->Copy()) : nullptr;
 #ifdef LBANN_HAS_CUDNN
     m_tensors_cudnn_desc = other.m_tensors_cudnn_desc;
@@ -126,10 +130,12 @@ public:
   std::string get_type() const override { return "dropout"; }
   data_layout get_data_layout() const override { return T_layout; }
   El::Device get_device_allocation() const override { return Dev; }
+  bool can_recompute_activations() const override { return false; }
 
   description get_description() const override {
     auto desc = regularizer_layer<TensorDataType>::get_description();
     desc.add("Keep probability", m_keep_prob);
+    desc.add("Regenerate mask", m_regenerate_mask);
     return desc;
   }
   /** @brief get prob for keep each unit. */
@@ -150,11 +156,19 @@ protected:
 
   void setup_matrices(const El::Grid& grid) override {
     regularizer_layer<TensorDataType>::setup_matrices(grid);
-    m_mask = std::unique_ptr<AbsDistMatrixType>(this->get_activations().Copy());
+    // cuDNN dropout and per-process generators depend on the process
+    // grid and thread timing, so use the counter-based mask
+    if (deterministic_mode()) {
+      m_regenerate_mask = true;
+    }
+    if (!m_regenerate_mask) {
+      m_mask = std::unique_ptr<AbsDistMatrixType>(this->get_activations().Copy());
+    }
   }
 
   void setup_gpu() override {
     regularizer_layer<TensorDataType>::setup_gpu();
+    if (m_regenerate_mask) { return; }
 #ifndef LBANN_HAS_CUDNN
     LBANN_ERROR("cuDNN not detected");
 #else
@@ -166,7 +180,9 @@ protected:
   }
 
   void fp_compute () override {
-    if (this->using_gpus()) {
+    if (m_regenerate_mask) {
+      fp_compute_regenerated();
+    } else if (this->using_gpus()) {
       fp_compute_gpu();
     } else {
       fp_compute_cpu();
@@ -174,7 +190,9 @@ protected:
   }
 
   void bp_compute () override {
-    if (this->using_gpus()) {
+    if (m_regenerate_mask) {
+      bp_compute_regenerated();
+    } else if (this->using_gpus()) {
       bp_compute_gpu();
     } else {
       bp_compute_cpu();
@@ -183,6 +201,38 @@ protected:
 
  private:
 
+  /** Drop out units with a freshly seeded counter-based mask. */
+  void fp_compute_regenerated() {
+    const auto& input = this->get_prev_activations();
+    auto& output = this->get_activations();
+    const auto& mode = this->m_model->get_execution_context().get_execution_mode();
+    if (mode != execution_mode::training || m_keep_prob < EvalType(0)) {
+      El::Copy(input, output);
+      return;
+    }
+    const auto zero = El::TypeTraits<TensorDataType>::Zero();
+    const auto scale = El::To<TensorDataType>(1 / m_keep_prob);
+    m_mask_seed = get_philox_seed();
+    philox_mask_apply<TensorDataType, Dev>(input, output, m_keep_prob, m_mask_seed,
+                                           scale, zero, zero);
+  }
+
+  /** Regenerate the forward prop mask and apply it to gradients. */
+  void bp_compute_regenerated() {
+    const auto& gradient_wrt_output = this->get_prev_error_signals();
+    auto& gradient_wrt_input = this->get_error_signals();
+    const auto& mode = this->m_model->get_execution_context().get_execution_mode();
+    if (mode != execution_mode::training || m_keep_prob < EvalType(0)) {
+      El::Copy(gradient_wrt_output, gradient_wrt_input);
+      return;
+    }
+    const auto zero = El::TypeTraits<TensorDataType>::Zero();
+    const auto scale = El::To<TensorDataType>(1 / m_keep_prob);
+    philox_mask_apply<TensorDataType, Dev>(gradient_wrt_output, gradient_wrt_input,
+                                           m_keep_prob, m_mask_seed,
+                                           scale, zero, zero);
+  }
+
   void fp_compute_cpu() {
 
     // Matrices
@@ -201,10 +251,6 @@ protected:
     const auto& height = input.Height();
     const auto& width = input.Width();
     m_mask->Resize(height, width);
-#ifdef LBANN_DETERMINISTIC
-    bernoulli_fill_procdet(*m_mask, height, width, TensorDataType(m_keep_prob));
-    El::Scale(scale, *m_mask);
-#else
     El::EntrywiseMap(*m_mask,
                      (std::function<TensorDataType(const TensorDataType&)>)
                      ([this,scale](const TensorDataType& z)->TensorDataType {
@@ -212,7 +258,6 @@ protected:
                        std::bernoulli_distribution dist(m_keep_prob);
                        return dist(gen) ? scale : El::TypeTraits<TensorDataType>::Zero();
                      }));
-#endif // LBANN_DETERMINISTIC
 
     // Apply mask matrix to get activations
     El::Hadamard(input, *m_mask, output);
@@ -331,6 +376,10 @@ protected:
 
   /** Probability of keeping each unit. */
   EvalType m_keep_prob;
+  /** Whether the mask is regenerated in backprop instead of stored. */
+  bool m_regenerate_mask;
+  /** Seed of the current regenerated mask. */
+  uint64_t m_mask_seed = 0;
   /** Current dropout mask (a scaled Bernoulli random matrix). */
   std::unique_ptr<AbsDistMatrixType> m_mask;
 
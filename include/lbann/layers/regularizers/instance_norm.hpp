@@ -28,6 +28,7 @@
 #define LBANN_LAYERS_REGULARIZERS_INSTANCE_NORM_HPP_INCLUDED
 
 #include "lbann/layers/data_type_layer.hpp"
+#include "lbann/utils/row_normalization.hpp"
 
 namespace lbann {
 
@@ -79,9 +80,19 @@ private:
   /** Small number to avoid division by zero. */
   TensorDataType m_epsilon;
 
-  /** Contains per-channel sums and sums of squares. */
+  /** Contains per-channel sums and sums of squares.
+   *
+   *  With the fused GPU kernels, it instead contains per-channel
+   *  means (first row) and variances (second row).
+   */
   El::Matrix<TensorDataType,Device> m_workspace;
 
+  /** @brief GPU kernel variant.
+   *
+   *  Chosen in setup by the channel size.
+   */
+  row_normalization_kernel m_kernel = row_normalization_kernel::grid;
+
 };
 
 // Builder function
@@ -129,6 +140,11 @@ template <typename TensorDataType, data_layout Layout, El::Device Device>
 void instance_norm_layer<TensorDataType,Layout,Device>::setup_dims(DataReaderMetaData& dr_metadata) {
   data_type_layer<TensorDataType>::setup_dims(dr_metadata);
   this->set_output_dims(this->get_input_dims());
+  const auto& dims = this->get_output_dims();
+  const El::Int channel_size = this->get_output_size() / dims.front();
+  m_kernel = (channel_size > 1
+              ? choose_row_normalization_kernel(channel_size)
+              : row_normalization_kernel::grid);
 }
 
 // =========================================================
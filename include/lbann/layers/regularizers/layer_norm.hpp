@@ -28,6 +28,7 @@
 #define LBANN_LAYERS_REGULARIZERS_LAYER_NORM_HPP_INCLUDED
 
 #include "lbann/layers/data_type_layer.hpp"
+#include "lbann/utils/row_normalization.hpp"
 
 #include <memory>
 
@@ -102,6 +103,12 @@ private:
    */
   std::unique_ptr<AbsDistMatType> m_statistics_gradient;
 
+  /** @brief GPU kernel variant.
+   *
+   *  Chosen in setup by the sample size.
+   */
+  row_normalization_kernel m_kernel = row_normalization_kernel::grid;
+
 };
 
 // =========================================================
@@ -125,7 +132,8 @@ layer_norm_layer<TensorDataType,Layout,Device>::layer_norm_layer(
                  : nullptr),
     m_statistics_gradient(other.m_statistics_gradient
                           ? other.m_statistics_gradient->Copy()
-                          : nullptr)
+                          : nullptr),
+    m_kernel(other.m_kernel)
 {}
 
 template <typename TensorDataType, data_layout Layout, El::Device Device>
@@ -139,6 +147,7 @@ layer_norm_layer<TensorDataType,Layout,Device>& layer_norm_layer<TensorDataType,
   m_statistics_gradient.reset(other.m_statistics_gradient
                               ? other.m_statistics_gradient->Copy()
                               : nullptr);
+  m_kernel = other.m_kernel;
   return *this;
 }
 
@@ -182,6 +191,15 @@ void layer_norm_layer<TensorDataType,Layout,Device>::setup_matrices(const El::Gr
   dist.colDist = El::STAR;
   m_statistics.reset(AbsDistMatrixType::Instantiate(dist));
   m_statistics_gradient.reset(AbsDistMatrixType::Instantiate(dist));
+
+  // Samples split between processes need grid-wide reductions
+  const auto& sample_size = this->get_input_size();
+  if (this->get_prev_activations().ColStride() == 1 && sample_size > 1) {
+    m_kernel = choose_row_normalization_kernel(sample_size);
+  }
+  else {
+    m_kernel = row_normalization_kernel::grid;
+  }
 }
 
 template <typename TensorDataType, data_layout Layout, El::Device Device>
@@ -29,6 +29,8 @@
 
 #include "lbann/layers/regularizers/regularizer.hpp"
 #include "lbann/models/model.hpp"
+#include "lbann/utils/determinism.hpp"
+#include "lbann/utils/random.hpp"
 
 namespace lbann {
 
@@ -39,6 +41,10 @@ namespace lbann {
  *  Gunter Klambauer, Thomas Unterthiner, Andreas Mayr, and Sepp
  *  Hochreiter. "Self-normalizing neural networks." In Advances in
  *  Neural Information Processing Systems, pp. 971-980. 2017.
+ *
+ *  If @c regenerate_mask is set, the mask is regenerated in backprop
+ *  from a counter-based (Philox) RNG instead of being stored (see
+ *  @c dropout).
  */
 template <typename TensorDataType, data_layout T_layout, El::Device Dev>
 class selu_dropout : public regularizer_layer<TensorDataType> {
@@ -63,9 +69,6 @@ public:
     regularizer_layer<TensorDataType>(comm),
     m_keep_prob(keep_prob),
     m_mask(nullptr) {
-#ifdef LBANN_DETERMINISTIC
-    throw lbann_exception("selu_dropout: deterministic dropout not supported");
-#endif
     // Compute alpha' and the affine transform.
     m_alpha_prime = -scale*alpha;
     m_a = keep_prob +
@@ -80,6 +83,8 @@ public:
     m_a(other.m_a),
     m_b(other.m_b),
     m_keep_prob(other.m_keep_prob),
+    m_regenerate_mask(other.m_regenerate_mask),
+    m_mask_seed(other.m_mask_seed),
     m_mask(other.m_mask) {
     if (m_mask != nullptr) { m_mask = m_mask->Copy(); }
   }
@@ -90,6 +95,8 @@ public:
     m_a = other.m_a;
     m_b = other.m_b;
     m_keep_prob = other.m_keep_prob;
+    m_regenerate_mask = other.m_regenerate_mask;
+    m_mask_seed = other.m_mask_seed;
     if (m_mask != nullptr) { delete m_mask; }
     m_mask = other.m_mask;
     if (m_mask != nullptr) { m_mask = m_mask->Copy(); }
@@ -103,10 +110,22 @@ public:
   selu_dropout* copy() const override { return new selu_dropout(*this); }
 
   std::string get_type() const override { return "selu dropout"; }
+  /** The mask seed is generated on the host. */
+  bool supports_cuda_graph() const override { return false; }
 
   data_layout get_data_layout() const override { return T_layout; }
 
   El::Device get_device_allocation() const override { return Dev; }
+  bool can_recompute_activations() const override { return false; }
+
+  /** @brief Whether the mask is regenerated in backprop. */
+  bool get_regenerate_mask() const noexcept { return m_regenerate_mask; }
+  /** @brief Regenerate the mask in backprop instead of storing it.
+   *  @details Must be called before setup.
+   */
+  void set_regenerate_mask(bool regenerate_mask) {
+    m_regenerate_mask = regenerate_mask;
+  }
 
   void setup_dims(DataReaderMetaData& dr_metadata) override {
     regularizer_layer<TensorDataType>::setup_dims(dr_metadata);
@@ -116,7 +135,15 @@ public:
   void setup_matrices(const El::Grid& grid) override {
     regularizer_layer<TensorDataType>::setup_matrices(grid);
     if (m_mask != nullptr) { delete m_mask; }
-    m_mask = this->get_activations().Copy();
+    m_mask = nullptr;
+    // Per-process generators depend on the process grid and thread
+    // timing, so use the counter-based mask
+    if (deterministic_mode()) {
+      m_regenerate_mask = true;
+    }
+    if (!m_regenerate_mask) {
+      m_mask = this->get_activations().Copy();
+    }
   }
 
  protected:
@@ -126,6 +153,12 @@ public:
         m_keep_prob < 0.0f) {
       // Do nothing if dropout is disabled
       El::Copy(this->get_prev_activations(), this->get_activations());
+    } else if (m_regenerate_mask) {
+      m_mask_seed = get_philox_seed();
+      philox_mask_apply<TensorDataType, Dev>(this->get_prev_activations(),
+                                             this->get_activations(),
+                                             static_cast<double>(m_keep_prob), m_mask_seed,
+                                             m_a, m_b, m_a * m_alpha_prime + m_b);
     } else {
 
       const auto *input_acts = &this->get_prev_activations();
@@ -140,7 +173,7 @@ public:
 
       // Construct and apply mask and the affine transform.
       // TODO: Optimize.
-      El::Bernoulli(*m_mask, height, width, m_keep_prob);
+      bernoulli_fill(*m_mask, height, width, static_cast<double>(m_keep_prob));
       for (El::Int col = 0; col < local_width; ++col) {
         for (El::Int row = 0; row < local_height; ++row) {
           local_output_acts(row, col) = m_a *
@@ -157,6 +190,12 @@ public:
     if (this->m_model->get_execution_context().get_execution_mode() != execution_mode::training
         || m_keep_prob < 0.0f) {
       El::Copy(this->get_prev_error_signals(), this->get_error_signals());
+    } else if (m_regenerate_mask) {
+      const auto zero = El::TypeTraits<TensorDataType>::Zero();
+      philox_mask_apply<TensorDataType, Dev>(this->get_prev_error_signals(),
+                                             this->get_error_signals(),
+                                             static_cast<double>(m_keep_prob), m_mask_seed,
+                                             m_a, zero, zero);
     } else {
 
       const auto& local_prev_error_signal = this->get_local_prev_error_signals();
@@ -184,6 +223,10 @@ public:
   TensorDataType m_b;
   /** Probability of keeping each unit. */
   TensorDataType m_keep_prob;
+  /** Whether the mask is regenerated in backprop instead of stored. */
+  bool m_regenerate_mask = false;
+  /** Seed of the current regenerated mask. */
+  uint64_t m_mask_seed = 0;
   /** Current dropout mask (a scaled Bernoulli random matrix). */
   AbsDistMatrixType *m_mask;
 };
@@ -57,6 +57,9 @@ public:
   std::string get_type() const override { return "Bernoulli"; }
   data_layout get_data_layout() const override { return T_layout; }
   El::Device get_device_allocation() const override { return Dev; }
+  /** Random numbers are generated on the host. */
+  bool supports_cuda_graph() const override { return false; }
+  bool can_recompute_activations() const override { return false; }
 
   description get_description() const override {
     auto desc = transform_layer<TensorDataType>::get_description();
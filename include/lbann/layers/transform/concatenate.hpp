@@ -69,6 +69,27 @@ public:
 
   description get_description() const override;
 
+  /** @brief Read a window of an input tensor instead of all of it.
+   *
+   *  The window has dimensions @c dims and is placed the way the crop
+   *  layer places a crop, with the same normalized @c position in
+   *  every dimension. The error signal is zero outside the window.
+   *  This lets the layer absorb a crop layer (see
+   *  model::fuse_crop_concatenate_layers) without materializing the
+   *  cropped tensor. Only supported for data-parallel layouts with
+   *  more than one input.
+   */
+  void set_input_crop(size_t input_index,
+                      std::vector<int> dims,
+                      double position);
+  /** @brief Whether any input is read through a crop window. */
+  bool has_input_crops() const noexcept;
+  /** @brief Dimensions of an input tensor as it is concatenated.
+   *  @details The crop window if the input is cropped. */
+  std::vector<int> get_concat_input_dims(size_t input_index) const;
+  /** @brief Offset of an input's crop window within a sample. */
+  size_t get_input_crop_offset(size_t input_index) const;
+
 protected:
 
   void setup_pointers() override;
@@ -83,6 +104,26 @@ private:
 
   /** @brief Tensor dimension to concatenate along. */
   size_t m_concat_dim;
+  /** @brief Whether input gradients are views into the output
+   *  gradient.
+   *
+   *  This is possible for data-parallel layouts when all dimensions
+   *  before the concatenation dimension are trivial, so each input
+   *  corresponds to a contiguous block of rows in the output matrix.
+   */
+  bool m_view_gradients = false;
+
+  /** @brief Window read from an input tensor. */
+  struct input_crop {
+    /** Window dimensions (empty if the input is not cropped). */
+    std::vector<int> dims;
+    /** Normalized position in [0,1]. */
+    double position = 0.0;
+    /** Window offset in each dimension, computed at setup. */
+    std::vector<int> offsets;
+  };
+  /** @brief Crop windows of the input tensors, by parent index. */
+  std::vector<input_crop> m_input_crops;
 
 #ifdef LBANN_HAS_GPU
   /** @brief Workspace buffer.
@@ -112,7 +153,7 @@ private:
   bool is_distconv_supported() const override {
     // Only supported for the channel dimension
     return Device == El::Device::GPU && Layout == data_layout::DATA_PARALLEL
-        && m_concat_dim == 0;
+        && m_concat_dim == 0 && !has_input_crops();
   }
   void setup_distconv_adapter() override {
     this->get_distconv_adapter_ptr() = make_unique<
@@ -160,9 +201,65 @@ template <typename TensorDataType, data_layout Layout, El::Device Device>
 description concatenate_layer<TensorDataType,Layout,Device>::get_description() const {
   auto desc = data_type_layer<TensorDataType>::get_description();
   desc.add("Concatenation dimension", m_concat_dim);
+  for (size_t j=0; j<m_input_crops.size(); ++j) {
+    const auto& crop = m_input_crops[j];
+    if (crop.dims.empty()) { continue; }
+    std::ostringstream ss;
+    for (size_t d=0; d<crop.dims.size(); ++d) {
+      ss << (d>0 ? "x" : "") << crop.dims[d];
+    }
+    ss << " at " << crop.position;
+    desc.add("Input " + std::to_string(j) + " crop", ss.str());
+  }
   return desc;
 }
 
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void concatenate_layer<TensorDataType,Layout,Device>::set_input_crop(
+  size_t input_index,
+  std::vector<int> dims,
+  double position) {
+  if (m_input_crops.size() <= input_index) {
+    m_input_crops.resize(input_index + 1);
+  }
+  auto& crop = m_input_crops[input_index];
+  crop.dims = std::move(dims);
+  crop.position = position;
+  crop.offsets.clear();
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+bool concatenate_layer<TensorDataType,Layout,Device>::has_input_crops() const noexcept {
+  return std::any_of(m_input_crops.begin(), m_input_crops.end(),
+                     [](const input_crop& c) { return !c.dims.empty(); });
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+std::vector<int> concatenate_layer<TensorDataType,Layout,Device>::get_concat_input_dims(
+  size_t input_index) const {
+  if (input_index < m_input_crops.size()
+      && !m_input_crops[input_index].dims.empty()) {
+    return m_input_crops[input_index].dims;
+  }
+  return this->get_input_dims(input_index);
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+size_t concatenate_layer<TensorDataType,Layout,Device>::get_input_crop_offset(
+  size_t input_index) const {
+  if (input_index >= m_input_crops.size()
+      || m_input_crops[input_index].offsets.empty()) {
+    return 0;
+  }
+  const auto& input_dims = this->get_input_dims(input_index);
+  const auto& offsets = m_input_crops[input_index].offsets;
+  size_t offset = 0;
+  for (size_t d = 0; d < input_dims.size(); ++d) {
+    offset = offset * input_dims[d] + offsets[d];
+  }
+  return offset;
+}
+
 template <typename TensorDataType, data_layout Layout, El::Device Device>
 void concatenate_layer<TensorDataType,Layout,Device>::setup_pointers() {
   data_type_layer<TensorDataType>::setup_pointers();
@@ -176,8 +273,42 @@ template <typename TensorDataType, data_layout Layout, El::Device Device>
 void concatenate_layer<TensorDataType,Layout,Device>::setup_dims(DataReaderMetaData& dr_metadata) {
   data_type_layer<TensorDataType>::setup_dims(dr_metadata);
 
+  // Place crop windows
+  m_input_crops.resize(this->get_num_parents());
+  for (size_t j=0; j<m_input_crops.size(); ++j) {
+    auto& crop = m_input_crops[j];
+    if (crop.dims.empty()) { continue; }
+    const auto& input_dims = this->get_input_dims(j);
+    if (Layout != data_layout::DATA_PARALLEL || this->get_num_parents() < 2) {
+      LBANN_ERROR(get_type()," layer \"",this->get_name(),"\" ",
+                  "can only crop inputs with a data-parallel layout ",
+                  "and more than one input");
+    }
+    if (crop.position < 0.0 || crop.position > 1.0) {
+      LBANN_ERROR(get_type()," layer \"",this->get_name(),"\" ",
+                  "has a crop position (",crop.position,") ",
+                  "that is not in range [0,1]");
+    }
+    bool valid = crop.dims.size() == input_dims.size();
+    for (size_t d=0; valid && d<input_dims.size(); ++d) {
+      valid = crop.dims[d] > 0 && crop.dims[d] <= input_dims[d];
+    }
+    if (!valid) {
+      LBANN_ERROR(get_type()," layer \"",this->get_name(),"\" ",
+                  "can not crop input ",j," ",
+                  "(parent layer \"",this->get_parent_layers()[j]->get_name(),"\") ",
+                  "to a window that does not fit in it");
+    }
+    crop.offsets.resize(input_dims.size());
+    for (size_t d=0; d<input_dims.size(); ++d) {
+      const int num_offsets = input_dims[d] - crop.dims[d] + 1;
+      crop.offsets[d] = std::min(static_cast<int>(crop.position * num_offsets),
+                                 num_offsets - 1);
+    }
+  }
+
   // Dimensions of first input tensor
-  auto output_dims = this->get_input_dims(0);
+  auto output_dims = get_concat_input_dims(0);
   if (m_concat_dim >= output_dims.size()) {
     std::ostringstream err;
     err << get_type() << " layer \"" << this->get_name() << "\" "
@@ -194,7 +325,7 @@ void concatenate_layer<TensorDataType,Layout,Device>::setup_dims(DataReaderMetaD
 
   // Dimensions of remaining input tensors
   for (int j=1; j<this->get_num_parents(); ++j) {
-    const auto& input_dims = this->get_input_dims(j);
+    const auto input_dims = get_concat_input_dims(j);
     if (input_dims.size() != output_dims.size()
         || !std::equal(input_dims.begin(),
                        input_dims.begin() + m_concat_dim,
@@ -233,6 +364,14 @@ void concatenate_layer<TensorDataType,Layout,Device>::setup_dims(DataReaderMetaD
   // Update output dimensions
   this->set_output_dims(output_dims);
 
+  // Input gradients can be views if concatenating along the leading
+  // dimension and no input is cropped
+  m_view_gradients = (Layout == data_layout::DATA_PARALLEL
+                      && !has_input_crops()
+                      && std::all_of(output_dims.begin(),
+                                     output_dims.begin() + m_concat_dim,
+                                     [](int d) { return d == 1; }));
+
 }
 
 template <typename TensorDataType, data_layout Layout, El::Device Device>
@@ -308,6 +447,22 @@ void bp_setup_gradient_wrt_inputs_impl(
 #endif
     El::LockedView(l.get_error_signals(0), output_grad);
   }
+  else if (l.m_view_gradients) {
+    // View blocks of rows if concatenating along the leading dimension
+    size_t offset = 0;
+    for (size_t j=0; j<num_inputs; ++j) {
+      const auto& input_size = l.get_input_size(j);
+#ifdef LBANN_HAS_DISTCONV
+      if (!l.keep_original_gradient_wrt_inputs(j)) {
+        offset += input_size;
+        continue;
+      }
+#endif
+      El::LockedView(l.get_error_signals(j), output_grad,
+                     El::IR(offset, offset+input_size), El::ALL);
+      offset += input_size;
+    }
+  }
   else {
     for (size_t j=0; j<num_inputs; ++j) {
 #ifdef LBANN_HAS_DISTCONV
@@ -341,6 +496,19 @@ void concatenate_layer<TensorDataType,Layout,Device>::bp_compute() {
     return;
   }
 
+  // Tensor views have already been setup in
+  // bp_setup_gradient_wrt_inputs
+  if (m_view_gradients) {
+    return;
+  }
+
+  // Error signals are zero outside crop windows
+  for (size_t j=0; j<m_input_crops.size(); ++j) {
+    if (!m_input_crops[j].dims.empty()) {
+      El::Zero(this->get_error_signals(j));
+    }
+  }
+
   // Perform slice
   bp_compute_impl(*this, m_concat_dim);
 
@@ -51,6 +51,9 @@ public:
   data_layout get_data_layout() const override { return T_layout; }
   El::Device get_device_allocation() const override { return Dev; }
 
+  /** Value of every output entry. */
+  TensorDataType get_value() const noexcept { return m_value; }
+
   description get_description() const override {
     auto desc = transform_layer<TensorDataType>::get_description();
     desc.add("Value", m_value);
@@ -65,6 +65,9 @@ class discrete_random_layer : public transform_layer<TensorDataType> {
   std::string get_type() const override { return "discrete random"; }
   data_layout get_data_layout() const override { return T_layout; }
   El::Device get_device_allocation() const override { return Dev; }
+  /** Random numbers are generated on the host. */
+  bool supports_cuda_graph() const override { return false; }
+  bool can_recompute_activations() const override { return false; }
 
  protected:
 
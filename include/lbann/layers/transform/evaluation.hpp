@@ -28,12 +28,60 @@
 #define LBANN_LAYER_EVALUATION_HPP_INCLUDED
 
 #include "lbann/layers/transform/transform.hpp"
+#include "lbann/utils/pinned_memory.hpp"
+
+#include <map>
 
 namespace lbann {
 
+/** @brief Partially reduced value of an evaluation layer
+ *
+ *  Forward prop only computes each process' contribution to the
+ *  value. The model then reduces the pending values of all its
+ *  evaluation layers together with a single collective (see @c
+ *  model::reduce_evaluation_values), instead of one tiny allreduce
+ *  per metric and objective function term.
+ */
+class evaluation_partial_value {
+public:
+  virtual ~evaluation_partial_value() = default;
+
+  /** Whether the local contribution still needs to be reduced. */
+  bool is_partial() const noexcept { return m_partial; }
+  /** Mark the value as not yet reduced, e.g. after forward prop.
+   *  Does nothing if the value is only accumulated across steps.
+   */
+  void mark_partial() noexcept { m_partial = !m_accumulate_only; }
+
+  /** Whether the local contribution is copied asynchronously from
+   *  GPU memory. */
+  virtual bool has_async_local_value() const = 0;
+  /** This process' contribution, waiting for it if needed. */
+  virtual EvalType get_local_value() = 0;
+  /** Communicator the contributions are summed over. */
+  virtual const El::mpi::Comm& get_reduction_comm() const = 0;
+  /** Store the value summed over the reduction communicator. */
+  void set_reduced_value(EvalType value) {
+    m_reduced_value = value;
+    m_partial = false;
+  }
+
+protected:
+  /** Value summed over the reduction communicator. */
+  EvalType m_reduced_value = 0;
+  /** Whether the value is only read after being accumulated across
+   *  steps, so it is not reduced every step. */
+  bool m_accumulate_only = false;
+
+private:
+  /** Whether the local contribution still needs to be reduced. */
+  bool m_partial = false;
+};
+
 /** @brief Interface with objective function and metrics. */
 template <typename TensorDataType>
-class abstract_evaluation_layer : public transform_layer<TensorDataType> {
+class abstract_evaluation_layer : public transform_layer<TensorDataType>,
+                                  public evaluation_partial_value {
 public:
   using CPUMatType = El::Matrix<TensorDataType, El::Device::CPU>;
 
@@ -43,9 +91,37 @@ public:
   EvalType get_scale() const { return m_scale; }
   /** Set scaling factor. */
   void set_scale(EvalType scale) { m_scale = scale; }
-  /** Get evaluated value. */
+  /** Get evaluated value.
+   *  Reduces the pending values of the model's evaluation layers if
+   *  needed.
+   */
   EvalType get_value(bool scaled = true);
 
+  /** @brief Accumulate values across steps.
+   *
+   *  For readers that only need the sum over several steps (see @c
+   *  take_accumulated_value). GPU layers accumulate on the device, so
+   *  they do not copy the value to the host every step unless it is
+   *  also read every step.
+   *
+   *  @returns Whether accumulation is supported. 16-bit types would
+   *  overflow, so they are not.
+   */
+  bool enable_accumulation();
+  /** @brief Mark that the value is read every step, e.g. by an
+   *  objective function term. */
+  void set_value_read_every_step();
+  /** @brief Sum of values times mini-batch sizes since the last call
+   *
+   *  Collective over the reduction communicator. Only for layers
+   *  with @c enable_accumulation.
+   */
+  EvalType take_accumulated_value(execution_mode mode);
+
+  bool has_async_local_value() const override;
+  EvalType get_local_value() override;
+  const El::mpi::Comm& get_reduction_comm() const override;
+
   /** Construct an evaluation layer.
    *  The caller is responsible for deallocating the layer.
    */
@@ -64,13 +140,21 @@ private:
 
   /** Scaling factor to apply to evaluated value. */
   EvalType m_scale = 0;
-  /** Evaluated value.
-   *  The value may be stored in pinned memory.
+  /** Local contribution to the evaluated value.
+   *  GPU layers copy it back asynchronously, so it is in memory from
+   *  the pinned memory pool.
    */
-  CPUMatType m_value;
-  /** Non-blocking allreduce request. */
-  Al::request m_allreduce_req;
+  pinned_host_matrix<TensorDataType> m_value;
+  /** Whether values are accumulated across steps. */
+  bool m_accumulate = false;
+  /** Whether the value is read every step. */
+  bool m_read_every_step = false;
+  /** Local values accumulated across steps on the host. */
+  std::map<execution_mode, EvalType> m_accumulated;
 #ifdef LBANN_HAS_GPU
+  /** Local values accumulated across steps on the GPU. */
+  std::map<execution_mode, El::Matrix<TensorDataType, El::Device::GPU>>
+    m_accumulated_gpu;
   /** CUDA event after a non-blocking GPU-CPU memory copy. */
   cuda::event_wrapper m_copy_event;
 #endif // LBANN_HAS_GPU
@@ -91,6 +175,7 @@ public:
   std::string get_type() const override { return "evaluation"; }
   data_layout get_data_layout() const override { return T_layout; }
   El::Device get_device_allocation() const override { return Dev; }
+  bool can_recompute_activations() const override { return false; }
 };
 
 LBANN_DEFINE_LAYER_BUILDER(evaluation);
@@ -88,43 +88,8 @@ protected:
 
   }
 
-  void fp_compute() override {
-    auto& output = this->get_activations();
-    switch (this->get_num_parents()) {
-    case 0: El::Fill(output, El::TypeTraits<TensorDataType>::One()); break;
-    case 1: El::LockedView(output, this->get_prev_activations()); break;
-    default:
-      El::Hadamard(this->get_prev_activations(0),
-                   this->get_prev_activations(1),
-                   output);
-      for (int i = 2; i < this->get_num_parents(); ++i) {
-        El::Hadamard(this->get_prev_activations(i), output, output);
-      }
-    }
-  }
-
-  void bp_compute() override {
-    const int num_parents = this->get_num_parents();
-    const auto& gradient_wrt_output = this->get_prev_error_signals();
-    switch (num_parents) {
-    case 0: break;
-    case 1:
-      El::LockedView(this->get_error_signals(), gradient_wrt_output);
-      break;
-    default:
-      for (int i = 0; i < num_parents; ++i) {
-        auto& gradient_wrt_input = this->get_error_signals(i);
-        El::Copy(gradient_wrt_output, gradient_wrt_input);
-        for (int j = 0; j < num_parents; ++j) {
-          if (i != j) {
-            El::Hadamard(this->get_prev_activations(j),
-                         gradient_wrt_input,
-                         gradient_wrt_input);
-          }
-        }
-      }
-    }
-  }
+  void fp_compute() override;
+  void bp_compute() override;
 
 };
 
@@ -31,8 +31,9 @@
 #include <vector>
 #include "lbann/layers/transform/transform.hpp"
 #include "lbann/utils/cudnn.hpp"
+#include "lbann/utils/determinism.hpp"
 #include "lbann/utils/exception.hpp"
-#include "lbann/utils/im2col.hpp"
+#include "lbann/utils/cpu_pooling.hpp"
 #include "lbann/utils/distconv.hpp"
 
 namespace lbann {
@@ -82,9 +83,13 @@ private:
   /** Input indices for max pooling.
    *  Each entry corresponds to a local entry in the activations
    *  matrix. The entry gives the index of the maximum entry within
-   *  the pooling window.
+   *  the pooling window. Only used if the window has more than 256
+   *  entries (see @c m_max_pool_offsets).
    */
   std::vector<int> m_max_pool_indices;
+  /** Input indices for max pooling with windows of at most 256
+   *  entries. */
+  std::vector<unsigned char> m_max_pool_offsets;
 
 #ifdef LBANN_HAS_CUDNN
   /** Pooling descriptor. */
@@ -141,7 +146,8 @@ public:
       m_pool_size(other.m_pool_size),
       m_pads(other.m_pads),
       m_strides(other.m_strides),
-      m_max_pool_indices(other.m_max_pool_indices)
+      m_max_pool_indices(other.m_max_pool_indices),
+      m_max_pool_offsets(other.m_max_pool_offsets)
 #ifdef LBANN_HAS_CUDNN
     , m_pooling_cudnn_desc(nullptr),
       m_tensors_cudnn_desc(other.m_tensors_cudnn_desc)
@@ -161,6 +167,7 @@ public:
     m_pads = other.m_pads;
     m_strides = other.m_strides;
     m_max_pool_indices = other.m_max_pool_indices;
+    m_max_pool_offsets = other.m_max_pool_offsets;
 #ifdef LBANN_HAS_CUDNN
     copy_pooling_cudnn_desc(other.m_pooling_cudnn_desc, m_pooling_cudnn_desc);
     m_tensors_cudnn_desc = other.m_tensors_cudnn_desc;
@@ -253,11 +260,10 @@ protected:
     cudnnPoolingMode_t cudnn_pool_mode;
     switch(m_pool_mode) {
     case pool_mode::max:
-    #ifndef LBANN_DETERMINISTIC
-      cudnn_pool_mode = CUDNN_POOLING_MAX; break;
-    #else
-      cudnn_pool_mode = CUDNN_POOLING_MAX_DETERMINISTIC; break;
-    #endif
+      cudnn_pool_mode = (deterministic_mode()
+                         ? CUDNN_POOLING_MAX_DETERMINISTIC
+                         : CUDNN_POOLING_MAX);
+      break;
     case pool_mode::average:
       cudnn_pool_mode = CUDNN_POOLING_AVERAGE_COUNT_INCLUDE_PADDING; break;
     case pool_mode::average_no_pad:
@@ -290,7 +296,7 @@ protected:
 #endif // LBANN_HAS_DISTCONV
       fp_compute_cudnn();
     } else {
-      fp_compute_im2col();
+      fp_compute_cpu();
     }
   }
 
@@ -304,7 +310,7 @@ protected:
 #endif // LBANN_HAS_DISTCONV
       bp_compute_cudnn();
     } else {
-      bp_compute_im2col();
+      bp_compute_cpu();
     }
   }
 
@@ -367,173 +373,91 @@ private:
 #endif // #ifndef LBANN_HAS_CUDNN
   }
 
-  /// Pooling forward propagation with im2col
-  void fp_compute_im2col() {
+  /** Whether max pooling indices fit in @c m_max_pool_offsets. */
+  bool use_max_pool_offsets() const noexcept { return m_pool_size <= 256; }
+
+  /// Pooling forward propagation on CPU
+  void fp_compute_cpu() {
+    using CPUMatType = El::Matrix<TensorDataType, El::Device::CPU>;
     if(m_pool_mode != pool_mode::max && m_pool_mode != pool_mode::average) {
       LBANN_ERROR("CPU pooling layer only supports max and average pooling");
     }
 
     // Local matrices
-    const auto& local_input = this->get_local_prev_activations();
-    auto& local_output = this->get_local_activations();
+    const auto& local_input
+      = static_cast<const CPUMatType&>(this->get_local_prev_activations());
+    auto& local_output
+      = static_cast<CPUMatType&>(this->get_local_activations());
 
     // Pool parameters
-    const int local_width = local_input.Width();
     const auto& input_dims = this->get_input_dims();
     const int num_channels = input_dims[0];
-    const int num_per_output_channel = this->get_output_size() / num_channels;
+    const int num_spatial_dims = input_dims.size() - 1;
 
-    // Initialize max pool indices if needed
     if(m_pool_mode == pool_mode::max) {
-      m_max_pool_indices.assign(this->get_output_size() * local_width, 0);
-    }
-
-    // Initialize matrices
-    El::Matrix<TensorDataType, Dev> im2col_mat(m_pool_size * num_channels, num_per_output_channel);
-    El::Matrix<TensorDataType, Dev> input_mat;
-
-    // Iterate through data samples
-    for(int sample = 0; sample < local_width; ++sample) {
-
-      // Construct im2col matrix from input
-      El::LockedView(input_mat, local_input,
-                     El::ALL, El::IR(sample));
-      im2col<TensorDataType>(input_mat,
-             im2col_mat,
-             num_channels,
-             input_dims.size() - 1,
-             &input_dims[1],
-             m_pads.data(),
-             m_pool_dims.data(),
-             m_strides.data());
-
-      if(m_pool_mode == pool_mode::max) {
-        // Apply max pooling
-        TensorDataType *output_buffer = local_output.Buffer(0, sample);
-        int *indices_buffer = &m_max_pool_indices[sample * this->get_output_size()];
-        LBANN_OMP_PARALLEL_FOR
-        for(int channel = 0; channel < num_channels; ++channel) {
-          for(int j = 0; j < num_per_output_channel; ++j) {
-            TensorDataType *im2col_buffer = im2col_mat.Buffer(channel*m_pool_size, j);
-            TensorDataType max_entry = im2col_buffer[0];
-            int max_index = 0;
-            for(int i = 1; i < m_pool_size; ++i) {
-              const TensorDataType current_entry = im2col_buffer[i];
-              if(current_entry > max_entry) {
-                max_entry = current_entry;
-                max_index = i;
-              }
-            }
-            const int output_index = j + channel * num_per_output_channel;
-            output_buffer[output_index] = max_entry;
-            indices_buffer[output_index] = max_index;
-          }
-        }
+      const size_t num_indices = this->get_output_size() * local_input.Width();
+      if (use_max_pool_offsets()) {
+        m_max_pool_offsets.resize(num_indices);
+        max_pool_forward(local_input, local_output,
+                         m_max_pool_offsets.data(),
+                         num_channels, num_spatial_dims, &input_dims[1],
+                         m_pads.data(), m_pool_dims.data(), m_strides.data());
       }
-
-      if(m_pool_mode == pool_mode::average) {
-        // Apply average pooling
-        TensorDataType *output_buffer = local_output.Buffer(0, sample);
-        LBANN_OMP_PARALLEL_FOR
-        for(int channel = 0; channel < num_channels; ++channel) {
-          for(int j = 0; j < num_per_output_channel; ++j) {
-            const TensorDataType *im2col_buffer
-              = im2col_mat.LockedBuffer(channel*m_pool_size, j);
-            TensorDataType output_entry = El::TypeTraits<TensorDataType>::Zero();
-            for(int i = 0; i < m_pool_size; ++i) {
-              output_entry += im2col_buffer[i];
-            }
-            output_entry /= m_pool_size;
-            const int output_index = j + channel * num_per_output_channel;
-            output_buffer[output_index] = output_entry;
-          }
-        }
+      else {
+        m_max_pool_indices.resize(num_indices);
+        max_pool_forward(local_input, local_output,
+                         m_max_pool_indices.data(),
+                         num_channels, num_spatial_dims, &input_dims[1],
+                         m_pads.data(), m_pool_dims.data(), m_strides.data());
       }
-
+    }
+    if(m_pool_mode == pool_mode::average) {
+      average_pool_forward(local_input, local_output,
+                           num_channels, num_spatial_dims, &input_dims[1],
+                           m_pads.data(), m_pool_dims.data(), m_strides.data());
     }
 
   }
 
-  /// Pooling forward propagation with im2col
-  void bp_compute_im2col() {
+  /// Pooling backward propagation on CPU
+  void bp_compute_cpu() {
     using CPUMatType = El::Matrix<TensorDataType, El::Device::CPU>;
     if(m_pool_mode != pool_mode::max && m_pool_mode != pool_mode::average) {
       LBANN_ERROR("CPU pooling layer only supports max and average pooling");
     }
 
     // Local matrices
-    const auto& local_gradient_wrt_output = this->get_local_prev_error_signals();
-    auto& local_gradient_wrt_input = this->get_local_error_signals();
+    const auto& local_gradient_wrt_output
+      = static_cast<const CPUMatType&>(this->get_local_prev_error_signals());
+    auto& local_gradient_wrt_input
+      = static_cast<CPUMatType&>(this->get_local_error_signals());
 
     // Pool parameters
-    const int local_width = local_gradient_wrt_output.Width();
     const auto& input_dims = this->get_input_dims();
     const int num_channels = input_dims[0];
-    const int num_per_input_channel = this->get_output_size() / num_channels;
-
-    // Initialize matrices
-    CPUMatType im2col_mat(m_pool_size * num_channels, num_per_input_channel);
-    CPUMatType gradient_wrt_input_col;
-
-    // Iterate through data samples
-    for(int sample = 0; sample < local_width; ++sample) {
-
-      // Compute gradient w.r.t. im2col matrix for max pooling
-      if(m_pool_mode == pool_mode::max) {
-
-        // Clear im2col matrix
-        El::Zero(im2col_mat);
-
-        // Copy previous error signal to im2col matrix entries
-        // corresponding to max
-        const TensorDataType *gradient_wrt_output_buffer
-          = local_gradient_wrt_output.LockedBuffer(0, sample);
-        const int *indices_buffer
-          = &m_max_pool_indices[sample * this->get_output_size()];
-        LBANN_OMP_PARALLEL_FOR
-        for(int channel = 0; channel < num_channels; ++channel) {
-          for(int j = 0; j < num_per_input_channel; ++j) {
-            const int input_index = j + channel * num_per_input_channel;
-            const int max_index = indices_buffer[input_index];
-            TensorDataType *im2col_buffer = im2col_mat.Buffer(channel*m_pool_size, j);
-            im2col_buffer[max_index]
-              = gradient_wrt_output_buffer[input_index];
-          }
-        }
+    const int num_spatial_dims = input_dims.size() - 1;
 
+    if(m_pool_mode == pool_mode::max) {
+      if (use_max_pool_offsets()) {
+        max_pool_backward(local_gradient_wrt_output,
+                          m_max_pool_offsets.data(),
+                          local_gradient_wrt_input,
+                          num_channels, num_spatial_dims, &input_dims[1],
+                          m_pads.data(), m_pool_dims.data(), m_strides.data());
       }
-
-      // Compute gradient w.r.t. im2col matrix for average pooling
-      if(m_pool_mode == pool_mode::average) {
-        const TensorDataType *gradient_wrt_output_buffer
-          = local_gradient_wrt_output.LockedBuffer(0, sample);
-        LBANN_OMP_PARALLEL_FOR
-        for(int channel = 0; channel < num_channels; ++channel) {
-          for(int j = 0; j < num_per_input_channel; ++j) {
-            TensorDataType *im2col_buffer = im2col_mat.Buffer(channel*m_pool_size, j);
-            const int input_index = j + channel * num_per_input_channel;
-            const TensorDataType output_entry
-              = gradient_wrt_output_buffer[input_index] / El::To<TensorDataType>(m_pool_size);
-            for(int i = 0; i < m_pool_size; ++i) {
-              im2col_buffer[i] = output_entry;
-            }
-          }
-        }
-
+      else {
+        max_pool_backward(local_gradient_wrt_output,
+                          m_max_pool_indices.data(),
+                          local_gradient_wrt_input,
+                          num_channels, num_spatial_dims, &input_dims[1],
+                          m_pads.data(), m_pool_dims.data(), m_strides.data());
       }
-
-      // Compute error signal (i.e. gradient w.r.t. input)
-      El::View(gradient_wrt_input_col, local_gradient_wrt_input,
-               El::ALL, El::IR(sample));
-      col2im<TensorDataType>(im2col_mat,
-             gradient_wrt_input_col,
-             num_channels,
-             input_dims.size() - 1,
-             &input_dims[1],
-             m_pads.data(),
-             m_pool_dims.data(),
-             m_strides.data());
-
+    }
+    if(m_pool_mode == pool_mode::average) {
+      average_pool_backward(local_gradient_wrt_output,
+                            local_gradient_wrt_input,
+                            num_channels, num_spatial_dims, &input_dims[1],
+                            m_pads.data(), m_pool_dims.data(), m_strides.data());
     }
 
   }
@@ -89,61 +89,8 @@ protected:
     this->set_output_dims({1});
   }
 
-  void fp_compute() override {
-
-    // Local matrices
-    const auto& local_input = this->get_local_prev_activations();
-    auto& local_output = this->get_local_activations();
-    const El::Int input_size = local_input.Height();
-
-    // Apply reduction
-    switch (m_mode) {
-    case reduction_mode::SUM:
-      El::Ones(m_ones, input_size, 1);
-      El::Gemv(El::TRANSPOSE,
-               El::TypeTraits<TensorDataType>::One(), local_input, m_ones,
-               El::TypeTraits<TensorDataType>::Zero(), local_output);
-      break;
-    case reduction_mode::AVERAGE:
-      El::Ones(m_ones, input_size, 1);
-      El::Gemv(El::TRANSPOSE,
-               El::TypeTraits<TensorDataType>::One() / El::To<TensorDataType>(input_size),
-               local_input, m_ones,
-               El::TypeTraits<TensorDataType>::Zero(), local_output);
-      break;
-    default:
-      LBANN_ERROR("invalid reduction mode");
-    }
-
-  }
-
-  void bp_compute() override {
-
-    // Local matrices
-    const auto& local_gradient_wrt_output = this->get_local_prev_error_signals();
-    auto& local_gradient_wrt_input = this->get_local_error_signals();
-    const El::Int input_size = local_gradient_wrt_input.Height();
-
-    // Compute gradients w.r.t. inputs
-    switch (m_mode) {
-    case reduction_mode::SUM:
-      El::Ones(m_ones, input_size, 1);
-      El::Gemm(El::NORMAL, El::NORMAL,
-               El::TypeTraits<TensorDataType>::One(), m_ones, local_gradient_wrt_output,
-               El::TypeTraits<TensorDataType>::Zero(), local_gradient_wrt_input);
-      break;
-    case reduction_mode::AVERAGE:
-      El::Ones(m_ones, input_size, 1);
-      El::Gemm(El::NORMAL, El::NORMAL,
-               El::TypeTraits<TensorDataType>::One() / El::To<TensorDataType>(input_size),
-               m_ones, local_gradient_wrt_output,
-               El::TypeTraits<TensorDataType>::Zero(), local_gradient_wrt_input);
-      break;
-    default:
-      LBANN_ERROR("invalid reduction mode");
-    }
-
-  }
+  void fp_compute() override;
+  void bp_compute() override;
 
 };
 
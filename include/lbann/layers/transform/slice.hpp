@@ -97,6 +97,13 @@ private:
   bool m_set_slice_points_from_data_reader;
   /** Category for retrieving slice points from data reader */
   slice_points_mode m_var_category;
+  /** @brief Whether output tensors are views into the input tensor.
+   *
+   *  This is possible for data-parallel layouts when all dimensions
+   *  before the slice dimension are trivial, so each output is a
+   *  contiguous block of rows in the input matrix.
+   */
+  bool m_view_outputs = false;
 
 #ifdef LBANN_HAS_GPU
   /** @brief Workspace buffer.
@@ -232,6 +239,12 @@ void slice_layer<TensorDataType,Layout,Device>::setup_dims(DataReaderMetaData& d
     this->set_output_dims(output_dims, i);
   }
 
+  // Outputs can be views if slicing along the leading dimension
+  m_view_outputs = (Layout == data_layout::DATA_PARALLEL
+                    && std::all_of(input_dims.begin(),
+                                   input_dims.begin() + m_slice_dim,
+                                   [](int d) { return d == 1; }));
+
 }
 
 template <typename TensorDataType, El::Device Device>
@@ -259,6 +272,23 @@ void fp_setup_outputs_impl(
 
   const size_t num_outputs = l.get_num_children();
   const auto& input = l.get_prev_activations();
+
+  // View blocks of rows if slicing along the leading dimension
+  if (l.m_view_outputs) {
+    const auto& input_dims = l.get_input_dims();
+    const size_t slice_stride = (l.get_input_size()
+                                 / input_dims[l.m_slice_dim]);
+    size_t offset = l.m_slice_points.front() * slice_stride;
+    for (size_t j=0; j<num_outputs; ++j) {
+      auto& output = l.get_activations(j);
+      const auto& output_size = l.get_output_size(j);
+      El::LockedView(output, input,
+                     El::IR(offset, offset+output_size), El::ALL);
+      offset += output_size;
+    }
+    return;
+  }
+
   for (size_t j=0; j<num_outputs; ++j) {
     auto& output = l.get_activations(j);
     output.AlignWith(input);
@@ -274,6 +304,10 @@ void slice_layer<TensorDataType,Layout,Device>::fp_setup_outputs(El::Int mini_ba
 
 template <typename TensorDataType, data_layout Layout, El::Device Device>
 void slice_layer<TensorDataType,Layout,Device>::fp_compute() {
+  if (m_view_outputs) {
+    // Tensor views have already been setup in fp_setup_outputs
+    return;
+  }
   fp_compute_impl(*this);
 }
 
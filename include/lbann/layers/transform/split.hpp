@@ -82,6 +82,16 @@ protected:
 
   void fp_compute() override {}
 
+  void bp_setup_gradient_wrt_inputs(El::Int mini_batch_size) override {
+    if (view_gradient_wrt_input()) {
+      El::LockedView(this->get_error_signals(),
+                     this->get_prev_error_signals(0));
+    }
+    else {
+      transform_layer<TensorDataType>::bp_setup_gradient_wrt_inputs(mini_batch_size);
+    }
+  }
+
   void bp_compute() override {
 #ifdef LBANN_HAS_DISTCONV
     if (this->distconv_enabled()) {
@@ -89,6 +99,11 @@ protected:
       return;
     }
 #endif // LBANN_HAS_DISTCONV
+    if (view_gradient_wrt_input()) {
+      // Tensor view has already been setup in
+      // bp_setup_gradient_wrt_inputs
+      return;
+    }
     auto& gradient_wrt_input = this->get_error_signals();
     if (this->get_num_children() > 0) {
       El::Copy(this->get_prev_error_signals(0), gradient_wrt_input);
@@ -101,6 +116,20 @@ protected:
     }
   }
 
+private:
+
+  /** @brief Whether the input gradient is a view into the output
+   *  gradient.
+   *
+   *  This is the case when there is exactly one child.
+   */
+  bool view_gradient_wrt_input() const {
+#ifdef LBANN_HAS_DISTCONV
+    if (this->distconv_enabled()) { return false; }
+#endif // LBANN_HAS_DISTCONV
+    return this->get_num_children() == 1;
+  }
+
 #ifdef LBANN_HAS_DISTCONV
  protected:
   bool is_distconv_supported() const override {
@@ -30,7 +30,7 @@
 #include <vector>
 #include "lbann/layers/transform/pooling.hpp"
 #include "lbann/utils/exception.hpp"
-#include "lbann/utils/im2col.hpp"
+#include "lbann/utils/cpu_pooling.hpp"
 
 namespace lbann {
 
@@ -129,7 +129,7 @@ class unpooling_layer : public transform_layer<TensorDataType> {
     if(this->using_gpus()) {
       throw lbann_exception("unpooling_layer: GPU version not yet implemented");
     } else {
-      fp_compute_im2col();
+      fp_compute_cpu();
     }
   }
 
@@ -137,120 +137,80 @@ class unpooling_layer : public transform_layer<TensorDataType> {
     if(this->using_gpus()) {
       throw lbann_exception("unpooling_layer: GPU version not yet implemented");
     } else {
-      bp_compute_im2col();
+      bp_compute_cpu();
     }
   }
 
  private:
 
-  /// Unpooling forward propagation with im2col
-  void fp_compute_im2col() {
+  /// Unpooling forward propagation on CPU
+  void fp_compute_cpu() {
 
     using DMatDT = El::Matrix<TensorDataType, Dev>;
 
     // Get local matrices
-    const DMatDT& prev_activations_local = this->get_local_prev_activations();
-    DMatDT& activations_local = this->get_local_activations();
+    const auto& prev_activations_local
+      = static_cast<const DMatDT&>(this->get_local_prev_activations());
+    auto& activations_local
+      = static_cast<DMatDT&>(this->get_local_activations());
 
     // Get parameters
-    const int local_width = prev_activations_local.Width();
     const auto& output_dims = this->get_output_dims();
     const int num_channels = output_dims[0];
-    const int num_per_input_channel = this->get_input_size() / num_channels;
-    const int pool_size = m_pooling_layer->m_pool_size;
-
-    // Initialize im2col matrix
-    DMatDT im2col_mat(pool_size * num_channels, num_per_input_channel);
-
-    // Iterate through data samples
-    for(int sample = 0; sample < local_width; ++sample) {
-
-      // Clear im2col matrix
-      El::Zero(im2col_mat);
-
-      // Populate im2col matrix
-      const TensorDataType *prev_activations_buffer
-        = prev_activations_local.LockedBuffer(0, sample);
-      const int *indices_buffer
-        = &m_pooling_layer->m_max_pool_indices[sample * this->get_input_size()];
-      LBANN_OMP_PARALLEL_FOR
-      for(int channel = 0; channel < num_channels; ++channel) {
-        for(int j = 0; j < num_per_input_channel; ++j) {
-          const int input_index = j + channel * num_per_input_channel;
-          const int max_index = indices_buffer[input_index];
-          TensorDataType *im2col_buffer
-            = im2col_mat.Buffer(channel * pool_size, j);
-          im2col_buffer[max_index]
-            = prev_activations_buffer[input_index];
-        }
-      }
-
-      // Convert im2col matrix to output matrix
-      DMatDT output_mat =
-        El::View(activations_local, El::ALL, El::IR(sample));
-      col2im<TensorDataType>(im2col_mat,
-             output_mat,
-             num_channels,
-             output_dims.size() - 1,
-             &output_dims[1],
-             m_pooling_layer->m_pads.data(),
-             m_pooling_layer->m_pool_dims.data(),
-             m_pooling_layer->m_strides.data(),
-             [](TensorDataType const& a, TensorDataType const& b) {
-               return std::max(a, b);
-             });
+    const int num_spatial_dims = output_dims.size() - 1;
+    const auto& pool = *m_pooling_layer;
+
+    if (pool.use_max_pool_offsets()) {
+      max_unpool_forward(prev_activations_local,
+                         pool.m_max_pool_offsets.data(),
+                         activations_local,
+                         num_channels, num_spatial_dims, &output_dims[1],
+                         pool.m_pads.data(), pool.m_pool_dims.data(),
+                         pool.m_strides.data());
     }
+    else {
+      max_unpool_forward(prev_activations_local,
+                         pool.m_max_pool_indices.data(),
+                         activations_local,
+                         num_channels, num_spatial_dims, &output_dims[1],
+                         pool.m_pads.data(), pool.m_pool_dims.data(),
+                         pool.m_strides.data());
+    }
+
   }
 
-  /// Unpooling backward propagation with im2col
-  void bp_compute_im2col() {
+  /// Unpooling backward propagation on CPU
+  void bp_compute_cpu() {
 
     using DMatDT = El::Matrix<TensorDataType, Dev>;
 
     // Get local matrices
-    const DMatDT& prev_error_signal_local = this->get_local_prev_error_signals();
-    DMatDT& error_signal_local = this->get_local_error_signals();
+    const auto& prev_error_signal_local
+      = static_cast<const DMatDT&>(this->get_local_prev_error_signals());
+    auto& error_signal_local
+      = static_cast<DMatDT&>(this->get_local_error_signals());
 
     // Get parameters
-    const int local_width = prev_error_signal_local.Width();
     const auto& output_dims = this->get_output_dims();
     const int num_channels = output_dims[0];
-    const int num_per_output_channel = this->get_input_size() / num_channels;
-    const int pool_size = m_pooling_layer->m_pool_size;
-
-    // Initialize im2col matrix
-    DMatDT im2col_mat(pool_size * num_channels, num_per_output_channel);
-
-    // Iterate through data samples
-    for(int sample = 0; sample < local_width; ++sample) {
-
-      // Construct im2col matrix from input
-      const DMatDT& input_mat = El::LockedView(prev_error_signal_local,
-                                               El::ALL, El::IR(sample));
-      im2col<TensorDataType>(input_mat,
-             im2col_mat,
-             num_channels,
-             output_dims.size() - 1,
-             &output_dims[1],
-             m_pooling_layer->m_pads.data(),
-             m_pooling_layer->m_pool_dims.data(),
-             m_pooling_layer->m_strides.data());
-
-      // Propagate error signal based on pooling layer
-      TensorDataType *output_buffer = error_signal_local.Buffer(0, sample);
-      const int *indices_buffer
-        = &m_pooling_layer->m_max_pool_indices[sample * this->get_input_size()];
-      LBANN_OMP_PARALLEL_FOR
-      for(int channel = 0; channel < num_channels; ++channel) {
-        for(int j = 0; j < num_per_output_channel; ++j) {
-          const int output_index = j + channel * num_per_output_channel;
-          const int max_index = indices_buffer[output_index];
-          TensorDataType *im2col_buffer
-            = im2col_mat.Buffer(channel * pool_size, j);
-          output_buffer[output_index] = im2col_buffer[max_index];
-        }
-      }
-
+    const int num_spatial_dims = output_dims.size() - 1;
+    const auto& pool = *m_pooling_layer;
+
+    if (pool.use_max_pool_offsets()) {
+      max_unpool_backward(prev_error_signal_local,
+                          pool.m_max_pool_offsets.data(),
+                          error_signal_local,
+                          num_channels, num_spatial_dims, &output_dims[1],
+                          pool.m_pads.data(), pool.m_pool_dims.data(),
+                          pool.m_strides.data());
+    }
+    else {
+      max_unpool_backward(prev_error_signal_local,
+                          pool.m_max_pool_indices.data(),
+                          error_signal_local,
+                          num_channels, num_spatial_dims, &output_dims[1],
+                          pool.m_pads.data(), pool.m_pool_dims.data(),
+                          pool.m_strides.data());
     }
 
   }
@@ -112,23 +112,8 @@ protected:
 
   }
 
-  void fp_compute() override {
-    auto& output = this->get_activations();
-    El::Zero(output);
-    for (int i = 0; i < this->get_num_parents(); ++i) {
-      El::Axpy(m_scaling_factors[i], this->get_prev_activations(i), output);
-    }
-  }
-
-  void bp_compute() override {
-    const auto& gradient_wrt_output = this->get_prev_error_signals();
-    for (int i = 0; i < this->get_num_parents(); ++i) {
-      auto& gradient_wrt_input = this->get_error_signals(i);
-      El::Zero(gradient_wrt_input);
-      El::Axpy(m_scaling_factors[i], gradient_wrt_output,
-               gradient_wrt_input);
-    }
-  }
+  void fp_compute() override;
+  void bp_compute() override;
 
 };
 
@@ -32,9 +32,12 @@
 
 /// Training Algorithms
 #include "lbann/training_algorithms/training_algorithm.hpp"
+#include "lbann/training_algorithms/local_sgd_training_algorithm.hpp"
 
 /// Models
 #include "lbann/models/directed_acyclic_graph.hpp"
+#include "lbann/models/inference_engine.hpp"
+#include "lbann/models/inference_server.hpp"
 
 /// Activation layers
 #include "lbann/layers/activations/activations.hpp"
@@ -69,6 +72,7 @@
 #include "lbann/layers/math/unary.hpp"
 #include "lbann/layers/math/binary.hpp"
 #include "lbann/layers/math/clamp.hpp"
+#include "lbann/layers/math/fused_entrywise.hpp"
 
 /// Transform layers
 #include "lbann/layers/transform/reshape.hpp"
@@ -118,12 +122,14 @@
 #include "lbann/layers/misc/argmax.hpp"
 #include "lbann/layers/misc/argmin.hpp"
 #include "lbann/layers/misc/one_hot.hpp"
+#include "lbann/layers/misc/scaled_dot_product_attention.hpp"
 
 /// Data readers
 #include "lbann/data_readers/data_reader_npz_ras_lipid.hpp"
 #include "lbann/data_readers/data_reader_imagenet.hpp"
 #include "lbann/data_readers/data_reader_cifar10.hpp"
 #include "lbann/data_readers/data_reader_mnist.hpp"
+#include "lbann/data_readers/data_reader_stream.hpp"
 #include "lbann/data_readers/data_reader_synthetic.hpp"
 #include "lbann/data_readers/data_reader_jag_conduit.hpp"
 #include "lbann/data_readers/data_reader_nci.hpp"
@@ -142,6 +148,7 @@
 #include "lbann/data_store/data_store_conduit.hpp"
 
 /// Callbacks
+#include "lbann/callbacks/autotune_io.hpp"
 #include "lbann/callbacks/check_dataset.hpp"
 #include "lbann/callbacks/check_gradients.hpp"
 #include "lbann/callbacks/check_init.hpp"
@@ -149,6 +156,7 @@
 #include "lbann/callbacks/check_nan.hpp"
 #include "lbann/callbacks/check_small.hpp"
 #include "lbann/callbacks/checkpoint.hpp"
+#include "lbann/callbacks/comm_profiler.hpp"
 #include "lbann/callbacks/confusion_matrix.hpp"
 #include "lbann/callbacks/debug.hpp"
 #include "lbann/callbacks/debug_io.hpp"
@@ -158,27 +166,35 @@
 #include "lbann/callbacks/dump_outputs.hpp"
 #include "lbann/callbacks/dump_weights.hpp"
 #include "lbann/callbacks/early_stopping.hpp"
+#include "lbann/callbacks/elastic_resize.hpp"
+#include "lbann/callbacks/gpu_layer_timer.hpp"
 #include "lbann/callbacks/gpu_memory_usage.hpp"
 #include "lbann/callbacks/hang.hpp"
 #include "lbann/callbacks/imcomm.hpp"
 #include "lbann/callbacks/learning_rate.hpp"
 #include "lbann/callbacks/ltfb.hpp"
+#include "lbann/callbacks/memory_accounting.hpp"
 #include "lbann/callbacks/mixup.hpp"
 #include "lbann/callbacks/monitor_io.hpp"
+#include "lbann/callbacks/parallel_plan.hpp"
+#include "lbann/callbacks/pbt.hpp"
 #include "lbann/callbacks/perturb_adam.hpp"
 #include "lbann/callbacks/perturb_dropout.hpp"
 #include "lbann/callbacks/print_model_description.hpp"
 #include "lbann/callbacks/print_statistics.hpp"
 #include "lbann/callbacks/profiler.hpp"
+#include "lbann/callbacks/quantize_int8.hpp"
 #include "lbann/callbacks/replace_weights.hpp"
 #include "lbann/callbacks/save_images.hpp"
 #include "lbann/callbacks/save_model.hpp"
 #include "lbann/callbacks/load_model.hpp"
 #include "lbann/callbacks/save_topk_models.hpp"
+#include "lbann/callbacks/straggler_detection.hpp"
 #include "lbann/callbacks/summary.hpp"
 #include "lbann/callbacks/sync_layers.hpp"
 #include "lbann/callbacks/timeline.hpp"
 #include "lbann/callbacks/timer.hpp"
+#include "lbann/callbacks/trace.hpp"
 #include "lbann/callbacks/variable_minibatch.hpp"
 
 /// Weights and weight initializers
@@ -190,6 +206,8 @@
 #include "lbann/optimizers/adagrad.hpp"
 #include "lbann/optimizers/adam.hpp"
 #include "lbann/optimizers/hypergradient_adam.hpp"
+#include "lbann/optimizers/lamb.hpp"
+#include "lbann/optimizers/lars.hpp"
 #include "lbann/optimizers/rmsprop.hpp"
 #include "lbann/optimizers/sgd.hpp"
 
@@ -213,6 +231,7 @@
 #include "lbann/utils/omp_diagnostics.hpp"
 #include "lbann/utils/peek_map.hpp"
 #include "lbann/utils/stack_trace.hpp"
+#include "lbann/utils/sampling_profiler.hpp"
 #include "lbann/utils/stack_profiler.hpp"
 #include "lbann/utils/threads/thread_pool.hpp"
 #include "lbann/utils/threads/thread_utils.hpp"
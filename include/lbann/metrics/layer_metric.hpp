@@ -32,6 +32,13 @@
 
 namespace lbann {
 
+/** @brief Metric given by an evaluation layer
+ *
+ *  With @c --metric_sync_interval=K (K > 1), values are accumulated
+ *  by the evaluation layer (on the device for GPU layers) and added
+ *  to the statistics every K steps and in @c synchronize_statistics,
+ *  rather than read every step.
+ */
 class layer_metric : public metric {
 
  public:
@@ -72,9 +79,12 @@ class layer_metric : public metric {
   bool save_to_checkpoint_distributed(persist& p);
   bool load_from_checkpoint_distributed(persist& p);
 
+  void synchronize_statistics() override;
+
  protected:
 
   void setup(model& m) override;
+  /** Returns zero if the value is deferred. */
   EvalType evaluate(execution_mode mode, int mini_batch_size) override;
 
   /** Computation to evaluate the metric function (deprecated).
@@ -98,6 +108,20 @@ class layer_metric : public metric {
   /** Corresponding layer. */
   Layer* m_layer;
 
+  /** Steps between adding accumulated values to the statistics. */
+  int m_sync_interval = 1;
+  /** Whether values are accumulated by the evaluation layer. */
+  bool m_deferred = false;
+  /** Steps and samples accumulated since the last synchronization. */
+  struct pending_statistics {
+    int num_steps = 0;
+    int num_samples = 0;
+  };
+  std::map<execution_mode, pending_statistics> m_pending;
+
+  /** Add the values accumulated for a mode to the statistics. */
+  void synchronize_statistics(execution_mode mode);
+
   /** Get corresponding evaluation layer. */
   /*abstract_evaluation_*/Layer& get_evaluation_layer();
 
@@ -122,6 +122,17 @@ class metric {
    */
   virtual EvalType evaluate(execution_mode mode, int mini_batch_size) = 0;
 
+  /** @brief Add values that were accumulated across steps to the
+   *  statistics.
+   *
+   *  Metrics may defer reading their values (see @c
+   *  layer_metric). This is called by the training algorithm before
+   *  epoch and evaluation end callbacks, and may be called by
+   *  callbacks that need current statistics at other times. Must be
+   *  called on every process of the trainer.
+   */
+  virtual void synchronize_statistics() {}
+
   /** Clear all statistics. */
   void reset_statistics() { m_statistics.clear(); }
   /** Clear statistics for an execution mode. */
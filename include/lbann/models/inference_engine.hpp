@@ -0,0 +1,171 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_MODELS_INFERENCE_ENGINE_HPP_INCLUDED
+#define LBANN_MODELS_INFERENCE_ENGINE_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+#include "lbann/trainers/trainer.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lbann {
+
+// Forward declarations
+class Layer;
+class model;
+class sgd_execution_context;
+class sgd_training_algorithm;
+template <typename TensorDataType> class data_type_layer;
+
+/** @brief Low-latency forward prop on batches held in memory.
+ *
+ *  Runs the layers needed for the output layers directly, bypassing
+ *  the data coordinator, callbacks, the objective function and
+ *  metrics. Layers that are not needed for the outputs, e.g. loss
+ *  and evaluation layers, are not run. The model must have a single
+ *  input layer, whose samples are replaced by the batch and whose
+ *  labels are zero. Layer buffers are allocated for the largest
+ *  batch when the engine is constructed, so later batches do not
+ *  allocate memory.
+ *
+ *  Inference graph rewrites (see --fuse_inference_layers) are
+ *  applied when the model is set up. Weights should be loaded before
+ *  the engine is constructed.
+ */
+class inference_engine {
+public:
+
+  /** @param t               Trainer that owns the model's execution
+   *                          contexts.
+   *  @param m               Model.
+   *  @param output_layers   Names of layers whose outputs are
+   *                          returned. If empty, layers without
+   *                          children that do not depend on the
+   *                          labels.
+   *  @param max_batch_size  Largest batch. If zero, the trainer's
+   *                          maximum mini-batch size.
+   */
+  inference_engine(trainer& t,
+                   model& m,
+                   std::vector<std::string> output_layers = {},
+                   El::Int max_batch_size = 0);
+  ~inference_engine();
+  inference_engine(const inference_engine&) = delete;
+  inference_engine& operator=(const inference_engine&) = delete;
+
+  /** @brief Compute the outputs for a batch of samples.
+   *
+   *  Every process in the trainer must call this with the same
+   *  batch.
+   *
+   *  @param samples  Flattened samples, one per column.
+   *  @returns        Outputs of each output layer, one column per
+   *                  sample.
+   */
+  std::vector<CPUMat> predict(const CPUMat& samples);
+
+  /** @brief Size of a flattened sample. */
+  El::Int get_input_size() const;
+  /** @brief Largest batch. */
+  El::Int get_max_batch_size() const noexcept { return m_max_batch_size; }
+  /** @brief Names of the output layers. */
+  std::vector<std::string> get_output_layer_names() const;
+
+private:
+
+  trainer& m_trainer;
+  model& m_model;
+  /** Algorithm that owns the execution context. */
+  std::unique_ptr<sgd_training_algorithm> m_algorithm;
+  trainer::execution_context_key_pair_t m_context_key;
+  sgd_execution_context* m_context;
+  /** Input layer, whose outputs are set to the batch. */
+  data_type_layer<DataType>* m_input_layer = nullptr;
+  /** Layers needed for the outputs, in execution order. */
+  std::vector<Layer*> m_layers;
+  std::vector<data_type_layer<DataType>*> m_output_layers;
+  El::Int m_max_batch_size;
+
+};
+
+/** @brief Gather single-sample requests into batches.
+ *
+ *  A worker thread runs a batch once it has @c max_batch_size
+ *  requests or the oldest request has waited for @c max_delay. The
+ *  engine must only be used by the batcher while it is running, and
+ *  the trainer must have one process since batches are formed
+ *  independently on each process.
+ */
+class inference_batcher {
+public:
+
+  inference_batcher(inference_engine& engine,
+                    El::Int max_batch_size,
+                    std::chrono::microseconds max_delay);
+  ~inference_batcher();
+  inference_batcher(const inference_batcher&) = delete;
+  inference_batcher& operator=(const inference_batcher&) = delete;
+
+  /** @brief Queue a request.
+   *  @param sample  Flattened sample in one column.
+   *  @returns       Outputs of each output layer for the sample.
+   */
+  std::future<std::vector<CPUMat>> submit(CPUMat sample);
+
+private:
+
+  struct request {
+    CPUMat sample;
+    std::promise<std::vector<CPUMat>> outputs;
+  };
+
+  /** Worker thread loop. */
+  void run();
+
+  inference_engine& m_engine;
+  El::Int m_max_batch_size;
+  std::chrono::microseconds m_max_delay;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  /** Requests and their arrival times. */
+  std::deque<std::pair<request, std::chrono::steady_clock::time_point>> m_requests;
+  bool m_stop = false;
+  std::thread m_worker;
+
+};
+
+} // namespace lbann
+
+#endif // LBANN_MODELS_INFERENCE_ENGINE_HPP_INCLUDED
@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_MODELS_INFERENCE_SERVER_HPP_INCLUDED
+#define LBANN_MODELS_INFERENCE_SERVER_HPP_INCLUDED
+
+#include "lbann/models/inference_engine.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lbann {
+
+/** @brief Serve inference requests over TCP.
+ *
+ *  Each connection sends requests and receives responses in order.
+ *  Requests from all connections are batched by an @c
+ *  inference_batcher. Values are sent in the server's native byte
+ *  order:
+ *
+ *  - Request: a @c uint64_t sample size followed by that many @c
+ *    DataType values. The size must match the model's input size.
+ *  - Response: a @c uint64_t number of outputs followed, for each
+ *    output layer, by a @c uint64_t size and that many @c DataType
+ *    values.
+ *
+ *  A malformed request or a failed forward prop closes the
+ *  connection.
+ *
+ *  Every trainer may run a replica with its own server. Where the
+ *  platform supports @c SO_REUSEPORT, replicas on the same node can
+ *  share a port and the kernel balances connections between them.
+ */
+class inference_server {
+public:
+
+  /** @param engine          Inference engine for a single-process
+   *                          trainer.
+   *  @param max_batch_size  Largest batch.
+   *  @param max_delay       Longest time a request waits for a
+   *                          batch to fill.
+   *  @param port            TCP port.
+   */
+  inference_server(inference_engine& engine,
+                   El::Int max_batch_size,
+                   std::chrono::microseconds max_delay,
+                   int port);
+  ~inference_server();
+  inference_server(const inference_server&) = delete;
+  inference_server& operator=(const inference_server&) = delete;
+
+  /** @brief Accept connections until @c stop is called. */
+  void serve();
+  /** @brief Stop accepting connections and close open ones.
+   *  @details Safe to call from another thread.
+   */
+  void stop();
+
+private:
+
+  /** Read requests from a connection until it is closed. */
+  void handle_connection(int fd);
+
+  inference_batcher m_batcher;
+  El::Int m_input_size;
+  /** Listening socket. */
+  int m_socket = -1;
+  std::atomic<bool> m_stop;
+  std::mutex m_mutex;
+  /** Open connections. */
+  std::vector<int> m_connections;
+  std::vector<std::thread> m_threads;
+
+};
+
+} // namespace lbann
+
+#endif // LBANN_MODELS_INFERENCE_SERVER_HPP_INCLUDED
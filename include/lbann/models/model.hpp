@@ -42,6 +42,7 @@
 #include "lbann/proto/factories.hpp"
 #include "lbann/weights/weights.hpp"
 #include "lbann/utils/threads/thread_pool.hpp"
+#include "lbann/utils/cuda.hpp"
 #include <cereal/types/utility.hpp>
 
 // Note (trb): There's what is, IMO, an STL error in GCC in which the
@@ -51,9 +52,14 @@
 // `IncompleteType*`, which is annoying.
 #include <optimizers.pb.h>
 
+#include <atomic>
+#include <functional>
+#include <map>
+#include <set>
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 // Forward-declare protobuf class
 namespace lbann_data {
@@ -66,6 +72,7 @@ namespace lbann {
 class lbann_callback;
 class training_algorithm;
 class callback_base;
+class evaluation_partial_value;
 
 /** @brief Abstract base class for neural network models. */
 class model {
@@ -123,6 +130,10 @@ public:
 
   /** @brief Size of model's list of layers. */
   El::Int get_num_layers() const noexcept;
+  /** @brief Bytes in the tensor arena on a device.
+   *  @details See @c setup_activation_memory_plan.
+   */
+  size_t get_tensor_arena_size(El::Device device) const noexcept;
   /** @param pos Position in model's list of layers. */
   Layer& get_layer(El::Int pos);
   /** @param pos Position in model's list of layers. */
@@ -206,6 +217,14 @@ public:
    */
   void copy_trained_weights_from(std::vector<weights *>& w);
 
+  /** @brief Share the matrices of trained weights in w.
+   *
+   *  Like copy_trained_weights_from, but done once: weights with the
+   *  same name as unfrozen weights in w share their matrix, so
+   *  training either model updates both.
+   */
+  void tie_trained_weights_with(std::vector<weights *>& w);
+
   /** @brief Construct an instance of the default optimizer.
    *
    *  If there is no default optimizer, a null pointer is returned.
@@ -337,9 +356,17 @@ protected:
    *
    *  Called in setup function. All weights being used by layers or
    *  the objective function are added to the model and all unused
-   *  weights are deleted.
+   *  weights are deleted. Initialization is deferred if a callback
+   *  will restore the weights values during setup.
    */
   virtual void setup_weights();
+  /** @brief Initialize weights that are still unset after setup.
+   *
+   *  Covers deferred weights that a checkpoint did not restore.
+   *  The decision is made over the trainer, since initializers
+   *  communicate.
+   */
+  void initialize_pending_weights();
 
 public:
   // ===========================================
@@ -359,21 +386,97 @@ public:
       mode requested */
   virtual void collect_background_data_fetch(execution_mode mode);
 
-  /** @brief Forward propagation step. */
+  /** @brief Forward propagation step.
+   *
+   *  With --parallel_layer_execution, independent layers may run
+   *  concurrently (see @c setup_parallel_layer_execution).
+   */
   virtual void forward_prop(execution_mode mode);
-  /** @brief Backward propagation step. */
+  /** @brief Backward propagation step.
+   *
+   *  With --parallel_layer_execution, independent layers may run
+   *  concurrently (see @c setup_parallel_layer_execution).
+   */
   virtual void backward_prop();
+  /** @brief Whether @c forward_backward_prop_with_graph is used for
+   *  training steps.
+   *
+   *  Enabled with --cuda_graph_training_step. The model is checked on
+   *  the first call and a message is printed if it can not be
+   *  captured.
+   */
+  bool using_training_graph();
+  /** @brief Forward and backward prop for a training step, replaying
+   *  the GPU work from a CUDA graph.
+   *
+   *  Leading layers without parents (e.g. input layers) run eagerly.
+   *  The other layers are run eagerly for --cuda_graph_warmup steps
+   *  (default 2), then captured into a CUDA graph that is replayed on
+   *  later steps. The graph is recaptured whenever the mini-batch
+   *  size changes or another forward prop ran in between (e.g. for
+   *  validation). If a capture fails, the model falls back to eager
+   *  execution.
+   *
+   *  Replaying a step skips the host code of the captured layers, so
+   *  their per-layer callbacks and timers only run on eager and
+   *  capture steps. Gradient allreduces are launched after the graph
+   *  instead of during backprop. The captured layers must not hold
+   *  memory pool buffers across steps, other than their tensors.
+   */
+  void forward_backward_prop_with_graph();
   /** Evaluate any metrics in the model */
   virtual void evaluate_metrics(execution_mode mode,
                                 size_t current_mini_batch_size);
+  /** @brief Add deferred metric values to the metric statistics.
+   *  @details See @c metric::synchronize_statistics.
+   */
+  void synchronize_metrics();
+  /** @brief Reduce the pending values of all evaluation layers.
+   *
+   *  The values are packed and summed with one allreduce over the
+   *  trainer, so metrics and objective function terms share a single
+   *  collective per step. Called by the first evaluation layer whose
+   *  value is requested. Waits for a reduction started by @c
+   *  start_evaluation_reduction.
+   */
+  void reduce_evaluation_values();
   /** @brief Clear each optimizer's gradient.
    *
    *  This must be called before training forward prop since layers
    *  set an optimizer flag during forward prop.
    */
   virtual void clear_gradients();
-  /** @brief Update weights step. */
+  /** @brief Defer the optimizers' gradient allreduces.
+   *
+   *  While deferred, gradients from successive backprops accumulate
+   *  locally. They are allreduced during the first backprop after
+   *  the deferral is lifted, e.g. to accumulate gradients over
+   *  micro-batches.
+   */
+  void set_gradient_allreduces_deferred(bool defer);
+  /** @brief Update weights step.
+   *
+   *  With --overlap_weight_updates, the optimization steps are
+   *  deferred to the next forward prop, where each weights object is
+   *  updated just before the first layer that uses it. Forward prop
+   *  can then start on the first layers while the gradient
+   *  allreduces for deeper layers are still in flight.
+   *
+   *  With --pipelined_weight_updates, fused GPU optimization steps
+   *  run on a side stream in forward order, one weights object at a
+   *  time. Each layer's forward prop only waits for the steps of its
+   *  own weights, so the first layers of the next step overlap with
+   *  the steps of deeper layers' weights. The weight optimize-end
+   *  callbacks run once the model waits for the step.
+   */
   virtual void update_weights();
+  /** @brief Apply optimization steps deferred by @c update_weights.
+   *
+   *  Must be called before weight values are accessed outside of
+   *  forward prop, e.g. before checkpointing or at the end of an
+   *  epoch.
+   */
+  virtual void apply_pending_weight_updates();
   /** @brief Update layers step. */
   virtual bool update_layers();
   /** @brief Reconcile weight values.
@@ -462,6 +565,203 @@ private:
    */
   bool m_model_is_setup = false;
 
+  /** @brief Range of layers whose outputs are freed after forward
+   *  prop and recomputed during backprop.
+   *  @details The outputs of the last layer in the range are kept.
+   */
+  struct recompute_segment {
+    /** @brief Index of the first layer. Its inputs are kept. */
+    El::Int first;
+    /** @brief Whether the outputs were freed in the last training
+     *  forward prop. */
+    bool released;
+  };
+  /** @brief Activation recomputation segments, keyed by the index of
+   *  their last layer. */
+  std::map<El::Int, recompute_segment> m_recompute_segments;
+
+  /** @brief Whether each weights object had an optimizer when
+   *  @c update_backprop_layers last ran. */
+  std::vector<bool> m_optimized_weights;
+  /** @brief Index of the first layer that needs backprop.
+   *  @details Backprop stops after this layer. Equal to the number
+   *  of layers if no layer needs backprop and negative if the layers
+   *  have not been marked yet.
+   */
+  El::Int m_first_backprop_layer = -1;
+
+  /** @brief Memory shared by planned activations and error signals.
+   *  @details See @c setup_activation_memory_plan. Not copied with
+   *  the model.
+   */
+  El::Matrix<DataType, El::Device::CPU> m_tensor_arena_cpu;
+#ifdef LBANN_HAS_GPU
+  /** @brief GPU memory shared by planned activations and error
+   *  signals. */
+  El::Matrix<DataType, El::Device::GPU> m_tensor_arena_gpu;
+#endif // LBANN_HAS_GPU
+
+  /** @brief Weights whose optimization step has been deferred.
+   *  @details See @c update_weights.
+   */
+  std::unordered_set<weights*> m_pending_weight_updates;
+
+  /** @brief Whether gradient allreduces are deferred to a later
+   *  backprop.
+   *  @details See @c set_gradient_allreduces_deferred.
+   */
+  bool m_gradient_allreduces_deferred = false;
+
+#ifdef LBANN_HAS_GPU
+  /** @brief CUDA graph of a training step.
+   *  @details See @c forward_backward_prop_with_graph. Not copied
+   *  with the model.
+   */
+  struct training_graph_state {
+    /** @brief Whether the model has been checked for support. */
+    bool checked = false;
+    /** @brief Whether training steps use the graph. */
+    bool enabled = false;
+    /** @brief Number of leading layers that run eagerly. */
+    El::Int num_eager_layers = 0;
+    /** @brief Eager steps left before the first capture. */
+    El::Int warmup_steps = 0;
+    /** @brief Mini-batch size of the captured graph.
+     *  @details Zero if the graph must be recaptured.
+     */
+    El::Int mini_batch_size = 0;
+    /** @brief Gradient status of each optimizer after the captured
+     *  backprop. */
+    std::vector<std::pair<optimizer*, optimizer_gradient_status>> gradient_status;
+    /** @brief Captured layers. */
+    cuda::graph_wrapper graph;
+  };
+  training_graph_state m_training_graph;
+
+  /** @brief Optimization steps launched on the side stream.
+   *  @details See @c update_weights. Not copied with the model.
+   */
+  struct weight_update_pipeline {
+    /** @brief Marks when a gradient is ready on the main stream. */
+    cuda::event_wrapper gradient_ready;
+    /** @brief Completion of each weights object's last step. */
+    std::unordered_map<weights*, cuda::event_wrapper> step_done;
+    /** @brief Weights whose step has not been waited for. */
+    std::unordered_set<weights*> in_flight;
+  };
+  weight_update_pipeline m_weight_update_pipeline;
+#endif // LBANN_HAS_GPU
+
+  /** @brief Forward and backward prop on the layers captured by
+   *  @c forward_backward_prop_with_graph. */
+  void forward_backward_prop_graph_layers();
+
+  /** @brief Concurrent execution of independent layers.
+   *  @details See @c setup_parallel_layer_execution. Not copied with
+   *  the model.
+   */
+  struct parallel_execution_state {
+    /** @brief Layers that wait for each layer in forward prop. */
+    std::map<El::Int,std::set<El::Int>> fp_edges;
+    /** @brief Layers that wait for each layer in backprop. */
+    std::map<El::Int,std::set<El::Int>> bp_edges;
+    /** @brief OpenMP threads used by each worker thread. */
+    int omp_threads = 1;
+    /** @brief Seed for the worker threads' random number
+     *  generators. */
+    size_t seed = 0;
+    /** @brief Number of worker threads that have been initialized. */
+    std::atomic<int> num_initialized_workers{0};
+    /** @brief Worker threads. */
+    thread_pool pool;
+  };
+  std::unique_ptr<parallel_execution_state> m_parallel_execution;
+
+  /** @brief Packed evaluation layer values and their reduction.
+   *  @details See @c reduce_evaluation_values. Not copied with the
+   *  model.
+   */
+  struct evaluation_reduction_state {
+    /** @brief Layers whose values are packed in @c values. */
+    std::vector<evaluation_partial_value*> layers;
+    /** @brief Values being summed over the trainer. */
+    std::vector<EvalType> values;
+    /** @brief Non-blocking allreduce request. */
+    Al::request req;
+    /** @brief Whether an allreduce has been launched. */
+    bool in_progress = false;
+  };
+  evaluation_reduction_state m_evaluation_reduction;
+
+  /** @brief Evaluation layers with values to reduce. */
+  std::vector<evaluation_partial_value*> get_partial_evaluation_values();
+  /** @brief Pack the pending evaluation layer values and launch a
+   *  non-blocking allreduce.
+   *
+   *  Called after forward prop so the reduction overlaps with
+   *  backprop. Does nothing if some value is still being copied from
+   *  a GPU, since waiting for it would stall the host; those are
+   *  reduced when first requested.
+   */
+  void start_evaluation_reduction();
+
+  /** @brief Run independent layers concurrently.
+   *
+   *  Enabled with --parallel_layer_execution. Each layer waits for
+   *  its parents in forward prop and for its children in backprop.
+   *  Layers that share weights, and input layers, keep their order
+   *  in sequential execution. Ready layers are dispatched to a pool
+   *  of worker threads, one per independent branch up to the
+   *  hardware concurrency, which split the OpenMP threads between
+   *  them.
+   *
+   *  Only models with CPU layers and one process per trainer are
+   *  supported: GPU layers share a single CUDA stream, and
+   *  collectives from concurrent layers could be matched in
+   *  different orders on different processes. Activation
+   *  recomputation and activation memory plans assume sequential
+   *  execution, so they are not supported either.
+   */
+  void setup_parallel_layer_execution();
+  /** @brief Apply a function to each layer once the layers it waits
+   *  for have finished.
+   *
+   *  @param edges          Layers that wait for each layer.
+   *  @param reverse_order  Whether ready layers later in the
+   *                        execution order are dispatched first.
+   *  @param func           Function applied to each layer on a
+   *                        worker thread.
+   */
+  void run_layers_concurrently(const std::map<El::Int,std::set<El::Int>>& edges,
+                               bool reverse_order,
+                               const std::function<void(Layer&)>& func);
+
+  /** @brief Apply a deferred optimization step, if any.
+   *  @details Also makes the main stream wait for the weights'
+   *  pipelined step, if any.
+   */
+  void apply_pending_weight_update(weights& w);
+
+  /** @brief Whether some optimization step is deferred or in flight. */
+  bool has_pending_weight_updates() const;
+
+  /** @brief Optimization steps with the side stream.
+   *  @details See @c update_weights.
+   */
+  void pipeline_weight_updates();
+
+  /** @brief Mark the layers that need backprop.
+   *
+   *  A layer needs backprop if it has weights with an optimizer or
+   *  if one of its parents needs backprop. Layers are only marked
+   *  again when the set of weights with an optimizer changes
+   *  (e.g. when weights are frozen or unfrozen), so this is cheap to
+   *  call before every backprop.
+   *
+   *  @returns Whether the marks changed.
+   */
+  bool update_backprop_layers();
+
   // ===========================================
   // Functions to add utility layers
   // ===========================================
@@ -498,6 +798,93 @@ private:
    *                        newly created layers.
    */
   void add_split_layers(std::unordered_set<std::string>& layer_names);
+  /** @brief Compute cross entropy losses from logits.
+   *
+   *  Cross entropy layers whose predictions come from an
+   *  instance-wise softmax layer take the softmax input instead and
+   *  fuse softmax into the loss. Softmax layers without other
+   *  children are removed. Enabled with
+   *  --fuse_softmax_cross_entropy.
+   */
+  void fuse_softmax_cross_entropy_layers();
+  /** @brief Look up one-hot vectors instead of multiplying them.
+   *
+   *  A data-parallel fully-connected layer without bias or transposed
+   *  weights whose input is a one-hot layer is replaced by an
+   *  embedding layer, which gathers columns of the same linearity
+   *  weights and updates only those columns in backprop. A reshape
+   *  layer with the fully-connected layer's name restores its output
+   *  dimensions. One-hot layers without other children are removed.
+   *  Enabled with --fuse_one_hot_fully_connected.
+   */
+  void fuse_one_hot_fully_connected_layers(
+    std::unordered_set<std::string>& layer_names);
+  /** @brief Read crop windows directly in concatenation.
+   *
+   *  A crop layer whose only child is a data-parallel concatenate
+   *  layer, and whose crop position comes from a constant layer
+   *  (e.g. the center crops of U-Net skip connections), is removed.
+   *  The concatenate layer reads the crop window from the crop
+   *  layer's input with strided accesses and writes the error signal
+   *  back into it (see concatenate_layer::set_input_crop), so the
+   *  cropped tensor is never stored. Constant layers without other
+   *  children are removed. Enabled with --fuse_crop_concatenate.
+   */
+  void fuse_crop_concatenate_layers();
+  /** @brief Let entry-wise binary layers broadcast small inputs.
+   *
+   *  A tessellate layer whose parent and child have no other
+   *  connections, and whose child is an entry-wise binary layer with
+   *  a data-parallel layout, is removed. Its child then reads the
+   *  untessellated tensor directly (see @c broadcast_map). Constant
+   *  layers whose children are all such binary layers only output
+   *  one entry per sample. Enabled with --lazy_broadcast.
+   */
+  void setup_lazy_broadcasts();
+  /** @brief Fold layer sequences that only need inference.
+   *
+   *  Convolution layers followed by batch normalization, and
+   *  optionally ReLU, apply both in their forward prop. Chains of
+   *  entry-wise layers are replaced by a @c fused_entrywise_layer.
+   *  The folded layers are removed. Enabled with
+   *  --fuse_inference_layers. The resulting model cannot be trained.
+   */
+  void fuse_inference_layers(size_t max_mini_batch_size,
+                             DataReaderMetaData& dr_metadata);
+  /** @brief Choose layers whose outputs are recomputed in backprop.
+   *
+   *  Consecutive layers flagged with @c recompute_activations in the
+   *  prototext form segments. With --recompute_memory_budget_mb,
+   *  segments of about @f$ \sqrt{N} @f$ layers are also chosen,
+   *  largest first, until the kept activations are expected to fit
+   *  in the budget. A segment may only contain layers that can be
+   *  recomputed and its layers, except the last, may only feed
+   *  layers in the segment.
+   */
+  void setup_activation_recomputation(size_t max_mini_batch_size);
+  /** @brief Choose layers that overwrite their parent's output.
+   *
+   *  Enabled with --in_place_activations. A layer runs in place if it
+   *  supports it, it is the only child of its parent, and its parent
+   *  does not use its outputs in backprop. Layers that use distconv
+   *  or recompute activations, or whose parents do, are left alone.
+   */
+  void setup_in_place_layers();
+  /** @brief Assign activations and error signals to shared memory.
+   *
+   *  Tensor lifetimes follow the layer execution order of a training
+   *  step: the outputs of layer @f$ i @f$ live from its forward prop
+   *  until its backprop, and the error signals it sends to a parent
+   *  live until the parent's backprop. Tensors whose lifetimes do not
+   *  overlap are placed at overlapping offsets of one arena per
+   *  device, using a greedy best-fit over tensors sorted by size.
+   *
+   *  Tensors that are views, belong to input layers or recomputed
+   *  layers, or use distconv are left alone. Callbacks that inspect
+   *  activations after a layer's backprop (e.g. at the end of a
+   *  mini-batch) may see memory that has been reused.
+   */
+  void setup_activation_memory_plan();
 
 #ifdef LBANN_HAS_DISTCONV
   void setup_distconv();
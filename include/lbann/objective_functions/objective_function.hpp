@@ -75,14 +75,50 @@ class objective_function {
 
   /** Compute the objective function gradient.
    *  The gradient is with respect to the objective function inputs
+   *  and is multiplied by scale, e.g. to average gradients that are
+   *  accumulated over micro-batches. The weight regularization
+   *  gradient is not affected.
    */
-  void differentiate();
+  void differentiate(EvalType scale = EvalType(1));
 
   /** Compute the gradient of the weight regularization term.
    *  The gradient is computed w.r.t. the weights.
    */
   void compute_weight_regularization();
 
+  /** Set the loss scale.
+   *  The objective function gradient is multiplied by the loss scale
+   *  so that small reduced-precision gradients do not underflow.
+   *  unscale_gradients must be called on the weights gradients
+   *  before the optimization step.
+   */
+  void set_loss_scale(EvalType scale);
+  /** Get the loss scale. */
+  EvalType get_loss_scale() const { return m_loss_scale; }
+  /** Adjust the loss scale during training.
+   *  If the unscaled gradients have infinite or NaN entries, the
+   *  loss scale is multiplied by backoff_factor. It is multiplied by
+   *  growth_factor after growth_interval consecutive steps without
+   *  overflow.
+   */
+  void set_dynamic_loss_scaling(EvalType growth_factor = 2,
+                                EvalType backoff_factor = 0.5,
+                                El::Int growth_interval = 2000);
+  /** Whether the gradient is being computed with a loss scale. */
+  bool using_loss_scaling() const {
+    return m_dynamic_loss_scaling || m_loss_scale != EvalType(1);
+  }
+  /** Remove the loss scale from a model's weights gradients.
+   *  Gradients are scaled and checked for infinite and NaN entries
+   *  with a handful of fused kernels (see gradient_unscale_queue).
+   *  With dynamic loss scaling, the loss scale is updated.
+   *  @returns Whether all gradients in the trainer are finite. If
+   *  not, the optimization step should be skipped.
+   */
+  bool unscale_gradients(model& m);
+  /** Number of optimization steps skipped due to overflow. */
+  El::Int get_num_skipped_steps() const { return m_num_skipped_steps; }
+
   /** Clear all statistics. */
   void reset_statistics() { m_statistics.clear(); }
   /** Clear statistics for an execution mode. */
@@ -128,6 +164,21 @@ class objective_function {
   /** Time spent computing the objective function gradient. */
   EvalType m_differentiation_time = EvalType(0);
 
+  /** Factor applied to the objective function gradient. */
+  EvalType m_loss_scale = EvalType(1);
+  /** Whether the loss scale is adjusted during training. */
+  bool m_dynamic_loss_scaling = false;
+  /** Loss scale multiplier after enough steps without overflow. */
+  EvalType m_loss_scale_growth_factor = EvalType(2);
+  /** Loss scale multiplier after an overflow. */
+  EvalType m_loss_scale_backoff_factor = EvalType(0.5);
+  /** Steps without overflow before the loss scale is increased. */
+  El::Int m_loss_scale_growth_interval = 2000;
+  /** Consecutive steps without overflow. */
+  El::Int m_num_good_steps = 0;
+  /** Number of optimization steps skipped due to overflow. */
+  El::Int m_num_skipped_steps = 0;
+
 };
 
 } // namespace lbann
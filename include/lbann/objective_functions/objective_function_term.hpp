@@ -84,10 +84,19 @@ class objective_function_term {
   /** Set list of pointers to weights. */
   void set_weights_pointers(std::vector<weights*> w) { m_weights = w; }
 
+  /** Set loss scale.
+   *  Gradients computed in differentiate and
+   *  compute_weight_regularization are multiplied by the loss
+   *  scale. The objective function value is not.
+   */
+  void set_loss_scale(EvalType scale) { m_loss_scale = scale; }
+
  protected:
 
   /** Scaling factor for objective function term. */
   EvalType m_scale_factor;
+  /** Additional scaling factor for the term's gradients. */
+  EvalType m_loss_scale = EvalType(1);
 
   /** Layers used to compute objective function term. */
   std::vector<Layer*> m_layers;
@@ -40,6 +40,16 @@ template <typename> class data_type_weights;
  *  Given a weights tensor @f$ w @f$,
  *  @f[ L2(w) = \frac{1}{2} \sum\limits_{i} w(i)^2 @f]
  *  Note the @f$ 1/2 @f$ scaling factor.
+ *
+ *  In decoupled mode, the gradient term is replaced by a decoupled
+ *  weight decay that the optimizers apply inside their step (see
+ *  @c data_type_optimizer::set_weight_decay). This saves a pass over
+ *  the weights each step. Note that it only matches the coupled
+ *  form for SGD without momentum.
+ *
+ *  The value of the term can be computed every few steps instead of
+ *  every step, in which case the last computed value is reused in
+ *  between. It is only used for reporting the objective function.
  */
 class l2_weight_regularization : public objective_function_term {
 public:
@@ -59,6 +69,15 @@ public:
    *                        @f$ \text{scale\_factor} \times \sum L2(w_i) @f$
    */
   l2_weight_regularization(EvalType scale_factor = 1);
+  /** @param scale_factor          See above.
+   *  @param decoupled             Apply the term as a decoupled
+   *                               weight decay in the optimizers.
+   *  @param evaluation_interval   Compute the value every this many
+   *                               evaluations. Zero is treated as one.
+   */
+  l2_weight_regularization(EvalType scale_factor,
+                           bool decoupled,
+                           El::Int evaluation_interval);
   l2_weight_regularization* copy() const override { return new l2_weight_regularization(*this); }
   std::string name() const override { return "L2 weight regularization"; }
   void setup(model& m) override;
@@ -82,6 +101,17 @@ public:
 
 private:
 
+  /** Whether the optimizers apply the term as a weight decay. */
+  bool m_decoupled = false;
+  /** Number of evaluations between computations of the value. */
+  El::Int m_evaluation_interval = 1;
+  /** Number of evaluations so far. */
+  El::Int m_evaluation_count = 0;
+  /** Whether the current evaluation computes the value. */
+  bool m_evaluating = true;
+  /** Last computed value. */
+  EvalType m_last_value = 0;
+
   /** Contributions to evaluated value. */
   std::map<El::Device, CPUMatType> m_contributions;
 
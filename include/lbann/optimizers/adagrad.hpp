@@ -84,6 +84,11 @@ protected:
   /** Computation for an optimization step. */
   void step_compute(AbsDistMatrixType& values, const AbsDistMatrixType& gradient) override;
 
+  /** Optimizer state for lazy sparse steps. */
+  std::vector<std::unique_ptr<AbsDistMatrixType>*> get_state_matrices() override {
+    return {&m_cache};
+  }
+
 private:
 
   /** Small factor to avoid division by zero. */
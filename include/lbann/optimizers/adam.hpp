@@ -154,6 +154,14 @@ protected:
   void step_compute(AbsDistMatrixType& values,
                     const AbsDistMatrixType& gradient) override;
 
+  /** Optimizer state for lazy sparse steps. */
+  std::vector<std::unique_ptr<AbsDistMatrixType>*> get_state_matrices() override {
+    return {&m_moment1, &m_moment2};
+  }
+
+  /** The step kernels apply the weight decay. */
+  bool fuses_weight_decay() const override { return true; }
+
 private:
 
   /** Update factor for first moment estimate. */
@@ -28,6 +28,9 @@
 #define LBANN_OPTIMIZERS_DATA_TYPE_OPTIMIZER_HPP_INCLUDED
 
 #include "lbann/optimizers/optimizer.hpp"
+#include "lbann/optimizers/gradient_bucket.hpp"
+#include "lbann/optimizers/gradient_compressor.hpp"
+#include "lbann/optimizers/sparse_gradient.hpp"
 
 namespace lbann {
 
@@ -46,6 +49,9 @@ public:
   /** @brief The tensor type expected in this object. */
   using AbsDistMatrixType = El::AbstractDistMatrix<TensorDataType>;
 
+  /** @brief The local tensor type expected in this object. */
+  using AbsMatrixType = El::AbstractMatrix<TensorDataType>;
+
   /** @brief The concrete weights type used by this object. */
   using WeightsType = data_type_weights<TensorDataType>;
 
@@ -72,6 +78,8 @@ public:
   /** @brief Human-readable description. */
   virtual description get_description() const override;
 
+  size_t get_memory_usage(El::Device device) const override;
+
   /** @brief Weights being optimized. */
   data_type_weights<TensorDataType>& get_weights();
   /** @brief Weights being optimized. */
@@ -81,7 +89,9 @@ public:
 
   /** @brief Objective function gradient w.r.t. the weights.
    *
-   *  An allreduce may be launched and/or synchronized if needed.
+   *  An allreduce may be launched and/or synchronized if needed. If
+   *  the optimizer state is sharded, this is only this rank's shard
+   *  of the gradient (see @c get_optimizer_state_sharded).
    */
   AbsDistMatrixType& get_gradient();
 
@@ -100,6 +110,32 @@ public:
   void add_to_gradient(const AbsDistMatrixType& gradient,
                        TensorDataType scale = TensorDataType(1),
                        bool allreduce_needed = false);
+  /** @brief Add a column-sparse contribution to the gradient.
+   *
+   *  Meant for gradients that are nonzero in a few columns of a large
+   *  matrix, e.g. embedding tables. If only sparse contributions are
+   *  added before the optimization step, the step is lazy: the
+   *  values and optimizer state (e.g. momentum, Adam moments) of
+   *  untouched columns are left as they are. Otherwise the sparse
+   *  contributions are added to the dense gradient first. Sparse
+   *  contributions are not included in @c get_gradient.
+   *
+   *  @param cols             Local column index of each column in
+   *                          @c gradient. Indices may repeat.
+   *  @param gradient         Local matrix with the contributions to
+   *                          the @c cols columns of the gradient. It
+   *                          must be on the same device as the
+   *                          weights values.
+   *  @param scale            Scaling factor for gradient contribution.
+   *  @param allreduce_needed Whether the contribution must be summed
+   *                          over the redundant communicator. If so,
+   *                          this is done immediately with allgathers
+   *                          of the nonzero columns.
+   */
+  void add_to_sparse_gradient(const std::vector<El::Int>& cols,
+                              const AbsMatrixType& gradient,
+                              TensorDataType scale = TensorDataType(1),
+                              bool allreduce_needed = false);
   /** @brief Zero out the objective function gradient w.r.t. the weights. */
   void clear_gradient() override;
   /** @brief Get the gradient buffer.
@@ -138,18 +174,70 @@ public:
    *  When an object adds its contribution to the objective function
    *  gradient during back prop, it should unregister itself. If there
    *  are no more gradient sources remaining, a non-blocking allreduce
-   *  will be launched on the gradient, if needed.
+   *  will be launched on the gradient, if needed and not deferred.
    */
   void remove_gradient_source(const void* source) override;
 
-  /** @brief Optimization step. */
+  /** @brief Hold back the gradient allreduce when the last gradient
+   *  source is removed.
+   *
+   *  Disabling deferral launches any allreduce that was held back.
+   */
+  void set_gradient_allreduce_deferred(bool defer) override;
+
+  /** @brief Optimization step.
+   *
+   *  If the weights keep fp32 master values (see
+   *  @c data_type_weights::has_master_weights), the step is computed
+   *  in single precision by the master weights' optimizer and the
+   *  result is rounded into the weights values.
+   */
   void step() override;
 
+  void enqueue_gradient_unscaling() override;
+
+  /** @brief Lossy compression for the gradient allreduce.
+   *
+   *  If set, the gradient is summed with the compressor instead of
+   *  an allreduce (and is not added to a gradient bucket).
+   */
+  void set_gradient_compressor(std::unique_ptr<gradient_compressor<TensorDataType>> compressor) {
+    m_gradient_compressor = std::move(compressor);
+  }
+
+  /** @brief Whether each rank only owns a shard of the optimizer state.
+   *
+   *  Set with --shard_optimizer_state for weights that are replicated
+   *  over the trainer. The local values and gradient are flattened
+   *  and each of the P ranks owns a contiguous 1/P of them (the
+   *  remainder of fewer than P entries is owned by every rank). The
+   *  gradient allreduce becomes a reduce-scatter, derived optimizers
+   *  allocate their state and compute their step on the local shard
+   *  only, and the values are allgathered after the step.
+   *
+   *  Shared checkpoints only contain the master's shard, so sharded
+   *  optimizers should be checkpointed with distributed checkpoints.
+   */
+  bool get_optimizer_state_sharded() const noexcept {
+    return m_gradient_shard != nullptr;
+  }
+
   /** @brief Scaling factor for optimization step sizes. */
   TensorDataType get_learning_rate() const;
   /** @brief Scaling factor for optimization step sizes. */
   void set_learning_rate(TensorDataType learning_rate);
 
+  /** @brief Decoupled weight decay.
+   *
+   *  Each step also applies @f$ w \leftarrow w - \eta\lambda w @f$,
+   *  where @f$\eta@f$ is the learning rate and @f$\lambda@f$ is the
+   *  decay. Unlike an L2 term in the objective function, this does
+   *  not touch the gradient (see @c l2_weight_regularization).
+   */
+  TensorDataType get_weight_decay() const noexcept { return m_weight_decay; }
+  /** @brief Decoupled weight decay. */
+  void set_weight_decay(TensorDataType decay) { m_weight_decay = decay; }
+
 protected:
 
   /** @brief Computation for an optimization step.
@@ -160,6 +248,22 @@ protected:
   virtual void step_compute(AbsDistMatrixType& values,
                             const AbsDistMatrixType& gradient) = 0;
 
+  /** @brief Optimizer state with the same shape as the weights.
+   *
+   *  A lazy sparse step temporarily swaps these matrices with
+   *  matrices holding only the touched columns and calls
+   *  @c step_compute.
+   */
+  virtual std::vector<std::unique_ptr<AbsDistMatrixType>*> get_state_matrices() = 0;
+
+  /** @brief Whether @c step_compute applies the decoupled weight
+   *  decay itself.
+   *
+   *  If not, the values are scaled in a separate pass before
+   *  @c step_compute.
+   */
+  virtual bool fuses_weight_decay() const { return false; }
+
 private:
 
   /** @brief Weights being optimized. */
@@ -182,6 +286,46 @@ private:
    */
   Al::request m_gradient_allreduce_req;
 
+  /** @brief Fused allreduce holding the gradient, if any.
+   *
+   *  Set while the gradient allreduce is in progress and the
+   *  gradient is packed with others (see @c gradient_bucket).
+   */
+  std::shared_ptr<gradient_bucket<TensorDataType>> m_gradient_bucket;
+  /** @brief Position of the gradient in @c m_gradient_bucket. */
+  El::Int m_gradient_bucket_offset = 0;
+  /** @brief Capacity of gradient buckets in bytes.
+   *
+   *  Set with --gradient_bucket_mb (default 25). Gradients at least
+   *  this large are allreduced on their own. Zero disables fusion.
+   */
+  size_t m_gradient_bucket_capacity = 0;
+
+  /** @brief Lossy compression for the gradient allreduce, if any. */
+  std::unique_ptr<gradient_compressor<TensorDataType>> m_gradient_compressor;
+
+  /** @brief Column-sparse contributions to the gradient, if any. */
+  std::unique_ptr<sparse_gradient<TensorDataType>> m_sparse_gradient;
+
+  /** @brief Single-process grid for the shard matrices and for the
+   *  touched columns in sparse steps.
+   */
+  std::shared_ptr<El::Grid> m_shard_grid;
+  /** @brief This rank's shard of the gradient, if sharded. */
+  std::unique_ptr<AbsDistMatrixType> m_gradient_shard;
+  /** @brief This rank's shard of the weights values, if sharded. */
+  std::unique_ptr<AbsDistMatrixType> m_values_shard;
+  /** @brief Number of entries owned by a single rank. */
+  El::Int m_shard_block_size = 0;
+  /** @brief Number of trailing entries owned by every rank. */
+  El::Int m_shard_tail_size = 0;
+  /** @brief Whether @c m_gradient_shard supersedes @c m_gradient.
+   *
+   *  After the reduce-scatter, @c m_gradient still holds the local
+   *  contribution.
+   */
+  bool m_gradient_in_shard = false;
+
   /** @brief Scaling factor for optimization step sizes.
    *
    *  This is not used by the base optimizer class, but is currently
@@ -192,10 +336,20 @@ private:
    */
   TensorDataType m_learning_rate;
 
+  /** @brief Decoupled weight decay. */
+  TensorDataType m_weight_decay = TensorDataType(0);
+
+  /** @brief @c step_compute, preceded by the decoupled weight decay
+   *  if @c step_compute does not apply it.
+   */
+  void apply_step(AbsDistMatrixType& values,
+                  const AbsDistMatrixType& gradient);
+
   /** @brief Launch non-blocking allreduce on the gradient, if needed.
    *
    *  Does nothing if an allreduce is not needed or has already been
-   *  started.
+   *  started. Small gradients are added to a gradient bucket, whose
+   *  fused allreduce is launched once it fills up.
    */
   void start_gradient_allreduce();
 
@@ -205,6 +359,24 @@ private:
    *  if an allreduce is needed but hasn't been started.
    */
   void finish_gradient_allreduce();
+
+  /** @brief Optimization step on the columns of the sparse gradient. */
+  void sparse_step();
+  /** @brief Copy the gradient to the master weights' optimizer.
+   *
+   *  Sparse contributions are included. Does nothing if the master
+   *  gradient has already been set since it was last cleared.
+   */
+  void load_master_gradient();
+
+  /** @brief Sum the gradient into the local shards. */
+  void reduce_scatter_gradient();
+  /** @brief Reconstruct the full gradient from the shards. */
+  void all_gather_gradient();
+  /** @brief Copy this rank's part of the weights values to its shard. */
+  void copy_values_to_shard();
+  /** @brief Reconstruct the full weights values from the shards. */
+  void all_gather_values();
 };
 
 #ifndef LBANN_DATA_TYPE_OPTIMIZER_INSTANTIATE
@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_OPTIMIZERS_FUSED_STEP_HPP_INCLUDED
+#define LBANN_OPTIMIZERS_FUSED_STEP_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+#include <vector>
+
+namespace lbann {
+
+/** @brief Update rule applied by a fused optimization step. */
+enum class fused_step_kind {
+  momentum,
+  nesterov,
+  adam,
+  adagrad,
+  rmsprop
+};
+
+/** @brief Local data and hyperparameters for one weights tensor.
+ *
+ *  The meaning of the hyperparameters depends on the update rule:
+ *  @c learning_rate is the bias-corrected step size for Adam and
+ *  @c hyper1 is the momentum, Adam's @f$\beta_1@f$, or RMSprop's
+ *  decay rate. @c hyper2 is Adam's @f$\beta_2@f$. Each value @f$x@f$
+ *  is also decreased by @c decay @f$\times x@f$.
+ */
+template <typename TensorDataType>
+struct fused_step_tensor {
+  TensorDataType* values;
+  const TensorDataType* gradient;
+  TensorDataType* state1;
+  TensorDataType* state2;
+  size_t size;
+  TensorDataType learning_rate;
+  TensorDataType hyper1;
+  TensorDataType hyper2;
+  TensorDataType eps;
+  /** Decoupled weight decay times the learning rate. */
+  TensorDataType decay;
+};
+
+/** @brief Deferred GPU optimization steps.
+ *
+ *  Launching one kernel per weights object is dominated by launch
+ *  overhead for models with many small tensors. With
+ *  --fused_optimizer_step, GPU optimizers with contiguous local
+ *  matrices enqueue their tensors here instead. @c flush applies
+ *  every queued step with a handful of kernel launches, each of which
+ *  processes a table of tensors passed as a kernel argument.
+ *
+ *  Queued steps read the values, gradient, and optimizer state when
+ *  the queue is flushed, so these must not be modified in between.
+ */
+template <typename TensorDataType>
+class fused_step_queue {
+public:
+  using TensorType = fused_step_tensor<TensorDataType>;
+
+  /** @brief Queue an optimization step. */
+  static void enqueue(fused_step_kind kind, const TensorType& tensor);
+
+#ifdef LBANN_HAS_CUDA
+  /** @brief Launch kernels for all queued optimization steps. */
+  static void flush(cudaStream_t stream = El::GPUManager::Stream());
+#endif // LBANN_HAS_CUDA
+
+private:
+  static std::vector<TensorType>& get_queue(fused_step_kind kind);
+};
+
+/** @brief Whether GPU optimizers should use @c fused_step_queue.
+ *  @details True with --fused_optimizer_step or
+ *  --pipelined_weight_updates.
+ */
+bool use_fused_optimizer_step();
+
+/** @brief Apply all queued fused optimization steps. */
+void flush_fused_optimizer_steps();
+
+#ifdef LBANN_HAS_CUDA
+/** @brief Apply all queued fused optimization steps on a stream.
+ *
+ *  The caller must make @c stream wait for the gradients, and make
+ *  later users of the weights wait for @c stream.
+ */
+void flush_fused_optimizer_steps(cudaStream_t stream);
+#endif // LBANN_HAS_CUDA
+
+#if defined(LBANN_HAS_CUDA) && !defined(LBANN_FUSED_STEP_INSTANTIATE)
+#define PROTO(T)                            \
+  extern template class fused_step_queue<T>
+
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+#undef PROTO
+#undef LBANN_INSTANTIATE_GPU_HALF
+#endif // LBANN_HAS_CUDA && !LBANN_FUSED_STEP_INSTANTIATE
+
+} // namespace lbann
+
+#endif // LBANN_OPTIMIZERS_FUSED_STEP_HPP_INCLUDED
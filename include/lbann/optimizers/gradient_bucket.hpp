@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_OPTIMIZERS_GRADIENT_BUCKET_HPP_INCLUDED
+#define LBANN_OPTIMIZERS_GRADIENT_BUCKET_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+#include "lbann/comm.hpp"
+#include <memory>
+#include <vector>
+
+namespace lbann {
+
+/** @brief Fused allreduce over several weights gradients.
+ *
+ *  Gradients that share a redundant communicator and a device are
+ *  appended to an open bucket as they become ready during back
+ *  prop. Once the bucket holds at least its capacity in bytes, the
+ *  local matrices are packed into one contiguous buffer and a single
+ *  non-blocking allreduce is launched. Since back prop finishes
+ *  gradients from the last layer to the first, buckets are filled in
+ *  reverse layer order.
+ *
+ *  Every rank in the redundant communicator must enqueue the same
+ *  gradients in the same order, which holds as long as they execute
+ *  the same model.
+ */
+template <typename TensorDataType>
+class gradient_bucket {
+public:
+  using AbsDistMatrixType = El::AbstractDistMatrix<TensorDataType>;
+  using AbsMatrixType = El::AbstractMatrix<TensorDataType>;
+
+  gradient_bucket(const El::mpi::Comm& comm, El::Device device);
+  gradient_bucket(const gradient_bucket&) = delete;
+  gradient_bucket& operator=(const gradient_bucket&) = delete;
+  ~gradient_bucket() = default;
+
+  /** @brief Add a gradient to the open bucket for its communicator.
+   *
+   *  The bucket is launched if it reaches @c capacity bytes.
+   *
+   *  @param comm     LBANN communicator.
+   *  @param gradient Gradient matrix. It must stay alive and
+   *                  unmodified until @c unpack is called.
+   *  @param capacity Bucket size in bytes.
+   *  @param offset   Set to the gradient's position in the bucket.
+   *  @returns The bucket holding the gradient.
+   */
+  static std::shared_ptr<gradient_bucket> enqueue(lbann_comm& comm,
+                                                  const AbsDistMatrixType& gradient,
+                                                  size_t capacity,
+                                                  El::Int& offset);
+
+  /** @brief Copy the allreduced values back into a gradient.
+   *
+   *  Launches the allreduce if the bucket is still open and waits for
+   *  it to complete.
+   */
+  void unpack(lbann_comm& comm, AbsDistMatrixType& gradient, El::Int offset);
+
+  /** @brief Launch allreduces for all buckets that are still open. */
+  static void launch_all(lbann_comm& comm);
+
+private:
+
+  /** @brief Redundant communicator shared by all gradients. */
+  const El::mpi::Comm& m_comm;
+  /** @brief Device of the local gradient matrices. */
+  El::Device m_device;
+  /** @brief Gradients in the order they were enqueued. */
+  std::vector<const AbsDistMatrixType*> m_gradients;
+  /** @brief Number of entries of all enqueued local matrices. */
+  El::Int m_size = 0;
+  /** @brief Packed local matrices. */
+  std::unique_ptr<AbsMatrixType> m_buffer;
+  /** @brief Communication request for the fused allreduce. */
+  Al::request m_req;
+  bool m_launched = false;
+  bool m_finished = false;
+
+  /** @brief Pack the gradients and launch the allreduce. */
+  void launch(lbann_comm& comm);
+  /** @brief Synchronize the allreduce, if needed. */
+  void wait(lbann_comm& comm);
+
+};
+
+/** @brief Launch allreduces for all open gradient buckets.
+ *
+ *  Buckets are otherwise launched when they fill up or when one of
+ *  their gradients is accessed. Calling this once back prop is done
+ *  starts the allreduce for the first layers' gradients early.
+ */
+void launch_gradient_buckets(lbann_comm& comm);
+
+#ifndef LBANN_GRADIENT_BUCKET_INSTANTIATE
+#define PROTO(T)                           \
+  extern template class gradient_bucket<T>
+
+#define LBANN_INSTANTIATE_CPU_HALF
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+#undef PROTO
+#undef LBANN_INSTANTIATE_CPU_HALF
+#undef LBANN_INSTANTIATE_GPU_HALF
+#endif // LBANN_GRADIENT_BUCKET_INSTANTIATE
+
+} // namespace lbann
+
+#endif // LBANN_OPTIMIZERS_GRADIENT_BUCKET_HPP_INCLUDED
@@ -0,0 +1,175 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_OPTIMIZERS_GRADIENT_COMPRESSOR_HPP_INCLUDED
+#define LBANN_OPTIMIZERS_GRADIENT_COMPRESSOR_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+#include "lbann/comm.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lbann {
+
+/** @brief Lossy gradient summation with a compressed payload.
+ *
+ *  Replaces the gradient allreduce over a redundant communicator when
+ *  network bandwidth is the bottleneck. Each derived class defines an
+ *  encoding of the local gradient and how contributions from all
+ *  processes are summed. The result is identical on every process of
+ *  the redundant communicator.
+ *
+ *  The exchange is performed on a host copy of the local gradient
+ *  and is blocking.
+ */
+template <typename TensorDataType>
+class gradient_compressor {
+public:
+  using AbsDistMatrixType = El::AbstractDistMatrix<TensorDataType>;
+
+  virtual ~gradient_compressor() = default;
+  /** @brief Create a copy of the class instance.
+   *
+   *  The caller is responsible for deallocating the returned object.
+   */
+  virtual gradient_compressor* copy() const = 0;
+  /** @brief Human-readable type name. */
+  virtual std::string get_type() const = 0;
+
+  /** @brief Sum a gradient over its redundant communicator.
+   *
+   *  @returns Bytes this process did not send compared to an
+   *  uncompressed ring allreduce. Negative savings are reported as
+   *  zero.
+   */
+  size_t allreduce(lbann_comm& comm, AbsDistMatrixType& gradient);
+
+protected:
+  /** @brief Sum contiguous local values over a communicator.
+   *
+   *  @returns Bytes sent by this process.
+   */
+  virtual size_t allreduce_values(lbann_comm& comm,
+                                  const El::mpi::Comm& c,
+                                  std::vector<float>& values) = 0;
+
+private:
+  /** @brief Workspace for the host copy of the local gradient. */
+  std::vector<float> m_values;
+};
+
+/** @brief 16-bit floating point wire format.
+ *
+ *  Values are sent as IEEE half precision or bfloat16 in a ring
+ *  reduce-scatter followed by a ring allgather. Partial sums are
+ *  accumulated in single precision but re-encoded at every hop.
+ */
+template <typename TensorDataType>
+class half_precision_compressor : public gradient_compressor<TensorDataType> {
+public:
+  /** @param bfloat16 Send bfloat16 instead of IEEE half precision. */
+  half_precision_compressor(bool bfloat16) : m_bfloat16(bfloat16) {}
+  half_precision_compressor* copy() const override {
+    return new half_precision_compressor(*this);
+  }
+  std::string get_type() const override { return m_bfloat16 ? "bf16" : "fp16"; }
+protected:
+  size_t allreduce_values(lbann_comm& comm,
+                          const El::mpi::Comm& c,
+                          std::vector<float>& values) override;
+private:
+  bool m_bfloat16;
+  std::uint16_t encode(float x) const;
+  float decode(std::uint16_t x) const;
+};
+
+/** @brief Top-k sparsification with error feedback.
+ *
+ *  Only the entries with the largest magnitudes are sent, as
+ *  (index, value) pairs. Entries that are not sent are accumulated
+ *  into a local residual and added to the next gradient.
+ */
+template <typename TensorDataType>
+class topk_compressor : public gradient_compressor<TensorDataType> {
+public:
+  /** @param ratio Fraction of entries to send. */
+  topk_compressor(double ratio);
+  topk_compressor* copy() const override {
+    return new topk_compressor(*this);
+  }
+  std::string get_type() const override { return "top-k"; }
+protected:
+  size_t allreduce_values(lbann_comm& comm,
+                          const El::mpi::Comm& c,
+                          std::vector<float>& values) override;
+private:
+  double m_ratio;
+  /** @brief Error feedback. */
+  std::vector<float> m_residual;
+};
+
+/** @brief 1-bit sign compression with error feedback.
+ *
+ *  Each process sends the signs of its entries and a single scaling
+ *  factor, the mean magnitude. The quantization error is accumulated
+ *  into a local residual and added to the next gradient.
+ */
+template <typename TensorDataType>
+class sign_compressor : public gradient_compressor<TensorDataType> {
+public:
+  sign_compressor* copy() const override {
+    return new sign_compressor(*this);
+  }
+  std::string get_type() const override { return "sign"; }
+protected:
+  size_t allreduce_values(lbann_comm& comm,
+                          const El::mpi::Comm& c,
+                          std::vector<float>& values) override;
+private:
+  /** @brief Error feedback. */
+  std::vector<float> m_residual;
+};
+
+#ifndef LBANN_GRADIENT_COMPRESSOR_INSTANTIATE
+#define PROTO(T)                                        \
+  extern template class gradient_compressor<T>;         \
+  extern template class half_precision_compressor<T>;   \
+  extern template class topk_compressor<T>;             \
+  extern template class sign_compressor<T>
+
+#define LBANN_INSTANTIATE_CPU_HALF
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+#undef PROTO
+#undef LBANN_INSTANTIATE_CPU_HALF
+#undef LBANN_INSTANTIATE_GPU_HALF
+#endif // LBANN_GRADIENT_COMPRESSOR_INSTANTIATE
+
+} // namespace lbann
+
+#endif // LBANN_OPTIMIZERS_GRADIENT_COMPRESSOR_HPP_INCLUDED
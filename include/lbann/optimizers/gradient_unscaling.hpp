@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_OPTIMIZERS_GRADIENT_UNSCALING_HPP_INCLUDED
+#define LBANN_OPTIMIZERS_GRADIENT_UNSCALING_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+#include <vector>
+
+namespace lbann {
+
+/** @brief Deferred removal of the loss scale from gradients.
+ *
+ *  With loss scaling, the objective function gradient is multiplied
+ *  by a large factor so that small reduced-precision gradients do
+ *  not underflow. Before the optimization step, the weights
+ *  gradients are multiplied by the inverse of the loss scale and
+ *  checked for infinite and NaN entries, which indicate that the
+ *  scaled gradient overflowed.
+ *
+ *  Optimizers enqueue their local gradient matrices here and
+ *  @c flush processes all of them at once: CPU matrices with a
+ *  single OpenMP loop and GPU matrices with a handful of kernel
+ *  launches that each cover a table of matrices. Only a single flag
+ *  is copied back to the host.
+ */
+template <typename TensorDataType>
+class gradient_unscale_queue {
+public:
+  using MatrixType = El::AbstractMatrix<TensorDataType>;
+
+  /** @brief Queue a local gradient matrix. */
+  static void enqueue(MatrixType& gradient);
+
+  /** @brief Scale all queued matrices.
+   *  @returns Whether all of the scaled entries are finite.
+   */
+  static bool flush(TensorDataType scale);
+
+private:
+  static std::vector<MatrixType*>& get_queue(El::Device device);
+  static bool flush_cpu(std::vector<MatrixType*>& queue,
+                        TensorDataType scale);
+#ifdef LBANN_HAS_GPU
+  static bool flush_gpu(std::vector<MatrixType*>& queue,
+                        TensorDataType scale);
+#endif // LBANN_HAS_GPU
+};
+
+/** @brief Scale all queued gradients of every data type.
+ *  @returns Whether all of the local scaled entries are finite.
+ */
+bool flush_gradient_unscaling(EvalType scale);
+
+#ifndef LBANN_GRADIENT_UNSCALING_INSTANTIATE
+#define PROTO(T)                                  \
+  extern template class gradient_unscale_queue<T>
+
+#define LBANN_INSTANTIATE_CPU_HALF
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+#undef PROTO
+#undef LBANN_INSTANTIATE_CPU_HALF
+#undef LBANN_INSTANTIATE_GPU_HALF
+#endif // LBANN_GRADIENT_UNSCALING_INSTANTIATE
+
+} // namespace lbann
+
+#endif // LBANN_OPTIMIZERS_GRADIENT_UNSCALING_HPP_INCLUDED
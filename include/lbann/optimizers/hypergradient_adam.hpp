@@ -40,6 +40,14 @@ namespace lbann {
  *
  *  Baydin et al. "Online Learning Rate Adaptation with Hypergradient
  *  Descent", 2017.
+ *
+ *  On GPU, the learning rate lives in device memory. The hypergradient
+ *  dot product, its allreduce, the learning rate update and the Adam
+ *  step are all enqueued on the compute stream, so a step never waits
+ *  for the GPU. The host copy of the learning rate is refreshed when
+ *  it is reported or checkpointed. If it is changed on the host (e.g.
+ *  by a learning rate schedule), the new value is sent to the device
+ *  at the next step.
  */
 template <typename TensorDataType>
 class hypergradient_adam : public data_type_optimizer<TensorDataType> {
@@ -80,7 +88,7 @@ public:
                      TensorDataType eps = 1e-8);
   hypergradient_adam(const hypergradient_adam& other);
   hypergradient_adam& operator=(const hypergradient_adam& other);
-  ~hypergradient_adam() override = default;
+  ~hypergradient_adam() override;
   hypergradient_adam* copy() const override { return new hypergradient_adam(*this); }
 
     /** Archive for checkpoint and restart */
@@ -106,6 +114,14 @@ protected:
   /** @brief Computation for an optimization step. */
   void step_compute(AbsDistMatrixType& values, const AbsDistMatrixType& gradient) override;
 
+  /** @brief Latest learning rate, including device-side updates. */
+  TensorDataType get_current_learning_rate() const;
+
+  /** Optimizer state for lazy sparse steps. */
+  std::vector<std::unique_ptr<AbsDistMatrixType>*> get_state_matrices() override {
+    return {&m_moment1, &m_moment2, &m_old_gradient};
+  }
+
 private:
 
   /** @brief Hypergradient learning rate. */
@@ -127,6 +143,27 @@ private:
   /** @brief Gradient estimate from the prior step (for hypergradient). */
   std::unique_ptr<AbsDistMatrixType> m_old_gradient;
 
+#ifdef LBANN_HAS_CUDA
+  /** @brief Device learning rate followed by the hypergradient.
+   *  @details Allocated at the first GPU step.
+   */
+  TensorDataType* m_device_state = nullptr;
+  /** @brief Host learning rate last sent to the device. */
+  TensorDataType m_device_learning_rate_source = TensorDataType(0.);
+
+  /** @brief GPU implementation of optimization step. */
+  void step_compute_gpu(AbsDistMatrixType& values,
+                        const AbsDistMatrixType& gradient,
+                        const TensorDataType& correction);
+  /** @brief Read the device learning rate. */
+  TensorDataType get_device_learning_rate() const;
+  /** @brief Deallocate the device learning rate. */
+  void free_device_state();
+#endif // LBANN_HAS_CUDA
+
+  /** @brief Copy the latest learning rate to the host. */
+  void sync_learning_rate();
+
   // ===========================================
   // Checkpointing
   // ===========================================
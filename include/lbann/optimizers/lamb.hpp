@@ -0,0 +1,176 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_OPTIMIZERS_LAMB_HPP_INCLUDED
+#define LBANN_OPTIMIZERS_LAMB_HPP_INCLUDED
+
+#include "lbann/optimizers/data_type_optimizer.hpp"
+#include "lbann/io/persist.hpp"
+#include <optimizers.pb.h>
+#include <cereal/types/base_class.hpp>
+
+namespace lbann {
+
+/** @brief Layer-wise adaptive moments (LAMB).
+ *
+ *  Adam with decoupled weight decay, where each weights tensor's
+ *  update @f$u@f$ is rescaled by the trust ratio
+ *  @f$\lVert w \rVert / \lVert u \rVert@f$. The moment update and
+ *  both squared norms come from a single pass over the local data,
+ *  followed by a single allreduce. On GPU the norms stay in device
+ *  memory and the step kernel computes the trust ratio itself, so no
+ *  value is read back to the host.
+ *
+ *  Reference:
+ *
+ *  You et al. "Large Batch Optimization for Deep Learning: Training
+ *  BERT in 76 minutes", 2019.
+ */
+template <typename TensorDataType>
+class lamb : public data_type_optimizer<TensorDataType> {
+
+public:
+  /** @name Public Types */
+  ///@{
+
+  /** @brief The tensor type expected in this object. */
+  using AbsDistMatrixType = El::AbstractDistMatrix<TensorDataType>;
+
+  /** @brief The optimizer base type of this object. */
+  using OptimizerType = data_type_optimizer<TensorDataType>;
+
+  /** @brief The concrete weights type used by this object. */
+  using WeightsType = data_type_weights<TensorDataType>;
+
+  ///@}
+
+public:
+
+  /** @name Life cycle functions */
+  ///@{
+
+  lamb(TensorDataType learning_rate,
+       TensorDataType beta1 = 0.9,
+       TensorDataType beta2 = 0.999,
+       TensorDataType eps = 1e-6,
+       TensorDataType weight_decay = 0);
+  lamb(const lamb& other);
+  lamb& operator=(const lamb& other);
+  ~lamb() override = default;
+  lamb* copy() const override { return new lamb(*this); }
+
+  /** Archive for checkpoint and restart */
+  template <class Archive> void serialize(Archive & ar) {
+    ar(cereal::base_class<data_type_optimizer<TensorDataType>>(this),
+       CEREAL_NVP(m_beta1),
+       CEREAL_NVP(m_beta2),
+       CEREAL_NVP(m_eps),
+       CEREAL_NVP(m_weight_decay),
+       CEREAL_NVP(m_current_beta1),
+       CEREAL_NVP(m_current_beta2));
+  }
+  ///@}
+
+  /** @name Descriptions */
+  ///@{
+
+  /** Human-readable type name. */
+  std::string get_type() const override { return "LAMB"; }
+  /** Human-readable description. */
+  description get_description() const override;
+
+  ///@}
+
+  /** @name Setup */
+  ///@{
+
+  void setup(WeightsType* w = nullptr) override;
+
+  ///@}
+
+protected:
+
+  /** Computation for an optimization step. */
+  void step_compute(AbsDistMatrixType& values, const AbsDistMatrixType& gradient) override;
+
+  /** Optimizer state for lazy sparse steps. */
+  std::vector<std::unique_ptr<AbsDistMatrixType>*> get_state_matrices() override {
+    return {&m_moment1, &m_moment2};
+  }
+
+private:
+
+  /** Update factor for first moment estimate. */
+  TensorDataType m_beta1;
+  /** Update factor for second moment estimate. */
+  TensorDataType m_beta2;
+  /** Small factor to avoid division by zero. */
+  TensorDataType m_eps;
+  /** Decoupled weight decay. */
+  TensorDataType m_weight_decay;
+  /** beta1 ^ iteration. */
+  TensorDataType m_current_beta1;
+  /** beta2 ^ iteration. */
+  TensorDataType m_current_beta2;
+  /** First moment estimates. */
+  std::unique_ptr<AbsDistMatrixType> m_moment1;
+  /** Second moment estimates. */
+  std::unique_ptr<AbsDistMatrixType> m_moment2;
+
+  /** CPU implementation of optimization step. */
+  void step_compute_cpu(AbsDistMatrixType& values,
+                        const AbsDistMatrixType& gradient,
+                        const TensorDataType& correction1,
+                        const TensorDataType& correction2);
+#ifdef LBANN_HAS_CUDA
+  /** GPU implementation of optimization step. */
+  void step_compute_gpu(AbsDistMatrixType& values,
+                        const AbsDistMatrixType& gradient,
+                        const TensorDataType& correction1,
+                        const TensorDataType& correction2);
+#endif // LBANN_HAS_CUDA
+
+  /** @name Checkpointing */
+  ///@{
+
+  bool save_to_checkpoint_shared(persist& p, std::string m_name) override;
+  bool load_from_checkpoint_shared(persist& p, std::string m_name) override;
+  bool save_to_checkpoint_distributed(persist& p, std::string m_name) override;
+  bool load_from_checkpoint_distributed(persist& p, std::string m_name) override;
+
+  ///@}
+
+};
+
+template <typename TensorDataType>
+std::unique_ptr<optimizer>
+build_lamb_optimizer_from_pbuf(
+  google::protobuf::Message const&);
+
+} // namespace lbann
+
+#endif // LBANN_OPTIMIZERS_LAMB_HPP_INCLUDED
@@ -0,0 +1,165 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_OPTIMIZERS_LARS_HPP_INCLUDED
+#define LBANN_OPTIMIZERS_LARS_HPP_INCLUDED
+
+#include "lbann/optimizers/data_type_optimizer.hpp"
+#include "lbann/io/persist.hpp"
+#include <optimizers.pb.h>
+#include <cereal/types/base_class.hpp>
+
+namespace lbann {
+
+/** @brief Layer-wise adaptive rate scaling (LARS).
+ *
+ *  Momentum SGD where each weights tensor's step is scaled by a
+ *  trust ratio
+ *  @f[
+ *    \eta \frac{\lVert w \rVert}
+ *              {\lVert g \rVert + \lambda \lVert w \rVert + \epsilon}
+ *  @f]
+ *  with @f$\lambda@f$ the weight decay. Both norms come from a single
+ *  pass over the local data and a single allreduce. On GPU the norms
+ *  stay in device memory and the step kernel computes the trust
+ *  ratio itself, so no value is read back to the host.
+ *
+ *  Reference:
+ *
+ *  You et al. "Large Batch Training of Convolutional Networks",
+ *  2017.
+ */
+template <typename TensorDataType>
+class lars : public data_type_optimizer<TensorDataType> {
+
+public:
+  /** @name Public Types */
+  ///@{
+
+  /** @brief The tensor type expected in this object. */
+  using AbsDistMatrixType = El::AbstractDistMatrix<TensorDataType>;
+
+  /** @brief The optimizer base type of this object. */
+  using OptimizerType = data_type_optimizer<TensorDataType>;
+
+  /** @brief The concrete weights type used by this object. */
+  using WeightsType = data_type_weights<TensorDataType>;
+
+  ///@}
+
+public:
+
+  /** @name Life cycle functions */
+  ///@{
+
+  lars(TensorDataType learning_rate,
+       TensorDataType momentum = 0.9,
+       TensorDataType weight_decay = 0,
+       TensorDataType eta = 0.001,
+       TensorDataType eps = 1e-8);
+  lars(const lars& other);
+  lars& operator=(const lars& other);
+  ~lars() override = default;
+  lars* copy() const override { return new lars(*this); }
+
+  /** Archive for checkpoint and restart */
+  template <class Archive> void serialize(Archive & ar) {
+    ar(cereal::base_class<data_type_optimizer<TensorDataType>>(this),
+       CEREAL_NVP(m_momentum),
+       CEREAL_NVP(m_weight_decay),
+       CEREAL_NVP(m_eta),
+       CEREAL_NVP(m_eps));
+  }
+  ///@}
+
+  /** @name Descriptions */
+  ///@{
+
+  /** Human-readable type name. */
+  std::string get_type() const override { return "LARS"; }
+  /** Human-readable description. */
+  description get_description() const override;
+
+  ///@}
+
+  /** @name Setup */
+  ///@{
+
+  void setup(WeightsType* w = nullptr) override;
+
+  ///@}
+
+protected:
+
+  /** Computation for an optimization step. */
+  void step_compute(AbsDistMatrixType& values, const AbsDistMatrixType& gradient) override;
+
+  /** Optimizer state for lazy sparse steps. */
+  std::vector<std::unique_ptr<AbsDistMatrixType>*> get_state_matrices() override {
+    return {&m_velocity};
+  }
+
+private:
+
+  /** Decay rate for gradient accumulation. */
+  TensorDataType m_momentum;
+  /** L2 penalty added to the gradient. */
+  TensorDataType m_weight_decay;
+  /** Trust coefficient. */
+  TensorDataType m_eta;
+  /** Small factor to avoid division by zero. */
+  TensorDataType m_eps;
+  /** Accumulated scaled gradients. */
+  std::unique_ptr<AbsDistMatrixType> m_velocity;
+
+  /** CPU implementation of optimization step. */
+  void step_compute_cpu(AbsDistMatrixType& values, const AbsDistMatrixType& gradient);
+#ifdef LBANN_HAS_CUDA
+  /** GPU implementation of optimization step. */
+  void step_compute_gpu(AbsDistMatrixType& values, const AbsDistMatrixType& gradient);
+#endif // LBANN_HAS_CUDA
+
+  /** @name Checkpointing */
+  ///@{
+
+  bool save_to_checkpoint_shared(persist& p, std::string m_name) override;
+  bool load_from_checkpoint_shared(persist& p, std::string m_name) override;
+  bool save_to_checkpoint_distributed(persist& p, std::string m_name) override;
+  bool load_from_checkpoint_distributed(persist& p, std::string m_name) override;
+
+  ///@}
+
+};
+
+template <typename TensorDataType>
+std::unique_ptr<optimizer>
+build_lars_optimizer_from_pbuf(
+  google::protobuf::Message const&);
+
+} // namespace lbann
+
+#endif // LBANN_OPTIMIZERS_LARS_HPP_INCLUDED
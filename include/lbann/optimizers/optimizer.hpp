@@ -100,6 +100,13 @@ public:
   /** @brief Zero out the objective function gradient w.r.t. the weights. */
   virtual void clear_gradient() = 0;
 
+  /** @brief Bytes of local memory owned by the gradient and optimizer
+   *  state on a device.
+   *
+   *  Gradient buckets shared between optimizers are not included.
+   */
+  virtual size_t get_memory_usage(El::Device device) const = 0;
+
   /** @brief Objects that are expected to contribute to the gradient. */
   El::Int get_num_gradient_sources() const;
   /** @brief Register a gradient source.
@@ -122,6 +129,14 @@ public:
   /** @brief Optimization step. */
   virtual void step() = 0;
 
+  /** @brief Queue the gradient to have the loss scale removed.
+   *
+   *  Waits for the gradient allreduce if needed. The queued gradients
+   *  are scaled and checked for overflow by
+   *  @c flush_gradient_unscaling.
+   */
+  virtual void enqueue_gradient_unscaling() = 0;
+
   /** @brief LBANN communicator. */
   lbann_comm& get_comm() { return *m_comm; }
   /** @brief LBANN communicator. */
@@ -129,13 +144,71 @@ public:
 
   /** @brief Time spent in optimization step. */
   EvalType get_step_time() const { return m_step_time; }
-  /** @brief Reset stats counters. */
-  virtual void reset_counters() { m_step_time = 0; }
-
-protected:
+  /** @brief Whether gradients are allreduced over the redundant
+   *  communicator.
+   *
+   *  If disabled, each process takes optimization steps with its own
+   *  gradient (rescaled to the full mini-batch), so replicated weights
+   *  drift apart until they are reconciled.
+   */
+  bool get_gradient_allreduce_enabled() const { return m_gradient_allreduce_enabled; }
+  /** @brief Whether gradients are allreduced over the redundant
+   *  communicator. */
+  void set_gradient_allreduce_enabled(bool enable) { m_gradient_allreduce_enabled = enable; }
+  /** @brief Whether the gradient allreduce is held back when the
+   *  last gradient source is removed.
+   *
+   *  A deferred allreduce is launched when deferral is disabled or
+   *  when the gradient is accessed. This keeps communication out of
+   *  captured CUDA graphs (see
+   *  @c model::forward_backward_prop_with_graph).
+   */
+  bool get_gradient_allreduce_deferred() const { return m_gradient_allreduce_deferred; }
+  /** @brief Whether the gradient allreduce is held back when the
+   *  last gradient source is removed. */
+  virtual void set_gradient_allreduce_deferred(bool defer) { m_gradient_allreduce_deferred = defer; }
 
   /** @brief Return the current gradient status */
   optimizer_gradient_status get_gradient_status() const { return m_gradient_status; }
+  /** @brief Overwrite the gradient status.
+   *
+   *  Used when backprop is replayed from a CUDA graph, which updates
+   *  the gradient values but not the host-side bookkeeping.
+   */
+  void restore_gradient_status(optimizer_gradient_status status) { m_gradient_status = status; }
+
+  /** @brief Bytes not sent thanks to gradient compression. */
+  size_t get_gradient_bytes_saved() const { return m_gradient_bytes_saved; }
+
+  /** @brief Record squared gradient norms around the allreduce.
+   *
+   *  While enabled, the squared norms of this rank's local entries
+   *  are recorded before the allreduce and after it. Before the
+   *  allreduce, the local contribution is scaled to an estimate from
+   *  this rank's samples alone. Each record costs a copy of the
+   *  gradient to the host. Nothing is recorded if the allreduce is
+   *  disabled or the optimizer state is sharded. Not copied with the
+   *  optimizer.
+   */
+  void set_track_gradient_norms(bool track) {
+    m_track_gradient_norms = track;
+    m_local_gradient_norm2 = 0;
+    m_global_gradient_norm2 = 0;
+  }
+  bool get_track_gradient_norms() const noexcept { return m_track_gradient_norms; }
+  /** @brief Squared norm of the gradient estimated from this rank's
+   *  samples, from the last tracked allreduce. */
+  double get_local_gradient_norm2() const noexcept { return m_local_gradient_norm2; }
+  /** @brief Squared norm of this rank's entries of the allreduced
+   *  gradient, from the last tracked allreduce. */
+  double get_global_gradient_norm2() const noexcept { return m_global_gradient_norm2; }
+  /** @brief Reset stats counters. */
+  virtual void reset_counters() {
+    m_step_time = 0;
+    m_gradient_bytes_saved = 0;
+  }
+
+protected:
 
   void set_gradient_status(const optimizer_gradient_status status) { m_gradient_status = status; }
 
@@ -147,6 +220,12 @@ protected:
 
   void inc_step_time(EvalType time) { m_step_time += time; }
 
+  void inc_gradient_bytes_saved(size_t bytes) { m_gradient_bytes_saved += bytes; }
+
+  void set_local_gradient_norm2(double norm2) { m_local_gradient_norm2 = norm2; }
+
+  void set_global_gradient_norm2(double norm2) { m_global_gradient_norm2 = norm2; }
+
 private:
 
   /** @brief LBANN communicator. */
@@ -170,6 +249,26 @@ private:
   /** @brief Time spent in optimization step. */
   EvalType m_step_time = 0;
 
+  /** @brief Bytes not sent thanks to gradient compression. */
+  size_t m_gradient_bytes_saved = 0;
+
+  /** @brief Whether gradients are allreduced over the redundant
+   *  communicator. */
+  bool m_gradient_allreduce_enabled = true;
+
+  /** @brief Whether the gradient allreduce is held back when the
+   *  last gradient source is removed.
+   *  @details Not copied with the optimizer.
+   */
+  bool m_gradient_allreduce_deferred = false;
+
+  /** @brief Whether gradient norms are recorded (not copied). */
+  bool m_track_gradient_norms = false;
+  /** @see get_local_gradient_norm2 */
+  double m_local_gradient_norm2 = 0;
+  /** @see get_global_gradient_norm2 */
+  double m_global_gradient_norm2 = 0;
+
 public:
 
   // ===========================================
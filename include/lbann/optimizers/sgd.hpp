@@ -121,6 +121,16 @@ protected:
   /** Computation for an optimization step. */
   void step_compute(AbsDistMatrixType& values, const AbsDistMatrixType& gradient) override;
 
+  /** Optimizer state for lazy sparse steps. */
+  std::vector<std::unique_ptr<AbsDistMatrixType>*> get_state_matrices() override {
+    return {&m_velocity};
+  }
+
+  /** Momentum steps apply the weight decay in their kernels. */
+  bool fuses_weight_decay() const override {
+    return m_momentum != TensorDataType(0.);
+  }
+
 private:
 
   /** @brief Decay rate for gradient accumulation.
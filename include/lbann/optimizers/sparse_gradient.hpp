@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_OPTIMIZERS_SPARSE_GRADIENT_HPP_INCLUDED
+#define LBANN_OPTIMIZERS_SPARSE_GRADIENT_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+#include "lbann/comm.hpp"
+#include <memory>
+#include <vector>
+
+namespace lbann {
+
+/** @brief Gradient that is nonzero in only a few matrix columns.
+ *
+ *  Stores the sorted indices of the nonzero columns along with a
+ *  local matrix holding those columns. This is the natural format
+ *  for embedding tables, where a mini-batch only touches the
+ *  embedding vectors of the indices it contains.
+ */
+template <typename TensorDataType>
+class sparse_gradient {
+public:
+  using AbsMatrixType = El::AbstractMatrix<TensorDataType>;
+
+  /** @param height Number of matrix rows.
+   *  @param device Device of the nonzero columns.
+   */
+  sparse_gradient(El::Int height, El::Device device);
+  sparse_gradient(const sparse_gradient& other);
+  sparse_gradient& operator=(const sparse_gradient& other);
+  ~sparse_gradient() = default;
+
+  /** @brief Whether there are no nonzero columns. */
+  bool empty() const noexcept { return m_cols.empty(); }
+  /** @brief Sorted indices of the nonzero columns. */
+  const std::vector<El::Int>& get_cols() const noexcept { return m_cols; }
+  /** @brief Nonzero columns, in the order of @c get_cols. */
+  const AbsMatrixType& get_values() const { return *m_values; }
+  /** @brief Nonzero columns, in the order of @c get_cols. */
+  AbsMatrixType& get_values() { return *m_values; }
+
+  /** @brief Remove all nonzero columns. */
+  void clear();
+
+  /** @brief Add scaled columns to the gradient.
+   *
+   *  @param cols   Column index of each column in @c values. Indices
+   *                may be repeated and need not be sorted.
+   *  @param values Local matrix with @c cols.size() columns.
+   *  @param scale  Scaling factor for @c values.
+   */
+  void add(const std::vector<El::Int>& cols,
+           const AbsMatrixType& values,
+           TensorDataType scale = TensorDataType(1));
+
+  /** @brief Sum the gradient over a communicator.
+   *
+   *  The nonzero columns of all ranks are allgathered and merged, so
+   *  communication scales with the number of nonzero columns rather
+   *  than the full matrix width.
+   */
+  void allreduce(lbann_comm& comm, const El::mpi::Comm& c);
+
+  /** @brief Add the gradient to a dense local matrix. */
+  void add_to(AbsMatrixType& dense) const;
+
+  /** @brief Add scaled columns of @c src to columns @c dst_cols of
+   *  @c dst. Indices may be repeated.
+   */
+  static void add_columns(const AbsMatrixType& src,
+                          const std::vector<El::Int>& dst_cols,
+                          TensorDataType scale,
+                          AbsMatrixType& dst);
+  /** @brief Copy columns @c cols of @c src to @c dst. */
+  static void gather_columns(const AbsMatrixType& src,
+                             const std::vector<El::Int>& cols,
+                             AbsMatrixType& dst);
+  /** @brief Copy @c src to unique columns @c cols of @c dst. */
+  static void scatter_columns(const AbsMatrixType& src,
+                              const std::vector<El::Int>& cols,
+                              AbsMatrixType& dst);
+
+private:
+
+  /** @brief Number of matrix rows. */
+  El::Int m_height;
+  /** @brief Device of @c m_values. */
+  El::Device m_device;
+  /** @brief Sorted indices of the nonzero columns. */
+  std::vector<El::Int> m_cols;
+  /** @brief Nonzero columns. */
+  std::unique_ptr<AbsMatrixType> m_values;
+
+  /** @brief Construct an empty local matrix on @c m_device. */
+  std::unique_ptr<AbsMatrixType> make_matrix() const;
+
+#ifdef LBANN_HAS_CUDA
+  static void add_columns_gpu(const AbsMatrixType& src,
+                              const std::vector<El::Int>& dst_cols,
+                              TensorDataType scale,
+                              AbsMatrixType& dst);
+  static void gather_columns_gpu(const AbsMatrixType& src,
+                                 const std::vector<El::Int>& cols,
+                                 AbsMatrixType& dst);
+  static void scatter_columns_gpu(const AbsMatrixType& src,
+                                  const std::vector<El::Int>& cols,
+                                  AbsMatrixType& dst);
+#endif // LBANN_HAS_CUDA
+
+};
+
+#ifndef LBANN_SPARSE_GRADIENT_INSTANTIATE
+#define PROTO(T)                           \
+  extern template class sparse_gradient<T>
+
+#define LBANN_INSTANTIATE_CPU_HALF
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+#undef PROTO
+#undef LBANN_INSTANTIATE_CPU_HALF
+#undef LBANN_INSTANTIATE_GPU_HALF
+#endif // LBANN_SPARSE_GRADIENT_INSTANTIATE
+
+} // namespace lbann
+
+#endif // LBANN_OPTIMIZERS_SPARSE_GRADIENT_HPP_INCLUDED
@@ -78,6 +78,13 @@ void set_num_parallel_readers(const lbann_comm& comm, ::lbann_data::LbannPB& p);
 /** @brief adjusts the values in p by querying the options db */
 void get_cmdline_overrides(const lbann_comm& comm, ::lbann_data::LbannPB& p);
 
+/** @brief sets layer data layouts and parallel strategies from a plan
+ *  written by the parallel_plan callback; layers are matched by name
+ */
+void apply_parallel_plan(const lbann_comm& comm,
+                         ::lbann_data::LbannPB& p,
+                         const std::string& plan_file);
+
 /** @brief print various params (learn_rate, etc) to cout */
 void print_parameters(const lbann_comm& comm, ::lbann_data::LbannPB& p);
 
@@ -131,6 +131,14 @@ public:
 
   void for_each_execution_context(std::function<void(observer_ptr<execution_context>)>fn);
 
+  /** @brief Give the execution contexts of one model to another
+   *  @details Used when a model is rebuilt, so that the new model
+   *  resumes at the epoch and step of the old one. Requests to stop
+   *  training are cleared.
+   */
+  void transfer_execution_contexts(observer_ptr<model> old_model,
+                                   observer_ptr<model> new_model);
+
   data_coordinator& get_data_coordinator() { return m_data_coordinator; }
 
   void apply(training_algorithm& alg,
@@ -142,6 +150,19 @@ public:
 
   void evaluate(observer_ptr<model> model, execution_mode mode, El::Int num_batches=0);
 
+  /** @brief Snapshot the weights and start an evaluation that uses
+   *  them.
+   *  @details The evaluation is run in pieces with
+   *  evaluate_on_snapshot, so that it can be interleaved with
+   *  training.
+   */
+  void begin_evaluation_on_snapshot(observer_ptr<model> model, execution_mode mode);
+  /** @brief Evaluate on the snapshot weights for up to @c num_batches
+   *  mini-batches (all remaining mini-batches if zero).
+   *  @returns Whether the evaluation is finished.
+   */
+  bool evaluate_on_snapshot(observer_ptr<model> model, execution_mode mode, El::Int num_batches=0);
+
   /** Return the I/O thread pool */
   thread_pool& get_io_thread_pool() const {
     if (!m_io_thread_pool) { LBANN_ERROR("m_io_thread_pool is null"); }
@@ -0,0 +1,159 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_LOCAL_SGD_TRAINING_ALGORITHM_HPP
+#define LBANN_LOCAL_SGD_TRAINING_ALGORITHM_HPP
+
+#include "lbann/training_algorithms/sgd_training_algorithm.hpp"
+#include "lbann/comm.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace lbann {
+
+class weights;
+
+/** @brief SGD with periodic model averaging.
+ *
+ *  Replicas of the model take several optimization steps on their own
+ *  data and then average their weights. Between two synchronizations
+ *  no gradients are communicated, so communication volume drops by
+ *  the synchronization interval.
+ *
+ *  Within a trainer, each process steps with its local gradient and
+ *  the replicated weights are averaged over the trainer. Across
+ *  trainers, each trainer stays synchronous and the weights are
+ *  averaged over the inter-trainer communicator.
+ *
+ *  With adaptive synchronization, the interval is doubled (up to a
+ *  maximum) when the relative distance between the local and averaged
+ *  weights is below a target and halved when it is above.
+ *
+ *  With asynchronous averaging, the allreduce of the weights is
+ *  started at a synchronization and completed at the next one, so
+ *  replicas keep training while it is in flight and a slow replica no
+ *  longer stalls the others at every synchronization. The average then
+ *  has one interval of staleness: it replaces the snapshot that was
+ *  sent, and the local progress made since is kept,
+ *    @f[ w \leftarrow w - w_{	ext{sent}} + ar{w}_{	ext{sent}} @f]
+ *  The last average of a training run is blocking.
+ */
+class local_sgd_training_algorithm : public sgd_training_algorithm {
+public:
+
+  /** @param sync_interval     Optimization steps between weight
+   *                           averaging.
+   *  @param intertrainer      Average over trainers instead of over
+   *                           the processes of a trainer.
+   *  @param adaptive          Adapt the synchronization interval.
+   *  @param max_sync_interval Largest adaptive interval.
+   *  @param divergence_target Relative weight divergence targeted by
+   *                           adaptive synchronization.
+   *  @param async             Overlap the averaging with the next
+   *                           interval.
+   */
+  local_sgd_training_algorithm(size_t sync_interval,
+                               bool intertrainer = false,
+                               bool adaptive = false,
+                               size_t max_sync_interval = 64,
+                               double divergence_target = 0.01,
+                               bool async = false);
+  local_sgd_training_algorithm(const local_sgd_training_algorithm& other) = default;
+  local_sgd_training_algorithm& operator=(const local_sgd_training_algorithm& other) = default;
+  local_sgd_training_algorithm(local_sgd_training_algorithm&& other) = default;
+  local_sgd_training_algorithm& operator=(local_sgd_training_algorithm&& other) = default;
+  virtual ~local_sgd_training_algorithm() = default;
+
+  std::string get_name() const { return "local_sgd"; }
+
+  /** Apply the training algorithm to the model with the provided
+      context and execution mode */
+  void apply(execution_context& c,
+             model& model,
+             data_coordinator& dc,
+             execution_mode mode,
+             termination_criteria const& term_criteria) override;
+
+  /** @brief Current number of optimization steps between weight
+   *  averaging. */
+  size_t get_sync_interval() const noexcept { return m_sync_interval; }
+
+protected:
+  /** Train model on one step, averaging weights when due */
+  bool train_mini_batch(sgd_execution_context& c, model& model, data_coordinator& dc) override;
+
+private:
+  /** @brief Average weights over the model replicas.
+   *  @returns Distance between the local and averaged weights,
+   *  relative to the norm of the averaged weights.
+   */
+  double average_weights(model& m);
+  /** @brief Make sure all trainers start from the same weights. */
+  void broadcast_weights(model& m);
+  /** @brief Snapshot the weights and start averaging them. */
+  void start_average_weights(model& m);
+  /** @brief Complete the averaging in flight and apply it.
+   *  @returns Same as average_weights, for the snapshot.
+   */
+  double finish_average_weights(model& m);
+  /** @brief Adapt the synchronization interval to a divergence. */
+  void adapt_sync_interval(double divergence);
+
+  /** @brief Optimization steps between weight averaging. */
+  size_t m_sync_interval;
+  /** @brief Average over trainers instead of over processes. */
+  bool m_intertrainer;
+  /** @brief Adapt the synchronization interval. */
+  bool m_adaptive;
+  /** @brief Largest adaptive synchronization interval. */
+  size_t m_max_sync_interval;
+  /** @brief Relative weight divergence targeted by adaptive
+   *  synchronization. */
+  double m_divergence_target;
+  /** @brief Optimization steps since weights were last averaged. */
+  size_t m_steps_since_sync = 0;
+  /** @brief Overlap the averaging with the next interval. */
+  bool m_async;
+
+  /** @brief Averaging of one weights object in flight. */
+  struct pending_average {
+    /** Weights being averaged. */
+    weights* w;
+    /** Values that were sent. */
+    std::shared_ptr<El::AbstractDistMatrix<DataType>> sent;
+    /** Sum of the replicas' values once the request completes. */
+    std::shared_ptr<El::AbstractDistMatrix<DataType>> sum;
+    Al::request req;
+  };
+  /** @brief Averaging in flight (asynchronous mode). */
+  std::vector<pending_average> m_pending;
+};
+
+}  // namespace lbann
+
+#endif  // LBANN_LOCAL_SGD_TRAINING_ALGORITHM_HPP
@@ -77,6 +77,23 @@ public:
                 data_coordinator& dc,
                 execution_mode mode, size_t num_batches=0);
 
+  /** Snapshot the weights and start an evaluation that uses them.
+   *  The evaluation is run in pieces with evaluate_on_snapshot, so
+   *  that it can be interleaved with training.
+   */
+  void begin_evaluation_on_snapshot(sgd_execution_context& c,
+                                    model& model,
+                                    data_coordinator& dc,
+                                    execution_mode mode);
+  /** Evaluate on the snapshot weights for up to num_batches
+   *  mini-batches (all remaining mini-batches if zero).
+   *  Returns true when the evaluation is finished.
+   */
+  bool evaluate_on_snapshot(sgd_execution_context& c,
+                            model& model,
+                            data_coordinator& dc,
+                            size_t num_batches);
+
 protected:
   /** Train model on one step / mini-batch of an SGD forward pass */
   virtual bool train_mini_batch(sgd_execution_context& c, model& model, data_coordinator& dc);
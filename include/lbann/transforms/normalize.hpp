@@ -62,6 +62,8 @@ public:
   void apply(utils::type_erased_matrix& data, std::vector<size_t>& dims) override;
   void apply(utils::type_erased_matrix& data, CPUMat& out,
              std::vector<size_t>& dims) override;
+  bool supports_batch() const override { return true; }
+  void apply_batch(CPUMat& data, const std::vector<size_t>& dims) override;
 private:
   /** Channel-wise means. */
   std::vector<float> m_means;
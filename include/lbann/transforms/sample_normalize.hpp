@@ -45,6 +45,8 @@ public:
   std::string get_type() const override { return "sample_normalize"; }
 
   void apply(utils::type_erased_matrix& data, std::vector<size_t>& dims) override;
+  bool supports_batch() const override { return true; }
+  void apply_batch(CPUMat& data, const std::vector<size_t>& dims) override;
 };
 
 // Builder function
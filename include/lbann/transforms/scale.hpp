@@ -47,6 +47,8 @@ public:
   std::string get_type() const override { return "scale"; }
 
   void apply(utils::type_erased_matrix& data, std::vector<size_t>& dims) override;
+  bool supports_batch() const override { return true; }
+  void apply_batch(CPUMat& data, const std::vector<size_t>& dims) override;
 private:
   /** Amount to scale data by. */
   float m_scale;
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_TRANSFORMS_SCRATCH_ARENA_HPP_INCLUDED
+#define LBANN_TRANSFORMS_SCRATCH_ARENA_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace lbann {
+namespace transform {
+
+/**
+ * Per-thread bump allocator for the intermediate images of a
+ * transform pipeline.
+ *
+ * While a scratch_scope is open on a thread, make_scratch_matrix()
+ * carves buffers out of that thread's arena instead of the heap. The
+ * arena is reset when the scope closes (once per sample); if a sample
+ * needed more than the arena holds, the arena grows to that size, so
+ * in the steady state no memory is allocated at all.
+ */
+class scratch_arena {
+public:
+  scratch_arena() = default;
+  scratch_arena(const scratch_arena&) = delete;
+  scratch_arena& operator=(const scratch_arena&) = delete;
+
+  /** The calling thread's arena. */
+  static scratch_arena& get();
+
+  /** Whether a scratch_scope is open on this arena. */
+  bool active() const { return m_active; }
+  /** Ensure at least bytes are available without further allocation.
+   *  Must not be called while allocations are live. */
+  void reserve(size_t bytes);
+  /** Get bytes of (cache-line aligned) scratch memory. */
+  uint8_t* allocate(size_t bytes);
+  /** Release all allocations, growing the arena if it overflowed. */
+  void reset();
+
+  /** Bytes held by the arena. */
+  size_t capacity() const { return m_capacity; }
+
+private:
+  friend class scratch_scope;
+
+  static constexpr size_t alignment = 64;
+
+  std::unique_ptr<uint8_t[]> m_buffer;
+  /** m_buffer, rounded up to the alignment. */
+  uint8_t* m_base = nullptr;
+  size_t m_capacity = 0;
+  size_t m_used = 0;
+  /** Bytes requested since the last reset, including overflow. */
+  size_t m_requested = 0;
+  /** Allocations that did not fit; freed at reset. */
+  std::vector<std::unique_ptr<uint8_t[]>> m_overflow;
+  bool m_active = false;
+};
+
+/**
+ * Route the calling thread's scratch allocations to its arena for the
+ * lifetime of this object. Nothing allocated in the scope may be used
+ * after it closes.
+ */
+class scratch_scope {
+public:
+  /** @param reserve_bytes Initial arena size, e.g. from the expected
+   *  output dims of the pipeline. */
+  explicit scratch_scope(size_t reserve_bytes = 0);
+  scratch_scope(const scratch_scope&) = delete;
+  scratch_scope& operator=(const scratch_scope&) = delete;
+  ~scratch_scope();
+private:
+  scratch_arena& m_arena;
+  /** False if a scope was already open (scopes do not nest). */
+  bool m_owner;
+};
+
+/**
+ * Get an uninitialized size x 1 matrix for an intermediate image,
+ * from the thread's arena if a scratch_scope is open, otherwise from
+ * the heap.
+ */
+El::Matrix<uint8_t> make_scratch_matrix(size_t size);
+
+}  // namespace transform
+}  // namespace lbann
+
+#endif  // LBANN_TRANSFORMS_SCRATCH_ARENA_HPP_INCLUDED
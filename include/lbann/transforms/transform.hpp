@@ -32,6 +32,7 @@
 #include "lbann/utils/random.hpp"
 #include "lbann/utils/type_erased_matrix.hpp"
 #include "lbann/utils/exception.hpp"
+#include "lbann/transforms/vision/fused_image_op.hpp"
 
 namespace lbann {
 namespace transform {
@@ -88,6 +89,44 @@ public:
                      std::vector<size_t>& dims) {
     LBANN_ERROR("Non-in-place apply not implemented.");
   }
+
+  /**
+   * True if applying the transform makes no random choices, so its
+   * output depends only on its input.
+   */
+  virtual bool is_deterministic() const {
+    return false;
+  }
+
+  /** True if the transform implements apply_batch(). */
+  virtual bool supports_batch() const {
+    return false;
+  }
+
+  /**
+   * Apply the transform in-place to a batch of samples at once.
+   * Only for transforms on DataType data that do not change dims.
+   * @param data One sample per column, each in LBANN's layout; columns
+   *   need not be contiguous with each other.
+   * @param dims The dimensions of each sample.
+   */
+  virtual void apply_batch(CPUMat& data, const std::vector<size_t>& dims) {
+    LBANN_ERROR(get_type(), " transform cannot be applied to a batch.");
+  }
+
+  /** True if the transform implements fuse(). */
+  virtual bool supports_fuse() const {
+    return false;
+  }
+
+  /**
+   * Add the transform to op instead of applying it.
+   * This makes the same random choices apply() would, based on dims,
+   * which are updated as apply() would update them.
+   */
+  virtual void fuse(fused_image_op& op, std::vector<size_t>& dims) const {
+    LBANN_ERROR(get_type(), " transform cannot be fused.");
+  }
 protected:
   /** Return a value uniformly at random in [a, b). */
   static inline float get_uniform_random(float a, float b) {
@@ -34,6 +34,25 @@
 namespace lbann {
 namespace transform {
 
+/**
+ * While one is open on a thread, transform_pipeline::apply() on that
+ * thread stops before the pipeline's batchable suffix, which the
+ * caller must then run with transform_pipeline::apply_batch() on the
+ * samples. Only for callers whose per-sample output is exactly the
+ * columns later passed to apply_batch().
+ */
+class deferred_batch_scope {
+public:
+  explicit deferred_batch_scope(bool enable = true);
+  deferred_batch_scope(const deferred_batch_scope&) = delete;
+  deferred_batch_scope& operator=(const deferred_batch_scope&) = delete;
+  ~deferred_batch_scope();
+  /** Whether a scope is open on the calling thread. */
+  static bool active();
+private:
+  bool m_prev;
+};
+
 /**
  * Applies a sequence of transforms to input data.
  */
@@ -63,6 +82,12 @@ public:
     m_expected_out_dims = expected_out_dims;
   }
 
+  /**
+   * Enable or disable (default: enabled) executing a fusable pipeline
+   * as a single pass when converting uint8 images to CPUMat.
+   */
+  void set_fuse(bool fuse) { m_fuse = fuse; }
+
   /**
    * Apply the transforms to data.
    * @param data The data to transform. data will be modified in-place.
@@ -76,14 +101,72 @@ public:
    * @param data The data to transform. Will be modified in-place.
    * @param out_data Output will be placed here. It will not be reallocated.
    * @param dims Dimensions of data. Will be modified in-place.
+   * @param first Index of the first transform to apply; those before
+   *   it have already been applied (see apply_deterministic_prefix()).
    */
   void apply(El::Matrix<uint8_t>& data, CPUMat& out_data,
-             std::vector<size_t>& dims);
+             std::vector<size_t>& dims, size_t first = 0);
+
+  /**
+   * Number of leading transforms whose output depends only on their
+   * input (e.g., resize, center_crop), and so can be computed once
+   * and cached across epochs.
+   */
+  size_t get_deterministic_prefix() const;
+  /**
+   * Apply the first get_deterministic_prefix() transforms in-place;
+   * data stays a uint8 image.
+   */
+  void apply_deterministic_prefix(El::Matrix<uint8_t>& data,
+                                  std::vector<size_t>& dims);
+
+  /**
+   * True if the pipeline ends with transforms that can be applied to a
+   * batch of samples, and the expected output dims are known.
+   */
+  bool supports_batch() const;
+  /**
+   * Apply the batchable suffix of the pipeline to samples that went
+   * through apply() inside a deferred_batch_scope.
+   * @param data One sample per column, in LBANN's layout.
+   */
+  void apply_batch(CPUMat& data) const;
+
+  /**
+   * True if every transform can be fused and the pipeline ends by
+   * converting to LBANN's layout, so that fuse() can replace apply().
+   */
+  bool supports_fuse(size_t first = 0) const;
+  /**
+   * Collapse the transforms into op, making the random choices they
+   * would make for an image with the given dims.
+   * @param dims Dimensions of the image. Will be modified in-place.
+   * @param first Index of the first transform to fuse.
+   */
+  void fuse(fused_image_op& op, std::vector<size_t>& dims,
+            size_t first = 0) const;
 private:
   /** Ordered list of transforms to apply. */
   std::vector<std::unique_ptr<transform>> m_transforms;
   /** Expected dimensions after applying all transforms. */
   std::vector<size_t> m_expected_out_dims;
+  /** Whether apply() may run fusable pipelines in a single pass. */
+  bool m_fuse = true;
+
+  /**
+   * Resample, flip and convert data to LBANN's layout in one pass,
+   * writing straight into out_data, in place of the transforms.
+   */
+  void apply_fused(El::Matrix<uint8_t>& data, CPUMat& out_data,
+                   std::vector<size_t>& dims, size_t first);
+  /**
+   * Index of the first transform of the batchable suffix.
+   * Never at or before the first non-in-place transform, so the
+   * uint8 -> DataType conversion always happens per sample.
+   */
+  size_t get_batch_start() const;
+  /** Number of transforms apply() runs on the calling thread. */
+  size_t get_num_per_sample() const;
 
   /** Assert dims matches expected_out_dims (if set). */
   void assert_expected_out_dims(const std::vector<size_t>& dims);
@@ -58,6 +58,8 @@ public:
 
   std::string get_type() const override { return "adjust_saturation"; }
 
+  bool is_deterministic() const override { return true; }
+
   void apply(utils::type_erased_matrix& data, std::vector<size_t>& dims) override;
 
 private:
@@ -44,7 +44,13 @@ public:
 
   std::string get_type() const override { return "center_crop"; }
 
+  bool is_deterministic() const override { return true; }
+
   void apply(utils::type_erased_matrix& data, std::vector<size_t>& dims) override;
+
+  bool supports_fuse() const override { return true; }
+
+  void fuse(fused_image_op& op, std::vector<size_t>& dims) const override;
 private:
   /** Height and width of the crop. */
   size_t m_h, m_w;
@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_TRANSFORMS_FUSED_IMAGE_OP_HPP_INCLUDED
+#define LBANN_TRANSFORMS_FUSED_IMAGE_OP_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+#ifdef LBANN_HAS_GPU
+#include "lbann/utils/cuda.hpp"
+#endif // LBANN_HAS_GPU
+
+#include <vector>
+
+namespace lbann {
+namespace transform {
+
+/**
+ * A sequence of crops, resizes and flips, followed by conversion to
+ * LBANN's layout, collapsed into a single sampling of the source image.
+ *
+ * Output pixel (x, y) samples the source image (bilinearly) at
+ * (x_offset + x_stride*x, y_offset + y_stride*y), in pixel-center
+ * coordinates; a flip makes the stride negative. Each channel is then
+ * scaled to [0, 1] and normalized with the means and standard
+ * deviations. Transforms add themselves through transform::fuse(), so
+ * that, e.g., the GPU image path applies a whole pipeline in one pass.
+ */
+struct fused_image_op {
+  float x_offset = 0.0f;
+  float x_stride = 1.0f;
+  float y_offset = 0.0f;
+  float y_stride = 1.0f;
+  /** Channel-wise means and standard deviations (after scaling). */
+  float means[3] = {0.0f, 0.0f, 0.0f};
+  float stds[3] = {1.0f, 1.0f, 1.0f};
+  /** Set by the transform that converts to LBANN's layout. */
+  bool to_lbann_layout = false;
+
+  /** Crop with upper-left corner (x, y) of the current image. */
+  void crop(size_t x, size_t y) {
+    x_offset += x_stride * x;
+    y_offset += y_stride * y;
+  }
+  /** Resize the current h x w image to new_h x new_w. */
+  void resize(size_t h, size_t w, size_t new_h, size_t new_w) {
+    const float sx = float(w) / float(new_w);
+    const float sy = float(h) / float(new_h);
+    x_offset += x_stride * 0.5f * (sx - 1.0f);
+    y_offset += y_stride * 0.5f * (sy - 1.0f);
+    x_stride *= sx;
+    y_stride *= sy;
+  }
+  /** Flip the current image, of width w, horizontally. */
+  void flip_horizontal(size_t w) {
+    x_offset += x_stride * (w - 1);
+    x_stride = -x_stride;
+  }
+  /** Flip the current image, of height h, vertically. */
+  void flip_vertical(size_t h) {
+    y_offset += y_stride * (h - 1);
+    y_stride = -y_stride;
+  }
+};
+
+/**
+ * Apply op on the CPU to an interleaved, 3-channel image, writing the
+ * result in LBANN's layout (out_h x out_w, 3 channels) to out.
+ */
+void apply_fused_image_op(const fused_image_op& op, const uint8_t* image,
+                          size_t height, size_t width,
+                          size_t out_h, size_t out_w, DataType* out);
+
+#ifdef LBANN_HAS_GPU
+/** One decoded image and the op to apply to it. */
+struct fused_image_task {
+  /** Interleaved, 3-channel (BGR, as OpenCV) image on the device. */
+  const uint8_t* image;
+  int height;
+  int width;
+  fused_image_op op;
+};
+
+/**
+ * Apply fused ops on the device, writing sample i in LBANN's layout
+ * to column i of out (out_h x out_w, 3 channels).
+ * @param tasks Device array of num_tasks tasks.
+ */
+void apply_fused_image_ops(const fused_image_task* tasks, size_t num_tasks,
+                           size_t out_h, size_t out_w,
+                           DataType* out, El::Int out_ldim,
+                           cudaStream_t stream);
+#endif // LBANN_HAS_GPU
+
+}  // namespace transform
+}  // namespace lbann
+
+#endif  // LBANN_TRANSFORMS_FUSED_IMAGE_OP_HPP_INCLUDED
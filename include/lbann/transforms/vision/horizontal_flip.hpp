@@ -46,6 +46,10 @@ public:
 
   void apply(utils::type_erased_matrix& data, std::vector<size_t>& dims) override;
 
+  bool supports_fuse() const override { return true; }
+
+  void fuse(fused_image_op& op, std::vector<size_t>& dims) const override;
+
 private:
   /** Probability that that the image is flipped. */
   float m_p;
@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_TRANSFORMS_LAYOUT_KERNELS_HPP_INCLUDED
+#define LBANN_TRANSFORMS_LAYOUT_KERNELS_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+namespace lbann {
+namespace transform {
+
+/**
+ * Convert an interleaved, row-major (HWC, as OpenCV) uint8 image to
+ * LBANN's layout, applying out = in*scale[c] + bias[c] per channel.
+ *
+ * The conversion is a transpose, so it is done in cache-sized tiles.
+ * On x86 the kernel is built for several instruction sets (AVX-512,
+ * AVX2, baseline) and the best one is selected at load time; on ARM
+ * the baseline build uses NEON.
+ *
+ * @param channels Number of channels; 1 to 4.
+ */
+void interleaved_to_lbann_layout(const uint8_t* src, size_t channels,
+                                 size_t height, size_t width,
+                                 const float* scale, const float* bias,
+                                 DataType* dst);
+
+/**
+ * Split num_pixels interleaved pixels into channel-strided planes:
+ * dst[c*num_pixels + i] = src[channels*i + c].
+ * @param channels Number of channels; 1 to 4.
+ */
+void deinterleave_channels(const DataType* src, size_t channels,
+                           size_t num_pixels, DataType* dst);
+
+}  // namespace transform
+}  // namespace lbann
+
+#endif  // LBANN_TRANSFORMS_LAYOUT_KERNELS_HPP_INCLUDED
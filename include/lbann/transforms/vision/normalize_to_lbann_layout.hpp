@@ -60,6 +60,10 @@ public:
 
   void apply(utils::type_erased_matrix& data, std::vector<size_t>& dims) override;
 
+  bool supports_fuse() const override { return true; }
+
+  void fuse(fused_image_op& op, std::vector<size_t>& dims) const override;
+
   void apply(utils::type_erased_matrix& data, CPUMat& out,
              std::vector<size_t>& dims) override;
 private:
@@ -45,6 +45,10 @@ public:
   std::string get_type() const override { return "random_crop"; }
 
   void apply(utils::type_erased_matrix& data, std::vector<size_t>& dims) override;
+
+  bool supports_fuse() const override { return true; }
+
+  void fuse(fused_image_op& op, std::vector<size_t>& dims) const override;
 private:
   /** Height and width of the crop. */
   size_t m_h, m_w;
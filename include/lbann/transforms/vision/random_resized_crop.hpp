@@ -62,7 +62,15 @@ public:
   std::string get_type() const override { return "random_resized_crop"; }
 
   void apply(utils::type_erased_matrix& data, std::vector<size_t>& dims) override;
+
+  bool supports_fuse() const override { return true; }
+
+  void fuse(fused_image_op& op, std::vector<size_t>& dims) const override;
 private:
+  /** Select the crop (upper-left corner and size) for an image. */
+  void select_crop(const std::vector<size_t>& dims,
+                   size_t& x, size_t& y, size_t& h, size_t& w) const;
+
   /** Height and width of the final crop. */
   size_t m_h, m_w;
   /** Range for the area of the random crop. */
@@ -0,0 +1,86 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_UTILS_ASYNC_READ_HPP_INCLUDED
+#define LBANN_UTILS_ASYNC_READ_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+#include <string>
+#include <vector>
+
+namespace lbann {
+namespace file {
+
+/** @brief Read whole files into buffers, all requests in flight at once.
+ *
+ *  A data reader thread that needs several files, e.g. the images of
+ *  its block of a mini-batch, queues them here and reads them with a
+ *  single call. With io_uring (LBANN_HAS_IO_URING) every read is
+ *  submitted before any completion is awaited, so the device sees a
+ *  queue depth of the batch size rather than one per thread. Without
+ *  it, readahead is requested for every file before the first one is
+ *  read with @c pread, which overlaps the reads in the page cache.
+ *
+ *  Buffers are resized to the file sizes but are otherwise reused, so
+ *  a reader that keeps its buffers across mini-batches does not
+ *  allocate once they have grown to the largest file.
+ *
+ *  An object is meant to be used by one thread at a time; the
+ *  io_uring ring is per thread.
+ */
+class batch_file_reader {
+public:
+
+  /** @brief Queue a file to be read into @c buf by the next @c read. */
+  void add(std::string path, El::Matrix<uint8_t>& buf);
+
+  /** @brief Read every queued file and clear the queue.
+   *
+   *  Throws if a file cannot be opened or is read short.
+   */
+  void read();
+
+  /** @brief Number of queued files. */
+  size_t size() const noexcept { return m_paths.size(); }
+
+private:
+
+  /** @brief Paths of the queued files. */
+  std::vector<std::string> m_paths;
+  /** @brief Destinations of the queued files. */
+  std::vector<El::Matrix<uint8_t>*> m_bufs;
+  /** @brief File descriptors, open during @c read. */
+  std::vector<int> m_fds;
+  /** @brief Bytes read so far of each file. */
+  std::vector<size_t> m_offsets;
+
+};
+
+} // namespace file
+} // namespace lbann
+
+#endif // LBANN_UTILS_ASYNC_READ_HPP_INCLUDED
@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_BATCHED_GEMM_HPP_INCLUDED
+#define LBANN_UTILS_BATCHED_GEMM_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+namespace lbann {
+
+/** @brief Strided batched matrix multiplication on CPU.
+ *
+ *  Computes @f$ C_i = \alpha op(A_i) op(B_i) + \beta C_i @f$ for each
+ *  of @c batch_count matrices in Fortran layout, where matrix @c i
+ *  begins @c i * @c stride entries after the first one. This mirrors
+ *  @c cublas::gemm_strided_batched.
+ *
+ *  Small products are computed directly with one OpenMP task per
+ *  matrix, since the overhead of a BLAS call dominates for the tiny
+ *  matrices in attention-style workloads. Large products are passed
+ *  to BLAS.
+ */
+template <typename TensorDataType>
+void gemm_strided_batched(El::Orientation transa, El::Orientation transb,
+                          El::Int m, El::Int n, El::Int k,
+                          TensorDataType alpha,
+                          const TensorDataType* A, El::Int lda,
+                          El::Int strideA,
+                          const TensorDataType* B, El::Int ldb,
+                          El::Int strideB,
+                          TensorDataType beta,
+                          TensorDataType* C, El::Int ldc,
+                          El::Int strideC,
+                          El::Int batch_count);
+
+} // namespace lbann
+
+#endif // LBANN_UTILS_BATCHED_GEMM_HPP_INCLUDED
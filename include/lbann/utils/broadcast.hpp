@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_UTILS_BROADCAST_HPP_INCLUDED
+#define LBANN_UTILS_BROADCAST_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+#include <vector>
+
+#ifdef __CUDACC__
+#define LBANN_BROADCAST_FUNC __host__ __device__ __forceinline__
+#else
+#define LBANN_BROADCAST_FUNC inline
+#endif // __CUDACC__
+
+namespace lbann {
+
+/** @brief Index map for reading a tensor as if it were tessellated
+ *
+ *  Lets entry-wise layers consume a small tensor directly instead of
+ *  a copy that has been tessellated to full size (see @c
+ *  tessellate_layer). For an input tensor @f$ X @f$ with dimensions
+ *  @f$ d_1\times\cdots\times d_n @f$ read at the shape @f$
+ *  e_1\times\cdots\times e_n @f$,
+ *  @f[ Y_{i_1,\cdots,i_n} = X_{i_1\% d_1,\cdots,i_n\% d_n} @f]
+ *  A dimension of size 1 is an ordinary (stride-0) broadcast.
+ *
+ *  Dimensions are right-aligned, and missing leading dimensions count
+ *  as 1. Neighboring dimensions that are not broadcast are merged, so
+ *  the map can describe tensors with more than @c max_dims
+ *  dimensions as long as few of them are broadcast.
+ */
+struct broadcast_map {
+
+  /** @brief Maximum number of dimensions after merging. */
+  static constexpr int max_dims = 4;
+
+  /** @brief Number of dimensions, or 0 if the map is the identity. */
+  int num_dims = 0;
+  /** @brief Dimensions being read, outermost first. */
+  El::Int output_dims[max_dims];
+  /** @brief Dimensions of the stored tensor, outermost first. */
+  El::Int input_dims[max_dims];
+  /** @brief Strides of the stored tensor, outermost first. */
+  El::Int input_strides[max_dims];
+
+  /** @brief Whether entries are read in place. */
+  LBANN_BROADCAST_FUNC bool is_identity() const { return num_dims == 0; }
+
+  /** @brief Position in the stored tensor of an entry of the
+   *  tessellated tensor.
+   */
+  LBANN_BROADCAST_FUNC El::Int operator()(El::Int pos) const {
+    if (num_dims == 0) { return pos; }
+    El::Int input_pos = 0;
+    for (int d = num_dims-1; d >= 0; --d) {
+      const El::Int i = pos % output_dims[d];
+      pos /= output_dims[d];
+      input_pos += (i % input_dims[d]) * input_strides[d];
+    }
+    return input_pos;
+  }
+
+};
+
+/** @brief Whether a tensor can be read at another shape with a
+ *  @c broadcast_map
+ *
+ *  @c input_dims can have at most as many dimensions as @c
+ *  output_dims, and none of them can be larger than the matching
+ *  output dimension.
+ */
+bool is_broadcastable(const std::vector<int>& input_dims,
+                      const std::vector<int>& output_dims);
+
+/** @brief Smallest shape that two tensors can both be read at
+ *
+ *  Each (right-aligned) dimension is the larger of the two. Throws an
+ *  exception if either tensor is empty.
+ */
+std::vector<int> get_broadcast_dims(const std::vector<int>& dims1,
+                                    const std::vector<int>& dims2);
+
+/** @brief Construct a map that reads a tensor at another shape
+ *
+ *  Throws an exception if the tensor is not broadcastable (see @c
+ *  is_broadcastable) or if more than @c broadcast_map::max_dims
+ *  dimensions remain after merging.
+ */
+broadcast_map make_broadcast_map(const std::vector<int>& input_dims,
+                                 const std::vector<int>& output_dims);
+
+} // namespace lbann
+
+#endif // LBANN_UTILS_BROADCAST_HPP_INCLUDED
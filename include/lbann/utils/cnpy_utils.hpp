@@ -28,6 +28,8 @@
 #define _LBANN_CNPY_UTILS_HPP_
 
 #include "cnpy.h"
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include "lbann/utils/exception.hpp"
@@ -100,6 +102,41 @@ void shrink_to_fit(cnpy::NpyArray& na, size_t sz);
 /// Show the dimensions of loaded data
 std::string show_shape(const cnpy::NpyArray& na);
 
+
+/**
+ * Read-only view of a numpy array, with the same metadata members as
+ * cnpy::NpyArray. The data either belongs to a loaded cnpy::NpyArray
+ * or is memory-mapped from the file, in which case pages are only
+ * read (and only stay resident) as they are touched. Copies share
+ * the data.
+ */
+struct npy_view {
+  std::vector<size_t> shape;
+  size_t word_size = 0u;
+  bool fortran_order = false;
+
+  template<typename T>
+  const T* data() const { return reinterpret_cast<const T*>(m_data); }
+
+  /// Start of the data.
+  const char* m_data = nullptr;
+  /// Keeps the loaded array or the mapping alive.
+  std::shared_ptr<const void> m_owner;
+};
+
+/// View an array loaded by cnpy, sharing its data.
+npy_view make_npy_view(const cnpy::NpyArray& na);
+
+/// Memory-map the array in a .npy file.
+npy_view mmap_npy(const std::string& filename);
+
+/**
+ * Memory-map the arrays in a .npz file, keyed by name (without the
+ * .npy suffix). The arrays must be stored uncompressed, as by
+ * numpy.savez; zip64 archives are supported.
+ */
+std::map<std::string, npy_view> mmap_npz(const std::string& filename);
+
 } // end of namespace cnpy_utils
 } // end of namespace lbann
 
@@ -0,0 +1,209 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_COMM_PROFILE_HPP_INCLUDED
+#define LBANN_UTILS_COMM_PROFILE_HPP_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lbann {
+
+/** @brief Profile of communication and its overlap with compute.
+ *
+ *  @c lbann_comm records the size, algorithm, and host-side timing
+ *  of each allreduce, broadcast, and send/recv, along with the layer
+ *  or weights that triggered it (see @c context). Blocking operations
+ *  are fully exposed. Non-blocking operations are only exposed while
+ *  they are being launched and while the host waits for them, so the
+ *  rest of their duration overlapped with compute.
+ *
+ *  Timing is from the host's perspective: completion of an operation
+ *  is observed when it is waited on or successfully tested, so
+ *  durations of non-blocking operations are upper bounds. GPU
+ *  collectives whose @c wait does not block the host appear fully
+ *  overlapped.
+ *
+ *  When profiling is disabled, each operation costs one relaxed
+ *  atomic load.
+ */
+namespace comm_profile {
+
+/** Kind of communication operation. */
+enum class collective : uint8_t {
+  allreduce,
+  nb_allreduce,
+  broadcast,
+  sendrecv
+};
+
+/** Human-readable name for a kind of operation. */
+std::string to_string(collective op);
+
+namespace details {
+extern std::atomic<bool> enabled;
+} // namespace details
+
+/** Whether operations are being recorded. */
+inline bool enabled() noexcept {
+  return details::enabled.load(std::memory_order_relaxed);
+}
+
+/** Start recording operations. */
+void enable();
+/** Stop recording operations and discard any records. */
+void disable();
+
+/** @brief Attribute communication on this thread to a layer or
+ *  weights for the lifetime of the object.
+ *
+ *  Contexts nest; the innermost one is used. Does nothing if
+ *  profiling is disabled when the object is constructed.
+ */
+class context {
+public:
+  explicit context(const std::string& name);
+  ~context();
+  context(const context&) = delete;
+  context& operator=(const context&) = delete;
+private:
+  bool m_active;
+  std::string m_name;
+  const std::string* m_prev;
+};
+
+/** @brief Record a blocking operation for the lifetime of the
+ *  object.
+ *
+ *  @param op        Kind of operation.
+ *  @param bytes     Bytes contributed by this process.
+ *  @param comm_size Number of processes in the communicator.
+ *  @param algorithm Name of the algorithm. Must be a string literal
+ *                   or otherwise outlive the profile.
+ */
+class blocking_op {
+public:
+  blocking_op(collective op, size_t bytes, int comm_size,
+              const char* algorithm) noexcept;
+  ~blocking_op();
+  blocking_op(const blocking_op&) = delete;
+  blocking_op& operator=(const blocking_op&) = delete;
+private:
+  collective m_op;
+  size_t m_bytes;
+  int m_comm_size;
+  const char* m_algorithm;
+  const std::string* m_context;
+  double m_start;
+};
+
+/** @brief Record the launch of a non-blocking operation.
+ *
+ *  Call @c launch_end once the operation has been posted, and
+ *  @c wait_begin and @c complete around the host's wait for it.
+ *  Returns zero, which is ignored by the other functions, if
+ *  profiling is disabled.
+ */
+uint64_t launch_begin(collective op, size_t bytes, int comm_size,
+                      const char* algorithm);
+void launch_end(uint64_t id);
+void wait_begin(uint64_t id);
+/** Record that an operation has completed. If @c wait_begin was not
+ *  called, none of the wait was exposed. */
+void complete(uint64_t id);
+
+/** @brief Record the launch of a non-blocking operation for the
+ *  lifetime of the object.
+ *
+ *  The record's ID is written to @c id.
+ */
+class launch {
+public:
+  launch(uint64_t& id, collective op, size_t bytes, int comm_size,
+         const char* algorithm)
+    : m_id(launch_begin(op, bytes, comm_size, algorithm)) {
+    id = m_id;
+  }
+  ~launch() { launch_end(m_id); }
+  launch(const launch&) = delete;
+  launch& operator=(const launch&) = delete;
+private:
+  uint64_t m_id;
+};
+
+/** Statistics for operations of one kind, algorithm, and size
+ *  class. */
+struct size_class_stats {
+  collective op;
+  std::string algorithm;
+  /** Operations in this class have at least this many bytes and
+   *  fewer than twice as many. */
+  size_t min_bytes;
+  size_t count = 0;
+  size_t bytes = 0;
+  /** Total duration (seconds). */
+  double time = 0;
+  /** Bus bandwidth (bytes per second). Allreduces are scaled by
+   *  2(p-1)/p so values are comparable with link bandwidth. */
+  double bus_bandwidth = 0;
+};
+
+/** Statistics for operations triggered by one layer or weights. */
+struct context_stats {
+  std::string name;
+  size_t count = 0;
+  size_t bytes = 0;
+  /** Total duration (seconds). */
+  double time = 0;
+  /** Time the host spent blocked (seconds). */
+  double exposed_time = 0;
+};
+
+/** Summary of the operations completed since the last report. */
+struct report {
+  /** Wall-clock time since the last report (seconds). */
+  double wall_time = 0;
+  /** Total duration of operations (seconds). */
+  double comm_time = 0;
+  /** Time the host spent blocked in communication (seconds). */
+  double exposed_time = 0;
+  std::vector<size_class_stats> size_classes;
+  /** Sorted by decreasing exposed time. */
+  std::vector<context_stats> contexts;
+};
+
+/** Summarize the operations completed since the last call and
+ *  discard their records. Operations still in flight are kept. */
+report collect();
+
+} // namespace comm_profile
+} // namespace lbann
+
+#endif // LBANN_UTILS_COMM_PROFILE_HPP_INCLUDED
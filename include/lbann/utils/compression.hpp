@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_UTILS_COMPRESSION_HPP_INCLUDED
+#define LBANN_UTILS_COMPRESSION_HPP_INCLUDED
+
+#include <cstddef>
+#include <vector>
+
+namespace lbann {
+namespace utils {
+
+/** @brief Returns true if LBANN was built with a compression library */
+bool have_compression();
+
+/** @brief Compresses a buffer
+ *
+ *  Uses a fast (low) compression level, since this is intended for
+ *  compressing samples in memory, where throughput matters more than
+ *  the compression ratio.
+ *
+ *  @param src      The bytes to compress.
+ *  @param src_size The number of bytes to compress.
+ *  @param dst      On return, contains the compressed bytes.
+ */
+void compress_bytes(const void* src, std::size_t src_size,
+                    std::vector<unsigned char>& dst);
+
+/** @brief Decompresses a buffer that was compressed by compress_bytes
+ *
+ *  @param src      The compressed bytes.
+ *  @param src_size The number of compressed bytes.
+ *  @param dst      Destination; must hold exactly dst_size bytes.
+ *  @param dst_size The size of the uncompressed data.
+ */
+void decompress_bytes(const void* src, std::size_t src_size,
+                      void* dst, std::size_t dst_size);
+
+/** @brief Compresses a buffer in independent blocks
+ *
+ *  Blocks are compressed in parallel with OpenMP, so this is much
+ *  faster than @c compress_bytes for large buffers, e.g. checkpoint
+ *  files. The output starts with the block size, the number of
+ *  blocks, and the compressed size of each block, so the blocks can
+ *  also be decompressed in parallel.
+ *
+ *  @param src        The bytes to compress.
+ *  @param src_size   The number of bytes to compress.
+ *  @param dst        On return, contains the compressed blocks.
+ *  @param block_size Uncompressed bytes per block.
+ */
+void compress_blocks(const void* src, std::size_t src_size,
+                     std::vector<unsigned char>& dst,
+                     std::size_t block_size = std::size_t(1) << 20);
+
+/** @brief Decompresses a buffer that was compressed by compress_blocks
+ *
+ *  @param src      The compressed blocks.
+ *  @param src_size The number of compressed bytes.
+ *  @param dst      Destination; must hold exactly dst_size bytes.
+ *  @param dst_size The size of the uncompressed data.
+ */
+void decompress_blocks(const void* src, std::size_t src_size,
+                       void* dst, std::size_t dst_size);
+
+}// namespace utils
+}// namespace lbann
+
+#endif // LBANN_UTILS_COMPRESSION_HPP_INCLUDED
@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_CPU_POOLING_HPP_INCLUDED
+#define LBANN_UTILS_CPU_POOLING_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+namespace lbann {
+
+/** @file
+ *  Direct CPU pooling kernels.
+ *
+ *  Tensors are stored as matrices with one sample per column, each
+ *  column holding a channels x spatial tensor. Entries outside the
+ *  input tensor are treated as zero padding. Up to three spatial
+ *  dimensions are supported.
+ *
+ *  Max pooling records, for each output entry, the offset of the
+ *  maximum within the pooling window (flattened with the last
+ *  dimension fastest). The index array has the same layout as the
+ *  output tensor, but with contiguous columns. Windows with at most
+ *  256 entries can use @c unsigned @c char offsets.
+ */
+
+/** @brief Max pooling forward prop.
+ *  @param input            Input tensor.
+ *  @param output           Output tensor.
+ *  @param indices          Window offsets of maxima.
+ *  @param num_channels     Number of channels in input tensor.
+ *  @param num_dims         Number of spatial dimensions.
+ *  @param input_dims       Spatial dimensions of input tensor.
+ *  @param pads             Zero pads for input tensor.
+ *  @param window_dims      Dimensions of pooling window.
+ *  @param window_strides   Pooling window strides.
+ */
+template <typename TensorDataType, typename IndexType>
+void max_pool_forward(const CPUMatDT<TensorDataType>& input,
+                      CPUMatDT<TensorDataType>& output,
+                      IndexType* indices,
+                      int num_channels,
+                      int num_dims,
+                      const int* input_dims,
+                      const int* pads,
+                      const int* window_dims,
+                      const int* window_strides);
+
+/** @brief Max pooling backprop.
+ *  @details Each output gradient is routed to the input entry
+ *  recorded in @c max_pool_forward.
+ */
+template <typename TensorDataType, typename IndexType>
+void max_pool_backward(const CPUMatDT<TensorDataType>& gradient_wrt_output,
+                       const IndexType* indices,
+                       CPUMatDT<TensorDataType>& gradient_wrt_input,
+                       int num_channels,
+                       int num_dims,
+                       const int* input_dims,
+                       const int* pads,
+                       const int* window_dims,
+                       const int* window_strides);
+
+/** @brief Average pooling forward prop.
+ *  @details Padding entries are included in the average.
+ */
+template <typename TensorDataType>
+void average_pool_forward(const CPUMatDT<TensorDataType>& input,
+                          CPUMatDT<TensorDataType>& output,
+                          int num_channels,
+                          int num_dims,
+                          const int* input_dims,
+                          const int* pads,
+                          const int* window_dims,
+                          const int* window_strides);
+
+/** @brief Average pooling backprop. */
+template <typename TensorDataType>
+void average_pool_backward(const CPUMatDT<TensorDataType>& gradient_wrt_output,
+                           CPUMatDT<TensorDataType>& gradient_wrt_input,
+                           int num_channels,
+                           int num_dims,
+                           const int* input_dims,
+                           const int* pads,
+                           const int* window_dims,
+                           const int* window_strides);
+
+/** @brief Max unpooling forward prop.
+ *  @details Transpose of max pooling: each input entry is routed to
+ *  the window entry recorded by the paired pooling layer. An output
+ *  entry is the maximum over the windows that contain it, where
+ *  windows that did not select it contribute zero.
+ *  @param input            Input tensor, with pooled dimensions.
+ *  @param indices          Window offsets from @c max_pool_forward.
+ *  @param output           Output tensor, with unpooled dimensions.
+ *  @param output_dims      Spatial dimensions of output tensor.
+ */
+template <typename TensorDataType, typename IndexType>
+void max_unpool_forward(const CPUMatDT<TensorDataType>& input,
+                        const IndexType* indices,
+                        CPUMatDT<TensorDataType>& output,
+                        int num_channels,
+                        int num_dims,
+                        const int* output_dims,
+                        const int* pads,
+                        const int* window_dims,
+                        const int* window_strides);
+
+/** @brief Max unpooling backprop. */
+template <typename TensorDataType, typename IndexType>
+void max_unpool_backward(const CPUMatDT<TensorDataType>& gradient_wrt_output,
+                         const IndexType* indices,
+                         CPUMatDT<TensorDataType>& gradient_wrt_input,
+                         int num_channels,
+                         int num_dims,
+                         const int* output_dims,
+                         const int* pads,
+                         const int* window_dims,
+                         const int* window_strides);
+
+} // namespace lbann
+
+#endif // LBANN_UTILS_CPU_POOLING_HPP_INCLUDED
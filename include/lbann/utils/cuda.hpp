@@ -28,6 +28,7 @@
 #define LBANN_UTILS_CUDA_HPP
 
 #include "lbann/utils/exception.hpp"
+#include "lbann/utils/gpu_allocator.hpp"
 
 #ifdef LBANN_HAS_GPU
 
@@ -221,6 +222,48 @@ private:
   cudaStream_t m_stream;
 };
 
+// -------------------------------------------------------------
+// Utilities for CUDA graphs
+// -------------------------------------------------------------
+
+/** Wrapper class for a CUDA graph captured from a CUDA stream.
+ *
+ *  Recapturing updates the executable graph in place when the graph
+ *  topology is unchanged.
+ */
+class graph_wrapper {
+public:
+  graph_wrapper() = default;
+  graph_wrapper(const graph_wrapper& other) = delete;
+  graph_wrapper& operator=(const graph_wrapper& other) = delete;
+  ~graph_wrapper();
+  /** Start capturing the work enqueued on a CUDA stream.
+   *  The work is recorded but not executed.
+   */
+  void begin_capture(cudaStream_t stream);
+  /** Stop capturing and instantiate the captured graph.
+   *  Returns false if the capture was invalidated (e.g. by a
+   *  synchronization with the captured stream), in which case no
+   *  graph is kept.
+   */
+  bool end_capture();
+  /** Launch the graph on the stream it was captured from. */
+  void launch();
+  /** Whether a graph has been instantiated. */
+  bool is_instantiated() const noexcept { return m_graph_exec != nullptr; }
+  /** Destroy the instantiated graph, if any. */
+  void reset();
+private:
+  /** CUDA stream object.
+   *  The stream object lifetime is assumed to be managed externally.
+   */
+  cudaStream_t m_stream = 0;
+  /** Executable CUDA graph object.
+   *  The graph object lifetime is managed internally.
+   */
+  cudaGraphExec_t m_graph_exec = nullptr;
+};
+
 // -------------------------------------------------------------
 // Helper functions for entrywise operations
 // -------------------------------------------------------------
@@ -81,6 +81,7 @@ namespace lbann {
 
 // Forward declaration
 class Layer;
+class lbann_comm;
 
 namespace cudnn {
 
@@ -147,7 +148,12 @@ void copy_activation_desc(const cudnnActivationDescriptor_t& src,
 // cuDNN tensor managers
 ////////////////////////////////////////////////////////////
 
-/** Manager for a layer's cuDNN tensor descriptors. */
+/** Manager for a layer's cuDNN tensor descriptors.
+ *
+ *  Descriptors are only reset when the shape of the corresponding
+ *  local matrix changes, e.g. when the mini-batch size changes, so
+ *  repeated calls in forward and backward prop are cheap.
+ */
 template <typename TensorDataType>
 class layer_tensor_manager {
 public:
@@ -190,6 +196,15 @@ protected:
   /** cuDNN tensor descriptors for gradients w.r.t. layer inputs. */
   std::vector<cudnnTensorDescriptor_t> m_error_signals;
 
+  /** Shapes used to set @c m_prev_activations. */
+  std::vector<std::vector<int>> m_prev_activations_keys;
+  /** Shapes used to set @c m_activations. */
+  std::vector<std::vector<int>> m_activations_keys;
+  /** Shapes used to set @c m_prev_error_signals. */
+  std::vector<std::vector<int>> m_prev_error_signals_keys;
+  /** Shapes used to set @c m_error_signals. */
+  std::vector<std::vector<int>> m_error_signals_keys;
+
 };
 
 /** Manager for a data-parallel layer's cuDNN tensor descriptors. */
@@ -228,15 +243,66 @@ public:
   cudnnTensorDescriptor_t& get_error_signals(int parent_index = 0) override;
 };
 
+////////////////////////////////////////////////////////////
+// cuDNN workspace
+////////////////////////////////////////////////////////////
+
+/** @brief Get device workspace for a cuDNN call.
+ *
+ *  All cuDNN calls are issued on the Hydrogen default stream, so one
+ *  buffer is shared by every layer. It grows to the largest size
+ *  requested and is valid until the next call that needs a larger
+ *  buffer. Synchronizes the device when growing.
+ */
+void* get_workspace(size_t size);
+/** @brief Current size of the shared workspace (bytes).
+ *
+ *  The workspace never shrinks, so this is also the peak size.
+ */
+size_t get_workspace_size() noexcept;
+
 ////////////////////////////////////////////////////////////
 // cuDNN algorithm selection
 ////////////////////////////////////////////////////////////
 
+/** @brief Make autotuned algorithms persistent.
+ *
+ *  Loads algorithms from a cache file (if it exists) and enables
+ *  writing to it in @c save_algorithm_cache. Entries are keyed by
+ *  GPU model, cuDNN version, and convolution problem (including data
+ *  type and mini-batch size), so a cache can be shared between runs
+ *  and trainers. Must be called by all processes.
+ */
+void load_algorithm_cache(lbann_comm& comm, const std::string& path);
+/** @brief Merge algorithms tuned in this run into the cache file.
+ *
+ *  Does nothing if @c load_algorithm_cache has not been called. Must
+ *  be called by all processes.
+ */
+void save_algorithm_cache(lbann_comm& comm);
+
+/** @brief Cost of restricting cuDNN to deterministic algorithms. */
+struct deterministic_overhead {
+  /** Autotuned time of the chosen deterministic algorithms (ms). */
+  double deterministic_ms = 0;
+  /** Autotuned time of the fastest algorithms overall (ms). */
+  double nondeterministic_ms = 0;
+  /** Number of autotuned deterministic selections. */
+  size_t num_selections = 0;
+};
+/** @brief Deterministic algorithm overhead in this process so far.
+ *
+ *  Only algorithms autotuned in this run are counted, not ones found
+ *  in the algorithm cache.
+ */
+deterministic_overhead get_deterministic_overhead();
+
 /**
  * Select a forward convolution algorithm.
  *
  * If autotuning, memory for cuDNN algorithm runs is needed and should be
- * provided via the pointer arguments.
+ * provided via the pointer arguments. Workspace for the trial runs is
+ * allocated temporarily, up to --cudnn_workspace_mb.
  *
  * @param autotune True to attempt all cuDNN algorithms and select the fastest.
  * @param deterministic True to require deterministic algorithms.
@@ -250,14 +316,13 @@ cudnnConvolutionFwdAlgo_t get_fwd_algorithm(
   const void* kernel,
   const cudnnConvolutionDescriptor_t& conv_desc,
   const cudnnTensorDescriptor_t& output_desc,
-  void* output,
-  size_t ws_size,
-  void* ws);
+  void* output);
 
 /** Select a backward data convolution algorithm.
  *
  * If autotuning, memory for cuDNN algorithm runs is needed and should be
- * provided via the pointer arguments.
+ * provided via the pointer arguments. Workspace for the trial runs is
+ * allocated temporarily, up to --cudnn_workspace_mb.
  *
  * @param autotune True to attempt all cuDNN algorithms and select the fastest.
  * @param deterministic True to require deterministic algorithms.
@@ -271,14 +336,13 @@ cudnnConvolutionBwdDataAlgo_t get_bwd_data_algorithm(
   const void* prev_error_signal,
   const cudnnConvolutionDescriptor_t& conv_desc,
   const cudnnTensorDescriptor_t& error_signal_desc,
-  void* error_signal,
-  size_t ws_size,
-  void* ws);
+  void* error_signal);
 
 /** Select a backward filter convolution algorithm.
  *
  * If autotuning, memory for cuDNN algorithm runs is needed and should be
- * provided via the pointer arguments.
+ * provided via the pointer arguments. Workspace for the trial runs is
+ * allocated temporarily, up to --cudnn_workspace_mb.
  *
  * @param autotune True to attempt all cuDNN algorithms and select the fastest.
  * @param deterministic True to require deterministic algorithms.
@@ -292,9 +356,7 @@ cudnnConvolutionBwdFilterAlgo_t get_bwd_filter_algorithm(
   const void* prev_error_signal,
   const cudnnConvolutionDescriptor_t& conv_desc,
   const cudnnFilterDescriptor_t& kernel_gradient_desc,
-  void* kernel_gradient,
-  size_t ws_size,
-  void* ws);
+  void* kernel_gradient);
 
 /** @brief Set the default to use tensor core operations, allowing
  *         FP32->FP16 conversions.
@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_UTILS_DETERMINISM_HPP_INCLUDED
+#define LBANN_UTILS_DETERMINISM_HPP_INCLUDED
+
+namespace lbann {
+
+/** @brief Whether runs should be bit-reproducible.
+ *
+ *  True if LBANN is built with @c LBANN_DETERMINISTIC or run with
+ *  @c --deterministic. Reductions then use fixed-order algorithms,
+ *  cuDNN only picks deterministic algorithms (still autotuned), and
+ *  dropout masks come from the counter-based RNG. Results do not
+ *  depend on thread timing, but may change with the number of
+ *  processes.
+ */
+bool deterministic_mode();
+
+} // namespace lbann
+
+#endif // LBANN_UTILS_DETERMINISM_HPP_INCLUDED
@@ -189,7 +189,17 @@ bool is_deterministic();
  */
 int get_number_of_io_partitions();
 
+/** Query if spatially-parallel I/O is enabled.
+ *
+ *  Data readers read only their partition of each sample along the
+ *  outermost spatial dimension (see
+ *  @c generic_data_reader::set_spatial_partition), so input layers
+ *  do not shuffle samples into the spatial distribution.
+ */
+bool is_spatial_parallel_io_enabled();
+
 /** Query if Cosmoflow parallel I/O is enabled.
+ *  @deprecated Use @c is_spatial_parallel_io_enabled.
  */
 bool is_cosmoflow_parallel_io_enabled();
 
@@ -221,6 +231,11 @@ MPI_Comm get_input_comm(const lbann_comm &comm);
  */
 int get_input_rank(const lbann_comm &comm);
 
+/** Get the partition of each sample read by this process with
+ *  spatially-parallel I/O.
+ */
+int get_io_partition_index(const lbann_comm &comm);
+
 /** Return Dist for data-parallel Hydrogen matrices
  */
 Dist get_hydrogen_data_parallel_distribution(int num_dims);
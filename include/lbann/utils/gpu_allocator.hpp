@@ -0,0 +1,178 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_UTILS_GPU_ALLOCATOR_HPP_INCLUDED
+#define LBANN_UTILS_GPU_ALLOCATOR_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+#ifdef LBANN_HAS_GPU
+
+#include <cuda_runtime.h>
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace lbann {
+namespace cuda {
+
+/** Counters of the caching GPU allocator. */
+struct allocator_statistics {
+  /** Bytes in blocks handed out, rounded up to their size classes. */
+  size_t live_bytes = 0;
+  /** Bytes the callers asked for in the live blocks. */
+  size_t requested_bytes = 0;
+  /** Bytes in free blocks kept for reuse. */
+  size_t cached_bytes = 0;
+  /** Largest value of live_bytes so far. */
+  size_t peak_live_bytes = 0;
+  /** Size of the arena reserved up front. */
+  size_t reserved_bytes = 0;
+  /** Number of cudaMalloc and cudaFree calls. */
+  size_t num_mallocs = 0;
+  size_t num_frees = 0;
+  /** Number of allocations, and how many used a cached block. */
+  size_t num_allocations = 0;
+  size_t num_reuses = 0;
+
+  /** Fraction of the held device memory that no caller asked for. */
+  double fragmentation() const noexcept {
+    const auto held = live_bytes + cached_bytes;
+    return held > 0 ? 1.0 - double(requested_bytes) / held : 0.0;
+  }
+};
+
+/**
+ * Device memory allocator that keeps freed blocks for reuse.
+ *
+ * Requests are rounded up to size classes: powers of two from 512 B,
+ * then quarter steps between powers of two above 1 MiB, so a shape
+ * that changes a little (e.g. the last mini-batch of an epoch) maps
+ * to the same block. Each stream has its own free lists, so a block
+ * freed on a stream can be given to the next request on that stream
+ * right away. Blocks freed on other streams are only reused once
+ * their stream has passed the free. If the device runs out of
+ * memory, the cached blocks are released and the allocation retried.
+ *
+ * With @c --gpu_arena_mb=N, a single N MiB region is allocated at
+ * first use and new blocks are carved from it before calling
+ * cudaMalloc. The allocator is only used for LBANN's own buffers
+ * when @c --gpu_caching_allocator is given; Hydrogen matrices that
+ * own their memory still use Hydrogen's memory pool. Thread-safe.
+ */
+class caching_allocator {
+public:
+  /** The process-wide allocator. */
+  static caching_allocator& instance();
+  /** Whether LBANN should route its buffers through the allocator. */
+  static bool enabled();
+
+  caching_allocator(const caching_allocator&) = delete;
+  caching_allocator& operator=(const caching_allocator&) = delete;
+  ~caching_allocator();
+
+  /** Get a block of at least bytes for use on stream. */
+  void* allocate(size_t bytes,
+                 cudaStream_t stream = El::GPUManager::Stream());
+  /** Return a block. It may be reused once its stream gets here. */
+  void deallocate(void* ptr);
+
+  /** Allocate the arena, if there is none yet. */
+  void reserve(size_t bytes);
+  /** Free the cached blocks that are not in the arena. */
+  void release_cached();
+
+  allocator_statistics get_statistics() const;
+
+  /** Size class of a request. */
+  static size_t round_up(size_t bytes) noexcept;
+
+private:
+  caching_allocator();
+
+  struct block {
+    void* ptr = nullptr;
+    size_t size = 0;
+    size_t requested = 0;
+    cudaStream_t stream = nullptr;
+    /** Recorded on the stream when the block was freed. */
+    cudaEvent_t freed = nullptr;
+    bool in_arena = false;
+  };
+  /** Free blocks by size class. */
+  using free_list = std::map<size_t, std::vector<block>>;
+
+  /** Take a cached block of size class size, if one is ready. */
+  bool take_cached(size_t size, cudaStream_t stream, block& b);
+  /** Get new device memory for a block. */
+  void* allocate_new(size_t size, bool& in_arena);
+  void release_cached_locked();
+
+  std::unordered_map<void*, block> m_live;
+  std::unordered_map<cudaStream_t, free_list> m_free;
+
+  char* m_arena = nullptr;
+  size_t m_arena_used = 0;
+
+  allocator_statistics m_stats;
+  mutable std::mutex m_mutex;
+};
+
+/**
+ * Device buffer from the caching allocator that only needs to grow
+ * when a request is larger than any it has held. Freed on reset or
+ * destruction.
+ */
+class cached_buffer {
+public:
+  cached_buffer() = default;
+  cached_buffer(const cached_buffer&) = delete;
+  cached_buffer& operator=(const cached_buffer&) = delete;
+  cached_buffer(cached_buffer&& other) noexcept;
+  cached_buffer& operator=(cached_buffer&& other) noexcept;
+  ~cached_buffer() { reset(); }
+
+  /** Make the buffer hold at least bytes. Contents are not kept. */
+  void* reserve(size_t bytes,
+                cudaStream_t stream = El::GPUManager::Stream());
+  void reset();
+
+  void* get() const noexcept { return m_ptr; }
+  size_t capacity() const noexcept { return m_capacity; }
+
+private:
+  void* m_ptr = nullptr;
+  size_t m_capacity = 0;
+};
+
+} // namespace cuda
+} // namespace lbann
+
+#endif // LBANN_HAS_GPU
+#endif // LBANN_UTILS_GPU_ALLOCATOR_HPP_INCLUDED
@@ -140,6 +140,34 @@ void im2col_2d(const TensorDataType *__restrict__ input_buffer,
                int offset_stride_x,
                int offset_stride_y);
 
+/// Rearrange a block of 2D image blocks into matrix columns
+/** Computes columns [first_offset, first_offset + num_offsets) of
+ *  the matrix produced by @c im2col_2d. The output buffer holds
+ *  @c num_offsets columns. This allows convolution to apply GEMM to
+ *  cache-sized blocks without forming the full im2col matrix.
+ */
+template <typename TensorDataType>
+void im2col_2d_block(const TensorDataType *__restrict__ input_buffer,
+                     TensorDataType *__restrict__ output_buffer,
+                     int input_dim_x,
+                     int input_dim_y,
+                     int input_pad_x,
+                     int input_pad_y,
+                     int num_channels,
+                     int window_dim_x,
+                     int window_dim_y,
+                     int offset_stride_x,
+                     int offset_stride_y,
+                     int first_offset,
+                     int num_offsets);
+
+/// Number of im2col columns to form at a time
+/** Chooses a multiple of 16 columns that keeps an im2col block within
+ *  a typical per-core L2 cache (256 KB), clamped to the number of
+ *  columns.
+ */
+int get_im2col_block_size(int col_height, int col_width, size_t type_size);
+
 /// Rearrange matrix columns into 1x1 image blocks
 /** This is an optimized implementation of col2im when the window has
  *  a size of one, there is no padding, and the window stride is
@@ -569,7 +569,12 @@ allocator<T>::allocator(cudaStream_t stream)
 template <typename T>
 typename allocator<T>::pointer allocator<T>::allocate(allocator<T>::size_type size) {
   value_type* buffer = nullptr;
-  if (size > 0) {
+  if (size > 0 && caching_allocator::enabled()) {
+    auto& alloc = caching_allocator::instance();
+    buffer = static_cast<value_type*>(
+      alloc.allocate(size * sizeof(value_type), m_stream));
+  }
+  else if (size > 0) {
 #ifdef HYDROGEN_HAVE_CUB
     auto& memory_pool = El::cub::MemoryPool();
     CHECK_CUDA(memory_pool.DeviceAllocate(reinterpret_cast<void**>(&buffer),
@@ -586,7 +591,10 @@ template <typename T>
 void allocator<T>::deallocate(allocator<T>::pointer buffer,
                               allocator<T>::size_type size) {
   auto&& ptr = buffer.get();
-  if (ptr != nullptr) {
+  if (ptr != nullptr && caching_allocator::enabled()) {
+    caching_allocator::instance().deallocate(ptr);
+  }
+  else if (ptr != nullptr) {
 #ifdef HYDROGEN_HAVE_CUB
     auto& memory_pool = El::cub::MemoryPool();
     CHECK_CUDA(memory_pool.DeviceFree(ptr));
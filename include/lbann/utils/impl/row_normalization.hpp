@@ -0,0 +1,350 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <thrust/pair.h>
+
+namespace lbann {
+namespace cuda {
+namespace row_normalization_impl {
+
+/** Rows handled by each block in the warp-per-row kernels. */
+constexpr El::Int warp_rows_per_block = 4;
+/** Block size for the block-per-row kernels. */
+constexpr size_t block_size = 256;
+/** Maximum number of blocks per launch. */
+constexpr El::Int max_grid_size = 65535;
+
+/** Functor for adding @c thrust::pair objects. */
+template <typename Pair>
+struct pair_sum {
+  __device__ __forceinline__
+  Pair operator()(const Pair& x, const Pair& y) {
+    return Pair(x.first+y.first, x.second+y.second);
+  }
+};
+
+/** Sum over the threads in a warp. Every lane gets the result. */
+template <typename TensorDataType>
+__device__ __forceinline__
+TensorDataType warp_sum(TensorDataType val) {
+  for (int offset = 16; offset > 0; offset /= 2) {
+    val += __shfl_xor_sync(0xffffffff, val, offset);
+  }
+  return val;
+}
+
+/** Offset of a row within a matrix. */
+__device__ __forceinline__
+El::Int row_offset(El::Int row, El::Int rows_per_col, El::Int row_size,
+                   El::Int ldim) {
+  return (row % rows_per_col) * row_size + (row / rows_per_col) * ldim;
+}
+
+/** Mean and unbiased variance from a sum and a sum of squares. */
+template <typename TensorDataType>
+__device__ __forceinline__
+void compute_statistics(TensorDataType sum, TensorDataType sqsum,
+                        El::Int row_size,
+                        TensorDataType& mean, TensorDataType& var) {
+  const TensorDataType n(row_size);
+  mean = sum / n;
+  const auto sqmean = sqsum / n;
+  var = (sqmean - mean*mean) * n / TensorDataType(row_size - 1);
+  var = cuda::max(var, TensorDataType(0.));
+}
+
+/** Normalize a row once its statistics are known. */
+template <typename TensorDataType>
+__device__ __forceinline__
+void normalize_row(El::Int begin, El::Int step, El::Int row_size,
+                   TensorDataType mean, TensorDataType inv_stdev,
+                   const TensorDataType* __restrict__ x,
+                   TensorDataType* __restrict__ y) {
+  for (El::Int j = begin; j < row_size; j += step) {
+    y[j] = (x[j] - mean) * inv_stdev;
+  }
+}
+
+/** Compute gradient w.r.t. a row once the gradients w.r.t. its
+ *  statistics are known.
+ *
+ *  dL/dx_i = ( dL/dy_i / sqrt(var+epsilon)
+ *              + dL/dmean / n
+ *              + dL/dvar * (x_i - mean) * 2/(n-1) )
+ */
+template <typename TensorDataType>
+__device__ __forceinline__
+void backprop_row(El::Int begin, El::Int step, El::Int row_size,
+                  TensorDataType mean, TensorDataType inv_stdev,
+                  TensorDataType dmean, TensorDataType dvar,
+                  const TensorDataType* __restrict__ x,
+                  const TensorDataType* __restrict__ dy,
+                  TensorDataType* __restrict__ dx) {
+  const TensorDataType dmean_term = dmean / TensorDataType(row_size);
+  const TensorDataType dvar_scale
+    = dvar * TensorDataType(2) / TensorDataType(row_size - 1);
+  for (El::Int j = begin; j < row_size; j += step) {
+    dx[j] = dy[j] * inv_stdev + dmean_term + dvar_scale * (x[j] - mean);
+  }
+}
+
+/** Forward prop with one warp per row.
+ *
+ *  Block dimensions: 32 x warp_rows_per_block x 1
+ */
+template <typename TensorDataType>
+__global__ void fp_warp_kernel(
+  El::Int num_rows, El::Int rows_per_col, El::Int row_size,
+  TensorDataType epsilon,
+  const TensorDataType* __restrict__ input, El::Int input_ldim,
+  TensorDataType* __restrict__ output, El::Int output_ldim,
+  TensorDataType* __restrict__ means, El::Int means_stride,
+  TensorDataType* __restrict__ vars, El::Int vars_stride) {
+  const El::Int lane = threadIdx.x;
+  const El::Int num_rows_per_iter = blockDim.y * gridDim.x;
+  for (El::Int row = threadIdx.y + blockIdx.x * blockDim.y;
+       row < num_rows;
+       row += num_rows_per_iter) {
+    const auto* x = input + row_offset(row, rows_per_col, row_size, input_ldim);
+    auto* y = output + row_offset(row, rows_per_col, row_size, output_ldim);
+    TensorDataType sum(0.), sqsum(0.);
+    for (El::Int j = lane; j < row_size; j += 32) {
+      const auto& val = x[j];
+      sum += val;
+      sqsum += val * val;
+    }
+    sum = warp_sum(sum);
+    sqsum = warp_sum(sqsum);
+    TensorDataType mean, var;
+    compute_statistics(sum, sqsum, row_size, mean, var);
+    normalize_row(lane, 32, row_size, mean, cuda::rsqrt(var + epsilon), x, y);
+    if (lane == 0) {
+      means[row*means_stride] = mean;
+      vars[row*vars_stride] = var;
+    }
+  }
+}
+
+/** Forward prop with one block per row.
+ *
+ *  Block dimensions: block_size x 1 x 1
+ */
+template <typename TensorDataType>
+__global__ void fp_block_kernel(
+  El::Int num_rows, El::Int rows_per_col, El::Int row_size,
+  TensorDataType epsilon,
+  const TensorDataType* __restrict__ input, El::Int input_ldim,
+  TensorDataType* __restrict__ output, El::Int output_ldim,
+  TensorDataType* __restrict__ means, El::Int means_stride,
+  TensorDataType* __restrict__ vars, El::Int vars_stride) {
+  using pair_t = thrust::pair<TensorDataType,TensorDataType>;
+  __shared__ TensorDataType shared_statistics[2];
+  const El::Int tid = threadIdx.x;
+  for (El::Int row = blockIdx.x; row < num_rows; row += gridDim.x) {
+    const auto* x = input + row_offset(row, rows_per_col, row_size, input_ldim);
+    auto* y = output + row_offset(row, rows_per_col, row_size, output_ldim);
+    pair_t sum_sqsum(0., 0.);
+    for (El::Int j = tid; j < row_size; j += block_size) {
+      const auto& val = x[j];
+      sum_sqsum.first += val;
+      sum_sqsum.second += val * val;
+    }
+    sum_sqsum = cuda::block_reduce<block_size,1,1,pair_t,pair_sum<pair_t>>(sum_sqsum);
+    if (tid == 0) {
+      TensorDataType mean, var;
+      compute_statistics(sum_sqsum.first, sum_sqsum.second, row_size, mean, var);
+      shared_statistics[0] = mean;
+      shared_statistics[1] = var;
+      means[row*means_stride] = mean;
+      vars[row*vars_stride] = var;
+    }
+    __syncthreads();
+    const auto mean = shared_statistics[0];
+    const auto var = shared_statistics[1];
+    normalize_row(tid, block_size, row_size, mean, cuda::rsqrt(var + epsilon), x, y);
+    __syncthreads();
+  }
+}
+
+/** Backprop with one warp per row.
+ *
+ *  Block dimensions: 32 x warp_rows_per_block x 1
+ */
+template <typename TensorDataType>
+__global__ void bp_warp_kernel(
+  El::Int num_rows, El::Int rows_per_col, El::Int row_size,
+  TensorDataType epsilon,
+  const TensorDataType* __restrict__ input, El::Int input_ldim,
+  const TensorDataType* __restrict__ output_grad, El::Int output_grad_ldim,
+  TensorDataType* __restrict__ input_grad, El::Int input_grad_ldim,
+  const TensorDataType* __restrict__ means, El::Int means_stride,
+  const TensorDataType* __restrict__ vars, El::Int vars_stride) {
+  const El::Int lane = threadIdx.x;
+  const El::Int num_rows_per_iter = blockDim.y * gridDim.x;
+  for (El::Int row = threadIdx.y + blockIdx.x * blockDim.y;
+       row < num_rows;
+       row += num_rows_per_iter) {
+    const auto* x = input + row_offset(row, rows_per_col, row_size, input_ldim);
+    const auto* dy = output_grad + row_offset(row, rows_per_col, row_size, output_grad_ldim);
+    auto* dx = input_grad + row_offset(row, rows_per_col, row_size, input_grad_ldim);
+    const auto mean = means[row*means_stride];
+    const auto inv_stdev = cuda::rsqrt(vars[row*vars_stride] + epsilon);
+    TensorDataType dy_sum(0.), dy_x_sum(0.);
+    for (El::Int j = lane; j < row_size; j += 32) {
+      dy_sum += dy[j];
+      dy_x_sum += dy[j] * (x[j] - mean);
+    }
+    dy_sum = warp_sum(dy_sum);
+    dy_x_sum = warp_sum(dy_x_sum);
+    const TensorDataType dmean = -dy_sum * inv_stdev;
+    const TensorDataType dvar
+      = -dy_x_sum * inv_stdev*inv_stdev*inv_stdev / TensorDataType(2);
+    backprop_row(lane, 32, row_size, mean, inv_stdev, dmean, dvar, x, dy, dx);
+  }
+}
+
+/** Backprop with one block per row.
+ *
+ *  Block dimensions: block_size x 1 x 1
+ */
+template <typename TensorDataType>
+__global__ void bp_block_kernel(
+  El::Int num_rows, El::Int rows_per_col, El::Int row_size,
+  TensorDataType epsilon,
+  const TensorDataType* __restrict__ input, El::Int input_ldim,
+  const TensorDataType* __restrict__ output_grad, El::Int output_grad_ldim,
+  TensorDataType* __restrict__ input_grad, El::Int input_grad_ldim,
+  const TensorDataType* __restrict__ means, El::Int means_stride,
+  const TensorDataType* __restrict__ vars, El::Int vars_stride) {
+  using pair_t = thrust::pair<TensorDataType,TensorDataType>;
+  __shared__ TensorDataType shared_grads[2];
+  const El::Int tid = threadIdx.x;
+  for (El::Int row = blockIdx.x; row < num_rows; row += gridDim.x) {
+    const auto* x = input + row_offset(row, rows_per_col, row_size, input_ldim);
+    const auto* dy = output_grad + row_offset(row, rows_per_col, row_size, output_grad_ldim);
+    auto* dx = input_grad + row_offset(row, rows_per_col, row_size, input_grad_ldim);
+    const auto mean = means[row*means_stride];
+    const auto inv_stdev = cuda::rsqrt(vars[row*vars_stride] + epsilon);
+    pair_t sums(0., 0.);
+    for (El::Int j = tid; j < row_size; j += block_size) {
+      sums.first += dy[j];
+      sums.second += dy[j] * (x[j] - mean);
+    }
+    sums = cuda::block_reduce<block_size,1,1,pair_t,pair_sum<pair_t>>(sums);
+    if (tid == 0) {
+      shared_grads[0] = -sums.first * inv_stdev;
+      shared_grads[1]
+        = -sums.second * inv_stdev*inv_stdev*inv_stdev / TensorDataType(2);
+    }
+    __syncthreads();
+    backprop_row(tid, block_size, row_size, mean, inv_stdev,
+                 shared_grads[0], shared_grads[1], x, dy, dx);
+    __syncthreads();
+  }
+}
+
+} // namespace row_normalization_impl
+
+template <typename TensorDataType>
+void fused_row_normalization_forward(
+  row_normalization_kernel kernel,
+  El::Int num_rows, El::Int rows_per_col, El::Int row_size,
+  TensorDataType epsilon,
+  const TensorDataType* input, El::Int input_ldim,
+  TensorDataType* output, El::Int output_ldim,
+  TensorDataType* means, El::Int means_stride,
+  TensorDataType* vars, El::Int vars_stride,
+  cudaStream_t stream) {
+  using namespace row_normalization_impl;
+  if (num_rows < 1 || row_size < 1) { return; }
+  dim3 block_dims, grid_dims;
+  switch (kernel) {
+  case row_normalization_kernel::warp:
+    block_dims.x = 32;
+    block_dims.y = warp_rows_per_block;
+    grid_dims.x = std::min((num_rows + warp_rows_per_block - 1) / warp_rows_per_block,
+                           max_grid_size);
+    fp_warp_kernel<<<grid_dims, block_dims, 0, stream>>>(
+      num_rows, rows_per_col, row_size, epsilon,
+      input, input_ldim, output, output_ldim,
+      means, means_stride, vars, vars_stride);
+    break;
+  case row_normalization_kernel::block:
+    block_dims.x = block_size;
+    grid_dims.x = std::min(num_rows, max_grid_size);
+    fp_block_kernel<<<grid_dims, block_dims, 0, stream>>>(
+      num_rows, rows_per_col, row_size, epsilon,
+      input, input_ldim, output, output_ldim,
+      means, means_stride, vars, vars_stride);
+    break;
+  default:
+    LBANN_ERROR("invalid kernel variant for fused row normalization");
+  }
+}
+
+template <typename TensorDataType>
+void fused_row_normalization_backward(
+  row_normalization_kernel kernel,
+  El::Int num_rows, El::Int rows_per_col, El::Int row_size,
+  TensorDataType epsilon,
+  const TensorDataType* input, El::Int input_ldim,
+  const TensorDataType* output_grad, El::Int output_grad_ldim,
+  TensorDataType* input_grad, El::Int input_grad_ldim,
+  const TensorDataType* means, El::Int means_stride,
+  const TensorDataType* vars, El::Int vars_stride,
+  cudaStream_t stream) {
+  using namespace row_normalization_impl;
+  if (num_rows < 1 || row_size < 1) { return; }
+  dim3 block_dims, grid_dims;
+  switch (kernel) {
+  case row_normalization_kernel::warp:
+    block_dims.x = 32;
+    block_dims.y = warp_rows_per_block;
+    grid_dims.x = std::min((num_rows + warp_rows_per_block - 1) / warp_rows_per_block,
+                           max_grid_size);
+    bp_warp_kernel<<<grid_dims, block_dims, 0, stream>>>(
+      num_rows, rows_per_col, row_size, epsilon,
+      input, input_ldim, output_grad, output_grad_ldim,
+      input_grad, input_grad_ldim,
+      means, means_stride, vars, vars_stride);
+    break;
+  case row_normalization_kernel::block:
+    block_dims.x = block_size;
+    grid_dims.x = std::min(num_rows, max_grid_size);
+    bp_block_kernel<<<grid_dims, block_dims, 0, stream>>>(
+      num_rows, rows_per_col, row_size, epsilon,
+      input, input_ldim, output_grad, output_grad_ldim,
+      input_grad, input_grad_ldim,
+      means, means_stride, vars, vars_stride);
+    break;
+  default:
+    LBANN_ERROR("invalid kernel variant for fused row normalization");
+  }
+}
+
+} // namespace cuda
+} // namespace lbann
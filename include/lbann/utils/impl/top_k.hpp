@@ -0,0 +1,280 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <thrust/sort.h>
+#include <thrust/device_ptr.h>
+
+namespace lbann {
+namespace cuda {
+namespace top_k_impl {
+
+/** Whether @c a comes before @c b in a top-k list. */
+template <typename TensorDataType>
+__host__ __device__ __forceinline__
+bool is_before(const top_k_entry<TensorDataType>& a,
+               const top_k_entry<TensorDataType>& b) {
+  return a.value > b.value || (a.value == b.value && a.index < b.index);
+}
+
+/** Comparison operation to sort sparse vector entries. */
+template <typename TensorDataType>
+struct entry_compare
+  : ::thrust::binary_function<top_k_entry<TensorDataType>,
+                              top_k_entry<TensorDataType>,
+                              bool> {
+  __host__ __device__ bool operator()(const top_k_entry<TensorDataType>& a,
+                                      const top_k_entry<TensorDataType>& b) const {
+    return is_before(a, b);
+  }
+};
+
+/** Load entries from a dense matrix. */
+template <typename TensorDataType>
+struct dense_loader {
+  const TensorDataType* matrix;
+  El::Int ldim;
+  El::Int col_shift;
+  El::Int col_stride;
+  __device__ __forceinline__
+  top_k_entry<TensorDataType> operator()(El::Int row, El::Int col) const {
+    return {matrix[row + col * ldim], col_shift + row * col_stride};
+  }
+};
+
+/** Load entries from blocks of entry arrays. */
+template <typename TensorDataType>
+struct entry_loader {
+  const top_k_entry<TensorDataType>* input;
+  El::Int ldim;
+  El::Int block_height;
+  El::Int block_stride;
+  __device__ __forceinline__
+  top_k_entry<TensorDataType> operator()(El::Int row, El::Int col) const {
+    const auto& block = row / block_height;
+    const auto& block_row = row % block_height;
+    return input[block_row + col * ldim + block * block_stride];
+  }
+};
+
+/** @brief Top-k entries with one thread block per column.
+ *
+ *  Each thread keeps a sorted list of its k best entries, and the
+ *  lists are merged pairwise in shared memory.
+ */
+template <El::Int max_k, El::Int block_size,
+          typename TensorDataType, typename Loader>
+__global__ void block_top_k_kernel(El::Int k,
+                                   El::Int height,
+                                   El::Int width,
+                                   Loader load,
+                                   El::Int pad_index,
+                                   top_k_entry<TensorDataType>* __restrict__ entries,
+                                   El::Int entries_ldim) {
+  const El::Int tid = threadIdx.x;
+  __shared__ top_k_entry<TensorDataType> shared_entries[block_size * max_k];
+  top_k_entry<TensorDataType> pad;
+  pad.value = -cuda::infinity<TensorDataType>();
+  pad.index = pad_index;
+
+  for (El::Int col = blockIdx.x; col < width; col += gridDim.x) {
+
+    // Private top-k list for each thread
+    top_k_entry<TensorDataType> list[max_k];
+    for (El::Int i = 0; i < k; ++i) { list[i] = pad; }
+    for (El::Int row = tid; row < height; row += block_size) {
+      const auto entry = load(row, col);
+      if (is_before(entry, list[k-1])) {
+        El::Int pos = k-1;
+        for (; pos > 0 && is_before(entry, list[pos-1]); --pos) {
+          list[pos] = list[pos-1];
+        }
+        list[pos] = entry;
+      }
+    }
+
+    // Merge lists in shared memory
+    auto* my_list = &shared_entries[tid * k];
+    for (El::Int i = 0; i < k; ++i) { my_list[i] = list[i]; }
+    for (El::Int stride = block_size / 2; stride > 0; stride /= 2) {
+      __syncthreads();
+      if (tid < stride) {
+        const auto* other_list = &shared_entries[(tid + stride) * k];
+        El::Int pos = 0, other_pos = 0;
+        for (El::Int i = 0; i < k; ++i) {
+          if (is_before(other_list[other_pos], my_list[pos])) {
+            list[i] = other_list[other_pos++];
+          } else {
+            list[i] = my_list[pos++];
+          }
+        }
+        for (El::Int i = 0; i < k; ++i) { my_list[i] = list[i]; }
+      }
+    }
+    __syncthreads();
+    for (El::Int i = tid; i < k; i += block_size) {
+      entries[i + col * entries_ldim] = shared_entries[i];
+    }
+    __syncthreads();
+
+  }
+
+}
+
+/** Copy entries into a padded array for sorting. */
+template <typename TensorDataType, typename Loader>
+__global__ void load_entries_kernel(El::Int height,
+                                    El::Int padded_height,
+                                    El::Int width,
+                                    Loader load,
+                                    El::Int pad_index,
+                                    top_k_entry<TensorDataType>* __restrict__ entries,
+                                    El::Int* __restrict__ entries_cols) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int num_threads = blockDim.x * gridDim.x;
+  const El::Int size = padded_height * width;
+  for (El::Int i = gid; i < size; i += num_threads) {
+    const auto& row = i % padded_height;
+    const auto& col = i / padded_height;
+    if (row < height) {
+      entries[i] = load(row, col);
+    } else {
+      entries[i].value = -cuda::infinity<TensorDataType>();
+      entries[i].index = pad_index;
+    }
+    entries_cols[i] = col;
+  }
+}
+
+/** @brief Top-k entries by sorting all columns at once.
+ *
+ *  Entries are sorted by value and then stably by column, so each
+ *  column is sorted with two sorts of the whole matrix.
+ */
+template <typename TensorDataType, typename Loader>
+void sort_top_k(El::Int k,
+                El::Int height,
+                El::Int width,
+                Loader load,
+                El::Int pad_index,
+                top_k_entry<TensorDataType>* entries,
+                El::Int entries_ldim,
+                cudaStream_t stream) {
+  cuda::thrust::allocator<> alloc(stream);
+  const auto& padded_height = std::max(height, k);
+  const auto& size = padded_height * width;
+  const El::Int block_dim = 256;
+  const El::Int grid_dim = (size + block_dim - 1) / block_dim;
+  cuda::thrust::vector<top_k_entry<TensorDataType>> sorted_entries(size);
+  cuda::thrust::vector<El::Int> sorted_entries_cols(size);
+  load_entries_kernel<<<grid_dim, block_dim, 0, stream>>>(
+    height, padded_height, width, load, pad_index,
+    sorted_entries.data().get(), sorted_entries_cols.data().get());
+  ::thrust::sort_by_key(alloc.system(),
+                        sorted_entries.begin(),
+                        sorted_entries.end(),
+                        sorted_entries_cols.begin(),
+                        entry_compare<TensorDataType>());
+  ::thrust::stable_sort_by_key(alloc.system(),
+                               sorted_entries_cols.begin(),
+                               sorted_entries_cols.end(),
+                               sorted_entries.begin());
+  CHECK_CUDA(cudaMemcpy2DAsync(entries,
+                               entries_ldim * sizeof(top_k_entry<TensorDataType>),
+                               sorted_entries.data().get(),
+                               padded_height * sizeof(top_k_entry<TensorDataType>),
+                               k * sizeof(top_k_entry<TensorDataType>),
+                               width,
+                               cudaMemcpyDeviceToDevice,
+                               stream));
+}
+
+template <typename TensorDataType, typename Loader>
+void top_k_columns(El::Int k,
+                   El::Int height,
+                   El::Int width,
+                   Loader load,
+                   El::Int pad_index,
+                   top_k_entry<TensorDataType>* entries,
+                   El::Int entries_ldim,
+                   cudaStream_t stream) {
+  if (k < 1 || width < 1) { return; }
+  constexpr El::Int block_size = 64;
+  dim3 block_dims, grid_dims;
+  block_dims.x = block_size;
+  grid_dims.x = std::min(width, El::Int(65535));
+  if (k <= 4) {
+    block_top_k_kernel<4, block_size><<<grid_dims, block_dims, 0, stream>>>(
+      k, height, width, load, pad_index, entries, entries_ldim);
+  } else if (k <= 8) {
+    block_top_k_kernel<8, block_size><<<grid_dims, block_dims, 0, stream>>>(
+      k, height, width, load, pad_index, entries, entries_ldim);
+  } else if (k <= 16) {
+    block_top_k_kernel<16, block_size><<<grid_dims, block_dims, 0, stream>>>(
+      k, height, width, load, pad_index, entries, entries_ldim);
+  } else if (k <= 32) {
+    block_top_k_kernel<32, block_size><<<grid_dims, block_dims, 0, stream>>>(
+      k, height, width, load, pad_index, entries, entries_ldim);
+  } else {
+    sort_top_k(k, height, width, load, pad_index,
+               entries, entries_ldim, stream);
+  }
+}
+
+} // namespace top_k_impl
+
+template <typename TensorDataType>
+void top_k_columns(El::Int k,
+                   El::Int height, El::Int width,
+                   const TensorDataType* matrix, El::Int matrix_ldim,
+                   El::Int col_shift, El::Int col_stride,
+                   El::Int pad_index,
+                   top_k_entry<TensorDataType>* entries,
+                   El::Int entries_ldim,
+                   cudaStream_t stream) {
+  const top_k_impl::dense_loader<TensorDataType> load{
+    matrix, matrix_ldim, col_shift, col_stride};
+  top_k_impl::top_k_columns(k, height, width, load, pad_index,
+                            entries, entries_ldim, stream);
+}
+
+template <typename TensorDataType>
+void top_k_columns(El::Int k,
+                   El::Int block_height, El::Int num_blocks, El::Int width,
+                   const top_k_entry<TensorDataType>* input,
+                   El::Int input_ldim, El::Int block_stride,
+                   El::Int pad_index,
+                   top_k_entry<TensorDataType>* entries,
+                   El::Int entries_ldim,
+                   cudaStream_t stream) {
+  const top_k_impl::entry_loader<TensorDataType> load{
+    input, input_ldim, block_height, block_stride};
+  top_k_impl::top_k_columns(k, block_height * num_blocks, width, load,
+                            pad_index, entries, entries_ldim, stream);
+}
+
+} // namespace cuda
+} // namespace lbann
@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_IO_PROFILE_HPP_INCLUDED
+#define LBANN_UTILS_IO_PROFILE_HPP_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lbann {
+
+/** @brief Time I/O threads spend in the stages of a data fetch.
+ *
+ *  Each thread that fetches data has its own counters: the time it
+ *  spends fetching mini-batch chunks (@c busy_scope), the samples it
+ *  fetches, and how much of the busy time is spent reading, decoding,
+ *  and transforming samples (@c scope). Data readers that do not
+ *  mark their stages have all of their time attributed to "other".
+ *  Counters are only written by their own thread, so recording is
+ *  cheap, and they can be read from any thread with @c snapshot.
+ *
+ *  When profiling is disabled, each scope costs one relaxed atomic
+ *  load.
+ */
+namespace io_profile {
+
+/** Stage of fetching a sample. */
+enum class stage : uint8_t {
+  read,
+  decode,
+  transform,
+  num_stages
+};
+
+constexpr size_t num_stages = static_cast<size_t>(stage::num_stages);
+
+/** Human-readable name for a stage. */
+const char* to_string(stage s);
+
+namespace details {
+extern std::atomic<bool> enabled;
+/** Add to this thread's counters. */
+void add_stage_time(stage s, uint64_t ns);
+void add_busy_time(uint64_t ns);
+/** Nesting depth of a stage on this thread. */
+int& stage_depth(stage s);
+inline uint64_t now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+} // namespace details
+
+/** Whether fetches are being recorded. */
+inline bool enabled() noexcept {
+  return details::enabled.load(std::memory_order_relaxed);
+}
+
+/** Start recording fetches. */
+void enable();
+/** Stop recording fetches. Counters are kept. */
+void disable();
+
+/** @brief Attribute the lifetime of the object to a stage.
+ *
+ *  Nested scopes of the same stage are only counted once.
+ */
+class scope {
+public:
+  explicit scope(stage s) : m_stage(s), m_counted(enabled()), m_start(0) {
+    if (m_counted && details::stage_depth(s)++ == 0) {
+      m_start = details::now();
+    }
+  }
+  ~scope() {
+    if (m_counted && --details::stage_depth(m_stage) == 0) {
+      details::add_stage_time(m_stage, details::now() - m_start);
+    }
+  }
+  scope(const scope&) = delete;
+  scope& operator=(const scope&) = delete;
+private:
+  stage m_stage;
+  bool m_counted;
+  uint64_t m_start;
+};
+
+/** @brief Mark the lifetime of the object as time spent fetching. */
+class busy_scope {
+public:
+  busy_scope() : m_start(enabled() ? details::now() : 0) {}
+  ~busy_scope() {
+    if (m_start != 0) { details::add_busy_time(details::now() - m_start); }
+  }
+  busy_scope(const busy_scope&) = delete;
+  busy_scope& operator=(const busy_scope&) = delete;
+private:
+  uint64_t m_start;
+};
+
+/** Count samples fetched by this thread. */
+void add_samples(size_t num_samples);
+
+/** Counters of one thread. Times are in seconds. */
+struct thread_stats {
+  double busy_time = 0;
+  double stage_time[num_stages] = {};
+  uint64_t num_samples = 0;
+  /** Busy time not attributed to a stage. */
+  double other_time() const;
+};
+
+/** @brief Counters of each thread that has fetched data.
+ *
+ *  Threads are in the order they first recorded a fetch, so
+ *  successive snapshots can be differenced entry by entry.
+ */
+std::vector<thread_stats> snapshot();
+
+} // namespace io_profile
+} // namespace lbann
+
+#endif // LBANN_UTILS_IO_PROFILE_HPP_INCLUDED
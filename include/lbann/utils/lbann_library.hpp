@@ -51,6 +51,43 @@ std::unique_ptr<model> build_model_from_prototext(
     std::vector<std::shared_ptr<callback_base>>& shared_callbacks,
     int training_dr_linearized_data_size);
 
+/** @brief Regroup the processes into trainers of a different size.
+ *
+ *  Collective over the world. The weights and optimizer state of @c
+ *  old_model are copied to host memory, the communicators are split
+ *  again, and the data readers and data stores of @c t are
+ *  repartitioned. The model is then rebuilt from the prototext, set
+ *  up, and given the saved state and the execution contexts of @c
+ *  old_model, so training resumes where it stopped. Each new trainer
+ *  takes the state of its master process.
+ *
+ *  @returns The rebuilt model. @c old_model is destroyed.
+ */
+std::unique_ptr<model> resize_trainer(
+    int procs_per_trainer,
+    std::unique_ptr<model> old_model,
+    trainer& t,
+    int argc, char **argv,
+    lbann_data::LbannPB &pb,
+    lbann_comm *comm,
+    options *opts,
+    int training_dr_linearized_data_size);
+
+/** @brief Keep one copy per node of the weight values of @c m.
+ *
+ *  For replicas of a model with one process per trainer, e.g. for
+ *  inference. Collective over the node. The node's first process
+ *  writes its CPU weight values into a shared memory segment, and
+ *  the weights of every process on the node then use the segment
+ *  in place of their own matrices, so only the first process needs
+ *  to load them. The segment is mapped copy-on-write, so a process
+ *  that changes its weights afterwards only changes its own copy of
+ *  the pages. Weights on the GPU are left alone.
+ *
+ *  @returns The mapping; it must outlive the model.
+ */
+std::shared_ptr<void> share_weights_on_node(model& m, lbann_comm& comm);
+
 void print_lbann_configuration(lbann_comm *comm,
                                int io_threads_per_process,
                                int io_threads_offset);
@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_MAPPED_FILE_HPP_INCLUDED
+#define LBANN_UTILS_MAPPED_FILE_HPP_INCLUDED
+
+#include <cstddef>
+#include <string>
+
+namespace lbann {
+
+/** @brief A read-only, shared memory mapping of a whole file.
+ *
+ *  Pages are faulted in on access, so resident memory follows what is
+ *  actually read rather than the file size.
+ */
+class mapped_file {
+ public:
+  explicit mapped_file(const std::string& filename);
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+  ~mapped_file();
+
+  const char* data() const { return static_cast<const char*>(m_addr); }
+  size_t size() const { return m_size; }
+
+ private:
+  void* m_addr = nullptr;
+  size_t m_size = 0u;
+};
+
+} // namespace lbann
+
+#endif // LBANN_UTILS_MAPPED_FILE_HPP_INCLUDED
@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_MEMORY_USAGE_HPP_INCLUDED
+#define LBANN_UTILS_MEMORY_USAGE_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+#include <memory>
+
+namespace lbann {
+
+/** @brief Bytes of local memory owned by a matrix on a device.
+ *
+ *  Zero for views, which do not own their memory, and for matrices
+ *  on other devices.
+ */
+template <typename T>
+size_t get_local_memory_usage(const El::AbstractDistMatrix<T>& m,
+                              El::Device device) {
+  if (m.Viewing() || m.GetLocalDevice() != device) { return 0; }
+  const auto& local = m.LockedMatrix();
+  return sizeof(T) * local.LDim() * local.Width();
+}
+
+template <typename T>
+size_t get_local_memory_usage(const std::unique_ptr<El::AbstractDistMatrix<T>>& m,
+                              El::Device device) {
+  return m == nullptr ? 0 : get_local_memory_usage(*m, device);
+}
+
+template <typename T>
+size_t get_local_memory_usage(const std::shared_ptr<El::AbstractDistMatrix<T>>& m,
+                              El::Device device) {
+  return m == nullptr ? 0 : get_local_memory_usage(*m, device);
+}
+
+} // namespace lbann
+
+#endif // LBANN_UTILS_MEMORY_USAGE_HPP_INCLUDED
@@ -0,0 +1,178 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_METADATA_BUNDLE_HPP_INCLUDED
+#define LBANN_UTILS_METADATA_BUNDLE_HPP_INCLUDED
+
+#include "lbann/comm.hpp"
+#include "lbann/utils/exception.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace lbann {
+
+/** @brief Startup metadata shared from a root process in one message
+ *
+ *  Data readers build sample indices, offsets, labels and similar
+ *  structures on one process and share them with the others. Sent one
+ *  structure at a time, each needs its own broadcast (and often a
+ *  second one for its size). A bundle packs all of them into one
+ *  buffer that is sent with a single broadcast.
+ *
+ *  The root puts entries; after @c share, every process gets them
+ *  back in the same order. Entries are trivially copyable scalars,
+ *  vectors of them, and strings.
+ *
+ *  With a cache directory (e.g. on node-local disk), shared bundles
+ *  are also saved there, keyed by a hash of the input files and the
+ *  reader parameters. A rerun then loads the bundle on every process
+ *  and skips both building and broadcasting.
+ */
+class metadata_bundle {
+public:
+
+  /** @brief Cache key of a bundle
+   *
+   *  FNV-1a hash of the values and files that determine the
+   *  bundle's contents. Files are hashed by path, size and
+   *  modification time.
+   */
+  class key {
+  public:
+    template <typename T>
+    key& add(const T& val) {
+      static_assert(std::is_trivially_copyable<T>::value,
+                    "metadata_bundle keys need trivially copyable values");
+      return add_bytes(&val, sizeof(T));
+    }
+    key& add(const std::string& str);
+    key& add_file(const std::string& path);
+    uint64_t value() const noexcept { return m_hash; }
+  private:
+    key& add_bytes(const void* data, size_t size);
+    uint64_t m_hash = 14695981039346656037ull;
+  };
+
+  /** Append a scalar (root). */
+  template <typename T>
+  void put(const T& val) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "metadata_bundle entries must be trivially copyable");
+    append(&val, sizeof(T));
+  }
+  /** Append a vector (root). */
+  template <typename T>
+  void put(const std::vector<T>& vals) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "metadata_bundle entries must be trivially copyable");
+    put(static_cast<uint64_t>(vals.size()));
+    append(vals.data(), vals.size() * sizeof(T));
+  }
+  void put(const std::string& str) {
+    put(static_cast<uint64_t>(str.size()));
+    append(str.data(), str.size());
+  }
+
+  /** Read the next scalar. */
+  template <typename T>
+  void get(T& val) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "metadata_bundle entries must be trivially copyable");
+    extract(&val, sizeof(T));
+  }
+  /** Read the next vector. */
+  template <typename T>
+  void get(std::vector<T>& vals) {
+    uint64_t size;
+    get(size);
+    vals.resize(size);
+    extract(vals.data(), size * sizeof(T));
+  }
+  void get(std::string& str) {
+    uint64_t size;
+    get(size);
+    str.resize(size);
+    extract(&str[0], size);
+  }
+
+  /** @brief Load a cached bundle on every process of @c c
+   *
+   *  Collective. Does nothing unless @c --metadata_cache_dir is set.
+   *  @returns Whether every process loaded the bundle. Otherwise it
+   *  has to be built and shared.
+   */
+  bool load_cached(lbann_comm& comm, const El::mpi::Comm& c,
+                   const std::string& name, const key& k);
+
+  /** @brief Broadcast the bundle from @c root over @c c
+   *
+   *  Collective. If it was keyed by @c load_cached, the bundle is
+   *  then saved to the cache by one process on each compute node.
+   */
+  void share(lbann_comm& comm, const El::mpi::Comm& c, int root = 0);
+
+  /** Write the bundle to a cache file. */
+  void save(const std::string& path, uint64_t k) const;
+  /** Read the bundle from a cache file.
+   *  @returns False if the file is missing or for another key. */
+  bool load(const std::string& path, uint64_t k);
+
+  /** Size of the packed entries in bytes. */
+  size_t size() const noexcept { return m_buffer.size(); }
+
+private:
+  void append(const void* data, size_t size) {
+    const auto* bytes = static_cast<const char*>(data);
+    m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+  }
+  void extract(void* data, size_t size) {
+    if (m_read_pos + size > m_buffer.size()) {
+      LBANN_ERROR("read past the end of a metadata bundle");
+    }
+    if (size > 0) {
+      std::memcpy(data, m_buffer.data() + m_read_pos, size);
+    }
+    m_read_pos += size;
+  }
+
+  /** Packed entries. */
+  std::vector<char> m_buffer;
+  /** Position of the next entry to read. */
+  size_t m_read_pos = 0;
+  /** Cache file for @c share, if any. */
+  std::string m_cache_path;
+  /** Key of the cache file. */
+  uint64_t m_cache_key = 0;
+};
+
+} // namespace lbann
+
+#endif // LBANN_UTILS_METADATA_BUNDLE_HPP_INCLUDED
@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_UTILS_MODEL_ESTIMATE_HPP_INCLUDED
+#define LBANN_UTILS_MODEL_ESTIMATE_HPP_INCLUDED
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace lbann {
+
+class model;
+
+/** @brief Estimated cost of one layer in one training step. */
+struct layer_estimate {
+  std::string name;
+  std::string type;
+  /** Forward plus backward prop FLOPs for the whole mini-batch. */
+  double flops = 0.0;
+  /** Bytes of outputs and error signals per process. */
+  double activation_bytes = 0.0;
+  /** Bytes of weight values per process. */
+  double weight_bytes = 0.0;
+  /** Bytes of gradients and optimizer state per process. */
+  double optimizer_bytes = 0.0;
+  /** Bytes sent by each process, including redistributions from
+   *  the parents. */
+  double comm_bytes = 0.0;
+  /** Seconds of compute and communication. */
+  double compute_time = 0.0;
+  double comm_time = 0.0;
+  /** Whether the compute time uses a measured layer rate. */
+  bool calibrated = false;
+};
+
+/** @brief Estimated cost of a training step of a model. */
+struct model_estimate {
+  std::string model_name;
+  int num_procs = 1;
+  int mini_batch_size = 1;
+  double flop_rate = 0.0;
+  double bandwidth = 0.0;
+  std::vector<layer_estimate> layers;
+  double flops = 0.0;
+  double activation_bytes = 0.0;
+  double weight_bytes = 0.0;
+  double optimizer_bytes = 0.0;
+  double comm_bytes = 0.0;
+  double step_time = 0.0;
+  /** Total bytes per process. */
+  double memory_bytes() const noexcept {
+    return activation_bytes + weight_bytes + optimizer_bytes;
+  }
+};
+
+/** @brief Estimate step time, memory and communication of a model.
+ *
+ *  The model must be set up but does not need to have run. FLOPs and
+ *  communication come from the cost model in
+ *  @c lbann::parallel_plan, using each layer's current data layout
+ *  and parallel strategy. Activation memory is computed from the
+ *  output dimensions at the maximum mini-batch size, without reuse
+ *  between layers; weight and optimizer memory are what setup
+ *  allocated. Values are per process unless noted.
+ *
+ *  @param m                The model.
+ *  @param mini_batch_size  Samples per training step.
+ *  @param calibration_file JSON report of the layer and
+ *                          communication benchmarks (see
+ *                          benchmarks/). Achieved GFLOP/s of each
+ *                          layer type on the model's device replace
+ *                          the default FLOP rate, and the fastest
+ *                          allreduce bus bandwidth replaces the
+ *                          default bandwidth. Ignored if empty.
+ */
+model_estimate estimate_model(const model& m,
+                              int mini_batch_size,
+                              const std::string& calibration_file = "");
+
+/** @brief Print a per-layer table and totals. */
+void print_model_estimate(const model_estimate& e, std::ostream& os);
+
+} // namespace lbann
+
+#endif // LBANN_UTILS_MODEL_ESTIMATE_HPP_INCLUDED
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_NUMA_HPP_INCLUDED
+#define LBANN_UTILS_NUMA_HPP_INCLUDED
+
+#include <cstddef>
+#include <string>
+
+namespace lbann {
+namespace numa {
+
+/** @brief How new host memory pages are spread over NUMA domains */
+enum class placement {
+  /** Leave it to the OS (pages go to the first thread to write). */
+  none,
+  /** Write the pages in a static OpenMP loop, so they land with the
+   *  threads that use them in static OpenMP loops. */
+  first_touch,
+  /** Spread the pages round-robin over all NUMA domains. Needs
+   *  hwloc; otherwise falls back to first touch. */
+  interleave,
+};
+
+/** @brief Placement chosen with --numa_placement (default: none) */
+placement get_placement();
+
+/** @brief Convert a placement from a string */
+placement placement_from_string(const std::string& str);
+
+/** @brief Place new memory pages.
+ *
+ *  Must be called after the memory is allocated and before it is
+ *  written, since a page stays where it was first touched. First
+ *  touch zeroes the memory.
+ */
+void place_pages(void* ptr, size_t bytes, placement p);
+
+/** @brief Place new memory pages with @c get_placement */
+inline void place_pages(void* ptr, size_t bytes) {
+  place_pages(ptr, bytes, get_placement());
+}
+
+} // namespace numa
+} // namespace lbann
+
+#endif // LBANN_UTILS_NUMA_HPP_INCLUDED
@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_UTILS_NVJPEG_HPP_INCLUDED
+#define LBANN_UTILS_NVJPEG_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+#ifdef LBANN_HAS_NVJPEG
+
+#include "lbann/transforms/vision/fused_image_op.hpp"
+#include <nvjpeg.h>
+
+#include <vector>
+
+namespace lbann {
+
+/**
+ * Batched JPEG decoding on the GPU with nvJPEG, followed by the fused
+ * crop/resize/flip/normalize kernel. Images are decoded to
+ * interleaved BGR, matching OpenCV, so the results agree with the CPU
+ * transform pipeline up to interpolation details. Not thread-safe;
+ * each I/O thread should use its own decoder.
+ */
+class nvjpeg_image_decoder {
+public:
+  nvjpeg_image_decoder();
+  nvjpeg_image_decoder(const nvjpeg_image_decoder&) = delete;
+  nvjpeg_image_decoder& operator=(const nvjpeg_image_decoder&) = delete;
+  ~nvjpeg_image_decoder();
+
+  /** Get the dims (channels, height, width) of the decoded image. */
+  std::vector<size_t> get_dims(const uint8_t* data, size_t size);
+
+  /**
+   * Decode images and apply their ops on stream, writing image i in
+   * LBANN's layout to column i of out.
+   * @param dims The dims returned by get_dims() for each image.
+   */
+  void decode_and_transform(const std::vector<const uint8_t*>& data,
+                            const std::vector<size_t>& sizes,
+                            const std::vector<std::vector<size_t>>& dims,
+                            const std::vector<transform::fused_image_op>& ops,
+                            size_t out_h, size_t out_w,
+                            El::Matrix<DataType, El::Device::GPU>& out,
+                            cudaStream_t stream);
+
+private:
+  /** Grow a device buffer to at least bytes, after the stream is idle. */
+  void reserve(void** buffer, size_t& capacity, size_t bytes,
+               cudaStream_t stream);
+
+  nvjpegHandle_t m_handle;
+  nvjpegJpegState_t m_state;
+  /** Decoded images, back to back. */
+  void* m_images = nullptr;
+  size_t m_images_capacity = 0;
+  /** Device copy of the tasks for the fused kernel. */
+  void* m_tasks = nullptr;
+  size_t m_tasks_capacity = 0;
+  std::vector<transform::fused_image_task> m_host_tasks;
+  std::vector<nvjpegImage_t> m_destinations;
+};
+
+} // namespace lbann
+
+#endif // LBANN_HAS_NVJPEG
+#endif // LBANN_UTILS_NVJPEG_HPP_INCLUDED
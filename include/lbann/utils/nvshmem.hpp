@@ -34,6 +34,8 @@
 
 #include "lbann/comm.hpp"
 
+#include <vector>
+
 namespace lbann {
 namespace nvshmem {
 
@@ -41,6 +43,30 @@ namespace nvshmem {
 void initialize(MPI_Comm comm);
 /// Finalize NVSHMEM library
 void finalize();
+/// Whether NVSHMEM has been initialized
+bool is_initialized() noexcept;
+
+/** @brief All-to-all of GPU buffers with NVSHMEM puts
+ *
+ *  Meant for small, frequent exchanges inside layers (e.g. sharded
+ *  embedding lookups). A kernel issues one put per destination
+ *  directly into the peer's symmetric workspace and signals its
+ *  arrival, so no host staging or MPI progress is involved in moving
+ *  the data. Only the byte counts and displacements are exchanged on
+ *  the host. The call returns once @c recv is filled.
+ *
+ *  Counts are in bytes, and buffers are in GPU memory. Processes are
+ *  numbered by their rank in @c c. The symmetric workspace can only
+ *  grow collectively, so every process in @c MPI_COMM_WORLD must call
+ *  this function the same number of times. LBANN trainers do so
+ *  because they run the same model.
+ */
+void all_to_all(const void* send,
+                const std::vector<size_t>& send_bytes,
+                void* recv,
+                const std::vector<size_t>& recv_bytes,
+                const El::mpi::Comm& c,
+                cudaStream_t stream);
 
 } // namespace nvshmem
 } // namespace lbann
@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_PARALLEL_PLAN_HPP_INCLUDED
+#define LBANN_UTILS_PARALLEL_PLAN_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+#include <string>
+#include <vector>
+
+namespace lbann {
+namespace parallel_plan {
+
+/** @brief How one layer is parallelized within a trainer.
+ *
+ *  The mini-batch is split over @c num_procs / @c spatial_groups
+ *  process groups and, for spatially decomposed layers (distconv),
+ *  the height dimension is split over @c spatial_groups processes.
+ */
+struct choice {
+  data_layout layout;
+  int spatial_groups;
+  choice(data_layout layout_ = data_layout::DATA_PARALLEL,
+         int spatial_groups_ = 1)
+    : layout(layout_), spatial_groups(spatial_groups_) {}
+  bool operator==(const choice& other) const noexcept {
+    return layout == other.layout && spatial_groups == other.spatial_groups;
+  }
+  bool operator!=(const choice& other) const noexcept {
+    return !(*this == other);
+  }
+};
+
+/** @brief What the cost model needs to know about a layer. */
+struct layer_info {
+  std::string name;
+  std::string type;
+  /** Indices of parent layers (earlier in the list). */
+  std::vector<size_t> parents;
+  std::vector<int> input_dims;
+  std::vector<int> output_dims;
+  /** Forward plus backward prop FLOPs per sample. */
+  double flops = 0.0;
+  /** Number of weight entries. */
+  double num_weights = 0.0;
+  /** Whether the layer has a model-parallel implementation. */
+  bool model_parallel = false;
+  /** Whether the layer can be spatially decomposed. */
+  bool spatial = false;
+  /** Rows exchanged with each neighbor when spatially decomposed. */
+  int halo = 0;
+  /** Parallelization the layer is currently using. */
+  choice current;
+  /** Measured forward plus backward prop seconds per step with
+   *  @c current, or negative if the layer was not profiled. */
+  double measured_time = -1.0;
+};
+
+/** @brief Machine and trainer parameters for the cost model. */
+struct machine {
+  int num_procs = 1;
+  int mini_batch_size = 1;
+  /** Sustained FLOP/s of one process. */
+  double flop_rate = 1e12;
+  /** Point-to-point bandwidth of one process in bytes/s. */
+  double bandwidth = 1e10;
+  /** Per-message latency in seconds. */
+  double latency = 1e-5;
+  /** Bytes per tensor entry. */
+  double entry_size = 4.0;
+};
+
+/** @brief Estimated seconds per training step. */
+struct cost {
+  double compute = 0.0;
+  double comm = 0.0;
+  double total() const noexcept { return compute + comm; }
+};
+
+/** @brief Parallelizations worth considering for a layer. */
+std::vector<choice> candidates(const layer_info& l, const machine& m);
+
+/** @brief Compute and communication within a layer.
+ *
+ *  Compute is the layer's FLOPs divided over the processes that have
+ *  work: a mini-batch smaller than the number of sample groups
+ *  leaves processes idle, which spatial decomposition recovers. If
+ *  the layer was profiled, its measured time is rescaled instead.
+ *  Communication is the weight gradient allreduce for data-parallel
+ *  layers, the activation and error signal exchanges of the
+ *  distributed GEMM for model-parallel layers, and halo exchanges for
+ *  spatially decomposed layers.
+ */
+cost layer_cost(const layer_info& l, const choice& c, const machine& m);
+
+/** @brief Redistributing a parent's output (and the error signal
+ *  coming back) between two parallelizations. */
+double redistribution_cost(const layer_info& parent,
+                           const choice& from,
+                           const choice& to,
+                           const machine& m);
+
+/** @brief Bytes each process sends per step within a layer.
+ *  @details The traffic behind the communication part of
+ *  @c layer_cost. */
+double layer_comm_bytes(const layer_info& l, const choice& c,
+                        const machine& m);
+
+/** @brief Bytes each process sends per step to redistribute a
+ *  parent's output. */
+double redistribution_bytes(const layer_info& parent,
+                            const choice& from,
+                            const choice& to,
+                            const machine& m);
+
+/** @brief A parallelization for every layer and its estimated cost. */
+struct plan {
+  std::vector<choice> choices;
+  std::vector<cost> layer_costs;
+  /** Redistribution cost into each layer from its parents. */
+  std::vector<double> redistribution_costs;
+  double total = 0.0;
+};
+
+/** @brief Estimate the step time of given parallelizations. */
+plan evaluate(const std::vector<layer_info>& layers,
+              const std::vector<choice>& choices,
+              const machine& m);
+
+/** @brief Search for low-cost parallelizations.
+ *
+ *  Starting from each layer's current parallelization, sweeps over
+ *  the layers and moves each one to the candidate minimizing its own
+ *  cost plus redistribution to and from its neighbors, until a sweep
+ *  changes nothing. Ties keep the current choice.
+ */
+plan search(const std::vector<layer_info>& layers,
+            const machine& m,
+            size_t max_sweeps = 16);
+
+} // namespace parallel_plan
+} // namespace lbann
+
+#endif // LBANN_UTILS_PARALLEL_PLAN_HPP_INCLUDED
@@ -0,0 +1,156 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_PHILOX_HPP_INCLUDED
+#define LBANN_UTILS_PHILOX_HPP_INCLUDED
+
+#include <cmath>
+#include <cstdint>
+
+#ifdef __CUDACC__
+#define LBANN_PHILOX_FUNC __host__ __device__ __forceinline__
+#else
+#define LBANN_PHILOX_FUNC inline
+#endif // __CUDACC__
+
+namespace lbann {
+namespace philox {
+
+/** @brief Philox-4x32-10 counter-based random number generator.
+ *
+ *  Maps a 128-bit counter and a 64-bit key to 128 random bits with
+ *  no internal state, so any entry of a random stream can be
+ *  regenerated on demand on the CPU or GPU. See:
+ *
+ *  John K. Salmon, Mark A. Moraes, Ron O. Dror, and David
+ *  E. Shaw. "Parallel random numbers: as easy as 1, 2, 3." In
+ *  Proceedings of SC11, pp. 1-12. 2011.
+ */
+struct uint32x4 { uint32_t x[4]; };
+
+LBANN_PHILOX_FUNC void mulhilo(uint32_t a, uint32_t b,
+                               uint32_t& hi, uint32_t& lo) {
+  const uint64_t product = static_cast<uint64_t>(a) * b;
+  hi = static_cast<uint32_t>(product >> 32);
+  lo = static_cast<uint32_t>(product);
+}
+
+LBANN_PHILOX_FUNC uint32x4 philox4x32_10(uint32x4 ctr,
+                                         uint32_t key0,
+                                         uint32_t key1) {
+  constexpr uint32_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u;
+  constexpr uint32_t W0 = 0x9E3779B9u, W1 = 0xBB67AE85u;
+  for (int round = 0; round < 10; ++round) {
+    uint32_t hi0, lo0, hi1, lo1;
+    mulhilo(M0, ctr.x[0], hi0, lo0);
+    mulhilo(M1, ctr.x[2], hi1, lo1);
+    ctr = {{hi1 ^ ctr.x[1] ^ key0, lo1, hi0 ^ ctr.x[3] ^ key1, lo0}};
+    key0 += W0;
+    key1 += W1;
+  }
+  return ctr;
+}
+
+/** @brief 128 random bits for entry @c index of stream @c seed. */
+LBANN_PHILOX_FUNC uint32x4 random_bits(uint64_t seed, uint64_t index) {
+  const uint32x4 ctr = {{static_cast<uint32_t>(index),
+                         static_cast<uint32_t>(index >> 32),
+                         0u, 0u}};
+  return philox4x32_10(ctr,
+                       static_cast<uint32_t>(seed),
+                       static_cast<uint32_t>(seed >> 32));
+}
+
+/** @brief Uniform random number in [0,1).
+ *
+ *  The same seed and index always give the same value.
+ */
+LBANN_PHILOX_FUNC float uniform(uint64_t seed, uint64_t index) {
+  return (random_bits(seed, index).x[0] >> 8) * (1.f / 16777216.f);
+}
+
+/** @brief Convert random bits to floating-point samples. */
+template <typename T> struct sampler;
+
+template <> struct sampler<float> {
+  /** Uniform sample in [0,1). */
+  static LBANN_PHILOX_FUNC float unit(uint32_t a, uint32_t) {
+    return (a >> 8) * (1.f / 16777216.f);
+  }
+  /** Standard normal sample (Box-Muller). */
+  static LBANN_PHILOX_FUNC float normal(const uint32x4& bits) {
+    const float u1 = 1.f - unit(bits.x[0], bits.x[1]);
+    const float u2 = unit(bits.x[2], bits.x[3]);
+    return sqrtf(-2.f * logf(u1)) * cosf(6.283185307179586f * u2);
+  }
+};
+
+template <> struct sampler<double> {
+  /** Uniform sample in [0,1). */
+  static LBANN_PHILOX_FUNC double unit(uint32_t a, uint32_t b) {
+    const uint64_t bits53 = ((static_cast<uint64_t>(a) << 21)
+                             ^ static_cast<uint64_t>(b >> 11));
+    return bits53 * (1. / 9007199254740992.);
+  }
+  /** Standard normal sample (Box-Muller). */
+  static LBANN_PHILOX_FUNC double normal(const uint32x4& bits) {
+    const double u1 = 1. - unit(bits.x[0], bits.x[1]);
+    const double u2 = unit(bits.x[2], bits.x[3]);
+    return sqrt(-2. * log(u1)) * cos(6.283185307179586 * u2);
+  }
+};
+
+/** @brief Probability distributions for random fills. */
+enum class distribution { uniform, gaussian, bernoulli };
+
+/** @brief Random sample for entry @c index of stream @c seed.
+ *
+ *  Uniform samples are drawn from @f$ [a-b,a+b) @f$, Gaussian samples
+ *  have mean @f$ a @f$ and standard deviation @f$ b @f$, and
+ *  Bernoulli samples are one with probability @f$ a @f$.
+ */
+template <typename T>
+LBANN_PHILOX_FUNC T sample(distribution dist, T a, T b,
+                           uint64_t seed, uint64_t index) {
+  const auto bits = random_bits(seed, index);
+  switch (dist) {
+  case distribution::uniform:
+    return a + b * (T(2) * sampler<T>::unit(bits.x[0], bits.x[1]) - T(1));
+  case distribution::gaussian:
+    return a + b * sampler<T>::normal(bits);
+  case distribution::bernoulli:
+  default:
+    return sampler<T>::unit(bits.x[0], bits.x[1]) < a ? T(1) : T(0);
+  }
+}
+
+} // namespace philox
+} // namespace lbann
+
+#undef LBANN_PHILOX_FUNC
+
+#endif // LBANN_UTILS_PHILOX_HPP_INCLUDED
@@ -0,0 +1,203 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_UTILS_PINNED_MEMORY_HPP_INCLUDED
+#define LBANN_UTILS_PINNED_MEMORY_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace lbann {
+
+/** Counters of the pinned host memory pool. */
+struct pinned_memory_statistics {
+  /** Pinned bytes held by the pool, leased or not. */
+  size_t pinned_bytes = 0;
+  /** Bytes in buffers that are leased out. */
+  size_t leased_bytes = 0;
+  /** Pinned bytes in free buffers kept for reuse. */
+  size_t cached_bytes = 0;
+  /** Number of host allocations that pinned memory. */
+  size_t num_pins = 0;
+  /** Number of leases, and how many reused a cached buffer. */
+  size_t num_leases = 0;
+  size_t num_reuses = 0;
+  /** Number of leases given pageable memory because of the cap. */
+  size_t num_pageable = 0;
+};
+
+/**
+ * Pool of pinned host buffers for staging device-host copies.
+ *
+ * Buffers are leased out and go back to the pool when the lease is
+ * destroyed. Requests are rounded up to powers of two from 4 KiB, so
+ * a returned buffer serves later requests of similar size without
+ * calling cudaHostAlloc again. Pinned memory counts against a cap
+ * (@c --pinned_memory_mb, 2048 MiB by default). If a request does
+ * not fit, the free buffers are released, and if it still does not
+ * fit, the lease gets pageable memory, which is correct but makes
+ * asynchronous copies synchronous.
+ *
+ * Without GPU support the buffers are ordinary host memory. The pool
+ * is shared by the input pipeline, checkpoint staging, dump
+ * callbacks, and metric readback. Thread-safe.
+ */
+class pinned_memory_pool {
+public:
+
+  /** Buffer leased from the pool. Move-only. */
+  class lease {
+  public:
+    lease() = default;
+    lease(const lease&) = delete;
+    lease& operator=(const lease&) = delete;
+    lease(lease&& other) noexcept;
+    lease& operator=(lease&& other) noexcept;
+    ~lease() { reset(); }
+
+    /** Give the buffer back to the pool. */
+    void reset();
+
+    void* get() const noexcept { return m_ptr; }
+    template <typename T>
+    T* data() const noexcept { return static_cast<T*>(m_ptr); }
+    /** Usable size in bytes, at least the requested size. */
+    size_t size() const noexcept { return m_size; }
+    bool is_pinned() const noexcept { return m_pinned; }
+
+  private:
+    friend class pinned_memory_pool;
+    lease(void* ptr, size_t size, bool pinned) noexcept
+      : m_ptr(ptr), m_size(size), m_pinned(pinned) {}
+    void* m_ptr = nullptr;
+    size_t m_size = 0;
+    bool m_pinned = false;
+  };
+
+  /** The process-wide pool. */
+  static pinned_memory_pool& instance();
+
+  pinned_memory_pool(const pinned_memory_pool&) = delete;
+  pinned_memory_pool& operator=(const pinned_memory_pool&) = delete;
+  ~pinned_memory_pool();
+
+  /** Lease a buffer of at least bytes. */
+  lease acquire(size_t bytes);
+
+  /** Free the buffers that are not leased. */
+  void release_cached();
+
+  /** Cap on pinned bytes. */
+  size_t get_capacity() const;
+  void set_capacity(size_t bytes);
+
+  pinned_memory_statistics get_statistics() const;
+
+  /** Size class of a request. */
+  static size_t round_up(size_t bytes) noexcept;
+
+private:
+  pinned_memory_pool();
+
+  /** Return a leased buffer. */
+  void give_back(void* ptr, size_t size, bool pinned);
+  void release_cached_locked();
+
+  /** Free pinned buffers by size class. */
+  std::map<size_t, std::vector<void*>> m_free;
+  size_t m_capacity;
+  pinned_memory_statistics m_stats;
+  mutable std::mutex m_mutex;
+};
+
+/**
+ * Host matrix in memory leased from the pinned memory pool.
+ *
+ * The buffer only grows. Copies get their own lease and a copy of the
+ * entries.
+ */
+template <typename T>
+class pinned_host_matrix {
+public:
+  using matrix_type = El::Matrix<T, El::Device::CPU>;
+
+  pinned_host_matrix() = default;
+  pinned_host_matrix(El::Int height, El::Int width) { Resize(height, width); }
+  pinned_host_matrix(const pinned_host_matrix& other) { *this = other; }
+  pinned_host_matrix& operator=(const pinned_host_matrix& other) {
+    if (this != &other) {
+      Resize(other.m_matrix.Height(), other.m_matrix.Width());
+      El::Copy(other.m_matrix, m_matrix);
+    }
+    return *this;
+  }
+  pinned_host_matrix(pinned_host_matrix&& other) noexcept {
+    *this = std::move(other);
+  }
+  pinned_host_matrix& operator=(pinned_host_matrix&& other) noexcept {
+    // Views are re-attached, since moving a view copies its entries
+    if (this != &other) {
+      const auto height = other.m_matrix.Height();
+      const auto width = other.m_matrix.Width();
+      const auto ldim = other.m_matrix.LDim();
+      other.m_matrix.Empty();
+      m_matrix.Empty();
+      m_lease = std::move(other.m_lease);
+      m_matrix.Attach(height, width, m_lease.template data<T>(), ldim);
+    }
+    return *this;
+  }
+
+  /** Resize the matrix. Entries are not kept. */
+  void Resize(El::Int height, El::Int width) {
+    const El::Int ldim = std::max(height, El::Int(1));
+    const size_t bytes = ldim * width * sizeof(T);
+    if (bytes > m_lease.size()) {
+      m_matrix.Empty();
+      m_lease = pinned_memory_pool::instance().acquire(bytes);
+    }
+    m_matrix.Attach(height, width, m_lease.template data<T>(), ldim);
+  }
+
+  El::Int Height() const noexcept { return m_matrix.Height(); }
+  El::Int Width() const noexcept { return m_matrix.Width(); }
+  matrix_type& Matrix() noexcept { return m_matrix; }
+  const matrix_type& LockedMatrix() const noexcept { return m_matrix; }
+
+private:
+  pinned_memory_pool::lease m_lease;
+  matrix_type m_matrix;
+};
+
+} // namespace lbann
+
+#endif // LBANN_UTILS_PINNED_MEMORY_HPP_INCLUDED
@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_PIPELINE_HPP_INCLUDED
+#define LBANN_UTILS_PIPELINE_HPP_INCLUDED
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace lbann {
+namespace pipeline {
+
+/** @brief Micro-batch schedule for a pipeline of layer stages. */
+enum class schedule_type {
+  /** All forward passes, then all backward passes (GPipe). */
+  gpipe,
+  /** Alternate forward and backward passes after a warmup (1F1B).
+   *  Each stage keeps at most (number of stages - stage index)
+   *  micro-batches of activations.
+   */
+  one_forward_one_backward
+};
+std::string to_string(schedule_type type);
+
+/** @brief Forward or backward pass of a stage on a micro-batch. */
+struct operation {
+  /** Whether this is a forward pass. */
+  bool forward;
+  /** Micro-batch index. */
+  int micro_batch;
+};
+
+/** @brief Partition a sequence of layers into contiguous stages.
+ *
+ *  Minimizes the cost of the most expensive stage. Every stage has
+ *  at least one layer, so there are at most @c costs.size() stages.
+ *
+ *  @param costs       Cost of each layer, e.g. its forward and
+ *                     backward prop time.
+ *  @param num_stages  Number of stages.
+ *  @returns           Index of the first layer in each stage.
+ */
+std::vector<size_t> balance_stages(const std::vector<double>& costs,
+                                   size_t num_stages);
+
+/** @brief Order in which a stage runs its passes.
+ *
+ *  Forward passes of a micro-batch wait for the previous stage and
+ *  backward passes wait for the next stage.
+ */
+std::vector<operation> get_schedule(schedule_type type,
+                                    int stage,
+                                    int num_stages,
+                                    int num_micro_batches);
+
+/** @brief Estimate the time of a pipelined training step.
+ *
+ *  Each stage runs its schedule in order, starting each pass once it
+ *  is ready. Transfers between stages are assumed to be free.
+ *
+ *  @param type                Micro-batch schedule.
+ *  @param forward_times       Forward pass time of each stage for
+ *                             one micro-batch.
+ *  @param backward_times      Backward pass time of each stage for
+ *                             one micro-batch.
+ *  @param num_micro_batches   Number of micro-batches per step.
+ */
+double estimate_step_time(schedule_type type,
+                          const std::vector<double>& forward_times,
+                          const std::vector<double>& backward_times,
+                          int num_micro_batches);
+
+} // namespace pipeline
+} // namespace lbann
+
+#endif // LBANN_UTILS_PIPELINE_HPP_INCLUDED
@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_UTILS_QUANTIZATION_HPP_INCLUDED
+#define LBANN_UTILS_QUANTIZATION_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace lbann {
+namespace utils {
+
+/** @brief Reduced-precision types for storing samples */
+enum class storage_type { uint8, fp16, bf16 };
+
+/** @brief Parses "uint8", "fp16" or "bf16" */
+storage_type parse_storage_type(const std::string& name);
+
+std::string to_string(storage_type t);
+
+/** @brief Bytes per stored element */
+std::size_t storage_type_size(storage_type t);
+
+/** @brief Rounds a float to the nearest IEEE half, as its bits */
+uint16_t float_to_half(float x);
+float half_to_float(uint16_t bits);
+
+/** @brief Rounds a float to the nearest bfloat16, as its bits */
+uint16_t float_to_bf16(float x);
+float bf16_to_float(uint16_t bits);
+
+/** @brief Converts values to a reduced-precision type
+ *
+ *  For uint8, values are mapped linearly onto [0,255] so that the
+ *  smallest is 0 and the largest is 255; x is restored as
+ *  q*scale + offset. The floating-point types are rounded to nearest
+ *  and have a scale of 1 and an offset of 0.
+ *
+ *  @param src    The values to convert.
+ *  @param n      The number of values.
+ *  @param t      The type to convert to.
+ *  @param dst    Destination; must hold n*storage_type_size(t) bytes.
+ *  @param scale  On return, the scale that recovers the values.
+ *  @param offset On return, the offset that recovers the values.
+ */
+template <typename T>
+void quantize(const T* src, std::size_t n, storage_type t, void* dst,
+              double& scale, double& offset);
+
+/** @brief Reverses quantize */
+template <typename T>
+void dequantize(const void* src, std::size_t n, storage_type t,
+                double scale, double offset, T* dst);
+
+}// namespace utils
+}// namespace lbann
+
+#endif // LBANN_UTILS_QUANTIZATION_HPP_INCLUDED
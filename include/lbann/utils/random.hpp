@@ -185,9 +185,12 @@ void init_io_random(int seed = -1);
 /**
  * Make mat into an m x n matrix where each entry is independently drawn from
  * a Gaussian distribution with given mean and standard deviation.
- * Unless selected so at compile-time, this ensures the entries of the matrix do
- * not change as the grid it is distributed over changes; that is, it will have
- * the same entries when mat spans any number of processes.
+ * This ensures the entries of the matrix do not change as the grid it is
+ * distributed over changes; that is, it will have the same entries when mat
+ * spans any number of processes. Entries are generated in place from a
+ * counter-based (Philox) RNG, with OpenMP threads on the CPU or a kernel on
+ * the GPU, and the stream is seeded from the global generator (see
+ * init_random). This is collective over the grid of mat.
  */
 template <typename TensorDataType>
 void gaussian_fill(El::AbstractDistMatrix<TensorDataType>& mat, El::Int m, El::Int n, TensorDataType mean = 0.0,
@@ -211,8 +214,8 @@ void uniform_fill(El::AbstractDistMatrix<TensorDataType>& mat, El::Int m, El::In
 /**
  * Make mat into an m x n matrix where each entry is independently drawn from
  * a Gaussian distribution with given mean and standard deviation.
- * This always ensures that the entries of the matrix do not change as the grid
- * it is distributed over changes.
+ * Equivalent to gaussian_fill, which always ensures that the entries of the
+ * matrix do not change as the grid it is distributed over changes.
  */
 template <typename TensorDataType>
 void gaussian_fill_procdet(El::AbstractDistMatrix<TensorDataType>& mat, El::Int m, El::Int n,
@@ -233,6 +236,28 @@ template <typename TensorDataType>
 void uniform_fill_procdet(El::AbstractDistMatrix<TensorDataType>& mat, El::Int m, El::Int n,
                           TensorDataType center = 0.0, TensorDataType radius = 1.0);
 
+/**
+ * Apply a Bernoulli mask that is regenerated from a counter-based
+ * (Philox) RNG instead of being stored. Entry (i,j) is kept with
+ * probability keep_prob, in which case the output entry is
+ * keep_scale * input + keep_shift; otherwise it is drop_value. The
+ * mask only depends on the seed and the global entry index, so
+ * applying it again with the same seed reproduces it (e.g. in
+ * backprop) and it does not change with the grid. input and output
+ * must have the same dimensions and distribution. On GPUs the mask
+ * is generated in a kernel.
+ */
+template <typename TensorDataType, El::Device Device>
+void philox_mask_apply(const El::AbstractDistMatrix<TensorDataType>& input,
+                       El::AbstractDistMatrix<TensorDataType>& output,
+                       double keep_prob,
+                       uint64_t seed,
+                       TensorDataType keep_scale,
+                       TensorDataType keep_shift,
+                       TensorDataType drop_value);
+/** Draw a 64-bit seed for philox_mask_apply from the global generator. */
+uint64_t get_philox_seed();
+
 bool save_rng_to_checkpoint_shared(persist& p, lbann_comm* comm);
 bool save_rng_to_checkpoint_distributed(persist& p, lbann_comm* comm);
 bool load_rng_from_checkpoint(persist& p, const lbann_comm* comm);
@@ -288,6 +313,13 @@ void rng_bernoulli(const float p, DistMat *m) {
 #undef PROTO
 #undef LBANN_INSTANTIATE_CPU_HALF
 #undef LBANN_INSTANTIATE_GPU_HALF
+
+#define PROTO_DEVICE(T, Device)                                         \
+  extern template void philox_mask_apply<T, Device>(                    \
+    const El::AbstractDistMatrix<T>&, El::AbstractDistMatrix<T>&,       \
+    double, uint64_t, T, T, T)
+#include "lbann/macros/instantiate_device.hpp"
+#undef PROTO_DEVICE
 #endif // LBANN_RANDOM_INSTANTIATE
 
 }// end namespace
@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_ROW_NORMALIZATION_HPP_INCLUDED
+#define LBANN_UTILS_ROW_NORMALIZATION_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+namespace lbann {
+
+/** @brief GPU kernel variant for normalizing rows of data.
+ *
+ *  Layer and instance normalization normalize contiguous rows of
+ *  entries (a data sample or a channel) to zero mean and unit
+ *  variance. Short rows are handled by one warp each and medium rows
+ *  by one thread block each, computing the statistics and the result
+ *  in a single kernel launch. Long rows, or rows distributed over
+ *  several processes, use grid-wide reductions.
+ */
+enum class row_normalization_kernel { warp, block, grid };
+
+/** @brief Choose the kernel variant for rows of a given length. */
+inline row_normalization_kernel choose_row_normalization_kernel(El::Int row_size) {
+  if (row_size <= 1024) { return row_normalization_kernel::warp; }
+  if (row_size <= 16384) { return row_normalization_kernel::block; }
+  return row_normalization_kernel::grid;
+}
+
+} // namespace lbann
+
+#if defined(LBANN_HAS_GPU) && defined(__CUDACC__)
+
+#include "lbann/utils/cuda.hpp"
+
+namespace lbann {
+namespace cuda {
+
+/** @brief Normalize rows with a single kernel launch.
+ *
+ *  @f[ y_i = \frac{x_i - \mu}{\sqrt{\sigma^2 + \epsilon}} @f]
+ *
+ *  The variance is unbiased. Row @f$ r @f$ starts at entry
+ *  @f$ (r \bmod m) n + \lfloor r/m \rfloor \text{ldim} @f$, where
+ *  @f$ m @f$ is @c rows_per_col and @f$ n @f$ is @c row_size, so a
+ *  column can hold several consecutive rows. The row means and
+ *  variances are stored in @c means and @c vars.
+ *
+ *  @param kernel Either @c warp or @c block.
+ */
+template <typename TensorDataType>
+void fused_row_normalization_forward(
+  row_normalization_kernel kernel,
+  El::Int num_rows, El::Int rows_per_col, El::Int row_size,
+  TensorDataType epsilon,
+  const TensorDataType* input, El::Int input_ldim,
+  TensorDataType* output, El::Int output_ldim,
+  TensorDataType* means, El::Int means_stride,
+  TensorDataType* vars, El::Int vars_stride,
+  cudaStream_t stream);
+
+/** @brief Backprop for @c fused_row_normalization_forward.
+ *
+ *  Uses the statistics computed in forward prop.
+ */
+template <typename TensorDataType>
+void fused_row_normalization_backward(
+  row_normalization_kernel kernel,
+  El::Int num_rows, El::Int rows_per_col, El::Int row_size,
+  TensorDataType epsilon,
+  const TensorDataType* input, El::Int input_ldim,
+  const TensorDataType* output_grad, El::Int output_grad_ldim,
+  TensorDataType* input_grad, El::Int input_grad_ldim,
+  const TensorDataType* means, El::Int means_stride,
+  const TensorDataType* vars, El::Int vars_stride,
+  cudaStream_t stream);
+
+} // namespace cuda
+} // namespace lbann
+
+#include "lbann/utils/impl/row_normalization.hpp"
+
+#endif // defined(LBANN_HAS_GPU) && defined(__CUDACC__)
+#endif // LBANN_UTILS_ROW_NORMALIZATION_HPP_INCLUDED
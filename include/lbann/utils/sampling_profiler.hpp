@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_SAMPLING_PROFILER_HPP_INCLUDED
+#define LBANN_UTILS_SAMPLING_PROFILER_HPP_INCLUDED
+
+#include <cstdint>
+#include <string>
+
+namespace lbann {
+
+/** @brief Statistical CPU profiler based on stack samples.
+ *
+ *  Each registered thread gets a timer on its own CPU-time clock
+ *  that raises @c SIGPROF, and the signal handler records the
+ *  thread's call stack into a preallocated per-thread ring. Samples
+ *  are aggregated into folded stacks ("thread;outer;...;inner
+ *  count"), which @c flamegraph.pl and speedscope can render.
+ *
+ *  Unlike @c stack_profiler, this needs no special build, costs
+ *  nothing when stopped, and can be started and stopped at any time.
+ *  Only registered threads are sampled; the main thread and the I/O
+ *  thread pool's workers are registered. Samples are dropped while a
+ *  thread's ring is full. Linux only.
+ */
+namespace sampling_profiler {
+
+/** @brief Start sampling all registered threads.
+ *  @param frequency Samples per second of each thread's CPU time.
+ *  @param capacity  Samples buffered per thread between calls to
+ *                   @c write_folded_stacks. Rounded up to a power of
+ *                   two.
+ */
+void start(double frequency = 99, size_t capacity = 1 << 14);
+
+/** @brief Stop sampling. Recorded samples are kept. */
+void stop();
+
+/** @brief Whether threads are being sampled. */
+bool running();
+
+/** @brief Write folded stacks of all samples recorded so far.
+ *
+ *  May be called while sampling. Drains the per-thread rings, so it
+ *  should be called periodically in long runs.
+ */
+void write_folded_stacks(const std::string& filename);
+
+/** Number of samples dropped because a ring was full. */
+uint64_t num_dropped();
+
+/** @brief Sample the calling thread for the lifetime of the object.
+ *
+ *  @c name identifies the thread in the folded stacks. Samples
+ *  recorded before the object is destroyed are kept.
+ */
+class thread_registration {
+public:
+  explicit thread_registration(const std::string& name);
+  ~thread_registration();
+  thread_registration(const thread_registration&) = delete;
+  thread_registration& operator=(const thread_registration&) = delete;
+private:
+  void* m_state;
+};
+
+} // namespace sampling_profiler
+} // namespace lbann
+
+#endif // LBANN_UTILS_SAMPLING_PROFILER_HPP_INCLUDED
@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBANN_UTILS_SPARSE_HPP_INCLUDED
+#define LBANN_UTILS_SPARSE_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+#include <vector>
+
+namespace lbann {
+
+/** @brief Mini-batch in compressed sparse row format
+ *
+ *  Each row is a sample and each column is a feature, i.e. this is
+ *  the CSR form of the transpose of a local mini-batch matrix (which
+ *  stores one sample per column). Feature indices within a sample are
+ *  sorted.
+ */
+template <typename TensorDataType>
+struct sparse_mini_batch {
+
+  /** @brief Number of features per sample. */
+  El::Int num_features = 0;
+  /** @brief Number of samples. */
+  El::Int num_samples = 0;
+  /** @brief Position of each sample's first nonzero.
+   *  Has @c num_samples+1 entries.
+   */
+  std::vector<El::Int> row_offsets;
+  /** @brief Feature index of each nonzero. */
+  std::vector<El::Int> col_indices;
+  /** @brief Value of each nonzero. */
+  std::vector<TensorDataType> values;
+
+  /** @brief Number of nonzero entries. */
+  El::Int num_nonzeros() const { return values.size(); }
+  /** @brief Fraction of entries that are nonzero. */
+  double density() const {
+    const double size = double(num_features) * num_samples;
+    return size > 0 ? num_nonzeros() / size : 0;
+  }
+
+};
+
+/** @brief Compress a local mini-batch matrix
+ *
+ *  Each column of @c dense is a sample.
+ */
+template <typename TensorDataType>
+void compress_mini_batch(
+  const El::Matrix<TensorDataType, El::Device::CPU>& dense,
+  sparse_mini_batch<TensorDataType>& sparse);
+
+/** @brief Multiply a dense matrix with a sparse mini-batch
+ *
+ *  Computes @f$ Y = \alpha op(W) X + \beta Y @f$, where the columns
+ *  of @f$ X @f$ are the samples in @c input. Work is proportional to
+ *  the number of nonzeros in @c input rather than its size.
+ */
+template <typename TensorDataType>
+void sparse_gemm(El::Orientation orientation_w,
+                 TensorDataType alpha,
+                 const El::Matrix<TensorDataType, El::Device::CPU>& W,
+                 const sparse_mini_batch<TensorDataType>& input,
+                 TensorDataType beta,
+                 El::Matrix<TensorDataType, El::Device::CPU>& Y);
+
+/** @brief Outer product of a dense matrix and a sparse mini-batch
+ *
+ *  Computes @f$ G = \alpha D X^T + \beta G @f$, or @f$ G = \alpha X
+ *  D^T + \beta G @f$ if @c transpose is set, where the columns of
+ *  @f$ X @f$ are the samples in @c input. This is the gradient of a
+ *  linearity applied to sparse inputs (see @c sparse_gemm).
+ */
+template <typename TensorDataType>
+void sparse_gemm_gradient(bool transpose,
+                          TensorDataType alpha,
+                          const El::Matrix<TensorDataType, El::Device::CPU>& D,
+                          const sparse_mini_batch<TensorDataType>& input,
+                          TensorDataType beta,
+                          El::Matrix<TensorDataType, El::Device::CPU>& G);
+
+} // namespace lbann
+
+#endif // LBANN_UTILS_SPARSE_HPP_INCLUDED
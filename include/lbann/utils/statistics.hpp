@@ -29,6 +29,11 @@
 
 #include "lbann/base.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
 namespace lbann {
 
 /** @brief Compute mean and standard deviation over matrix entries
@@ -132,5 +137,111 @@ void columnwise_covariance(const AbsDistMat& data1,
                            const AbsDistMat& means2,
                            AbsDistMat& cov);
 
+#ifdef LBANN_HAS_GPU
+/** @brief Compute the sum, sum of squares, minimum, and maximum of a
+ *  matrix on the GPU.
+ *
+ *  Asynchronous on the Hydrogen stream.
+ *
+ *  @param mat        Matrix to summarize.
+ *  @param workspace  Scratch space for per-block partial results.
+ *  @param stats      4x1 matrix that receives the results.
+ */
+template <typename TensorDataType>
+void local_stats_gpu(const El::Matrix<TensorDataType, El::Device::GPU>& mat,
+                     El::Matrix<double, El::Device::GPU>& workspace,
+                     El::Matrix<double, El::Device::GPU>& stats);
+
+/** @brief Count the entries of a matrix in histogram buckets on the
+ *  GPU.
+ *
+ *  Entry x is counted in bucket i where i is the number of edges that
+ *  are less than or equal to x. Asynchronous on the Hydrogen stream.
+ *
+ *  @param mat     Matrix to summarize.
+ *  @param edges   Sorted bucket edges.
+ *  @param counts  (number of edges + 1) x 1 matrix that receives the
+ *                 counts.
+ */
+template <typename TensorDataType>
+void local_histogram_gpu(const El::Matrix<TensorDataType, El::Device::GPU>& mat,
+                         const El::Matrix<double, El::Device::GPU>& edges,
+                         El::Matrix<double, El::Device::GPU>& counts);
+#endif // LBANN_HAS_GPU
+
+/** @brief Mergeable streaming statistics of a sequence of values
+ *
+ *  Mean and variance are accumulated with Welford's algorithm in one
+ *  pass. Two accumulators are combined with the pairwise update of
+ *  Chan et al., so partial results from threads or processes can be
+ *  merged in any order. An optional histogram with fixed, evenly
+ *  spaced bins is kept alongside; values outside its range go to the
+ *  first or last bin.
+ */
+class running_statistics {
+public:
+  running_statistics() = default;
+  /** @param num_bins Number of histogram bins (0 for none).
+   *  @param lo       Lower edge of the first bin.
+   *  @param hi       Upper edge of the last bin.
+   */
+  running_statistics(size_t num_bins, double lo, double hi);
+
+  /** @brief Add one value */
+  void add(double x) {
+    ++m_count;
+    const double delta = x - m_mean;
+    m_mean += delta / m_count;
+    m_m2 += delta * (x - m_mean);
+    m_min = std::min(m_min, x);
+    m_max = std::max(m_max, x);
+    if (!m_histogram.empty()) {
+      const double bin = (x - m_lo) * m_histogram.size() / (m_hi - m_lo);
+      const auto last = static_cast<double>(m_histogram.size() - 1);
+      m_histogram[static_cast<size_t>(std::max(0.0, std::min(bin, last)))] += 1;
+    }
+  }
+
+  /** @brief Combine the values seen by another accumulator
+   *  @details The histograms must have the same bins.
+   */
+  void merge(const running_statistics& other);
+
+  double count() const noexcept { return m_count; }
+  double mean() const noexcept { return m_mean; }
+  /** @brief Population variance */
+  double variance() const noexcept {
+    return m_count > 0 ? m_m2 / m_count : 0.0;
+  }
+  double stdev() const noexcept { return std::sqrt(variance()); }
+  double min() const noexcept { return m_min; }
+  double max() const noexcept { return m_max; }
+  const std::vector<double>& histogram() const noexcept { return m_histogram; }
+  double histogram_min() const noexcept { return m_lo; }
+  double histogram_max() const noexcept { return m_hi; }
+
+  /** @brief Append the state to a buffer, e.g. to send it with MPI */
+  void pack(std::vector<double>& buffer) const;
+  /** @brief Read a state written by @c pack
+   *  @details The accumulator must have the same bins as the one that
+   *  packed the state.
+   *  @return The entry of @c buffer just past the state.
+   */
+  const double* unpack(const double* buffer);
+  /** @brief Number of entries @c pack appends */
+  size_t packed_size() const noexcept { return 5 + m_histogram.size(); }
+
+private:
+  double m_count = 0;
+  double m_mean = 0;
+  /** Sum of squared differences from the mean */
+  double m_m2 = 0;
+  double m_min = std::numeric_limits<double>::infinity();
+  double m_max = -std::numeric_limits<double>::infinity();
+  double m_lo = 0;
+  double m_hi = 1;
+  std::vector<double> m_histogram;
+};
+
 } // end namespace
 #endif // LBANN_UTILS_STATISTICS_HPP
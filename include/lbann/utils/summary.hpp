@@ -33,9 +33,14 @@
 #include <vector>
 #include "lbann/base.hpp"
 #include "lbann/comm.hpp"
+#include "lbann/utils/statistics.hpp"
 
 #ifdef LBANN_HAS_TBINF
 #include "TBinf.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #endif
 
 namespace lbann {
@@ -58,6 +63,13 @@ using BiggerOf = typename std::conditional<(sizeof(T) > sizeof(U)), T, U>::type;
  * This class automatically prepends "modelN/" to each tag. The tag is only
  * relevant at the world master process.
  *
+ * Local statistics of GPU matrices are computed with kernels on the
+ * Hydrogen stream and are only copied to the host when the summaries
+ * are flushed, so adding a summary does not synchronize. Flushing
+ * packs all pending summaries into one sum and one max reduction in
+ * each trainer and one gather among trainers. TensorBoard events are
+ * written by a background thread on the world master.
+ *
  * @note WHEN YOU UPDATE THE PUBLIC API HERE, REMEMBER TO UPDATE THE KLUDGE FOR
  * NON-TENSORBOARD BUILDS BELOW!
  */
@@ -84,6 +96,11 @@ public:
   /** Report the standard deviation of mat. */
   template <typename TensorDataType>
   void reduce_stdev(const std::string tag, const El::AbstractDistMatrix<TensorDataType>& mat, int step);
+  /** Report the mean, minimum, maximum, standard deviation, and
+   *  squared 2-norm of mat as prefix + "/mean", "/min", "/max",
+   *  "/stdev", and "/2norm2". This makes one pass over mat. */
+  template <typename TensorDataType>
+  void reduce_moments(const std::string prefix, const El::AbstractDistMatrix<TensorDataType>& mat, int step);
   /** Report a scalar from each model (only meaningful on model masters). */
   template <typename TensorDataType>
   void reduce_scalar(const std::string tag, TensorDataType s, int step);
@@ -100,45 +117,46 @@ public:
   template <typename TensorDataType>
   void reduce_2norm(const std::string tag, const El::AbstractDistMatrix<TensorDataType>& mat, int step);
 
-  /**
-   * Write all summaries out.
-   * @todo This can be made faster by combining collective operations element-
-   * wise for each type of summary.
-   */
+  /** Write all summaries out. */
   void flush();
 
  private:
   lbann_comm *m_comm;
+  /** Only accessed by the writer thread once it is running. */
   TBinf::SummaryWriter *m_sw;
 
-  /** Represent a pending summary operation.
-    * Note that TensorBoard takes scalars as floats
-    */
+  /** Entries of local statistics. */
+  enum stat_field { STAT_SUM = 0, STAT_SQSUM, STAT_MIN, STAT_MAX,
+                    NUM_STAT_FIELDS };
+
+  /** Represent a pending summary operation. */
   struct pending_op {
-    pending_op(const std::string tag_, int step_, float local_,
-               float local2_ = 0.0f, int num_ = 0) :
-      tag(tag_), step(step_), local(local_), local2(local2_), num(num_) {}
+    pending_op(const std::string tag_, int step_, double local_,
+               double local2_ = 0.0, int num_ = 0, int slot_ = -1) :
+      tag(tag_), step(step_), local(local_), local2(local2_), num(num_),
+      slot(slot_) {}
     /** Associated tag. */
     const std::string tag;
     /** Global step. */
     int step;
     /** Locally-computed data. */
-    float local;
+    double local;
     /** More locally-computed data (for stdev). */
-    float local2;
+    double local2;
     /** Size of matrix (needed for mean/stdev). */
     int num;
+    /** Column of the device statistics that holds the local data, or
+     *  -1 if it is already on the host. */
+    int slot;
   };
-  /** Represent a pending histogram operation.
-    * Note that TensorBoard takes histograms as double
-    */
+  /** Represent a pending histogram operation. */
   struct pending_histogram {
     pending_histogram(const std::string tag_, int step_,
                       std::vector<double> buckets_,
                       double min_, double max_, double num_,
-                      double sum_, double sqsum_) :
-      tag(tag_), step(step_), buckets(buckets_), min(min_), max(max_),
-      num(num_), sum(sum_), sqsum(sqsum_) {}
+                      double sum_, double sqsum_, int slot_ = -1) :
+      tag(tag_), step(step_), buckets(std::move(buckets_)), min(min_),
+      max(max_), num(num_), sum(sum_), sqsum(sqsum_), slot(slot_) {}
     /** Associated tag. */
     const std::string tag;
     /** Global step. */
@@ -155,6 +173,12 @@ public:
     double sum;
     /** Sum of the squares of the values in the data. */
     double sqsum;
+    /** @see pending_op::slot */
+    int slot;
+#ifdef LBANN_HAS_GPU
+    /** Buckets computed on the device, if not yet on the host. */
+    El::Matrix<double, El::Device::GPU> device_buckets;
+#endif // LBANN_HAS_GPU
   };
 
   /** Currently-pending reduce_means. */
@@ -176,45 +200,73 @@ public:
   /** Currently-pending reduce_histograms. */
   std::vector<pending_histogram> m_pending_histograms;
 
-  /** Execute all pending mean operations. */
-  void flush_means();
-  /** Execute all pending min operations. */
-  void flush_mins();
-  /** Execute all pending max operations. */
-  void flush_maxes();
-  /** Execute all pending stdev operations. */
-  void flush_stdevs();
-  /** Execute all pending scalar operations. */
-  void flush_scalars();
-  /** Execute all pending sum-scalar operations. */
-  void flush_sum_scalars();
-  /** Execute all pending scalar-all operations. */
-  void flush_scalar_alls();
-  /** Execute all pending histogram operations. */
-  void flush_histograms();
-
-  /** Compute the sum of elements in mat. */
-  template <typename TensorDataType>
-  auto local_sum(const El::AbstractMatrix<TensorDataType>& mat) const -> BiggerOf<TensorDataType, float>;
-  /** Compute the sum of square of elements in mat. */
-  template <typename TensorDataType, typename AccumT>
-  void local_sum_sqsum(const El::AbstractMatrix<TensorDataType>& mat, AccumT& sum, AccumT& sqsum) const;
-  /** Compute the minimum element in mat. */
-  template <typename TensorDataType>
-  auto local_min(const El::AbstractMatrix<TensorDataType>& mat) const -> BiggerOf<TensorDataType, float>;
-  /** Compute the maximum element in mat. */
-  template <typename TensorDataType>
-  auto local_max(const El::AbstractMatrix<TensorDataType>& mat) const -> BiggerOf<TensorDataType, float>;
-  /** Compute the element-wise L2 norm of mat. */
-  template <typename TensorDataType>
-  auto local_2norm(const El::AbstractMatrix<TensorDataType>& mat) const -> BiggerOf<TensorDataType, float>;
+#ifdef LBANN_HAS_GPU
+  /** Local statistics computed on the device, one column per matrix
+   *  (NUM_STAT_FIELDS x capacity). */
+  El::Matrix<double, El::Device::GPU> m_device_stats;
+  /** Number of columns of m_device_stats in use. */
+  El::Int m_num_device_stats = 0;
+  /** Scratch space for local_stats_gpu. */
+  El::Matrix<double, El::Device::GPU> m_device_workspace;
+  /** Copy of m_histogram_buckets on the device. */
+  El::Matrix<double, El::Device::GPU> m_device_histogram_buckets;
+#endif // LBANN_HAS_GPU
+
+  /** Events for the writer thread. */
+  struct scalar_event {
+    std::string tag;
+    float value;
+    int step;
+  };
+  struct histogram_event {
+    std::string tag;
+    std::vector<float> buckets;
+    double min, max, num, sum, sqsum;
+    int step;
+  };
+  struct event_batch {
+    std::vector<scalar_event> scalars;
+    std::vector<histogram_event> histograms;
+  };
+  /** Writes queued event batches with m_sw (world master only). */
+  std::thread m_writer;
+  std::mutex m_writer_mutex;
+  std::condition_variable m_writer_cv;
+  std::deque<event_batch> m_writer_queue;
+  bool m_writer_stop = false;
+  /** Main loop of the writer thread. */
+  void write_events();
+
+  /** Whether this process contributes the local part of mat. Matrices
+   *  that are replicated over the trainer are only counted once. */
+  template <typename TensorDataType>
+  bool counts_locally(const El::AbstractDistMatrix<TensorDataType>& mat) const;
+  /** @brief Compute local statistics of mat.
+   *
+   *  Fills stats with identities if this process does not count
+   *  mat. For GPU matrices, the statistics are computed
+   *  asynchronously into a column of m_device_stats.
+   *
+   *  @returns The column of m_device_stats, or -1 if stats holds the
+   *  result.
+   */
+  template <typename TensorDataType>
+  int local_stats(const El::AbstractDistMatrix<TensorDataType>& mat,
+                  double (&stats)[NUM_STAT_FIELDS]);
+  /** Compute the local statistics of a CPU matrix. */
+  template <typename TensorDataType>
+  void local_stats_cpu(const El::AbstractMatrix<TensorDataType>& mat,
+                       double (&stats)[NUM_STAT_FIELDS]) const;
+#ifdef LBANN_HAS_GPU
+  /** Allocate a column of m_device_stats, resolving pending
+   *  statistics if all are in use. */
+  El::Int next_device_slot();
+#endif // LBANN_HAS_GPU
+  /** Copy statistics computed on the device into the pending
+   *  operations. */
+  void resolve_device_stats();
   /** Prepend "model<model>/" to tag. */
   std::string prepend_model(const std::string tag, int model) const;
-  /** Gather and write out a scalar summary for each model. */
-  void gather_scalar_summary(const std::string tag, float s, int step);
-  /** Gather and write out a scalar summary for each entry in a vector. */
-  void gather_scalar_summary(const std::vector<pending_op>& ops,
-                             std::vector<float>& scalars);
 };
 
 #include "lbann/utils/summary_impl.hpp"
@@ -235,6 +287,8 @@ class lbann_summary {
   template <typename TensorDataType>
   void reduce_stdev(const std::string tag, const El::AbstractDistMatrix<TensorDataType>& mat, int step) {}
   template <typename TensorDataType>
+  void reduce_moments(const std::string prefix, const El::AbstractDistMatrix<TensorDataType>& mat, int step) {}
+  template <typename TensorDataType>
   void reduce_scalar(const std::string tag, TensorDataType s, int step) {}
   template <typename TensorDataType>
   void sum_reduce_scalar(const std::string tag, TensorDataType s, int step) {}
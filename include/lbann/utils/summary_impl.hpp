@@ -31,77 +31,63 @@
 
 #ifdef LBANN_HAS_TBINF
 
+#include <cfloat>
+
 template <typename TensorDataType>
 inline void lbann_summary::reduce_mean(const std::string tag,
                                 const El::AbstractDistMatrix<TensorDataType>& mat,
                                 int step) {
-  using AccumT = BiggerOf<TensorDataType, float>;
-  // Local sum
-  AccumT sum = 0.0;
-
-  // Check distributed matrix format
-  El::DistData mat_format(mat);
-  if(mat_format.colDist == El::STAR && mat_format.rowDist == El::STAR) {
-    // Compute local sum on master process if matrix is Star,Star
-    if(m_comm->am_trainer_master()) {
-      sum = local_sum(mat.LockedMatrix());
-    }
-  } else {
-    // Compute local sum on all processes if matrix is in MC,MR;
-    // Star,VC; or similar format
-    // TODO: implement for matrices in Circ,Circ; MC,Star; or similar
-    // formats
-    sum = local_sum(mat.LockedMatrix());
-  }
-
-  // Add local sum to list of pending means
-  m_pending_means.emplace_back(tag, step, sum, 0.0f, mat.Height() * mat.Width());
+  double stats[NUM_STAT_FIELDS];
+  const int slot = local_stats(mat, stats);
+  m_pending_means.emplace_back(tag, step, stats[STAT_SUM], 0.0,
+                               mat.Height() * mat.Width(), slot);
 }
 
 template <typename TensorDataType>
 inline void lbann_summary::reduce_min(const std::string tag,
                                       const El::AbstractDistMatrix<TensorDataType>& mat,
                                       int step) {
-  using AccumT = BiggerOf<TensorDataType, float>;
-  AccumT mat_local_min = local_min(mat.LockedMatrix());
-  m_pending_mins.emplace_back(tag, step, mat_local_min);
+  double stats[NUM_STAT_FIELDS];
+  const int slot = local_stats(mat, stats);
+  m_pending_mins.emplace_back(tag, step, stats[STAT_MIN], 0.0, 0, slot);
 }
 
 template <typename TensorDataType>
 inline void lbann_summary::reduce_max(const std::string tag,
                                       const El::AbstractDistMatrix<TensorDataType>& mat,
                                       int step) {
-  using AccumT = BiggerOf<TensorDataType, float>;
-  AccumT mat_local_max = local_max(mat.LockedMatrix());
-  m_pending_maxes.emplace_back(tag, step, mat_local_max);
+  double stats[NUM_STAT_FIELDS];
+  const int slot = local_stats(mat, stats);
+  m_pending_maxes.emplace_back(tag, step, stats[STAT_MAX], 0.0, 0, slot);
 }
 
 template <typename TensorDataType>
 inline void lbann_summary::reduce_stdev(const std::string tag,
                                         const El::AbstractDistMatrix<TensorDataType>& mat,
                                         int step) {
-  using AccumT = BiggerOf<TensorDataType, float>;
-  // Local sum and squared sum
-  AccumT sum = 0.0;
-  AccumT sqsum = 0.0;
-
-  // Check distributed matrix format
-  El::DistData mat_format(mat);
-  if(mat_format.colDist == El::STAR && mat_format.rowDist == El::STAR) {
-    // Compute local sums on master process if matrix is Star,Star
-    if(m_comm->am_trainer_master()) {
-      local_sum_sqsum(mat.LockedMatrix(), sum, sqsum);
-    }
-  } else {
-    // Compute local sums on all processes if matrix is in MC,MR;
-    // Star,VC; or similar format
-    // TODO: implement for matrices in Circ,Circ; MC,Star; or similar
-    // formats
-    local_sum_sqsum(mat.LockedMatrix(), sum, sqsum);
-  }
+  double stats[NUM_STAT_FIELDS];
+  const int slot = local_stats(mat, stats);
+  m_pending_stdevs.emplace_back(tag, step, stats[STAT_SUM], stats[STAT_SQSUM],
+                                mat.Height() * mat.Width(), slot);
+}
 
-  // Add local sums to list of pending stdevs.
-  m_pending_stdevs.emplace_back(tag, step, sum, sqsum, mat.Height() * mat.Width());
+template <typename TensorDataType>
+inline void lbann_summary::reduce_moments(const std::string prefix,
+                                          const El::AbstractDistMatrix<TensorDataType>& mat,
+                                          int step) {
+  double stats[NUM_STAT_FIELDS];
+  const int slot = local_stats(mat, stats);
+  const int num = mat.Height() * mat.Width();
+  m_pending_means.emplace_back(prefix + "/mean", step, stats[STAT_SUM], 0.0,
+                               num, slot);
+  m_pending_mins.emplace_back(prefix + "/min", step, stats[STAT_MIN], 0.0,
+                              0, slot);
+  m_pending_maxes.emplace_back(prefix + "/max", step, stats[STAT_MAX], 0.0,
+                               0, slot);
+  m_pending_stdevs.emplace_back(prefix + "/stdev", step, stats[STAT_SUM],
+                                stats[STAT_SQSUM], num, slot);
+  m_pending_sum_scalars.emplace_back(prefix + "/2norm2", step,
+                                     stats[STAT_SQSUM], 0.0, 0, slot);
 }
 
 template <typename TensorDataType>
@@ -131,28 +117,34 @@ template <typename TensorDataType>
 inline void lbann_summary::reduce_histogram(const std::string tag,
                                             const El::AbstractDistMatrix<TensorDataType>& mat,
                                             int step) {
-  using AccumT = BiggerOf<TensorDataType, float>;
-  AccumT mat_local_min = local_min(mat.LockedMatrix());
-  AccumT mat_local_max = local_max(mat.LockedMatrix());
-  // Local sum and squared sum
-  AccumT sum = 0.0;
-  AccumT sqsum = 0.0;
-  // Check distributed matrix format
-  El::DistData mat_format(mat);
-  if(mat_format.colDist == El::STAR && mat_format.rowDist == El::STAR) {
-    // Compute local sums on master process if matrix is Star,Star
-    if(m_comm->am_trainer_master()) {
-      local_sum_sqsum(mat.LockedMatrix(), sum, sqsum);
+  double stats[NUM_STAT_FIELDS];
+  const int slot = local_stats(mat, stats);
+  m_pending_histograms.emplace_back(
+    tag, step, std::vector<double>(m_histogram_buckets.size()+1, 0.0),
+    stats[STAT_MIN], stats[STAT_MAX], mat.Height() * mat.Width(),
+    stats[STAT_SUM], stats[STAT_SQSUM], slot);
+  if (!counts_locally(mat)) { return; }
+  auto& hist = m_pending_histograms.back();
+
+#ifdef LBANN_HAS_GPU
+  if (slot >= 0) {
+    if (m_device_histogram_buckets.IsEmpty()) {
+      El::Matrix<double, El::Device::CPU> edges(m_histogram_buckets.size(), 1);
+      std::copy(m_histogram_buckets.begin(), m_histogram_buckets.end(),
+                edges.Buffer());
+      El::Copy(edges, m_device_histogram_buckets);
     }
-  } else {
-    // Compute local sums on all processes if matrix is in MC,MR;
-    // Star,VC; or similar format
-    // TODO: implement for matrices in Circ,Circ; MC,Star; or similar
-    // formats
-    local_sum_sqsum(mat.LockedMatrix(), sum, sqsum);
+    hist.device_buckets.Resize(hist.buckets.size(), 1);
+    local_histogram_gpu(
+      static_cast<const El::Matrix<TensorDataType, El::Device::GPU>&>(
+        mat.LockedMatrix()),
+      m_device_histogram_buckets, hist.device_buckets);
+    return;
   }
+#endif // LBANN_HAS_GPU
+
   // Compute local buckets.
-  std::vector<double> buckets(m_histogram_buckets.size()+1, 0.0);
+  auto& buckets = hist.buckets;
   const auto height = mat.LocalHeight();
   const auto width = mat.LocalWidth();
   const auto ldim = mat.LDim();
@@ -172,12 +164,6 @@ inline void lbann_summary::reduce_histogram(const std::string tag,
 #endif // LBANN_DEBUG
     }
   }
-  // Add to list of pending histograms.
-  m_pending_histograms.emplace_back(
-    tag, step, std::move(buckets),
-    mat_local_min, mat_local_max,
-    mat.Height() * mat.Width(),
-    sum, sqsum);
   // TODO: Support histograms on multiple models.
 }
 
@@ -185,141 +171,88 @@ template <typename TensorDataType>
 inline void lbann_summary::reduce_2norm(const std::string tag, const El::AbstractDistMatrix<TensorDataType>& mat,
                                         int step) {
   // Using a squared 2-norm so that we can just sum this.
-  using AccumT = BiggerOf<TensorDataType, float>;
-  AccumT local_norm = local_2norm(mat.LockedMatrix());
-  sum_reduce_scalar(tag, local_norm * local_norm, step);
+  double stats[NUM_STAT_FIELDS];
+  const int slot = local_stats(mat, stats);
+  m_pending_sum_scalars.emplace_back(tag, step, stats[STAT_SQSUM], 0.0, 0, slot);
 }
 
 template <typename TensorDataType>
-inline auto lbann_summary::local_sum(const El::AbstractMatrix<TensorDataType>& mat) const -> BiggerOf<TensorDataType, float> {
-  // Note there are more numerically stable ways to compute a sum.
-  const El::Int height = mat.Height();
-  const El::Int width = mat.Width();
-  const El::Int ldim = mat.LDim();
-  const auto* __restrict__ mat_buf = mat.LockedBuffer();
-  using AccumT = BiggerOf<TensorDataType, float>;
-  AccumT sum = AccumT(0);
-  if (ldim == height) {
-    const El::Int size = height*width;
-    LBANN_OMP_PARALLEL_FOR_ARGS(reduction(+:sum))
-    for (El::Int i = 0; i < size; ++i) {
-      sum += mat_buf[i];
-    }
-  } else {
-    LBANN_OMP_PARALLEL_FOR_ARGS(reduction(+:sum) collapse(2))
-    for (El::Int row = 0; row < height; ++row) {
-      for (El::Int col = 0; col < width; ++col) {
-        sum += mat_buf[row + col * ldim];
-      }
-    }
-  }
-  return sum;
-}
-
-template <typename TensorDataType, typename AccumT>
-inline void lbann_summary::local_sum_sqsum(
-  const El::AbstractMatrix<TensorDataType>& mat, AccumT& sum, AccumT& sqsum) const {
-  // Note there are more numerically stable ways to compute a sum.
-  const El::Int height = mat.Height();
-  const El::Int width = mat.Width();
-  const El::Int ldim = mat.LDim();
-  const auto* __restrict__ mat_buf = mat.LockedBuffer();
-  sum = AccumT(0);
-  sqsum = AccumT(0);
-  if (ldim == height) {
-    const El::Int size = height*width;
-    LBANN_OMP_PARALLEL_FOR_ARGS(reduction(+:sum,sqsum))
-    for (El::Int i = 0; i < size; ++i) {
-      const DataType val = mat_buf[i];
-      sum += val;
-      sqsum += val*val;
-    }
-  } else {
-    LBANN_OMP_PARALLEL_FOR_ARGS(reduction(+:sum,sqsum) collapse(2))
-    for (El::Int row = 0; row < height; ++row) {
-      for (El::Int col = 0; col < width; ++col) {
-        const DataType val = mat_buf[row + col*ldim];
-        sum += val;
-        sqsum += val * val;
-      }
-    }
+inline bool lbann_summary::counts_locally(
+  const El::AbstractDistMatrix<TensorDataType>& mat) const {
+  // Compute local statistics on master process if matrix is Star,Star
+  // and on all processes if matrix is in MC,MR; Star,VC; or similar
+  // format
+  // TODO: implement for matrices in Circ,Circ; MC,Star; or similar
+  // formats
+  El::DistData mat_format(mat);
+  if (mat_format.colDist == El::STAR && mat_format.rowDist == El::STAR) {
+    return m_comm->am_trainer_master();
   }
+  return true;
 }
 
 template <typename TensorDataType>
-inline auto lbann_summary::local_min(const El::AbstractMatrix<TensorDataType>& mat) const -> BiggerOf<TensorDataType, float> {
-  const El::Int height = mat.Height();
-  const El::Int width = mat.Width();
-  const El::Int ldim = mat.LDim();
-  const auto* __restrict__ mat_buf = mat.LockedBuffer();
-  using AccumT = BiggerOf<TensorDataType, float>;
-  AccumT min = std::numeric_limits<AccumT>::max();
-  if (ldim == height) {
-    const El::Int size = height*width;
-    LBANN_OMP_PARALLEL_FOR_ARGS(reduction(min:min))
-    for (El::Int i = 0; i < size; ++i) {
-      min = El::Min(min, mat_buf[i]);
-    }
-  } else {
-    LBANN_OMP_PARALLEL_FOR_ARGS(reduction(min:min) collapse(2))
-    for (El::Int row = 0; row < height; ++row) {
-      for (El::Int col = 0; col < width; ++col) {
-        min = El::Min(min, mat_buf[row + col*ldim]);
-      }
-    }
+inline int lbann_summary::local_stats(
+  const El::AbstractDistMatrix<TensorDataType>& mat,
+  double (&stats)[NUM_STAT_FIELDS]) {
+  stats[STAT_SUM] = 0.0;
+  stats[STAT_SQSUM] = 0.0;
+  stats[STAT_MIN] = DBL_MAX;
+  stats[STAT_MAX] = -DBL_MAX;
+  const auto& local_mat = mat.LockedMatrix();
+  if (!counts_locally(mat) || local_mat.IsEmpty()) {
+    return -1;
   }
-  return min;
-}
-
-template <typename TensorDataType>
-inline auto lbann_summary::local_max(const El::AbstractMatrix<TensorDataType>& mat) const -> BiggerOf<TensorDataType, float> {
-  const El::Int height = mat.Height();
-  const El::Int width = mat.Width();
-  const El::Int ldim = mat.LDim();
-  const auto* __restrict__ mat_buf = mat.LockedBuffer();
-  using AccumT = BiggerOf<TensorDataType, float>;
-  AccumT max = std::numeric_limits<AccumT>::min();
-  if (ldim == height) {
-    const El::Int size = height*width;
-    LBANN_OMP_PARALLEL_FOR_ARGS(reduction(max:max))
-    for (El::Int i = 0; i < size; ++i) {
-      max = El::Max(max, mat_buf[i]);
-    }
-  } else {
-    LBANN_OMP_PARALLEL_FOR_ARGS(reduction(max:max) collapse(2))
-    for (El::Int row = 0; row < height; ++row) {
-      for (El::Int col = 0; col < width; ++col) {
-        max = El::Max(max, mat_buf[row + col*ldim]);
-      }
-    }
+#ifdef LBANN_HAS_GPU
+  if (local_mat.GetDevice() == El::Device::GPU) {
+    const auto slot = next_device_slot();
+    auto slot_stats = m_device_stats(El::ALL, El::IR(slot, slot+1));
+    local_stats_gpu(
+      static_cast<const El::Matrix<TensorDataType, El::Device::GPU>&>(local_mat),
+      m_device_workspace, slot_stats);
+    return slot;
   }
-  return max;
+#endif // LBANN_HAS_GPU
+  local_stats_cpu(local_mat, stats);
+  return -1;
 }
 
 template <typename TensorDataType>
-inline auto lbann_summary::local_2norm(const El::AbstractMatrix<TensorDataType>& mat) const -> BiggerOf<TensorDataType, float> {
-  // Note there are more numerically stable ways to compute this.
+inline void lbann_summary::local_stats_cpu(
+  const El::AbstractMatrix<TensorDataType>& mat,
+  double (&stats)[NUM_STAT_FIELDS]) const {
+  // Note there are more numerically stable ways to compute a sum.
   const El::Int height = mat.Height();
   const El::Int width = mat.Width();
   const El::Int ldim = mat.LDim();
   const auto* __restrict__ mat_buf = mat.LockedBuffer();
-  using AccumT = BiggerOf<TensorDataType, float>;
-  AccumT norm = AccumT(0);
+  double sum = 0.0, sqsum = 0.0, min = DBL_MAX, max = -DBL_MAX;
   if (ldim == height) {
     const El::Int size = height*width;
-    LBANN_OMP_PARALLEL_FOR_ARGS(reduction(+:norm))
+    LBANN_OMP_PARALLEL_FOR_ARGS(reduction(+:sum,sqsum) reduction(min:min) reduction(max:max))
     for (El::Int i = 0; i < size; ++i) {
-      norm += mat_buf[i] * mat_buf[i];
+      const double val = mat_buf[i];
+      sum += val;
+      sqsum += val * val;
+      min = std::min(min, val);
+      max = std::max(max, val);
     }
   } else {
-    LBANN_OMP_PARALLEL_FOR_ARGS(reduction(+:norm) collapse(2))
+    LBANN_OMP_PARALLEL_FOR_ARGS(reduction(+:sum,sqsum) reduction(min:min) reduction(max:max) collapse(2))
     for (El::Int row = 0; row < height; ++row) {
       for (El::Int col = 0; col < width; ++col) {
-        norm += mat_buf[row + col * ldim] * mat_buf[row + col * ldim];
+        const double val = mat_buf[row + col * ldim];
+        sum += val;
+        sqsum += val * val;
+        min = std::min(min, val);
+        max = std::max(max, val);
       }
     }
   }
-  return El::Sqrt(norm);
+  stats[STAT_SUM] = sum;
+  stats[STAT_SQSUM] = sqsum;
+  stats[STAT_MIN] = min;
+  stats[STAT_MAX] = max;
 }
 
 #endif  // LBANN_HAS_TBINF
@@ -0,0 +1,166 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_TELEMETRY_HPP_INCLUDED
+#define LBANN_UTILS_TELEMETRY_HPP_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace lbann {
+
+/** @brief Low-overhead event tracing.
+ *
+ *  Each thread records fixed-size binary events into its own
+ *  lock-free ring buffer. Regions are identified by interned IDs and
+ *  timed with the CPU timestamp counter. A background thread drains
+ *  the rings and writes the events in Chrome trace format, which
+ *  can be viewed with chrome://tracing or Perfetto.
+ *
+ *  Recording an event does not allocate, lock, or hash strings.
+ *  When a ring is full, its events are dropped until the flusher
+ *  catches up. When tracing is disabled, a region costs one relaxed
+ *  atomic load.
+ */
+namespace telemetry {
+
+/** Interned region name. */
+using region_id = uint32_t;
+/** ID that does not name a region. */
+constexpr region_id no_region = UINT32_MAX;
+
+/** Kind of work in a region. */
+enum class category : uint8_t {
+  forward_prop,
+  backward_prop,
+  optimizer,
+  io,
+  comm,
+  other
+};
+
+/** Fixed-size binary event. */
+struct event {
+  /** Timestamp at the start of the region. */
+  uint64_t begin;
+  /** Timestamp at the end of the region. */
+  uint64_t end;
+  region_id region;
+  category cat;
+};
+
+namespace details {
+extern std::atomic<bool> enabled;
+/** Append an event to the calling thread's ring. */
+void record(const event& e) noexcept;
+} // namespace details
+
+/** Whether events are being recorded. */
+inline bool enabled() noexcept {
+  return details::enabled.load(std::memory_order_relaxed);
+}
+
+/** Current timestamp in ticks of the timestamp counter. */
+inline uint64_t ticks() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+/** Get the ID of a region name, assigning one if needed.
+ *
+ *  Thread-safe, but takes a lock, so IDs should be cached rather
+ *  than interned for every event.
+ */
+region_id intern(const std::string& name);
+
+/** @brief Start recording events.
+ *
+ *  @param filename       Chrome trace output file.
+ *  @param pid            Process ID written with the events, usually
+ *                        the MPI rank.
+ *  @param ring_capacity  Events per thread ring. Rounded up to a
+ *                        power of two.
+ *  @param flush_interval Seconds between flushes of the rings.
+ */
+void start(const std::string& filename,
+           int pid,
+           size_t ring_capacity = 1 << 16,
+           double flush_interval = 0.1);
+
+/** @brief Stop recording, flush all events, and close the output. */
+void stop();
+
+/** Number of events dropped because a ring was full. */
+uint64_t num_dropped();
+
+/** @brief Record the lifetime of an object as a region. */
+class scope {
+public:
+  scope(category cat, region_id region) noexcept
+    : m_region(enabled() ? region : no_region),
+      m_cat(cat),
+      m_begin(m_region != no_region ? ticks() : 0) {}
+
+  /** Intern @c name the first time the region is recorded and cache
+   *  its ID in @c cache. */
+  scope(category cat, const std::string& name, region_id& cache)
+    : m_region(no_region), m_cat(cat), m_begin(0) {
+    if (!enabled()) { return; }
+    if (cache == no_region) { cache = intern(name); }
+    m_region = cache;
+    m_begin = ticks();
+  }
+
+  ~scope() {
+    if (m_region != no_region) {
+      details::record({m_begin, ticks(), m_region, m_cat});
+    }
+  }
+
+  scope(const scope&) = delete;
+  scope& operator=(const scope&) = delete;
+
+private:
+  region_id m_region;
+  category m_cat;
+  uint64_t m_begin;
+};
+
+} // namespace telemetry
+} // namespace lbann
+
+#endif // LBANN_UTILS_TELEMETRY_HPP_INCLUDED
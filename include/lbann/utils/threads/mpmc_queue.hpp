@@ -0,0 +1,237 @@
+#ifndef LBANN_UTILS_THREADS_MPMC_QUEUE_HPP_INCLUDED
+#define LBANN_UTILS_THREADS_MPMC_QUEUE_HPP_INCLUDED
+
+#include "thread_safe_queue.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace lbann {
+
+/** @class mpmc_queue
+ *  @brief A queue that is safe for multiple threads to push to or
+ *  pull from "simultaneously".
+ *
+ *  This version is a bounded lock-free ring (D. Vyukov's MPMC queue):
+ *  the slots are allocated once, and each one has a sequence number
+ *  that tells producers and consumers whose turn it is. Pushing and
+ *  popping take no locks and do not allocate.
+ *
+ *  If the ring is full, values go to a locked overflow queue (@c
+ *  thread_safe_queue) instead of blocking the producer, which may
+ *  itself be a consumer. Values are then not strictly FIFO.
+ *
+ *  Consumers that find the queue empty spin briefly and then sleep
+ *  on a condition variable. Producers only touch the mutex when some
+ *  consumer is asleep.
+ *
+ *  @tparam T A default-constructible, move-assignable type
+ */
+template <typename T>
+class mpmc_queue {
+public:
+
+  /** @brief Create an empty queue
+   *  @param capacity Number of slots in the ring, rounded up to a
+   *                  power of two.
+   */
+  explicit mpmc_queue(size_t capacity = 1024)
+  {
+    size_t size = 2;
+    while (size < capacity) { size *= 2; }
+    mask_ = size - 1;
+    cells_.reset(new cell[size]);
+    for (size_t i = 0; i < size; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  /** @brief Adds a value to back of the queue */
+  void push(T value)
+  {
+    if (!try_push_ring_(value)) {
+      overflow_.push(std::move(value));
+    }
+    // Pairs with the fence in wait_and_pop, so either this thread
+    // sees the sleeper or the sleeper sees the value
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (num_sleepers_.load(std::memory_order_relaxed) > 0) {
+      { std::lock_guard<std::mutex> lk(sleep_mtx_); }
+      data_available_.notify_one();
+    }
+  }
+
+  void wake_all(bool stop = false) {
+    {
+      std::lock_guard<std::mutex> lk(sleep_mtx_);
+      m_stop_threads = stop;
+    }
+    data_available_.notify_all();
+  }
+
+  /// Allow the thread pool to set / reset the flags
+  void set_stop_threads(bool flag) { m_stop_threads = flag; }
+
+  /** @brief Try to remove the first value from the queue
+   *  @return false if the queue is empty
+   */
+  bool try_pop(T& value)
+  {
+    if (try_pop_ring_(value)) { return true; }
+    if (!overflow_.empty()) {
+      auto overflow_value = overflow_.try_pop();
+      if (overflow_value) {
+        value = std::move(*overflow_value);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /** @brief Wait for data and then return it
+   *  @return false if the queue is empty and the threads are stopped
+   */
+  bool wait_and_pop(T& value)
+  {
+    while (true) {
+      for (int spin = 0; spin < spin_count; ++spin) {
+        if (try_pop(value)) { return true; }
+        std::this_thread::yield();
+      }
+      std::unique_lock<std::mutex> lk(sleep_mtx_);
+      num_sleepers_.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      data_available_.wait(lk, [&]{ return !empty() || m_stop_threads; });
+      num_sleepers_.fetch_sub(1, std::memory_order_relaxed);
+      lk.unlock();
+      if (try_pop(value)) { return true; }
+      if (m_stop_threads && empty()) { return false; }
+    }
+  }
+
+  /** @brief Check if queue is empty
+   *  @details Values that are still being pushed may be missed.
+   */
+  bool empty() const
+  {
+    return (enqueue_pos_.load(std::memory_order_acquire)
+            == dequeue_pos_.load(std::memory_order_acquire)
+            && overflow_.empty());
+  }
+
+  /** @brief Number of slots in the ring */
+  size_t capacity() const noexcept { return mask_ + 1; }
+
+private:
+
+  /** @brief Try to add a value to the ring
+   *  @details The value is only moved from on success.
+   */
+  bool try_push_ring_(T& value)
+  {
+    cell* c;
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      c = &cells_[pos & mask_];
+      const size_t seq = c->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::intptr_t>(seq)
+        - static_cast<std::intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    c->data = std::move(value);
+    c->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** @brief Try to remove a value from the ring */
+  bool try_pop_ring_(T& value)
+  {
+    cell* c;
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      c = &cells_[pos & mask_];
+      const size_t seq = c->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::intptr_t>(seq)
+        - static_cast<std::intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    value = std::move(c->data);
+    c->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+
+  /** @brief Attempts to pop before a consumer goes to sleep */
+  static constexpr int spin_count = 64;
+
+  /** @brief Size of padding against false sharing */
+  static constexpr size_t cache_line_size = 64;
+
+  /** @class cell
+   *  @brief A slot in the ring
+   */
+  struct cell
+  {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  /** @brief The slots of the ring */
+  std::unique_ptr<cell[]> cells_;
+
+  /** @brief Ring size minus one */
+  size_t mask_;
+
+  char pad0_[cache_line_size];
+  /** @brief Position of the next push */
+  std::atomic<size_t> enqueue_pos_{0};
+  char pad1_[cache_line_size];
+  /** @brief Position of the next pop */
+  std::atomic<size_t> dequeue_pos_{0};
+  char pad2_[cache_line_size];
+
+  /** @brief Values that did not fit in the ring */
+  thread_safe_queue<T> overflow_;
+
+  /** @brief The mutex consumers sleep on */
+  mutable std::mutex sleep_mtx_;
+
+  /** @brief Condition variable tripped when data added */
+  std::condition_variable data_available_;
+
+  /** @brief Number of consumers asleep or about to sleep */
+  std::atomic<int> num_sleepers_{0};
+
+  std::atomic<bool> m_stop_threads{false};
+
+};// class mpmc_queue
+
+template <typename T> constexpr int mpmc_queue<T>::spin_count;
+template <typename T> constexpr size_t mpmc_queue<T>::cache_line_size;
+
+}// namespace lbann
+#endif /* LBANN_UTILS_THREADS_MPMC_QUEUE_HPP_INCLUDED */
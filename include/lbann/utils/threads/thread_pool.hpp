@@ -3,13 +3,16 @@
 
 #include "lbann_config.hpp"
 
-#include "thread_safe_queue.hpp"
+#include "mpmc_queue.hpp"
 #include "type_erased_function.hpp"
 #include "lbann/utils/exception.hpp"
 
 #include <sched.h>
 
+#include <deque>
 #include <future>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
 #include <vector>
@@ -57,6 +60,19 @@ public:
   void launch_threads(size_type num_threads);
   /** @brief Launch the threads and pin them to the Hyperthreaded cores */
   void launch_pinned_threads(size_type num_threads, int cpu_offset);
+  /** @brief Launch one thread pinned to each of the given CPUs
+   *  @details Falls back to unpinned threads if thread affinity is
+   *  not supported.
+   */
+  void launch_threads_on_cpus(const std::vector<int>& cpus);
+  /** @brief Number of OpenMP threads for parallel regions in jobs
+   *
+   *  With several workers, jobs that open OpenMP parallel regions
+   *  would otherwise each start a full team and oversubscribe the
+   *  cores. Zero (the default) leaves the OpenMP settings alone.
+   *  Applies to threads launched afterwards.
+   */
+  void set_worker_omp_threads(int num_threads) { m_worker_omp_threads = num_threads; }
   /** Wake and terminate all threads in the pool */
   void reap_threads();
   /** Reap all threads in the pool and relaunch pinned threads */
@@ -103,6 +119,25 @@ public:
     return true;
   }
 
+  /** @brief Split [0, n) into chunks and deal them out to per-worker deques
+   *
+   *  Each of the num_workers deques receives a contiguous run of
+   *  chunks of at most chunk_size items. Workers then consume their
+   *  chunks with get_next_chunk(), which steals from the other deques
+   *  once a worker's own deque is empty, so that a few expensive items
+   *  do not leave the remaining workers idle. Must not be called while
+   *  a previous partition is being consumed.
+   */
+  void partition_work(size_t n, size_t chunk_size, int num_workers);
+
+  /** @brief Get the next chunk [begin, end) for a worker
+   *
+   *  Pops from the front of the worker's own deque; if that is empty,
+   *  steals from the back of another worker's deque. Returns false
+   *  when all of the chunks have been handed out.
+   */
+  bool get_next_chunk(int worker, size_t& begin, size_t& end);
+
   /** @brief Query the number of worker threads actually present */
   size_type get_num_threads() const noexcept { return threads_.size(); }
 
@@ -118,13 +153,15 @@ private:
 #ifdef LBANN_HAS_PTHREAD_AFFINITY_SUPPORT
   void do_thread_work_pinned_thread_(int tid, cpu_set_t cpu_set);
 #endif // LBANN_HAS_PTHREAD_AFFINITY_SUPPORT
+  /** @brief Apply @c m_worker_omp_threads in a worker thread */
+  void setup_worker_omp_threads_();
 private:
 
   /** @brief Container holding the threads */
   thread_container_type threads_;
 
-  /** @brief The thread-safe work queue */
-  thread_safe_queue<type_erased_function> global_work_queue_;
+  /** @brief The lock-free work queue */
+  mpmc_queue<type_erased_function> global_work_queue_;
 
   /** @brief RAII "deleter" for the threads */
   thread_joiner thread_joiner_;
@@ -138,8 +175,23 @@ private:
   /** @brief Work Group */
   std::vector<std::future<bool>> m_work_group;
 
+  /** @brief The chunks of [begin, end) ranges owned by one worker */
+  struct work_deque {
+    std::mutex mutex;
+    std::deque<std::pair<size_t, size_t>> chunks;
+  };
+
+  /** @brief Per-worker deques filled by partition_work() */
+  std::vector<std::unique_ptr<work_deque>> m_work_deques;
+
   int m_threads_offset;
 
+  /** @brief CPUs of threads from @c launch_threads_on_cpus */
+  std::vector<int> m_thread_cpus;
+
+  /** @brief OpenMP threads in each worker (zero to leave alone) */
+  int m_worker_omp_threads = 0;
+
 };// class thread_pool
 
 }// namespace lbann
@@ -29,11 +29,43 @@
 
 #include "lbann/comm.hpp"
 
+#include <vector>
+
 namespace lbann {
 
 int num_free_cores_per_process(const lbann_comm *comm);
 int free_core_offset(const lbann_comm *comm);
 
+/** @brief Split of a process' CPUs between compute and I/O threads */
+struct core_partition {
+  /** CPUs for the OpenMP compute threads. */
+  std::vector<int> compute_cpus;
+  /** CPUs for the I/O threads. */
+  std::vector<int> io_cpus;
+};
+
+/** @brief Split the CPUs a process is bound to between compute and
+ *  I/O threads.
+ *
+ *  Uses the process' affinity mask, so each process only uses the
+ *  cores (and NUMA domain) its launcher bound it to. The last @c
+ *  num_io_threads CPUs go to I/O threads and, with Aluminum, the one
+ *  before them is left for its progress thread. The rest are for
+ *  OpenMP.
+ *
+ *  @returns An empty partition if thread affinity is not supported
+ *  or there are too few CPUs.
+ */
+core_partition partition_process_cores(int num_io_threads);
+
+/** @brief Run OpenMP compute on the given CPUs.
+ *
+ *  Sets the number of OpenMP threads to the number of CPUs and, unless
+ *  OMP_PLACES or OMP_PROC_BIND control the binding, pins each thread
+ *  of the OpenMP pool to one of them.
+ */
+void pin_omp_threads(lbann_comm& comm, const std::vector<int>& cpus);
+
 } // namespace lbann
 
 #endif // LBANN_UTILS_THREADS_THREAD_UTILS_HPP_INCLUDED
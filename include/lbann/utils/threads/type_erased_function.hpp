@@ -3,7 +3,9 @@
 
 #include <lbann/utils/memory.hpp>
 
+#include <cstddef>
 #include <memory>
+#include <new>
 #include <type_traits>
 #include <utility>
 
@@ -11,30 +13,61 @@ namespace lbann {
 
 /** @class type_erased_function
  *  @brief A move-only callable type for wrapping functions
+ *
+ *  Small functions (e.g. @c std::packaged_task or lambdas with a few
+ *  captures) are stored in an inline buffer, so wrapping them does
+ *  not allocate. Larger ones are stored on the heap.
  */
 class type_erased_function {
 public:
 
+  /** @brief Size of the inline buffer for small functions */
+  static constexpr size_t inline_size = 48;
+
+  /** @brief Create an empty function */
+  type_erased_function() noexcept = default;
+
   /** @brief Erase the type of input function F */
-  template <typename FunctionT>
+  template <typename FunctionT,
+            typename = typename std::enable_if<
+              !std::is_same<typename std::decay<FunctionT>::type,
+                            type_erased_function>::value>::type>
   type_erased_function(FunctionT&& F)
-    : held_function_(make_unique<Function<FunctionT>>(std::move(F))) {}
+  {
+    using held_type = Function<typename std::decay<FunctionT>::type>;
+    construct_<held_type>(
+      std::forward<FunctionT>(F),
+      std::integral_constant<bool, fits_inline<held_type>()>());
+  }
 
   /** @brief Move constructor */
-  type_erased_function(type_erased_function&& other) = default;
+  type_erased_function(type_erased_function&& other) noexcept
+  {
+    take_(other);
+  }
 
   /** @brief Move assignment */
-  type_erased_function& operator=(type_erased_function&& other) = default;
+  type_erased_function& operator=(type_erased_function&& other) noexcept
+  {
+    if (this != &other) {
+      reset_();
+      take_(other);
+    }
+    return *this;
+  }
+
+  /** @brief Destructor */
+  ~type_erased_function() { reset_(); }
 
   /** @brief Make the function callable */
   void operator()() { held_function_->call_held(); }
 
+  /** @brief Whether a function is held */
+  explicit operator bool() const noexcept { return held_function_ != nullptr; }
+
   /** @name Deleted functions */
   ///@{
 
-  /** @brief Deleted constructor */
-  type_erased_function() = delete;
-
   /** @brief Deleted copy constructor */
   type_erased_function(const type_erased_function& other) = delete;
 
@@ -57,6 +90,9 @@ private:
 
     /** @brief Call the held function */
     virtual void call_held() = 0;
+
+    /** @brief Move the held function into an inline buffer */
+    virtual FunctionHolder* move_to(void* buffer) noexcept = 0;
   };
 
   /** @class Function
@@ -70,9 +106,10 @@ private:
     static_assert(std::is_move_constructible<FunctionT>::value,
                   "Given type is not move constructible!");
 
-    /** @brief Construct by moving from the input function type */
-    Function(FunctionT&& f)
-      : F__(std::move(f)) {}
+    /** @brief Construct from the input function type */
+    template <typename F>
+    Function(F&& f)
+      : F__(std::forward<F>(f)) {}
 
     /** @brief Destructor */
     ~Function() = default;
@@ -80,13 +117,70 @@ private:
     /** @brief Call the held function */
     void call_held() override { F__(); }
 
+    /** @brief Move the held function into an inline buffer
+     *  @details Only called for functions that fit inline.
+     */
+    FunctionHolder* move_to(void* buffer) noexcept override {
+      return new (buffer) Function(std::move(F__));
+    }
+
     /** @brief The held function */
     FunctionT F__;
   };
   ///@}
 
-  /** @brief A type-erased function */
-  std::unique_ptr<FunctionHolder> held_function_;
+  /** @brief Whether a held function is stored in the inline buffer */
+  template <typename HeldT>
+  static constexpr bool fits_inline() {
+    return (sizeof(HeldT) <= inline_size
+            && alignof(HeldT) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible<HeldT>::value);
+  }
+
+  /** @brief Store a function in the inline buffer */
+  template <typename HeldT, typename FunctionT>
+  void construct_(FunctionT&& F, std::true_type) {
+    held_function_ = new (&buffer_) HeldT(std::forward<FunctionT>(F));
+    is_inline_ = true;
+  }
+
+  /** @brief Store a function on the heap */
+  template <typename HeldT, typename FunctionT>
+  void construct_(FunctionT&& F, std::false_type) {
+    held_function_ = new HeldT(std::forward<FunctionT>(F));
+  }
+
+  /** @brief Destroy the held function */
+  void reset_() noexcept {
+    if (is_inline_) { held_function_->~FunctionHolder(); }
+    else            { delete held_function_; }
+    held_function_ = nullptr;
+    is_inline_ = false;
+  }
+
+  /** @brief Take the function held by another object */
+  void take_(type_erased_function& other) noexcept {
+    if (other.is_inline_) {
+      held_function_ = other.held_function_->move_to(&buffer_);
+      is_inline_ = true;
+      other.reset_();
+    } else {
+      held_function_ = other.held_function_;
+      other.held_function_ = nullptr;
+    }
+  }
+
+  /** @brief Inline storage for small functions */
+  typename std::aligned_storage<inline_size,
+                                alignof(std::max_align_t)>::type buffer_;
+
+  /** @brief A type-erased function
+   *  @details Points into @c buffer_ or to the heap.
+   */
+  FunctionHolder* held_function_ = nullptr;
+
+  /** @brief Whether the function is stored in @c buffer_ */
+  bool is_inline_ = false;
 };// class type_erased_function
 
 }// namespace lbann
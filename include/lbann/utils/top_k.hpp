@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_TOP_K_HPP_INCLUDED
+#define LBANN_UTILS_TOP_K_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+#if defined(LBANN_HAS_GPU) && defined(__CUDACC__)
+
+#include "lbann/utils/cuda.hpp"
+
+namespace lbann {
+namespace cuda {
+
+/** @brief Sparse vector entry. */
+template <typename TensorDataType>
+struct top_k_entry {
+  /** Vector entry value. */
+  TensorDataType value;
+  /** Vector entry index. */
+  El::Int index;
+};
+
+/** @brief Find the k largest entries in each matrix column.
+ *
+ *  Entries are sorted by value in decreasing order, with ties broken
+ *  in favor of entries with smaller indices. A local row @c i
+ *  corresponds to index @c col_shift + @c i * @c col_stride. Columns
+ *  with fewer than k entries are padded with @f$ -\infty @f$ entries
+ *  with index @c pad_index.
+ *
+ *  For small k, each column is handled by one thread block that
+ *  keeps a sorted top-k list per thread and merges them in shared
+ *  memory, so the cost is linear in the column height. Larger k fall
+ *  back to a segmented sort of the whole matrix.
+ *
+ *  @param entries      Output array with k entries per column and
+ *                      leading dimension @c entries_ldim.
+ */
+template <typename TensorDataType>
+void top_k_columns(El::Int k,
+                   El::Int height, El::Int width,
+                   const TensorDataType* matrix, El::Int matrix_ldim,
+                   El::Int col_shift, El::Int col_stride,
+                   El::Int pad_index,
+                   top_k_entry<TensorDataType>* entries,
+                   El::Int entries_ldim,
+                   cudaStream_t stream);
+
+/** @brief Find the k largest sparse vector entries in each column.
+ *
+ *  Same as above, except the input consists of @c num_blocks arrays
+ *  of entries, each @c block_height x @c width with leading dimension
+ *  @c input_ldim and stored @c block_stride entries apart (e.g. top-k
+ *  entries gathered from several processes).
+ */
+template <typename TensorDataType>
+void top_k_columns(El::Int k,
+                   El::Int block_height, El::Int num_blocks, El::Int width,
+                   const top_k_entry<TensorDataType>* input,
+                   El::Int input_ldim, El::Int block_stride,
+                   El::Int pad_index,
+                   top_k_entry<TensorDataType>* entries,
+                   El::Int entries_ldim,
+                   cudaStream_t stream);
+
+} // namespace cuda
+} // namespace lbann
+
+#include "lbann/utils/impl/top_k.hpp"
+
+#endif // defined(LBANN_HAS_GPU) && defined(__CUDACC__)
+#endif // LBANN_UTILS_TOP_K_HPP_INCLUDED
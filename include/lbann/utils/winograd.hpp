@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_UTILS_WINOGRAD_HPP
+#define LBANN_UTILS_WINOGRAD_HPP
+
+#include "lbann/base.hpp"
+
+namespace lbann {
+
+/// Number of entries in a transformed 3x3 filter
+/** Winograd F(4x4,3x3) transforms each 3x3 filter and each 6x6 input
+ *  tile into 6x6 tiles, multiplies them entrywise (as 36 GEMMs over
+ *  channels), and transforms the products into 4x4 output tiles.
+ */
+constexpr int winograd_f4x4_3x3_tile_size = 36;
+
+/// Transform 3x3 convolution filters for Winograd F(4x4,3x3)
+/** @param kernel_buffer      Filters, ordered as
+ *                            output channel x input channel x 3 x 3.
+ *  @param transformed_buffer Transformed filters. Holds 36 matrices,
+ *                            each num_output_channels x
+ *                            num_input_channels and contiguous.
+ */
+template <typename TensorDataType>
+void winograd_f4x4_3x3_transform_filters(
+  const TensorDataType * kernel_buffer,
+  TensorDataType * transformed_buffer,
+  int num_input_channels,
+  int num_output_channels);
+
+/// 2D 3x3 stride-1 convolution with Winograd F(4x4,3x3)
+/** Computes the same result as im2col + GEMM for one sample, with
+ *  about 4x fewer multiplications.
+ *  @param input_buffer       Input tensor (channels x height x width).
+ *  @param transformed_filters Output of
+ *                            @c winograd_f4x4_3x3_transform_filters.
+ *  @param output_buffer      Output tensor (channels x height x
+ *                            width), where the output spatial dims
+ *                            are input_dim + 2*pad - 2.
+ */
+template <typename TensorDataType>
+void winograd_f4x4_3x3_convolution(
+  const TensorDataType * input_buffer,
+  const TensorDataType * transformed_filters,
+  TensorDataType * output_buffer,
+  int num_input_channels,
+  int num_output_channels,
+  int input_dim_y,
+  int input_dim_x,
+  int pad_y,
+  int pad_x);
+
+} // namespace lbann
+
+#endif // LBANN_UTILS_WINOGRAD_HPP
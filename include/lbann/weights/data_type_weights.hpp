@@ -79,7 +79,7 @@ public:
   data_type_weights(lbann_comm* comm);
   data_type_weights(const data_type_weights& other);
   data_type_weights& operator=(const data_type_weights& other);
-  virtual ~data_type_weights() = default;
+  virtual ~data_type_weights();
 
   /** Create a copy of the weights.
    *  This function dynamically allocates memory for a weights
@@ -93,6 +93,8 @@ public:
 
   bool has_optimizer() const override { return m_optimizer != nullptr; }
 
+  size_t get_memory_usage(El::Device device) const override;
+
   // -----------------------------------------------
   // Dimension accessors
   // -----------------------------------------------
@@ -130,21 +132,66 @@ public:
    */
   void set_optimizer(std::unique_ptr<optimizer>&& opt) override;
 
+  // -----------------------------------------------
+  // Master weights
+  // -----------------------------------------------
+  /** Keep single-precision master values.
+   *  Meant for reduced-precision weights. The weights values are
+   *  rounded copies of fp32 master values, which are updated by
+   *  'opt' so that small updates are not lost to rounding. The
+   *  optimizer returned by get_optimizer still accumulates the
+   *  (reduced-precision) gradient. 'opt' must be an optimizer for
+   *  float weights with the same hyperparameters as the weights
+   *  optimizer. Must be called before setup.
+   */
+  void set_master_optimizer(std::unique_ptr<optimizer>&& opt);
+  /** Whether the weights keep single-precision master values. */
+  bool has_master_weights() const noexcept {
+    return m_master_weights != nullptr;
+  }
+  /** Get single-precision master weights. */
+  data_type_weights<float>& get_master_weights();
+
   // -----------------------------------------------
   // Setup
   // -----------------------------------------------
   void setup() override;
+  void initialize_values() override;
 
   // -----------------------------------------------
   // Weight matrix accessors
   // -----------------------------------------------
 
-  /** Get the weight matrix. */
+  /** Get the weight matrix for writing.
+   *  If the matrix is shared with copies of the weights, it is deep
+   *  copied first. Views into the matrix should not be kept across
+   *  calls.
+   */
   AbsDistMatrixType& get_values();
   /** Get the weight matrix. */
   const AbsDistMatrixType& get_values() const;
   /** Set the weight matrix. */
   void set_values(const AbsDistMatrixType& values);
+  /** Share the weight matrix of other for writing as well as reading.
+   *  Afterwards an update to either weights is seen by both, without
+   *  copies, e.g. for models that train parts of the same network in
+   *  turns. The weights must have the same dimensions and
+   *  distribution, and must have been setup. Copies of tied weights
+   *  (and snapshots) are not tied; they share the matrix
+   *  copy-on-write as usual.
+   */
+  void tie_values(WeightsType& other);
+  /** Use external memory for the local weight matrix.
+   *  The current values are not copied. 'buffer' holds the local
+   *  matrix in column-major order without padding; it is not owned
+   *  and must outlive the weights, e.g. node-shared memory. Only for
+   *  element-wise distributed weights on the CPU, after setup.
+   */
+  void attach_values(TensorDataType* buffer);
+  /** Whether the weight matrix is tied to other weights. */
+  bool has_tied_values() const noexcept {
+    return m_tied_weights != nullptr && m_tied_weights->size() > 1;
+  }
 
   /** Set a weight value. */
   void set_value(TensorDataType value, int index);
@@ -164,6 +211,10 @@ public:
    */
   void reconcile_values(Al::request& req) override;
 
+  void save_snapshot() override;
+  void swap_snapshot() override;
+  void clear_snapshot() override;
+
   // -----------------------------------------------
   // Checkpointing
   // -----------------------------------------------
@@ -178,8 +229,20 @@ public:
 
 private:
 
-  /** Weight matrix. */
-  std::unique_ptr<AbsDistMatrixType> m_values;
+  /** Weight matrix.
+   *  Copies of the weights share the matrix until one of them
+   *  accesses it for writing (copy-on-write).
+   */
+  std::shared_ptr<AbsDistMatrixType> m_values;
+  /** Snapshot of the weight matrix.
+   *  Default is nullptr, which corresponds to no snapshot. It shares
+   *  the weight matrix like copies of the weights do.
+   */
+  std::shared_ptr<AbsDistMatrixType> m_snapshot_values;
+  /** Weights that share the weight matrix for writing, including
+   *  these; see tie_values(). Default is nullptr.
+   */
+  std::shared_ptr<std::vector<WeightsType*>> m_tied_weights;
 
   /** Weights initializer.
    *  Default is nullptr, which corresponds to zero initialization.
@@ -189,6 +252,22 @@ private:
    *  Default is nullptr, which corresponds to no optimizer.
    */
   std::unique_ptr<OptimizerType> m_optimizer;
+  /** Single-precision master weights.
+   *  Default is nullptr, which corresponds to no master weights.
+   */
+  std::unique_ptr<data_type_weights<float>> m_master_weights;
+
+  /** Give the weights a private copy of a shared weight matrix.
+   *  Called before any write to the weight matrix. Tied weights
+   *  keep sharing; the private copy is made for all of them.
+   */
+  void detach_values();
+  /** Leave the group of tied weights, if any. */
+  void untie_values();
+  /** Round master values into the weight matrix. */
+  void copy_values_from_master();
+  /** Set master values to the weight matrix. */
+  void copy_values_to_master();
 
   friend class data_type_optimizer<TensorDataType>;
 };
@@ -31,6 +31,7 @@
 #include "lbann/comm.hpp"
 #include "lbann/io/persist.hpp"
 #include "lbann/utils/description.hpp"
+#include "lbann/utils/telemetry.hpp"
 
 #include <memory>
 #include <string>
@@ -79,7 +80,12 @@ public:
    *  Each set of weights in a model should have a unique,
    *  human-readable name.
    */
-  void set_name(std::string name) { m_name = name; }
+  void set_name(std::string name) {
+    m_name = name;
+    m_telemetry_region = telemetry::no_region;
+  }
+  /** Cached telemetry region of the weights name. */
+  telemetry::region_id& get_telemetry_region() { return m_telemetry_region; }
   /** Get weights name. */
   std::string get_name() const { return m_name; }
 
@@ -100,6 +106,10 @@ public:
 
   virtual bool has_optimizer() const = 0;
 
+  /** Bytes of local memory owned by the weight values on a device,
+   *  including snapshots and master copies but not the optimizer. */
+  virtual size_t get_memory_usage(El::Device device) const = 0;
+
   // -----------------------------------------------
   // Dimension accessors
   // -----------------------------------------------
@@ -183,6 +193,44 @@ public:
   // -----------------------------------------------
   virtual void setup();
 
+  // -----------------------------------------------
+  // Initialization
+  // -----------------------------------------------
+  /** Do not run the initializer during setup.
+   *  The values are left unset until they are loaded from a
+   *  checkpoint or 'initialize_values' is called. This avoids
+   *  initializing weights that a restart immediately overwrites.
+   *  Must be called before setup.
+   */
+  void defer_initialization() { m_initialization_pending = true; }
+  /** Whether the values have not been set since setup. */
+  bool is_initialization_pending() const noexcept {
+    return m_initialization_pending;
+  }
+  /** Set the values with the weights initializer.
+   *  The values are zero if there is no initializer.
+   */
+  virtual void initialize_values() = 0;
+
+  // -----------------------------------------------
+  // Initialization
+  // -----------------------------------------------
+  /** Do not run the initializer during setup.
+   *  The values are left unset until they are loaded from a
+   *  checkpoint or 'initialize_values' is called. This avoids
+   *  initializing weights that a restart immediately overwrites.
+   *  Must be called before setup.
+   */
+  void defer_initialization() { m_initialization_pending = true; }
+  /** Whether the values have not been set since setup. */
+  bool is_initialization_pending() const noexcept {
+    return m_initialization_pending;
+  }
+  /** Set the values with the weights initializer.
+   *  The values are zero if there is no initializer.
+   */
+  virtual void initialize_values() = 0;
+
   // -----------------------------------------------
   // Freezing
   // -----------------------------------------------
@@ -208,6 +256,16 @@ public:
    */
   virtual void reconcile_values(Al::request& req) = 0;
 
+  /** Copy the weight values into a snapshot. */
+  virtual void save_snapshot() = 0;
+  /** Exchange the weight values with the snapshot.
+   *  This does not copy any data. Weight values must be swapped back
+   *  before an optimization step.
+   */
+  virtual void swap_snapshot() = 0;
+  /** Deallocate the snapshot. */
+  virtual void clear_snapshot() = 0;
+
   // -----------------------------------------------
   // Checkpointing
   // -----------------------------------------------
@@ -220,6 +278,13 @@ public:
   /** Write weights to proto file */
   virtual void write_proto(lbann_data::WeightsData* proto) const = 0;
 
+protected:
+
+  /** Record that the values have been set. */
+  void clear_initialization_pending() noexcept {
+    m_initialization_pending = false;
+  }
+
 private:
 
   /** Weights name.
@@ -228,6 +293,10 @@ private:
    */
   std::string m_name;
 
+  /** Telemetry region of the weights name. Interned when first
+   *  recorded. */
+  telemetry::region_id m_telemetry_region = telemetry::no_region;
+
   /** Reference to LBANN communicator. */
   lbann_comm* m_comm;
 
@@ -245,6 +314,10 @@ private:
   /** Whether weight optimization is disabled. */
   bool m_frozen;
 
+  /** Whether setup skipped the initializer and the values have not
+   *  been set since. */
+  bool m_initialization_pending;
+
 };
 
 } // namespace lbann
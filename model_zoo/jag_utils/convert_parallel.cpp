@@ -0,0 +1,362 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann_config.hpp"
+
+#include "conduit/conduit.hpp"
+#include "conduit/conduit_relay.hpp"
+#include "conduit/conduit_relay_io_hdf5.hpp"
+#include <cnpy.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "lbann/lbann.hpp"
+#include "lbann/data_readers/sample_list.hpp"
+#include "lbann/data_readers/sample_list_binary.hpp"
+#include "lbann/utils/file_utils.hpp"
+#include "lbann/utils/jag_utils.hpp"
+#include "lbann/utils/threads/thread_pool.hpp"
+
+using namespace lbann;
+
+namespace {
+
+/// Field names and the groups they live under in a bundle
+struct schema {
+  std::string input_dir;
+  std::string scalar_dir;
+  std::string image_dir;
+  std::vector<std::string> inputs;
+  std::vector<std::string> scalars;
+  std::vector<std::string> images;
+};
+
+schema get_schema(bool jag) {
+  schema s;
+  if (jag) {
+    s.input_dir = "/inputs/";
+    s.scalar_dir = "/outputs/scalars/";
+    s.image_dir = "/outputs/images/";
+    s.inputs = {"shape_model_initial_modes:(4,3)", "betti_prl15_trans_u",
+                "betti_prl15_trans_v", "shape_model_initial_modes:(2,1)",
+                "shape_model_initial_modes:(1,0)"};
+    s.scalars = {"BWx", "BT", "tMAXt", "BWn", "MAXpressure", "BAte",
+                 "MAXtion", "tMAXpressure", "BAt", "Yn", "Ye", "Yx",
+                 "tMAXte", "BAtion", "MAXte", "tMAXtion", "BTx", "MAXt",
+                 "BTn", "BApressure", "tMINradius", "MINradius"};
+    s.images = {"(0.0, 0.0)/0.0/emi", "(90.0, 0.0)/0.0/emi",
+                "(90.0, 78.0)/0.0/emi"};
+  } else {
+    s.input_dir = "/inputs/";
+    s.scalar_dir = "/scalars/";
+    s.image_dir = "/images/";
+    s.inputs = {"p_preheat", "sc_peak", "t_3rd", "t_end"};
+    s.scalars = {"avg_rhor", "peak_eprod", "peak_tion_bw_DT",
+                 "bt_tion_bw_DT", "avg_tion_bw_DT", "adiabat", "bangt",
+                 "burnwidth", "bt_rhor", "bt_eprodr", "peak_eprodr"};
+    s.images = {"(90,0)/bang/image/data", "(0,0)/bang/image/data"};
+  }
+  return s;
+}
+
+/// What one converted bundle contributes to the sample list index
+struct converted_file {
+  size_t file_index = 0;
+  std::string name;
+  size_t total_samples = 0;
+  std::vector<std::string> samples;
+  size_t bytes_read = 0;
+};
+
+// The HDF5 library is not assumed to be thread-safe, so every call
+// into it goes through this lock; packing and writing run unlocked
+std::mutex hdf5_mutex;
+
+/// Read the good samples of one bundle, keeping only the schema fields
+converted_file read_bundle(const std::string& path, const schema& s,
+                           conduit::Node& samples) {
+  converted_file out;
+  std::lock_guard<std::mutex> lock(hdf5_mutex);
+  hid_t hnd = conduit::relay::io::hdf5_open_file_for_read(path);
+  std::vector<std::string> cnames;
+  conduit::relay::io::hdf5_group_list_child_names(hnd, "/", cnames);
+  out.total_samples = cnames.size();
+  conduit::Node n_ok, tmp;
+  for (const auto& name : cnames) {
+    const std::string key_ok = "/" + name + "/performance/success";
+    // hydra has a top-level child that is meta-data, not a sample
+    if (!conduit::relay::io::hdf5_has_path(hnd, key_ok)) {
+      continue;
+    }
+    conduit::relay::io::hdf5_read(hnd, key_ok, n_ok);
+    if (n_ok.to_int64() != 1) {
+      continue;
+    }
+    conduit::Node& sample = samples[name];
+    sample["performance/success"] = 1;
+    for (const auto& f : s.inputs) {
+      conduit::relay::io::hdf5_read(hnd, name + s.input_dir + f, tmp);
+      sample[s.input_dir.substr(1) + f] = tmp;
+      out.bytes_read += tmp.total_bytes_compact();
+    }
+    for (const auto& f : s.scalars) {
+      conduit::relay::io::hdf5_read(hnd, name + s.scalar_dir + f, tmp);
+      sample[s.scalar_dir.substr(1) + f] = tmp;
+      out.bytes_read += tmp.total_bytes_compact();
+    }
+    for (const auto& f : s.images) {
+      conduit::relay::io::hdf5_read(hnd, name + s.image_dir + f, tmp);
+      sample[s.image_dir.substr(1) + f] = tmp;
+      out.bytes_read += tmp.total_bytes_compact();
+    }
+    out.samples.push_back(name);
+  }
+  conduit::relay::io::hdf5_close_file(hnd);
+  return out;
+}
+
+/** Pack the samples as one float32 row each, [inputs | scalars | images],
+ *  and save them as an uncompressed npz that numpy_npz_reader can map
+ *  with --numpy_mmap. "columns" holds the offsets of the three blocks.
+ */
+void write_npz(const std::string& filename, const schema& s,
+               const converted_file& f, const conduit::Node& samples) {
+  if (f.samples.empty()) {
+    LBANN_ERROR("no good samples to write to ", filename);
+  }
+  const conduit::Node& first = samples[f.samples.front()];
+  std::vector<size_t> columns = {0, s.inputs.size(),
+                                 s.inputs.size() + s.scalars.size()};
+  size_t width = columns.back();
+  for (const auto& im : s.images) {
+    width += first[s.image_dir.substr(1) + im].dtype().number_of_elements();
+  }
+  columns.push_back(width);
+
+  std::vector<float> data(f.samples.size() * width);
+  conduit::Node tmp;
+  for (size_t i = 0; i < f.samples.size(); ++i) {
+    const conduit::Node& sample = samples[f.samples[i]];
+    float* row = &data[i * width];
+    for (const auto& v : s.inputs) {
+      *row++ = sample[s.input_dir.substr(1) + v].to_float32();
+    }
+    for (const auto& v : s.scalars) {
+      *row++ = sample[s.scalar_dir.substr(1) + v].to_float32();
+    }
+    for (const auto& im : s.images) {
+      sample[s.image_dir.substr(1) + im].to_float32_array(tmp);
+      const conduit::float32_array a = tmp.value();
+      for (conduit::index_t g = 0; g < a.number_of_elements(); ++g) {
+        *row++ = a[g];
+      }
+    }
+    if (row != &data[i * width] + width) {
+      LBANN_ERROR("sample ", f.samples[i], " in ", f.name,
+                  " has images of a different size than the first sample");
+    }
+  }
+  cnpy::npz_save(filename, "data", data.data(),
+                 {f.samples.size(), width}, "w");
+  cnpy::npz_save(filename, "columns", columns.data(),
+                 {columns.size()}, "a");
+}
+
+std::string basename_of(const std::string& path) {
+  const size_t k = path.rfind('/');
+  return (k == std::string::npos ? path : path.substr(k + 1));
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  int random_seed = lbann_default_random_seed;
+  world_comm_ptr comm = initialize(argc, argv, random_seed);
+  bool master = comm->am_world_master();
+
+  try {
+    options *opts = options::get();
+    opts->init(argc, argv);
+
+    if (!(opts->has_string("filelist") && opts->has_string("output_dir"))) {
+      if (master) {
+        std::cout << "usage: " << argv[0] << " --filelist=<string> --output_dir=<string>\n"
+          "         [--format=<npz|conduit_bin|hdf5>] [--jag=<0|1>] [--num_threads=<int>]\n"
+          "where: filelist contains a list of conduit HDF5 bundles\n"
+          "       (in the format of build_index, with full paths)\n"
+          "function: converts the bundles in parallel; files are striped\n"
+          "          over the ranks and each rank packs and writes them\n"
+          "          with num_threads threads (default: 4). Writes\n"
+          "            npz:         float32 rows [inputs | scalars | images]\n"
+          "                         for numpy_npz_reader --numpy_mmap\n"
+          "            conduit_bin: bundles of the good samples and fields\n"
+          "            hdf5:        as conduit_bin, in HDF5\n"
+          "          plus output_dir/index.txt (CONDUIT_HDF5_INCLUSION) and\n"
+          "          output_dir/index.bin (binary sample list)\n";
+      }
+      return EXIT_SUCCESS;
+    }
+
+    const std::string output_dir = opts->get_string("output_dir");
+    const std::string format = opts->get_string("format", "npz");
+    const schema s = get_schema(opts->get_int("jag", 1) != 0);
+    const int num_threads = opts->get_int("num_threads", 4);
+    if (format != "npz" && format != "conduit_bin" && format != "hdf5") {
+      LBANN_ERROR("unknown --format=", format, "; must be npz, conduit_bin or hdf5");
+    }
+    const std::string suffix = (format == "npz" ? ".npz"
+                                : format == "hdf5" ? ".hdf5" : ".bundle");
+    if (master) {
+      create_dir(output_dir);
+    }
+    comm->global_barrier();
+
+    std::vector<std::string> filenames;
+    read_filelist(comm.get(), opts->get_string("filelist"), filenames);
+
+    // Each bundle is one task: read (under the HDF5 lock), then pack and
+    // write, so reads on one thread overlap writes on the others
+    const int rank = comm->get_rank_in_world();
+    const int np = comm->get_procs_in_world();
+    const double tm1 = get_time();
+    thread_pool pool(num_threads);
+    std::vector<std::future<converted_file>> tasks;
+    for (size_t j = rank; j < filenames.size(); j += np) {
+      tasks.emplace_back(pool.submit_job([&, j]() {
+        conduit::Node samples;
+        converted_file f = read_bundle(filenames[j], s, samples);
+        f.file_index = j;
+        std::string name = basename_of(filenames[j]);
+        name = name.substr(0, name.rfind('.')) + suffix;
+        f.name = name;
+        const std::string path = add_delimiter(output_dir) + name;
+        if (format == "npz") {
+          write_npz(path, s, f, samples);
+        } else if (format == "hdf5") {
+          std::lock_guard<std::mutex> lock(hdf5_mutex);
+          conduit::relay::io::save(samples, path, "hdf5");
+        } else {
+          conduit::relay::io::save(samples, path, "conduit_bin");
+        }
+        return f;
+      }));
+    }
+
+    // Write this rank's part of the index
+    std::vector<converted_file> converted;
+    size_t bytes_read = 0, num_samples = 0;
+    for (auto& t : tasks) {
+      converted.emplace_back(t.get());
+      bytes_read += converted.back().bytes_read;
+      num_samples += converted.back().samples.size();
+    }
+    const double tm2 = get_time();
+    {
+      std::ofstream out(add_delimiter(output_dir) + "index.txt." + std::to_string(rank));
+      if (!out) {
+        LBANN_ERROR("failed to open the index part for rank ", rank);
+      }
+      for (const auto& f : converted) {
+        out << f.file_index << " " << f.name << " " << f.total_samples
+            << " " << f.samples.size();
+        for (const auto& sample : f.samples) {
+          out << " " << sample;
+        }
+        out << "\n";
+      }
+    }
+    comm->global_barrier();
+
+    const auto global_bytes = comm->allreduce(double(bytes_read), comm->get_world_comm());
+    const auto global_samples = comm->allreduce(double(num_samples), comm->get_world_comm());
+    const auto max_time = comm->allreduce(tm2 - tm1, comm->get_world_comm(), El::mpi::MAX);
+
+    // The master merges the parts in the order of the filelist
+    if (master) {
+      std::vector<sample_list_binary::file_entry> files(filenames.size());
+      for (int r = 0; r < np; ++r) {
+        const std::string part = add_delimiter(output_dir) + "index.txt." + std::to_string(r);
+        std::ifstream in(part);
+        std::string line;
+        while (std::getline(in, line)) {
+          std::stringstream ss(line);
+          size_t j, num_good;
+          sample_list_binary::file_entry f;
+          ss >> j >> f.name >> f.total_samples >> num_good;
+          f.samples.resize(num_good);
+          for (auto& sample : f.samples) { ss >> sample; }
+          files.at(j) = std::move(f);
+        }
+        in.close();
+        std::remove(part.c_str());
+      }
+      files.erase(std::remove_if(files.begin(), files.end(),
+                                 [](const sample_list_binary::file_entry& f) {
+                                   return f.name.empty(); }),
+                  files.end());
+
+      size_t included = 0, excluded = 0;
+      for (const auto& f : files) {
+        included += f.samples.size();
+        excluded += f.total_samples - f.samples.size();
+      }
+      std::ofstream out(add_delimiter(output_dir) + "index.txt");
+      out << sample_inclusion_list << "\n" << included << " " << excluded
+          << " " << files.size() << "\n" << output_dir << "\n";
+      for (const auto& f : files) {
+        out << f.name << " " << f.samples.size() << " "
+            << f.total_samples - f.samples.size();
+        for (const auto& sample : f.samples) {
+          out << " " << sample;
+        }
+        out << "\n";
+      }
+      out.close();
+      sample_list_binary::write(add_delimiter(output_dir) + "index.bin",
+                                output_dir, files);
+
+      std::cout << "converted " << files.size() << " files and "
+                << global_samples << " samples to " << format << " in "
+                << max_time << " s (" << global_bytes / max_time / 1e6
+                << " MB/s read)\n"
+                << "sample list index: " << add_delimiter(output_dir)
+                << "index.txt, index.bin" << std::endl;
+    }
+
+  } catch (std::exception const &e) {
+    El::ReportException(e);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
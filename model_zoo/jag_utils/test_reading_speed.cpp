@@ -37,6 +37,9 @@
 #include <sstream>
 #include "lbann/lbann.hpp"
 #include "lbann/utils/jag_utils.hpp"
+#include "lbann/utils/cnpy_utils.hpp"
+#include "lbann/data_readers/sample_list_binary.hpp"
+#include "lbann/utils/file_utils.hpp"
 #include <time.h>
 #include <cfloat>
 
@@ -51,6 +54,7 @@ vector<string> get_scalar_names_hydra();
 vector<string> get_image_names_hydra();
 void test_hydra(string filename);
 void test_jag(string filename);
+void test_converted(string output_dir);
 
 //==========================================================================
 #define MAX_SAMPLES 10000
@@ -62,15 +66,22 @@ int main(int argc, char *argv[]) {
   options *opts = options::get();
   opts->init(argc, argv);
 
-  if (!(opts->has_string("filelist") && opts->has_int("jag"))) {
-    LBANN_ERROR("usage: test_speed_hydra_ --filelist=<string> --jag=<0|1>");
+  if (!((opts->has_string("filelist") && opts->has_int("jag"))
+        || opts->has_string("converted"))) {
+    LBANN_ERROR("usage: test_speed_hydra_ --filelist=<string> --jag=<0|1> [--converted=<string>]\n"
+                "  --converted=<dir> also times the output of convert_parallel in <dir>");
   }
 
-  if (opts->get_int("jag")) {
-    test_jag(opts->get_string("filelist"));
-  } else {
-    test_hydra(opts->get_string("filelist"));
-  }  
+  if (opts->has_string("filelist")) {
+    if (opts->get_int("jag")) {
+      test_jag(opts->get_string("filelist"));
+    } else {
+      test_hydra(opts->get_string("filelist"));
+    }
+  }
+  if (opts->has_string("converted")) {
+    test_converted(opts->get_string("converted"));
+  }
   return EXIT_SUCCESS;
 }
 
@@ -378,3 +389,55 @@ FINISHED:
     cout << "num bytes: " << bytes << " time to read 1M bytes: " << (tm2 - tm1)/(bytes/1000000) << endl;
 
 }
+
+// Read the output of convert_parallel through its binary sample list
+void test_converted(string output_dir) {
+    double tm1 = get_time();
+    const sample_list_binary index(add_delimiter(output_dir) + "index.bin");
+
+    int num_samples = 0;
+    size_t num_files = 0;
+    double total = 0;
+    double bytes = 0;
+    long sample_size = 0;
+    for (size_t f=0; f<index.get_num_files() && num_samples < MAX_SAMPLES; f++) {
+      const string filename = add_delimiter(output_dir) + index.get_file_name(f);
+      ++num_files;
+      cout << "reading: " << filename << endl;
+      if (filename.size() > 4 && filename.substr(filename.size()-4) == ".npz") {
+        // Rows of float32, mapped in place
+        auto npz = cnpy_utils::mmap_npz(filename);
+        const auto& data = npz.at("data");
+        const size_t width = data.shape.at(1);
+        sample_size = width * sizeof(float);
+        const float* p = data.data<float>();
+        for (size_t i=0; i<data.shape[0] && num_samples < MAX_SAMPLES; i++) {
+          for (size_t g=0; g<width; g++) {
+            total += p[i*width + g];
+          }
+          bytes += width * sizeof(float);
+          ++num_samples;
+        }
+      } else {
+        const string protocol = (filename.substr(filename.rfind('.')+1) == "hdf5"
+                                 ? "hdf5" : "conduit_bin");
+        conduit::Node node;
+        conduit::relay::io::load(filename, protocol, node);
+        sample_size = 0;
+        conduit::NodeConstIterator it = node.children();
+        while (it.has_next() && num_samples < MAX_SAMPLES) {
+          const conduit::Node& sample = it.next();
+          sample_size = sample.total_bytes_compact();
+          bytes += sample_size;
+          ++num_samples;
+        }
+      }
+    }
+
+    double tm2 = get_time();
+    cout << "========================================================\n"
+         << "converted test:\n";
+    cout << "bytes per sample: " << sample_size << endl;
+    cout << "time: " << tm2 - tm1 << " num samples: " << num_samples << " num files: " << num_files << endl;
+    cout << "num bytes: " << bytes << " time to read 1M bytes: " << (tm2 - tm1)/(bytes/1000000) << endl;
+}
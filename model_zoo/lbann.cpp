@@ -31,6 +31,8 @@
 #include "lbann/utils/protobuf_utils.hpp"
 #include "lbann/data_store/data_store_conduit.hpp"
 #include "lbann/utils/argument_parser.hpp"
+#include "lbann/utils/determinism.hpp"
+#include "lbann/utils/model_estimate.hpp"
 #ifdef LBANN_HAS_CUDNN
 #include "lbann/utils/cudnn.hpp"
 #endif // LBANN_HAS_CUDNN
@@ -149,6 +151,12 @@ int main(int argc, char *argv[]) {
     //to activate, must specify --st_on on cmd line
     stack_profiler::get()->activate(comm->get_rank_in_world());
 
+    // Sample call stacks if --sampling_profile=<prefix> is given
+    sampling_profiler::thread_registration main_thread_profile("main");
+    if (opts->has_string("sampling_profile")) {
+      sampling_profiler::start(opts->get_double("sampling_profile_hz", 99));
+    }
+
     // Load the prototexts specificed on the command line
     auto pbs = protobuf_utils::load_prototext(master, argc, argv);
     // Optionally over-ride some values in the prototext for each model
@@ -181,14 +189,78 @@ int main(int argc, char *argv[]) {
       return EXIT_SUCCESS;
     }
 
+    // Dry run: set up the model, report estimated costs and exit
+    if (opts->get_bool("estimate")) {
+      sgd_training_algorithm alg;
+      auto dr_metadata = trainer->get_data_coordinator().get_dr_metadata();
+      alg.setup_models({model.get()}, trainer->get_max_mini_batch_size(),
+                       dr_metadata);
+      const auto estimate = estimate_model(
+        *model, trainer->get_max_mini_batch_size(),
+        opts->get_string("estimate_calibration", ""));
+      if (master) {
+        std::cout << model->get_description();
+        print_model_estimate(estimate, std::cout);
+      }
+      return EXIT_SUCCESS;
+    }
+
     if (! opts->get_bool("exit_after_setup")) {
 
       // Train model
-      trainer->train(model.get(), pb_model->num_epochs());
+      const auto& pb_alg = pb.training_algorithm();
+      if (pb_alg.type() == "local_sgd") {
+        const auto& params = pb_alg.local_sgd();
+        local_sgd_training_algorithm alg(
+          params.sync_interval() > 0 ? params.sync_interval() : 8,
+          params.intertrainer(),
+          params.adaptive(),
+          params.max_sync_interval() > 0 ? params.max_sync_interval() : 64,
+          params.divergence_target() > 0 ? params.divergence_target() : 0.01,
+          params.async());
+        sgd_termination_criteria term;
+        term.num_epochs = pb_model->num_epochs();
+        term.num_steps = 0;
+        trainer->apply(alg, model.get(), execution_mode::training, term);
+      } else if (pb_alg.type().empty() || pb_alg.type() == "sgd") {
+        trainer->train(model.get(), pb_model->num_epochs());
+        // Regroup the trainers and continue while a resize is requested
+        while (true) {
+          int procs_per_trainer = 0;
+          for (auto* c : model->get_callbacks()) {
+            auto* cb = dynamic_cast<callback::elastic_resize*>(c);
+            if (cb != nullptr) {
+              procs_per_trainer = cb->get_requested_procs_per_trainer();
+            }
+          }
+          if (procs_per_trainer == 0) { break; }
+          model = resize_trainer(procs_per_trainer, std::move(model), *trainer,
+                                 argc, argv, pb, comm.get(), opts,
+                                 training_dr_linearized_data_size);
+          trainer->train(model.get(), pb_model->num_epochs());
+        }
+      } else {
+        LBANN_ERROR("unknown training algorithm (", pb_alg.type(), ")");
+      }
 
       // Evaluate model on test set
       trainer->evaluate(model.get(), execution_mode::testing);
 
+#ifdef LBANN_HAS_CUDNN
+      // Report what deterministic cuDNN algorithms cost
+      const auto overhead = cudnn::get_deterministic_overhead();
+      if (master && deterministic_mode() && overhead.num_selections > 0) {
+        std::cout << "Deterministic cuDNN algorithms: "
+                  << overhead.num_selections << " autotuned selections, "
+                  << overhead.deterministic_ms << " ms vs. "
+                  << overhead.nondeterministic_ms
+                  << " ms with nondeterministic algorithms ("
+                  << 100 * (overhead.deterministic_ms
+                            / overhead.nondeterministic_ms - 1)
+                  << "% overhead)" << std::endl;
+      }
+#endif // LBANN_HAS_CUDNN
+
       //has no affect unless option: --st_on was given
       stack_profiler::get()->print();
 
@@ -205,6 +277,17 @@ int main(int argc, char *argv[]) {
       stack_profiler::get()->print();
     }
 
+    if (sampling_profiler::running()) {
+      sampling_profiler::stop();
+      sampling_profiler::write_folded_stacks(
+        opts->get_string("sampling_profile") + "."
+        + std::to_string(comm->get_rank_in_world()) + ".folded");
+      if (sampling_profiler::num_dropped() > 0) {
+        LBANN_WARNING("sampling profiler dropped ",
+                      sampling_profiler::num_dropped(), " samples");
+      }
+    }
+
   } catch (exception& e) {
     if (options::get()->get_bool("stack_trace_to_file")) {
       std::ostringstream ss("stack_trace");
@@ -149,6 +149,23 @@ int main(int argc, char *argv[]) {
       ae_cycgan_model->copy_trained_weights_from(ae_weights);
     }
 
+    //Share trained weights between the solvers once, instead of
+    //copying them after every step: D1 & D2 from the discriminator
+    //model, G1 and G2 from their solvers
+    if(master) std::cout << " Tie trained weights of discriminator, G1 and G2 solvers " << std::endl;
+    auto model1_weights = model_1->get_weights();
+    auto model2_weights = model_2->get_weights();
+    auto model3_weights = model_3->get_weights();
+    model_2->tie_trained_weights_with(model1_weights);
+    model_3->tie_trained_weights_with(model1_weights);
+    model_1->tie_trained_weights_with(model2_weights);
+    model_1->tie_trained_weights_with(model3_weights);
+    //Optionally evaluate on pretrained autoencoder
+    if(ae_model != nullptr && ae_cycgan_model != nullptr){
+      if(master) std::cout << " Tie trained weights from cycle GAN" << std::endl;
+      ae_cycgan_model->tie_trained_weights_with(model2_weights);
+    }
+
     //Train cycle GAN
     int super_step = 1;
     int max_super_step = pb_model.super_steps();
@@ -156,38 +173,16 @@ int main(int argc, char *argv[]) {
       if (master)  std::cerr << "\nSTARTING train - discriminator (D1 & D2) models at step " << super_step <<"\n\n";
       trainer->train(model_1.get(), super_step*pb_model.num_epochs(),pb_model.num_batches());
 
-      if(master) std::cout << " Copy all trained weights from discriminator to G1 and train/freeze as appropriate " << std::endl;
-      auto model1_weights = model_1->get_weights();
-      model_2->copy_trained_weights_from(model1_weights);
       if (master) std::cerr << "\n STARTING train - G1 solver model at step " << super_step << " \n\n";
       trainer->train(model_2.get(), super_step*pb_model_2.num_epochs(),pb_model_2.num_batches());
       // Evaluate model on test set
       //      model_2->evaluate(execution_mode::testing,pb_model_2.num_batches());
 
-      if(master) std::cout << " Copy all trained weights from discriminator to G2 and train/freeze as appropriate " << std::endl;
-      model_3->copy_trained_weights_from(model1_weights);
       if (master) std::cerr << "\n STARTING train - G2 solver model at step " << super_step << " \n\n";
       trainer->train(model_3.get(), super_step*pb_model_3.num_epochs(),pb_model_3.num_batches());
       // Evaluate model on test set
       //      model_3->evaluate(execution_mode::testing,pb_model_3.num_batches());
 
-      if(master) std::cout << " Update G1 weights " << std::endl;
-      auto model2_weights = model_2->get_weights();
-      model_1->copy_trained_weights_from(model2_weights);
-      if(master) std::cout << " Update G2 weights " << std::endl;
-      auto model3_weights = model_3->get_weights();
-      model_1->copy_trained_weights_from(model3_weights);
-
-      //Optionally evaluate on pretrained autoencoder
-      if(ae_model != nullptr && ae_cycgan_model != nullptr){
-        //if(master) std::cout << " Copy trained weights from autoencoder to autoencoder proxy" << std::endl;
-        //ae_cycgan_model->copy_trained_weights_from(ae_weights);
-        if(master) std::cout << " Copy trained weights from cycle GAN" << std::endl;
-        ae_cycgan_model->copy_trained_weights_from(model2_weights);
-        if(master) std::cout << " Evaluate pretrained autoencoder" << std::endl;
-        //ae_cycgan_model->evaluate(execution_mode::testing);
-      }
-
       super_step++;
     }
 
@@ -88,6 +88,25 @@ int main(int argc, char *argv[]) {
 
     const auto layers1 = model_1->get_layers();
     const auto layers2 = model_2->get_layers();
+
+    //Tie "proxy" layer in adversarial model (model2) to its "equivalent" layer in discriminator model (model1)
+    //so both models train the same weight matrices without copies
+    //@todo freeze layers after replacement
+    for(size_t l2=0; l2 < layers2.size(); l2++) {
+      //check if a discriminator layer is a proxy
+      std::string l2_fullname = layers2[l2]->get_name();
+      if(l2_fullname.find("proxy") != std::string::npos) { //if a proxy layer
+        std::string l2_name = l2_fullname.erase(l2_fullname.length()-6);
+        for(size_t l1=0; l1 < layers1.size(); l1++) {
+           if(l2_name == layers1[l1]->get_name()){
+             if(master) std::cout << "Tying adversarial model (model 2) Layer " << layers2[l2]->get_name();
+             layers2[l2]->tie_weights(layers1[l1]);
+             if(master) std::cout << " to corresponding layer " << layers1[l1]->get_name() << " in discriminator model (model1) " << std::endl;
+           }
+        }
+      }
+    }
+
     int super_step = 1;
     int max_super_step = pb_model.super_steps();
     while (super_step <= max_super_step) {
@@ -95,24 +114,6 @@ int main(int argc, char *argv[]) {
       //@todo freeze generator layers in this step
       trainer->train(model_1.get(), super_step*pb_model.num_epochs() );
 
-      //Replace/copy "proxy" layer in adversarial model (model2) with its "equivalent" layer in discriminator model (model1)
-      //@todo freeze layers after replacement
-      for(size_t l2=0; l2 < layers2.size(); l2++) {
-        //check if a discriminator layer is a proxy
-        std::string l2_fullname = layers2[l2]->get_name();
-        if(l2_fullname.find("proxy") != std::string::npos) { //if a proxy layer
-          std::string l2_name = l2_fullname.erase(l2_fullname.length()-6);
-          std::cout << "L2 Name " << l2_name << std::endl;
-          for(size_t l1=0; l1 < layers1.size(); l1++) {
-             if(l2_name == layers1[l1]->get_name()){
-               if(master) std::cout << "Replacing adversarial model (model 2) Layer " << layers1[l1]->get_name();
-               layers2[l2]->replace_weights(layers1[l1]);
-               if(master) std::cout << " with corresponding layer " << layers2[l2]->get_name() << " in discriminator model (model1) " << std::endl;
-             }
-          }
-        }
-      }
-
       if (master) std::cerr << "\n STARTING train - adversarial model at step " << super_step << " \n\n";
       trainer->train(model_2.get(), super_step*pb_model_2.num_epochs() );
 
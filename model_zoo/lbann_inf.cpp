@@ -35,6 +35,8 @@
 
 #include <dirent.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
 
 using namespace lbann;
@@ -53,6 +55,12 @@ int main(int argc, char *argv[]) {
       return EXIT_SUCCESS;
     }
 
+    // Inference-only models can fold batch normalization into
+    // convolutions
+    if (!opts->get_bool("no_fuse_inference_layers")) {
+      opts->set_option("fuse_inference_layers", 1);
+    }
+
     std::ostringstream err;
 
     auto pbs = protobuf_utils::load_prototext(master, argc, argv);
@@ -74,6 +82,8 @@ int main(int argc, char *argv[]) {
       training_dr_linearized_data_size = dr->get_linearized_data_size();
     }
 
+    // Mappings of node-shared weights; must outlive the models
+    std::vector<std::shared_ptr<void>> shared_weights;
     std::vector<std::unique_ptr<model>> models;
     for(auto&& pb_model : pbs) {
       models.emplace_back(
@@ -83,9 +93,15 @@ int main(int argc, char *argv[]) {
                                    training_dr_linearized_data_size));
     }
 
+    // With node-shared weights, only the first process of each node
+    // loads them
+    const bool node_shared_weights = opts->get_bool("inference_node_shared_weights");
+    const bool load_weights = !node_shared_weights || comm->get_rank_in_node() == 0;
+
     // Load layer weights from checkpoint if checkpoint directory given
     if(opts->has_string("ckpt_dir")){
       for(auto&& m : models) {
+        if (!load_weights) { break; }
         auto&& dirs = parse_list<std::string>(opts->get_string("ckpt_dir"));
         for(auto&& d : dirs) { //load file from each (space limited) directory
           bool loaded = callback::load_model::load_model_weights(d,
@@ -98,6 +114,69 @@ int main(int argc, char *argv[]) {
     }else {
       LBANN_ERROR("Unable to reload model");
     }
+    if (node_shared_weights) {
+      for(auto&& m : models) {
+        shared_weights.push_back(share_weights_on_node(*m, *comm));
+      }
+    }
+
+    std::vector<std::string> output_layers;
+    if (opts->has_string("inference_output_layers")) {
+      output_layers = parse_list<std::string>(
+        opts->get_string("inference_output_layers"));
+    }
+
+    // Serve requests until the job is killed
+    // Note: Each trainer is a replica with its own server.
+    if (opts->has_int("inference_server_port")) {
+      if (comm->get_procs_per_trainer() != 1) {
+        LBANN_ERROR("inference server requires one process per trainer, ",
+                    "but there are ", comm->get_procs_per_trainer());
+      }
+      inference_engine engine(*trainer, *models[0], output_layers);
+      const El::Int max_batch_size
+        = opts->get_int("inference_max_batch_size",
+                        engine.get_max_batch_size());
+      const std::chrono::microseconds max_delay(
+        opts->get_int("inference_max_delay_us", 1000));
+      inference_server server(engine,
+                              max_batch_size,
+                              max_delay,
+                              opts->get_int("inference_server_port"));
+      if (master) {
+        std::cout << "serving model \"" << models[0]->get_name() << "\" "
+                  << "on port " << opts->get_int("inference_server_port")
+                  << " (max batch size " << max_batch_size << ", "
+                  << "max delay " << max_delay.count() << " us)"
+                  << std::endl;
+      }
+      server.serve();
+      return EXIT_SUCCESS;
+    }
+
+    // Measure single-sample latency with the inference engine
+    if (opts->has_int("inference_latency_samples")) {
+      inference_engine engine(*trainer, *models[0], output_layers);
+      CPUMat sample;
+      El::Zeros(sample, engine.get_input_size(), 1);
+      const int num_samples = opts->get_int("inference_latency_samples");
+      std::vector<double> latencies;
+      for (int s = 0; s < num_samples; ++s) {
+        comm->trainer_barrier();
+        const auto start = get_time();
+        engine.predict(sample);
+        latencies.push_back(get_time() - start);
+      }
+      if (master && !latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        const auto& p50 = latencies[latencies.size() / 2];
+        const auto& p99 = latencies[(latencies.size() * 99) / 100];
+        std::cout << "inference latency over " << latencies.size()
+                  << " samples: p50 " << p50 * 1e3 << " ms, "
+                  << "p99 " << p99 * 1e3 << " ms" << std::endl;
+      }
+      return EXIT_SUCCESS;
+    }
 
     /// Interleave the inference between the models so that they can use a shared data reader
     /// Enable shared testing data readers on the command line via --share_testing_data_readers=1
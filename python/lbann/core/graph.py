@@ -0,0 +1,315 @@
+"""Optimization passes on the layer graph.
+
+These passes rewrite a layer graph in place before it is exported to
+Protobuf. They only use information that is available in the Python
+front-end (layer types, connectivity, and layer fields), so they are
+conservative: anything that is referenced by name elsewhere in the
+model is left alone.
+
+The passes are:
+
+- Constant folding: entry-wise operations whose inputs are all
+  `Constant` layers are replaced by a `Constant` layer.
+- Reshape coalescing: a `Reshape` that only reads another `Reshape`
+  reads that layer's input instead.
+- Identity elimination: `Identity` layers that do not change the
+  device, data layout, or data type are removed.
+- Common subexpression elimination: layers with the same type, the
+  same fields, and the same parents are merged.
+- Dead layer elimination: layers that do not contribute to a protected
+  layer are removed.
+
+"""
+import math
+import re
+from lbann.util import make_iterable
+import lbann.core.layer
+
+# Entry-wise operations that can be evaluated on scalars
+_unary_ops = {
+    'Abs': abs,
+    'Negative': lambda x: -x,
+    'Sign': lambda x: math.copysign(1.0, x) if x != 0 else 0.0,
+    'Ceil': math.ceil,
+    'Floor': math.floor,
+    'Reciprocal': lambda x: 1 / x,
+    'Square': lambda x: x * x,
+    'Sqrt': math.sqrt,
+    'Rsqrt': lambda x: 1 / math.sqrt(x),
+    'Exp': math.exp,
+    'Expm1': math.expm1,
+    'Log': math.log,
+    'Log1p': math.log1p,
+    'Cos': math.cos,
+    'Sin': math.sin,
+    'Tan': math.tan,
+    'Tanh': math.tanh,
+    'Sigmoid': lambda x: 1 / (1 + math.exp(-x)),
+    'Relu': lambda x: max(x, 0.0),
+}
+_binary_ops = {
+    'Add': lambda x, y: x + y,
+    'Subtract': lambda x, y: x - y,
+    'Multiply': lambda x, y: x * y,
+    'Divide': lambda x, y: x / y,
+    'Pow': math.pow,
+    'Max': max,
+    'Min': min,
+}
+
+# Layers whose output changes from one evaluation to the next, or
+# that read data from outside the layer graph
+_nondeterministic_types = set([
+    'Input', 'Dropout', 'SeluDropout', 'Gaussian', 'Bernoulli',
+    'Uniform', 'CategoricalRandom', 'DiscreteRandom', 'MiniBatchIndex',
+    'MiniBatchSize', 'Evaluation', 'Dummy',
+])
+
+# Layers whose children receive different output tensors
+_multi_output_types = set(['Slice'])
+
+def _type_name(l):
+    return type(l).__name__
+
+def _same_placement(a, b):
+    """Whether two layers run on the same device with the same layout."""
+    return (a.device == b.device
+            and a.data_layout == b.data_layout
+            and a.datatype == b.datatype)
+
+def _field_string(val):
+    """String form of a space-separated list field."""
+    if val is None or isinstance(val, str):
+        return val
+    return ' '.join([str(v) for v in make_iterable(val)])
+
+def _referenced_names(message, names):
+    """Add all whitespace-separated tokens in string fields to names."""
+    for field, val in message.ListFields():
+        vals = val if field.label == field.LABEL_REPEATED else [val]
+        for v in vals:
+            if field.type == field.TYPE_MESSAGE:
+                _referenced_names(v, names)
+            elif field.type == field.TYPE_STRING:
+                names.update(re.split(r'[\s,;]+', v))
+
+def _replace_uses(old, new, layers):
+    """Make every reader of `old` read `new` instead.
+
+    `old` is disconnected from its parents and children. Positions in
+    the parent lists of the children are preserved.
+
+    """
+    for c in old.children:
+        c.parents = [new if p is old else p for p in c.parents]
+        new.children.append(c)
+    for p in old.parents:
+        p.children = [c for c in p.children if c is not old]
+    old.parents = []
+    old.children = []
+    for l in layers:
+        if l.hint_layer is old:
+            l.hint_layer = new
+
+def _bypass(l, layers):
+    """Remove a single-input layer, wiring its input to its readers.
+
+    The readers take the place of `l` in its parent's child list, so
+    layers that map outputs to children by position keep working.
+
+    """
+    parent = l.parents[0]
+    new_children = []
+    for c in parent.children:
+        if c is l:
+            new_children.extend(l.children)
+        else:
+            new_children.append(c)
+    parent.children = new_children
+    for c in l.children:
+        c.parents = [parent if p is l else p for p in c.parents]
+    l.parents = []
+    l.children = []
+    for other in layers:
+        if other.hint_layer is l:
+            other.hint_layer = parent
+
+def _can_bypass(l):
+    """Whether `l` can be replaced by its only parent."""
+    if len(l.parents) != 1 or l.weights:
+        return False
+    parent = l.parents[0]
+    return (_type_name(parent) not in _multi_output_types
+            or len(l.children) == 1)
+
+def _fold_constants(layers, protected):
+    changed = False
+    for l in layers:
+        name = _type_name(l)
+        if l.weights or not l.parents:
+            continue
+        if not all([_type_name(p) == 'Constant' for p in l.parents]):
+            continue
+        num_neurons = _field_string(l.parents[0].num_neurons)
+        if any([_field_string(p.num_neurons) != num_neurons
+                for p in l.parents]):
+            continue
+        values = [p.value if p.value is not None else 0.0
+                  for p in l.parents]
+        try:
+            if name in _unary_ops and len(values) == 1:
+                value = float(_unary_ops[name](values[0]))
+            elif name in _binary_ops and len(values) == 2:
+                value = float(_binary_ops[name](values[0], values[1]))
+            else:
+                continue
+        except (ArithmeticError, ValueError):
+            continue
+        if not math.isfinite(value):
+            continue
+        folded = lbann.core.layer.Constant(
+            value=value, num_neurons=num_neurons, name=l.name,
+            device=l.device, data_layout=l.data_layout,
+            datatype=l.datatype)
+        _replace_uses(l, folded, layers)
+        if l in protected:
+            protected.add(folded)
+        layers[layers.index(l)] = folded
+        changed = True
+    return changed
+
+def _coalesce_reshapes(layers, protected):
+    changed = False
+    for l in layers:
+        if _type_name(l) != 'Reshape' or len(l.parents) != 1:
+            continue
+        prev = l.parents[0]
+        if (_type_name(prev) != 'Reshape'
+            or not _same_placement(l, prev)
+            or prev.hint_layer is not None
+            or l.hint_layer is not None):
+            continue
+        if len(prev.children) == 1 and prev not in protected:
+            # Reshape the input directly and drop the second reshape
+            if l in protected or not _can_bypass(l):
+                continue
+            prev.dims = l.dims
+            prev.num_dims = l.num_dims
+            _bypass(l, layers)
+        else:
+            # Read the first reshape's input
+            if len(prev.parents) != 1:
+                continue
+            source = prev.parents[0]
+            if _type_name(source) in _multi_output_types:
+                continue
+            prev.children = [c for c in prev.children if c is not l]
+            l.parents = [source]
+            source.children.append(l)
+        changed = True
+    return changed
+
+def _eliminate_identities(layers, protected):
+    changed = False
+    for l in layers:
+        if (_type_name(l) == 'Identity'
+            and l not in protected
+            and l.children
+            and _can_bypass(l)
+            and _same_placement(l, l.parents[0])):
+            _bypass(l, layers)
+            changed = True
+    return changed
+
+def _eliminate_common_subexpressions(layers, protected):
+    changed = False
+    canonical = {}
+    for l in layers:
+        name = _type_name(l)
+        if (name in _nondeterministic_types
+            or name in _multi_output_types
+            or l.weights):
+            continue
+        proto = l.export_proto()
+        proto.ClearField('name')
+        proto.ClearField('children')
+        key = proto.SerializeToString(deterministic=True)
+        if key not in canonical:
+            canonical[key] = l
+        elif l not in protected:
+            _replace_uses(l, canonical[key], layers)
+            changed = True
+    return changed
+
+def _eliminate_dead_layers(layers, protected):
+    live = set()
+    stack = [l for l in layers
+             if l in protected or _type_name(l) == 'Input']
+    while stack:
+        l = stack.pop()
+        if l not in live:
+            live.add(l)
+            stack.extend(l.parents)
+            if l.hint_layer is not None:
+                stack.append(l.hint_layer)
+    changed = False
+    for l in layers:
+        if l not in live:
+            for p in l.parents:
+                p.children = [c for c in p.children if c is not l]
+            for c in l.children:
+                c.parents = [p for p in c.parents if p is not l]
+            l.parents = []
+            l.children = []
+            changed = True
+    return changed
+
+def optimize_layer_graph(layers,
+                         protected_layers=[],
+                         protected_names=[],
+                         max_iterations=16):
+    """Simplify a layer graph in place.
+
+    Args:
+        layers (Layer or Iterator of Layer): Node(s) in layer graph.
+        protected_layers (Iterable of Layer, optional): Layers that
+            must not be removed, e.g. objective function terms and
+            metrics. Dead layer elimination keeps every layer they
+            depend on, and is skipped if there are none.
+        protected_names (Iterable of str, optional): Names that are
+            used elsewhere in the model, e.g. in callbacks. Layers
+            with these names are protected.
+        max_iterations (int, optional): Maximum number of times to
+            apply the passes.
+
+    Returns:
+        list of Layer: Remaining layers, in a topological order.
+
+    """
+    layers = list(lbann.core.layer.traverse_layer_graph(layers))
+    protected_names = set(protected_names)
+    protected = set(make_iterable(protected_layers))
+    protected.update([l for l in layers if l.name in protected_names])
+    for _ in range(max_iterations):
+        changed = _fold_constants(layers, protected)
+        changed |= _coalesce_reshapes(layers, protected)
+        changed |= _eliminate_identities(layers, protected)
+        layers = list(lbann.core.layer.traverse_layer_graph(layers))
+        changed |= _eliminate_common_subexpressions(layers, protected)
+        if protected:
+            changed |= _eliminate_dead_layers(layers, protected)
+        layers = [l for l in layers
+                  if l.parents or l.children or l in protected
+                  or _type_name(l) == 'Input']
+        layers = list(lbann.core.layer.traverse_layer_graph(layers))
+        if not changed:
+            break
+    return layers
+
+def protected_names_in(messages):
+    """Names referenced in the string fields of Protobuf messages."""
+    names = set()
+    for m in messages:
+        _referenced_names(m, names)
+    names.discard('')
+    return names
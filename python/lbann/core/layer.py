@@ -21,6 +21,11 @@ class Layer(abc.ABC):
         datatype (lbann.DataType, optional): Data type used for activations and weights.
         hint_layer (Layer, optional): Hint for output dimensions.
         parallel_strategy (dictionary, optional): Data partitioning scheme.
+        recompute_activations (bool, optional): Free output tensors
+            after forward prop and recompute them during backprop.
+        transfer_precision (str, optional): Precision for
+            redistributing input tensors and error signals ('fp32' or
+            'fp16').
 
     """
 
@@ -36,7 +41,9 @@ class Layer(abc.ABC):
                  data_layout=None,
                  datatype=None,
                  hint_layer=None,
-                 parallel_strategy={}):
+                 parallel_strategy={},
+                 recompute_activations=False,
+                 transfer_precision=None):
         Layer.global_count += 1
         self.parents = []
         self.children = []
@@ -47,6 +54,8 @@ class Layer(abc.ABC):
         self.datatype = datatype
         self.hint_layer = hint_layer
         self.parallel_strategy = parallel_strategy
+        self.recompute_activations = recompute_activations
+        self.transfer_precision = transfer_precision
 
         # Initialize parents, children, and weights
         for arg in args:
@@ -72,6 +81,10 @@ class Layer(abc.ABC):
             proto.hint_layer = self.hint_layer.name
         for k, v in self.parallel_strategy.items():
             setattr(proto.parallel_strategy, k, v)
+        if self.recompute_activations:
+            proto.recompute_activations = True
+        if self.transfer_precision:
+            proto.transfer_precision = self.transfer_precision
         return proto
 
     def add_parent(self, parent):
@@ -106,11 +119,13 @@ classes = lbann.core.util.generate_classes_from_protobuf_message(
     skip_fields = set([
         'name', 'parents', 'children', 'data_layout', 'device_allocation', 'datatype',
         'weights', 'num_neurons_from_data_reader', 'freeze', 'hint_layer',
-        'parallel_strategy', 'weights_data', 'top', 'bottom', 'type', 'motif_layer']),
+        'parallel_strategy', 'recompute_activations', 'transfer_precision',
+        'weights_data', 'top', 'bottom', 'type', 'motif_layer']),
     base_class = Layer,
     base_kwargs = set([
         'parents', 'children', 'weights',
-        'name', 'device', 'data_layout', 'datatype', 'hint_layer', 'parallel_strategy']),
+        'name', 'device', 'data_layout', 'datatype', 'hint_layer', 'parallel_strategy',
+        'recompute_activations', 'transfer_precision']),
     base_has_export_proto = True)
 for c in classes:
     globals()[c.__name__] = c
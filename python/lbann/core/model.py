@@ -1,29 +1,29 @@
 """Neural network model."""
 from lbann import model_pb2
 from lbann.util import make_iterable
+import lbann.core.graph
 import lbann.core.layer
 import lbann.core.objective_function
 
 class Model:
-    """Neural network model."""
+    """Neural network model.
+
+    If `optimize_graph` is set, the layer graph is simplified before
+    it is exported (see `lbann.core.graph`). Layers and weights used
+    by the objective function, metrics, and callbacks are kept.
+
+    """
 
     def __init__(self, epochs,
                  layers=[], weights=[], objective_function=None,
                  metrics=[], callbacks=[],
-                 summary_dir=None,serialize_io=False):
+                 summary_dir=None,serialize_io=False,
+                 optimize_graph=False):
 
         # Scalar fields
         self.epochs = epochs
         self.summary_dir = summary_dir
         self.serialize_io = serialize_io
-        # Get connected layers
-        self.layers = list(lbann.core.layer.traverse_layer_graph(layers))
-
-        # Get weights associated with layers
-        self.weights = set(make_iterable(weights))
-        for l in self.layers:
-            self.weights.update(l.weights)
-
         # Construct objective function if needed
         obj_type = lbann.core.objective_function.ObjectiveFunction
         if isinstance(objective_function, obj_type):
@@ -37,6 +37,24 @@ class Model:
         self.metrics = make_iterable(metrics)
         self.callbacks = make_iterable(callbacks)
 
+        # Get connected layers
+        if optimize_graph:
+            protected_layers = [m.layer for m in self.metrics]
+            for term in self.objective_function.terms:
+                if isinstance(term, lbann.core.objective_function.LayerTerm):
+                    protected_layers.append(term.layer)
+            protected_names = lbann.core.graph.protected_names_in(
+                [c.export_proto() for c in self.callbacks])
+            self.layers = lbann.core.graph.optimize_layer_graph(
+                layers, protected_layers, protected_names)
+        else:
+            self.layers = list(lbann.core.layer.traverse_layer_graph(layers))
+
+        # Get weights associated with layers
+        self.weights = set(make_iterable(weights))
+        for l in self.layers:
+            self.weights.update(l.weights)
+
     def export_proto(self):
         """Construct and return a protobuf message."""
         # Initialize protobuf message
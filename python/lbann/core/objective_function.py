@@ -38,19 +38,48 @@ class L2WeightRegularization(ObjectiveFunctionTerm):
         proto.weights = ' '.join([w.name for w in self.weights])
         return proto
 
+class LossScaling:
+    """Loss scaling for reduced-precision gradients.
+
+    The objective function gradient is multiplied by `scale` and the
+    factor is removed before the optimization step. If `dynamic` is
+    set, steps with infinite or NaN gradients are skipped and the
+    scale is adjusted during training.
+
+    """
+
+    def __init__(self, scale=65536.0, dynamic=True, growth_factor=2.0,
+                 backoff_factor=0.5, growth_interval=2000):
+        self.scale = scale
+        self.dynamic = dynamic
+        self.growth_factor = growth_factor
+        self.backoff_factor = backoff_factor
+        self.growth_interval = growth_interval
+
+    def export_proto(self):
+        """Construct and return a protobuf message."""
+        proto = objective_functions_pb2.ObjectiveFunction.LossScaling()
+        proto.initial_scale = self.scale
+        proto.dynamic = self.dynamic
+        proto.growth_factor = self.growth_factor
+        proto.backoff_factor = self.backoff_factor
+        proto.growth_interval = self.growth_interval
+        return proto
+
 class ObjectiveFunction:
     """Objective function for optimization algorithm."""
 
-    def __init__(self, terms=[]):
+    def __init__(self, terms=[], loss_scaling=None):
         """Create an objective function with layer terms and regularization.
 
         `terms` should be a sequence of `ObjectiveFunctionTerm`s and
-        `Layer`s.
+        `Layer`s. `loss_scaling` is an optional `LossScaling`.
 
         """
         self.terms = []
         for t in make_iterable(terms):
             self.add_term(t)
+        self.loss_scaling = loss_scaling
 
     def add_term(self, term):
         """Add a term to the objective function.
@@ -72,4 +101,6 @@ class ObjectiveFunction:
                 proto.layer_term.extend([term_message])
             elif type(term) is L2WeightRegularization:
                 proto.l2_weight_regularization.extend([term_message])
+        if self.loss_scaling:
+            proto.loss_scaling.CopyFrom(self.loss_scaling.export_proto())
         return proto
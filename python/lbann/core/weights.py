@@ -21,17 +21,33 @@ classes = lbann.core.util.generate_classes_from_protobuf_message(
 for c in classes:
     globals()[c.__name__] = c
 
+class GradientCompression(abc.ABC):
+    """Lossy compression for the gradient allreduce of `Weights`."""
+    def export_proto(self):
+        """Construct and return a protobuf message."""
+        return weights_pb2.GradientCompression()
+
+# Generate GradientCompression sub-classes from weights.proto.
+classes = lbann.core.util.generate_classes_from_protobuf_message(
+    weights_pb2.GradientCompression,
+    base_class = GradientCompression,
+    base_has_export_proto = True)
+for c in classes:
+    globals()[c.__name__] = c
+
 class Weights:
     """Trainable parameters for neural network."""
 
     global_count = 0  # Static counter, used for default names
 
-    def __init__(self, initializer=None, optimizer=None, name=None, datatype=None):
+    def __init__(self, initializer=None, optimizer=None, name=None, datatype=None,
+                 gradient_compression=None):
         Weights.global_count += 1
         self.name = name if name else 'weights{0}'.format(Weights.global_count)
         self.initializer = initializer
         self.optimizer = optimizer
         self.datatype = datatype
+        self.gradient_compression = gradient_compression
 
     def export_proto(self):
         """Construct and return a protobuf message."""
@@ -52,4 +68,9 @@ class Weights:
         if self.datatype:
             proto.datatype = self.datatype
 
+        # Set gradient compression if needed
+        if self.gradient_compression:
+            proto.gradient_compression.CopyFrom(self.gradient_compression.export_proto())
+            proto.gradient_compression.SetInParent()
+
         return proto
@@ -1,4 +1,5 @@
 from lbann.models.alexnet import AlexNet
+from lbann.models.cosmoflow import CosmoFlow
 from lbann.models.lenet import LeNet
 from lbann.models.resnet import ResNet, ResNet18, ResNet34, ResNet50, ResNet101, ResNet152
 from lbann.models.transformer import Transformer, TransformerEncoderLayer, TransformerDecoderLayer
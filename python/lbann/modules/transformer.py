@@ -20,6 +20,9 @@ class MultiheadAttention(Module):
             evenly divide `embed_dim`.
         name (str): Default name is in the form
             'multiheadattention<index>'.
+        fused (bool): Use the fused scaled dot-product attention
+            layer when no attention mask is provided. It avoids
+            storing the attention score matrix.
 
     """
 
@@ -28,7 +31,8 @@ class MultiheadAttention(Module):
     def __init__(self,
                  embed_dim,
                  num_heads,
-                 name=None):
+                 name=None,
+                 fused=True):
         super().__init__()
         MultiheadAttention.global_count += 1
         self.instance = 0
@@ -36,6 +40,7 @@ class MultiheadAttention(Module):
         self.embed_dim = embed_dim
         self.num_heads = num_heads
         self.head_dim = embed_dim // num_heads
+        self.fused = fused
 
         # Module name
         self.name = name
@@ -111,6 +116,22 @@ class MultiheadAttention(Module):
             name=f'{name}_values_fc',
         )
 
+        # Fused attention for all heads
+        if self.fused and not mask:
+            attentions = lbann.ScaledDotProductAttention(
+                queries_fc,
+                keys_fc,
+                values_fc,
+                num_heads=self.num_heads,
+                name=f'{name}_attention',
+            )
+            return lbann.ChannelwiseFullyConnected(
+                attentions,
+                weights=self.output_weights,
+                output_channel_dims=[self.embed_dim],
+                name=f'{name}',
+            )
+
         # Slice embedding vectors for each head
         slice_points = str_list(self.head_dim * i
                                 for i in range(self.num_heads+1))
@@ -31,6 +31,8 @@
 #include <lbann_config.hpp>
 #include "lbann/Elemental_extensions.hpp"
 
+#include <type_traits>
+
 namespace El {
 
 template<typename F>
@@ -49,17 +51,93 @@ void ColumnSum( const Matrix<F>& X, Matrix<F>& sums ) {
     const Int sumsLDim = sums.LDim();
 
     // Compute sum over each column
+    // Note: Independent partial sums break the dependency chain of a
+    // single accumulator so the contiguous column can be streamed.
     EL_PARALLEL_FOR
     for( Int j=0; j<n; ++j )
     {
-        for( Int i=0; i<m; ++i )
+        const F* col = &XBuf[j*XLDim];
+        F sum0 = TypeTraits<F>::Zero(), sum1 = TypeTraits<F>::Zero(), sum2 = TypeTraits<F>::Zero(), sum3 = TypeTraits<F>::Zero();
+        Int i = 0;
+        for( ; i+4<=m; i+=4 )
         {
-            sumsBuf[j*sumsLDim] += XBuf[i+j*XLDim];
+            sum0 += col[i];
+            sum1 += col[i+1];
+            sum2 += col[i+2];
+            sum3 += col[i+3];
         }
+        for( ; i<m; ++i )
+        {
+            sum0 += col[i];
+        }
+        sumsBuf[j*sumsLDim] = (sum0 + sum1) + (sum2 + sum3);
+    }
+
+}
+
+#ifdef LBANN_HAS_GPU
+namespace {
+
+/** Device vector of ones used to express sums as GEMMs. */
+template<typename F>
+Matrix<F,Device::GPU> GPUOnes( Int height ) {
+    Matrix<F,Device::GPU> ones;
+#ifdef HYDROGEN_HAVE_CUB
+    ones.SetMemoryMode(1); // Use CUB GPU memory pool if possible
+#endif // HYDROGEN_HAVE_CUB
+    ones.Resize( height, 1 );
+    Fill( ones, TypeTraits<F>::One() );
+    return ones;
+}
+
+// Sums on the GPU are GEMMs with a vector of ones, which cuBLAS
+// runs at memory bandwidth. Types without GPU GEMMs are rejected.
+
+template<typename F,
+         typename=typename std::enable_if<IsComputeType<F,Device::GPU>::value>::type>
+void GPUColumnSum( const Matrix<F,Device::GPU>& X, Matrix<F,Device::GPU>& sums ) {
+    sums.Resize( 1, X.Width() );
+    if( X.Height() < 1 ) {
+        Zero( sums );
+        return;
+    }
+    const auto ones = GPUOnes<F>( X.Height() );
+    Gemm( TRANSPOSE, NORMAL,
+          TypeTraits<F>::One(), ones, X,
+          TypeTraits<F>::Zero(), sums );
+}
+
+template<typename F,
+         typename=typename std::enable_if<!IsComputeType<F,Device::GPU>::value>::type,
+         typename=void>
+void GPUColumnSum( const Matrix<F,Device::GPU>&, Matrix<F,Device::GPU>& ) {
+    LogicError("ColumnSum: Unsupported data type on GPU.");
+}
+
+template<typename F,
+         typename=typename std::enable_if<IsComputeType<F,Device::GPU>::value>::type>
+void GPURowSum( const Matrix<F,Device::GPU>& X, Matrix<F,Device::GPU>& sums ) {
+    sums.Resize( X.Height(), 1 );
+    if( X.Width() < 1 ) {
+        Zero( sums );
+        return;
     }
+    const auto ones = GPUOnes<F>( X.Width() );
+    Gemm( NORMAL, NORMAL,
+          TypeTraits<F>::One(), X, ones,
+          TypeTraits<F>::Zero(), sums );
+}
 
+template<typename F,
+         typename=typename std::enable_if<!IsComputeType<F,Device::GPU>::value>::type,
+         typename=void>
+void GPURowSum( const Matrix<F,Device::GPU>&, Matrix<F,Device::GPU>& ) {
+    LogicError("RowSum: Unsupported data type on GPU.");
 }
 
+} // namespace
+#endif // LBANN_HAS_GPU
+
 template<typename F>
 void ColumnSum( const AbstractMatrix<F>& X, AbstractMatrix<F>& sums ) {
     if (X.GetDevice() != sums.GetDevice())
@@ -70,9 +148,8 @@ void ColumnSum( const AbstractMatrix<F>& X, AbstractMatrix<F>& sums ) {
                 static_cast<Matrix<F,Device::CPU>&>(sums));
 #ifdef LBANN_HAS_GPU
     }else if ((X.GetDevice() == Device::GPU)) {
-      LogicError("ColumnSum: Unsupported device type.");
-      // ColumnSum(static_cast<const Matrix<F,Device::GPU>&>(X),
-      //           static_cast<Matrix<F,Device::GPU>&>(sums));
+      GPUColumnSum(static_cast<const Matrix<F,Device::GPU>&>(X),
+                   static_cast<Matrix<F,Device::GPU>&>(sums));
 #endif // LBANN_HAS_GPU
     }else {
       LogicError("ColumnSum: Unsupported device type.");
@@ -113,19 +190,63 @@ void RowSum(const Matrix<F>& X, Matrix<F>& sums) {
     // Initialize output
     Zeros( sums, m, 1 );
     F *sumsBuf = sums.Buffer();
+    if( m < 1 || n < 1 ) { return; }
 
-    // Iterate through row blocks
-    const Int bsize = Max( 64 / sizeof(F), 1 );
+    // Each task accumulates a block of rows over a range of columns
+    // in a local buffer. The inner loop over rows is contiguous and
+    // vectorizes. Short matrices (e.g. bias gradients of small
+    // layers) are also split along columns so that all threads get
+    // work, with deterministic per-chunk partial sums.
+    const Int bsize = 512;
+    const Int num_row_blocks = (m + bsize - 1) / bsize;
+    const Int num_col_chunks = (num_row_blocks >= 16 ?
+                                1 : Max( Min( n / 64, Int(16) ), Int(1) ));
+    const Int col_chunk_size = (n + num_col_chunks - 1) / num_col_chunks;
+    Matrix<F> partials;
+    if( num_col_chunks > 1 ) {
+        partials.Resize( m, num_col_chunks );
+    }
+    F *partialsBuf = (num_col_chunks > 1 ? partials.Buffer() : sumsBuf);
+    const Int partialsLDim = (num_col_chunks > 1 ? partials.LDim() : m);
     EL_PARALLEL_FOR
-    for( Int i=0; i<m; i+=bsize )
+    for( Int task=0; task<num_row_blocks*num_col_chunks; ++task )
     {
+        const Int i = (task % num_row_blocks) * bsize;
+        const Int chunk = task / num_row_blocks;
         const Int mb = Min( bsize, m - i );
-        for( Int j=0; j<n; ++j )
+        const Int jstart = chunk * col_chunk_size;
+        const Int jend = Min( jstart + col_chunk_size, n );
+        F acc[bsize];
+        for( Int ib=0; ib<mb; ++ib )
+        {
+            acc[ib] = TypeTraits<F>::Zero();
+        }
+        for( Int j=jstart; j<jend; ++j )
         {
+            const F* col = &XBuf[i+j*XLDim];
             for( Int ib=0; ib<mb; ++ib )
             {
-                sumsBuf[i+ib] += XBuf[(i+ib)+j*XLDim];
+                acc[ib] += col[ib];
+            }
+        }
+        F* out = &partialsBuf[i+chunk*partialsLDim];
+        for( Int ib=0; ib<mb; ++ib )
+        {
+            out[ib] = acc[ib];
+        }
+    }
+
+    // Combine partial sums
+    if( num_col_chunks > 1 ) {
+        EL_PARALLEL_FOR
+        for( Int i=0; i<m; ++i )
+        {
+            F sum = TypeTraits<F>::Zero();
+            for( Int chunk=0; chunk<num_col_chunks; ++chunk )
+            {
+                sum += partialsBuf[i+chunk*partialsLDim];
             }
+            sumsBuf[i] = sum;
         }
     }
 
@@ -141,9 +262,8 @@ void RowSum(const AbstractMatrix<F>& X, AbstractMatrix<F>& sums) {
              static_cast<Matrix<F,Device::CPU>&>(sums));
 #ifdef LBANN_HAS_GPU
     }else if ((X.GetDevice() == Device::GPU)) {
-      LogicError("RowSum: Unsupported device type.");
-      // RowSum(static_cast<const Matrix<F,Device::GPU>&>(X),
-      //        static_cast<Matrix<F,Device::GPU>&>(sums));
+      GPURowSum(static_cast<const Matrix<F,Device::GPU>&>(X),
+                static_cast<Matrix<F,Device::GPU>&>(sums));
 #endif // LBANN_HAS_GPU
     }else {
       LogicError("RowSum: Unsupported device type.");
@@ -45,6 +45,9 @@
 #ifdef LBANN_HAS_CUDNN
 #include "lbann/utils/cudnn.hpp"
 #endif
+#ifdef LBANN_HAS_GPU
+#include "lbann/utils/gpu_allocator.hpp"
+#endif
 #ifdef LBANN_HAS_PYTHON
 #include "lbann/utils/python.hpp"
 #endif
@@ -128,8 +131,37 @@ void finalize(lbann_comm* comm) {
   dc::finalize();
 #endif
 #ifdef LBANN_HAS_CUDNN
+  if (comm != nullptr) {
+    cudnn::save_algorithm_cache(*comm);
+    const auto workspace_mb = comm->allreduce(
+      cudnn::get_workspace_size() / double(1 << 20),
+      comm->get_world_comm(), El::mpi::MAX);
+    if (comm->am_world_master() && workspace_mb > 0) {
+      std::cout << "peak cuDNN workspace: " << workspace_mb << " MB"
+                << std::endl;
+    }
+  }
   cudnn::destroy();
 #endif
+#ifdef LBANN_HAS_GPU
+  if (cuda::caching_allocator::enabled()) {
+    auto& alloc = cuda::caching_allocator::instance();
+    if (comm != nullptr) {
+      const auto stats = alloc.get_statistics();
+      const auto peak_mb = comm->allreduce(
+        stats.peak_live_bytes / double(1 << 20),
+        comm->get_world_comm(), El::mpi::MAX);
+      const auto mallocs = comm->allreduce(
+        double(stats.num_mallocs), comm->get_world_comm(), El::mpi::MAX);
+      if (comm->am_world_master()) {
+        std::cout << "peak GPU caching allocator usage: " << peak_mb
+                  << " MB, " << static_cast<size_t>(mallocs)
+                  << " cudaMalloc calls" << std::endl;
+      }
+    }
+    alloc.release_cached();
+  }
+#endif
 #ifdef LBANN_HAS_PYTHON
   python::finalize();
 #endif
@@ -0,0 +1,219 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/callbacks/autotune_io.hpp"
+
+#include "lbann/layers/io/input/generic_input_layer.hpp"
+#include "lbann/utils/io_profile.hpp"
+#include "lbann/utils/memory.hpp"
+#include "lbann/utils/threads/thread_pool.hpp"
+#include "lbann/utils/timer.hpp"
+
+#include <callbacks.pb.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace lbann {
+namespace callback {
+
+namespace {
+
+/** Utilization of the I/O threads above which they are considered
+ *  saturated. */
+constexpr double saturated_utilization = 0.75;
+
+std::vector<generic_input_layer<DataType>*> get_input_layers(model& m) {
+  std::vector<generic_input_layer<DataType>*> inputs;
+  for (auto* l : m.get_layers()) {
+    auto* input = dynamic_cast<generic_input_layer<DataType>*>(l);
+    if (input != nullptr) { inputs.push_back(input); }
+  }
+  return inputs;
+}
+
+/** Total fetch wait time of the model's input layers. */
+double get_io_wait_time(model& m) {
+  double t = 0;
+  for (const auto* input : get_input_layers(m)) {
+    t += input->get_io_wait_time();
+  }
+  return t;
+}
+
+/** Total time the I/O threads have spent fetching. */
+double get_io_busy_time() {
+  double t = 0;
+  for (const auto& stats : io_profile::snapshot()) {
+    t += stats.busy_time;
+  }
+  return t;
+}
+
+} // namespace
+
+void autotune_io::setup(model *m) {
+  for (auto* input : get_input_layers(*m)) {
+    input->reserve_prefetch_depth(m_max_prefetch_depth);
+  }
+}
+
+void autotune_io::on_train_begin(model *m) {
+  if (m_done) { return; }
+  io_profile::enable();
+  if (m_max_threads == 0) {
+    m_max_threads = m->get_execution_context().get_io_thread_pool().get_num_threads();
+  }
+  start_window(*m);
+}
+
+void autotune_io::on_batch_end(model *m) {
+  if (m_done) { return; }
+  ++m_num_steps;
+  if (++m_window_steps < m_interval) { return; }
+  tune(*m);
+  start_window(*m);
+}
+
+void autotune_io::start_window(model& m) {
+  m_window_steps = 0;
+  m_wait_start = get_io_wait_time(m);
+  m_busy_start = get_io_busy_time();
+  m_window_start = get_time();
+}
+
+void autotune_io::set_num_io_threads(model& m, int num_threads) {
+  // Threads cannot be replaced under a running fetch
+  m.collect_background_data_fetch(execution_mode::training);
+  m.get_execution_context().get_io_thread_pool().relaunch_pinned_threads(num_threads);
+}
+
+void autotune_io::tune(model& m) {
+  auto& comm = *m.get_comm();
+  auto& pool = m.get_execution_context().get_io_thread_pool();
+  const auto inputs = get_input_layers(m);
+  if (inputs.empty()) {
+    m_done = true;
+    return;
+  }
+  const int num_threads = std::max(static_cast<int>(pool.get_num_threads()), 1);
+  const double elapsed = std::max(get_time() - m_window_start, 1e-9);
+
+  // Decide for the slowest process, so every process makes the same
+  // change
+  double local[2], global[2];
+  local[0] = (get_io_wait_time(m) - m_wait_start) / elapsed;
+  local[1] = (get_io_busy_time() - m_busy_start) / (elapsed * num_threads);
+  comm.trainer_allreduce(local, 2, global, El::mpi::MAX);
+  const double wait_fraction = global[0];
+  const double utilization = global[1];
+  if (!m_warmed_up) {
+    m_warmed_up = true;
+    return;
+  }
+
+  int depth = inputs.front()->get_prefetch_depth();
+  int max_depth = m_max_prefetch_depth;
+  for (const auto* input : inputs) {
+    max_depth = std::min(max_depth, input->get_max_prefetch_depth());
+  }
+
+  action next = action::none;
+  if (wait_fraction > m_wait_threshold) {
+    if (m_last_action == action::remove_thread) {
+      // Undo the removal and stop there
+      set_num_io_threads(m, num_threads + 1);
+      m_done = true;
+    } else if (utilization >= saturated_utilization
+               && num_threads < m_max_threads) {
+      next = action::add_thread;
+    } else if (depth < max_depth) {
+      next = action::deepen_prefetch;
+    } else if (num_threads < m_max_threads) {
+      next = action::add_thread;
+    } else {
+      m_done = true;
+    }
+  } else if (num_threads > 1
+             && utilization * num_threads / (num_threads - 1)
+                < saturated_utilization) {
+    next = action::remove_thread;
+  } else {
+    m_done = true;
+  }
+
+  switch (next) {
+  case action::add_thread:
+    set_num_io_threads(m, num_threads + 1);
+    break;
+  case action::remove_thread:
+    set_num_io_threads(m, num_threads - 1);
+    break;
+  case action::deepen_prefetch:
+    ++depth;
+    for (auto* input : inputs) { input->set_prefetch_depth(depth); }
+    break;
+  case action::none:
+    break;
+  }
+  m_last_action = next;
+  if (m_num_steps >= m_max_steps) { m_done = true; }
+
+  if (comm.am_trainer_master()) {
+    std::stringstream msg;
+    msg << std::fixed << std::setprecision(1)
+        << m.get_name() << " autotune I/O : step " << m_num_steps
+        << ", model waited " << 100 * wait_fraction << "% of the time on data"
+        << ", " << num_threads << " I/O threads " << 100 * utilization
+        << "% utilized";
+    if (m_done) {
+      msg << "; chose " << pool.get_num_threads() << " I/O threads"
+          << " and a prefetch depth of " << depth;
+    } else {
+      msg << "; trying " << pool.get_num_threads() << " I/O threads"
+          << " and a prefetch depth of " << depth;
+    }
+    std::cout << msg.str() << std::endl;
+  }
+}
+
+std::unique_ptr<callback_base>
+build_autotune_io_callback_from_pbuf(
+  const google::protobuf::Message& proto_msg, std::shared_ptr<lbann_summary> const&) {
+  const auto& params =
+    dynamic_cast<const lbann_data::Callback::CallbackAutotuneIO&>(proto_msg);
+  return make_unique<autotune_io>(
+    params.interval() > 0 ? params.interval() : 20,
+    params.max_steps() > 0 ? params.max_steps() : 1000,
+    params.max_prefetch_depth() > 0 ? params.max_prefetch_depth() : 4,
+    params.wait_threshold() > 0 ? params.wait_threshold() : 0.02);
+}
+
+} // namespace callback
+} // namespace lbann
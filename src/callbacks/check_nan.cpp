@@ -30,6 +30,8 @@
 
 #include "lbann/utils/h2_tmp.hpp"
 
+#include <callbacks.pb.h>
+
 namespace lbann {
 namespace callback {
 
@@ -194,6 +196,13 @@ void check_nan::on_forward_prop_end(model *m, Layer *l) {
   for (int i = 0; i < num_outputs; ++i) {
     El::Int row, col;
     auto const& dtl = dynamic_cast<data_type_layer<DataType>&>(*l);
+#ifdef LBANN_HAS_GPU
+    if (m_deferred
+        && dtl.get_activations(i).GetLocalDevice() == El::Device::GPU) {
+      flag_nonfinite_gpu(dtl.get_activations(i).LockedMatrix());
+      continue;
+    }
+#endif // LBANN_HAS_GPU
     proxy_type mat_proxy(dtl.get_activations(i));
     if (has_nan(mat_proxy.GetLocked(), row, col)) {
       dump_network(m);
@@ -221,6 +230,13 @@ void check_nan::on_backward_prop_end(model *m, Layer *l) {
   for (int i = 0; i < num_inputs; ++i) {
     El::Int row, col;
     auto const& dtl = dynamic_cast<data_type_layer<DataType>&>(*l);
+#ifdef LBANN_HAS_GPU
+    if (m_deferred
+        && dtl.get_error_signals(i).GetLocalDevice() == El::Device::GPU) {
+      flag_nonfinite_gpu(dtl.get_error_signals(i).LockedMatrix());
+      continue;
+    }
+#endif // LBANN_HAS_GPU
     proxy_type mat_proxy(dtl.get_error_signals(i));
     if (has_nan(mat_proxy.GetLocked(), row, col)) {
       dump_network(m);
@@ -249,6 +265,13 @@ void check_nan::on_backward_prop_end(model *m) {
     auto* opt = dtw.get_optimizer();
     if (opt != nullptr) {
       El::Int row, col;
+#ifdef LBANN_HAS_GPU
+      if (m_deferred
+          && opt->get_gradient().GetLocalDevice() == El::Device::GPU) {
+        flag_nonfinite_gpu(opt->get_gradient().LockedMatrix());
+        continue;
+      }
+#endif // LBANN_HAS_GPU
       proxy_type mat_proxy(opt->get_gradient());
       if (has_nan(mat_proxy.GetLocked(), row, col)) {
         dump_network(m);
@@ -272,7 +295,14 @@ void check_nan::on_batch_end(model *m) {
   for (weights *w : m->get_weights()) {
     auto& dtw = dynamic_cast<data_type_weights<DataType>&>(*w);
     El::Int row, col;
-    proxy_type mat_proxy(dtw.get_values());
+    const auto& values = static_cast<const data_type_weights<DataType>&>(dtw).get_values();
+#ifdef LBANN_HAS_GPU
+    if (m_deferred && values.GetLocalDevice() == El::Device::GPU) {
+      flag_nonfinite_gpu(values.LockedMatrix());
+      continue;
+    }
+#endif // LBANN_HAS_GPU
+    proxy_type mat_proxy(values);
     if (has_nan(mat_proxy.GetLocked(), row, col)) {
       dump_network(m);
       LBANN_ERROR("rank ", m->get_comm()->get_rank_in_world(), ": "
@@ -286,6 +316,52 @@ void check_nan::on_batch_end(model *m) {
                   "in weights \"", w->get_name(), "\"");
     }
   }
+
+#ifdef LBANN_HAS_GPU
+  // Read this step's flag in the background and act on the last
+  // completed read
+  if (m_deferred && m_device != nullptr) {
+    if (poll_flag(false)) {
+      handle_deferred_flag(m);
+    } else {
+      start_flag_read();
+    }
+  }
+#endif // LBANN_HAS_GPU
+}
+
+void check_nan::on_train_end(model *m) {
+#ifdef LBANN_HAS_GPU
+  if (m_deferred && m_device != nullptr) {
+    bool tripped = poll_flag(true);
+    if (!tripped) {
+      start_flag_read();
+      tripped = poll_flag(true);
+    }
+    if (tripped) {
+      handle_deferred_flag(m);
+    }
+  }
+#endif // LBANN_HAS_GPU
+}
+
+void check_nan::handle_deferred_flag(model *m) {
+  const auto& c = dynamic_cast<sgd_execution_context&>(m->get_execution_context());
+  LBANN_WARNING("rank ", m->get_comm()->get_rank_in_world(), ": "
+                "found a NaN or inf on the GPU by step ", c.get_step(), "; "
+                "checking weights and gradients, then every layer from now on");
+  m_deferred = false;
+  on_backward_prop_end(m);
+  on_batch_end(m);
+}
+
+std::unique_ptr<callback_base>
+build_check_nan_callback_from_pbuf(
+  const google::protobuf::Message& proto_msg,
+  const std::shared_ptr<lbann_summary>&) {
+  const auto& params =
+    dynamic_cast<const lbann_data::Callback::CallbackCheckNaN&>(proto_msg);
+  return make_unique<check_nan>(params.deferred());
 }
 
 } // namespace callback
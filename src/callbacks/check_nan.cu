@@ -0,0 +1,126 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/callbacks/check_nan.hpp"
+#include "lbann/utils/cuda.hpp"
+#include "lbann/utils/pinned_memory.hpp"
+
+#include <algorithm>
+
+namespace lbann {
+namespace callback {
+
+/** Device flag that any kernel may set and a pinned host copy that
+ *  is read back asynchronously.
+ */
+struct check_nan::device_state {
+  int* flag = nullptr;
+  pinned_memory_pool::lease host_buffer;
+  int* host_flag = nullptr;
+  cudaEvent_t event;
+  bool pending = false;
+  device_state() {
+    CHECK_CUDA(cudaMalloc(&flag, sizeof(int)));
+    CHECK_CUDA(cudaMemset(flag, 0, sizeof(int)));
+    host_buffer = pinned_memory_pool::instance().acquire(sizeof(int));
+    host_flag = host_buffer.data<int>();
+    *host_flag = 0;
+    CHECK_CUDA(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+  }
+  ~device_state() {
+    cudaEventDestroy(event);
+    cudaFree(flag);
+  }
+};
+
+namespace {
+
+/**
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: (height*width / bsize) x 1 x 1
+ */
+__global__ void flag_nonfinite_kernel(El::Int height,
+                                      El::Int width,
+                                      const DataType* __restrict__ x,
+                                      El::Int x_ldim,
+                                      int* flag) {
+  const El::Int size = height * width;
+  const El::Int num_threads = blockDim.x * gridDim.x;
+  for (El::Int pos = blockIdx.x * blockDim.x + threadIdx.x;
+       pos < size;
+       pos += num_threads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    if (!isfinite(x[row + col * x_ldim])) {
+      *flag = 1;
+    }
+  }
+}
+
+} // namespace <anon>
+
+void check_nan::flag_nonfinite_gpu(const El::AbstractMatrix<DataType>& mat) {
+  const El::Int height = mat.Height();
+  const El::Int width = mat.Width();
+  if (height == 0 || width == 0) { return; }
+  if (m_device == nullptr) {
+    m_device = std::make_shared<device_state>();
+  }
+  const auto& gpu_mat = static_cast<const GPUMat&>(mat);
+  constexpr El::Int block_size = 256;
+  const El::Int grid_size = std::min((height * width + block_size - 1) / block_size,
+                                     El::Int(65535));
+  flag_nonfinite_kernel<<<grid_size, block_size, 0, El::GPUManager::Stream()>>>(
+    height, width, gpu_mat.LockedBuffer(), gpu_mat.LDim(), m_device->flag);
+  CHECK_CUDA(cudaGetLastError());
+}
+
+void check_nan::start_flag_read() {
+  if (m_device == nullptr || m_device->pending) { return; }
+  auto&& stream = El::GPUManager::Stream();
+  CHECK_CUDA(cudaMemcpyAsync(m_device->host_flag, m_device->flag, sizeof(int),
+                             cudaMemcpyDeviceToHost, stream));
+  CHECK_CUDA(cudaEventRecord(m_device->event, stream));
+  m_device->pending = true;
+}
+
+bool check_nan::poll_flag(bool wait) {
+  if (m_device == nullptr || !m_device->pending) { return false; }
+  if (wait) {
+    CHECK_CUDA(cudaEventSynchronize(m_device->event));
+  } else {
+    const auto status = cudaEventQuery(m_device->event);
+    if (status == cudaErrorNotReady) { return false; }
+    CHECK_CUDA(status);
+  }
+  m_device->pending = false;
+  return *m_device->host_flag != 0;
+}
+
+} // namespace callback
+} // namespace lbann
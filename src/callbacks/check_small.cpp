@@ -30,19 +30,29 @@
 
 namespace lbann {
 namespace callback {
-namespace {
-template <typename TensorDataType>
-bool is_good(const El::AbstractDistMatrix<TensorDataType>& m) {
-  static const TensorDataType threshold
-    = El::Sqrt(std::numeric_limits<TensorDataType>::min());
+
+bool check_small::is_good(const El::AbstractDistMatrix<DataType>& m) {
+  static const DataType threshold
+    = El::Sqrt(std::numeric_limits<DataType>::min());
 
   const auto& local_mat = m.LockedMatrix();
+#ifdef LBANN_HAS_GPU
+  if (local_mat.GetDevice() == El::Device::GPU) {
+    // Only the count is copied back to the host
+    const auto num_small = count_small_gpu(local_mat);
+    if (num_small > 0) {
+      std::cout << "Found " << num_small << " small values!" << std::endl;
+      return false;
+    }
+    return true;
+  }
+#endif // LBANN_HAS_GPU
   const El::Int height = local_mat.Height();
   const El::Int width = local_mat.Width();
   for (El::Int col = 0; col < width; ++col) {
     for (El::Int row = 0; row < height; ++row) {
       const auto val = std::abs(local_mat(row, col));
-      if (val > TensorDataType(0) && val <= threshold) {
+      if (val > DataType(0) && val <= threshold) {
         std::cout << "Found small value " << val
                   << " at (" << row << "," << col << ")!" << std::endl;
         return false;
@@ -51,7 +61,6 @@ bool is_good(const El::AbstractDistMatrix<TensorDataType>& m) {
   }
   return true;
 }
-}// namespace <anon>
 
 void check_small::on_forward_prop_end(model *m, Layer *l) {
   const auto& c = m->get_execution_context();
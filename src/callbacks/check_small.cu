@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/callbacks/check_small.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace lbann {
+namespace callback {
+
+namespace {
+
+/** Count entries x with 0 < |x| <= threshold.
+ *
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: (height*width / bsize) x 1 x 1
+ */
+template <El::Int bsize>
+__global__ void count_small_kernel(El::Int height,
+                                   El::Int width,
+                                   const DataType* __restrict__ x,
+                                   El::Int x_ldim,
+                                   DataType threshold,
+                                   El::Int* __restrict__ count) {
+  const El::Int tid = threadIdx.x;
+  const El::Int size = height * width;
+  const El::Int num_threads = blockDim.x * gridDim.x;
+  unsigned long long local_count = 0;
+  for (El::Int pos = blockIdx.x * blockDim.x + threadIdx.x;
+       pos < size;
+       pos += num_threads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    const auto val = cuda::abs(x[row + col * x_ldim]);
+    if (val > DataType(0) && val <= threshold) {
+      ++local_count;
+    }
+  }
+
+  // Shared memory reduction so each block adds to the count once
+  __shared__ unsigned long long shared_count[bsize];
+  shared_count[tid] = local_count;
+  for (El::Int stride = bsize / 2; stride > 0; stride /= 2) {
+    __syncthreads();
+    if (tid < stride) {
+      shared_count[tid] += shared_count[tid + stride];
+    }
+  }
+  if (tid == 0 && shared_count[0] > 0) {
+    atomicAdd(reinterpret_cast<unsigned long long*>(count), shared_count[0]);
+  }
+}
+
+} // namespace <anon>
+
+El::Int check_small::count_small_gpu(const El::AbstractMatrix<DataType>& mat) {
+  const El::Int height = mat.Height();
+  const El::Int width = mat.Width();
+  if (height == 0 || width == 0) { return 0; }
+  const auto& gpu_mat = static_cast<const GPUMat&>(mat);
+  const DataType threshold = El::Sqrt(std::numeric_limits<DataType>::min());
+
+  // Count on the device and copy one integer back
+  El::Matrix<El::Int, El::Device::GPU> count(1, 1);
+  El::Zero(count);
+  constexpr El::Int block_size = 256;
+  const El::Int grid_size = std::min((height * width + block_size - 1) / block_size,
+                                     El::Int(65535));
+  auto&& stream = El::GPUManager::Stream();
+  count_small_kernel<block_size><<<grid_size, block_size, 0, stream>>>(
+    height, width, gpu_mat.LockedBuffer(), gpu_mat.LDim(),
+    threshold, count.Buffer());
+  CHECK_CUDA(cudaGetLastError());
+  El::Int host_count = 0;
+  CHECK_CUDA(cudaMemcpyAsync(&host_count, count.LockedBuffer(),
+                             sizeof(host_count), cudaMemcpyDeviceToHost,
+                             stream));
+  CHECK_CUDA(cudaStreamSynchronize(stream));
+  return host_count;
+}
+
+} // namespace callback
+} // namespace lbann
@@ -30,11 +30,22 @@
 #include "lbann/callbacks/checkpoint.hpp"
 
 #include "lbann/models/model.hpp"
+#include "lbann/proto/proto_common.hpp"
+#include "lbann/utils/compression.hpp"
+#include "lbann/utils/file_utils.hpp"
 
 #include <callbacks.pb.h>
 
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace lbann {
 namespace callback {
@@ -43,10 +54,45 @@ void checkpoint::setup(model *m) {
   reload_model(m);
 }
 
+bool checkpoint::restores_weights(model *m) {
+  if (get_restart_dir().length() == 0 &&  m_per_rank_dir.length() == 0) {
+    return false;
+  }
+  size_t epoch = std::numeric_limits<size_t>::max();
+  size_t step = std::numeric_limits<size_t>::max();
+  bool shared = true;
+  execution_mode mode;
+  find_latest_checkpoint(*(m->get_comm()),
+                         get_active_trainer().get_name(),
+                         get_active_training_algorithm().get_name(),
+                         mode, epoch, step, shared);
+  return epoch != std::numeric_limits<size_t>::max();
+}
+
 void checkpoint::setup(trainer *t) {
   set_active_trainer(t);
   auto& p = get_active_trainer().get_persist_obj();
   p.set_cb_type(callback_type::invalid);
+#ifndef LBANN_HAS_CUFILE
+  if (m_gpu_direct_storage && t->get_comm()->am_world_master()) {
+    LBANN_WARNING("GPUDirect Storage was requested for checkpoints, "
+                  "but LBANN was built without cuFile");
+  }
+#endif // LBANN_HAS_CUFILE
+  p.set_gpu_direct_storage(m_gpu_direct_storage);
+  for (const auto& name : parse_set<std::string>(m_compress)) {
+    if (name == "train") {
+      p.set_compressed(persist_type::train, true);
+    } else if (name == "model") {
+      p.set_compressed(persist_type::model, true);
+    } else {
+      LBANN_ERROR("invalid persist type to compress (", name, ")");
+    }
+  }
+  if (!m_compress.empty() && !utils::have_compression()) {
+    LBANN_ERROR("checkpoint compression was requested, "
+                "but LBANN was built without zlib");
+  }
   reload_trainer(t);
 }
 
@@ -78,6 +124,7 @@ void checkpoint::on_validation_end(model *m) {
 }
  // Interval defined with checkpoint_steps or ckpt_dist_steps
 void checkpoint::on_batch_end(model *m) {
+  finish_async_writes(m, false);
   auto& p = get_active_trainer().get_persist_obj();
   p.set_cb_type(callback_type::full_checkpoint);
   if(need_checkpoint(m, callback_phase::batch)){
@@ -86,6 +133,209 @@ void checkpoint::on_batch_end(model *m) {
   p.set_cb_type(callback_type::invalid);
 }
 
+void checkpoint::on_train_end(model *m) {
+  finish_async_writes(m, true);
+}
+
+void checkpoint::finish_async_writes(model *m, bool wait) {
+  if (m_async_writes_done == nullptr) { return; }
+  lbann_comm *comm = m->get_comm();
+  if (!wait) {
+    const int done = (m_async_writes_done->wait_for(std::chrono::seconds(0))
+                      == std::future_status::ready);
+    if (comm->trainer_allreduce(done, El::mpi::MIN) == 0) { return; }
+  }
+  m_async_writes_done->get();
+  m_async_writes_done.reset();
+  comm->trainer_barrier();
+  if (!m_pending_buddy_dir.empty()) {
+    copy_to_buddy(*comm, m_pending_buddy_dir);
+    m_pending_buddy_dir.clear();
+  }
+  for (const auto& marker : m_pending_markers) {
+    write_latest(marker.filename, marker.mode, marker.epoch, marker.step);
+  }
+  m_pending_markers.clear();
+}
+
+namespace {
+
+/** Trainer ranks that are among the first @c per_node processes on
+ *  their node. */
+std::vector<int> choose_io_aggregators(lbann_comm& comm, int per_node) {
+  int is_aggregator = (comm.get_rank_in_node() < per_node);
+  std::vector<int> flags(comm.get_procs_per_trainer());
+  comm.trainer_all_gather(is_aggregator, flags);
+  std::vector<int> ranks;
+  for (size_t r = 0; r < flags.size(); ++r) {
+    if (flags[r]) { ranks.push_back(r); }
+  }
+  return ranks;
+}
+
+/** Maximum number of bytes in one message. */
+constexpr size_t max_message_size = 1ul << 30;
+
+/** This rank's buddy, which keeps a copy of its distributed
+ *  checkpoint, and the rank whose copy it keeps. Buddies are one
+ *  node apart. */
+std::pair<int, int> get_buddies(lbann_comm& comm) {
+  const int np = comm.get_procs_per_trainer();
+  const int rank = comm.get_rank_in_trainer();
+  const int offset = comm.get_procs_per_node() % np;
+  return {(rank + offset) % np, (rank - offset + np) % np};
+}
+
+template <typename T>
+void pack_value(std::vector<char>& buf, const T& val) {
+  const auto* ptr = reinterpret_cast<const char*>(&val);
+  buf.insert(buf.end(), ptr, ptr + sizeof(T));
+}
+
+template <typename T>
+T unpack_value(const std::vector<char>& buf, size_t& pos) {
+  T val;
+  std::memcpy(&val, &buf[pos], sizeof(T));
+  pos += sizeof(T);
+  return val;
+}
+
+void pack_string(std::vector<char>& buf, const std::string& str) {
+  pack_value<uint64_t>(buf, str.size());
+  buf.insert(buf.end(), str.begin(), str.end());
+}
+
+std::string unpack_string(const std::vector<char>& buf, size_t& pos) {
+  const auto size = unpack_value<uint64_t>(buf, pos);
+  std::string str(&buf[pos], size);
+  pos += size;
+  return str;
+}
+
+/** Pack the files in a checkpoint directory into a buffer. */
+std::vector<char> pack_directory(const std::string& dir) {
+  DIR* d = opendir(dir.c_str());
+  if (d == nullptr) {
+    LBANN_ERROR("failed to open checkpoint directory (", dir, ")");
+  }
+  std::vector<std::string> names;
+  for (auto* entry = readdir(d); entry != nullptr; entry = readdir(d)) {
+    const std::string path = dir + "/" + entry->d_name;
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+      names.push_back(entry->d_name);
+    }
+  }
+  closedir(d);
+
+  std::vector<char> buf;
+  pack_string(buf, dir);
+  pack_value<uint64_t>(buf, names.size());
+  std::vector<char> data;
+  for (const auto& name : names) {
+    if (!load_file(dir + "/" + name, data)) {
+      LBANN_ERROR("failed to read checkpoint file (", dir, "/", name, ")");
+    }
+    pack_string(buf, name);
+    pack_value<uint64_t>(buf, data.size());
+    buf.insert(buf.end(), data.begin(), data.end());
+  }
+  return buf;
+}
+
+/** Write files packed by pack_directory. */
+void unpack_directory(const std::vector<char>& buf) {
+  size_t pos = 0;
+  const auto dir = unpack_string(buf, pos);
+  file::make_directory(dir);
+  const auto num_files = unpack_value<uint64_t>(buf, pos);
+  for (uint64_t i = 0; i < num_files; ++i) {
+    const auto name = unpack_string(buf, pos);
+    const auto size = unpack_value<uint64_t>(buf, pos);
+    std::ofstream os(dir + "/" + name, std::ios::binary);
+    os.write(&buf[pos], size);
+    if (!os) {
+      LBANN_ERROR("failed to write checkpoint file (", dir, "/", name, ")");
+    }
+    pos += size;
+  }
+}
+
+/** Send a buffer to @c dst while receiving one from @c src. Either
+ *  rank may be negative to skip that direction. */
+std::vector<char> exchange_buffers(lbann_comm& comm,
+                                   const std::vector<char>& send_buf,
+                                   int dst,
+                                   int src) {
+  const int trainer = comm.get_trainer_rank();
+  const uint64_t send_size = send_buf.size();
+  uint64_t recv_size = 0;
+  El::mpi::Request<uint64_t> size_req;
+  if (dst >= 0) { comm.nb_send(&send_size, 1, trainer, dst, size_req); }
+  if (src >= 0) { comm.recv(&recv_size, 1, trainer, src); }
+  if (dst >= 0) { comm.wait(size_req); }
+
+  std::vector<El::mpi::Request<char>> send_reqs;
+  if (dst >= 0) {
+    send_reqs.resize((send_size + max_message_size - 1) / max_message_size);
+    for (size_t i = 0; i < send_reqs.size(); ++i) {
+      const size_t offset = i * max_message_size;
+      const int count = std::min(max_message_size, send_size - offset);
+      comm.nb_send(send_buf.data() + offset, count, trainer, dst, send_reqs[i]);
+    }
+  }
+  std::vector<char> recv_buf(recv_size);
+  for (size_t offset = 0; offset < recv_size; offset += max_message_size) {
+    const int count = std::min(max_message_size, recv_size - offset);
+    comm.recv(recv_buf.data() + offset, count, trainer, src);
+  }
+  comm.wait_all(send_reqs);
+  return recv_buf;
+}
+
+/** Copy this rank's distributed checkpoint to its buddy and keep
+ *  a copy of another rank's. Collective over the trainer. */
+void copy_to_buddy(lbann_comm& comm, const std::string& epochdir) {
+  const auto buddies = get_buddies(comm);
+  if (buddies.first == comm.get_rank_in_trainer()) { return; }
+  unpack_directory(exchange_buffers(comm, pack_directory(epochdir),
+                                    buddies.first, buddies.second));
+}
+
+/** Restore missing distributed checkpoints from buddies. Collective
+ *  over the trainer. */
+void restore_from_buddy(lbann_comm& comm,
+                        const std::string& epochdir,
+                        const std::string& buddy_copy_dir) {
+  const int np = comm.get_procs_per_trainer();
+  const int offset = comm.get_procs_per_node() % np;
+  int missing = !file::directory_exists(epochdir);
+  std::vector<int> all_missing(np);
+  comm.trainer_all_gather(missing, all_missing);
+  for (int r = 0; r < np; ++r) {
+    if (all_missing[r] && (offset == 0 || all_missing[(r + offset) % np])) {
+      LBANN_ERROR("distributed checkpoint of rank ", r,
+                  " is missing on both that process and its buddy");
+    }
+  }
+  const auto buddies = get_buddies(comm);
+  std::vector<char> send_buf;
+  int dst = -1;
+  if (all_missing[buddies.second]) {
+    if (!file::directory_exists(buddy_copy_dir)) {
+      LBANN_ERROR("buddy copy of distributed checkpoint is missing (",
+                  buddy_copy_dir, ")");
+    }
+    send_buf = pack_directory(buddy_copy_dir);
+    dst = buddies.second;
+  }
+  const int src = missing ? buddies.first : -1;
+  const auto recv_buf = exchange_buffers(comm, send_buf, dst, src);
+  if (missing) { unpack_directory(recv_buf); }
+}
+
+} // namespace
+
 // Decide if we need to trigger a checkpoint for either mode, based on prototext defined intervals
 bool checkpoint::need_checkpoint(model *m, callback_phase phase) {
   const auto& c = static_cast<sgd_execution_context&>(m->get_execution_context());
@@ -150,6 +400,9 @@ bool checkpoint::do_checkpoint(model *m) {
   if (get_checkpoint_dir().length() == 0 && m_per_rank_dir.length() == 0) {
     return false;
   }
+  // only one checkpoint can be written in the background
+  finish_async_writes(m, true);
+  p.set_defer_writes(m_async_writes);
   // time how long this takes
   // read current epoch and step counters from model
   El::Timer timer;
@@ -179,6 +432,13 @@ bool checkpoint::do_checkpoint(model *m) {
   comm->trainer_broadcast(0, epoch);
   comm->trainer_broadcast(0, step);
 
+  // Every few checkpoints is a full base for the deltas in between
+  const bool delta = (m_full_checkpoint_interval > 1
+                      && m_checkpoints_since_full % m_full_checkpoint_interval != 0);
+  if (m_full_checkpoint_interval > 1) {
+    m_checkpoints_since_full = delta ? m_checkpoints_since_full + 1 : 1;
+  }
+
   // Distributed ckpt
   if(m_checkpoint_dist){
     // prepend per rank directory with shared checkpoint dir name
@@ -199,6 +459,15 @@ bool checkpoint::do_checkpoint(model *m) {
     /** @todo BVE FIXME this should be refactored to only open the
         checkpoints files that we care about */
     p.open_checkpoint(epochdir.c_str(), true);
+    if (m_full_checkpoint_interval > 1) {
+      if (delta && !m_dist_base_dir.empty()) {
+        p.set_delta(checkpoint_delta::delta, m_dist_base_dir);
+        p.write_base_dir();
+      } else {
+        p.set_delta(checkpoint_delta::base);
+        m_dist_base_dir = epochdir;
+      }
+    }
     // Make sure that the master has had a chance to create the directories
     comm->trainer_barrier();
     // Call top level save to checkpoint function in model, in turn calls save to checkpoint functions for other model classes (weights, layers)
@@ -209,13 +478,34 @@ bool checkpoint::do_checkpoint(model *m) {
        || p.get_cb_type() == callback_type::full_checkpoint) {
       t.save_to_checkpoint_distributed();
     }
+    p.set_delta(checkpoint_delta::none);
     p.close_checkpoint();
+    // Copy to buddy once the files are written
+    if (m_buddy_checkpoint) {
+      if (m_async_writes) {
+        m_pending_buddy_dir = epochdir;
+      } else {
+        copy_to_buddy(*comm, epochdir);
+      }
+    }
     // Print latest checkpoint to file
     if (comm->am_trainer_master()) {
+      // Nodes can be lost with buddy checkpoints, so use the shared
+      // checkpoint directory
+      const std::string latest_dir = (m_buddy_checkpoint
+                                      ? get_checkpoint_dir()
+                                      : std::string(dir));
+      if (m_buddy_checkpoint) {
+        file::make_directory(get_trainer_checkpoint_dirname(t.get_name(), latest_dir));
+      }
       latest_file = get_last_distributed_checkpoint_filename(t.get_name(),
                                                              get_active_training_algorithm().get_name(),
-                                                             dir);
-      write_latest(latest_file, c.get_execution_mode(), epoch, step);
+                                                             latest_dir);
+      if (m_async_writes) {
+        m_pending_markers.push_back({latest_file, c.get_execution_mode(), epoch, step});
+      } else {
+        write_latest(latest_file, c.get_execution_mode(), epoch, step);
+      }
     }
   }
   // Shared checkpoint, logic identical to Distributed.
@@ -226,6 +516,18 @@ bool checkpoint::do_checkpoint(model *m) {
                                              get_active_training_algorithm().get_name(),
                                              dir, c.get_execution_mode(), epoch, step);
     p.open_checkpoint(epochdir.c_str(), comm->am_trainer_master());
+    if (m_io_aggregators_per_node > 0) {
+      p.set_io_aggregators(choose_io_aggregators(*comm, m_io_aggregators_per_node));
+    }
+    if (m_full_checkpoint_interval > 1) {
+      if (delta && !m_shared_base_dir.empty()) {
+        p.set_delta(checkpoint_delta::delta, m_shared_base_dir);
+        if (comm->am_trainer_master()) { p.write_base_dir(); }
+      } else {
+        p.set_delta(checkpoint_delta::base);
+        m_shared_base_dir = epochdir;
+      }
+    }
     // Make sure that the master has had a chance to create the directories
     comm->trainer_barrier();
     if(p.get_cb_type() == callback_type::model_only || p.get_cb_type() == callback_type::full_checkpoint) {
@@ -236,15 +538,32 @@ bool checkpoint::do_checkpoint(model *m) {
       t.save_to_checkpoint_shared();
     }
     // close our checkpoint
+    p.set_delta(checkpoint_delta::none);
+    p.set_io_aggregators({});
     p.close_checkpoint();
     if (comm->am_trainer_master()) {
       latest_file = get_last_shared_checkpoint_filename(t.get_name(),
                                                         get_active_training_algorithm().get_name(),
                                                         dir);
-      write_latest(latest_file, c.get_execution_mode(), epoch, step);
+      if (m_async_writes) {
+        m_pending_markers.push_back({latest_file, c.get_execution_mode(), epoch, step});
+      } else {
+        write_latest(latest_file, c.get_execution_mode(), epoch, step);
+      }
     }
   }
 
+  // write matrices in the background
+  if (m_async_writes) {
+    p.set_defer_writes(false);
+    auto writes = std::make_shared<std::vector<persist::deferred_write>>(
+      p.take_deferred_writes());
+    m_async_writes_done = std::make_shared<std::future<void>>(
+      std::async(std::launch::async, [writes]() {
+          for (const auto& write : *writes) { write(); }
+        }));
+  }
+
   uint64_t bytes_count = p.get_bytes();
 
   if (comm->am_trainer_master()) {
@@ -260,7 +579,9 @@ bool checkpoint::do_checkpoint(model *m) {
               << " complete: Epoch=" << epoch
               << " Step=" << step
               << " (" << secs << " secs, " << bytes_count << " bytes, "
-              << bw << " MB/sec)" << std::endl;
+              << bw << " MB/sec)"
+              << (m_async_writes ? ", writing in background" : "")
+              << std::endl;
     fflush(stdout);
   }
   // record last checkpoint time in case checkpoint_secs interval defined.
@@ -285,7 +606,9 @@ std::string checkpoint::find_latest_checkpoint(lbann_comm& comm,
   if (comm.am_trainer_master()) {
     std::string latest_file;
     if(m_per_rank_dir.length()){
-      dir = get_distributed_checkpoint_rootdir();
+      dir = (m_buddy_checkpoint
+             ? get_restart_dir()
+             : get_distributed_checkpoint_rootdir());
       latest_file = get_last_distributed_checkpoint_filename(trainer_name, alg_name, dir);
       read_latest(latest_file, &mode, &epoch_dist, &step_dist);
     }
@@ -382,6 +705,12 @@ bool checkpoint::open_latest_checkpoint(
                                                   alg_name,
                                                   comm.get_rank_in_trainer(),
                                                   dir, mode, epoch, step);
+    if (m_buddy_checkpoint) {
+      const auto buddy_copy_dir = get_distributed_checkpoint_dirname(
+        trainer_name, alg_name, get_buddies(comm).second,
+        dir, mode, epoch, step);
+      restore_from_buddy(comm, epochdir, buddy_copy_dir);
+    }
     if(!file::directory_exists(epochdir)) {
       LBANN_WARNING(epochdir + " does not exist");
       return false;
@@ -525,7 +854,13 @@ build_checkpoint_callback_from_pbuf(
                                  params.checkpoint_secs(),
                                  params.per_rank_dir(),
                                  params.ckpt_dist_epochs(),
-                                 params.ckpt_dist_steps());
+                                 params.ckpt_dist_steps(),
+                                 params.async_writes(),
+                                 params.io_aggregators_per_node(),
+                                 params.full_checkpoint_interval(),
+                                 params.buddy_checkpoint(),
+                                 params.gpu_direct_storage(),
+                                 params.compress());
 }
 
 } // namespace callback
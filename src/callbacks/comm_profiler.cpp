@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/callbacks/comm_profiler.hpp"
+
+#include "lbann/execution_contexts/sgd_execution_context.hpp"
+#include "lbann/utils/comm_profile.hpp"
+#include "lbann/utils/memory.hpp"
+
+#include <callbacks.pb.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace lbann {
+namespace callback {
+
+void comm_profiler::on_train_begin(model *m) {
+  comm_profile::enable();
+}
+
+void comm_profiler::on_train_end(model *m) {
+  comm_profile::disable();
+}
+
+void comm_profiler::on_epoch_begin(model *m) {
+  // Discard communication from outside the epoch
+  comm_profile::collect();
+}
+
+void comm_profiler::on_epoch_end(model *m) {
+  const auto& c = static_cast<sgd_execution_context&>(m->get_execution_context());
+  auto& comm = *m->get_comm();
+  const auto rep = comm_profile::collect();
+
+  // Exposed communication on each process in the trainer
+  double exposed = rep.exposed_time;
+  std::vector<double> exposed_list(comm.get_procs_per_trainer());
+  comm.trainer_all_gather(exposed, exposed_list);
+  if (!comm.am_trainer_master()) { return; }
+  const auto max_it = std::max_element(exposed_list.begin(),
+                                       exposed_list.end());
+  const auto min_exposed = *std::min_element(exposed_list.begin(),
+                                             exposed_list.end());
+  double mean_exposed = 0;
+  for (const auto& t : exposed_list) { mean_exposed += t; }
+  mean_exposed /= exposed_list.size();
+
+  std::stringstream msg;
+  msg << std::fixed << std::setprecision(3);
+  const std::string prefix =
+    m->get_name() + " (instance " + std::to_string(comm.get_trainer_rank())
+    + ") training epoch " + std::to_string(c.get_epoch()-1) + " ";
+  const double overlap = (rep.comm_time > 0
+                          ? 100 * (1 - rep.exposed_time / rep.comm_time)
+                          : 0);
+  msg << prefix << "communication : "
+      << rep.comm_time << "s total, "
+      << rep.exposed_time << "s exposed ("
+      << (rep.wall_time > 0 ? 100 * rep.exposed_time / rep.wall_time : 0)
+      << "% of " << rep.wall_time << "s), "
+      << overlap << "% overlapped\n";
+  msg << prefix << "exposed communication per process : "
+      << mean_exposed << "s mean, "
+      << min_exposed << "s min, "
+      << *max_it << "s max (rank " << (max_it - exposed_list.begin())
+      << ", on the critical path)\n";
+
+  msg << prefix << "communication by size :\n";
+  for (const auto& sc : rep.size_classes) {
+    msg << "  " << comm_profile::to_string(sc.op)
+        << " (" << sc.algorithm << ") >= " << sc.min_bytes << "B : "
+        << sc.count << " ops, "
+        << sc.time << "s, "
+        << sc.bus_bandwidth / 1e9 << " GB/s bus bandwidth\n";
+  }
+
+  msg << prefix << "exposed communication by layer/weights :\n";
+  const auto num_contexts = std::min(m_num_contexts, rep.contexts.size());
+  for (size_t i = 0; i < num_contexts; ++i) {
+    const auto& cs = rep.contexts[i];
+    msg << "  " << cs.name << " : "
+        << cs.exposed_time << "s exposed of " << cs.time << "s, "
+        << cs.count << " ops, " << cs.bytes << "B\n";
+  }
+  std::cout << msg.str() << std::flush;
+}
+
+std::unique_ptr<callback_base>
+build_comm_profiler_callback_from_pbuf(
+  const google::protobuf::Message& proto_msg, std::shared_ptr<lbann_summary> const&) {
+  const auto& params =
+    dynamic_cast<const lbann_data::Callback::CallbackCommProfiler&>(proto_msg);
+  return make_unique<comm_profiler>(
+    params.num_contexts() > 0 ? params.num_contexts() : 10);
+}
+
+} // namespace callback
+} // namespace lbann
@@ -30,6 +30,7 @@
 #include <callbacks.pb.h>
 
 #include <fstream>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -65,7 +66,14 @@ confusion_matrix::confusion_matrix(const confusion_matrix& other)
     m_prefix(other.m_prefix),
     m_counts(other.m_counts),
     m_predictions_v(other.m_predictions_v ? other.m_predictions_v->Copy() : nullptr),
-    m_labels_v(other.m_labels_v ? other.m_labels_v->Copy() : nullptr) {}
+    m_labels_v(other.m_labels_v ? other.m_labels_v->Copy() : nullptr) {
+#ifdef LBANN_HAS_GPU
+  for (const auto& kv : other.m_device_counts) {
+    El::Copy(kv.second, m_device_counts[kv.first]);
+  }
+  m_device_num_samples = other.m_device_num_samples;
+#endif // LBANN_HAS_GPU
+}
 
 confusion_matrix& confusion_matrix::operator=(const confusion_matrix& other) {
   callback_base::operator=(other);
@@ -75,6 +83,13 @@ confusion_matrix& confusion_matrix::operator=(const confusion_matrix& other) {
   m_counts = other.m_counts;
   m_predictions_v.reset(other.m_predictions_v ? other.m_predictions_v->Copy() : nullptr);
   m_labels_v.reset(other.m_labels_v ? other.m_labels_v->Copy() : nullptr);
+#ifdef LBANN_HAS_GPU
+  m_device_counts.clear();
+  for (const auto& kv : other.m_device_counts) {
+    El::Copy(kv.second, m_device_counts[kv.first]);
+  }
+  m_device_num_samples = other.m_device_num_samples;
+#endif // LBANN_HAS_GPU
   return *this;
 }
 
@@ -142,7 +157,29 @@ void confusion_matrix::reset_counts(const model& m) {
   auto& counts = m_counts[c.get_execution_mode()];
   const auto& num_classes = get_predictions(m).Height();
   counts.assign(num_classes * num_classes, 0);
+#ifdef LBANN_HAS_GPU
+  m_device_counts.erase(c.get_execution_mode());
+  m_device_num_samples.erase(c.get_execution_mode());
+#endif // LBANN_HAS_GPU
+}
+
+#ifdef LBANN_HAS_GPU
+void confusion_matrix::flush_device_counts(execution_mode mode) {
+  auto it = m_device_counts.find(mode);
+  if (it == m_device_counts.end()) { return; }
+  CPUMat host_counts;
+  El::Copy(it->second, host_counts);
+  auto& counts = m_counts[mode];
+  const auto& num_classes = host_counts.Height();
+  for (El::Int i = 0; i < num_classes; ++i) {
+    for (El::Int j = 0; j < num_classes; ++j) {
+      counts[j + i * num_classes] += static_cast<El::Int>(host_counts(j, i));
+    }
+  }
+  El::Zero(it->second);
+  m_device_num_samples[mode] = 0;
 }
+#endif // LBANN_HAS_GPU
 
 void confusion_matrix::update_counts(const model& m) {
   constexpr DataType zero = 0;
@@ -150,6 +187,34 @@ void confusion_matrix::update_counts(const model& m) {
   // Get predictions
   const auto& predictions = get_predictions(m);
   const auto& num_classes = predictions.Height();
+
+#ifdef LBANN_HAS_GPU
+  // Count on the GPU if every process has whole output columns there
+  const auto& gpu_labels = get_labels(m);
+  if (predictions.GetLocalDevice() == El::Device::GPU
+      && predictions.DistData() == gpu_labels.DistData()
+      && predictions.LocalHeight() == num_classes) {
+    const auto& mode = m.get_execution_context().get_execution_mode();
+    auto& device_counts = m_device_counts[mode];
+    if (device_counts.Height() != num_classes) {
+      El::Zeros(device_counts, num_classes, num_classes);
+    }
+    update_confusion_matrix_counts_gpu(
+      static_cast<const GPUMat&>(predictions.LockedMatrix()),
+      static_cast<const GPUMat&>(gpu_labels.LockedMatrix()),
+      device_counts);
+    // Flush before any count could exceed the exact integers of
+    // DataType
+    auto& num_samples = m_device_num_samples[mode];
+    num_samples += predictions.LocalWidth();
+    constexpr El::Int max_exact_count
+      = El::Int(1) << std::numeric_limits<DataType>::digits;
+    if (num_samples >= max_exact_count - predictions.LocalWidth()) {
+      flush_device_counts(mode);
+    }
+    return;
+  }
+#endif // LBANN_HAS_GPU
   m_predictions_v->Empty(false);
   m_predictions_v->AlignWith(predictions);
   if (m_predictions_v->DistData() == predictions.DistData()) {
@@ -198,6 +263,9 @@ void confusion_matrix::save_confusion_matrix(const model& m) {
 
   // Get counts
   const auto& mode = c.get_execution_mode();
+#ifdef LBANN_HAS_GPU
+  flush_device_counts(mode);
+#endif // LBANN_HAS_GPU
   auto& counts = m_counts[mode];
 
   // Accumulate counts in master process
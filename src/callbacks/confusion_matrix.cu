@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/callbacks/confusion_matrix.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <algorithm>
+
+namespace lbann {
+namespace callback {
+
+namespace {
+
+/**
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: width x 1 x 1
+ *
+ *  Each block finds the nonzero rows of a prediction column and its
+ *  label column, then one thread counts the pair.
+ */
+__global__ void confusion_matrix_kernel(El::Int height,
+                                        El::Int width,
+                                        const DataType* __restrict__ predictions,
+                                        El::Int predictions_ldim,
+                                        const DataType* __restrict__ labels,
+                                        El::Int labels_ldim,
+                                        DataType* __restrict__ counts,
+                                        El::Int counts_ldim) {
+  const DataType zero = 0.;
+  __shared__ int prediction_index, label_index;
+  for (El::Int col = blockIdx.x; col < width; col += gridDim.x) {
+    if (threadIdx.x == 0) {
+      prediction_index = -1;
+      label_index = -1;
+    }
+    __syncthreads();
+    for (El::Int row = threadIdx.x; row < height; row += blockDim.x) {
+      if (predictions[row + col * predictions_ldim] != zero) {
+        atomicMax(&prediction_index, static_cast<int>(row));
+      }
+      if (labels[row + col * labels_ldim] != zero) {
+        atomicMax(&label_index, static_cast<int>(row));
+      }
+    }
+    __syncthreads();
+    if (threadIdx.x == 0 && prediction_index >= 0 && label_index >= 0) {
+      cuda::atomic_add(&counts[label_index + prediction_index * counts_ldim],
+                       DataType(1));
+    }
+    __syncthreads();
+  }
+}
+
+} // namespace <anon>
+
+void update_confusion_matrix_counts_gpu(const GPUMat& predictions,
+                                        const GPUMat& labels,
+                                        GPUMat& counts) {
+  const El::Int height = predictions.Height();
+  const El::Int width = predictions.Width();
+  if (height == 0 || width == 0) { return; }
+  constexpr El::Int block_size = 256;
+  const El::Int grid_size = std::min(width, El::Int(65535));
+  confusion_matrix_kernel<<<grid_size, block_size, 0, El::GPUManager::Stream()>>>(
+    height, width,
+    predictions.LockedBuffer(), predictions.LDim(),
+    labels.LockedBuffer(), labels.LDim(),
+    counts.Buffer(), counts.LDim());
+  CHECK_CUDA(cudaGetLastError());
+}
+
+} // namespace callback
+} // namespace lbann
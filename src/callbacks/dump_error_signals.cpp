@@ -26,6 +26,7 @@
 
 #include "lbann/callbacks/dump_error_signals.hpp"
 #include "lbann/layers/data_type_layer.hpp"
+#include "shard_writer.hpp"
 
 #include <callbacks.pb.h>
 
@@ -50,18 +51,29 @@ void dump_error_signals::on_backward_prop_end(model *m, Layer *l) {
 
     // Write activations to file
     auto& dtl = dynamic_cast<data_type_layer<DataType>&>(*l);
-    El::Write(dtl.get_error_signals(i), file.str(), El::ASCII);
+    if (m_sharded) {
+      if (m_writer == nullptr) { m_writer = std::make_shared<shard_writer>(); }
+      m_writer->write(dtl.get_error_signals(i),
+                      shard_file_name(file.str(), m->get_comm()->get_rank_in_trainer(), "txt"),
+                      save_ascii);
+    } else {
+      El::Write(dtl.get_error_signals(i), file.str(), El::ASCII);
+    }
 
   }
 
 }
 
+void dump_error_signals::on_train_end(model *m) {
+  if (m_writer != nullptr) { m_writer->wait(); }
+}
+
 std::unique_ptr<callback_base>
 build_dump_error_signals_callback_from_pbuf(
   const google::protobuf::Message& proto_msg, const std::shared_ptr<lbann_summary>&) {
   const auto& params =
     dynamic_cast<const lbann_data::Callback::CallbackDumpErrorSignals&>(proto_msg);
-  return make_unique<dump_error_signals>(params.basename());
+  return make_unique<dump_error_signals>(params.basename(), params.sharded());
 }
 
 } // namespace callback
@@ -29,6 +29,7 @@
 #include "lbann/utils/file_utils.hpp"
 #include "lbann/utils/trainer_file_utils.hpp"
 #include "lbann/layers/data_type_layer.hpp"
+#include "shard_writer.hpp"
 
 #include <callbacks.pb.h>
 
@@ -103,12 +104,14 @@ dump_outputs::dump_outputs(std::set<std::string> layer_names,
                            std::set<execution_mode> modes,
                            El::Int batch_interval,
                            std::string directory,
-                           std::string file_format)
+                           std::string file_format,
+                           bool sharded)
   : callback_base(std::max(batch_interval, El::Int(1))),
     m_layer_names(std::move(layer_names)),
     m_modes(std::move(modes)),
     m_directory(std::move(directory)),
-    m_file_format(std::move(file_format)) {
+    m_file_format(std::move(file_format)),
+    m_sharded(sharded) {
   std::stringstream err;
 
   // Initialize directory for output files
@@ -151,6 +154,38 @@ void dump_outputs::do_dump_outputs(const model& m, const Layer& l) {
   const std::string root_file_path = get_multi_trainer_model_path(m, m_directory);
   file::trainer_master_make_directory(root_file_path, m.get_comm());
 
+  // Each rank saves its local outputs in the background
+  if (m_sharded) {
+    if (m_writer == nullptr) { m_writer = std::make_shared<shard_writer>(); }
+    const auto& dtl = dynamic_cast<const data_type_layer<DataType>&>(l);
+    const int rank = m.get_comm()->get_rank_in_trainer();
+    for (int i = 0; i < l.get_num_children(); ++i) {
+      const auto& mat = dtl.get_activations(i);
+      const std::string tensor_name = l.get_name() + "_output" + std::to_string(i);
+      const std::string file_name = shard_file_name(
+        root_file_path + c.get_state_string() + "_" + tensor_name,
+        rank, m_file_format);
+      // Tensor dims only apply if this rank has full samples
+      std::vector<int> dims = dtl.get_output_dims(i);
+      if (mat.ColStride() != 1) { dims.assign(1, mat.LocalHeight()); }
+      const auto format = m_file_format;
+      m_writer->write(
+        mat, file_name,
+        [format, tensor_name, dims](const std::string& name, const CPUMat& data) {
+          if (format == "csv") {
+            save_text(name, ",", data);
+          } else if (format == "tsv") {
+            save_text(name, "\t", data);
+          } else if (format == "npy") {
+            save_npy(name, dims, data);
+          } else if (format == "npz") {
+            save_npz(name, tensor_name, dims, data);
+          }
+        });
+    }
+    return;
+  }
+
   // Save layer outputs on root process
   for (int i = 0; i < l.get_num_children(); ++i) {
     const auto& dtl = dynamic_cast<const data_type_layer<DataType>&>(l);
@@ -179,6 +214,10 @@ void dump_outputs::do_dump_outputs(const model& m, const Layer& l) {
 
 }
 
+void dump_outputs::wait_for_writes() {
+  if (m_writer != nullptr) { m_writer->wait(); }
+}
+
 std::unique_ptr<callback_base>
 build_dump_outputs_callback_from_pbuf(
   const google::protobuf::Message& proto_msg, const std::shared_ptr<lbann_summary>&) {
@@ -191,7 +230,8 @@ build_dump_outputs_callback_from_pbuf(
                                                   modes,
                                                   params.batch_interval(),
                                                   params.directory(),
-                                                  params.format());
+                                                  params.format(),
+                                                  params.sharded());
 }
 
 } // namespace callback
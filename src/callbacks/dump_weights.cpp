@@ -29,6 +29,7 @@
 #include "lbann/callbacks/dump_weights.hpp"
 #include "lbann/utils/memory.hpp"
 #include "lbann/weights/data_type_weights.hpp"
+#include "shard_writer.hpp"
 
 #include <callbacks.pb.h>
 
@@ -45,6 +46,10 @@ void dump_weights::on_epoch_end(model *m) {
   do_dump_weights(m);
 }
 
+void dump_weights::on_train_end(model *m) {
+  if (m_writer != nullptr) { m_writer->wait(); }
+}
+
 void dump_weights::do_dump_weights(model *m, std::string s) {
   const auto& c = static_cast<const sgd_execution_context&>(m->get_execution_context());
 
@@ -63,7 +68,14 @@ void dump_weights::do_dump_weights(model *m, std::string s) {
          + "-" + w->get_name()
          + "-Weights");
     const auto* dtw = dynamic_cast<const data_type_weights<DataType>*>(w);
-    El::Write(dtw->get_values(), file, El::ASCII);
+    if (m_sharded) {
+      if (m_writer == nullptr) { m_writer = std::make_shared<shard_writer>(); }
+      m_writer->write(dtw->get_values(),
+                      shard_file_name(file, m->get_comm()->get_rank_in_trainer(), "txt"),
+                      save_ascii);
+    } else {
+      El::Write(dtw->get_values(), file, El::ASCII);
+    }
   }
 }
 
@@ -72,7 +84,9 @@ build_dump_weights_callback_from_pbuf(
   const google::protobuf::Message& proto_msg, const std::shared_ptr<lbann_summary>&) {
   const auto& params =
     dynamic_cast<const lbann_data::Callback::CallbackDumpWeights&>(proto_msg);
-  return make_unique<dump_weights>(params.basename(), params.epoch_interval());
+  return make_unique<dump_weights>(params.basename(),
+                                   params.epoch_interval(),
+                                   params.sharded());
 }
 
 } // namespace callback
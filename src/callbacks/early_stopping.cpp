@@ -35,8 +35,8 @@
 namespace lbann {
 namespace callback {
 
-early_stopping::early_stopping(int64_t patience) :
-  callback_base(), m_patience(patience) {}
+early_stopping::early_stopping(int64_t patience, bool restore_best) :
+  callback_base(), m_patience(patience), m_restore_best(restore_best) {}
 
 /// Monitor the objective function to see if the validation score
 /// continues to improve
@@ -52,6 +52,7 @@ void early_stopping::on_validation_end(model *m) {
     }
     m_last_score = score;
     m_wait = 0;
+    if (m_restore_best) { m_best.save(*m); }
   } else {
     if (m_wait >= m_patience) {
       c.set_terminate_training(true);
@@ -66,12 +67,23 @@ void early_stopping::on_validation_end(model *m) {
   }
 }
 
+void early_stopping::on_train_end(model *m) {
+  if (!m_restore_best || m_best.empty()) { return; }
+  if (m->get_comm()->am_trainer_master()) {
+    std::cout << "Model " << m->get_comm()->get_trainer_rank() <<
+      " early stopping: restoring weights with score " << m_last_score <<
+      std::endl;
+  }
+  m_best.restore(*m);
+  m_best.clear();
+}
+
 std::unique_ptr<callback_base>
 build_early_stopping_callback_from_pbuf(
   const google::protobuf::Message& proto_msg, const std::shared_ptr<lbann_summary>&) {
   const auto& params =
     dynamic_cast<const lbann_data::Callback::CallbackEarlyStopping&>(proto_msg);
-  return make_unique<early_stopping>(params.patience());
+  return make_unique<early_stopping>(params.patience(), params.restore_best());
 }
 
 } // namespace callback
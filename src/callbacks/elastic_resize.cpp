@@ -0,0 +1,184 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/callbacks/elastic_resize.hpp"
+#include "lbann/models/model.hpp"
+#include "lbann/optimizers/adam.hpp"
+#include "lbann/optimizers/sgd.hpp"
+#include "lbann/utils/exception.hpp"
+#include "lbann/utils/memory.hpp"
+#include "lbann/weights/data_type_weights.hpp"
+
+#include <callbacks.pb.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace lbann {
+namespace callback {
+
+namespace {
+
+using AbsDistMatType = El::AbstractDistMatrix<DataType>;
+
+/** Copy a distributed matrix to host memory on every process. */
+void replicate_to_host(const AbsDistMatType& x, CPUMat& host) {
+  StarMat<El::Device::CPU> replica(x.Grid(), x.Root());
+  El::Copy(x, replica);
+  El::Copy(replica.LockedMatrix(), host);
+}
+
+/** Fill @c replica, on the trainer grid, with the host copy held by
+ *  the trainer master. */
+void broadcast_from_master(lbann_comm& comm,
+                           const std::string& name,
+                           const CPUMat& host,
+                           const AbsDistMatType& like,
+                           StarMat<El::Device::CPU>& replica) {
+  if (host.Height() != like.Height() || host.Width() != like.Width()) {
+    LBANN_ERROR("saved state of \"", name, "\" is ",
+                host.Height(), " x ", host.Width(), ", but the rebuilt ",
+                "model expects ", like.Height(), " x ", like.Width());
+  }
+  replica.Resize(host.Height(), host.Width());
+  El::Copy(host, replica.Matrix());
+  comm.trainer_broadcast(0, replica.Buffer(),
+                         replica.LDim() * replica.LocalWidth());
+}
+
+} // namespace
+
+void elastic_resize::on_epoch_end(model *m) {
+  auto& comm = *m->get_comm();
+  int procs_per_trainer = 0;
+  if (comm.am_world_master()) {
+    std::ifstream in(m_request_file);
+    if (in) {
+      in >> procs_per_trainer;
+      in.close();
+      std::remove(m_request_file.c_str());
+      const int world_size = comm.get_procs_in_world();
+      if (procs_per_trainer <= 0 || world_size % procs_per_trainer != 0) {
+        LBANN_WARNING("ignoring the request in ", m_request_file, " for ",
+                      procs_per_trainer, " processes per trainer; it must ",
+                      "divide the ", world_size, " processes");
+        procs_per_trainer = 0;
+      } else if (procs_per_trainer == comm.get_procs_per_trainer()) {
+        procs_per_trainer = 0;
+      }
+    }
+  }
+  comm.world_broadcast(0, procs_per_trainer);
+  if (procs_per_trainer > 0) {
+    m_requested_procs_per_trainer = procs_per_trainer;
+    m->get_execution_context().set_terminate_training(true);
+    if (comm.am_world_master()) {
+      std::cout << "elastic resize: stopping to regroup into "
+                << comm.get_procs_in_world() / procs_per_trainer
+                << " trainers of " << procs_per_trainer << " processes"
+                << std::endl;
+    }
+  }
+}
+
+void replicated_model_state::save(model& m) {
+  m_state.clear();
+  for (const auto* w : m.get_weights()) {
+    const auto& dtw = dynamic_cast<const data_type_weights<DataType>&>(*w);
+    auto& e = m_state[w->get_name()];
+    replicate_to_host(dtw.get_values(), e.values);
+    const auto* opt = dtw.get_optimizer();
+    if (opt == nullptr) { continue; }
+    e.hyperparameters.push_back(opt->get_learning_rate());
+    if (const auto* sgd_opt = dynamic_cast<const sgd<DataType>*>(opt)) {
+      e.optimizer_state.resize(1);
+      replicate_to_host(sgd_opt->get_velocity(), e.optimizer_state[0]);
+    }
+    if (const auto* adam_opt = dynamic_cast<const adam<DataType>*>(opt)) {
+      e.optimizer_state.resize(2);
+      replicate_to_host(adam_opt->get_moment1(), e.optimizer_state[0]);
+      replicate_to_host(adam_opt->get_moment2(), e.optimizer_state[1]);
+      e.hyperparameters.push_back(adam_opt->get_current_beta1());
+      e.hyperparameters.push_back(adam_opt->get_current_beta2());
+    }
+  }
+}
+
+void replicated_model_state::restore(model& m) const {
+  auto& comm = *m.get_comm();
+  StarMat<El::Device::CPU> replica(comm.get_trainer_grid());
+  for (auto* w : m.get_weights()) {
+    const auto& it = m_state.find(w->get_name());
+    if (it == m_state.end()) {
+      LBANN_ERROR("saved model state has no weights \"", w->get_name(), "\"");
+    }
+    const auto& e = it->second;
+    auto& dtw = dynamic_cast<data_type_weights<DataType>&>(*w);
+    broadcast_from_master(comm, w->get_name(), e.values,
+                          dtw.get_values(), replica);
+    dtw.set_values(replica);
+
+    auto* opt = dtw.get_optimizer();
+    if (opt == nullptr || e.hyperparameters.empty()) { continue; }
+    auto hyperparameters = e.hyperparameters;
+    comm.trainer_broadcast(0, hyperparameters.data(), hyperparameters.size());
+    opt->set_learning_rate(hyperparameters[0]);
+    if (auto* sgd_opt = dynamic_cast<sgd<DataType>*>(opt)) {
+      if (e.optimizer_state.size() == 1) {
+        broadcast_from_master(comm, w->get_name(), e.optimizer_state[0],
+                              sgd_opt->get_velocity(), replica);
+        El::Copy(replica, sgd_opt->get_velocity());
+      }
+    }
+    if (auto* adam_opt = dynamic_cast<adam<DataType>*>(opt)) {
+      if (e.optimizer_state.size() == 2 && hyperparameters.size() == 3) {
+        broadcast_from_master(comm, w->get_name(), e.optimizer_state[0],
+                              adam_opt->get_moment1(), replica);
+        El::Copy(replica, adam_opt->get_moment1());
+        broadcast_from_master(comm, w->get_name(), e.optimizer_state[1],
+                              adam_opt->get_moment2(), replica);
+        El::Copy(replica, adam_opt->get_moment2());
+        adam_opt->set_current_beta1(hyperparameters[1]);
+        adam_opt->set_current_beta2(hyperparameters[2]);
+      }
+    }
+  }
+}
+
+std::unique_ptr<callback_base>
+build_elastic_resize_callback_from_pbuf(
+  const google::protobuf::Message& proto_msg, std::shared_ptr<lbann_summary> const&) {
+  const auto& params =
+    dynamic_cast<const lbann_data::Callback::CallbackElasticResize&>(proto_msg);
+  if (params.request_file().empty()) {
+    LBANN_ERROR("the elastic resize callback needs a request file");
+  }
+  return make_unique<elastic_resize>(params.request_file());
+}
+
+} // namespace callback
+} // namespace lbann
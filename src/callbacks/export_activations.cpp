@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/callbacks/export_activations.hpp"
+#include "lbann/layers/data_type_layer.hpp"
+#include "lbann/layers/io/input/generic_input_layer.hpp"
+#include "lbann/proto/proto_common.hpp"
+#include "lbann/utils/trainer_file_utils.hpp"
+#include "shard_writer.hpp"
+
+#include <callbacks.pb.h>
+
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+namespace lbann {
+namespace callback {
+
+struct export_activations::shard {
+  std::string file_base;
+  std::ofstream data;
+  std::ofstream indices;
+  std::vector<int> dims;
+  El::Int num_samples = 0;
+};
+
+namespace {
+
+/** Sample indices of the current mini-batch on this rank. */
+const El::Matrix<El::Int>* get_sample_indices(model& m) {
+  for (auto* l : m.get_layers()) {
+    if (dynamic_cast<generic_input_layer<DataType>*>(l) != nullptr) {
+      return l->get_sample_indices_per_mb();
+    }
+  }
+  return nullptr;
+}
+
+} // namespace <anon>
+
+export_activations::export_activations(std::set<std::string> layer_names,
+                                       std::string directory)
+  : callback_base(),
+    m_layer_names(std::move(layer_names)),
+    m_directory(std::move(directory)) {
+  if (m_layer_names.empty()) {
+    LBANN_ERROR("callback \"", this->name(), "\" needs at least one layer");
+  }
+  if (m_directory.empty()) { m_directory = "./"; }
+  if (m_directory.back() != '/') { m_directory += "/"; }
+}
+
+void export_activations::on_test_begin(model* m) {
+  file::trainer_master_make_directory(m_directory, m->get_comm());
+  m_shards.clear();
+  if (m_writer == nullptr) { m_writer = std::make_shared<shard_writer>(); }
+}
+
+void export_activations::on_evaluate_forward_prop_end(model* m, Layer* l) {
+  const auto& c = m->get_execution_context();
+  if (c.get_execution_mode() != execution_mode::testing) { return; }
+  if (m_layer_names.count(l->get_name()) == 0) { return; }
+  if (m_writer == nullptr) { return; }
+
+  const auto& dtl = dynamic_cast<const data_type_layer<DataType>&>(*l);
+  const auto& mat = dtl.get_activations();
+  const auto& dist = mat.DistData();
+  if (dist.colDist != El::STAR || dist.rowDist != El::VC) {
+    LBANN_ERROR("callback \"", this->name(), "\" can only export ",
+                "data-parallel outputs, but layer \"", l->get_name(), "\" ",
+                "has a different data layout");
+  }
+
+  // Sample indices of local columns
+  const auto* mb_indices = get_sample_indices(*m);
+  const El::Int local_width = mat.LocalWidth();
+  if (mb_indices == nullptr || mb_indices->Height() < local_width) {
+    LBANN_ERROR("callback \"", this->name(), "\" could not get ",
+                "sample indices for layer \"", l->get_name(), "\"");
+  }
+  auto indices = std::make_shared<std::vector<std::int64_t>>(local_width);
+  for (El::Int j = 0; j < local_width; ++j) {
+    (*indices)[j] = mb_indices->CRef(j, 0);
+  }
+
+  // Open output files on first use
+  auto& s = m_shards[l->get_name()];
+  if (s == nullptr) {
+    s = std::make_shared<shard>();
+    s->file_base = (m_directory + m->get_name() + "_" + l->get_name()
+                    + "_rank" + std::to_string(m->get_comm()->get_rank_in_trainer()));
+    s->data.open(s->file_base + ".bin", std::ios::binary);
+    s->indices.open(s->file_base + ".idx", std::ios::binary);
+    if (!s->data.is_open() || !s->indices.is_open()) {
+      LBANN_ERROR("failed to open output files (", s->file_base, ".bin/.idx)");
+    }
+    s->dims = dtl.get_output_dims();
+  }
+
+  // Append records in the background
+  std::shared_ptr<shard> out = s;
+  m_writer->queue(mat, [out, indices](const CPUMat& data) {
+      const El::Int height = data.Height();
+      for (El::Int col = 0; col < data.Width(); ++col) {
+        out->data.write(reinterpret_cast<const char*>(data.LockedBuffer(0, col)),
+                        height * sizeof(DataType));
+      }
+      out->indices.write(reinterpret_cast<const char*>(indices->data()),
+                         indices->size() * sizeof(std::int64_t));
+      if (!out->data || !out->indices) {
+        LBANN_ERROR("failed to write to ", out->file_base, ".bin/.idx");
+      }
+      out->num_samples += data.Width();
+    });
+}
+
+void export_activations::on_test_end(model* m) {
+  if (m_writer == nullptr) { return; }
+  m_writer->wait();
+  for (auto& entry : m_shards) {
+    auto& s = *entry.second;
+    s.data.close();
+    s.indices.close();
+    std::ofstream meta(s.file_base + ".meta");
+    if (!meta.is_open()) {
+      LBANN_ERROR("failed to open output file (", s.file_base, ".meta)");
+    }
+    meta << "dims:";
+    for (const auto& d : s.dims) { meta << " " << d; }
+    meta << "\n"
+         << "samples: " << s.num_samples << "\n"
+         << "value_size: " << sizeof(DataType) << "\n";
+  }
+  m_shards.clear();
+}
+
+std::unique_ptr<callback_base>
+build_export_activations_callback_from_pbuf(
+  const google::protobuf::Message& proto_msg, const std::shared_ptr<lbann_summary>&) {
+  const auto& params =
+    dynamic_cast<const lbann_data::Callback::CallbackExportActivations&>(proto_msg);
+  return make_unique<export_activations>(
+    parse_set<std::string>(params.layers()),
+    params.directory());
+}
+
+} // namespace callback
+} // namespace lbann
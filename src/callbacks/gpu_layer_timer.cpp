@@ -0,0 +1,230 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/callbacks/gpu_layer_timer.hpp"
+
+#include "lbann/execution_contexts/sgd_execution_context.hpp"
+#include "lbann/utils/memory.hpp"
+
+#include <callbacks.pb.h>
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace lbann {
+namespace callback {
+
+gpu_layer_timer& gpu_layer_timer::operator=(const gpu_layer_timer& other) {
+  callback_base::operator=(other);
+#ifdef LBANN_HAS_GPU
+  release_events();
+#endif // LBANN_HAS_GPU
+  m_lag = other.m_lag;
+  m_step = 0;
+  m_region_names.clear();
+  m_region_index.clear();
+  m_region_times.clear();
+  return *this;
+}
+
+gpu_layer_timer::~gpu_layer_timer() {
+#ifdef LBANN_HAS_GPU
+  release_events();
+#endif // LBANN_HAS_GPU
+}
+
+void gpu_layer_timer::setup(model *m) {
+#ifndef LBANN_HAS_GPU
+  if (m->get_comm()->am_world_master()) {
+    LBANN_WARNING("LBANN was built without GPU support, "
+                  "so the GPU layer timer callback does nothing");
+  }
+#endif // LBANN_HAS_GPU
+}
+
+size_t gpu_layer_timer::get_region(const std::string& name) {
+  auto it = m_region_index.find(name);
+  if (it == m_region_index.end()) {
+    it = m_region_index.emplace(name, m_region_names.size()).first;
+    m_region_names.push_back(name);
+    m_region_times.push_back(0.0);
+  }
+  return it->second;
+}
+
+#ifdef LBANN_HAS_GPU
+
+cudaEvent_t gpu_layer_timer::get_event() {
+  if (!m_free_events.empty()) {
+    auto event = m_free_events.back();
+    m_free_events.pop_back();
+    return event;
+  }
+  cudaEvent_t event;
+  CHECK_CUDA(cudaEventCreate(&event));
+  return event;
+}
+
+void gpu_layer_timer::begin_region(const std::string& name) {
+  const auto region = get_region(name);
+  auto& r = m_open[region];
+  r.region = region;
+  r.step = m_step;
+  r.begin = get_event();
+  r.end = nullptr;
+  CHECK_CUDA(cudaEventRecord(r.begin, El::GPUManager::Stream()));
+}
+
+void gpu_layer_timer::end_region(const std::string& name) {
+  const auto region = get_region(name);
+  auto it = m_open.find(region);
+  if (it == m_open.end()) { return; }
+  auto r = it->second;
+  m_open.erase(it);
+  r.end = get_event();
+  CHECK_CUDA(cudaEventRecord(r.end, El::GPUManager::Stream()));
+  m_pending.push_back(r);
+}
+
+void gpu_layer_timer::resolve(bool blocking) {
+  while (!m_pending.empty()) {
+    auto& r = m_pending.front();
+    if (!blocking) {
+      // Events are recorded on one stream, so later events cannot
+      // complete before earlier ones
+      if (r.step + m_lag > m_step) { break; }
+      const auto status = cudaEventQuery(r.end);
+      if (status == cudaErrorNotReady) { break; }
+      CHECK_CUDA(status);
+    } else {
+      CHECK_CUDA(cudaEventSynchronize(r.end));
+    }
+    float ms = 0.f;
+    CHECK_CUDA(cudaEventElapsedTime(&ms, r.begin, r.end));
+    m_region_times[r.region] += ms;
+    m_free_events.push_back(r.begin);
+    m_free_events.push_back(r.end);
+    m_pending.pop_front();
+  }
+}
+
+void gpu_layer_timer::release_events() {
+  for (const auto& r : m_pending) {
+    m_free_events.push_back(r.begin);
+    m_free_events.push_back(r.end);
+  }
+  for (const auto& kv : m_open) {
+    m_free_events.push_back(kv.second.begin);
+  }
+  m_pending.clear();
+  m_open.clear();
+  for (auto& event : m_free_events) {
+    cudaEventDestroy(event);
+  }
+  m_free_events.clear();
+}
+
+#endif // LBANN_HAS_GPU
+
+void gpu_layer_timer::on_batch_end(model *m) {
+  ++m_step;
+#ifdef LBANN_HAS_GPU
+  resolve(false);
+#endif // LBANN_HAS_GPU
+}
+
+void gpu_layer_timer::on_epoch_end(model *m) {
+#ifdef LBANN_HAS_GPU
+  resolve(true);
+#endif // LBANN_HAS_GPU
+  const auto& c = static_cast<sgd_execution_context&>(m->get_execution_context());
+  auto& comm = *m->get_comm();
+  if (comm.am_trainer_master() && m_step > 0 && !m_region_names.empty()) {
+    std::stringstream msg;
+    msg << m->get_name() << " (instance " << comm.get_trainer_rank() << ") "
+        << "training epoch " << c.get_epoch()-1 << " "
+        << "mean GPU time per mini-batch :\n";
+    for (size_t i = 0; i < m_region_names.size(); ++i) {
+      msg << "  " << m_region_names[i] << " : "
+          << std::fixed << std::setprecision(3)
+          << m_region_times[i] / m_step << "ms\n";
+    }
+    std::cout << msg.str() << std::flush;
+  }
+  m_step = 0;
+  for (auto& t : m_region_times) { t = 0.0; }
+}
+
+void gpu_layer_timer::on_forward_prop_begin(model *m, Layer *l) {
+#ifdef LBANN_HAS_GPU
+  if (l->using_gpus()) { begin_region("fp-" + l->get_name()); }
+#endif // LBANN_HAS_GPU
+}
+
+void gpu_layer_timer::on_forward_prop_end(model *m, Layer *l) {
+#ifdef LBANN_HAS_GPU
+  if (l->using_gpus()) { end_region("fp-" + l->get_name()); }
+#endif // LBANN_HAS_GPU
+}
+
+void gpu_layer_timer::on_backward_prop_begin(model *m, Layer *l) {
+#ifdef LBANN_HAS_GPU
+  if (l->using_gpus()) { begin_region("bp-" + l->get_name()); }
+#endif // LBANN_HAS_GPU
+}
+
+void gpu_layer_timer::on_backward_prop_end(model *m, Layer *l) {
+#ifdef LBANN_HAS_GPU
+  if (l->using_gpus()) { end_region("bp-" + l->get_name()); }
+#endif // LBANN_HAS_GPU
+}
+
+void gpu_layer_timer::on_optimize_begin(model *m, weights *w) {
+#ifdef LBANN_HAS_GPU
+  begin_region("opt-" + w->get_name());
+#endif // LBANN_HAS_GPU
+}
+
+void gpu_layer_timer::on_optimize_end(model *m, weights *w) {
+#ifdef LBANN_HAS_GPU
+  end_region("opt-" + w->get_name());
+#endif // LBANN_HAS_GPU
+}
+
+std::unique_ptr<callback_base>
+build_gpu_layer_timer_callback_from_pbuf(
+  const google::protobuf::Message& proto_msg, std::shared_ptr<lbann_summary> const&) {
+  const auto& params =
+    dynamic_cast<const lbann_data::Callback::CallbackGPULayerTimer&>(proto_msg);
+  return make_unique<gpu_layer_timer>(
+    params.lag() > 0 ? params.lag() : 2);
+}
+
+} // namespace callback
+} // namespace lbann
@@ -26,6 +26,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lbann/callbacks/gpu_memory_usage.hpp"
+#include "lbann/utils/gpu_allocator.hpp"
 #include <iomanip>
 #include <sstream>
 
@@ -89,6 +90,44 @@ void gpu_memory_usage::on_epoch_begin(model *m) {
   } else {
     comm->trainer_gather(used, comm->get_trainer_master());
   }
+
+  // Statistics of the caching allocator, maximized over the trainer
+  if (cuda::caching_allocator::enabled()) {
+    const auto stats = cuda::caching_allocator::instance().get_statistics();
+    const auto& trainer_comm = comm->get_trainer_comm();
+    const auto to_gib = [&](size_t bytes) {
+      return comm->allreduce(bytes / 1024.0 / 1024.0 / 1024.0,
+                             trainer_comm, El::mpi::MAX);
+    };
+    const auto live = to_gib(stats.live_bytes);
+    const auto cached = to_gib(stats.cached_bytes);
+    const auto peak = to_gib(stats.peak_live_bytes);
+    const auto fragmentation = comm->allreduce(stats.fragmentation(),
+                                               trainer_comm, El::mpi::MAX);
+    const auto mallocs = comm->allreduce(double(stats.num_mallocs),
+                                         trainer_comm, El::mpi::MAX);
+    const auto reuse = comm->allreduce(
+      stats.num_allocations > 0
+      ? double(stats.num_reuses) / stats.num_allocations : 0.0,
+      trainer_comm, El::mpi::MIN);
+    if (comm->am_trainer_master()) {
+      std::stringstream ss;
+      ss << "Model " << comm->get_trainer_rank()
+         << " GPU caching allocator statistics (max over ranks) : "
+         << std::setprecision(3)
+         << live << " GiB live, "
+         << std::setprecision(3)
+         << cached << " GiB cached, "
+         << std::setprecision(3)
+         << peak << " GiB peak, "
+         << std::setprecision(3)
+         << 100 * fragmentation << "% fragmentation, "
+         << static_cast<size_t>(mallocs) << " cudaMalloc calls, "
+         << std::setprecision(3)
+         << 100 * reuse << "% min reuse" << std::endl;
+      std::cout << ss.str();
+    }
+  }
 #endif
 }
 
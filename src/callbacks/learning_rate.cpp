@@ -47,6 +47,55 @@
 namespace lbann {
 namespace callback {
 
+#ifdef LBANN_HAS_GPU
+void local_squared_norms_gpu(const GPUMat& x, const GPUMat& y, GPUMat& result);
+#endif // LBANN_HAS_GPU
+
+namespace {
+
+/** Norms of two matrices with the same distribution.
+ *  Both local sums of squares go through one allreduce and, on GPU,
+ *  one device-to-host copy.
+ */
+std::pair<DataType, DataType> fused_norms(
+  const El::AbstractDistMatrix<DataType>& x,
+  const El::AbstractDistMatrix<DataType>& y,
+  lbann_comm& comm) {
+  if (!(x.DistData() == y.DistData())) {
+    return {El::Nrm2(x), El::Nrm2(y)};
+  }
+  CPUMat sums(2, 1);
+  switch (x.GetLocalDevice()) {
+  case El::Device::CPU:
+    {
+      const auto& x_local = static_cast<const CPUMat&>(x.LockedMatrix());
+      const auto& y_local = static_cast<const CPUMat&>(y.LockedMatrix());
+      sums(0, 0) = El::Dot(x_local, x_local);
+      sums(1, 0) = El::Dot(y_local, y_local);
+      comm.allreduce(sums, x.DistComm());
+    }
+    break;
+#ifdef LBANN_HAS_GPU
+  case El::Device::GPU:
+    {
+      GPUMat sums_d;
+      sums_d.SetMemoryMode(1); // Use CUB GPU memory pool
+      sums_d.Resize(2, 1);
+      local_squared_norms_gpu(static_cast<const GPUMat&>(x.LockedMatrix()),
+                              static_cast<const GPUMat&>(y.LockedMatrix()),
+                              sums_d);
+      comm.allreduce(sums_d, x.DistComm());
+      El::Copy(sums_d, sums);
+    }
+    break;
+#endif // LBANN_HAS_GPU
+  default: LBANN_ERROR("invalid device");
+  }
+  return {El::Sqrt(sums(0, 0)), El::Sqrt(sums(1, 0))};
+}
+
+} // namespace
+
 float learning_rate::m_cur_global_lr = 0.0f;
 
 learning_rate::learning_rate() {}
@@ -310,8 +359,10 @@ optimizerwise_adaptive_learning_rate(
 float optimizerwise_adaptive_learning_rate::optimizer_schedule(
   model *m, optimizer &opt) {
   auto& dto = dynamic_cast<data_type_optimizer<DataType>&>(opt);
-  DataType param_norm = El::Nrm2(dto.get_weights().get_values());
-  DataType param_grad_norm = El::Nrm2(dto.get_gradient());
+  const auto& dtw = static_cast<const data_type_weights<DataType>&>(dto.get_weights());
+  const auto norms = fused_norms(dtw.get_values(), dto.get_gradient(), dtw.get_comm());
+  DataType param_norm = norms.first;
+  DataType param_grad_norm = norms.second;
   if (param_norm > DataType(0) && param_grad_norm > DataType(0)) {
     // TODO: Should incorporate weight decay, etc. here.
     return optimizerwise_adaptive_learning_rate::get_current_global_learning_rate()
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/base.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <algorithm>
+
+namespace lbann {
+namespace callback {
+
+namespace {
+
+/**
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: (height*width / bsize) x 1 x 1
+ */
+template <size_t bsize>
+__global__ void squared_norms_kernel(El::Int height,
+                                     El::Int width,
+                                     const DataType* __restrict__ x,
+                                     El::Int x_ldim,
+                                     const DataType* __restrict__ y,
+                                     El::Int y_ldim,
+                                     DataType* __restrict__ result) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int num_threads = blockDim.x * gridDim.x;
+  DataType x_sum = DataType(0), y_sum = DataType(0);
+  for (El::Int pos = gid; pos < height * width; pos += num_threads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    const auto& xi = x[row + col * x_ldim];
+    const auto& yi = y[row + col * y_ldim];
+    x_sum += xi * xi;
+    y_sum += yi * yi;
+  }
+  x_sum = cuda::block_reduce<bsize,1,1>(x_sum);
+  __syncthreads(); // Shared workspace is reused
+  y_sum = cuda::block_reduce<bsize,1,1>(y_sum);
+  if (threadIdx.x == 0) {
+    cuda::atomic_add(&result[0], x_sum);
+    cuda::atomic_add(&result[1], y_sum);
+  }
+}
+
+} // namespace <anon>
+
+void local_squared_norms_gpu(const GPUMat& x, const GPUMat& y, GPUMat& result) {
+  El::Zero(result);
+  const El::Int height = x.Height();
+  const El::Int width = x.Width();
+  if (height == 0 || width == 0) { return; }
+  constexpr El::Int block_size = 256;
+  const El::Int grid_size = std::min((height * width + block_size - 1) / block_size,
+                                     El::Int(65535));
+  squared_norms_kernel<block_size><<<grid_size, block_size, 0, El::GPUManager::Stream()>>>(
+    height, width,
+    x.LockedBuffer(), x.LDim(),
+    y.LockedBuffer(), y.LDim(),
+    result.Buffer());
+  CHECK_CUDA(cudaGetLastError());
+}
+
+} // namespace callback
+} // namespace lbann
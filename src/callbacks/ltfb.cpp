@@ -26,6 +26,7 @@
 
 #include "lbann/callbacks/ltfb.hpp"
 #include "lbann/callbacks/imcomm.hpp"
+#include "lbann/utils/options.hpp"
 #include "lbann/utils/random.hpp"
 #include "lbann/optimizers/sgd.hpp"
 #include "lbann/optimizers/adam.hpp"
@@ -97,10 +98,66 @@ El::Int get_partner_trainer(lbann_comm& comm,
 /// See @c lbann::callbacks::ltfb::communication_algorithm::sendrecv_weights
 namespace sendrecv_weights {
 
+/** @brief Exchange local matrices with the partner process.
+ *
+ *  Contiguous GPU matrices are exchanged directly between device
+ *  buffers with non-blocking NCCL sendrecvs when Aluminum supports
+ *  it, so the transfers of all matrices overlap. Other matrices are
+ *  exchanged with blocking sendrecvs. Received values can only be
+ *  used after @c finish.
+ */
+template <typename TensorDataType>
+class matrix_exchanger {
+public:
+  matrix_exchanger(lbann_comm& comm, El::Int partner_rank_in_world)
+    : m_comm(comm), m_partner(partner_rank_in_world) {}
+  ~matrix_exchanger() { finish(); }
+
+  void exchange(const El::AbstractMatrix<TensorDataType>& send,
+                El::AbstractMatrix<TensorDataType>& recv) {
+#if defined(LBANN_HAS_GPU) && defined(LBANN_HAS_ALUMINUM) && defined(AL_HAS_NCCL)
+    if (send.GetDevice() == El::Device::GPU
+        && recv.GetDevice() == El::Device::GPU
+        && send.Contiguous() && recv.Contiguous()) {
+      using GPUMatType = El::Matrix<TensorDataType, El::Device::GPU>;
+      auto& recv_gpu = static_cast<GPUMatType&>(recv);
+      const auto& syncinfo = El::SyncInfoFromMatrix(recv_gpu);
+      m_requests.emplace_back();
+      ::Al::NonblockingSendRecv<::Al::NCCLBackend>(
+        send.LockedBuffer(), send.Height() * send.Width(), m_partner,
+        recv.Buffer(), recv.Height() * recv.Width(), m_partner,
+        m_comm.get_world_comm().template GetComm<::Al::NCCLBackend>(syncinfo),
+        m_requests.back());
+      return;
+    }
+#endif // defined(LBANN_HAS_GPU) && defined(LBANN_HAS_ALUMINUM) && defined(AL_HAS_NCCL)
+    El::SendRecv(send, recv, m_comm.get_world_comm(), m_partner, m_partner);
+  }
+
+  /** Wait for all exchanges to complete. */
+  void finish() {
+#if defined(LBANN_HAS_GPU) && defined(LBANN_HAS_ALUMINUM) && defined(AL_HAS_NCCL)
+    for (auto& req : m_requests) {
+      ::Al::Wait<::Al::NCCLBackend>(req);
+    }
+    m_requests.clear();
+#endif // defined(LBANN_HAS_GPU) && defined(LBANN_HAS_ALUMINUM) && defined(AL_HAS_NCCL)
+  }
+
+private:
+  lbann_comm& m_comm;
+  El::Int m_partner;
+#if defined(LBANN_HAS_GPU) && defined(LBANN_HAS_ALUMINUM) && defined(AL_HAS_NCCL)
+  std::vector<typename ::Al::NCCLBackend::req_type> m_requests;
+#endif // defined(LBANN_HAS_GPU) && defined(LBANN_HAS_ALUMINUM) && defined(AL_HAS_NCCL)
+};
+
 /** @param weights_names    Names of weights to exchange. If empty,
  *                          then all weights are exchanged.
  *  @param send_weights     Weights values sent to partner.
  *  @param recv_weights     Weights values recieved from partner.
+ *  @param exchange_optimizer_state Whether to exchange optimizer
+ *                          state along with weights values.
  */
 template <typename TensorDataType>
 void exchange_models(lbann_comm& comm,
@@ -108,13 +165,15 @@ void exchange_models(lbann_comm& comm,
                      const std::set<std::string>& weights_names,
                      const std::vector<data_type_weights<TensorDataType>*>& send_weights,
                      std::vector<data_type_weights<TensorDataType>*>& recv_weights,
-                     bool exchange_hyperparameters) {
+                     bool exchange_hyperparameters,
+                     bool exchange_optimizer_state) {
 
   // Get partner process
   const El::Int rank_in_trainer = comm.get_rank_in_trainer();
   const El::Int procs_per_trainer = comm.get_procs_per_trainer();
   const El::Int partner_rank_in_world = (partner_trainer * procs_per_trainer
                                          + rank_in_trainer);
+  matrix_exchanger<TensorDataType> exchanger(comm, partner_rank_in_world);
 
   // Exchange weights with partner
   for (size_t i = 0; i < send_weights.size(); ++i) {
@@ -126,11 +185,9 @@ void exchange_models(lbann_comm& comm,
             != weights_names.end())) {
 
       // Exchange weights values
-      El::SendRecv(send.get_values().LockedMatrix(),
-                   recv.get_values().Matrix(),
-                   comm.get_world_comm(),
-                   partner_rank_in_world,
-                   partner_rank_in_world);
+      exchanger.exchange(send.get_values().LockedMatrix(),
+                         recv.get_values().Matrix());
+      if (!exchange_optimizer_state) { continue; }
 
       // Exchange optimizer state
       const auto* send_opt = send.get_optimizer();
@@ -153,11 +210,8 @@ void exchange_models(lbann_comm& comm,
           recv_sgd->set_momentum(std::get<1>(hyperparameters));
           recv_sgd->set_nesterov(std::get<2>(hyperparameters));
         }
-        El::SendRecv(send_sgd->get_velocity().LockedMatrix(),
-                     recv_sgd->get_velocity().Matrix(),
-                     comm.get_world_comm(),
-                     partner_rank_in_world,
-                     partner_rank_in_world);
+        exchanger.exchange(send_sgd->get_velocity().LockedMatrix(),
+                           recv_sgd->get_velocity().Matrix());
       }
       const auto* send_adam = dynamic_cast<const adam<TensorDataType>*>(send_opt);
       auto* recv_adam = dynamic_cast<adam<TensorDataType>*>(recv_opt);
@@ -184,20 +238,15 @@ void exchange_models(lbann_comm& comm,
           recv_adam->set_current_beta1(std::get<4>(hyperparameters));
           recv_adam->set_current_beta2(std::get<5>(hyperparameters));
         }
-        El::SendRecv(send_adam->get_moment1().LockedMatrix(),
-                     recv_adam->get_moment1().Matrix(),
-                     comm.get_world_comm(),
-                     partner_rank_in_world,
-                     partner_rank_in_world);
-        El::SendRecv(send_adam->get_moment2().LockedMatrix(),
-                     recv_adam->get_moment2().Matrix(),
-                     comm.get_world_comm(),
-                     partner_rank_in_world,
-                     partner_rank_in_world);
+        exchanger.exchange(send_adam->get_moment1().LockedMatrix(),
+                           recv_adam->get_moment1().Matrix());
+        exchanger.exchange(send_adam->get_moment2().LockedMatrix(),
+                           recv_adam->get_moment2().Matrix());
       }
 
     }
   }
+  exchanger.finish();
 
 }
 
@@ -304,6 +353,18 @@ void restore_local_model(lbann_comm& comm,
 
 } // namespace checkpoint_file
 
+/** Get mean metric value from the last validation pass. */
+EvalType get_validation_metric(model& m, const std::string& metric_name) {
+  for (const auto& met : m.get_metrics()) {
+    if (met->name() == metric_name) {
+      return met->get_mean_value(execution_mode::validation);
+    }
+  }
+  LBANN_ERROR("could not find metric \"",metric_name,"\" ",
+              "in model \"",m.get_name(),"\"");
+  return EvalType(0);
+}
+
 /** Get mean metric value with validation set. */
 EvalType evaluate(model& m, const std::string& metric_name) {
   auto& c = m.get_execution_context();
@@ -319,19 +380,7 @@ EvalType evaluate(model& m, const std::string& metric_name) {
   c.get_trainer().evaluate(&m, execution_mode::validation);
 
   // Get metric value
-  bool found_metric = false;
-  EvalType metric_value = 0;
-  for (const auto& met : m.get_metrics()) {
-    if (met->name() == metric_name) {
-      found_metric = true;
-      metric_value = met->get_mean_value(execution_mode::validation);
-      break;
-    }
-  }
-  if (!found_metric) {
-    LBANN_ERROR("could not find metric \"",metric_name,"\" ",
-                "in model \"",m.get_name(),"\"");
-  }
+  const auto metric_value = get_validation_metric(m, metric_name);
 
   // Mark the data store as loaded - Note that this is a temporary fix
   // for the current use of the tournament
@@ -343,6 +392,28 @@ EvalType evaluate(model& m, const std::string& metric_name) {
 
 }
 
+/** Weights as data_type_weights. */
+template <typename WeightsList>
+std::vector<data_type_weights<DataType>*> get_data_type_weights(const WeightsList& weights_list) {
+  std::vector<data_type_weights<DataType>*> dtw_list;
+  dtw_list.reserve(weights_list.size());
+  for (const auto& w : weights_list) {
+    auto* dtw = dynamic_cast<data_type_weights<DataType>*>(&*w);
+    if (dtw == nullptr) {
+      LBANN_ERROR("Detected bad weights");
+    }
+    dtw_list.push_back(dtw);
+  }
+  return dtw_list;
+}
+
+void copy_weights(const std::vector<data_type_weights<DataType>*>& src,
+                  const std::vector<data_type_weights<DataType>*>& dst) {
+  for (size_t i = 0; i < src.size(); ++i) {
+    *dst[i] = *src[i];
+  }
+}
+
 } // namespace <anon>
 
 ltfb::ltfb(El::Int batch_interval,
@@ -351,23 +422,36 @@ ltfb::ltfb(El::Int batch_interval,
            bool low_score_wins,
            communication_algorithm comm_algo,
            const std::string& ckpt_basedir,
-           bool exchange_hyperparameters)
-  : callback_base(batch_interval),
+           bool exchange_hyperparameters,
+           bool exchange_optimizer_state,
+           El::Int async_evaluation_steps)
+  : callback_base(async_evaluation_steps > 0 ? 1 : batch_interval),
+    m_tournament_interval(batch_interval),
     m_metric_name(std::move(metric_name)),
     m_weights_names(std::move(weights_names)),
     m_low_score_wins(low_score_wins),
     m_comm_algo(comm_algo),
     m_ckpt_basedir(ckpt_basedir),
-    m_exchange_hyperparameters(exchange_hyperparameters) {}
+    m_exchange_hyperparameters(exchange_hyperparameters),
+    m_exchange_optimizer_state(exchange_optimizer_state),
+    m_async_evaluation_steps(async_evaluation_steps) {}
 
 ltfb::ltfb(const ltfb& other) :
   callback_base(other),
+  m_tournament_interval(other.m_tournament_interval),
   m_metric_name(other.m_metric_name),
   m_weights_names(other.m_weights_names),
   m_low_score_wins(other.m_low_score_wins),
   m_comm_algo(other.m_comm_algo),
   m_ckpt_basedir(other.m_ckpt_basedir),
-  m_exchange_hyperparameters(other.m_exchange_hyperparameters) {
+  m_exchange_hyperparameters(other.m_exchange_hyperparameters),
+  m_exchange_optimizer_state(other.m_exchange_optimizer_state),
+  m_async_evaluation_steps(other.m_async_evaluation_steps),
+  m_async_phase(other.m_async_phase),
+  m_async_partner(other.m_async_partner),
+  m_async_partner_score(other.m_async_partner_score),
+  m_async_local_score(other.m_async_local_score),
+  m_async_decision_pending(other.m_async_decision_pending) {
 
   // Deep copy
   m_workspace_weights.clear();
@@ -375,6 +459,11 @@ ltfb::ltfb(const ltfb& other) :
   for (const auto& w : other.m_workspace_weights) {
     m_workspace_weights.emplace_back(w->copy());
   }
+  m_stash_weights.clear();
+  m_stash_weights.reserve(other.m_stash_weights.size());
+  for (const auto& w : other.m_stash_weights) {
+    m_stash_weights.emplace_back(w->copy());
+  }
 
 }
 
@@ -382,12 +471,20 @@ ltfb& ltfb::operator=(const ltfb& other) {
   callback_base::operator=(other);
 
   // Shallow copies
+  m_tournament_interval = other.m_tournament_interval;
   m_metric_name = other.m_metric_name;
   m_weights_names = other.m_weights_names;
   m_low_score_wins = other.m_low_score_wins;
   m_comm_algo = other.m_comm_algo;
   m_ckpt_basedir = other.m_ckpt_basedir;
   m_exchange_hyperparameters = other.m_exchange_hyperparameters;
+  m_exchange_optimizer_state = other.m_exchange_optimizer_state;
+  m_async_evaluation_steps = other.m_async_evaluation_steps;
+  m_async_phase = other.m_async_phase;
+  m_async_partner = other.m_async_partner;
+  m_async_partner_score = other.m_async_partner_score;
+  m_async_local_score = other.m_async_local_score;
+  m_async_decision_pending = other.m_async_decision_pending;
 
   // Deep copy
   m_workspace_weights.clear();
@@ -395,6 +492,11 @@ ltfb& ltfb::operator=(const ltfb& other) {
   for (const auto& w : other.m_workspace_weights) {
     m_workspace_weights.emplace_back(w->copy());
   }
+  m_stash_weights.clear();
+  m_stash_weights.reserve(other.m_stash_weights.size());
+  for (const auto& w : other.m_stash_weights) {
+    m_stash_weights.emplace_back(w->copy());
+  }
 
   return *this;
 }
@@ -408,6 +510,22 @@ void ltfb::setup(model *m) {
   for (const auto& w : model_weights) {
     m_workspace_weights.emplace_back(w->copy());
   }
+  m_stash_weights.clear();
+  if (m_async_evaluation_steps > 0) {
+    m_stash_weights.reserve(model_weights.size());
+    for (const auto& w : model_weights) {
+      m_stash_weights.emplace_back(w->copy());
+    }
+    if (m_comm_algo != communication_algorithm::sendrecv_weights) {
+      LBANN_ERROR("asynchronous LTFB evaluation requires the "
+                  "sendrecv_weights communication algorithm");
+    }
+    if (options::get()->has_int("interleaved_validation_steps")
+        && options::get()->get_int("interleaved_validation_steps") > 0) {
+      LBANN_ERROR("asynchronous LTFB evaluation can not be combined "
+                  "with --interleaved_validation_steps");
+    }
+  }
 
   // Make sure model does not have inter-trainer communication callback
   for (auto&& cb : m->get_callbacks()) {
@@ -441,6 +559,7 @@ void ltfb::on_batch_begin(model *m) {
   const auto mode = c.get_execution_mode();
   const auto step = c.get_step();
   if (mode != execution_mode::training || step == 0) { return; }
+  if (step % m_tournament_interval != 0) { return; }
 
   // Print message
   const auto message_prefix = (std::string{} + "LTFB ("
@@ -451,6 +570,11 @@ void ltfb::on_batch_begin(model *m) {
     std::cout << message_prefix + "starting tournament...\n";
   }
 
+  if (m_async_evaluation_steps > 0) {
+    start_async_tournament(*m, message_prefix);
+    return;
+  }
+
   // Determine partner model for tournament
   const El::Int local_trainer = comm.get_trainer_rank();
   const El::Int partner_trainer = get_partner_trainer(comm, message_prefix);
@@ -489,7 +613,8 @@ void ltfb::on_batch_begin(model *m) {
                                       m_weights_names,
                                       local_weights,
                                       model_weights,
-                                      m_exchange_hyperparameters);
+                                      m_exchange_hyperparameters,
+                                      m_exchange_optimizer_state);
     break;
   case communication_algorithm::checkpoint_file:
     checkpoint_file::exchange_models(comm,
@@ -544,6 +669,130 @@ void ltfb::on_batch_begin(model *m) {
   }
 }
 
+void ltfb::on_batch_end(model *m) {
+  const auto& c = m->get_execution_context();
+  if (m_async_evaluation_steps <= 0
+      || c.get_execution_mode() != execution_mode::training) {
+    return;
+  }
+  continue_async_evaluation(*m, m_async_evaluation_steps);
+}
+
+void ltfb::on_train_end(model *m) {
+  while (m_async_phase != async_phase::none) {
+    continue_async_evaluation(*m, 0);
+  }
+}
+
+void ltfb::start_async_tournament(model& m, const std::string& message_prefix) {
+  auto&& comm = *m.get_comm();
+  const El::Int local_trainer = comm.get_trainer_rank();
+  const auto local_weights = get_data_type_weights(m_workspace_weights);
+  const auto model_weights = get_data_type_weights(m.get_weights());
+
+  // Finish evaluating the last tournament
+  while (m_async_phase != async_phase::none) {
+    continue_async_evaluation(m, 0);
+  }
+
+  // Apply the last tournament's decision
+  // Note: The winning trainer has kept training since the
+  // tournament began, so its current model is taken.
+  if (m_async_decision_pending) {
+    copy_weights(model_weights, local_weights);
+    sendrecv_weights::exchange_models(comm,
+                                      m_async_partner,
+                                      m_weights_names,
+                                      local_weights,
+                                      model_weights,
+                                      m_exchange_hyperparameters,
+                                      m_exchange_optimizer_state);
+    El::Int tournament_winner = m_async_partner;
+    if ((m_low_score_wins && m_async_local_score <= m_async_partner_score) ||
+        (!m_low_score_wins && m_async_local_score >= m_async_partner_score)) {
+      tournament_winner = local_trainer;
+      copy_weights(local_weights, model_weights);
+    }
+    if (comm.am_trainer_master()) {
+      std::stringstream msg;
+      msg << message_prefix
+          << "trainer " << local_trainer << " "
+          << "selected model from trainer " << tournament_winner
+          << " (trainer " << local_trainer << " score "
+          << "= " << m_async_local_score << ", "
+          << "trainer " << m_async_partner << " score "
+          << "= " << m_async_partner_score << ")" << "\n";
+      std::cout << msg.str();
+    }
+    m_async_decision_pending = false;
+  }
+
+  // Exchange models with new partner and start evaluating the
+  // partner model on a snapshot
+  m_async_partner = get_partner_trainer(comm, message_prefix);
+  copy_weights(model_weights, local_weights);
+  sendrecv_weights::exchange_models(comm,
+                                    m_async_partner,
+                                    m_weights_names,
+                                    local_weights,
+                                    model_weights,
+                                    m_exchange_hyperparameters,
+                                    m_exchange_optimizer_state);
+  begin_async_evaluation(m);
+  copy_weights(local_weights, model_weights);
+  m_async_phase = async_phase::partner;
+}
+
+void ltfb::begin_async_evaluation(model& m) {
+  auto& c = m.get_execution_context();
+  auto& t = c.get_trainer();
+  const auto original_mode = c.get_execution_mode();
+  m.collect_background_data_fetch(original_mode);
+  t.begin_evaluation_on_snapshot(&m, execution_mode::validation);
+  m.reset_mode(c, original_mode);
+  t.get_data_coordinator().reset_mode(c);
+}
+
+void ltfb::continue_async_evaluation(model& m, El::Int num_batches) {
+  if (m_async_phase == async_phase::none) { return; }
+  auto& c = m.get_execution_context();
+  auto& t = c.get_trainer();
+  const auto original_mode = c.get_execution_mode();
+
+  // Evaluate a few mini-batches on the snapshot
+  // Note: Marking the data store is a temporary fix for the current
+  // use of the tournament.
+  m.collect_background_data_fetch(original_mode);
+  m.mark_data_store_explicitly_loading(execution_mode::validation);
+  const bool finished = t.evaluate_on_snapshot(&m, execution_mode::validation,
+                                               num_batches);
+  if (finished) {
+    m.make_data_store_preloaded(execution_mode::validation);
+  }
+  m.reset_mode(c, original_mode);
+  t.get_data_coordinator().reset_mode(c);
+  if (!finished) { return; }
+
+  // Record score
+  const auto score = get_validation_metric(m, m_metric_name);
+  if (m_async_phase == async_phase::partner) {
+    // Evaluate the local model from the start of the tournament
+    m_async_partner_score = score;
+    const auto local_weights = get_data_type_weights(m_workspace_weights);
+    const auto stash_weights = get_data_type_weights(m_stash_weights);
+    const auto model_weights = get_data_type_weights(m.get_weights());
+    copy_weights(model_weights, stash_weights);
+    copy_weights(local_weights, model_weights);
+    begin_async_evaluation(m);
+    copy_weights(stash_weights, model_weights);
+    m_async_phase = async_phase::local;
+  } else {
+    m_async_local_score = score;
+    m_async_decision_pending = true;
+    m_async_phase = async_phase::none;
+  }
+}
+
 typename ltfb::communication_algorithm
 ltfb::string_to_comm_algo(const std::string& str) {
   if (str.empty() || str == "sendrecv_weights") {
@@ -567,6 +816,23 @@ std::string ltfb::get_ckpt_basedir() const {
   return m_ckpt_basedir;
 }
 
+void ltfb_exchange_weights(
+  lbann_comm& comm,
+  El::Int partner_trainer,
+  const std::set<std::string>& weights_names,
+  const std::vector<data_type_weights<DataType>*>& send_weights,
+  std::vector<data_type_weights<DataType>*>& recv_weights,
+  bool exchange_hyperparameters,
+  bool exchange_optimizer_state) {
+  sendrecv_weights::exchange_models(comm,
+                                    partner_trainer,
+                                    weights_names,
+                                    send_weights,
+                                    recv_weights,
+                                    exchange_hyperparameters,
+                                    exchange_optimizer_state);
+}
+
 std::unique_ptr<callback_base>
 build_ltfb_callback_from_pbuf(
   const google::protobuf::Message& proto_msg,
@@ -580,7 +846,9 @@ build_ltfb_callback_from_pbuf(
     params.low_score_wins(),
     ltfb::string_to_comm_algo(params.communication_algorithm()),
     params.checkpoint_basedir(),
-    params.exchange_hyperparameters());
+    params.exchange_hyperparameters(),
+    !params.skip_optimizer_state(),
+    params.async_evaluation_steps());
 }
 
 } // namespace callback
@@ -0,0 +1,197 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/callbacks/memory_accounting.hpp"
+
+#include "lbann/execution_contexts/sgd_execution_context.hpp"
+#include "lbann/optimizers/optimizer.hpp"
+#include "lbann/utils/memory.hpp"
+#include "lbann/weights/weights.hpp"
+#ifdef LBANN_HAS_CUDNN
+#include "lbann/utils/cudnn.hpp"
+#endif // LBANN_HAS_CUDNN
+
+#include <callbacks.pb.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace lbann {
+namespace callback {
+
+namespace {
+
+#ifdef LBANN_HAS_GPU
+constexpr El::Device tracked_device = El::Device::GPU;
+#else
+constexpr El::Device tracked_device = El::Device::CPU;
+#endif // LBANN_HAS_GPU
+
+std::string format_mib(size_t bytes) {
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(1) << bytes / (1024. * 1024.) << " MiB";
+  return ss.str();
+}
+
+} // namespace
+
+std::string memory_accounting::to_string(category c) {
+  switch (c) {
+  case category::activations:   return "activations";
+  case category::error_signals: return "error signals";
+  case category::data:          return "data";
+  case category::weights:       return "weights";
+  case category::optimizer:     return "optimizer";
+  case category::workspace:     return "workspace";
+  case category::tensor_arena:  return "tensor arena";
+  }
+  return "unknown";
+}
+
+void memory_accounting::sample(model& m, const std::string& phase) {
+  const auto& c = static_cast<sgd_execution_context&>(m.get_execution_context());
+  if (c.get_execution_mode() != execution_mode::training) { return; }
+
+  std::vector<std::pair<owner, size_t>> usage;
+  const auto& add = [&usage] (category cat, const std::string& name, size_t bytes) {
+    if (bytes > 0) { usage.emplace_back(owner(cat, name), bytes); }
+  };
+  for (const auto* l : m.get_layers()) {
+    // Layers without parents hold mini-batches from the data reader
+    add(l->get_num_parents() == 0 ? category::data : category::activations,
+        l->get_name(), l->get_activations_memory_usage(tracked_device));
+    add(category::error_signals, l->get_name(),
+        l->get_error_signals_memory_usage(tracked_device));
+  }
+  for (const auto* w : m.get_weights()) {
+    add(category::weights, w->get_name(), w->get_memory_usage(tracked_device));
+    const auto* opt = w->get_optimizer();
+    if (opt != nullptr) {
+      add(category::optimizer, w->get_name(),
+          opt->get_memory_usage(tracked_device));
+    }
+  }
+  add(category::tensor_arena, m.get_name(),
+      m.get_tensor_arena_size(tracked_device));
+#ifdef LBANN_HAS_CUDNN
+  add(category::workspace, "cuDNN", cudnn::get_workspace_size());
+#endif // LBANN_HAS_CUDNN
+
+  // Update peaks
+  size_t total = 0;
+  std::map<category, size_t> category_usage;
+  const std::pair<owner, size_t>* largest = nullptr;
+  for (const auto& u : usage) {
+    auto& peak = m_owner_peaks[u.first];
+    peak = std::max(peak, u.second);
+    category_usage[u.first.first] += u.second;
+    total += u.second;
+    if (largest == nullptr || u.second > largest->second) { largest = &u; }
+  }
+  for (const auto& cu : category_usage) {
+    auto& peak = m_category_peaks[cu.first];
+    peak = std::max(peak, cu.second);
+  }
+
+  // Record high-water mark
+  if (total > m_high_water && largest != nullptr) {
+    m_high_water = total;
+    size_t device_used = 0;
+#ifdef LBANN_HAS_GPU
+    size_t available, device_total;
+    FORCE_CHECK_CUDA(cudaMemGetInfo(&available, &device_total));
+    device_used = device_total - available;
+#endif // LBANN_HAS_GPU
+    m_high_water_marks.push_back({c.get_epoch(), c.get_step(), phase,
+                                  total, device_used,
+                                  largest->first, largest->second});
+  }
+}
+
+void memory_accounting::on_epoch_end(model *m) {
+  auto& comm = *m->get_comm();
+  if (comm.am_trainer_master()) {
+    const std::string prefix =
+      m->get_name() + " (instance " + std::to_string(comm.get_trainer_rank())
+      + ") ";
+    std::stringstream msg;
+
+    msg << prefix << "peak "
+        << (tracked_device == El::Device::CPU ? "host" : "GPU")
+        << " memory by category :\n";
+    for (const auto& cp : m_category_peaks) {
+      msg << "  " << to_string(cp.first) << " : "
+          << format_mib(cp.second) << "\n";
+    }
+
+    std::vector<std::pair<owner, size_t>> owners(m_owner_peaks.begin(),
+                                                 m_owner_peaks.end());
+    std::sort(owners.begin(), owners.end(),
+              [](const std::pair<owner, size_t>& a,
+                 const std::pair<owner, size_t>& b) {
+                return a.second > b.second;
+              });
+    msg << prefix << "peak memory of largest owners :\n";
+    for (size_t i = 0; i < std::min(m_num_owners, owners.size()); ++i) {
+      const auto& o = owners[i];
+      msg << "  " << o.first.second << " (" << to_string(o.first.first)
+          << ") : " << format_mib(o.second) << "\n";
+    }
+
+    if (!m_high_water_marks.empty()) {
+      msg << prefix << "memory high-water marks :\n";
+      for (const auto& h : m_high_water_marks) {
+        msg << "  epoch " << h.epoch << " step " << h.step
+            << " after " << h.phase << " : "
+            << format_mib(h.tracked) << " tracked";
+        if (h.device_used > 0) {
+          msg << ", " << format_mib(h.device_used) << " in use on device";
+        }
+        msg << ", largest " << h.largest.second
+            << " (" << to_string(h.largest.first) << ") "
+            << format_mib(h.largest_bytes) << "\n";
+      }
+    }
+    std::cout << msg.str() << std::flush;
+  }
+  m_high_water_marks.clear();
+}
+
+std::unique_ptr<callback_base>
+build_memory_accounting_callback_from_pbuf(
+  const google::protobuf::Message& proto_msg, std::shared_ptr<lbann_summary> const&) {
+  const auto& params =
+    dynamic_cast<const lbann_data::Callback::CallbackMemoryAccounting&>(proto_msg);
+  return make_unique<memory_accounting>(
+    params.batch_interval() > 0 ? params.batch_interval() : 1,
+    params.num_owners() > 0 ? params.num_owners() : 20);
+}
+
+} // namespace callback
+} // namespace lbann
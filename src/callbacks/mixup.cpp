@@ -34,11 +34,130 @@
 
 #include <callbacks.pb.h>
 
+#include <cmath>
+#include <numeric>
+#include <random>
 #include <unordered_set>
 
 namespace lbann {
 namespace callback {
 
+void mixup::make_plan(El::Int mbsize, El::Int height, El::Int width,
+                      CPUMat& plan) const {
+  auto& gen = get_fast_generator();
+  beta_distribution<float> dist(m_alpha, m_alpha);
+  std::uniform_int_distribution<El::Int> row_dist(0, std::max(height-1, El::Int(0)));
+  std::uniform_int_distribution<El::Int> col_dist(0, std::max(width-1, El::Int(0)));
+
+  // Decide how to mix the mini-batch.
+  std::vector<El::Int> shuffled_indices(mbsize);
+  std::iota(shuffled_indices.begin(), shuffled_indices.end(), 0);
+  std::shuffle(shuffled_indices.begin(), shuffled_indices.end(), gen);
+
+  const El::Int num_holes = m_cutout_holes;
+  const El::Int length = m_cutout_length;
+  plan.Resize(mixup_plan_header_size + 4*num_holes, mbsize);
+  for (El::Int i = 0; i < mbsize; ++i) {
+    const El::Int j = shuffled_indices[i];
+    float lambda = 1.0f;
+    El::Int box[4] = {0, 0, 0, 0};
+    if (i != j) {
+      lambda = dist(gen);
+      lambda = std::max(lambda, 1.0f - lambda);
+      if (m_cutmix) {
+        // Box covering a 1-lambda fraction of the image, clipped to
+        // the image, then lambda from the clipped area
+        const float side = std::sqrt(1.0f - lambda);
+        const El::Int cut_h = height * side;
+        const El::Int cut_w = width * side;
+        const El::Int center_y = row_dist(gen);
+        const El::Int center_x = col_dist(gen);
+        box[0] = std::max(center_y - cut_h / 2, El::Int(0));
+        box[1] = std::max(center_x - cut_w / 2, El::Int(0));
+        box[2] = std::min(center_y + cut_h / 2, height);
+        box[3] = std::min(center_x + cut_w / 2, width);
+        lambda = 1.0f - (float((box[2] - box[0]) * (box[3] - box[1]))
+                         / float(height * width));
+      }
+    }
+    plan(0, i) = j;
+    plan(1, i) = lambda;
+    for (El::Int k = 0; k < 4; ++k) {
+      plan(2+k, i) = box[k];
+    }
+    for (El::Int h = 0; h < num_holes; ++h) {
+      const El::Int y0 = std::max(row_dist(gen) - length / 2, El::Int(0));
+      const El::Int x0 = std::max(col_dist(gen) - length / 2, El::Int(0));
+      const El::Int row = mixup_plan_header_size + 4*h;
+      plan(row, i) = y0;
+      plan(row+1, i) = x0;
+      plan(row+2, i) = std::min(y0 + length, height);
+      plan(row+3, i) = std::min(x0 + length, width);
+    }
+  }
+}
+
+namespace {
+
+/** Whether (y, x) is in a (y0, x0, y1, x1) box in column i of plan. */
+bool in_box(const CPUMat& plan, El::Int row, El::Int i, El::Int y, El::Int x) {
+  return (y >= plan(row, i) && y < plan(row+2, i)
+          && x >= plan(row+1, i) && x < plan(row+3, i));
+}
+
+/** Apply a mixup plan to a mini-batch on the CPU. */
+void apply_mixup_plan_cpu(const CPUMat& plan, El::Int num_holes,
+                          El::Int image_height, El::Int image_width,
+                          const CPUMat& samples_in, const CPUMat& labels_in,
+                          CPUMat& samples, CPUMat& labels,
+                          bool cutmix) {
+  const El::Int mbsize = samples.Width();
+  const El::Int samples_height = samples.Height();
+  const El::Int labels_height = labels.Height();
+  const El::Int image_size = image_height * image_width;
+  LBANN_OMP_PARALLEL_FOR
+  for (El::Int i = 0; i < mbsize; ++i) {
+    const El::Int j = plan(0, i);
+    if (i == j && num_holes == 0) {
+      continue;
+    }
+    const float lambda = plan(1, i);
+    const float lambda_sub = 1.0f - lambda;
+    const DataType* __restrict__ x1_buf = samples_in.LockedBuffer(0, i);
+    const DataType* __restrict__ x2_buf = samples_in.LockedBuffer(0, j);
+    DataType* __restrict__ x = samples.Buffer(0, i);
+    for (El::Int k = 0; k < samples_height; ++k) {
+      const El::Int pos = image_size > 0 ? k % image_size : 0;
+      const El::Int py = image_width > 0 ? pos / image_width : 0;
+      const El::Int px = image_width > 0 ? pos % image_width : 0;
+      DataType value = x1_buf[k];
+      if (i != j) {
+        if (!cutmix) {
+          value = lambda*x1_buf[k] + lambda_sub*x2_buf[k];
+        } else if (in_box(plan, 2, i, py, px)) {
+          value = x2_buf[k];
+        }
+      }
+      for (El::Int h = 0; h < num_holes; ++h) {
+        if (in_box(plan, mixup_plan_header_size + 4*h, i, py, px)) {
+          value = DataType(0);
+        }
+      }
+      x[k] = value;
+    }
+    if (i != j) {
+      const DataType* __restrict__ y1_buf = labels_in.LockedBuffer(0, i);
+      const DataType* __restrict__ y2_buf = labels_in.LockedBuffer(0, j);
+      DataType* __restrict__ y = labels.Buffer(0, i);
+      for (El::Int k = 0; k < labels_height; ++k) {
+        y[k] = lambda*y1_buf[k] + lambda_sub*y2_buf[k];
+      }
+    }
+  }
+}
+
+} // namespace
+
 void mixup::on_forward_prop_end(model *m, Layer *l) {
   if (!m_layers.count(l->get_name())) {
     return;
@@ -52,53 +171,56 @@ void mixup::on_forward_prop_end(model *m, Layer *l) {
   auto* dtl = dynamic_cast<data_type_layer<DataType>*>(l);
   auto& samples_orig = dtl->get_local_activations(0);
   auto& labels_orig = dtl->get_local_activations(1);
-  if (samples_orig.GetDevice() != El::Device::CPU ||
-      labels_orig.GetDevice() != El::Device::CPU) {
-    LBANN_ERROR("Mixup requires CPU data.");
+  if (samples_orig.GetDevice() != labels_orig.GetDevice()) {
+    LBANN_ERROR("Mixup requires samples and labels on the same device.");
   }
-  // Copy samples.
-  // Assumes data are on CPU.
-  CPUMat samples, labels;
-  El::Copy(samples_orig, samples);
-  El::Copy(labels_orig, labels);
-  El::Int mbsize = samples.Width();
-  const El::Int samples_height = samples.Height();
-  const El::Int labels_height = labels.Height();
-  auto& gen = get_fast_generator();
-  beta_distribution<float> dist(m_alpha, m_alpha);
 
-  // For now, data must be on the CPU.
-  if (samples.GetDevice() != El::Device::CPU ||
-      labels.GetDevice() != El::Device::CPU) {
-    LBANN_ERROR("mixup only works with CPU data");
+  // Images are (channels, height, width) tensors
+  El::Int image_height = 0, image_width = 0;
+  const auto dims = l->get_output_dims(0);
+  if (dims.size() == 3) {
+    image_height = dims[1];
+    image_width = dims[2];
+  } else if (m_cutmix || m_cutout_holes > 0) {
+    LBANN_ERROR("cutmix and cutout require image data "
+                "(\"", l->get_name(), "\" has ", dims.size(), "-D outputs)");
   }
 
-  // Decide how to mix the mini-batch.
-  std::vector<El::Int> shuffled_indices(mbsize);
-  std::iota(shuffled_indices.begin(), shuffled_indices.end(), 0);
-  std::shuffle(shuffled_indices.begin(), shuffled_indices.end(), gen);
+  CPUMat plan;
+  make_plan(samples_orig.Width(), image_height, image_width, plan);
 
-  LBANN_OMP_PARALLEL_FOR
-  for (El::Int i = 0; i < mbsize; ++i) {
-    const El::Int j = shuffled_indices[i];
-    if (i == j) {
-      continue;
-    }
-    float lambda = dist(gen);
-    lambda = std::max(lambda, 1.0f - lambda);
-    const float lambda_sub = 1.0f - lambda;
-    const DataType* __restrict__ x1_buf = samples.LockedBuffer(0, i);
-    const DataType* __restrict__ x2_buf = samples.LockedBuffer(0, j);
-    DataType* __restrict__ x = samples_orig.Buffer(0, i);
-    const DataType* __restrict__ y1_buf = labels.LockedBuffer(0, i);
-    const DataType* __restrict__ y2_buf = labels.LockedBuffer(0, j);
-    DataType* __restrict__ y = labels_orig.Buffer(0, i);
-    for (El::Int k = 0; k < samples_height; ++k) {
-      x[k] = lambda*x1_buf[k] + lambda_sub*x2_buf[k];
+  switch (samples_orig.GetDevice()) {
+  case El::Device::CPU:
+    {
+      // Mix from a copy of the mini-batch
+      CPUMat samples, labels;
+      El::Copy(samples_orig, samples);
+      El::Copy(labels_orig, labels);
+      apply_mixup_plan_cpu(plan, m_cutout_holes, image_height, image_width,
+                           samples, labels,
+                           static_cast<CPUMat&>(samples_orig),
+                           static_cast<CPUMat&>(labels_orig),
+                           m_cutmix);
     }
-    for (El::Int k = 0; k < labels_height; ++k) {
-      y[k] = lambda*y1_buf[k] + lambda_sub*y2_buf[k];
+    break;
+#ifdef LBANN_HAS_GPU
+  case El::Device::GPU:
+    {
+      GPUMat plan_gpu, samples, labels;
+      El::Copy(plan, plan_gpu);
+      El::Copy(samples_orig, samples);
+      El::Copy(labels_orig, labels);
+      apply_mixup_plan_gpu(plan_gpu, m_cutout_holes,
+                           image_height, image_width,
+                           samples, labels,
+                           static_cast<GPUMat&>(samples_orig),
+                           static_cast<GPUMat&>(labels_orig),
+                           m_cutmix);
     }
+    break;
+#endif // LBANN_HAS_GPU
+  default:
+    LBANN_ERROR("invalid device");
   }
 }
 
@@ -110,7 +232,8 @@ build_mixup_callback_from_pbuf(
   const auto& layers_list = parse_list<std::string>(params.layers());
   std::unordered_set<std::string> layers(layers_list.begin(),
                                          layers_list.end());
-  return make_unique<mixup>(layers, params.alpha());
+  return make_unique<mixup>(layers, params.alpha(), params.cutmix(),
+                           params.cutout_holes(), params.cutout_length());
 }
 
 } // namespace callback
@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/callbacks/mixup.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace lbann {
+namespace callback {
+
+namespace {
+
+/** Whether (y, x) is in a (y0, x0, y1, x1) box. */
+__device__ __forceinline__
+bool in_box(const DataType* __restrict__ box, El::Int y, El::Int x) {
+  return (y >= El::Int(box[0]) && y < El::Int(box[2])
+          && x >= El::Int(box[1]) && x < El::Int(box[3]));
+}
+
+/**
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: (samples_height / bsize) x mbsize x 1
+ */
+__global__ void mixup_samples_kernel(El::Int mbsize,
+                                     El::Int samples_height,
+                                     El::Int num_holes,
+                                     El::Int image_height,
+                                     El::Int image_width,
+                                     bool cutmix,
+                                     const DataType* __restrict__ plan,
+                                     El::Int plan_ldim,
+                                     const DataType* __restrict__ samples_in,
+                                     El::Int samples_in_ldim,
+                                     DataType* __restrict__ samples,
+                                     El::Int samples_ldim) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int num_threads = blockDim.x * gridDim.x;
+  const El::Int image_size = image_height * image_width;
+  for (El::Int i = blockIdx.y; i < mbsize; i += gridDim.y) {
+    const DataType* __restrict__ p = plan + i * plan_ldim;
+    const El::Int j = p[0];
+    const DataType lambda = p[1];
+    const DataType lambda_sub = DataType(1) - lambda;
+    const DataType* __restrict__ x1 = samples_in + i * samples_in_ldim;
+    const DataType* __restrict__ x2 = samples_in + j * samples_in_ldim;
+    DataType* __restrict__ x = samples + i * samples_ldim;
+    for (El::Int k = gid; k < samples_height; k += num_threads) {
+      const El::Int pos = image_size > 0 ? k % image_size : 0;
+      const El::Int py = image_width > 0 ? pos / image_width : 0;
+      const El::Int px = image_width > 0 ? pos % image_width : 0;
+      DataType value = x1[k];
+      if (i != j) {
+        if (!cutmix) {
+          value = lambda * x1[k] + lambda_sub * x2[k];
+        } else if (in_box(p + 2, py, px)) {
+          value = x2[k];
+        }
+      }
+      for (El::Int h = 0; h < num_holes; ++h) {
+        if (in_box(p + mixup_plan_header_size + 4*h, py, px)) {
+          value = DataType(0);
+        }
+      }
+      x[k] = value;
+    }
+  }
+}
+
+/**
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: (labels_height / bsize) x mbsize x 1
+ */
+__global__ void mixup_labels_kernel(El::Int mbsize,
+                                    El::Int labels_height,
+                                    const DataType* __restrict__ plan,
+                                    El::Int plan_ldim,
+                                    const DataType* __restrict__ labels_in,
+                                    El::Int labels_in_ldim,
+                                    DataType* __restrict__ labels,
+                                    El::Int labels_ldim) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int num_threads = blockDim.x * gridDim.x;
+  for (El::Int i = blockIdx.y; i < mbsize; i += gridDim.y) {
+    const DataType* __restrict__ p = plan + i * plan_ldim;
+    const El::Int j = p[0];
+    if (i == j) { continue; }
+    const DataType lambda = p[1];
+    const DataType lambda_sub = DataType(1) - lambda;
+    const DataType* __restrict__ y1 = labels_in + i * labels_in_ldim;
+    const DataType* __restrict__ y2 = labels_in + j * labels_in_ldim;
+    DataType* __restrict__ y = labels + i * labels_ldim;
+    for (El::Int k = gid; k < labels_height; k += num_threads) {
+      y[k] = lambda * y1[k] + lambda_sub * y2[k];
+    }
+  }
+}
+
+/** Grid dimensions for a kernel over a matrix's columns. */
+dim3 mixup_grid_dims(El::Int height, El::Int width, El::Int block_size) {
+  dim3 grid_dims;
+  grid_dims.x = std::min((height + block_size - 1) / block_size,
+                         El::Int(std::numeric_limits<uint32_t>::max()));
+  grid_dims.y = std::min(width, El::Int(65535));
+  return grid_dims;
+}
+
+} // namespace <anon>
+
+void apply_mixup_plan_gpu(const GPUMat& plan, El::Int num_holes,
+                          El::Int image_height, El::Int image_width,
+                          const GPUMat& samples_in, const GPUMat& labels_in,
+                          GPUMat& samples, GPUMat& labels,
+                          bool cutmix) {
+  const El::Int mbsize = samples.Width();
+  if (mbsize == 0) { return; }
+  constexpr El::Int block_size = 256;
+  auto stream = El::GPUManager::Stream();
+  if (samples.Height() > 0) {
+    mixup_samples_kernel
+      <<<mixup_grid_dims(samples.Height(), mbsize, block_size),
+         block_size, 0, stream>>>(
+        mbsize, samples.Height(), num_holes,
+        image_height, image_width, cutmix,
+        plan.LockedBuffer(), plan.LDim(),
+        samples_in.LockedBuffer(), samples_in.LDim(),
+        samples.Buffer(), samples.LDim());
+  }
+  if (labels.Height() > 0) {
+    mixup_labels_kernel
+      <<<mixup_grid_dims(labels.Height(), mbsize, block_size),
+         block_size, 0, stream>>>(
+        mbsize, labels.Height(),
+        plan.LockedBuffer(), plan.LDim(),
+        labels_in.LockedBuffer(), labels_in.LDim(),
+        labels.Buffer(), labels.LDim());
+  }
+  CHECK_CUDA(cudaGetLastError());
+}
+
+} // namespace callback
+} // namespace lbann
@@ -31,12 +31,55 @@
 #include "lbann/callbacks/monitor_io.hpp"
 #include "lbann/layers/io/input/generic_input_layer.hpp"
 #include "lbann/proto/proto_common.hpp"
+#include "lbann/utils/timer.hpp"
 
 #include <callbacks.pb.h>
 
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
 namespace lbann {
 namespace callback {
 
+namespace {
+
+/** Fraction of the epoch waiting on data above which training is
+ *  considered I/O-bound. */
+constexpr double io_bound_wait_fraction = 0.05;
+
+} // namespace
+
+void monitor_io::on_train_begin(model *m) {
+  io_profile::enable();
+}
+
+void monitor_io::on_train_end(model *m) {
+  io_profile::disable();
+}
+
+void monitor_io::on_epoch_begin(model *m) {
+  m_wait_start = 0;
+  m_copy_start = 0;
+  m_batches_start = 0;
+  m_queue_depth_start = 0;
+  for (const Layer *layer : m->get_layers()) {
+    if(m_layers.size() == 0
+       || m_layers.find(layer->get_name()) != m_layers.end()) {
+      auto *input = dynamic_cast<const generic_input_layer<DataType> *> (layer);
+      if(input != nullptr) {
+        const auto& stats = input->get_pipeline_stats();
+        m_wait_start += stats.wait_time;
+        m_copy_start += stats.copy_time;
+        m_batches_start += stats.num_batches;
+        m_queue_depth_start += stats.queue_depth;
+      }
+    }
+  }
+  m_threads_start = io_profile::snapshot();
+  m_epoch_start = get_time();
+}
+
 void monitor_io::on_epoch_end(model *m) {
   const auto& c = static_cast<const sgd_execution_context&>(m->get_execution_context());
   lbann_comm *comm = m->get_comm();
@@ -53,6 +96,112 @@ void monitor_io::on_epoch_end(model *m) {
       }
     }
   }
+  report_pipeline(*m);
+}
+
+void monitor_io::report_pipeline(model& m) {
+  const double epoch_time = get_time() - m_epoch_start;
+  lbann_comm *comm = m.get_comm();
+
+  // Pipeline as seen by the model
+  double wait_time = -m_wait_start, copy_time = -m_copy_start;
+  size_t num_batches = 0, queue_depth = 0;
+  bool has_input = false;
+  for (const Layer *layer : m.get_layers()) {
+    if(m_layers.size() == 0
+       || m_layers.find(layer->get_name()) != m_layers.end()) {
+      auto *input = dynamic_cast<const generic_input_layer<DataType> *> (layer);
+      if(input != nullptr) {
+        const auto& stats = input->get_pipeline_stats();
+        wait_time += stats.wait_time;
+        copy_time += stats.copy_time;
+        num_batches += stats.num_batches;
+        queue_depth += stats.queue_depth;
+        has_input = true;
+      }
+    }
+  }
+  if (!has_input || epoch_time <= 0) { return; }
+  num_batches -= m_batches_start;
+  queue_depth -= m_queue_depth_start;
+
+  // Pipeline as seen by the I/O threads
+  auto threads = io_profile::snapshot();
+  threads.resize(std::max(threads.size(), m_threads_start.size()));
+  std::vector<io_profile::thread_stats> epoch_threads;
+  io_profile::thread_stats total;
+  for (size_t i = 0; i < threads.size(); ++i) {
+    io_profile::thread_stats t = threads[i];
+    if (i < m_threads_start.size()) {
+      const auto& t0 = m_threads_start[i];
+      t.busy_time -= t0.busy_time;
+      for (size_t s = 0; s < io_profile::num_stages; ++s) {
+        t.stage_time[s] -= t0.stage_time[s];
+      }
+      t.num_samples -= t0.num_samples;
+    }
+    if (t.busy_time <= 0) { continue; }
+    total.busy_time += t.busy_time;
+    for (size_t s = 0; s < io_profile::num_stages; ++s) {
+      total.stage_time[s] += t.stage_time[s];
+    }
+    total.num_samples += t.num_samples;
+    epoch_threads.push_back(t);
+  }
+
+  std::stringstream msg;
+  msg << std::fixed << std::setprecision(3);
+  const std::string prefix =
+    "Rank " + std::to_string(comm->get_trainer_rank()) + "."
+    + std::to_string(comm->get_rank_in_trainer()) + " data pipeline ";
+  const double wait_fraction = wait_time / epoch_time;
+  msg << prefix << ": " << total.num_samples / epoch_time
+      << " samples/s fetched, model waited " << wait_time << "s on data ("
+      << 100 * wait_fraction << "% of " << epoch_time << "s), "
+      << (num_batches > 0 ? double(queue_depth) / num_batches : 0.0)
+      << " fetches queued per mini-batch, "
+      << copy_time << "s copying to activations\n";
+
+  double mean_utilization = 0;
+  for (size_t i = 0; i < epoch_threads.size(); ++i) {
+    const auto& t = epoch_threads[i];
+    const double utilization = t.busy_time / epoch_time;
+    mean_utilization += utilization / epoch_threads.size();
+    msg << prefix << "I/O thread " << i << " : "
+        << 100 * utilization << "% utilized, " << t.num_samples << " samples";
+    for (size_t s = 0; s < io_profile::num_stages; ++s) {
+      msg << ", " << io_profile::to_string(static_cast<io_profile::stage>(s))
+          << " " << t.stage_time[s] << "s";
+    }
+    msg << ", other " << t.other_time() << "s\n";
+  }
+
+  msg << prefix << "verdict : ";
+  if (wait_fraction <= io_bound_wait_fraction) {
+    msg << "compute-bound\n";
+  } else {
+    // Stage with the most time across the I/O threads
+    const char* bottleneck = "other";
+    double bottleneck_time = total.other_time();
+    for (size_t s = 0; s < io_profile::num_stages; ++s) {
+      if (total.stage_time[s] > bottleneck_time) {
+        bottleneck = io_profile::to_string(static_cast<io_profile::stage>(s));
+        bottleneck_time = total.stage_time[s];
+      }
+    }
+    msg << "I/O-bound; ";
+    if (mean_utilization < 0.5) {
+      msg << "I/O threads are " << 100 * mean_utilization
+          << "% utilized, so fetches are not issued early enough "
+          << "(consider more I/O buffers)\n";
+    } else {
+      msg << "I/O threads are " << 100 * mean_utilization
+          << "% utilized, mostly in " << bottleneck << " ("
+          << (total.busy_time > 0 ? 100 * bottleneck_time / total.busy_time : 0)
+          << "% of their time)\n";
+    }
+  }
+  std::cout << msg.str() << std::flush;
 }
 
 void monitor_io::on_test_end(model *m) {
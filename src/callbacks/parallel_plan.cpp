@@ -0,0 +1,304 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/callbacks/parallel_plan.hpp"
+
+#include "lbann/execution_contexts/sgd_execution_context.hpp"
+#include "lbann/layers/math/fused_entrywise.hpp"
+#include "lbann/trainers/trainer.hpp"
+#include "lbann/utils/memory.hpp"
+#include "lbann/utils/parallel_plan.hpp"
+#include "lbann/weights/weights.hpp"
+
+#include <callbacks.pb.h>
+#include <lbann.pb.h>
+
+#include <google/protobuf/text_format.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lbann {
+namespace callback {
+
+namespace {
+
+namespace planner = ::lbann::parallel_plan;
+
+double layer_time(const Layer& l) {
+  return l.get_fp_time() + l.get_bp_time();
+}
+
+double num_weights(const Layer& l) {
+  double n = 0;
+  for (const auto* w : extract_weights(l)) {
+    n += w->get_size();
+  }
+  return n;
+}
+
+#ifdef LBANN_HAS_DISTCONV
+bool is_spatial_type(const std::string& type) {
+  return (type == "convolution" || type == "deconvolution"
+          || type == "pooling" || type == "batch normalization"
+          || type == "ReLU" || type == "leaky ReLU" || type == "identity");
+}
+#endif // LBANN_HAS_DISTCONV
+
+/** Spatially split dimension index in the parallel strategy: height
+ *  for 2D tensors and depth for 3D tensors. */
+int spatial_groups(const ParallelStrategy& ps, size_t num_dims) {
+  return std::max(num_dims >= 4 ? ps.depth_groups : ps.height_groups, 1);
+}
+
+std::string describe(const planner::choice& c) {
+  std::string s = (c.layout == data_layout::MODEL_PARALLEL
+                   ? "model" : "data");
+  if (c.spatial_groups > 1) {
+    s += " x" + std::to_string(c.spatial_groups);
+  }
+  return s;
+}
+
+} // namespace
+
+planner::layer_info describe_layer_for_plan(const Layer& l) {
+  planner::layer_info info;
+  info.name = l.get_name();
+  info.type = l.get_type();
+  info.input_dims = (l.get_num_parents() > 0
+                     ? l.get_input_dims() : l.get_output_dims());
+  info.output_dims = l.get_output_dims();
+  info.num_weights = num_weights(l);
+  info.current.layout = l.get_data_layout();
+  info.current.spatial_groups = spatial_groups(l.get_parallel_strategy(),
+                                               info.output_dims.size());
+
+  // Forward and backward prop FLOPs per sample: a multiply-add per
+  // weight per output pixel, three times over
+  const double output_size = l.get_output_size();
+  if (info.type == "fully connected") {
+    info.flops = 6 * info.num_weights;
+  } else if ((info.type == "convolution" || info.type == "deconvolution")
+             && !info.output_dims.empty()) {
+    info.flops = 6 * info.num_weights * output_size / info.output_dims[0];
+  } else {
+    info.flops = 10 * output_size;
+  }
+
+  fused_entrywise_step<DataType> step;
+  info.model_parallel = (info.type == "fully connected"
+                         || get_fused_entrywise_op<DataType>(l, step));
+
+#ifdef LBANN_HAS_DISTCONV
+  info.spatial = (is_spatial_type(info.type)
+                  && info.input_dims.size() >= 3
+                  && info.output_dims.size() >= 3);
+#endif // LBANN_HAS_DISTCONV
+  if (info.spatial
+      && (info.type == "convolution" || info.type == "deconvolution")) {
+    // Kernel width from weights = C_out * C_in * k^d
+    const double spatial_dims = info.output_dims.size() - 1;
+    const double channels = double(info.input_dims[0]) * info.output_dims[0];
+    const double k = std::pow(info.num_weights / channels,
+                              1.0 / spatial_dims);
+    info.halo = std::max(int(std::round(k)) / 2, 0);
+  } else if (info.spatial && info.type == "pooling") {
+    info.halo = std::max(info.input_dims[1] / info.output_dims[1] / 2, 0);
+  }
+  return info;
+}
+
+void parallel_plan::on_train_begin(model *m) {
+  if (m_done) { return; }
+  const auto& layers = m->get_layers();
+  m_start_times.assign(layers.size(), 0.0);
+  m_layer_times.assign(layers.size(), 0.0);
+  m_num_steps = 0;
+  if (m_profile_steps == 0) {
+    make_plan(*m);
+  }
+}
+
+void parallel_plan::on_batch_begin(model *m) {
+  if (m_done) { return; }
+  const auto& layers = m->get_layers();
+  for (size_t i = 0; i < layers.size(); ++i) {
+    m_start_times[i] = layer_time(*layers[i]);
+  }
+}
+
+void parallel_plan::on_batch_end(model *m) {
+  if (m_done) { return; }
+  // The first step includes setup costs and is not profiled
+  if (m_num_steps++ == 0) { return; }
+  const auto& layers = m->get_layers();
+  for (size_t i = 0; i < layers.size(); ++i) {
+    // Layer counters are reset between epochs
+    m_layer_times[i] += std::max(layer_time(*layers[i]) - m_start_times[i],
+                                 0.0);
+  }
+  if (m_num_steps > m_profile_steps) {
+    make_plan(*m);
+  }
+}
+
+void parallel_plan::make_plan(model& m) {
+  m_done = true;
+  auto& comm = *m.get_comm();
+  const auto& layers = m.get_layers();
+  const auto& c = m.get_execution_context();
+  const size_t num_layers = layers.size();
+
+  // Machine description
+  planner::machine mach;
+  mach.num_procs = comm.get_procs_per_trainer();
+  mach.mini_batch_size = c.get_trainer().get_max_mini_batch_size();
+  mach.entry_size = sizeof(DataType);
+  bool using_gpus = false;
+  for (const auto* l : layers) { using_gpus = using_gpus || l->using_gpus(); }
+  mach.flop_rate = (m_flop_rate > 0 ? m_flop_rate
+                    : using_gpus ? 1e13 : 1e11);
+  if (m_bandwidth > 0) { mach.bandwidth = m_bandwidth; }
+  if (m_latency > 0) { mach.latency = m_latency; }
+
+  // Layer descriptions
+  std::unordered_map<const Layer*, size_t> index;
+  for (size_t i = 0; i < num_layers; ++i) { index[layers[i]] = i; }
+  std::vector<planner::layer_info> infos;
+  infos.reserve(num_layers);
+  for (const auto* l : layers) {
+    infos.push_back(describe_layer_for_plan(*l));
+    for (const auto* p : l->get_parent_layers()) {
+      infos.back().parents.push_back(index.at(p));
+    }
+  }
+
+  // Measured times, from the slowest process
+  if (m_profile_steps > 0 && m_num_steps > 1) {
+    std::vector<double> times(num_layers);
+    for (size_t i = 0; i < num_layers; ++i) {
+      times[i] = m_layer_times[i] / (m_num_steps - 1);
+    }
+    std::vector<double> max_times(num_layers);
+    comm.trainer_allreduce(times.data(), num_layers, max_times.data(),
+                           El::mpi::MAX);
+    for (size_t i = 0; i < num_layers; ++i) {
+      infos[i].measured_time = max_times[i];
+    }
+  }
+
+  const auto current = [&] {
+    std::vector<planner::choice> choices;
+    for (const auto& info : infos) { choices.push_back(info.current); }
+    return planner::evaluate(infos, choices, mach);
+  }();
+  const auto planned = planner::search(infos, mach);
+  if (!comm.am_world_master()) { return; }
+
+  // Report
+  const std::string prefix =
+    m.get_name() + " (instance " + std::to_string(comm.get_trainer_rank())
+    + ") parallel plan : ";
+  std::stringstream msg;
+  msg << std::scientific << std::setprecision(3);
+  msg << prefix << mach.num_procs << " processes, mini-batch size "
+      << mach.mini_batch_size
+      << (m_profile_steps > 0 ? ", profiled" : ", estimated") << "\n";
+  size_t num_changed = 0;
+  for (size_t i = 0; i < num_layers; ++i) {
+    const auto& cur = current.choices[i];
+    const auto& next = planned.choices[i];
+    if (cur != next) { ++num_changed; }
+    msg << prefix << infos[i].name << " (" << infos[i].type << ") : "
+        << describe(cur) << " -> " << describe(next)
+        << (cur != next ? " * " : "   ")
+        << current.layer_costs[i].total() + current.redistribution_costs[i]
+        << "s -> "
+        << planned.layer_costs[i].total() + planned.redistribution_costs[i]
+        << "s (compute " << planned.layer_costs[i].compute
+        << "s, comm " << planned.layer_costs[i].comm
+        << "s, redistribution " << planned.redistribution_costs[i] << "s)\n";
+  }
+  msg << prefix << "estimated step time " << current.total << "s -> "
+      << planned.total << "s, " << num_changed << " layers changed\n";
+
+  // Plan as a partial prototext
+  lbann_data::LbannPB pb;
+  auto& proto_model = *pb.mutable_model();
+  for (size_t i = 0; i < num_layers; ++i) {
+    const auto& next = planned.choices[i];
+    auto& proto_layer = *proto_model.add_layer();
+    proto_layer.set_name(infos[i].name);
+    proto_layer.set_data_layout(to_string(next.layout));
+    auto& ps = *proto_layer.mutable_parallel_strategy();
+    if (next.spatial_groups > 1) {
+      ps.set_sample_groups(mach.num_procs / next.spatial_groups);
+      if (infos[i].output_dims.size() >= 4) {
+        ps.set_depth_groups(next.spatial_groups);
+      } else {
+        ps.set_height_groups(next.spatial_groups);
+      }
+    }
+  }
+  std::string text;
+  google::protobuf::TextFormat::PrintToString(pb, &text);
+  std::ofstream fs(m_output_file);
+  if (!fs) {
+    LBANN_WARNING("parallel plan could not open ", m_output_file);
+  } else {
+    fs << "# Parallel plan for " << m.get_name()
+       << ", apply with --parallel_plan=" << m_output_file << "\n"
+       << text;
+    msg << prefix << "wrote " << m_output_file << "\n";
+  }
+  std::cout << msg.str() << std::flush;
+}
+
+std::unique_ptr<callback_base>
+build_parallel_plan_callback_from_pbuf(
+  const google::protobuf::Message& proto_msg, std::shared_ptr<lbann_summary> const&) {
+  const auto& params =
+    dynamic_cast<const lbann_data::Callback::CallbackParallelPlan&>(proto_msg);
+  return make_unique<parallel_plan>(
+    params.profile_steps(),
+    params.output_file().empty() ? "parallel_plan.prototext"
+                                 : params.output_file(),
+    params.flop_rate(),
+    params.bandwidth(),
+    params.latency());
+}
+
+} // namespace callback
+} // namespace lbann
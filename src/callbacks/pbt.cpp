@@ -0,0 +1,338 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/callbacks/pbt.hpp"
+#include "lbann/callbacks/imcomm.hpp"
+#include "lbann/callbacks/ltfb.hpp"
+#include "lbann/callbacks/perturb_adam.hpp"
+#include "lbann/callbacks/perturb_dropout.hpp"
+#include "lbann/proto/proto_common.hpp"
+#include "lbann/weights/data_type_weights.hpp"
+
+#include <callbacks.pb.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace lbann {
+namespace callback {
+
+namespace {
+
+/** Get mean metric value with validation set. */
+EvalType evaluate(model& m, const std::string& metric_name) {
+  auto& c = m.get_execution_context();
+  const auto original_mode = c.get_execution_mode();
+  m.collect_background_data_fetch(original_mode);
+  m.mark_data_store_explicitly_loading(execution_mode::validation);
+  c.get_trainer().evaluate(&m, execution_mode::validation);
+  m.make_data_store_preloaded(execution_mode::validation);
+  c.set_execution_mode(original_mode);
+  for (const auto& met : m.get_metrics()) {
+    if (met->name() == metric_name) {
+      return met->get_mean_value(execution_mode::validation);
+    }
+  }
+  LBANN_ERROR("could not find metric \"",metric_name,"\" ",
+              "in model \"",m.get_name(),"\"");
+  return EvalType(0);
+}
+
+/** Weights as data_type_weights. */
+template <typename WeightsList>
+std::vector<data_type_weights<DataType>*> get_data_type_weights(const WeightsList& weights_list) {
+  std::vector<data_type_weights<DataType>*> dtw_list;
+  dtw_list.reserve(weights_list.size());
+  for (const auto& w : weights_list) {
+    auto* dtw = dynamic_cast<data_type_weights<DataType>*>(&*w);
+    if (dtw == nullptr) {
+      LBANN_ERROR("Detected bad weights");
+    }
+    dtw_list.push_back(dtw);
+  }
+  return dtw_list;
+}
+
+} // namespace <anon>
+
+pbt::pbt(El::Int batch_interval,
+         std::string metric_name,
+         std::set<std::string> weights_names,
+         bool low_score_wins,
+         EvalType truncation_fraction)
+  : callback_base(batch_interval),
+    m_metric_name(std::move(metric_name)),
+    m_weights_names(std::move(weights_names)),
+    m_low_score_wins(low_score_wins),
+    m_truncation_fraction(truncation_fraction) {
+  if (m_truncation_fraction <= EvalType(0)
+      || m_truncation_fraction > EvalType(0.5)) {
+    LBANN_ERROR("PBT truncation fraction must be in (0, 0.5], ",
+                "but got ",m_truncation_fraction);
+  }
+}
+
+pbt::pbt(const pbt& other) :
+  callback_base(other),
+  m_metric_name(other.m_metric_name),
+  m_weights_names(other.m_weights_names),
+  m_low_score_wins(other.m_low_score_wins),
+  m_truncation_fraction(other.m_truncation_fraction),
+  m_round(other.m_round),
+  m_scores(other.m_scores),
+  m_scores_ready(other.m_scores_ready && !other.m_scores_pending) {
+
+  // Deep copy
+  m_workspace_weights.clear();
+  m_workspace_weights.reserve(other.m_workspace_weights.size());
+  for (const auto& w : other.m_workspace_weights) {
+    m_workspace_weights.emplace_back(w->copy());
+  }
+
+}
+
+pbt& pbt::operator=(const pbt& other) {
+  callback_base::operator=(other);
+
+  // Shallow copies
+  // Note: An in-flight allreduce stays with the original.
+  m_metric_name = other.m_metric_name;
+  m_weights_names = other.m_weights_names;
+  m_low_score_wins = other.m_low_score_wins;
+  m_truncation_fraction = other.m_truncation_fraction;
+  m_round = other.m_round;
+  m_scores = other.m_scores;
+  m_scores_pending = false;
+  m_scores_ready = other.m_scores_ready && !other.m_scores_pending;
+
+  // Deep copy
+  m_workspace_weights.clear();
+  m_workspace_weights.reserve(other.m_workspace_weights.size());
+  for (const auto& w : other.m_workspace_weights) {
+    m_workspace_weights.emplace_back(w->copy());
+  }
+
+  return *this;
+}
+
+void pbt::setup(model* m) {
+
+  // Create workspace objects
+  const auto& model_weights = m->get_weights();
+  m_workspace_weights.clear();
+  m_workspace_weights.reserve(model_weights.size());
+  for (const auto& w : model_weights) {
+    m_workspace_weights.emplace_back(w->copy());
+  }
+
+  // Check callbacks
+  bool has_explore = false;
+  for (auto&& cb : m->get_callbacks()) {
+    if (dynamic_cast<imcomm*>(cb) != nullptr) {
+      LBANN_ERROR("Detected both PBT and imcomm callbacks. ");
+    }
+    if (dynamic_cast<ltfb*>(cb) != nullptr) {
+      LBANN_ERROR("Detected both PBT and LTFB callbacks. ");
+    }
+    if (dynamic_cast<perturb_adam*>(cb) != nullptr
+        || dynamic_cast<perturb_dropout*>(cb) != nullptr) {
+      has_explore = true;
+    }
+  }
+  if (!has_explore && m->get_comm()->am_world_master()) {
+    LBANN_WARNING("PBT found no perturb_adam or perturb_dropout callback, "
+                  "so copied hyperparameters will not be perturbed");
+  }
+
+}
+
+void pbt::on_batch_begin(model* m) {
+  const auto& c = m->get_execution_context();
+  auto&& comm = *m->get_comm();
+
+  // Check whether to start PBT round
+  const auto mode = c.get_execution_mode();
+  const auto step = c.get_step();
+  if (mode != execution_mode::training || step == 0) { return; }
+
+  // Print message
+  const auto message_prefix = (std::string{} + "PBT ("
+                               + "model \"" + m->get_name() + "\", "
+                               + "step " + std::to_string(step)
+                               + "): ");
+
+  // Exploit and explore with the last round's scores
+  wait_for_scores(comm);
+  if (m_scores_ready) {
+    const auto donor = exploit(*m, message_prefix);
+    if (donor >= 0) {
+      explore(*m);
+    }
+    m_scores_ready = false;
+  }
+
+  // Evaluate local model and share score with other trainers
+  // Note: The allreduce completes during the next interval of
+  // training.
+  const El::Int num_trainers = comm.get_num_trainers();
+  const auto score = evaluate(*m, m_metric_name);
+  m_scores.assign(num_trainers, EvalType(0));
+  m_scores[comm.get_trainer_rank()] = score;
+  comm.nb_allreduce(m_scores.data(), num_trainers,
+                    comm.get_intertrainer_comm(), m_scores_req);
+  m_scores_pending = true;
+  if (comm.am_trainer_master()) {
+    std::stringstream msg;
+    msg << message_prefix
+        << "trainer " << comm.get_trainer_rank() << " score "
+        << "= " << score << "\n";
+    std::cout << msg.str();
+  }
+
+}
+
+void pbt::on_train_end(model* m) {
+  wait_for_scores(*m->get_comm());
+}
+
+void pbt::wait_for_scores(lbann_comm& comm) {
+  if (m_scores_pending) {
+    comm.wait(m_scores_req);
+    m_scores_pending = false;
+    m_scores_ready = true;
+  }
+}
+
+El::Int pbt::exploit(model& m, const std::string& message_prefix) {
+  auto&& comm = *m.get_comm();
+  const El::Int num_trainers = comm.get_num_trainers();
+  const El::Int local_trainer = comm.get_trainer_rank();
+  const auto round = m_round++;
+
+  // Rank trainers from best to worst
+  std::vector<El::Int> ranking(num_trainers);
+  std::iota(ranking.begin(), ranking.end(), 0);
+  std::stable_sort(ranking.begin(), ranking.end(),
+                   [this](El::Int a, El::Int b) {
+                     return (m_low_score_wins
+                             ? m_scores[a] < m_scores[b]
+                             : m_scores[a] > m_scores[b]);
+                   });
+
+  // Pair bottom trainers with randomly chosen top trainers
+  // Note: The generator is seeded with the round, so every trainer
+  // computes the same pairs.
+  const El::Int num_pairs
+    = std::min(std::max(static_cast<El::Int>(m_truncation_fraction * num_trainers),
+                        El::Int(1)),
+               num_trainers / 2);
+  if (num_pairs == 0) { return -1; }
+  std::vector<El::Int> donors(ranking.begin(), ranking.begin() + num_pairs);
+  std::mt19937 gen(static_cast<std::mt19937::result_type>(round));
+  std::shuffle(donors.begin(), donors.end(), gen);
+  El::Int partner = -1;
+  bool is_donor = false;
+  std::stringstream pairs;
+  for (El::Int i = 0; i < num_pairs; ++i) {
+    const auto& donor = donors[i];
+    const auto& recipient = ranking[num_trainers - num_pairs + i];
+    pairs << (i > 0 ? "," : "") << " " << donor << "->" << recipient;
+    if (local_trainer == donor) {
+      partner = recipient;
+      is_donor = true;
+    }
+    if (local_trainer == recipient) {
+      partner = donor;
+    }
+  }
+  if (comm.am_world_master()) {
+    std::cout << message_prefix + "copying models -" + pairs.str() + "\n";
+  }
+  if (partner < 0) { return -1; }
+
+  // Exchange model data with partner trainer
+  // Note: The donor receives into the workspace and keeps its model.
+  auto model_weights = get_data_type_weights(m.get_weights());
+  auto workspace_weights = get_data_type_weights(m_workspace_weights);
+  for (size_t i = 0; i < model_weights.size(); ++i) {
+    *workspace_weights[i] = *model_weights[i];
+  }
+  if (is_donor) {
+    ltfb_exchange_weights(comm, partner, m_weights_names,
+                          model_weights, workspace_weights,
+                          true, true);
+    return -1;
+  }
+  ltfb_exchange_weights(comm, partner, m_weights_names,
+                        workspace_weights, model_weights,
+                        true, true);
+  if (comm.am_trainer_master()) {
+    std::stringstream msg;
+    msg << message_prefix
+        << "trainer " << local_trainer << " "
+        << "copied model from trainer " << partner
+        << " (trainer " << local_trainer << " score "
+        << "= " << m_scores[local_trainer] << ", "
+        << "trainer " << partner << " score "
+        << "= " << m_scores[partner] << ")" << "\n";
+    std::cout << msg.str();
+  }
+  return partner;
+
+}
+
+void pbt::explore(model& m) {
+  for (auto&& cb : m.get_callbacks()) {
+    if (auto* cb_adam = dynamic_cast<perturb_adam*>(cb)) {
+      cb_adam->perturb(m);
+    }
+    if (auto* cb_dropout = dynamic_cast<perturb_dropout*>(cb)) {
+      cb_dropout->perturb(m);
+    }
+  }
+}
+
+std::unique_ptr<callback_base>
+build_pbt_callback_from_pbuf(
+  const google::protobuf::Message& proto_msg,
+  const std::shared_ptr<lbann_summary>&) {
+  const auto& params =
+    dynamic_cast<const lbann_data::Callback::CallbackPBT&>(proto_msg);
+  const auto& fraction = params.truncation_fraction();
+  return make_unique<pbt>(
+    params.batch_interval(),
+    params.metric(),
+    parse_set<std::string>(params.weights()),
+    params.low_score_wins(),
+    fraction > 0.0 ? fraction : 0.2);
+}
+
+} // namespace callback
+} // namespace lbann
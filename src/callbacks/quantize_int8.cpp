@@ -0,0 +1,297 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/callbacks/quantize_int8.hpp"
+#include "lbann/layers/learning/fully_connected.hpp"
+#include "lbann/metrics/metric.hpp"
+#include "lbann/proto/proto_common.hpp"
+#include "lbann/weights/data_type_weights.hpp"
+
+#include <callbacks.pb.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <iomanip>
+#include <sstream>
+
+namespace lbann {
+namespace callback {
+
+namespace {
+
+using AbsDistMatType = El::AbstractDistMatrix<DataType>;
+
+/** Largest int8 magnitude on a symmetric grid. */
+constexpr DataType int8_max = 127;
+
+bool is_quantizable(const Layer& l) {
+  return ((l.get_type() == "fully connected" || l.get_type() == "convolution")
+          && dynamic_cast<const data_type_layer<DataType>*>(&l) != nullptr);
+}
+
+template <data_layout Layout, El::Device Device>
+bool get_fully_connected_transpose(const Layer& l, bool& transpose) {
+  using LayerType = fully_connected_layer<DataType, Layout, Device>;
+  const auto* fc = dynamic_cast<const LayerType*>(&l);
+  if (fc != nullptr) { transpose = fc->is_transposed(); }
+  return fc != nullptr;
+}
+
+/** Whether a fully-connected layer stores one output per column. */
+bool is_transposed(const Layer& l) {
+  bool transpose = false;
+  if (get_fully_connected_transpose<data_layout::DATA_PARALLEL, El::Device::CPU>(l, transpose)
+      || get_fully_connected_transpose<data_layout::MODEL_PARALLEL, El::Device::CPU>(l, transpose)
+#ifdef LBANN_HAS_GPU
+      || get_fully_connected_transpose<data_layout::DATA_PARALLEL, El::Device::GPU>(l, transpose)
+      || get_fully_connected_transpose<data_layout::MODEL_PARALLEL, El::Device::GPU>(l, transpose)
+#endif // LBANN_HAS_GPU
+      ) {
+    return transpose;
+  }
+  LBANN_ERROR("could not determine weights layout of layer \"", l.get_name(), "\"");
+  return false;
+}
+
+/** Round to a symmetric int8 grid. */
+inline DataType round_to_grid(DataType x, DataType scale) {
+  const DataType q = std::round(x / scale);
+  return std::min(std::max(q, -int8_max), int8_max) * scale;
+}
+
+/** Largest entry magnitude over the trainer. */
+EvalType get_max_abs(const AbsDistMatType& x, lbann_comm& comm) {
+  std::unique_ptr<AbsDistMatType> x_cpu;
+  if (x.GetLocalDevice() != El::Device::CPU) {
+    auto dist_data = x.DistData();
+    dist_data.device = El::Device::CPU;
+    x_cpu.reset(AbsDistMatType::Instantiate(dist_data));
+    El::Copy(x, *x_cpu);
+  }
+  const auto& local = static_cast<const CPUMat&>(
+    x_cpu ? x_cpu->LockedMatrix() : x.LockedMatrix());
+  EvalType max_abs = 0;
+  for (El::Int col = 0; col < local.Width(); ++col) {
+    for (El::Int row = 0; row < local.Height(); ++row) {
+      max_abs = std::max(max_abs, EvalType(std::fabs(local(row, col))));
+    }
+  }
+  return comm.trainer_allreduce(max_abs, El::mpi::MAX);
+}
+
+/** Round entries in place to a symmetric int8 grid. */
+void round_to_grid(AbsDistMatType& x, DataType scale) {
+  std::unique_ptr<AbsDistMatType> x_cpu;
+  if (x.GetLocalDevice() != El::Device::CPU) {
+    auto dist_data = x.DistData();
+    dist_data.device = El::Device::CPU;
+    x_cpu.reset(AbsDistMatType::Instantiate(dist_data));
+    El::Copy(x, *x_cpu);
+  }
+  auto& local = static_cast<CPUMat&>(x_cpu ? x_cpu->Matrix() : x.Matrix());
+  for (El::Int col = 0; col < local.Width(); ++col) {
+    for (El::Int row = 0; row < local.Height(); ++row) {
+      local(row, col) = round_to_grid(local(row, col), scale);
+    }
+  }
+  if (x_cpu) { El::Copy(*x_cpu, x); }
+}
+
+} // namespace
+
+quantize_int8::quantize_int8(std::set<std::string> layer_names,
+                             El::Int calibration_batches)
+  : callback_base(),
+    m_layer_names(std::move(layer_names)),
+    m_calibration_batches(std::max(calibration_batches, El::Int(1))) {}
+
+void quantize_int8::setup(model* m) {
+  callback_base::setup(m);
+  std::set<std::string> quantizable;
+  for (El::Int i = 0; i < m->get_num_layers(); ++i) {
+    const auto& l = m->get_layer(i);
+    if (is_quantizable(l)) {
+      quantizable.insert(l.get_name());
+    }
+  }
+  if (m_layer_names.empty()) {
+    m_layer_names = quantizable;
+  }
+  for (const auto& name : m_layer_names) {
+    if (quantizable.count(name) == 0) {
+      LBANN_ERROR("callback \"", this->name(), "\" ",
+                  "can only quantize fully-connected and convolution layers, ",
+                  "but model \"", m->get_name(), "\" ",
+                  "has no such layer \"", name, "\"");
+    }
+  }
+}
+
+void quantize_int8::on_evaluate_forward_prop_begin(model* m, Layer* l) {
+  if (!m_quantized || m_layer_names.count(l->get_name()) == 0) { return; }
+
+  // Round input to the calibrated grid
+  const auto& range = m_input_ranges[l->get_name()];
+  if (range <= EvalType(0)) { return; }
+  // Note: Each parent output goes to one child, but views may share
+  // memory with other tensors.
+  auto& parent = dynamic_cast<data_type_layer<DataType>&>(
+    *const_cast<Layer*>(l->get_parent_layers().front()));
+  const auto& children = parent.get_child_layers();
+  const auto index = std::distance(children.begin(),
+                                   std::find(children.begin(), children.end(), l));
+  auto& input = parent.get_activations(index);
+  if (input.Viewing()) { return; }
+  round_to_grid(input, DataType(range) / int8_max);
+
+}
+
+void quantize_int8::on_evaluate_forward_prop_end(model* m, Layer* l) {
+  if (m_quantized || m_layer_names.count(l->get_name()) == 0) { return; }
+  const auto& dtl = dynamic_cast<const data_type_layer<DataType>&>(*l);
+  auto& range = m_input_ranges[l->get_name()];
+  range = std::max(range, get_max_abs(dtl.get_prev_activations(), *m->get_comm()));
+}
+
+void quantize_int8::on_evaluate_forward_prop_end(model* m) {
+  if (!m_quantized) { ++m_num_calibrated_batches; }
+}
+
+void quantize_int8::quantize_weights(model& m) {
+  using StarMatType = El::DistMatrix<DataType, El::STAR, El::STAR, El::ELEMENT, El::Device::CPU>;
+  std::ostringstream msg;
+  msg << "model \"" << m.get_name() << "\": int8 quantization of "
+      << m_layer_names.size() << " layers\n";
+  for (El::Int i = 0; i < m.get_num_layers(); ++i) {
+    auto& l = m.get_layer(i);
+    if (m_layer_names.count(l.get_name()) == 0) { continue; }
+    auto& w = dynamic_cast<data_type_weights<DataType>&>(*l.get_weights().front());
+
+    // Entry (row,col) belongs to output channel (col) if by_column,
+    // otherwise (row / rows_per_channel)
+    // Note: Convolution kernels are column vectors packed with the
+    // output channel slowest.
+    StarMatType values(w.get_values().Grid(), w.get_values().Root());
+    El::Copy(w.get_values(), values);
+    auto& local = values.Matrix();
+    bool by_column = false;
+    El::Int rows_per_channel = 1;
+    El::Int num_channels = local.Height();
+    if (l.get_type() == "convolution") {
+      num_channels = l.get_output_dims().front();
+      rows_per_channel = local.Height() / num_channels;
+    } else if (is_transposed(l)) {
+      by_column = true;
+      num_channels = local.Width();
+    }
+    const auto channel = [&](El::Int row, El::Int col) -> El::Int {
+      return by_column ? col : row / rows_per_channel;
+    };
+
+    // Per-channel scales
+    std::vector<DataType> scales(num_channels, DataType(0));
+    for (El::Int col = 0; col < local.Width(); ++col) {
+      for (El::Int row = 0; row < local.Height(); ++row) {
+        auto& scale = scales[channel(row, col)];
+        scale = std::max(scale, DataType(std::fabs(local(row, col))));
+      }
+    }
+    for (auto& scale : scales) {
+      scale = (scale > DataType(0) ? scale / int8_max : DataType(1));
+    }
+
+    // Round weights and measure relative error
+    EvalType error = 0, norm = 0;
+    for (El::Int col = 0; col < local.Width(); ++col) {
+      for (El::Int row = 0; row < local.Height(); ++row) {
+        auto& x = local(row, col);
+        const auto q = round_to_grid(x, scales[channel(row, col)]);
+        error += EvalType(x - q) * EvalType(x - q);
+        norm += EvalType(x) * EvalType(x);
+        x = q;
+      }
+    }
+    w.set_values(values);
+    msg << "  " << l.get_name() << " (" << l.get_type() << "): "
+        << num_channels << " channels, relative weights error "
+        << (norm > EvalType(0) ? std::sqrt(error / norm) : EvalType(0))
+        << ", input range " << m_input_ranges[l.get_name()] << "\n";
+  }
+  if (m.get_comm()->am_trainer_master()) {
+    std::cout << msg.str() << std::flush;
+  }
+}
+
+void quantize_int8::end_evaluation(model& m) {
+  const auto& mode = m.get_execution_context().get_execution_mode();
+  const auto& metrics = m.get_metrics();
+  auto& sums = m_quantized ? m_int8_metrics : m_fp32_metrics;
+  sums.resize(metrics.size(), EvalType(0));
+  for (size_t i = 0; i < metrics.size(); ++i) {
+    sums[i] += metrics[i]->get_mean_value(mode);
+  }
+
+  // Quantize once calibration is done
+  if (!m_quantized) {
+    ++m_num_fp32_evaluations;
+    if (m_num_calibrated_batches >= m_calibration_batches) {
+      quantize_weights(m);
+      m_quantized = true;
+    }
+    return;
+  }
+
+  // Report metrics against fp32 model
+  ++m_num_int8_evaluations;
+  if (m.get_comm()->am_trainer_master()) {
+    std::ostringstream msg;
+    for (size_t i = 0; i < metrics.size(); ++i) {
+      const auto& fp32 = m_fp32_metrics[i] / m_num_fp32_evaluations;
+      const auto& int8 = m_int8_metrics[i] / m_num_int8_evaluations;
+      msg << m.get_name() << " (int8) " << metrics[i]->name() << " : "
+          << int8 << metrics[i]->get_unit() << " "
+          << "(fp32 " << fp32 << metrics[i]->get_unit() << ", "
+          << "difference " << std::showpos << int8 - fp32
+          << std::noshowpos << metrics[i]->get_unit() << ")\n";
+    }
+    std::cout << msg.str() << std::flush;
+  }
+
+}
+
+std::unique_ptr<callback_base>
+build_quantize_int8_callback_from_pbuf(
+  const google::protobuf::Message& proto_msg, const std::shared_ptr<lbann_summary>&) {
+  const auto& params =
+    dynamic_cast<const lbann_data::Callback::CallbackQuantizeInt8&>(proto_msg);
+  return make_unique<quantize_int8>(parse_set<std::string>(params.layers()),
+                                    params.calibration_batches());
+}
+
+} // namespace callback
+} // namespace lbann
@@ -31,43 +31,105 @@
 #include <callbacks.pb.h>
 
 #include <algorithm>
+#include <csignal>
 #include <functional>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <vector>
 
 namespace lbann {
 namespace callback {
+
+namespace {
+
+/** Set by the flush signal handler. */
+volatile std::sig_atomic_t flush_requested = 0;
+
+void request_flush(int) { flush_requested = 1; }
+
+} // namespace
+
+void save_topk_models::on_train_begin(model *m) {
+  if (m_in_memory && m_flush_signal != 0) {
+    std::signal(m_flush_signal, request_flush);
+  }
+}
+
+void save_topk_models::on_batch_end(model *m) {
+  if (!m_in_memory || m_flush_signal == 0) { return; }
+  // Ranks may see the signal at different steps
+  lbann_comm *comm = m->get_comm();
+  const int requested = flush_requested;
+  if (comm->trainer_allreduce(requested, El::mpi::MAX) != 0) {
+    flush_requested = 0;
+    if (!m_best.empty()) { save_best_snapshot(m); }
+  }
+}
+
+void save_topk_models::on_validation_end(model *m) {
+  if (!m_in_memory) { return; }
+  const EvalType score = get_score(m);
+  const bool better = (m_ascending_ordering
+                       ? score < m_best_score
+                       : score > m_best_score);
+  if (m_best.empty() || better) {
+    m_best.save(*m);
+    m_best_score = score;
+  }
+}
+
+void save_topk_models::on_train_end(model *m) {
+  if (!m_in_memory) { return; }
+  // Trainers without a snapshot compete with the worst score
+  const EvalType score = (!m_best.empty() ? m_best_score
+                          : m_ascending_ordering
+                          ? std::numeric_limits<EvalType>::max()
+                          : std::numeric_limits<EvalType>::lowest());
+  bool in_topk = false;
+  if(m->get_comm()->am_trainer_master()) {
+    in_topk = am_in_topk(m, score);
+  }
+  m->get_comm()->trainer_broadcast(0, in_topk);
+  if(in_topk && !m_best.empty()) save_best_snapshot(m);
+  m_best.clear();
+}
+
 void save_topk_models::on_test_end(model *m) {
+  if (m_in_memory) { return; }
   bool in_topk = false;
   if(m->get_comm()->am_trainer_master()) {
-    in_topk = am_in_topk(m);
+    in_topk = am_in_topk(m, get_score(m));
   }
   m->get_comm()->trainer_broadcast(0, in_topk);
   if(in_topk) do_save_model(m);
 }
 
-bool save_topk_models::am_in_topk(model *m) {
+void save_topk_models::save_best_snapshot(model *m) {
+  weights_snapshot current;
+  current.save(*m);
+  m_best.restore(*m);
+  do_save_model(m);
+  current.restore(*m);
+}
+
+EvalType save_topk_models::get_score(model *m) const {
   const auto& c = static_cast<const execution_context&>(m->get_execution_context());
-  lbann_comm *comm = m->get_comm();
-  const int num_trainers = comm->get_num_trainers();
-  std::string mode_string = "test";
-  bool found_metric = false;
-  EvalType score = 0;
   for (const auto& met : m->get_metrics()) {
     if (met->name() == m_metric_name) {
-      found_metric = true;
-      score = met->get_mean_value(c.get_execution_mode());
-      break;
+      return met->get_mean_value(c.get_execution_mode());
     }
   }
-  //sanity check
-  if (!found_metric) {
-    std::stringstream err;
-    err << "could not find metric \"" << m_metric_name << "\""
-        << "in model \"" << m->get_name() << "\"";
-    LBANN_ERROR(err.str());
-  }
+  std::stringstream err;
+  err << "could not find metric \"" << m_metric_name << "\""
+      << "in model \"" << m->get_name() << "\"";
+  LBANN_ERROR(err.str());
+  return 0;
+}
+
+bool save_topk_models::am_in_topk(model *m, EvalType score) {
+  lbann_comm *comm = m->get_comm();
+  const int num_trainers = comm->get_num_trainers();
 
   if (m_k > num_trainers) {
     std::stringstream err;
@@ -106,7 +168,9 @@ build_save_topk_models_callback_from_pbuf(
     params.dir(),
     params.k(),
     params.metric(),
-    params.ascending_ordering());
+    params.ascending_ordering(),
+    params.in_memory(),
+    params.flush_signal());
 }
 
 } // namespace callback
@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "shard_writer.hpp"
+#include "lbann/utils/exception.hpp"
+#include "lbann/utils/pinned_memory.hpp"
+#ifdef LBANN_HAS_GPU
+#include "lbann/utils/cuda.hpp"
+#endif // LBANN_HAS_GPU
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+namespace lbann {
+namespace callback {
+
+shard_writer::~shard_writer() {
+  // Errors cannot be rethrown here
+  if (m_last_write.valid()) { m_last_write.wait(); }
+}
+
+void shard_writer::write(const El::AbstractDistMatrix<DataType>& mat,
+                         const std::string& file_name,
+                         save_function save) {
+  if (mat.RedundantRank() != 0) { return; }
+
+  // Position of local block in global matrix
+  std::ostringstream index;
+  index << mat.LocalHeight() << " " << mat.LocalWidth() << " "
+        << mat.Height() << " " << mat.Width() << " "
+        << mat.ColShift() << " " << mat.ColStride() << " "
+        << mat.RowShift() << " " << mat.RowStride() << "\n";
+  const auto index_str = index.str();
+
+  queue(mat, [file_name, index_str, save](const CPUMat& data) {
+      save(file_name, data);
+      std::ofstream fs(file_name + ".index");
+      if (!fs.is_open()) {
+        LBANN_ERROR("failed to open output file (", file_name, ".index)");
+      }
+      fs << index_str;
+    });
+}
+
+void shard_writer::queue(const El::AbstractDistMatrix<DataType>& mat,
+                         std::function<void(const CPUMat&)> task) {
+  const auto& local = mat.LockedMatrix();
+  const El::Int height = local.Height();
+  const El::Int width = local.Width();
+
+  // Copy local block to host
+  auto data = std::make_shared<pinned_host_matrix<DataType>>(height, width);
+  std::function<void()> wait_for_copy = [] {};
+  switch (local.GetDevice()) {
+  case El::Device::CPU:
+    El::Copy(static_cast<const CPUMat&>(local), data->Matrix());
+    break;
+#ifdef LBANN_HAS_GPU
+  case El::Device::GPU:
+    {
+      if (height > 0 && width > 0) {
+        auto& host = data->Matrix();
+        CHECK_CUDA(cudaMemcpy2DAsync(host.Buffer(),
+                                     host.LDim() * sizeof(DataType),
+                                     local.LockedBuffer(),
+                                     local.LDim() * sizeof(DataType),
+                                     height * sizeof(DataType),
+                                     width,
+                                     cudaMemcpyDeviceToHost,
+                                     El::GPUManager::Stream()));
+      }
+      auto copy_done = std::make_shared<cuda::event_wrapper>();
+      copy_done->record(El::GPUManager::Stream());
+      wait_for_copy = [copy_done] { copy_done->synchronize(); };
+    }
+    break;
+#endif // LBANN_HAS_GPU
+  default: LBANN_ERROR("invalid device");
+  }
+
+  // Run task after the previous one
+  auto previous = m_last_write;
+  m_last_write = std::async(
+    std::launch::async,
+    [previous, data, wait_for_copy, task]() {
+      if (previous.valid()) { previous.get(); }
+      wait_for_copy();
+      task(data->LockedMatrix());
+    }).share();
+}
+
+void shard_writer::wait() {
+  if (m_last_write.valid()) {
+    auto last_write = m_last_write;
+    m_last_write = std::shared_future<void>();
+    last_write.get();
+  }
+}
+
+void save_ascii(const std::string& file_name, const CPUMat& data) {
+  std::ofstream fs(file_name.c_str());
+  if (!fs.is_open()) {
+    LBANN_ERROR("failed to open output file (", file_name, ")");
+  }
+  for (El::Int row = 0; row < data.Height(); ++row) {
+    for (El::Int col = 0; col < data.Width(); ++col) {
+      fs << (col > 0 ? " " : "") << data(row, col);
+    }
+    fs << "\n";
+  }
+}
+
+std::string shard_file_name(const std::string& base,
+                            int rank,
+                            const std::string& ext) {
+  return base + "_rank" + std::to_string(rank) + "." + ext;
+}
+
+} // namespace callback
+} // namespace lbann
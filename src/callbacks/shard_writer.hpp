@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef LBANN_CALLBACKS_SHARD_WRITER_HPP_INCLUDED
+#define LBANN_CALLBACKS_SHARD_WRITER_HPP_INCLUDED
+
+#include "lbann/base.hpp"
+
+#include <functional>
+#include <future>
+#include <string>
+
+namespace lbann {
+namespace callback {
+
+/** @brief Write the local blocks of distributed matrices in the
+ *  background.
+ *
+ *  Only ranks holding a unique block (redundant rank 0) write. GPU
+ *  blocks are copied into memory leased from the pinned memory pool
+ *  on the compute stream, so the caller does not wait for the copy. Writes run on a
+ *  background thread, one at a time, in the order they were queued.
+ *
+ *  Next to each shard, a text file "<file>.index" records where the
+ *  block sits in the global matrix: local height and width, global
+ *  height and width, column shift and stride, and row shift and
+ *  stride.
+ */
+class shard_writer {
+public:
+
+  /** Writes a host matrix to a file. Runs on the background thread. */
+  using save_function = std::function<void(const std::string&, const CPUMat&)>;
+
+  shard_writer() = default;
+  shard_writer(const shard_writer&) = delete;
+  shard_writer& operator=(const shard_writer&) = delete;
+  ~shard_writer();
+
+  /** @brief Queue a write of this rank's block of @c mat.
+   *  @param file_name Shard file name, usually from @c shard_file_name.
+   */
+  void write(const El::AbstractDistMatrix<DataType>& mat,
+             const std::string& file_name,
+             save_function save);
+
+  /** @brief Copy this rank's block of @c mat to host and queue a task
+   *  on it.
+   *  @details Unlike @c write, every rank queues the task.
+   */
+  void queue(const El::AbstractDistMatrix<DataType>& mat,
+             std::function<void(const CPUMat&)> task);
+
+  /** @brief Wait for all queued writes.
+   *  @details Rethrows the first error from a background write.
+   */
+  void wait();
+
+private:
+
+  /** Completes when the last queued write does. */
+  std::shared_future<void> m_last_write;
+
+};
+
+/** Save a host matrix with one matrix row per line, like Elemental's
+ *  ASCII format.
+ */
+void save_ascii(const std::string& file_name, const CPUMat& data);
+
+/** "<base>_rank<rank>.<ext>" */
+std::string shard_file_name(const std::string& base,
+                            int rank,
+                            const std::string& ext);
+
+} // namespace callback
+} // namespace lbann
+
+#endif // LBANN_CALLBACKS_SHARD_WRITER_HPP_INCLUDED
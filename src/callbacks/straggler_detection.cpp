@@ -0,0 +1,212 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/callbacks/straggler_detection.hpp"
+
+#include "lbann/execution_contexts/sgd_execution_context.hpp"
+#include "lbann/layers/io/input/generic_input_layer.hpp"
+#include "lbann/utils/memory.hpp"
+#include "lbann/utils/system_info.hpp"
+#include "lbann/utils/timer.hpp"
+
+#include <callbacks.pb.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace lbann {
+namespace callback {
+
+namespace {
+
+/** Metrics gathered from each process, as per-step averages. */
+enum metric { step_time = 0, io_wait_time, comm_wait_time, compute_time,
+              num_metrics };
+
+const char* metric_name(int i) {
+  switch (i) {
+  case step_time:      return "step";
+  case io_wait_time:   return "io_wait";
+  case comm_wait_time: return "comm_wait";
+  case compute_time:   return "compute";
+  default:             return "unknown";
+  }
+}
+
+/** Total fetch wait time of the model's input layers. */
+double get_io_wait_time(const model& m) {
+  double t = 0;
+  for (const auto* l : m.get_layers()) {
+    const auto* input = dynamic_cast<const generic_input_layer<DataType>*>(l);
+    if (input != nullptr) { t += input->get_io_wait_time(); }
+  }
+  return t;
+}
+
+double median(std::vector<double> v) {
+  if (v.empty()) { return 0; }
+  const auto mid = v.begin() + v.size() / 2;
+  std::nth_element(v.begin(), mid, v.end());
+  if (v.size() % 2 == 1) { return *mid; }
+  return (*mid + *std::max_element(v.begin(), mid)) / 2;
+}
+
+} // namespace
+
+void straggler_detection::on_train_begin(model *m) {
+  if (!m_hosts.empty()) { return; }
+  auto& comm = *m->get_comm();
+  const int num_procs = comm.get_procs_per_trainer();
+
+  // Variable-length gather of host names
+  const auto host = utils::SystemInfo{}.host_name();
+  std::vector<char> host_chars(host.begin(), host.end());
+  int length = host_chars.size();
+  std::vector<int> lengths(num_procs), displacements(num_procs, 0);
+  comm.trainer_all_gather(length, lengths);
+  for (int i = 1; i < num_procs; ++i) {
+    displacements[i] = displacements[i-1] + lengths[i-1];
+  }
+  std::vector<char> all_chars(displacements.back() + lengths.back());
+  comm.trainer_all_gather(host_chars, all_chars, lengths, displacements);
+  m_hosts.resize(num_procs);
+  for (int i = 0; i < num_procs; ++i) {
+    m_hosts[i].assign(all_chars.begin() + displacements[i],
+                      all_chars.begin() + displacements[i] + lengths[i]);
+  }
+}
+
+void straggler_detection::on_batch_begin(model *m) {
+  m_io_wait_start = get_io_wait_time(*m);
+  m_comm_wait_start = m->get_comm()->get_wait_time();
+  m_step_start = get_time();
+}
+
+void straggler_detection::on_batch_end(model *m) {
+  m_step_time += get_time() - m_step_start;
+  m_io_wait_time += get_io_wait_time(*m) - m_io_wait_start;
+  m_comm_wait_time += m->get_comm()->get_wait_time() - m_comm_wait_start;
+  if (++m_num_steps >= m_interval) {
+    analyze(*m);
+    m_num_steps = 0;
+    m_step_time = 0;
+    m_io_wait_time = 0;
+    m_comm_wait_time = 0;
+  }
+}
+
+void straggler_detection::analyze(model& m) {
+  const auto& c = static_cast<sgd_execution_context&>(m.get_execution_context());
+  auto& comm = *m.get_comm();
+  const int num_procs = comm.get_procs_per_trainer();
+
+  double local[num_metrics];
+  local[step_time] = m_step_time / m_num_steps;
+  local[io_wait_time] = m_io_wait_time / m_num_steps;
+  local[comm_wait_time] = m_comm_wait_time / m_num_steps;
+  local[compute_time] = std::max(local[step_time]
+                                 - local[io_wait_time]
+                                 - local[comm_wait_time], 0.0);
+  if (!comm.am_trainer_master()) {
+    comm.trainer_gather(local, num_metrics, comm.get_trainer_master());
+    return;
+  }
+  std::vector<double> all(num_metrics * num_procs);
+  comm.trainer_gather(local, num_metrics, all.data());
+
+  // Median of each metric over the processes
+  std::vector<double> medians(num_metrics), mads(num_metrics);
+  for (int k = 0; k < num_metrics; ++k) {
+    std::vector<double> values(num_procs);
+    for (int i = 0; i < num_procs; ++i) {
+      values[i] = all[i * num_metrics + k];
+    }
+    medians[k] = median(values);
+    for (auto& v : values) { v = std::fabs(v - medians[k]); }
+    // Floor the spread at 1% of the median so a perfectly uniform
+    // trainer does not flag noise
+    mads[k] = std::max(median(values), 0.01 * medians[k]);
+  }
+
+  std::stringstream msg, out;
+  msg << std::fixed << std::setprecision(4);
+  const std::string prefix =
+    m.get_name() + " (instance " + std::to_string(comm.get_trainer_rank())
+    + ") step " + std::to_string(c.get_step()) + " ";
+  for (int i = 0; i < num_procs; ++i) {
+    const double* values = &all[i * num_metrics];
+    for (const int k : {compute_time, io_wait_time}) {
+      if (mads[k] <= 0 || values[k] < m_min_ratio * medians[k]) { continue; }
+      const double z = 0.6745 * (values[k] - medians[k]) / mads[k];
+      if (z <= m_threshold) { continue; }
+      msg << prefix << "straggler : rank " << i
+          << " (host " << m_hosts[i] << ") "
+          << metric_name(k) << " " << values[k] << "s/step vs median "
+          << medians[k] << "s (robust z " << std::setprecision(1) << z
+          << std::setprecision(4) << "); step "
+          << values[step_time] << "s, I/O wait "
+          << values[io_wait_time] << "s, comm wait "
+          << values[comm_wait_time] << "s (median "
+          << medians[comm_wait_time] << "s)\n";
+      out << c.get_step() << " " << i << " " << m_hosts[i] << " "
+          << metric_name(k) << " " << values[k] << " "
+          << medians[k] << " " << z << "\n";
+    }
+  }
+  if (!msg.str().empty()) {
+    std::cout << msg.str() << std::flush;
+  }
+  if (!m_output_file.empty() && !out.str().empty()) {
+    std::ofstream fs(m_output_file, std::ios::app);
+    if (!fs) {
+      LBANN_WARNING("straggler detection could not open ", m_output_file);
+    } else {
+      fs << out.str();
+    }
+  }
+}
+
+std::unique_ptr<callback_base>
+build_straggler_detection_callback_from_pbuf(
+  const google::protobuf::Message& proto_msg, std::shared_ptr<lbann_summary> const&) {
+  const auto& params =
+    dynamic_cast<const lbann_data::Callback::CallbackStragglerDetection&>(proto_msg);
+  return make_unique<straggler_detection>(
+    params.interval() > 0 ? params.interval() : 100,
+    params.threshold() > 0 ? params.threshold() : 3.5,
+    params.min_ratio() > 0 ? params.min_ratio() : 1.1,
+    params.output_file());
+}
+
+} // namespace callback
+} // namespace lbann
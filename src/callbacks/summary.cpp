@@ -143,25 +143,22 @@ void summary::save_histograms(model *m) {
     const std::string prefix = layer->get_name() + "/";
     for (int i = 0; i < layer->get_num_children(); ++i) {
       auto* dtl = dynamic_cast<LayerType*>(layer);
-      AbsDistMatReadProxy<El::Device::CPU> acts(dtl->get_activations(i));
       m_summarizer->reduce_histogram(prefix + "activations" + std::to_string(i),
-                                     acts.GetLocked(),
+                                     dtl->get_activations(i),
                                      c.get_step());
     }
   }
   for (const auto& w : m->get_weights()) {
     const std::string prefix = w->get_name() + "/";
     auto* dtw = dynamic_cast<WeightsType*>(w);
-    AbsDistMatReadProxy<El::Device::CPU> weights(dtw->get_values());
     m_summarizer->reduce_histogram(prefix + "weights",
-                                   weights.GetLocked(),
+                                   dtw->get_values(),
                                    c.get_step());
     optimizer *opt = w->get_optimizer();
     if (opt != nullptr) {
       auto* dt_opt = dynamic_cast<OptimizerType*>(opt);
-      AbsDistMatReadProxy<El::Device::CPU> gradients(dt_opt->get_gradient());
       m_summarizer->reduce_histogram(prefix + "weights_gradient",
-                                     gradients.GetLocked(),
+                                     dt_opt->get_gradient(),
                                      c.get_step());
     }
   }
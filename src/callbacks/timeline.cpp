@@ -81,21 +81,21 @@ void timeline::on_train_end(model *m) {
 }
 
 void timeline::on_forward_prop_begin(model *m, Layer *l) {
-  m_fp_start_time = get_rel_time();
+  const EvalType start = get_rel_time();
+  m_fp_times[l->get_name()].emplace_back(start, start);
 }
 
 void timeline::on_forward_prop_end(model *m, Layer *l) {
-  EvalType end = get_rel_time();
-  m_fp_times[l->get_name()].emplace_back(m_fp_start_time, end);
+  m_fp_times[l->get_name()].back().second = get_rel_time();
 }
 
 void timeline::on_backward_prop_begin(model *m, Layer *l) {
-  m_bp_start_time = get_rel_time();
+  const EvalType start = get_rel_time();
+  m_bp_times[l->get_name()].emplace_back(start, start);
 }
 
 void timeline::on_backward_prop_end(model *m, Layer *l) {
-  EvalType end = get_rel_time();
-  m_bp_times[l->get_name()].emplace_back(m_bp_start_time, end);
+  m_bp_times[l->get_name()].back().second = get_rel_time();
 }
 
 void timeline::on_optimize_begin(model *m, weights *w) {
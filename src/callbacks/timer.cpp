@@ -26,7 +26,12 @@
 
 #include "lbann/callbacks/timer.hpp"
 #include "lbann/utils/timer.hpp"
+#include "lbann/utils/options.hpp"
+#include "lbann/utils/pipeline.hpp"
 #include <algorithm>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
 
 namespace lbann {
 namespace callback {
@@ -53,6 +58,13 @@ void timer::timing_begin(const model& m) {
   const auto& mode = c.get_execution_mode();
   m_start_times[mode] = get_time();
   m_batch_times[mode].clear();
+  if (mode == execution_mode::training) {
+    m_layer_start_times.clear();
+    for (El::Int i = 0; i < m.get_num_layers(); ++i) {
+      const auto& l = m.get_layer(i);
+      m_layer_start_times.emplace_back(l.get_fp_time(), l.get_bp_time());
+    }
+  }
 }
 
 void timer::timing_end(model& m) {
@@ -170,6 +182,122 @@ void timer::timing_end(model& m) {
     }
   }
 
+  if (mode == execution_mode::training) {
+    report_step_breakdown(m, mode_string);
+  }
+
+  // Suggest pipeline stages
+  if (mode == execution_mode::training
+      && options::get()->has_int("pipeline_stages")) {
+    const int num_stages = options::get()->get_int("pipeline_stages");
+    if (num_stages > 1) { report_pipeline_stages(m, num_stages); }
+  }
+
+}
+
+void timer::report_step_breakdown(model& m, const std::string& mode_string) {
+  const El::Int num_layers = m.get_num_layers();
+  const auto& batch_times = m_batch_times[execution_mode::training];
+  if (m_layer_start_times.size() != static_cast<size_t>(num_layers)
+      || batch_times.empty()) {
+    return;
+  }
+
+  // Note: Counters may have been reset during the epoch.
+  EvalType fp_time = 0, bp_time = 0;
+  for (El::Int i = 0; i < num_layers; ++i) {
+    const auto& l = m.get_layer(i);
+    fp_time += std::max(l.get_fp_time() - m_layer_start_times[i].first,
+                        EvalType(0));
+    bp_time += std::max(l.get_bp_time() - m_layer_start_times[i].second,
+                        EvalType(0));
+  }
+  const EvalType num_steps = batch_times.size();
+  const EvalType step_time = std::accumulate(batch_times.begin(),
+                                             batch_times.end(),
+                                             EvalType(0)) / num_steps;
+  fp_time /= num_steps;
+  bp_time /= num_steps;
+  const EvalType other_time = std::max(step_time - fp_time - bp_time,
+                                       EvalType(0));
+  auto& comm = *m.get_comm();
+  if (comm.am_trainer_master()) {
+    std::cout << m.get_name() << " (instance " << comm.get_trainer_rank() << ") "
+              << mode_string << " "
+              << "step time breakdown : "
+              << fp_time << "s forward prop, "
+              << bp_time << "s backward prop, "
+              << other_time << "s other"
+              << std::endl;
+  }
+}
+
+void timer::report_pipeline_stages(model& m, int num_stages) {
+  const El::Int num_layers = m.get_num_layers();
+  const auto& num_steps = m_batch_times[execution_mode::training].size();
+  if (m_layer_start_times.size() != static_cast<size_t>(num_layers)
+      || num_steps == 0) {
+    return;
+  }
+  int num_micro_batches = 1;
+  if (options::get()->has_int("num_micro_batches")) {
+    num_micro_batches = std::max(options::get()->get_int("num_micro_batches"), 1);
+  }
+
+  // Layer times per micro-batch
+  // Note: Counters may have been reset during the epoch.
+  const double scale = 1. / (num_steps * num_micro_batches);
+  std::vector<double> fp_times(num_layers), bp_times(num_layers), costs(num_layers);
+  for (El::Int i = 0; i < num_layers; ++i) {
+    const auto& l = m.get_layer(i);
+    fp_times[i] = std::max(l.get_fp_time() - m_layer_start_times[i].first,
+                           EvalType(0)) * scale;
+    bp_times[i] = std::max(l.get_bp_time() - m_layer_start_times[i].second,
+                           EvalType(0)) * scale;
+    costs[i] = fp_times[i] + bp_times[i];
+  }
+
+  // Balance stages by forward and backward prop time
+  const auto starts = pipeline::balance_stages(costs, num_stages);
+  std::vector<double> stage_fp_times, stage_bp_times;
+  std::stringstream ss;
+  ss << std::setprecision(3)
+     << "model \"" << m.get_name() << "\" split into "
+     << starts.size() << " balanced pipeline stages:\n";
+  for (size_t s = 0; s < starts.size(); ++s) {
+    const El::Int first = starts[s];
+    const El::Int last = (s + 1 < starts.size() ? El::Int(starts[s+1]) : num_layers) - 1;
+    stage_fp_times.push_back(0.);
+    stage_bp_times.push_back(0.);
+    for (El::Int i = first; i <= last; ++i) {
+      stage_fp_times.back() += fp_times[i];
+      stage_bp_times.back() += bp_times[i];
+    }
+    ss << "  stage " << s << ": "
+       << "layers \"" << m.get_layer(first).get_name() << "\" "
+       << "to \"" << m.get_layer(last).get_name() << "\" "
+       << "(" << last - first + 1 << " layers), "
+       << stage_fp_times.back() + stage_bp_times.back() << "s "
+       << "per micro-batch\n";
+  }
+
+  // Estimate step times without transfers between stages
+  const double sequential_time
+    = std::accumulate(costs.begin(), costs.end(), 0.) * num_micro_batches;
+  ss << "  estimated step time with " << num_micro_batches << " "
+     << "micro-batches: " << sequential_time << "s in one stage";
+  for (const auto& type : {pipeline::schedule_type::gpipe,
+                           pipeline::schedule_type::one_forward_one_backward}) {
+    ss << ", " << pipeline::estimate_step_time(type,
+                                               stage_fp_times,
+                                               stage_bp_times,
+                                               num_micro_batches)
+       << "s with " << pipeline::to_string(type);
+  }
+  if (m.get_comm()->am_trainer_master()) {
+    std::cout << ss.str() << std::endl;
+  }
+
 }
 
 std::unique_ptr<callback_base>
@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/callbacks/trace.hpp"
+
+#include "lbann/utils/memory.hpp"
+#include "lbann/utils/telemetry.hpp"
+
+#include <callbacks.pb.h>
+
+#include <string>
+
+namespace lbann {
+namespace callback {
+
+void trace::on_train_begin(model *m) {
+  auto* comm = m->get_comm();
+  const std::string path = m_outdir + "/trace.t" +
+    std::to_string(comm->get_trainer_rank()) + "." +
+    std::to_string(comm->get_rank_in_trainer()) + ".json";
+  lbann::telemetry::start(path, comm->get_rank_in_world(),
+                          m_ring_capacity, m_flush_interval);
+}
+
+void trace::on_train_end(model *) {
+  lbann::telemetry::stop();
+  const auto dropped = lbann::telemetry::num_dropped();
+  if (dropped > 0) {
+    LBANN_WARNING("trace callback dropped ", dropped, " events; "
+                  "consider a larger ring capacity");
+  }
+}
+
+std::unique_ptr<callback_base>
+build_trace_callback_from_pbuf(
+  const google::protobuf::Message& proto_msg, std::shared_ptr<lbann_summary> const&) {
+  const auto& params =
+    dynamic_cast<const lbann_data::Callback::CallbackTrace&>(proto_msg);
+  return make_unique<trace>(
+    params.directory(),
+    params.ring_capacity() > 0 ? params.ring_capacity() : 1 << 16,
+    params.flush_interval() > 0.0 ? params.flush_interval() : 0.1);
+}
+
+} // namespace callback
+} // namespace lbann
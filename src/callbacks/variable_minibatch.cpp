@@ -196,6 +196,82 @@ bool minibatch_schedule::schedule(
   return false;
 }
 
+noise_scale_minibatch::noise_scale_minibatch(
+  size_t starting_mbsize, size_t interval, size_t ramp_time, double ema_decay) :
+  variable_minibatch(starting_mbsize), m_interval(interval),
+  m_ramp_time(ramp_time), m_ema_decay(ema_decay) {}
+
+void noise_scale_minibatch::on_batch_begin(model *m) {
+  m_tracking = (m_num_steps++ % m_interval == 0
+                && m->get_comm()->get_procs_per_trainer() > 1);
+  if (!m_tracking) { return; }
+  for (weights *w : m->get_weights()) {
+    optimizer *opt = w->get_optimizer();
+    if (opt != nullptr) { opt->set_track_gradient_norms(true); }
+  }
+}
+
+void noise_scale_minibatch::on_batch_end(model *m) {
+  if (!m_tracking) { return; }
+  m_tracking = false;
+  double norms[2] = {0, 0};
+  for (weights *w : m->get_weights()) {
+    optimizer *opt = w->get_optimizer();
+    if (opt != nullptr) {
+      norms[0] += opt->get_local_gradient_norm2();
+      norms[1] += opt->get_global_gradient_norm2();
+      opt->set_track_gradient_norms(false);
+    }
+  }
+  lbann_comm *comm = m->get_comm();
+  const double num_procs = comm->get_procs_per_trainer();
+  double sums[2];
+  comm->trainer_allreduce(norms, 2, sums);
+  if (sums[1] <= 0) { return; }
+
+  // Every rank holds the whole allreduced gradient, so both sums are
+  // averages over the ranks once divided by their number
+  const double small_norm2 = sums[0] / num_procs;
+  const double big_norm2 = sums[1] / num_procs;
+  const auto& c = static_cast<const sgd_execution_context&>(m->get_execution_context());
+  const double big_batch = c.get_current_mini_batch_size();
+  const double small_batch = big_batch / num_procs;
+  const double gradient_norm2 = ((big_batch * big_norm2 - small_batch * small_norm2)
+                                 / (big_batch - small_batch));
+  const double trace_sigma = ((small_norm2 - big_norm2)
+                              / (1 / small_batch - 1 / big_batch));
+  if (m_num_measurements++ == 0) {
+    m_gradient_norm2 = gradient_norm2;
+    m_trace_sigma = trace_sigma;
+  } else {
+    m_gradient_norm2 = m_ema_decay * m_gradient_norm2 + (1 - m_ema_decay) * gradient_norm2;
+    m_trace_sigma = m_ema_decay * m_trace_sigma + (1 - m_ema_decay) * trace_sigma;
+  }
+}
+
+bool noise_scale_minibatch::schedule(
+  model *m, size_t& new_mbsize, float& new_lr, size_t& ramp_time) {
+  if (m_num_measurements == 0 || m_gradient_norm2 <= 0 || m_trace_sigma <= 0) {
+    return false;
+  }
+  const double noise_scale = m_trace_sigma / m_gradient_norm2;
+  const auto& t = static_cast<const sgd_execution_context&>(m->get_execution_context()).get_trainer();
+  lbann_comm *comm = m->get_comm();
+  if (comm->am_trainer_master()) {
+    std::cout << "Model " << comm->get_trainer_rank()
+              << ": gradient noise scale " << noise_scale
+              << " at mini-batch size " << m_current_mini_batch_size << std::endl;
+  }
+  if (noise_scale < 2 * m_current_mini_batch_size
+      || m_current_mini_batch_size >= static_cast<size_t>(t.get_max_mini_batch_size())) {
+    return false;
+  }
+  new_mbsize = m_current_mini_batch_size * 2;
+  new_lr = get_current_learning_rate(m) * 2;
+  ramp_time = m_ramp_time;
+  return true;
+}
+
 std::unique_ptr<callback_base>
 build_step_minibatch_callback_from_pbuf(
   const google::protobuf::Message& proto_msg, std::shared_ptr<lbann_summary> const&) {
@@ -223,5 +299,17 @@ build_minibatch_schedule_callback_from_pbuf(
                                                         steps);
 }
 
+std::unique_ptr<callback_base>
+build_noise_scale_minibatch_callback_from_pbuf(
+  const google::protobuf::Message& proto_msg, std::shared_ptr<lbann_summary> const&) {
+  const auto& params =
+    dynamic_cast<const lbann_data::Callback::CallbackNoiseScaleMinibatch&>(proto_msg);
+  return make_unique<noise_scale_minibatch>(
+    params.starting_mbsize(),
+    params.interval() > 0 ? params.interval() : 10,
+    params.ramp_time(),
+    params.ema_decay() > 0 ? params.ema_decay() : 0.95);
+}
+
 } // namespace callback
 } // namespace lbann
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/callbacks/weights_snapshot.hpp"
+#include "lbann/models/model.hpp"
+#include "lbann/utils/exception.hpp"
+#include "lbann/weights/data_type_weights.hpp"
+
+namespace lbann {
+namespace callback {
+
+void weights_snapshot::save(model& m) {
+  for (const auto* w : m.get_weights()) {
+    const auto& dtw = dynamic_cast<const data_type_weights<DataType>&>(*w);
+    const auto& local = dtw.get_values().LockedMatrix();
+    auto& host = m_values[w->get_name()];
+#ifdef LBANN_HAS_GPU
+    if (local.GetDevice() == El::Device::GPU
+        && host.Height() * host.Width() == 0) {
+      host.SetMemoryMode(1); // Pinned memory
+    }
+#endif // LBANN_HAS_GPU
+    El::Copy(local, host);
+  }
+}
+
+void weights_snapshot::restore(model& m) const {
+  for (auto* w : m.get_weights()) {
+    const auto& it = m_values.find(w->get_name());
+    if (it == m_values.end()) {
+      LBANN_ERROR("weights snapshot has no values for \"", w->get_name(), "\"");
+    }
+    auto& dtw = dynamic_cast<data_type_weights<DataType>&>(*w);
+    auto& local = dtw.get_values().Matrix();
+    if (local.Height() != it->second.Height()
+        || local.Width() != it->second.Width()) {
+      LBANN_ERROR("weights snapshot of \"", w->get_name(), "\" has ",
+                  "a different size than the weights");
+    }
+    El::Copy(it->second, local);
+  }
+}
+
+} // namespace callback
+} // namespace lbann
@@ -28,13 +28,21 @@
 
 #define LBANN_COMM_INSTANTIATE
 #include "lbann/comm.hpp"
+#include "lbann/utils/telemetry.hpp"
 #include "lbann/utils/timer.hpp"
 #include "lbann/utils/exception.hpp"
 #include "lbann/utils/cuda.hpp"
 #include "mpi.h"
 #include "omp.h"
+#if defined(LBANN_TOPO_AWARE)
+#include <hwloc.h>
+#endif // LBANN_TOPO_AWARE
+#include <algorithm>
+#include <cctype>
+#include <numeric>
 #include <sstream>
 #include <thread>
+#include <tuple>
 
 namespace lbann {
 
@@ -87,6 +95,101 @@ lbann_comm::~lbann_comm() {
 #endif
 }
 
+namespace {
+
+/** Processor (compute node) names of every process in @c comm. */
+std::vector<std::string> gather_node_names(const El::mpi::Comm& comm) {
+  char node_name[MPI_MAX_PROCESSOR_NAME] = {};
+  int node_name_len;
+  checkMPI(MPI_Get_processor_name(node_name, &node_name_len));
+  const int size = El::mpi::Size(comm);
+  std::vector<char> all_names(size * MPI_MAX_PROCESSOR_NAME);
+  checkMPI(MPI_Allgather(node_name, MPI_MAX_PROCESSOR_NAME, MPI_CHAR,
+                         all_names.data(), MPI_MAX_PROCESSOR_NAME, MPI_CHAR,
+                         comm.GetMPIComm()));
+  std::vector<std::string> names(size);
+  for (int i = 0; i < size; ++i) {
+    names[i] = std::string(&all_names[i * MPI_MAX_PROCESSOR_NAME]);
+  }
+  return names;
+}
+
+/** Hostname order with digit runs compared as numbers. */
+bool natural_less(const std::string& a, const std::string& b) {
+  size_t i = 0, j = 0;
+  while (i < a.size() && j < b.size()) {
+    if (std::isdigit(a[i]) && std::isdigit(b[j])) {
+      size_t i_end = i, j_end = j;
+      while (i_end < a.size() && std::isdigit(a[i_end])) { ++i_end; }
+      while (j_end < b.size() && std::isdigit(b[j_end])) { ++j_end; }
+      const auto x = a.substr(i, i_end - i), y = b.substr(j, j_end - j);
+      const auto x_trim = x.substr(std::min(x.find_first_not_of('0'), x.size()));
+      const auto y_trim = y.substr(std::min(y.find_first_not_of('0'), y.size()));
+      if (x_trim.size() != y_trim.size()) {
+        return x_trim.size() < y_trim.size();
+      }
+      if (x_trim != y_trim) { return x_trim < y_trim; }
+      i = i_end;
+      j = j_end;
+    } else {
+      if (a[i] != b[j]) { return a[i] < b[j]; }
+      ++i;
+      ++j;
+    }
+  }
+  if ((a.size() - i) != (b.size() - j)) {
+    return (a.size() - i) < (b.size() - j);
+  }
+  return a < b; // e.g. node02 and node2
+}
+
+/** NUMA domain this process is bound to (0 if unknown). */
+int get_numa_domain() {
+  int domain = 0;
+#if defined(LBANN_TOPO_AWARE)
+  hwloc_topology_t topo;
+  hwloc_topology_init(&topo);
+  hwloc_topology_load(topo);
+  hwloc_bitmap_t cpuset = hwloc_bitmap_alloc();
+  if (hwloc_get_cpubind(topo, cpuset, HWLOC_CPUBIND_PROCESS) == 0) {
+    const int num_domains = hwloc_get_nbobjs_by_type(topo, HWLOC_OBJ_NUMANODE);
+    for (int i = 0; i < num_domains; ++i) {
+      auto* obj = hwloc_get_obj_by_type(topo, HWLOC_OBJ_NUMANODE, i);
+      if (obj != nullptr && obj->cpuset != nullptr
+          && hwloc_bitmap_intersects(obj->cpuset, cpuset)) {
+        domain = i;
+        break;
+      }
+    }
+  }
+  hwloc_bitmap_free(cpuset);
+  hwloc_topology_destroy(topo);
+#endif // LBANN_TOPO_AWARE
+  return domain;
+}
+
+/** World ranks ordered by compute node, NUMA domain and world rank. */
+std::vector<int> get_topology_order(const El::mpi::Comm& world) {
+  const int size = El::mpi::Size(world);
+  const auto names = gather_node_names(world);
+  std::vector<int> domains(size);
+  int my_domain = get_numa_domain();
+  checkMPI(MPI_Allgather(&my_domain, 1, MPI_INT,
+                         domains.data(), 1, MPI_INT, world.GetMPIComm()));
+  std::vector<int> order(size);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&names, &domains](int a, int b) {
+                     if (names[a] != names[b]) {
+                       return natural_less(names[a], names[b]);
+                     }
+                     return domains[a] < domains[b];
+                   });
+  return order;
+}
+
+} // namespace
+
 void lbann_comm::split_trainers(int ppm) {
   int world_size = El::mpi::Size(get_world_comm());
   procs_per_trainer = ppm;
@@ -110,8 +213,25 @@ void lbann_comm::split_trainers(int ppm) {
   }
 
   num_trainers = world_size / procs_per_trainer;
-  trainer_rank = El::mpi::Rank(get_world_comm()) / procs_per_trainer;
-  rank_in_trainer = El::mpi::Rank(get_world_comm()) % procs_per_trainer;
+  int position = El::mpi::Rank(get_world_comm());
+  m_placement_order.clear();
+  if (m_trainer_placement == trainer_placement::topology) {
+    m_placement_order = get_topology_order(get_world_comm());
+    position = std::find(m_placement_order.begin(), m_placement_order.end(),
+                         position) - m_placement_order.begin();
+  }
+  trainer_rank = position / procs_per_trainer;
+  rank_in_trainer = position % procs_per_trainer;
+
+  // Release the communicators of a previous split. Hierarchical
+  // allreduce communicators are keyed by handles that MPI may reuse.
+  if (grid != nullptr) {
+    delete grid;
+    grid = nullptr;
+    hierarchical_communicators.clear();
+    El::mpi::Free(trainer_comm);
+    El::mpi::Free(intertrainer_comm);
+  }
 
   // Initialize trainer and intertrainer communicators
   El::mpi::Split(get_world_comm(), trainer_rank, rank_in_trainer, trainer_comm);
@@ -119,12 +239,49 @@ void lbann_comm::split_trainers(int ppm) {
                  intertrainer_comm);
 
   // Initialize Elemental grid
-  if (grid != nullptr) {
-    delete grid;
-  }
   grid = new Grid(trainer_comm.GetMPIComm());
 }
 
+std::string lbann_comm::describe_trainer_placement() const {
+  const auto names = gather_node_names(get_world_comm());
+  if (!am_world_master()) { return std::string(); }
+  std::ostringstream ss;
+  ss << num_trainers << " trainers of " << procs_per_trainer << " processes ("
+     << (m_trainer_placement == trainer_placement::topology ?
+         "topology" : "contiguous") << " placement)\n";
+  const int max_listed = 16;
+  size_t max_nodes = 0;
+  for (int t = 0; t < num_trainers; ++t) {
+    // Nodes of this trainer with their process counts, in rank order
+    std::vector<std::pair<std::string, int>> nodes;
+    for (int r = 0; r < procs_per_trainer; ++r) {
+      const auto& name = names[get_world_rank(t, r)];
+      auto it = std::find_if(nodes.begin(), nodes.end(),
+                             [&name](const std::pair<std::string, int>& n) {
+                               return n.first == name;
+                             });
+      if (it == nodes.end()) {
+        nodes.emplace_back(name, 1);
+      } else {
+        ++it->second;
+      }
+    }
+    max_nodes = std::max(max_nodes, nodes.size());
+    if (t < max_listed) {
+      ss << "  trainer " << t << ":";
+      for (const auto& n : nodes) {
+        ss << " " << n.first << " (" << n.second << ")";
+      }
+      ss << "\n";
+    }
+  }
+  if (num_trainers > max_listed) {
+    ss << "  ... " << (num_trainers - max_listed) << " more trainers\n";
+  }
+  ss << "  at most " << max_nodes << " nodes per trainer";
+  return ss.str();
+}
+
 void lbann_comm::intertrainer_sum_matrix(AbsMat& mat) {
   bytes_sent += sizeof(DataType) * mat.Height() * mat.Width();
   El::AllReduce(mat, intertrainer_comm, El::mpi::SUM);
@@ -135,6 +292,14 @@ void lbann_comm::intertrainer_sum_matrix(AbsDistMat& mat) {
   allreduce(mat, intertrainer_comm, El::mpi::SUM);
 }
 
+void lbann_comm::nb_intertrainer_sum_matrix(AbsMat& mat, Al::request& req) {
+  nb_allreduce(mat, intertrainer_comm, req, El::mpi::SUM);
+}
+
+void lbann_comm::nb_intertrainer_sum_matrix(AbsDistMat& mat, Al::request& req) {
+  nb_allreduce(mat, intertrainer_comm, req, El::mpi::SUM);
+}
+
 namespace {
 
 template <typename BackendT>
@@ -322,8 +487,145 @@ void nb_allreduce_impl(El::Matrix<T, El::Device::GPU>& m,
 }
 
 #endif // defined(LBANN_HAS_GPU) && defined(LBANN_HAS_ALUMINUM)
+
+// Two-level allreduce: reduce-scatter over the processes on this
+// node, allreduce of this process's shard across nodes, allgather
+// over the processes on this node.
+template <typename T, El::Device D>
+void hierarchical_allreduce_impl(El::Matrix<T, D>& m,
+                                 const El::mpi::Comm& local_comm,
+                                 const El::mpi::Comm& cross_comm,
+                                 El::mpi::Op const& op) {
+  const El::Int height = m.Height();
+  const El::Int width = m.Width();
+  const El::Int size = height * width;
+  const El::Int local_size = El::mpi::Size(local_comm);
+  const El::Int shard_size = (size + local_size - 1) / local_size;
+
+  // Pack matrix into a zero-padded contiguous buffer
+  El::Matrix<T, D> workspace(shard_size * local_size, 1);
+  El::Matrix<T, D> shard(shard_size, 1);
+  {
+    El::Matrix<T, D> workspace_v;
+    workspace_v.Attach(height, width, workspace.Buffer(), height);
+    El::Copy(m, workspace_v);
+    if (shard_size * local_size > size) {
+      El::View(workspace_v, workspace,
+               El::IR(size, shard_size * local_size), El::ALL);
+      El::Zero(workspace_v);
+    }
+  }
+
+  const auto& sync_info = El::SyncInfoFromMatrix(workspace);
+  El::mpi::ReduceScatter(workspace.LockedBuffer(), shard.Buffer(),
+                         shard_size, op, local_comm, sync_info);
+  El::mpi::AllReduce(shard.Buffer(), shard_size, op, cross_comm, sync_info);
+  El::mpi::AllGather(shard.LockedBuffer(), shard_size,
+                     workspace.Buffer(), shard_size,
+                     local_comm, sync_info);
+
+  // Unpack
+  El::Matrix<T, D> workspace_v;
+  workspace_v.LockedAttach(height, width, workspace.LockedBuffer(), height);
+  El::Copy(workspace_v, m);
+}
+
+#ifdef LBANN_HAS_ALUMINUM
+// Host allreduce with a fixed Aluminum algorithm. Strided matrices
+// are packed so Aluminum sees one buffer.
+template <typename T,
+          El::EnableWhen<
+            El::AluminumSupportsBackendAndCollective<
+              T, El::Collective::ALLREDUCE, ::Al::MPIBackend>,
+            int> = 0>
+void ordered_allreduce_impl(El::Matrix<T, El::Device::CPU>& m,
+                            const El::mpi::Comm& c,
+                            El::mpi::Op const& op,
+                            ::Al::MPIAllreduceAlgorithm algo) {
+  const bool contiguous = (m.Width() == 1 || m.Height() == m.LDim());
+  El::Matrix<T, El::Device::CPU> packed;
+  if (!contiguous) {
+    El::Copy(m, packed);
+  }
+  auto& buffer = contiguous ? m : packed;
+  ::Al::Allreduce<::Al::MPIBackend>(
+    buffer.Buffer(),
+    buffer.Height() * buffer.Width(),
+    mpi_op_to_al_op(op),
+    c.template GetComm<::Al::MPIBackend>(El::SyncInfo<El::Device::CPU>{}),
+    algo);
+  if (!contiguous) {
+    El::Copy(packed, m);
+  }
+}
+
+template <typename T,
+          El::EnableUnless<
+            El::AluminumSupportsBackendAndCollective<
+              T, El::Collective::ALLREDUCE, ::Al::MPIBackend>,
+            int> = 0>
+void ordered_allreduce_impl(El::Matrix<T, El::Device::CPU>& m,
+                            const El::mpi::Comm& c,
+                            El::mpi::Op const& op,
+                            ::Al::MPIAllreduceAlgorithm) {
+  // Aluminum does not handle this type, so MPI does
+  El::AllReduce(m, c, op);
+}
+#endif // LBANN_HAS_ALUMINUM
+
 }// namespace <anon>
 
+auto lbann_comm::get_hierarchical_comms(const El::mpi::Comm& c, size_t bytes)
+  -> const hierarchical_comms* {
+  if (m_allreduce_algorithm != allreduce_algorithm::hierarchical
+      || bytes < m_hierarchical_allreduce_min_bytes) {
+    return nullptr;
+  }
+  auto it = hierarchical_communicators.find(c.GetMPIComm());
+  if (it == hierarchical_communicators.end()) {
+    // Split by node, then by rank within node
+    const int rank = El::mpi::Rank(c);
+    MPI_Comm local_comm, cross_comm;
+    checkMPI(MPI_Comm_split(c.GetMPIComm(), world_ranks_on_node.front(),
+                            rank, &local_comm));
+    int local_rank, local_size, cross_size;
+    checkMPI(MPI_Comm_rank(local_comm, &local_rank));
+    checkMPI(MPI_Comm_size(local_comm, &local_size));
+    checkMPI(MPI_Comm_split(c.GetMPIComm(), local_rank, rank, &cross_comm));
+    checkMPI(MPI_Comm_size(cross_comm, &cross_size));
+
+    // Only use with several nodes with the same number of processes
+    int sizes[2] = {local_size, -local_size};
+    checkMPI(MPI_Allreduce(MPI_IN_PLACE, sizes, 2, MPI_INT, MPI_MAX,
+                           c.GetMPIComm()));
+    const bool usable = (sizes[0] == -sizes[1]
+                         && local_size > 1
+                         && cross_size > 1);
+
+    it = hierarchical_communicators.emplace(
+      std::piecewise_construct,
+      std::forward_as_tuple(c.GetMPIComm()),
+      std::forward_as_tuple(local_comm, cross_comm, usable)).first;
+    MPI_Comm_free(&local_comm);  // El::mpi::Comm duplicates internally.
+    MPI_Comm_free(&cross_comm);
+  }
+  return it->second.usable ? &it->second : nullptr;
+}
+
+namespace {
+
+/** Adds the lifetime of the object to a wait time counter. */
+class wait_timer {
+public:
+  wait_timer(double& total) : m_total(total), m_start(get_time()) {}
+  ~wait_timer() { m_total += get_time() - m_start; }
+private:
+  double& m_total;
+  double m_start;
+};
+
+} // namespace
+
 template <typename TensorDataType>
 void lbann_comm::allreduce(El::AbstractMatrix<TensorDataType>& m,
                            const El::mpi::Comm& c,
@@ -331,11 +633,46 @@ void lbann_comm::allreduce(El::AbstractMatrix<TensorDataType>& m,
   if (El::mpi::Size(c) == 1 || m.Height() < 1 || m.Width() < 1) {
     return;
   }
+  static const auto telemetry_region = telemetry::intern("allreduce");
+  telemetry::scope telemetry_scope(telemetry::category::comm, telemetry_region);
 
   const int local_size = m.Height() * m.Width();
   bytes_sent += sizeof(DataType) * local_size;
   bytes_received += sizeof(DataType) * local_size * (El::mpi::Size(c) - 1);
 
+  const auto* hier_comms = get_hierarchical_comms(
+    c, sizeof(TensorDataType) * local_size);
+  const bool ordered = (m_deterministic_reductions
+                        && hier_comms == nullptr
+                        && m.GetDevice() == El::Device::CPU);
+  comm_profile::blocking_op profile(
+    comm_profile::collective::allreduce,
+    sizeof(TensorDataType) * local_size, El::mpi::Size(c),
+    hier_comms != nullptr ? "hierarchical" : (ordered ? "ordered" : "flat"));
+  wait_timer timer(wait_time);
+  if (hier_comms != nullptr) {
+    switch (m.GetDevice()) {
+    case El::Device::CPU:
+      return hierarchical_allreduce_impl(
+        static_cast<El::Matrix<TensorDataType, El::Device::CPU>&>(m),
+        hier_comms->local, hier_comms->cross, op);
+#ifdef LBANN_HAS_GPU
+    case El::Device::GPU:
+      return hierarchical_allreduce_impl(
+        static_cast<El::Matrix<TensorDataType, El::Device::GPU>&>(m),
+        hier_comms->local, hier_comms->cross, op);
+#endif // LBANN_HAS_GPU
+    }
+  }
+
+#ifdef LBANN_HAS_ALUMINUM
+  if (ordered) {
+    return ordered_allreduce_impl(
+      static_cast<El::Matrix<TensorDataType, El::Device::CPU>&>(m), c, op,
+      get_mpi_allreduce_algorithm());
+  }
+#endif // LBANN_HAS_ALUMINUM
+
   switch (m.GetDevice()) {
   case El::Device::CPU:
     return allreduce_impl(
@@ -364,11 +701,47 @@ void lbann_comm::nb_allreduce(El::AbstractMatrix<TensorDataType>& m,
   if (El::mpi::Size(c) == 1 || m.Height() < 1 || m.Width() < 1) {
     return;
   }
+  static const auto telemetry_region = telemetry::intern("nb_allreduce");
+  telemetry::scope telemetry_scope(telemetry::category::comm, telemetry_region);
 
   const int local_size = m.Height() * m.Width();
   bytes_sent += sizeof(DataType) * local_size;
   bytes_received += sizeof(DataType) * local_size * (El::mpi::Size(c) - 1);
 
+  const auto* hier_comms = get_hierarchical_comms(
+    c, sizeof(TensorDataType) * local_size);
+  const bool ordered = (m_deterministic_reductions
+                        && hier_comms == nullptr
+                        && m.GetDevice() == El::Device::CPU);
+  // The hierarchical and ordered host algorithms block, so they are
+  // exposed while launching
+  comm_profile::launch profile(
+    req.profile_id, comm_profile::collective::nb_allreduce,
+    sizeof(TensorDataType) * local_size, El::mpi::Size(c),
+    hier_comms != nullptr ? "hierarchical" : (ordered ? "ordered" : "flat"));
+  if (hier_comms != nullptr) {
+    switch (m.GetDevice()) {
+    case El::Device::CPU:
+      return hierarchical_allreduce_impl(
+        static_cast<El::Matrix<TensorDataType, El::Device::CPU>&>(m),
+        hier_comms->local, hier_comms->cross, op);
+#ifdef LBANN_HAS_GPU
+    case El::Device::GPU:
+      return hierarchical_allreduce_impl(
+        static_cast<El::Matrix<TensorDataType, El::Device::GPU>&>(m),
+        hier_comms->local, hier_comms->cross, op);
+#endif // LBANN_HAS_GPU
+    }
+  }
+
+#ifdef LBANN_HAS_ALUMINUM
+  if (ordered) {
+    return ordered_allreduce_impl(
+      static_cast<El::Matrix<TensorDataType, El::Device::CPU>&>(m), c, op,
+      get_mpi_allreduce_algorithm());
+  }
+#endif // LBANN_HAS_ALUMINUM
+
   switch (m.GetDevice()) {
   case El::Device::CPU:
     return nb_allreduce_impl(
@@ -391,6 +764,10 @@ void lbann_comm::nb_allreduce(El::AbstractDistMatrix<TensorDataType>& m,
 }
 
 void lbann_comm::wait(Al::request& req) {
+  static const auto telemetry_region = telemetry::intern("wait");
+  telemetry::scope telemetry_scope(telemetry::category::comm, telemetry_region);
+  comm_profile::wait_begin(req.profile_id);
+  wait_timer timer(wait_time);
 #ifdef LBANN_HAS_ALUMINUM
   if (req.mpi_req != Al::mpi_null_req) {
     ::Al::Wait<::Al::MPIBackend>(req.mpi_req);
@@ -408,6 +785,8 @@ void lbann_comm::wait(Al::request& req) {
   }
 #endif  // AL_HAS_MPI_CUDA
 #endif // LBANN_HAS_ALUMINUM
+  comm_profile::complete(req.profile_id);
+  req.profile_id = 0;
 }
 
 bool lbann_comm::test(Al::request& req) {
@@ -427,6 +806,10 @@ bool lbann_comm::test(Al::request& req) {
   }
 #endif  // AL_HAS_MPI_CUDA
 #endif // LBANN_HAS_ALUMINUM
+  if (req_test && req.profile_id != 0) {
+    comm_profile::complete(req.profile_id);
+    req.profile_id = 0;
+  }
   return req_test;
 }
 
@@ -461,6 +844,9 @@ void lbann_comm::global_barrier() {
 }
 
 void lbann_comm::barrier(const El::mpi::Comm& c) {
+  static const auto telemetry_region = telemetry::intern("barrier");
+  telemetry::scope telemetry_scope(telemetry::category::comm, telemetry_region);
+  wait_timer timer(wait_time);
   El::mpi::Barrier(c);
 }
 
@@ -25,6 +25,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <lbann/data_coordinator/data_coordinator.hpp>
+#include <lbann/data_store/data_store_conduit.hpp>
 #include <lbann/trainers/trainer.hpp>
 
 namespace lbann {
@@ -62,6 +63,29 @@ void data_coordinator::setup(int max_mini_batch_size) {
   }
 }
 
+void data_coordinator::resize_trainer() {
+  for(auto&& dr: m_data_readers) {
+    if (!dr.second) continue;
+    dr.second->set_rank(m_comm->get_rank_in_trainer());
+    calculate_num_iterations_per_epoch(m_trainer->get_max_mini_batch_size(), dr.second);
+    if (dr.second->get_data_store_ptr() != nullptr) {
+      dr.second->get_data_store_ptr()->rebalance_after_trainer_resize();
+    }
+  }
+}
+
+int data_coordinator::get_prefetch_depth() {
+  options *opts = options::get();
+  int depth = 1;
+  if (opts->has_int("prefetch_depth")) {
+    depth = opts->get_int("prefetch_depth");
+  }
+  if (depth < 1) {
+    LBANN_ERROR("--prefetch_depth must be at least 1; got ", depth);
+  }
+  return depth;
+}
+
 void data_coordinator::calculate_num_iterations_per_epoch(int max_mini_batch_size, generic_data_reader *data_reader) {
   if(data_reader == nullptr) { return; }
   // If the data reader does not have any data bail out (e.g. unused validation reader)
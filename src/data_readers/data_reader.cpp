@@ -30,8 +30,18 @@
 #include "lbann/data_store/data_store_conduit.hpp"
 #include "lbann/utils/omp_pragma.hpp"
 #include "lbann/trainers/trainer.hpp"
+#include "lbann/utils/lbann_library.hpp"
+#include "lbann/utils/io_profile.hpp"
+#include "lbann/utils/telemetry.hpp"
+#include "lbann/utils/timer.hpp"
 #include <omp.h>
+#include <chrono>
+#include <exception>
 #include <future>
+#include <numeric>
+#include <atomic>
+#include <random>
+#include <thread>
 #include "lbann/io/persist.hpp"
 #include "lbann/execution_contexts/sgd_execution_context.hpp"
 #include <cereal/archives/binary.hpp>
@@ -42,8 +52,50 @@ namespace lbann {
 #undef DEBUG
 //#define DEBUG
 
+namespace {
+
+/** Set while an I/O thread fetches a sample that the background
+ *  preload has already put in the data store, so the reader takes it
+ *  from there. */
+thread_local bool t_fetching_stored_sample = false;
+
+} // namespace
+
+struct generic_data_reader::background_preload_state {
+  std::thread thread;
+  std::atomic<bool> stop{false};
+  std::exception_ptr error;
+  size_t num_loaded = 0;
+};
+
+generic_data_reader::~generic_data_reader() {
+  if (m_background_preload != nullptr
+      && m_background_preload->thread.joinable()) {
+    m_background_preload->stop = true;
+    m_background_preload->thread.join();
+  }
+}
+
 void generic_data_reader::shuffle_indices() {
-  shuffle_indices(get_data_seq_generator());
+  if (m_shuffle_count == 0) {
+    m_shuffle_seed = get_data_seq_generator()();
+  }
+  ++m_shuffle_count;
+  regenerate_shuffled_indices();
+}
+
+void generic_data_reader::regenerate_shuffled_indices() {
+  if (m_shuffle_count == 0) { return; }
+  // Bucketing reorders unshuffled indices too, so start over from
+  // the sorted indices whenever the order changes
+  if (m_shuffle || options::get()->get_bool("bucket_by_length")) {
+    std::sort(m_shuffled_indices.begin(), m_shuffled_indices.end());
+  }
+  std::seed_seq seq{m_shuffle_seed,
+                    static_cast<uint32_t>(m_shuffle_count),
+                    static_cast<uint32_t>(m_shuffle_count >> 32)};
+  rng_gen gen(seq);
+  shuffle_indices(gen);
 }
 
 void generic_data_reader::shuffle_indices(rng_gen& gen) {
@@ -52,6 +104,98 @@ void generic_data_reader::shuffle_indices(rng_gen& gen) {
     std::shuffle(m_shuffled_indices.begin(), m_shuffled_indices.end(),
                  gen);
   }
+  if (options::get()->get_bool("bucket_by_length")) {
+    bucket_by_length(gen);
+  }
+  if (m_shuffle) {
+    if (m_data_store != nullptr && m_data_store->is_locality_aware_shuffle()) {
+      m_data_store->localize_shuffled_indices(m_shuffled_indices);
+    }
+  }
+}
+
+void generic_data_reader::bucket_by_length(rng_gen& gen) {
+  // Mini-batch k is m_shuffled_indices[k*mb, (k+1)*mb); before the data
+  // coordinator has set the global size, the prototext size is the same
+  const int mb = m_global_mini_batch_size > 0 ? m_global_mini_batch_size : m_mini_batch_size;
+  const int n = m_shuffled_indices.size();
+  if (mb <= 1 || n == 0) {
+    return;
+  }
+  if (get_sample_length(m_shuffled_indices[0]) < 0) {
+    static bool warned = false;
+    if (is_master() && !warned) {
+      LBANN_WARNING("--bucket_by_length is ignored: ", get_type(), " does not report sample lengths");
+      warned = true;
+    }
+    return;
+  }
+  int window = 100;
+  if (options::get()->has_int("bucket_window")) {
+    window = options::get()->get_int("bucket_window");
+  }
+  if (window < 1) {
+    LBANN_ERROR("--bucket_window must be at least 1; got ", window);
+  }
+
+  std::vector<std::pair<int, int>> samples(n); // (length, data_id)
+  LBANN_OMP_PARALLEL_FOR
+  for (int j = 0; j < n; ++j) {
+    samples[j] = std::make_pair(get_sample_length(m_shuffled_indices[j]), m_shuffled_indices[j]);
+  }
+
+  // Sort each window; the sort is stable so equal lengths keep their
+  // shuffled order. The partial mini-batch at the end is left alone.
+  const int num_batches = n / mb;
+  const int full = num_batches * mb;
+  const int window_size = window * mb;
+  const auto by_length = [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+    return a.first < b.first;
+  };
+  for (int begin = 0; begin < full; begin += window_size) {
+    std::stable_sort(samples.begin() + begin,
+                     samples.begin() + std::min(full, begin + window_size),
+                     by_length);
+  }
+
+  std::vector<int> batch_order(num_batches);
+  std::iota(batch_order.begin(), batch_order.end(), 0);
+  if (m_shuffle) {
+    std::shuffle(batch_order.begin(), batch_order.end(), gen);
+  }
+
+  int max_id = 0;
+  for (const auto& s : samples) {
+    max_id = std::max(max_id, s.second);
+  }
+  m_bucket_lengths.assign(max_id + 1, 0);
+  const auto place_batch = [&](int src, int dst, int size) {
+    int len = 0;
+    for (int j = 0; j < size; ++j) {
+      len = std::max(len, samples[src + j].first);
+    }
+    for (int j = 0; j < size; ++j) {
+      m_shuffled_indices[dst + j] = samples[src + j].second;
+      m_bucket_lengths[samples[src + j].second] = len;
+    }
+  };
+  for (int k = 0; k < num_batches; ++k) {
+    place_batch(batch_order[k] * mb, k * mb, mb);
+  }
+  if (full < n) {
+    place_batch(full, full, n - full);
+  }
+}
+
+int generic_data_reader::get_effective_length(const El::Matrix<El::Int>& indices) const {
+  int len = 0;
+  for (El::Int j = 0; j < indices.Height(); ++j) {
+    const El::Int id = indices(j, 0);
+    if (id >= 0 && id < static_cast<El::Int>(m_bucket_lengths.size())) {
+      len = std::max(len, m_bucket_lengths[id]);
+    }
+  }
+  return len;
 }
 
   /// @todo BVE FIXME
@@ -79,16 +223,37 @@ void generic_data_reader::setup(int num_io_threads, observer_ptr<thread_pool> io
 
 
 bool lbann::generic_data_reader::fetch_data_block(CPUMat& X, El::Int thread_id, El::Int mb_size, El::Matrix<El::Int>& indices_fetched) {
+  static const auto telemetry_region = telemetry::intern("fetch_data_block");
+  telemetry::scope telemetry_scope(telemetry::category::io, telemetry_region);
+  io_profile::busy_scope profile;
   std::string error_message;
-  for (int s = thread_id; s < mb_size; s+=m_io_thread_pool->get_num_threads()) {
-    int n = m_current_pos + (s * m_sample_stride);
-    int index = m_shuffled_indices[n];
-    bool valid = fetch_datum(X, index, s);
-    if (!valid) {
-      error_message = "invalid datum (index " + std::to_string(index) + ")";
+  // The chunks were dealt out by fetch_data; once this thread's own
+  // chunks are done, it steals from the threads that are behind
+  size_t begin, end;
+  const bool batch_transforms = supports_batched_transforms()
+    && m_transform_pipeline.supports_batch();
+  while (m_io_thread_pool->get_next_chunk(thread_id, begin, end)) {
+    transform::deferred_batch_scope defer(batch_transforms);
+    prefetch_data_chunk(begin, end);
+    for (int s = begin; s < static_cast<int>(end); ++s) {
+      int n = m_current_pos + (s * m_sample_stride);
+      int index = get_shuffled_index(n);
+      t_fetching_stored_sample = (m_background_preload != nullptr
+                                  && m_data_store->is_background_loading()
+                                  && m_data_store->has_conduit_node(index));
+      bool valid = fetch_datum(X, index, s);
+      t_fetching_stored_sample = false;
+      if (!valid) {
+        error_message = "invalid datum (index " + std::to_string(index) + ")";
+      }
+      if (!error_message.empty()) { LBANN_ERROR(error_message); }
+      indices_fetched.Set(s, 0, index);
+    }
+    io_profile::add_samples(end - begin);
+    if (batch_transforms) {
+      auto X_chunk = X(El::IR(0, X.Height()), El::IR(begin, end));
+      m_transform_pipeline.apply_batch(X_chunk);
     }
-    if (!error_message.empty()) { LBANN_ERROR(error_message); }
-    indices_fetched.Set(s, 0, index);
   }
   return true;
 }
@@ -109,7 +274,7 @@ int lbann::generic_data_reader::fetch_data(CPUMat& X, El::Matrix<El::Int>& indic
 
   int loaded_batch_size = get_loaded_mini_batch_size();
 
-  const int end_pos = std::min(static_cast<size_t>(m_current_pos+loaded_batch_size), m_shuffled_indices.size());
+  const int end_pos = std::min(m_current_pos+loaded_batch_size, get_num_data());
   const int mb_size = std::min(El::Int{((end_pos - m_current_pos) + m_sample_stride - 1) / m_sample_stride},
       X.Width());
 
@@ -120,6 +285,10 @@ int lbann::generic_data_reader::fetch_data(CPUMat& X, El::Matrix<El::Int>& indic
   /// to seeing if the local rank's position is valid.  Note that
   /// every rank will hold data that may be used in the last mini-batch
   if (data_store_active()) {
+    // The first epoch is over, so the background preload is done
+    if (m_background_preload != nullptr) {
+      finish_background_preload();
+    }
     m_data_store->exchange_mini_batch_data(m_current_pos-m_base_offset-m_model_offset, loaded_batch_size);
   }
 
@@ -133,6 +302,13 @@ int lbann::generic_data_reader::fetch_data(CPUMat& X, El::Matrix<El::Int>& indic
     }
   }
 
+  if (m_background_preload == nullptr && at_new_epoch()
+      && options::get()->has_int("data_store_background_preload")
+      && priming_data_store() && m_data_store->is_explicitly_loading()
+      && !m_data_store->is_local_cache()) {
+    start_background_preload();
+  }
+
   /// Allow each thread to perform any preprocessing necessary on the
   /// data source prior to fetching data
   for (int t = 0; t < static_cast<int>(m_io_thread_pool->get_num_threads()); t++) {
@@ -145,6 +321,15 @@ int lbann::generic_data_reader::fetch_data(CPUMat& X, El::Matrix<El::Int>& indic
     set_jag_variables(mb_size);
   }
 
+  // Split the mini-batch into chunks that idle threads can steal;
+  // by default each thread starts with about four chunks
+  const int num_io_threads = std::max(static_cast<int>(m_io_thread_pool->get_num_threads()), 1);
+  int chunk_size = (mb_size + 4*num_io_threads - 1) / (4*num_io_threads);
+  if (options::get()->has_int("fetch_chunk_size")) {
+    chunk_size = options::get()->get_int("fetch_chunk_size");
+  }
+  m_io_thread_pool->partition_work(mb_size, chunk_size, num_io_threads);
+
   for (int t = 0; t < static_cast<int>(m_io_thread_pool->get_num_threads()); t++) {
     // Queue up work into other threads and then finish off the
     // mini-batch in the active thread
@@ -170,6 +355,47 @@ int lbann::generic_data_reader::fetch_data(CPUMat& X, El::Matrix<El::Int>& indic
   return mb_size;
 }
 
+#ifdef LBANN_HAS_GPU
+int lbann::generic_data_reader::fetch_data_on_device(El::Matrix<DataType, El::Device::GPU>& X,
+                                                     El::Matrix<El::Int>& indices_fetched,
+                                                     cudaStream_t stream) {
+  int loaded_batch_size = get_loaded_mini_batch_size();
+
+  const int end_pos = std::min(m_current_pos+loaded_batch_size, get_num_data());
+  const int mb_size = std::min(El::Int{((end_pos - m_current_pos) + m_sample_stride - 1) / m_sample_stride},
+      X.Width());
+
+  El::Zeros_seq(indices_fetched, mb_size, 1);
+
+  /// As in fetch_data, every rank participates in the data store
+  /// exchange before checking its position
+  if (data_store_active()) {
+    m_data_store->exchange_mini_batch_data(m_current_pos-m_base_offset-m_model_offset, loaded_batch_size);
+  }
+
+  if(!position_valid()) {
+    if(position_is_overrun()) {
+      return 0;
+    }else {
+      LBANN_ERROR(std::string{} + "generic data reader load error: !position_valid"
+                  + " -- current pos = " + std::to_string(m_current_pos)
+                  + " and there are " + std::to_string(m_shuffled_indices.size()) + " indices");
+    }
+  }
+
+  // Columns past the end of a short mini-batch are zeroed, as on the host
+  if (mb_size < X.Width()) {
+    CHECK_CUDA(cudaMemset2DAsync(X.Buffer(0, mb_size), X.LDim() * sizeof(DataType), 0,
+                                 X.Height() * sizeof(DataType), X.Width() - mb_size,
+                                 stream));
+  }
+  if (mb_size > 0) {
+    fetch_data_block_on_device(X, mb_size, indices_fetched, stream);
+  }
+  return mb_size;
+}
+#endif // LBANN_HAS_GPU
+
 void lbann::generic_data_reader::set_jag_variables(int mb_size) {
   // all min_batches have the same number of indices;
   // this probably causes a few indices to be discarded,
@@ -198,8 +424,7 @@ void lbann::generic_data_reader::set_jag_variables(int mb_size) {
 
 int lbann::generic_data_reader::fetch_labels(CPUMat& Y) {
   int loaded_batch_size = get_loaded_mini_batch_size();
-  const int end_pos = std::min(static_cast<size_t>(m_current_pos+loaded_batch_size),
-                               m_shuffled_indices.size());
+  const int end_pos = std::min(m_current_pos+loaded_batch_size, get_num_data());
   const int mb_size = std::min(
     El::Int{((end_pos - m_current_pos) + m_sample_stride - 1) / m_sample_stride},
     Y.Width());
@@ -219,7 +444,7 @@ int lbann::generic_data_reader::fetch_labels(CPUMat& Y) {
   std::string error_message;
   for (int s = 0; s < mb_size; s++) {
     int n = m_current_pos + (s * m_sample_stride);
-    int index = m_shuffled_indices[n];
+    int index = get_shuffled_index(n);
     bool valid = fetch_label(Y, index, s);
     if (!valid) {
       error_message = "invalid label (index " + std::to_string(index) + ")";
@@ -232,8 +457,7 @@ int lbann::generic_data_reader::fetch_labels(CPUMat& Y) {
 
 int lbann::generic_data_reader::fetch_responses(CPUMat& Y) {
   int loaded_batch_size = get_loaded_mini_batch_size();
-  const int end_pos = std::min(static_cast<size_t>(m_current_pos+loaded_batch_size),
-                               m_shuffled_indices.size());
+  const int end_pos = std::min(m_current_pos+loaded_batch_size, get_num_data());
   const int mb_size = std::min(
     El::Int{((end_pos - m_current_pos) + m_sample_stride - 1) / m_sample_stride},
     Y.Width());
@@ -253,7 +477,7 @@ int lbann::generic_data_reader::fetch_responses(CPUMat& Y) {
   std::string error_message;
   for (int s = 0; s < mb_size; s++) {
     int n = m_current_pos + (s * m_sample_stride);
-    int index = m_shuffled_indices[n];
+    int index = get_shuffled_index(n);
     bool valid = fetch_response(Y, index, s);
     if (!valid) {
       error_message = "invalid response (index " + std::to_string(index) + ")";
@@ -274,12 +498,12 @@ bool generic_data_reader::update(bool is_active_reader) {
   if (m_loaded_mini_batch_idx >= m_num_iterations_per_epoch) {
     reader_not_done = false;
   }
-  if ((size_t)m_current_pos >= m_shuffled_indices.size()) {
+  if (m_current_pos >= get_num_data()) {
     reader_not_done = false;
   }
   if (m_current_mini_batch_idx == m_num_iterations_per_epoch) {
     // for working with 1B jag samples, we may not process all the data
-    if ((get_rank() < m_num_parallel_readers) && (m_current_pos < (int)m_shuffled_indices.size()) && !m_jag_partitioned) {
+    if ((get_rank() < m_num_parallel_readers) && (m_current_pos < get_num_data()) && !m_jag_partitioned) {
       throw lbann_exception(
         std::string{} + __FILE__ + " " + std::to_string(__LINE__)
         + " :: generic data reader update error: the epoch is complete,"
@@ -308,6 +532,28 @@ bool generic_data_reader::update(bool is_active_reader) {
   return reader_not_done;
 }
 
+bool generic_data_reader::begin_lookahead(int k) {
+  m_saved_current_pos = m_current_pos;
+  m_saved_current_mini_batch_idx = m_current_mini_batch_idx;
+  m_saved_loaded_mini_batch_idx = m_loaded_mini_batch_idx;
+  for (int j=0; j<k; j++) {
+    if (m_current_mini_batch_idx + 1 >= m_num_iterations_per_epoch) {
+      end_lookahead();
+      return false;
+    }
+    m_current_pos = get_next_position();
+    m_loaded_mini_batch_idx += m_iteration_stride;
+    m_current_mini_batch_idx++;
+  }
+  return true;
+}
+
+void generic_data_reader::end_lookahead() {
+  m_current_pos = m_saved_current_pos;
+  m_current_mini_batch_idx = m_saved_current_mini_batch_idx;
+  m_loaded_mini_batch_idx = m_saved_loaded_mini_batch_idx;
+}
+
 int generic_data_reader::get_loaded_mini_batch_size() const {
   if (m_loaded_mini_batch_idx >= (m_num_iterations_per_epoch-1)) {
     return m_last_mini_batch_size;
@@ -575,6 +821,7 @@ bool generic_data_reader::save_to_checkpoint_shared(persist& p, execution_mode m
 /** \brief Given directory to store checkpoint files, read state from file and add to number of bytes read */
 bool lbann::generic_data_reader::load_from_checkpoint_shared(persist& p, execution_mode mode) {
   load_from_shared_cereal_archive<generic_data_reader>(*this, p, mode, *get_comm(), "_dr.xml");
+  regenerate_shuffled_indices();
   // Adjust current position to deal with fact that it was just loaded to all ranks from rank 0 (differs by rank #)
   m_current_pos += m_comm->get_rank_in_trainer();
   return true;
@@ -587,6 +834,7 @@ bool generic_data_reader::save_to_checkpoint_distributed(persist& p, execution_m
 
 bool lbann::generic_data_reader::load_from_checkpoint_distributed(persist& p, execution_mode mode) {
   read_cereal_archive<generic_data_reader>(*this, p, mode, "_dc.xml");
+  regenerate_shuffled_indices();
   return true;
 }
 
@@ -747,9 +995,17 @@ void generic_data_reader::setup_data_store(int mini_batch_size) {
   }
 
   m_data_store->setup(mini_batch_size);
+
+  // the owner map is now known, so the first epoch can use it as well
+  if (m_shuffle && m_data_store->is_locality_aware_shuffle()) {
+    m_data_store->localize_shuffled_indices(m_shuffled_indices);
+  }
 }
 
 bool generic_data_reader::data_store_active() const {
+  if (t_fetching_stored_sample) {
+    return true;
+  }
   if (m_data_store != nullptr && m_data_store->is_fully_loaded()) {
     return true;
   }
@@ -765,6 +1021,9 @@ bool generic_data_reader::data_store_active() const {
 }
 
 bool generic_data_reader::priming_data_store() const {
+  if (t_fetching_stored_sample) {
+    return false;
+  }
   const auto& c = static_cast<const sgd_execution_context&>(m_trainer->get_data_coordinator().get_execution_context());
   if (m_data_store != nullptr && m_data_store->is_fully_loaded()) {
     return false;
@@ -825,16 +1084,25 @@ void generic_data_reader::preload_data_store() {
   else {
     std::vector<int> local_list_sizes;
     int np = m_comm->get_procs_per_trainer();
-    int base_files_per_rank = m_shuffled_indices.size() / np;
-    int extra = m_shuffled_indices.size() - (base_files_per_rank*np);
-    if (extra > np) {
-      LBANN_ERROR("extra > np");
-    }
     local_list_sizes.resize(np, 0);
-    for (int j=0; j<np; j++) {
-      local_list_sizes[j] = base_files_per_rank;
-      if (j < extra) {
-        local_list_sizes[j] += 1;
+    if (!m_shard_offsets.empty()) {
+      // Each rank owns the samples of its shard that are in use
+      for (auto index : m_shuffled_indices) {
+        const int r = std::upper_bound(m_shard_offsets.begin(), m_shard_offsets.end(), index)
+                      - m_shard_offsets.begin() - 1;
+        ++local_list_sizes[r];
+      }
+    } else {
+      int base_files_per_rank = m_shuffled_indices.size() / np;
+      int extra = m_shuffled_indices.size() - (base_files_per_rank*np);
+      if (extra > np) {
+        LBANN_ERROR("extra > np");
+      }
+      for (int j=0; j<np; j++) {
+        local_list_sizes[j] = base_files_per_rank;
+        if (j < extra) {
+          local_list_sizes[j] += 1;
+        }
       }
     }
     m_data_store->set_profile_msg("generic_data_reader::preload_data_store() calling m_data_store->build_preloaded_owner_map()");
@@ -846,6 +1114,138 @@ void generic_data_reader::preload_data_store() {
 
 }
 
+void generic_data_reader::start_background_preload() {
+  m_background_preload = std::make_shared<background_preload_state>();
+  if (!supports_background_preload()) {
+    if (is_master()) {
+      LBANN_WARNING("the ", get_type(), " reader does not support "
+                    "--data_store_background_preload; ignoring it");
+    }
+    return;
+  }
+  const int rate = options::get()->get_int("data_store_background_preload");
+  if (rate <= 0) {
+    LBANN_ERROR("--data_store_background_preload=", rate,
+                " must be a positive number of samples per second");
+  }
+
+  // The samples this rank will fetch in the rest of the epoch, in
+  // order; the current mini-batch is left to the I/O threads
+  std::vector<int> indices;
+  begin_lookahead(0);
+  while (m_current_mini_batch_idx + 1 < m_num_iterations_per_epoch) {
+    m_current_pos = get_next_position();
+    m_loaded_mini_batch_idx += m_iteration_stride;
+    m_current_mini_batch_idx++;
+    if (!position_valid()) {
+      break;
+    }
+    const int end_pos = std::min(m_current_pos + get_loaded_mini_batch_size(), get_num_data());
+    for (int n = m_current_pos; n < end_pos; n += m_sample_stride) {
+      indices.push_back(get_shuffled_index(n));
+    }
+  }
+  end_lookahead();
+
+  m_data_store->set_is_background_loading(true);
+  auto state = m_background_preload;
+  state->thread = std::thread([this, state, rate](std::vector<int> indices) {
+    try {
+      conduit::Node node;
+      const auto start = std::chrono::steady_clock::now();
+      for (const int index : indices) {
+        if (state->stop) {
+          break;
+        }
+        // Skip samples the I/O threads have caught up with
+        if (m_data_store->has_conduit_node(index)) {
+          continue;
+        }
+        load_data_store_node(index, node);
+        m_data_store->set_conduit_node(index, node);
+        ++state->num_loaded;
+        std::this_thread::sleep_until(
+          start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(double(state->num_loaded) / rate)));
+      }
+    } catch (...) {
+      state->error = std::current_exception();
+    }
+  }, std::move(indices));
+}
+
+void generic_data_reader::finish_background_preload() {
+  auto& state = *m_background_preload;
+  if (!state.thread.joinable()) {
+    return;
+  }
+  state.stop = true;
+  state.thread.join();
+  m_data_store->set_is_background_loading(false);
+  if (state.error) {
+    std::rethrow_exception(state.error);
+  }
+  if (is_master()) {
+    std::cout << "data reader for role " << get_role() << ": the background "
+              << "preload loaded " << state.num_loaded << " samples during "
+              << "the first epoch" << std::endl;
+  }
+}
+
+void generic_data_reader::parallel_preload_data_store(const std::function<void(int, conduit::Node&)> &loader) {
+  options *opts = options::get();
+  double tm1 = get_time();
+  const int rank = m_comm->get_rank_in_trainer();
+
+  // the samples I own; index order tends to be file order
+  std::vector<int> my_indices;
+  for (auto index : m_shuffled_indices) {
+    if (m_data_store->get_index_owner(index) == rank) {
+      my_indices.push_back(index);
+    }
+  }
+  std::sort(my_indices.begin(), my_indices.end());
+
+  const bool verbose = m_comm->am_trainer_master();
+  const size_t report_interval = std::max(my_indices.size()/10, static_cast<size_t>(1));
+  std::atomic<size_t> next(0);
+  std::atomic<size_t> num_loaded(0);
+  auto work = [&]() -> bool {
+    conduit::Node node;
+    for (size_t k = next++; k < my_indices.size(); k = next++) {
+      const int index = my_indices[k];
+      loader(index, node);
+      m_data_store->set_preloaded_conduit_node(index, node);
+      const size_t n = ++num_loaded;
+      if (verbose && (n % report_interval == 0 || n == my_indices.size())) {
+        std::stringstream msg;
+        msg << "preload for role: " << get_role() << "; loaded " << n
+            << " of " << my_indices.size() << " samples in "
+            << get_time() - tm1 << "s\n";
+        std::cout << msg.str() << std::flush;
+      }
+    }
+    return true;
+  };
+
+  if (opts->get_bool("data_store_no_thread")) {
+    work();
+    return;
+  }
+
+  std::shared_ptr<thread_pool> io_thread_pool = construct_io_thread_pool(m_comm, opts);
+  int num_threads = static_cast<int>(io_thread_pool->get_num_threads());
+  if (opts->has_int("data_store_preload_max_in_flight")) {
+    num_threads = std::max(1, std::min(num_threads, opts->get_int("data_store_preload_max_in_flight")));
+  }
+  // this thread is one of the workers
+  for (int t = 1; t < num_threads; t++) {
+    io_thread_pool->submit_job_to_work_group(work);
+  }
+  work();
+  io_thread_pool->finish_work_group();
+}
+
 void generic_data_reader::print_get_methods(const std::string filename) {
   if (!is_master()) {
     return;
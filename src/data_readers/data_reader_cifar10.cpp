@@ -86,57 +86,60 @@ void cifar10_reader::load() {
     LBANN_ERROR("Unsupported training mode for CIFAR loading.");
   }
 
+  m_files.clear();
+  m_images_per_file = images_per_file;
+  m_record_size = image_size + (cifar100 ?
+                                cifar100_label_size :
+                                cifar10_label_size);
+  // CIFAR-10 has only one label; for CIFAR-100, the second byte is the
+  // fine label.
+  m_label_offset = cifar100 ? 1 : 0;
   for (const auto& filename : filenames) {
-    std::ifstream f(path + "/" + filename,
-                    std::ios::in | std::ios::binary);
-    if (!f.good()) {
-      LBANN_ERROR("Could not open " + path + "/" + filename);
+    auto file = std::make_shared<mapped_file>(path + "/" + filename);
+    if (file->size() < images_per_file * m_record_size) {
+      LBANN_ERROR("Could not read from " + path + "/" + filename);
     }
-    // Temporary buffer to hold an image.
-    std::vector<uint8_t> buf(image_size + (cifar100 ?
-                                           cifar100_label_size :
-                                           cifar10_label_size), 0);
-    for (size_t i = 0; i < images_per_file; ++i) {
-      f.read(reinterpret_cast<char*>(buf.data()), buf.size());
-      if (static_cast<size_t>(f.gcount()) != buf.size()) {
-        LBANN_ERROR("Could not read from " + path + "/" + filename);
-      }
-      // CIFAR-10 has only one label; for CIFAR-100, the second byte is the
-      // fine label.
-      m_labels.push_back(buf[cifar100 ? 1 : 0]);
-      // Convert to OpenCV layout.
-      std::vector<uint8_t> image(image_size);
-      for (size_t channel = 0; channel < num_channels; ++channel) {
-        const size_t src_start = channel*channel_size;
-        for (size_t j = 0; j < channel_size; ++j) {
-          image[j*num_channels + channel] = buf[src_start + j];
-        }
-      }
-      m_images.push_back(std::move(image));
-    }
-    f.close();
+    m_files.push_back(std::move(file));
   }
+  const size_t num_images = m_files.size() * images_per_file;
 
   m_shuffled_indices.clear();
-  m_shuffled_indices.resize(m_images.size());
+  m_shuffled_indices.resize(num_images);
   std::iota(m_shuffled_indices.begin(), m_shuffled_indices.end(), 0);
   resize_shuffled_indices();
   select_subset_of_data();
 }
 
+const uint8_t* cifar10_reader::get_record(int data_id) const {
+  const auto* file = m_files[data_id / m_images_per_file].get();
+  const size_t offset = (data_id % m_images_per_file) * m_record_size;
+  return reinterpret_cast<const uint8_t*>(file->data()) + offset;
+}
+
 bool cifar10_reader::fetch_datum(CPUMat& X, int data_id, int mb_idx) {
-  // Copy to a matrix so we can do data augmentation.
   // Sizes per CIFAR-10/100 dataset description.
-  El::Matrix<uint8_t> image(3*32*32, 1);
-  std::vector<size_t> dims = {size_t(3), size_t(32), size_t(32)};
-  std::copy_n(m_images[data_id].data(), 3*32*32, image.Buffer());
+  constexpr size_t num_channels = 3;
+  constexpr size_t channel_size = 32*32;
+  // Interleave the mapped planes into OpenCV layout for the transforms.
+  thread_local El::Matrix<uint8_t> image;
+  image.Resize(num_channels*channel_size, 1);
+  const uint8_t* src = get_record(data_id) + m_record_size
+    - num_channels*channel_size;
+  uint8_t* __restrict__ dst = image.Buffer();
+  for (size_t channel = 0; channel < num_channels; ++channel) {
+    const uint8_t* __restrict__ plane = src + channel*channel_size;
+    for (size_t j = 0; j < channel_size; ++j) {
+      dst[j*num_channels + channel] = plane[j];
+    }
+  }
+  std::vector<size_t> dims = {num_channels, size_t(32), size_t(32)};
   auto X_v = X(El::IR(0, X.Height()), El::IR(mb_idx, mb_idx + 1));
   m_transform_pipeline.apply(image, X_v, dims);
   return true;
 }
 
 bool cifar10_reader::fetch_label(CPUMat& Y, int data_id, int mb_idx) {
-  Y.Set(m_labels[data_id], mb_idx, 1);
+  Y.Set(get_record(data_id)[m_label_offset], mb_idx, 1);
   return true;
 }
 
@@ -28,11 +28,133 @@
 
 #include <unordered_set>
 #include "lbann/data_readers/data_reader_csv.hpp"
+#include "lbann/utils/metadata_bundle.hpp"
 #include "lbann/utils/options.hpp"
 #include <omp.h>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <sys/stat.h>
 
 namespace lbann {
 
+namespace {
+
+/**
+ * Parse [begin, end) as a double with the result std::stod would give.
+ * Plain decimals whose mantissa and power of ten are exactly representable
+ * are converted directly (exact, hence correctly rounded); anything else
+ * goes through std::stod on a copy.
+ */
+double parse_double(const char* begin, const char* end) {
+  static const double pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  const char* p = begin;
+  while (p < end && *p == ' ') { ++p; }
+  const bool negative = (p < end && *p == '-');
+  if (p < end && (*p == '-' || *p == '+')) { ++p; }
+  uint64_t mantissa = 0;
+  int num_digits = 0;
+  int exponent = 0;
+  const char* digits_start = p;
+  for (; p < end && *p >= '0' && *p <= '9'; ++p, ++num_digits) {
+    mantissa = mantissa * 10 + (*p - '0');
+  }
+  bool has_digits = (p != digits_start);
+  if (p < end && *p == '.') {
+    const char* frac_start = ++p;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p, ++num_digits) {
+      mantissa = mantissa * 10 + (*p - '0');
+    }
+    exponent -= static_cast<int>(p - frac_start);
+    has_digits = has_digits || (p != frac_start);
+  }
+  if (has_digits && p < end && (*p == 'e' || *p == 'E')) {
+    const char* q = p + 1;
+    const bool exp_negative = (q < end && *q == '-');
+    if (q < end && (*q == '-' || *q == '+')) { ++q; }
+    int e = 0;
+    const char* exp_start = q;
+    for (; q < end && *q >= '0' && *q <= '9' && e < 10000; ++q) {
+      e = e * 10 + (*q - '0');
+    }
+    if (q != exp_start) {
+      exponent += exp_negative ? -e : e;
+      p = q;
+    }
+  }
+  while (p < end && (*p == ' ' || *p == '\r')) { ++p; }
+  if (has_digits && p == end && num_digits <= 19
+      && mantissa <= (uint64_t{1} << 53) && std::abs(exponent) <= 22) {
+    double val = static_cast<double>(mantissa);
+    val = (exponent < 0) ? val / pow10[-exponent] : val * pow10[exponent];
+    return negative ? -val : val;
+  }
+  const std::string str_val(begin, end);
+  try {
+    return std::stod(str_val);
+  } catch (std::invalid_argument& e) {
+    throw lbann_exception(
+      "csv_reader: could not convert '" + str_val + "'");
+  }
+}
+
+/// Header of a persisted line index (--csv_index_file).
+struct csv_index_header {
+  char magic[8];
+  uint64_t file_size;
+  int64_t file_mtime;
+  /// Offset of the first sample, which depends on the skip/header settings
+  uint64_t start;
+  uint64_t count;
+};
+const char csv_index_magic[8] = {'L', 'B', 'C', 'S', 'V', 'I', 'X', '1'};
+
+csv_index_header make_index_header(const std::string& csv_file, size_t start) {
+  csv_index_header hdr;
+  std::memset(&hdr, 0, sizeof(hdr));
+  std::memcpy(hdr.magic, csv_index_magic, sizeof(csv_index_magic));
+  struct stat st;
+  if (stat(csv_file.c_str(), &st) == 0) {
+    hdr.file_size = st.st_size;
+    hdr.file_mtime = st.st_mtime;
+  }
+  hdr.start = start;
+  return hdr;
+}
+
+/// Read a persisted index if it matches the CSV file; return false otherwise.
+bool read_index_file(const std::string& index_file, const csv_index_header& expected,
+                     std::vector<long long>& index) {
+  std::ifstream in(index_file, std::ios::binary);
+  csv_index_header hdr;
+  if (!in.read(reinterpret_cast<char*>(&hdr), sizeof(hdr))
+      || std::memcmp(hdr.magic, expected.magic, sizeof(hdr.magic)) != 0
+      || hdr.file_size != expected.file_size
+      || hdr.file_mtime != expected.file_mtime
+      || hdr.start != expected.start) {
+    return false;
+  }
+  index.resize(hdr.count);
+  return static_cast<bool>(
+    in.read(reinterpret_cast<char*>(index.data()), hdr.count * sizeof(long long)));
+}
+
+void write_index_file(const std::string& index_file, csv_index_header hdr,
+                      const std::vector<long long>& index) {
+  hdr.count = index.size();
+  std::ofstream out(index_file, std::ios::binary);
+  out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+  out.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(long long));
+  if (!out) {
+    LBANN_WARNING("csv_reader: failed to write the line index to ", index_file);
+  }
+}
+
+} // namespace
+
 csv_reader::csv_reader(bool shuffle)
   : generic_data_reader(shuffle) {}
 
@@ -49,6 +171,7 @@ csv_reader::csv_reader(const csv_reader& other) :
   m_num_cols(other.m_num_cols),
   m_num_samples(other.m_num_samples),
   m_num_labels(other.m_num_labels),
+  m_file(other.m_file),
   m_index(other.m_index),
   m_labels(other.m_labels),
   m_responses(other.m_responses),
@@ -74,6 +197,7 @@ csv_reader& csv_reader::operator=(const csv_reader& other) {
   m_num_cols = other.m_num_cols;
   m_num_samples = other.m_num_samples;
   m_num_labels = other.m_num_labels;
+  m_file = other.m_file;
   m_index = other.m_index;
   m_labels = other.m_labels;
   m_responses = other.m_responses;
@@ -96,58 +220,78 @@ csv_reader::~csv_reader() {
   }
 }
 
+void csv_reader::parse_header_line(const std::string& line) {
+  m_num_cols = std::count(line.begin(), line.end(), m_separator) + 1;
+  if (m_skip_cols >= m_num_cols) {
+    throw lbann_exception(
+      "csv_reader: asked to skip more columns than are present");
+  }
+
+  if (!m_disable_labels) {
+    if (m_label_col < 0) {
+      // Last column becomes the label column.
+      m_label_col = m_num_cols - 1;
+    }
+    if (m_label_col >= m_num_cols) {
+      throw lbann_exception(
+        "csv_reader: label column" + std::to_string(m_label_col) +
+        " is not present");
+    }
+  }
+
+  if (!m_disable_responses) {
+    if (m_response_col < 0) {
+      // Last column becomes the response column.
+      m_response_col = m_num_cols - 1;
+    }
+    if (m_response_col >= m_num_cols) {
+      throw lbann_exception(
+        "csv_reader: response column" + std::to_string(m_response_col) +
+        " is not present");
+    }
+  }
+}
+
 void csv_reader::load() {
   bool master = m_comm->am_world_master();
-  setup_ifstreams();
-  std::ifstream& ifs = *m_ifstreams[0];
-  const El::mpi::Comm& world_comm = m_comm->get_world_comm();
-  // Parse the header to determine how many columns there are.
-  // Skip rows if needed.
-  if (master) {
-    skip_rows(ifs, m_skip_rows);
+  if (options::get()->get_bool("csv_mmap")) {
+    m_file = std::make_shared<mapped_file>(get_file_dir() + get_data_filename());
+  } else {
+    setup_ifstreams();
   }
-  m_comm->broadcast<int>(0, m_skip_rows, world_comm);
+  const El::mpi::Comm& world_comm = m_comm->get_world_comm();
 
   //This will be broadcast from root to other procs, and will
   //then be converted to std::vector<int> m_labels; this is because
   //El::mpi::Broadcast<std::streampos> doesn't work
   std::vector<long long> index;
 
-  if (master) {
+  // Everything the master learns from the file is shared in one
+  // bundle, which may also be cached across runs
+  metadata_bundle metadata;
+  metadata_bundle::key metadata_key;
+  metadata_key.add_file(get_file_dir() + get_data_filename())
+    .add(m_skip_rows).add(m_skip_cols).add(m_has_header).add(m_separator)
+    .add(m_label_col).add(m_response_col)
+    .add(m_disable_labels).add(m_disable_responses)
+    .add(get_absolute_sample_count());
+  const bool cached = metadata.load_cached(*m_comm, world_comm, "csv",
+                                           metadata_key);
+
+  if (cached) {
+    // Nothing to build
+  } else if (master && m_file != nullptr) {
+    build_mapped_index(index);
+  } else if (master) {
+    std::ifstream& ifs = *m_ifstreams[0];
+    // Parse the header to determine how many columns there are.
+    // Skip rows if needed.
+    skip_rows(ifs, m_skip_rows);
     std::string line;
     std::streampos header_start = ifs.tellg();
     // TODO: Skip comment lines.
     if (std::getline(ifs, line)) {
-      m_num_cols = std::count(line.begin(), line.end(), m_separator) + 1;
-      if (m_skip_cols >= m_num_cols) {
-        throw lbann_exception(
-          "csv_reader: asked to skip more columns than are present");
-      }
-
-      if (!m_disable_labels) {
-        if (m_label_col < 0) {
-          // Last column becomes the label column.
-          m_label_col = m_num_cols - 1;
-        }
-        if (m_label_col >= m_num_cols) {
-          throw lbann_exception(
-            "csv_reader: label column" + std::to_string(m_label_col) +
-            " is not present");
-        }
-      }
-
-      if (!m_disable_responses) {
-        if (m_response_col < 0) {
-          // Last column becomes the response column.
-          m_response_col = m_num_cols - 1;
-        }
-        if (m_response_col >= m_num_cols) {
-          throw lbann_exception(
-            "csv_reader: response column" + std::to_string(m_response_col) +
-            " is not present");
-        }
-      }
-
+      parse_header_line(line);
     } else {
       throw lbann_exception(
         "csv_reader: failed to read header in " + get_data_filename());
@@ -237,11 +381,23 @@ void csv_reader::load() {
     ifs.clear();
   } // if (master)
 
-  m_comm->broadcast<int>(0, m_num_cols, world_comm);
+  if (!cached) {
+    if (master) {
+      metadata.put(m_skip_rows);
+      metadata.put(m_num_cols);
+      metadata.put(index);
+      metadata.put(m_responses);
+      metadata.put(m_labels);
+    }
+    metadata.share(*m_comm, world_comm);
+  }
+  metadata.get(m_skip_rows);
+  metadata.get(m_num_cols);
+  metadata.get(index);
+  metadata.get(m_responses);
+  metadata.get(m_labels);
   m_label_col = m_num_cols - 1;
 
-  //bcast the index vector
-  m_comm->world_broadcast<long long>(0, index);
   m_num_samples = index.size() - 1;
   if (m_master) std::cerr << "num samples: " << m_num_samples << "\n";
 
@@ -250,15 +406,10 @@ void csv_reader::load() {
     m_index.push_back(t);
   }
 
-  //optionally bcast the response vector
   if (!m_disable_responses) {
     m_response_col = m_num_cols - 1;
-    m_comm->world_broadcast<DataType>(0, m_responses);
   }
-
-  //optionally bcast the label vector
   if (!m_disable_labels) {
-    m_comm->world_broadcast<int>(0, m_labels);
     m_num_labels = m_labels.size();
   }
 
@@ -270,6 +421,10 @@ void csv_reader::load() {
 }
 
 bool csv_reader::fetch_datum(CPUMat& X, int data_id, int mb_idx) {
+  if (m_file != nullptr) {
+    fetch_mapped_datum(X, data_id, mb_idx);
+    return true;
+  }
   auto line = fetch_line_label_response(data_id);
   // TODO: Avoid unneeded copies.
   for (size_t i = 0; i < line.size(); ++i) {
@@ -278,6 +433,171 @@ bool csv_reader::fetch_datum(CPUMat& X, int data_id, int mb_idx) {
   return true;
 }
 
+void csv_reader::build_mapped_index(std::vector<long long>& index) {
+  const char* data = m_file->data();
+  const long long size = m_file->size();
+  // Offset just past the newline ending the line at pos (size + 1 if none).
+  auto next_line = [data, size](long long pos) -> long long {
+    const void* nl = std::memchr(data + pos, '\n', size - pos);
+    return (nl == nullptr) ? size + 1 : static_cast<const char*>(nl) - data + 1;
+  };
+
+  long long pos = 0;
+  for (int i = 0; i < m_skip_rows; ++i) {
+    if (pos >= size) {
+      throw lbann_exception("csv_reader: error on skipping rows");
+    }
+    pos = next_line(pos);
+  }
+  if (pos >= size) {
+    throw lbann_exception(
+      "csv_reader: failed to read header in " + get_data_filename());
+  }
+  const long long header_end = next_line(pos);
+  parse_header_line(std::string(data + pos, header_end - pos - 1));
+  if (header_end >= size) {
+    throw lbann_exception(
+      "csv_reader: reached EOF after reading header");
+  }
+  const long long start = m_has_header ? header_end : pos;
+
+  // Construct an index mapping each line (sample) to its offset, from the
+  // persisted index if there is a valid one.
+  const std::string csv_file = get_file_dir() + get_data_filename();
+  const bool persist = options::get()->has_string("csv_index_file");
+  const std::string index_file = persist ? options::get()->get_string("csv_index_file") : "";
+  const csv_index_header index_hdr = make_index_header(csv_file, start);
+  if (!persist || !read_index_file(index_file, index_hdr, index)) {
+    // Each thread collects the line starts within its chunk of the file
+    const int num_chunks = omp_get_max_threads();
+    std::vector<std::vector<long long>> chunk_starts(num_chunks);
+    const long long chunk_size = (size - start + num_chunks - 1) / num_chunks;
+    LBANN_OMP_PARALLEL_FOR
+    for (int t = 0; t < num_chunks; ++t) {
+      const long long begin = std::min(size, start + t * chunk_size);
+      const long long end = std::min(size, begin + chunk_size);
+      for (const char* p = data + begin;
+           (p = static_cast<const char*>(std::memchr(p, '\n', end - (p - data)))) != nullptr;
+           ++p) {
+        chunk_starts[t].push_back(p - data + 1);
+      }
+    }
+    index.clear();
+    index.push_back(start);
+    for (const auto& c : chunk_starts) {
+      index.insert(index.end(), c.begin(), c.end());
+    }
+    if (index.back() < size) {
+      // The last line has no newline.
+      index.push_back(size + 1);
+    }
+    if (persist) {
+      write_index_file(index_file, index_hdr, index);
+    }
+  }
+
+  const int num_samples_to_use = get_absolute_sample_count();
+  if (num_samples_to_use > 0
+      && static_cast<size_t>(num_samples_to_use) + 1 < index.size()) {
+    index.resize(num_samples_to_use + 1);
+  }
+
+  // Verify the column counts and extract labels and responses in parallel.
+  const long long num_lines = index.size() - 1;
+  if (!m_disable_labels) {
+    m_labels.resize(num_lines);
+  }
+  if (!m_disable_responses) {
+    m_responses.resize(num_lines);
+  }
+  std::atomic<long long> bad_line(num_lines);
+  std::atomic<long long> bad_value(num_lines);
+  LBANN_OMP_PARALLEL_FOR
+  for (long long l = 0; l < num_lines; ++l) {
+    const char* line = data + index[l];
+    const char* line_end = data + index[l+1] - 1;
+    if (std::count(line, line_end, m_separator) + 1 != m_num_cols) {
+      long long cur = bad_line;
+      while (l < cur && !bad_line.compare_exchange_weak(cur, l)) {}
+      continue;
+    }
+    try {
+      const char* cur_pos = line;
+      for (int col = 0; col < m_num_cols; ++col) {
+        const char* end_pos = static_cast<const char*>(
+          std::memchr(cur_pos, m_separator, line_end - cur_pos));
+        if (end_pos == nullptr) {
+          end_pos = line_end;
+        }
+        if (!m_disable_labels && col == m_label_col) {
+          m_labels[l] = m_label_transform(std::string(cur_pos, end_pos));
+        }
+        if (!m_disable_responses && col == m_response_col) {
+          m_responses[l] = m_response_transform(std::string(cur_pos, end_pos));
+        }
+        cur_pos = end_pos + 1;
+      }
+    } catch (std::exception&) {
+      long long cur = bad_value;
+      while (l < cur && !bad_value.compare_exchange_weak(cur, l)) {}
+    }
+  }
+  if (bad_line < num_lines) {
+    throw lbann_exception(
+      "csv_reader: line " + std::to_string(bad_line + 1) +
+      " does not have right number of entries");
+  }
+  if (bad_value < num_lines) {
+    throw lbann_exception(
+      "csv_reader: could not convert the label or response on line " +
+      std::to_string(bad_value + 1));
+  }
+
+  if (!m_disable_labels) {
+    // Do some simple validation checks on the classes.
+    // Ensure the elements begin with 0, and there are no gaps.
+    std::unordered_set<int> label_classes(m_labels.begin(), m_labels.end());
+    auto minmax = std::minmax_element(label_classes.begin(), label_classes.end());
+    if (*minmax.first != 0) {
+      throw lbann_exception(
+        "csv_reader: classes are not indexed from 0");
+    }
+    if (*minmax.second != (int) label_classes.size() - 1) {
+      throw lbann_exception(
+        "csv_reader: label classes are not contiguous");
+    }
+    m_num_labels = label_classes.size();
+  }
+}
+
+void csv_reader::fetch_mapped_datum(CPUMat& X, int data_id, int mb_idx) {
+  const char* cur_pos = m_file->data() + static_cast<std::streamoff>(m_index[data_id]);
+  const char* line_end = m_file->data() + static_cast<std::streamoff>(m_index[data_id+1]) - 1;
+  DataType* dest = X.Buffer(0, mb_idx);
+  // Note: load already verified that every line is properly formatted.
+  for (int col = 0; col < m_num_cols; ++col) {
+    const char* end_pos = static_cast<const char*>(
+      std::memchr(cur_pos, m_separator, line_end - cur_pos));
+    if (end_pos == nullptr) {
+      end_pos = line_end;
+    }
+    // Skip the label, response, and any columns if needed.
+    if ((!m_disable_labels && col == m_label_col) ||
+        (!m_disable_responses && col == m_response_col) ||
+        col < m_skip_cols) {
+      cur_pos = end_pos + 1;
+      continue;
+    }
+    const auto t = m_col_transforms.find(col);
+    if (t != m_col_transforms.end()) {
+      *dest++ = t->second(std::string(cur_pos, end_pos));
+    } else {
+      *dest++ = parse_double(cur_pos, end_pos);
+    }
+    cur_pos = end_pos + 1;
+  }
+}
+
 bool csv_reader::fetch_label(CPUMat& Y, int data_id, int mb_idx) {
   Y(m_labels[data_id], mb_idx) = 1;
   return true;
@@ -353,6 +673,11 @@ std::vector<DataType> csv_reader::fetch_line_label_response(
 }
 
 std::string csv_reader::fetch_raw_line(int data_id) {
+  if (m_file != nullptr) {
+    // Exclude the newline, as for the ifstream path.
+    const std::streamoff start = m_index[data_id];
+    return std::string(m_file->data() + start, m_index[data_id+1] - start - 1);
+  }
 static int n = 0;
   std::ifstream& ifs = *m_ifstreams[omp_get_thread_num()];
   // Seek to the start of this datum's line.
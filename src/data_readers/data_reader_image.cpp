@@ -31,6 +31,7 @@
 #include "lbann/utils/timer.hpp"
 #include "lbann/data_store/data_store_conduit.hpp"
 #include "lbann/utils/file_utils.hpp"
+#include "lbann/utils/io_profile.hpp"
 #include "lbann/utils/threads/thread_utils.hpp"
 #include "lbann/utils/lbann_library.hpp"
 #include <fstream>
@@ -57,6 +58,7 @@ image_data_reader& image_data_reader::operator=(const image_data_reader& rhs) {
   m_image_num_channels = rhs.m_image_num_channels;
   m_image_linearized_size = rhs.m_image_linearized_size;
   m_num_labels = rhs.m_num_labels;
+  m_decoded_cache = rhs.m_decoded_cache;
 
   return (*this);
 }
@@ -75,6 +77,7 @@ void image_data_reader::copy_members(const image_data_reader &rhs) {
   m_image_num_channels = rhs.m_image_num_channels;
   m_image_linearized_size = rhs.m_image_linearized_size;
   m_num_labels = rhs.m_num_labels;
+  m_decoded_cache = rhs.m_decoded_cache;
   //m_thread_cv_buffer = rhs.m_thread_cv_buffer
 }
 
@@ -129,26 +132,39 @@ bool image_data_reader::fetch_label(CPUMat& Y, int data_id, int mb_idx) {
   return true;
 }
 
-void image_data_reader::load() {
-  options *opts = options::get();
-
-  const std::string imageListFile = get_data_filename();
+namespace {
 
-  // load image list
-  m_image_list.clear();
-  FILE *fplist = fopen(imageListFile.c_str(), "rt");
+void read_image_list(const std::string& list_file,
+                     std::vector<image_data_reader::sample_t>& list) {
+  list.clear();
+  FILE *fplist = fopen(list_file.c_str(), "rt");
   if (!fplist) {
-    LBANN_ERROR("failed to open: " + imageListFile + " for reading");
+    LBANN_ERROR("failed to open: " + list_file + " for reading");
   }
   while (!feof(fplist)) {
     char imagepath[512];
-    label_t imagelabel;
+    image_data_reader::label_t imagelabel;
     if (fscanf(fplist, "%s%d", imagepath, &imagelabel) <= 1) {
       break;
     }
-    m_image_list.emplace_back(imagepath, imagelabel);
+    list.emplace_back(imagepath, imagelabel);
   }
   fclose(fplist);
+}
+
+} // namespace
+
+void image_data_reader::load() {
+  options *opts = options::get();
+
+  const std::string imageListFile = get_data_filename();
+
+  // load image list
+  if (opts->get_bool("image_list_shards")) {
+    load_list_shard(imageListFile);
+  } else {
+    read_image_list(imageListFile, m_image_list);
+  }
 
   // TODO: this will probably need to change after sample_list class
   //       is modified
@@ -164,7 +180,60 @@ void image_data_reader::load() {
   select_subset_of_data();
 }
 
+void image_data_reader::load_list_shard(const std::string& list_file) {
+  options *opts = options::get();
+  const int np = m_comm->get_procs_per_trainer();
+  const int rank = m_comm->get_rank_in_trainer();
+
+  std::vector<sample_t> shard;
+  read_image_list(list_file + ".p" + std::to_string(rank), shard);
+  if (shard.empty()) {
+    LBANN_ERROR("image list shard ", list_file, ".p", rank, " is empty");
+  }
+
+  // Place the shards one after another in the global index space
+  int shard_size = shard.size();
+  std::vector<int> shard_sizes(np);
+  m_comm->trainer_all_gather(shard_size, shard_sizes);
+  m_shard_offsets.assign(np+1, 0);
+  for (int r = 0; r < np; ++r) {
+    m_shard_offsets[r+1] = m_shard_offsets[r] + shard_sizes[r];
+  }
+
+  // Labels are needed for every sample this rank may train on
+  std::vector<label_t> my_labels(shard.size());
+  for (size_t j = 0; j < shard.size(); ++j) {
+    my_labels[j] = shard[j].second;
+  }
+  std::vector<label_t> labels(m_shard_offsets[np]);
+  std::vector<int> displacements(m_shard_offsets.begin(), m_shard_offsets.end()-1);
+  m_comm->trainer_all_gather(my_labels, labels, shard_sizes, displacements);
+
+  m_image_list.clear();
+  m_image_list.reserve(labels.size());
+  for (size_t j = 0; j < labels.size(); ++j) {
+    m_image_list.emplace_back(std::string(), labels[j]);
+  }
+  for (size_t j = 0; j < shard.size(); ++j) {
+    m_image_list[m_shard_offsets[rank] + j].first = std::move(shard[j].first);
+  }
+
+  // Other shards' images are only reachable through the data store
+  if (!opts->get_bool("preload_data_store")) {
+    if (is_master()) {
+      LBANN_WARNING("setting --preload_data_store, which --image_list_shards requires");
+    }
+    opts->set_option("preload_data_store", 1);
+  }
+  if (is_master()) {
+    std::cout << "image_data_reader: read " << shard.size()
+              << " samples from this rank's shard; " << labels.size()
+              << " samples in " << np << " shards" << std::endl;
+  }
+}
+
 void read_raw_data(const std::string &filename, std::vector<char> &data) {
+  io_profile::scope profile(io_profile::stage::read);
   data.clear();
   std::ifstream in(filename.c_str());
   if (!in) {
@@ -180,56 +249,8 @@ void read_raw_data(const std::string &filename, std::vector<char> &data) {
 
 
 void image_data_reader::do_preload_data_store() {
-  options *opts = options::get();
-
-  int rank = m_comm->get_rank_in_trainer();
-
-  bool threaded = ! options::get()->get_bool("data_store_no_thread");
-  if (threaded) {
-    if (is_master()) {
-      std::cout << "mode: data_store_thread\n";
-    }
-    std::shared_ptr<thread_pool> io_thread_pool = construct_io_thread_pool(m_comm, opts);
-    int num_threads = static_cast<int>(io_thread_pool->get_num_threads());
-
-    std::vector<std::unordered_set<int>> data_ids(num_threads);
-    int j = 0;
-    for (size_t data_id=0; data_id<m_shuffled_indices.size(); data_id++) {
-      int index = m_shuffled_indices[data_id];
-      if (m_data_store->get_index_owner(index) != rank) {
-        continue;
-      }
-      data_ids[j++].insert(index);
-      if (j == num_threads) {
-        j = 0;
-      }
-    }
-
-    for (int t = 0; t < num_threads; t++) {
-      if(t == io_thread_pool->get_local_thread_id()) {
-        continue;
-      } else {
-        io_thread_pool->submit_job_to_work_group(std::bind(&image_data_reader::load_conduit_nodes_from_file, this, data_ids[t]));
-      }
-    }
-    load_conduit_nodes_from_file(data_ids[io_thread_pool->get_local_thread_id()]);
-    io_thread_pool->finish_work_group();
-  }
-
-  else {
-    conduit::Node node;
-    if (is_master()) {
-      std::cout << "mode: NOT data_store_thread\n";
-    }
-    for (size_t data_id=0; data_id<m_shuffled_indices.size(); data_id++) {
-      int index = m_shuffled_indices[data_id];
-      if (m_data_store->get_index_owner(index) != rank) {
-        continue;
-      }
-      load_conduit_node_from_file(index, node);
-      m_data_store->set_preloaded_conduit_node(index, node);
-    }
-  }
+  parallel_preload_data_store(
+    [this](int data_id, conduit::Node &node) { load_conduit_node_from_file(data_id, node); });
 }
 
 void image_data_reader::setup(int num_io_threads, observer_ptr<thread_pool> io_thread_pool) {
@@ -238,6 +259,13 @@ void image_data_reader::setup(int num_io_threads, observer_ptr<thread_pool> io_t
     {static_cast<size_t>(m_image_num_channels),
      static_cast<size_t>(m_image_height),
      static_cast<size_t>(m_image_width)});
+  m_transform_pipeline.set_fuse(!options::get()->get_bool("no_fused_transforms"));
+  if (m_decoded_cache == nullptr && options::get()->has_int("decoded_image_cache_mb")) {
+    const int cache_mb = options::get()->get_int("decoded_image_cache_mb");
+    if (cache_mb > 0) {
+      m_decoded_cache = std::make_shared<decoded_image_cache>(size_t(cache_mb) << 20);
+    }
+  }
 }
 
 std::vector<image_data_reader::sample_t> image_data_reader::get_image_list_of_current_mb() const {
@@ -246,15 +274,6 @@ std::vector<image_data_reader::sample_t> image_data_reader::get_image_list_of_cu
   return ret;
 }
 
-bool image_data_reader::load_conduit_nodes_from_file(const std::unordered_set<int> &data_ids) {
-  conduit::Node node;
-  for (auto t : data_ids) {
-    load_conduit_node_from_file(t, node);
-    m_data_store->set_preloaded_conduit_node(t, node);
-  }
-  return true;
-}
-
 void image_data_reader::load_conduit_node_from_file(int data_id, conduit::Node &node) {
   node.reset();
   const std::string filename = get_file_dir() + m_image_list[data_id].first;
@@ -27,8 +27,13 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lbann/data_readers/data_reader_imagenet.hpp"
+#include "lbann/utils/async_read.hpp"
 #include "lbann/utils/image.hpp"
 #include "lbann/utils/file_utils.hpp"
+#ifdef LBANN_HAS_NVJPEG
+#include "lbann/utils/nvjpeg.hpp"
+#include <memory>
+#endif // LBANN_HAS_NVJPEG
 
 namespace lbann {
 
@@ -47,6 +52,11 @@ void imagenet_reader::set_defaults() {
   m_num_labels = 1000;
 }
 
+void imagenet_reader::setup(int num_io_threads, observer_ptr<thread_pool> io_thread_pool) {
+  image_data_reader::setup(num_io_threads, io_thread_pool);
+  m_async_file_reads = options::get()->get_bool("async_file_reads");
+}
+
 CPUMat imagenet_reader::create_datum_view(CPUMat& X, const int mb_idx) const {
   return El::View(X, El::IR(0, X.Height()), El::IR(mb_idx, mb_idx + 1));
 }
@@ -54,6 +64,96 @@ CPUMat imagenet_reader::create_datum_view(CPUMat& X, const int mb_idx) const {
 bool imagenet_reader::fetch_datum(CPUMat& X, int data_id, int mb_idx) {
   El::Matrix<uint8_t> image;
   std::vector<size_t> dims;
+  auto decode = [&]() {
+    if (!decode_prefetched(data_id, mb_idx, image, dims)) {
+      decode_datum(data_id, image, dims);
+    }
+  };
+  // Index of the first transform still to be applied
+  size_t first = 0;
+  if (m_decoded_cache != nullptr) {
+    first = m_transform_pipeline.get_deterministic_prefix();
+    if (!m_decoded_cache->get(data_id, image, dims)) {
+      decode();
+      if (m_decoded_cache->full()) {
+        first = 0;
+      } else {
+        m_transform_pipeline.apply_deterministic_prefix(image, dims);
+        m_decoded_cache->insert(data_id, image, dims);
+      }
+    }
+  } else {
+    decode();
+  }
+
+  auto X_v = create_datum_view(X, mb_idx);
+  m_transform_pipeline.apply(image, X_v, dims, first);
+
+  return true;
+}
+
+namespace {
+
+/** Encoded images of the chunk a thread is fetching. */
+struct prefetched_chunk {
+  /** Reader that read the chunk. */
+  const imagenet_reader* reader = nullptr;
+  /** First mini-batch column of the chunk. */
+  size_t begin = 0;
+  /** Sample of each column, or -1 if it was not read or has been
+   *  decoded. */
+  std::vector<int> data_ids;
+  /** Encoded image of each column, reused between chunks. */
+  std::vector<El::Matrix<uint8_t>> images;
+  file::batch_file_reader file_reader;
+};
+
+prefetched_chunk& get_prefetched_chunk() {
+  thread_local prefetched_chunk chunk;
+  return chunk;
+}
+
+} // namespace
+
+void imagenet_reader::prefetch_data_chunk(size_t begin, size_t end) {
+  if (!m_async_file_reads || m_data_store != nullptr) {
+    return;
+  }
+  auto& chunk = get_prefetched_chunk();
+  chunk.reader = this;
+  chunk.begin = begin;
+  chunk.data_ids.assign(end - begin, -1);
+  if (chunk.images.size() < end - begin) {
+    chunk.images.resize(end - begin);
+  }
+  for (size_t s = begin; s < end; ++s) {
+    const int data_id = get_shuffled_index(m_current_pos + s * m_sample_stride);
+    if (m_decoded_cache != nullptr && m_decoded_cache->contains(data_id)) {
+      continue;
+    }
+    chunk.file_reader.add(get_file_dir() + m_image_list[data_id].first,
+                          chunk.images[s - begin]);
+    chunk.data_ids[s - begin] = data_id;
+  }
+  chunk.file_reader.read();
+}
+
+bool imagenet_reader::decode_prefetched(int data_id, int mb_idx,
+                                        El::Matrix<uint8_t>& image,
+                                        std::vector<size_t>& dims) {
+  auto& chunk = get_prefetched_chunk();
+  const size_t i = mb_idx - chunk.begin;
+  if (chunk.reader != this || size_t(mb_idx) < chunk.begin
+      || i >= chunk.data_ids.size() || chunk.data_ids[i] != data_id) {
+    return false;
+  }
+  chunk.data_ids[i] = -1;
+  decode_image(chunk.images[i], image, dims);
+  return true;
+}
+
+void imagenet_reader::decode_datum(int data_id, El::Matrix<uint8_t>& image,
+                                   std::vector<size_t>& dims) {
   const std::string image_path = get_file_dir() + m_image_list[data_id].first;
   if (m_data_store != nullptr) {
     bool have_node = true;
@@ -98,11 +198,81 @@ bool imagenet_reader::fetch_datum(CPUMat& X, int data_id, int mb_idx) {
   else {
     load_image(image_path, image, dims);
   }
+}
 
-  auto X_v = create_datum_view(X, mb_idx);
-  m_transform_pipeline.apply(image, X_v, dims);
+#ifdef LBANN_HAS_NVJPEG
+bool imagenet_reader::supports_device_fetch() const {
+  if (!options::get()->get_bool("gpu_image_decode")) {
+    return false;
+  }
+  if (!m_transform_pipeline.supports_fuse()) {
+    static bool warned = false;
+    if (!warned && is_master()) {
+      LBANN_WARNING("--gpu_image_decode was given, but the transform pipeline "
+                    "cannot be fused; decoding images on the CPU");
+    }
+    warned = true;
+    return false;
+  }
+  return true;
+}
+
+void imagenet_reader::get_encoded_image(int data_id, conduit::Node& node) {
+  if (m_data_store == nullptr) {
+    load_conduit_node_from_file(data_id, node);
+  } else if (m_data_store->is_local_cache()) {
+    if (m_data_store->has_conduit_node(data_id)) {
+      node.set_external(m_data_store->get_conduit_node(data_id));
+    } else {
+      load_conduit_node_from_file(data_id, node);
+      m_data_store->set_conduit_node(data_id, node);
+    }
+  } else if (data_store_active()) {
+    node.set_external(m_data_store->get_conduit_node(data_id));
+  } else if (priming_data_store()) {
+    load_conduit_node_from_file(data_id, node);
+    m_data_store->set_conduit_node(data_id, node);
+  } else {
+    load_conduit_node_from_file(data_id, node);
+  }
+}
+
+bool imagenet_reader::fetch_data_block_on_device(El::Matrix<DataType, El::Device::GPU>& X,
+                                                 El::Int mb_size,
+                                                 El::Matrix<El::Int>& indices_fetched,
+                                                 cudaStream_t stream) {
+  // One decoder per thread, since nvJPEG state is not shareable
+  static thread_local std::unique_ptr<nvjpeg_image_decoder> decoder;
+  if (decoder == nullptr) {
+    decoder.reset(new nvjpeg_image_decoder());
+  }
+
+  // The nodes own (or reference) the encoded bytes until decoding is done
+  std::vector<conduit::Node> nodes(mb_size);
+  std::vector<const uint8_t*> data(mb_size);
+  std::vector<size_t> sizes(mb_size);
+  std::vector<std::vector<size_t>> dims(mb_size);
+  std::vector<transform::fused_image_op> ops(mb_size);
+  for (El::Int s = 0; s < mb_size; ++s) {
+    const int n = m_current_pos + (s * m_sample_stride);
+    const int index = m_shuffled_indices[n];
+    get_encoded_image(index, nodes[s]);
+    char *buf = nodes[s][LBANN_DATA_ID_STR(index) + "/buffer"].value();
+    sizes[s] = nodes[s][LBANN_DATA_ID_STR(index) + "/buffer_size"].value();
+    data[s] = reinterpret_cast<const uint8_t*>(buf);
+    dims[s] = decoder->get_dims(data[s], sizes[s]);
+    // Random choices are made here, on the host, as apply() would
+    std::vector<size_t> out_dims = dims[s];
+    m_transform_pipeline.fuse(ops[s], out_dims);
+    indices_fetched.Set(s, 0, index);
+  }
 
+  decoder->decode_and_transform(data, sizes, dims, ops,
+                                m_image_height, m_image_width, X, stream);
+  // The encoded bytes must outlive the (asynchronous) decode
+  CHECK_CUDA(cudaStreamSynchronize(stream));
   return true;
 }
+#endif // LBANN_HAS_NVJPEG
 
 }  // namespace lbann
@@ -42,6 +42,7 @@
 #include <numeric>    // accumulate
 #include <functional> // multiplies
 #include <type_traits>// is_same
+#include <cstring>    // memcpy
 #include <set>
 #include <map>
 #include <omp.h>
@@ -113,6 +114,12 @@ void data_reader_jag_conduit::shuffle_indices(rng_gen& gen) {
     return;
   }
   generic_data_reader::shuffle_indices(gen);
+  if (is_master() && (m_sample_list.get_num_file_opens() > 0u)) {
+    std::cout << "data_reader_jag_conduit - " << get_role()
+              << " samples per file open: "
+              << m_sample_list.get_samples_per_file_open() << std::endl;
+  }
+  m_sample_list.reset_open_file_stats();
   m_sample_list.compute_epochs_file_usage(get_shuffled_indices(), get_mini_batch_size(), *m_comm);
 }
 
@@ -179,6 +186,9 @@ void data_reader_jag_conduit::copy_members(const data_reader_jag_conduit& rhs) {
   m_cached_response_mb_size = rhs.m_cached_response_mb_size;
   m_cached_label_mb_size = rhs.m_cached_label_mb_size;
 
+  m_scalar_cache = rhs.m_scalar_cache;
+  m_input_cache = rhs.m_input_cache;
+
   m_image_normalization_params = rhs.m_image_normalization_params;
   m_scalar_normalization_params = rhs.m_scalar_normalization_params;
   m_input_normalization_params = rhs.m_input_normalization_params;
@@ -260,6 +270,11 @@ void data_reader_jag_conduit::set_defaults() {
 
 void data_reader_jag_conduit::setup(int num_io_threads, observer_ptr<thread_pool> io_thread_pool) {
   generic_data_reader::setup(num_io_threads, io_thread_pool);
+  // Number of upcoming bundle files to open ahead of the I/O threads
+  options *opts = options::get();
+  const int prefetch_files = opts->has_int("sample_list_prefetch_files")
+                             ? opts->get_int("sample_list_prefetch_files") : 2;
+  m_sample_list.set_prefetch_depth(static_cast<size_t>(std::max(prefetch_files, 0)));
 }
 
 #ifdef _USE_IO_HANDLE_
@@ -352,6 +367,99 @@ bool data_reader_jag_conduit::load_conduit_node(const size_t i, const std::strin
   return true;
 }
 
+void data_reader_jag_conduit::read_sample_fields(const size_t i,
+                                                 const std::vector<variable_t>& vars,
+                                                 conduit::Node& sample) const {
+  const auto uses = [&vars](variable_t vt) {
+    return std::find(vars.begin(), vars.end(), vt) != vars.end();
+  };
+  const sample_t& s = m_sample_list[i];
+  const std::string& sample_name = s.second;
+  const auto h = m_sample_list.get_samples_file_handle(s.first);
+  if (!m_sample_list.is_file_handle_valid(h)) {
+    return;
+  }
+  const std::string id_str = LBANN_DATA_ID_STR(i);
+
+  // Read a whole group in one call and copy out the requested children
+  const auto read_group = [&](const std::string& prefix,
+                              const std::vector<std::string>& keys) {
+    conduit::Node group;
+    try {
+      read_node(h, sample_name + prefix, group);
+    } catch (conduit::Error const&) {
+      return;
+    }
+    for (const auto& key : keys) {
+      if (group.has_child(key)) {
+        sample['/' + id_str + '/' + prefix + key].set(group[key]);
+      }
+    }
+  };
+
+  if (uses(JAG_Scalar)) {
+    read_group(m_output_scalar_prefix, m_scalar_keys);
+  }
+  if (uses(JAG_Input)) {
+    read_group(m_input_prefix, m_input_keys);
+  }
+  if (uses(JAG_Image)) {
+    // Images are large and the image group has more views than are used
+    for (const auto& emi_tag : m_emi_image_keys) {
+      const std::string conduit_field = m_output_image_prefix + emi_tag;
+      try {
+        conduit::Node n_image;
+        read_node(h, sample_name + conduit_field, n_image);
+        sample[id_str + conduit_field].set(n_image);
+      } catch (conduit::Error const&) {
+        // Left for get_image_data to report
+      }
+    }
+  }
+}
+
+bool data_reader_jag_conduit::variable_cache::get(CPUMat& X, size_t data_id, int mb_idx) const {
+  if (!has(data_id)) {
+    return false;
+  }
+  std::memcpy(X.Buffer(0, mb_idx), m_values.data() + data_id * m_width,
+              m_width * sizeof(DataType));
+  return true;
+}
+
+void data_reader_jag_conduit::variable_cache::put(const CPUMat& X, size_t data_id, int mb_idx) {
+  std::memcpy(m_values.data() + data_id * m_width, X.LockedBuffer(0, mb_idx),
+              m_width * sizeof(DataType));
+  m_filled[data_id] = 1;
+}
+
+void data_reader_jag_conduit::setup_variable_caches() {
+  if (!options::get()->get_bool("jag_variable_cache")) {
+    return;
+  }
+  const size_t num_samples = m_sample_list.size();
+  if (m_scalar_cache == nullptr) {
+    m_scalar_cache = std::make_shared<variable_cache>(num_samples, get_linearized_scalar_size());
+  }
+  if (m_input_cache == nullptr) {
+    m_input_cache = std::make_shared<variable_cache>(num_samples, get_linearized_input_size());
+  }
+}
+
+bool data_reader_jag_conduit::are_variables_cached(size_t data_id,
+                                                   const std::vector<variable_t>& vars) const {
+  if (m_scalar_cache == nullptr || priming_data_store()) {
+    return false;
+  }
+  for (const auto vt : vars) {
+    if (!((vt == JAG_Scalar && m_scalar_cache->has(data_id))
+          || (vt == JAG_Input && m_input_cache->has(data_id)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool data_reader_jag_conduit::has_conduit_path(const size_t i, const std::string& key) const {
   const sample_t& s = m_sample_list[i];
   sample_file_id_t id = s.first;
@@ -778,6 +886,7 @@ void data_reader_jag_conduit::load() {
   if ((m_leading_reader != this) && (m_leading_reader != nullptr)) {
     // The following member variables of the leadering reader should have been
     // copied when this was copy-constructed: m_sample_list, and m_open_hdf5_files
+    setup_variable_caches();
     return;
   }
 
@@ -856,6 +965,7 @@ void data_reader_jag_conduit::load() {
   m_shuffled_indices.resize(m_sample_list.size());
   std::iota(m_shuffled_indices.begin(), m_shuffled_indices.end(), 0);
   resize_shuffled_indices();
+  setup_variable_caches();
 
   if(is_master()) {
     std::cout << "Lists have been gathered" << std::endl;
@@ -1409,13 +1519,27 @@ bool data_reader_jag_conduit::fetch(CPUMat& X, int data_id, conduit::Node& sampl
       break;
     }
     case JAG_Scalar: {
+      const bool use_cache = (m_scalar_cache != nullptr) && !priming_data_store();
+      if (use_cache && m_scalar_cache->get(X, data_id, mb_idx)) {
+        break;
+      }
       const std::vector<scalar_t> scalars(get_scalars(data_id, sample));
       set_minibatch_item<scalar_t>(X, mb_idx, scalars.data(), get_linearized_scalar_size());
+      if (use_cache) {
+        m_scalar_cache->put(X, data_id, mb_idx);
+      }
       break;
     }
     case JAG_Input: {
+      const bool use_cache = (m_input_cache != nullptr) && !priming_data_store();
+      if (use_cache && m_input_cache->get(X, data_id, mb_idx)) {
+        break;
+      }
       const std::vector<input_t> inputs(get_inputs(data_id, sample));
       set_minibatch_item<input_t>(X, mb_idx, inputs.data(), get_linearized_input_size());
+      if (use_cache) {
+        m_input_cache->put(X, data_id, mb_idx);
+      }
       break;
     }
     default: { // includes Undefined case
@@ -1481,8 +1605,9 @@ bool data_reader_jag_conduit::fetch_datum(CPUMat& X, int data_id, int mb_idx) {
   if (data_store_active()) {
     const conduit::Node& ds_node = m_data_store->get_conduit_node(data_id);
     node.set_external(ds_node);
-  }else {
+  }else if (!are_variables_cached(data_id, m_independent)) {
     m_sample_list.open_samples_file_handle(data_id);
+    read_sample_fields(data_id, m_independent, node);
   }
 
   for(size_t i = 0u; ok && (i < X_v.size()); ++i) {
@@ -1511,6 +1636,8 @@ bool data_reader_jag_conduit::fetch_response(CPUMat& X, int data_id, int mb_idx)
   if (m_data_store != nullptr && c.get_epoch() > 0) {
     const conduit::Node& ds_node = m_data_store->get_conduit_node(data_id);
     node.set_external(ds_node);
+  } else if (!are_variables_cached(data_id, m_dependent)) {
+    read_sample_fields(data_id, m_dependent, node);
   }
   for(size_t i = 0u; ok && (i < X_v.size()); ++i) {
     ok = fetch(X_v[i], data_id, node, 0, tid, m_dependent[i], "response");
@@ -66,6 +66,7 @@ data_reader_merge_features::~data_reader_merge_features() {
 
 void data_reader_merge_features::load() {
   // Load each data reader separately.
+  m_data_size = 0;
   for (auto&& reader : m_data_readers) {
     double tm1 = get_time();
     reader->set_comm(m_comm);
@@ -29,6 +29,8 @@
 #include "lbann/data_readers/data_reader_merge_samples.hpp"
 #include "lbann/utils/options.hpp"
 
+#include <algorithm>
+
 namespace lbann {
 
 data_reader_merge_samples::data_reader_merge_samples(
@@ -54,7 +56,7 @@ data_reader_merge_samples::~data_reader_merge_samples() {}
 size_t data_reader_merge_samples::compute_num_samples_psum() {
   size_t global_num_samples = 0;
   // Prepend a 0 to make things easier.
-  m_num_samples_psum.push_back(0);
+  m_num_samples_psum.assign(1, 0);
   for (auto&& reader : m_data_readers) {
     m_num_samples_psum.push_back(reader->get_num_data());
     global_num_samples += reader->get_num_data();
@@ -113,43 +115,32 @@ void data_reader_merge_samples::load() {
   setup_indices(global_num_samples);
 }
 
-bool data_reader_merge_samples::fetch_datum(CPUMat& X, int data_id, int mb_idx) {
-  // Find the right data reader to delegate to.
-  for (size_t i = 0; i < m_data_readers.size(); ++i) {
-    if (data_id < m_num_samples_psum[i + 1]) {
-      data_id -= m_num_samples_psum[i];
-      return m_data_readers[i]->fetch_datum(X, data_id, mb_idx);
-    }
+generic_data_reader& data_reader_merge_samples::get_reader(int& data_id) const {
+  // Binary search over the partial sums
+  const auto it = std::upper_bound(m_num_samples_psum.begin(),
+                                   m_num_samples_psum.end(),
+                                   data_id);
+  if (data_id < 0 || it == m_num_samples_psum.end()) {
+    LBANN_ERROR("data_reader_merge_samples: do not have data ID ", data_id);
   }
-  throw lbann_exception(
-    "data_reader_merge_samples: do not have data ID " +
-    std::to_string(data_id));
+  const auto i = std::distance(m_num_samples_psum.begin(), it) - 1;
+  data_id -= m_num_samples_psum[i];
+  return *m_data_readers[i];
+}
+
+bool data_reader_merge_samples::fetch_datum(CPUMat& X, int data_id, int mb_idx) {
+  auto& reader = get_reader(data_id);
+  return reader.fetch_datum(X, data_id, mb_idx);
 }
 
 bool data_reader_merge_samples::fetch_label(CPUMat& Y, int data_id, int mb_idx) {
-  // Find the right data reader to delegate to.
-  for (size_t i = 0; i < m_data_readers.size(); ++i) {
-    if (data_id < m_num_samples_psum[i + 1]) {
-      data_id -= m_num_samples_psum[i];
-      return m_data_readers[i]->fetch_label(Y, data_id, mb_idx);
-    }
-  }
-  throw lbann_exception(
-    "data_reader_merge_samples: do not have data ID " +
-    std::to_string(data_id));
+  auto& reader = get_reader(data_id);
+  return reader.fetch_label(Y, data_id, mb_idx);
 }
 
 bool data_reader_merge_samples::fetch_response(CPUMat& Y, int data_id, int mb_idx) {
-  // Find the right data reader to delegate to.
-  for (size_t i = 0; i < m_data_readers.size(); ++i) {
-    if (data_id < m_num_samples_psum[i + 1]) {
-      data_id -= m_num_samples_psum[i];
-      return m_data_readers[i]->fetch_response(Y, data_id, mb_idx);
-    }
-  }
-  throw lbann_exception(
-    "data_reader_merge_samples: do not have data ID " +
-    std::to_string(data_id));
+  auto& reader = get_reader(data_id);
+  return reader.fetch_response(Y, data_id, mb_idx);
 }
 
 }  // namespace lbann
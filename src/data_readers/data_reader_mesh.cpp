@@ -27,11 +27,32 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lbann/data_readers/data_reader_mesh.hpp"
+#include "lbann/data_store/data_store_conduit.hpp"
+#include "lbann/utils/async_read.hpp"
+#include "lbann/utils/file_utils.hpp"
 #include "lbann/utils/glob.hpp"
-#include <omp.h>
+#include "lbann/utils/options.hpp"
+#include <cstring>
+#include <fstream>
 
 namespace lbann {
 
+namespace {
+
+/** Files of the sample a thread is loading, reused between samples. */
+struct mesh_buffers {
+  std::vector<El::Matrix<uint8_t>> files;
+  file::batch_file_reader file_reader;
+  std::vector<float> response;
+};
+
+mesh_buffers& get_mesh_buffers() {
+  thread_local mesh_buffers bufs;
+  return bufs;
+}
+
+} // namespace
+
 mesh_reader::mesh_reader(bool shuffle)
   : generic_data_reader(shuffle) {}
 
@@ -46,16 +67,17 @@ void mesh_reader::load() {
     throw lbann_exception("mesh_reader: could not find any targets");
   }
   m_num_samples = matches.size();
-  // Set up buffers to load data into.
-  m_load_bufs.resize(omp_get_max_threads());
-  for (auto&& buf : m_load_bufs) {
-    buf.resize(m_data_height * m_data_width);
-  }
   // Set up the format string.
   if (std::pow(10, m_index_length) <= m_num_samples) {
     throw lbann_exception("mesh_reader: index length too small");
   }
   m_index_format_str = "%0" + std::to_string(m_index_length) + "d";
+  // Use packed files if there is one for every sample.
+  m_packed = (glob(get_file_dir() + m_packed_name + m_suffix + "/*.bin").size()
+              == static_cast<size_t>(m_num_samples));
+  if (!m_packed && options::get()->get_bool("mesh_pack_channels")) {
+    pack_samples();
+  }
   // Set up to record flipping if needed.
   if (m_random_flips) {
     m_flip_choices.resize(m_num_samples);
@@ -64,93 +86,188 @@ void mesh_reader::load() {
   m_shuffled_indices.resize(m_num_samples);
   std::iota(m_shuffled_indices.begin(), m_shuffled_indices.end(), 0);
   resize_shuffled_indices();
+  instantiate_data_store();
   select_subset_of_data();
 }
 
-bool mesh_reader::fetch_datum(CPUMat& X, int data_id, int mb_idx) {
-  if (m_random_flips) {
-    fast_rng_gen& gen = get_fast_io_generator();
-    std::uniform_int_distribution<int> dist(0, 1);
-    m_flip_choices[data_id].first = dist(gen);
-    m_flip_choices[data_id].second = dist(gen);
+void mesh_reader::pack_samples() {
+  const std::string dir = get_file_dir() + m_packed_name + m_suffix;
+  if (m_comm->am_world_master()) {
+    create_dir(dir);
+    std::cout << "mesh_reader: packing " << m_num_samples << " samples of "
+              << m_channels.size() << " channels into " << dir << std::endl;
   }
-  for (size_t i = 0; i < m_channels.size(); ++i) {
-    Mat X_view = El::View(
-      X, El::IR(i*m_data_height*m_data_width, (i+1)*m_data_height*m_data_width),
-      El::IR(mb_idx));
-    load_file(data_id, m_channels[i], X_view);
+  m_comm->global_barrier();
+  const size_t plane_bytes = m_data_height * m_data_width * sizeof(float);
+  for (int data_id = m_comm->get_rank_in_world(); data_id < m_num_samples;
+       data_id += m_comm->get_procs_in_world()) {
+    const auto planes = read_planes(data_id, true);
+    const std::string filename = construct_filename(m_packed_name, data_id);
+    std::ofstream out(filename, std::ios::binary);
+    for (const auto* p : planes) {
+      out.write(reinterpret_cast<const char*>(p), plane_bytes);
+    }
+    if (!out) {
+      LBANN_ERROR("mesh_reader: failed to write ", filename);
+    }
   }
-  return true;
+  m_comm->global_barrier();
+  m_packed = true;
 }
 
-bool mesh_reader::fetch_response(CPUMat& Y, int data_id, int mb_idx) {
-  Mat Y_view = El::View(Y, El::ALL, El::IR(mb_idx));
-  load_file(data_id, m_target_name, Y_view);
-  return true;
+std::vector<const float*> mesh_reader::read_planes(int data_id,
+                                                   bool with_target) {
+  const size_t plane_bytes = m_data_height * m_data_width * sizeof(float);
+  const size_t num_planes = m_channels.size() + (with_target ? 1 : 0);
+  auto& bufs = get_mesh_buffers();
+  std::vector<const float*> planes;
+  planes.reserve(num_planes);
+  if (m_packed) {
+    // Channels, then the target, in one file
+    if (bufs.files.empty()) { bufs.files.resize(1); }
+    bufs.file_reader.add(construct_filename(m_packed_name, data_id), bufs.files[0]);
+    bufs.file_reader.read();
+    if (size_t(bufs.files[0].Height()) != (m_channels.size() + 1) * plane_bytes) {
+      LBANN_ERROR("mesh_reader: packed file for sample ", data_id,
+                  " has the wrong size");
+    }
+    const auto* data = bufs.files[0].LockedBuffer();
+    for (size_t i = 0; i < num_planes; ++i) {
+      planes.push_back(reinterpret_cast<const float*>(data + i * plane_bytes));
+    }
+    return planes;
+  }
+  // One file per channel, all read at once
+  if (bufs.files.size() < num_planes) { bufs.files.resize(num_planes); }
+  for (size_t i = 0; i < m_channels.size(); ++i) {
+    bufs.file_reader.add(construct_filename(m_channels[i], data_id), bufs.files[i]);
+  }
+  if (with_target) {
+    bufs.file_reader.add(construct_filename(m_target_name, data_id),
+                         bufs.files[m_channels.size()]);
+  }
+  bufs.file_reader.read();
+  for (size_t i = 0; i < num_planes; ++i) {
+    if (size_t(bufs.files[i].Height()) != plane_bytes) {
+      LBANN_ERROR("mesh_reader: plane ", i, " of sample ", data_id,
+                  " has the wrong size");
+    }
+    planes.push_back(reinterpret_cast<const float*>(bufs.files[i].LockedBuffer()));
+  }
+  return planes;
 }
 
-void mesh_reader::load_file(int data_id, const std::string channel, Mat& mat) {
-  const std::string filename = construct_filename(channel, data_id);
+const float* mesh_reader::read_response(int data_id) {
+  const size_t plane_size = m_data_height * m_data_width;
+  const std::string filename = (m_packed
+                                ? construct_filename(m_packed_name, data_id)
+                                : construct_filename(m_target_name, data_id));
   std::ifstream f(filename, std::ios::binary);
   if (f.fail()) {
     throw lbann_exception("mesh_reader: failed to open " + filename);
   }
-  // Load into a local buffer.
-  DataType* buf = m_load_bufs[omp_get_thread_num()].data();
-  if (!f.read((char*) buf, m_data_height * m_data_width * sizeof(float))) {
+  if (m_packed) {
+    f.seekg(m_channels.size() * plane_size * sizeof(float));
+  }
+  auto& buf = get_mesh_buffers().response;
+  buf.resize(plane_size);
+  if (!f.read((char*) buf.data(), plane_size * sizeof(float))) {
     throw lbann_exception("mesh_reader: failed to read " + filename);
   }
-  if (std::is_same<float, DataType>::value) {
-    // Need to transpose from row-major to column-major order.
-    Mat tmp_mat(m_data_width, m_data_height, buf, m_data_width);
-    Mat mat_reshape(m_data_height, m_data_width, mat.Buffer(), m_data_height);
-    El::Transpose(tmp_mat, mat_reshape);
-    // Flip if needed.
-    if (m_random_flips) {
-      if (m_flip_choices[data_id].first) {
-        horizontal_flip(mat_reshape);
+  return buf.data();
+}
+
+void mesh_reader::copy_plane(const float* src, DataType* dst,
+                             int data_id) const {
+  // The file is row-major; flips are applied as index remaps while
+  // transposing into the column-major output.
+  const El::Int height = m_data_height;
+  const El::Int width = m_data_width;
+  const bool hflip = m_random_flips && m_flip_choices[data_id].first;
+  const bool vflip = m_random_flips && m_flip_choices[data_id].second;
+  for (El::Int col = 0; col < width; ++col) {
+    const float* src_col = src + (hflip ? width - col - 1 : col);
+    DataType* dst_col = dst + col * height;
+    if (vflip) {
+      for (El::Int row = 0; row < height; ++row) {
+        dst_col[row] = src_col[(height - row - 1) * width];
       }
-      if (m_flip_choices[data_id].second) {
-        vertical_flip(mat_reshape);
+    } else {
+      for (El::Int row = 0; row < height; ++row) {
+        dst_col[row] = src_col[row * width];
       }
     }
-  } else {
-    // Need to transpose and convert from float. Not yet supported.
-    throw lbann_exception("mesh_reader: does not support DataType != float");
   }
 }
 
-std::string mesh_reader::construct_filename(std::string channel, int data_id) {
-  std::string filename = get_file_dir() + channel + m_suffix + "/" + channel;
-  char idx[m_index_length + 1];
-  std::snprintf(idx, m_index_length + 1, m_index_format_str.c_str(), data_id);
-  return filename + std::string(idx) + ".bin";
+void mesh_reader::load_conduit_node(int data_id, conduit::Node& node) {
+  node.reset();
+  const size_t plane_size = m_data_height * m_data_width;
+  const auto planes = read_planes(data_id, true);
+  const std::string root = LBANN_DATA_ID_STR(data_id);
+  node[root + "/data"].set(conduit::DataType::float32(m_channels.size() * plane_size));
+  float* data = node[root + "/data"].as_float32_ptr();
+  for (size_t i = 0; i < m_channels.size(); ++i) {
+    std::memcpy(data + i * plane_size, planes[i], plane_size * sizeof(float));
+  }
+  node[root + "/response"].set(planes.back(), plane_size);
+}
+
+void mesh_reader::do_preload_data_store() {
+  parallel_preload_data_store(
+    [this](int data_id, conduit::Node& node) { load_conduit_node(data_id, node); });
 }
 
-void mesh_reader::horizontal_flip(CPUMat& mat) {
-  // TODO: Could probably optimize this for better locality.
-  const El::Int height = mat.Height();
-  const El::Int width = mat.Width();
-  for (El::Int row = 0; row < height; ++row) {
-    for (El::Int col = 0; col < (width / 2); ++col) {
-      DataType tmp = mat(row, col);
-      mat(row, col) = mat(row, width - col - 1);
-      mat(row, width - col - 1) = tmp;
+bool mesh_reader::fetch_datum(CPUMat& X, int data_id, int mb_idx) {
+  if (m_random_flips) {
+    fast_rng_gen& gen = get_fast_io_generator();
+    std::uniform_int_distribution<int> dist(0, 1);
+    m_flip_choices[data_id].first = dist(gen);
+    m_flip_choices[data_id].second = dist(gen);
+  }
+  const size_t plane_size = m_data_height * m_data_width;
+  DataType* dst = X.Buffer(0, mb_idx);
+  if (data_store_active() || priming_data_store()) {
+    conduit::Node node;
+    if (data_store_active()) {
+      node.set_external(m_data_store->get_conduit_node(data_id));
+    } else {
+      load_conduit_node(data_id, node);
+    }
+    const float* data = node[LBANN_DATA_ID_STR(data_id) + "/data"].as_float32_ptr();
+    for (size_t i = 0; i < m_channels.size(); ++i) {
+      copy_plane(data + i * plane_size, dst + i * plane_size, data_id);
     }
+    if (priming_data_store()) {
+      m_data_store->set_conduit_node(data_id, node);
+    }
+    return true;
+  }
+  const auto planes = read_planes(data_id, false);
+  for (size_t i = 0; i < m_channels.size(); ++i) {
+    copy_plane(planes[i], dst + i * plane_size, data_id);
   }
+  return true;
 }
 
-void mesh_reader::vertical_flip(CPUMat& mat) {
-  // TODO: Could probably optimize this for better locality.
-  const El::Int height = mat.Height();
-  const El::Int width = mat.Width();
-  for (El::Int row = 0; row < (height / 2); ++row) {
-    for (El::Int col = 0; col < width; ++col) {
-      DataType tmp = mat(row, col);
-      mat(row, col) = mat(height - row - 1, col);
-      mat(height - row - 1, col) = tmp;
-    }
+bool mesh_reader::fetch_response(CPUMat& Y, int data_id, int mb_idx) {
+  DataType* dst = Y.Buffer(0, mb_idx);
+  if (data_store_active()) {
+    conduit::Node node;
+    node.set_external(m_data_store->get_conduit_node(data_id));
+    copy_plane(node[LBANN_DATA_ID_STR(data_id) + "/response"].as_float32_ptr(),
+               dst, data_id);
+  } else {
+    copy_plane(read_response(data_id), dst, data_id);
   }
+  return true;
+}
+
+std::string mesh_reader::construct_filename(std::string channel, int data_id) {
+  std::string filename = get_file_dir() + channel + m_suffix + "/" + channel;
+  char idx[m_index_length + 1];
+  std::snprintf(idx, m_index_length + 1, m_index_format_str.c_str(), data_id);
+  return filename + std::string(idx) + ".bin";
 }
 
 }  // namespace lbann
@@ -28,7 +28,8 @@
 
 #include "lbann/data_readers/data_reader_mnist.hpp"
 #include "lbann/utils/file_utils.hpp"
-#include <cstdio>
+#include <algorithm>
+#include <cstring>
 
 namespace lbann {
 
@@ -49,11 +50,12 @@ void mnist_reader::set_defaults() {
 }
 
 bool mnist_reader::fetch_datum(CPUMat& X, int data_id, int mb_idx) {
-  int pixelcount = m_image_width * m_image_height;
-  std::vector<unsigned char>& tmp = m_image_data[data_id];
-
-  for (int p = 0; p < pixelcount; p++) {
-    X.Set(p, mb_idx, tmp[p+1]);
+  // Convert straight from the mapping into the output column
+  const El::Int pixelcount = m_image_width * m_image_height;
+  const uint8_t* __restrict__ src = get_image(data_id);
+  DataType* __restrict__ dst = X.Buffer(0, mb_idx);
+  for (El::Int p = 0; p < pixelcount; ++p) {
+    dst[p] = src[p];
   }
 
   auto pixel_col = X(El::IR(0, X.Height()), El::IR(mb_idx, mb_idx + 1));
@@ -67,7 +69,7 @@ bool mnist_reader::fetch_datum(CPUMat& X, int data_id, int mb_idx) {
 
 bool mnist_reader::fetch_label(CPUMat& Y, int data_id, int mb_idx) {
   if(!m_gan_labelling) { //default
-    unsigned char label = m_image_data[data_id][0];
+    unsigned char label = get_label(data_id);
     Y.Set(label, mb_idx, 1);
   } else {
     if(m_gan_label_value) Y.Set(m_gan_label_value,mb_idx,1); //fake sample is set to 1; adversarial model
@@ -81,69 +83,40 @@ bool mnist_reader::fetch_label(CPUMat& Y, int data_id, int mb_idx) {
 
 //===================================================
 
-void load_mnist_data(const std::string imagepath, const std::string labelpath,
-  const int m_first_n, std::vector<std::vector<unsigned char> >& m_image_data) {
+namespace {
 
-  // read labels
-  FILE *fplbl = fopen(labelpath.c_str(), "rb");
-  if (!fplbl) {
-    throw lbann_exception(
-      std::string{} + __FILE__ + " " + std::to_string(__LINE__) +
-      " :: load_mnist_data: failed to open file: " + labelpath);
-  }
+/** IDX header sizes: magic and count, plus rows and columns for images. */
+constexpr size_t mnist_label_header_size = 8;
+constexpr size_t mnist_image_header_size = 16;
 
-  int magicnum1, numitems1;
-  fread(&magicnum1, 4, 1, fplbl);
-  fread(&numitems1, 4, 1, fplbl);
-  __swapEndianInt((unsigned int&)magicnum1);
-  __swapEndianInt((unsigned int&)numitems1);
-
-  // read images
-  FILE *fpimg = fopen(imagepath.c_str(), "rb");
-  if (!fpimg) {
-    throw lbann_exception(
-      std::string{} + __FILE__ + " " + std::to_string(__LINE__) +
-      " :: load_mnist_data: failed to open file: " + imagepath);
+/** Read the big-endian int at word i of an IDX header. */
+unsigned int read_idx_int(const mapped_file& file, size_t i) {
+  if (file.size() < 4*(i+1)) {
+    LBANN_ERROR("MNIST file is too short for its header");
   }
+  unsigned int v;
+  std::memcpy(&v, file.data() + 4*i, 4);
+  __swapEndianInt(v);
+  return v;
+}
 
-  int magicnum2, numitems2, imgwidth, imgheight;
-  fread(&magicnum2, 4, 1, fpimg);
-  fread(&numitems2, 4, 1, fpimg);
-  fread(&imgwidth, 4, 1, fpimg);
-  fread(&imgheight, 4, 1, fpimg);
-  __swapEndianInt((unsigned int&)magicnum2);
-  __swapEndianInt((unsigned int&)numitems2);
-  __swapEndianInt((unsigned int&)imgwidth);
-  __swapEndianInt((unsigned int&)imgheight);
-
-  if (numitems1 != numitems2) {
-    fclose(fplbl);
-    fclose(fpimg);
-    throw lbann_exception(
-      std::string{} + __FILE__ + " " + std::to_string(__LINE__) +
-      " :: load_mnist_data: numitems1 != numitems2");
-  }
+} // namespace
 
-  if (m_first_n > 0) {
-    numitems1 = m_first_n > numitems1 ? numitems1 : m_first_n;
-  }
+const uint8_t* mnist_reader::get_image(int data_id) const {
+  return reinterpret_cast<const uint8_t*>(m_image_file->data())
+    + mnist_image_header_size
+    + size_t(data_id) * m_image_width * m_image_height;
+}
 
-  // set to array
-  m_image_data.resize(numitems1);
-  for (int n = 0; n < numitems1; n++) {
-    m_image_data[n].resize(1+(imgwidth * imgheight));
-    fread(&m_image_data[n][0], 1, 1, fplbl);
-    fread(&m_image_data[n][1], imgwidth * imgheight, 1, fpimg);
-  }
-  fclose(fpimg);
-  fclose(fplbl);
+uint8_t mnist_reader::get_label(int data_id) const {
+  return reinterpret_cast<const uint8_t*>(m_label_file->data())
+    [mnist_label_header_size + data_id];
 }
 
 void mnist_reader::load() {
   if (is_master()) {
     std::cerr << "starting lbann::mnist_reader::load\n";
   }
-  m_image_data.clear();
 
   if(m_gan_labelling) m_num_labels=2;
 
@@ -156,10 +129,33 @@ void mnist_reader::load() {
   const std::string labelpath = FileDir + "/" + LabelFile;
 
   if (is_master()) {
-    std::cerr << "read labels!\n";
+    std::cerr << "mapping images and labels\n";
   }
 
-  load_mnist_data(imagepath, labelpath, m_first_n, m_image_data);
+  m_label_file = std::make_shared<mapped_file>(labelpath);
+  m_image_file = std::make_shared<mapped_file>(imagepath);
+  const size_t num_labels = read_idx_int(*m_label_file, 1);
+  const size_t num_images = read_idx_int(*m_image_file, 1);
+  const int height = read_idx_int(*m_image_file, 2);
+  const int width = read_idx_int(*m_image_file, 3);
+  if (num_labels != num_images) {
+    LBANN_ERROR("MNIST files ", imagepath, " and ", labelpath,
+                " have different numbers of items");
+  }
+  if (height != m_image_height || width != m_image_width) {
+    LBANN_ERROR("MNIST images are ", height, "x", width, ", expected ",
+                m_image_height, "x", m_image_width);
+  }
+  if (m_label_file->size() < mnist_label_header_size + num_labels
+      || m_image_file->size() < (mnist_image_header_size
+                                 + num_images * height * width)) {
+    LBANN_ERROR("MNIST files ", imagepath, " and ", labelpath,
+                " are shorter than their headers declare");
+  }
+  m_num_images = num_images;
+  if (m_first_n > 0) {
+    m_num_images = std::min(m_num_images, size_t(m_first_n));
+  }
 
   if (m_first_n > 0) {
     set_use_percent(1.0);
@@ -168,7 +164,7 @@ void mnist_reader::load() {
 
   // reset indices
   m_shuffled_indices.clear();
-  m_shuffled_indices.resize(m_image_data.size());
+  m_shuffled_indices.resize(m_num_images);
   for (size_t n = 0; n < m_shuffled_indices.size(); n++) {
     m_shuffled_indices[n] = n;
   }
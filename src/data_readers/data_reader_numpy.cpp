@@ -27,7 +27,10 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lbann/data_readers/data_reader_numpy.hpp"
+#include <algorithm>
 #include <cstdio>
+#include <functional>
+#include <numeric>
 #include <string>
 #include <unordered_set>
 #include <cnpy.h>
@@ -69,7 +72,11 @@ void numpy_reader::load() {
   }
   ifs.close();
 
-  m_data = cnpy::npy_load(infile);
+  if (options::get()->get_bool("numpy_mmap")) {
+    m_data = cnpy_utils::mmap_npy(infile);
+  } else {
+    m_data = cnpy_utils::make_npy_view(cnpy::npy_load(infile));
+  }
   m_num_samples = m_data.shape[0];
   m_num_features = std::accumulate(
     m_data.shape.begin() + 1, m_data.shape.end(), (unsigned) 1,
@@ -99,10 +106,10 @@ void numpy_reader::load() {
     std::unordered_set<int> label_classes;
     for (int i = 0; i < m_num_samples; ++i) {
       if (m_data.word_size == 4) {
-        float *data = m_data.data<float>() + i*(m_num_features+1);
+        const float *data = m_data.data<float>() + i*(m_num_features+1);
         label_classes.insert((int) data[m_num_features+1]);
       } else if (m_data.word_size == 8) {
-        double *data = m_data.data<double>() + i*(m_num_features+1);
+        const double *data = m_data.data<double>() + i*(m_num_features+1);
         label_classes.insert((int) data[m_num_features+1]);
       }
     }
@@ -122,6 +129,15 @@ void numpy_reader::load() {
     // Last feature becomes the response.
     m_num_features -= 1;
   }
+  if (m_num_spatial_partitions > 1) {
+    if (m_data.shape.size() < 4
+        || m_data.shape[2] % m_num_spatial_partitions != 0) {
+      LBANN_ERROR("numpy_reader: cannot split samples of ", infile,
+                  " into ", m_num_spatial_partitions, " slabs; samples "
+                  "must be C x D x ... with D divisible by the number of "
+                  "slabs");
+    }
+  }
 
   // Reset indices.
   m_shuffled_indices.clear();
@@ -131,18 +147,59 @@ void numpy_reader::load() {
   select_subset_of_data();
 }
 
+namespace {
+
+/** Copy one depth slab of a C x D x ... sample into a packed
+ *  C x (D/num_partitions) x ... buffer. */
+template <typename T>
+void copy_spatial_partition(const T* sample,
+                            const std::vector<size_t>& shape,
+                            int num_partitions,
+                            int index,
+                            DataType* out) {
+  const size_t channels = shape[1];
+  const size_t depth = shape[2];
+  const size_t inner = std::accumulate(shape.begin() + 3, shape.end(),
+                                       size_t{1}, std::multiplies<size_t>());
+  const size_t slab_depth = depth / num_partitions;
+  const size_t slab_size = slab_depth * inner;
+  for (size_t c = 0; c < channels; ++c) {
+    const T* src = sample + (c * depth + index * slab_depth) * inner;
+    std::copy(src, src + slab_size, out + c * slab_size);
+  }
+}
+
+} // namespace
+
 bool numpy_reader::fetch_datum(Mat& X, int data_id, int mb_idx) {
+  if (m_num_spatial_partitions > 1) {
+    if (X.LDim() != X.Height()) {
+      LBANN_ERROR("numpy_reader: partial samples need a contiguous buffer");
+    }
+    const size_t slab_size = m_num_features / m_num_spatial_partitions;
+    auto* out = X.Buffer() + mb_idx * slab_size;
+    if (m_data.word_size == 4) {
+      copy_spatial_partition(m_data.data<float>() + data_id * m_num_features,
+                             m_data.shape, m_num_spatial_partitions,
+                             m_spatial_partition, out);
+    } else if (m_data.word_size == 8) {
+      copy_spatial_partition(m_data.data<double>() + data_id * m_num_features,
+                             m_data.shape, m_num_spatial_partitions,
+                             m_spatial_partition, out);
+    }
+    return true;
+  }
   int features_size = m_num_features;
   if (m_has_labels || m_has_responses) {
     features_size += 1;
   }
   if (m_data.word_size == 4) {
-    float *data = m_data.data<float>() + data_id * features_size;
+    const float *data = m_data.data<float>() + data_id * features_size;
     for (int j = 0; j < m_num_features; ++j) {
       X(j, mb_idx) = data[j];
     }
   } else if (m_data.word_size == 8) {
-    double *data = m_data.data<double>() + data_id * features_size;
+    const double *data = m_data.data<double>() + data_id * features_size;
     for (int j = 0; j < m_num_features; ++j) {
       X(j, mb_idx) = data[j];
     }
@@ -156,10 +213,10 @@ bool numpy_reader::fetch_label(Mat& Y, int data_id, int mb_idx) {
   }
   int label = 0;
   if (m_data.word_size == 4) {
-    float *data = m_data.data<float>() + data_id*(m_num_features+1);
+    const float *data = m_data.data<float>() + data_id*(m_num_features+1);
     label = (int) data[m_num_features+1];
   } else if (m_data.word_size == 8) {
-    double *data = m_data.data<double>() + data_id*(m_num_features+1);
+    const double *data = m_data.data<double>() + data_id*(m_num_features+1);
     label = (int) data[m_num_features+1];
   }
   Y(label, mb_idx) = 1;
@@ -172,10 +229,10 @@ bool numpy_reader::fetch_response(Mat& Y, int data_id, int mb_idx) {
   }
   auto response = DataType(0);
   if (m_data.word_size == 4) {
-    float *data = m_data.data<float>() + data_id*(m_num_features+1);
+    const float *data = m_data.data<float>() + data_id*(m_num_features+1);
     response = (DataType) data[m_num_features+1];
   } else if (m_data.word_size == 8) {
-    double *data = m_data.data<double>() + data_id*(m_num_features+1);
+    const double *data = m_data.data<double>() + data_id*(m_num_features+1);
     response = (DataType) data[m_num_features+1];
   }
   Y(0, mb_idx) = response;
@@ -30,6 +30,7 @@
 #include <cstdio>
 #include <string>
 #include <unordered_set>
+#include <map>
 #include <cnpy.h>
 
 namespace lbann {
@@ -81,9 +82,16 @@ namespace lbann {
     }
     ifs.close();
 
-    const cnpy::npz_t npz = cnpy::npz_load(infile);
+    std::map<std::string, cnpy_utils::npy_view> npz;
+    if (options::get()->get_bool("numpy_mmap")) {
+      npz = cnpy_utils::mmap_npz(infile);
+    } else {
+      for (const auto& kv : cnpy::npz_load(infile)) {
+        npz.emplace(kv.first, cnpy_utils::make_npy_view(kv.second));
+      }
+    }
 
-    std::vector<std::tuple<const bool, const std::string, cnpy::NpyArray &> > npyLoadList;
+    std::vector<std::tuple<const bool, const std::string, cnpy_utils::npy_view &> > npyLoadList;
     npyLoadList.push_back(std::forward_as_tuple(true,            NPZ_KEY_DATA,      m_data));
     npyLoadList.push_back(std::forward_as_tuple(m_has_labels,    NPZ_KEY_LABELS,    m_labels));
     npyLoadList.push_back(std::forward_as_tuple(m_has_responses, NPZ_KEY_RESPONSES, m_responses));
@@ -95,7 +103,7 @@ namespace lbann {
 
       // Load the tensor.
       const std::string key = std::get<1>(npyLoad);
-      cnpy::NpyArray &ary = std::get<2>(npyLoad);
+      cnpy_utils::npy_view &ary = std::get<2>(npyLoad);
       const auto i = npz.find(key);
       if(i != npz.end()) {
         ary = i->second;
@@ -137,7 +145,7 @@ namespace lbann {
       if (m_labels.word_size != 4) {
         throw lbann_exception("numpy_npz_reader: label numpy array should be in int32");
       }
-      int *data = m_labels.data<int>();
+      const int *data = m_labels.data<int>();
       for (int i = 0; i < m_num_samples; ++i) {
         label_classes.insert((int) data[i]);
       }
@@ -175,11 +183,11 @@ namespace lbann {
           dest[j] = data[j] * m_scaling_factor_int16;
 
     } else {
-      void *data = NULL;
+      const void *data = NULL;
       if (m_data.word_size == 4) {
-        data = (void *) (m_data.data<float>() + data_id * m_num_features);
+        data = (const void *) (m_data.data<float>() + data_id * m_num_features);
       } else if (m_data.word_size == 8) {
-        data = (void *) (m_data.data<double>() + data_id * m_num_features);
+        data = (const void *) (m_data.data<double>() + data_id * m_num_features);
       }
       std::memcpy(X_v.Buffer(), data, m_num_features * m_data.word_size);
     }
@@ -212,12 +220,12 @@ namespace lbann {
       return true;
     }
 
-    void *responses = NULL;
+    const void *responses = NULL;
     if (m_responses.word_size == 4) {
-      responses = (void *) (m_responses.data<float>()
+      responses = (const void *) (m_responses.data<float>()
                             + data_id * m_num_response_features);
     } else if (m_responses.word_size == 8) {
-      responses = (void *) (m_responses.data<double>()
+      responses = (const void *) (m_responses.data<double>()
                             + data_id * m_num_response_features);
     }
     std::memcpy(Y_v.Buffer(), responses,
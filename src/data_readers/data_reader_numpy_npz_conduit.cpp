@@ -124,65 +124,15 @@ void numpy_npz_conduit_reader::do_preload_data_store() {
     LBANN_ERROR("numpy_npz_conduit_reader currently assumes you are using 100% of the data set; you specified get_absolute_sample_count() = ", count, " and get_use_percent() = ", use_percent, "; please ask Dave Hysom to modify the code, if you want to use less than 100%");
   }
 
-  int rank = m_comm->get_rank_in_trainer();
-
-  std::unordered_set<int> label_classes;
-
-  bool threaded = ! options::get()->get_bool("data_store_no_thread");
-
-  //threaded mode
-  if (threaded) {
-    if (is_master()) {
-      std::cout << "mode: data_store_thread\n";
-    }
-    std::shared_ptr<thread_pool> io_thread_pool = construct_io_thread_pool(m_comm, options::get());
-    int num_threads = static_cast<int>(io_thread_pool->get_num_threads());
-
-    //collect the set of indices that belong to this rank
-    std::vector<std::unordered_set<int>> data_ids(num_threads);
-    int j = 0;
-    for (size_t data_id=0; data_id<m_shuffled_indices.size(); data_id++) {
-      int index = m_shuffled_indices[data_id];
-      if (m_data_store->get_index_owner(index) != rank) {
-        continue;
-      }
-      data_ids[j++].insert(index);
-      if (j == num_threads) {
-        j = 0;
-      }
-    }
-
-    //load the samples
-    for (int t = 0; t < num_threads; t++) {
-      if(t == io_thread_pool->get_local_thread_id()) {
-        continue;
-      } else {
-        io_thread_pool->submit_job_to_work_group(std::bind(&numpy_npz_conduit_reader::load_numpy_npz_from_file, this, data_ids[t], label_classes));
-      }
-    }
-    load_numpy_npz_from_file(data_ids[io_thread_pool->get_local_thread_id()], label_classes);
-    io_thread_pool->finish_work_group();
-  } //end: threaded mode
-
-  //non-threaded mode
-  else {
-    for (size_t data_id=0; data_id<m_filenames.size(); data_id++) {
-      if (m_data_store->get_index_owner(data_id) != rank) {
-        continue;
-      }
-
-      conduit::Node node;
-      load_npz(m_filenames[data_id], data_id, node);
-      const char *char_ptr = node[LBANN_DATA_ID_STR(data_id) + "/frm/data"].value();
-      const int* label_ptr = reinterpret_cast<const int*>(char_ptr);
-      label_classes.insert(*label_ptr);
-      m_data_store->set_conduit_node(data_id, node);
-    }
-  } //end: non-threaded mode
+  parallel_preload_data_store(
+    [this](int data_id, conduit::Node &node) {
+      load_conduit_node(m_filenames[data_id], data_id, node);
+    });
 
   // Nikoli says we're not using labels, so I'm commenting this section out
   // (this section is a mess, anyway)
   #if 0
+  std::unordered_set<int> label_classes;
   if (m_has_labels) {
 
     // get max element. Yes, I know you can do this with, e.g, lambda
@@ -239,18 +189,6 @@ void numpy_npz_conduit_reader::do_preload_data_store() {
   }
 }
 
-bool numpy_npz_conduit_reader::load_numpy_npz_from_file(const std::unordered_set<int> &data_ids, std::unordered_set<int> &label_classes) {
-  for (auto data_id : data_ids) {
-    conduit::Node node;
-    load_conduit_node(m_filenames[data_id], data_id, node);
-    const char *char_ptr = node[LBANN_DATA_ID_STR(data_id) + "/frm/data"].value();
-    const int* label_ptr = reinterpret_cast<const int*>(char_ptr);
-    label_classes.insert(*label_ptr);
-    m_data_store->set_conduit_node(data_id, node);
-  }
-  return true;
-}
-
 bool numpy_npz_conduit_reader::fetch_datum(Mat& X, int data_id, int mb_idx) {
   Mat X_v = El::View(X, El::IR(0, X.Height()), El::IR(mb_idx, mb_idx+1));
   conduit::Node node;
@@ -27,7 +27,14 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lbann/data_readers/data_reader_pilot2_molecular.hpp"
+#include "lbann/data_store/data_store_conduit.hpp"
 #include "lbann/utils/options.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <unordered_map>
 
 namespace lbann {
 
@@ -62,13 +69,11 @@ void pilot2_molecular_reader::load() {
         std::string{} + __FILE__ + " " + std::to_string(__LINE__) +
         " pilot2_molecular::load() - no features");
     }
-    if (dict.count("neighbors") != 1) {
-      throw lbann_exception(
-        std::string{} + __FILE__ + " " + std::to_string(__LINE__) +
-        " pilot2_molecular::load() - no neighbors");
-    }
     m_features = dict["features"];
-    m_neighbors = dict["neighbors"];
+    const bool have_neighbors = dict.count("neighbors") == 1;
+    if (have_neighbors) {
+      m_neighbors = dict["neighbors"];
+    }
 
     // Ensure we understand the word size.
     if (!(m_features.word_size == 4 || m_features.word_size == 8)) {
@@ -77,7 +82,8 @@ void pilot2_molecular_reader::load() {
         " pilot2_molecular::load() - feature word size " +
         std::to_string(m_features.word_size) + " not supported");
     }
-    if (!(m_neighbors.word_size == 4 || m_neighbors.word_size == 8)) {
+    if (have_neighbors
+        && !(m_neighbors.word_size == 4 || m_neighbors.word_size == 8)) {
       throw lbann_exception(
         std::string{} + __FILE__ + " " + std::to_string(__LINE__) +
         " pilot2_molecular::load() - neighbor word size " +
@@ -89,7 +95,7 @@ void pilot2_molecular_reader::load() {
         std::string{} + __FILE__ + " " + std::to_string(__LINE__) +
         " pilot2_molecular::load() - feature fortran order not supported");
     }
-    if (m_neighbors.fortran_order) {
+    if (have_neighbors && m_neighbors.fortran_order) {
       throw lbann_exception(
         std::string{} + __FILE__ + " " + std::to_string(__LINE__) +
         " pilot2_molecular::load() - neighbor fortran order not supported");
@@ -103,12 +109,24 @@ void pilot2_molecular_reader::load() {
       m_features.shape.begin() + 2, m_features.shape.end(), (unsigned) 1,
       std::multiplies<unsigned>());
 
-    m_word_size = m_neighbors.word_size;
+    m_word_size = have_neighbors ? m_neighbors.word_size : m_features.word_size;
 
     m_shape.resize(3);
     m_shape[0] = m_num_neighbors + 1;
     m_shape[1] = m_features.shape[2];
     m_shape[2] = m_features.shape[3];
+
+    // Scale factors of scale_data, once per feature
+    m_feature_scales.resize(m_num_features);
+    for (int i = 0; i < m_num_features; ++i) {
+      m_feature_scales[i] = scale_data<DataType>(i, DataType(1));
+    }
+
+    if (have_neighbors) {
+      build_neighbor_ids_from_file();
+    } else {
+      build_neighbor_ids_from_positions();
+    }
   }
 
   // Reset indices.
@@ -116,66 +134,224 @@ void pilot2_molecular_reader::load() {
   m_shuffled_indices.resize(m_num_samples);
   std::iota(m_shuffled_indices.begin(), m_shuffled_indices.end(), 0);
   resize_shuffled_indices();
+  instantiate_data_store();
   select_subset_of_data();
 }
 
-bool pilot2_molecular_reader::fetch_datum(
-  CPUMat& X, int data_id, int mb_idx) {
-
-  const int frame = get_frame(data_id);
-  // Fetch the actual molecule.
-  fetch_molecule(X, data_id, 0, mb_idx);
-  // Fetch the neighbors - note that the offset is 2x the max
-  // neighborhood size to accommodate the top and bottom of the
-  // bilayer
-  const int neighbor_frame_offset =
-    frame * m_num_samples_per_frame * (2 * m_max_neighborhood);
-  const int intra_frame_data_id = data_id - frame * m_num_samples_per_frame;
-  if (m_neighbors.word_size == 4) {
-    float *neighbor_data = m_neighbors.data<float>() +
-      neighbor_frame_offset + intra_frame_data_id * (2 * m_max_neighborhood);
-    // Start at 1 to skip self.
+void pilot2_molecular_reader::build_neighbor_ids_from_file() {
+  // Neighbors are stored per frame with 2x the max neighborhood to
+  // accommodate the top and bottom of the bilayer; entry 0 is self
+  m_neighbor_ids.assign(size_t(m_num_samples) * m_num_neighbors, -1);
+  const size_t stride = 2 * m_max_neighborhood;
+  for (int data_id = 0; data_id < m_num_samples; ++data_id) {
+    const int frame = get_frame(data_id);
+    const size_t offset = size_t(data_id) * stride;
     for (int i = 1; i < m_num_neighbors + 1; ++i) {
-      int neighbor_id = neighbor_data[i];
+      const int neighbor_id = (m_neighbors.word_size == 4
+                               ? int(m_neighbors.data<float>()[offset + i])
+                               : int(m_neighbors.data<double>()[offset + i]));
       if (neighbor_id != -1) {
-        fetch_molecule(X, neighbor_id + frame * m_num_samples_per_frame, i,
-                       mb_idx);
+        m_neighbor_ids[size_t(data_id) * m_num_neighbors + i - 1] =
+          neighbor_id + frame * m_num_samples_per_frame;
       }
     }
-  } else if (m_neighbors.word_size == 8) {
-    double *neighbor_data = m_neighbors.data<double>() +
-      neighbor_frame_offset + intra_frame_data_id * (2 * m_max_neighborhood);
-    // Start at 1 to skip self.
-    for (int i = 1; i < m_num_neighbors + 1; ++i) {
-      int neighbor_id = neighbor_data[i];
-      if (neighbor_id != -1) {
-        fetch_molecule(X, neighbor_id + frame * m_num_samples_per_frame, i,
-                       mb_idx);
+  }
+}
+
+namespace {
+
+/** Bead centroid of each molecule of a frame. */
+template <typename T>
+std::vector<std::array<double, 3>> get_centroids(const T* frame_data,
+                                                 int num_molecules,
+                                                 int num_beads,
+                                                 int bead_size) {
+  std::vector<std::array<double, 3>> centroids(num_molecules, {{0, 0, 0}});
+  for (int m = 0; m < num_molecules; ++m) {
+    const T* molecule = frame_data + size_t(m) * num_beads * bead_size;
+    for (int b = 0; b < num_beads; ++b) {
+      for (int d = 0; d < 3; ++d) {
+        centroids[m][d] += molecule[b * bead_size + d];
+      }
+    }
+    for (int d = 0; d < 3; ++d) {
+      centroids[m][d] /= num_beads;
+    }
+  }
+  return centroids;
+}
+
+} // namespace
+
+void pilot2_molecular_reader::build_neighbor_ids_from_positions() {
+  const int num_molecules = m_num_samples_per_frame;
+  const int num_beads = m_features.shape[2];
+  const int bead_size = m_features.shape[3];
+  if (bead_size < 3) {
+    LBANN_ERROR("pilot2_molecular::load() - no neighbors, and the features "
+                "have no positions to compute them from");
+  }
+  const int k = m_num_neighbors;
+  m_neighbor_ids.assign(size_t(m_num_samples) * k, -1);
+  if (k <= 0) { return; }
+  const int num_frames = m_num_samples / num_molecules;
+  for (int frame = 0; frame < num_frames; ++frame) {
+    const size_t frame_offset = size_t(frame) * num_molecules * m_num_features;
+    const auto centroids = (m_features.word_size == 4
+                            ? get_centroids(m_features.data<float>() + frame_offset,
+                                            num_molecules, num_beads, bead_size)
+                            : get_centroids(m_features.data<double>() + frame_offset,
+                                            num_molecules, num_beads, bead_size));
+
+    // Hash the molecules into cubic cells holding about k of them
+    std::array<double, 3> lo, hi;
+    lo.fill(std::numeric_limits<double>::max());
+    hi.fill(std::numeric_limits<double>::lowest());
+    for (const auto& c : centroids) {
+      for (int d = 0; d < 3; ++d) {
+        lo[d] = std::min(lo[d], c[d]);
+        hi[d] = std::max(hi[d], c[d]);
+      }
+    }
+    double volume = 1;
+    for (int d = 0; d < 3; ++d) { volume *= std::max(hi[d] - lo[d], 1e-6); }
+    const double cell = std::cbrt(volume * (k + 1) / num_molecules);
+    std::array<int, 3> num_cells;
+    for (int d = 0; d < 3; ++d) {
+      num_cells[d] = std::max(1, int((hi[d] - lo[d]) / cell) + 1);
+    }
+    auto cell_of = [&](const std::array<double, 3>& c) {
+      std::array<int, 3> idx;
+      for (int d = 0; d < 3; ++d) {
+        idx[d] = std::min(num_cells[d] - 1, int((c[d] - lo[d]) / cell));
+      }
+      return idx;
+    };
+    auto cell_key = [&](int x, int y, int z) {
+      return (size_t(z) * num_cells[1] + y) * num_cells[0] + x;
+    };
+    std::unordered_map<size_t, std::vector<int>> cells;
+    for (int m = 0; m < num_molecules; ++m) {
+      const auto idx = cell_of(centroids[m]);
+      cells[cell_key(idx[0], idx[1], idx[2])].push_back(m);
+    }
+    const int max_shell = *std::max_element(num_cells.begin(), num_cells.end());
+
+    // Visit shells of cells until the k-th nearest candidate is closer
+    // than any molecule in an unvisited shell
+    std::vector<std::pair<double, int>> candidates;
+    for (int m = 0; m < num_molecules; ++m) {
+      const auto& c = centroids[m];
+      const auto idx = cell_of(c);
+      candidates.clear();
+      for (int r = 0; r <= max_shell; ++r) {
+        for (int z = idx[2] - r; z <= idx[2] + r; ++z) {
+          for (int y = idx[1] - r; y <= idx[1] + r; ++y) {
+            for (int x = idx[0] - r; x <= idx[0] + r; ++x) {
+              if (std::max({std::abs(x - idx[0]), std::abs(y - idx[1]),
+                            std::abs(z - idx[2])}) != r
+                  || x < 0 || y < 0 || z < 0 || x >= num_cells[0]
+                  || y >= num_cells[1] || z >= num_cells[2]) {
+                continue;
+              }
+              const auto it = cells.find(cell_key(x, y, z));
+              if (it == cells.end()) { continue; }
+              for (const int j : it->second) {
+                if (j == m) { continue; }
+                double dist = 0;
+                for (int d = 0; d < 3; ++d) {
+                  dist += (centroids[j][d] - c[d]) * (centroids[j][d] - c[d]);
+                }
+                candidates.emplace_back(dist, j);
+              }
+            }
+          }
+        }
+        if (int(candidates.size()) >= k) {
+          std::nth_element(candidates.begin(), candidates.begin() + (k - 1),
+                           candidates.end());
+          const double reach = r * cell;
+          if (candidates[k - 1].first <= reach * reach) { break; }
+        }
+      }
+      const int found = std::min(k, int(candidates.size()));
+      std::partial_sort(candidates.begin(), candidates.begin() + found,
+                        candidates.end());
+      int32_t* ids = &m_neighbor_ids[(size_t(frame) * num_molecules + m) * k];
+      for (int i = 0; i < found; ++i) {
+        ids[i] = frame * num_molecules + candidates[i].second;
       }
     }
   }
+}
+
+bool pilot2_molecular_reader::fetch_datum(
+  CPUMat& X, int data_id, int mb_idx) {
+  DataType* dst = X.Buffer(0, mb_idx);
+  if (data_store_active()) {
+    conduit::Node node;
+    node.set_external(m_data_store->get_conduit_node(data_id));
+    const auto* src = static_cast<const DataType*>(
+      node[LBANN_DATA_ID_STR(data_id) + "/data"].data_ptr());
+    std::copy_n(src, get_linearized_data_size(), dst);
+    return true;
+  }
+  copy_sample(data_id, dst);
+  if (priming_data_store()) {
+    conduit::Node node;
+    node[LBANN_DATA_ID_STR(data_id) + "/data"].set(dst, get_linearized_data_size());
+    m_data_store->set_conduit_node(data_id, node);
+  }
   return true;
 }
 
-void pilot2_molecular_reader::fetch_molecule(CPUMat& X, int data_id, int idx,
-                                             int mb_idx) {
-  const int frame = get_frame(data_id);
-  // Compute the offset in features for this frame.
-  const int frame_offset = frame * m_num_features * m_num_samples_per_frame;
-  const int intra_frame_data_id = data_id - frame * m_num_samples_per_frame;
+void pilot2_molecular_reader::copy_sample(int data_id, DataType* dst) const {
+  // The molecule, then its neighbors
+  copy_molecule(data_id, dst);
+  const int32_t* ids = &m_neighbor_ids[size_t(data_id) * m_num_neighbors];
+  for (int i = 0; i < m_num_neighbors; ++i) {
+    DataType* neighbor_dst = dst + size_t(i + 1) * m_num_features;
+    if (ids[i] >= 0) {
+      copy_molecule(ids[i], neighbor_dst);
+    } else {
+      std::fill_n(neighbor_dst, m_num_features, DataType(0));
+    }
+  }
+}
+
+void pilot2_molecular_reader::copy_molecule(int data_id, DataType* dst) const {
+  // Samples are contiguous across frames, so the offset is direct
+  const size_t offset = size_t(data_id) * m_num_features;
+  const DataType* __restrict__ scales = m_feature_scales.data();
+  DataType* __restrict__ out = dst;
   if (m_features.word_size == 4) {
-    float *data = m_features.data<float>() + frame_offset +
-      intra_frame_data_id * m_num_features;
+    const float* __restrict__ data = m_features.data<float>() + offset;
     for (int i = 0; i < m_num_features; ++i) {
-      X(m_num_features * idx + i, mb_idx) = scale_data<float>(i, data[i]);
+      out[i] = data[i] * scales[i];
     }
-  } else if (m_features.word_size == 8) {
-    double *data = m_features.data<double>() + frame_offset +
-      intra_frame_data_id * m_num_features;
+  } else {
+    const double* __restrict__ data = m_features.data<double>() + offset;
     for (int i = 0; i < m_num_features; ++i) {
-      X(m_num_features * idx + i, mb_idx) = scale_data<double>(i, data[i]);
+      out[i] = data[i] * scales[i];
     }
   }
 }
 
+void pilot2_molecular_reader::load_conduit_node(int data_id, conduit::Node& node) {
+  node.reset();
+  std::vector<DataType> data(get_linearized_data_size());
+  copy_sample(data_id, data.data());
+  node[LBANN_DATA_ID_STR(data_id) + "/data"].set(data.data(), data.size());
+}
+
+void pilot2_molecular_reader::do_preload_data_store() {
+  parallel_preload_data_store(
+    [this](int data_id, conduit::Node& node) { load_conduit_node(data_id, node); });
+}
+
+void pilot2_molecular_reader::fetch_molecule(CPUMat& X, int data_id, int idx,
+                                             int mb_idx) {
+  copy_molecule(data_id, X.Buffer(m_num_features * idx, mb_idx));
+}
+
 }  // namespace lbann
@@ -29,7 +29,10 @@
 #ifdef LBANN_HAS_PYTHON
 #include <cstdio>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <regex>
+#include <thread>
 #include "lbann/trainers/trainer.hpp"
 #include "lbann/utils/python.hpp"
 
@@ -110,52 +113,133 @@ bool python_reader::fetch_data_block(CPUMat& X,
                                      El::Int mb_size,
                                      El::Matrix<El::Int>& indices_fetched) {
 
-  // Acquire Python GIL on first IO thread
-  // Note: Do nothing on other IO threads.
+  // The whole mini-batch is assembled by the worker processes, so only
+  // the first IO thread has anything to do.
   if (thread_id != 0) { return true; }
-  python::global_interpreter_lock gil;
 
-  // Check that shared memory array is large enough
-  const El::Int sample_size = get_linearized_data_size();
-  const El::Int array_size = PyObject_Length(m_shared_memory_array);
-  if (array_size < sample_size * mb_size) {
-    std::stringstream err;
-    err << "Python data reader attempted to load "
-        << sample_size * mb_size * sizeof(DataType) << " B "
-        << "into shared memory array, but only "
-        << array_size * sizeof(DataType) << " B is available";
-    LBANN_ERROR(err.str());
+  // Check that a shared memory slot is large enough
+  if (mb_size > m_slot_capacity) {
+    LBANN_ERROR("Python data reader attempted to load a mini-batch of ",
+                mb_size, " samples, but shared memory slots only hold ",
+                m_slot_capacity);
   }
 
-  // Get arguments for sample access function
-  python::object args_list = PyList_New(0);
-  for (El::Int i = 0; i < mb_size; ++i) {
-    El::Int sample_index = m_shuffled_indices[m_current_pos + i * m_sample_stride];
-    El::Int array_offset = sample_size * i;
-    PyList_Append(args_list,
-                  python::object(Py_BuildValue("(l,l)",
-                                               sample_index,
-                                               array_offset)));
-    indices_fetched.Set(i, 0, sample_index);
+  // Make sure this mini-batch and the following ones are being
+  // assembled; normally this one was submitted by an earlier fetch.
+  const auto indices = get_batch_indices(m_current_pos, mb_size);
+  const size_t slot = request_batch(indices);
+  if (m_next_slot == slot) {
+    // Don't let the look-ahead below evict this mini-batch
+    m_next_slot = (m_next_slot + 1) % m_slots.size();
   }
-
-  // Get samples using Python process pool
-  python::object samples = PyObject_CallMethod(m_process_pool,
-                                               "starmap",
-                                               "(O,O)",
-                                               m_sample_function_wrapper.get(),
-                                               args_list.get());
+  for (size_t j = 1; j < m_slots.size(); ++j) {
+    const auto next = get_batch_indices(
+      m_current_pos + j * m_stride_to_next_mini_batch, mb_size);
+    if (next.empty()) { break; }
+    request_batch(next);
+  }
+  wait_for_batch(slot);
 
   // Copy data from shared memory to output matrix
+  const El::Int sample_size = get_linearized_data_size();
   CPUMat shared_memory_matrix(sample_size,
                               mb_size,
-                              m_shared_memory_array_ptr,
+                              m_shared_memory_array_ptr
+                              + slot * m_slot_capacity * sample_size,
                               sample_size);
   El::Copy(shared_memory_matrix, X);
+  for (El::Int i = 0; i < mb_size; ++i) {
+    indices_fetched.Set(i, 0, indices[i]);
+  }
+  m_slots[slot].indices.clear();
 
   return true;
 }
 
+std::vector<El::Int> python_reader::get_batch_indices(El::Int pos,
+                                                      El::Int mb_size) const {
+  std::vector<El::Int> indices;
+  indices.reserve(mb_size);
+  for (El::Int i = 0; i < mb_size; ++i) {
+    const El::Int n = pos + i * m_sample_stride;
+    if (n >= static_cast<El::Int>(m_shuffled_indices.size())) { break; }
+    indices.push_back(m_shuffled_indices[n]);
+  }
+  return indices;
+}
+
+size_t python_reader::request_batch(const std::vector<El::Int>& indices) {
+  for (size_t s = 0; s < m_slots.size(); ++s) {
+    if (m_slots[s].indices == indices) { return s; }
+  }
+
+  // Reuse the oldest slot. A stale submission (e.g. a guess at a
+  // mini-batch that was never requested) may still be writing to it.
+  const size_t slot = m_next_slot;
+  m_next_slot = (m_next_slot + 1) % m_slots.size();
+  auto& state = m_slots[slot];
+  if (state.pending) { wait_for_batch(slot); }
+  state.generation = (state.generation % 255) + 1;
+  state.indices = indices;
+
+  // Submit samples to Python process pool
+  python::global_interpreter_lock gil;
+  const El::Int sample_size = get_linearized_data_size();
+  python::object args_list = PyList_New(0);
+  for (size_t i = 0; i < indices.size(); ++i) {
+    const El::Int flag_index = slot * m_slot_capacity + i;
+    PyList_Append(args_list,
+                  python::object(Py_BuildValue("(l,l,l,i)",
+                                               indices[i],
+                                               flag_index * sample_size,
+                                               flag_index,
+                                               int(state.generation))));
+  }
+  const El::Int chunk_size
+    = std::max(El::Int(1), El::Int(indices.size()) / (2 * m_num_workers));
+  state.result = PyObject_CallMethod(m_process_pool,
+                                     "starmap_async",
+                                     "(O,O,l)",
+                                     m_sample_function_wrapper.get(),
+                                     args_list.get(),
+                                     chunk_size);
+  python::check_error();
+  state.pending = true;
+  return slot;
+}
+
+void python_reader::wait_for_batch(size_t slot) {
+  auto& state = m_slots[slot];
+  if (!state.pending) { return; }
+  const size_t num_samples = state.indices.size();
+  volatile unsigned char* flags = m_ready_flags_ptr + slot * m_slot_capacity;
+  const auto error_check_interval = std::chrono::milliseconds(10);
+  auto next_error_check = std::chrono::steady_clock::now() + error_check_interval;
+  for (size_t i = 0; i < num_samples; ) {
+    if (flags[i] == state.generation) {
+      ++i;
+      continue;
+    }
+    std::this_thread::yield();
+    if (std::chrono::steady_clock::now() < next_error_check) { continue; }
+    next_error_check = std::chrono::steady_clock::now() + error_check_interval;
+
+    // If the workers are done but a sample is missing, one of them
+    // failed; AsyncResult.get() re-raises its exception.
+    python::global_interpreter_lock gil;
+    python::object ready = PyObject_CallMethod(state.result, "ready", nullptr);
+    if (PyObject_IsTrue(ready) && flags[i] != state.generation) {
+      python::object res = PyObject_CallMethod(state.result, "get", nullptr);
+      python::check_error();
+      LBANN_ERROR("Python data reader workers finished without producing sample ",
+                  state.indices[i]);
+    }
+  }
+  // The samples were written before their flags
+  std::atomic_thread_fence(std::memory_order_acquire);
+  state.pending = false;
+}
+
 bool python_reader::fetch_label(CPUMat& Y, int data_id, int col) {
   return true;
 }
@@ -179,11 +263,23 @@ void python_reader::setup(int num_io_threads,
     m_process_pool = nullptr;
   }
 
-  // Allocate shared memory array
+  // Allocate shared memory array with a ring of mini-batch slots
   /// @todo Figure out more robust way to get max mini-batch size
   const El::Int sample_size = get_linearized_data_size();
   const El::Int mini_batch_size
     = generic_data_reader::get_trainer().get_max_mini_batch_size();
+  El::Int num_slots = 3;
+  if (options::get()->has_int("python_reader_slots")) {
+    num_slots = options::get()->get_int("python_reader_slots");
+  }
+  if (num_slots < 1) {
+    LBANN_ERROR("--python_reader_slots must be at least 1; got ", num_slots);
+  }
+  m_slots.clear();
+  m_slots.resize(num_slots);
+  m_next_slot = 0;
+  m_slot_capacity = mini_batch_size;
+  m_num_workers = std::max(num_io_threads, 1);
   std::string datatype_typecode;
   switch (sizeof(DataType)) {
   case 4: datatype_typecode = "f"; break;
@@ -196,7 +292,14 @@ void python_reader::setup(int num_io_threads,
                           "RawArray",
                           "(s, l)",
                           datatype_typecode.c_str(),
-                          sample_size * mini_batch_size);
+                          sample_size * mini_batch_size * num_slots);
+  m_ready_flags
+    = PyObject_CallMethod(multiprocessing_module,
+                          "RawArray",
+                          "(s, l)",
+                          "B",
+                          mini_batch_size * num_slots);
+  python::check_error();
 
   // Get address of shared memory buffer
   python::object shared_memory_ptr
@@ -206,6 +309,13 @@ void python_reader::setup(int num_io_threads,
                           m_shared_memory_array.get());
   m_shared_memory_array_ptr
     = reinterpret_cast<DataType*>(PyLong_AsLong(shared_memory_ptr));
+  python::object ready_flags_ptr
+    = PyObject_CallMethod(ctypes_module,
+                          "addressof",
+                          "(O)",
+                          m_ready_flags.get());
+  m_ready_flags_ptr
+    = reinterpret_cast<volatile unsigned char*>(PyLong_AsLong(ready_flags_ptr));
 
   // Create global variables in Python
   // Note: The static counter makes sure variable names are unique.
@@ -225,39 +335,73 @@ void python_reader::setup(int num_io_threads,
                          shared_array_name.c_str(),
                          m_shared_memory_array);
   python::check_error();
+  const std::string ready_flags_name
+    = ("_DATA_READER_PYTHON_CPP_ready_flags"
+       + std::to_string(instance_id));
+  PyObject_SetAttrString(main_module,
+                         ready_flags_name.c_str(),
+                         m_ready_flags);
+  python::check_error();
 
   // Create wrapper around sample function
-  // Note: We attempt accessing the sample with the buffer protocol
-  // since they can be copied more efficiently. If this fails, we just
-  // iterate through the sample entries.
-  /// @todo Handle multi-dimensional NumPy arrays.
+  // Note: We copy the sample into its slot through NumPy when it is
+  // available, which accepts anything exposing __array_interface__ or
+  // the buffer protocol, with any shape and dtype. Otherwise we try the
+  // buffer protocol directly, and then fall back to iterating through
+  // the sample entries. The ready flag is written after the copy.
   const std::string wrapper_func_name
     = ("_DATA_READER_PYTHON_CPP_sample_function"
        + std::to_string(instance_id));
   std::string wrapper_func_def = R"(
-def @wrapper_func@(sample_index, array_offset):
-    """Get data sample and copy to shared memory array."""
+def @wrapper_func@(sample_index, array_offset, flag_index, generation):
+    """Get data sample, copy to shared memory array and mark it ready."""
 
     # Get sample
     sample = @sample_func@(sample_index)
 
     # Copy entries from sample to shared memory array
-    # Note: We attempt to copy via the buffer protocol since it is
-    # much more efficient than naively looping through the arrays.
-    try:
-        # Note: ctypes arrays explicitly specify their endianness, but
-        # memoryview copies only work when the endianness is
-        # explicitly set to the system default. We need to do some
-        # type casting to get around this excessive error checking.
-        input_buffer = memoryview(sample)
-        output_buffer = memoryview(@shared_array@)
-        output_buffer = output_buffer[array_offset:array_offset+@sample_size@]
-        output_buffer = output_buffer.cast('B').cast('@datatype_typecode@')
-        output_buffer[:] = input_buffer
-    except:
-        for i, val in enumerate(sample):
-            @shared_array@[i + array_offset] = val
+    global @shared_view@
+    if @shared_view@ is None:
+        try:
+            import numpy
+            @shared_view@ = numpy.frombuffer(@shared_array@,
+                                             dtype=numpy.dtype('@datatype_typecode@'))
+        except:
+            @shared_view@ = False
+    copied = False
+    if @shared_view@ is not False:
+        try:
+            import numpy
+            sample_array = numpy.asarray(sample, dtype=@shared_view@.dtype)
+            @shared_view@[array_offset:array_offset+@sample_size@] = \
+                sample_array.reshape(-1)
+            copied = True
+        except: pass
+    if not copied:
+        try:
+            # Note: ctypes arrays explicitly specify their endianness, but
+            # memoryview copies only work when the endianness is
+            # explicitly set to the system default. We need to do some
+            # type casting to get around this excessive error checking.
+            input_buffer = memoryview(sample)
+            output_buffer = memoryview(@shared_array@)
+            output_buffer = output_buffer[array_offset:array_offset+@sample_size@]
+            output_buffer = output_buffer.cast('B').cast('@datatype_typecode@')
+            output_buffer[:] = input_buffer
+        except:
+            for i, val in enumerate(sample):
+                @shared_array@[i + array_offset] = val
+
+    # Publish the sample to the C++ reader
+    @ready_flags@[flag_index] = generation
+@shared_view@ = None
 )";
+  wrapper_func_def = std::regex_replace(wrapper_func_def,
+                                        std::regex("\\@shared_view\\@"),
+                                        shared_array_name + "_view");
+  wrapper_func_def = std::regex_replace(wrapper_func_def,
+                                        std::regex("\\@ready_flags\\@"),
+                                        ready_flags_name);
   wrapper_func_def = std::regex_replace(wrapper_func_def,
                                         std::regex("\\@wrapper_func\\@"),
                                         wrapper_func_name);
@@ -30,10 +30,81 @@
 #include "lbann/utils/timer.hpp"
 #include "lbann/utils/commify.hpp"
 #include "lbann/utils/lbann_library.hpp"
+#include "lbann/utils/metadata_bundle.hpp"
+#include <sys/stat.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <mutex>
 
 namespace lbann {
 
+namespace {
+
+/// Header of a SMILES token cache; followed by num_tokens shorts (padded
+/// to a multiple of 8 bytes) and num_samples+1 uint64_t offsets.
+struct token_cache_header {
+  char magic[8];
+  uint64_t text_size;
+  int64_t text_mtime;
+  uint64_t vocab_hash;
+  uint64_t num_samples;
+  uint64_t num_tokens;
+};
+const char token_cache_magic[8] = {'L', 'B', 'S', 'M', 'T', 'O', 'K', '1'};
+
+size_t padded_token_bytes(uint64_t num_tokens) {
+  return (num_tokens * sizeof(short) + 7) / 8 * 8;
+}
+
+/// FNV-1a over the sorted vocabulary, so the cache is rebuilt if any id changes
+uint64_t hash_vocab(const std::unordered_map<char, short> &vocab, short unk) {
+  std::vector<std::pair<char, short>> entries(vocab.begin(), vocab.end());
+  std::sort(entries.begin(), entries.end());
+  entries.emplace_back('\0', unk);
+  uint64_t h = 14695981039346656037ull;
+  for (const auto &e : entries) {
+    const unsigned char bytes[3] = {static_cast<unsigned char>(e.first),
+                                    static_cast<unsigned char>(e.second & 0xff),
+                                    static_cast<unsigned char>((e.second >> 8) & 0xff)};
+    for (const auto b : bytes) {
+      h = (h ^ b) * 1099511628211ull;
+    }
+  }
+  return h;
+}
+
+token_cache_header make_token_cache_header(const std::string &text_file,
+                                           uint64_t vocab_hash) {
+  token_cache_header hdr;
+  std::memset(&hdr, 0, sizeof(hdr));
+  std::memcpy(hdr.magic, token_cache_magic, sizeof(token_cache_magic));
+  struct stat st;
+  if (stat(text_file.c_str(), &st) == 0) {
+    hdr.text_size = st.st_size;
+    hdr.text_mtime = st.st_mtime;
+  }
+  hdr.vocab_hash = vocab_hash;
+  return hdr;
+}
+
+/// True if hdr was made for the expected text file and vocabulary
+bool token_cache_matches(const token_cache_header &hdr,
+                         const token_cache_header &expected) {
+  return std::memcmp(hdr.magic, expected.magic, sizeof(hdr.magic)) == 0
+    && hdr.text_size == expected.text_size
+    && hdr.text_mtime == expected.text_mtime
+    && hdr.vocab_hash == expected.vocab_hash;
+}
+
+size_t token_cache_size(const token_cache_header &hdr) {
+  return sizeof(hdr) + padded_token_bytes(hdr.num_tokens)
+    + (hdr.num_samples + 1) * sizeof(uint64_t);
+}
+
+} // namespace
+
 smiles_data_reader::smiles_data_reader(const bool shuffle)
   : generic_data_reader(shuffle) {}
 
@@ -83,6 +154,9 @@ void smiles_data_reader::copy_members(const smiles_data_reader &rhs) {
   m_missing_char_in_vocab_count = rhs.m_missing_char_in_vocab_count;
   m_missing_chars = rhs.m_missing_chars;
   m_fast_experimental = rhs.m_fast_experimental;
+  m_token_cache = rhs.m_token_cache;
+  m_token_offsets = rhs.m_token_offsets;
+  m_tokens = rhs.m_tokens;
 }
 
 void smiles_data_reader::load() {
@@ -126,10 +200,16 @@ void smiles_data_reader::load() {
   // TODO: fix this!
   m_has_header = true;
 
-  const std::string infile = get_file_dir() + "/" + get_data_filename();
-  m_total_samples = get_num_lines(infile);
-  if (m_has_header) {
-    --m_total_samples;
+  set_delimiter();
+
+  if (opts->get_bool("smiles_token_cache")) {
+    m_total_samples = setup_token_cache();
+  } else {
+    const std::string infile = get_file_dir() + "/" + get_data_filename();
+    m_total_samples = get_num_lines(infile);
+    if (m_has_header) {
+      --m_total_samples;
+    }
   }
 
   // Get the number of samples to use (this is separate from "percent_of_data_to_use," etc);
@@ -151,7 +231,7 @@ void smiles_data_reader::load() {
   select_subset_of_data();
 
   // TODO: does this work if we carve of a validation set?
-  if (m_fast_experimental) {
+  if (m_fast_experimental && m_tokens == nullptr) {
     setup_fast_experimental();
   }
 
@@ -178,22 +258,44 @@ void smiles_data_reader::do_preload_data_store() {
 
   //TODO: this is terrible! Maybe: have root scan the file and bcast a map:
   //      offset->line number
+  //      The file is read serially, but the lines I own are encoded
+  //      in parallel
   int rank = m_comm->get_rank_in_trainer();
-  conduit::Node node;
+  std::unordered_map<int, std::string> my_lines;
   for (size_t data_id=0; data_id<m_shuffled_indices.size(); data_id++) {
     getline(in, line);
     int index = m_shuffled_indices[data_id];
     if (m_data_store->get_index_owner(index) != rank) {
       continue;
     }
-    construct_conduit_node(index, line, node);
-    m_data_store->set_preloaded_conduit_node(index, node);
+    my_lines[index] = line;
   }
   in.close();
+
+  parallel_preload_data_store(
+    [this, &my_lines](int data_id, conduit::Node &node) {
+      construct_conduit_node(data_id, my_lines.at(data_id), node);
+    });
 }
 
 bool smiles_data_reader::fetch_datum(Mat& X, int data_id, int mb_idx) {
-  if (m_fast_experimental) {
+  if (m_tokens != nullptr) {
+    // The cache holds untruncated strings; frame them as encode_smiles does
+    const uint64_t begin = m_token_offsets[data_id];
+    const int n = std::min<uint64_t>(m_token_offsets[data_id+1] - begin,
+                                     m_linearized_data_size - 2);
+    const short *v = m_tokens + begin;
+    X(0, mb_idx) = m_bos;
+    for (int j = 0; j < n; ++j) {
+      X(j+1, mb_idx) = v[j];
+    }
+    X(n+1, mb_idx) = m_eos;
+    for (int j = n+2; j < m_linearized_data_size; ++j) {
+      X(j, mb_idx) = m_pad;
+    }
+  }
+
+  else if (m_fast_experimental) {
     std::vector<short> data;
     get_sample(data_id, data);
 
@@ -262,6 +364,20 @@ bool smiles_data_reader::fetch_datum(Mat& X, int data_id, int mb_idx) {
   return true;
 }
 
+int smiles_data_reader::get_sample_length(int data_id) const {
+  uint64_t n;
+  if (m_tokens != nullptr) {
+    n = m_token_offsets[data_id+1] - m_token_offsets[data_id];
+  } else {
+    const auto iter = m_sample_lookup.find(data_id);
+    if (iter == m_sample_lookup.end()) {
+      return -1;
+    }
+    n = iter->second.second;
+  }
+  return std::min<uint64_t>(n, m_linearized_data_size - 2) + 2;
+}
+
 bool smiles_data_reader::fetch_label(Mat& Y, int data_id, int mb_idx) {
   LBANN_ERROR("smiles_data_reader::fetch_label is not implemented");
   return true;
@@ -288,7 +404,7 @@ void smiles_data_reader::print_statistics() const {
     std::cout << "delimiter=<tab>\n"; 
   } else if (m_delimiter == ',') {
     std::cout << "delimiter=<,>\n"; 
-  } else if (m_delimiter == '0') {
+  } else if (m_delimiter == '\0') {
     std::cout << "delimiter=<none>\n"; 
   } else {
     LBANN_ERROR("invalid delimiter character: ", m_delimiter);
@@ -305,7 +421,18 @@ void smiles_data_reader::load_vocab() {
   if (!opts->has_string("vocab")) {
     LBANN_ERROR("you must pass --vocab=<string> on the command line");
   }
-  const std::string fn = opts->get_string("vocab");
+  read_vocab(opts->get_string("vocab"), m_vocab, m_pad, m_unk, m_bos, m_eos);
+  if (opts->has_int("pad_index")) {
+    short tmp = opts->get_int("pad_index");
+    if (tmp != m_pad) {
+      LBANN_ERROR("you passed --pad_index=", tmp, " but we got --pad_index=", m_pad, " from the vocabulary file");
+    }
+  }
+}
+
+void smiles_data_reader::read_vocab(const std::string &fn,
+                                    std::unordered_map<char, short> &vocab,
+                                    short &pad, short &unk, short &bos, short &eos) {
   std::ifstream in(fn.c_str());
   if (!in) {
     LBANN_ERROR("failed to open ", fn, " for reading; this is the vocabulary file");
@@ -315,22 +442,22 @@ void smiles_data_reader::load_vocab() {
   int sanity = 4;
   while (in >> token >> id) {
     if (token.size() == 1) {
-      m_vocab[token[0]] = id;
+      vocab[token[0]] = id;
     }  
     if (token == "<pad>") {
-      m_pad = id;
+      pad = id;
       --sanity;
     }
     if (token == "<unk>") {
-      m_unk = id;
+      unk = id;
       --sanity;
     }
     if (token == "<bos>") {
-      m_bos = id;
+      bos = id;
       --sanity;
     }
     if (token == "<eos>") {
-      m_eos = id;
+      eos = id;
       --sanity;
     }
   }
@@ -338,12 +465,6 @@ void smiles_data_reader::load_vocab() {
   if (sanity) {
     LBANN_ERROR("failed to find <pad> and/or <unk> and/or <bos> and/or <eos> in vocab file: ", fn);
   }
-  if (opts->has_int("pad_index")) {
-    short tmp = opts->get_int("pad_index");
-    if (tmp != m_pad) {
-      LBANN_ERROR("you passed --pad_index=", tmp, " but we got --pad_index=", m_pad, " from the vocabulary file");
-    }
-  }
 }
 
 int smiles_data_reader::get_num_lines(std::string fn) {
@@ -466,41 +587,28 @@ void smiles_data_reader::setup_fast_experimental() {
     std::cout << "\nSTARTING smiles_data_reader::setup_fast_experimental() " << std::endl << std::endl;
   }  
 
-  // Get delimiter; default delimiter is none ('\0'), though it's likely
-  // to be ',' or '\t', since we're likely reading csv files
   options *opts = options::get();
-  if (opts->has_string("delimiter")) {
-    const std::string d = opts->get_string("delimiter");
-    const char dd = d[0];
-    switch (dd) {
-      case 'c' :
-        m_delimiter = ',';
-        break;
-      case 't' :
-        m_delimiter = '\t';
-        break;
-      case '0' :
-        m_delimiter = '\0';
-        break;
-      default :
-        LBANN_ERROR("Invalid delimiter character; should be 'c', 't', '0'; you passed: ", d);
-    }  
-  }
-  if (is_master()) {
-    std::cout << "USING delimiter character: " << m_delimiter << std::endl;
-  }
 
   // This will hold: (dataum_id, datum_offset, datum length) for each sample
   std::vector<size_t> sample_offsets(m_shuffled_indices.size()*3);
 
-  // Will hold size of above buffer, for bcasting
-  size_t buffer_size;
+  // The offsets and sample buffer are shared in one bundle, which may
+  // also be cached across runs
+  const std::string infile = get_file_dir() + "/" + get_data_filename();
+  metadata_bundle metadata;
+  metadata_bundle::key metadata_key;
+  metadata_key.add_file(infile).add(m_has_header).add(m_delimiter)
+    .add(static_cast<uint64_t>(m_shuffled_indices.size()));
+  for (const auto& idx : m_shuffled_indices) {
+    metadata_key.add(idx);
+  }
+  const bool cached = metadata.load_cached(*m_comm, m_comm->get_world_comm(),
+                                           "smiles", metadata_key);
 
-  if (is_master()) {
+  if (!cached && is_master()) {
     double tm1 = get_time();
 
     // Open input file and discard header line, if it exists
-    const std::string infile = get_file_dir() + "/" + get_data_filename();
     std::ifstream in(infile.c_str());
     if (!in) {
       LBANN_ERROR("failed to open data file: ", infile, " for reading");
@@ -539,8 +647,7 @@ void smiles_data_reader::setup_fast_experimental() {
         offset += k;
       }
     }
-    buffer_size = offset;
-    m_data.resize(buffer_size);
+    m_data.resize(offset);
 
     // Part 2: Fill in the data buffer
     in.seekg(0);
@@ -565,29 +672,22 @@ void smiles_data_reader::setup_fast_experimental() {
     std::cout << "P_0 time for computing sample sizes and filling buffer: " << get_time() - tm1 << std::endl;
   }
 
+  if (!cached) {
+    if (is_master()) {
+      metadata.put(sample_offsets);
+      metadata.put(m_data);
+    }
+    metadata.share(*m_comm, m_comm->get_world_comm());
+  }
+  metadata.get(sample_offsets);
+  metadata.get(m_data);
+
   // Construct lookup table for locating samples in the m_data vector (aka, the sample buffer)
-  m_comm->broadcast<size_t>(0, sample_offsets.data(), sample_offsets.size(), m_comm->get_world_comm());
   for (size_t j=0; j<sample_offsets.size(); j += 3) {
     m_sample_lookup[sample_offsets[j]] = 
       std::make_pair(sample_offsets[j+1], sample_offsets[j+2]);
   }
 
-  // Bcast the sample buffer
-  m_comm->broadcast<size_t>(0, &buffer_size, 1, m_comm->get_world_comm());
-  m_data.resize(buffer_size);
-
-  int full_rounds = m_data.size() / INT_MAX;
-  int last_round = m_data.size() % INT_MAX;
-  size_t the_offset = 0;
-
-  for (int j=0; j<full_rounds; j++) {
-    m_comm->broadcast<char>(0, m_data.data()+the_offset, INT_MAX, m_comm->get_world_comm());
-    the_offset += INT_MAX;
-  }
-  if (last_round) {
-    m_comm->broadcast<char>(0, m_data.data()+the_offset, last_round, m_comm->get_world_comm());
-  }
-
   if (is_master()) {
     std::cout << "total time for loading data: " << get_time()-tm3 << std::endl
               << "num samples: " << m_sample_lookup.size() << std::endl;
@@ -599,6 +699,154 @@ void smiles_data_reader::setup_fast_experimental() {
   }
 }
 
+void smiles_data_reader::set_delimiter() {
+  // Get delimiter; default delimiter is none ('\0'), though it's likely
+  // to be ',' or '\t', since we're likely reading csv files
+  options *opts = options::get();
+  if (opts->has_string("delimiter")) {
+    const std::string d = opts->get_string("delimiter");
+    const char dd = d[0];
+    switch (dd) {
+      case 'c' :
+        m_delimiter = ',';
+        break;
+      case 't' :
+        m_delimiter = '\t';
+        break;
+      case '0' :
+        m_delimiter = '\0';
+        break;
+      default :
+        LBANN_ERROR("Invalid delimiter character; should be 'c', 't', '0'; you passed: ", d);
+    }  
+  }
+  if (is_master()) {
+    std::cout << "USING delimiter character: " << m_delimiter << std::endl;
+  }
+}
+
+size_t smiles_data_reader::write_token_cache(const std::string &text_file,
+                                             const std::string &cache_file,
+                                             const std::unordered_map<char, short> &vocab,
+                                             short unk, char delimiter, bool has_header) {
+  std::ifstream in(text_file.c_str());
+  if (!in) {
+    LBANN_ERROR("failed to open data file: ", text_file, " for reading");
+  }
+  // Write to a temporary and rename, so a reader never maps a partial cache
+  const std::string tmp_file = cache_file + ".tmp";
+  std::ofstream out(tmp_file.c_str(), std::ios::binary);
+  if (!out) {
+    LBANN_ERROR("failed to open ", tmp_file, " for writing");
+  }
+
+  token_cache_header hdr = make_token_cache_header(text_file, hash_vocab(vocab, unk));
+  out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+
+  std::string line;
+  if (has_header) {
+    getline(in, line);
+  }
+  std::vector<uint64_t> offsets(1, 0);
+  std::vector<short> tokens;
+  size_t missing = 0;
+  for (size_t line_number = 0; getline(in, line); ++line_number) {
+    size_t len = line.size();
+    if (delimiter != '\0') {
+      len = line.find(delimiter);
+      if (len == std::string::npos) {
+        LBANN_ERROR("failed to find delimit character >>", delimiter, " in line: ", line, " which is line number ", line_number);
+      }
+    }
+    tokens.resize(len);
+    for (size_t j = 0; j < len; ++j) {
+      const auto it = vocab.find(line[j]);
+      if (it == vocab.end()) {
+        ++missing;
+        tokens[j] = unk;
+      } else {
+        tokens[j] = it->second;
+      }
+    }
+    out.write(reinterpret_cast<const char*>(tokens.data()), len * sizeof(short));
+    offsets.push_back(offsets.back() + len);
+  }
+  in.close();
+
+  hdr.num_samples = offsets.size() - 1;
+  hdr.num_tokens = offsets.back();
+  const char zeros[8] = {0};
+  out.write(zeros, padded_token_bytes(hdr.num_tokens) - hdr.num_tokens * sizeof(short));
+  out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+  out.seekp(0);
+  out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+  out.close();
+  if (!out) {
+    LBANN_ERROR("failed to write SMILES token cache ", tmp_file);
+  }
+  if (std::rename(tmp_file.c_str(), cache_file.c_str()) != 0) {
+    LBANN_ERROR("failed to rename ", tmp_file, " to ", cache_file, ": ", std::strerror(errno));
+  }
+  if (missing) {
+    LBANN_WARNING(missing, " characters in ", text_file, " were missing from the vocabulary and were encoded as <unk>");
+  }
+  return hdr.num_samples;
+}
+
+int smiles_data_reader::setup_token_cache() {
+  double tm1 = get_time();
+  const std::string infile = get_file_dir() + "/" + get_data_filename();
+  const std::string cache_file = infile + ".lbtok";
+  const token_cache_header expected =
+    make_token_cache_header(infile, hash_vocab(m_vocab, m_unk));
+
+  // The master rank (re)builds a missing or stale cache; everyone else waits
+  int ok = 1;
+  if (is_master()) {
+    token_cache_header hdr;
+    std::ifstream in(cache_file.c_str(), std::ios::binary);
+    const bool valid = in.read(reinterpret_cast<char*>(&hdr), sizeof(hdr))
+      && token_cache_matches(hdr, expected);
+    in.close();
+    if (!valid) {
+      std::cout << "building SMILES token cache: " << cache_file << std::endl;
+      try {
+        write_token_cache(infile, cache_file, m_vocab, m_unk, m_delimiter, m_has_header);
+      } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        ok = 0;
+      }
+    }
+  }
+  m_comm->broadcast<int>(0, &ok, 1, m_comm->get_world_comm());
+  if (!ok) {
+    LBANN_ERROR("failed to build SMILES token cache ", cache_file);
+  }
+
+  m_token_cache = std::make_shared<mapped_file>(cache_file);
+  token_cache_header hdr;
+  if (m_token_cache->size() < sizeof(hdr)) {
+    LBANN_ERROR("SMILES token cache ", cache_file, " is truncated");
+  }
+  std::memcpy(&hdr, m_token_cache->data(), sizeof(hdr));
+  if (!token_cache_matches(hdr, expected)) {
+    LBANN_ERROR("SMILES token cache ", cache_file, " does not match ", infile, " or the vocabulary");
+  }
+  if (m_token_cache->size() != token_cache_size(hdr)) {
+    LBANN_ERROR("SMILES token cache ", cache_file, " has size ", m_token_cache->size(),
+                "; expected ", token_cache_size(hdr));
+  }
+  m_tokens = reinterpret_cast<const short*>(m_token_cache->data() + sizeof(hdr));
+  m_token_offsets = reinterpret_cast<const uint64_t*>(
+    m_token_cache->data() + sizeof(hdr) + padded_token_bytes(hdr.num_tokens));
+
+  if (is_master()) {
+    std::cout << "mapped SMILES token cache with " << utils::commify(hdr.num_samples)
+              << " samples; time: " << get_time() - tm1 << std::endl;
+  }
+  return hdr.num_samples;
+}
+
 void smiles_data_reader::test_encode() {
   double tm1 = get_time();
   if (is_master()) {
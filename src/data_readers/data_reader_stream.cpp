@@ -0,0 +1,189 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+//
+// data_reader_stream .hpp .cpp - generic_data_reader class for unbounded sample streams
+////////////////////////////////////////////////////////////////////////////////
+#include "lbann/data_readers/data_reader_stream.hpp"
+#include "lbann/utils/random.hpp"
+#include <cstring>
+#include <string>
+
+namespace lbann {
+
+fifo_sample_producer::fifo_sample_producer(const std::string& path,
+                                           size_t record_size)
+  : m_in(path, std::ios::binary), m_path(path), m_record_size(record_size) {
+  if (!m_in) {
+    LBANN_ERROR("failed to open sample stream ", path, " for reading");
+  }
+}
+
+bool fifo_sample_producer::next(float* record) {
+  m_in.read(reinterpret_cast<char*>(record), m_record_size * sizeof(float));
+  if (m_in.gcount() == 0 && m_in.eof()) {
+    return false;
+  }
+  if (!m_in) {
+    LBANN_ERROR("sample stream ", m_path, " ended in the middle of a record");
+  }
+  return true;
+}
+
+data_reader_stream::data_reader_stream(int samples_per_epoch,
+                                       std::vector<int> dims,
+                                       int num_labels, bool shuffle)
+  : generic_data_reader(shuffle), m_samples_per_epoch(samples_per_epoch),
+    m_num_labels(num_labels), m_dimensions(dims),
+    m_stream(std::make_shared<stream_state>()) {}
+
+data_reader_stream::data_reader_stream(int samples_per_epoch,
+                                       std::vector<int> dims,
+                                       std::vector<int> response_dims,
+                                       bool shuffle)
+  : generic_data_reader(shuffle), m_samples_per_epoch(samples_per_epoch),
+    m_num_labels(0), m_dimensions(dims), m_response_dimensions(response_dims),
+    m_stream(std::make_shared<stream_state>()) {}
+
+void data_reader_stream::set_producer(std::unique_ptr<sample_producer> producer) {
+  std::lock_guard<std::mutex> lock(m_stream->mutex);
+  m_stream->producer = std::move(producer);
+}
+
+void data_reader_stream::load() {
+  if (m_samples_per_epoch <= 0) {
+    LBANN_ERROR("the stream data reader needs num_samples, the number of samples per epoch");
+  }
+  if (get_validation_percent() > 0) {
+    LBANN_ERROR("the stream data reader cannot carve a validation set out of a stream; "
+                "use a separate reader with role \"validate\"");
+  }
+  if (options::get()->get_bool("use_data_store")
+      || options::get()->get_bool("preload_data_store")) {
+    LBANN_ERROR("the stream data reader does not support the data store");
+  }
+
+  int capacity = 1024;
+  if (options::get()->has_int("stream_shuffle_buffer")) {
+    capacity = options::get()->get_int("stream_shuffle_buffer");
+  }
+  if (capacity < 1) {
+    LBANN_ERROR("--stream_shuffle_buffer must be at least 1; got ", capacity);
+  }
+
+  std::lock_guard<std::mutex> lock(m_stream->mutex);
+  m_stream->capacity = m_shuffle ? capacity : 1;
+  m_stream->buffer.assign(m_stream->capacity * get_record_size(), 0.f);
+  m_stream->size = 0;
+  m_stream->ended = false;
+  if (m_stream->producer == nullptr) {
+    std::string path = get_file_dir() + get_data_filename();
+    const std::string tag = "{rank}";
+    const size_t k = path.find(tag);
+    if (k != std::string::npos) {
+      path.replace(k, tag.size(), std::to_string(m_comm->get_rank_in_world()));
+    }
+    m_stream->producer.reset(new fifo_sample_producer(path, get_record_size()));
+  }
+
+  // Nothing to enumerate; positions in the epoch identify samples
+  m_shuffled_indices.clear();
+}
+
+void data_reader_stream::take_record(float* record) {
+  const size_t record_size = get_record_size();
+  std::lock_guard<std::mutex> lock(m_stream->mutex);
+  auto& st = *m_stream;
+
+  // Fill the buffer before handing out the first record, so samples
+  // are drawn from a full window of the stream
+  while (!st.ended && st.size < st.capacity) {
+    if (st.producer->next(st.buffer.data() + st.size * record_size)) {
+      ++st.size;
+    } else {
+      st.ended = true;
+    }
+  }
+  if (st.size == 0) {
+    LBANN_ERROR("the sample stream for ", get_role(), " has ended");
+  }
+
+  // Hand out a random record and put the next one from the stream in
+  // its place, or the last record if the stream has ended
+  const size_t j = st.size > 1 ? fast_rand_int(get_fast_io_generator(), st.size) : 0;
+  float* slot = st.buffer.data() + j * record_size;
+  std::memcpy(record, slot, record_size * sizeof(float));
+  if (st.ended || !st.producer->next(slot)) {
+    st.ended = true;
+    --st.size;
+    std::memmove(slot, st.buffer.data() + st.size * record_size,
+                 record_size * sizeof(float));
+  }
+}
+
+int data_reader_stream::fetch_data(CPUMat& X, El::Matrix<El::Int>& indices_fetched) {
+  const size_t tail_size = get_record_size() - get_linearized_data_size();
+  m_staged.resize(X.Width() * tail_size);
+  return generic_data_reader::fetch_data(X, indices_fetched);
+}
+
+bool data_reader_stream::fetch_datum(CPUMat& X, int data_id, int mb_idx) {
+  const size_t data_size = get_linearized_data_size();
+  const size_t tail_size = get_record_size() - data_size;
+  std::vector<float> record(data_size + tail_size);
+  take_record(record.data());
+  DataType* buf = X.Buffer(0, mb_idx);
+  for (size_t i = 0; i < data_size; ++i) {
+    buf[i] = record[i];
+  }
+  std::copy(record.begin() + data_size, record.end(),
+            m_staged.begin() + mb_idx * tail_size);
+  return true;
+}
+
+bool data_reader_stream::fetch_label(CPUMat& Y, int data_id, int mb_idx) {
+  if (m_num_labels == 0) {
+    LBANN_ERROR("stream data reader does not have labels");
+  }
+  const int label = static_cast<int>(m_staged[mb_idx]);
+  if (label < 0 || label >= m_num_labels) {
+    LBANN_ERROR("stream data reader expects ", m_num_labels,
+                " labels, but sample ", data_id, " has a label of ", label);
+  }
+  Y.Set(label, mb_idx, 1);
+  return true;
+}
+
+bool data_reader_stream::fetch_response(CPUMat& Y, int data_id, int mb_idx) {
+  if (m_response_dimensions.empty()) {
+    LBANN_ERROR("stream data reader does not have responses");
+  }
+  const size_t response_size = get_linearized_response_size();
+  for (size_t i = 0; i < response_size; ++i) {
+    Y(i, mb_idx) = m_staged[mb_idx * response_size + i];
+  }
+  return true;
+}
+
+}  // namespace lbann
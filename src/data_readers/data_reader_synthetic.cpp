@@ -27,6 +27,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lbann/data_readers/data_reader_synthetic.hpp"
+#include "lbann/utils/options.hpp"
 #include "lbann/utils/random.hpp"
 #include <cstdio>
 #include <string>
@@ -87,6 +88,12 @@ bool data_reader_synthetic::fetch_response(CPUMat& Y, int data_id, int mb_idx) {
   return true;
 }
 
+#ifdef LBANN_HAS_GPU
+bool data_reader_synthetic::supports_device_fetch() const {
+  return options::get()->get_bool("synthetic_on_device");
+}
+#endif // LBANN_HAS_GPU
+
 void data_reader_synthetic::load() {
   m_shuffled_indices.clear();
   m_shuffled_indices.resize(m_num_samples);
@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/data_readers/data_reader_synthetic.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <algorithm>
+
+namespace lbann {
+
+namespace {
+
+/** SplitMix64 finalizer. */
+__device__ __forceinline__ uint64_t mix(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+/** Fill a matrix with standard normal values.
+ *
+ *  Each entry is a hash of (seed, position), transformed with
+ *  Box-Muller, so there is no RNG state to set up or store.
+ */
+template <typename TensorDataType>
+__global__ void fill_normal_kernel(size_t height,
+                                   size_t width,
+                                   uint64_t seed,
+                                   TensorDataType * __restrict__ x,
+                                   size_t x_ldim) {
+  const size_t gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const size_t num_threads = blockDim.x * gridDim.x;
+  constexpr float two_pi = 6.283185307179586f;
+  constexpr float scale = 1.f / 4294967296.f;
+  for (size_t pos = gid; pos < height * width; pos += num_threads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    const uint64_t bits = mix(seed ^ mix(pos));
+    // u1 is in (0,1] so that its log is finite
+    const float u1 = (static_cast<uint32_t>(bits) + 1.f) * scale;
+    const float u2 = static_cast<uint32_t>(bits >> 32) * scale;
+    const float r = sqrtf(-2.f * logf(u1));
+    x[row + col * x_ldim] = TensorDataType(r * cosf(two_pi * u2));
+  }
+}
+
+} // namespace
+
+bool data_reader_synthetic::fetch_data_block_on_device(El::Matrix<DataType, El::Device::GPU>& X,
+                                                       El::Int mb_size,
+                                                       El::Matrix<El::Int>& indices_fetched,
+                                                       cudaStream_t stream) {
+  for (El::Int s = 0; s < mb_size; ++s) {
+    const int n = m_current_pos + (s * m_sample_stride);
+    indices_fetched.Set(s, 0, m_shuffled_indices[n]);
+  }
+
+  // Different seeds for each rank and mini-batch
+  const uint64_t seed = ((static_cast<uint64_t>(m_comm->get_rank_in_world()) << 40)
+                         ^ m_num_device_fetches++);
+  const size_t height = X.Height();
+  const size_t size = height * mb_size;
+  if (size > 0) {
+    constexpr size_t block_size = 256;
+    const size_t grid_size = std::min((size + block_size - 1) / block_size,
+                                      size_t(65535));
+    fill_normal_kernel<<<grid_size, block_size, 0, stream>>>(
+      height, mb_size, seed, X.Buffer(), X.LDim());
+    CHECK_CUDA(cudaGetLastError());
+  }
+  return true;
+}
+
+}  // namespace lbann
@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/data_readers/decoded_image_cache.hpp"
+
+#include <algorithm>
+
+namespace lbann {
+
+bool decoded_image_cache::get(int data_id, El::Matrix<uint8_t>& image,
+                              std::vector<size_t>& dims) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto it = m_images.find(data_id);
+  if (it == m_images.end()) {
+    return false;
+  }
+  const entry& e = it->second;
+  image.Resize(e.data.size(), 1);
+  std::copy(e.data.begin(), e.data.end(), image.Buffer());
+  dims = e.dims;
+  return true;
+}
+
+bool decoded_image_cache::insert(int data_id, const El::Matrix<uint8_t>& image,
+                                 const std::vector<size_t>& dims) {
+  const size_t bytes = image.Height() * image.Width();
+  if (image.Height() != image.LDim() && image.Width() > 1) {
+    LBANN_ERROR("cannot cache a non-contiguous image");
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_full || m_images.count(data_id) > 0) {
+    return false;
+  }
+  if (m_size + bytes > m_capacity) {
+    m_full = true;
+    return false;
+  }
+  entry& e = m_images[data_id];
+  e.data.assign(image.LockedBuffer(), image.LockedBuffer() + bytes);
+  e.dims = dims;
+  m_size += bytes;
+  return true;
+}
+
+size_t decoded_image_cache::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_size;
+}
+
+bool decoded_image_cache::contains(int data_id) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_images.count(data_id) > 0;
+}
+
+bool decoded_image_cache::full() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_full;
+}
+
+} // namespace lbann
@@ -0,0 +1,161 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/data_readers/sample_list_binary.hpp"
+#include "lbann/utils/exception.hpp"
+#include <cstring>
+#include <fstream>
+
+namespace lbann {
+
+namespace {
+
+const char binary_magic[8] = {'L', 'B', 'A', 'N', 'N', 'S', 'L', '\0'};
+constexpr uint32_t binary_version = 1u;
+
+} // namespace
+
+bool sample_list_binary::is_binary(const std::string& filename) {
+  std::ifstream in(filename, std::ios::binary);
+  char magic[sizeof(binary_magic)];
+  return in.read(magic, sizeof(magic))
+    && (std::memcmp(magic, binary_magic, sizeof(magic)) == 0);
+}
+
+void sample_list_binary::write(const std::string& filename,
+                               const std::string& file_dir,
+                               const std::vector<file_entry>& files) {
+  std::vector<file_record> file_table;
+  std::vector<sample_record> sample_table;
+  std::string strings;
+  file_table.reserve(files.size());
+
+  auto add_string = [&strings](const std::string& s, uint64_t& offset, uint64_t& length) {
+    offset = strings.size();
+    length = s.size();
+    strings += s;
+  };
+
+  header_t hdr;
+  std::memset(&hdr, 0, sizeof(hdr));
+  std::memcpy(hdr.magic, binary_magic, sizeof(binary_magic));
+  hdr.version = binary_version;
+  add_string(file_dir, hdr.file_dir_offset, hdr.file_dir_length);
+  for (const auto& f : files) {
+    file_record r;
+    add_string(f.name, r.name_offset, r.name_length);
+    r.first_sample = sample_table.size();
+    r.num_samples = f.samples.size();
+    r.total_samples = f.total_samples;
+    if (r.total_samples < r.num_samples) {
+      LBANN_ERROR("file ", f.name, " has ", r.num_samples,
+                  " included samples but only ", r.total_samples, " in total");
+    }
+    hdr.num_excluded += r.total_samples - r.num_samples;
+    for (const auto& s : f.samples) {
+      sample_record sr;
+      add_string(s, sr.name_offset, sr.name_length);
+      sample_table.push_back(sr);
+    }
+    file_table.push_back(r);
+  }
+  hdr.num_files = file_table.size();
+  hdr.num_samples = sample_table.size();
+  hdr.file_table_offset = sizeof(header_t);
+  hdr.sample_table_offset = hdr.file_table_offset + file_table.size() * sizeof(file_record);
+  hdr.string_table_offset = hdr.sample_table_offset + sample_table.size() * sizeof(sample_record);
+  hdr.string_table_size = strings.size();
+
+  std::ofstream out(filename, std::ios::binary);
+  if (!out) {
+    LBANN_ERROR("failed to open ", filename, " for writing");
+  }
+  out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+  out.write(reinterpret_cast<const char*>(file_table.data()),
+            file_table.size() * sizeof(file_record));
+  out.write(reinterpret_cast<const char*>(sample_table.data()),
+            sample_table.size() * sizeof(sample_record));
+  out.write(strings.data(), strings.size());
+  if (!out) {
+    LBANN_ERROR("failed to write ", filename);
+  }
+}
+
+sample_list_binary::sample_list_binary(const std::string& filename)
+  : m_file(filename) {
+  const char* base = m_file.data();
+  const size_t size = m_file.size();
+  if (size < sizeof(header_t)
+      || std::memcmp(base, binary_magic, sizeof(binary_magic)) != 0) {
+    LBANN_ERROR(filename, " is not a binary sample list");
+  }
+  m_header = reinterpret_cast<const header_t*>(base);
+  if (m_header->version != binary_version) {
+    LBANN_ERROR(filename, " has binary sample list version ", m_header->version,
+                ", expected ", binary_version);
+  }
+  // Validate the section bounds once so accessors need no checks
+  const header_t& h = *m_header;
+  const bool ok =
+    (h.file_table_offset + h.num_files * sizeof(file_record) <= h.sample_table_offset)
+    && (h.sample_table_offset + h.num_samples * sizeof(sample_record) <= h.string_table_offset)
+    && (h.string_table_offset + h.string_table_size <= size)
+    && (h.file_dir_offset + h.file_dir_length <= h.string_table_size);
+  if (!ok) {
+    LBANN_ERROR(filename, " is truncated or corrupt");
+  }
+  m_files = reinterpret_cast<const file_record*>(base + h.file_table_offset);
+  m_samples = reinterpret_cast<const sample_record*>(base + h.sample_table_offset);
+  m_strings = base + h.string_table_offset;
+  if (h.num_files > 0u) {
+    const file_record& last = m_files[h.num_files - 1u];
+    if (last.first_sample + last.num_samples != h.num_samples) {
+      LBANN_ERROR(filename, " has a file table inconsistent with its sample table");
+    }
+  }
+}
+
+std::string sample_list_binary::get_string(uint64_t offset, uint64_t length) const {
+  if (offset + length > m_header->string_table_size) {
+    LBANN_ERROR("binary sample list string out of range");
+  }
+  return std::string(m_strings + offset, length);
+}
+
+std::string sample_list_binary::get_file_dir() const {
+  return get_string(m_header->file_dir_offset, m_header->file_dir_length);
+}
+
+std::string sample_list_binary::get_file_name(size_t i) const {
+  return get_string(m_files[i].name_offset, m_files[i].name_length);
+}
+
+std::string sample_list_binary::get_sample_name(size_t i) const {
+  return get_string(m_samples[i].name_offset, m_samples[i].name_length);
+}
+
+} // namespace lbann
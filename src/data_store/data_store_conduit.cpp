@@ -34,7 +34,16 @@
 #include "lbann/utils/timer.hpp"
 #include "lbann/utils/file_utils.hpp"
 #include "lbann/utils/commify.hpp"
+#include "lbann/utils/compression.hpp"
+#include "lbann/utils/numa.hpp"
+#include "lbann/utils/quantization.hpp"
 #include <unordered_set>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <deque>
+#include <future>
+#include <cstring>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <stdarg.h>
@@ -44,6 +53,7 @@
 #include <unistd.h>
 #include <sys/statvfs.h>
 #include <cereal/types/unordered_map.hpp>
+#include <cereal/types/vector.hpp>
 #include <cereal/archives/binary.hpp>
 
 
@@ -53,6 +63,32 @@
 
 namespace lbann {
 
+namespace {
+/// name of the child that describes the compressed fields of a sample
+const std::string compressed_fields_name = "lbann_compressed_fields";
+/// max number of decompressed samples cached by each thread
+const size_t max_decompressed_cache_size = 8;
+
+/// a packed sample, as snapshotted for an asynchronous checkpoint
+struct checkpoint_extent {
+  int data_id;
+  const char *data;
+  size_t size;
+};
+
+/// runs on the background writer; see data_store_conduit::write_checkpoint_async
+void write_checkpoint_snapshot(const std::vector<checkpoint_extent> &snapshot, const std::string &fn) {
+  sample_segment seg;
+  seg.open(fn);
+  for (const auto &t : snapshot) {
+    seg.append(t.data_id, t.data, t.size);
+  }
+  seg.persist();
+}
+}
+
+std::atomic<size_t> data_store_conduit::s_num_instances(0);
+
 data_store_conduit::data_store_conduit(
   generic_data_reader *reader) :
   m_reader(reader) {
@@ -86,11 +122,79 @@ data_store_conduit::data_store_conduit(
   if (opts->has_string("data_store_spill")) {
     setup_spill(opts->get_string("data_store_spill"));
   }
+  if (opts->has_string("data_store_tiered")
+      && (opts->has_string("data_store_spill") || opts->has_string("data_store_test_checkpoint"))) {
+    LBANN_ERROR("--data_store_tiered may not be used with --data_store_spill or --data_store_test_checkpoint");
+  }
+  m_max_resident = opts->get_int("data_store_tiered_cache", m_max_resident);
+
+  m_node_shared = opts->get_bool("data_store_node_shared");
+  if (m_node_shared && (opts->get_bool("data_store_cache") || m_spill || opts->has_string("data_store_tiered"))) {
+    LBANN_ERROR("--data_store_node_shared may not be used with --data_store_cache, --data_store_spill, or --data_store_tiered");
+  }
+  m_deflate = opts->get_bool("data_store_compress") || opts->has_string("data_store_compress_fields");
+  if (opts->has_string("data_store_quantize")) {
+    for (const auto &spec : get_tokens(opts->get_string("data_store_quantize"), ",")) {
+      const size_t colon = spec.find(':');
+      if (colon == std::string::npos) {
+        LBANN_ERROR("--data_store_quantize expects <name:type,...>; got \"", spec, "\"");
+      }
+      m_quantize_fields.emplace_back(spec.substr(0, colon),
+                                     utils::parse_storage_type(spec.substr(colon+1)));
+    }
+  }
+  m_compress = m_deflate || !m_quantize_fields.empty();
+  if (m_compress) {
+    if (opts->get_bool("data_store_cache")) {
+      LBANN_ERROR("--data_store_compress may not be used with --data_store_cache");
+    }
+    if (m_deflate && !utils::have_compression()) {
+      LBANN_ERROR("--data_store_compress requires LBANN to be built with LBANN_WITH_ZLIB=ON");
+    }
+    if (opts->has_string("data_store_compress_fields")) {
+      m_compress_fields = get_tokens(opts->get_string("data_store_compress_fields"), ",");
+    }
+    // compressed samples are never the same size
+    m_node_sizes_vary = true;
+    PROFILE("data_store_conduit will compress samples");
+  }
+  if (opts->has_string("data_store_tiered") && !opts->get_bool("data_store_tiered_auto")) {
+    setup_tier(opts->get_string("data_store_tiered"));
+  }
 
   set_is_local_cache(opts->get_bool("data_store_cache"));
   set_is_preloading(opts->get_bool("preload_data_store"));
   set_is_explicitly_loading(! is_preloading());
+
+  m_async_checkpoint = opts->get_bool("data_store_async_checkpoint");
+  if (m_async_checkpoint && opts->has_string("data_store_spill")) {
+    LBANN_ERROR("--data_store_async_checkpoint may not be used with --data_store_spill; spilled samples are already on disk");
+  }
+
+  m_locality_shuffle = opts->get_bool("data_store_locality_shuffle");
+  if (m_locality_shuffle) {
+    PROFILE("data_store_conduit will bias shuffles toward locally owned samples");
+  }
+
+  m_pipeline_exchange = opts->get_bool("data_store_pipeline_exchange");
+  m_aggregate_exchange = opts->get_bool("data_store_aggregate_exchange");
+  if (m_aggregate_exchange) {
+    PROFILE("data_store_conduit will send one message per peer in exchange_mini_batch_data");
+  }
+  if (m_pipeline_exchange) {
+    PROFILE("data_store_conduit will pipeline exchange_mini_batch_data");
+  }
   
+  if (opts->get_bool("data_store_exchange_profile") && m_reader != nullptr) {
+    m_exchange_profiler.reset(new exchange_profiler(m_np_in_trainer));
+    m_exchange_profile_filename = "data_store_exchange_" + m_reader->get_role() + "." + std::to_string(m_rank_in_world) + ".jsonl";
+    m_exchange_profile_file.reset(new std::ofstream(m_exchange_profile_filename.c_str()));
+    if (!*m_exchange_profile_file) {
+      LBANN_ERROR("failed to open ", m_exchange_profile_filename, " for writing");
+    }
+    PROFILE("each rank writes exchange profiles to data_store_exchange_", m_reader->get_role(), ".<rank>.jsonl");
+  }
+
   if (is_local_cache()) {
     PROFILE("data_store_conduit is running in local_cache mode");
   } else {
@@ -106,12 +210,19 @@ data_store_conduit::data_store_conduit(
 }
 
 data_store_conduit::~data_store_conduit() {
+  drain_pipelined_exchanges();
+  try {
+    wait_for_checkpoint();
+  } catch (const std::exception &e) {
+    std::cerr << "\nWARNING: the background data store checkpoint failed: " << e.what() << "\n";
+  }
   if (m_debug) {
     m_debug->close();
   }
   if (m_profile) {
     m_profile->close();
   }
+  free_node_shared_segment();
   if (m_is_local_cache && m_mem_seg) {
     int sanity = shm_unlink(m_seg_name.c_str());
     if (sanity != 0) {
@@ -185,6 +296,7 @@ void data_store_conduit::copy_members(const data_store_conduit& rhs) {
   m_rank_in_trainer = rhs.m_rank_in_trainer;
   m_np_in_trainer = rhs.m_np_in_trainer;
   m_owner = rhs.m_owner;
+  m_owner_ranges = rhs.m_owner_ranges;
   m_shuffled_indices = rhs.m_shuffled_indices;
   m_sample_sizes = rhs.m_sample_sizes;
   m_mem_seg = rhs.m_mem_seg;
@@ -203,6 +315,28 @@ void data_store_conduit::copy_members(const data_store_conduit& rhs) {
   m_cur_spill_dir = rhs.m_cur_spill_dir;
   m_num_files_in_cur_spill_dir = rhs.m_num_files_in_cur_spill_dir;
 
+  // the file-backed tier is not shared; the copy will open its own
+  // segment when samples are added to it
+  m_tiered = rhs.m_tiered;
+  m_tier_dir = rhs.m_tier_dir;
+  m_max_resident = rhs.m_max_resident;
+  m_segment.reset();
+  m_lru.clear();
+  m_lru_pos.clear();
+
+  // as above, the node shared segment is not shared with the copy
+  m_node_shared = rhs.m_node_shared;
+
+  m_compress = rhs.m_compress;
+  m_deflate = rhs.m_deflate;
+  m_quantize_fields = rhs.m_quantize_fields;
+  m_compress_fields = rhs.m_compress_fields;
+
+  m_locality_shuffle = rhs.m_locality_shuffle;
+
+  // the copy neither shares nor waits on our checkpoint writer
+  m_async_checkpoint = rhs.m_async_checkpoint;
+
   /// Clear the pointer to the data reader, this cannot be copied
   m_reader = nullptr;
   m_shuffled_indices = nullptr;
@@ -212,9 +346,10 @@ void data_store_conduit::copy_members(const data_store_conduit& rhs) {
   m_minibatch_data = rhs.m_minibatch_data;
   m_send_buffer = rhs.m_send_buffer;
   m_send_buffer_2 = rhs.m_send_buffer_2;
-  m_send_requests = rhs.m_send_requests;
-  m_recv_requests = rhs.m_recv_requests;
-  m_recv_buffer = rhs.m_recv_buffer;
+  m_exchange_ws = rhs.m_exchange_ws;
+  m_cur_exchange_ws = rhs.m_cur_exchange_ws;
+  m_pipeline_exchange = rhs.m_pipeline_exchange;
+  m_aggregate_exchange = rhs.m_aggregate_exchange;
   m_outgoing_msg_sizes = rhs.m_outgoing_msg_sizes;
   m_incoming_msg_sizes = rhs.m_incoming_msg_sizes;
   m_compacted_sample_size = rhs.m_compacted_sample_size;
@@ -234,11 +369,13 @@ void data_store_conduit::setup_data_store_buffers() {
   // allocate buffers that are used in exchange_data()
   m_send_buffer.resize(m_np_in_trainer);
   m_send_buffer_2.resize(m_np_in_trainer);
-  m_send_requests.resize(m_np_in_trainer);
-  m_recv_requests.resize(m_np_in_trainer);
   m_outgoing_msg_sizes.resize(m_np_in_trainer);
   m_incoming_msg_sizes.resize(m_np_in_trainer);
-  m_recv_buffer.resize(m_np_in_trainer);
+  for (auto &ws : m_exchange_ws) {
+    ws.send_requests.resize(m_np_in_trainer);
+    ws.recv_requests.resize(m_np_in_trainer);
+    ws.recv_buffer.resize(m_np_in_trainer);
+  }
 }
 
 void data_store_conduit::spill_preloaded_conduit_node(int data_id, const conduit::Node &node) {
@@ -263,7 +400,13 @@ void data_store_conduit::spill_preloaded_conduit_node(int data_id, const conduit
   }
 }
 
-void data_store_conduit::set_preloaded_conduit_node(int data_id, const conduit::Node &node) {
+void data_store_conduit::set_preloaded_conduit_node(int data_id, const conduit::Node &node_in) {
+  conduit::Node compressed;
+  if (m_compress) {
+    compress_node(node_in, compressed);
+  }
+  const conduit::Node &node = m_compress ? compressed : node_in;
+
   // note: at this point m_data[data_id] = node
   {
     std::lock_guard<std::mutex> lock(m_mutex);
@@ -281,6 +424,11 @@ void data_store_conduit::set_preloaded_conduit_node(int data_id, const conduit::
     return;
   }
 
+  if (m_tiered) {
+    set_preloaded_tiered_conduit_node(data_id, node);
+    return;
+  }
+
   { 
     conduit::Node n2 = node;
     std::lock_guard<std::mutex> lock(m_mutex);
@@ -324,12 +472,24 @@ void data_store_conduit::error_check_compacted_node(const conduit::Node &nd, int
 
 //n.b. Do not put any PROFILE or DEBUG_DS statements in this method,
 //     since the threading from the data_reader will cause you grief
-void data_store_conduit::set_conduit_node(int data_id, const conduit::Node &node, bool already_have) {
+void data_store_conduit::set_conduit_node(int data_id, const conduit::Node &node_in, bool already_have) {
+
+  // compress before taking the lock, so that I/O threads compress concurrently
+  conduit::Node compressed;
+  if (m_compress) {
+    compress_node(node_in, compressed);
+  }
+  const conduit::Node &node = m_compress ? compressed : node_in;
 
   std::lock_guard<std::mutex> lock(m_mutex);
   // TODO: test whether having multiple mutexes below is better (faster) than
   //       locking this entire call with a single mutex. For now I'm
   //       playing it safe and locking the whole dang thing.
+
+  // the background preload and the fetching threads may both load a sample
+  if (m_background_loading && m_data.find(data_id) != m_data.end()) {
+    return;
+  }
   ++m_my_num_indices;
 
   if (is_local_cache() && is_preloading()) {
@@ -402,18 +562,197 @@ const conduit::Node & data_store_conduit::get_conduit_node(int data_id) const {
     return t3->second;
   }
 
+  std::unique_lock<std::mutex> lock(m_mutex, std::defer_lock);
+  if (m_background_loading) {
+    lock.lock();
+  }
   std::unordered_map<int, conduit::Node>::const_iterator t2 = m_minibatch_data.find(data_id);
   // if not preloaded, and get_label() or get_response() is called,
   // we need to check m_data
   if (t2 == m_minibatch_data.end()) {
     std::unordered_map<int, conduit::Node>::const_iterator t3 = m_data.find(data_id);
     if (t3 != m_data.end()) {
-      return t3->second["data"];
+      return m_compress ? decompress_node(data_id, t3->second["data"]) : t3->second["data"];
     }
     LBANN_ERROR("failed to find data_id: ", data_id, " in m_minibatch_data; m_minibatch_data.size: ", m_minibatch_data.size(), " and also failed to find it in m_data; m_data.size: ", m_data.size(), "; role: ", m_reader->get_role());
   }
 
-  return t2->second;
+  return m_compress ? decompress_node(data_id, t2->second) : t2->second;
+}
+
+bool data_store_conduit::has_conduit_node(int data_id) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_data.find(data_id) != m_data.end();
+}
+
+void data_store_conduit::compress_node(const conduit::Node &node_in, conduit::Node &node_out) const {
+  node_out.reset();
+  conduit::Node fields;
+  compress_subtree(node_in, "", node_out, fields);
+  if (fields.number_of_children() > 0) {
+    node_out[compressed_fields_name].set(fields);
+  }
+}
+
+void data_store_conduit::compress_subtree(const conduit::Node &node_in, const std::string &path, conduit::Node &node_out, conduit::Node &fields) const {
+  if (node_in.dtype().is_object()) {
+    const std::vector<std::string> names = node_in.child_names();
+    for (size_t j=0; j<names.size(); j++) {
+      const std::string child_path = path.empty() ? names[j] : path + "/" + names[j];
+      compress_subtree(node_in.child(j), child_path, node_out[names[j]], fields);
+    }
+    return;
+  }
+
+  utils::storage_type storage;
+  const bool quantize = is_quantized(node_in, path, storage);
+  if (!quantize && !(m_deflate && is_compressible(node_in, path))) {
+    node_out.set(node_in);
+    return;
+  }
+
+  conduit::Node compact;
+  const conduit::Node *leaf = &node_in;
+  if (!node_in.is_compact()) {
+    node_in.compact_to(compact);
+    leaf = &compact;
+  }
+  const size_t num_elements = leaf->dtype().number_of_elements();
+  const unsigned char *payload = static_cast<const unsigned char*>(leaf->element_ptr(0));
+  size_t num_bytes = leaf->dtype().bytes_compact();
+
+  std::vector<unsigned char> quantized;
+  double scale = 1, offset = 0;
+  if (quantize) {
+    quantized.resize(num_elements * utils::storage_type_size(storage));
+    if (leaf->dtype().is_float32()) {
+      utils::quantize(leaf->as_float32_ptr(), num_elements, storage, quantized.data(), scale, offset);
+    } else {
+      utils::quantize(leaf->as_float64_ptr(), num_elements, storage, quantized.data(), scale, offset);
+    }
+    payload = quantized.data();
+    num_bytes = quantized.size();
+  }
+
+  // incompressible data (e.g, jpegs) is stored as-is
+  std::vector<unsigned char> bytes;
+  bool deflated = false;
+  if (m_deflate && (quantize || is_compressible(node_in, path))) {
+    utils::compress_bytes(payload, num_bytes, bytes);
+    deflated = bytes.size() < num_bytes;
+  }
+  if (!deflated && !quantize) {
+    node_out.set(node_in);
+    return;
+  }
+  if (deflated) {
+    node_out.set(bytes);
+  } else {
+    node_out.set(quantized);
+  }
+  conduit::Node &f = fields.append();
+  f["path"] = path;
+  f["dtype"] = static_cast<int64_t>(leaf->dtype().id());
+  f["num_elements"] = static_cast<int64_t>(num_elements);
+  if (quantize) {
+    f["storage"] = utils::to_string(storage);
+    f["scale"] = scale;
+    f["offset"] = offset;
+    f["deflated"] = static_cast<int64_t>(deflated);
+  }
+}
+
+bool data_store_conduit::is_quantized(const conduit::Node &leaf, const std::string &path, utils::storage_type &t) const {
+  if (m_quantize_fields.empty()
+      || !(leaf.dtype().is_float32() || leaf.dtype().is_float64())) {
+    return false;
+  }
+  const std::string p = "/" + path + "/";
+  for (const auto &field : m_quantize_fields) {
+    if (p.find("/" + field.first + "/") != std::string::npos) {
+      t = field.second;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool data_store_conduit::is_compressible(const conduit::Node &leaf, const std::string &path) const {
+  if (!leaf.dtype().is_number()) {
+    return false;
+  }
+  if (m_compress_fields.empty()) {
+    return static_cast<size_t>(leaf.dtype().bytes_compact()) >= m_compress_min_bytes;
+  }
+  const std::string p = "/" + path + "/";
+  for (const auto &field : m_compress_fields) {
+    if (p.find("/" + field + "/") != std::string::npos) {
+      return true;
+    }
+  }
+  return false;
+}
+
+const conduit::Node & data_store_conduit::decompress_node(int data_id, const conduit::Node &node) const {
+  if (!node.has_child(compressed_fields_name)) {
+    return node;
+  }
+
+  using cache_key = std::pair<size_t, int>;
+  thread_local std::map<cache_key, conduit::Node> cache;
+  thread_local std::deque<cache_key> cache_order;
+
+  const cache_key key(m_instance_id, data_id);
+  auto t = cache.find(key);
+  if (t != cache.end()) {
+    return t->second;
+  }
+
+  conduit::Node &out = cache[key];
+  cache_order.push_back(key);
+  const std::vector<std::string> names = node.child_names();
+  for (size_t j=0; j<names.size(); j++) {
+    if (names[j] != compressed_fields_name) {
+      out[names[j]].set(node.child(j));
+    }
+  }
+  const conduit::Node &fields = node[compressed_fields_name];
+  for (conduit::index_t j=0; j<fields.number_of_children(); j++) {
+    const conduit::Node &f = fields.child(j);
+    const std::string path = f["path"].as_string();
+    const conduit::Node &src = node[path];
+    conduit::Node &dst = out[path];
+    dst.set(conduit::DataType(f["dtype"].to_int64(), f["num_elements"].to_int64()));
+    if (!f.has_child("storage")) {
+      utils::decompress_bytes(src.element_ptr(0), src.dtype().number_of_elements(),
+                              dst.element_ptr(0), dst.dtype().bytes_compact());
+      continue;
+    }
+    const utils::storage_type storage = utils::parse_storage_type(f["storage"].as_string());
+    const size_t num_elements = f["num_elements"].to_int64();
+    const void *quantized = src.element_ptr(0);
+    std::vector<unsigned char> inflated;
+    if (f["deflated"].to_int64() != 0) {
+      inflated.resize(num_elements * utils::storage_type_size(storage));
+      utils::decompress_bytes(src.element_ptr(0), src.dtype().number_of_elements(),
+                              inflated.data(), inflated.size());
+      quantized = inflated.data();
+    }
+    const double scale = f["scale"].to_float64();
+    const double offset = f["offset"].to_float64();
+    if (dst.dtype().is_float32()) {
+      utils::dequantize(quantized, num_elements, storage, scale, offset, dst.as_float32_ptr());
+    } else {
+      utils::dequantize(quantized, num_elements, storage, scale, offset, dst.as_float64_ptr());
+    }
+  }
+
+  // evict the oldest entries; never the one we are about to return
+  while (cache_order.size() > max_decompressed_cache_size) {
+    cache.erase(cache_order.front());
+    cache_order.pop_front();
+  }
+  return out;
 }
 
 // code in the following method is a modification of code from
@@ -453,9 +792,18 @@ void data_store_conduit::build_node_for_sending(const conduit::Node &node_in, co
 }
 
 void data_store_conduit::exchange_data_by_sample(size_t current_pos, size_t mb_size) {
+  exchange_workspace &ws = m_exchange_ws[m_cur_exchange_ws];
+  start_exchange_data_by_sample(current_pos, mb_size, ws);
+  finish_exchange_data_by_sample(ws);
+}
+
+void data_store_conduit::start_exchange_data_by_sample(size_t current_pos, size_t mb_size, exchange_workspace &ws) {
   if (! m_is_setup) {
     LBANN_ERROR("setup(mb_size) has not been called");
   }
+  if (ws.in_flight) {
+    LBANN_ERROR("attempting to start an exchange in a work space that is already in flight");
+  }
 
   // The following is needed to deal with one-off cases where one or
   // more ranks do not own any samples (i.e, m_data is empty).
@@ -480,18 +828,43 @@ void data_store_conduit::exchange_data_by_sample(size_t current_pos, size_t mb_s
     m_exchange_sample_sizes_time += (get_time() - tm3);
   }
 
+  double tm_pack = get_time();
   int num_send_req = build_indices_i_will_send(current_pos, mb_size);
   if (m_spill) {
     // TODO
     load_spilled_conduit_nodes();
   }
+  if (m_segment) {
+    load_tiered_conduit_nodes();
+  }
 
   int num_recv_req = build_indices_i_will_recv(current_pos, mb_size);
+  ws.node_local_data_ids = m_node_local_indices_to_recv;
+  count_local_samples();
+  double tm_post = get_time();
+  if (m_exchange_profiler) {
+    record_exchange_traffic();
+  }
+
+  if (m_aggregate_exchange) {
+    const double pack_time = start_exchange_data_by_peer(ws);
+    if (m_exchange_profiler) {
+      m_exchange_profiler->record(exchange_profiler::PACK, tm_post - tm_pack + pack_time);
+      m_exchange_profiler->record(exchange_profiler::POST, get_time() - tm_post - pack_time);
+    }
+    ws.current_pos = current_pos;
+    ws.mb_size = mb_size;
+    ws.in_flight = true;
+    m_start_snd_rcv_time += (get_time() - tm5);
+    return;
+  }
 
-  m_send_requests.resize(num_send_req);
-  m_recv_requests.resize(num_recv_req);
-  m_recv_buffer.resize(num_recv_req);
-  m_recv_data_ids.resize(num_recv_req);
+  ws.send_requests.resize(num_send_req);
+  ws.recv_requests.resize(num_recv_req);
+  ws.recv_buffer.resize(num_recv_req);
+  ws.recv_data_ids.resize(num_recv_req);
+  ws.recv_buffer_index.resize(num_recv_req);
+  ws.recv_offsets.assign(num_recv_req, 0);
 
   //========================================================================
   //part 2: exchange the actual data
@@ -525,13 +898,13 @@ void data_store_conduit::exchange_data_by_sample(size_t current_pos, size_t mb_s
         sz = m_sample_sizes[index];
       }
 
-      m_comm->nb_tagged_send<El::byte>(s, sz, p, index, m_send_requests[ss++], m_comm->get_trainer_comm());
+      m_comm->nb_tagged_send<El::byte>(s, sz, p, index, ws.send_requests[ss++], m_comm->get_trainer_comm());
     }
   }
 
   // sanity checks
-  if (ss != m_send_requests.size()) {
-    LBANN_ERROR("ss != m_send_requests.size; ss: ", ss, " m_send_requests.size: ", m_send_requests.size());
+  if (ss != ws.send_requests.size()) {
+    LBANN_ERROR("ss != send_requests.size; ss: ", ss, " send_requests.size: ", ws.send_requests.size());
   }
 
   // start recvs for incoming data
@@ -550,29 +923,236 @@ void data_store_conduit::exchange_data_by_sample(size_t current_pos, size_t mb_s
         sz = m_sample_sizes[index];
       }
 
-      m_recv_buffer[ss].set(conduit::DataType::uint8(sz));
-      El::byte *r = reinterpret_cast<El::byte*>(m_recv_buffer[ss].data_ptr());
-      m_comm->nb_tagged_recv<El::byte>(r, sz, p, index, m_recv_requests[ss], m_comm->get_trainer_comm());
-      m_recv_data_ids[ss] = index;
+      ws.recv_buffer[ss].set(conduit::DataType::uint8(sz));
+      El::byte *r = reinterpret_cast<El::byte*>(ws.recv_buffer[ss].data_ptr());
+      m_comm->nb_tagged_recv<El::byte>(r, sz, p, index, ws.recv_requests[ss], m_comm->get_trainer_comm());
+      ws.recv_data_ids[ss] = index;
+      ws.recv_buffer_index[ss] = ss;
       ++ss;
     }
   }
 
   // sanity checks
-  if (ss != m_recv_buffer.size()) {
-    LBANN_ERROR("ss != m_recv_buffer.size; ss: ", ss, " m_recv_buffer.size: ", m_recv_buffer.size());
+  if (ss != ws.recv_buffer.size()) {
+    LBANN_ERROR("ss != recv_buffer.size; ss: ", ss, " recv_buffer.size: ", ws.recv_buffer.size());
   }
-  if (m_recv_requests.size() != m_recv_buffer.size()) {
-    LBANN_ERROR("m_recv_requests.size != m_recv_buffer.size; m_recv_requests: ", m_recv_requests.size(), " m_recv_buffer.size: ", m_recv_buffer.size());
+  if (ws.recv_requests.size() != ws.recv_buffer.size()) {
+    LBANN_ERROR("recv_requests.size != recv_buffer.size; recv_requests: ", ws.recv_requests.size(), " recv_buffer.size: ", ws.recv_buffer.size());
   }
+  m_num_exchange_msgs += ws.send_requests.size();
 
+  ws.current_pos = current_pos;
+  ws.mb_size = mb_size;
+  ws.in_flight = true;
+
+  if (m_exchange_profiler) {
+    m_exchange_profiler->record(exchange_profiler::PACK, tm_post - tm_pack);
+    m_exchange_profiler->record(exchange_profiler::POST, get_time() - tm_post);
+  }
   m_start_snd_rcv_time += (get_time() - tm5);
+}
+
+double data_store_conduit::start_exchange_data_by_peer(exchange_workspace &ws) {
+  double pack_time = 0.;
+  // reserve, so the requests are not relocated once they've been posted
+  ws.send_requests.clear();
+  ws.send_requests.reserve(m_np_in_trainer);
+  ws.recv_requests.clear();
+  ws.recv_requests.reserve(m_np_in_trainer);
+  ws.send_buffers.resize(m_np_in_trainer);
+  ws.recv_buffer.resize(m_np_in_trainer);
+  ws.recv_data_ids.clear();
+  ws.recv_buffer_index.clear();
+  ws.recv_offsets.clear();
+
+  // Both sides of each exchange pack the samples in order of
+  // increasing data_id; since sample sizes are known on both sides,
+  // the receiver can compute the offsets without a separate header
+  std::vector<int> ids;
+
+  // pack and start sends for outgoing data; one message per peer
+  for (int p=0; p<m_np_in_trainer; p++) {
+    const std::unordered_set<int> &indices = m_indices_to_send[p];
+    if (indices.empty()) {
+      continue;
+    }
+    ids.assign(indices.begin(), indices.end());
+    std::sort(ids.begin(), ids.end());
+    size_t total = 0;
+    for (auto index : ids) {
+      total += get_exchange_sample_size(index);
+    }
+    const double tm1 = m_exchange_profiler ? get_time() : 0.;
+    std::vector<El::byte> &buf = ws.send_buffers[p];
+    buf.resize(total);
+    size_t offset = 0;
+    for (auto index : ids) {
+      if (m_data.find(index) == m_data.end()) {
+        LBANN_ERROR("failed to find data_id: ", index, " to be sent to ", p, " in m_data");
+      }
+      const conduit::Node& n = m_data[index];
+      if(!n.is_contiguous() || n.data_ptr() == nullptr) {
+        LBANN_ERROR("data_id: ", index, " does not have a contiguous layout or a valid data pointer");
+      }
+      const size_t sz = get_exchange_sample_size(index);
+      memcpy(buf.data()+offset, n.data_ptr(), sz);
+      offset += sz;
+    }
+    if (m_exchange_profiler) {
+      pack_time += get_time() - tm1;
+    }
+    if (total > static_cast<size_t>(INT_MAX)) {
+      LBANN_ERROR("aggregated message to P_", p, " is ", total, " bytes, which exceeds INT_MAX; please run without --data_store_aggregate_exchange");
+    }
+    ws.send_requests.emplace_back();
+    m_comm->nb_tagged_send<El::byte>(buf.data(), total, p, m_aggregated_exchange_tag, ws.send_requests.back(), m_comm->get_trainer_comm());
+  }
+
+  // start recvs for incoming data; one message per peer
+  for (int p=0; p<m_np_in_trainer; p++) {
+    const std::unordered_set<int> &indices = m_indices_to_recv[p];
+    if (indices.empty()) {
+      continue;
+    }
+    ids.assign(indices.begin(), indices.end());
+    std::sort(ids.begin(), ids.end());
+    size_t total = 0;
+    for (auto index : ids) {
+      ws.recv_data_ids.push_back(index);
+      ws.recv_buffer_index.push_back(p);
+      ws.recv_offsets.push_back(total);
+      total += get_exchange_sample_size(index);
+    }
+    if (total > static_cast<size_t>(INT_MAX)) {
+      LBANN_ERROR("aggregated message from P_", p, " is ", total, " bytes, which exceeds INT_MAX; please run without --data_store_aggregate_exchange");
+    }
+    ws.recv_buffer[p].set(conduit::DataType::uint8(total));
+    El::byte *r = reinterpret_cast<El::byte*>(ws.recv_buffer[p].data_ptr());
+    ws.recv_requests.emplace_back();
+    m_comm->nb_tagged_recv<El::byte>(r, total, p, m_aggregated_exchange_tag, ws.recv_requests.back(), m_comm->get_trainer_comm());
+  }
+  m_num_exchange_msgs += ws.send_requests.size();
+  return pack_time;
+}
+
+void data_store_conduit::record_exchange_traffic() {
+  for (int p=0; p<m_np_in_trainer; p++) {
+    const std::unordered_set<int> &to_send = m_indices_to_send[p];
+    const std::unordered_set<int> &to_recv = m_indices_to_recv[p];
+    size_t bytes = 0;
+    for (auto index : to_send) {
+      bytes += get_exchange_sample_size(index);
+    }
+    if (!to_send.empty()) {
+      m_exchange_profiler->add_sent(p, bytes, m_aggregate_exchange ? 1 : to_send.size());
+    }
+    bytes = 0;
+    for (auto index : to_recv) {
+      bytes += get_exchange_sample_size(index);
+    }
+    if (!to_recv.empty()) {
+      m_exchange_profiler->add_received(p, bytes, m_aggregate_exchange ? 1 : to_recv.size());
+    }
+  }
+}
+
+void data_store_conduit::count_local_samples() {
+  for (int p=0; p<m_np_in_trainer; p++) {
+    const bool local = (p == m_rank_in_trainer);
+    for (auto index : m_indices_to_recv[p]) {
+      const size_t sz = get_exchange_sample_size(index);
+      if (local) {
+        ++m_num_local_samples;
+        m_num_local_bytes += sz;
+      } else {
+        ++m_num_remote_samples;
+        m_num_remote_bytes += sz;
+      }
+    }
+  }
+  for (auto index : m_node_local_indices_to_recv) {
+    ++m_num_local_samples;
+    m_num_local_bytes += get_exchange_sample_size(index);
+  }
+}
+
+void data_store_conduit::localize_shuffled_indices(std::vector<int> &indices) {
+  if (!m_owner_maps_were_exchanged || m_owner_map_mb_size == 0 || m_np_in_trainer == 1) {
+    return;
+  }
+  double tm1 = get_time();
+  const size_t mb_size = m_owner_map_mb_size;
+  std::vector<std::vector<size_t>> slots(m_np_in_trainer);
+  std::vector<std::vector<int>> owned(m_np_in_trainer);
+  std::vector<size_t> free_slots;
+  std::vector<int> leftover;
+  size_t num_moved = 0;
+
+  for (size_t start = 0; start < indices.size(); start += mb_size) {
+    const size_t end = std::min(start + mb_size, indices.size());
+    for (int p=0; p<m_np_in_trainer; p++) {
+      slots[p].clear();
+      owned[p].clear();
+    }
+    free_slots.clear();
+    leftover.clear();
+
+    // bucket the slots by the rank that consumes them (see
+    // build_indices_i_will_recv) and the samples by the rank that owns them
+    for (size_t i = start; i < end; i++) {
+      slots[(i % mb_size) % m_np_in_trainer].push_back(i);
+      const int owner = find_index_owner(indices[i]);
+      if (owner < 0) {
+        leftover.push_back(indices[i]);
+      } else {
+        owned[owner].push_back(indices[i]);
+      }
+    }
+
+    for (int p=0; p<m_np_in_trainer; p++) {
+      const size_t n = std::min(slots[p].size(), owned[p].size());
+      for (size_t k = 0; k < n; k++) {
+        if (indices[slots[p][k]] != owned[p][k]) {
+          ++num_moved;
+        }
+        indices[slots[p][k]] = owned[p][k];
+      }
+      free_slots.insert(free_slots.end(), slots[p].begin() + n, slots[p].end());
+      leftover.insert(leftover.end(), owned[p].begin() + n, owned[p].end());
+    }
+    std::sort(free_slots.begin(), free_slots.end());
+    for (size_t k = 0; k < free_slots.size(); k++) {
+      indices[free_slots[k]] = leftover[k];
+    }
+  }
+  PROFILE("localize_shuffled_indices; moved ", num_moved, " of ", indices.size(), " samples; time: ", get_time() - tm1);
+}
+
+size_t data_store_conduit::get_exchange_sample_size(int data_id) const {
+  if (!m_node_sizes_vary) {
+    return m_compacted_sample_size;
+  }
+  map_is_t::const_iterator t = m_sample_sizes.find(data_id);
+  if (t == m_sample_sizes.end()) {
+    LBANN_ERROR("m_sample_sizes.find(data_id) == m_sample_sizes.end() for data_id: ", data_id, "; m_sample_sizes.size(): ", m_sample_sizes.size(), " role: ", m_reader->get_role());
+  }
+  return t->second;
+}
+
+void data_store_conduit::finish_exchange_data_by_sample(exchange_workspace &ws) {
+  if (! ws.in_flight) {
+    LBANN_ERROR("attempting to finish an exchange that was never started");
+  }
 
   // wait for all msgs to complete
-  tm5 = get_time();
-  m_comm->wait_all(m_send_requests);
-  m_comm->wait_all(m_recv_requests);
+  double tm5 = get_time();
+  m_comm->wait_all(ws.send_requests);
+  m_comm->wait_all(ws.recv_requests);
+  ws.in_flight = false;
   m_wait_all_time += (get_time() - tm5);
+  if (m_exchange_profiler) {
+    m_exchange_profiler->record(exchange_profiler::WAIT, get_time() - tm5);
+  }
 
   //========================================================================
   //part 3: construct the Nodes needed by me for the current minibatch
@@ -580,22 +1160,28 @@ void data_store_conduit::exchange_data_by_sample(size_t current_pos, size_t mb_s
   tm5 = get_time();
   conduit::Node nd;
   m_minibatch_data.clear();
-  for (size_t j=0; j < m_recv_buffer.size(); j++) {
-    conduit::uint8 *n_buff_ptr = (conduit::uint8*)m_recv_buffer[j].data_ptr();
+  for (size_t j=0; j < ws.recv_data_ids.size(); j++) {
+    conduit::uint8 *n_buff_ptr = (conduit::uint8*)ws.recv_buffer[ws.recv_buffer_index[j]].data_ptr();
+    n_buff_ptr += ws.recv_offsets[j];
+    conduit::Node n_msg;
+    view_packed_node(n_buff_ptr, n_msg);
+
+    int data_id = ws.recv_data_ids[j];
+    m_minibatch_data[data_id].set_external(n_msg["data"]);
+  }
+  for (auto data_id : ws.node_local_data_ids) {
+    map_is_t::const_iterator t = m_node_seg_offsets.find(data_id);
+    if (t == m_node_seg_offsets.end()) {
+      LBANN_ERROR("failed to find data_id: ", data_id, " in the node shared segment; role: ", m_reader->get_role());
+    }
     conduit::Node n_msg;
-    n_msg["schema_len"].set_external((conduit::int64*)n_buff_ptr);
-    n_buff_ptr +=8;
-    n_msg["schema"].set_external_char8_str((char*)(n_buff_ptr));
-    conduit::Schema rcv_schema;
-    conduit::Generator gen(n_msg["schema"].as_char8_str());
-    gen.walk(rcv_schema);
-    n_buff_ptr += n_msg["schema"].total_bytes_compact();
-    n_msg["data"].set_external(rcv_schema,n_buff_ptr);
-
-    int data_id = m_recv_data_ids[j];
+    view_packed_node(reinterpret_cast<const conduit::uint8*>(m_node_seg + t->second), n_msg);
     m_minibatch_data[data_id].set_external(n_msg["data"]);
   }
   m_rebuild_time += (get_time() - tm5);
+  if (m_exchange_profiler) {
+    m_exchange_profiler->record(exchange_profiler::UNPACK, get_time() - tm5);
+  }
 
   if (m_spill) {
     // TODO
@@ -603,14 +1189,70 @@ void data_store_conduit::exchange_data_by_sample(size_t current_pos, size_t mb_s
   }
 }
 
+void data_store_conduit::view_packed_node(const conduit::uint8 *buf, conduit::Node &n_msg) const {
+  conduit::uint8 *n_buff_ptr = const_cast<conduit::uint8*>(buf);
+  n_msg["schema_len"].set_external((conduit::int64*)n_buff_ptr);
+  n_buff_ptr +=8;
+  n_msg["schema"].set_external_char8_str((char*)(n_buff_ptr));
+  conduit::Schema rcv_schema;
+  conduit::Generator gen(n_msg["schema"].as_char8_str());
+  gen.walk(rcv_schema);
+  n_buff_ptr += n_msg["schema"].total_bytes_compact();
+  n_msg["data"].set_external(rcv_schema,n_buff_ptr);
+}
+
+void data_store_conduit::drain_pipelined_exchanges() {
+  if (m_comm == nullptr) {
+    return;
+  }
+  for (auto &ws : m_exchange_ws) {
+    if (ws.in_flight) {
+      m_comm->wait_all(ws.send_requests);
+      m_comm->wait_all(ws.recv_requests);
+      ws.in_flight = false;
+    }
+  }
+}
+
+bool data_store_conduit::can_pipeline_exchange() const {
+  // Spilling reuses m_data for each mini-batch, and the local cache
+  // does not exchange samples, so neither may be pipelined
+  return m_pipeline_exchange
+         && m_owner_maps_were_exchanged
+         && !m_spill
+         && !is_local_cache()
+         && m_reader != nullptr
+         && m_shuffled_indices != nullptr;
+}
+
+bool data_store_conduit::get_next_mini_batch_extent(size_t current_pos, size_t &next_pos, size_t &next_mb_size) const {
+  // Never look past the end of the epoch, since the indices will
+  // be reshuffled before the next mini-batch is fetched
+  const int num_iterations = m_reader->get_num_iterations_per_epoch();
+  const int next_idx = m_reader->get_loaded_mini_batch_index() + m_reader->get_iteration_stride();
+  if (next_idx >= num_iterations) {
+    return false;
+  }
+  next_pos = current_pos + (m_reader->get_next_position() - m_reader->get_position());
+  next_mb_size = (next_idx >= num_iterations - 1)
+                   ? m_reader->get_last_mini_batch_size()
+                   : m_reader->get_mini_batch_size();
+  return next_pos + next_mb_size <= m_shuffled_indices->size();
+}
+
 int data_store_conduit::build_indices_i_will_recv(int current_pos, int mb_size) {
   m_indices_to_recv.clear();
   m_indices_to_recv.resize(m_np_in_trainer);
+  m_node_local_indices_to_recv.clear();
   int k = 0;
   for (int i=current_pos; i< current_pos + mb_size; ++i) {
     auto index = (*m_shuffled_indices)[i];
     if ((i % m_owner_map_mb_size) % m_np_in_trainer == m_rank_in_trainer) {
-      int owner = m_owner[index];
+      int owner = get_index_owner(index);
+      if (m_node_seg != nullptr && m_is_node_local[owner]) {
+        m_node_local_indices_to_recv.push_back(index);
+        continue;
+      }
       m_indices_to_recv[owner].insert(index);
       k++;
     }
@@ -631,13 +1273,20 @@ int data_store_conduit::build_indices_i_will_send(int current_pos, int mb_size)
       is_mine = true;
     } else if (m_spilled_nodes.find(index) != m_spilled_nodes.end()) {
       is_mine = true;
+    } else if (m_segment && m_segment->contains(index)) {
+      is_mine = true;
     }
     if (is_mine) {
-      m_indices_to_send[(i % m_owner_map_mb_size) % m_np_in_trainer].insert(index);
+      const int dest = (i % m_owner_map_mb_size) % m_np_in_trainer;
+      // node-local ranks read the sample from the node shared segment
+      if (m_node_seg != nullptr && m_is_node_local[dest]) {
+        continue;
+      }
+      m_indices_to_send[dest].insert(index);
 
       // Sanity check
-      if (m_owner[index] != m_rank_in_trainer) {
-        LBANN_ERROR( "error for i: ", i, " index: ", index, " m_owner: ", m_owner[index], " me: ", m_rank_in_trainer);
+      if (get_index_owner(index) != m_rank_in_trainer) {
+        LBANN_ERROR( "error for i: ", i, " index: ", index, " owner: ", get_index_owner(index), " me: ", m_rank_in_trainer);
       }
       k++;
     }
@@ -647,18 +1296,37 @@ int data_store_conduit::build_indices_i_will_send(int current_pos, int mb_size)
 
 void data_store_conduit::build_preloaded_owner_map(const std::vector<int>& per_rank_list_sizes) {
   PROFILE("starting data_store_conduit::build_preloaded_owner_map");
+  double tm1 = get_time();
   m_owner.clear();
-  int owning_rank = 0;
-  size_t per_rank_list_range_start = 0;
-  for (size_t i = 0; i < m_shuffled_indices->size(); i++) {
-    const auto per_rank_list_size = per_rank_list_sizes[owning_rank];
-    if(i == (per_rank_list_range_start + per_rank_list_size)) {
-      ++owning_rank;
-      per_rank_list_range_start += per_rank_list_size;
+  m_owner_ranges.clear();
+  if (m_shuffled_indices->empty()) {
+    m_owner_maps_were_exchanged = true;
+    return;
+  }
+
+  // mark the indices that are present; they may be a subset of
+  // [0, max_index], e.g, when a validation set has been carved out
+  const int max_index = *std::max_element(m_shuffled_indices->begin(), m_shuffled_indices->end());
+  std::vector<bool> present(max_index+1, false);
+  for (auto index : *m_shuffled_indices) {
+    present[index] = true;
+  }
+
+  m_owner_ranges.resize(m_np_in_trainer+1);
+  int index = 0;
+  for (int r=0; r<m_np_in_trainer; r++) {
+    m_owner_ranges[r] = index;
+    int n = 0;
+    while (n < per_rank_list_sizes[r] && index <= max_index) {
+      if (present[index]) {
+        ++n;
+      }
+      ++index;
     }
-    m_owner[(*m_shuffled_indices)[i]] = owning_rank;
   }
-PROFILE("build_preloaded_owner_map; m_owner_maps_were_exchanged = true");
+  m_owner_ranges[m_np_in_trainer] = max_index+1;
+
+PROFILE("build_preloaded_owner_map; m_owner_maps_were_exchanged = true; time: ", get_time() - tm1);
   m_owner_maps_were_exchanged = true;
 }
 
@@ -690,6 +1358,7 @@ conduit::Node & data_store_conduit::get_empty_node(int data_id) {
 }
 
 void data_store_conduit::compact_nodes() {
+  wait_for_checkpoint();
   for(auto&& j : *m_shuffled_indices) {
     if(m_data.find(j) != m_data.end()){
       if(! (m_data[j].is_contiguous() && m_data[j].is_compact()) ) {
@@ -702,15 +1371,30 @@ void data_store_conduit::compact_nodes() {
   }
 }
 
-int data_store_conduit::get_index_owner(int idx) {
-  if (m_owner.find(idx) == m_owner.end()) {
-    LBANN_ERROR(" idx: ", idx, " was not found in the m_owner map; map size: ", m_owner.size());
+int data_store_conduit::get_index_owner(int idx) const {
+  const int owner = find_index_owner(idx);
+  if (owner < 0) {
+    LBANN_ERROR(" idx: ", idx, " was not found in the m_owner map; map size: ", m_owner.size(), "; num owner ranges: ", m_owner_ranges.size());
   }
-  return m_owner[idx];
+  return owner;
+}
+
+int data_store_conduit::find_index_owner(int idx) const {
+  map_ii_t::const_iterator t = m_owner.find(idx);
+  if (t != m_owner.end()) {
+    return t->second;
+  }
+  if (!m_owner_ranges.empty() && idx >= m_owner_ranges.front() && idx < m_owner_ranges.back()) {
+    // ranges of ranks that own nothing are empty, so this finds the last
+    // rank whose range starts at or below idx
+    return std::upper_bound(m_owner_ranges.begin(), m_owner_ranges.end(), idx) - m_owner_ranges.begin() - 1;
+  }
+  return -1;
 }
 
 void data_store_conduit::check_mem_capacity(lbann_comm *comm, const std::string sample_list_file, size_t stride, size_t offset) {
 //TODO: this is junky, and isn't called anywhere; rethink!
+  int insufficient = 0;
   if (comm->am_world_master()) {
     // note: we only estimate memory required by the data reader/store
 
@@ -846,7 +1530,7 @@ void data_store_conduit::check_mem_capacity(lbann_comm *comm, const std::string
     if (mem_this_node > static_cast<double>(a_mem)) {
       std::cerr << "\nYOU DO NOT HAVE ENOUGH MEMORY\n"
         << "==============================================================\n\n";
-      LBANN_ERROR("insufficient memory to load data\n");
+      insufficient = 1;
     } else {
       double m = 100 * mem_this_node / a_mem;
       std::cerr << "Estimate that data will consume at least " << m << " % of memory\n"
@@ -854,12 +1538,28 @@ void data_store_conduit::check_mem_capacity(lbann_comm *comm, const std::string
     }
   }
 
+  comm->world_broadcast(0, insufficient);
+  if (insufficient) {
+    options *opts = options::get();
+    if (opts->has_string("data_store_tiered") && opts->get_bool("data_store_tiered_auto")) {
+      if (comm->am_world_master()) {
+        std::cerr << "Using the file-backed data store tier in: " << opts->get_string("data_store_tiered") << "\n\n";
+      }
+      setup_tier(opts->get_string("data_store_tiered"));
+    } else {
+      LBANN_ERROR("insufficient memory to load data; consider running with --data_store_tiered=<dir> --data_store_tiered_auto\n");
+    }
+  }
+
   comm->trainer_barrier();
 }
 
 bool data_store_conduit::has_conduit_node(int data_id) const {
   std::unordered_map<int, conduit::Node>::const_iterator t = m_data.find(data_id);
-  return t != m_data.end();
+  if (t != m_data.end()) {
+    return true;
+  }
+  return m_segment && m_segment->contains(data_id);
 }
 
 void data_store_conduit::set_shuffled_indices(const std::vector<int> *indices) {
@@ -930,6 +1630,10 @@ void data_store_conduit::set_loading_is_complete() {
   set_is_explicitly_loading(false);
   check_query_flags();
 
+  if (m_node_shared) {
+    share_node_local_samples();
+  }
+
   if (m_run_checkpoint_test) {
     test_checkpoint(m_spill_dir_base);
   }
@@ -1082,6 +1786,11 @@ void data_store_conduit::allocate_shared_segment(map_is_t &sizes, std::vector<st
       LBANN_ERROR("mmap failed");
     }
     m_mem_seg = reinterpret_cast<char*>(m);
+    // The segment is read by every rank on the node, so it should not
+    // all land on this rank's NUMA domain
+    if (numa::get_placement() == numa::placement::interleave) {
+      numa::place_pages(m_mem_seg, m_mem_seg_length, numa::placement::interleave);
+    }
     std::fill_n(m_mem_seg, m_mem_seg_length, 1);
     int sanity = msync(static_cast<void*>(m_mem_seg), m_mem_seg_length, MS_SYNC);
     if (sanity != 0) {
@@ -1114,6 +1823,154 @@ void data_store_conduit::allocate_shared_segment(map_is_t &sizes, std::vector<st
   close(shm_fd);
 }
 
+void data_store_conduit::share_node_local_samples() {
+  double tm1 = get_time();
+  if (m_node_seg != nullptr) {
+    return;
+  }
+  // the samples are about to be moved
+  wait_for_checkpoint();
+
+  // Only ranks in this trainer share a segment
+  if (!m_have_trainer_node_comm) {
+    El::mpi::Split(m_comm->get_node_comm(), m_comm->get_trainer_rank(),
+                   m_comm->get_rank_in_node(), m_trainer_node_comm);
+    m_have_trainer_node_comm = true;
+  }
+  m_is_node_local.resize(m_np_in_trainer);
+  for (int p=0; p<m_np_in_trainer; p++) {
+    m_is_node_local[p] = m_comm->is_rank_node_local(p, m_comm->get_trainer_comm());
+  }
+  const int node_rank = El::mpi::Rank(m_trainer_node_comm);
+  const int node_np = El::mpi::Size(m_trainer_node_comm);
+
+  // Compute the offset of my samples in the segment
+  size_t my_bytes = 0;
+  for (const auto &t : m_data) {
+    my_bytes += t.second.total_bytes_compact();
+  }
+  std::vector<size_t> all_bytes(node_np);
+  m_comm->all_gather<size_t>(&my_bytes, 1, all_bytes.data(), 1, m_trainer_node_comm);
+  size_t offset = 0;
+  m_node_seg_length = 0;
+  for (int j=0; j<node_np; j++) {
+    if (j < node_rank) {
+      offset += all_bytes[j];
+    }
+    m_node_seg_length += all_bytes[j];
+  }
+  if (m_node_seg_length == 0) {
+    return;
+  }
+
+  // Create the segment; the name must be unique across data readers,
+  // trainers, and nodes
+  const int leader = El::mpi::Translate(m_trainer_node_comm, 0, m_comm->get_world_comm());
+  m_node_seg_name = "/lbann_node_shared_" + m_reader->get_role() + "_"
+                    + std::to_string(m_comm->get_trainer_rank()) + "_"
+                    + std::to_string(leader);
+  int shm_fd = -1;
+  if (node_rank == 0) {
+    //in case a previous run was aborted
+    shm_unlink(m_node_seg_name.c_str());
+    shm_fd = shm_open(m_node_seg_name.c_str(), O_CREAT | O_RDWR | O_EXCL, 0666);
+    if (shm_fd == -1) {
+      LBANN_ERROR("shm_open failed for ", m_node_seg_name);
+    }
+    if (ftruncate(shm_fd, m_node_seg_length) != 0) {
+      LBANN_ERROR("ftruncate failed for size: ", m_node_seg_length);
+    }
+  }
+  m_comm->barrier(m_trainer_node_comm);
+  if (node_rank != 0) {
+    shm_fd = shm_open(m_node_seg_name.c_str(), O_RDWR, 0666);
+    if (shm_fd == -1) {
+      LBANN_ERROR("shm_open failed for ", m_node_seg_name);
+    }
+  }
+  void *m = mmap(0, m_node_seg_length, PROT_WRITE | PROT_READ, MAP_SHARED, shm_fd, 0);
+  if (m == MAP_FAILED) {
+    LBANN_ERROR("mmap failed for ", m_node_seg_name);
+  }
+  close(shm_fd);
+  m_node_seg = reinterpret_cast<char*>(m);
+
+  // Each rank writes its own samples, so by default its pages land on
+  // its NUMA domain; interleaving spreads them for the other readers
+  if (numa::get_placement() == numa::placement::interleave) {
+    if (node_rank == 0) {
+      numa::place_pages(m_node_seg, m_node_seg_length, numa::placement::interleave);
+    }
+    m_comm->barrier(m_trainer_node_comm);
+  }
+
+  // Move my samples into the segment, replacing each with a view;
+  // my_index holds <data_id, offset> pairs
+  std::vector<size_t> my_index;
+  my_index.reserve(m_data.size()*2);
+  for (auto &t : m_data) {
+    conduit::Node &nd = t.second;
+    const size_t sz = nd.total_bytes_compact();
+    if (!nd.is_contiguous()) {
+      LBANN_ERROR("data_id: ", t.first, " does not have a contiguous layout");
+    }
+    memcpy(m_node_seg + offset, nd.contiguous_data_ptr(), sz);
+    conduit::Schema s = nd.schema();
+    nd.reset();
+    nd.set_external(s, m_node_seg + offset);
+    my_index.push_back(t.first);
+    my_index.push_back(offset);
+    offset += sz;
+  }
+
+  // Exchange the indices; note that all_gather can't handle empty
+  // vectors, so a rank that owns no samples contributes a dummy entry
+  const size_t dummy = std::numeric_limits<size_t>::max();
+  if (my_index.empty()) {
+    my_index.push_back(dummy);
+    my_index.push_back(dummy);
+  }
+  int my_count = my_index.size();
+  std::vector<int> counts(node_np);
+  m_comm->all_gather<int>(&my_count, 1, counts.data(), 1, m_trainer_node_comm);
+  std::vector<int> disp(node_np + 1, 0);
+  for (int j=0; j<node_np; j++) {
+    disp[j+1] = disp[j] + counts[j];
+  }
+  std::vector<size_t> all_index(disp[node_np]);
+  m_comm->all_gather<size_t>(my_index, all_index, counts, disp, m_trainer_node_comm);
+  for (size_t j=0; j<all_index.size(); j += 2) {
+    if (all_index[j] != dummy) {
+      m_node_seg_offsets[all_index[j]] = all_index[j+1];
+    }
+  }
+
+  // ensure all ranks have written their samples before any are read
+  m_comm->barrier(m_trainer_node_comm);
+  PROFILE("share_node_local_samples; segment size: ", utils::commify(m_node_seg_length),
+          " num samples on node: ", m_node_seg_offsets.size(),
+          " time: ", (get_time() - tm1));
+}
+
+void data_store_conduit::free_node_shared_segment() {
+  if (m_node_seg != nullptr) {
+    if (munmap(reinterpret_cast<void*>(m_node_seg), m_node_seg_length) != 0) {
+      std::cerr << "\nWARNING: munmap failed for the node shared segment in data_store_conduit\n";
+    }
+    // other ranks have already mapped the segment, so it's safe to
+    // unlink even if they still hold it
+    if (m_have_trainer_node_comm && El::mpi::Rank(m_trainer_node_comm) == 0) {
+      shm_unlink(m_node_seg_name.c_str());
+    }
+    m_node_seg = nullptr;
+    m_node_seg_length = 0;
+  }
+  if (m_have_trainer_node_comm) {
+    El::mpi::Free(m_trainer_node_comm);
+    m_have_trainer_node_comm = false;
+  }
+}
+
 void data_store_conduit::preload_local_cache() {
   exchange_local_caches();
 }
@@ -1356,6 +2213,144 @@ PROFILE("exchange_owner_maps; m_owner_maps_were_exchanged = true");
           "my owner map size: ", m_owner.size());
 }
 
+void data_store_conduit::rebalance_after_trainer_resize() {
+  PROFILE("starting rebalance_after_trainer_resize");
+  double tm1 = get_time();
+  if (m_spill || m_tiered || m_node_shared) {
+    LBANN_ERROR("the data store can not be rebalanced with --data_store_spill, --data_store_tiered, or --data_store_node_shared");
+  }
+  drain_pipelined_exchanges();
+  wait_for_checkpoint();
+  m_minibatch_data.clear();
+
+  m_world_master = m_comm->am_world_master();
+  m_trainer_master = m_comm->am_trainer_master();
+  m_rank_in_trainer = m_comm->get_rank_in_trainer();
+  m_np_in_trainer = m_comm->get_procs_per_trainer();
+
+  // in local cache mode every node holds the complete data set
+  if (is_local_cache()) {
+    return;
+  }
+  if (!is_fully_loaded()) {
+    LBANN_ERROR("the data store can only be rebalanced after loading is complete; role: ", m_reader->get_role());
+  }
+
+  // every rank lists the samples it holds; the list starts with its
+  // length, so that no list is empty
+  const El::mpi::Comm& world = m_comm->get_world_comm();
+  const int np_world = m_comm->get_procs_in_world();
+  std::vector<int> mine;
+  mine.reserve(m_data.size()+1);
+  mine.push_back(m_data.size());
+  for (const auto& t : m_data) {
+    mine.push_back(t.first);
+  }
+  int my_count = mine.size();
+  std::vector<int> counts(np_world);
+  m_comm->all_gather(&my_count, 1, counts.data(), 1, world);
+  std::vector<int> displs(np_world, 0);
+  for (int r=1; r<np_world; r++) {
+    displs[r] = displs[r-1] + counts[r-1];
+  }
+  std::vector<int> held(displs.back() + counts.back());
+  m_comm->all_gather(mine, held, counts, displs, world);
+
+  // world ranks that hold each sample, in increasing order
+  std::map<int, std::vector<int>> holders;
+  for (int r=0; r<np_world; r++) {
+    for (int j=1; j<counts[r]; j++) {
+      holders[held[displs[r]+j]].push_back(r);
+    }
+  }
+
+  // placement of each world rank in the new trainers
+  const int num_trainers = m_comm->get_num_trainers();
+  const int my_trainer = m_comm->get_trainer_rank();
+  const int me = m_comm->get_rank_in_world();
+  std::vector<int> trainer_of(np_world), rank_of(np_world);
+  for (int t=0; t<num_trainers; t++) {
+    for (int r=0; r<m_np_in_trainer; r++) {
+      trainer_of[m_comm->get_world_rank(t, r)] = t;
+      rank_of[m_comm->get_world_rank(t, r)] = r;
+    }
+  }
+
+  // Each trainer keeps one copy of every sample: the one held by its
+  // lowest rank. Samples that no rank of a trainer holds are sent to
+  // it by a rank of another trainer; the senders are spread over the
+  // trainers that hold a copy.
+  m_owner.clear();
+  m_owner_ranges.clear();
+  std::vector<int> drop;
+  std::vector<std::pair<int,int>> sends; // (world rank, data_id)
+  std::vector<std::pair<int,int>> recvs;
+  for (const auto& t : holders) {
+    const int data_id = t.first;
+    const std::vector<int> &h = t.second;
+    for (int k=0; k<num_trainers; k++) {
+      int owner = -1;
+      for (auto r : h) {
+        if (trainer_of[r] == k && (owner < 0 || rank_of[r] < owner)) {
+          owner = rank_of[r];
+        }
+      }
+      int source = -1;
+      if (owner < 0) {
+        owner = data_id % m_np_in_trainer;
+        source = h[k % h.size()];
+      }
+      if (k == my_trainer) {
+        m_owner[data_id] = owner;
+        const bool have = (m_data.find(data_id) != m_data.end());
+        if (have && owner != m_rank_in_trainer) {
+          drop.push_back(data_id);
+        } else if (source >= 0 && owner == m_rank_in_trainer) {
+          recvs.emplace_back(source, data_id);
+        }
+      } else if (source == me) {
+        sends.emplace_back(m_comm->get_world_rank(k, owner), data_id);
+      }
+    }
+  }
+
+  // move the missing samples
+  std::vector<El::mpi::Request<El::byte>> send_requests(sends.size());
+  for (size_t j=0; j<sends.size(); j++) {
+    const conduit::Node &n = m_data[sends[j].second];
+    m_comm->nb_tagged_send<El::byte>(reinterpret_cast<const El::byte*>(n.data_ptr()),
+                                     n.total_bytes_compact(), sends[j].first,
+                                     sends[j].second, send_requests[j], world);
+  }
+  std::vector<conduit::Node> recv_buffers(recvs.size());
+  std::vector<El::mpi::Request<El::byte>> recv_requests(recvs.size());
+  for (size_t j=0; j<recvs.size(); j++) {
+    const size_t sz = get_exchange_sample_size(recvs[j].second);
+    recv_buffers[j].set(conduit::DataType::uint8(sz));
+    m_comm->nb_tagged_recv<El::byte>(reinterpret_cast<El::byte*>(recv_buffers[j].data_ptr()),
+                                     sz, recvs[j].first, recvs[j].second,
+                                     recv_requests[j], world);
+  }
+  m_comm->wait_all(send_requests);
+  m_comm->wait_all(recv_requests);
+  for (size_t j=0; j<recvs.size(); j++) {
+    conduit::Node n_msg;
+    view_packed_node_for_sending(reinterpret_cast<const conduit::uint8*>(recv_buffers[j].data_ptr()), n_msg);
+    build_node_for_sending(n_msg["data"], m_data[recvs[j].second]);
+  }
+
+  // drop the duplicate copies only after the sends have completed
+  for (auto data_id : drop) {
+    m_data.erase(data_id);
+  }
+  m_my_num_indices = m_data.size();
+  m_owner_maps_were_exchanged = true;
+
+  PROFILE("rebalance_after_trainer_resize; sent: ", sends.size(),
+          " received: ", recvs.size(), " dropped: ", drop.size(),
+          " time: ", get_time() - tm1);
+}
+
 void data_store_conduit::profile_timing() {
   if (m_exchange_time == 0) {
     return;
@@ -1368,7 +2363,34 @@ void data_store_conduit::profile_timing() {
         "  exchange sample sizes:    ", m_exchange_sample_sizes_time, "\n",
         "  start sends and rcvs:     ", m_start_snd_rcv_time, "\n",
         "  wait alls:                ", m_wait_all_time, "\n",
-        "  unpacking rcvd nodes:     ", m_rebuild_time, "\n\n");
+        "  unpacking rcvd nodes:     ", m_rebuild_time, "\n");
+    PROFILE("  messages sent:            ", m_num_exchange_msgs, "\n");
+    if (m_pipeline_exchange) {
+      PROFILE("  pipelined mini-batches:   ", m_num_pipelined_exchanges, "\n");
+    }
+    PROFILE("  samples rcvd locally:     ", m_num_local_samples, " (", utils::commify(m_num_local_bytes), " bytes)\n");
+    PROFILE("  samples rcvd remotely:    ", m_num_remote_samples, " (", utils::commify(m_num_remote_bytes), " bytes)\n");
+    if (m_locality_shuffle) {
+      // with a uniformly random shuffle, each sample is local with
+      // probability (num local owners)/(num ranks)
+      size_t num_local_owners = 1;
+      if (m_node_seg != nullptr) {
+        num_local_owners = std::count(m_is_node_local.begin(), m_is_node_local.end(), true);
+      }
+      const double expected = static_cast<double>(m_num_local_bytes + m_num_remote_bytes) * num_local_owners / m_np_in_trainer;
+      const double saved = static_cast<double>(m_num_local_bytes) - expected;
+      PROFILE("  bytes saved by locality shuffle: ", utils::commify(saved > 0 ? static_cast<size_t>(saved) : 0), "\n");
+    }
+    if (m_exchange_profiler) {
+      for (int j=0; j<exchange_profiler::NUM_PHASES; j++) {
+        const exchange_profiler::phase p = static_cast<exchange_profiler::phase>(j);
+        PROFILE("  ", exchange_profiler::get_phase_name(p), " p50/p99:  ",
+                m_exchange_profiler->get_quantile(p, 0.5), " / ",
+                m_exchange_profiler->get_quantile(p, 0.99), "\n");
+      }
+      m_exchange_profiler->write_json(*m_exchange_profile_file, m_reader->get_role(), m_rank_in_world, m_exchange_profile_epoch++);
+    }
+    PROFILE();
 
     if (options::get()->get_bool("data_store_min_max_timing")) {
       std::vector<double> send;
@@ -1409,6 +2431,12 @@ void data_store_conduit::profile_timing() {
     m_wait_all_time = 0.;
     m_rebuild_time = 0.;
     m_exchange_time = 0.;
+    m_num_pipelined_exchanges = 0;
+    m_num_exchange_msgs = 0;
+    m_num_local_samples = 0;
+    m_num_local_bytes = 0;
+    m_num_remote_samples = 0;
+    m_num_remote_bytes = 0;
   }
 }
 
@@ -1456,7 +2484,35 @@ PROFILE("exchange_mini_batch_data; m_owner_maps_were_exchanged = true");
     */
   }
 
-  exchange_data_by_sample(current_pos, mb_size);
+  if (! can_pipeline_exchange()) {
+    exchange_data_by_sample(current_pos, mb_size);
+    m_exchange_time += (get_time() - tm1);
+    return;
+  }
+
+  // Complete the exchange that was posted during the previous call,
+  // if it's for this mini-batch; otherwise (first mini-batch of an
+  // epoch, change in mini-batch size, etc.) fall back to a synchronous
+  // exchange. Note that ranks in a trainer always agree on whether
+  // the posted exchange is a match, since they all see the same positions.
+  exchange_workspace &ws = m_exchange_ws[m_cur_exchange_ws];
+  if (ws.in_flight && ws.current_pos == current_pos && ws.mb_size == mb_size) {
+    finish_exchange_data_by_sample(ws);
+    ++m_num_pipelined_exchanges;
+  } else {
+    drain_pipelined_exchanges();
+    exchange_data_by_sample(current_pos, mb_size);
+  }
+
+  // Post the exchange for the next mini-batch into the other work space;
+  // the current work space backs m_minibatch_data, so must not be touched
+  // until the following call
+  size_t next_pos = 0;
+  size_t next_mb_size = 0;
+  if (get_next_mini_batch_extent(current_pos, next_pos, next_mb_size)) {
+    m_cur_exchange_ws = 1 - m_cur_exchange_ws;
+    start_exchange_data_by_sample(next_pos, next_mb_size, m_exchange_ws[m_cur_exchange_ws]);
+  }
   m_exchange_time += (get_time() - tm1);
 }
 
@@ -1477,7 +2533,10 @@ void data_store_conduit::flush_profile_file() const {
 }
 
 size_t data_store_conduit::get_num_global_indices() const {
-  size_t n = m_comm->trainer_allreduce<size_t>(m_data.size());
+  // all preloaded samples are in the file-backed tier, whether or not
+  // they are also resident in m_data
+  size_t my_count = m_segment ? m_segment->get_num_samples() : m_data.size();
+  size_t n = m_comm->trainer_allreduce<size_t>(my_count);
   //size_t n = m_comm->trainer_allreduce<size_t>(m_my_num_indices);
   return n;
 }
@@ -1492,10 +2551,13 @@ void data_store_conduit::test_checkpoint(const std::string &checkpoint_dir) {
     std::cerr << "\nCalling write_checkpoint()" << std::endl;
   }
   write_checkpoint(checkpoint_dir);
+  wait_for_checkpoint();
 
   // clear or reset private variables
   auto sanity = m_owner;
+  auto sanity_ranges = m_owner_ranges;
   m_owner.clear();
+  m_owner_ranges.clear();
   m_sample_sizes.clear();
   m_data.clear();
 
@@ -1532,6 +2594,9 @@ void data_store_conduit::test_checkpoint(const std::string &checkpoint_dir) {
       LBANN_ERROR("sanity[t.first] != m_owner[t.first] for t.first= ", t.first, " and m_owner[t.first]= ", m_owner[t.first]);
     }
   }
+  if (sanity_ranges != m_owner_ranges) {
+    LBANN_ERROR("the owner ranges were not correctly reloaded");
+  }
 
   m_comm->global_barrier();
 }
@@ -1582,6 +2647,11 @@ void data_store_conduit::write_checkpoint(std::string dir_name) {
   if (m_is_spilled) {
     return;
   }
+  wait_for_checkpoint();
+  if (m_async_checkpoint) {
+    write_checkpoint_async(dir_name);
+    return;
+  }
   double tm1 = get_time();
   setup_spill(dir_name);
 
@@ -1594,10 +2664,97 @@ void data_store_conduit::write_checkpoint(std::string dir_name) {
   for (auto t : m_data) {
     spill_conduit_node(t.second["data"], t.first);
   }
+  if (m_segment) {
+    for (auto t : m_sample_sizes) {
+      if (m_data.find(t.first) != m_data.end() || !m_segment->contains(t.first)) {
+        continue;
+      }
+      size_t sz;
+      const char *buf = m_segment->get(t.first, sz);
+      conduit::Node n_msg;
+      view_packed_node(reinterpret_cast<const conduit::uint8*>(buf), n_msg);
+      spill_conduit_node(n_msg["data"], t.first);
+    }
+  }
   m_metadata.close();
   PROFILE("time to write checkpoint: ", (get_time() - tm1));
 }
 
+void data_store_conduit::write_checkpoint_async(const std::string &dir_name) {
+  double tm1 = get_time();
+  m_spill_dir_base = dir_name;
+  make_dir_if_it_doesnt_exist(m_spill_dir_base);
+  m_comm->trainer_barrier();
+
+  // cerealize all non-conduit::Node variables
+  save_state();
+
+  // if we were loaded from this very checkpoint, m_data views the file
+  // we'd overwrite; the samples in it are already current
+  const std::string fn = get_checkpoint_segment_fn();
+  if (m_checkpoint_segment && m_checkpoint_segment->get_filename() == fn) {
+    PROFILE("samples are unchanged since loading ", fn, "; only the state was written");
+    return;
+  }
+
+  // Snapshot the packed samples. These are not modified once loading
+  // is complete, and anything that frees them first calls
+  // wait_for_checkpoint(), so the writer may use them in place
+  std::vector<checkpoint_extent> snapshot;
+  if (m_segment) {
+    // every tiered sample is in the segment, resident or not
+    for (auto id : m_segment->get_data_ids()) {
+      size_t sz;
+      const char *buf = m_segment->get(id, sz);
+      snapshot.push_back({id, buf, sz});
+    }
+  } else {
+    snapshot.reserve(m_data.size());
+    for (const auto &t : m_data) {
+      const conduit::Node &nd = t.second;
+      if (!nd.is_contiguous()) {
+        LBANN_ERROR("data_id: ", t.first, " does not have a contiguous layout");
+      }
+      snapshot.push_back({t.first, reinterpret_cast<const char*>(nd.contiguous_data_ptr()), static_cast<size_t>(nd.total_bytes_compact())});
+    }
+  }
+
+  // remove a stale index, so that a partially written checkpoint is never loaded
+  std::remove(sample_segment::get_index_fn(fn).c_str());
+  m_checkpoint_writer = std::async(std::launch::async, write_checkpoint_snapshot, std::move(snapshot), fn);
+  PROFILE("time to snapshot checkpoint: ", (get_time() - tm1), "; samples are being written in the background");
+}
+
+void data_store_conduit::wait_for_checkpoint() {
+  if (m_checkpoint_writer.valid()) {
+    double tm1 = get_time();
+    // rethrows, if the writer failed
+    m_checkpoint_writer.get();
+    PROFILE("time waiting for the background checkpoint writer: ", (get_time() - tm1));
+  }
+}
+
+std::string data_store_conduit::get_checkpoint_segment_fn() const {
+  return m_spill_dir_base + "/samples_" + m_reader->get_role() + "_" + std::to_string(m_rank_in_world);
+}
+
+void data_store_conduit::view_packed_node_for_sending(const conduit::uint8 *buf, conduit::Node &node) const {
+  // this mirrors the layout built by build_node_for_sending()
+  const char *schema_json = reinterpret_cast<const char*>(buf + sizeof(conduit::int64));
+  conduit::Schema s_data;
+  conduit::Generator gen(schema_json);
+  gen.walk(s_data);
+
+  conduit::Schema s_msg;
+  s_msg["schema_len"].set(conduit::DataType::int64());
+  s_msg["schema"].set(conduit::DataType::char8_str(strlen(schema_json)+1));
+  s_msg["data"].set(s_data);
+  conduit::Schema s_msg_compact;
+  s_msg.compact_to(s_msg_compact);
+  node.reset();
+  node.set_external(s_msg_compact, const_cast<conduit::uint8*>(buf));
+}
+
 void data_store_conduit::save_state() {
   // checkpoint remaining state using cereal
   const std::string fn = get_cereal_fn();
@@ -1620,6 +2777,7 @@ void data_store_conduit::save_state() {
             CEREAL_NVP(m_node_sizes_vary), 
             CEREAL_NVP(m_have_sample_sizes),
             CEREAL_NVP(m_owner),
+            CEREAL_NVP(m_owner_ranges),
             CEREAL_NVP(m_sample_sizes));
   }
   os.close();
@@ -1629,15 +2787,21 @@ void data_store_conduit::load_checkpoint(std::string dir_name, generic_data_read
   double tm1 = get_time();
   PROFILE("starting data_store_conduit::load_checkpoint");
 
+  wait_for_checkpoint();
+
   // Sanity check that checkpoint directories exist
   m_spill_dir_base = dir_name;
   bool exists = file::directory_exists(m_spill_dir_base);
   if (!exists) {
     LBANN_ERROR("cannot load data_store from file, since the specified directory ", dir_name, "doesn't exist");
   }
+  // asynchronous checkpoints are a single file of packed samples, plus its
+  // index, instead of a directory of conduit files
+  const std::string segment_fn = get_checkpoint_segment_fn();
+  const bool is_segment = file::file_exists(sample_segment::get_index_fn(segment_fn));
   const std::string conduit_dir = get_conduit_dir();
   exists = file::directory_exists(conduit_dir);
-  if (!exists) {
+  if (!exists && !is_segment) {
     LBANN_ERROR("cannot load data_store from file, since the specified directory '", conduit_dir, "' doesn't exist");
   }
 
@@ -1654,7 +2818,7 @@ void data_store_conduit::load_checkpoint(std::string dir_name, generic_data_read
            m_explicitly_loading, m_owner_map_mb_size,
            m_compacted_sample_size, m_is_local_cache,
            m_node_sizes_vary, m_have_sample_sizes,
-           m_owner, m_sample_sizes);
+           m_owner, m_owner_ranges, m_sample_sizes);
 
   if (reader != nullptr) {
     m_reader = reader;
@@ -1667,6 +2831,19 @@ void data_store_conduit::load_checkpoint(std::string dir_name, generic_data_read
     m_np_in_trainer = m_comm->get_procs_per_trainer();
   }  
 
+  if (is_segment) {
+    m_checkpoint_segment.reset(new sample_segment);
+    m_checkpoint_segment->attach(segment_fn);
+    for (auto id : m_checkpoint_segment->get_data_ids()) {
+      size_t sz;
+      const char *buf = m_checkpoint_segment->get(id, sz);
+      view_packed_node_for_sending(reinterpret_cast<const conduit::uint8*>(buf), m_data[id]);
+    }
+    m_was_loaded_from_file = true;
+    PROFILE("time to load (mmap) checkpoint: ", (get_time() - tm1));
+    return;
+  }
+
   // Open metadata filename; this is in index re, checkpointed conduit filenames
   const std::string metadata_fn = get_metadata_fn();
   std::ifstream metadata(metadata_fn);
@@ -1772,6 +2949,95 @@ void data_store_conduit::load_spilled_conduit_nodes() {
   }
 }
 
+void data_store_conduit::setup_tier(const std::string &dir) {
+  std::string base_dir = dir;
+  if (base_dir == "lassen") {
+     base_dir = get_lassen_spill_dir();
+  }
+  m_tier_dir = base_dir;
+  m_tiered = true;
+  make_dir_if_it_doesnt_exist(m_tier_dir);
+  m_comm->trainer_barrier();
+  PROFILE("data_store_conduit is using a file-backed tier in: ", m_tier_dir,
+          "; max resident samples: ", m_max_resident);
+}
+
+std::string data_store_conduit::get_segment_fn() const {
+  return m_tier_dir + "/segment_" + m_reader->get_role() + "_" + std::to_string(m_rank_in_world);
+}
+
+void data_store_conduit::set_preloaded_tiered_conduit_node(int data_id, const conduit::Node &node) {
+  // note: at this point m_data[data_id] may be node
+  conduit::Node n2 = node;
+  bool resident;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    resident = m_lru.size() < m_max_resident;
+  }
+
+  // The first m_max_resident samples remain in memory; all samples
+  // are written to the tier
+  conduit::Node n3;
+  conduit::Node *p = &n3;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (resident) {
+      p = &m_data[data_id];
+    }
+    build_node_for_sending(n2, *p);
+  }
+  const conduit::Node &packed = *p;
+  if (!m_node_sizes_vary) {
+    error_check_compacted_node(packed, data_id);
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_node_sizes_vary) {
+    m_sample_sizes[data_id] = packed.total_bytes_compact();
+  }
+  if (!m_segment) {
+    m_segment.reset(new sample_segment);
+    m_segment->open(get_segment_fn());
+  }
+  m_segment->append(data_id, packed.data_ptr(), packed.total_bytes_compact());
+  if (resident) {
+    m_lru.push_front(data_id);
+    m_lru_pos[data_id] = m_lru.begin();
+  } else {
+    m_data.erase(data_id);
+  }
+}
+
+void data_store_conduit::load_tiered_conduit_nodes() {
+  size_t num_to_send = 0;
+  for (const auto &v : m_indices_to_send) {
+    for (const auto &id : v) {
+      ++num_to_send;
+      auto it = m_lru_pos.find(id);
+      if (it != m_lru_pos.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        continue;
+      }
+      size_t sz;
+      const char *buf = m_segment->get(id, sz);
+      conduit::Node n_msg;
+      view_packed_node(reinterpret_cast<const conduit::uint8*>(buf), n_msg);
+      build_node_for_sending(n_msg["data"], m_data[id]);
+      m_lru.push_front(id);
+      m_lru_pos[id] = m_lru.begin();
+    }
+  }
+
+  // Samples to be sent are at the front of the list, so are never evicted
+  const size_t max_resident = std::max(m_max_resident, num_to_send);
+  while (m_lru.size() > max_resident) {
+    const int id = m_lru.back();
+    m_data.erase(id);
+    m_lru_pos.erase(id);
+    m_lru.pop_back();
+  }
+}
+
 void data_store_conduit::open_informational_files() {
   options *opts = options::get();
   if (m_comm == nullptr) {
@@ -1938,6 +3204,7 @@ void data_store_conduit::check_query_flags() const {
 void data_store_conduit::clear_owner_map() { 
     m_owner_maps_were_exchanged = false;
     m_owner.clear(); 
+    m_owner_ranges.clear();
 }
 
 void data_store_conduit::verify_sample_size() {
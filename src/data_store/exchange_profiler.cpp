@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/data_store/exchange_profiler.hpp"
+#include "lbann/utils/exception.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace lbann {
+
+exchange_profiler::exchange_profiler(int num_peers)
+  : m_peers(num_peers) {}
+
+const char* exchange_profiler::get_phase_name(phase p) {
+  switch (p) {
+  case PACK:   return "pack";
+  case POST:   return "post";
+  case WAIT:   return "wait";
+  case UNPACK: return "unpack";
+  default:     LBANN_ERROR("invalid exchange phase: ", static_cast<int>(p));
+  }
+  return "";
+}
+
+double exchange_profiler::get_quantile(phase p, double q) const {
+  const std::vector<double> &v = m_times[p];
+  if (v.empty()) {
+    return 0.;
+  }
+  std::vector<double> w = v;
+  const size_t k = std::min(w.size()-1, static_cast<size_t>(q*(w.size()-1) + 0.5));
+  std::nth_element(w.begin(), w.begin()+k, w.end());
+  return w[k];
+}
+
+void exchange_profiler::write_json(std::ostream &os, const std::string &role, int rank, int epoch) {
+  os << "{\"role\":\"" << role << "\",\"rank\":" << rank
+     << ",\"epoch\":" << epoch;
+  for (int j=0; j<NUM_PHASES; j++) {
+    const phase p = static_cast<phase>(j);
+    const std::vector<double> &v = m_times[p];
+    const double total = std::accumulate(v.begin(), v.end(), 0.);
+    const double max = v.empty() ? 0. : *std::max_element(v.begin(), v.end());
+    os << ",\"" << get_phase_name(p) << "\":{"
+       << "\"steps\":" << v.size()
+       << ",\"total\":" << total
+       << ",\"p50\":" << get_quantile(p, 0.5)
+       << ",\"p99\":" << get_quantile(p, 0.99)
+       << ",\"max\":" << max << "}";
+  }
+  os << ",\"peers\":[";
+  bool first = true;
+  for (size_t p=0; p<m_peers.size(); p++) {
+    const peer_traffic &t = m_peers[p];
+    if (t.msgs_sent == 0 && t.msgs_rcvd == 0) {
+      continue;
+    }
+    os << (first ? "" : ",")
+       << "{\"peer\":" << p
+       << ",\"bytes_sent\":" << t.bytes_sent
+       << ",\"msgs_sent\":" << t.msgs_sent
+       << ",\"bytes_rcvd\":" << t.bytes_rcvd
+       << ",\"msgs_rcvd\":" << t.msgs_rcvd << "}";
+    first = false;
+  }
+  os << "]}" << std::endl;
+
+  for (auto &v : m_times) {
+    v.clear();
+  }
+  std::fill(m_peers.begin(), m_peers.end(), peer_traffic());
+}
+
+} // namespace lbann
@@ -0,0 +1,194 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/data_store/sample_segment.hpp"
+#include "lbann/utils/exception.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+
+namespace lbann {
+
+sample_segment::~sample_segment() {
+  close();
+}
+
+void sample_segment::open(const std::string &filename) {
+  close();
+  m_filename = filename;
+  m_fd = ::open(m_filename.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+  if (m_fd == -1) {
+    LBANN_ERROR("failed to open ", m_filename, " for writing; errno: ", strerror(errno));
+  }
+  m_length = 0;
+  m_index.clear();
+}
+
+void sample_segment::attach(const std::string &filename) {
+  close();
+  m_filename = filename;
+  m_persistent = true;
+
+  const std::string index_fn = get_index_fn(m_filename);
+  std::ifstream in(index_fn.c_str(), std::ios::binary);
+  if (!in) {
+    LBANN_ERROR("failed to open ", index_fn, " for reading");
+  }
+  size_t n = 0;
+  in.read(reinterpret_cast<char*>(&n), sizeof(size_t));
+  m_index.reserve(n);
+  for (size_t j=0; j<n; j++) {
+    int data_id;
+    extent e;
+    in.read(reinterpret_cast<char*>(&data_id), sizeof(int));
+    in.read(reinterpret_cast<char*>(&e.offset), sizeof(size_t));
+    in.read(reinterpret_cast<char*>(&e.size), sizeof(size_t));
+    if (!in) {
+      LBANN_ERROR("failed to read entry ", j, " of ", n, " from ", index_fn);
+    }
+    m_index[data_id] = e;
+    m_length = std::max(m_length, e.offset + e.size);
+  }
+  in.close();
+
+  m_fd = ::open(m_filename.c_str(), O_RDONLY);
+  if (m_fd == -1) {
+    LBANN_ERROR("failed to open ", m_filename, " for reading; errno: ", strerror(errno));
+  }
+  struct stat st;
+  if (fstat(m_fd, &st) != 0 || static_cast<size_t>(st.st_size) < m_length) {
+    LBANN_ERROR(m_filename, " is shorter than its index claims; was the checkpoint completed?");
+  }
+}
+
+void sample_segment::persist() {
+  if (m_fd == -1) {
+    LBANN_ERROR("sample_segment::persist called before open()");
+  }
+  if (fsync(m_fd) != 0) {
+    LBANN_WARNING("fsync failed for ", m_filename, "; errno: ", strerror(errno));
+  }
+  const std::string index_fn = get_index_fn(m_filename);
+  std::ofstream out(index_fn.c_str(), std::ios::binary);
+  if (!out) {
+    LBANN_ERROR("failed to open ", index_fn, " for writing");
+  }
+  const size_t n = m_index.size();
+  out.write(reinterpret_cast<const char*>(&n), sizeof(size_t));
+  for (const auto &t : m_index) {
+    out.write(reinterpret_cast<const char*>(&t.first), sizeof(int));
+    out.write(reinterpret_cast<const char*>(&t.second.offset), sizeof(size_t));
+    out.write(reinterpret_cast<const char*>(&t.second.size), sizeof(size_t));
+  }
+  out.close();
+  if (!out) {
+    LBANN_ERROR("failed to write ", index_fn);
+  }
+  m_persistent = true;
+}
+
+std::vector<int> sample_segment::get_data_ids() const {
+  std::vector<int> ids;
+  ids.reserve(m_index.size());
+  for (const auto &t : m_index) {
+    ids.push_back(t.first);
+  }
+  return ids;
+}
+
+void sample_segment::close() {
+  unmap();
+  if (m_fd != -1) {
+    ::close(m_fd);
+    if (!m_persistent) {
+      std::remove(m_filename.c_str());
+    }
+    m_fd = -1;
+  }
+  m_length = 0;
+  m_index.clear();
+  m_persistent = false;
+}
+
+void sample_segment::unmap() {
+  if (m_map != nullptr) {
+    if (munmap(reinterpret_cast<void*>(m_map), m_map_length) != 0) {
+      LBANN_WARNING("munmap failed for ", m_filename);
+    }
+    m_map = nullptr;
+    m_map_length = 0;
+  }
+}
+
+void sample_segment::append(int data_id, const void *data, size_t size) {
+  if (m_fd == -1) {
+    LBANN_ERROR("sample_segment::append called before open()");
+  }
+  if (contains(data_id)) {
+    LBANN_ERROR("duplicate data_id: ", data_id, " in sample segment ", m_filename);
+  }
+  const char *c = reinterpret_cast<const char*>(data);
+  size_t written = 0;
+  while (written < size) {
+    ssize_t n = pwrite(m_fd, c + written, size - written, m_length + written);
+    if (n == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LBANN_ERROR("pwrite failed for ", m_filename, "; errno: ", strerror(errno));
+    }
+    written += n;
+  }
+  m_index[data_id] = {m_length, size};
+  m_length += size;
+}
+
+const char* sample_segment::get(int data_id, size_t &size) {
+  std::unordered_map<int, extent>::const_iterator t = m_index.find(data_id);
+  if (t == m_index.end()) {
+    LBANN_ERROR("failed to find data_id: ", data_id, " in sample segment ", m_filename);
+  }
+  if (m_map_length < m_length) {
+    unmap();
+    void *m = mmap(0, m_length, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (m == MAP_FAILED) {
+      LBANN_ERROR("mmap failed for ", m_filename, "; errno: ", strerror(errno));
+    }
+    m_map = reinterpret_cast<char*>(m);
+    m_map_length = m_length;
+  }
+  size = t->second.size;
+  return m_map + t->second.offset;
+}
+
+} // namespace lbann
@@ -29,12 +29,41 @@
 
 namespace lbann {
 
+#ifdef LBANN_HAS_GPU
+namespace {
+
+/** Setup a host input buffer in leased pinned memory.
+ *  @details Local data is stored contiguously.
+ */
+template <typename TensorDataType>
+void attach_to_lease(El::AbstractDistMatrix<TensorDataType>& mat,
+                     const pinned_memory_pool::lease& lease,
+                     El::Int height,
+                     El::Int width) {
+  auto& elemental_mat = dynamic_cast<El::ElementalMatrix<TensorDataType>&>(mat);
+  const auto col_shift = El::Shift(mat.ColRank(), mat.ColAlign(), mat.ColStride());
+  const auto local_height = El::Length(height, col_shift, mat.ColStride());
+  elemental_mat.Attach(height, width, mat.Grid(),
+                       mat.ColAlign(), mat.RowAlign(),
+                       lease.data<TensorDataType>(),
+                       std::max(local_height, El::Int(1)),
+                       mat.Root());
+}
+
+} // namespace
+#endif // LBANN_HAS_GPU
+
 template <typename TensorDataType>
 partitioned_io_buffer<TensorDataType>::partitioned_io_buffer(lbann_comm *comm, int num_parallel_readers, int num_child_layers)
   : generic_io_buffer<TensorDataType>(comm, num_parallel_readers) {
   m_data_buffers[execution_mode::training] = new data_buffer<IODataType>(comm, num_child_layers);
   m_data_buffers[execution_mode::validation] = new data_buffer<IODataType>(comm, num_child_layers);
   m_data_buffers[execution_mode::testing] = new data_buffer<IODataType>(comm, num_child_layers);
+#ifdef LBANN_HAS_GPU
+  m_device = El::GPUManager::Device();
+  CHECK_CUDA(cudaStreamCreateWithFlags(&m_copy_stream, cudaStreamNonBlocking));
+  m_stage_on_device = false;
+#endif // LBANN_HAS_GPU
 }
 
 template <typename TensorDataType>
@@ -42,14 +71,23 @@ partitioned_io_buffer<TensorDataType>::~partitioned_io_buffer() {
   for (auto& buf : m_data_buffers) {
     delete buf.second;
   }
+#ifdef LBANN_HAS_GPU
+  cudaStreamDestroy(m_copy_stream);
+#endif // LBANN_HAS_GPU
 }
 
 template <typename TensorDataType>
 partitioned_io_buffer<TensorDataType>::partitioned_io_buffer(const partitioned_io_buffer& other)
-  : generic_io_buffer<TensorDataType>(other) {
+  : generic_io_buffer<TensorDataType>(other),
+    m_max_mini_batch_size(other.m_max_mini_batch_size) {
   for (const auto& buf : other.m_data_buffers) {
     m_data_buffers[buf.first] = buf.second->copy();
   }
+#ifdef LBANN_HAS_GPU
+  m_device = other.m_device;
+  CHECK_CUDA(cudaStreamCreateWithFlags(&m_copy_stream, cudaStreamNonBlocking));
+  m_stage_on_device = false;
+#endif // LBANN_HAS_GPU
 }
 
 template <typename TensorDataType>
@@ -60,6 +98,7 @@ partitioned_io_buffer<TensorDataType>* partitioned_io_buffer<TensorDataType>::co
 template <typename TensorDataType>
 partitioned_io_buffer<TensorDataType>& partitioned_io_buffer<TensorDataType>::operator=(const partitioned_io_buffer& other) {
   generic_io_buffer<TensorDataType>::operator=(other);
+  m_max_mini_batch_size = other.m_max_mini_batch_size;
   for (auto& buf : m_data_buffers) {
     if (buf.second) delete buf.second;
     buf.second = buf.second->copy();
@@ -70,7 +109,16 @@ partitioned_io_buffer<TensorDataType>& partitioned_io_buffer<TensorDataType>::op
 template <typename TensorDataType>
 void partitioned_io_buffer<TensorDataType>::fp_setup_data(El::Int cur_mini_batch_size, int idx) {
   for (auto& buf : m_data_buffers) {
-    buf.second->m_input_buffers[idx]->Resize(buf.second->m_input_buffers[idx]->Height(), cur_mini_batch_size);
+    auto& mat = *buf.second->m_input_buffers[idx];
+#ifdef LBANN_HAS_GPU
+    const auto& leases = buf.second->m_input_leases;
+    if (static_cast<size_t>(idx) < leases.size()
+        && leases[idx].get() != nullptr) {
+      attach_to_lease(mat, leases[idx], mat.Height(), cur_mini_batch_size);
+      continue;
+    }
+#endif // LBANN_HAS_GPU
+    mat.Resize(mat.Height(), cur_mini_batch_size);
   }
 }
 
@@ -81,17 +129,35 @@ void partitioned_io_buffer<TensorDataType>::setup_data(El::Int num_neurons, El::
   if(partial_mini_batch_size > 0 && this->m_comm->get_rank_in_trainer() < partial_mini_batch_size) {
     local_mini_batch_size++;
   }
+  m_max_mini_batch_size = max_mini_batch_size;
   for (const auto& it : m_data_buffers) {
     data_buffer<IODataType> *data_buffer = it.second;
     int i = 0;
+#ifdef LBANN_HAS_GPU
+    // Host buffers are staged to the GPU, so they are pinned
+    data_buffer->m_input_leases.clear();
+#endif // LBANN_HAS_GPU
     for (const auto& buf : data_buffer->m_input_buffers) {
+      El::Int height = 0;
       if(i == 0) {
-        buf->Resize(num_neurons, max_mini_batch_size);
+        height = num_neurons;
       }else if(i == 1) {
-        buf->Resize(num_targets, max_mini_batch_size);
+        height = num_targets;
       }else {
         LBANN_ERROR("Unsupported number of input channels");
       }
+#ifdef LBANN_HAS_GPU
+      buf->Empty(false);
+      const auto local_width = El::Length(max_mini_batch_size,
+                                          buf->RowShift(), buf->RowStride());
+      data_buffer->m_input_leases.emplace_back(
+        pinned_memory_pool::instance().acquire(
+          std::max(height, El::Int(1)) * local_width * sizeof(IODataType)));
+      attach_to_lease(*buf, data_buffer->m_input_leases.back(),
+                      height, max_mini_batch_size);
+#else
+      buf->Resize(height, max_mini_batch_size);
+#endif // LBANN_HAS_GPU
       i++;
     }
     /// The amount of space needed will vary based on input layer type,
@@ -109,8 +175,33 @@ int partitioned_io_buffer<TensorDataType>::fetch_to_local_matrix(generic_data_re
   data_buffer<IODataType> *buf = get_data_buffer(mode);
   buf->m_num_samples_fetched = 0;
   if (this->m_comm->get_rank_in_trainer() < num_parallel_readers && (buf->m_input_buffers[0]->Height() != 0 && buf->m_input_buffers[0]->Width() != 0)) {
+#ifdef LBANN_HAS_GPU
+    // The last copy out of the pinned buffers must finish before
+    // they are overwritten
+    if (m_stage_on_device) {
+      buf->m_copy_done.synchronize();
+    }
+#endif // LBANN_HAS_GPU
     /// Each data reader needs to either have independent / split
     /// data, or take an offset / stride
+#ifdef LBANN_HAS_GPU
+    // Readers that decode on the GPU write samples straight into the
+    // device staging buffer; only the responses go through the host
+    if (m_stage_on_device && buf->m_input_buffers.size() == 2
+        && this->fetch_data_fn->supports_device_samples()
+        && data_reader->supports_device_fetch()) {
+      CHECK_CUDA(cudaSetDevice(m_device));
+      const auto& host = *buf->m_input_buffers[0];
+      auto& device = *buf->m_device_buffers[0];
+      device.Resize(host.Height(), host.Width());
+      auto& local_device = static_cast<El::Matrix<IODataType, El::Device::GPU>&>(device.Matrix());
+      buf->m_num_samples_fetched = (*this->fetch_data_fn)(local_device, buf->m_input_buffers[1]->Matrix(), buf->m_indices_fetched_per_mb, data_reader, m_copy_stream);
+      if (buf->m_num_samples_fetched > 0) {
+        copy_to_device(*buf, 1);
+      }
+      return buf->m_num_samples_fetched;
+    }
+#endif // LBANN_HAS_GPU
     if(buf->m_input_buffers.size() == 2) {
       buf->m_num_samples_fetched = (*this->fetch_data_fn)(buf->m_input_buffers[0]->Matrix(), buf->m_input_buffers[1]->Matrix(), buf->m_indices_fetched_per_mb, data_reader);
     }else {
@@ -119,6 +210,11 @@ int partitioned_io_buffer<TensorDataType>::fetch_to_local_matrix(generic_data_re
     bool data_valid = (buf->m_num_samples_fetched > 0);
     if(data_valid) {
       //      m_num_data_per_epoch+=num_samples_fetched; /// BVE FIXME need to change how this is shared
+#ifdef LBANN_HAS_GPU
+      if (m_stage_on_device) {
+        copy_to_device(*buf);
+      }
+#endif // LBANN_HAS_GPU
     }
   }
   return buf->m_num_samples_fetched;
@@ -127,6 +223,19 @@ int partitioned_io_buffer<TensorDataType>::fetch_to_local_matrix(generic_data_re
 template <typename TensorDataType>
 void partitioned_io_buffer<TensorDataType>::distribute_from_local_matrix(generic_data_reader *data_reader, execution_mode mode, AbsDistMatrixType& sample, AbsDistMatrixType& response) {
   data_buffer<IODataType> *buf = get_data_buffer(mode);
+#ifdef LBANN_HAS_GPU
+  if (sample.GetLocalDevice() == El::Device::GPU) {
+    if (buf->m_device_buffers_ready) {
+      CHECK_CUDA(cudaStreamWaitEvent(El::GPUManager::Stream(), buf->m_copy_done.get_event(), 0));
+      Copy(*buf->m_device_buffers[0], sample);
+      Copy(*buf->m_device_buffers[1], response);
+      buf->m_device_buffers_ready = false;
+      buf->m_num_samples_fetched = 0;
+      return;
+    }
+    enable_device_staging();
+  }
+#endif // LBANN_HAS_GPU
   Copy(*buf->m_input_buffers[0], sample);
   Copy(*buf->m_input_buffers[1], response);
   buf->m_num_samples_fetched = 0;
@@ -136,6 +245,18 @@ void partitioned_io_buffer<TensorDataType>::distribute_from_local_matrix(generic
 template <typename TensorDataType>
 void partitioned_io_buffer<TensorDataType>::distribute_from_local_matrix(generic_data_reader *data_reader, execution_mode mode, AbsDistMatrixType& sample) {
   data_buffer<IODataType> *buf = get_data_buffer(mode);
+#ifdef LBANN_HAS_GPU
+  if (sample.GetLocalDevice() == El::Device::GPU) {
+    if (buf->m_device_buffers_ready) {
+      CHECK_CUDA(cudaStreamWaitEvent(El::GPUManager::Stream(), buf->m_copy_done.get_event(), 0));
+      Copy(*buf->m_device_buffers[0], sample);
+      buf->m_device_buffers_ready = false;
+      buf->m_num_samples_fetched = 0;
+      return;
+    }
+    enable_device_staging();
+  }
+#endif // LBANN_HAS_GPU
   Copy(*buf->m_input_buffers[0], sample);
   buf->m_num_samples_fetched = 0;
   return;
@@ -194,6 +315,50 @@ std::future<void> partitioned_io_buffer<TensorDataType>::get_data_fetch_future(e
   return std::move(buf->m_data_fetch_future);
 }
 
+#ifdef LBANN_HAS_GPU
+template <typename TensorDataType>
+void partitioned_io_buffer<TensorDataType>::enable_device_staging() {
+  if (m_stage_on_device) {
+    return;
+  }
+  for (auto& it : m_data_buffers) {
+    data_buffer<IODataType> *buf = it.second;
+    buf->m_device_buffers.clear();
+    for (const auto& host : buf->m_input_buffers) {
+      buf->m_device_buffers.emplace_back(
+        new StarVCMatDT<IODataType, El::Device::GPU>(host->Grid()));
+      // Allocate for the largest mini-batch up front; the I/O threads
+      // only shrink the matrices, which does not reallocate
+      buf->m_device_buffers.back()->Resize(host->Height(), m_max_mini_batch_size);
+    }
+  }
+  // Set last, so that I/O threads only see allocated buffers
+  m_stage_on_device = true;
+}
+
+template <typename TensorDataType>
+void partitioned_io_buffer<TensorDataType>::copy_to_device(data_buffer<IODataType>& buf, size_t first) {
+  CHECK_CUDA(cudaSetDevice(m_device));
+  for (size_t i = first; i < buf.m_input_buffers.size(); ++i) {
+    const auto& host = *buf.m_input_buffers[i];
+    auto& device = *buf.m_device_buffers[i];
+    device.Resize(host.Height(), host.Width());
+    if (host.LocalHeight() > 0 && host.LocalWidth() > 0) {
+      CHECK_CUDA(cudaMemcpy2DAsync(device.Buffer(),
+                                   device.LDim() * sizeof(IODataType),
+                                   host.LockedBuffer(),
+                                   host.LDim() * sizeof(IODataType),
+                                   host.LocalHeight() * sizeof(IODataType),
+                                   host.LocalWidth(),
+                                   cudaMemcpyHostToDevice,
+                                   m_copy_stream));
+    }
+  }
+  buf.m_copy_done.record(m_copy_stream);
+  buf.m_device_buffers_ready = true;
+}
+#endif // LBANN_HAS_GPU
+
 #define PROTO(T)                          \
   template class partitioned_io_buffer<T>
 
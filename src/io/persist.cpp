@@ -28,6 +28,7 @@
 #include <sys/types.h>
 
 #include <cerrno>
+#include <cstdint>
 #include <cstring>
 #include <cstdio>
 
@@ -35,6 +36,9 @@
 #include "lbann/io/persist.hpp"
 #include "lbann/utils/exception.hpp"
 #include "lbann/io/file_io.hpp"
+#include "lbann/utils/pinned_memory.hpp"
+#include "lbann/utils/compression.hpp"
+#include "lbann/comm.hpp"
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -44,6 +48,16 @@
 #include "El.hpp"
 #include "mpi.h"
 
+#ifdef LBANN_HAS_CUFILE
+#include <cufile.h>
+#endif // LBANN_HAS_CUFILE
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+
 /****************************************************
  * These functions will save a libElemental matrix
  * using a file-per-process
@@ -62,6 +76,258 @@ struct layer_header {
   uint64_t ldim;       /**< specifies padding of first dimension in local storage */
 };
 
+namespace {
+
+/** Write a buffer at an offset, retrying partial writes. */
+void pwrite_bytes(int fd, const std::string& filename,
+                  const void* buf, size_t size, off_t offset) {
+  auto* ptr = static_cast<const char*>(buf);
+  while (size > 0) {
+    const ssize_t rc = pwrite(fd, ptr, size, offset);
+    if (rc < 0) {
+      if (errno == EINTR) { continue; }
+      LBANN_ERROR("failed to write file (", filename, "): ", strerror(errno));
+    }
+    ptr += rc;
+    size -= rc;
+    offset += rc;
+  }
+}
+
+/** @brief Write a matrix in El::Write's binary format with several
+ *  writers.
+ *
+ *  Columns are split into contiguous blocks, one per aggregator. Each
+ *  block is gathered to its aggregator, which writes it at the
+ *  block's offset in the file. The first block also writes the
+ *  height and width. Every process in the matrix's grid must call
+ *  this.
+ */
+template <typename TensorDataType>
+void write_distmat_stripes(
+  const std::string& filename,
+  const El::AbstractDistMatrix<TensorDataType>& M,
+  const std::vector<int>& aggregators,
+  std::vector<lbann::persist::deferred_write>* deferred_writes) {
+  using CPUMatType = El::Matrix<TensorDataType, El::Device::CPU>;
+  using StripeMatType = El::DistMatrix<TensorDataType, El::CIRC, El::CIRC, El::ELEMENT, El::Device::CPU>;
+  const El::Int height = M.Height();
+  const El::Int width = M.Width();
+  const El::Int num_stripes = std::max(std::min(static_cast<El::Int>(aggregators.size()), width),
+                                       El::Int(1));
+
+  // Gather each stripe to its aggregator
+  std::shared_ptr<CPUMatType> data;
+  off_t offset = 0;
+  bool write_header = false;
+  std::unique_ptr<El::AbstractDistMatrix<TensorDataType>> M_v(M.Construct(M.Grid(), M.Root()));
+  for (El::Int s = 0; s < num_stripes; ++s) {
+    const El::Int col_begin = (width * s) / num_stripes;
+    const El::Int col_end = (width * (s+1)) / num_stripes;
+    El::LockedView(*M_v, M, El::ALL, El::IR(col_begin, col_end));
+    StripeMatType stripe(M.Grid(), aggregators[s]);
+    El::Copy(*M_v, stripe);
+    if (stripe.CrossRank() == stripe.Root()) {
+      data = std::make_shared<CPUMatType>();
+      El::Copy(stripe.LockedMatrix(), *data);
+      offset = 2 * sizeof(El::Int) + col_begin * height * sizeof(TensorDataType);
+      write_header = (s == 0);
+    }
+  }
+  if (data == nullptr) { return; }
+
+  const std::string bin_filename = filename + ".bin";
+  auto write_stripe = [bin_filename, height, width, data, offset, write_header]() {
+    const mode_t mode_file = S_IWUSR | S_IRUSR | S_IWGRP | S_IRGRP;
+    const int fd = open(bin_filename.c_str(), O_WRONLY | O_CREAT, mode_file);
+    if (fd == -1) {
+      LBANN_ERROR("failed to open file (", bin_filename, "): ", strerror(errno));
+    }
+    if (write_header) {
+      const El::Int dims[2] = {height, width};
+      pwrite_bytes(fd, bin_filename, dims, sizeof(dims), 0);
+    }
+    const size_t col_size = data->Height() * sizeof(TensorDataType);
+    if (data->Height() == data->LDim()) {
+      pwrite_bytes(fd, bin_filename, data->LockedBuffer(),
+                   col_size * data->Width(), offset);
+    } else {
+      for (El::Int j = 0; j < data->Width(); ++j) {
+        pwrite_bytes(fd, bin_filename, data->LockedBuffer(0, j),
+                     col_size, offset + j * col_size);
+      }
+    }
+    lbann::closewrite(fd, bin_filename.c_str());
+  };
+  if (deferred_writes != nullptr) {
+    deferred_writes->emplace_back(std::move(write_stripe));
+  } else {
+    write_stripe();
+  }
+}
+
+/** File in a delta checkpoint that names its base checkpoint. */
+const std::string base_dir_filename = "/base_checkpoint";
+
+/** FNV-1a hash of the local matrix data. */
+template <typename TensorDataType>
+uint64_t local_checksum(const El::AbstractDistMatrix<TensorDataType>& M) {
+  using CPUMatType = El::Matrix<TensorDataType, El::Device::CPU>;
+  CPUMatType local;
+  if (M.GetLocalDevice() == El::Device::CPU) {
+    El::LockedView(local, static_cast<const CPUMatType&>(M.LockedMatrix()));
+  } else {
+    El::Copy(M.LockedMatrix(), local);
+  }
+  uint64_t hash = 14695981039346656037ull;
+  const size_t col_size = local.Height() * sizeof(TensorDataType);
+  for (El::Int j = 0; j < local.Width(); ++j) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(local.LockedBuffer(0, j));
+    for (size_t i = 0; i < col_size; ++i) {
+      hash ^= bytes[i];
+      hash *= 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+#ifdef LBANN_HAS_CUFILE
+
+/** Transfer data between a file and GPU memory with cuFile.
+ *
+ *  The file is opened with @c O_DIRECT if the file system supports
+ *  it, so cuFile can DMA between storage and the GPU. Otherwise
+ *  cuFile falls back to its compatibility mode.
+ */
+void cufile_transfer(const std::string& filename, bool write,
+                     void* buf, size_t size, off_t offset) {
+  static std::once_flag driver_flag;
+  std::call_once(driver_flag, []() {
+      const auto status = cuFileDriverOpen();
+      if (status.err != CU_FILE_SUCCESS) {
+        LBANN_ERROR("failed to open cuFile driver (error ", status.err, ")");
+      }
+    });
+
+  const int mode = write ? O_WRONLY : O_RDONLY;
+  int fd = open(filename.c_str(), mode | O_DIRECT);
+  if (fd == -1) {
+    fd = open(filename.c_str(), mode);
+  }
+  if (fd == -1) {
+    LBANN_ERROR("failed to open file (", filename, ") for cuFile: ",
+                std::strerror(errno));
+  }
+  CUfileDescr_t descr;
+  std::memset(&descr, 0, sizeof(descr));
+  descr.handle.fd = fd;
+  descr.type = CU_FILE_HANDLE_TYPE_OPAQUE_FD;
+  CUfileHandle_t handle;
+  const auto status = cuFileHandleRegister(&handle, &descr);
+  if (status.err != CU_FILE_SUCCESS) {
+    close(fd);
+    LBANN_ERROR("failed to register file (", filename, ") with cuFile "
+                "(error ", status.err, ")");
+  }
+  const ssize_t rc = (write
+                      ? cuFileWrite(handle, buf, size, offset, 0)
+                      : cuFileRead(handle, buf, size, offset, 0));
+  cuFileHandleDeregister(handle);
+  close(fd);
+  if (rc < 0 || static_cast<size_t>(rc) != size) {
+    LBANN_ERROR("cuFile failed to ", (write ? "write " : "read "), size,
+                " bytes ", (write ? "to " : "from "), filename,
+                " (returned ", rc, ")");
+  }
+}
+
+#endif // LBANN_HAS_CUFILE
+
+/** Suffix of compressed rank matrix files. */
+const std::string compressed_suffix = ".z";
+
+/** @brief Write local matrix data as compressed blocks.
+ *
+ *  The file holds the layer header, the compressed size, and the
+ *  output of utils::compress_blocks for the packed local data.
+ *  Returns the number of bytes written.
+ */
+template <typename TensorDataType>
+size_t write_compressed_matrix(const std::string& filename,
+                               const layer_header& header,
+                               const El::Matrix<TensorDataType, El::Device::CPU>& local) {
+  const El::Int height = local.Height();
+  const El::Int width = local.Width();
+  const TensorDataType* packed = local.LockedBuffer();
+  std::vector<TensorDataType> contiguous;
+  if (local.LDim() != height) {
+    contiguous.resize(height * width);
+    for (El::Int j = 0; j < width; ++j) {
+      std::copy(local.LockedBuffer(0, j), local.LockedBuffer(0, j) + height,
+                &contiguous[j * height]);
+    }
+    packed = contiguous.data();
+  }
+  std::vector<unsigned char> blob;
+  lbann::utils::compress_blocks(packed, height * width * sizeof(TensorDataType),
+                                blob);
+  const uint64_t blob_size = blob.size();
+  const int fd = lbann::openwrite(filename.c_str());
+  lbann::write_bytes(fd, filename.c_str(), &header, sizeof(header));
+  lbann::write_bytes(fd, filename.c_str(), &blob_size, sizeof(blob_size));
+  lbann::write_bytes(fd, filename.c_str(), blob.data(), blob.size());
+  lbann::closewrite(fd, filename.c_str());
+  return sizeof(header) + sizeof(blob_size) + blob.size();
+}
+
+/** @brief Read compressed local matrix data after its header.
+ *
+ *  Blocks are decompressed in parallel. Returns the number of bytes
+ *  read.
+ */
+template <typename TensorDataType>
+size_t read_compressed_matrix(int fd, const std::string& filename,
+                              El::AbstractDistMatrix<TensorDataType>& M,
+                              El::Int localheight, El::Int localwidth) {
+  uint64_t blob_size;
+  lbann::read_bytes(fd, filename.c_str(), &blob_size, sizeof(blob_size));
+  std::vector<unsigned char> blob(blob_size);
+  lbann::read_bytes(fd, filename.c_str(), blob.data(), blob.size());
+  El::Matrix<TensorDataType, El::Device::CPU> local(localheight, localwidth);
+  lbann::utils::decompress_blocks(
+    blob.data(), blob.size(), local.Buffer(),
+    localheight * localwidth * sizeof(TensorDataType));
+  if (M.LocalHeight() != localheight || M.LocalWidth() != localwidth) {
+    LBANN_ERROR("local matrix in ", filename, " is ",
+                localheight, " x ", localwidth, ", but expected ",
+                M.LocalHeight(), " x ", M.LocalWidth());
+  }
+  El::Copy(local, M.Matrix());
+  return sizeof(blob_size) + blob.size();
+}
+
+} // namespace
+
+template <typename TensorDataType>
+bool lbann::persist::skip_unchanged(
+  const std::string& key,
+  const El::AbstractDistMatrix<TensorDataType>& M,
+  bool collective) {
+  if (m_delta == checkpoint_delta::none) { return false; }
+  const uint64_t checksum = local_checksum(M);
+  if (m_delta == checkpoint_delta::base) {
+    m_base_checksums[key] = checksum;
+    return false;
+  }
+  const auto it = m_base_checksums.find(key);
+  int changed = (it == m_base_checksums.end() || it->second != checksum);
+  if (collective) {
+    El::mpi::AllReduce(&changed, 1, El::mpi::MAX, M.Grid().Comm(),
+                       El::SyncInfo<El::Device::CPU>{});
+  }
+  return !changed;
+}
+
 /** \brief Given an open file descriptor, file name, and a matrix, write the matrix
  *         to the file descriptor, return the number of bytes written */
 
@@ -81,9 +347,11 @@ bool lbann::persist::write_rank_distmat(persist_type type, const char *name, con
   const El::Int localWidth = M.LocalWidth();
   // If this is the case we will try to grab the matrix from model rank 0 on reload
   if(localHeight * localWidth == 0) { return true; }
-
-
-  int fd = lbann::openwrite(filename.c_str());
+  // Unchanged since the base checkpoint
+  if (skip_unchanged(std::string("rank/") + filename.substr(m_checkpoint_dir.size()),
+                     M, false)) {
+    return true;
+  }
 
   // build our header
   struct layer_header header;
@@ -94,6 +362,62 @@ bool lbann::persist::write_rank_distmat(persist_type type, const char *name, con
   header.localheight = (uint64_t) M.LocalHeight();
   header.ldim        = (uint64_t) M.LDim();
 
+  // Copy local data to pinned host memory and write it later
+  const bool compress = is_compressed(type);
+  if (m_defer_writes) {
+    auto data = std::make_shared<pinned_host_matrix<TensorDataType>>(
+      localHeight, localWidth);
+    El::Copy(M.LockedMatrix(), data->Matrix());
+    m_bytes[type] += sizeof(header) + localHeight * localWidth * sizeof(TensorDataType);
+    if (compress) {
+      m_deferred_writes.emplace_back([filename, header, data]() {
+          write_compressed_matrix(filename + compressed_suffix, header,
+                                  data->LockedMatrix());
+        });
+      return true;
+    }
+    m_deferred_writes.emplace_back([filename, header, data]() {
+        const int fd = lbann::openwrite(filename.c_str());
+        lbann::write_bytes(fd, filename.c_str(), &header, sizeof(header));
+        const auto& local = data->LockedMatrix();
+        for (El::Int j = 0; j < local.Width(); ++j) {
+          lbann::write_bytes(fd, filename.c_str(), local.LockedBuffer(0, j),
+                             local.Height() * sizeof(TensorDataType));
+        }
+        lbann::closewrite(fd, filename.c_str());
+      });
+    return true;
+  }
+
+  // Compress on the host
+  if (compress) {
+    El::Matrix<TensorDataType, El::Device::CPU> local;
+    El::Copy(M.LockedMatrix(), local);
+    m_bytes[type] += write_compressed_matrix(filename + compressed_suffix,
+                                             header, local);
+    return true;
+  }
+
+#ifdef LBANN_HAS_CUFILE
+  // Write GPU data directly from device memory
+  if (m_gpu_direct_storage
+      && M.GetLocalDevice() == El::Device::GPU
+      && localHeight == M.LDim()) {
+    const int fd = lbann::openwrite(filename.c_str());
+    lbann::write_bytes(fd, filename.c_str(), &header, sizeof(header));
+    lbann::closewrite(fd, filename.c_str());
+    const size_t bufsize = localHeight * localWidth * sizeof(TensorDataType);
+    El::GPUManager::SynchronizeDevice();
+    cufile_transfer(filename, true,
+                    const_cast<TensorDataType*>(M.LockedBuffer()),
+                    bufsize, sizeof(header));
+    m_bytes[type] += sizeof(header) + bufsize;
+    return true;
+  }
+#endif // LBANN_HAS_CUFILE
+
+  int fd = lbann::openwrite(filename.c_str());
+
   // write the header to the file
   ssize_t write_rc = write(fd, &header, sizeof(header));
   if (write_rc != sizeof(header)) {
@@ -143,7 +467,26 @@ bool lbann::persist::read_rank_distmat(persist_type type, const char *name, El::
   } else {
     LBANN_ERROR("invalid persist_type (", static_cast<int>(type), ")");
   }
-  int fd = openread(filename.c_str());
+  // look for an uncompressed file, then a compressed one
+  bool compressed = false;
+  auto open_file = [&filename, &compressed]() {
+    int fd = openread(filename.c_str());
+    compressed = false;
+    if (fd == -1) {
+      fd = openread((filename + compressed_suffix).c_str());
+      if (fd != -1) {
+        filename += compressed_suffix;
+        compressed = true;
+      }
+    }
+    return fd;
+  };
+  int fd = open_file();
+  // skipped by delta checkpoint, so read from base
+  if (fd == -1 && !m_base_dir.empty()) {
+    filename = m_base_dir + filename.substr(m_checkpoint_dir.size());
+    fd = open_file();
+  }
   // file does not exist. we will try to grab matrix from rank 0
    if( fd == -1 ) {return false;}
 
@@ -162,6 +505,27 @@ bool lbann::persist::read_rank_distmat(persist_type type, const char *name, El::
   // TODO: check that header values match up
   const El::Int localheight = header.localheight;
   const El::Int localwidth = header.localwidth;
+  if (compressed) {
+    m_bytes[type] += read_compressed_matrix(fd, filename, M,
+                                            localheight, localwidth);
+    lbann::closeread(fd, filename.c_str());
+    return true;
+  }
+#ifdef LBANN_HAS_CUFILE
+  // Read GPU data directly into device memory
+  if (m_gpu_direct_storage
+      && M.GetLocalDevice() == El::Device::GPU
+      && M.LocalHeight() == localheight
+      && M.LocalWidth() == localwidth
+      && M.LDim() == localheight) {
+    lbann::closeread(fd, filename.c_str());
+    const size_t bufsize = localheight * localwidth * sizeof(TensorDataType);
+    El::GPUManager::SynchronizeDevice();
+    cufile_transfer(filename, false, M.Buffer(), bufsize, sizeof(header));
+    m_bytes[type] += bufsize;
+    return true;
+  }
+#endif // LBANN_HAS_CUFILE
   if(M.ColStride() == 1 && M.RowStride() == 1) {
     if(M.Height() == M.LDim()) {
       auto *buf = (void *) M.Buffer();
@@ -258,6 +622,11 @@ void lbann::persist::open_restart(const std::string& dir) {
   // copy checkpoint directory
   m_checkpoint_dir = dir;
 
+  // delta checkpoints name their base checkpoint
+  m_base_dir.clear();
+  std::ifstream base_file(dir + base_dir_filename);
+  if (base_file) { std::getline(base_file, m_base_dir); }
+
   for(persist_type pt : persist_type_iterator()) {
     // open the file for reading
     if(m_filenames[pt].compare("<unknown>") == 0) {
@@ -267,11 +636,20 @@ void lbann::persist::open_restart(const std::string& dir) {
 }
 
 void lbann::persist::close_restart() {
+  m_base_dir.clear();
   for(persist_type pt : persist_type_iterator()) {
     m_filenames[pt] = "<unknown>";
   }
 }
 
+void lbann::persist::write_base_dir() const {
+  std::ofstream base_file(m_checkpoint_dir + base_dir_filename);
+  if (!base_file) {
+    LBANN_ERROR("failed to write file (", m_checkpoint_dir + base_dir_filename, ")");
+  }
+  base_file << m_base_dir << std::endl;
+}
+
 template <typename TensorDataType>
 bool lbann::persist::write_distmat(persist_type type, const char *name, El::AbstractDistMatrix<TensorDataType> *M) {
   // define full path to file to store matrix
@@ -284,8 +662,42 @@ bool lbann::persist::write_distmat(persist_type type, const char *name, El::Abst
     LBANN_ERROR("invalid persist_type (", static_cast<int>(type), ")");
   }
 
-  El::Write(*M, filename, El::BINARY, "");
-  //Write_MPI(M, filename, BINARY, "");
+  // Unchanged since the base checkpoint
+  if (skip_unchanged(std::string("shared/") + filename.substr(m_checkpoint_dir.size()),
+                     *M, true)) {
+    return true;
+  }
+
+  if (!m_io_aggregators.empty()) {
+    write_distmat_stripes(filename, *M, m_io_aggregators,
+                          m_defer_writes ? &m_deferred_writes : nullptr);
+  } else if (m_defer_writes) {
+    // Gather to the process that El::Write would write from and copy
+    // to pinned host memory
+    std::shared_ptr<pinned_host_matrix<TensorDataType>> data;
+    if (M->ColStride() == 1 && M->RowStride() == 1) {
+      if (M->CrossRank() == M->Root()) {
+        data = std::make_shared<pinned_host_matrix<TensorDataType>>(
+          M->LocalHeight(), M->LocalWidth());
+        El::Copy(M->LockedMatrix(), data->Matrix());
+      }
+    } else {
+      const El::DistMatrix<TensorDataType, El::CIRC, El::CIRC, El::ELEMENT, El::Device::CPU> circ(*M);
+      if (circ.CrossRank() == circ.Root()) {
+        data = std::make_shared<pinned_host_matrix<TensorDataType>>(
+          circ.LocalHeight(), circ.LocalWidth());
+        El::Copy(circ.LockedMatrix(), data->Matrix());
+      }
+    }
+    if (data != nullptr) {
+      m_deferred_writes.emplace_back([filename, data]() {
+          El::Write(data->LockedMatrix(), filename, El::BINARY, "");
+        });
+    }
+  } else {
+    El::Write(*M, filename, El::BINARY, "");
+    //Write_MPI(M, filename, BINARY, "");
+  }
 
   uint64_t bytes = 2 * sizeof(El::Int) + M->Height() * M->Width() * sizeof(DataType);
   m_bytes[type] += bytes;
@@ -307,6 +719,11 @@ bool lbann::persist::read_distmat(persist_type type, const char *name, El::Abstr
 
   // check whether file exists
   int exists = lbann::exists(filename.c_str());
+  // skipped by delta checkpoint, so read from base
+  if (!exists && !m_base_dir.empty()) {
+    filename = m_base_dir + filename.substr(m_checkpoint_dir.size());
+    exists = lbann::exists(filename.c_str());
+  }
   if (! exists) {
     LBANN_ERROR("failed to read distributed matrix from file (", filename, ")");
     return false;
@@ -373,6 +790,83 @@ bool lbann::read_string(int fd, const char *name, char *buf, size_t size) {
 }
 
 
+lbann::trainer_broadcast_streambuf::trainer_broadcast_streambuf(
+  lbann_comm& comm, int root, size_t chunk_size)
+  : m_comm(comm),
+    m_root(root),
+    m_is_root(comm.get_rank_in_trainer() == root),
+    m_chunk_size(chunk_size),
+    m_buffer(sizeof(uint64_t) + chunk_size) {
+  char* data = m_buffer.data() + sizeof(uint64_t);
+  if (m_is_root) {
+    setp(data, data + m_chunk_size);
+  } else {
+    setg(data, data, data);
+  }
+}
+
+size_t lbann::trainer_broadcast_streambuf::broadcast_chunk(size_t size) {
+  uint64_t size_ = size;
+  if (m_is_root) {
+    std::memcpy(m_buffer.data(), &size_, sizeof(uint64_t));
+  }
+  m_comm.trainer_broadcast(m_root, m_buffer.data(),
+                           static_cast<int>(m_buffer.size()));
+  std::memcpy(&size_, m_buffer.data(), sizeof(uint64_t));
+  m_done = (size_ < m_chunk_size);
+  return size_;
+}
+
+lbann::trainer_broadcast_streambuf::int_type
+lbann::trainer_broadcast_streambuf::overflow(int_type ch) {
+  if (!m_is_root || m_done) {
+    return traits_type::eof();
+  }
+  broadcast_chunk(pptr() - pbase());
+  char* data = m_buffer.data() + sizeof(uint64_t);
+  setp(data, data + m_chunk_size);
+  if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+  }
+  return traits_type::not_eof(ch);
+}
+
+lbann::trainer_broadcast_streambuf::int_type
+lbann::trainer_broadcast_streambuf::underflow() {
+  if (m_is_root) {
+    return traits_type::eof();
+  }
+  while (gptr() == egptr()) {
+    if (m_done) {
+      return traits_type::eof();
+    }
+    const auto size = broadcast_chunk(0);
+    char* data = m_buffer.data() + sizeof(uint64_t);
+    setg(data, data, data + size);
+  }
+  return traits_type::to_int_type(*gptr());
+}
+
+void lbann::trainer_broadcast_streambuf::finish() {
+  if (m_is_root) {
+    // A full chunk is followed by an empty one, so the last chunk is
+    // never full
+    if (!m_done && pptr() == epptr()) {
+      overflow(traits_type::eof());
+    }
+    if (!m_done) {
+      broadcast_chunk(pptr() - pbase());
+    }
+  } else {
+    // Keep collectives matched even if the reader stopped early
+    while (!m_done) {
+      setg(eback(), egptr(), egptr());
+      underflow();
+    }
+  }
+}
+
 namespace lbann {
 
 #define PROTO(T)                     \
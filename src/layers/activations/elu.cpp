@@ -48,9 +48,13 @@ void local_fp(TensorDataType alpha,
   }
 }
 
-/** Local backprop computation. */
+/** Local backprop computation.
+ *  @param from_output Whether @c input holds the forward prop
+ *  outputs, as happens when the layer runs in place.
+ */
 template <typename TensorDataType>
 void local_bp(TensorDataType alpha,
+              bool from_output,
               const El::AbstractMatrix<TensorDataType>& input,
               const El::AbstractMatrix<TensorDataType>& gradient_wrt_output,
               El::AbstractMatrix<TensorDataType>& gradient_wrt_input) {
@@ -62,7 +66,11 @@ void local_bp(TensorDataType alpha,
       const auto& x = input(row, col);
       const auto& dy = gradient_wrt_output(row, col);
       auto& dx = gradient_wrt_input(row, col);
-      dx = (x > El::TypeTraits<TensorDataType>::Zero()) ? dy : dy * alpha * std::exp(x);
+      if (x > El::TypeTraits<TensorDataType>::Zero()) {
+        dx = dy;
+      } else {
+        dx = from_output ? dy * (x + alpha) : dy * alpha * std::exp(x);
+      }
     }
   }
 }
@@ -78,8 +86,13 @@ void elu_layer<TensorDataType, Layout, Device>::fp_compute() {
 
 template <typename TensorDataType, data_layout Layout, El::Device Device>
 void elu_layer<TensorDataType, Layout, Device>::bp_compute() {
+  // Check if forward prop overwrote the input tensor
+  const auto& local_input = this->get_local_prev_activations();
+  const bool in_place
+    = (local_input.LockedBuffer() == this->get_local_activations().LockedBuffer());
   local_bp(this->m_alpha,
-           this->get_local_prev_activations(),
+           in_place,
+           local_input,
            this->get_local_prev_error_signals(),
            this->get_local_error_signals());
 }
@@ -52,9 +52,13 @@ __global__ void fp_kernel(TensorDataType alpha,
   }
 }
 
-/** CUDA kernel for backprop computation. */
+/** CUDA kernel for backprop computation.
+ *  @param from_output Whether @c input holds the forward prop
+ *  outputs, as happens when the layer runs in place.
+ */
 template <typename TensorDataType>
 __global__ void bp_kernel(TensorDataType alpha,
+                          bool from_output,
                           El::Int height,
                           El::Int width,
                           const TensorDataType* __restrict__ input,
@@ -72,7 +76,11 @@ __global__ void bp_kernel(TensorDataType alpha,
     const auto& x = input[row + col * input_ldim];
     const auto& dy = gradient_wrt_output[row + col * gradient_wrt_output_ldim];
     auto& dx = gradient_wrt_input[row + col * gradient_wrt_input_ldim];
-    dx = (x > TensorDataType(0.0)) ? dy : dy * alpha * cuda::exp(x);
+    if (x > TensorDataType(0.0)) {
+      dx = dy;
+    } else {
+      dx = from_output ? dy * (x + alpha) : dy * alpha * cuda::exp(x);
+    }
   }
 }
 
@@ -107,6 +115,7 @@ void local_fp(TensorDataType alpha,
 /** Local backprop computation. */
 template <typename TensorDataType>
 void local_bp(TensorDataType alpha,
+              bool from_output,
               const El::AbstractMatrix<TensorDataType>& input,
               const El::AbstractMatrix<TensorDataType>& gradient_wrt_output,
               El::AbstractMatrix<TensorDataType>& gradient_wrt_input) {
@@ -126,7 +135,7 @@ void local_bp(TensorDataType alpha,
   // Launch CUDA kernel
   if (grid_dim > 0) {
     bp_kernel<<<grid_dim, block_dim, 0, El::GPUManager::Stream()>>>(
-      alpha, height, width,
+      alpha, from_output, height, width,
       input.LockedBuffer(), input.LDim(),
       gradient_wrt_output.LockedBuffer(), gradient_wrt_output.LDim(),
       gradient_wrt_input.Buffer(), gradient_wrt_input.LDim());
@@ -144,8 +153,13 @@ void elu_layer<TensorDataType, Layout, Device>::fp_compute() {
 }
 template <typename TensorDataType, data_layout Layout, El::Device Device>
 void elu_layer<TensorDataType, Layout, Device>::bp_compute() {
+  // Check if forward prop overwrote the input tensor
+  const auto& local_input = this->get_local_prev_activations();
+  const bool in_place
+    = (local_input.LockedBuffer() == this->get_local_activations().LockedBuffer());
   local_bp(this->m_alpha,
-           this->get_local_prev_activations(),
+           in_place,
+           local_input,
            this->get_local_prev_error_signals(),
            this->get_local_error_signals());
 }
@@ -32,6 +32,7 @@
 #include "lbann/models/model.hpp"
 #include "lbann/trainers/trainer.hpp"
 #include "lbann/execution_contexts/sgd_execution_context.hpp"
+#include "lbann/utils/memory_usage.hpp"
 
 namespace lbann {
 
@@ -89,12 +90,22 @@ data_type_layer<TensorDataType>& data_type_layer<TensorDataType>::operator=(cons
     m_gradient_wrt_inputs.emplace_back(ptr ? ptr->Copy() : nullptr);
   }
   m_persistent_error_signals = other.m_persistent_error_signals;
+  m_activations_buffers.clear();
+  m_error_signals_buffers.clear();
+#ifdef LBANN_HAS_GPU
+  m_activations_allocations.clear();
+#endif // LBANN_HAS_GPU
+  m_activations_setups.clear();
+  m_error_signals_setups.clear();
   return *this;
 }
 
 template <typename TensorDataType>
 void data_type_layer<TensorDataType>::forward_prop() {
   const auto fp_start = get_time();
+  telemetry::scope telemetry_scope(telemetry::category::forward_prop,
+                                   m_name, m_telemetry_region);
+  comm_profile::context comm_context(m_name);
 
   // Setup tensors
   const auto& c = static_cast<sgd_execution_context&>(m_model->get_execution_context());
@@ -137,6 +148,9 @@ void data_type_layer<TensorDataType>::forward_prop() {
 template <typename TensorDataType>
 void data_type_layer<TensorDataType>::back_prop_impl_() {
   const auto bp_start = get_time();
+  telemetry::scope telemetry_scope(telemetry::category::backward_prop,
+                                   m_name, m_telemetry_region);
+  comm_profile::context comm_context(m_name);
 
   // Setup tensors
   const auto& c = static_cast<sgd_execution_context&>(
@@ -182,14 +196,9 @@ void data_type_layer<TensorDataType>::summarize_matrices(lbann_summary& summariz
   // Summarize activation matrices
   const int num_children = get_num_children();
   for (int i = 0; i < num_children; ++i) {
-    AbsDistMatReadProxyType<El::Device::CPU> acts(*m_outputs[i]);
     std::string prefix = m_name + "/activations";
     if (num_children > 1) { prefix += std::to_string(i); }
-    summarizer.reduce_mean(prefix + "/mean", acts.GetLocked(), step);
-    summarizer.reduce_min(prefix + "/min", acts.GetLocked(), step);
-    summarizer.reduce_max(prefix + "/max", acts.GetLocked(), step);
-    summarizer.reduce_stdev(prefix + "/stdev", acts.GetLocked(), step);
-    summarizer.reduce_2norm(prefix + "/2norm2", acts.GetLocked(), step);
+    summarizer.reduce_moments(prefix, *m_outputs[i], step);
   }
 
   // Summarize error signal matrices
@@ -197,14 +206,9 @@ void data_type_layer<TensorDataType>::summarize_matrices(lbann_summary& summariz
   for (int i = 0; i < num_parents; ++i) {
     if (!m_gradient_wrt_inputs[i]) continue;
 
-    AbsDistMatReadProxyType<El::Device::CPU> error_signals(*m_gradient_wrt_inputs[i]);
     std::string prefix = m_name + "/error_signals";
     if (num_parents > 1) { prefix += std::to_string(i); }
-    summarizer.reduce_mean(prefix + "/mean", error_signals.GetLocked(), step);
-    summarizer.reduce_min(prefix + "/min", error_signals.GetLocked(), step);
-    summarizer.reduce_max(prefix + "/max", error_signals.GetLocked(), step);
-    summarizer.reduce_stdev(prefix + "/stdev", error_signals.GetLocked(), step);
-    summarizer.reduce_2norm(prefix + "/2norm2", error_signals.GetLocked(), step);
+    summarizer.reduce_moments(prefix, *m_gradient_wrt_inputs[i], step);
   }
 
 }
@@ -533,6 +537,185 @@ void data_type_layer<TensorDataType>::check_setup() {
   }
 }
 
+template <typename TensorDataType>
+void data_type_layer<TensorDataType>::release_activations() {
+  for (int i = 0; i < get_num_children(); ++i) {
+#ifdef LBANN_HAS_DISTCONV
+    if (!keep_original_outputs(i)) continue;
+#endif // LBANN_HAS_DISTCONV
+#ifdef LBANN_HAS_GPU
+    if (is_activations_cached(i)) { m_activations_allocations[i].reset(); }
+#endif // LBANN_HAS_GPU
+    m_outputs[i]->Empty();
+  }
+}
+
+template <typename TensorDataType>
+bool data_type_layer<TensorDataType>::has_activation_views() const {
+  for (size_t i = 0; i < m_outputs.size(); ++i) {
+    if (m_outputs[i] != nullptr && m_outputs[i]->Viewing()
+        && !is_activations_cached(i)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename TensorDataType>
+bool data_type_layer<TensorDataType>::is_activations_cached(int child_index) const {
+#ifdef LBANN_HAS_GPU
+  const auto& output = m_outputs[child_index];
+  return (static_cast<size_t>(child_index) < m_activations_allocations.size()
+          && m_activations_allocations[child_index].get() != nullptr
+          && output != nullptr
+          && output->Viewing()
+          && output->LockedBuffer() == m_activations_allocations[child_index].get());
+#else
+  return false;
+#endif // LBANN_HAS_GPU
+}
+
+namespace {
+
+/** @brief Entry of a buffer list, or null if there is none. */
+void* get_buffer(const std::vector<void*>& buffers, int index) {
+  return (static_cast<size_t>(index) < buffers.size()
+          ? buffers[index] : nullptr);
+}
+
+/** @brief Setup a distributed matrix in external memory.
+ *  @details The matrix should already be aligned. Local data is
+ *  stored contiguously.
+ */
+template <typename TensorDataType>
+void attach_to_buffer(El::AbstractDistMatrix<TensorDataType>& mat,
+                      void* buffer,
+                      El::Int height,
+                      El::Int width) {
+  auto& elemental_mat = dynamic_cast<El::ElementalMatrix<TensorDataType>&>(mat);
+  const auto col_shift = El::Shift(mat.ColRank(), mat.ColAlign(), mat.ColStride());
+  const auto local_height = El::Length(height, col_shift, mat.ColStride());
+  elemental_mat.Attach(height, width, mat.Grid(),
+                       mat.ColAlign(), mat.RowAlign(),
+                       static_cast<TensorDataType*>(buffer),
+                       std::max(local_height, El::Int(1)),
+                       mat.Root());
+}
+
+/** @brief Whether a tensor's last setup can be kept.
+ *  @details True if it has the requested shape and memory and was
+ *  aligned with the same distribution.
+ */
+template <typename TensorDataType, typename SetupType>
+bool is_setup_current(const El::AbstractDistMatrix<TensorDataType>& mat,
+                      const std::vector<SetupType>& setups,
+                      int index,
+                      const El::DistData& alignment,
+                      const void* buffer,
+                      El::Int height,
+                      El::Int width) {
+  if (static_cast<size_t>(index) >= setups.size()
+      || !setups[index].valid
+      || !(setups[index].alignment == alignment)
+      || mat.Height() != height
+      || mat.Width() != width) {
+    return false;
+  }
+  if (buffer != nullptr) {
+    return mat.Viewing() && mat.LockedMatrix().LockedBuffer() == buffer;
+  }
+  return !mat.Viewing();
+}
+
+/** @brief Record the alignment a tensor was set up with. */
+template <typename SetupType>
+void record_setup(std::vector<SetupType>& setups,
+                  size_t size,
+                  int index,
+                  const El::DistData* alignment) {
+  setups.resize(std::max(setups.size(), size));
+  setups[index].valid = (alignment != nullptr);
+  if (alignment != nullptr) { setups[index].alignment = *alignment; }
+}
+
+} // namespace
+
+template <typename TensorDataType>
+size_t data_type_layer<TensorDataType>::get_activations_memory_usage(El::Device device) const {
+  size_t bytes = 0;
+  for (const auto& m : m_inputs) { bytes += get_local_memory_usage(m, device); }
+  for (const auto& m : m_outputs) { bytes += get_local_memory_usage(m, device); }
+  return bytes;
+}
+
+template <typename TensorDataType>
+size_t data_type_layer<TensorDataType>::get_error_signals_memory_usage(El::Device device) const {
+  size_t bytes = 0;
+  for (const auto& m : m_gradient_wrt_outputs) { bytes += get_local_memory_usage(m, device); }
+  for (const auto& m : m_gradient_wrt_inputs) { bytes += get_local_memory_usage(m, device); }
+  return bytes;
+}
+
+template <typename TensorDataType>
+size_t data_type_layer<TensorDataType>::get_activations_buffer_size(int child_index) const {
+#ifdef LBANN_HAS_DISTCONV
+  if (!keep_original_outputs(child_index)) { return 0; }
+#endif // LBANN_HAS_DISTCONV
+  const auto& output = get_activations(child_index);
+  if (output.Viewing() && get_buffer(m_activations_buffers, child_index) == nullptr
+      && !is_activations_cached(child_index)) {
+    return 0;
+  }
+  return (std::max(output.LocalHeight(), El::Int(1))
+          * output.LocalWidth() * sizeof(TensorDataType));
+}
+
+template <typename TensorDataType>
+size_t data_type_layer<TensorDataType>::get_error_signals_buffer_size(int parent_index) const {
+#ifdef LBANN_HAS_DISTCONV
+  if (!keep_original_gradient_wrt_inputs(parent_index)) { return 0; }
+#endif // LBANN_HAS_DISTCONV
+  if (m_persistent_error_signals) { return 0; }
+
+  // Error signals are aligned with the input tensors
+  const auto& input = get_prev_activations(parent_index);
+  return (std::max(input.LocalHeight(), El::Int(1))
+          * input.LocalWidth() * sizeof(TensorDataType));
+}
+
+template <typename TensorDataType>
+void data_type_layer<TensorDataType>::set_activations_buffer(int child_index, void* buffer) {
+  if (m_activations_buffers.size() < m_outputs.size()) {
+    m_activations_buffers.resize(m_outputs.size(), nullptr);
+  }
+  m_activations_buffers.at(child_index) = buffer;
+
+  // Move output tensor to new memory
+  auto& output = get_activations(child_index);
+  const auto height = output.Height();
+  const auto width = output.Width();
+  output.Empty(false);
+#ifdef LBANN_HAS_GPU
+  if (static_cast<size_t>(child_index) < m_activations_allocations.size()) {
+    m_activations_allocations[child_index].reset();
+  }
+#endif // LBANN_HAS_GPU
+  if (buffer != nullptr) {
+    attach_to_buffer(output, buffer, height, width);
+  }
+  else {
+    output.Resize(height, width);
+  }
+}
+
+template <typename TensorDataType>
+void data_type_layer<TensorDataType>::set_error_signals_buffer(int parent_index, void* buffer) {
+  if (m_error_signals_buffers.size() < m_gradient_wrt_inputs.size()) {
+    m_error_signals_buffers.resize(m_gradient_wrt_inputs.size(), nullptr);
+  }
+  m_error_signals_buffers.at(parent_index) = buffer;
+}
+
 // ===========================================================
 // Weights access functions
 // ===========================================================
@@ -553,6 +736,78 @@ void data_type_layer<TensorDataType>::replace_weights(Layer* other_layer) {
 
 }
 
+template <typename TensorDataType>
+void data_type_layer<TensorDataType>::tie_weights(Layer* other_layer) {
+  auto* other = dynamic_cast<data_type_layer<TensorDataType>*>(other_layer);
+  if (other == nullptr) {
+    LBANN_ERROR("attempted to tie the weights of layer \"", get_name(), "\" ",
+                "to a null pointer or a layer of another data type");
+  }
+  const std::vector<WeightsType*>& other_layer_weights = other->get_data_type_weights();
+  if (other_layer_weights.size() != m_weights.size()) {
+    LBANN_ERROR("attempted to tie the weights of layer \"", get_name(), "\" ",
+                "to layer \"", other->get_name(), "\", which has ",
+                other_layer_weights.size(), " weights instead of ",
+                m_weights.size());
+  }
+  for (size_t i = 0; i < m_weights.size(); ++i) {
+    if (m_weights[i] && other_layer_weights[i]) {
+      m_weights[i]->tie_values(*other_layer_weights[i]);
+    }
+  }
+}
+
+namespace {
+
+/** @brief Copy @c src to @c tgt with a 16-bit redistribution.
+ *
+ *  @c src is converted to 16-bit floating point in its own
+ *  distribution, redistributed, and converted back on arrival.
+ *
+ *  @returns @c false, without copying, if the copy needs no
+ *  communication, if @c tgt is already 16-bit, or if this build has
+ *  no 16-bit matrices on the source device.
+ */
+template <typename TDT>
+bool copy_in_half_precision(const BaseDistMat& src,
+                            El::AbstractDistMatrix<TDT>& tgt) {
+  const auto src_dist = src.DistData();
+  const auto tgt_dist = tgt.DistData();
+  if (sizeof(TDT) <= 2
+      || (src_dist.colDist == tgt_dist.colDist
+          && src_dist.rowDist == tgt_dist.rowDist
+          && src_dist.colAlign == tgt_dist.colAlign
+          && src_dist.rowAlign == tgt_dist.rowAlign)) {
+    return false;
+  }
+  switch (src.GetLocalDevice()) {
+#ifdef LBANN_HAS_HALF
+  case El::Device::CPU:
+    {
+      using HalfMatType = El::AbstractDistMatrix<cpu_fp16>;
+      std::unique_ptr<HalfMatType> half(HalfMatType::Instantiate(src_dist));
+      El::Copy(src, *half);
+      El::Copy(*half, tgt);
+    }
+    return true;
+#endif // LBANN_HAS_HALF
+#ifdef LBANN_HAS_GPU_FP16
+  case El::Device::GPU:
+    {
+      using HalfMatType = El::AbstractDistMatrix<fp16>;
+      std::unique_ptr<HalfMatType> half(HalfMatType::Instantiate(src_dist));
+      El::Copy(src, *half);
+      El::Copy(*half, tgt);
+    }
+    return true;
+#endif // LBANN_HAS_GPU_FP16
+  default:
+    return false;
+  }
+}
+
+} // namespace
+
 template <typename TensorDataType>
 void data_type_layer<TensorDataType>::fp_setup_inputs(El::Int mini_batch_size) {
   if (get_num_parents() < 1) { return; }
@@ -569,10 +824,31 @@ void data_type_layer<TensorDataType>::fp_setup_inputs(El::Int mini_batch_size) {
     const auto& parent = *m_parent_layers[i];
     const auto& parent_output = parent.get_activations(*this);
     auto& input = *m_inputs[i];
+    // Note: Parents with a different data type (e.g. with
+    // --mixed_precision) are always copied.
+    const auto* typed_parent_output
+      = dynamic_cast<const AbsDistMatrixType*>(&parent_output);
+
+    // Keep the view from the last step if the parent output has not
+    // moved
+    if (typed_parent_output != nullptr
+        && input.Viewing()
+        && input.DistData() == parent_output.DistData()
+        && input.Height() == get_input_size(i)
+        && input.Width() == mini_batch_size
+        && parent_output.Height() == input.Height()
+        && parent_output.Width() == input.Width()
+        && input.LDim() == typed_parent_output->LDim()
+        && (input.LockedMatrix().LockedBuffer()
+            == typed_parent_output->LockedMatrix().LockedBuffer())) {
+      continue;
+    }
+
     input.Empty(false);
     input.AlignWith(alignment_dist);
-    if (parent_output.DistData() == input.DistData()) {
-      El::LockedView(input, dynamic_cast<const AbsDistMatrixType&>(parent_output));
+    if (typed_parent_output != nullptr
+        && parent_output.DistData() == input.DistData()) {
+      El::LockedView(input, *typed_parent_output);
     } else {
       bool async_copy = false;
 #if defined(LBANN_HAS_GPU) && defined(ASYNC_INPUT_MEMORY_TRANSFER)
@@ -586,7 +862,8 @@ void data_type_layer<TensorDataType>::fp_setup_inputs(El::Int mini_batch_size) {
 #endif // defined(LBANN_HAS_GPU) && defined(ASYNC_INPUT_MEMORY_TRANSFER)
       if (async_copy) {
         El::CopyAsync(parent_output, input);
-      } else {
+      } else if (get_transfer_precision() != transfer_precision::half
+                 || !copy_in_half_precision(parent_output, input)) {
         El::Copy(parent_output, input);
       }
     }
@@ -624,9 +901,72 @@ void data_type_layer<TensorDataType>::fp_setup_outputs(El::Int mini_batch_size)
     if (!keep_original_outputs(i)) continue;
 #endif // LBANN_HAS_DISTCONV
     auto& output = get_activations(i);
+    auto* buffer = get_buffer(m_activations_buffers, i);
+#ifdef LBANN_HAS_GPU
+    // GPU outputs without external memory can use the caching
+    // allocator, which other layers share
+    const bool use_cache = (buffer == nullptr && !m_in_place
+                            && output.GetLocalDevice() == El::Device::GPU
+                            && cuda::caching_allocator::enabled());
+    if (use_cache) {
+      m_activations_allocations.resize(
+        std::max(m_activations_allocations.size(), m_outputs.size()));
+      buffer = m_activations_allocations[i].get();
+    }
+#endif // LBANN_HAS_GPU
+
+    // Keep the setup from the last step if nothing has changed
+    if (!m_in_place
+        && is_setup_current(output, m_activations_setups, i, alignment_dist,
+                            buffer, get_output_size(i), mini_batch_size)) {
+      continue;
+    }
+
     output.Empty(false);
     if (align_outputs) { output.AlignWith(alignment_dist); }
-    output.Resize(get_output_size(i), mini_batch_size);
+
+    // Overwrite the parent's output tensor if the model allows it
+    // Note: The parent output is only used by this layer (see
+    // model::setup_in_place_layers), so constness can be dropped.
+    if (m_in_place) {
+      const auto& parent_output = m_parent_layers.front()->get_activations(*this);
+      auto* typed_parent_output = const_cast<AbsDistMatrixType*>(
+        dynamic_cast<const AbsDistMatrixType*>(&parent_output));
+      if (typed_parent_output != nullptr
+          && typed_parent_output->DistData() == output.DistData()
+          && typed_parent_output->Height() == get_output_size(i)
+          && typed_parent_output->Width() == mini_batch_size) {
+        El::View(output, *typed_parent_output);
+        continue;
+      }
+    }
+
+#ifdef LBANN_HAS_GPU
+    // The cached block is kept if the tensor shrinks, e.g. for the
+    // last mini-batch of an epoch
+    if (use_cache) {
+      const auto col_shift = El::Shift(output.ColRank(), output.ColAlign(),
+                                       output.ColStride());
+      const auto row_shift = El::Shift(output.RowRank(), output.RowAlign(),
+                                       output.RowStride());
+      const auto local_height = El::Length(El::Int(get_output_size(i)),
+                                           col_shift, output.ColStride());
+      const auto local_width = El::Length(mini_batch_size, row_shift,
+                                          output.RowStride());
+      buffer = m_activations_allocations[i].reserve(
+        std::max(local_height, El::Int(1)) * local_width
+        * sizeof(TensorDataType));
+    }
+#endif // LBANN_HAS_GPU
+
+    if (buffer != nullptr) {
+      attach_to_buffer(output, buffer, get_output_size(i), mini_batch_size);
+    }
+    else {
+      output.Resize(get_output_size(i), mini_batch_size);
+    }
+    record_setup(m_activations_setups, get_num_children(), i,
+                 align_outputs ? &alignment_dist : nullptr);
   }
 
 }
@@ -638,7 +978,8 @@ namespace {
 // asynchronously or not -- encapsulate it in this little function.
 template <typename TDT>
 void do_tensor_copy(const BaseDistMat& src,
-                    El::AbstractDistMatrix<TDT>& tgt) {
+                    El::AbstractDistMatrix<TDT>& tgt,
+                    transfer_precision precision = transfer_precision::full) {
   bool copy_async = false;
 #if defined(LBANN_HAS_GPU) && defined(ASYNC_INPUT_MEMORY_TRANSFER)
   auto src_dist_data = src.DistData();
@@ -653,7 +994,8 @@ void do_tensor_copy(const BaseDistMat& src,
   if (copy_async) {
     El::CopyAsync(src, tgt);
   }
-  else {
+  else if (precision != transfer_precision::half
+           || !copy_in_half_precision(src, tgt)) {
     El::Copy(src, tgt);
   }
 }
@@ -710,12 +1052,13 @@ void data_type_layer<TensorDataType>::view_or_copy_prev_error_signal_(
   // If the distributions are compatible, we can just view
   // things. Otherwise, deep-copy the data.
   auto& prev_error_sig = *m_gradient_wrt_outputs[layer_idx];
-  if (signal.DistData() == prev_error_sig.DistData()) {
-    El::LockedView(prev_error_sig,
-                   dynamic_cast<const AbsDistMatrixType&>(signal));
+  const auto* typed_signal = dynamic_cast<const AbsDistMatrixType*>(&signal);
+  if (typed_signal != nullptr
+      && signal.DistData() == prev_error_sig.DistData()) {
+    El::LockedView(prev_error_sig, *typed_signal);
   }
   else {
-    do_tensor_copy(signal, prev_error_sig);
+    do_tensor_copy(signal, prev_error_sig, get_transfer_precision());
   }
 }
 
@@ -734,18 +1077,13 @@ void data_type_layer<TensorDataType>::move_or_copy_prev_error_signal_(
     signal, get_output_size(layer_idx), m_outputs[layer_idx]->Width(),
     m_name, child.get_name());
 
-  // If the distribution is OK, then we can just swap data
-  // around. Otherwise, deep copy into correct distribution.
+  // If the distribution and data type are OK, then we can just swap
+  // data around. Otherwise, deep copy into correct distribution.
   El::DistData expected_distdata = m_outputs[layer_idx]->DistData();
-  if (signal.DistData() == expected_distdata) {
-    if (auto sig_ptr = dynamic_cast<AbsDistMatrixType*>(signal_in.get())) {
-      signal_in.release();
-      m_gradient_wrt_outputs[layer_idx].reset(sig_ptr);
-    }
-    else {
-      LBANN_ERROR("Logic error: DistData objects compare equal "
-                  "but matrices have different dynamic types.");
-    }
+  auto sig_ptr = dynamic_cast<AbsDistMatrixType*>(signal_in.get());
+  if (sig_ptr != nullptr && signal.DistData() == expected_distdata) {
+    signal_in.release();
+    m_gradient_wrt_outputs[layer_idx].reset(sig_ptr);
   }
   else // Deep copy
   {
@@ -756,7 +1094,8 @@ void data_type_layer<TensorDataType>::move_or_copy_prev_error_signal_(
           this->get_device_allocation())->MakeEmpty(*expected_distdata.grid, 0);
     }
 
-    do_tensor_copy(signal, *m_gradient_wrt_outputs[layer_idx]);
+    do_tensor_copy(signal, *m_gradient_wrt_outputs[layer_idx],
+                   get_transfer_precision());
   }
 }
 
@@ -777,7 +1116,7 @@ void data_type_layer<TensorDataType>::deep_copy_prev_error_signal_(
   // If the distributions are compatible, we can just view
   // things. Otherwise, deep-copy the data.
   auto& prev_error_sig = *m_gradient_wrt_outputs[layer_idx];
-  do_tensor_copy(signal, prev_error_sig);
+  do_tensor_copy(signal, prev_error_sig, get_transfer_precision());
 }
 
 template <typename TensorDataType>
@@ -816,13 +1155,21 @@ void data_type_layer<TensorDataType>::propagate_error_signals_to_parents_() {
   std::vector<Layer*> layer_list = get_model()->get_layers();
   for (size_t p_idx = 0; p_idx < parents.size(); ++p_idx) {
     Layer& parent = get_nonconst_layer(layer_list, parents[p_idx]);
+    if (!parent.needs_backprop()) { continue; }
 
     // If my error signals persist, my parent can always view them,
     // assuming the distdata is right. Otherwise, my views and my data
     // will be released. Views must be copied and owned data can
     // either be copied or swapped out.
+    // Error signals in planned memory stay valid until the parent
+    // has finished backprop, so they can also be viewed.
     auto& error_signal = *m_gradient_wrt_inputs[p_idx];
-    if (m_persistent_error_signals)
+    const auto* buffer = get_buffer(m_error_signals_buffers, p_idx);
+    const bool in_buffer
+      = (buffer != nullptr
+         && error_signal.Viewing()
+         && static_cast<const void*>(error_signal.LockedBuffer()) == buffer);
+    if (m_persistent_error_signals || in_buffer)
       attempt_view_error_signal(parent, *this, error_signal);
     else if (error_signal.Viewing())
       deep_copy_error_signal(parent, *this, error_signal);
@@ -859,10 +1206,45 @@ void data_type_layer<TensorDataType>::bp_setup_gradient_wrt_inputs(
 #ifdef LBANN_HAS_DISTCONV
     if (!keep_original_gradient_wrt_inputs(i)) continue;
 #endif // LBANN_HAS_DISTCONV
+    auto* buffer = get_buffer(m_error_signals_buffers, i);
+
+    // Take over the gradient w.r.t. the output tensor if it is owned
+    // by this layer. The gradient w.r.t. the output tensor becomes a
+    // view and backprop overwrites it.
+    if (m_in_place && buffer == nullptr && !m_persistent_error_signals) {
+      auto& gradient_wrt_output = m_gradient_wrt_outputs.front();
+      if (gradient_wrt_output != nullptr
+          && !gradient_wrt_output->Viewing()
+          && gradient_wrt_output->DistData() == get_prev_activations(i).DistData()) {
+        std::swap(m_gradient_wrt_inputs[i], gradient_wrt_output);
+        El::LockedView(*gradient_wrt_output, *m_gradient_wrt_inputs[i]);
+        record_setup(m_error_signals_setups, get_num_parents(), i, nullptr);
+        continue;
+      }
+    }
+
     auto& gradient_wrt_input = get_error_signals(i);
+    const auto& alignment_dist = get_prev_activations(i).DistData();
+    const bool skip = can_skip_error_signals() && !error_signals_needed(i);
+    if (!skip
+        && is_setup_current(gradient_wrt_input, m_error_signals_setups, i,
+                            alignment_dist, buffer,
+                            get_input_size(i), mini_batch_size)) {
+      continue;
+    }
     gradient_wrt_input.Empty(false);
     gradient_wrt_input.AlignWith(get_prev_activations(i));
-    gradient_wrt_input.Resize(get_input_size(i), mini_batch_size);
+    if (skip) {
+      continue;
+    }
+    if (buffer != nullptr) {
+      attach_to_buffer(gradient_wrt_input, buffer,
+                       get_input_size(i), mini_batch_size);
+    }
+    else {
+      gradient_wrt_input.Resize(get_input_size(i), mini_batch_size);
+    }
+    record_setup(m_error_signals_setups, get_num_parents(), i, &alignment_dist);
   }
 }
 
@@ -35,7 +35,7 @@ template <typename TensorDataType, typename T_io_buffer,
           data_layout T_layout, El::Device Dev>
 input_distconv_adapter<TensorDataType, T_io_buffer, T_layout, Dev>::
 input_distconv_adapter(Layer& layer): data_type_distconv_adapter<TensorDataType>(layer),
-                                      m_shuffle_required(true) {
+                                      m_shuffle_required(!dc::is_spatial_parallel_io_enabled()) {
   // Input data is only processed when its consumer layer is also
   // enabled for distconv
   for (int i = 0; i < layer.get_num_children(); ++i) {
@@ -126,15 +126,14 @@ void input_distconv_adapter<TensorDataType, T_io_buffer, T_layout, Dev>::setup_f
         make_unique<TensorHost>(shape, loc, host_tensor_dist));
 
     if (m_shuffle_required) {
-      // TODO: This is a temporary hack. Should use
-      // CUDAHostPooledAllocator, but the shuffler is
-      // only specialized for BaseAllocator.
+      // The shuffler is only specialized for BaseAllocator, so the
+      // tensor views memory leased from the pinned memory pool
       size_t buf_size = m_host_tensors.back()->get_local_real_size()
           * sizeof(TensorDataType);
-      TensorDataType *buf = nullptr;
-      CHECK_CUDA(cudaMallocHost(&buf, buf_size));
-      // Note buf should be deallocated.
-      dc::tensor::View(*m_host_tensors.back(), buf);
+      m_host_tensor_leases.emplace_back(
+        pinned_memory_pool::instance().acquire(buf_size));
+      dc::tensor::View(*m_host_tensors.back(),
+                       m_host_tensor_leases.back().data<TensorDataType>());
       setup_shuffler_buffers(*m_original_host_tensors.back(),
                              *m_host_tensors.back());
     }
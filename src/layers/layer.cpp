@@ -69,6 +69,10 @@ Layer::Layer(const Layer& other) :
   m_expected_num_child_layers(other.m_expected_num_child_layers),
   m_model(other.m_model),
   m_frozen(other.m_frozen),
+  m_recompute_activations(other.m_recompute_activations),
+  m_transfer_precision(other.m_transfer_precision),
+  m_in_place(other.m_in_place),
+  m_needs_backprop(other.m_needs_backprop),
   m_fp_time(other.m_fp_time),
   m_fp_compute_time(other.m_fp_compute_time),
   m_bp_time(other.m_bp_time),
@@ -89,6 +93,10 @@ Layer& Layer::operator=(const Layer& other) {
   m_expected_num_child_layers = other.m_expected_num_child_layers;
   m_model = other.m_model;
   m_frozen = other.m_frozen;
+  m_recompute_activations = other.m_recompute_activations;
+  m_transfer_precision = other.m_transfer_precision;
+  m_in_place = other.m_in_place;
+  m_needs_backprop = other.m_needs_backprop;
   m_fp_time = other.m_fp_time;
   m_fp_compute_time = other.m_fp_compute_time;
   m_bp_time = other.m_bp_time;
@@ -207,6 +215,11 @@ description Layer::get_description() const {
     desc.add("Frozen");
   }
 
+  // Transfer precision
+  if (m_transfer_precision == transfer_precision::half) {
+    desc.add("Transfer precision", "fp16");
+  }
+
   return desc;
 }
 
@@ -238,15 +251,20 @@ void Layer::summarize_stats(lbann_summary& summarizer, int step) {
   reset_counters();
   // Combine the optimizer step time from all the weights.
   double step_time = 0.0;
+  size_t bytes_saved = 0;
   for (auto const& w : get_weights()) {
     optimizer *opt = w->get_optimizer();
     if (opt) {
       step_time += opt->get_step_time();
+      bytes_saved += opt->get_gradient_bytes_saved();
       opt->reset_counters();
     }
   }
   summarizer.reduce_scalar(prefix + "opt_time", step_time, step);
   summarizer.reduce_scalar_all(prefix + "opt_time", step_time, step);
+  if (bytes_saved > 0) {
+    summarizer.reduce_scalar(prefix + "grad_bytes_saved", bytes_saved, step);
+  }
 }
 
 // ===================================================================
@@ -521,6 +539,14 @@ void Layer::back_prop() {
   clear_prev_error_signals_();
 }
 
+bool Layer::error_signals_needed(int parent_index) const {
+  if (parent_index < 0 || parent_index >= get_num_parents()) {
+    LBANN_ERROR("attempted to access parent ", parent_index, " ",
+                "of layer \"", get_name(), "\", ",
+                "which has ", get_num_parents(), " parents");
+  }
+  return m_parent_layers[parent_index]->needs_backprop();
+}
 
 bool Layer::save_to_checkpoint_shared(persist& p) const {
   return true;
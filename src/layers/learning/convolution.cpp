@@ -134,6 +134,34 @@ std::unique_ptr<Layer> build_convolution_layer_from_pbuf(
   return Builder::Build(comm, proto_layer);
 }
 
+template <typename TensorDataType>
+void fold_batchnorm(const El::Matrix<TensorDataType, El::Device::CPU>& kernel,
+                    const El::Matrix<TensorDataType, El::Device::CPU>* bias,
+                    TensorDataType bias_scale,
+                    const El::Matrix<TensorDataType, El::Device::CPU>& scale,
+                    const El::Matrix<TensorDataType, El::Device::CPU>& shift,
+                    const El::Matrix<TensorDataType, El::Device::CPU>& mean,
+                    const El::Matrix<TensorDataType, El::Device::CPU>& var,
+                    TensorDataType epsilon,
+                    El::Matrix<TensorDataType, El::Device::CPU>& fused_kernel,
+                    El::Matrix<TensorDataType, El::Device::CPU>& fused_bias) {
+  const El::Int height = kernel.Height();
+  const El::Int num_channels = kernel.Width();
+  fused_kernel.Resize(height, num_channels);
+  fused_bias.Resize(num_channels, 1);
+  LBANN_OMP_PARALLEL_FOR
+  for (El::Int k = 0; k < num_channels; ++k) {
+    const TensorDataType s = scale(k, 0) / El::Sqrt(var(k, 0) + epsilon);
+    for (El::Int i = 0; i < height; ++i) {
+      fused_kernel(i, k) = kernel(i, k) * s;
+    }
+    const TensorDataType b = (bias != nullptr
+                              ? bias_scale * (*bias)(k, 0)
+                              : El::TypeTraits<TensorDataType>::Zero());
+    fused_bias(k, 0) = (b - mean(k, 0)) * s + shift(k, 0);
+  }
+}
+
 // Note: This unit will also instantiate the base_convolution_layer class.
 
 #define PROTO_DEVICE(T, Device)                                            \
@@ -148,5 +176,20 @@ std::unique_ptr<Layer> build_convolution_layer_from_pbuf(
 
 
 #include "lbann/macros/instantiate_device.hpp"
+#undef PROTO_DEVICE
+
+#define PROTO(T)                                                        \
+  template void fold_batchnorm<T>(                                      \
+    const El::Matrix<T, El::Device::CPU>&,                              \
+    const El::Matrix<T, El::Device::CPU>*, T,                           \
+    const El::Matrix<T, El::Device::CPU>&,                              \
+    const El::Matrix<T, El::Device::CPU>&,                              \
+    const El::Matrix<T, El::Device::CPU>&,                              \
+    const El::Matrix<T, El::Device::CPU>&, T,                           \
+    El::Matrix<T, El::Device::CPU>&,                                    \
+    El::Matrix<T, El::Device::CPU>&)
+
+#define LBANN_INSTANTIATE_CPU_HALF
+#include "lbann/macros/instantiate.hpp"
 
 }// namespace lbann
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/layers/learning/convolution.hpp"
+#include "lbann/utils/cuda.hpp"
+
+namespace lbann {
+
+namespace {
+
+/**
+ *  Block dimensions: bsizex x 1 x 1
+ *
+ *  Grid dimensions: (height / bsizex) x num_channels x 1
+ */
+template <typename TensorDataType>
+__global__ void fold_batchnorm_kernel(size_t height,
+                                      size_t num_channels,
+                                      const TensorDataType* __restrict__ kernel,
+                                      size_t kernel_ldim,
+                                      const TensorDataType* __restrict__ bias,
+                                      TensorDataType bias_scale,
+                                      const TensorDataType* __restrict__ scale,
+                                      const TensorDataType* __restrict__ shift,
+                                      const TensorDataType* __restrict__ mean,
+                                      const TensorDataType* __restrict__ var,
+                                      TensorDataType epsilon,
+                                      TensorDataType* __restrict__ fused_kernel,
+                                      size_t fused_kernel_ldim,
+                                      TensorDataType* __restrict__ fused_bias) {
+  const size_t gidx = threadIdx.x + blockIdx.x * blockDim.x;
+  const size_t nthreadsx = blockDim.x * gridDim.x;
+  for (size_t k = blockIdx.y; k < num_channels; k += gridDim.y) {
+    const auto s = scale[k] * cuda::rsqrt(var[k] + epsilon);
+    for (size_t i = gidx; i < height; i += nthreadsx) {
+      fused_kernel[i + k*fused_kernel_ldim] = kernel[i + k*kernel_ldim] * s;
+    }
+    if (gidx == 0) {
+      const auto b = (bias != nullptr
+                      ? bias_scale * bias[k]
+                      : TensorDataType(0.f));
+      fused_bias[k] = (b - mean[k]) * s + shift[k];
+    }
+  }
+}
+
+} // namespace <anon>
+
+template <typename TensorDataType>
+void fold_batchnorm(const El::Matrix<TensorDataType, El::Device::GPU>& kernel,
+                    const El::Matrix<TensorDataType, El::Device::GPU>* bias,
+                    TensorDataType bias_scale,
+                    const El::Matrix<TensorDataType, El::Device::GPU>& scale,
+                    const El::Matrix<TensorDataType, El::Device::GPU>& shift,
+                    const El::Matrix<TensorDataType, El::Device::GPU>& mean,
+                    const El::Matrix<TensorDataType, El::Device::GPU>& var,
+                    TensorDataType epsilon,
+                    El::Matrix<TensorDataType, El::Device::GPU>& fused_kernel,
+                    El::Matrix<TensorDataType, El::Device::GPU>& fused_bias) {
+  const El::Int height = kernel.Height();
+  const El::Int num_channels = kernel.Width();
+  fused_kernel.Resize(height, num_channels);
+  fused_bias.Resize(num_channels, 1);
+  if (kernel.IsEmpty()) {
+    return;
+  }
+  constexpr size_t block_size = 256;
+  dim3 block_dims, grid_dims;
+  block_dims.x = block_size;
+  grid_dims.x = (height + block_size - 1) / block_size;
+  grid_dims.y = El::Min(num_channels, El::Int(65535));
+  fold_batchnorm_kernel<<<grid_dims, block_dims, 0, El::GPUManager::Stream()>>>(
+    height, num_channels,
+    kernel.LockedBuffer(), kernel.LDim(),
+    bias != nullptr ? bias->LockedBuffer() : nullptr,
+    bias_scale,
+    scale.LockedBuffer(),
+    shift.LockedBuffer(),
+    mean.LockedBuffer(),
+    var.LockedBuffer(),
+    epsilon,
+    fused_kernel.Buffer(), fused_kernel.LDim(),
+    fused_bias.Buffer());
+}
+
+#define PROTO(T)                                                        \
+  template void fold_batchnorm<T>(                                      \
+    const El::Matrix<T, El::Device::GPU>&,                              \
+    const El::Matrix<T, El::Device::GPU>*, T,                           \
+    const El::Matrix<T, El::Device::GPU>&,                              \
+    const El::Matrix<T, El::Device::GPU>&,                              \
+    const El::Matrix<T, El::Device::GPU>&,                              \
+    const El::Matrix<T, El::Device::GPU>&, T,                           \
+    El::Matrix<T, El::Device::GPU>&,                                    \
+    El::Matrix<T, El::Device::GPU>&)
+
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
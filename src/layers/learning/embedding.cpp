@@ -32,13 +32,22 @@ namespace lbann {
 template <typename TensorDataType, data_layout Layout, El::Device Device>
 void embedding_layer<TensorDataType,Layout,Device>::setup_matrices(const El::Grid& grid) {
   data_type_layer<TensorDataType>::setup_matrices(grid);
-  this->m_embeddings_grad.reset(new El::DistMatrix<TensorDataType, El::STAR, El::STAR, El::ELEMENT, El::Device::CPU>(grid));
+  if (this->m_sharded) {
+    this->m_embeddings_grad.reset(new El::DistMatrix<TensorDataType, El::STAR, El::VC, El::ELEMENT, El::Device::CPU>(grid));
+  } else {
+    this->m_embeddings_grad.reset(new El::DistMatrix<TensorDataType, El::STAR, El::STAR, El::ELEMENT, El::Device::CPU>(grid));
+  }
 }
 
 template <typename TensorDataType, data_layout Layout, El::Device Device>
 void embedding_layer<TensorDataType,Layout,Device>::fp_compute() {
   using MatType = El::Matrix<TensorDataType, El::Device::CPU>;
 
+  if (this->m_sharded) {
+    sharded_fp_compute();
+    return;
+  }
+
   // Local data
   const auto& local_embeddings = dynamic_cast<const MatType&>(this->get_data_type_weights(0).get_values().LockedMatrix());
   const auto& local_input = dynamic_cast<const MatType&>(this->get_local_prev_activations());
@@ -77,6 +86,15 @@ void embedding_layer<TensorDataType, Layout, Device>::bp_compute() {
   if (this->get_data_type_weights(0).get_optimizer() == nullptr) { return; }
   auto& opt = *this->get_data_type_weights(0).get_optimizer();
 
+  if (this->m_sharded) {
+    sharded_bp_compute();
+    return;
+  }
+  if (this->m_sparse_gradient) {
+    sparse_bp_compute();
+    return;
+  }
+
   // Local data
   const auto& local_input = dynamic_cast<const MatType&>(this->get_local_prev_activations());
   auto& local_embedding_grad = dynamic_cast<MatType&>(this->m_embeddings_grad->Matrix());
@@ -28,6 +28,9 @@
 #include "lbann/layers/learning/fully_connected.hpp"
 #include "layers.pb.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace lbann {
 
 template <typename TensorDataType, data_layout T_layout, El::Device Dev>
@@ -46,9 +49,222 @@ void fully_connected_layer<TensorDataType, T_layout, Dev>
   }
 }
 
+namespace {
+
+/** Largest fraction of nonzero inputs for which sparse GEMMs are
+ *  used instead of dense ones. */
+constexpr double max_sparse_input_density = 0.25;
+
+/** Local matrix of ones with @c height rows. */
+template <typename TensorDataType, El::Device Device>
+El::Matrix<TensorDataType, Device> make_ones(El::Int height) {
+  El::Matrix<TensorDataType, Device> ones;
+#ifdef HYDROGEN_HAVE_CUB
+  if (Device == El::Device::GPU) {
+    ones.SetMemoryMode(1); // Use CUB GPU memory pool if possible
+  }
+#endif // HYDROGEN_HAVE_CUB
+  ones.Resize(height, 1);
+  El::Fill(ones, El::TypeTraits<TensorDataType>::One());
+  return ones;
+}
+
+/** @brief C = op(A) * B, allreduced over the process grid columns
+ *
+ *  A and B are local blocks whose product is a partial sum. The
+ *  product is computed in column chunks and the allreduce of each
+ *  chunk is started as soon as it is available, so communication
+ *  overlaps the GEMMs of the following chunks.
+ */
+template <typename TensorDataType, El::Device Device>
+void chunked_gemm_allreduce(lbann_comm& comm,
+                            const El::mpi::Comm& grid_col_comm,
+                            El::Orientation orientation_a,
+                            const El::AbstractMatrix<TensorDataType>& A,
+                            const El::AbstractMatrix<TensorDataType>& B,
+                            El::AbstractMatrix<TensorDataType>& C,
+                            int num_chunks) {
+  const El::Int width = B.Width();
+  const El::Int chunk_size = std::max((width + num_chunks - 1) / num_chunks,
+                                      El::Int(1));
+  std::vector<Al::request> reqs;
+  for (El::Int start = 0; start < width; start += chunk_size) {
+    const El::Int end = std::min(start + chunk_size, width);
+    El::Matrix<TensorDataType, Device> B_chunk, C_chunk;
+    El::LockedView(B_chunk,
+                   static_cast<const El::Matrix<TensorDataType, Device>&>(B),
+                   El::ALL, El::IR(start, end));
+    El::View(C_chunk, static_cast<El::Matrix<TensorDataType, Device>&>(C),
+             El::ALL, El::IR(start, end));
+    El::Gemm(orientation_a, El::NORMAL,
+             El::TypeTraits<TensorDataType>::One(), A, B_chunk,
+             El::TypeTraits<TensorDataType>::Zero(), C_chunk);
+    reqs.emplace_back();
+    comm.nb_allreduce(C_chunk, grid_col_comm, reqs.back());
+  }
+  for (auto& req : reqs) {
+    comm.wait(req);
+  }
+}
+
+} // namespace
+
+/** Forward prop of tensor-parallel layers.
+ *
+ *  Column-parallel layers gather the input features and multiply
+ *  them with their rows of the linearity. Row-parallel layers
+ *  multiply their input features with their columns of the linearity
+ *  and allreduce the partial sums.
+ */
+template <typename TensorDataType, El::Device Device>
+void fp_compute_tensor_parallel(fully_connected_layer<TensorDataType, data_layout::MODEL_PARALLEL, Device>& l) {
+  using StarMRMatType
+    = El::DistMatrix<TensorDataType, El::STAR, El::MR, El::ELEMENT, Device>;
+
+  // Matrices
+  const auto& input = l.get_prev_activations();
+  auto& output = l.get_activations();
+  const auto& local_linearity = l.get_data_type_weights(0).get_values().LockedMatrix();
+  const auto orientation = l.m_transpose ? El::TRANSPOSE : El::NORMAL;
+
+  if (l.m_tensor_parallel == fully_connected_tensor_parallel::COLUMN) {
+    // Gather input features (kept for backprop)
+    if (l.m_tensor_parallel_input == nullptr) {
+      l.m_tensor_parallel_input.reset(new StarMRMatType(input.Grid(), input.Root()));
+    }
+    auto& full_input = *l.m_tensor_parallel_input;
+    full_input.AlignRowsWith(input.DistData());
+    El::Copy(input, full_input);
+    El::Gemm(orientation, El::NORMAL,
+             El::TypeTraits<TensorDataType>::One(), local_linearity,
+             full_input.LockedMatrix(),
+             El::TypeTraits<TensorDataType>::Zero(), output.Matrix());
+  } else {
+    // Allreduce partial sums, then keep local output features
+    StarMRMatType full_output(output.Grid(), output.Root());
+    full_output.AlignRowsWith(output.DistData());
+    full_output.Resize(output.Height(), output.Width());
+    chunked_gemm_allreduce<TensorDataType, Device>(
+      *l.get_comm(), output.Grid().ColComm(), orientation,
+      local_linearity, input.LockedMatrix(), full_output.Matrix(),
+      l.m_tensor_parallel_chunks);
+    El::Copy(full_output, output);
+  }
+
+  // Apply bias if needed
+  // Note: bias is distributed like the output features
+  if (l.m_bias_scaling_factor != El::TypeTraits<TensorDataType>::Zero()) {
+    const auto& bias = l.get_data_type_weights(1).get_values();
+    auto ones = make_ones<TensorDataType, Device>(output.LocalWidth());
+    El::Gemm(El::NORMAL, El::TRANSPOSE,
+             l.m_bias_scaling_factor, bias.LockedMatrix(), ones,
+             El::TypeTraits<TensorDataType>::One(), output.Matrix());
+  }
+
+}
+
+/** Backward prop of tensor-parallel layers.
+ *
+ *  The mirror image of forward prop: column-parallel layers allreduce
+ *  partial sums of the input gradient and row-parallel layers gather
+ *  the features of the output gradient.
+ */
+template <typename TensorDataType, El::Device Device>
+void bp_compute_tensor_parallel(fully_connected_layer<TensorDataType, data_layout::MODEL_PARALLEL, Device>& l) {
+  using StarMRMatType
+    = El::DistMatrix<TensorDataType, El::STAR, El::MR, El::ELEMENT, Device>;
+  const auto one = El::TypeTraits<TensorDataType>::One();
+  const auto zero = El::TypeTraits<TensorDataType>::Zero();
+  const bool column = (l.m_tensor_parallel == fully_connected_tensor_parallel::COLUMN);
+
+  // Matrices
+  const auto& local_linearity = l.get_data_type_weights(0).get_values().LockedMatrix();
+  const auto& input = l.get_prev_activations();
+  const auto& gradient_wrt_output = l.get_prev_error_signals();
+  auto& gradient_wrt_input = l.get_error_signals();
+  const auto& local_gradient_wrt_output = gradient_wrt_output.LockedMatrix();
+
+  // Input and output gradient blocks that match the local linearity
+  StarMRMatType full_gradient_wrt_output(gradient_wrt_output.Grid(),
+                                         gradient_wrt_output.Root());
+  if (!column) {
+    full_gradient_wrt_output.AlignRowsWith(gradient_wrt_output.DistData());
+    El::Copy(gradient_wrt_output, full_gradient_wrt_output);
+  }
+  const auto& linearity_input = (column
+                                 ? l.m_tensor_parallel_input->LockedMatrix()
+                                 : input.LockedMatrix());
+  const auto& linearity_gradient_wrt_output = (column
+                                               ? local_gradient_wrt_output
+                                               : full_gradient_wrt_output.LockedMatrix());
+
+  // Compute gradient w.r.t. bias if needed
+  // Note: bias is distributed like the output features
+  if (l.m_bias_scaling_factor != zero) {
+    auto* bias_optimizer = l.get_data_type_weights(1).get_optimizer();
+    if (bias_optimizer != nullptr) {
+      TensorDataType dst_scale = zero, gradient_scale = zero;
+      auto& bias_gradient = bias_optimizer->get_gradient_buffer(
+        dst_scale, gradient_scale, true);
+      if (local_gradient_wrt_output.Height() < 1
+          || local_gradient_wrt_output.Width() < 1) {
+        El::Scale(dst_scale, bias_gradient);
+      } else {
+        auto ones = make_ones<TensorDataType, Device>(local_gradient_wrt_output.Width());
+        El::Gemv(El::NORMAL,
+                 gradient_scale, local_gradient_wrt_output, ones,
+                 dst_scale, bias_gradient.Matrix());
+      }
+    }
+  }
+
+  // Compute gradient w.r.t. linearity if needed
+  // Note: the local blocks are allreduced by the optimizer
+  auto* linearity_optimizer = l.get_data_type_weights(0).get_optimizer();
+  if (linearity_optimizer != nullptr) {
+    TensorDataType dst_scale = zero, gradient_scale = zero;
+    auto& linearity_gradient = linearity_optimizer->get_gradient_buffer(
+      dst_scale, gradient_scale, true);
+    if (l.m_transpose) {
+      El::Gemm(El::NORMAL, El::TRANSPOSE,
+               gradient_scale, linearity_input, linearity_gradient_wrt_output,
+               dst_scale, linearity_gradient.Matrix());
+    } else {
+      El::Gemm(El::NORMAL, El::TRANSPOSE,
+               gradient_scale, linearity_gradient_wrt_output, linearity_input,
+               dst_scale, linearity_gradient.Matrix());
+    }
+  }
+
+  // Compute gradient w.r.t. input if needed
+  if (!l.error_signals_needed()) { return; }
+  const auto orientation = l.m_transpose ? El::NORMAL : El::TRANSPOSE;
+  if (column) {
+    StarMRMatType full_gradient_wrt_input(gradient_wrt_input.Grid(),
+                                          gradient_wrt_input.Root());
+    full_gradient_wrt_input.AlignRowsWith(gradient_wrt_input.DistData());
+    full_gradient_wrt_input.Resize(gradient_wrt_input.Height(),
+                                   gradient_wrt_input.Width());
+    chunked_gemm_allreduce<TensorDataType, Device>(
+      *l.get_comm(), gradient_wrt_input.Grid().ColComm(), orientation,
+      local_linearity, local_gradient_wrt_output,
+      full_gradient_wrt_input.Matrix(), l.m_tensor_parallel_chunks);
+    El::Copy(full_gradient_wrt_input, gradient_wrt_input);
+  } else {
+    El::Gemm(orientation, El::NORMAL,
+             one, local_linearity, full_gradient_wrt_output.LockedMatrix(),
+             zero, gradient_wrt_input.Matrix());
+  }
+
+}
+
 /** CPU implementation of forward prop computation. */
 template <typename TensorDataType>
 void fp_compute_impl(fully_connected_layer<TensorDataType, data_layout::MODEL_PARALLEL, El::Device::CPU>& l) {
+  if (l.m_tensor_parallel != fully_connected_tensor_parallel::NONE) {
+    fp_compute_tensor_parallel(l);
+    return;
+  }
 
   // Matrices
   const auto& input = l.get_prev_activations();
@@ -86,6 +302,10 @@ void fp_compute_impl(fully_connected_layer<TensorDataType, data_layout::MODEL_PA
 /** CPU implementation of backward prop computation. */
 template <typename TensorDataType>
 void bp_compute_impl(fully_connected_layer<TensorDataType, data_layout::MODEL_PARALLEL, El::Device::CPU>& l) {
+  if (l.m_tensor_parallel != fully_connected_tensor_parallel::NONE) {
+    bp_compute_tensor_parallel(l);
+    return;
+  }
 
   // Matrices
   const auto& linearity = l.get_data_type_weights(0).get_values();
@@ -142,7 +362,8 @@ void bp_compute_impl(fully_connected_layer<TensorDataType, data_layout::MODEL_PA
     }
   }
 
-  // Compute gradient w.r.t. input
+  // Compute gradient w.r.t. input if needed
+  if (!l.error_signals_needed()) { return; }
   // Note: Perform GEMMs independently if possible
   if (linearity.DistSize() == 1) {
     El::Gemm(l.m_transpose ? El::NORMAL : El::TRANSPOSE,
@@ -166,12 +387,31 @@ void fp_compute_impl(fully_connected_layer<TensorDataType, data_layout::DATA_PAR
   const auto& local_input = l.get_local_prev_activations();
   auto& local_output = l.get_local_activations();
 
+  // Compress input if it is sparse
+  l.m_use_sparse_local_input = false;
+  if (l.m_sparse_input) {
+    compress_mini_batch(
+      dynamic_cast<const CPUMatDT<TensorDataType>&>(local_input),
+      l.m_sparse_local_input);
+    l.m_use_sparse_local_input
+      = (l.m_sparse_local_input.density() <= max_sparse_input_density);
+  }
+
   // Apply linearity
   const auto& local_linearity = l.get_data_type_weights(0).get_values().LockedMatrix();
-  El::Gemm(l.m_transpose ? El::TRANSPOSE : El::NORMAL,
-           El::NORMAL,
-           El::TypeTraits<TensorDataType>::One(), local_linearity, local_input,
-           El::TypeTraits<TensorDataType>::Zero(), local_output);
+  if (l.m_use_sparse_local_input) {
+    sparse_gemm(l.m_transpose ? El::TRANSPOSE : El::NORMAL,
+                El::TypeTraits<TensorDataType>::One(),
+                dynamic_cast<const CPUMatDT<TensorDataType>&>(local_linearity),
+                l.m_sparse_local_input,
+                El::TypeTraits<TensorDataType>::Zero(),
+                dynamic_cast<CPUMatDT<TensorDataType>&>(local_output));
+  } else {
+    El::Gemm(l.m_transpose ? El::TRANSPOSE : El::NORMAL,
+             El::NORMAL,
+             El::TypeTraits<TensorDataType>::One(), local_linearity, local_input,
+             El::TypeTraits<TensorDataType>::Zero(), local_output);
+  }
 
   // Apply bias if needed
   if(l.m_bias_scaling_factor != El::TypeTraits<TensorDataType>::Zero()) {
@@ -215,7 +455,15 @@ void bp_compute_impl(fully_connected_layer<TensorDataType, data_layout::DATA_PAR
     TensorDataType dst_scale = El::TypeTraits<TensorDataType>::Zero(), gradient_scale = El::TypeTraits<TensorDataType>::Zero();
     auto& linearity_gradient = linearity_optimizer->get_gradient_buffer(
       dst_scale, gradient_scale, true);
-    if (l.m_transpose) {
+    if (l.m_use_sparse_local_input) {
+      sparse_gemm_gradient(
+        l.m_transpose,
+        gradient_scale,
+        dynamic_cast<const CPUMatDT<TensorDataType>&>(local_gradient_wrt_output),
+        l.m_sparse_local_input,
+        dst_scale,
+        dynamic_cast<CPUMatDT<TensorDataType>&>(linearity_gradient.Matrix()));
+    } else if (l.m_transpose) {
       El::Gemm(El::NORMAL, El::TRANSPOSE,
                gradient_scale, local_input, local_gradient_wrt_output,
                dst_scale, linearity_gradient.Matrix());
@@ -226,7 +474,8 @@ void bp_compute_impl(fully_connected_layer<TensorDataType, data_layout::DATA_PAR
     }
   }
 
-  // Compute gradient w.r.t. input
+  // Compute gradient w.r.t. input if needed
+  if (!l.error_signals_needed()) { return; }
   El::Gemm(l.m_transpose ? El::NORMAL : El::TRANSPOSE,
            El::NORMAL,
            El::TypeTraits<TensorDataType>::One(), local_linearity, local_gradient_wrt_output,
@@ -317,7 +566,8 @@ void bp_compute_impl(fully_connected_layer<TensorDataType, data_layout::DATA_PAR
     }
   }
 
-  // Compute gradient w.r.t. input
+  // Compute gradient w.r.t. input if needed
+  if (!l.error_signals_needed()) { return; }
   El::Gemm(l.m_transpose ? El::NORMAL : El::TRANSPOSE,
            El::NORMAL,
            El::TypeTraits<TensorDataType>::One(), local_linearity, local_gradient_wrt_output,
@@ -327,6 +577,10 @@ void bp_compute_impl(fully_connected_layer<TensorDataType, data_layout::DATA_PAR
 
 template <typename TensorDataType>
 void fp_compute_impl(fully_connected_layer<TensorDataType, data_layout::MODEL_PARALLEL, El::Device::GPU>& l) {
+  if (l.m_tensor_parallel != fully_connected_tensor_parallel::NONE) {
+    fp_compute_tensor_parallel(l);
+    return;
+  }
 
   // Matrices
   const auto& input = l.get_prev_activations();
@@ -366,6 +620,10 @@ void fp_compute_impl(fully_connected_layer<TensorDataType, data_layout::MODEL_PA
 
 template <typename TensorDataType>
 void bp_compute_impl(fully_connected_layer<TensorDataType, data_layout::MODEL_PARALLEL, El::Device::GPU>& l) {
+  if (l.m_tensor_parallel != fully_connected_tensor_parallel::NONE) {
+    bp_compute_tensor_parallel(l);
+    return;
+  }
 
   // Matrices
   const auto& linearity = l.get_data_type_weights(0).get_values();
@@ -434,7 +692,8 @@ void bp_compute_impl(fully_connected_layer<TensorDataType, data_layout::MODEL_PA
     }
   }
 
-  // Compute gradient w.r.t. input
+  // Compute gradient w.r.t. input if needed
+  if (!l.error_signals_needed()) { return; }
   // Note: Perform GEMMs independently if possible
   if (linearity.DistSize() == 1) {
     El::Gemm(l.m_transpose ? El::NORMAL : El::TRANSPOSE,
@@ -467,12 +726,25 @@ std::unique_ptr<Layer> build_fully_connected_layer_from_pbuf(
   lbann_comm* comm, lbann_data::Layer const& layer_msg)
 {
   const auto& params = layer_msg.fully_connected();
+  auto tensor_parallel = fully_connected_tensor_parallel::NONE;
+  if (params.tensor_parallel() == "column") {
+    tensor_parallel = fully_connected_tensor_parallel::COLUMN;
+  } else if (params.tensor_parallel() == "row") {
+    tensor_parallel = fully_connected_tensor_parallel::ROW;
+  } else if (!params.tensor_parallel().empty()) {
+    LBANN_ERROR("invalid tensor-parallel mode \"", params.tensor_parallel(),
+                "\" for fully-connected layer \"", layer_msg.name(),
+                "\" (expected \"column\" or \"row\")");
+  }
   return lbann::make_unique<fully_connected_layer<TensorDataType, layout, device>>(
     comm,
     params.num_neurons(),
     params.transpose(),
     nullptr,
-    params.has_bias());
+    params.has_bias(),
+    tensor_parallel,
+    params.tensor_parallel_chunks() > 0 ? params.tensor_parallel_chunks() : 4,
+    params.sparse_input());
 }
 
 #define PROTO_DEVICE(T, Device) \
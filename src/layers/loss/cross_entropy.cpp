@@ -28,6 +28,9 @@
 #include "lbann/layers/loss/cross_entropy.hpp"
 #include "lbann/utils/exception.hpp"
 
+#include <cmath>
+#include <limits>
+
 namespace lbann {
 
 namespace {
@@ -89,8 +92,132 @@ void local_bp_cpu(const El::AbstractMatrix<TensorDataType>& local_prediction,
 
 }
 
+template <typename TensorDataType>
+void local_fp_logits_stats_cpu(const El::AbstractMatrix<TensorDataType>& local_logits,
+                               const El::AbstractMatrix<TensorDataType>& local_ground_truth,
+                               El::AbstractMatrix<TensorDataType>& local_max,
+                               El::AbstractMatrix<TensorDataType>& local_stats) {
+
+  // Useful constants
+  const TensorDataType zero = El::TypeTraits<TensorDataType>::Zero();
+  const TensorDataType one = El::TypeTraits<TensorDataType>::One();
+  const TensorDataType neg_inf = -std::numeric_limits<TensorDataType>::infinity();
+  const El::Int local_height = local_logits.Height();
+  const El::Int local_width = local_logits.Width();
+
+  // Online log-sum-exp and ground truth sums in one sweep
+  LBANN_OMP_PARALLEL_FOR
+  for (El::Int col = 0; col < local_width; ++col) {
+    TensorDataType max_x = neg_inf, sum_exp = zero;
+    TensorDataType sum_y = zero, sum_yx = zero;
+    for (El::Int row = 0; row < local_height; ++row) {
+      const auto& x = local_logits(row, col);
+      const auto& y = local_ground_truth(row, col);
+      if (x > max_x) {
+        sum_exp = sum_exp * std::exp(max_x - x) + one;
+        max_x = x;
+      }
+      else {
+        sum_exp += std::exp(x - max_x);
+      }
+      sum_y += y;
+      sum_yx += y * x;
+    }
+    local_max(0, col) = max_x;
+    local_stats(0, col) = (local_height > 0
+                           ? max_x + std::log(sum_exp)
+                           : neg_inf);
+    local_stats(1, col) = sum_y;
+    local_stats(2, col) = sum_yx;
+  }
+
+}
+
+template <typename TensorDataType>
+void local_fp_logits_rescale_cpu(const El::AbstractMatrix<TensorDataType>& global_max,
+                                 El::AbstractMatrix<TensorDataType>& local_stats) {
+  const TensorDataType zero = El::TypeTraits<TensorDataType>::Zero();
+  const El::Int local_width = local_stats.Width();
+  LBANN_OMP_PARALLEL_FOR
+  for (El::Int col = 0; col < local_width; ++col) {
+    const auto& lse = local_stats(0, col);
+    local_stats(0, col) = (std::isinf(lse)
+                           ? zero
+                           : std::exp(lse - global_max(0, col)));
+  }
+}
+
+template <typename TensorDataType>
+void local_fp_logits_finalize_cpu(const El::AbstractMatrix<TensorDataType>& global_max,
+                                  El::AbstractMatrix<TensorDataType>& stats,
+                                  El::AbstractMatrix<TensorDataType>& contribution) {
+  const El::Int local_width = stats.Width();
+  LBANN_OMP_PARALLEL_FOR
+  for (El::Int col = 0; col < local_width; ++col) {
+    const auto log_partition = global_max(0, col) + std::log(stats(0, col));
+    stats(0, col) = log_partition;
+    contribution(0, col) = log_partition * stats(1, col) - stats(2, col);
+  }
+}
+
+template <typename TensorDataType>
+void local_bp_logits_cpu(const El::AbstractMatrix<TensorDataType>& local_logits,
+                         const El::AbstractMatrix<TensorDataType>& local_ground_truth,
+                         const El::AbstractMatrix<TensorDataType>& local_gradient_wrt_output,
+                         const El::AbstractMatrix<TensorDataType>& stats,
+                         El::AbstractMatrix<TensorDataType>& local_gradient_wrt_logits,
+                         El::AbstractMatrix<TensorDataType>& local_gradient_wrt_ground_truth) {
+
+  // Useful constants
+  const El::Int local_height = local_logits.Height();
+  const El::Int local_width = local_logits.Width();
+
+  // Compute gradients
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (El::Int col = 0; col < local_width; ++col) {
+    for (El::Int row = 0; row < local_height; ++row) {
+      const auto& x = local_logits(row, col);
+      const auto& y = local_ground_truth(row, col);
+      const auto& dy = local_gradient_wrt_output(0, col);
+      const auto& log_partition = stats(0, col);
+      const auto& sum_y = stats(1, col);
+      local_gradient_wrt_logits(row, col)
+        = dy * (std::exp(x - log_partition) * sum_y - y);
+      local_gradient_wrt_ground_truth(row, col) = - dy * (x - log_partition);
+    }
+  }
+
+}
+
 } // namespace
 
+template <typename TensorDataType, data_layout T_layout, El::Device Dev>
+void cross_entropy_layer<TensorDataType, T_layout, Dev>::local_fp_logits_compute() {
+  auto& comm = *this->get_comm();
+  auto& max_x = *this->m_workspace;
+  auto& stats = *this->m_logits_workspace;
+  local_fp_logits_stats_cpu(this->get_local_prev_activations(0),
+                            this->get_local_prev_activations(1),
+                            max_x.Matrix(),
+                            stats.Matrix());
+  comm.allreduce(max_x, max_x.RedundantComm(), El::mpi::MAX);
+  local_fp_logits_rescale_cpu(max_x.LockedMatrix(), stats.Matrix());
+  comm.allreduce(stats, stats.RedundantComm());
+  local_fp_logits_finalize_cpu(max_x.LockedMatrix(),
+                               stats.Matrix(),
+                               max_x.Matrix());
+}
+
+template <typename TensorDataType, data_layout T_layout, El::Device Dev>
+void cross_entropy_layer<TensorDataType, T_layout, Dev>::local_bp_logits_compute() {
+  local_bp_logits_cpu(this->get_local_prev_activations(0),
+                      this->get_local_prev_activations(1),
+                      this->m_workspace->LockedMatrix(),
+                      this->m_logits_workspace->LockedMatrix(),
+                      this->get_local_error_signals(0),
+                      this->get_local_error_signals(1));
+}
+
 template <typename TensorDataType, data_layout T_layout, El::Device Dev>
 void cross_entropy_layer<TensorDataType, T_layout, Dev>::local_fp_compute() {
   local_fp_cpu(this->get_local_prev_activations(0),
@@ -29,6 +29,8 @@
 #include "lbann/utils/exception.hpp"
 #include "math.h"
 
+#include <limits>
+
 namespace lbann {
 
 namespace {
@@ -161,8 +163,246 @@ void local_bp_gpu(const El::AbstractMatrix<TensorDataType>& local_prediction,
   }
 }
 
+/** @brief Column statistics of logits.
+ *
+ *  Each block handles one column and merges per-thread running
+ *  maxima and rescaled exponential sums in shared memory, so the
+ *  logits are only read once.
+ */
+template <int block_size, typename TensorDataType>
+__global__ void fp_logits_stats_kernel(int height, int width,
+                                       const TensorDataType* __restrict__ logits,
+                                       int logits_ldim,
+                                       const TensorDataType* __restrict__ ground_truth,
+                                       int ground_truth_ldim,
+                                       TensorDataType* __restrict__ local_max,
+                                       TensorDataType* __restrict__ stats,
+                                       int stats_ldim) {
+
+  // Indices
+  const int tid = threadIdx.x;
+  const int bidy = blockIdx.y;
+
+  __shared__ TensorDataType shared_max[block_size];
+  __shared__ TensorDataType shared_sum_exp[block_size];
+  __shared__ TensorDataType shared_sum_y[block_size];
+  __shared__ TensorDataType shared_sum_yx[block_size];
+
+  for (int col = bidy; col < width; col += gridDim.y) {
+
+    // Online log-sum-exp for each thread
+    auto max_x = -cuda::infinity<TensorDataType>();
+    auto sum_exp = TensorDataType(0.);
+    auto sum_y = TensorDataType(0.);
+    auto sum_yx = TensorDataType(0.);
+    for (int row = tid; row < height; row += block_size) {
+      const auto& x = logits[row + col * logits_ldim];
+      const auto& y = ground_truth[row + col * ground_truth_ldim];
+      if (x > max_x) {
+        sum_exp = sum_exp * cuda::exp(max_x - x) + TensorDataType(1.);
+        max_x = x;
+      }
+      else {
+        sum_exp += cuda::exp(x - max_x);
+      }
+      sum_y += y;
+      sum_yx += y * x;
+    }
+
+    // Shared memory reduction
+    shared_max[tid] = max_x;
+    shared_sum_exp[tid] = sum_exp;
+    shared_sum_y[tid] = sum_y;
+    shared_sum_yx[tid] = sum_yx;
+    for (int stride = block_size / 2; stride > 0; stride /= 2) {
+      __syncthreads();
+      if (tid < stride) {
+        const auto& max_a = shared_max[tid];
+        const auto& max_b = shared_max[tid + stride];
+        const auto new_max = cuda::max(max_a, max_b);
+        if (new_max > -cuda::infinity<TensorDataType>()) {
+          shared_sum_exp[tid]
+            = (shared_sum_exp[tid] * cuda::exp(max_a - new_max)
+               + shared_sum_exp[tid + stride] * cuda::exp(max_b - new_max));
+        }
+        shared_max[tid] = new_max;
+        shared_sum_y[tid] += shared_sum_y[tid + stride];
+        shared_sum_yx[tid] += shared_sum_yx[tid + stride];
+      }
+    }
+    if (tid == 0) {
+      const auto& max_col = shared_max[0];
+      local_max[col] = max_col;
+      stats[0 + col * stats_ldim]
+        = (shared_sum_exp[0] > TensorDataType(0.)
+           ? max_col + cuda::log(shared_sum_exp[0])
+           : -cuda::infinity<TensorDataType>());
+      stats[1 + col * stats_ldim] = shared_sum_y[0];
+      stats[2 + col * stats_ldim] = shared_sum_yx[0];
+    }
+    __syncthreads();
+
+  }
+
+}
+
+/** Rescale local partition function by global maximum. */
+template <typename TensorDataType>
+__global__ void fp_logits_rescale_kernel(int width,
+                                         const TensorDataType* __restrict__ global_max,
+                                         TensorDataType* __restrict__ stats,
+                                         int stats_ldim) {
+  const int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const int nthreads = blockDim.x * gridDim.x;
+  for (int col = gid; col < width; col += nthreads) {
+    auto& lse = stats[col * stats_ldim];
+    lse = (lse > -cuda::infinity<TensorDataType>()
+           ? cuda::exp(lse - global_max[col])
+           : TensorDataType(0.));
+  }
+}
+
+/** Compute log-partition function and loss. */
+template <typename TensorDataType>
+__global__ void fp_logits_finalize_kernel(int width,
+                                          const TensorDataType* __restrict__ global_max,
+                                          TensorDataType* __restrict__ stats,
+                                          int stats_ldim,
+                                          TensorDataType* __restrict__ contribution) {
+  const int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const int nthreads = blockDim.x * gridDim.x;
+  for (int col = gid; col < width; col += nthreads) {
+    const auto log_partition = global_max[col] + cuda::log(stats[col * stats_ldim]);
+    stats[col * stats_ldim] = log_partition;
+    contribution[col] = (log_partition * stats[1 + col * stats_ldim]
+                         - stats[2 + col * stats_ldim]);
+  }
+}
+
+template <int block_size, typename TensorDataType>
+__global__ void bp_logits_kernel(int height, int width,
+                                 const TensorDataType* __restrict__ logits,
+                                 int logits_ldim,
+                                 const TensorDataType* __restrict__ ground_truth,
+                                 int ground_truth_ldim,
+                                 const TensorDataType* __restrict__ gradient_wrt_output,
+                                 const TensorDataType* __restrict__ stats,
+                                 int stats_ldim,
+                                 TensorDataType* __restrict__ gradient_wrt_logits,
+                                 int gradient_wrt_logits_ldim,
+                                 TensorDataType* __restrict__ gradient_wrt_ground_truth,
+                                 int gradient_wrt_ground_truth_ldim) {
+
+  // Indices
+  const int gidx = threadIdx.x + blockIdx.x * blockDim.x;
+  const int bidy = blockIdx.y;
+  const int nthreadsx = blockDim.x * gridDim.x;
+
+  // Compute gradients
+  for (int col = bidy; col < width; col += gridDim.y) {
+    const auto& dy = gradient_wrt_output[col];
+    const auto& log_partition = stats[col * stats_ldim];
+    const auto& sum_y = stats[1 + col * stats_ldim];
+    for (int row = gidx; row < height; row += nthreadsx) {
+      const auto& x = logits[row + col * logits_ldim];
+      const auto& y = ground_truth[row + col * ground_truth_ldim];
+      auto& dx = gradient_wrt_logits[row + col * gradient_wrt_logits_ldim];
+      auto& dy_gt = gradient_wrt_ground_truth[row + col * gradient_wrt_ground_truth_ldim];
+      dx = dy * (cuda::exp(x - log_partition) * sum_y - y);
+      dy_gt = - dy * (x - log_partition);
+    }
+  }
+
+}
+
 } // namespace
 
+template <typename TensorDataType, data_layout T_layout, El::Device Dev>
+void cross_entropy_layer<TensorDataType, T_layout, Dev>::local_fp_logits_compute() {
+
+  // Local matrices
+  auto& comm = *this->get_comm();
+  auto& max_x = *this->m_workspace;
+  auto& stats = *this->m_logits_workspace;
+  const auto& local_logits = this->get_local_prev_activations(0);
+  const auto& local_ground_truth = this->get_local_prev_activations(1);
+  auto& local_max = max_x.Matrix();
+  auto& local_stats = stats.Matrix();
+  const auto& height = local_logits.Height();
+  const auto& width = local_logits.Width();
+  if (width <= 0) { return; }
+  CHECK_CUDA(cudaSetDevice(El::GPUManager::Device()));
+  auto&& stream = El::GPUManager::Stream();
+
+  // Local statistics
+  if (height > 0) {
+    const int block_size = 256;
+    dim3 block_dims, grid_dims;
+    block_dims.x = block_size;
+    grid_dims.y = width;
+    fp_logits_stats_kernel<block_size>
+      <<<grid_dims, block_dims, 0, stream>>>(
+        height, width,
+        local_logits.LockedBuffer(), local_logits.LDim(),
+        local_ground_truth.LockedBuffer(), local_ground_truth.LDim(),
+        local_max.Buffer(),
+        local_stats.Buffer(), local_stats.LDim());
+  }
+  else {
+    El::Fill(local_max, -std::numeric_limits<TensorDataType>::infinity());
+    El::Fill(local_stats, -std::numeric_limits<TensorDataType>::infinity());
+    auto&& sums = El::View(local_stats, El::IR(1, 3), El::ALL);
+    El::Zero(sums);
+  }
+
+  // Combine statistics across processes
+  const int block_size = 256;
+  dim3 block_dims, grid_dims;
+  block_dims.x = block_size;
+  grid_dims.x = (width + block_size - 1) / block_size;
+  comm.allreduce(max_x, max_x.RedundantComm(), El::mpi::MAX);
+  fp_logits_rescale_kernel<<<grid_dims, block_dims, 0, stream>>>(
+    width, local_max.LockedBuffer(),
+    local_stats.Buffer(), local_stats.LDim());
+  comm.allreduce(stats, stats.RedundantComm());
+  fp_logits_finalize_kernel<<<grid_dims, block_dims, 0, stream>>>(
+    width, local_max.LockedBuffer(),
+    local_stats.Buffer(), local_stats.LDim(),
+    local_max.Buffer());
+
+}
+
+template <typename TensorDataType, data_layout T_layout, El::Device Dev>
+void cross_entropy_layer<TensorDataType, T_layout, Dev>::local_bp_logits_compute() {
+  const auto& local_logits = this->get_local_prev_activations(0);
+  const auto& local_ground_truth = this->get_local_prev_activations(1);
+  const auto& local_gradient_wrt_output = this->m_workspace->LockedMatrix();
+  const auto& local_stats = this->m_logits_workspace->LockedMatrix();
+  auto& local_gradient_wrt_logits = this->get_local_error_signals(0);
+  auto& local_gradient_wrt_ground_truth = this->get_local_error_signals(1);
+  const auto& height = local_logits.Height();
+  const auto& width = local_logits.Width();
+  if (height > 0 && width > 0) {
+    const int block_size = 256;
+    dim3 block_dims, grid_dims;
+    block_dims.x = block_size;
+    grid_dims.x = (height + block_size - 1) / block_size;
+    grid_dims.y = width;
+    CHECK_CUDA(cudaSetDevice(El::GPUManager::Device()));
+    bp_logits_kernel<block_size>
+      <<<grid_dims, block_dims, 0, El::GPUManager::Stream()>>>(
+        height, width,
+        local_logits.LockedBuffer(), local_logits.LDim(),
+        local_ground_truth.LockedBuffer(), local_ground_truth.LDim(),
+        local_gradient_wrt_output.LockedBuffer(),
+        local_stats.LockedBuffer(), local_stats.LDim(),
+        local_gradient_wrt_logits.Buffer(),
+        local_gradient_wrt_logits.LDim(),
+        local_gradient_wrt_ground_truth.Buffer(),
+        local_gradient_wrt_ground_truth.LDim());
+  }
+}
+
 template <typename TensorDataType, data_layout T_layout, El::Device Dev>
 void cross_entropy_layer<TensorDataType, T_layout, Dev>::local_fp_compute() {
   local_fp_gpu(this->get_local_prev_activations(0),
@@ -28,91 +28,12 @@
 #include "lbann/layers/loss/top_k_categorical_accuracy.hpp"
 #include "lbann/utils/cuda.hpp"
 #include "lbann/utils/exception.hpp"
-
-#include <thrust/sort.h>
-#include <thrust/iterator/discard_iterator.h>
+#include "lbann/utils/top_k.hpp"
 
 namespace lbann {
 
 namespace {
 
-/** Sparse vector entry. */
-template <typename TensorDataType>
-struct entry {
-  /** Vector entry value. */
-  TensorDataType value;
-  /** Vector entry index. */
-  El::Int index;
-};
-
-/** Comparison operation to sort sparse vector entries.
- *  Entries are sorted by value in decreasing order, with ties broken
- *  in favor of entries with smaller indices.
- */
-template <typename TensorDataType>
-struct entry_compare : ::thrust::binary_function<entry<TensorDataType>,entry<TensorDataType>,bool> {
-  __host__ __device__ bool operator()(const entry<TensorDataType>& a, const entry<TensorDataType>& b) const {
-    return a.value > b.value || (a.value == b.value && a.index < b.index);
-  }
-};
-
-/** Convert columns of a dense matrix into sparse vectors.
- *  The matrix and vectors are both distributed, so entry indices in
- *  the sparse vectors correspond to global row indices in the dense
- *  matrix.
- */
-template <typename TensorDataType>
-__global__ void dense_matrix_to_sparse_vectors(El::Int local_vector_size,
-                                               El::Int local_matrix_height,
-                                               El::Int local_matrix_width,
-                                               El::Int global_matrix_height,
-                                               El::Int global_matrix_col_shift,
-                                               El::Int global_matrix_col_stride,
-                                               const TensorDataType* __restrict__ local_matrix,
-                                               El::Int local_matrix_ldim,
-                                               entry<TensorDataType>* __restrict__ local_entries,
-                                               El::Int local_entries_ldim) {
-  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
-  const El::Int num_threads = blockDim.x * gridDim.x;
-  const El::Int num_local_entries = local_vector_size * local_matrix_width;
-  for (El::Int i = gid; i < num_local_entries; i += num_threads) {
-    const auto& local_row = i % local_vector_size;
-    const auto& local_col = i / local_vector_size;
-    auto& current_entry = local_entries[local_row + local_col * local_entries_ldim];
-    if (local_row < local_matrix_height) {
-      const auto& global_row = (global_matrix_col_shift
-                                + local_row * global_matrix_col_stride);
-      current_entry.value = local_matrix[local_row + local_col * local_matrix_ldim];
-      current_entry.index = global_row;
-    } else {
-      current_entry.value = -cuda::infinity<TensorDataType>();
-      current_entry.index = global_matrix_height;
-    }
-  }
-}
-
-/** Fill an array with a corresponding tensor index.
- *  Consider a d(1) x d(2) x ... x d(n) tensor with entry indices
- *  denoted with (i(1), ..., i(n)). This tensor is contiguous in
- *  memory with d(1) as the most major dimension and d(n) as the most
- *  minor (e.g. d(1) is the width and d(2) is the height for a
- *  column-major matrix). Given some k, this kernel sets each entry in
- *  the tensor to i(k). Using this notation:
- *    tensor_size = d(1) * ... * d(n)
- *    dim         = d(k)
- *    dim_stride  = d(k+1) * ... * d(n)
- */
-__global__ void fill_with_tensor_index(El::Int tensor_size,
-                                       El::Int dim,
-                                       El::Int dim_stride,
-                                       El::Int* tensor) {
-  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
-  const El::Int num_threads = blockDim.x * gridDim.x;
-  for (El::Int i = gid; i < tensor_size; i += num_threads) {
-    tensor[i] = (i / dim_stride) % dim;
-  }
-}
-
 /** Get indices corresponding to one-hot matrix.
  *  Each column of the input matrix is interpreted as a one-hot
  *  vector. Note that we may get race conditions if a matrix column is
@@ -148,7 +69,7 @@ template <typename TensorDataType>
 __global__ void compute_categorical_accuracy(El::Int k,
                                              El::Int width,
                                              El::Int max_entry,
-                                             const entry<TensorDataType>*  __restrict__ top_entries,
+                                             const cuda::top_k_entry<TensorDataType>*  __restrict__ top_entries,
                                              El::Int top_entries_ldim,
                                              const El::Int*  __restrict__ label_indices,
                                              TensorDataType* __restrict__ loss,
@@ -204,7 +125,6 @@ void fp_gpu(lbann_comm& comm,
   auto&& stream = El::GPUManager::Stream();
   auto&& event = El::GPUManager::Event();
   El::SyncInfo<El::Device::GPU> syncInfo{stream, event};
-  cuda::thrust::allocator<> alloc(stream);
 
   // Get label indices
   cuda::thrust::vector<El::Int> label_indices(local_width, height);
@@ -226,78 +146,32 @@ void fp_gpu(lbann_comm& comm,
   }
 
   // Find top-k entries in each column of local prediction matrix
-  cuda::thrust::vector<entry<TensorDataType>> top_entries(local_width * k);
-  {
-    const auto& num_local_entries_per_col = std::max(local_height, k);
-    const auto& num_local_entries = local_width * num_local_entries_per_col;
-    const auto& block_dim = 256;
-    const auto& grid_dim = (num_local_entries + block_dim - 1) / block_dim;
-    cuda::thrust::vector<entry<TensorDataType>> local_entries(num_local_entries);
-    cuda::thrust::vector<El::Int> local_entries_cols(num_local_entries);
-    dense_matrix_to_sparse_vectors<<<grid_dim, block_dim, 0, stream>>>(
-      num_local_entries_per_col, local_height, local_width, height,
-      predictions.ColShift(), predictions.ColStride(),
-      local_predictions.LockedBuffer(), local_predictions.LDim(),
-      local_entries.data().get(), num_local_entries_per_col);
-    fill_with_tensor_index<<<grid_dim, block_dim, 0, stream>>>(
-      num_local_entries, local_width, num_local_entries_per_col,
-      local_entries_cols.data().get());
-    ::thrust::sort_by_key(alloc.system(),
-                          local_entries.begin(),
-                          local_entries.end(),
-                          local_entries_cols.begin(),
-                          entry_compare<TensorDataType>());
-    ::thrust::stable_sort_by_key(alloc.system(),
-                                 local_entries_cols.begin(),
-                                 local_entries_cols.end(),
-                                 local_entries.begin());
-    CHECK_CUDA(cudaMemcpy2DAsync(top_entries.data().get(),
-                                 k * sizeof(entry<TensorDataType>),
-                                 local_entries.data().get(),
-                                 num_local_entries_per_col * sizeof(entry<TensorDataType>),
-                                 k * sizeof(entry<TensorDataType>),
-                                 local_width,
-                                 cudaMemcpyDeviceToDevice,
-                                 stream));
-  }
+  cuda::thrust::vector<cuda::top_k_entry<TensorDataType>> top_entries(local_width * k);
+  cuda::top_k_columns(k, local_height, local_width,
+                      local_predictions.LockedBuffer(),
+                      local_predictions.LDim(),
+                      predictions.ColShift(), predictions.ColStride(),
+                      height, top_entries.data().get(), k, stream);
 
   // Find top-k entries in each column of global prediction matrix
   if (col_comm_size > 1) {
     const auto& num_entries_per_rank = local_width * k;
     const auto& num_entries = col_comm_size * num_entries_per_rank;
-    const auto& block_dim = 256;
-    const auto& grid_dim = (num_entries + block_dim - 1) / block_dim;
     if (col_comm_rank != col_comm_root) {
       comm.gather(reinterpret_cast<El::byte*>(top_entries.data().get()),
-                  top_entries.size() * sizeof(entry<TensorDataType>),
+                  top_entries.size() * sizeof(cuda::top_k_entry<TensorDataType>),
                   col_comm_root,
                   col_comm, syncInfo);
     } else {
-      cuda::thrust::vector<entry<TensorDataType>> global_top_entries(num_entries);
-      cuda::thrust::vector<El::Int> global_top_entries_cols(num_entries);
+      cuda::thrust::vector<cuda::top_k_entry<TensorDataType>> global_top_entries(num_entries);
       comm.gather(reinterpret_cast<El::byte*>(top_entries.data().get()),
-                  top_entries.size() * sizeof(entry<TensorDataType>),
+                  top_entries.size() * sizeof(cuda::top_k_entry<TensorDataType>),
                   reinterpret_cast<El::byte*>(global_top_entries.data().get()),
                   col_comm, syncInfo);
-      fill_with_tensor_index<<<grid_dim, block_dim, 0, stream>>>(
-        num_entries, local_width, k, global_top_entries_cols.data().get());
-      ::thrust::sort_by_key(alloc.system(),
-                            global_top_entries.begin(),
-                            global_top_entries.end(),
-                            global_top_entries_cols.begin(),
-                            entry_compare<TensorDataType>());
-      ::thrust::stable_sort_by_key(alloc.system(),
-                                   global_top_entries_cols.begin(),
-                                   global_top_entries_cols.end(),
-                                   global_top_entries.begin());
-      CHECK_CUDA(cudaMemcpy2DAsync(top_entries.data().get(),
-                                   k * sizeof(entry<TensorDataType>),
-                                   global_top_entries.data().get(),
-                                   col_comm_size * k * sizeof(entry<TensorDataType>),
-                                   k * sizeof(entry<TensorDataType>),
-                                   local_width,
-                                   cudaMemcpyDeviceToDevice,
-                                   stream));
+      cuda::top_k_columns(k, k, col_comm_size, local_width,
+                          global_top_entries.data().get(), k,
+                          num_entries_per_rank, height,
+                          top_entries.data().get(), k, stream);
     }
   }
 
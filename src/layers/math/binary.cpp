@@ -28,10 +28,129 @@
 #include "lbann/layers/math/binary.hpp"
 #include "lbann/utils/entrywise_operator.hpp"
 
+#include <unordered_set>
+
 namespace lbann {
 
+std::vector<int> get_binary_layer_output_dims(const Layer& l,
+                                              bool allow_broadcast) {
+  const auto& dims1 = l.get_input_dims(0);
+  const auto& dims2 = l.get_input_dims(1);
+  if (dims1 == dims2) { return dims1; }
+
+  // Check if inputs can be broadcast against each other
+  if (allow_broadcast) {
+    const auto& dims = get_broadcast_dims(dims1, dims2);
+    const auto& is_compatible = [&dims] (const std::vector<int>& input_dims) {
+      const size_t offset = dims.size() - input_dims.size();
+      for (size_t d = 0; d < input_dims.size(); ++d) {
+        if (input_dims[d] != 1 && input_dims[d] != dims[d+offset]) {
+          return false;
+        }
+      }
+      return true;
+    };
+    if (is_compatible(dims1) && is_compatible(dims2)) { return dims; }
+  }
+
+  const auto& parents = l.get_parent_layers();
+  std::stringstream err;
+  err << l.get_type() << " layer \"" << l.get_name() << "\" "
+      << "has input tensors with "
+      << (allow_broadcast ? "incompatible" : "different") << " dimensions (";
+  for (int i = 0; i < l.get_num_parents(); ++i) {
+    const auto& dims = l.get_input_dims(i);
+    err << (i > 0 ? ", " : "")
+        << "layer \"" << parents[i]->get_name() << "\" outputs ";
+    for (size_t j = 0; j < dims.size(); ++j) {
+      err << (j > 0 ? " x " : "") << dims[j];
+    }
+  }
+  err << ")";
+  if (!allow_broadcast) {
+    err << ", and broadcasting requires a data-parallel layout";
+  }
+  LBANN_ERROR(err.str());
+  return {};
+}
+
+bool is_entrywise_binary_layer(const Layer& l) {
+  static const std::unordered_set<std::string> types = {
+    "add", "subtract", "multiply", "divide", "modulo", "power",
+    "safe divide", "squared difference",
+    "maximum", "minimum", "equal", "not equal",
+    "less than", "less than or equal",
+    "greater than", "greater than or equal",
+    "logical and", "logical or", "logical xor"};
+  return (l.get_num_parents() == 2 && types.count(l.get_type()) > 0);
+}
+
+bool get_binary_layer_broadcast_maps(const Layer& l,
+                                     broadcast_map& map1,
+                                     broadcast_map& map2) {
+  const auto& output_dims = l.get_output_dims();
+  map1 = make_broadcast_map(l.get_input_dims(0), output_dims);
+  map2 = make_broadcast_map(l.get_input_dims(1), output_dims);
+  return !map1.is_identity() || !map2.is_identity();
+}
+
 namespace {
 
+/** Apply an entry-wise binary operator to inputs read at the output
+ *  shape. Mini-batch samples are independent, so the broadcast only
+ *  acts within columns.
+ */
+template <template <typename> class Op, typename TensorDataType>
+void apply_broadcast_binary_operator(
+  const broadcast_map& map1,
+  const El::AbstractMatrix<TensorDataType>& x1,
+  const broadcast_map& map2,
+  const El::AbstractMatrix<TensorDataType>& x2,
+  El::AbstractMatrix<TensorDataType>& y) {
+  using BinaryOperator = Op<TensorDataType>;
+  const El::Int height = y.Height();
+  const El::Int width = y.Width();
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (El::Int col = 0; col < width; ++col) {
+    for (El::Int row = 0; row < height; ++row) {
+      BinaryOperator op;
+      y(row, col) = op(x1(map1(row), col), x2(map2(row), col));
+    }
+  }
+}
+
+/** Apply a binary backprop operator to inputs read at the output
+ *  shape. Gradients w.r.t. broadcast inputs are summed over the
+ *  entries they were broadcast to.
+ */
+template <template <typename> class Op, typename TensorDataType>
+void apply_broadcast_binary_backprop_operator(
+  const broadcast_map& map1,
+  const El::AbstractMatrix<TensorDataType>& x1,
+  const broadcast_map& map2,
+  const El::AbstractMatrix<TensorDataType>& x2,
+  const El::AbstractMatrix<TensorDataType>& dy,
+  El::AbstractMatrix<TensorDataType>& dx1,
+  El::AbstractMatrix<TensorDataType>& dx2) {
+  using BinaryBackPropOperator = Op<TensorDataType>;
+  El::Zero(dx1);
+  El::Zero(dx2);
+  const El::Int height = dy.Height();
+  const El::Int width = dy.Width();
+  LBANN_OMP_PARALLEL_FOR
+  for (El::Int col = 0; col < width; ++col) {
+    for (El::Int row = 0; row < height; ++row) {
+      BinaryBackPropOperator op;
+      const auto& row1 = map1(row);
+      const auto& row2 = map2(row);
+      TensorDataType d1, d2;
+      op(x1(row1, col), x2(row2, col), dy(row, col), d1, d2);
+      dx1(row1, col) += d1;
+      dx2(row2, col) += d2;
+    }
+  }
+}
+
 /** Apply a binary backprop operator to CPU data.
  *  The input and output data must be on CPU and must have the same
  *  dimensions. Given a binary function \f$ y = f(x_1,x_2) \f$, the
@@ -450,6 +569,14 @@ struct logical_xor_op {
 #define DEFINE_COMPUTE_OPS(layer, op)                                   \
   template <typename TensorDataType, data_layout Layout, El::Device Device> \
   void layer<TensorDataType, Layout, Device>::fp_compute() {            \
+    broadcast_map map1, map2;                                           \
+    if (get_binary_layer_broadcast_maps(*this, map1, map2)) {           \
+      apply_broadcast_binary_operator<op>(                              \
+        map1, this->get_local_prev_activations(0),                      \
+        map2, this->get_local_prev_activations(1),                      \
+        this->get_local_activations());                                 \
+      return;                                                           \
+    }                                                                   \
     apply_entrywise_binary_operator<op>(                                \
       this->get_prev_activations(0),                                    \
       this->get_prev_activations(1),                                    \
@@ -457,6 +584,16 @@ struct logical_xor_op {
   }                                                                     \
   template <typename TensorDataType, data_layout Layout, El::Device Device> \
   void layer<TensorDataType, Layout, Device>::bp_compute() {            \
+    broadcast_map map1, map2;                                           \
+    if (get_binary_layer_broadcast_maps(*this, map1, map2)) {           \
+      apply_broadcast_binary_backprop_operator<op>(                     \
+        map1, this->get_local_prev_activations(0),                      \
+        map2, this->get_local_prev_activations(1),                      \
+        this->get_local_prev_error_signals(),                           \
+        this->get_local_error_signals(0),                               \
+        this->get_local_error_signals(1));                              \
+      return;                                                           \
+    }                                                                   \
     apply_binary_backprop_operator<op>(                                 \
       this->get_local_prev_activations(0),                              \
       this->get_local_prev_activations(1),                              \
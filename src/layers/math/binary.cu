@@ -106,6 +106,139 @@ void apply_binary_backprop_operator(const El::AbstractMatrix<TensorDataType>& x1
 
 }
 
+/** CUDA kernel to apply a binary operator to inputs read at the
+ *  output shape.
+ */
+template <template <typename> class BinaryOperator,
+          typename TensorDataType>
+__global__
+void broadcast_binary_operator_kernel(El::Int height, El::Int width,
+                                      broadcast_map map1,
+                                      const TensorDataType* __restrict__ x1,
+                                      El::Int x1_ldim,
+                                      broadcast_map map2,
+                                      const TensorDataType* __restrict__ x2,
+                                      El::Int x2_ldim,
+                                      TensorDataType* __restrict__ y,
+                                      El::Int y_ldim) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int size = height * width;
+  const El::Int num_threads = blockDim.x * gridDim.x;
+  BinaryOperator<TensorDataType> op;
+  for (El::Int pos = gid; pos < size; pos += num_threads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    y[row + col * y_ldim] = op(x1[map1(row) + col * x1_ldim],
+                               x2[map2(row) + col * x2_ldim]);
+  }
+}
+
+/** CUDA kernel to apply a binary backprop operator to inputs read at
+ *  the output shape. Gradients w.r.t. broadcast inputs are
+ *  accumulated with atomics and must be zeroed beforehand.
+ */
+template <template <typename> class BinaryBackPropOperator,
+          typename TensorDataType>
+__global__
+void broadcast_binary_backprop_operator_kernel(
+  El::Int height, El::Int width,
+  broadcast_map map1,
+  const TensorDataType* __restrict__ x1,
+  El::Int x1_ldim,
+  broadcast_map map2,
+  const TensorDataType* __restrict__ x2,
+  El::Int x2_ldim,
+  const TensorDataType* __restrict__ dy,
+  El::Int dy_ldim,
+  TensorDataType* __restrict__ dx1,
+  El::Int dx1_ldim,
+  TensorDataType* __restrict__ dx2,
+  El::Int dx2_ldim) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int size = height * width;
+  const El::Int num_threads = blockDim.x * gridDim.x;
+  BinaryBackPropOperator<TensorDataType> op;
+  for (El::Int pos = gid; pos < size; pos += num_threads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    const auto& row1 = map1(row);
+    const auto& row2 = map2(row);
+    TensorDataType d1, d2;
+    op(x1[row1 + col * x1_ldim],
+       x2[row2 + col * x2_ldim],
+       dy[row + col * dy_ldim],
+       d1, d2);
+    if (map1.is_identity()) { dx1[row1 + col * dx1_ldim] = d1; }
+    else { cuda::atomic_add(&dx1[row1 + col * dx1_ldim], d1); }
+    if (map2.is_identity()) { dx2[row2 + col * dx2_ldim] = d2; }
+    else { cuda::atomic_add(&dx2[row2 + col * dx2_ldim], d2); }
+  }
+}
+
+/** Grid dimension for an entry-wise kernel. */
+El::Int get_grid_dim(El::Int height, El::Int width, El::Int block_dim) {
+  El::Int grid_dim = (height * width + block_dim - 1) / block_dim;
+  if (sizeof(El::Int) > sizeof(unsigned int)
+      && grid_dim > std::numeric_limits<uint32_t>::max()) {
+    grid_dim = std::numeric_limits<uint32_t>::max();
+  }
+  return grid_dim;
+}
+
+/** Apply a binary operator to GPU inputs read at the output shape. */
+template <template <typename> class BinaryOperator,
+          typename TensorDataType>
+void apply_broadcast_binary_operator(
+  const broadcast_map& map1,
+  const El::AbstractMatrix<TensorDataType>& x1,
+  const broadcast_map& map2,
+  const El::AbstractMatrix<TensorDataType>& x2,
+  El::AbstractMatrix<TensorDataType>& y) {
+  const El::Int height = y.Height();
+  const El::Int width = y.Width();
+  const El::Int block_dim = 256;
+  const El::Int grid_dim = get_grid_dim(height, width, block_dim);
+  if (grid_dim > 0) {
+    broadcast_binary_operator_kernel<BinaryOperator>
+      <<<grid_dim, block_dim, 0, El::GPUManager::Stream()>>>(
+        height, width,
+        map1, x1.LockedBuffer(), x1.LDim(),
+        map2, x2.LockedBuffer(), x2.LDim(),
+        y.Buffer(), y.LDim());
+  }
+}
+
+/** Apply a binary backprop operator to GPU inputs read at the output
+ *  shape.
+ */
+template <template <typename> class BinaryBackPropOperator,
+          typename TensorDataType>
+void apply_broadcast_binary_backprop_operator(
+  const broadcast_map& map1,
+  const El::AbstractMatrix<TensorDataType>& x1,
+  const broadcast_map& map2,
+  const El::AbstractMatrix<TensorDataType>& x2,
+  const El::AbstractMatrix<TensorDataType>& dy,
+  El::AbstractMatrix<TensorDataType>& dx1,
+  El::AbstractMatrix<TensorDataType>& dx2) {
+  if (!map1.is_identity()) { El::Zero(dx1); }
+  if (!map2.is_identity()) { El::Zero(dx2); }
+  const El::Int height = dy.Height();
+  const El::Int width = dy.Width();
+  const El::Int block_dim = 256;
+  const El::Int grid_dim = get_grid_dim(height, width, block_dim);
+  if (grid_dim > 0) {
+    broadcast_binary_backprop_operator_kernel<BinaryBackPropOperator>
+      <<<grid_dim, block_dim, 0, El::GPUManager::Stream()>>>(
+        height, width,
+        map1, x1.LockedBuffer(), x1.LDim(),
+        map2, x2.LockedBuffer(), x2.LDim(),
+        dy.LockedBuffer(), dy.LDim(),
+        dx1.Buffer(), dx1.LDim(),
+        dx2.Buffer(), dx2.LDim());
+  }
+}
+
 // =========================================================
 // Operator objects for entry-wise binary layers
 // =========================================================
@@ -478,6 +611,14 @@ struct logical_xor_op {
 #define DEFINE_COMPUTE_OPS(layer, op)                                   \
   template <typename TensorDataType, data_layout Layout, El::Device Device> \
   void layer<TensorDataType, Layout, Device>::fp_compute() {            \
+    broadcast_map map1, map2;                                           \
+    if (get_binary_layer_broadcast_maps(*this, map1, map2)) {           \
+      apply_broadcast_binary_operator<op>(                              \
+        map1, this->get_local_prev_activations(0),                      \
+        map2, this->get_local_prev_activations(1),                      \
+        this->get_local_activations());                                 \
+      return;                                                           \
+    }                                                                   \
     cuda::apply_entrywise_binary_operator<op>(                          \
       this->get_prev_activations(0),                                    \
       this->get_prev_activations(1),                                    \
@@ -485,6 +626,16 @@ struct logical_xor_op {
   }                                                                     \
   template <typename TensorDataType, data_layout Layout, El::Device Device> \
   void layer<TensorDataType, Layout, Device>::bp_compute() {            \
+    broadcast_map map1, map2;                                           \
+    if (get_binary_layer_broadcast_maps(*this, map1, map2)) {           \
+      apply_broadcast_binary_backprop_operator<op>(                     \
+        map1, this->get_local_prev_activations(0),                      \
+        map2, this->get_local_prev_activations(1),                      \
+        this->get_local_prev_error_signals(),                           \
+        this->get_local_error_signals(0),                               \
+        this->get_local_error_signals(1));                              \
+      return;                                                           \
+    }                                                                   \
     apply_binary_backprop_operator<op>(                                 \
       this->get_local_prev_activations(0),                              \
       this->get_local_prev_activations(1),                              \
@@ -0,0 +1,217 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#define LBANN_FUSED_ENTRYWISE_LAYER_INSTANTIATE
+#include "lbann/layers/math/fused_entrywise.hpp"
+#include "lbann/layers/math/clamp.hpp"
+
+#include <unordered_map>
+
+namespace lbann {
+
+namespace {
+
+/** Fused operation with pointers to local data. */
+template <typename TensorDataType>
+struct local_step {
+  fused_entrywise_op op;
+  const El::AbstractMatrix<TensorDataType>* operand = nullptr;
+  broadcast_map operand_map;
+  bool operand_first = false;
+  TensorDataType min, max;
+  const TensorDataType* scale = nullptr;
+  const TensorDataType* bias = nullptr;
+};
+
+/** Apply one fused operation to an entry. */
+template <typename TensorDataType>
+inline TensorDataType apply_step(const local_step<TensorDataType>& s,
+                                 const TensorDataType& x,
+                                 El::Int row,
+                                 El::Int col) {
+  const auto zero = El::TypeTraits<TensorDataType>::Zero();
+  const auto one = El::TypeTraits<TensorDataType>::One();
+  switch (s.op) {
+  case fused_entrywise_op::abs:        return x >= zero ? x : -x;
+  case fused_entrywise_op::negative:   return -x;
+  case fused_entrywise_op::square:     return x * x;
+  case fused_entrywise_op::sqrt:       return El::Sqrt(x);
+  case fused_entrywise_op::rsqrt:      return one / El::Sqrt(x);
+  case fused_entrywise_op::reciprocal: return one / x;
+  case fused_entrywise_op::exp:        return El::Exp(x);
+  case fused_entrywise_op::log:        return El::Log(x);
+  case fused_entrywise_op::sin:        return El::Sin(x);
+  case fused_entrywise_op::cos:        return El::Cos(x);
+  case fused_entrywise_op::tanh:       return El::Tanh(x);
+  case fused_entrywise_op::relu:       return x > zero ? x : zero;
+  case fused_entrywise_op::clamp:
+    return x <= s.min ? s.min : (x >= s.max ? s.max : x);
+  case fused_entrywise_op::scale_bias:
+    return s.scale[row] * x + s.bias[row];
+  default: break;
+  }
+
+  // Binary operations
+  const TensorDataType y = (*s.operand)(s.operand_map(row), col);
+  const auto& a = s.operand_first ? y : x;
+  const auto& b = s.operand_first ? x : y;
+  switch (s.op) {
+  case fused_entrywise_op::add:      return a + b;
+  case fused_entrywise_op::subtract: return a - b;
+  case fused_entrywise_op::multiply: return a * b;
+  case fused_entrywise_op::divide:   return a / b;
+  case fused_entrywise_op::max:      return a >= b ? a : b;
+  case fused_entrywise_op::min:      return a <= b ? a : b;
+  case fused_entrywise_op::squared_difference: return (a - b) * (a - b);
+  default:
+    LBANN_ERROR("invalid fused entry-wise operation");
+  }
+  return x;
+}
+
+/** @brief Type names of the layers that can be fused.
+ *  @details Clamp and scale/bias are handled separately.
+ */
+const std::unordered_map<std::string, fused_entrywise_op>& fusable_layer_types() {
+  static const std::unordered_map<std::string, fused_entrywise_op> types = {
+    {"absolute value",         fused_entrywise_op::abs},
+    {"negative",               fused_entrywise_op::negative},
+    {"square",                 fused_entrywise_op::square},
+    {"square root",            fused_entrywise_op::sqrt},
+    {"reciprocal square root", fused_entrywise_op::rsqrt},
+    {"reciprocal",             fused_entrywise_op::reciprocal},
+    {"exponential",            fused_entrywise_op::exp},
+    {"natural logarithm",      fused_entrywise_op::log},
+    {"sine",                   fused_entrywise_op::sin},
+    {"cosine",                 fused_entrywise_op::cos},
+    {"hyperbolic tangent",     fused_entrywise_op::tanh},
+    {"ReLU",                   fused_entrywise_op::relu},
+    {"add",                    fused_entrywise_op::add},
+    {"subtract",               fused_entrywise_op::subtract},
+    {"multiply",               fused_entrywise_op::multiply},
+    {"divide",                 fused_entrywise_op::divide},
+    {"maximum",                fused_entrywise_op::max},
+    {"minimum",                fused_entrywise_op::min},
+    {"squared difference",     fused_entrywise_op::squared_difference}};
+  return types;
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+bool get_clamp_range(const Layer& l, TensorDataType& min, TensorDataType& max) {
+  const auto* clamp = dynamic_cast<const clamp_layer<TensorDataType, Layout, Device>*>(&l);
+  if (clamp == nullptr) { return false; }
+  min = clamp->get_min();
+  max = clamp->get_max();
+  return true;
+}
+
+} // namespace <anon>
+
+template <typename TensorDataType>
+bool get_fused_entrywise_op(const Layer& l,
+                            fused_entrywise_step<TensorDataType>& step) {
+  if (dynamic_cast<const data_type_layer<TensorDataType>*>(&l) == nullptr) {
+    return false;
+  }
+  const auto type = l.get_type();
+  const auto& types = fusable_layer_types();
+  const auto it = types.find(type);
+  if (it != types.end()) {
+    step.op = it->second;
+    return true;
+  }
+  if (type == "entry-wise scale/bias") {
+    step.op = fused_entrywise_op::scale_bias;
+    return true;
+  }
+  if (get_clamp_range<TensorDataType, data_layout::DATA_PARALLEL, El::Device::CPU>(l, step.min, step.max)
+      || get_clamp_range<TensorDataType, data_layout::MODEL_PARALLEL, El::Device::CPU>(l, step.min, step.max)
+#ifdef LBANN_HAS_GPU
+      || get_clamp_range<TensorDataType, data_layout::DATA_PARALLEL, El::Device::GPU>(l, step.min, step.max)
+      || get_clamp_range<TensorDataType, data_layout::MODEL_PARALLEL, El::Device::GPU>(l, step.min, step.max)
+#endif // LBANN_HAS_GPU
+      ) {
+    step.op = fused_entrywise_op::clamp;
+    return true;
+  }
+  return false;
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void fused_entrywise_layer<TensorDataType, Layout, Device>::fp_compute() {
+
+  // Local matrices
+  const auto& local_input = this->get_local_prev_activations(0);
+  auto& local_output = this->get_local_activations();
+  std::vector<local_step<TensorDataType>> steps(m_steps.size());
+  for (size_t i = 0; i < m_steps.size(); ++i) {
+    const auto& s = m_steps[i];
+    auto& ls = steps[i];
+    ls.op = s.op;
+    ls.operand_first = s.operand_first;
+    ls.min = s.min;
+    ls.max = s.max;
+    if (s.operand >= 0) {
+      ls.operand = &this->get_local_prev_activations(s.operand);
+      ls.operand_map = get_operand_map(s.operand);
+    }
+    if (s.weights >= 0) {
+      const auto& local_scale_bias
+        = this->get_data_type_weights(s.weights).get_values().LockedMatrix();
+      ls.scale = local_scale_bias.LockedBuffer(0, 0);
+      ls.bias = local_scale_bias.LockedBuffer(0, 1);
+    }
+  }
+
+  // Apply all operations to each entry
+  const El::Int local_height = local_input.Height();
+  const El::Int local_width = local_input.Width();
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (El::Int col = 0; col < local_width; ++col) {
+    for (El::Int row = 0; row < local_height; ++row) {
+      auto x = local_input(row, col);
+      for (const auto& s : steps) {
+        x = apply_step(s, x, row, col);
+      }
+      local_output(row, col) = x;
+    }
+  }
+
+}
+
+#define PROTO(T)                                                        \
+  template bool get_fused_entrywise_op<T>(                              \
+    const Layer&, fused_entrywise_step<T>&);                            \
+  template class fused_entrywise_layer<                                 \
+    T, data_layout::DATA_PARALLEL, El::Device::CPU>;                    \
+  template class fused_entrywise_layer<                                 \
+    T, data_layout::MODEL_PARALLEL, El::Device::CPU>
+
+PROTO(float);
+PROTO(double);
+
+} // namespace lbann
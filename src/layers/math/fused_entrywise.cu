@@ -0,0 +1,305 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#define LBANN_FUSED_ENTRYWISE_LAYER_INSTANTIATE
+#include "lbann/layers/math/fused_entrywise.hpp"
+#include "lbann/utils/cuda.hpp"
+
+namespace lbann {
+
+namespace {
+
+/** Fused operation with pointers to local data. */
+template <typename TensorDataType>
+struct gpu_step {
+  fused_entrywise_op op;
+  const TensorDataType* operand;
+  El::Int operand_ldim;
+  broadcast_map operand_map;
+  bool operand_first;
+  TensorDataType min, max;
+  const TensorDataType* scale;
+  const TensorDataType* bias;
+};
+
+/** @brief Fused operations, passed to the kernel by value. */
+template <typename TensorDataType>
+struct gpu_chain {
+  int num_steps;
+  gpu_step<TensorDataType> steps[max_fused_entrywise_steps];
+};
+
+/** @brief Apply one fused operation to an entry.
+ *
+ *  @c op is passed separately from the step so that the branches
+ *  fold away when it is a compile-time constant.
+ */
+template <typename TensorDataType>
+__device__ __forceinline__
+TensorDataType apply_op(fused_entrywise_op op,
+                        const gpu_step<TensorDataType>& s,
+                        const TensorDataType& x,
+                        El::Int row,
+                        El::Int col) {
+  const TensorDataType zero = 0.;
+  const TensorDataType one = 1.;
+  switch (op) {
+  case fused_entrywise_op::abs:        return cuda::abs(x);
+  case fused_entrywise_op::negative:   return -x;
+  case fused_entrywise_op::square:     return x * x;
+  case fused_entrywise_op::sqrt:       return cuda::sqrt(x);
+  case fused_entrywise_op::rsqrt:      return cuda::rsqrt(x);
+  case fused_entrywise_op::reciprocal: return one / x;
+  case fused_entrywise_op::exp:        return cuda::exp(x);
+  case fused_entrywise_op::log:        return cuda::log(x);
+  case fused_entrywise_op::sin:        return cuda::sin(x);
+  case fused_entrywise_op::cos:        return cuda::cos(x);
+  case fused_entrywise_op::tanh:       return cuda::tanh(x);
+  case fused_entrywise_op::relu:       return x > zero ? x : zero;
+  case fused_entrywise_op::clamp:
+    return x <= s.min ? s.min : (x >= s.max ? s.max : x);
+  case fused_entrywise_op::scale_bias:
+    return s.scale[row] * x + s.bias[row];
+  default: break;
+  }
+
+  // Binary operations
+  const auto& y = s.operand[s.operand_map(row) + col * s.operand_ldim];
+  const auto& a = s.operand_first ? y : x;
+  const auto& b = s.operand_first ? x : y;
+  switch (op) {
+  case fused_entrywise_op::add:      return a + b;
+  case fused_entrywise_op::subtract: return a - b;
+  case fused_entrywise_op::multiply: return a * b;
+  case fused_entrywise_op::divide:   return a / b;
+  case fused_entrywise_op::max:      return cuda::max(a, b);
+  case fused_entrywise_op::min:      return cuda::min(a, b);
+  case fused_entrywise_op::squared_difference: return (a - b) * (a - b);
+  default:                           return x;
+  }
+}
+
+/** Apply one fused operation, chosen at run time, to an entry. */
+template <typename TensorDataType>
+__device__ __forceinline__
+TensorDataType apply_step(const gpu_step<TensorDataType>& s,
+                          const TensorDataType& x,
+                          El::Int row,
+                          El::Int col) {
+  return apply_op(s.op, s, x, row, col);
+}
+
+/** Chain of operations fixed at compile time. */
+template <typename TensorDataType, fused_entrywise_op... Ops>
+struct fixed_chain;
+template <typename TensorDataType>
+struct fixed_chain<TensorDataType> {
+  static __device__ __forceinline__
+  TensorDataType apply(const gpu_chain<TensorDataType>&, int,
+                       const TensorDataType& x, El::Int, El::Int) {
+    return x;
+  }
+};
+template <typename TensorDataType,
+          fused_entrywise_op Op, fused_entrywise_op... Rest>
+struct fixed_chain<TensorDataType, Op, Rest...> {
+  static __device__ __forceinline__
+  TensorDataType apply(const gpu_chain<TensorDataType>& chain, int i,
+                       const TensorDataType& x, El::Int row, El::Int col) {
+    return fixed_chain<TensorDataType, Rest...>::apply(
+      chain, i+1, apply_op(Op, chain.steps[i], x, row, col), row, col);
+  }
+};
+
+/**
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: (height*width / bsize) x 1 x 1
+ */
+template <typename TensorDataType>
+__global__ void fp_kernel(gpu_chain<TensorDataType> chain,
+                          El::Int height,
+                          El::Int width,
+                          const TensorDataType* __restrict__ input,
+                          El::Int input_ldim,
+                          TensorDataType* __restrict__ output,
+                          El::Int output_ldim) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int size = height * width;
+  const El::Int num_threads = blockDim.x * gridDim.x;
+  for (El::Int pos = gid; pos < size; pos += num_threads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    auto x = input[row + col * input_ldim];
+    for (int i = 0; i < chain.num_steps; ++i) {
+      x = apply_step(chain.steps[i], x, row, col);
+    }
+    output[row + col * output_ldim] = x;
+  }
+}
+
+/** @brief Kernel specialized for one chain of operations
+ *
+ *  Same as @c fp_kernel, without branching on the operations.
+ */
+template <typename TensorDataType, fused_entrywise_op... Ops>
+__global__ void fixed_fp_kernel(gpu_chain<TensorDataType> chain,
+                                El::Int height,
+                                El::Int width,
+                                const TensorDataType* __restrict__ input,
+                                El::Int input_ldim,
+                                TensorDataType* __restrict__ output,
+                                El::Int output_ldim) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int size = height * width;
+  const El::Int num_threads = blockDim.x * gridDim.x;
+  for (El::Int pos = gid; pos < size; pos += num_threads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    const auto& x = input[row + col * input_ldim];
+    output[row + col * output_ldim]
+      = fixed_chain<TensorDataType, Ops...>::apply(chain, 0, x, row, col);
+  }
+}
+
+template <typename TensorDataType>
+using fp_kernel_type = void (*)(gpu_chain<TensorDataType>,
+                                El::Int, El::Int,
+                                const TensorDataType*, El::Int,
+                                TensorDataType*, El::Int);
+
+/** Registered specialized kernel for a chain of operations. */
+template <typename TensorDataType>
+struct fixed_kernel_entry {
+  std::vector<fused_entrywise_op> ops;
+  fp_kernel_type<TensorDataType> kernel;
+};
+
+/** @brief Specialized kernels for common chains
+ *
+ *  Only single precision has specialized kernels. Other types always
+ *  use the generic kernel.
+ */
+template <typename TensorDataType>
+const std::vector<fixed_kernel_entry<TensorDataType>>& fixed_kernels() {
+  static const std::vector<fixed_kernel_entry<TensorDataType>> kernels;
+  return kernels;
+}
+template <>
+const std::vector<fixed_kernel_entry<float>>& fixed_kernels<float>() {
+  using op = fused_entrywise_op;
+  static const std::vector<fixed_kernel_entry<float>> kernels = {
+    {{op::scale_bias, op::relu}, fixed_fp_kernel<float, op::scale_bias, op::relu>},
+    {{op::add, op::relu},        fixed_fp_kernel<float, op::add, op::relu>},
+    {{op::multiply, op::add},    fixed_fp_kernel<float, op::multiply, op::add>},
+    {{op::scale_bias},           fixed_fp_kernel<float, op::scale_bias>},
+    {{op::relu},                 fixed_fp_kernel<float, op::relu>},
+    {{op::add},                  fixed_fp_kernel<float, op::add>},
+  };
+  return kernels;
+}
+
+/** Find a specialized kernel for the chain, if one is registered. */
+template <typename TensorDataType>
+fp_kernel_type<TensorDataType> find_fixed_kernel(
+  const std::vector<fused_entrywise_step<TensorDataType>>& steps) {
+  for (const auto& entry : fixed_kernels<TensorDataType>()) {
+    if (entry.ops.size() != steps.size()) { continue; }
+    bool match = true;
+    for (size_t i = 0; i < steps.size() && match; ++i) {
+      match = (entry.ops[i] == steps[i].op);
+    }
+    if (match) { return entry.kernel; }
+  }
+  return nullptr;
+}
+
+} // namespace <anon>
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void fused_entrywise_layer<TensorDataType, Layout, Device>::fp_compute() {
+
+  // Local matrices
+  const auto& local_input = this->get_local_prev_activations(0);
+  auto& local_output = this->get_local_activations();
+  gpu_chain<TensorDataType> chain;
+  chain.num_steps = m_steps.size();
+  for (size_t i = 0; i < m_steps.size(); ++i) {
+    const auto& s = m_steps[i];
+    auto& gs = chain.steps[i];
+    gs.op = s.op;
+    gs.operand = nullptr;
+    gs.operand_ldim = 0;
+    gs.operand_first = s.operand_first;
+    gs.min = s.min;
+    gs.max = s.max;
+    gs.scale = nullptr;
+    gs.bias = nullptr;
+    if (s.operand >= 0) {
+      const auto& local_operand = this->get_local_prev_activations(s.operand);
+      gs.operand = local_operand.LockedBuffer();
+      gs.operand_ldim = local_operand.LDim();
+      gs.operand_map = get_operand_map(s.operand);
+    }
+    if (s.weights >= 0) {
+      const auto& local_scale_bias
+        = this->get_data_type_weights(s.weights).get_values().LockedMatrix();
+      gs.scale = local_scale_bias.LockedBuffer(0, 0);
+      gs.bias = local_scale_bias.LockedBuffer(0, 1);
+    }
+  }
+
+  // Apply all operations in one kernel
+  const El::Int height = local_input.Height();
+  const El::Int width = local_input.Width();
+  const El::Int block_dim = 256;
+  El::Int grid_dim = (height * width + block_dim - 1) / block_dim;
+  if (sizeof(El::Int) > sizeof(unsigned int)
+      && grid_dim > std::numeric_limits<uint32_t>::max()) {
+    grid_dim = std::numeric_limits<uint32_t>::max();
+  }
+  if (grid_dim > 0) {
+    auto kernel = find_fixed_kernel(m_steps);
+    if (kernel == nullptr) { kernel = fp_kernel<TensorDataType>; }
+    kernel<<<grid_dim, block_dim, 0, El::GPUManager::Stream()>>>(
+      chain, height, width,
+      local_input.LockedBuffer(), local_input.LDim(),
+      local_output.Buffer(), local_output.LDim());
+  }
+
+}
+
+#define PROTO(T)                                      \
+  template class fused_entrywise_layer<               \
+    T, data_layout::DATA_PARALLEL, El::Device::GPU>;  \
+  template class fused_entrywise_layer<               \
+    T, data_layout::MODEL_PARALLEL, El::Device::GPU>
+
+PROTO(float);
+PROTO(double);
+
+} // namespace lbann
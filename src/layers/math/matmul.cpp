@@ -26,6 +26,7 @@
 
 #define LBANN_MATMUL_LAYER_INSTANTIATE
 #include "lbann/layers/math/matmul.hpp"
+#include "lbann/utils/batched_gemm.hpp"
 #ifdef LBANN_HAS_GPU
 #include "lbann/utils/cublas.hpp"
 #endif // LBANN_HAS_GPU
@@ -44,34 +45,34 @@ void fp_compute_impl(matmul_layer<TensorDataType,data_layout::DATA_PARALLEL,El::
   auto& local_output = dynamic_cast<LocalMat&>(l.get_local_activations());
   const auto& local_mini_batch_size = local_input0.Width();
 
+  // Return immediately if nothing needs to be done
+  if (local_mini_batch_size < 1) { return; }
+
   // Matrix dimensions
   const auto input0_dims = l.get_input_dims(0);
   const auto input1_dims = l.get_input_dims(1);
   const auto output_dims = l.get_output_dims();
   const El::Int input0_height = *(input0_dims.rbegin()+1);
   const El::Int input0_width = *(input0_dims.rbegin());
-  const El::Int input1_height = *(input1_dims.rbegin()+1);
   const El::Int input1_width = *(input1_dims.rbegin());
   const El::Int output_height = *(output_dims.rbegin()+1);
   const El::Int output_width = *(output_dims.rbegin());
 
   // Compute matrix multiplication for each mini-batch sample
-  // Note: Elemental matrices are in Fortran layout while LBANN
+  // Note: BLAS expects matrices in Fortran layout while LBANN
   // tensors are in C layout.
-  LBANN_OMP_PARALLEL_FOR
-  for (El::Int i = 0; i < local_mini_batch_size; ++i) {
-    LocalMat input0_v, input1_v, output_v;
-    input0_v.LockedAttach(input0_width, input0_height,
-                          local_input0.LockedBuffer(0,i), input0_width);
-    input1_v.LockedAttach(input1_width, input1_height,
-                          local_input1.LockedBuffer(0,i), input1_width);
-    output_v.Attach(output_width, output_height,
-                    local_output.Buffer(0,i), output_width);
-    El::Gemm(transpose_input1 ? El::TRANSPOSE : El::NORMAL,
-             transpose_input0 ? El::TRANSPOSE : El::NORMAL,
-             El::TypeTraits<TensorDataType>::One(), input1_v, input0_v,
-             El::TypeTraits<TensorDataType>::Zero(), output_v);
-  }
+  gemm_strided_batched(
+    transpose_input1 ? El::TRANSPOSE : El::NORMAL,
+    transpose_input0 ? El::TRANSPOSE : El::NORMAL,
+    output_width,
+    output_height,
+    transpose_input0 ? input0_height : input0_width,
+    El::TypeTraits<TensorDataType>::One(),
+    local_input1.LockedBuffer(), input1_width, local_input1.LDim(),
+    local_input0.LockedBuffer(), input0_width, local_input0.LDim(),
+    El::TypeTraits<TensorDataType>::Zero(),
+    local_output.Buffer(), output_width, local_output.LDim(),
+    local_mini_batch_size);
 
 }
 
@@ -89,6 +90,9 @@ void bp_compute_impl(matmul_layer<TensorDataType,data_layout::DATA_PARALLEL,El::
   auto& local_input1_grad = dynamic_cast<LocalMat&>(l.get_local_error_signals(1));
   const auto& local_mini_batch_size = local_input0.Width();
 
+  // Return immediately if nothing needs to be done
+  if (local_mini_batch_size < 1) { return; }
+
   // Matrix dimensions
   const auto input0_dims = l.get_input_dims(0);
   const auto input1_dims = l.get_input_dims(1);
@@ -101,45 +105,55 @@ void bp_compute_impl(matmul_layer<TensorDataType,data_layout::DATA_PARALLEL,El::
   const El::Int output_width = *(output_dims.rbegin());
 
   // Compute gradients for each mini-batch sample
-  // Note: Elemental matrices are in Fortran layout while LBANN
+  // Note: BLAS expects matrices in Fortran layout while LBANN
   // tensors are in C layout.
-  LBANN_OMP_PARALLEL_FOR
-  for (El::Int i = 0; i < local_mini_batch_size; ++i) {
-    LocalMat input0_v, input1_v, output_grad_v, input0_grad_v, input1_grad_v;
-    input0_v.LockedAttach(input0_width, input0_height,
-                          local_input0.LockedBuffer(0,i), input0_width);
-    input1_v.LockedAttach(input1_width, input1_height,
-                          local_input1.LockedBuffer(0,i), input1_width);
-    output_grad_v.LockedAttach(output_width, output_height,
-                               local_output_grad.LockedBuffer(0,i), output_width);
-    input0_grad_v.Attach(input0_width, input0_height,
-                         local_input0_grad.Buffer(0,i), input0_width);
-    input1_grad_v.Attach(input1_width, input1_height,
-                         local_input1_grad.Buffer(0,i), input1_width);
-    if (transpose_input0) {
-      El::Gemm(El::TRANSPOSE,
-               transpose_input1 ? El::TRANSPOSE : El::NORMAL,
-               El::TypeTraits<TensorDataType>::One(), output_grad_v, input1_v,
-               El::TypeTraits<TensorDataType>::Zero(), input0_grad_v);
-    }
-    else {
-      El::Gemm(transpose_input1 ? El::NORMAL : El::TRANSPOSE,
-               El::NORMAL,
-               El::TypeTraits<TensorDataType>::One(), input1_v, output_grad_v,
-               El::TypeTraits<TensorDataType>::Zero(), input0_grad_v);
-    }
-    if (transpose_input1) {
-      El::Gemm(transpose_input0 ? El::TRANSPOSE : El::NORMAL,
-               El::TRANSPOSE,
-               El::TypeTraits<TensorDataType>::One(), input0_v, output_grad_v,
-               El::TypeTraits<TensorDataType>::Zero(), input1_grad_v);
-    }
-    else {
-      El::Gemm(El::NORMAL,
-               transpose_input0 ? El::NORMAL : El::TRANSPOSE,
-               El::TypeTraits<TensorDataType>::One(), output_grad_v, input0_v,
-               El::TypeTraits<TensorDataType>::Zero(), input1_grad_v);
-    }
+  if (transpose_input0) {
+    gemm_strided_batched(
+      El::TRANSPOSE,
+      transpose_input1 ? El::TRANSPOSE : El::NORMAL,
+      input0_width, input0_height, output_width,
+      El::TypeTraits<TensorDataType>::One(),
+      local_output_grad.LockedBuffer(), output_width, local_output_grad.LDim(),
+      local_input1.LockedBuffer(), input1_width, local_input1.LDim(),
+      El::TypeTraits<TensorDataType>::Zero(),
+      local_input0_grad.Buffer(), input0_width, local_input0_grad.LDim(),
+      local_mini_batch_size);
+  }
+  else {
+    gemm_strided_batched(
+      transpose_input1 ? El::NORMAL : El::TRANSPOSE,
+      El::NORMAL,
+      input0_width, input0_height, output_width,
+      El::TypeTraits<TensorDataType>::One(),
+      local_input1.LockedBuffer(), input1_width, local_input1.LDim(),
+      local_output_grad.LockedBuffer(), output_width, local_output_grad.LDim(),
+      El::TypeTraits<TensorDataType>::Zero(),
+      local_input0_grad.Buffer(), input0_width, local_input0_grad.LDim(),
+      local_mini_batch_size);
+  }
+  if (transpose_input1) {
+    gemm_strided_batched(
+      transpose_input0 ? El::TRANSPOSE : El::NORMAL,
+      El::TRANSPOSE,
+      input1_width, input1_height, output_height,
+      El::TypeTraits<TensorDataType>::One(),
+      local_input0.LockedBuffer(), input0_width, local_input0.LDim(),
+      local_output_grad.LockedBuffer(), output_width, local_output_grad.LDim(),
+      El::TypeTraits<TensorDataType>::Zero(),
+      local_input1_grad.Buffer(), input1_width, local_input1_grad.LDim(),
+      local_mini_batch_size);
+  }
+  else {
+    gemm_strided_batched(
+      El::NORMAL,
+      transpose_input0 ? El::NORMAL : El::TRANSPOSE,
+      input1_width, input1_height, output_height,
+      El::TypeTraits<TensorDataType>::One(),
+      local_output_grad.LockedBuffer(), output_width, local_output_grad.LDim(),
+      local_input0.LockedBuffer(), input0_width, local_input0.LDim(),
+      El::TypeTraits<TensorDataType>::Zero(),
+      local_input1_grad.Buffer(), input1_width, local_input1_grad.LDim(),
+      local_mini_batch_size);
   }
 
 }
@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#define LBANN_ARGMIN_LAYER_INSTANTIATE
+#include "lbann/layers/misc/argmin.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <algorithm>
+
+namespace lbann {
+
+namespace {
+
+/** Columns handled by each block. */
+constexpr El::Int cols_per_block = 8;
+
+/** Find the index of the minimum entry in each column.
+ *
+ *  Each column is handled by one warp. Each lane scans a strided
+ *  subset of the column and the partial results are combined with
+ *  warp shuffles. Ties go to the lower index, matching
+ *  @c std::min_element.
+ *
+ *  Block dimensions: 32 x cols_per_block x 1
+ *
+ *  Grid dimensions: (width / cols_per_block) x 1 x 1
+ */
+template <typename TensorDataType>
+__global__ void fp_kernel(El::Int height,
+                          El::Int width,
+                          const TensorDataType* __restrict__ input,
+                          El::Int input_ldim,
+                          TensorDataType* __restrict__ output,
+                          El::Int output_ldim) {
+  const El::Int lane = threadIdx.x;
+  const El::Int num_cols_per_iter = blockDim.y * gridDim.x;
+  for (El::Int col = threadIdx.y + blockIdx.x * blockDim.y;
+       col < width;
+       col += num_cols_per_iter) {
+
+    // Partial result for this lane
+    // Note: An index of height means no entry has been seen yet.
+    TensorDataType best_val(0.f);
+    El::Int best_ind = height;
+    for (El::Int row = lane; row < height; row += 32) {
+      const auto& x = input[row + col * input_ldim];
+      if (best_ind == height || x < best_val) {
+        best_val = x;
+        best_ind = row;
+      }
+    }
+
+    // Combine partial results within the warp
+    for (int offset = 16; offset > 0; offset /= 2) {
+      const auto val = __shfl_down_sync(0xffffffff, best_val, offset);
+      const auto ind = __shfl_down_sync(0xffffffff, best_ind, offset);
+      if (ind < height
+          && (best_ind == height
+              || val < best_val
+              || (val == best_val && ind < best_ind))) {
+        best_val = val;
+        best_ind = ind;
+      }
+    }
+    if (lane == 0) {
+      output[col * output_ldim] = TensorDataType(best_ind);
+    }
+
+  }
+}
+
+} // namespace <anon>
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void argmin_layer<TensorDataType, Layout, Device>::fp_compute() {
+  using GPUMatType = El::Matrix<TensorDataType, El::Device::GPU>;
+  const auto& local_input =
+    dynamic_cast<const GPUMatType&>(this->get_local_prev_activations());
+  auto& local_output = dynamic_cast<GPUMatType&>(this->get_local_activations());
+  const El::Int local_height = local_input.Height();
+  const El::Int local_width = local_input.Width();
+  if (local_height > 0 && local_width > 0) {
+    dim3 block_dims, grid_dims;
+    block_dims.x = 32;
+    block_dims.y = cols_per_block;
+    grid_dims.x = std::min((local_width + cols_per_block - 1) / cols_per_block,
+                           El::Int(65535));
+    fp_kernel<<<grid_dims, block_dims, 0, El::GPUManager::Stream()>>>(
+      local_height, local_width,
+      local_input.LockedBuffer(), local_input.LDim(),
+      local_output.Buffer(), local_output.LDim());
+    CHECK_CUDA(cudaGetLastError());
+  }
+}
+
+#define PROTO(T)                     \
+  template class argmin_layer<T, data_layout::DATA_PARALLEL, El::Device::GPU>
+
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
@@ -27,10 +27,20 @@
 #define LBANN_CHANNELWISE_MEAN_LAYER_INSTANTIATE
 #include "lbann/layers/misc/channelwise_mean.hpp"
 
+#include <algorithm>
+
 namespace lbann {
 
 namespace {
 
+/** Channel-wise means.
+ *  Each block reduces whole channels, so the outputs are written
+ *  directly without zero-initialization or atomics.
+ *
+ *  Block dimensions: block_size x 1 x 1
+ *
+ *  Grid dimensions: 1 x num_channels x width
+ */
 template <El::Int block_size, typename TensorDataType>
 __global__ void mean_kernel(El::Int num_channels,
                             El::Int channel_size,
@@ -42,26 +52,25 @@ __global__ void mean_kernel(El::Int num_channels,
 
   // Indices
   const El::Int tid = threadIdx.x;
-  const El::Int gidx = threadIdx.x + blockIdx.x * blockDim.x;
   const El::Int bidy = blockIdx.y;
   const El::Int bidz = blockIdx.z;
-  const El::Int nthreadsx = blockDim.x * gridDim.x;
   const El::Int nblocksy = gridDim.y;
   const El::Int nblocksz = gridDim.z;
 
-  // Compute local contribution for each channel
+  // Compute mean for each channel
+  __shared__ TensorDataType shared_sums[block_size];
   for (El::Int col = bidz; col < width; col += nblocksz) {
     for (El::Int channel = bidy; channel < num_channels; channel += nblocksy) {
 
       // Sum for each thread
+      const auto* __restrict__ channel_input = &input[channel*channel_size + col*input_ldim];
       TensorDataType private_sum = 0;
-      for (El::Int i = gidx; i < channel_size; i += nthreadsx) {
-        private_sum += input[i + channel*channel_size + col*input_ldim];
+      for (El::Int i = tid; i < channel_size; i += block_size) {
+        private_sum += channel_input[i];
       }
 
       // Shared memory reduction to get sum for each block
-      /// @todo unroll loops
-      __shared__ TensorDataType shared_sums[block_size];
+      __syncthreads();
       shared_sums[tid] = private_sum;
       for (El::Int stride = block_size / 2; stride > 0; stride /= 2) {
         __syncthreads();
@@ -70,8 +79,7 @@ __global__ void mean_kernel(El::Int num_channels,
         }
       }
       if (tid == 0) {
-        cuda::atomic_add(&output[channel + col * output_ldim],
-                         shared_sums[0] / TensorDataType(channel_size));
+        output[channel + col * output_ldim] = shared_sums[0] / TensorDataType(channel_size);
       }
 
     }
@@ -130,19 +138,29 @@ void channelwise_mean_layer<TensorDataType, Layout, Device>::fp_compute() {
   const auto& local_width = local_input.Width();
 
   // Compute channel-wise mean
-  El::Zero(local_output);
+  // Note: The block size is chosen so that small channels do not
+  // leave most threads idle.
   if (!local_input.IsEmpty()) {
-    constexpr El::Int block_size = 256;
-    dim3 block_dims, grid_dims;
-    block_dims.x = block_size;
-    grid_dims.x = (channel_size + block_size - 1) / block_size;
-    grid_dims.y = num_channels;
-    grid_dims.z = local_width;
-    mean_kernel<block_size>
-      <<<grid_dims, block_dims, 0, El::GPUManager::Stream()>>>(
+    dim3 grid_dims;
+    grid_dims.y = std::min(num_channels, El::Int(65535));
+    grid_dims.z = std::min(local_width, El::Int(65535));
+    auto&& stream = El::GPUManager::Stream();
+    if (channel_size <= 256) {
+      mean_kernel<32><<<grid_dims, 32, 0, stream>>>(
+        num_channels, channel_size, local_width,
+        local_input.LockedBuffer(), local_input.LDim(),
+        local_output.Buffer(), local_output.LDim());
+    } else if (channel_size <= 8192) {
+      mean_kernel<256><<<grid_dims, 256, 0, stream>>>(
         num_channels, channel_size, local_width,
         local_input.LockedBuffer(), local_input.LDim(),
         local_output.Buffer(), local_output.LDim());
+    } else {
+      mean_kernel<1024><<<grid_dims, 1024, 0, stream>>>(
+        num_channels, channel_size, local_width,
+        local_input.LockedBuffer(), local_input.LDim(),
+        local_output.Buffer(), local_output.LDim());
+    }
   }
 
 }
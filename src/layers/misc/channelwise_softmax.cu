@@ -28,21 +28,14 @@
 #include "lbann/layers/misc/channelwise_softmax.hpp"
 #include "lbann/utils/cuda.hpp"
 
+#include <algorithm>
+
 namespace lbann {
 
 namespace {
 
 using Size3 = cuda::array<size_t,3>;
 
-/** @brief Max functor */
-template <class T>
-struct max_op {
-  __device__ __forceinline__
-  DataType operator()(const T& x1, const T& x2) const {
-    return cuda::max(x1, x2);
-  }
-};
-
 } // namespace <anon>
 
 // =========================================================
@@ -51,111 +44,83 @@ struct max_op {
 
 namespace {
 
-/** @brief Max reduction over last dimension of 3D tensor.
- *
- *  Each CUDA block computes the max over a subset of tensor entries
- *  in @c vals and outputs the result to @c maxvals. This should be
- *  repeated multiple times to fully reduce the last tensor dimension.
- *
- *  Block dimensions: bdimx x 1 x 1
- *
- *  Grid dimensions: (vals_dims[2] / bdimx) x vals_dims[1] x vals_dims[0]
+/** Compute softmax shift and denominator in one pass.
  *
- *  maxvals: vals_dims[0] x vals_dims[1] x (vals_dims[2] / bdimx)
- */
-template <typename TensorDataType, size_t bdimx>
-__global__ void fp_max_kernel(
-  Size3 vals_dims,
-  const TensorDataType* __restrict__ vals_buffer,
-  Size3 vals_strides,
-  TensorDataType* __restrict__ maxvals_buffer,
-  Size3 maxvals_strides) {
-
-  // Indices and dimensions
-  constexpr size_t bdimy = 1;
-  constexpr size_t bdimz = 1;
-  const size_t tid = threadIdx.x;
-  const size_t bidx = blockIdx.x;
-  const size_t gidx = threadIdx.x + blockIdx.x * blockDim.x;
-  const size_t gidy = threadIdx.y + blockIdx.y * blockDim.y;
-  const size_t gidz = threadIdx.z + blockIdx.z * blockDim.z;
-  const size_t nthreadsx = blockDim.x * gridDim.x;
-  const size_t nthreadsy = blockDim.y * gridDim.y;
-  const size_t nthreadsz = blockDim.z * gridDim.z;
-
-  for (size_t k = gidz; k < vals_dims[0]; k += nthreadsz) {
-    for (size_t j = gidy; j < vals_dims[1]; j += nthreadsy) {
-
-      // Find largest value for each thread
-      TensorDataType maxval{-cuda::infinity<TensorDataType>()};
-      for (size_t i = gidx; i < vals_dims[2]; i += nthreadsx) {
-        const auto& val = vals_buffer[k * vals_strides[0]
-                                      + j * vals_strides[1]
-                                      + i * vals_strides[2]];
-        maxval = cuda::max(maxval, val);
-      }
-
-      // Find largest value for each block
-      maxval = cuda::block_reduce<bdimx,bdimy,bdimz,TensorDataType,max_op<TensorDataType>>(maxval);
-      if (tid == 0) {
-        const auto& pos = (k * maxvals_strides[0]
-                           + j * maxvals_strides[1]
-                           + bidx * maxvals_strides[2]);
-        maxvals_buffer[pos] = maxval;
-      }
-
-    }
-  }
-
-}
-
-/** Compute softmax denominator.
+ *  shift = max( x_i )
  *
  *  denom = sum( exp(x_i-shift) )
  *
+ *  Each thread keeps a running max and a running sum that is rescaled
+ *  whenever the max grows ("online softmax"), so the input is only
+ *  read once. Each CUDA block handles whole channels.
+ *
  *  Block dimensions: bdimx x 1 x 1
  *
- *  Grid dimensions: (input_dims[2] / bdimx) x input_dims[1] x input_dims[0]
+ *  Grid dimensions: 1 x input_dims[1] x input_dims[0]
  *
  *  shifts and denoms are fully-packed 2D tensors with dimensions of
  *  input_dims[0] x input_dims[1].
  */
 template <typename TensorDataType, size_t bdimx>
-__global__ void fp_denom_kernel(
+__global__ void fp_stats_kernel(
   Size3 input_dims,
   const TensorDataType* __restrict__ input_buffer,
   Size3 input_strides,
-  const TensorDataType* __restrict__ shifts,
+  TensorDataType* __restrict__ shifts,
   TensorDataType* __restrict__ denoms) {
 
   // Indices and dimensions
-  constexpr size_t bdimy = 1;
-  constexpr size_t bdimz = 1;
   const size_t tid = threadIdx.x;
-  const size_t gidx = threadIdx.x + blockIdx.x * blockDim.x;
-  const size_t gidy = threadIdx.y + blockIdx.y * blockDim.y;
-  const size_t gidz = threadIdx.z + blockIdx.z * blockDim.z;
-  const size_t nthreadsx = blockDim.x * gridDim.x;
-  const size_t nthreadsy = blockDim.y * gridDim.y;
-  const size_t nthreadsz = blockDim.z * gridDim.z;
+  const size_t nblocksy = gridDim.y;
+  const size_t nblocksz = gridDim.z;
 
-  for (size_t k = gidz; k < input_dims[0]; k += nthreadsz) {
-    for (size_t j = gidy; j < input_dims[1]; j += nthreadsy) {
+  __shared__ TensorDataType shared_maxvals[bdimx];
+  __shared__ TensorDataType shared_denoms[bdimx];
+  for (size_t k = blockIdx.z; k < input_dims[0]; k += nblocksz) {
+    for (size_t j = blockIdx.y; j < input_dims[1]; j += nblocksy) {
 
-      // Compute contribution from each thread
-      const auto& shift = shifts[j + k*input_dims[1]];
+      // Running max and denominator for each thread
+      TensorDataType maxval{-cuda::infinity<TensorDataType>()};
       TensorDataType denom{0.};
-      for (size_t i = gidx; i < input_dims[2]; i += nthreadsx) {
+      for (size_t i = tid; i < input_dims[2]; i += bdimx) {
         const auto& x = input_buffer[k * input_strides[0]
                                      + j * input_strides[1]
                                      + i * input_strides[2]];
-        denom += cuda::exp(x-shift);
+        if (x > maxval) {
+          denom = denom * cuda::exp(maxval-x) + TensorDataType(1.);
+          maxval = x;
+        }
+        else {
+          denom += cuda::exp(x-maxval);
+        }
       }
 
-      // Compute contribution from each block
-      denom = cuda::block_reduce<bdimx,bdimy,bdimz>(denom);
+      // Merge running values within block
+      __syncthreads();
+      shared_maxvals[tid] = maxval;
+      shared_denoms[tid] = denom;
+      for (size_t stride = bdimx / 2; stride > 0; stride /= 2) {
+        __syncthreads();
+        if (tid < stride && shared_denoms[tid + stride] > TensorDataType(0.)) {
+          const auto& maxval1 = shared_maxvals[tid];
+          const auto& maxval2 = shared_maxvals[tid + stride];
+          const auto& denom1 = shared_denoms[tid];
+          const auto& denom2 = shared_denoms[tid + stride];
+          if (denom1 > TensorDataType(0.)) {
+            const auto& new_maxval = cuda::max(maxval1, maxval2);
+            shared_denoms[tid] = (denom1 * cuda::exp(maxval1-new_maxval)
+                                  + denom2 * cuda::exp(maxval2-new_maxval));
+            shared_maxvals[tid] = new_maxval;
+          }
+          else {
+            shared_denoms[tid] = denom2;
+            shared_maxvals[tid] = maxval2;
+          }
+        }
+      }
       if (tid == 0) {
-        cuda::atomic_add(&denoms[j+k*input_dims[1]], denom);
+        shifts[j+k*input_dims[1]] = shared_maxvals[0];
+        denoms[j+k*input_dims[1]] = shared_denoms[0];
       }
 
     }
@@ -224,56 +189,36 @@ void fp_impl(size_t num_channels,
   const size_t local_mini_batch_size = local_input.Width();
   // const Size3 input_dims{local_mini_batch_size, num_channels, channel_size};
 
-  // Compute softmax shifts
-  LocalMat local_shifts;
-  if (!local_input.IsEmpty()) {
-    constexpr size_t block_size = 256;
-    dim3 block_dims, grid_dims;
-    block_dims.x = block_size;
-    grid_dims.x = (channel_size + block_size - 1) / block_size;
-    grid_dims.y = num_channels;
-    grid_dims.z = local_mini_batch_size;
-    LocalMat maxvals(grid_dims.x * num_channels, local_mini_batch_size);
-    fp_max_kernel<TensorDataType,block_size>
-      <<<grid_dims, block_dims, 0, El::GPUManager::Stream()>>>(
-        {local_mini_batch_size, num_channels, channel_size},
-        local_input.LockedBuffer(),
-        {static_cast<size_t>(local_input.LDim()), channel_size, 1},
-        maxvals.Buffer(),
-        {static_cast<size_t>(maxvals.LDim()), grid_dims.x, 1});
-    while (grid_dims.x > 1) {
-      const size_t prev_dim = grid_dims.x;
-      grid_dims.x = (prev_dim + block_size - 1) / block_size;
-      const LocalMat prev_maxvals(std::move(maxvals));
-      maxvals.Resize(grid_dims.x * num_channels, local_mini_batch_size);
-      fp_max_kernel<TensorDataType,block_size>
-        <<<grid_dims, block_dims, 0, El::GPUManager::Stream()>>>(
-          {local_mini_batch_size, num_channels, prev_dim},
-          prev_maxvals.LockedBuffer(),
-          {static_cast<size_t>(prev_maxvals.LDim()), prev_dim, 1},
-          maxvals.Buffer(),
-          {static_cast<size_t>(maxvals.LDim()), grid_dims.x, 1});
-    }
-    local_shifts = std::move(maxvals);
-  }
-
-  // Compute softmax denominators
+  // Compute softmax shifts and denominators
+  // Note: The block size is chosen so that small channels do not
+  // leave most threads idle.
+  LocalMat local_shifts(num_channels, local_mini_batch_size);
   LocalMat local_denoms(num_channels, local_mini_batch_size);
-  El::Zero(local_denoms);
   if (!local_input.IsEmpty()) {
-    constexpr size_t block_size = 256;
-    dim3 block_dims, grid_dims;
-    block_dims.x = block_size;
-    grid_dims.x = (channel_size + block_size - 1) / block_size;
-    grid_dims.y = num_channels;
-    grid_dims.z = local_mini_batch_size;
-    fp_denom_kernel<TensorDataType,block_size>
-      <<<grid_dims, block_dims, 0, El::GPUManager::Stream()>>>(
-        {local_mini_batch_size, num_channels, channel_size},
-        local_input.LockedBuffer(),
-        {static_cast<size_t>(local_input.LDim()), channel_size, 1},
-        local_shifts.LockedBuffer(),
-        local_denoms.Buffer());
+    dim3 grid_dims;
+    grid_dims.y = std::min(num_channels, size_t(65535));
+    grid_dims.z = std::min(local_mini_batch_size, size_t(65535));
+    auto&& stream = El::GPUManager::Stream();
+    const Size3 input_dims{local_mini_batch_size, num_channels, channel_size};
+    const Size3 input_strides{static_cast<size_t>(local_input.LDim()), channel_size, 1};
+    if (channel_size <= 256) {
+      fp_stats_kernel<TensorDataType,32>
+        <<<grid_dims, 32, 0, stream>>>(
+          input_dims, local_input.LockedBuffer(), input_strides,
+          local_shifts.Buffer(), local_denoms.Buffer());
+    }
+    else if (channel_size <= 8192) {
+      fp_stats_kernel<TensorDataType,256>
+        <<<grid_dims, 256, 0, stream>>>(
+          input_dims, local_input.LockedBuffer(), input_strides,
+          local_shifts.Buffer(), local_denoms.Buffer());
+    }
+    else {
+      fp_stats_kernel<TensorDataType,1024>
+        <<<grid_dims, 1024, 0, stream>>>(
+          input_dims, local_input.LockedBuffer(), input_strides,
+          local_shifts.Buffer(), local_denoms.Buffer());
+    }
   }
 
   // Compute softmax
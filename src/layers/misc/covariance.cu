@@ -26,117 +26,177 @@
 
 #define LBANN_COVARIANCE_LAYER_INSTANTIATE
 #include "lbann/layers/misc/covariance.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <algorithm>
 
 namespace lbann {
 
 namespace {
 
-/** Compute local contributions to means.
- *  Computes column-wise sums of two input matrices and multiplies
- *  them by a scaling factor (which should be
- *  1/height). 'contribution' is interpreted as a 2 x width matrix
- *  where the first row corresponds to 'input0' and the second row to
- *  'input1'.
+/** Combine the moments of two sets of value pairs.
+ *  Uses the pairwise update of Chan et al. comoment is the sum of
+ *  products of differences from the means.
  */
-template <typename TensorDataType, El::Int block_size>
-__global__ void mean_contribution_kernel(El::Int height,
-                                         El::Int width,
-                                         TensorDataType scale,
-                                         const TensorDataType* __restrict__ input0,
-                                         El::Int input0_ldim,
-                                         const TensorDataType* __restrict__ input1,
-                                         El::Int input1_ldim,
-                                         TensorDataType* __restrict__ contribution) {
-
-  // Indices
-  const El::Int tid = threadIdx.x;
-  const El::Int gidx = threadIdx.x + blockIdx.x * blockDim.x;
-  const El::Int bidy = blockIdx.y;
-  const El::Int nthreadsx = blockDim.x * gridDim.x;
-
-  // Compute local contribution for each matrix column
-  for (El::Int col = bidy; col < width; col += gridDim.y) {
-
-    // Compute contributions for each thread
-    TensorDataType private_contribution0 = 0;
-    TensorDataType private_contribution1 = 0;
-    for (El::Int row = gidx; row < height; row += nthreadsx) {
-      private_contribution0 += input0[row + col * input0_ldim];
-      private_contribution1 += input1[row + col * input1_ldim];
-    }
-
-    // Shared memory reduction to get contribution for each block
-    /// @todo unroll loops
-    __shared__ TensorDataType shared_contribution0[block_size];
-    __shared__ TensorDataType shared_contribution1[block_size];
-    shared_contribution0[tid] = private_contribution0;
-    shared_contribution1[tid] = private_contribution1;
-    for (El::Int stride = block_size / 2; stride > 0; stride /= 2) {
-      __syncthreads();
-      if (tid < stride) {
-        shared_contribution0[tid] += shared_contribution0[tid + stride];
-        shared_contribution1[tid] += shared_contribution1[tid + stride];
-      }
-    }
-    if (tid == 0) {
-      cuda::atomic_add(&contribution[2*col],
-                       scale * shared_contribution0[0]);
-      cuda::atomic_add(&contribution[2*col+1],
-                       scale * shared_contribution1[0]);
-    }
-
-  }
-
+template <typename TensorDataType>
+__device__ __forceinline__
+void merge_comoments(El::Int& count,
+                     TensorDataType& mean0,
+                     TensorDataType& mean1,
+                     TensorDataType& comoment,
+                     El::Int other_count,
+                     const TensorDataType& other_mean0,
+                     const TensorDataType& other_mean1,
+                     const TensorDataType& other_comoment) {
+  if (other_count == 0) { return; }
+  const El::Int total = count + other_count;
+  const TensorDataType delta0 = other_mean0 - mean0;
+  const TensorDataType delta1 = other_mean1 - mean1;
+  const TensorDataType weight(double(other_count) / double(total));
+  mean0 += delta0 * weight;
+  mean1 += delta1 * weight;
+  comoment += other_comoment + delta0 * delta1 * TensorDataType(double(count) * double(other_count) / double(total));
+  count = total;
 }
 
-/** Compute local contributions to covariances. */
+/** Single-pass column-wise means and covariance contribution.
+ *  Each thread runs Welford's algorithm over a strided subset of the
+ *  column and the results are merged within the block, so no
+ *  intermediate means are needed. 'means' is interpreted as a 2 x
+ *  width matrix where the first row corresponds to 'input0' and the
+ *  second row to 'input1'. Outputs scale times the sum of products of
+ *  differences from the means.
+ *
+ *  Block dimensions: block_size x 1 x 1
+ *
+ *  Grid dimensions: 1 x width x 1
+ */
 template <typename TensorDataType, El::Int block_size>
-__global__ void covariance_contribution_kernel(El::Int height,
-                                               El::Int width,
-                                               TensorDataType scale,
-                                               const TensorDataType* __restrict__ input0,
-                                               El::Int input0_ldim,
-                                               const TensorDataType* __restrict__ input1,
-                                               El::Int input1_ldim,
-                                               const TensorDataType* __restrict__ means,
-                                               TensorDataType* __restrict__ contribution) {
-
-  // Indices
+__global__ void covariance_stats_kernel(El::Int height,
+                                        El::Int width,
+                                        TensorDataType scale,
+                                        const TensorDataType* __restrict__ input0,
+                                        El::Int input0_ldim,
+                                        const TensorDataType* __restrict__ input1,
+                                        El::Int input1_ldim,
+                                        TensorDataType* __restrict__ means,
+                                        TensorDataType* __restrict__ comoments) {
   const El::Int tid = threadIdx.x;
-  const El::Int gidx = threadIdx.x + blockIdx.x * blockDim.x;
-  const El::Int bidy = blockIdx.y;
-  const El::Int nthreadsx = blockDim.x * gridDim.x;
-
-  // Compute local contribution for each matrix column
-  for (El::Int col = bidy; col < width; col += gridDim.y) {
-    const auto& mean0 = means[2*col];
-    const auto& mean1 = means[2*col+1];
-
-    // Compute contributions for each thread
-    TensorDataType private_contribution = 0;
-    for (El::Int row = gidx; row < height; row += nthreadsx) {
+  __shared__ El::Int shared_count[block_size];
+  __shared__ TensorDataType shared_mean0[block_size];
+  __shared__ TensorDataType shared_mean1[block_size];
+  __shared__ TensorDataType shared_comoment[block_size];
+  for (El::Int col = blockIdx.y; col < width; col += gridDim.y) {
+
+    // Welford's algorithm for each thread
+    El::Int count = 0;
+    TensorDataType mean0 = 0, mean1 = 0, comoment = 0;
+    for (El::Int row = tid; row < height; row += block_size) {
       const auto& x0 = input0[row + col * input0_ldim];
       const auto& x1 = input1[row + col * input1_ldim];
-      private_contribution += (x0 - mean0) * (x1 - mean1);
+      ++count;
+      const TensorDataType delta0 = x0 - mean0;
+      mean0 += delta0 / TensorDataType(count);
+      mean1 += (x1 - mean1) / TensorDataType(count);
+      comoment += delta0 * (x1 - mean1);
     }
 
-    // Shared memory reduction to get contribution for each block
-    /// @todo unroll loops
-    __shared__ TensorDataType shared_contribution[block_size];
-    shared_contribution[tid] = private_contribution;
+    // Shared memory reduction to get moments for each column
+    __syncthreads();
+    shared_count[tid] = count;
+    shared_mean0[tid] = mean0;
+    shared_mean1[tid] = mean1;
+    shared_comoment[tid] = comoment;
     for (El::Int stride = block_size / 2; stride > 0; stride /= 2) {
       __syncthreads();
       if (tid < stride) {
-        shared_contribution[tid] += shared_contribution[tid + stride];
+        merge_comoments(shared_count[tid], shared_mean0[tid],
+                        shared_mean1[tid], shared_comoment[tid],
+                        shared_count[tid + stride],
+                        shared_mean0[tid + stride],
+                        shared_mean1[tid + stride],
+                        shared_comoment[tid + stride]);
       }
     }
     if (tid == 0) {
-      cuda::atomic_add(&contribution[col],
-                       scale * shared_contribution[0]);
+      means[2*col] = shared_mean0[0];
+      means[2*col+1] = shared_mean1[0];
+      comoments[col] = scale * shared_comoment[0];
     }
 
   }
+}
 
+/** Merge moments gathered from the processes that share columns.
+ *  partials holds, for each process, the local means of each column
+ *  (as a 2 x width matrix) followed by the local comoments.
+ *
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: (width / bsize) x 1 x 1
+ */
+template <typename TensorDataType>
+__global__ void covariance_merge_kernel(El::Int height,
+                                        El::Int width,
+                                        El::Int num_procs,
+                                        El::Int col_align,
+                                        TensorDataType scale,
+                                        const TensorDataType* __restrict__ partials,
+                                        TensorDataType* __restrict__ means,
+                                        TensorDataType* __restrict__ covariances) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int nthreads = blockDim.x * gridDim.x;
+  for (El::Int col = gid; col < width; col += nthreads) {
+    El::Int count = 0;
+    TensorDataType mean0 = 0, mean1 = 0, comoment = 0;
+    for (El::Int rank = 0; rank < num_procs; ++rank) {
+      const El::Int shift = (rank + num_procs - col_align) % num_procs;
+      const El::Int rank_count = (height > shift
+                                  ? (height - shift - 1) / num_procs + 1
+                                  : 0);
+      const auto* rank_partials = &partials[3 * width * rank];
+      merge_comoments(count, mean0, mean1, comoment, rank_count,
+                      rank_partials[2*col], rank_partials[2*col+1],
+                      rank_partials[2 * width + col]);
+    }
+    means[2*col] = mean0;
+    means[2*col+1] = mean1;
+    covariances[col] = scale * comoment;
+  }
+}
+
+/** Launch the stats kernel with a block size suited to the column
+ *  height.
+ */
+template <typename TensorDataType>
+void launch_covariance_stats(El::Int height,
+                             El::Int width,
+                             TensorDataType scale,
+                             const TensorDataType* input0,
+                             El::Int input0_ldim,
+                             const TensorDataType* input1,
+                             El::Int input1_ldim,
+                             TensorDataType* means,
+                             TensorDataType* comoments) {
+  dim3 grid_dims;
+  grid_dims.y = std::min(width, El::Int(65535));
+  auto&& stream = El::GPUManager::Stream();
+  if (height <= 2048) {
+    covariance_stats_kernel<TensorDataType, 64>
+      <<<grid_dims, 64, 0, stream>>>(
+        height, width, scale, input0, input0_ldim, input1, input1_ldim,
+        means, comoments);
+  } else if (height <= 65536) {
+    covariance_stats_kernel<TensorDataType, 256>
+      <<<grid_dims, 256, 0, stream>>>(
+        height, width, scale, input0, input0_ldim, input1, input1_ldim,
+        means, comoments);
+  } else {
+    covariance_stats_kernel<TensorDataType, 1024>
+      <<<grid_dims, 1024, 0, stream>>>(
+        height, width, scale, input0, input0_ldim, input1, input1_ldim,
+        means, comoments);
+  }
 }
 
 /** Compute gradients w.r.t. inputs. */
@@ -174,69 +234,84 @@ void covariance_backprop_kernel(El::Int height,
 }
 
 /** GPU forward prop implementation.
- *  We use a two-pass algorithm since it is more numerically stable
- *  than the naive single-pass algorithm.
+ *  Means and covariances are computed in a single numerically stable
+ *  pass. If the columns are split among processes, the local moments
+ *  are gathered in one collective and merged.
  */
 template <typename TensorDataType>
-void fp_gpu(const El::AbstractDistMatrix<TensorDataType>& input0,
+void fp_gpu(lbann_comm& comm,
+            const El::AbstractDistMatrix<TensorDataType>& input0,
             const El::AbstractDistMatrix<TensorDataType>& input1,
             El::AbstractDistMatrix<TensorDataType>& output,
             El::AbstractDistMatrix<TensorDataType>& means,
             El::AbstractDistMatrix<TensorDataType>& workspace,
             bool biased) {
-
-  // Local matrices
-  const auto& local_input0 = static_cast<const El::Matrix<TensorDataType, El::Device::GPU>&>(input0.LockedMatrix());
-  const auto& local_input1 = static_cast<const El::Matrix<TensorDataType, El::Device::GPU>&>(input1.LockedMatrix());
-  auto& local_means = static_cast<El::Matrix<TensorDataType, El::Device::GPU>&>(means.Matrix());
-  auto& local_workspace = static_cast<El::Matrix<TensorDataType, El::Device::GPU>&>(workspace.Matrix());
+  using LocalMat = El::Matrix<TensorDataType, El::Device::GPU>;
 
   // Dimensions
   const auto& height = input0.Height();
   const auto& width = input0.Width();
-  const auto& local_height = local_input0.Height();
-  const auto& local_width = local_input0.Width();
 
-  // Compute column-wise mean
+  // Initialize outputs
   means.Empty(false);
   means.AlignWith(input0);
-  El::Zeros(means, 2, width);
-  if (!local_input0.IsEmpty()) {
-    constexpr El::Int block_size = 256;
-    dim3 block_dims, grid_dims;
-    block_dims.x = block_size;
-    grid_dims.x = (local_height + block_size - 1) / block_size;
-    grid_dims.y = local_width;
-    const auto& scale = El::TypeTraits<TensorDataType>::One() / TensorDataType(height);
-    mean_contribution_kernel<TensorDataType, block_size>
-      <<<grid_dims, block_dims, 0, El::GPUManager::Stream()>>>(
-        local_height, local_width, scale,
-        local_input0.LockedBuffer(), local_input0.LDim(),
-        local_input1.LockedBuffer(), local_input1.LDim(),
-        local_means.Buffer());
-  }
-  El::AllReduce(means, means.RedundantComm());
-
-  // Compute column-wise covariance
+  means.Resize(2, width);
   workspace.Empty(false);
   workspace.AlignWith(input0);
-  El::Zeros(workspace, 1, width);
-  if (!local_input0.IsEmpty()) {
-    constexpr El::Int block_size = 256;
-    dim3 block_dims, grid_dims;
-    block_dims.x = block_size;
-    grid_dims.x = (local_height + block_size - 1) / block_size;
-    grid_dims.y = local_width;
-    const auto& scale = El::TypeTraits<TensorDataType>::One() / (biased ? TensorDataType(height) : TensorDataType(height - 1));
-    covariance_contribution_kernel<TensorDataType, block_size>
-      <<<grid_dims, block_dims, 0, El::GPUManager::Stream()>>>(
-        local_height, local_width, scale,
-        local_input0.LockedBuffer(), local_input0.LDim(),
-        local_input1.LockedBuffer(), local_input1.LDim(),
-        local_means.LockedBuffer(),
-        local_workspace.Buffer());
+  workspace.Resize(1, width);
+
+  // Local matrices
+  const auto& local_input0 = static_cast<const LocalMat&>(input0.LockedMatrix());
+  const auto& local_input1 = static_cast<const LocalMat&>(input1.LockedMatrix());
+  auto& local_means = static_cast<LocalMat&>(means.Matrix());
+  auto& local_workspace = static_cast<LocalMat&>(workspace.Matrix());
+  const auto& local_height = local_input0.Height();
+  const auto& local_width = local_input0.Width();
+  const auto& scale = El::TypeTraits<TensorDataType>::One() / (biased ? TensorDataType(height) : TensorDataType(height - 1));
+
+  // Compute column-wise moments
+  auto&& col_comm = input0.ColComm();
+  const El::Int col_comm_size = El::mpi::Size(col_comm);
+  if (col_comm_size == 1) {
+    if (local_width > 0) {
+      launch_covariance_stats(local_height, local_width, scale,
+                              local_input0.LockedBuffer(), local_input0.LDim(),
+                              local_input1.LockedBuffer(), local_input1.LDim(),
+                              local_means.Buffer(), local_workspace.Buffer());
+    }
+  }
+  else {
+    LocalMat partials, gathered;
+#ifdef HYDROGEN_HAVE_CUB
+    partials.SetMemoryMode(1); // Use CUB GPU memory pool
+    gathered.SetMemoryMode(1);
+#endif // HYDROGEN_HAVE_CUB
+    partials.Resize(local_width, 3);
+    gathered.Resize(3 * local_width, col_comm_size);
+    if (local_width > 0) {
+      launch_covariance_stats(local_height, local_width,
+                              El::TypeTraits<TensorDataType>::One(),
+                              local_input0.LockedBuffer(), local_input0.LDim(),
+                              local_input1.LockedBuffer(), local_input1.LDim(),
+                              partials.Buffer(),
+                              partials.Buffer() + 2 * local_width);
+    }
+    auto&& stream = El::GPUManager::Stream();
+    auto&& event = El::GPUManager::Event();
+    const int bytes = 3 * local_width * sizeof(TensorDataType);
+    comm.all_gather(reinterpret_cast<const El::byte*>(partials.LockedBuffer()), bytes,
+                    reinterpret_cast<El::byte*>(gathered.Buffer()), bytes,
+                    col_comm, El::SyncInfo<El::Device::GPU>{stream, event});
+    if (local_width > 0) {
+      constexpr El::Int block_size = 256;
+      const El::Int grid_size = (local_width + block_size - 1) / block_size;
+      covariance_merge_kernel<TensorDataType>
+        <<<grid_size, block_size, 0, stream>>>(
+          height, local_width, col_comm_size, input0.ColAlign(), scale,
+          gathered.LockedBuffer(),
+          local_means.Buffer(), local_workspace.Buffer());
+    }
   }
-  El::AllReduce(workspace, workspace.RedundantComm());
   El::Copy(workspace, output);
 
 }
@@ -292,7 +367,8 @@ void bp_gpu(const El::AbstractDistMatrix<TensorDataType>& input0,
 
 template <typename TensorDataType, data_layout Layout, El::Device Device>
 void covariance_layer<TensorDataType, Layout, Device>::fp_compute() {
-  fp_gpu(this->get_prev_activations(0),
+  fp_gpu(*this->get_comm(),
+         this->get_prev_activations(0),
          this->get_prev_activations(1),
          this->get_activations(),
          *this->m_means,
@@ -0,0 +1,302 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#define LBANN_SCALED_DOT_PRODUCT_ATTENTION_LAYER_INSTANTIATE
+#include "lbann/layers/misc/scaled_dot_product_attention.hpp"
+#include "lbann/utils/memory.hpp"
+#include <layers.pb.h>
+
+namespace lbann {
+
+namespace {
+
+/** Number of keys in each tile of the attention scores. */
+constexpr El::Int key_tile_size = 64;
+
+template <typename TensorDataType>
+TensorDataType dot(El::Int size,
+                   const TensorDataType* __restrict__ x,
+                   const TensorDataType* __restrict__ y) {
+  TensorDataType sum = El::TypeTraits<TensorDataType>::Zero();
+  for (El::Int i = 0; i < size; ++i) {
+    sum += x[i] * y[i];
+  }
+  return sum;
+}
+
+} // namespace <anon>
+
+// =========================================================
+// Forward prop
+// =========================================================
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void scaled_dot_product_attention_layer<TensorDataType,Layout,Device>::fp_compute() {
+  using LocalMat = El::Matrix<TensorDataType, El::Device::CPU>;
+  const auto& zero = El::TypeTraits<TensorDataType>::Zero();
+  const auto& one = El::TypeTraits<TensorDataType>::One();
+
+  // Local matrices
+  const auto& local_queries = dynamic_cast<const LocalMat&>(this->get_local_prev_activations(0));
+  const auto& local_keys = dynamic_cast<const LocalMat&>(this->get_local_prev_activations(1));
+  const auto& local_values = dynamic_cast<const LocalMat&>(this->get_local_prev_activations(2));
+  auto& local_output = dynamic_cast<LocalMat&>(this->get_local_activations());
+
+  // Dimensions
+  const El::Int local_mini_batch_size = local_queries.Width();
+  const El::Int num_heads = m_num_heads;
+  const El::Int num_queries = this->get_input_dims(0)[0];
+  const El::Int num_keys = this->get_input_dims(1)[0];
+  const El::Int embed_dim = this->get_input_dims(0)[1];
+  const El::Int value_dim = this->get_input_dims(2)[1];
+  const El::Int head_dim = embed_dim / num_heads;
+  const El::Int head_value_dim = value_dim / num_heads;
+  const TensorDataType scale = one / El::Sqrt(TensorDataType(head_dim));
+  m_lse.Resize(num_heads * num_queries, local_mini_batch_size);
+
+  // Attention for each query, streaming over tiles of keys
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE3
+  for (El::Int k = 0; k < local_mini_batch_size; ++k) {
+    for (El::Int h = 0; h < num_heads; ++h) {
+      for (El::Int i = 0; i < num_queries; ++i) {
+        const auto* q = local_queries.LockedBuffer(i*embed_dim + h*head_dim, k);
+        auto* out = local_output.Buffer(i*value_dim + h*head_value_dim, k);
+        std::fill(out, out+head_value_dim, zero);
+        const El::Int keys_end = m_causal ? std::min(i+1, num_keys) : num_keys;
+        TensorDataType running_max = -std::numeric_limits<TensorDataType>::infinity();
+        TensorDataType denom = zero;
+        TensorDataType scores[key_tile_size];
+        for (El::Int j0 = 0; j0 < keys_end; j0 += key_tile_size) {
+          const El::Int tile_size = std::min(key_tile_size, keys_end - j0);
+
+          // Scores for tile
+          TensorDataType tile_max = -std::numeric_limits<TensorDataType>::infinity();
+          for (El::Int jj = 0; jj < tile_size; ++jj) {
+            const auto* key = local_keys.LockedBuffer((j0+jj)*embed_dim + h*head_dim, k);
+            scores[jj] = scale * dot(head_dim, q, key);
+            tile_max = std::max(tile_max, scores[jj]);
+          }
+
+          // Rescale accumulated values with new running max
+          const auto new_max = std::max(running_max, tile_max);
+          const auto factor = std::exp(running_max - new_max);
+          denom *= factor;
+          for (El::Int d = 0; d < head_value_dim; ++d) {
+            out[d] *= factor;
+          }
+          running_max = new_max;
+
+          // Accumulate values for tile
+          for (El::Int jj = 0; jj < tile_size; ++jj) {
+            const auto p = std::exp(scores[jj] - running_max);
+            const auto* value = local_values.LockedBuffer((j0+jj)*value_dim + h*head_value_dim, k);
+            denom += p;
+            for (El::Int d = 0; d < head_value_dim; ++d) {
+              out[d] += p * value[d];
+            }
+          }
+
+        }
+
+        // Normalize
+        if (denom > zero) {
+          const auto inv_denom = one / denom;
+          for (El::Int d = 0; d < head_value_dim; ++d) {
+            out[d] *= inv_denom;
+          }
+          m_lse(i + h*num_queries, k) = running_max + std::log(denom);
+        }
+        else {
+          m_lse(i + h*num_queries, k) = std::numeric_limits<TensorDataType>::infinity();
+        }
+
+      }
+    }
+  }
+
+}
+
+// =========================================================
+// Backprop
+// =========================================================
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void scaled_dot_product_attention_layer<TensorDataType,Layout,Device>::bp_compute() {
+  using LocalMat = El::Matrix<TensorDataType, El::Device::CPU>;
+  const auto& one = El::TypeTraits<TensorDataType>::One();
+
+  // Local matrices
+  const auto& local_queries = dynamic_cast<const LocalMat&>(this->get_local_prev_activations(0));
+  const auto& local_keys = dynamic_cast<const LocalMat&>(this->get_local_prev_activations(1));
+  const auto& local_values = dynamic_cast<const LocalMat&>(this->get_local_prev_activations(2));
+  const auto& local_output = dynamic_cast<const LocalMat&>(this->get_local_activations());
+  const auto& local_output_grad = dynamic_cast<const LocalMat&>(this->get_local_prev_error_signals());
+  auto& local_queries_grad = dynamic_cast<LocalMat&>(this->get_local_error_signals(0));
+  auto& local_keys_grad = dynamic_cast<LocalMat&>(this->get_local_error_signals(1));
+  auto& local_values_grad = dynamic_cast<LocalMat&>(this->get_local_error_signals(2));
+  El::Zero(local_queries_grad);
+  El::Zero(local_keys_grad);
+  El::Zero(local_values_grad);
+
+  // Dimensions
+  const El::Int local_mini_batch_size = local_queries.Width();
+  const El::Int num_heads = m_num_heads;
+  const El::Int num_queries = this->get_input_dims(0)[0];
+  const El::Int num_keys = this->get_input_dims(1)[0];
+  const El::Int embed_dim = this->get_input_dims(0)[1];
+  const El::Int value_dim = this->get_input_dims(2)[1];
+  const El::Int head_dim = embed_dim / num_heads;
+  const El::Int head_value_dim = value_dim / num_heads;
+  const TensorDataType scale = one / El::Sqrt(TensorDataType(head_dim));
+
+  // Recompute attention probabilities P and accumulate
+  //   dV_j += P_ij dY_i
+  //   dS_ij = P_ij * ( dot(dY_i,V_j) - dot(dY_i,Y_i) )
+  //   dQ_i += scale * dS_ij K_j
+  //   dK_j += scale * dS_ij Q_i
+  // Key and value gradients are shared by all queries in a head, so
+  // each thread handles one head of one mini-batch sample.
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (El::Int k = 0; k < local_mini_batch_size; ++k) {
+    for (El::Int h = 0; h < num_heads; ++h) {
+      for (El::Int i = 0; i < num_queries; ++i) {
+        const auto* q = local_queries.LockedBuffer(i*embed_dim + h*head_dim, k);
+        const auto* y = local_output.LockedBuffer(i*value_dim + h*head_value_dim, k);
+        const auto* dy = local_output_grad.LockedBuffer(i*value_dim + h*head_value_dim, k);
+        auto* dq = local_queries_grad.Buffer(i*embed_dim + h*head_dim, k);
+        const auto& lse = m_lse(i + h*num_queries, k);
+        const auto y_dot_dy = dot(head_value_dim, y, dy);
+        const El::Int keys_end = m_causal ? std::min(i+1, num_keys) : num_keys;
+        for (El::Int j = 0; j < keys_end; ++j) {
+          const auto* key = local_keys.LockedBuffer(j*embed_dim + h*head_dim, k);
+          const auto* value = local_values.LockedBuffer(j*value_dim + h*head_value_dim, k);
+          auto* dkey = local_keys_grad.Buffer(j*embed_dim + h*head_dim, k);
+          auto* dvalue = local_values_grad.Buffer(j*value_dim + h*head_value_dim, k);
+          const auto p = std::exp(scale * dot(head_dim, q, key) - lse);
+          const auto ds = scale * p * (dot(head_value_dim, dy, value) - y_dot_dy);
+          for (El::Int d = 0; d < head_value_dim; ++d) {
+            dvalue[d] += p * dy[d];
+          }
+          for (El::Int d = 0; d < head_dim; ++d) {
+            dq[d] += ds * key[d];
+            dkey[d] += ds * q[d];
+          }
+        }
+      }
+    }
+  }
+
+}
+
+// =============================================
+// Builder function
+// =============================================
+
+namespace
+{
+
+template <typename T, data_layout L, El::Device D>
+struct Builder
+{
+  template <typename... Args>
+  static std::unique_ptr<Layer> Build(Args&&...)
+  {
+    LBANN_ERROR(
+      "Attempted to construct scaled_dot_product_attention_layer ",
+      "with invalid parameters ",
+      "(TensorDataType=",TypeName<T>(),", ",
+      "Layout=",to_string(L),", ",
+      "Device=",to_string(D),")");
+    return nullptr;
+  }
+};
+
+template <El::Device Device>
+struct Builder<float,data_layout::DATA_PARALLEL,Device>
+{
+  template <typename... Args>
+  static std::unique_ptr<Layer> Build(Args&&... args)
+  {
+    using LayerType = scaled_dot_product_attention_layer<float,
+                                                         data_layout::DATA_PARALLEL,
+                                                         Device>;
+    return make_unique<LayerType>(std::forward<Args>(args)...);
+  }
+};
+
+template <El::Device Device>
+struct Builder<double,data_layout::DATA_PARALLEL,Device>
+{
+  template <typename... Args>
+  static std::unique_ptr<Layer> Build(Args&&... args)
+  {
+    using LayerType = scaled_dot_product_attention_layer<double,
+                                                         data_layout::DATA_PARALLEL,
+                                                         Device>;
+    return make_unique<LayerType>(std::forward<Args>(args)...);
+  }
+};
+
+} // namespace <anon>
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+std::unique_ptr<Layer> build_scaled_dot_product_attention_layer_from_pbuf(
+  lbann_comm* comm, lbann_data::Layer const& proto_layer)
+{
+  using BuilderType = Builder<TensorDataType, Layout, Device>;
+  LBANN_ASSERT_MSG_HAS_FIELD(proto_layer, scaled_dot_product_attention);
+  const auto& params = proto_layer.scaled_dot_product_attention();
+  const El::Int num_heads = (params.num_heads() > 0
+                             ? params.num_heads()
+                             : 1);
+  return BuilderType::Build(comm, num_heads, params.causal());
+}
+
+// =========================================================
+// Explicit template instantiation
+// =========================================================
+
+#define PROTO(T)                                                \
+  template class scaled_dot_product_attention_layer<            \
+    T, data_layout::DATA_PARALLEL, El::Device::CPU>
+#include "lbann/macros/instantiate.hpp"
+#undef PROTO
+
+#ifdef LBANN_HAS_GPU
+#define PROTO(T)                                                \
+  extern template class scaled_dot_product_attention_layer<     \
+    T, data_layout::DATA_PARALLEL, El::Device::GPU>
+#include "lbann/macros/instantiate.hpp"
+#undef PROTO
+#endif // LBANN_HAS_GPU
+
+#define PROTO_DEVICE(T, Device) \
+  LBANN_LAYER_BUILDER_ETI(scaled_dot_product_attention, T, Device)
+#include "lbann/macros/instantiate_device.hpp"
+#undef PROTO_DEVICE
+
+} // namespace lbann
@@ -0,0 +1,531 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#define LBANN_SCALED_DOT_PRODUCT_ATTENTION_LAYER_INSTANTIATE
+#include "lbann/layers/misc/scaled_dot_product_attention.hpp"
+#include "lbann/utils/cuda.hpp"
+
+namespace lbann {
+
+namespace {
+
+/** @brief Tensor dimensions for attention kernels.
+ *
+ *  Vectors for head @c h of entry @c i in a sequence with embedding
+ *  size @c E start at offset @c i*E+h*head_dim within each mini-batch
+ *  sample.
+ */
+struct attention_dims {
+  El::Int mini_batch_size;
+  El::Int num_heads;
+  El::Int num_queries;
+  El::Int num_keys;
+  El::Int embed_dim;
+  El::Int value_dim;
+  El::Int head_dim;
+  El::Int head_value_dim;
+  bool causal;
+};
+
+/** Number of threads per block in attention kernels. */
+constexpr El::Int block_size = 64;
+
+/** @brief Cooperatively load a tile of sequence vectors into shared
+ *  memory.
+ *
+ *  The tile holds @c tile_size vectors of @c dim entries each, with
+ *  stride @c max_dim. Entries past the end of the sequence are set to
+ *  zero.
+ */
+template <El::Int max_dim, typename TensorDataType>
+__device__ __forceinline__ void load_tile(El::Int tile_start,
+                                          El::Int tile_size,
+                                          El::Int seq_length,
+                                          El::Int dim,
+                                          El::Int embed_dim,
+                                          const TensorDataType* __restrict__ sequence,
+                                          TensorDataType* __restrict__ tile) {
+  for (El::Int pos = threadIdx.x; pos < tile_size * dim; pos += blockDim.x) {
+    const auto& t = pos / dim;
+    const auto& d = pos % dim;
+    const auto& row = tile_start + t;
+    tile[t*max_dim + d] = (row < seq_length ?
+                           sequence[row*embed_dim + d] :
+                           TensorDataType(0.));
+  }
+}
+
+/** @brief Forward prop with one thread per query.
+ *
+ *  Keys and values are streamed through shared memory in tiles and
+ *  the softmax is accumulated with a running maximum and denominator,
+ *  so the score matrix is never stored.
+ *
+ *  Block dimensions: block_size x 1 x 1
+ *
+ *  Grid dimensions: (num_queries / block_size) x num_heads x mini_batch_size
+ */
+template <El::Int max_dim, El::Int tile_size, typename TensorDataType>
+__global__ void fp_kernel(attention_dims dims,
+                          TensorDataType scale,
+                          const TensorDataType* __restrict__ queries,
+                          El::Int queries_ldim,
+                          const TensorDataType* __restrict__ keys,
+                          El::Int keys_ldim,
+                          const TensorDataType* __restrict__ values,
+                          El::Int values_ldim,
+                          TensorDataType* __restrict__ output,
+                          El::Int output_ldim,
+                          TensorDataType* __restrict__ lse,
+                          El::Int lse_ldim) {
+  __shared__ TensorDataType key_tile[tile_size*max_dim];
+  __shared__ TensorDataType value_tile[tile_size*max_dim];
+  const El::Int h = blockIdx.y;
+  const El::Int i = threadIdx.x + blockIdx.x * blockDim.x;
+  const bool valid = i < dims.num_queries;
+  const El::Int keys_end = (dims.causal ?
+                            cuda::min(dims.num_keys,
+                                      El::Int((blockIdx.x+1)*blockDim.x)) :
+                            dims.num_keys);
+
+  for (El::Int k = blockIdx.z; k < dims.mini_batch_size; k += gridDim.z) {
+    const auto* q_ptr = &queries[k*queries_ldim + i*dims.embed_dim + h*dims.head_dim];
+    const auto* keys_ptr = &keys[k*keys_ldim + h*dims.head_dim];
+    const auto* values_ptr = &values[k*values_ldim + h*dims.head_value_dim];
+
+    // Load query
+    TensorDataType q[max_dim], acc[max_dim];
+#pragma unroll
+    for (El::Int d = 0; d < max_dim; ++d) {
+      q[d] = (valid && d < dims.head_dim) ? q_ptr[d] : TensorDataType(0.);
+      acc[d] = TensorDataType(0.);
+    }
+    TensorDataType running_max = -cuda::infinity<TensorDataType>();
+    TensorDataType denom = TensorDataType(0.);
+
+    // Stream over tiles of keys and values
+    for (El::Int j0 = 0; j0 < keys_end; j0 += tile_size) {
+      __syncthreads();
+      load_tile<max_dim>(j0, tile_size, dims.num_keys, dims.head_dim,
+                         dims.embed_dim, keys_ptr, key_tile);
+      load_tile<max_dim>(j0, tile_size, dims.num_keys, dims.head_value_dim,
+                         dims.value_dim, values_ptr, value_tile);
+      __syncthreads();
+      if (valid) {
+        for (El::Int jj = 0; jj < tile_size; ++jj) {
+          const auto& j = j0 + jj;
+          if (j >= dims.num_keys || (dims.causal && j > i)) { break; }
+          TensorDataType s = TensorDataType(0.);
+#pragma unroll
+          for (El::Int d = 0; d < max_dim; ++d) {
+            s += q[d] * key_tile[jj*max_dim + d];
+          }
+          s *= scale;
+          if (s > running_max) {
+            const auto& factor = cuda::exp(running_max - s);
+            denom *= factor;
+#pragma unroll
+            for (El::Int d = 0; d < max_dim; ++d) { acc[d] *= factor; }
+            running_max = s;
+          }
+          const auto& p = cuda::exp(s - running_max);
+          denom += p;
+#pragma unroll
+          for (El::Int d = 0; d < max_dim; ++d) {
+            acc[d] += p * value_tile[jj*max_dim + d];
+          }
+        }
+      }
+    }
+
+    // Write output and log-sum-exp
+    if (valid) {
+      auto* out_ptr = &output[k*output_ldim + i*dims.value_dim + h*dims.head_value_dim];
+      const auto& inv_denom = TensorDataType(1.) / denom;
+#pragma unroll
+      for (El::Int d = 0; d < max_dim; ++d) {
+        if (d < dims.head_value_dim) { out_ptr[d] = acc[d] * inv_denom; }
+      }
+      lse[k*lse_ldim + h*dims.num_queries + i] = running_max + cuda::log(denom);
+    }
+
+  }
+
+}
+
+/** @brief Gradient w.r.t. queries with one thread per query.
+ *
+ *  Also computes dot(Y_i,dY_i) for each query, which is needed for
+ *  the key and value gradients.
+ *
+ *  Block dimensions: block_size x 1 x 1
+ *
+ *  Grid dimensions: (num_queries / block_size) x num_heads x mini_batch_size
+ */
+template <El::Int max_dim, El::Int tile_size, typename TensorDataType>
+__global__ void bp_queries_kernel(attention_dims dims,
+                                  TensorDataType scale,
+                                  const TensorDataType* __restrict__ queries,
+                                  El::Int queries_ldim,
+                                  const TensorDataType* __restrict__ keys,
+                                  El::Int keys_ldim,
+                                  const TensorDataType* __restrict__ values,
+                                  El::Int values_ldim,
+                                  const TensorDataType* __restrict__ output,
+                                  El::Int output_ldim,
+                                  const TensorDataType* __restrict__ output_grad,
+                                  El::Int output_grad_ldim,
+                                  const TensorDataType* __restrict__ lse,
+                                  El::Int lse_ldim,
+                                  TensorDataType* __restrict__ y_dot_dy,
+                                  El::Int y_dot_dy_ldim,
+                                  TensorDataType* __restrict__ queries_grad,
+                                  El::Int queries_grad_ldim) {
+  __shared__ TensorDataType key_tile[tile_size*max_dim];
+  __shared__ TensorDataType value_tile[tile_size*max_dim];
+  const El::Int h = blockIdx.y;
+  const El::Int i = threadIdx.x + blockIdx.x * blockDim.x;
+  const bool valid = i < dims.num_queries;
+  const El::Int keys_end = (dims.causal ?
+                            cuda::min(dims.num_keys,
+                                      El::Int((blockIdx.x+1)*blockDim.x)) :
+                            dims.num_keys);
+
+  for (El::Int k = blockIdx.z; k < dims.mini_batch_size; k += gridDim.z) {
+    const auto* q_ptr = &queries[k*queries_ldim + i*dims.embed_dim + h*dims.head_dim];
+    const auto* y_ptr = &output[k*output_ldim + i*dims.value_dim + h*dims.head_value_dim];
+    const auto* dy_ptr = &output_grad[k*output_grad_ldim + i*dims.value_dim + h*dims.head_value_dim];
+    const auto* keys_ptr = &keys[k*keys_ldim + h*dims.head_dim];
+    const auto* values_ptr = &values[k*values_ldim + h*dims.head_value_dim];
+
+    // Load query and output gradient
+    TensorDataType q[max_dim], dy[max_dim], dq[max_dim];
+    TensorDataType D = TensorDataType(0.), row_lse = TensorDataType(0.);
+#pragma unroll
+    for (El::Int d = 0; d < max_dim; ++d) {
+      q[d] = (valid && d < dims.head_dim) ? q_ptr[d] : TensorDataType(0.);
+      dy[d] = (valid && d < dims.head_value_dim) ? dy_ptr[d] : TensorDataType(0.);
+      dq[d] = TensorDataType(0.);
+      if (valid && d < dims.head_value_dim) { D += y_ptr[d] * dy[d]; }
+    }
+    if (valid) {
+      row_lse = lse[k*lse_ldim + h*dims.num_queries + i];
+      y_dot_dy[k*y_dot_dy_ldim + h*dims.num_queries + i] = D;
+    }
+
+    // Stream over tiles of keys and values
+    for (El::Int j0 = 0; j0 < keys_end; j0 += tile_size) {
+      __syncthreads();
+      load_tile<max_dim>(j0, tile_size, dims.num_keys, dims.head_dim,
+                         dims.embed_dim, keys_ptr, key_tile);
+      load_tile<max_dim>(j0, tile_size, dims.num_keys, dims.head_value_dim,
+                         dims.value_dim, values_ptr, value_tile);
+      __syncthreads();
+      if (valid) {
+        for (El::Int jj = 0; jj < tile_size; ++jj) {
+          const auto& j = j0 + jj;
+          if (j >= dims.num_keys || (dims.causal && j > i)) { break; }
+          TensorDataType s = TensorDataType(0.), dp = TensorDataType(0.);
+#pragma unroll
+          for (El::Int d = 0; d < max_dim; ++d) {
+            s += q[d] * key_tile[jj*max_dim + d];
+            dp += dy[d] * value_tile[jj*max_dim + d];
+          }
+          const auto& p = cuda::exp(scale * s - row_lse);
+          const auto& ds = scale * p * (dp - D);
+#pragma unroll
+          for (El::Int d = 0; d < max_dim; ++d) {
+            dq[d] += ds * key_tile[jj*max_dim + d];
+          }
+        }
+      }
+    }
+
+    // Write gradient
+    if (valid) {
+      auto* dq_ptr = &queries_grad[k*queries_grad_ldim + i*dims.embed_dim + h*dims.head_dim];
+#pragma unroll
+      for (El::Int d = 0; d < max_dim; ++d) {
+        if (d < dims.head_dim) { dq_ptr[d] = dq[d]; }
+      }
+    }
+
+  }
+
+}
+
+/** @brief Gradient w.r.t. keys and values with one thread per key.
+ *
+ *  Queries and output gradients are streamed through shared memory
+ *  in tiles. Each key is owned by one thread, so no atomics are
+ *  needed.
+ *
+ *  Block dimensions: block_size x 1 x 1
+ *
+ *  Grid dimensions: (num_keys / block_size) x num_heads x mini_batch_size
+ */
+template <El::Int max_dim, El::Int tile_size, typename TensorDataType>
+__global__ void bp_keys_kernel(attention_dims dims,
+                               TensorDataType scale,
+                               const TensorDataType* __restrict__ queries,
+                               El::Int queries_ldim,
+                               const TensorDataType* __restrict__ keys,
+                               El::Int keys_ldim,
+                               const TensorDataType* __restrict__ values,
+                               El::Int values_ldim,
+                               const TensorDataType* __restrict__ output_grad,
+                               El::Int output_grad_ldim,
+                               const TensorDataType* __restrict__ lse,
+                               El::Int lse_ldim,
+                               const TensorDataType* __restrict__ y_dot_dy,
+                               El::Int y_dot_dy_ldim,
+                               TensorDataType* __restrict__ keys_grad,
+                               El::Int keys_grad_ldim,
+                               TensorDataType* __restrict__ values_grad,
+                               El::Int values_grad_ldim) {
+  __shared__ TensorDataType query_tile[tile_size*max_dim];
+  __shared__ TensorDataType output_grad_tile[tile_size*max_dim];
+  __shared__ TensorDataType lse_tile[tile_size];
+  __shared__ TensorDataType D_tile[tile_size];
+  const El::Int h = blockIdx.y;
+  const El::Int j = threadIdx.x + blockIdx.x * blockDim.x;
+  const bool valid = j < dims.num_keys;
+  const El::Int queries_begin = (dims.causal ?
+                                 (blockIdx.x*blockDim.x / tile_size) * tile_size :
+                                 0);
+
+  for (El::Int k = blockIdx.z; k < dims.mini_batch_size; k += gridDim.z) {
+    const auto* key_ptr = &keys[k*keys_ldim + j*dims.embed_dim + h*dims.head_dim];
+    const auto* value_ptr = &values[k*values_ldim + j*dims.value_dim + h*dims.head_value_dim];
+    const auto* queries_ptr = &queries[k*queries_ldim + h*dims.head_dim];
+    const auto* output_grad_ptr = &output_grad[k*output_grad_ldim + h*dims.head_value_dim];
+    const auto* lse_ptr = &lse[k*lse_ldim + h*dims.num_queries];
+    const auto* D_ptr = &y_dot_dy[k*y_dot_dy_ldim + h*dims.num_queries];
+
+    // Load key and value
+    TensorDataType key[max_dim], value[max_dim], dk[max_dim], dv[max_dim];
+#pragma unroll
+    for (El::Int d = 0; d < max_dim; ++d) {
+      key[d] = (valid && d < dims.head_dim) ? key_ptr[d] : TensorDataType(0.);
+      value[d] = (valid && d < dims.head_value_dim) ? value_ptr[d] : TensorDataType(0.);
+      dk[d] = TensorDataType(0.);
+      dv[d] = TensorDataType(0.);
+    }
+
+    // Stream over tiles of queries and output gradients
+    for (El::Int i0 = queries_begin; i0 < dims.num_queries; i0 += tile_size) {
+      __syncthreads();
+      load_tile<max_dim>(i0, tile_size, dims.num_queries, dims.head_dim,
+                         dims.embed_dim, queries_ptr, query_tile);
+      load_tile<max_dim>(i0, tile_size, dims.num_queries, dims.head_value_dim,
+                         dims.value_dim, output_grad_ptr, output_grad_tile);
+      for (El::Int ii = threadIdx.x; ii < tile_size; ii += blockDim.x) {
+        const bool in_range = i0 + ii < dims.num_queries;
+        lse_tile[ii] = in_range ? lse_ptr[i0+ii] : TensorDataType(0.);
+        D_tile[ii] = in_range ? D_ptr[i0+ii] : TensorDataType(0.);
+      }
+      __syncthreads();
+      if (valid) {
+        for (El::Int ii = 0; ii < tile_size; ++ii) {
+          const auto& i = i0 + ii;
+          if (i >= dims.num_queries) { break; }
+          if (dims.causal && j > i) { continue; }
+          TensorDataType s = TensorDataType(0.), dp = TensorDataType(0.);
+#pragma unroll
+          for (El::Int d = 0; d < max_dim; ++d) {
+            s += query_tile[ii*max_dim + d] * key[d];
+            dp += output_grad_tile[ii*max_dim + d] * value[d];
+          }
+          const auto& p = cuda::exp(scale * s - lse_tile[ii]);
+          const auto& ds = scale * p * (dp - D_tile[ii]);
+#pragma unroll
+          for (El::Int d = 0; d < max_dim; ++d) {
+            dv[d] += p * output_grad_tile[ii*max_dim + d];
+            dk[d] += ds * query_tile[ii*max_dim + d];
+          }
+        }
+      }
+    }
+
+    // Write gradients
+    if (valid) {
+      auto* dk_ptr = &keys_grad[k*keys_grad_ldim + j*dims.embed_dim + h*dims.head_dim];
+      auto* dv_ptr = &values_grad[k*values_grad_ldim + j*dims.value_dim + h*dims.head_value_dim];
+#pragma unroll
+      for (El::Int d = 0; d < max_dim; ++d) {
+        if (d < dims.head_dim) { dk_ptr[d] = dk[d]; }
+        if (d < dims.head_value_dim) { dv_ptr[d] = dv[d]; }
+      }
+    }
+
+  }
+
+}
+
+/** Launch attention kernel specialized for head dimension. */
+#define LBANN_ATTENTION_LAUNCH(kernel, max_head_dim, grid_dims, stream, ...) \
+  do {                                                                  \
+    if (max_head_dim <= 32) {                                           \
+      kernel<32,64><<<grid_dims, block_size, 0, stream>>>(__VA_ARGS__); \
+    }                                                                   \
+    else if (max_head_dim <= 64) {                                      \
+      kernel<64,32><<<grid_dims, block_size, 0, stream>>>(__VA_ARGS__); \
+    }                                                                   \
+    else if (max_head_dim <= 128) {                                     \
+      kernel<128,16><<<grid_dims, block_size, 0, stream>>>(__VA_ARGS__); \
+    }                                                                   \
+    else {                                                              \
+      LBANN_ERROR("GPU scaled dot-product attention supports head ",   \
+                  "dimensions of at most 128, but got ", max_head_dim); \
+    }                                                                   \
+  } while (false)
+
+} // namespace <anon>
+
+// =========================================================
+// Forward prop
+// =========================================================
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void scaled_dot_product_attention_layer<TensorDataType,Layout,Device>::fp_compute() {
+  using LocalMat = El::Matrix<TensorDataType, El::Device::GPU>;
+
+  // Local matrices
+  const auto& local_queries = dynamic_cast<const LocalMat&>(this->get_local_prev_activations(0));
+  const auto& local_keys = dynamic_cast<const LocalMat&>(this->get_local_prev_activations(1));
+  const auto& local_values = dynamic_cast<const LocalMat&>(this->get_local_prev_activations(2));
+  auto& local_output = dynamic_cast<LocalMat&>(this->get_local_activations());
+
+  // Dimensions
+  attention_dims dims;
+  dims.mini_batch_size = local_queries.Width();
+  dims.num_heads = m_num_heads;
+  dims.num_queries = this->get_input_dims(0)[0];
+  dims.num_keys = this->get_input_dims(1)[0];
+  dims.embed_dim = this->get_input_dims(0)[1];
+  dims.value_dim = this->get_input_dims(2)[1];
+  dims.head_dim = dims.embed_dim / dims.num_heads;
+  dims.head_value_dim = dims.value_dim / dims.num_heads;
+  dims.causal = m_causal;
+  const auto max_head_dim = std::max(dims.head_dim, dims.head_value_dim);
+  const auto scale = TensorDataType(1.) / El::Sqrt(TensorDataType(dims.head_dim));
+  m_lse.Resize(dims.num_heads * dims.num_queries, dims.mini_batch_size);
+
+  // Launch kernel
+  if (dims.mini_batch_size < 1) { return; }
+  auto&& stream = El::GPUManager::Stream();
+  dim3 grid_dims;
+  grid_dims.x = (dims.num_queries + block_size - 1) / block_size;
+  grid_dims.y = dims.num_heads;
+  grid_dims.z = std::min(dims.mini_batch_size, El::Int(65535));
+  LBANN_ATTENTION_LAUNCH(
+    fp_kernel, max_head_dim, grid_dims, stream,
+    dims, scale,
+    local_queries.LockedBuffer(), local_queries.LDim(),
+    local_keys.LockedBuffer(), local_keys.LDim(),
+    local_values.LockedBuffer(), local_values.LDim(),
+    local_output.Buffer(), local_output.LDim(),
+    m_lse.Buffer(), m_lse.LDim());
+
+}
+
+// =========================================================
+// Backprop
+// =========================================================
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void scaled_dot_product_attention_layer<TensorDataType,Layout,Device>::bp_compute() {
+  using LocalMat = El::Matrix<TensorDataType, El::Device::GPU>;
+
+  // Local matrices
+  const auto& local_queries = dynamic_cast<const LocalMat&>(this->get_local_prev_activations(0));
+  const auto& local_keys = dynamic_cast<const LocalMat&>(this->get_local_prev_activations(1));
+  const auto& local_values = dynamic_cast<const LocalMat&>(this->get_local_prev_activations(2));
+  const auto& local_output = dynamic_cast<const LocalMat&>(this->get_local_activations());
+  const auto& local_output_grad = dynamic_cast<const LocalMat&>(this->get_local_prev_error_signals());
+  auto& local_queries_grad = dynamic_cast<LocalMat&>(this->get_local_error_signals(0));
+  auto& local_keys_grad = dynamic_cast<LocalMat&>(this->get_local_error_signals(1));
+  auto& local_values_grad = dynamic_cast<LocalMat&>(this->get_local_error_signals(2));
+
+  // Dimensions
+  attention_dims dims;
+  dims.mini_batch_size = local_queries.Width();
+  dims.num_heads = m_num_heads;
+  dims.num_queries = this->get_input_dims(0)[0];
+  dims.num_keys = this->get_input_dims(1)[0];
+  dims.embed_dim = this->get_input_dims(0)[1];
+  dims.value_dim = this->get_input_dims(2)[1];
+  dims.head_dim = dims.embed_dim / dims.num_heads;
+  dims.head_value_dim = dims.value_dim / dims.num_heads;
+  dims.causal = m_causal;
+  const auto max_head_dim = std::max(dims.head_dim, dims.head_value_dim);
+  const auto scale = TensorDataType(1.) / El::Sqrt(TensorDataType(dims.head_dim));
+  m_workspace.Resize(dims.num_heads * dims.num_queries, dims.mini_batch_size);
+
+  // Launch kernels
+  if (dims.mini_batch_size < 1) { return; }
+  auto&& stream = El::GPUManager::Stream();
+  dim3 grid_dims;
+  grid_dims.x = (dims.num_queries + block_size - 1) / block_size;
+  grid_dims.y = dims.num_heads;
+  grid_dims.z = std::min(dims.mini_batch_size, El::Int(65535));
+  LBANN_ATTENTION_LAUNCH(
+    bp_queries_kernel, max_head_dim, grid_dims, stream,
+    dims, scale,
+    local_queries.LockedBuffer(), local_queries.LDim(),
+    local_keys.LockedBuffer(), local_keys.LDim(),
+    local_values.LockedBuffer(), local_values.LDim(),
+    local_output.LockedBuffer(), local_output.LDim(),
+    local_output_grad.LockedBuffer(), local_output_grad.LDim(),
+    m_lse.LockedBuffer(), m_lse.LDim(),
+    m_workspace.Buffer(), m_workspace.LDim(),
+    local_queries_grad.Buffer(), local_queries_grad.LDim());
+  grid_dims.x = (dims.num_keys + block_size - 1) / block_size;
+  LBANN_ATTENTION_LAUNCH(
+    bp_keys_kernel, max_head_dim, grid_dims, stream,
+    dims, scale,
+    local_queries.LockedBuffer(), local_queries.LDim(),
+    local_keys.LockedBuffer(), local_keys.LDim(),
+    local_values.LockedBuffer(), local_values.LDim(),
+    local_output_grad.LockedBuffer(), local_output_grad.LDim(),
+    m_lse.LockedBuffer(), m_lse.LDim(),
+    m_workspace.LockedBuffer(), m_workspace.LDim(),
+    local_keys_grad.Buffer(), local_keys_grad.LDim(),
+    local_values_grad.Buffer(), local_values_grad.LDim());
+
+}
+
+// =========================================================
+// Explicit template instantiation
+// =========================================================
+
+#define PROTO(T)                                                \
+  template class scaled_dot_product_attention_layer<            \
+    T, data_layout::DATA_PARALLEL, El::Device::GPU>;
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
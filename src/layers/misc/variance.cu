@@ -26,54 +26,152 @@
 
 #define LBANN_VARIANCE_LAYER_INSTANTIATE
 #include "lbann/layers/misc/variance.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <algorithm>
 
 namespace lbann {
 
 namespace {
 
+/** Combine the moments of two sets of values.
+ *  Uses the pairwise update of Chan et al. m2 is the sum of squared
+ *  differences from the mean.
+ */
+template <typename TensorDataType>
+__device__ __forceinline__
+void merge_moments(El::Int& count, TensorDataType& mean, TensorDataType& m2,
+                   El::Int other_count,
+                   const TensorDataType& other_mean,
+                   const TensorDataType& other_m2) {
+  if (other_count == 0) { return; }
+  const El::Int total = count + other_count;
+  const TensorDataType delta = other_mean - mean;
+  mean += delta * TensorDataType(double(other_count) / double(total));
+  m2 += other_m2 + delta * delta * TensorDataType(double(count) * double(other_count) / double(total));
+  count = total;
+}
+
+/** Single-pass column-wise mean and variance contribution.
+ *  Each thread runs Welford's algorithm over a strided subset of the
+ *  column and the results are merged within the block, so no
+ *  intermediate means are needed. Outputs the local mean and scale
+ *  times the sum of squared differences from it.
+ *
+ *  Block dimensions: block_size x 1 x 1
+ *
+ *  Grid dimensions: 1 x width x 1
+ */
 template <typename TensorDataType, El::Int block_size>
-__global__ void variance_contribution_kernel(El::Int height,
-                                             El::Int width,
-                                             TensorDataType scale,
-                                             const TensorDataType* __restrict__ input,
-                                             El::Int input_ldim,
-                                             const TensorDataType* __restrict__ means,
-                                             TensorDataType* __restrict__ contribution) {
-
-  // Indices
+__global__ void variance_stats_kernel(El::Int height,
+                                      El::Int width,
+                                      TensorDataType scale,
+                                      const TensorDataType* __restrict__ input,
+                                      El::Int input_ldim,
+                                      TensorDataType* __restrict__ means,
+                                      TensorDataType* __restrict__ m2s) {
   const El::Int tid = threadIdx.x;
-  const El::Int gidx = threadIdx.x + blockIdx.x * blockDim.x;
-  const El::Int bidy = blockIdx.y;
-  const El::Int nthreadsx = blockDim.x * gridDim.x;
+  __shared__ El::Int shared_count[block_size];
+  __shared__ TensorDataType shared_mean[block_size];
+  __shared__ TensorDataType shared_m2[block_size];
+  for (El::Int col = blockIdx.y; col < width; col += gridDim.y) {
 
-  // Compute local contribution for each matrix column
-  for (El::Int col = bidy; col < width; col += gridDim.y) {
-    const auto& mean = means[col];
-
-    // Compute contributions for each thread
-    TensorDataType private_contribution = 0;
-    for (El::Int row = gidx; row < height; row += nthreadsx) {
-      const auto& diff = input[row + col * input_ldim] - mean;
-      private_contribution += diff * diff;
+    // Welford's algorithm for each thread
+    El::Int count = 0;
+    TensorDataType mean = 0, m2 = 0;
+    for (El::Int row = tid; row < height; row += block_size) {
+      const auto& x = input[row + col * input_ldim];
+      ++count;
+      const TensorDataType delta = x - mean;
+      mean += delta / TensorDataType(count);
+      m2 += delta * (x - mean);
     }
 
-    // Shared memory reduction to get contribution for each block
-    /// @todo unroll loops
-    __shared__ TensorDataType shared_contribution[block_size];
-    shared_contribution[tid] = private_contribution;
+    // Shared memory reduction to get moments for each column
+    __syncthreads();
+    shared_count[tid] = count;
+    shared_mean[tid] = mean;
+    shared_m2[tid] = m2;
     for (El::Int stride = block_size / 2; stride > 0; stride /= 2) {
       __syncthreads();
       if (tid < stride) {
-        shared_contribution[tid] += shared_contribution[tid + stride];
+        merge_moments(shared_count[tid], shared_mean[tid], shared_m2[tid],
+                      shared_count[tid + stride],
+                      shared_mean[tid + stride],
+                      shared_m2[tid + stride]);
       }
     }
     if (tid == 0) {
-      cuda::atomic_add(&contribution[col],
-                       scale * shared_contribution[0]);
+      means[col] = shared_mean[0];
+      m2s[col] = scale * shared_m2[0];
     }
 
   }
+}
 
+/** Merge moments gathered from the processes that share columns.
+ *  partials holds, for each process, the local means of each column
+ *  followed by the local sums of squared differences.
+ *
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: (width / bsize) x 1 x 1
+ */
+template <typename TensorDataType>
+__global__ void variance_merge_kernel(El::Int height,
+                                      El::Int width,
+                                      El::Int num_procs,
+                                      El::Int col_align,
+                                      TensorDataType scale,
+                                      const TensorDataType* __restrict__ partials,
+                                      TensorDataType* __restrict__ means,
+                                      TensorDataType* __restrict__ variances) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int nthreads = blockDim.x * gridDim.x;
+  for (El::Int col = gid; col < width; col += nthreads) {
+    El::Int count = 0;
+    TensorDataType mean = 0, m2 = 0;
+    for (El::Int rank = 0; rank < num_procs; ++rank) {
+      const El::Int shift = (rank + num_procs - col_align) % num_procs;
+      const El::Int rank_count = (height > shift
+                                  ? (height - shift - 1) / num_procs + 1
+                                  : 0);
+      const auto* rank_partials = &partials[2 * width * rank];
+      merge_moments(count, mean, m2, rank_count,
+                    rank_partials[col], rank_partials[width + col]);
+    }
+    means[col] = mean;
+    variances[col] = scale * m2;
+  }
+}
+
+/** Launch the stats kernel with a block size suited to the column
+ *  height.
+ */
+template <typename TensorDataType>
+void launch_variance_stats(El::Int height,
+                           El::Int width,
+                           TensorDataType scale,
+                           const TensorDataType* input,
+                           El::Int input_ldim,
+                           TensorDataType* means,
+                           TensorDataType* m2s) {
+  dim3 grid_dims;
+  grid_dims.y = std::min(width, El::Int(65535));
+  auto&& stream = El::GPUManager::Stream();
+  if (height <= 2048) {
+    variance_stats_kernel<TensorDataType, 64>
+      <<<grid_dims, 64, 0, stream>>>(
+        height, width, scale, input, input_ldim, means, m2s);
+  } else if (height <= 65536) {
+    variance_stats_kernel<TensorDataType, 256>
+      <<<grid_dims, 256, 0, stream>>>(
+        height, width, scale, input, input_ldim, means, m2s);
+  } else {
+    variance_stats_kernel<TensorDataType, 1024>
+      <<<grid_dims, 1024, 0, stream>>>(
+        height, width, scale, input, input_ldim, means, m2s);
+  }
 }
 
 template <typename TensorDataType>
@@ -102,61 +200,79 @@ void variance_backprop_kernel(El::Int height,
 }
 
 /** GPU forward prop implementation.
- *  We use a two-pass algorithm since it is more numerically stable
- *  than the naive single-pass algorithm.
+ *  Means and variances are computed in a single numerically stable
+ *  pass. If the columns are split among processes, the local moments
+ *  are gathered in one collective and merged.
  */
 template <typename TensorDataType>
-void fp_gpu(const El::AbstractDistMatrix<TensorDataType>& input,
+void fp_gpu(lbann_comm& comm,
+            const El::AbstractDistMatrix<TensorDataType>& input,
             El::AbstractDistMatrix<TensorDataType>& output,
             El::AbstractDistMatrix<TensorDataType>& means,
             El::AbstractDistMatrix<TensorDataType>& workspace,
             bool biased) {
-
-  // Local matrices
-  const auto& local_input = static_cast<const El::Matrix<TensorDataType, El::Device::GPU>&>(input.LockedMatrix());
-  auto& local_means = static_cast<El::Matrix<TensorDataType, El::Device::GPU>&>(means.Matrix());
-  auto& local_workspace = static_cast<El::Matrix<TensorDataType, El::Device::GPU>&>(workspace.Matrix());
+  using LocalMat = El::Matrix<TensorDataType, El::Device::GPU>;
 
   // Dimensions
   const auto& height = input.Height();
   const auto& width = input.Width();
-  const auto& local_height = local_input.Height();
-  const auto& local_width = local_input.Width();
 
-  // Compute column-wise mean
+  // Initialize outputs
   means.Empty(false);
   means.AlignWith(input);
   means.Resize(1, width);
-  El::Matrix<TensorDataType, El::Device::GPU> ones;
-#ifdef HYDROGEN_HAVE_CUB
-  ones.SetMemoryMode(1); // Use CUB GPU memory pool
-#endif // HYDROGEN_HAVE_CUB
-  ones.Resize(local_height, 1);
-  El::Fill(ones, El::TypeTraits<TensorDataType>::One());
-  El::Gemv(El::TRANSPOSE,
-           El::TypeTraits<TensorDataType>::One() / TensorDataType(height), local_input, ones,
-           El::TypeTraits<TensorDataType>::Zero(), local_means);
-  El::AllReduce(means, means.RedundantComm());
-
-  // Compute column-wise variance
   workspace.Empty(false);
   workspace.AlignWith(input);
-  El::Zeros(workspace, 1, width);
-  if (!local_input.IsEmpty()) {
-    constexpr El::Int block_size = 256;
-    dim3 block_dims, grid_dims;
-    block_dims.x = block_size;
-    grid_dims.x = (local_height + block_size - 1) / block_size;
-    grid_dims.y = local_width;
-    const auto& scale = El::TypeTraits<TensorDataType>::One() / (biased ? TensorDataType(height) : TensorDataType(height - 1));
-    variance_contribution_kernel<TensorDataType, block_size>
-      <<<grid_dims, block_dims, 0, El::GPUManager::Stream()>>>(
-        local_height, local_width, scale,
-        local_input.LockedBuffer(), local_input.LDim(),
-        local_means.LockedBuffer(),
-        local_workspace.Buffer());
+  workspace.Resize(1, width);
+
+  // Local matrices
+  const auto& local_input = static_cast<const LocalMat&>(input.LockedMatrix());
+  auto& local_means = static_cast<LocalMat&>(means.Matrix());
+  auto& local_workspace = static_cast<LocalMat&>(workspace.Matrix());
+  const auto& local_height = local_input.Height();
+  const auto& local_width = local_input.Width();
+  const auto& scale = El::TypeTraits<TensorDataType>::One() / (biased ? TensorDataType(height) : TensorDataType(height - 1));
+
+  // Compute column-wise moments
+  auto&& col_comm = input.ColComm();
+  const El::Int col_comm_size = El::mpi::Size(col_comm);
+  if (col_comm_size == 1) {
+    if (local_width > 0) {
+      launch_variance_stats(local_height, local_width, scale,
+                            local_input.LockedBuffer(), local_input.LDim(),
+                            local_means.Buffer(), local_workspace.Buffer());
+    }
+  }
+  else {
+    LocalMat partials, gathered;
+#ifdef HYDROGEN_HAVE_CUB
+    partials.SetMemoryMode(1); // Use CUB GPU memory pool
+    gathered.SetMemoryMode(1);
+#endif // HYDROGEN_HAVE_CUB
+    partials.Resize(local_width, 2);
+    gathered.Resize(2 * local_width, col_comm_size);
+    if (local_width > 0) {
+      launch_variance_stats(local_height, local_width,
+                            El::TypeTraits<TensorDataType>::One(),
+                            local_input.LockedBuffer(), local_input.LDim(),
+                            partials.Buffer(), partials.Buffer() + local_width);
+    }
+    auto&& stream = El::GPUManager::Stream();
+    auto&& event = El::GPUManager::Event();
+    const int bytes = 2 * local_width * sizeof(TensorDataType);
+    comm.all_gather(reinterpret_cast<const El::byte*>(partials.LockedBuffer()), bytes,
+                    reinterpret_cast<El::byte*>(gathered.Buffer()), bytes,
+                    col_comm, El::SyncInfo<El::Device::GPU>{stream, event});
+    if (local_width > 0) {
+      constexpr El::Int block_size = 256;
+      const El::Int grid_size = (local_width + block_size - 1) / block_size;
+      variance_merge_kernel<TensorDataType>
+        <<<grid_size, block_size, 0, stream>>>(
+          height, local_width, col_comm_size, input.ColAlign(), scale,
+          gathered.LockedBuffer(),
+          local_means.Buffer(), local_workspace.Buffer());
+    }
   }
-  El::AllReduce(workspace, workspace.RedundantComm());
   El::Copy(workspace, output);
 
 }
@@ -206,7 +322,8 @@ void bp_gpu(const El::AbstractDistMatrix<TensorDataType>& input,
 
 template <typename TensorDataType, data_layout Layout, El::Device Device>
 void variance_layer<TensorDataType, Layout, Device>::fp_compute() {
-  fp_gpu(this->get_prev_activations(),
+  fp_gpu(*this->get_comm(),
+         this->get_prev_activations(),
          this->get_activations(),
          *this->m_means,
          *this->m_workspace,
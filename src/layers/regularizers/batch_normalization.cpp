@@ -27,13 +27,16 @@
 #define LBANN_BATCH_NORMALIZATION_LAYER_INSTANTIATE
 #include "lbann/layers/regularizers/batch_normalization.hpp"
 
+#include <type_traits>
+
 namespace lbann {
 
 template <typename TensorDataType, data_layout T_layout, El::Device Dev>
 void batch_normalization_layer<TensorDataType, T_layout, Dev>::fp_compute() {
-  const TensorDataType zero = El::TypeTraits<TensorDataType>::Zero();
   const TensorDataType one = El::TypeTraits<TensorDataType>::One();
   const bool is_training = this->m_model->get_execution_context().get_execution_mode() == execution_mode::training;
+  using StatsDataType = typename std::conditional<
+    (sizeof(TensorDataType) < sizeof(float)), float, TensorDataType>::type;
 
   // Matrices
   const auto& input = this->get_prev_activations();
@@ -56,37 +59,51 @@ void batch_normalization_layer<TensorDataType, T_layout, Dev>::fp_compute() {
     auto& local_running_mean = this->get_data_type_weights(2).get_values().Matrix();
     auto& local_running_var = this->get_data_type_weights(3).get_values().Matrix();
 
-    // Compute sums and sums of squares
+    // Compute local statistics with Welford's algorithm
+    // Note: The statistics are packed as sums of deviations from the
+    // running mean, which is identical on all processes, so that they
+    // can be accumulated with a sum allreduce.
     LBANN_OMP_PARALLEL_FOR
     for (El::Int channel = 0; channel < num_channels; ++channel) {
-      TensorDataType sum = zero;
-      TensorDataType sqsum = zero;
+      El::Int count = 0;
+      StatsDataType mean = 0;
+      StatsDataType m2 = 0;
       const auto& row_start = channel * channel_size;
       const auto& row_end = (channel+1) * channel_size;
       for (El::Int col = 0; col < local_width; ++col) {
         for (El::Int row = row_start; row < row_end; ++row) {
-          const auto& x = local_input(row, col);
-          sum += x;
-          sqsum += x * x;
+          const StatsDataType x = local_input(row, col);
+          ++count;
+          const auto delta = x - mean;
+          mean += delta / count;
+          m2 += delta * (x - mean);
         }
       }
-      local_mean(channel, 0) = sum;
-      local_var(channel, 0) = sqsum;
+      const StatsDataType shift = local_running_mean(channel, 0);
+      const auto dev = mean - shift;
+      local_mean(channel, 0) = static_cast<TensorDataType>(count * dev);
+      local_var(channel, 0) = static_cast<TensorDataType>(m2 + count * dev * dev);
     }
+
+    // Start accumulating statistics while the sample count is found
     El::Int num_per_sum;
+    Al::request stats_req;
     if (this->m_statistics_group_size == 0) {
       // Global statistics aggregation; allreduce on fused buffer.
-      this->m_comm->allreduce(*this->m_mean_and_var, this->m_mean_and_var->RedundantComm(),
-                        El::mpi::SUM);
+      this->m_comm->nb_allreduce(*this->m_mean_and_var,
+                                 this->m_mean_and_var->RedundantComm(),
+                                 stats_req,
+                                 El::mpi::SUM);
       num_per_sum = channel_size * width;
     } else if (this->m_statistics_group_size == 1) {
       // Local aggregation, no allreduce needed.
       num_per_sum = channel_size * local_width;
     } else {
       // Grouped batchnorm. Allreduce on fused buffer.
-      this->m_comm->allreduce(*this->m_mean_and_var,
-                        this->m_comm->get_packed_group_comm(this->m_statistics_group_size),
-                        El::mpi::SUM);
+      this->m_comm->nb_allreduce(*this->m_mean_and_var,
+                                 this->m_comm->get_packed_group_comm(this->m_statistics_group_size),
+                                 stats_req,
+                                 El::mpi::SUM);
       if (this->m_num_per_sum_cache.count(width) == 0) {
         num_per_sum = channel_size * local_width;
         num_per_sum = this->m_comm->allreduce(
@@ -96,26 +113,29 @@ void batch_normalization_layer<TensorDataType, T_layout, Dev>::fp_compute() {
         num_per_sum = this->m_num_per_sum_cache[width];
       }
     }
+    this->m_comm->wait(stats_req);
 
     // Compute minibatch statistics
-    if (num_per_sum <= 1) {
-      El::Fill(local_var, one);
-    } else {
-      LBANN_OMP_PARALLEL_FOR
-      for (El::Int channel = 0; channel < num_channels; ++channel) {
-        auto num_per_sum_dt = El::To<TensorDataType>(num_per_sum);
-        const auto& mean = local_mean(channel, 0) / num_per_sum_dt;
-        const auto& sqmean = local_var(channel, 0) / num_per_sum_dt;
-        auto var = num_per_sum_dt * (sqmean - mean * mean)
-          / (num_per_sum_dt - El::TypeTraits<TensorDataType>::One());
-        var = std::max(var, this->m_epsilon);
-        local_mean(channel, 0) = mean;
-        local_var(channel, 0) = var;
-        auto& running_mean = local_running_mean(channel, 0);
-        auto& running_var = local_running_var(channel, 0);
-        running_mean = this->m_decay * running_mean + (one - this->m_decay) * mean;
-        running_var = this->m_decay * running_var + (one - this->m_decay) * var;
+    LBANN_OMP_PARALLEL_FOR
+    for (El::Int channel = 0; channel < num_channels; ++channel) {
+      auto& running_mean = local_running_mean(channel, 0);
+      auto& running_var = local_running_var(channel, 0);
+      if (num_per_sum <= 1) {
+        local_mean(channel, 0) += running_mean;
+        local_var(channel, 0) = one;
+        continue;
       }
+      auto num_per_sum_dt = El::To<TensorDataType>(num_per_sum);
+      const auto& dev_mean = local_mean(channel, 0) / num_per_sum_dt;
+      const auto& dev_sqmean = local_var(channel, 0) / num_per_sum_dt;
+      const auto mean = running_mean + dev_mean;
+      auto var = num_per_sum_dt * (dev_sqmean - dev_mean * dev_mean)
+        / (num_per_sum_dt - El::TypeTraits<TensorDataType>::One());
+      var = std::max(var, this->m_epsilon);
+      local_mean(channel, 0) = mean;
+      local_var(channel, 0) = var;
+      running_mean = this->m_decay * running_mean + (one - this->m_decay) * mean;
+      running_var = this->m_decay * running_var + (one - this->m_decay) * var;
     }
 
   }
@@ -222,23 +242,28 @@ void batch_normalization_layer<TensorDataType, T_layout, Dev>::bp_compute() {
 
   }
 
-  // Accumulate gradients
+  // Start accumulating gradients w.r.t. statistics
+  Al::request stats_req;
   if (is_training) {
     if (this->m_statistics_group_size == 0) {
       // Global aggregation; allreduce on fused buffer.
-      this->m_comm->allreduce(*this->m_mean_and_var_gradient,
-                        this->m_mean_and_var_gradient->RedundantComm(),
-                        El::mpi::SUM);
+      this->m_comm->nb_allreduce(*this->m_mean_and_var_gradient,
+                                 this->m_mean_and_var_gradient->RedundantComm(),
+                                 stats_req,
+                                 El::mpi::SUM);
     } else if (this->m_statistics_group_size > 1) {
       // Grouped batchnorm; allreduce on fused buffer.
-      this->m_comm->allreduce(*this->m_mean_and_var_gradient,
-                        this->m_comm->get_packed_group_comm(this->m_statistics_group_size),
-                        El::mpi::SUM);
+      this->m_comm->nb_allreduce(*this->m_mean_and_var_gradient,
+                                 this->m_comm->get_packed_group_comm(this->m_statistics_group_size),
+                                 stats_req,
+                                 El::mpi::SUM);
     }
   } else {
     // Zero fused buffer.
     El::Zero(*this->m_mean_and_var_gradient);
   }
+
+  // Scale and bias gradients are independent of the allreduce
   auto* scale_optimizer = this->get_data_type_weights(0).get_optimizer();
   if (scale_optimizer != nullptr) {
     scale_optimizer->add_to_gradient(*this->m_scale_gradient, El::TypeTraits<TensorDataType>::One(), true);
@@ -260,6 +285,7 @@ void batch_normalization_layer<TensorDataType, T_layout, Dev>::bp_compute() {
     // Grouped batchnorm.
     num_per_sum = this->m_num_per_sum_cache[width];  // This was computed in FP.
   }
+  this->m_comm->wait(stats_req);
   if (num_per_sum <= 1) {
     El::Zero(local_gradient_wrt_input);
   } else {
@@ -28,20 +28,30 @@
 #include "lbann/layers/regularizers/batch_normalization.hpp"
 #include "lbann/utils/cuda.hpp"
 
+#include <type_traits>
+
 namespace lbann {
 
 namespace {
 
-/** CUDA kernel to compute channel sums.
- *  Sums and squares of sums are used to compute mean and variance.
+/** CUDA kernel to compute channel statistics.
+ *
+ *  Each thread computes the mean and sum of squared deviations of a
+ *  row with Welford's algorithm. These are packed as sums of
+ *  deviations and squared deviations from a shift (the running mean,
+ *  which is identical on all processes), so that partial statistics
+ *  can be accumulated with sums.
  */
 template <El::Int block_size, typename TensorDataType>
-__global__ void channel_sums_kernel(
+__global__ void channel_stats_kernel(
   El::Int channel_height,
   El::Int width,
   const TensorDataType * __restrict__ data, El::Int data_ldim,
+  const TensorDataType * __restrict__ shifts,
         TensorDataType * __restrict__ sums,
         TensorDataType * __restrict__ sqsums) {
+  using StatsDataType = typename std::conditional<
+    (sizeof(TensorDataType) < sizeof(float)), float, TensorDataType>::type;
 
   // Indices
   const El::Int tid = threadIdx.x;
@@ -49,19 +59,26 @@ __global__ void channel_sums_kernel(
   const El::Int bidy = blockIdx.y;
 
   // Initialize shared memory
-  __shared__ TensorDataType shared_sums[block_size];
-  __shared__ TensorDataType shared_sqsums[block_size];
+  __shared__ StatsDataType shared_sums[block_size];
+  __shared__ StatsDataType shared_sqsums[block_size];
 
-  // Compute row sums in shared memory
-  TensorDataType private_sum = 0;
-  TensorDataType private_sqsum = 0;
+  // Compute row statistics
+  StatsDataType private_sum = 0;
+  StatsDataType private_sqsum = 0;
   if (gidx < channel_height) {
     const auto& row = gidx + bidy * channel_height;
+    StatsDataType mean = 0;
+    StatsDataType m2 = 0;
     for (El::Int col = 0; col < width; ++col) {
-      const auto& x = data[row + col * data_ldim];
-      private_sum += x;
-      private_sqsum += x * x;
+      const auto x = static_cast<StatsDataType>(data[row + col * data_ldim]);
+      const auto delta = x - mean;
+      mean += delta / static_cast<StatsDataType>(col + 1);
+      m2 += delta * (x - mean);
     }
+    const auto count = static_cast<StatsDataType>(width);
+    const auto dev = mean - static_cast<StatsDataType>(shifts[bidy]);
+    private_sum = count * dev;
+    private_sqsum = m2 + count * dev * dev;
   }
   shared_sums[tid] = private_sum;
   shared_sqsums[tid] = private_sqsum;
@@ -78,15 +95,16 @@ __global__ void channel_sums_kernel(
 
   // Output channel sum to global memory
   if (tid == 0) {
-    cuda::atomic_add(&sums[bidy], shared_sums[0]);
-    cuda::atomic_add(&sqsums[bidy], shared_sqsums[0]);
+    cuda::atomic_add(&sums[bidy], static_cast<TensorDataType>(shared_sums[0]));
+    cuda::atomic_add(&sqsums[bidy], static_cast<TensorDataType>(shared_sqsums[0]));
   }
 
 }
 
 /** CUDA kernel to compute statistics.
  *  On input, global_mean and global_var are assumed to contain sums
- *  and squares of sums, respectively.
+ *  of deviations and squared deviations from the running mean,
+ *  respectively.
  */
 template <typename TensorDataType>
 __global__ void compute_statistics_kernel(
@@ -102,19 +120,27 @@ __global__ void compute_statistics_kernel(
   const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
   const El::Int num_threads = blockDim.x * gridDim.x;
   for (El::Int i = gid; i < num_sums; i += num_threads) {
+    auto& running_mean = global_running_mean[i];
+    auto& running_var = global_running_var[i];
+
+    // Trivial statistics
+    if (num_per_sum <= 1) {
+      global_mean[i] += running_mean;
+      global_var[i] = TensorDataType(1.0);
+      continue;
+    }
 
     TensorDataType num_per_sum_dt = TensorDataType(num_per_sum);
     // Compute mean and variance
-    const auto& mean = global_mean[i] / num_per_sum_dt;
-    const auto& sqmean = global_var[i] / num_per_sum_dt;
-    auto var = num_per_sum_dt * (sqmean - mean * mean) / TensorDataType(num_per_sum - 1);
+    const auto& dev_mean = global_mean[i] / num_per_sum_dt;
+    const auto& dev_sqmean = global_var[i] / num_per_sum_dt;
+    const auto& mean = running_mean + dev_mean;
+    auto var = num_per_sum_dt * (dev_sqmean - dev_mean * dev_mean) / TensorDataType(num_per_sum - 1);
     var = var > epsilon ? var : epsilon;
-    global_mean[gid] = mean;
-    global_var[gid] = var;
+    global_mean[i] = mean;
+    global_var[i] = var;
 
     // Compute running statistics
-    auto& running_mean = global_running_mean[gid];
-    auto& running_var = global_running_var[gid];
     running_mean = decay * running_mean + (TensorDataType(1.0) - decay) * mean;
     running_var = decay * running_var + (TensorDataType(1.0) - decay) * var;
 
@@ -422,7 +448,7 @@ void batch_normalization_layer<TensorDataType, T_layout, Dev>::fp_compute() {
     auto& local_running_mean = this->get_data_type_weights(2).get_values().Matrix();
     auto& local_running_var = this->get_data_type_weights(3).get_values().Matrix();
 
-    // Compute sums and sums of squares
+    // Compute local statistics
     El::Zero(local_mean);
     El::Zero(local_var);
     if (!local_input.IsEmpty()) {
@@ -431,26 +457,33 @@ void batch_normalization_layer<TensorDataType, T_layout, Dev>::fp_compute() {
       block_dims.x = block_size;
       grid_dims.x = (channel_size + block_size - 1) / block_size;
       grid_dims.y = num_channels;
-      channel_sums_kernel<block_size>
+      channel_stats_kernel<block_size>
         <<<grid_dims, block_dims, 0, stream>>>(
           channel_size, local_width,
           local_input.LockedBuffer(), local_input.LDim(),
+          local_running_mean.LockedBuffer(),
           local_mean.Buffer(), local_var.Buffer());
     }
+
+    // Start accumulating statistics while the sample count is found
     El::Int num_per_sum;
+    Al::request stats_req;
     if (this->m_statistics_group_size == 0) {
       // Global statistics aggregation; allreduce on fused buffer.
-      this->m_comm->allreduce(*this->m_mean_and_var, this->m_mean_and_var->RedundantComm(),
-                        El::mpi::SUM);
+      this->m_comm->nb_allreduce(*this->m_mean_and_var,
+                                 this->m_mean_and_var->RedundantComm(),
+                                 stats_req,
+                                 El::mpi::SUM);
       num_per_sum = channel_size * width;
     } else if (this->m_statistics_group_size == 1) {
       // Local aggregation, no allreduce needed.
       num_per_sum = channel_size * local_width;
     } else {
       // Grouped batchnorm. Allreduce on fused buffer.
-      this->m_comm->allreduce(*this->m_mean_and_var,
-                        this->m_comm->get_packed_group_comm(this->m_statistics_group_size),
-                        El::mpi::SUM);
+      this->m_comm->nb_allreduce(*this->m_mean_and_var,
+                                 this->m_comm->get_packed_group_comm(this->m_statistics_group_size),
+                                 stats_req,
+                                 El::mpi::SUM);
       if (this->m_num_per_sum_cache.count(width) == 0) {
         num_per_sum = channel_size * local_width;
         num_per_sum = this->m_comm->allreduce(
@@ -460,11 +493,10 @@ void batch_normalization_layer<TensorDataType, T_layout, Dev>::fp_compute() {
         num_per_sum = this->m_num_per_sum_cache[width];
       }
     }
+    this->m_comm->wait(stats_req);
 
     // Compute minibatch statistics
-    if (num_per_sum <= 1) {
-      El::Fill(local_var, TensorDataType(1.0));
-    } else if (num_channels > 0) {
+    if (num_channels > 0) {
       const El::Int block_dim = 256;
       const El::Int grid_dim = (num_channels + block_dim - 1) / block_dim;
       compute_statistics_kernel<<<grid_dim, block_dim, 0, stream>>>(
@@ -563,23 +595,28 @@ void batch_normalization_layer<TensorDataType, T_layout, Dev>::bp_compute() {
         local_mean_gradient.Buffer(), local_var_gradient.Buffer());
   }
 
-  // Accumulate gradients
+  // Start accumulating gradients w.r.t. statistics
+  Al::request stats_req;
   if (is_training) {
     if (this->m_statistics_group_size == 0) {
       // Global aggregation; allreduce on fused buffer.
-      this->m_comm->allreduce(*this->m_mean_and_var_gradient,
-                        this->m_mean_and_var_gradient->RedundantComm(),
-                        El::mpi::SUM);
+      this->m_comm->nb_allreduce(*this->m_mean_and_var_gradient,
+                                 this->m_mean_and_var_gradient->RedundantComm(),
+                                 stats_req,
+                                 El::mpi::SUM);
     } else if (this->m_statistics_group_size > 1) {
       // Grouped batchnorm; allreduce on fused buffer.
-      this->m_comm->allreduce(*this->m_mean_and_var_gradient,
-                        this->m_comm->get_packed_group_comm(this->m_statistics_group_size),
-                        El::mpi::SUM);
+      this->m_comm->nb_allreduce(*this->m_mean_and_var_gradient,
+                                 this->m_comm->get_packed_group_comm(this->m_statistics_group_size),
+                                 stats_req,
+                                 El::mpi::SUM);
     }
   } else {
     // Zero fused buffer.
     El::Zero(*this->m_mean_and_var_gradient);
   }
+
+  // Scale and bias gradients are independent of the allreduce
   auto* scale_optimizer = this->get_data_type_weights(0).get_optimizer();
   if (scale_optimizer != nullptr) {
     scale_optimizer->add_to_gradient(*this->m_scale_gradient, TensorDataType(1.0), true);
@@ -601,6 +638,7 @@ void batch_normalization_layer<TensorDataType, T_layout, Dev>::bp_compute() {
     // Grouped batchnorm.
     num_per_sum = this->m_num_per_sum_cache[width];  // This was computed in FP.
   }
+  this->m_comm->wait(stats_req);
   if (num_per_sum <= 1) {
     El::Zero(local_gradient_wrt_input);
   } else if (!local_input.IsEmpty()) {
@@ -27,6 +27,9 @@
 #define LBANN_ENTRYWISE_BATCH_NORMALIZATION_LAYER_INSTANTIATE
 #include "lbann/layers/regularizers/entrywise_batch_normalization.hpp"
 
+#include <algorithm>
+#include <type_traits>
+
 namespace lbann {
 
 namespace {
@@ -37,9 +40,13 @@ constexpr El::Int _bsize = 64 / sizeof(DataType);
 constexpr El::Int bsize = _bsize > 1 ? _bsize : 1;
 
 /**
- *  mean = sum(x_i) / n
+ *  mean = shift + sum(x_i - shift) / n
+ *
+ *  var = ( sum((x_i-shift)^2)/n - (mean-shift)^2 ) * n/(n-1)
  *
- *  var = ( sum(x_i^2)/n - mean^2 ) * n/(n-1)
+ *  The shift is the running mean, which is identical on all
+ *  processes. Local sums are computed from Welford's algorithm so
+ *  that they can be accumulated with a sum allreduce.
  */
 template <typename TensorDataType>
 void compute_batch_statistics(lbann_comm& comm,
@@ -49,6 +56,8 @@ void compute_batch_statistics(lbann_comm& comm,
                               El::AbstractDistMatrix<TensorDataType>& running_mean,
                               El::AbstractDistMatrix<TensorDataType>& running_var) {
   using CPUMatType = El::Matrix<TensorDataType, El::Device::CPU>;
+  using StatsDataType = typename std::conditional<
+    (sizeof(TensorDataType) < sizeof(float)), float, TensorDataType>::type;
 
   // Local matrices
   const auto& local_input = dynamic_cast<const CPUMatType&>(input.LockedMatrix());
@@ -62,23 +71,37 @@ void compute_batch_statistics(lbann_comm& comm,
   const El::Int local_height = local_input.Height();
   const El::Int local_width = local_input.Width();
 
-  // Compute local sums
+  // Compute local statistics with Welford's algorithm
   El::Zero(batch_statistics);
   LBANN_OMP_PARALLEL_FOR
   for (El::Int row_start = 0; row_start < local_height; row_start += bsize) {
     const El::Int row_end = std::min(row_start + bsize, local_height);
     const El::Int col_start = 0;
     const El::Int col_end = local_width;
+    StatsDataType _mean[bsize], _m2[bsize];
+    std::fill(_mean, _mean + bsize, StatsDataType(0));
+    std::fill(_m2, _m2 + bsize, StatsDataType(0));
     for (El::Int col = col_start; col < col_end; ++col) {
+      const StatsDataType inv_count = StatsDataType(1) / (col - col_start + 1);
       for (El::Int row = row_start; row < row_end; ++row) {
-        const auto& x = local_input(row, col);
-        local_batch_mean(row, 0) += x;
-        local_batch_var(row, 0) += x * x;
+        const StatsDataType x = local_input(row, col);
+        auto& mean = _mean[row - row_start];
+        const auto delta = x - mean;
+        mean += delta * inv_count;
+        _m2[row - row_start] += delta * (x - mean);
       }
     }
+    const StatsDataType count = col_end - col_start;
+    for (El::Int row = row_start; row < row_end; ++row) {
+      const StatsDataType shift = local_running_mean(row, 0);
+      const auto dev = _mean[row - row_start] - shift;
+      local_batch_mean(row, 0) = static_cast<TensorDataType>(count * dev);
+      local_batch_var(row, 0) = static_cast<TensorDataType>(
+        _m2[row - row_start] + count * dev * dev);
+    }
   }
 
-  // Accumulate sums between processes
+  // Accumulate statistics between processes
   /// @todo Local statistics
   /// @todo Arbitrary group sizes
   comm.allreduce(batch_statistics,
@@ -86,9 +109,12 @@ void compute_batch_statistics(lbann_comm& comm,
                  El::mpi::SUM);
   const size_t statistics_count = input.Width();
 
-  // Compute mini-batch statistics from sums
+  // Compute mini-batch statistics
   if (statistics_count <= 1) {
-    // local_mean already has correct values
+    LBANN_OMP_PARALLEL_FOR
+    for (El::Int row = 0; row < local_height; ++row) {
+      local_batch_mean(row, 0) += local_running_mean(row, 0);
+    }
     El::Fill(local_batch_var, El::TypeTraits<TensorDataType>::One());
   } else {
     LBANN_OMP_PARALLEL_FOR
@@ -97,11 +123,10 @@ void compute_batch_statistics(lbann_comm& comm,
       auto& var = local_batch_var(row, 0);
       auto& _running_mean = local_running_mean(row, 0);
       auto& _running_var = local_running_var(row, 0);
-      const auto sum = local_batch_mean(row, 0);
-      const auto sqsum = local_batch_var(row, 0);
-      mean = sum / statistics_count;
-      const auto sqmean = sqsum / statistics_count;
-      var = (sqmean - mean * mean) * statistics_count / (statistics_count - 1);
+      const auto dev_mean = local_batch_mean(row, 0) / statistics_count;
+      const auto dev_sqmean = local_batch_var(row, 0) / statistics_count;
+      mean = _running_mean + dev_mean;
+      var = (dev_sqmean - dev_mean * dev_mean) * statistics_count / (statistics_count - 1);
       _running_mean = decay * _running_mean + (DataType{1} - decay) * mean;
       _running_var = decay * _running_var + (DataType{1} - decay) * var;
     }
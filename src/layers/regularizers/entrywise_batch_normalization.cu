@@ -28,40 +28,55 @@
 #include "lbann/layers/regularizers/entrywise_batch_normalization.hpp"
 #include "lbann/utils/cuda.hpp"
 
+#include <type_traits>
+
 namespace lbann {
 
 namespace {
 
 /**
- *  On input, sums and sqsums are assumed to be filled with zeros.
+ *  Computes the mean and sum of squared deviations of each row with
+ *  Welford's algorithm and packs them as sums of deviations and
+ *  squared deviations from a shift (the running mean, which is
+ *  identical on all processes). This way, partial statistics can be
+ *  accumulated with a sum allreduce.
  *
  *  Block dimensions: bsize x 1 x 1
  *
  *  Grid dimensions: (height / bsize) x 1 x 1
  */
 template <typename TensorDataType>
-__global__ void row_sums_kernel(size_t height,
-                                size_t width,
-                                const TensorDataType* __restrict__ vals,
-                                size_t vals_ldim,
-                                TensorDataType* __restrict__ sums,
-                                TensorDataType* __restrict__ sqsums) {
+__global__ void row_stats_kernel(size_t height,
+                                 size_t width,
+                                 const TensorDataType* __restrict__ vals,
+                                 size_t vals_ldim,
+                                 const TensorDataType* __restrict__ shifts,
+                                 TensorDataType* __restrict__ sums,
+                                 TensorDataType* __restrict__ sqsums) {
+  using StatsDataType = typename std::conditional<
+    (sizeof(TensorDataType) < sizeof(float)), float, TensorDataType>::type;
   const size_t gid = threadIdx.x + blockIdx.x * blockDim.x;
   const size_t nthreads = blockDim.x * gridDim.x;
   for (size_t row = gid; row < height; row += nthreads) {
-    auto& sum = sums[row];
-    auto& sqsum = sqsums[row];
+    StatsDataType mean = 0;
+    StatsDataType m2 = 0;
     for (size_t col = 0; col < width; ++col) {
-      const auto& x = vals[row + col * vals_ldim];
-      sum += x;
-      sqsum += x * x;
+      const auto x = static_cast<StatsDataType>(vals[row + col * vals_ldim]);
+      const auto delta = x - mean;
+      mean += delta / static_cast<StatsDataType>(col + 1);
+      m2 += delta * (x - mean);
     }
+    const auto count = static_cast<StatsDataType>(width);
+    const auto dev = mean - static_cast<StatsDataType>(shifts[row]);
+    sums[row] = static_cast<TensorDataType>(count * dev);
+    sqsums[row] = static_cast<TensorDataType>(m2 + count * dev * dev);
   }
 }
 
 /**
- *  On input, batch_mean and batch_var are assumed to contain sums and
- *  squares of sums, respectively.
+ *  On input, batch_mean and batch_var are assumed to contain sums of
+ *  deviations and squared deviations from the running mean,
+ *  respectively.
  *
  *  Block dimensions: bsize x 1 x 1
  *
@@ -82,21 +97,25 @@ __global__ void compute_statistics_kernel(size_t size,
     auto& var = batch_var[i];
     auto& _running_mean = running_mean[i];
     auto& _running_var = running_var[i];
-    const auto sum = batch_mean[i];
-    const auto sqsum = batch_var[i];
+    if (statistics_count <= 1) {
+      mean += _running_mean;
+      var = TensorDataType{1};
+      continue;
+    }
     const TensorDataType statistics_count_dt = TensorDataType(statistics_count);
-    mean = sum / statistics_count_dt;
-    const auto sqmean = sqsum / statistics_count_dt;
-    var = (sqmean - mean * mean) * statistics_count_dt / TensorDataType(statistics_count - 1);
+    const auto dev_mean = batch_mean[i] / statistics_count_dt;
+    const auto dev_sqmean = batch_var[i] / statistics_count_dt;
+    mean = _running_mean + dev_mean;
+    var = (dev_sqmean - dev_mean * dev_mean) * statistics_count_dt / TensorDataType(statistics_count - 1);
     _running_mean = decay * _running_mean + (TensorDataType{1} - decay) * mean;
     _running_var = decay * _running_var + (TensorDataType{1} - decay) * var;
   }
 }
 
 /**
- *  mean = sum(x_i) / n
+ *  mean = shift + sum(x_i - shift) / n
  *
- *  var = ( sum(x_i^2)/n - mean^2 ) * n/(n-1)
+ *  var = ( sum((x_i-shift)^2)/n - (mean-shift)^2 ) * n/(n-1)
  */
 template <typename TensorDataType>
 void compute_batch_statistics(lbann_comm& comm,
@@ -118,24 +137,25 @@ void compute_batch_statistics(lbann_comm& comm,
   const size_t local_height = local_input.Height();
   const size_t local_width = local_input.Width();
 
-  // Compute local sums
+  // Compute local statistics
   El::Zero(batch_statistics);
   if (local_height > 0) {
     constexpr size_t block_size = 256;
     dim3 block_dims, grid_dims;
     block_dims.x = block_size;
     grid_dims.x = (local_height + block_size - 1) / block_size;
-    row_sums_kernel<TensorDataType>
+    row_stats_kernel<TensorDataType>
       <<<grid_dims, block_dims, 0, El::GPUManager::Stream()>>>(
         local_height,
         local_width,
         local_input.LockedBuffer(),
         local_input.LDim(),
+        local_running_mean.LockedBuffer(),
         local_batch_mean.Buffer(),
         local_batch_var.Buffer());
   }
 
-  // Accumulate sums between processes
+  // Accumulate statistics between processes
   /// @todo Local statistics
   /// @todo Arbitrary group sizes
   comm.allreduce(batch_statistics,
@@ -143,26 +163,21 @@ void compute_batch_statistics(lbann_comm& comm,
                  El::mpi::SUM);
   const size_t statistics_count = input.Width();
 
-  // Compute mini-batch statistics from sums
-  if (statistics_count <= 1) {
-    // local_mean already has correct values
-    El::Fill(local_batch_var, El::TypeTraits<TensorDataType>::One());
-  } else {
-    if (local_height > 0) {
-      constexpr size_t block_size = 256;
-      dim3 block_dims, grid_dims;
-      block_dims.x = block_size;
-      grid_dims.x = (local_height + block_size - 1) / block_size;
-      compute_statistics_kernel<TensorDataType>
-        <<<grid_dims, block_dims, 0, El::GPUManager::Stream()>>>(
-          local_height,
-          statistics_count,
-          decay,
-          local_batch_mean.Buffer(),
-          local_batch_var.Buffer(),
-          local_running_mean.Buffer(),
-          local_running_var.Buffer());
-    }
+  // Compute mini-batch statistics
+  if (local_height > 0) {
+    constexpr size_t block_size = 256;
+    dim3 block_dims, grid_dims;
+    block_dims.x = block_size;
+    grid_dims.x = (local_height + block_size - 1) / block_size;
+    compute_statistics_kernel<TensorDataType>
+      <<<grid_dims, block_dims, 0, El::GPUManager::Stream()>>>(
+        local_height,
+        statistics_count,
+        decay,
+        local_batch_mean.Buffer(),
+        local_batch_var.Buffer(),
+        local_running_mean.Buffer(),
+        local_running_var.Buffer());
   }
 
 }
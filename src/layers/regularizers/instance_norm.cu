@@ -27,6 +27,7 @@
 #define LBANN_INSTANCE_NORM_LAYER_INSTANTIATE
 #include "lbann/layers/regularizers/instance_norm.hpp"
 #include "lbann/utils/cuda.hpp"
+#include "lbann/utils/row_normalization.hpp"
 
 #include <thrust/pair.h>
 
@@ -169,6 +170,7 @@ __global__ void fp_output_kernel(
 /** @brief Forward prop */
 template <typename TensorDataType>
 void fp_impl(lbann_comm& comm,
+             row_normalization_kernel kernel,
              size_t num_channels,
              size_t channel_size,
              TensorDataType epsilon,
@@ -192,6 +194,20 @@ void fp_impl(lbann_comm& comm,
     return;
   }
 
+  // Compute statistics and outputs in one kernel
+  if (kernel != row_normalization_kernel::grid) {
+    const El::Int num_rows = num_channels * local_mini_batch_size;
+    local_workspace.Resize(2, num_rows);
+    cuda::fused_row_normalization_forward(
+      kernel, num_rows, num_channels, channel_size, epsilon,
+      local_input.LockedBuffer(), local_input.LDim(),
+      local_output.Buffer(), local_output.LDim(),
+      local_workspace.Buffer(0, 0), local_workspace.LDim(),
+      local_workspace.Buffer(1, 0), local_workspace.LDim(),
+      El::GPUManager::Stream());
+    return;
+  }
+
   // Compute sums
   El::Zeros(local_workspace, 2*num_channels, local_mini_batch_size);
   auto local_sums = El::View(local_workspace,
@@ -241,6 +257,7 @@ void instance_norm_layer<TensorDataType, Layout, Device>::fp_compute()
   const size_t num_channels = this->get_output_dims().front();
   const size_t channel_size = this->get_output_size() / num_channels;
   fp_impl(*this->get_comm(),
+          this->m_kernel,
           num_channels,
           channel_size,
           this->m_epsilon,
@@ -406,6 +423,7 @@ __global__ void bp_input_grad_kernel(
 /** @brief Backprop */
 template <typename TensorDataType>
 void bp_impl(lbann_comm& comm,
+             row_normalization_kernel kernel,
              size_t num_channels,
              size_t channel_size,
              TensorDataType epsilon,
@@ -437,6 +455,20 @@ void bp_impl(lbann_comm& comm,
     return;
   }
 
+  // Compute gradient w.r.t. input in one kernel
+  if (kernel != row_normalization_kernel::grid) {
+    cuda::fused_row_normalization_backward(
+      kernel, num_channels * local_mini_batch_size, num_channels, channel_size,
+      epsilon,
+      local_input.LockedBuffer(), local_input.LDim(),
+      local_output_grad.LockedBuffer(), local_output_grad.LDim(),
+      local_input_grad.Buffer(), local_input_grad.LDim(),
+      local_workspace.LockedBuffer(0, 0), local_workspace.LDim(),
+      local_workspace.LockedBuffer(1, 0), local_workspace.LDim(),
+      El::GPUManager::Stream());
+    return;
+  }
+
   // Compute gradient w.r.t. statistics
   LocalMat local_statistics_grad;
   El::Zeros(local_statistics_grad, 2*num_channels, local_mini_batch_size);
@@ -494,6 +526,7 @@ void instance_norm_layer<TensorDataType, Layout, Device>::bp_compute()
   const size_t num_channels = this->get_output_dims().front();
   const size_t channel_size = this->get_output_size() / num_channels;
   bp_impl(*this->get_comm(),
+          this->m_kernel,
           num_channels,
           channel_size,
           this->m_epsilon,
@@ -27,6 +27,7 @@
 #define LBANN_LAYER_NORM_LAYER_INSTANTIATE
 #include "lbann/layers/regularizers/layer_norm.hpp"
 #include "lbann/utils/cuda.hpp"
+#include "lbann/utils/row_normalization.hpp"
 
 #include <thrust/pair.h>
 
@@ -173,6 +174,7 @@ __global__ void fp_output_kernel(
 /** @brief Forward prop */
 template <typename TensorDataType>
 void fp_impl(lbann_comm& comm,
+             row_normalization_kernel kernel,
              TensorDataType epsilon,
              const El::AbstractDistMatrix<TensorDataType>& input,
              El::AbstractDistMatrix<TensorDataType>& output,
@@ -183,8 +185,8 @@ void fp_impl(lbann_comm& comm,
   const auto& local_input = dynamic_cast<const GPUMatType&>(input.LockedMatrix());
   auto& local_output = dynamic_cast<GPUMatType&>(output.Matrix());
   auto& local_statistics = dynamic_cast<GPUMatType&>(statistics.Matrix());
-  auto local_means = El::LockedView(local_statistics, El::IR(0), El::ALL);
-  auto local_vars = El::LockedView(local_statistics, El::IR(1), El::ALL);
+  auto local_means = El::View(local_statistics, El::IR(0), El::ALL);
+  auto local_vars = El::View(local_statistics, El::IR(1), El::ALL);
 
   // Dimensions
   const size_t sample_size = input.Height();
@@ -194,6 +196,18 @@ void fp_impl(lbann_comm& comm,
   // Trivial cases
   if (local_num_samples < 1) { return; }
 
+  // Compute statistics and outputs in one kernel if samples are local
+  if (kernel != row_normalization_kernel::grid) {
+    cuda::fused_row_normalization_forward(
+      kernel, local_num_samples, 1, local_sample_size, epsilon,
+      local_input.LockedBuffer(), local_input.LDim(),
+      local_output.Buffer(), local_output.LDim(),
+      local_means.Buffer(), local_means.LDim(),
+      local_vars.Buffer(), local_vars.LDim(),
+      El::GPUManager::Stream());
+    return;
+  }
+
   // Compute sums
   El::Zero(statistics);
   if (!local_input.IsEmpty()) {
@@ -367,6 +381,7 @@ __global__ void bp_input_grad_kernel(
 /** @brief Backprop */
 template <typename TensorDataType>
 void bp_impl(lbann_comm& comm,
+             row_normalization_kernel kernel,
              TensorDataType epsilon,
              const El::AbstractDistMatrix<TensorDataType>& input,
              const El::AbstractDistMatrix<TensorDataType>& output_grad,
@@ -398,6 +413,19 @@ void bp_impl(lbann_comm& comm,
     return;
   }
 
+  // Compute gradient w.r.t. input in one kernel if samples are local
+  if (kernel != row_normalization_kernel::grid) {
+    cuda::fused_row_normalization_backward(
+      kernel, local_num_samples, 1, local_sample_size, epsilon,
+      local_input.LockedBuffer(), local_input.LDim(),
+      local_output_grad.LockedBuffer(), local_output_grad.LDim(),
+      local_input_grad.Buffer(), local_input_grad.LDim(),
+      local_means.LockedBuffer(), local_means.LDim(),
+      local_vars.LockedBuffer(), local_vars.LDim(),
+      El::GPUManager::Stream());
+    return;
+  }
+
   // Compute gradient w.r.t. statistics
   El::Zero(statistics_grad);
   if (!local_output_grad.IsEmpty()) {
@@ -447,6 +475,7 @@ void bp_impl(lbann_comm& comm,
 template <typename TensorDataType, data_layout Layout, El::Device Device>
 void layer_norm_layer<TensorDataType, Layout, Device>::fp_compute() {
   fp_impl(*this->get_comm(),
+          this->m_kernel,
           this->m_epsilon,
           this->get_prev_activations(),
           this->get_activations(),
@@ -456,6 +485,7 @@ void layer_norm_layer<TensorDataType, Layout, Device>::fp_compute() {
 template <typename TensorDataType, data_layout Layout, El::Device Device>
 void layer_norm_layer<TensorDataType, Layout, Device>::bp_compute() {
   bp_impl(*this->get_comm(),
+          this->m_kernel,
           this->m_epsilon,
           this->get_prev_activations(),
           this->get_prev_error_signals(),
@@ -31,17 +31,17 @@ namespace lbann {
 
 namespace {
 
-using dim4 = std::array<size_t, 4>;
+using dim5 = std::array<size_t, 5>;
 
-/** @brief Concatenate 4D tensors. */
+/** @brief Concatenate 5D tensors. */
 template <typename T>
-void concat4d(
+void concat5d(
   size_t concat_dim,
   const std::vector<const T*>& input_buffer_list,
-  const std::vector<dim4>& input_dims_list,
-  const std::vector<dim4>& input_strides_list,
+  const std::vector<dim5>& input_dims_list,
+  const std::vector<dim5>& input_strides_list,
   T* output_buffer,
-  const dim4& output_strides) {
+  const dim5& output_strides) {
 
   // Compute offset corresponding to each input tensor
   std::vector<size_t> output_offset_list;
@@ -60,21 +60,25 @@ void concat4d(
     const auto& output_offset = output_offset_list[j];
 
     // Copy input tensor to corresponding position in output tensor
-    LBANN_OMP_PARALLEL_FOR_COLLAPSE4
+    LBANN_OMP_PARALLEL_FOR_COLLAPSE5
     for (size_t i0=0; i0<input_dims[0]; ++i0) {
       for (size_t i1=0; i1<input_dims[1]; ++i1) {
         for (size_t i2=0; i2<input_dims[2]; ++i2) {
           for (size_t i3=0; i3<input_dims[3]; ++i3) {
-            const auto& x = input_buffer[i0 * input_strides[0]
-                                         + i1 * input_strides[1]
-                                         + i2 * input_strides[2]
-                                         + i3 * input_strides[3]];
-            auto& y = output_buffer[output_offset
-                                    + i0 * output_strides[0]
-                                    + i1 * output_strides[1]
-                                    + i2 * output_strides[2]
-                                    + i3 * output_strides[3]];
-            y = x;
+            for (size_t i4=0; i4<input_dims[4]; ++i4) {
+              const auto& x = input_buffer[i0 * input_strides[0]
+                                           + i1 * input_strides[1]
+                                           + i2 * input_strides[2]
+                                           + i3 * input_strides[3]
+                                           + i4 * input_strides[4]];
+              auto& y = output_buffer[output_offset
+                                      + i0 * output_strides[0]
+                                      + i1 * output_strides[1]
+                                      + i2 * output_strides[2]
+                                      + i3 * output_strides[3]
+                                      + i4 * output_strides[4]];
+              y = x;
+            }
           }
         }
       }
@@ -84,15 +88,15 @@ void concat4d(
 
 }
 
-/** @brief Slice 4D tensors. */
+/** @brief Slice 5D tensors. */
 template <typename T>
-void slice4d(
+void slice5d(
   size_t slice_dim,
   const T* input_buffer,
-  const dim4& input_strides,
+  const dim5& input_strides,
   const std::vector<T*>& output_buffer_list,
-  const std::vector<dim4>& output_dims_list,
-  const std::vector<dim4>& output_strides_list) {
+  const std::vector<dim5>& output_dims_list,
+  const std::vector<dim5>& output_strides_list) {
 
   // Compute offset corresponding to each output tensor
   std::vector<size_t> input_offset_list;
@@ -111,21 +115,25 @@ void slice4d(
     const auto& input_offset = input_offset_list[j];
 
     // Copy output tensor to corresponding position in input tensor
-    LBANN_OMP_PARALLEL_FOR_COLLAPSE4
+    LBANN_OMP_PARALLEL_FOR_COLLAPSE5
     for (size_t i0=0; i0<output_dims[0]; ++i0) {
       for (size_t i1=0; i1<output_dims[1]; ++i1) {
         for (size_t i2=0; i2<output_dims[2]; ++i2) {
           for (size_t i3=0; i3<output_dims[3]; ++i3) {
-            auto& x = input_buffer[input_offset
-                                   + i0 * input_strides[0]
-                                   + i1 * input_strides[1]
-                                   + i2 * input_strides[2]
-                                   + i3 * input_strides[3]];
-            auto& y = output_buffer[i0 * output_strides[0]
-                                    + i1 * output_strides[1]
-                                    + i2 * output_strides[2]
-                                    + i3 * output_strides[3]];
-            y = x;
+            for (size_t i4=0; i4<output_dims[4]; ++i4) {
+              auto& x = input_buffer[input_offset
+                                     + i0 * input_strides[0]
+                                     + i1 * input_strides[1]
+                                     + i2 * input_strides[2]
+                                     + i3 * input_strides[3]
+                                     + i4 * input_strides[4]];
+              auto& y = output_buffer[i0 * output_strides[0]
+                                      + i1 * output_strides[1]
+                                      + i2 * output_strides[2]
+                                      + i3 * output_strides[3]
+                                      + i4 * output_strides[4]];
+              y = x;
+            }
           }
         }
       }
@@ -174,41 +182,45 @@ void fp_compute_impl(
   // Check that number of dimensions is valid
   /// @todo Support tensors with arbitrary number of dimensions
   const size_t num_dims = l.get_output_dims().size();
-  if (num_dims > 3) {
+  if (num_dims > 4) {
     LBANN_ERROR(l.get_type()," layer \"",l.get_name(),"\" ",
                 "is operating on ",num_dims,"-D tensors, ",
-                "but only 3-D tensors are currently supported");
+                "but only tensors with up to 4 dimensions are currently supported");
   }
 
   // Get dimensions and strides for each input tensor
   std::vector<const TensorDataType*> input_buffer_list;
-  std::vector<dim4> input_dims_list, input_strides_list;
+  std::vector<dim5> input_dims_list, input_strides_list;
   for (size_t j=0; j<static_cast<size_t>(l.get_num_parents()); ++j) {
     const auto& input = l.get_prev_activations(j);
     const auto& input_dims = l.get_input_dims(j);
+    const auto concat_dims = l.get_concat_input_dims(j);
 
     // Construct dimensions and strides in reverse order
-    // Note: Assume each mini-batch sample is fully packed.
-    std::vector<size_t> rdims(input_dims.rbegin(), input_dims.rend());
+    // Note: Assume each mini-batch sample is fully packed. Cropped
+    // inputs are read at the strides of the full tensor.
+    std::vector<size_t> rdims(concat_dims.rbegin(), concat_dims.rend());
+    std::vector<size_t> rfull_dims(input_dims.rbegin(), input_dims.rend());
     std::vector<size_t> rstrides(input_dims.size(), 1);
     for (size_t d=1; d<input_dims.size(); ++d) {
-      rstrides[d] = rdims[d-1] * rstrides[d-1];
+      rstrides[d] = rfull_dims[d-1] * rstrides[d-1];
     }
     rdims.push_back(input.LocalWidth());
     rstrides.push_back(input.LDim());
 
-    // Pad tensor dimensions to 4D
-    rdims.resize(4, 1);
-    rstrides.resize(4, rstrides.back());
+    // Pad tensor dimensions to 5D
+    rdims.resize(5, 1);
+    rstrides.resize(5, rstrides.back());
 
-    input_buffer_list.push_back(input.LockedBuffer());
-    input_dims_list.push_back({rdims[3], rdims[2], rdims[1], rdims[0]});
+    input_buffer_list.push_back(input.LockedBuffer()
+                                + l.get_input_crop_offset(j));
+    input_dims_list.push_back({rdims[4], rdims[3], rdims[2], rdims[1], rdims[0]});
     input_strides_list.push_back(
-      {rstrides[3], rstrides[2], rstrides[1], rstrides[0]});
+      {rstrides[4], rstrides[3], rstrides[2], rstrides[1], rstrides[0]});
   }
 
   // Get strides for output tensor
-  dim4 output_strides;
+  dim5 output_strides;
   auto& output = l.get_activations();
   {
     const auto& output_dims = l.get_output_dims();
@@ -223,16 +235,16 @@ void fp_compute_impl(
     rdims.push_back(output.LocalWidth());
     rstrides.push_back(output.LDim());
 
-    // Pad tensor dimensions to 4D
-    rdims.resize(4, 1);
-    rstrides.resize(4, rstrides.back());
+    // Pad tensor dimensions to 5D
+    rdims.resize(5, 1);
+    rstrides.resize(5, rstrides.back());
 
-    output_strides = {rstrides[3], rstrides[2], rstrides[1], rstrides[0]};
+    output_strides = {rstrides[4], rstrides[3], rstrides[2], rstrides[1], rstrides[0]};
   }
 
-  // Concatenate 4D tensors
-  concat4d<TensorDataType>(
-    concat_dim + (4-num_dims),
+  // Concatenate 5D tensors
+  concat5d<TensorDataType>(
+    concat_dim + (5-num_dims),
     input_buffer_list,
     input_dims_list,
     input_strides_list,
@@ -249,43 +261,47 @@ void bp_compute_impl(
   // Check that number of dimensions is valid
   /// @todo Support tensors with arbitrary number of dimensions
   const size_t num_dims = l.get_output_dims().size();
-  if (num_dims > 3) {
+  if (num_dims > 4) {
     LBANN_ERROR(l.get_type()," layer \"",l.get_name(),"\" ",
                 "is operating on ",num_dims,"-D tensors, ",
-                "but only 3-D tensors are currently supported");
+                "but only tensors with up to 4 dimensions are currently supported");
   }
 
   // Get dimensions and strides for each input gradient tensor
   std::vector<TensorDataType*> input_grad_buffer_list;
-  std::vector<dim4> input_grad_dims_list, input_grad_strides_list;
+  std::vector<dim5> input_grad_dims_list, input_grad_strides_list;
   const size_t num_inputs = l.get_num_parents();
   for (size_t j=0; j<num_inputs; ++j) {
     auto& input_grad = l.get_error_signals(j);
     const auto& input_grad_dims = l.get_input_dims(j);
+    const auto concat_dims = l.get_concat_input_dims(j);
 
     // Construct dimensions and strides in reverse order
-    // Note: Assume each mini-batch sample is fully packed.
-    std::vector<size_t> rdims(input_grad_dims.rbegin(), input_grad_dims.rend());
+    // Note: Assume each mini-batch sample is fully packed. Cropped
+    // inputs are written at the strides of the full tensor.
+    std::vector<size_t> rdims(concat_dims.rbegin(), concat_dims.rend());
+    std::vector<size_t> rfull_dims(input_grad_dims.rbegin(), input_grad_dims.rend());
     std::vector<size_t> rstrides(input_grad_dims.size(), 1);
     for (size_t d=1; d<input_grad_dims.size(); ++d) {
-      rstrides[d] = rdims[d-1] * rstrides[d-1];
+      rstrides[d] = rfull_dims[d-1] * rstrides[d-1];
     }
     rdims.push_back(input_grad.LocalWidth());
     rstrides.push_back(input_grad.LDim());
 
-    // Pad tensor dimensions to 4D
-    rdims.resize(4, 1);
-    rstrides.resize(4, rstrides.back());
+    // Pad tensor dimensions to 5D
+    rdims.resize(5, 1);
+    rstrides.resize(5, rstrides.back());
 
-    input_grad_buffer_list.push_back(input_grad.Buffer());
-    input_grad_dims_list.push_back({rdims[3], rdims[2], rdims[1], rdims[0]});
+    input_grad_buffer_list.push_back(input_grad.Buffer()
+                                     + l.get_input_crop_offset(j));
+    input_grad_dims_list.push_back({rdims[4], rdims[3], rdims[2], rdims[1], rdims[0]});
     input_grad_strides_list.push_back(
-      {rstrides[3], rstrides[2], rstrides[1], rstrides[0]});
+      {rstrides[4], rstrides[3], rstrides[2], rstrides[1], rstrides[0]});
   }
 
   // Get strides for output gradient tensor
   const auto& output_grad = l.get_prev_error_signals();
-  dim4 output_grad_strides;
+  dim5 output_grad_strides;
   {
     const auto& output_grad_dims = l.get_output_dims();
 
@@ -299,16 +315,16 @@ void bp_compute_impl(
     rdims.push_back(output_grad.LocalWidth());
     rstrides.push_back(output_grad.LDim());
 
-    // Pad tensor dimensions to 4D
-    rdims.resize(4, 1);
-    rstrides.resize(4, rstrides.back());
+    // Pad tensor dimensions to 5D
+    rdims.resize(5, 1);
+    rstrides.resize(5, rstrides.back());
 
-    output_grad_strides = {rstrides[3], rstrides[2], rstrides[1], rstrides[0]};
+    output_grad_strides = {rstrides[4], rstrides[3], rstrides[2], rstrides[1], rstrides[0]};
   }
 
-  // Slice 4D tensor
-  slice4d<TensorDataType>(
-    concat_dim + (4-num_dims),
+  // Slice 5D tensor
+  slice5d<TensorDataType>(
+    concat_dim + (5-num_dims),
     output_grad.LockedBuffer(),
     output_grad_strides,
     input_grad_buffer_list,
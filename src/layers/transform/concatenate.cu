@@ -32,7 +32,7 @@ namespace lbann {
 
 namespace {
 
-using dim4 = cuda::array<size_t, 4>;
+using dim5 = cuda::array<size_t, 5>;
 
 /**
  *  Block dimensions: bsize x 1 x 1
@@ -40,13 +40,13 @@ using dim4 = cuda::array<size_t, 4>;
  *  Grid dimensions: (max_input_size / bsize) x num_inputs x 1
  */
 template <typename T>
-__global__ void concat4d_kernel(
+__global__ void concat5d_kernel(
   size_t num_inputs,
   const T* __restrict__ * __restrict__ input_buffer_list,
-  const dim4* __restrict__ input_dims_list,
-  const dim4* __restrict__ input_strides_list,
+  const dim5* __restrict__ input_dims_list,
+  const dim5* __restrict__ input_strides_list,
   T* __restrict__ output_buffer,
-  dim4 output_strides,
+  dim5 output_strides,
   const size_t* __restrict__ output_offset_list) {
 
   // Indices
@@ -63,15 +63,16 @@ __global__ void concat4d_kernel(
     const auto& input_strides = input_strides_list[j];
     const auto& output_offset = output_offset_list[j];
     const auto& input_size = (input_dims[0] * input_dims[1]
-                              * input_dims[2] * input_dims[3]);
+                              * input_dims[2] * input_dims[3]
+                              * input_dims[4]);
 
     for (size_t i=gidx; i<input_size; i+=nthreadsx) {
 
       // Get position in input tensor
-      dim4 pos;
+      dim5 pos;
       size_t pos_flat = i;
       #pragma unroll
-      for (int d=3; d>=0; --d) {
+      for (int d=4; d>=0; --d) {
         pos[d] = pos_flat % input_dims[d];
         pos_flat = pos_flat / input_dims[d];
       }
@@ -80,12 +81,14 @@ __global__ void concat4d_kernel(
       const auto& x = input_buffer[pos[0] * input_strides[0]
                                    + pos[1] * input_strides[1]
                                    + pos[2] * input_strides[2]
-                                   + pos[3] * input_strides[3]];
+                                   + pos[3] * input_strides[3]
+                                   + pos[4] * input_strides[4]];
       auto& y = output_buffer[output_offset
                               + pos[0] * output_strides[0]
                               + pos[1] * output_strides[1]
                               + pos[2] * output_strides[2]
-                              + pos[3] * output_strides[3]];
+                              + pos[3] * output_strides[3]
+                              + pos[4] * output_strides[4]];
       y = x;
 
     }
@@ -100,14 +103,14 @@ __global__ void concat4d_kernel(
  *  Grid dimensions: (max_input_size / bsize) x num_inputs x 1
  */
 template <typename T>
-__global__ void slice4d_kernel(
+__global__ void slice5d_kernel(
   size_t num_outputs,
   const T* __restrict__ input_buffer,
-  dim4 input_strides,
+  dim5 input_strides,
   const size_t* __restrict__ input_offset_list,
   T* __restrict__ * __restrict__ output_buffer_list,
-  const dim4* __restrict__ output_dims_list,
-  const dim4* __restrict__ output_strides_list) {
+  const dim5* __restrict__ output_dims_list,
+  const dim5* __restrict__ output_strides_list) {
 
   // Indices
   const size_t gidx = threadIdx.x + blockIdx.x * blockDim.x;
@@ -123,15 +126,16 @@ __global__ void slice4d_kernel(
     const auto& output_dims = output_dims_list[j];
     const auto& output_strides = output_strides_list[j];
     const auto& output_size = (output_dims[0] * output_dims[1]
-                              * output_dims[2] * output_dims[3]);
+                              * output_dims[2] * output_dims[3]
+                              * output_dims[4]);
 
     for (size_t i=gidx; i<output_size; i+=nthreadsx) {
 
       // Get position in output tensor
-      dim4 pos;
+      dim5 pos;
       size_t pos_flat = i;
       #pragma unroll
-      for (int d=3; d>=0; --d) {
+      for (int d=4; d>=0; --d) {
         pos[d] = pos_flat % output_dims[d];
         pos_flat = pos_flat / output_dims[d];
       }
@@ -141,11 +145,13 @@ __global__ void slice4d_kernel(
                                    + pos[0] * input_strides[0]
                                    + pos[1] * input_strides[1]
                                    + pos[2] * input_strides[2]
-                                   + pos[3] * input_strides[3]];
+                                   + pos[3] * input_strides[3]
+                                   + pos[4] * input_strides[4]];
       auto& y = output_buffer[pos[0] * output_strides[0]
                               + pos[1] * output_strides[1]
                               + pos[2] * output_strides[2]
-                              + pos[3] * output_strides[3]];
+                              + pos[3] * output_strides[3]
+                              + pos[4] * output_strides[4]];
       y = x;
 
     }
@@ -193,45 +199,49 @@ void fp_compute_impl(
   // Check that number of dimensions is valid
   /// @todo Support tensors with arbitrary number of dimensions
   const size_t num_dims = l.get_output_dims().size();
-  if (num_dims > 3) {
+  if (num_dims > 4) {
     LBANN_ERROR(l.get_type()," layer \"",l.get_name(),"\" ",
                 "is operating on ",num_dims,"-D tensors, ",
-                "but only 3-D tensors are currently supported");
+                "but only tensors with up to 4 dimensions are currently supported");
   }
 
   // Get dimensions and strides for each input tensor
   const size_t num_inputs = l.get_num_parents();
   std::vector<const TensorDataType*> input_buffer_list;
-  std::vector<dim4> input_dims_list, input_strides_list;
+  std::vector<dim5> input_dims_list, input_strides_list;
   size_t max_input_size = 0;
   for (size_t j=0; j<num_inputs; ++j) {
     const auto& input = l.get_prev_activations(j);
     const auto& input_dims = l.get_input_dims(j);
+    const auto concat_dims = l.get_concat_input_dims(j);
 
     // Construct dimensions and strides in reverse order
-    // Note: Assume each mini-batch sample is fully packed.
-    std::vector<size_t> rdims(input_dims.rbegin(), input_dims.rend());
+    // Note: Assume each mini-batch sample is fully packed. Cropped
+    // inputs are read at the strides of the full tensor.
+    std::vector<size_t> rdims(concat_dims.rbegin(), concat_dims.rend());
+    std::vector<size_t> rfull_dims(input_dims.rbegin(), input_dims.rend());
     std::vector<size_t> rstrides(input_dims.size(), 1);
     for (size_t d=1; d<input_dims.size(); ++d) {
-      rstrides[d] = rdims[d-1] * rstrides[d-1];
+      rstrides[d] = rfull_dims[d-1] * rstrides[d-1];
     }
     rdims.push_back(input.LocalWidth());
     rstrides.push_back(input.LDim());
 
-    // Pad tensor dimensions to 4D
-    rdims.resize(4, 1);
-    rstrides.resize(4, rstrides.back());
+    // Pad tensor dimensions to 5D
+    rdims.resize(5, 1);
+    rstrides.resize(5, rstrides.back());
 
-    input_buffer_list.push_back(input.LockedBuffer());
-    input_dims_list.push_back({rdims[3], rdims[2], rdims[1], rdims[0]});
+    input_buffer_list.push_back(input.LockedBuffer()
+                                + l.get_input_crop_offset(j));
+    input_dims_list.push_back({rdims[4], rdims[3], rdims[2], rdims[1], rdims[0]});
     input_strides_list.push_back(
-      {rstrides[3], rstrides[2], rstrides[1], rstrides[0]});
+      {rstrides[4], rstrides[3], rstrides[2], rstrides[1], rstrides[0]});
     max_input_size = std::max(max_input_size,
-                              rdims[3]*rdims[2]*rdims[1]*rdims[0]);
+                              rdims[4]*rdims[3]*rdims[2]*rdims[1]*rdims[0]);
   }
 
   // Get strides for output tensor
-  dim4 output_strides;
+  dim5 output_strides;
   auto& output = l.get_activations();
   {
     const auto& output_dims = l.get_output_dims();
@@ -246,15 +256,15 @@ void fp_compute_impl(
     rdims.push_back(output.LocalWidth());
     rstrides.push_back(output.LDim());
 
-    // Pad tensor dimensions to 4D
-    rdims.resize(4, 1);
-    rstrides.resize(4, rstrides.back());
+    // Pad tensor dimensions to 5D
+    rdims.resize(5, 1);
+    rstrides.resize(5, rstrides.back());
 
-    output_strides = {rstrides[3], rstrides[2], rstrides[1], rstrides[0]};
+    output_strides = {rstrides[4], rstrides[3], rstrides[2], rstrides[1], rstrides[0]};
   }
 
   // Compute each input tensor's offset in output tensor
-  concat_dim += 4 - num_dims;   // Tensor has been padded to 4-D
+  concat_dim += 5 - num_dims;   // Tensor has been padded to 5-D
   std::vector<size_t> output_offset_list;
   output_offset_list.push_back(0);
   for (const auto& input_dims : input_dims_list) {
@@ -267,19 +277,19 @@ void fp_compute_impl(
   l.m_workspace_event.synchronize();
   l.m_workspace.resize(
     sizeof(TensorDataType*) * input_buffer_list.size()
-    + sizeof(dim4) * input_dims_list.size()
-    + sizeof(dim4) * input_strides_list.size()
+    + sizeof(dim5) * input_dims_list.size()
+    + sizeof(dim5) * input_strides_list.size()
     + sizeof(size_t) * output_offset_list.size());
   size_t pos = 0;
   std::memcpy(&l.m_workspace[pos], input_buffer_list.data(),
               sizeof(TensorDataType*) * input_buffer_list.size());
   pos += sizeof(TensorDataType*) * input_buffer_list.size();
   std::memcpy(&l.m_workspace[pos], input_dims_list.data(),
-              sizeof(dim4) * input_dims_list.size());
-  pos += sizeof(dim4) * input_dims_list.size();
+              sizeof(dim5) * input_dims_list.size());
+  pos += sizeof(dim5) * input_dims_list.size();
   std::memcpy(&l.m_workspace[pos], input_strides_list.data(),
-              sizeof(dim4) * input_strides_list.size());
-  pos += sizeof(dim4) * input_strides_list.size();
+              sizeof(dim5) * input_strides_list.size());
+  pos += sizeof(dim5) * input_strides_list.size();
   std::memcpy(&l.m_workspace[pos], output_offset_list.data(),
               sizeof(size_t) * output_offset_list.size());
   pos += sizeof(size_t) * output_offset_list.size();
@@ -299,11 +309,11 @@ void fp_compute_impl(
     = reinterpret_cast<const TensorDataType**>(device_workspace_ptr+pos);
   pos += sizeof(TensorDataType*) * input_buffer_list.size();
   auto&& device_input_dims_list
-    = reinterpret_cast<const dim4*>(device_workspace_ptr+pos);
-  pos += sizeof(dim4) * input_dims_list.size();
+    = reinterpret_cast<const dim5*>(device_workspace_ptr+pos);
+  pos += sizeof(dim5) * input_dims_list.size();
   auto&& device_input_strides_list
-    = reinterpret_cast<const dim4*>(device_workspace_ptr+pos);
-  pos += sizeof(dim4) * input_strides_list.size();
+    = reinterpret_cast<const dim5*>(device_workspace_ptr+pos);
+  pos += sizeof(dim5) * input_strides_list.size();
   auto&& device_output_offset_list
     = reinterpret_cast<const size_t*>(device_workspace_ptr+pos);
   pos += sizeof(size_t) * output_offset_list.size();
@@ -315,7 +325,7 @@ void fp_compute_impl(
     block_dims.x = block_size;
     grid_dims.x = (max_input_size + block_size - 1) / block_size;
     grid_dims.y = num_inputs;
-    concat4d_kernel<<<grid_dims, block_dims, 0, stream>>>(
+    concat5d_kernel<<<grid_dims, block_dims, 0, stream>>>(
       num_inputs,
       device_input_buffer_list,
       device_input_dims_list,
@@ -335,45 +345,49 @@ void bp_compute_impl(
   // Check that number of dimensions is valid
   /// @todo Support tensors with arbitrary number of dimensions
   const size_t num_dims = l.get_output_dims().size();
-  if (num_dims > 3) {
+  if (num_dims > 4) {
     LBANN_ERROR(l.get_type()," layer \"",l.get_name(),"\" ",
                 "is operating on ",num_dims,"-D tensors, ",
-                "but only 3-D tensors are currently supported");
+                "but only tensors with up to 4 dimensions are currently supported");
   }
 
   // Get dimensions and strides for each input gradient tensor
   const size_t num_inputs = l.get_num_parents();
   std::vector<TensorDataType*> input_grad_buffer_list;
-  std::vector<dim4> input_grad_dims_list, input_grad_strides_list;
+  std::vector<dim5> input_grad_dims_list, input_grad_strides_list;
   size_t max_input_grad_size = 0;
   for (size_t j=0; j<num_inputs; ++j) {
     auto& input_grad = l.get_error_signals(j);
     const auto& input_grad_dims = l.get_input_dims(j);
+    const auto concat_dims = l.get_concat_input_dims(j);
 
     // Construct dimensions and strides in reverse order
-    // Note: Assume each mini-batch sample is fully packed.
-    std::vector<size_t> rdims(input_grad_dims.rbegin(), input_grad_dims.rend());
+    // Note: Assume each mini-batch sample is fully packed. Cropped
+    // inputs are written at the strides of the full tensor.
+    std::vector<size_t> rdims(concat_dims.rbegin(), concat_dims.rend());
+    std::vector<size_t> rfull_dims(input_grad_dims.rbegin(), input_grad_dims.rend());
     std::vector<size_t> rstrides(input_grad_dims.size(), 1);
     for (size_t d=1; d<input_grad_dims.size(); ++d) {
-      rstrides[d] = rdims[d-1] * rstrides[d-1];
+      rstrides[d] = rfull_dims[d-1] * rstrides[d-1];
     }
     rdims.push_back(input_grad.LocalWidth());
     rstrides.push_back(input_grad.LDim());
 
-    // Pad tensor dimensions to 4D
-    rdims.resize(4, 1);
-    rstrides.resize(4, rstrides.back());
+    // Pad tensor dimensions to 5D
+    rdims.resize(5, 1);
+    rstrides.resize(5, rstrides.back());
 
-    input_grad_buffer_list.push_back(input_grad.Buffer());
-    input_grad_dims_list.push_back({rdims[3], rdims[2], rdims[1], rdims[0]});
+    input_grad_buffer_list.push_back(input_grad.Buffer()
+                                     + l.get_input_crop_offset(j));
+    input_grad_dims_list.push_back({rdims[4], rdims[3], rdims[2], rdims[1], rdims[0]});
     input_grad_strides_list.push_back(
-      {rstrides[3], rstrides[2], rstrides[1], rstrides[0]});
+      {rstrides[4], rstrides[3], rstrides[2], rstrides[1], rstrides[0]});
     max_input_grad_size = std::max(max_input_grad_size,
-                                   rdims[3]*rdims[2]*rdims[1]*rdims[0]);
+                                   rdims[4]*rdims[3]*rdims[2]*rdims[1]*rdims[0]);
   }
 
   // Get strides for output gradient tensor
-  dim4 output_grad_strides;
+  dim5 output_grad_strides;
   const auto& output_grad = l.get_prev_error_signals();
   {
     const auto& output_grad_dims = l.get_output_dims();
@@ -388,15 +402,15 @@ void bp_compute_impl(
     rdims.push_back(output_grad.LocalWidth());
     rstrides.push_back(output_grad.LDim());
 
-    // Pad tensor dimensions to 4D
-    rdims.resize(4, 1);
-    rstrides.resize(4, rstrides.back());
+    // Pad tensor dimensions to 5D
+    rdims.resize(5, 1);
+    rstrides.resize(5, rstrides.back());
 
-    output_grad_strides = {rstrides[3], rstrides[2], rstrides[1], rstrides[0]};
+    output_grad_strides = {rstrides[4], rstrides[3], rstrides[2], rstrides[1], rstrides[0]};
   }
 
   // Compute each input gradient tensor's offset in output gradient tensor
-  concat_dim += 4 - num_dims;   // Tensor has been padded to 4-D
+  concat_dim += 5 - num_dims;   // Tensor has been padded to 5-D
   std::vector<size_t> output_grad_offset_list;
   output_grad_offset_list.push_back(0);
   for (const auto& input_grad_dims : input_grad_dims_list) {
@@ -410,8 +424,8 @@ void bp_compute_impl(
   l.m_workspace.resize(
     sizeof(size_t) * output_grad_offset_list.size()
     + sizeof(TensorDataType*) * input_grad_buffer_list.size()
-    + sizeof(dim4) * input_grad_dims_list.size()
-    + sizeof(dim4) * input_grad_strides_list.size());
+    + sizeof(dim5) * input_grad_dims_list.size()
+    + sizeof(dim5) * input_grad_strides_list.size());
   size_t pos = 0;
   std::memcpy(&l.m_workspace[pos], output_grad_offset_list.data(),
               sizeof(size_t) * output_grad_offset_list.size());
@@ -420,11 +434,11 @@ void bp_compute_impl(
               sizeof(TensorDataType*) * input_grad_buffer_list.size());
   pos += sizeof(TensorDataType*) * input_grad_buffer_list.size();
   std::memcpy(&l.m_workspace[pos], input_grad_dims_list.data(),
-              sizeof(dim4) * input_grad_dims_list.size());
-  pos += sizeof(dim4) * input_grad_dims_list.size();
+              sizeof(dim5) * input_grad_dims_list.size());
+  pos += sizeof(dim5) * input_grad_dims_list.size();
   std::memcpy(&l.m_workspace[pos], input_grad_strides_list.data(),
-              sizeof(dim4) * input_grad_strides_list.size());
-  pos += sizeof(dim4) * input_grad_strides_list.size();
+              sizeof(dim5) * input_grad_strides_list.size());
+  pos += sizeof(dim5) * input_grad_strides_list.size();
 
   // Copy tensor data to GPU
   auto&& stream = El::GPUManager::Stream();
@@ -444,11 +458,11 @@ void bp_compute_impl(
     = reinterpret_cast<TensorDataType**>(device_workspace_ptr+pos);
   pos += sizeof(TensorDataType*) * input_grad_buffer_list.size();
   auto&& device_input_grad_dims_list
-    = reinterpret_cast<const dim4*>(device_workspace_ptr+pos);
-  pos += sizeof(dim4) * input_grad_dims_list.size();
+    = reinterpret_cast<const dim5*>(device_workspace_ptr+pos);
+  pos += sizeof(dim5) * input_grad_dims_list.size();
   auto&& device_input_grad_strides_list
-    = reinterpret_cast<const dim4*>(device_workspace_ptr+pos);
-  pos += sizeof(dim4) * input_grad_strides_list.size();
+    = reinterpret_cast<const dim5*>(device_workspace_ptr+pos);
+  pos += sizeof(dim5) * input_grad_strides_list.size();
 
   // Launch CUDA kernel
   if (max_input_grad_size > 0) {
@@ -457,7 +471,7 @@ void bp_compute_impl(
     block_dims.x = block_size;
     grid_dims.x = (max_input_grad_size + block_size - 1) / block_size;
     grid_dims.y = num_inputs;
-    slice4d_kernel<<<grid_dims, block_dims, 0, stream>>>(
+    slice5d_kernel<<<grid_dims, block_dims, 0, stream>>>(
       num_inputs,
       output_grad.LockedBuffer(),
       output_grad_strides,
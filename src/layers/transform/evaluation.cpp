@@ -37,12 +37,12 @@ namespace lbann {
 
 namespace {
 
-/** CPU implementation of evaluation layer forward prop. */
+/** CPU implementation of evaluation layer forward prop.
+ *  Computes the local contribution to the value.
+ */
 template <typename TensorDataType>
-void fp_cpu(lbann_comm& comm,
-            const El::AbstractDistMatrix<TensorDataType>& input,
-            TensorDataType& value,
-            Al::request& req) {
+void fp_cpu(const El::AbstractDistMatrix<TensorDataType>& input,
+            TensorDataType& value) {
   const auto& local_input = input.LockedMatrix();
   const auto& local_height = local_input.Height();
   const auto& local_width = local_input.Width();
@@ -55,34 +55,34 @@ void fp_cpu(lbann_comm& comm,
     }
   }
   value = value / mini_batch_size;
-  comm.nb_allreduce(&value, 1, input.DistComm(), req);
 }
 
 #ifdef LBANN_HAS_HALF
-void fp_cpu(lbann_comm& comm,
-            const El::AbstractDistMatrix<cpu_fp16>& input,
-            cpu_fp16& value,
-            Al::request& req) {
+void fp_cpu(const El::AbstractDistMatrix<cpu_fp16>& input,
+            cpu_fp16& value) {
     LBANN_ERROR("This function is not supported in FP16 on CPUs");
 }
 #endif // LBANN_HAS_HALF
 
 #ifdef LBANN_HAS_GPU_FP16
-void fp_cpu(lbann_comm& comm,
-            const El::AbstractDistMatrix<fp16>& input,
-            fp16& value,
-            Al::request& req) {
+void fp_cpu(const El::AbstractDistMatrix<fp16>& input,
+            fp16& value) {
     LBANN_ERROR("This function is not supported in FP16 on CPUs");
 }
 #endif // LBANN_HAS_GPU_HALF
 
 #ifdef LBANN_HAS_GPU
-/** GPU implementation of evaluation layer forward prop. */
+/** GPU implementation of evaluation layer forward prop.
+ *  Computes the local contribution to the value. It is copied to the
+ *  host asynchronously if @c copy_to_host is set, and its sum over
+ *  the mini-batch is added to @c accumulated if it is not null.
+ */
 template <typename TensorDataType>
-void fp_gpu(lbann_comm& comm,
-            const El::AbstractDistMatrix<TensorDataType>& input,
+void fp_gpu(const El::AbstractDistMatrix<TensorDataType>& input,
             TensorDataType& value,
-            cuda::event_wrapper& copy_event) {
+            cuda::event_wrapper& copy_event,
+            bool copy_to_host,
+            El::Matrix<TensorDataType, El::Device::GPU>* accumulated) {
   const TensorDataType zero = El::TypeTraits<TensorDataType>::Zero();
   const TensorDataType one = El::TypeTraits<TensorDataType>::One();
 
@@ -143,9 +143,13 @@ void fp_gpu(lbann_comm& comm,
   }
   CHECK_CUBLAS(cublasSetPointerMode(handle, CUBLAS_POINTER_MODE_HOST));
 
+  if (accumulated != nullptr) {
+    El::Axpy(one, sum_d, *accumulated);
+  }
+  if (!copy_to_host) { return; }
+
   // Compute average value across mini-batch
   El::Scale(one / El::To<TensorDataType>(mini_batch_size), sum_d);
-  comm.allreduce(static_cast<El::AbstractMatrix<TensorDataType>&>(sum_d), input.DistComm());
   CHECK_CUDA(cudaMemcpyAsync(&value,
                              sum_d.LockedBuffer(),
                              sizeof(TensorDataType),
@@ -156,10 +160,11 @@ void fp_gpu(lbann_comm& comm,
 }
 
 #ifdef LBANN_HAS_GPU_FP16
-void fp_gpu(lbann_comm& comm,
-            const El::AbstractDistMatrix<cpu_fp16>& input,
+void fp_gpu(const El::AbstractDistMatrix<cpu_fp16>& input,
             cpu_fp16& value,
-            cuda::event_wrapper& copy_event) {
+            cuda::event_wrapper& copy_event,
+            bool copy_to_host,
+            El::Matrix<cpu_fp16, El::Device::GPU>* accumulated) {
   LBANN_ERROR("This function is not supported with "
               "the CPU FP16 type on GPUs. "
               "A severe logic error has occured; please "
@@ -173,15 +178,86 @@ void fp_gpu(lbann_comm& comm,
 
 template <typename TensorDataType>
 EvalType abstract_evaluation_layer<TensorDataType>::get_value(bool scaled) {
-  switch (this->get_device_allocation()) {
-  case El::Device::CPU: this->get_comm()->wait(m_allreduce_req); break;
+  if (is_partial() && this->m_model != nullptr) {
+    this->m_model->reduce_evaluation_values();
+  }
+  if (is_partial()) {
+    // Not reduced with the model, e.g. since the layer is not part
+    // of one
+    set_reduced_value(this->get_comm()->allreduce(get_local_value(),
+                                                  get_reduction_comm()));
+  }
+  if (scaled) { return m_scale * m_reduced_value; }
+  else        { return m_reduced_value; }
+}
+
+template <typename TensorDataType>
+bool abstract_evaluation_layer<TensorDataType>::enable_accumulation() {
+  if (sizeof(TensorDataType) < sizeof(float)) { return false; }
+  if (!m_accumulate) {
+    m_accumulate = true;
+    m_accumulate_only = !m_read_every_step;
 #ifdef LBANN_HAS_GPU
-  case El::Device::GPU: this->m_copy_event.synchronize(); break;
+    // Allocate up front since forward prop may be captured in a CUDA
+    // graph
+    if (this->get_device_allocation() == El::Device::GPU) {
+      for (const auto& mode : {execution_mode::training,
+                               execution_mode::validation,
+                               execution_mode::testing}) {
+        auto& accumulated = m_accumulated_gpu[mode];
+        El::Zeros(accumulated, 1, 1);
+      }
+    }
 #endif // LBANN_HAS_GPU
-  default: LBANN_ERROR("invalid device");
   }
-  if (scaled) { return m_scale * El::To<EvalType>(m_value(0,0)); }
-  else        { return m_value(0,0); }
+  return true;
+}
+
+template <typename TensorDataType>
+void abstract_evaluation_layer<TensorDataType>::set_value_read_every_step() {
+  m_read_every_step = true;
+  m_accumulate_only = false;
+}
+
+template <typename TensorDataType>
+EvalType abstract_evaluation_layer<TensorDataType>::take_accumulated_value(execution_mode mode) {
+  if (!m_accumulate) {
+    LBANN_ERROR(this->get_type(), " layer \"", this->get_name(), "\" ",
+                "does not accumulate its values");
+  }
+  EvalType local_value = m_accumulated[mode];
+  m_accumulated[mode] = EvalType(0);
+#ifdef LBANN_HAS_GPU
+  auto it = m_accumulated_gpu.find(mode);
+  if (it != m_accumulated_gpu.end()) {
+    El::Matrix<TensorDataType, El::Device::CPU> accumulated;
+    El::Copy(it->second, accumulated);
+    El::Zero(it->second);
+    local_value += El::To<EvalType>(accumulated(0,0));
+  }
+#endif // LBANN_HAS_GPU
+  return this->get_comm()->allreduce(local_value, get_reduction_comm());
+}
+
+template <typename TensorDataType>
+bool abstract_evaluation_layer<TensorDataType>::has_async_local_value() const {
+  return this->get_device_allocation() == El::Device::GPU;
+}
+
+template <typename TensorDataType>
+EvalType abstract_evaluation_layer<TensorDataType>::get_local_value() {
+#ifdef LBANN_HAS_GPU
+  if (this->get_device_allocation() == El::Device::GPU) {
+    m_copy_event.synchronize();
+  }
+#endif // LBANN_HAS_GPU
+  return El::To<EvalType>(m_value.LockedMatrix()(0,0));
+}
+
+template <typename TensorDataType>
+const El::mpi::Comm&
+abstract_evaluation_layer<TensorDataType>::get_reduction_comm() const {
+  return this->get_prev_activations().DistComm();
 }
 
 template <typename TensorDataType>
@@ -210,31 +286,38 @@ void abstract_evaluation_layer<TensorDataType>::setup_dims(DataReaderMetaData& d
 template <typename TensorDataType>
 void abstract_evaluation_layer<TensorDataType>::setup_data(size_t max_mini_batch_size) {
   transform_layer<TensorDataType>::setup_data(max_mini_batch_size);
-#ifdef LBANN_HAS_GPU
-  m_value.SetMemoryMode(1); // Use pinned memory on host
-#endif // LBANN_HAS_GPU
-  El::Zeros(m_value, 1, 1);
+  m_value.Resize(1, 1);
+  El::Zero(m_value.Matrix());
 }
 
 template <typename TensorDataType>
 void abstract_evaluation_layer<TensorDataType>::fp_compute() {
   switch (this->get_device_allocation()) {
   case El::Device::CPU:
-    fp_cpu(*this->get_comm(),
-           this->get_prev_activations(),
-           m_value(0, 0),
-           m_allreduce_req);
+    fp_cpu(this->get_prev_activations(), m_value.Matrix()(0, 0));
+    if (m_accumulate) {
+      const auto& mode = this->m_model->get_execution_context().get_execution_mode();
+      m_accumulated[mode] += (El::To<EvalType>(m_value.LockedMatrix()(0, 0))
+                              * this->get_prev_activations().Width());
+    }
     break;
 #ifdef LBANN_HAS_GPU
   case El::Device::GPU:
-    fp_gpu(*this->get_comm(),
-           this->get_prev_activations(),
-           m_value(0, 0),
-           m_copy_event);
+    {
+      El::Matrix<TensorDataType, El::Device::GPU>* accumulated = nullptr;
+      if (m_accumulate) {
+        const auto& mode = this->m_model->get_execution_context().get_execution_mode();
+        accumulated = &m_accumulated_gpu[mode];
+        if (accumulated->Height() != 1) { El::Zeros(*accumulated, 1, 1); }
+      }
+      fp_gpu(this->get_prev_activations(), m_value.Matrix()(0, 0), m_copy_event,
+             !m_accumulate_only, accumulated);
+    }
     break;
 #endif // LBANN_HAS_GPU
   default: LBANN_ERROR("invalid device");
   }
+  mark_partial();
 }
 
 template <typename TensorDataType>
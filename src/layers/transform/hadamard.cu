@@ -0,0 +1,230 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#define LBANN_HADAMARD_LAYER_INSTANTIATE
+#include "lbann/layers/transform/hadamard.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <algorithm>
+
+namespace lbann {
+
+namespace {
+
+/** Maximum number of tensors passed to a kernel in one launch. */
+constexpr int max_num_tensors = 16;
+
+/** Block size for the entry-wise kernels. */
+constexpr size_t block_size = 256;
+
+template <typename T>
+using const_ptr_list = cuda::array<const T*, max_num_tensors>;
+template <typename T>
+using ptr_list = cuda::array<T*, max_num_tensors>;
+using ldim_list = cuda::array<El::Int, max_num_tensors>;
+
+/** Multiply up to @c max_num_tensors inputs entry-wise.
+ *
+ *  If @c accumulate is set, the product is multiplied into the
+ *  output instead of overwriting it.
+ *
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: (height*width / bsize) x 1 x 1
+ */
+template <typename T>
+__global__ void fp_kernel(El::Int height,
+                          El::Int width,
+                          int num_inputs,
+                          const_ptr_list<T> inputs,
+                          ldim_list input_ldims,
+                          bool accumulate,
+                          T* __restrict__ output,
+                          El::Int output_ldim) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int nthreads = blockDim.x * gridDim.x;
+  const El::Int size = height * width;
+  for (El::Int pos = gid; pos < size; pos += nthreads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    auto& y = output[row + col * output_ldim];
+    T prod = accumulate ? y : T(1.f);
+    for (int j = 0; j < num_inputs; ++j) {
+      prod *= inputs[j][row + col * input_ldims[j]];
+    }
+    y = prod;
+  }
+}
+
+/** Compute gradients w.r.t. all inputs in one pass.
+ *
+ *  The gradient w.r.t. input i is the output gradient times the
+ *  product of all other inputs. It is built from prefix and suffix
+ *  products, so no division is needed and zeros are handled exactly.
+ *
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: (height*width / bsize) x 1 x 1
+ */
+template <typename T>
+__global__ void bp_kernel(El::Int height,
+                          El::Int width,
+                          int num_inputs,
+                          const_ptr_list<T> inputs,
+                          ldim_list input_ldims,
+                          const T* __restrict__ gradient_wrt_output,
+                          El::Int gradient_wrt_output_ldim,
+                          ptr_list<T> gradient_wrt_inputs,
+                          ldim_list gradient_wrt_input_ldims) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int nthreads = blockDim.x * gridDim.x;
+  const El::Int size = height * width;
+  for (El::Int pos = gid; pos < size; pos += nthreads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    T suffix_prods[max_num_tensors];
+    T suffix(1.f);
+    for (int j = num_inputs-1; j >= 0; --j) {
+      suffix_prods[j] = suffix;
+      suffix *= inputs[j][row + col * input_ldims[j]];
+    }
+    T prefix = gradient_wrt_output[row + col * gradient_wrt_output_ldim];
+    for (int j = 0; j < num_inputs; ++j) {
+      gradient_wrt_inputs[j][row + col * gradient_wrt_input_ldims[j]]
+        = prefix * suffix_prods[j];
+      prefix *= inputs[j][row + col * input_ldims[j]];
+    }
+  }
+}
+
+/** Grid size for an entry-wise kernel over a local matrix. */
+El::Int get_grid_size(El::Int height, El::Int width) {
+  const El::Int size = height * width;
+  return std::min((size + El::Int(block_size) - 1) / El::Int(block_size),
+                  El::Int(65535));
+}
+
+} // namespace <anon>
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void hadamard_layer<TensorDataType, Layout, Device>::fp_compute() {
+  const int num_parents = this->get_num_parents();
+  auto& output = this->get_activations();
+  switch (num_parents) {
+  case 0: El::Fill(output, El::TypeTraits<TensorDataType>::One()); return;
+  case 1: El::LockedView(output, this->get_prev_activations()); return;
+  default: break;
+  }
+
+  // Multiply inputs in batches of at most max_num_tensors
+  auto& local_output = output.Matrix();
+  const El::Int local_height = local_output.Height();
+  const El::Int local_width = local_output.Width();
+  if (local_height < 1 || local_width < 1) { return; }
+  const auto grid_size = get_grid_size(local_height, local_width);
+  auto&& stream = El::GPUManager::Stream();
+  for (int begin = 0; begin < num_parents; begin += max_num_tensors) {
+    const int end = std::min(begin + max_num_tensors, num_parents);
+    const_ptr_list<TensorDataType> inputs;
+    ldim_list input_ldims;
+    for (int j = begin; j < end; ++j) {
+      const auto& local_input = this->get_local_prev_activations(j);
+      inputs[j-begin] = local_input.LockedBuffer();
+      input_ldims[j-begin] = local_input.LDim();
+    }
+    fp_kernel<<<grid_size, block_size, 0, stream>>>(
+      local_height, local_width,
+      end - begin, inputs, input_ldims,
+      begin > 0,
+      local_output.Buffer(), local_output.LDim());
+    CHECK_CUDA(cudaGetLastError());
+  }
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void hadamard_layer<TensorDataType, Layout, Device>::bp_compute() {
+  const int num_parents = this->get_num_parents();
+  const auto& gradient_wrt_output = this->get_prev_error_signals();
+  switch (num_parents) {
+  case 0: return;
+  case 1:
+    El::LockedView(this->get_error_signals(), gradient_wrt_output);
+    return;
+  default: break;
+  }
+
+  // Fall back to one product per input if there are too many inputs
+  // for a single kernel
+  if (num_parents > max_num_tensors) {
+    for (int i = 0; i < num_parents; ++i) {
+      auto& gradient_wrt_input = this->get_error_signals(i);
+      El::Copy(gradient_wrt_output, gradient_wrt_input);
+      for (int j = 0; j < num_parents; ++j) {
+        if (i != j) {
+          El::Hadamard(this->get_prev_activations(j),
+                       gradient_wrt_input,
+                       gradient_wrt_input);
+        }
+      }
+    }
+    return;
+  }
+
+  // Compute all gradients with one kernel
+  const auto& local_gradient_wrt_output = gradient_wrt_output.LockedMatrix();
+  const El::Int local_height = local_gradient_wrt_output.Height();
+  const El::Int local_width = local_gradient_wrt_output.Width();
+  if (local_height < 1 || local_width < 1) { return; }
+  const_ptr_list<TensorDataType> inputs;
+  ldim_list input_ldims;
+  ptr_list<TensorDataType> gradient_wrt_inputs;
+  ldim_list gradient_wrt_input_ldims;
+  for (int j = 0; j < num_parents; ++j) {
+    const auto& local_input = this->get_local_prev_activations(j);
+    auto& local_gradient_wrt_input = this->get_local_error_signals(j);
+    inputs[j] = local_input.LockedBuffer();
+    input_ldims[j] = local_input.LDim();
+    gradient_wrt_inputs[j] = local_gradient_wrt_input.Buffer();
+    gradient_wrt_input_ldims[j] = local_gradient_wrt_input.LDim();
+  }
+  bp_kernel<<<get_grid_size(local_height, local_width), block_size,
+              0, El::GPUManager::Stream()>>>(
+    local_height, local_width,
+    num_parents, inputs, input_ldims,
+    local_gradient_wrt_output.LockedBuffer(),
+    local_gradient_wrt_output.LDim(),
+    gradient_wrt_inputs, gradient_wrt_input_ldims);
+  CHECK_CUDA(cudaGetLastError());
+}
+
+#define PROTO(T)                                                        \
+  template class hadamard_layer<T, data_layout::DATA_PARALLEL, El::Device::GPU>; \
+  template class hadamard_layer<T, data_layout::MODEL_PARALLEL, El::Device::GPU>
+
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+}// namespace lbann
@@ -0,0 +1,166 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#define LBANN_REDUCTION_LAYER_INSTANTIATE
+#include "lbann/layers/transform/reduction.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <algorithm>
+
+namespace lbann {
+
+namespace {
+
+/** Sum each column of a matrix and scale the result.
+ *
+ *  Each column is reduced by one block, so the whole reduction is a
+ *  single launch.
+ *
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: width x 1 x 1
+ */
+template <size_t bsize, typename TensorDataType>
+__global__ void fp_kernel(El::Int height,
+                          El::Int width,
+                          TensorDataType scale,
+                          const TensorDataType* __restrict__ input,
+                          El::Int input_ldim,
+                          TensorDataType* __restrict__ output,
+                          El::Int output_ldim) {
+  const El::Int tid = threadIdx.x;
+  for (El::Int col = blockIdx.x; col < width; col += gridDim.x) {
+    TensorDataType sum(0.f);
+    for (El::Int row = tid; row < height; row += bsize) {
+      sum += input[row + col * input_ldim];
+    }
+    sum = cuda::block_reduce<bsize,1,1>(sum);
+    if (tid == 0) {
+      output[col * output_ldim] = scale * sum;
+    }
+    __syncthreads();
+  }
+}
+
+/** Broadcast the scaled output gradient over each column.
+ *
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: (height*width / bsize) x 1 x 1
+ */
+template <typename TensorDataType>
+__global__ void bp_kernel(El::Int height,
+                          El::Int width,
+                          TensorDataType scale,
+                          const TensorDataType* __restrict__ gradient_wrt_output,
+                          El::Int gradient_wrt_output_ldim,
+                          TensorDataType* __restrict__ gradient_wrt_input,
+                          El::Int gradient_wrt_input_ldim) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int nthreads = blockDim.x * gridDim.x;
+  const El::Int size = height * width;
+  for (El::Int pos = gid; pos < size; pos += nthreads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    gradient_wrt_input[row + col * gradient_wrt_input_ldim]
+      = scale * gradient_wrt_output[col * gradient_wrt_output_ldim];
+  }
+}
+
+} // namespace <anon>
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void reduction_layer<TensorDataType, Layout, Device>::fp_compute() {
+
+  // Local matrices
+  const auto& local_input = this->get_local_prev_activations();
+  auto& local_output = this->get_local_activations();
+  const El::Int local_height = local_input.Height();
+  const El::Int local_width = local_input.Width();
+  if (local_width < 1) { return; }
+
+  // Apply reduction
+  TensorDataType scale = El::TypeTraits<TensorDataType>::One();
+  switch (m_mode) {
+  case reduction_mode::SUM: break;
+  case reduction_mode::AVERAGE:
+    scale /= El::To<TensorDataType>(local_height);
+    break;
+  default:
+    LBANN_ERROR("invalid reduction mode");
+  }
+  constexpr size_t block_size = 256;
+  const El::Int grid_size = std::min(local_width, El::Int(65535));
+  fp_kernel<block_size>
+    <<<grid_size, block_size, 0, El::GPUManager::Stream()>>>(
+      local_height, local_width, scale,
+      local_input.LockedBuffer(), local_input.LDim(),
+      local_output.Buffer(), local_output.LDim());
+  CHECK_CUDA(cudaGetLastError());
+
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void reduction_layer<TensorDataType, Layout, Device>::bp_compute() {
+
+  // Local matrices
+  const auto& local_gradient_wrt_output = this->get_local_prev_error_signals();
+  auto& local_gradient_wrt_input = this->get_local_error_signals();
+  const El::Int local_height = local_gradient_wrt_input.Height();
+  const El::Int local_width = local_gradient_wrt_input.Width();
+  if (local_height < 1 || local_width < 1) { return; }
+
+  // Compute gradients w.r.t. inputs
+  TensorDataType scale = El::TypeTraits<TensorDataType>::One();
+  switch (m_mode) {
+  case reduction_mode::SUM: break;
+  case reduction_mode::AVERAGE:
+    scale /= El::To<TensorDataType>(local_height);
+    break;
+  default:
+    LBANN_ERROR("invalid reduction mode");
+  }
+  constexpr El::Int block_size = 256;
+  const El::Int grid_size
+    = std::min((local_height * local_width + block_size - 1) / block_size,
+               El::Int(65535));
+  bp_kernel<<<grid_size, block_size, 0, El::GPUManager::Stream()>>>(
+    local_height, local_width, scale,
+    local_gradient_wrt_output.LockedBuffer(),
+    local_gradient_wrt_output.LDim(),
+    local_gradient_wrt_input.Buffer(),
+    local_gradient_wrt_input.LDim());
+  CHECK_CUDA(cudaGetLastError());
+
+}
+
+#define PROTO(T) \
+  template class reduction_layer<T, data_layout::DATA_PARALLEL, El::Device::GPU>
+
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+}// namespace lbann
@@ -30,13 +30,61 @@
 #include "lbann/utils/exception.hpp"
 
 #include <thrust/system/cuda/execution_policy.h>
-#include <thrust/sequence.h>
 #include <thrust/sort.h>
-#include <thrust/scatter.h>
-#include <thrust/device_ptr.h>
+#include <thrust/iterator/zip_iterator.h>
+#include <thrust/tuple.h>
 
 namespace lbann {
 
+namespace {
+
+/** Pack matrix entries into contiguous arrays for sorting.
+ *  Each entry is tagged with its row and column indices.
+ */
+template <typename TensorDataType>
+__global__ void pack_kernel(El::Int height,
+                            El::Int width,
+                            const TensorDataType* __restrict__ input,
+                            El::Int input_ldim,
+                            TensorDataType* __restrict__ vals,
+                            El::Int* __restrict__ rows,
+                            El::Int* __restrict__ cols) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int num_threads = blockDim.x * gridDim.x;
+  const El::Int size = height * width;
+  for (El::Int i = gid; i < size; i += num_threads) {
+    const auto& row = i % height;
+    const auto& col = i / height;
+    vals[i] = input[row + col * input_ldim];
+    rows[i] = row;
+    cols[i] = col;
+  }
+}
+
+/** Scatter gradients based on sorted indices. */
+template <typename TensorDataType>
+__global__ void scatter_kernel(El::Int height,
+                               El::Int width,
+                               const El::Int* __restrict__ indices,
+                               El::Int indices_ldim,
+                               const TensorDataType* __restrict__ gradient_wrt_output,
+                               El::Int gradient_wrt_output_ldim,
+                               TensorDataType* __restrict__ gradient_wrt_input,
+                               El::Int gradient_wrt_input_ldim) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int num_threads = blockDim.x * gridDim.x;
+  const El::Int size = height * width;
+  for (El::Int i = gid; i < size; i += num_threads) {
+    const auto& row = i % height;
+    const auto& col = i / height;
+    const auto& ind = indices[row + col * indices_ldim];
+    gradient_wrt_input[ind + col * gradient_wrt_input_ldim]
+      = gradient_wrt_output[row + col * gradient_wrt_output_ldim];
+  }
+}
+
+} // namespace
+
 template <typename TensorDataType, data_layout T_layout, El::Device Dev>
 void sort_layer<TensorDataType, T_layout, Dev>::fp_compute() {
 
@@ -46,29 +94,60 @@ void sort_layer<TensorDataType, T_layout, Dev>::fp_compute() {
   auto& local_indices = *this->m_indices;
   const auto& local_height = local_input.Height();
   const auto& local_width = local_input.Width();
+  const auto& local_size = local_height * local_width;
+  if (local_size < 1) { return; }
 
   // GPU objects
   auto&& stream = El::GPUManager::Stream();
   cuda::thrust::allocator<> alloc(stream);
 
-  // Sort each matrix column
-  El::Copy(local_input, local_output);
-  for (El::Int col = 0; col < local_width; ++col) {
-    ::thrust::device_ptr<TensorDataType> vals(local_output.Buffer(0, col));
-    ::thrust::device_ptr<El::Int> inds(local_indices.Buffer(0, col));
-    ::thrust::sequence(thrust::cuda::par(alloc).on(stream),
-                       inds, inds + local_height);
-    if (this->m_descending) {
-      ::thrust::sort_by_key(thrust::cuda::par(alloc).on(stream),
-                            vals, vals + local_height, inds,
-                            ::thrust::greater<TensorDataType>());
-    } else {
-      ::thrust::sort_by_key(thrust::cuda::par(alloc).on(stream),
-                            vals, vals + local_height, inds,
-                            ::thrust::less<TensorDataType>());
-    }
+  // Pack all columns into one array
+  cuda::thrust::vector<TensorDataType> vals(local_size);
+  cuda::thrust::vector<El::Int> rows(local_size), cols(local_size);
+  {
+    const El::Int block_dim = 256;
+    const El::Int grid_dim = std::min((local_size + block_dim - 1) / block_dim,
+                                      El::Int(65535));
+    pack_kernel<<<grid_dim, block_dim, 0, stream>>>(
+      local_height, local_width,
+      local_input.LockedBuffer(), local_input.LDim(),
+      vals.data().get(), rows.data().get(), cols.data().get());
   }
 
+  // Sort every column at once: sort all entries by value, then
+  // stably by column to restore the column segments
+  auto&& policy = thrust::cuda::par(alloc).on(stream);
+  auto inds_and_cols = ::thrust::make_zip_iterator(
+    ::thrust::make_tuple(rows.begin(), cols.begin()));
+  if (this->m_descending) {
+    ::thrust::sort_by_key(policy, vals.begin(), vals.end(), inds_and_cols,
+                          ::thrust::greater<TensorDataType>());
+  } else {
+    ::thrust::sort_by_key(policy, vals.begin(), vals.end(), inds_and_cols,
+                          ::thrust::less<TensorDataType>());
+  }
+  ::thrust::stable_sort_by_key(
+    policy, cols.begin(), cols.end(),
+    ::thrust::make_zip_iterator(::thrust::make_tuple(vals.begin(), rows.begin())));
+
+  // Unpack into output and index matrices
+  CHECK_CUDA(cudaMemcpy2DAsync(local_output.Buffer(),
+                               local_output.LDim() * sizeof(TensorDataType),
+                               vals.data().get(),
+                               local_height * sizeof(TensorDataType),
+                               local_height * sizeof(TensorDataType),
+                               local_width,
+                               cudaMemcpyDeviceToDevice,
+                               stream));
+  CHECK_CUDA(cudaMemcpy2DAsync(local_indices.Buffer(),
+                               local_indices.LDim() * sizeof(El::Int),
+                               rows.data().get(),
+                               local_height * sizeof(El::Int),
+                               local_height * sizeof(El::Int),
+                               local_width,
+                               cudaMemcpyDeviceToDevice,
+                               stream));
+
 }
 
 template <typename TensorDataType, data_layout T_layout, El::Device Dev>
@@ -80,20 +159,19 @@ void sort_layer<TensorDataType, T_layout, Dev>::bp_compute() {
   const auto& local_indices = *this->m_indices;
   const auto& local_height = local_gradient_wrt_input.Height();
   const auto& local_width = local_gradient_wrt_input.Width();
-
-  // GPU objects
-  auto&& stream = El::GPUManager::Stream();
-  cuda::thrust::allocator<> alloc(stream);
+  const auto& local_size = local_height * local_width;
+  if (local_size < 1) { return; }
 
   // Scatter gradients based on sorted indices
-  for (El::Int col = 0; col < local_width; ++col) {
-    const ::thrust::device_ptr<const El::Int> inds(this->m_indices->LockedBuffer(0, col));
-    const ::thrust::device_ptr<const TensorDataType> grad_wrt_out(local_gradient_wrt_output.LockedBuffer(0, col));
-    ::thrust::device_ptr<TensorDataType> grad_wrt_in(local_gradient_wrt_input.Buffer(0, col));
-    ::thrust::scatter(thrust::cuda::par(alloc).on(stream),
-                      grad_wrt_out, grad_wrt_out + local_height, inds,
-                      grad_wrt_in);
-  }
+  auto&& stream = El::GPUManager::Stream();
+  const El::Int block_dim = 256;
+  const El::Int grid_dim = std::min((local_size + block_dim - 1) / block_dim,
+                                    El::Int(65535));
+  scatter_kernel<<<grid_dim, block_dim, 0, stream>>>(
+    local_height, local_width,
+    local_indices.LockedBuffer(), local_indices.LDim(),
+    local_gradient_wrt_output.LockedBuffer(), local_gradient_wrt_output.LDim(),
+    local_gradient_wrt_input.Buffer(), local_gradient_wrt_input.LDim());
 
 }
 
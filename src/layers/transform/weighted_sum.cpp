@@ -27,27 +27,33 @@
 #define LBANN_WEIGHTED_SUM_LAYER_INSTANTIATE
 #include "lbann/layers/transform/weighted_sum.hpp"
 
-#include <lbann/proto/proto_common.hpp>
-#include <lbann.pb.h>
-
 namespace lbann {
 
 template <typename TensorDataType, data_layout Layout, El::Device Device>
-std::unique_ptr<Layer> build_weighted_sum_layer_from_pbuf(
-  lbann_comm* comm, lbann_data::Layer const& proto_layer)
-{
-  using LayerType = weighted_sum_layer<TensorDataType, Layout, Device>;
-  LBANN_ASSERT_MSG_HAS_FIELD(proto_layer, weighted_sum);
-  const auto& params = proto_layer.weighted_sum();
-  const auto& scaling_factors = parse_list<DataType>(params.scaling_factors());
-  return lbann::make_unique<LayerType>(comm, scaling_factors);
+void weighted_sum_layer<TensorDataType, Layout, Device>::fp_compute() {
+  auto& output = this->get_activations();
+  El::Zero(output);
+  for (int i = 0; i < this->get_num_parents(); ++i) {
+    El::Axpy(m_scaling_factors[i], this->get_prev_activations(i), output);
+  }
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void weighted_sum_layer<TensorDataType, Layout, Device>::bp_compute() {
+  const auto& gradient_wrt_output = this->get_prev_error_signals();
+  for (int i = 0; i < this->get_num_parents(); ++i) {
+    auto& gradient_wrt_input = this->get_error_signals(i);
+    El::Zero(gradient_wrt_input);
+    El::Axpy(m_scaling_factors[i], gradient_wrt_output,
+             gradient_wrt_input);
+  }
 }
 
-#define PROTO_DEVICE(T, Device) \
-  template class weighted_sum_layer<T, data_layout::DATA_PARALLEL, Device>; \
-  template class weighted_sum_layer<T, data_layout::MODEL_PARALLEL, Device>; \
-  LBANN_LAYER_BUILDER_ETI(weighted_sum, T, Device)
+#define PROTO(T)                                                        \
+  template class weighted_sum_layer<T, data_layout::DATA_PARALLEL, El::Device::CPU>; \
+  template class weighted_sum_layer<T, data_layout::MODEL_PARALLEL, El::Device::CPU>
 
-#include "lbann/macros/instantiate_device.hpp"
+#define LBANN_INSTANTIATE_CPU_HALF
+#include "lbann/macros/instantiate.hpp"
 
 }// namespace lbann
@@ -0,0 +1,194 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#define LBANN_WEIGHTED_SUM_LAYER_INSTANTIATE
+#include "lbann/layers/transform/weighted_sum.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <algorithm>
+
+namespace lbann {
+
+namespace {
+
+/** Maximum number of tensors passed to a kernel in one launch. */
+constexpr int max_num_tensors = 16;
+
+/** Block size for the entry-wise kernels. */
+constexpr size_t block_size = 256;
+
+template <typename T>
+using const_ptr_list = cuda::array<const T*, max_num_tensors>;
+template <typename T>
+using ptr_list = cuda::array<T*, max_num_tensors>;
+template <typename T>
+using scale_list = cuda::array<T, max_num_tensors>;
+using ldim_list = cuda::array<El::Int, max_num_tensors>;
+
+/** Add up to @c max_num_tensors scaled inputs.
+ *
+ *  If @c accumulate is set, the sum is added to the output instead
+ *  of overwriting it.
+ *
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: (height*width / bsize) x 1 x 1
+ */
+template <typename T>
+__global__ void fp_kernel(El::Int height,
+                          El::Int width,
+                          int num_inputs,
+                          const_ptr_list<T> inputs,
+                          ldim_list input_ldims,
+                          scale_list<T> scales,
+                          bool accumulate,
+                          T* __restrict__ output,
+                          El::Int output_ldim) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int nthreads = blockDim.x * gridDim.x;
+  const El::Int size = height * width;
+  for (El::Int pos = gid; pos < size; pos += nthreads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    auto& y = output[row + col * output_ldim];
+    T sum = accumulate ? y : T(0.f);
+    for (int j = 0; j < num_inputs; ++j) {
+      sum += scales[j] * inputs[j][row + col * input_ldims[j]];
+    }
+    y = sum;
+  }
+}
+
+/** Scale the output gradient into up to @c max_num_tensors input
+ *  gradients, reading it only once.
+ *
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: (height*width / bsize) x 1 x 1
+ */
+template <typename T>
+__global__ void bp_kernel(El::Int height,
+                          El::Int width,
+                          int num_inputs,
+                          const T* __restrict__ gradient_wrt_output,
+                          El::Int gradient_wrt_output_ldim,
+                          scale_list<T> scales,
+                          ptr_list<T> gradient_wrt_inputs,
+                          ldim_list gradient_wrt_input_ldims) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int nthreads = blockDim.x * gridDim.x;
+  const El::Int size = height * width;
+  for (El::Int pos = gid; pos < size; pos += nthreads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    const auto& dy = gradient_wrt_output[row + col * gradient_wrt_output_ldim];
+    for (int j = 0; j < num_inputs; ++j) {
+      gradient_wrt_inputs[j][row + col * gradient_wrt_input_ldims[j]]
+        = scales[j] * dy;
+    }
+  }
+}
+
+/** Grid size for an entry-wise kernel over a local matrix. */
+El::Int get_grid_size(El::Int height, El::Int width) {
+  const El::Int size = height * width;
+  return std::min((size + El::Int(block_size) - 1) / El::Int(block_size),
+                  El::Int(65535));
+}
+
+} // namespace <anon>
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void weighted_sum_layer<TensorDataType, Layout, Device>::fp_compute() {
+  const int num_parents = this->get_num_parents();
+  auto& local_output = this->get_local_activations();
+  const El::Int local_height = local_output.Height();
+  const El::Int local_width = local_output.Width();
+  if (local_height < 1 || local_width < 1) { return; }
+  const auto grid_size = get_grid_size(local_height, local_width);
+  auto&& stream = El::GPUManager::Stream();
+
+  // Add inputs in batches of at most max_num_tensors
+  for (int begin = 0; begin < num_parents; begin += max_num_tensors) {
+    const int end = std::min(begin + max_num_tensors, num_parents);
+    const_ptr_list<TensorDataType> inputs;
+    ldim_list input_ldims;
+    scale_list<TensorDataType> scales;
+    for (int j = begin; j < end; ++j) {
+      const auto& local_input = this->get_local_prev_activations(j);
+      inputs[j-begin] = local_input.LockedBuffer();
+      input_ldims[j-begin] = local_input.LDim();
+      scales[j-begin] = El::To<TensorDataType>(m_scaling_factors[j]);
+    }
+    fp_kernel<<<grid_size, block_size, 0, stream>>>(
+      local_height, local_width,
+      end - begin, inputs, input_ldims, scales,
+      begin > 0,
+      local_output.Buffer(), local_output.LDim());
+    CHECK_CUDA(cudaGetLastError());
+  }
+}
+
+template <typename TensorDataType, data_layout Layout, El::Device Device>
+void weighted_sum_layer<TensorDataType, Layout, Device>::bp_compute() {
+  const int num_parents = this->get_num_parents();
+  const auto& local_gradient_wrt_output = this->get_local_prev_error_signals();
+  const El::Int local_height = local_gradient_wrt_output.Height();
+  const El::Int local_width = local_gradient_wrt_output.Width();
+  if (local_height < 1 || local_width < 1) { return; }
+  const auto grid_size = get_grid_size(local_height, local_width);
+  auto&& stream = El::GPUManager::Stream();
+
+  // Write input gradients in batches of at most max_num_tensors
+  for (int begin = 0; begin < num_parents; begin += max_num_tensors) {
+    const int end = std::min(begin + max_num_tensors, num_parents);
+    ptr_list<TensorDataType> gradient_wrt_inputs;
+    ldim_list gradient_wrt_input_ldims;
+    scale_list<TensorDataType> scales;
+    for (int j = begin; j < end; ++j) {
+      auto& local_gradient_wrt_input = this->get_local_error_signals(j);
+      gradient_wrt_inputs[j-begin] = local_gradient_wrt_input.Buffer();
+      gradient_wrt_input_ldims[j-begin] = local_gradient_wrt_input.LDim();
+      scales[j-begin] = El::To<TensorDataType>(m_scaling_factors[j]);
+    }
+    bp_kernel<<<grid_size, block_size, 0, stream>>>(
+      local_height, local_width,
+      end - begin,
+      local_gradient_wrt_output.LockedBuffer(),
+      local_gradient_wrt_output.LDim(),
+      scales, gradient_wrt_inputs, gradient_wrt_input_ldims);
+    CHECK_CUDA(cudaGetLastError());
+  }
+}
+
+#define PROTO(T)                                                        \
+  template class weighted_sum_layer<T, data_layout::DATA_PARALLEL, El::Device::GPU>; \
+  template class weighted_sum_layer<T, data_layout::MODEL_PARALLEL, El::Device::GPU>
+
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+}// namespace lbann
@@ -25,6 +25,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lbann/metrics/layer_metric.hpp"
+#include "lbann/utils/options.hpp"
 
 namespace lbann {
 
@@ -74,12 +75,27 @@ void layer_metric::set_layer_pointers(std::vector<Layer*> layers) {
 
 void layer_metric::setup(model& m) {
   metric::setup(m);
-  get_evaluation_layer();
+  auto& eval = dynamic_cast<abstract_evaluation_layer<DataType>&>(get_evaluation_layer());
+  auto* opts = options::get();
+  if (opts->has_int("metric_sync_interval")) {
+    m_sync_interval = opts->get_int("metric_sync_interval");
+  }
+  m_deferred = (m_sync_interval > 1 && eval.enable_accumulation());
 }
 
 EvalType layer_metric::evaluate(execution_mode mode,
                                 int mini_batch_size) {
   const auto& start = get_time();
+  if (m_deferred) {
+    auto& pending = m_pending[mode];
+    ++pending.num_steps;
+    pending.num_samples += mini_batch_size;
+    if (pending.num_steps >= m_sync_interval) {
+      synchronize_statistics(mode);
+    }
+    get_evaluate_time() += get_time() - start;
+    return EvalType(0);
+  }
   auto value = dynamic_cast<abstract_evaluation_layer<DataType>&>(get_evaluation_layer()).get_value(false);
   get_evaluate_time() += get_time() - start;
   if (m_unit == "%") { value *= 100; }
@@ -88,6 +104,22 @@ EvalType layer_metric::evaluate(execution_mode mode,
   return value;
 }
 
+void layer_metric::synchronize_statistics() {
+  for (auto& pending : m_pending) {
+    synchronize_statistics(pending.first);
+  }
+}
+
+void layer_metric::synchronize_statistics(execution_mode mode) {
+  auto& pending = m_pending[mode];
+  if (pending.num_steps == 0) { return; }
+  auto& eval = dynamic_cast<abstract_evaluation_layer<DataType>&>(get_evaluation_layer());
+  auto sum = eval.take_accumulated_value(mode);
+  if (m_unit == "%") { sum *= 100; }
+  get_statistics()[mode].add_value(sum, pending.num_samples);
+  pending = pending_statistics();
+}
+
 /*abstract_evaluation_*/Layer& layer_metric::get_evaluation_layer() {
   auto& l = get_layer();
   auto* eval = dynamic_cast<abstract_evaluation_layer<DataType>*>(&l);
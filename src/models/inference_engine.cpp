@@ -0,0 +1,317 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/models/inference_engine.hpp"
+#include "lbann/execution_contexts/sgd_execution_context.hpp"
+#include "lbann/layers/data_type_layer.hpp"
+#include "lbann/layers/io/input/generic_input_layer.hpp"
+#include "lbann/models/model.hpp"
+#include "lbann/training_algorithms/sgd_training_algorithm.hpp"
+#include "lbann/utils/memory.hpp"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace lbann {
+
+// =============================================
+// inference_engine
+// =============================================
+
+inference_engine::inference_engine(trainer& t,
+                                   model& m,
+                                   std::vector<std::string> output_layers,
+                                   El::Int max_batch_size)
+  : m_trainer(t),
+    m_model(m),
+    m_algorithm(make_unique<sgd_training_algorithm>()),
+    m_max_batch_size(max_batch_size > 0
+                     ? max_batch_size
+                     : El::Int(t.get_max_mini_batch_size())) {
+
+  // Set up model with an execution context of its own
+  m_context_key = t.check_and_build_execution_context(*m_algorithm,
+                                                      &m,
+                                                      execution_mode::prediction);
+  m_context = &static_cast<sgd_execution_context&>(t.get_execution_context(m_context_key));
+  if (m_max_batch_size > El::Int(t.get_max_mini_batch_size())) {
+    LBANN_ERROR("inference engine for model \"", m.get_name(), "\" ",
+                "has a maximum batch size of ", m_max_batch_size, ", ",
+                "but the trainer's maximum mini-batch size is ",
+                t.get_max_mini_batch_size());
+  }
+  auto dr_metadata = t.get_data_coordinator().get_dr_metadata();
+  m_algorithm->setup_models({&m}, t.get_max_mini_batch_size(), dr_metadata);
+
+  // Find input layer
+  const El::Int num_layers = m.get_num_layers();
+  std::unordered_map<const Layer*, El::Int> layer_indices;
+  for (El::Int i = 0; i < num_layers; ++i) {
+    auto& l = m.get_layer(i);
+    layer_indices[&l] = i;
+    if (dynamic_cast<generic_input_layer<DataType>*>(&l) != nullptr) {
+      if (m_input_layer != nullptr) {
+        LBANN_ERROR("inference engine expects one input layer, but ",
+                    "model \"", m.get_name(), "\" has input layers ",
+                    "\"", m_input_layer->get_name(), "\" and ",
+                    "\"", l.get_name(), "\"");
+      }
+      m_input_layer = dynamic_cast<data_type_layer<DataType>*>(&l);
+    }
+  }
+  if (m_input_layer == nullptr) {
+    LBANN_ERROR("inference engine expects one input layer, but ",
+                "model \"", m.get_name(), "\" has none");
+  }
+
+  // Choose output layers
+  // Note: By default, the outputs are the graph sinks that do not
+  // depend on the labels, which excludes loss and evaluation layers.
+  if (output_layers.empty()) {
+    std::unordered_set<const Layer*> with_labels;
+    if (m_input_layer->get_num_children() > 1) {
+      with_labels.insert(m_input_layer->get_child_layers()[1]);
+    }
+    for (El::Int i = 0; i < num_layers; ++i) {
+      const auto& l = m.get_layer(i);
+      if (&l == m_input_layer) { continue; }
+      for (const auto* parent : l.get_parent_layers()) {
+        if (parent != m_input_layer && with_labels.count(parent) > 0) {
+          with_labels.insert(&l);
+        }
+      }
+      if (l.get_num_children() == 0 && with_labels.count(&l) == 0) {
+        output_layers.push_back(l.get_name());
+      }
+    }
+  }
+  for (const auto& name : output_layers) {
+    data_type_layer<DataType>* output = nullptr;
+    for (El::Int i = 0; i < num_layers; ++i) {
+      if (m.get_layer(i).get_name() == name) {
+        output = dynamic_cast<data_type_layer<DataType>*>(&m.get_layer(i));
+        if (output == nullptr) {
+          LBANN_ERROR("inference engine output layer \"", name, "\" ",
+                      "does not have the default data type");
+        }
+      }
+    }
+    if (output == nullptr) {
+      LBANN_ERROR("model \"", m.get_name(), "\" has no layer \"", name, "\"");
+    }
+    if (output->get_num_children() > 1) {
+      LBANN_ERROR("inference engine output layer \"", name, "\" ",
+                  "has ", output->get_num_children(), " output tensors, ",
+                  "but only layers with one are supported");
+    }
+    m_output_layers.push_back(output);
+  }
+  if (m_output_layers.empty()) {
+    LBANN_ERROR("inference engine for model \"", m.get_name(), "\" ",
+                "has no output layers");
+  }
+
+  // Only run layers that outputs depend on
+  std::vector<bool> needed(num_layers, false);
+  for (const auto* l : m_output_layers) {
+    needed[layer_indices.at(l)] = true;
+  }
+  for (El::Int i = num_layers - 1; i >= 0; --i) {
+    if (!needed[i]) { continue; }
+    for (const auto* parent : m.get_layer(i).get_parent_layers()) {
+      needed[layer_indices.at(parent)] = true;
+    }
+  }
+  for (El::Int i = 0; i < num_layers; ++i) {
+    if (needed[i] && &m.get_layer(i) != m_input_layer) {
+      m_layers.push_back(&m.get_layer(i));
+    }
+  }
+
+  // Allocate buffers for the largest batch
+  CPUMat samples;
+  El::Zeros(samples, get_input_size(), m_max_batch_size);
+  predict(samples);
+
+}
+
+inference_engine::~inference_engine() {
+  m_trainer.delete_execution_context(m_context_key);
+}
+
+El::Int inference_engine::get_input_size() const {
+  return m_input_layer->get_output_size(0);
+}
+
+std::vector<std::string> inference_engine::get_output_layer_names() const {
+  std::vector<std::string> names;
+  for (const auto* l : m_output_layers) {
+    names.push_back(l->get_name());
+  }
+  return names;
+}
+
+std::vector<CPUMat> inference_engine::predict(const CPUMat& samples) {
+  using StarMatType = El::DistMatrix<DataType, El::STAR, El::STAR, El::ELEMENT, El::Device::CPU>;
+  const El::Int batch_size = samples.Width();
+  if (samples.Height() != get_input_size()) {
+    LBANN_ERROR("inference engine for model \"", m_model.get_name(), "\" ",
+                "expects samples of size ", get_input_size(), ", ",
+                "but got samples of size ", samples.Height());
+  }
+  if (batch_size < 1 || batch_size > m_max_batch_size) {
+    LBANN_ERROR("inference engine for model \"", m_model.get_name(), "\" ",
+                "got a batch of ", batch_size, " samples, ",
+                "but expects between 1 and ", m_max_batch_size);
+  }
+  m_model.reset_mode(*m_context, execution_mode::prediction);
+  m_context->set_current_mini_batch_size(batch_size);
+
+  // Replace the input layer's outputs with the batch
+  auto& input = m_input_layer->get_activations(0);
+  StarMatType samples_v(input.Grid(), input.Root());
+  samples_v.LockedAttach(samples.Height(), batch_size,
+                         input.Grid(), 0, 0,
+                         samples.LockedBuffer(), samples.LDim(),
+                         input.Root());
+  El::Copy(samples_v, input);
+  if (m_input_layer->get_num_children() > 1) {
+    auto& labels = m_input_layer->get_activations(1);
+    El::Zeros(labels, m_input_layer->get_output_size(1), batch_size);
+  }
+
+  // Forward prop
+  for (auto* l : m_layers) {
+    l->forward_prop();
+  }
+
+  // Gather outputs
+  std::vector<CPUMat> outputs(m_output_layers.size());
+  for (size_t i = 0; i < m_output_layers.size(); ++i) {
+    const auto& output = m_output_layers[i]->get_activations(0);
+    StarMatType output_v(output.Grid(), output.Root());
+    El::Copy(output, output_v);
+    El::Copy(output_v.LockedMatrix(), outputs[i]);
+  }
+  return outputs;
+
+}
+
+// =============================================
+// inference_batcher
+// =============================================
+
+inference_batcher::inference_batcher(inference_engine& engine,
+                                     El::Int max_batch_size,
+                                     std::chrono::microseconds max_delay)
+  : m_engine(engine),
+    m_max_batch_size(std::min(max_batch_size, engine.get_max_batch_size())),
+    m_max_delay(max_delay) {
+  if (m_max_batch_size < 1) {
+    LBANN_ERROR("inference batches must have at least one sample");
+  }
+  m_worker = std::thread(&inference_batcher::run, this);
+}
+
+inference_batcher::~inference_batcher() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  m_worker.join();
+}
+
+std::future<std::vector<CPUMat>> inference_batcher::submit(CPUMat sample) {
+  if (sample.Width() != 1 || sample.Height() != m_engine.get_input_size()) {
+    LBANN_ERROR("inference request should be a ",
+                m_engine.get_input_size(), " x 1 matrix, ",
+                "but got a ", sample.Height(), " x ", sample.Width(), " matrix");
+  }
+  request req;
+  req.sample = std::move(sample);
+  auto outputs = req.outputs.get_future();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_requests.emplace_back(std::move(req), std::chrono::steady_clock::now());
+  }
+  m_cv.notify_one();
+  return outputs;
+}
+
+void inference_batcher::run() {
+  const El::Int input_size = m_engine.get_input_size();
+  CPUMat samples;
+  std::vector<request> batch;
+  while (true) {
+
+    // Wait for a full batch or for the oldest request to time out
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this] { return m_stop || !m_requests.empty(); });
+      if (m_requests.empty()) { return; }
+      const auto deadline = m_requests.front().second + m_max_delay;
+      m_cv.wait_until(lock, deadline, [this] {
+          return (m_stop
+                  || El::Int(m_requests.size()) >= m_max_batch_size);
+        });
+      const El::Int batch_size = std::min(El::Int(m_requests.size()),
+                                          m_max_batch_size);
+      batch.clear();
+      for (El::Int j = 0; j < batch_size; ++j) {
+        batch.push_back(std::move(m_requests.front().first));
+        m_requests.pop_front();
+      }
+    }
+
+    // Run batch and split outputs between requests
+    const El::Int batch_size = batch.size();
+    try {
+      samples.Resize(input_size, batch_size);
+      for (El::Int j = 0; j < batch_size; ++j) {
+        auto sample_v = El::View(samples, El::ALL, El::IR(j));
+        El::Copy(batch[j].sample, sample_v);
+      }
+      const auto outputs = m_engine.predict(samples);
+      for (El::Int j = 0; j < batch_size; ++j) {
+        std::vector<CPUMat> request_outputs(outputs.size());
+        for (size_t i = 0; i < outputs.size(); ++i) {
+          El::Copy(El::LockedView(outputs[i], El::ALL, El::IR(j)),
+                   request_outputs[i]);
+        }
+        batch[j].outputs.set_value(std::move(request_outputs));
+      }
+    } catch (...) {
+      for (auto& req : batch) {
+        req.outputs.set_exception(std::current_exception());
+      }
+    }
+
+  }
+}
+
+} // namespace lbann
@@ -0,0 +1,181 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/models/inference_server.hpp"
+#include "lbann/utils/exception.hpp"
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+namespace lbann {
+
+namespace {
+
+/** Read exactly @c size bytes. Returns false if the connection is
+ *  closed first. */
+bool read_bytes(int fd, void* buffer, size_t size) {
+  auto* ptr = static_cast<char*>(buffer);
+  while (size > 0) {
+    const auto n = ::recv(fd, ptr, size, 0);
+    if (n < 0 && errno == EINTR) { continue; }
+    if (n <= 0) { return false; }
+    ptr += n;
+    size -= n;
+  }
+  return true;
+}
+
+/** Write exactly @c size bytes. Returns false if the connection is
+ *  closed first. */
+bool write_bytes(int fd, const void* buffer, size_t size) {
+  auto* ptr = static_cast<const char*>(buffer);
+  while (size > 0) {
+    const auto n = ::send(fd, ptr, size, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) { continue; }
+    if (n <= 0) { return false; }
+    ptr += n;
+    size -= n;
+  }
+  return true;
+}
+
+} // namespace
+
+inference_server::inference_server(inference_engine& engine,
+                                   El::Int max_batch_size,
+                                   std::chrono::microseconds max_delay,
+                                   int port)
+  : m_batcher(engine, max_batch_size, max_delay),
+    m_input_size(engine.get_input_size()),
+    m_stop(false) {
+
+  m_socket = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (m_socket < 0) {
+    LBANN_ERROR("could not create socket (", std::strerror(errno), ")");
+  }
+  int enable = 1;
+  ::setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+#ifdef SO_REUSEPORT
+  ::setsockopt(m_socket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable));
+#endif // SO_REUSEPORT
+  sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (::bind(m_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+      || ::listen(m_socket, SOMAXCONN) != 0) {
+    const std::string err = std::strerror(errno);
+    ::close(m_socket);
+    LBANN_ERROR("could not listen on port ", port, " (", err, ")");
+  }
+
+}
+
+inference_server::~inference_server() {
+  stop();
+  for (auto& t : m_threads) {
+    t.join();
+  }
+  ::close(m_socket);
+}
+
+void inference_server::serve() {
+  while (!m_stop) {
+    const int fd = ::accept(m_socket, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) { continue; }
+      break;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stop) {
+      ::close(fd);
+      break;
+    }
+    m_connections.push_back(fd);
+    m_threads.emplace_back(&inference_server::handle_connection, this, fd);
+  }
+}
+
+void inference_server::stop() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stop = true;
+  ::shutdown(m_socket, SHUT_RDWR);
+  for (const auto& fd : m_connections) {
+    ::shutdown(fd, SHUT_RDWR);
+  }
+}
+
+void inference_server::handle_connection(int fd) {
+  while (!m_stop) {
+
+    // Receive request
+    uint64_t size;
+    if (!read_bytes(fd, &size, sizeof(size))) { break; }
+    if (size != uint64_t(m_input_size)) {
+      std::cerr << "inference server expected a sample of size "
+                << m_input_size << ", but got " << size << std::endl;
+      break;
+    }
+    CPUMat sample(m_input_size, 1);
+    if (!read_bytes(fd, sample.Buffer(), size * sizeof(DataType))) { break; }
+
+    // Run request and send response
+    std::vector<CPUMat> outputs;
+    try {
+      outputs = m_batcher.submit(std::move(sample)).get();
+    } catch (const std::exception& e) {
+      std::cerr << "inference request failed: " << e.what() << std::endl;
+      break;
+    }
+    const uint64_t num_outputs = outputs.size();
+    bool sent = write_bytes(fd, &num_outputs, sizeof(num_outputs));
+    for (const auto& output : outputs) {
+      const uint64_t output_size = output.Height();
+      sent = (sent
+              && write_bytes(fd, &output_size, sizeof(output_size))
+              && write_bytes(fd, output.LockedBuffer(),
+                             output_size * sizeof(DataType)));
+    }
+    if (!sent) { break; }
+
+  }
+
+  // Close connection
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_connections.erase(std::find(m_connections.begin(),
+                                m_connections.end(),
+                                fd));
+  ::close(fd);
+}
+
+} // namespace lbann
@@ -26,11 +26,25 @@
 
 #include "lbann/models/model.hpp"
 #include "lbann/trainers/trainer.hpp"
+#include "lbann/execution_contexts/sgd_execution_context.hpp"
 #include "lbann/callbacks/callback.hpp"
 #include "lbann/callbacks/save_model.hpp"
 #include "lbann/io/persist.hpp"
 #include "lbann/layers/io/input/generic_input_layer.hpp"
+#include "lbann/layers/activations/relu.hpp"
+#include "lbann/layers/activations/softmax.hpp"
+#include "lbann/layers/learning/convolution.hpp"
+#include "lbann/layers/learning/embedding.hpp"
+#include "lbann/layers/learning/fully_connected.hpp"
+#include "lbann/layers/loss/cross_entropy.hpp"
+#include "lbann/layers/math/binary.hpp"
+#include "lbann/layers/math/fused_entrywise.hpp"
+#include "lbann/layers/regularizers/batch_normalization.hpp"
+#include "lbann/layers/transform/concatenate.hpp"
+#include "lbann/layers/transform/constant.hpp"
+#include "lbann/layers/transform/crop.hpp"
 #include "lbann/layers/transform/dummy.hpp"
+#include "lbann/layers/transform/reshape.hpp"
 #include "lbann/layers/transform/split.hpp"
 #include "lbann/layers/transform/evaluation.hpp"
 #include "lbann/objective_functions/layer_term.hpp"
@@ -38,7 +52,14 @@
 #include "lbann/utils/random.hpp"
 #include "lbann/utils/omp_diagnostics.hpp"
 #include "lbann/utils/description.hpp"
+#include "lbann/utils/determinism.hpp"
 #include "lbann/data_store/data_store_conduit.hpp"
+#include "lbann/optimizers/fused_step.hpp"
+#include "lbann/optimizers/gradient_bucket.hpp"
+#include "lbann/utils/options.hpp"
+#include "lbann/utils/hash.hpp"
+#include "lbann/utils/numa.hpp"
+#include "lbann/utils/graph.hpp"
 
 #include <cereal/types/base_class.hpp>
 #include <cereal/types/polymorphic.hpp>
@@ -47,11 +68,22 @@
 #include <optimizers.pb.h>
 
 #include <mpi.h>
-
+#include <omp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include <string>
 #include <unistd.h>
 #include <iomanip>
 #include <queue>
+#include <sstream>
+#include <numeric>
+#include <limits>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "lbann/utils/distconv.hpp"
@@ -81,7 +113,8 @@ model::model(const model& other) :
   m_execution_context(other.m_execution_context),
   m_comm(other.m_comm),
   m_name(other.m_name),
-  m_model_is_setup(other.m_model_is_setup) {
+  m_model_is_setup(other.m_model_is_setup),
+  m_recompute_segments(other.m_recompute_segments) {
 
   // Deep copies
   m_default_optimizer_msg = (other.m_default_optimizer_msg
@@ -140,6 +173,10 @@ model& model::operator=(const model& other) {
   m_comm = other.m_comm;
   m_name = other.m_name;
   m_model_is_setup = other.m_model_is_setup;
+  m_recompute_segments = other.m_recompute_segments;
+  m_evaluation_reduction.layers.clear();
+  m_evaluation_reduction.values.clear();
+  m_evaluation_reduction.in_progress = false;
 
   // Deep copies
   m_execution_context  = other.m_execution_context;
@@ -293,6 +330,18 @@ description model::get_description() const {
 El::Int model::get_num_layers() const noexcept {
   return m_layers.size();
 }
+size_t model::get_tensor_arena_size(El::Device device) const noexcept {
+  switch (device) {
+  case El::Device::CPU:
+    return sizeof(DataType) * m_tensor_arena_cpu.Height();
+#ifdef LBANN_HAS_GPU
+  case El::Device::GPU:
+    return sizeof(DataType) * m_tensor_arena_gpu.Height();
+#endif // LBANN_HAS_GPU
+  default:
+    return 0;
+  }
+}
 Layer& model::get_layer(El::Int pos) {
   // Item 3, p. 23 in "Effective C++", 3rd ed., by Scott Meyers
   return const_cast<Layer&>(static_cast<const model&>(*this).get_layer(pos));
@@ -469,6 +518,24 @@ void model::copy_trained_weights_from(std::vector<weights*>& new_weights) {
    }
 }
 
+void model::tie_trained_weights_with(std::vector<weights*>& new_weights) {
+  std::unordered_map<std::string, data_type_weights<DataType>*> trained;
+  for (auto* w : new_weights) {
+    if (!w->is_frozen()) {
+      trained[w->get_name()] = dynamic_cast<data_type_weights<DataType>*>(w);
+    }
+  }
+  for (auto& w : m_weights) {
+    auto it = trained.find(w->get_name());
+    if (it != trained.end() && it->second != nullptr) {
+      auto* dtw = dynamic_cast<data_type_weights<DataType>*>(w.get());
+      if (dtw != nullptr) {
+        dtw->tie_values(*it->second);
+      }
+    }
+  }
+}
+
 bool model::is_execution_mode_valid(execution_mode mode) const {
   for (El::Int i = 0; i < get_num_layers(); ++i) {
     const auto* input = dynamic_cast<const generic_input_layer<DataType>*>(&get_layer(i));
@@ -577,11 +644,33 @@ void model::setup(size_t max_mini_batch_size, DataReaderMetaData& dr_metadata) {
   // Setup layers
   setup_layer_topology();
   setup_layer_execution_order();
+  if (options::get()->get_bool("in_place_activations")) {
+    setup_in_place_layers();
+  }
   setup_layers(max_mini_batch_size, dr_metadata);
 
   // Setup weights
   setup_weights();
 
+  // Read small tensors directly instead of replicating them
+  if (options::get()->get_bool("lazy_broadcast")) {
+    setup_lazy_broadcasts();
+  }
+
+  // Fold inference-only layer sequences
+  if (options::get()->get_bool("fuse_inference_layers")) {
+    fuse_inference_layers(max_mini_batch_size, dr_metadata);
+  }
+  setup_activation_recomputation(max_mini_batch_size);
+  m_first_backprop_layer = -1;
+  update_backprop_layers();
+  if (options::get()->get_bool("plan_activation_memory")) {
+    setup_activation_memory_plan();
+  }
+  if (options::get()->get_bool("parallel_layer_execution")) {
+    setup_parallel_layer_execution();
+  }
+
   // Setup metrics
   for (const auto& m : m_metrics) {
     m->setup(*this);
@@ -591,6 +680,7 @@ void model::setup(size_t max_mini_batch_size, DataReaderMetaData& dr_metadata) {
   for (const auto& cb : m_callbacks) {
     cb->setup(this);
   }
+  initialize_pending_weights();
 
 #ifdef LBANN_HAS_DISTCONV
   setup_distconv();
@@ -651,6 +741,15 @@ void model::setup_layer_topology() {
 
   // Add utility layers
   add_evaluation_layers(layer_set, layer_names);
+  if (options::get()->get_bool("fuse_softmax_cross_entropy")) {
+    fuse_softmax_cross_entropy_layers();
+  }
+  if (options::get()->get_bool("fuse_one_hot_fully_connected")) {
+    fuse_one_hot_fully_connected_layers(layer_names);
+  }
+  if (options::get()->get_bool("fuse_crop_concatenate")) {
+    fuse_crop_concatenate_layers();
+  }
   add_dummy_layers(layer_names);
   add_split_layers(layer_names);
 
@@ -697,11 +796,47 @@ void model::setup_weights() {
               return x->get_name().compare(y->get_name()) < 0;
             });
 
+  // Skip initializers if a callback will overwrite the values
+  // Note: Every callback is asked since the queries may communicate.
+  bool restores_weights = false;
+  for (const auto& cb : m_callbacks) {
+    restores_weights = cb->restores_weights(this) || restores_weights;
+  }
+  if (restores_weights) {
+    for (auto&& w : m_weights) { w->defer_initialization(); }
+  }
+
   // Setup weights
   for (auto&& w : m_weights) { w->setup(); }
 
 }
 
+void model::initialize_pending_weights() {
+  std::vector<int> pending(m_weights.size(), 0);
+  bool any_pending = false;
+  for (size_t i = 0; i < m_weights.size(); ++i) {
+    if (m_weights[i]->is_initialization_pending()) {
+      pending[i] = 1;
+      any_pending = true;
+    }
+  }
+  if (!m_comm->trainer_allreduce(int(any_pending), El::mpi::MAX)) {
+    return;
+  }
+  m_comm->allreduce(pending.data(), pending.size(),
+                    m_comm->get_trainer_comm(), El::mpi::MAX);
+  for (size_t i = 0; i < m_weights.size(); ++i) {
+    if (pending[i]) {
+      if (m_comm->am_trainer_master()) {
+        LBANN_WARNING("weights \"", m_weights[i]->get_name(), "\" "
+                      "were not restored from a checkpoint, "
+                      "so they are initialized now");
+      }
+      m_weights[i]->initialize_values();
+    }
+  }
+}
+
 void model::add_evaluation_layers(std::unordered_set<Layer*>& layer_set,
                                   std::unordered_set<std::string>& layer_names) {
   std::stringstream err;
@@ -914,6 +1049,1005 @@ void model::add_split_layers(std::unordered_set<std::string>& layer_names) {
   }
 }
 
+namespace {
+
+/** @brief Fold convolution -> batch normalization [-> ReLU].
+ *
+ *  The batch normalization and ReLU layers are disconnected from the
+ *  graph and added to @c removed.
+ *
+ *  @returns Whether @c l was fused with its children.
+ */
+template <El::Device Device>
+bool fuse_conv_batchnorm_relu(Layer& l, std::unordered_set<Layer*>& removed) {
+  using conv_type = convolution_layer<DataType, data_layout::DATA_PARALLEL, Device>;
+  using bn_type = batch_normalization_layer<DataType, data_layout::DATA_PARALLEL, Device>;
+  using relu_type = relu_layer<DataType, data_layout::DATA_PARALLEL, Device>;
+
+  // Only fuse single-child chains, otherwise other layers see the
+  // unnormalized output
+  auto single_child = [] (const Layer& x) -> Layer* {
+    const auto& children = x.get_child_layers();
+    if (children.size() != 1) { return nullptr; }
+    auto* child = const_cast<Layer*>(children.front());
+    if (child->get_parent_layers().size() != 1) { return nullptr; }
+#ifdef LBANN_HAS_DISTCONV
+    if (child->distconv_enabled()) { return nullptr; }
+#endif // LBANN_HAS_DISTCONV
+    return child;
+  };
+  auto* conv = dynamic_cast<conv_type*>(&l);
+  if (conv == nullptr || removed.count(conv) > 0) { return false; }
+#ifdef LBANN_HAS_DISTCONV
+  if (conv->distconv_enabled()) { return false; }
+#endif // LBANN_HAS_DISTCONV
+  auto* bn = dynamic_cast<bn_type*>(single_child(*conv));
+  if (bn == nullptr) { return false; }
+  Layer* last = bn;
+  auto* relu = dynamic_cast<relu_type*>(single_child(*bn));
+  if (relu != nullptr) { last = relu; }
+
+  // Move batch normalization weights into the convolution
+  std::vector<data_type_weights<DataType>*> bn_weights;
+  for (auto* w : bn->get_weights()) {
+    bn_weights.push_back(dynamic_cast<data_type_weights<DataType>*>(w));
+  }
+  conv->fuse_batchnorm(bn_weights, bn->get_epsilon(), relu != nullptr);
+
+  // Connect the convolution to the children of the last fused layer
+  auto& conv_children = conv->get_child_layers();
+  conv_children.clear();
+  for (auto&& const_child : last->get_child_layers()) {
+    auto* child = const_cast<Layer*>(const_child);
+    conv_children.push_back(child);
+    auto& child_parents = child->get_parent_layers();
+    std::replace(child_parents.begin(), child_parents.end(),
+                 static_cast<const Layer*>(last),
+                 static_cast<const Layer*>(conv));
+  }
+  removed.insert(bn);
+  if (relu != nullptr) { removed.insert(relu); }
+  return true;
+
+}
+
+/** @brief Replace a chain of entry-wise layers starting at @c head.
+ *
+ *  Follows single-consumer edges from @c head while the layers can
+ *  be fused (see @c get_fused_entrywise_op) and share a data layout
+ *  and device. The chain layers are disconnected from the graph and
+ *  added to @c removed.
+ *
+ *  @param last Set to the last layer in the chain.
+ *  @returns Fused layer that is not yet set up, or @c nullptr if
+ *           there is no chain of at least two layers.
+ */
+std::unique_ptr<Layer> fuse_entrywise_chain(lbann_comm* comm,
+                                            Layer& head,
+                                            std::unordered_set<Layer*>& removed,
+                                            Layer*& last) {
+  using step_type = fused_entrywise_step<DataType>;
+
+  // Check if layer can be fused
+  auto can_fuse = [&] (const Layer& l, step_type& step) -> bool {
+    if (removed.count(const_cast<Layer*>(&l)) > 0
+        || !get_fused_entrywise_op(l, step)
+        || l.get_data_layout() != head.get_data_layout()
+        || l.get_device_allocation() != head.get_device_allocation()) {
+      return false;
+    }
+#ifdef LBANN_HAS_DISTCONV
+    if (l.distconv_enabled()) { return false; }
+#endif // LBANN_HAS_DISTCONV
+    const size_t num_parents = (is_binary_fused_entrywise_op(step.op) ? 2 : 1);
+    return (l.get_parent_layers().size() == num_parents
+            && l.get_weights().size() == (step.op == fused_entrywise_op::scale_bias ? 1u : 0u));
+  };
+
+  // Find chain
+  // Note: Inputs are stored with the chain layer that consumes them.
+  std::vector<Layer*> chain;
+  std::vector<step_type> steps;
+  std::vector<std::pair<const Layer*, Layer*>> inputs;
+  std::vector<weights*> fused_weights;
+  step_type step;
+  if (!can_fuse(head, step)) { return nullptr; }
+  for (const auto* parent : head.get_parent_layers()) {
+    inputs.emplace_back(parent, &head);
+  }
+  if (is_binary_fused_entrywise_op(step.op)) {
+    if (inputs[0].first == inputs[1].first) { return nullptr; }
+    // The first input sets the shape of the chain, so a broadcast
+    // input has to be the operand
+    if (head.get_input_dims(0) != head.get_output_dims()) {
+      if (head.get_input_dims(1) != head.get_output_dims()) {
+        return nullptr;
+      }
+      std::swap(inputs[0], inputs[1]);
+      step.operand_first = true;
+    }
+    step.operand = 1;
+  }
+  Layer* current = &head;
+  while (true) {
+    if (step.op == fused_entrywise_op::scale_bias) {
+      step.weights = fused_weights.size();
+      fused_weights.push_back(current->get_weights().front());
+    }
+    chain.push_back(current);
+    steps.push_back(step);
+    if (chain.size() >= static_cast<size_t>(max_fused_entrywise_steps)
+        || current->get_child_layers().size() != 1) {
+      break;
+    }
+    auto* next = const_cast<Layer*>(current->get_child_layers().front());
+    step = step_type();
+    if (!can_fuse(*next, step)) { break; }
+    if (is_binary_fused_entrywise_op(step.op)) {
+      const auto& parents = next->get_parent_layers();
+      step.operand_first = (parents[1] == current);
+      const auto* operand = parents[step.operand_first ? 0 : 1];
+      const bool is_new_input = std::none_of(
+        inputs.begin(), inputs.end(),
+        [operand] (const std::pair<const Layer*, Layer*>& x) {
+          return x.first == operand;
+        });
+      if (operand == current || !is_new_input
+          || std::find(chain.begin(), chain.end(), operand) != chain.end()
+          || next->get_output_dims() != current->get_output_dims()) {
+        break;
+      }
+      step.operand = inputs.size();
+      inputs.emplace_back(operand, next);
+    }
+    current = next;
+  }
+  if (chain.size() < 2) { return nullptr; }
+  last = chain.back();
+
+  // Construct fused layer
+  std::vector<std::string> names;
+  for (const auto* l : chain) {
+    names.push_back(l->get_name());
+  }
+  std::unique_ptr<Layer> fused;
+  using args_tuple = std::tuple<data_layout,El::Device>;
+  args_tuple args(head.get_data_layout(), head.get_device_allocation());
+  if (args == args_tuple(data_layout::DATA_PARALLEL, El::Device::CPU)) {
+    fused.reset(new fused_entrywise_layer<DataType, data_layout::DATA_PARALLEL, El::Device::CPU>(comm, steps, names));
+  }
+  if (args == args_tuple(data_layout::MODEL_PARALLEL, El::Device::CPU)) {
+    fused.reset(new fused_entrywise_layer<DataType, data_layout::MODEL_PARALLEL, El::Device::CPU>(comm, steps, names));
+  }
+#ifdef LBANN_HAS_GPU
+  if (args == args_tuple(data_layout::DATA_PARALLEL, El::Device::GPU)) {
+    fused.reset(new fused_entrywise_layer<DataType, data_layout::DATA_PARALLEL, El::Device::GPU>(comm, steps, names));
+  }
+  if (args == args_tuple(data_layout::MODEL_PARALLEL, El::Device::GPU)) {
+    fused.reset(new fused_entrywise_layer<DataType, data_layout::MODEL_PARALLEL, El::Device::GPU>(comm, steps, names));
+  }
+#endif // LBANN_HAS_GPU
+  if (fused == nullptr) {
+    LBANN_ERROR("could not construct fused entry-wise layer corresponding to "
+                "layer \"",head.get_name(),"\"");
+  }
+  fused->set_weights(fused_weights);
+  fused->get_parallel_strategy() = head.get_parallel_strategy();
+
+  // Connect fused layer to inputs and outputs of chain
+  for (const auto& input : inputs) {
+    auto* parent = const_cast<Layer*>(input.first);
+    auto& parent_children = parent->get_child_layers();
+    std::replace(parent_children.begin(), parent_children.end(),
+                 static_cast<const Layer*>(input.second),
+                 static_cast<const Layer*>(fused.get()));
+    fused->add_parent_layer(parent);
+  }
+  for (auto&& const_child : last->get_child_layers()) {
+    auto* child = const_cast<Layer*>(const_child);
+    auto& child_parents = child->get_parent_layers();
+    std::replace(child_parents.begin(), child_parents.end(),
+                 static_cast<const Layer*>(last),
+                 static_cast<const Layer*>(fused.get()));
+    fused->add_child_layer(child);
+  }
+  removed.insert(chain.begin(), chain.end());
+  return fused;
+
+}
+
+/** @brief Feed logits directly into a cross entropy layer.
+ *
+ *  If the prediction input of a cross entropy layer is an
+ *  instance-wise softmax, the softmax input is passed to the cross
+ *  entropy layer instead and the loss is computed from logits. The
+ *  softmax layer is added to @c removed if it has no other children.
+ */
+template <data_layout Layout, El::Device Device>
+bool fuse_softmax_cross_entropy(Layer& l, std::unordered_set<Layer*>& removed) {
+  using ce_type = cross_entropy_layer<DataType, Layout, Device>;
+  using softmax_type = softmax_layer<DataType, Layout, Device>;
+  auto* ce = dynamic_cast<ce_type*>(&l);
+  if (ce == nullptr || ce->get_use_logits()) { return false; }
+  auto& ce_parents = ce->get_parent_layers();
+  if (ce_parents.size() != 2) { return false; }
+  auto* softmax = dynamic_cast<softmax_type*>(const_cast<Layer*>(ce_parents[0]));
+  if (softmax == nullptr
+      || softmax->get_mode() != softmax_mode::INSTANCE
+      || softmax->get_parent_layers().size() != 1) {
+    return false;
+  }
+  auto* logits = const_cast<Layer*>(softmax->get_parent_layers().front());
+  if (logits == ce_parents[1]) { return false; }
+
+  // Bypass softmax layer
+  ce_parents[0] = logits;
+  auto& softmax_children = softmax->get_child_layers();
+  softmax_children.erase(std::remove(softmax_children.begin(),
+                                     softmax_children.end(),
+                                     static_cast<const Layer*>(ce)),
+                         softmax_children.end());
+  logits->add_child_layer(ce);
+  ce->set_use_logits(true);
+  if (softmax_children.empty()) {
+    auto& logits_children = logits->get_child_layers();
+    logits_children.erase(std::remove(logits_children.begin(),
+                                      logits_children.end(),
+                                      static_cast<const Layer*>(softmax)),
+                          logits_children.end());
+    removed.insert(softmax);
+  }
+  return true;
+
+}
+
+/** @brief Let a concatenate layer read its inputs' crop windows.
+ *
+ *  Each parent of a data-parallel concatenate layer that is a crop
+ *  layer with no other children, and whose crop position is a
+ *  constant layer, is bypassed: the concatenate layer reads the crop
+ *  layer's input through a crop window at the same position. The
+ *  crop layers, and constant layers with no other children, are
+ *  added to @c removed. Returns the number of crop layers bypassed.
+ */
+template <El::Device Device>
+El::Int fuse_crop_concatenate(Layer& l, std::unordered_set<Layer*>& removed) {
+  using concat_type = concatenate_layer<DataType, data_layout::DATA_PARALLEL, Device>;
+  using crop_type = crop_layer<DataType, data_layout::DATA_PARALLEL, Device>;
+  using constant_type = constant_layer<DataType, data_layout::DATA_PARALLEL, Device>;
+  auto* concat = dynamic_cast<concat_type*>(&l);
+  if (concat == nullptr || concat->get_num_parents() < 2) { return 0; }
+  auto& concat_parents = concat->get_parent_layers();
+  El::Int num_fused = 0;
+  for (size_t j = 0; j < concat_parents.size(); ++j) {
+    auto* crop = dynamic_cast<crop_type*>(const_cast<Layer*>(concat_parents[j]));
+    if (crop == nullptr
+        || crop->get_num_children() != 1
+        || crop->get_num_parents() != 2) {
+      continue;
+    }
+    auto& crop_parents = crop->get_parent_layers();
+    auto* input = const_cast<Layer*>(crop_parents[0]);
+    auto* pos = dynamic_cast<constant_type*>(const_cast<Layer*>(crop_parents[1]));
+    if (pos == nullptr
+        || input == pos
+        || std::count(concat_parents.begin(), concat_parents.end(),
+                      static_cast<const Layer*>(input)) > 0) {
+      continue;
+    }
+
+    // Bypass crop layer
+    concat_parents[j] = input;
+    auto& input_children = input->get_child_layers();
+    std::replace(input_children.begin(), input_children.end(),
+                 static_cast<const Layer*>(crop),
+                 static_cast<const Layer*>(concat));
+    auto& pos_children = pos->get_child_layers();
+    pos_children.erase(std::remove(pos_children.begin(),
+                                   pos_children.end(),
+                                   static_cast<const Layer*>(crop)),
+                       pos_children.end());
+    if (pos_children.empty()) {
+      removed.insert(pos);
+    }
+    concat->set_input_crop(j, crop->get_output_dims(),
+                           static_cast<double>(pos->get_value()));
+    crop_parents.clear();
+    crop->get_child_layers().clear();
+    removed.insert(crop);
+    ++num_fused;
+  }
+  return num_fused;
+
+}
+
+/** @brief Replace a fully-connected layer applied to a one-hot vector
+ *  with an embedding lookup.
+ *
+ *  The one-hot layer's input is passed to an embedding layer with the
+ *  fully-connected layer's linearity weights, followed by a reshape
+ *  layer that takes over the fully-connected layer's name and
+ *  children. The fully-connected layer, and the one-hot layer if it
+ *  has no other children, are added to @c removed. Returns the new
+ *  layers, or nothing if the layer can not be replaced.
+ */
+template <El::Device Device>
+std::vector<std::unique_ptr<Layer>> fuse_one_hot_fully_connected(
+  model& m, Layer& l, std::unordered_set<Layer*>& removed,
+  std::unordered_set<std::string>& layer_names) {
+  using fc_type = fully_connected_layer<DataType, data_layout::DATA_PARALLEL, Device>;
+  using embedding_type = embedding_layer<DataType, data_layout::DATA_PARALLEL, Device>;
+  using reshape_type = reshape_layer<DataType, data_layout::DATA_PARALLEL, Device>;
+  std::vector<std::unique_ptr<Layer>> new_layers;
+  auto* fc = dynamic_cast<fc_type*>(&l);
+  if (fc == nullptr
+      || fc->is_transposed()
+      || fc->has_bias()
+      || fc->get_num_parents() != 1) {
+    return new_layers;
+  }
+  const auto fc_weights = extract_weights(*fc);
+  if (fc_weights.size() > 1) { return new_layers; }
+  auto* one_hot = const_cast<Layer*>(fc->get_parent_layers().front());
+  if (one_hot->get_type() != "one-hot"
+      || one_hot->get_num_parents() != 1
+      || removed.count(one_hot) > 0) {
+    return new_layers;
+  }
+  auto* indices = const_cast<Layer*>(one_hot->get_parent_layers().front());
+  auto* comm = fc->get_comm();
+  const auto num_embeddings = one_hot->get_output_size();
+  const auto embedding_dim = fc->get_output_size();
+
+  // Linearity weights, constructed like in the fully-connected layer
+  data_type_weights<DataType>* linearity = nullptr;
+  if (!fc_weights.empty() && fc_weights.front() != nullptr) {
+    linearity = dynamic_cast<data_type_weights<DataType>*>(fc_weights.front());
+    if (linearity == nullptr) { return new_layers; }
+  } else {
+    auto w = make_unique<data_type_weights<DataType>>(comm);
+    auto init = make_unique<he_initializer<DataType>>(probability_distribution::gaussian);
+    w->set_name(fc->get_name() + "_linearity_weights");
+    w->set_initializer(std::move(init));
+    w->set_optimizer(m.create_optimizer<DataType>());
+    linearity = w.get();
+    m.add_weights(std::move(w));
+  }
+  auto* init = dynamic_cast<variance_scaling_initializer<DataType>*>(linearity->get_initializer());
+  if (init != nullptr) {
+    init->set_fan_in(num_embeddings);
+    init->set_fan_out(embedding_dim);
+  }
+
+  // Embedding layer with sparse gradients
+  std::unique_ptr<Layer> embedding(
+    new embedding_type(comm, num_embeddings, embedding_dim, -1, true, false));
+  std::string name = fc->get_name() + "_lookup";
+  for (El::Int i = 2; layer_names.count(name) > 0; ++i) {
+    name = fc->get_name() + "_lookup" + std::to_string(i);
+  }
+  embedding->set_name(name);
+  layer_names.insert(name);
+  std::vector<weights*> embedding_weights = {linearity};
+  embedding->set_weights(embedding_weights);
+  if (fc->is_frozen()) { embedding->freeze(); }
+
+  // Reshape layer in place of the fully-connected layer
+  std::unique_ptr<Layer> reshape(new reshape_type(comm, fc->get_output_dims()));
+  reshape->set_name(fc->get_name());
+
+  // Rewire layer graph
+  auto& one_hot_children = one_hot->get_child_layers();
+  one_hot_children.erase(std::remove(one_hot_children.begin(),
+                                     one_hot_children.end(),
+                                     static_cast<const Layer*>(fc)),
+                         one_hot_children.end());
+  auto& indices_children = indices->get_child_layers();
+  if (one_hot_children.empty()) {
+    std::replace(indices_children.begin(), indices_children.end(),
+                 static_cast<const Layer*>(one_hot),
+                 static_cast<const Layer*>(embedding.get()));
+    removed.insert(one_hot);
+  } else {
+    indices->add_child_layer(embedding.get());
+  }
+  embedding->add_parent_layer(indices);
+  embedding->add_child_layer(reshape.get());
+  reshape->add_parent_layer(embedding.get());
+  for (const auto* child : fc->get_child_layers()) {
+    auto& child_parents = const_cast<Layer*>(child)->get_parent_layers();
+    std::replace(child_parents.begin(), child_parents.end(),
+                 static_cast<const Layer*>(fc),
+                 static_cast<const Layer*>(reshape.get()));
+    reshape->add_child_layer(child);
+  }
+  fc->get_parent_layers().clear();
+  fc->get_child_layers().clear();
+  removed.insert(fc);
+
+  new_layers.emplace_back(std::move(embedding));
+  new_layers.emplace_back(std::move(reshape));
+  return new_layers;
+
+}
+
+} // namespace <anon>
+
+void model::fuse_one_hot_fully_connected_layers(
+  std::unordered_set<std::string>& layer_names) {
+  std::unordered_set<Layer*> removed;
+  std::unordered_map<Layer*, std::vector<std::unique_ptr<Layer>>> lookups;
+  for (El::Int i = 0; i < get_num_layers(); ++i) {
+    auto& l = get_layer(i);
+    auto new_layers = fuse_one_hot_fully_connected<El::Device::CPU>(
+      *this, l, removed, layer_names);
+#ifdef LBANN_HAS_GPU
+    if (new_layers.empty()) {
+      new_layers = fuse_one_hot_fully_connected<El::Device::GPU>(
+        *this, l, removed, layer_names);
+    }
+#endif // LBANN_HAS_GPU
+    if (!new_layers.empty()) {
+      lookups[&l] = std::move(new_layers);
+    }
+  }
+  if (lookups.empty()) { return; }
+
+  // Put new layers in place of the fully-connected layers
+  std::vector<std::unique_ptr<Layer>> layers;
+  for (auto& l : m_layers) {
+    auto it = lookups.find(l.get());
+    if (it != lookups.end()) {
+      for (auto& new_layer : it->second) {
+        new_layer->set_model(this);
+        layers.emplace_back(std::move(new_layer));
+      }
+    }
+    if (removed.count(l.get()) == 0) {
+      layers.emplace_back(std::move(l));
+    }
+  }
+  m_layers = std::move(layers);
+  if (m_comm->am_trainer_master()) {
+    std::cout << "model \"" << get_name() << "\": "
+              << "replaced " << lookups.size() << " fully-connected layers "
+              << "after one-hot layers with embedding lookups "
+              << "(" << removed.size() << " layers removed)" << std::endl;
+  }
+
+}
+
+void model::fuse_crop_concatenate_layers() {
+  std::unordered_set<Layer*> removed;
+  El::Int num_fused = 0;
+  for (El::Int i = 0; i < get_num_layers(); ++i) {
+    auto& l = get_layer(i);
+    num_fused += fuse_crop_concatenate<El::Device::CPU>(l, removed);
+#ifdef LBANN_HAS_GPU
+    num_fused += fuse_crop_concatenate<El::Device::GPU>(l, removed);
+#endif // LBANN_HAS_GPU
+  }
+
+  // Remove bypassed crop layers and unused crop positions
+  if (!removed.empty()) {
+    std::vector<std::unique_ptr<Layer>> layers;
+    for (auto& l : m_layers) {
+      if (removed.count(l.get()) == 0) {
+        layers.emplace_back(std::move(l));
+      }
+    }
+    m_layers = std::move(layers);
+  }
+  if (num_fused > 0 && m_comm->am_trainer_master()) {
+    std::cout << "model \"" << get_name() << "\": "
+              << "reading " << num_fused << " crop windows "
+              << "directly in concatenate layers "
+              << "(" << removed.size() << " layers removed)" << std::endl;
+  }
+
+}
+
+void model::fuse_softmax_cross_entropy_layers() {
+  std::unordered_set<Layer*> removed;
+  El::Int num_fused = 0;
+  for (El::Int i = 0; i < get_num_layers(); ++i) {
+    auto& l = get_layer(i);
+    if (fuse_softmax_cross_entropy<data_layout::DATA_PARALLEL, El::Device::CPU>(l, removed)
+        || fuse_softmax_cross_entropy<data_layout::MODEL_PARALLEL, El::Device::CPU>(l, removed)) {
+      ++num_fused;
+    }
+#ifdef LBANN_HAS_GPU
+    if (fuse_softmax_cross_entropy<data_layout::DATA_PARALLEL, El::Device::GPU>(l, removed)
+        || fuse_softmax_cross_entropy<data_layout::MODEL_PARALLEL, El::Device::GPU>(l, removed)) {
+      ++num_fused;
+    }
+#endif // LBANN_HAS_GPU
+  }
+
+  // Remove unused softmax layers
+  if (!removed.empty()) {
+    std::vector<std::unique_ptr<Layer>> layers;
+    for (auto& l : m_layers) {
+      if (removed.count(l.get()) == 0) {
+        layers.emplace_back(std::move(l));
+      }
+    }
+    m_layers = std::move(layers);
+  }
+  if (num_fused > 0 && m_comm->am_trainer_master()) {
+    std::cout << "model \"" << get_name() << "\": "
+              << "computing " << num_fused << " cross entropy layers "
+              << "from logits "
+              << "(" << removed.size() << " softmax layers removed)"
+              << std::endl;
+  }
+
+}
+
+void model::setup_lazy_broadcasts() {
+  auto is_broadcasting_child = [] (const Layer& l) -> bool {
+    return (is_entrywise_binary_layer(l)
+            && l.get_data_layout() == data_layout::DATA_PARALLEL
+            && l.get_parent_layers()[0] != l.get_parent_layers()[1]);
+  };
+
+  // Remove tessellate layers that feed a binary layer
+  // Note: The binary layer's output dimensions stay the same. It
+  // reads the tessellate layer's input at its own output shape,
+  // which matches tessellation exactly.
+  std::unordered_set<Layer*> removed;
+  for (El::Int i = 0; i < get_num_layers(); ++i) {
+    auto& l = get_layer(i);
+    if (l.get_type() != "tessellate"
+        || l.get_num_parents() != 1
+        || l.get_num_children() != 1) {
+      continue;
+    }
+    auto* parent = const_cast<Layer*>(l.get_parent_layers().front());
+    auto* child = const_cast<Layer*>(l.get_child_layers().front());
+    if (parent->get_num_children() != 1
+        || !is_broadcasting_child(*child)
+        || !is_broadcastable(l.get_input_dims(), child->get_output_dims())) {
+      continue;
+    }
+#ifdef LBANN_HAS_DISTCONV
+    if (parent->distconv_enabled() || child->distconv_enabled()) {
+      continue;
+    }
+#endif // LBANN_HAS_DISTCONV
+    auto& parent_children = parent->get_child_layers();
+    std::replace(parent_children.begin(), parent_children.end(),
+                 static_cast<const Layer*>(&l),
+                 static_cast<const Layer*>(child));
+    auto& child_parents = child->get_parent_layers();
+    std::replace(child_parents.begin(), child_parents.end(),
+                 static_cast<const Layer*>(&l),
+                 static_cast<const Layer*>(parent));
+    l.get_parent_layers().clear();
+    l.get_child_layers().clear();
+    removed.insert(&l);
+  }
+  if (!removed.empty()) {
+    std::vector<std::unique_ptr<Layer>> layers;
+    for (auto& l : m_layers) {
+      if (removed.count(l.get()) == 0) {
+        layers.emplace_back(std::move(l));
+      }
+    }
+    m_layers = std::move(layers);
+  }
+
+  // Shrink constant layers that only feed binary layers
+  El::Int num_constants = 0;
+  for (El::Int i = 0; i < get_num_layers(); ++i) {
+    auto& l = get_layer(i);
+    if (l.get_type() != "constant" || l.get_num_children() < 1) {
+      continue;
+    }
+    const auto& children = l.get_child_layers();
+    if (!std::all_of(children.begin(), children.end(),
+                     [&] (const Layer* child) {
+                       return is_broadcasting_child(*child);
+                     })) {
+      continue;
+    }
+    const std::vector<int> dims(l.get_output_dims().size(), 1);
+    if (l.get_output_dims() == dims) { continue; }
+    for (int j = 0; j < l.get_num_children(); ++j) {
+      l.set_output_dims(dims, j);
+    }
+    ++num_constants;
+  }
+
+  if (m_comm->am_trainer_master()) {
+    std::cout << "model \"" << get_name() << "\": "
+              << "broadcasting " << removed.size() << " tessellated and "
+              << num_constants << " constant tensors "
+              << "instead of replicating them" << std::endl;
+  }
+
+}
+
+void model::fuse_inference_layers(size_t max_mini_batch_size,
+                                  DataReaderMetaData& dr_metadata) {
+  std::unordered_set<Layer*> removed;
+
+  // Fold batch normalization into convolutions
+  El::Int num_conv_fused = 0;
+  for (El::Int i = 0; i < get_num_layers(); ++i) {
+    auto& l = get_layer(i);
+    if (fuse_conv_batchnorm_relu<El::Device::CPU>(l, removed)) {
+      ++num_conv_fused;
+    }
+#ifdef LBANN_HAS_GPU
+    if (fuse_conv_batchnorm_relu<El::Device::GPU>(l, removed)) {
+      ++num_conv_fused;
+    }
+#endif // LBANN_HAS_GPU
+  }
+
+  // Replace chains of entry-wise layers
+  // Note: Fused layers take the place of the last layer in their
+  // chain in the execution order.
+  std::unordered_set<std::string> layer_names;
+  for (El::Int i = 0; i < get_num_layers(); ++i) {
+    layer_names.insert(get_layer(i).get_name());
+  }
+  std::unordered_map<Layer*, std::unique_ptr<Layer>> fused_chains;
+  for (El::Int i = 0; i < get_num_layers(); ++i) {
+    auto& head = get_layer(i);
+    Layer* last = nullptr;
+    auto fused = fuse_entrywise_chain(m_comm, head, removed, last);
+    if (fused == nullptr) { continue; }
+    std::string name = head.get_name() + "_fused";
+    for (El::Int j = 2; layer_names.count(name) > 0; ++j) {
+      name = head.get_name() + "_fused" + std::to_string(j);
+    }
+    fused->set_name(name);
+    layer_names.insert(name);
+    fused->set_model(this);
+    fused->setup(max_mini_batch_size, dr_metadata);
+    fused->check_setup();
+    fused_chains[last] = std::move(fused);
+  }
+  if (removed.empty()) { return; }
+
+  // Remove fused layers from the model
+  std::vector<std::unique_ptr<Layer>> layers;
+  for (auto& l : m_layers) {
+    auto it = fused_chains.find(l.get());
+    if (it != fused_chains.end()) {
+      layers.emplace_back(std::move(it->second));
+    }
+    if (removed.count(l.get()) == 0) {
+      layers.emplace_back(std::move(l));
+    }
+  }
+  m_layers = std::move(layers);
+  if (m_comm->am_trainer_master()) {
+    std::cout << "model \"" << get_name() << "\": "
+              << "fused " << num_conv_fused << " convolution layers with "
+              << "their batch normalization and "
+              << fused_chains.size() << " entry-wise layer chains "
+              << "(" << removed.size() << " layers removed)" << std::endl;
+  }
+
+}
+
+void model::setup_in_place_layers() {
+  El::Int num_in_place = 0;
+  for (El::Int i = 0; i < get_num_layers(); ++i) {
+    auto& l = get_layer(i);
+    l.set_in_place(false);
+    if (!l.supports_in_place()
+        || l.get_num_parents() != 1
+        || l.get_num_children() != 1
+        || l.get_recompute_activations()) {
+      continue;
+    }
+    const auto& parent = *l.get_parent_layers().front();
+    if (parent.get_num_children() != 1
+        || parent.uses_outputs_in_backprop()
+        || parent.get_recompute_activations()
+        || parent.get_device_allocation() != l.get_device_allocation()
+        || parent.get_data_layout() != l.get_data_layout()) {
+      continue;
+    }
+#ifdef LBANN_HAS_DISTCONV
+    if (l.distconv_enabled() || parent.distconv_enabled()) { continue; }
+#endif // LBANN_HAS_DISTCONV
+    l.set_in_place(true);
+    ++num_in_place;
+  }
+  if (m_comm->am_trainer_master()) {
+    std::cout << "model \"" << get_name() << "\": "
+              << num_in_place << " layers run in place" << std::endl;
+  }
+}
+
+void model::setup_activation_recomputation(size_t max_mini_batch_size) {
+  m_recompute_segments.clear();
+  const El::Int num_layers = get_num_layers();
+  std::unordered_map<const Layer*, El::Int> layer_indices;
+  for (El::Int i = 0; i < num_layers; ++i) {
+    layer_indices[&get_layer(i)] = i;
+  }
+
+  // Check which layers can be recomputed
+  std::vector<bool> can_recompute(num_layers);
+  for (El::Int i = 0; i < num_layers; ++i) {
+    const auto& l = get_layer(i);
+    can_recompute[i] = l.can_recompute_activations() && l.get_num_parents() > 0;
+    can_recompute[i] = can_recompute[i] && !l.is_in_place();
+    for (const auto* child : l.get_child_layers()) {
+      can_recompute[i] = can_recompute[i] && !child->is_in_place();
+    }
+#ifdef LBANN_HAS_DISTCONV
+    can_recompute[i] = can_recompute[i] && !l.distconv_enabled();
+#endif // LBANN_HAS_DISTCONV
+    if (l.get_recompute_activations() && !can_recompute[i]
+        && m_comm->am_trainer_master()) {
+      LBANN_WARNING("activations of ",l.get_type()," layer ",
+                    "\"",l.get_name(),"\" can not be recomputed");
+    }
+  }
+
+  // Find the longest valid segment starting at first and ending at
+  // or before last
+  auto segment_end = [&] (El::Int first, El::Int last) -> El::Int {
+    for (El::Int end = last; end > first; --end) {
+      bool valid = true;
+      for (El::Int j = first; valid && j < end; ++j) {
+        for (const auto* child : get_layer(j).get_child_layers()) {
+          if (layer_indices.at(child) > end) {
+            valid = false;
+            break;
+          }
+        }
+      }
+      if (valid) { return end; }
+    }
+    return first;
+  };
+
+  // Split runs of layers into segments of at most max_length layers
+  auto find_segments = [&] (const std::vector<bool>& in_run,
+                            El::Int max_length) {
+    std::vector<std::pair<El::Int, El::Int>> segments;
+    El::Int first = 0;
+    while (first < num_layers) {
+      if (!in_run[first]) { ++first; continue; }
+      El::Int last = first;
+      while (last+1 < num_layers && in_run[last+1]
+             && last+1 - first < max_length) {
+        ++last;
+      }
+      const auto end = segment_end(first, last);
+      if (end > first) {
+        segments.emplace_back(first, end);
+      }
+      first = std::max(end, first) + 1;
+    }
+    return segments;
+  };
+
+  // Segments from the prototext
+  std::vector<bool> flagged(num_layers);
+  for (El::Int i = 0; i < num_layers; ++i) {
+    flagged[i] = can_recompute[i] && get_layer(i).get_recompute_activations();
+  }
+  for (const auto& s : find_segments(flagged, num_layers)) {
+    m_recompute_segments[s.second] = {s.first, false};
+  }
+
+  // Automatically chosen segments
+  auto&& opts = options::get();
+  if (opts->has_int("recompute_memory_budget_mb")) {
+    const double budget = opts->get_int("recompute_memory_budget_mb") * 1024. * 1024.;
+    const double procs = m_comm->get_procs_per_trainer();
+    std::vector<double> sizes(num_layers, 0.);
+    double kept_size = 0.;
+    for (El::Int i = 0; i < num_layers; ++i) {
+      const auto& l = get_layer(i);
+      for (int j = 0; j < l.get_num_children(); ++j) {
+        sizes[i] += (l.get_output_size(j) * double(max_mini_batch_size)
+                     * sizeof(DataType) / procs);
+      }
+      kept_size += sizes[i];
+    }
+    for (const auto& s : m_recompute_segments) {
+      for (El::Int j = s.second.first; j < s.first; ++j) {
+        kept_size -= sizes[j];
+      }
+    }
+    if (kept_size > budget) {
+      std::vector<bool> candidates(can_recompute);
+      for (const auto& s : m_recompute_segments) {
+        for (El::Int j = s.second.first; j <= s.first; ++j) {
+          candidates[j] = false;
+        }
+      }
+      const El::Int max_length = std::max(El::Int(2),
+                                          El::Int(std::ceil(std::sqrt(num_layers))));
+      std::vector<std::pair<double, std::pair<El::Int, El::Int>>> choices;
+      for (const auto& s : find_segments(candidates, max_length)) {
+        double freed = 0.;
+        for (El::Int j = s.first; j < s.second; ++j) {
+          freed += sizes[j];
+        }
+        choices.emplace_back(freed, s);
+      }
+      std::sort(choices.begin(), choices.end(),
+                [] (const std::pair<double, std::pair<El::Int, El::Int>>& x,
+                    const std::pair<double, std::pair<El::Int, El::Int>>& y) {
+                  return x.first > y.first;
+                });
+      for (const auto& c : choices) {
+        if (kept_size <= budget) { break; }
+        m_recompute_segments[c.second.second] = {c.second.first, false};
+        kept_size -= c.first;
+      }
+    }
+    if (m_comm->am_trainer_master()) {
+      std::cout << "model \"" << get_name() << "\": "
+                << "expecting " << kept_size / (1024. * 1024.) << " MB "
+                << "of activations per process with "
+                << m_recompute_segments.size() << " recomputed segments "
+                << "(budget " << budget / (1024. * 1024.) << " MB)"
+                << std::endl;
+    }
+  }
+
+}
+
+void model::setup_activation_memory_plan() {
+  const El::Int num_layers = get_num_layers();
+  std::unordered_map<const Layer*, El::Int> layer_indices;
+  for (El::Int i = 0; i < num_layers; ++i) {
+    layer_indices[&get_layer(i)] = i;
+  }
+
+  // Layers whose outputs are managed elsewhere
+  std::vector<bool> skip(num_layers, false);
+  for (El::Int i = 0; i < num_layers; ++i) {
+    skip[i] = get_layer(i).get_num_parents() == 0;
+#ifdef LBANN_HAS_DISTCONV
+    skip[i] = skip[i] || get_layer(i).distconv_enabled();
+#endif // LBANN_HAS_DISTCONV
+  }
+  for (const auto& s : m_recompute_segments) {
+    for (El::Int j = s.second.first; j <= s.first; ++j) {
+      skip[j] = true;
+    }
+  }
+
+  // Tensor lifetimes, in training steps
+  // Note: Forward prop of layer i is step i and backprop is step
+  // 2N-1-i.
+  struct tensor {
+    El::Int layer;
+    int index;
+    bool is_error_signal;
+    El::Device device;
+    size_t size;
+    El::Int begin, end;
+    size_t offset;
+  };
+  constexpr size_t alignment = 256;
+  const auto backprop_step = [num_layers] (El::Int i) {
+    return 2 * num_layers - 1 - i;
+  };
+  std::vector<tensor> tensors;
+  for (El::Int i = 0; i < num_layers; ++i) {
+    if (skip[i]) { continue; }
+    auto& l = get_layer(i);
+    for (int j = 0; j < l.get_num_children(); ++j) {
+      const auto size = l.get_activations_buffer_size(j);
+      if (size > 0) {
+        tensors.push_back({i, j, false, l.get_device_allocation(),
+                           (size + alignment - 1) / alignment * alignment,
+                           i, backprop_step(i), 0});
+      }
+    }
+    // Note: Error signals that frozen layers do not need are left
+    // out. They are allocated as usual if the layers are unfrozen.
+    for (int j = 0; j < l.get_num_parents(); ++j) {
+      if (!l.needs_backprop() || !l.error_signals_needed(j)) { continue; }
+      const auto size = l.get_error_signals_buffer_size(j);
+      const auto parent = layer_indices.at(l.get_parent_layers()[j]);
+      if (size > 0 && !skip[parent]) {
+        tensors.push_back({i, j, true, l.get_device_allocation(),
+                           (size + alignment - 1) / alignment * alignment,
+                           backprop_step(i), backprop_step(parent), 0});
+      }
+    }
+  }
+
+  // Greedy best-fit placement, largest tensors first
+  std::vector<size_t> order(tensors.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&tensors] (size_t a, size_t b) {
+                     return tensors[a].size > tensors[b].size;
+                   });
+  std::map<El::Device, size_t> arena_sizes, owned_sizes;
+  std::vector<size_t> placed;
+  for (const auto& t_index : order) {
+    auto& t = tensors[t_index];
+    std::vector<std::pair<size_t, size_t>> conflicts;
+    for (const auto& p_index : placed) {
+      const auto& p = tensors[p_index];
+      if (p.device == t.device && p.begin <= t.end && t.begin <= p.end) {
+        conflicts.emplace_back(p.offset, p.offset + p.size);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end());
+    size_t best_offset = std::numeric_limits<size_t>::max();
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t offset = 0;
+    for (const auto& c : conflicts) {
+      if (c.first >= offset + t.size && c.first - offset < best_gap) {
+        best_offset = offset;
+        best_gap = c.first - offset;
+      }
+      offset = std::max(offset, c.second);
+    }
+    t.offset = (best_offset != std::numeric_limits<size_t>::max()
+                ? best_offset : offset);
+    arena_sizes[t.device] = std::max(arena_sizes[t.device], t.offset + t.size);
+    owned_sizes[t.device] += t.size;
+    placed.push_back(t_index);
+  }
+
+  // Allocate arenas and attach tensors
+  const auto arena_buffer = [this] (El::Device device, size_t offset) -> void* {
+    switch (device) {
+    case El::Device::CPU:
+      return reinterpret_cast<unsigned char*>(m_tensor_arena_cpu.Buffer()) + offset;
+#ifdef LBANN_HAS_GPU
+    case El::Device::GPU:
+      return reinterpret_cast<unsigned char*>(m_tensor_arena_gpu.Buffer()) + offset;
+#endif // LBANN_HAS_GPU
+    default:
+      LBANN_ERROR("invalid device");
+    }
+    return nullptr;
+  };
+  m_tensor_arena_cpu.Resize((arena_sizes[El::Device::CPU] + sizeof(DataType) - 1)
+                            / sizeof(DataType), 1);
+  numa::place_pages(m_tensor_arena_cpu.Buffer(),
+                    sizeof(DataType) * m_tensor_arena_cpu.Height());
+#ifdef LBANN_HAS_GPU
+  m_tensor_arena_gpu.Resize((arena_sizes[El::Device::GPU] + sizeof(DataType) - 1)
+                            / sizeof(DataType), 1);
+#endif // LBANN_HAS_GPU
+  for (const auto& t : tensors) {
+    auto& l = get_layer(t.layer);
+    auto* buffer = arena_buffer(t.device, t.offset);
+    if (t.is_error_signal) {
+      l.set_error_signals_buffer(t.index, buffer);
+    }
+    else {
+      l.set_activations_buffer(t.index, buffer);
+    }
+  }
+
+  // Report memory savings
+  if (m_comm->am_trainer_master()) {
+    std::stringstream ss;
+    ss << "model \"" << get_name() << "\" activation memory plan "
+       << "(" << tensors.size() << " tensors):";
+    for (const auto& s : arena_sizes) {
+      ss << " " << (s.first == El::Device::CPU ? "CPU" : "GPU") << " "
+         << std::fixed << std::setprecision(1)
+         << owned_sizes[s.first] / (1024. * 1024.) << " MB peak -> "
+         << s.second / (1024. * 1024.) << " MB peak;";
+    }
+    std::cout << ss.str() << std::endl;
+  }
+
+}
+
 // =============================================
 // Execution
 // =============================================
@@ -982,52 +2116,704 @@ void model::evaluate_metrics(execution_mode mode, size_t current_mini_batch_size
   }
 }
 
+std::vector<evaluation_partial_value*> model::get_partial_evaluation_values() {
+  std::vector<evaluation_partial_value*> values;
+  for (El::Int i = 0; i < get_num_layers(); ++i) {
+    auto* value = dynamic_cast<evaluation_partial_value*>(&get_layer(i));
+    if (value != nullptr && value->is_partial()) {
+      values.push_back(value);
+    }
+  }
+  return values;
+}
+
+void model::start_evaluation_reduction() {
+  auto& state = m_evaluation_reduction;
+  if (state.in_progress) {
+    // Values from an earlier forward prop that were never requested
+    m_comm->wait(state.req);
+    state.in_progress = false;
+  }
+  const auto& trainer_comm = m_comm->get_trainer_comm();
+  state.layers.clear();
+  state.values.clear();
+  for (auto* value : get_partial_evaluation_values()) {
+    if (value->has_async_local_value()) {
+      state.layers.clear();
+      state.values.clear();
+      return;
+    }
+    // Layers distributed over a subset of the trainer are reduced
+    // separately
+    if (El::mpi::Size(value->get_reduction_comm())
+        == El::mpi::Size(trainer_comm)) {
+      state.layers.push_back(value);
+      state.values.push_back(value->get_local_value());
+    }
+  }
+  if (!state.values.empty()) {
+    m_comm->nb_allreduce(state.values.data(),
+                         static_cast<int>(state.values.size()),
+                         trainer_comm, state.req);
+    state.in_progress = true;
+  }
+}
+
+void model::reduce_evaluation_values() {
+  auto& state = m_evaluation_reduction;
+  if (!state.in_progress) {
+    // Wait for values copied from GPUs and reduce everything at once
+    const auto& trainer_comm = m_comm->get_trainer_comm();
+    state.layers.clear();
+    state.values.clear();
+    for (auto* value : get_partial_evaluation_values()) {
+      if (El::mpi::Size(value->get_reduction_comm())
+          == El::mpi::Size(trainer_comm)) {
+        state.layers.push_back(value);
+        state.values.push_back(value->get_local_value());
+      }
+    }
+    if (!state.values.empty()) {
+      m_comm->allreduce(state.values.data(),
+                        static_cast<int>(state.values.size()),
+                        trainer_comm);
+    }
+  } else {
+    m_comm->wait(state.req);
+  }
+  for (size_t i = 0; i < state.layers.size(); ++i) {
+    state.layers[i]->set_reduced_value(state.values[i]);
+  }
+  state.layers.clear();
+  state.values.clear();
+  state.in_progress = false;
+}
+
+void model::synchronize_metrics() {
+  for (const auto& m : m_metrics) {
+    m->synchronize_statistics();
+  }
+}
+
 void model::clear_gradients() {
   for (auto&& w : m_weights) {
     auto&& opt = w->get_optimizer();
-    if (opt != nullptr) { opt->clear_gradient(); }
+    // Gradients of deferred updates are cleared once they are applied
+    if (opt != nullptr && m_pending_weight_updates.count(w.get()) == 0) {
+      opt->clear_gradient();
+    }
+  }
+}
+
+void model::set_gradient_allreduces_deferred(bool defer) {
+  m_gradient_allreduces_deferred = defer;
+  for (auto&& w : m_weights) {
+    auto* opt = w->get_optimizer();
+    if (opt != nullptr) { opt->set_gradient_allreduce_deferred(defer); }
   }
 }
 
 void model::forward_prop(execution_mode mode) {
+#ifdef LBANN_HAS_GPU
+  // Tensors may be reallocated, so the training graph is recaptured
+  m_training_graph.mini_batch_size = 0;
+#endif // LBANN_HAS_GPU
   do_model_forward_prop_begin_cbs(mode);
+
+  // Run independent layers concurrently
+  if (m_parallel_execution != nullptr) {
+    apply_pending_weight_updates();
+    std::mutex callback_mutex;
+    run_layers_concurrently(
+      m_parallel_execution->fp_edges,
+      false,
+      [this, mode, &callback_mutex] (Layer& l) {
+        {
+          std::lock_guard<std::mutex> guard(callback_mutex);
+          do_layer_forward_prop_begin_cbs(mode, &l);
+        }
+        l.forward_prop();
+        {
+          std::lock_guard<std::mutex> guard(callback_mutex);
+          do_layer_forward_prop_end_cbs(mode, &l);
+        }
+      });
+    start_evaluation_reduction();
+    do_model_forward_prop_end_cbs(mode);
+    return;
+  }
+
   for (El::Int i = 0; i < get_num_layers(); ++i) {
     auto& l = get_layer(i);
+    if (has_pending_weight_updates()) {
+      for (auto* w : l.get_weights()) {
+        apply_pending_weight_update(*w);
+      }
+    }
     do_layer_forward_prop_begin_cbs(mode, &l);
     l.forward_prop();
     do_layer_forward_prop_end_cbs(mode, &l);
+
+    // Free activations that will be recomputed in backprop
+    // Note: If the last layer's outputs view interior outputs, they
+    // must be kept.
+    if (mode == execution_mode::training) {
+      auto it = m_recompute_segments.find(i);
+      if (it != m_recompute_segments.end()) {
+        auto& segment = it->second;
+        segment.released = !l.has_activation_views();
+        for (El::Int j = segment.first; segment.released && j < i; ++j) {
+          get_layer(j).release_activations();
+        }
+      }
+    }
   }
+  apply_pending_weight_updates();
+  start_evaluation_reduction();
   do_model_forward_prop_end_cbs(mode);
 }
 
 void model::backward_prop() {
   do_model_backward_prop_begin_cbs();
-  for (El::Int i = get_num_layers()-1; i >= 0; --i) {
+  update_backprop_layers();
+
+  // Run independent layers concurrently
+  // Note: Gradient allreduces are launched from this thread
+  // afterwards.
+  if (m_parallel_execution != nullptr) {
+    for (auto&& w : m_weights) {
+      auto* opt = w->get_optimizer();
+      if (opt != nullptr) { opt->set_gradient_allreduce_deferred(true); }
+    }
+    std::mutex callback_mutex;
+    run_layers_concurrently(
+      m_parallel_execution->bp_edges,
+      true,
+      [this, &callback_mutex] (Layer& l) {
+        if (!l.needs_backprop()) { return; }
+        {
+          std::lock_guard<std::mutex> guard(callback_mutex);
+          do_layer_backward_prop_begin_cbs(&l);
+        }
+        l.back_prop();
+        {
+          std::lock_guard<std::mutex> guard(callback_mutex);
+          do_layer_backward_prop_end_cbs(&l);
+        }
+      });
+    set_gradient_allreduces_deferred(m_gradient_allreduces_deferred);
+    launch_gradient_buckets(*m_comm);
+    do_model_backward_prop_end_cbs();
+    return;
+  }
+
+  // Stop after the first layer that needs backprop since earlier
+  // layers do not contribute to any gradients
+  for (El::Int i = get_num_layers()-1; i >= m_first_backprop_layer; --i) {
+    auto& l = get_layer(i);
+    if (!l.needs_backprop()) { continue; }
+
+    // Recompute freed activations
+    auto it = m_recompute_segments.find(i);
+    if (it != m_recompute_segments.end() && it->second.released) {
+      for (El::Int j = it->second.first; j <= i; ++j) {
+        get_layer(j).forward_prop();
+      }
+      it->second.released = false;
+    }
 
     // Perform backward prop step on current layer
+    do_layer_backward_prop_begin_cbs(&l);
+    l.back_prop();
+    do_layer_backward_prop_end_cbs(&l);
+
+  }
+
+  // Start allreduces on the first layers' gradients now rather than
+  // when the optimization step needs them
+  launch_gradient_buckets(*m_comm);
+
+  do_model_backward_prop_end_cbs();
+}
+
+bool model::update_backprop_layers() {
+
+  // Check if any weights were frozen or unfrozen
+  const size_t num_weights = m_weights.size();
+  std::vector<bool> optimized_weights(num_weights);
+  for (size_t i = 0; i < num_weights; ++i) {
+    optimized_weights[i] = (m_weights[i]->get_optimizer() != nullptr);
+  }
+  if (m_first_backprop_layer >= 0
+      && optimized_weights == m_optimized_weights) {
+    return false;
+  }
+  m_optimized_weights = std::move(optimized_weights);
+
+  // Layers are in topological order, so parents are marked first
+  const El::Int num_layers = get_num_layers();
+  m_first_backprop_layer = num_layers;
+  for (El::Int i = 0; i < num_layers; ++i) {
+    auto& l = get_layer(i);
+    bool needs_backprop = false;
+    for (const auto* w : l.get_weights()) {
+      if (w->get_optimizer() != nullptr) { needs_backprop = true; }
+    }
+    for (const auto& parent : l.get_parent_layers()) {
+      if (parent->needs_backprop()) { needs_backprop = true; }
+    }
+    l.set_needs_backprop(needs_backprop);
+    if (needs_backprop) {
+      m_first_backprop_layer = std::min(m_first_backprop_layer, i);
+    }
+  }
+
+#ifdef LBANN_HAS_GPU
+  // Recapture the training step graph
+  m_training_graph.mini_batch_size = 0;
+#endif // LBANN_HAS_GPU
+
+  return true;
+}
+
+void model::setup_parallel_layer_execution() {
+  m_parallel_execution.reset();
+  const El::Int num_layers = get_num_layers();
+
+  // Check if layers can run concurrently
+  std::string reason;
+  if (m_comm->get_procs_per_trainer() > 1) {
+    reason = "the trainer has multiple processes";
+  } else if (!m_recompute_segments.empty()) {
+    reason = "activations are recomputed in backprop";
+  } else if (options::get()->get_bool("plan_activation_memory")) {
+    reason = "--plan_activation_memory is set";
+  }
+  if (deterministic_mode()) {
+    reason = "LBANN is running in deterministic mode";
+  }
+  for (El::Int i = 0; reason.empty() && i < num_layers; ++i) {
+    const auto& l = get_layer(i);
+    if (l.get_device_allocation() != El::Device::CPU) {
+      reason = ("layer \"" + l.get_name() + "\" is not on CPU "
+                "and GPU layers share a CUDA stream");
+    }
+  }
+
+  // Construct dependency graph
+  // Note: Layers that share weights update the same optimizer, and
+  // input layers share the data coordinator, so they keep their
+  // order in sequential execution.
+  std::set<El::Int> nodes;
+  std::map<El::Int,std::set<El::Int>> edges;
+  std::unordered_map<const Layer*,El::Int> layer_indices;
+  for (El::Int node = 0; node < num_layers; ++node) {
+    nodes.insert(node);
+    layer_indices[&get_layer(node)] = node;
+  }
+  std::unordered_map<const weights*,El::Int> last_weights_users;
+  El::Int last_input_layer = -1;
+  for (El::Int node = 0; node < num_layers; ++node) {
+    auto& l = get_layer(node);
+    for (const auto& child : l.get_child_layers()) {
+      edges[node].insert(layer_indices[child]);
+    }
+    for (const auto* w : l.get_weights()) {
+      auto it = last_weights_users.find(w);
+      if (it != last_weights_users.end() && it->second != node) {
+        edges[it->second].insert(node);
+      }
+      last_weights_users[w] = node;
+    }
+    if (dynamic_cast<generic_input_layer<DataType>*>(&l) != nullptr) {
+      if (last_input_layer >= 0) { edges[last_input_layer].insert(node); }
+      last_input_layer = node;
+    }
+  }
+  if (!graph::is_topologically_sorted(nodes, edges)) {
+    LBANN_ERROR("layers in model \"", get_name(), "\" are not in "
+                "topological order");
+  }
+
+  // Find number of independent branches
+  // Note: Layers are grouped by their depth in the graph.
+  std::vector<El::Int> depths(num_layers, 0);
+  std::map<El::Int,El::Int> depth_counts;
+  for (El::Int node = 0; node < num_layers; ++node) {
+    for (const auto& neighbor : graph::get_neighbors(node, edges)) {
+      depths[neighbor] = std::max(depths[neighbor], depths[node] + 1);
+    }
+    ++depth_counts[depths[node]];
+  }
+  El::Int max_width = 0;
+  for (const auto& count : depth_counts) {
+    max_width = std::max(max_width, count.second);
+  }
+  if (reason.empty() && max_width <= 1) {
+    reason = "the layer graph has no independent branches";
+  }
+  if (!reason.empty()) {
+    if (m_comm->am_trainer_master()) {
+      std::cout << "model \"" << get_name() << "\" runs layers "
+                << "sequentially since " << reason << std::endl;
+    }
+    return;
+  }
+
+  // Launch worker threads
+  const int max_threads = std::max(int(std::thread::hardware_concurrency()), 1);
+  const int num_workers = std::min(int(max_width), max_threads);
+  m_parallel_execution = make_unique<parallel_execution_state>();
+  auto& state = *m_parallel_execution;
+  state.fp_edges = edges;
+  state.bp_edges = graph::transpose(nodes, edges);
+  state.omp_threads = std::max(omp_get_max_threads() / num_workers, 1);
+  state.seed = get_generator()();
+  state.pool.launch_threads(num_workers);
+  if (m_comm->am_trainer_master()) {
+    std::cout << "model \"" << get_name() << "\" runs up to "
+              << max_width << " independent layers concurrently on "
+              << num_workers << " threads "
+              << "(" << state.omp_threads << " OpenMP threads each)"
+              << std::endl;
+  }
+
+}
+
+namespace {
+/** @brief Executor whose settings the current thread uses. */
+thread_local const void* initialized_worker_state = nullptr;
+} // namespace
+
+void model::run_layers_concurrently(
+  const std::map<El::Int,std::set<El::Int>>& edges,
+  bool reverse_order,
+  const std::function<void(Layer&)>& func) {
+  auto& state = *m_parallel_execution;
+  const El::Int num_layers = get_num_layers();
+
+  // Count the layers each layer waits for
+  std::vector<El::Int> num_dependencies(num_layers, 0);
+  for (const auto& e : edges) {
+    for (const auto& node : e.second) {
+      ++num_dependencies[node];
+    }
+  }
+  std::set<El::Int> ready;
+  for (El::Int node = 0; node < num_layers; ++node) {
+    if (num_dependencies[node] == 0) { ready.insert(node); }
+  }
+
+  // Dispatch ready layers until all have finished
+  // Note: Workers report back under the mutex, so the condition
+  // variable can not miss a notification. If a layer throws, no more
+  // layers are dispatched and the exception is rethrown once the
+  // running layers have finished.
+  std::mutex mutex;
+  std::condition_variable cv;
+  El::Int num_running = 0, num_finished = 0;
+  std::exception_ptr error;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (num_finished < num_layers) {
+    while (!ready.empty() && !error) {
+      const auto it = reverse_order ? std::prev(ready.end()) : ready.begin();
+      const El::Int node = *it;
+      ready.erase(it);
+      ++num_running;
+      state.pool.submit_job(
+        [this, &state, &edges, &func, &mutex, &cv, &num_dependencies,
+         &ready, &num_running, &num_finished, &error, node] () {
+
+          // Seed random number generators and split OpenMP threads
+          // the first time a worker runs a layer
+          if (initialized_worker_state != &state) {
+            const int worker = state.num_initialized_workers++;
+            get_generator().seed(hash_combine(state.seed, worker));
+            get_fast_generator().seed(hash_combine(state.seed, worker));
+            omp_set_num_threads(state.omp_threads);
+            initialized_worker_state = &state;
+          }
+
+          std::exception_ptr layer_error;
+          try {
+            func(get_layer(node));
+          } catch (...) {
+            layer_error = std::current_exception();
+          }
+
+          std::lock_guard<std::mutex> guard(mutex);
+          --num_running;
+          ++num_finished;
+          if (layer_error) {
+            if (!error) { error = layer_error; }
+          } else {
+            auto e = edges.find(node);
+            if (e != edges.end()) {
+              for (const auto& next : e->second) {
+                if (--num_dependencies[next] == 0) { ready.insert(next); }
+              }
+            }
+          }
+          cv.notify_one();
+        });
+    }
+    if (error && num_running == 0) { break; }
+    cv.wait(lock);
+  }
+  if (error) { std::rethrow_exception(error); }
+
+}
+
+bool model::using_training_graph() {
+#ifndef LBANN_HAS_GPU
+  return false;
+#else
+  auto& state = m_training_graph;
+  if (state.checked) { return state.enabled; }
+  state.checked = true;
+  if (!options::get()->get_bool("cuda_graph_training_step")) {
+    return false;
+  }
+
+  // Layers without parents at the start of the execution order run
+  // eagerly, so input layers can fetch data on the host
+  const El::Int num_layers = get_num_layers();
+  El::Int num_eager = 0;
+  while (num_eager < num_layers
+         && get_layer(num_eager).get_num_parents() == 0) {
+    ++num_eager;
+  }
+
+  // Check if the rest of the step can be captured
+  std::string reason;
+  if (!m_recompute_segments.empty()) {
+    reason = "activations are recomputed in backprop";
+  } else if (options::get()->get_bool("overlap_weight_updates")) {
+    reason = "--overlap_weight_updates is set";
+  } else if (options::get()->get_bool("pipelined_weight_updates")) {
+    reason = "--pipelined_weight_updates is set";
+  } else if (m_objective_function->using_loss_scaling()) {
+    reason = "the loss scale changes between steps";
+  } else if (num_eager == num_layers) {
+    reason = "every layer must run eagerly";
+  }
+  for (El::Int i = num_eager; reason.empty() && i < num_layers; ++i) {
+    const auto& l = get_layer(i);
+    if (l.get_device_allocation() != El::Device::GPU) {
+      reason = "layer \"" + l.get_name() + "\" is not on GPU";
+    } else if (!l.supports_cuda_graph()) {
+      reason = ("layer \"" + l.get_name() + "\" "
+                "(" + l.get_type() + ") does not support CUDA graphs");
+    }
+#ifdef LBANN_HAS_DISTCONV
+    else if (l.distconv_enabled()) {
+      reason = "layer \"" + l.get_name() + "\" uses distconv";
+    }
+#endif // LBANN_HAS_DISTCONV
+  }
+  if (!reason.empty()) {
+    if (m_comm->am_trainer_master()) {
+      std::cout << "model \"" << get_name() << "\" can not use a "
+                << "CUDA graph for training steps since "
+                << reason << std::endl;
+    }
+    return false;
+  }
+
+  // Error signals must stay in the same buffers between steps
+  for (El::Int i = num_eager; i < num_layers; ++i) {
+    get_layer(i).set_keep_error_signals(true);
+  }
+  state.enabled = true;
+  state.num_eager_layers = num_eager;
+  state.warmup_steps = (options::get()->has_int("cuda_graph_warmup")
+                        ? options::get()->get_int("cuda_graph_warmup")
+                        : 2);
+  state.mini_batch_size = 0;
+  if (m_comm->am_trainer_master()) {
+    std::cout << "model \"" << get_name() << "\" replays "
+              << num_layers - num_eager << " of " << num_layers
+              << " layers from a CUDA graph in training steps"
+              << std::endl;
+  }
+  return true;
+#endif // LBANN_HAS_GPU
+}
+
+void model::forward_backward_prop_graph_layers() {
+  const auto mode = execution_mode::training;
+  const El::Int num_layers = get_num_layers();
+#ifdef LBANN_HAS_GPU
+  const El::Int num_eager = m_training_graph.num_eager_layers;
+#else
+  const El::Int num_eager = 0;
+#endif // LBANN_HAS_GPU
+  for (El::Int i = num_eager; i < num_layers; ++i) {
     auto& l = get_layer(i);
+    do_layer_forward_prop_begin_cbs(mode, &l);
+    l.forward_prop();
+    do_layer_forward_prop_end_cbs(mode, &l);
+  }
+  for (El::Int i = num_layers-1; i >= num_eager; --i) {
+    auto& l = get_layer(i);
+    if (!l.needs_backprop()) { continue; }
     do_layer_backward_prop_begin_cbs(&l);
     l.back_prop();
     do_layer_backward_prop_end_cbs(&l);
+  }
+}
 
-    // Terminate early if all gradients have been computed
-    bool all_gradients_computed = true;
-    for (auto&& w : m_weights) {
-      auto&& opt = w->get_optimizer();
-      if (opt != nullptr && opt->get_num_gradient_sources() != 0) {
-        all_gradients_computed = false;
-        break;
+void model::forward_backward_prop_with_graph() {
+#ifndef LBANN_HAS_GPU
+  LBANN_ERROR("CUDA graphs require a GPU build");
+#else
+  auto& state = m_training_graph;
+  if (!state.enabled) {
+    LBANN_ERROR("model \"", get_name(), "\" can not use a CUDA graph "
+                "for training steps");
+  }
+  const auto mode = execution_mode::training;
+  const El::Int num_eager = state.num_eager_layers;
+
+  // Forward prop on eager layers
+  // Note: Input layers set the mini-batch size.
+  do_model_forward_prop_begin_cbs(mode);
+  for (El::Int i = 0; i < num_eager; ++i) {
+    auto& l = get_layer(i);
+    do_layer_forward_prop_begin_cbs(mode, &l);
+    l.forward_prop();
+    do_layer_forward_prop_end_cbs(mode, &l);
+  }
+  const auto& c = static_cast<sgd_execution_context&>(get_execution_context());
+  const El::Int mini_batch_size = c.get_current_mini_batch_size();
+  update_backprop_layers();
+
+  // Keep gradient allreduces out of the graph
+  for (auto&& w : m_weights) {
+    auto* opt = w->get_optimizer();
+    if (opt != nullptr) { opt->set_gradient_allreduce_deferred(true); }
+  }
+
+  if (state.mini_batch_size == mini_batch_size) {
+    // Replay graph and restore the optimizers' host-side state
+    // Note: The replayed evaluation layers have new local values.
+    state.graph.launch();
+    for (const auto& s : state.gradient_status) {
+      s.first->restore_gradient_status(s.second);
+    }
+    for (El::Int i = num_eager; i < get_num_layers(); ++i) {
+      auto* value = dynamic_cast<evaluation_partial_value*>(&get_layer(i));
+      if (value != nullptr) { value->mark_partial(); }
+    }
+  } else if (state.warmup_steps > 0) {
+    --state.warmup_steps;
+    forward_backward_prop_graph_layers();
+  } else {
+    // Capture graph
+    // Note: Captured work is not executed, so the graph is launched
+    // once it is instantiated.
+    state.mini_batch_size = 0;
+    state.gradient_status.clear();
+    std::exception_ptr error;
+    state.graph.begin_capture(El::GPUManager::Stream());
+    try {
+      forward_backward_prop_graph_layers();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    const bool captured = state.graph.end_capture();
+    if (error && captured) {
+      state.graph.reset();
+      std::rethrow_exception(error);
+    }
+    if (captured) {
+      state.graph.launch();
+      state.mini_batch_size = mini_batch_size;
+      for (auto&& w : m_weights) {
+        auto* opt = w->get_optimizer();
+        if (opt != nullptr) {
+          state.gradient_status.emplace_back(opt, opt->get_gradient_status());
+        }
+      }
+    } else {
+      // The capture was invalidated (e.g. by a host
+      // synchronization), so redo the step eagerly without the graph
+      if (m_comm->am_trainer_master()) {
+        std::cout << "model \"" << get_name() << "\" failed to "
+                  << "capture a CUDA graph of the training step, "
+                  << "so it will run eagerly" << std::endl;
       }
+      state.enabled = false;
+      for (auto&& w : m_weights) {
+        auto* opt = w->get_optimizer();
+        if (opt != nullptr) { opt->clear_gradient(); }
+      }
+      for (El::Int i = 0; i < num_eager; ++i) {
+        auto& l = get_layer(i);
+        for (auto* w : l.get_weights()) {
+          auto* opt = w->get_optimizer();
+          if (opt != nullptr) { opt->add_gradient_source(&l); }
+        }
+      }
+      forward_backward_prop_graph_layers();
     }
-    if (all_gradients_computed) { break; }
+  }
+  do_model_forward_prop_end_cbs(mode);
 
+  // Backprop on eager layers
+  do_model_backward_prop_begin_cbs();
+  for (El::Int i = num_eager-1; i >= 0; --i) {
+    auto& l = get_layer(i);
+    if (!l.needs_backprop()) { continue; }
+    do_layer_backward_prop_begin_cbs(&l);
+    l.back_prop();
+    do_layer_backward_prop_end_cbs(&l);
   }
+
+  // Launch gradient allreduces
+  set_gradient_allreduces_deferred(m_gradient_allreduces_deferred);
+  launch_gradient_buckets(*m_comm);
   do_model_backward_prop_end_cbs();
+
+#endif // LBANN_HAS_GPU
 }
 
 void model::update_weights() {
   do_model_optimize_begin_cbs();
 
+  // Remove the loss scale from the gradients and skip the step if
+  // they overflowed
+  // Note: This waits for all gradient allreduces, so it is not
+  // overlapped with forward prop by --overlap_weight_updates.
+  if (m_objective_function->using_loss_scaling()
+      && !m_objective_function->unscale_gradients(*this)) {
+    if (m_comm->am_trainer_master()) {
+      std::cout << "model \"" << get_name() << "\" skipped an "
+                << "optimization step due to nonfinite gradients; "
+                << "loss scale is now "
+                << m_objective_function->get_loss_scale() << std::endl;
+    }
+    clear_gradients();
+    do_model_optimize_end_cbs();
+    return;
+  }
+
+  // Defer optimization steps to the next forward prop
+  if (options::get()->get_bool("overlap_weight_updates")) {
+    for (auto&& w : m_weights) {
+      if (w->get_optimizer() != nullptr) {
+        m_pending_weight_updates.insert(w.get());
+      }
+    }
+    do_model_optimize_end_cbs();
+    return;
+  }
+  if (options::get()->get_bool("pipelined_weight_updates")) {
+    pipeline_weight_updates();
+    do_model_optimize_end_cbs();
+    return;
+  }
+
   // Apply optimization step to weights
   // Note: Heuristically, forward prop consumes weights in the same
   // order as m_weights and backprop computes weights gradients in
@@ -1035,19 +2821,125 @@ void model::update_weights() {
   // after a weights gradient has been computed. Thus, iterating in
   // reverse order will use gradients that have already finished their
   // allreduce, giving more time for more recent allreduces to finish.
+  // Note: With --fused_optimizer_step, GPU steps are only queued by
+  // the optimizers, so the weight callbacks that follow a step are
+  // deferred until the queue has been flushed.
+  const bool fused = use_fused_optimizer_step();
   for (auto rit = m_weights.rbegin(); rit != m_weights.rend(); ++rit) {
     auto& w = **rit;
     auto&& opt = w.get_optimizer();
     if (opt != nullptr) {
       do_weight_optimize_begin_cbs(&w);
-      opt->step();
-      do_weight_optimize_end_cbs(&w);
+      {
+        telemetry::scope telemetry_scope(telemetry::category::optimizer,
+                                         w.get_name(), w.get_telemetry_region());
+        comm_profile::context comm_context(w.get_name());
+        opt->step();
+      }
+      if (!fused) { do_weight_optimize_end_cbs(&w); }
+    }
+  }
+  if (fused) {
+    flush_fused_optimizer_steps();
+    for (auto rit = m_weights.rbegin(); rit != m_weights.rend(); ++rit) {
+      if ((*rit)->get_optimizer() != nullptr) {
+        do_weight_optimize_end_cbs(rit->get());
+      }
     }
   }
 
   do_model_optimize_end_cbs();
 }
 
+void model::apply_pending_weight_updates() {
+  // Same order as update_weights
+  for (auto rit = m_weights.rbegin();
+       rit != m_weights.rend() && has_pending_weight_updates();
+       ++rit) {
+    apply_pending_weight_update(**rit);
+  }
+}
+
+bool model::has_pending_weight_updates() const {
+#ifdef LBANN_HAS_GPU
+  if (!m_weight_update_pipeline.in_flight.empty()) { return true; }
+#endif // LBANN_HAS_GPU
+  return !m_pending_weight_updates.empty();
+}
+
+namespace {
+#ifdef LBANN_HAS_GPU
+/** @brief Stream for pipelined optimization steps.
+ *  @details Shared by all models and never destroyed, like
+ *  Hydrogen's stream.
+ */
+cudaStream_t get_weight_update_stream() {
+  static cudaStream_t stream = [] {
+    cudaStream_t s;
+    CHECK_CUDA(cudaStreamCreateWithFlags(&s, cudaStreamNonBlocking));
+    return s;
+  }();
+  return stream;
+}
+#endif // LBANN_HAS_GPU
+} // namespace
+
+void model::pipeline_weight_updates() {
+#ifndef LBANN_HAS_GPU
+  LBANN_ERROR("--pipelined_weight_updates requires GPU support");
+#else
+  // Forward order, so the steps that the next forward prop needs
+  // first are launched first
+  // Note: Optimizers whose steps are not fused run on the main
+  // stream as usual.
+  auto& pipeline = m_weight_update_pipeline;
+  auto&& main_stream = El::GPUManager::Stream();
+  const auto side_stream = get_weight_update_stream();
+  for (auto&& w_ptr : m_weights) {
+    auto& w = *w_ptr;
+    auto&& opt = w.get_optimizer();
+    if (opt == nullptr) { continue; }
+    do_weight_optimize_begin_cbs(&w);
+    {
+      telemetry::scope telemetry_scope(telemetry::category::optimizer,
+                                       w.get_name(), w.get_telemetry_region());
+      comm_profile::context comm_context(w.get_name());
+      opt->step();
+    }
+    // The step waited for the gradient allreduce on the main stream
+    pipeline.gradient_ready.record(main_stream);
+    CHECK_CUDA(cudaStreamWaitEvent(side_stream,
+                                   pipeline.gradient_ready.get_event(), 0));
+    flush_fused_optimizer_steps(side_stream);
+    pipeline.step_done[&w].record(side_stream);
+    pipeline.in_flight.insert(&w);
+  }
+#endif // LBANN_HAS_GPU
+}
+
+void model::apply_pending_weight_update(weights& w) {
+#ifdef LBANN_HAS_GPU
+  auto& pipeline = m_weight_update_pipeline;
+  if (pipeline.in_flight.erase(&w) > 0) {
+    CHECK_CUDA(cudaStreamWaitEvent(El::GPUManager::Stream(),
+                                   pipeline.step_done[&w].get_event(), 0));
+    do_weight_optimize_end_cbs(&w);
+  }
+#endif // LBANN_HAS_GPU
+  if (m_pending_weight_updates.erase(&w) == 0) { return; }
+  auto&& opt = w.get_optimizer();
+  do_weight_optimize_begin_cbs(&w);
+  {
+    telemetry::scope telemetry_scope(telemetry::category::optimizer,
+                                     w.get_name(), w.get_telemetry_region());
+    comm_profile::context comm_context(w.get_name());
+    opt->step();
+  }
+  flush_fused_optimizer_steps();
+  do_weight_optimize_end_cbs(&w);
+  opt->clear_gradient();
+}
+
 bool model::update_layers() {
   bool finished = true;
   for (El::Int i = get_num_layers()-1; i >= 0; --i) {
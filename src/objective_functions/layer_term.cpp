@@ -67,6 +67,7 @@ void layer_term::setup(model& m) {
   objective_function_term::setup(m);
   auto& eval = dynamic_cast<abstract_evaluation_layer<DataType>&>(get_evaluation_layer());
   eval.set_scale(m_scale_factor);
+  eval.set_value_read_every_step();
   //get_evaluation_layer().set_scale(m_scale_factor);
 }
 
@@ -81,7 +82,7 @@ EvalType layer_term::finish_evaluation() {
 
 void layer_term::differentiate() {
   auto& eval = dynamic_cast<abstract_evaluation_layer<DataType>&>(get_evaluation_layer());
-  eval.set_scale(m_scale_factor);
+  eval.set_scale(m_scale_factor * m_loss_scale);
   // get_evaluation_layer().set_scale(m_scale_factor);
 }
 
@@ -25,6 +25,8 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lbann/objective_functions/objective_function.hpp"
+#include "lbann/models/model.hpp"
+#include "lbann/optimizers/gradient_unscaling.hpp"
 #include "lbann/utils/timer.hpp"
 #include "lbann/utils/profiling.hpp"
 #include <numeric>
@@ -34,7 +36,14 @@ namespace lbann {
 objective_function::objective_function(const objective_function& other)
   : m_statistics(other.m_statistics),
     m_evaluation_time(other.m_evaluation_time),
-    m_differentiation_time(other.m_differentiation_time) {
+    m_differentiation_time(other.m_differentiation_time),
+    m_loss_scale(other.m_loss_scale),
+    m_dynamic_loss_scaling(other.m_dynamic_loss_scaling),
+    m_loss_scale_growth_factor(other.m_loss_scale_growth_factor),
+    m_loss_scale_backoff_factor(other.m_loss_scale_backoff_factor),
+    m_loss_scale_growth_interval(other.m_loss_scale_growth_interval),
+    m_num_good_steps(other.m_num_good_steps),
+    m_num_skipped_steps(other.m_num_skipped_steps) {
   m_terms = other.m_terms;
   for (auto& term : m_terms) {
     term = term->copy();
@@ -52,6 +61,13 @@ objective_function& objective_function::operator=(const objective_function& othe
   m_statistics = other.m_statistics;
   m_evaluation_time = other.m_evaluation_time;
   m_differentiation_time = other.m_differentiation_time;
+  m_loss_scale = other.m_loss_scale;
+  m_dynamic_loss_scaling = other.m_dynamic_loss_scaling;
+  m_loss_scale_growth_factor = other.m_loss_scale_growth_factor;
+  m_loss_scale_backoff_factor = other.m_loss_scale_backoff_factor;
+  m_loss_scale_growth_interval = other.m_loss_scale_growth_interval;
+  m_num_good_steps = other.m_num_good_steps;
+  m_num_skipped_steps = other.m_num_skipped_steps;
   return *this;
 }
 
@@ -103,11 +119,12 @@ EvalType objective_function::finish_evaluation(execution_mode mode,
   return value;
 }
 
-void objective_function::differentiate() {
+void objective_function::differentiate(EvalType scale) {
   const auto start_time = get_time();
   prof_region_begin("obj-differentiate", prof_colors[0], false);
   for (const auto& term : m_terms) {
     prof_region_begin(("obj-differentiate-" + term->name()).c_str(), prof_colors[1], false);
+    term->set_loss_scale(m_loss_scale * scale);
     term->differentiate();
     prof_region_end(("obj-differentiate-" + term->name()).c_str(), false);
   }
@@ -120,6 +137,7 @@ void objective_function::compute_weight_regularization() {
   prof_region_begin("obj-weight-regularization", prof_colors[0], false);
   for (const auto& term : m_terms) {
     prof_region_begin(("obj-weight-regularization-" + term->name()).c_str(), prof_colors[1], false);
+    term->set_loss_scale(m_loss_scale);
     term->compute_weight_regularization();
     prof_region_end(("obj-weight-regularization-" + term->name()).c_str(), false);
   }
@@ -127,6 +145,60 @@ void objective_function::compute_weight_regularization() {
   m_differentiation_time += get_time() - start_time;
 }
 
+void objective_function::set_loss_scale(EvalType scale) {
+  if (!(scale > EvalType(0))) {
+    LBANN_ERROR("attempted to set loss scale to ", scale, ", "
+                "but it must be positive");
+  }
+  m_loss_scale = scale;
+}
+
+void objective_function::set_dynamic_loss_scaling(EvalType growth_factor,
+                                                  EvalType backoff_factor,
+                                                  El::Int growth_interval) {
+  if (growth_factor < EvalType(1)
+      || backoff_factor <= EvalType(0) || backoff_factor >= EvalType(1)
+      || growth_interval < 1) {
+    LBANN_ERROR("invalid dynamic loss scaling parameters "
+                "(growth factor ", growth_factor, ", "
+                "backoff factor ", backoff_factor, ", "
+                "growth interval ", growth_interval, ")");
+  }
+  m_dynamic_loss_scaling = true;
+  m_loss_scale_growth_factor = growth_factor;
+  m_loss_scale_backoff_factor = backoff_factor;
+  m_loss_scale_growth_interval = growth_interval;
+  m_num_good_steps = 0;
+}
+
+bool objective_function::unscale_gradients(model& m) {
+  const auto start_time = get_time();
+  prof_region_begin("obj-unscale-gradients", prof_colors[0], false);
+  for (auto* w : m.get_weights()) {
+    auto* opt = w->get_optimizer();
+    if (opt != nullptr) { opt->enqueue_gradient_unscaling(); }
+  }
+  int finite = flush_gradient_unscaling(EvalType(1) / m_loss_scale);
+
+  // Weights may be distributed, so all ranks must agree to skip
+  finite = m.get_comm()->trainer_allreduce(finite, El::mpi::MIN);
+  if (!finite) {
+    ++m_num_skipped_steps;
+  }
+  if (m_dynamic_loss_scaling) {
+    if (!finite) {
+      m_loss_scale *= m_loss_scale_backoff_factor;
+      m_num_good_steps = 0;
+    } else if (++m_num_good_steps == m_loss_scale_growth_interval) {
+      m_loss_scale *= m_loss_scale_growth_factor;
+      m_num_good_steps = 0;
+    }
+  }
+  prof_region_end("obj-unscale-gradients", false);
+  m_differentiation_time += get_time() - start_time;
+  return finite;
+}
+
 EvalType objective_function::get_mean_value(execution_mode mode) const {
   if (m_statistics.count(mode) == 0
       || m_statistics.at(mode).get_num_samples() == 0) {
@@ -32,6 +32,8 @@
 #include "lbann/optimizers/data_type_optimizer.hpp"
 #include "lbann/weights/data_type_weights.hpp"
 
+#include <algorithm>
+
 namespace lbann {
 
 template <>
@@ -63,6 +65,13 @@ void l2_weight_regularization::accumulate_contribution<El::Device::CPU>(const CP
 l2_weight_regularization::l2_weight_regularization(EvalType scale_factor)
   : objective_function_term(scale_factor) {}
 
+l2_weight_regularization::l2_weight_regularization(EvalType scale_factor,
+                                                   bool decoupled,
+                                                   El::Int evaluation_interval)
+  : objective_function_term(scale_factor),
+    m_decoupled(decoupled),
+    m_evaluation_interval(std::max(evaluation_interval, El::Int(1))) {}
+
 void l2_weight_regularization::setup(model& m) {
   objective_function_term::setup(m);
 
@@ -78,6 +87,11 @@ void l2_weight_regularization::setup(model& m) {
 
   // Construct accumulation variables for each device
   for (auto* w : m_weights) {
+    if (dynamic_cast<WeightsType*>(w) == nullptr) {
+      LBANN_ERROR("L2 weight regularization does not support weights "
+                  "\"", w->get_name(), "\" since their data type "
+                  "is not the default data type");
+    }
     const auto& device = dynamic_cast<WeightsType*>(w)->get_values().GetLocalDevice();
     if (m_contributions.count(device) == 0) {
 #ifdef LBANN_HAS_GPU
@@ -87,10 +101,23 @@ void l2_weight_regularization::setup(model& m) {
     }
   }
 
+  // Hand the term to the optimizers as a decoupled weight decay
+  if (m_decoupled && m_scale_factor != EvalType(0)) {
+    for (auto* w : m_weights) {
+      auto* opt = dynamic_cast<OptimizerType*>(w->get_optimizer());
+      if (opt != nullptr) {
+        opt->set_weight_decay(opt->get_weight_decay()
+                              + DataType(m_scale_factor));
+      }
+    }
+  }
+
 }
 
 void l2_weight_regularization::start_evaluation() {
   if (m_scale_factor == EvalType(0)) { return; }
+  m_evaluating = (m_evaluation_count++ % m_evaluation_interval == 0);
+  if (!m_evaluating) { return; }
   const El::Int num_weights = m_weights.size();
 
   // Compute contributions from CPU weights
@@ -146,6 +173,7 @@ void l2_weight_regularization::start_evaluation() {
 
 EvalType l2_weight_regularization::finish_evaluation() {
   if (m_scale_factor == EvalType(0)) { return EvalType(0); }
+  if (!m_evaluating) { return m_last_value; }
   EvalType sqsum = 0;
   if (m_contributions.count(El::Device::CPU) > 0) {
     get_comm().wait(m_allreduce_req);
@@ -157,15 +185,17 @@ EvalType l2_weight_regularization::finish_evaluation() {
     sqsum += m_contributions[El::Device::GPU](0, 0);
   }
 #endif // LBANN_HAS_GPU
-  return m_scale_factor * sqsum / 2;
+  m_last_value = m_scale_factor * sqsum / 2;
+  return m_last_value;
 }
 
 void l2_weight_regularization::compute_weight_regularization() {
-  if (m_scale_factor == EvalType(0)) { return; }
+  if (m_scale_factor == EvalType(0) || m_decoupled) { return; }
   for (auto&& w : m_weights) {
     auto&& opt = dynamic_cast<OptimizerType*>(w->get_optimizer());
     if (opt != nullptr) {
-      opt->add_to_gradient(dynamic_cast<WeightsType*>(w)->get_values(), m_scale_factor);
+      opt->add_to_gradient(dynamic_cast<WeightsType*>(w)->get_values(),
+                           m_scale_factor * m_loss_scale);
     }
   }
 }
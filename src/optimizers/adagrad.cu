@@ -25,6 +25,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lbann/optimizers/adagrad.hpp"
+#include "lbann/optimizers/fused_step.hpp"
 
 namespace lbann {
 
@@ -62,7 +63,17 @@ void adagrad<TensorDataType>::step_compute_gpu(AbsDistMatrixType& values,
   const size_t local_height = values.LocalHeight();
   const size_t local_width = values.LocalWidth();
   const size_t local_size = local_height * local_width;
-  if (local_size > 0) {
+  if (local_size > 0
+      && use_fused_optimizer_step()
+      && values.Contiguous() && gradient.Contiguous()
+      && m_cache->Contiguous()) {
+    fused_step_queue<TensorDataType>::enqueue(
+      fused_step_kind::adagrad,
+      {values.Buffer(), gradient.LockedBuffer(),
+       m_cache->Buffer(), nullptr, local_size,
+       this->get_learning_rate(), TensorDataType(0), TensorDataType(0), m_eps,
+       TensorDataType(0)});
+  } else if (local_size > 0) {
     constexpr size_t block_size = 256;
     const size_t grid_size = (local_size + block_size - 1) / block_size;
     auto&& stream = El::GPUManager::Stream();
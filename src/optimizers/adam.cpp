@@ -140,6 +140,7 @@ void adam<TensorDataType>::step_compute_cpu(AbsDistMatrixType& values,
                                             const AbsDistMatrixType& gradient,
                                             const TensorDataType& correction) {
   static const auto one = TensorDataType(1.);
+  const auto decay = this->get_learning_rate() * this->get_weight_decay();
 
   // Get local matrix data
   const size_t local_height = values.LocalHeight();
@@ -162,7 +163,7 @@ void adam<TensorDataType>::step_compute_cpu(AbsDistMatrixType& values,
       auto& m2 = moment2_buffer[i];
       m1 = m_beta1 * m1 + (one - m_beta1) * g;
       m2 = m_beta2 * m2 + (one - m_beta2) * g * g;
-      x -= correction * m1 / (El::Sqrt(m2) + m_eps);
+      x -= correction * m1 / (El::Sqrt(m2) + m_eps) + decay * x;
     }
 
   } else {
@@ -181,7 +182,7 @@ void adam<TensorDataType>::step_compute_cpu(AbsDistMatrixType& values,
         auto& m2 = moment2_buffer[row+col*moment2_ldim];
         m1 = m_beta1 * m1 + (one - m_beta1) * g;
         m2 = m_beta2 * m2 + (one - m_beta2) * g * g;
-        x -= correction * m1 / (El::Sqrt(m2) + m_eps);
+        x -= correction * m1 / (El::Sqrt(m2) + m_eps) + decay * x;
       }
     }
 
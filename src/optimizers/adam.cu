@@ -25,6 +25,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lbann/optimizers/adam.hpp"
+#include "lbann/optimizers/fused_step.hpp"
 
 namespace lbann {
 
@@ -37,6 +38,7 @@ __global__ void adam_noncontiguous_kernel(size_t height,
                                           TensorDataType eps,
                                           TensorDataType beta1,
                                           TensorDataType beta2,
+                                          TensorDataType decay,
                                           TensorDataType * __restrict__ values,
                                           size_t values_ldim,
                                           const TensorDataType * __restrict__ gradient,
@@ -55,7 +57,7 @@ __global__ void adam_noncontiguous_kernel(size_t height,
     auto& x = values[row + col * values_ldim];
     m1 = beta1 * m1 + (TensorDataType(1) - beta1) * g;
     m2 = beta2 * m2 + (TensorDataType(1) - beta2) * g * g;
-    x -= correction * m1 / (cuda::sqrt(m2) + eps);
+    x -= correction * m1 / (cuda::sqrt(m2) + eps) + decay * x;
   }
 }
 
@@ -65,6 +67,7 @@ __global__ void adam_contiguous_kernel(size_t size,
                                        TensorDataType eps,
                                        TensorDataType beta1,
                                        TensorDataType beta2,
+                                       TensorDataType decay,
                                        TensorDataType * __restrict__ values,
                                        const TensorDataType * __restrict__ gradient,
                                        TensorDataType * __restrict__ moment1,
@@ -77,7 +80,7 @@ __global__ void adam_contiguous_kernel(size_t size,
     auto& x = values[gid];
     m1 = beta1 * m1 + (TensorDataType(1) - beta1) * g;
     m2 = beta2 * m2 + (TensorDataType(1) - beta2) * g * g;
-    x -= correction * m1 / (cuda::sqrt(m2) + eps);
+    x -= correction * m1 / (cuda::sqrt(m2) + eps) + decay * x;
   }
 }
 
@@ -93,6 +96,20 @@ void adam<TensorDataType>::step_compute_gpu(AbsDistMatrixType& values,
   const size_t local_size = local_height * local_width;
   if (local_size <= 0) { return; }
 
+  const auto decay = this->get_learning_rate() * this->get_weight_decay();
+
+  // Defer to a fused kernel if possible
+  if (use_fused_optimizer_step()
+      && values.Contiguous() && gradient.Contiguous()
+      && m_moment1->Contiguous() && m_moment2->Contiguous()) {
+    fused_step_queue<TensorDataType>::enqueue(
+      fused_step_kind::adam,
+      {values.Buffer(), gradient.LockedBuffer(),
+       m_moment1->Buffer(), m_moment2->Buffer(), local_size,
+       correction, m_beta1, m_beta2, m_eps, decay});
+    return;
+  }
+
   // Launch CUDA kernel
   constexpr size_t block_size = 256;
   const size_t grid_size = (local_size + block_size - 1) / block_size;
@@ -100,12 +117,12 @@ void adam<TensorDataType>::step_compute_gpu(AbsDistMatrixType& values,
   if (values.Contiguous() && gradient.Contiguous()
       && m_moment1->Contiguous() && m_moment2->Contiguous()) {
     adam_contiguous_kernel<TensorDataType><<<grid_size, block_size, 0, stream>>>(
-      local_size, correction, m_eps, m_beta1, m_beta2,
+      local_size, correction, m_eps, m_beta1, m_beta2, decay,
       values.Buffer(), gradient.LockedBuffer(),
       m_moment1->Buffer(), m_moment2->Buffer());
   } else {
     adam_noncontiguous_kernel<TensorDataType><<<grid_size, block_size, 0, stream>>>(
-      local_height, local_width, correction, m_eps, m_beta1, m_beta2,
+      local_height, local_width, correction, m_eps, m_beta1, m_beta2, decay,
       values.Buffer(), values.LDim(),
       gradient.LockedBuffer(), gradient.LDim(),
       m_moment1->Buffer(), m_moment1->LDim(),
@@ -29,9 +29,124 @@
 #include "lbann/weights/data_type_weights.hpp"
 #include "lbann/utils/timer.hpp"
 #include "lbann/io/persist.hpp"
+#include "lbann/utils/options.hpp"
+#include "lbann/utils/memory.hpp"
+#include "lbann/utils/memory_usage.hpp"
+#include "lbann/optimizers/fused_step.hpp"
+#include "lbann/optimizers/gradient_unscaling.hpp"
 
 namespace lbann {
 
+namespace {
+
+/** @brief Sum of squares of a local matrix, accumulated on the host. */
+template <typename TensorDataType>
+double local_squared_norm(const El::AbstractMatrix<TensorDataType>& x) {
+  using CPUMatrixType = El::Matrix<TensorDataType, El::Device::CPU>;
+  CPUMatrixType x_cpu;
+  if (x.GetDevice() == El::Device::CPU) {
+    El::LockedView(x_cpu, static_cast<const CPUMatrixType&>(x));
+  } else {
+    El::Copy(x, x_cpu);
+  }
+  double sum = 0;
+  for (El::Int j = 0; j < x_cpu.Width(); ++j) {
+    for (El::Int i = 0; i < x_cpu.Height(); ++i) {
+      const auto v = static_cast<double>(x_cpu.CRef(i, j));
+      sum += v * v;
+    }
+  }
+  return sum;
+}
+
+/** @brief Copy a contiguous range between local matrices. */
+template <typename TensorDataType, El::Device Device>
+void copy_range(const El::AbstractMatrix<TensorDataType>& src,
+                El::Int src_offset,
+                El::AbstractMatrix<TensorDataType>& dst,
+                El::Int dst_offset,
+                El::Int size) {
+  if (size <= 0) { return; }
+  using MatrixType = El::Matrix<TensorDataType, Device>;
+  MatrixType src_v, dst_v;
+  src_v.LockedAttach(size, 1,
+                     static_cast<const MatrixType&>(src).LockedBuffer() + src_offset,
+                     size);
+  dst_v.Attach(size, 1,
+               static_cast<MatrixType&>(dst).Buffer() + dst_offset,
+               size);
+  El::Copy(src_v, dst_v);
+}
+
+/** @brief Sum a flattened local matrix over ranks into their shards.
+ *
+ *  Rank @c r receives entries @c [r*block_size,(r+1)*block_size) in
+ *  the first @c block_size entries of its shard. Every rank receives
+ *  the last @c tail_size entries after them.
+ */
+template <typename TensorDataType, El::Device Device>
+void reduce_scatter_to_shard(const El::AbstractMatrix<TensorDataType>& full,
+                             El::AbstractMatrix<TensorDataType>& shard,
+                             El::Int block_size,
+                             El::Int tail_size,
+                             const El::mpi::Comm& comm) {
+  using MatrixType = El::Matrix<TensorDataType, Device>;
+  const auto& full_ = static_cast<const MatrixType&>(full);
+  auto& shard_ = static_cast<MatrixType&>(shard);
+  const auto& sync_info = El::SyncInfoFromMatrix(shard_);
+  if (block_size > 0) {
+    El::mpi::ReduceScatter(full_.LockedBuffer(), shard_.Buffer(),
+                           block_size, El::mpi::SUM, comm, sync_info);
+  }
+  if (tail_size > 0) {
+    copy_range<TensorDataType, Device>(full, block_size * El::mpi::Size(comm),
+                                       shard, block_size,
+                                       tail_size);
+    El::mpi::AllReduce(shard_.Buffer() + block_size, tail_size,
+                       El::mpi::SUM, comm, sync_info);
+  }
+}
+
+/** @brief Reconstruct a flattened local matrix from its shards. */
+template <typename TensorDataType, El::Device Device>
+void all_gather_from_shard(lbann_comm& lbann_comm,
+                           const El::AbstractMatrix<TensorDataType>& shard,
+                           El::AbstractMatrix<TensorDataType>& full,
+                           El::Int block_size,
+                           El::Int tail_size,
+                           const El::mpi::Comm& comm) {
+  using MatrixType = El::Matrix<TensorDataType, Device>;
+  const auto& shard_ = static_cast<const MatrixType&>(shard);
+  auto& full_ = static_cast<MatrixType&>(full);
+  if (block_size > 0) {
+    lbann_comm.all_gather(shard_.LockedBuffer(), block_size,
+                          full_.Buffer(), block_size,
+                          comm, El::SyncInfoFromMatrix(full_));
+  }
+  copy_range<TensorDataType, Device>(shard, block_size,
+                                     full, block_size * El::mpi::Size(comm),
+                                     tail_size);
+}
+
+/** @brief Copy this rank's entries of a flattened local matrix. */
+template <typename TensorDataType, El::Device Device>
+void copy_to_shard(const El::AbstractMatrix<TensorDataType>& full,
+                   El::AbstractMatrix<TensorDataType>& shard,
+                   El::Int block_size,
+                   El::Int tail_size,
+                   const El::mpi::Comm& comm) {
+  const El::Int rank = El::mpi::Rank(comm);
+  const El::Int procs = El::mpi::Size(comm);
+  copy_range<TensorDataType, Device>(full, rank * block_size,
+                                     shard, 0,
+                                     block_size);
+  copy_range<TensorDataType, Device>(full, procs * block_size,
+                                     shard, block_size,
+                                     tail_size);
+}
+
+} // namespace
+
 template <typename TensorDataType>
 data_type_optimizer<TensorDataType>::data_type_optimizer(TensorDataType learning_rate)
   : optimizer(), m_learning_rate(learning_rate) {}
@@ -42,7 +157,25 @@ data_type_optimizer<TensorDataType>::data_type_optimizer(const data_type_optimiz
     m_weights(other.m_weights),
     m_gradient(other.m_gradient ? other.m_gradient->Copy() : nullptr),
     m_gradient_v(other.m_gradient_v ? other.m_gradient_v->Copy() : nullptr),
-    m_learning_rate(other.m_learning_rate) {}
+    m_gradient_bucket_capacity(other.m_gradient_bucket_capacity),
+    m_gradient_compressor(other.m_gradient_compressor
+                          ? other.m_gradient_compressor->copy()
+                          : nullptr),
+    m_sparse_gradient(other.m_sparse_gradient
+                      ? make_unique<sparse_gradient<TensorDataType>>(*other.m_sparse_gradient)
+                      : nullptr),
+    m_shard_grid(other.m_shard_grid),
+    m_gradient_shard(other.m_gradient_shard
+                     ? other.m_gradient_shard->Copy()
+                     : nullptr),
+    m_values_shard(other.m_values_shard
+                   ? other.m_values_shard->Copy()
+                   : nullptr),
+    m_shard_block_size(other.m_shard_block_size),
+    m_shard_tail_size(other.m_shard_tail_size),
+    m_gradient_in_shard(other.m_gradient_in_shard),
+    m_learning_rate(other.m_learning_rate),
+    m_weight_decay(other.m_weight_decay) {}
 
 template <typename TensorDataType>
 data_type_optimizer<TensorDataType>& data_type_optimizer<TensorDataType>::operator=(const data_type_optimizer<TensorDataType>& other) {
@@ -50,7 +183,26 @@ data_type_optimizer<TensorDataType>& data_type_optimizer<TensorDataType>::operat
   m_weights = other.m_weights;
   m_gradient.reset(other.m_gradient ? other.m_gradient->Copy() : nullptr);
   m_gradient_v.reset(other.m_gradient_v ? other.m_gradient_v->Copy() : nullptr);
+  m_gradient_bucket.reset();
+  m_gradient_bucket_capacity = other.m_gradient_bucket_capacity;
+  m_gradient_compressor.reset(other.m_gradient_compressor
+                              ? other.m_gradient_compressor->copy()
+                              : nullptr);
+  m_sparse_gradient.reset(other.m_sparse_gradient
+                          ? new sparse_gradient<TensorDataType>(*other.m_sparse_gradient)
+                          : nullptr);
+  m_shard_grid = other.m_shard_grid;
+  m_gradient_shard.reset(other.m_gradient_shard
+                         ? other.m_gradient_shard->Copy()
+                         : nullptr);
+  m_values_shard.reset(other.m_values_shard
+                       ? other.m_values_shard->Copy()
+                       : nullptr);
+  m_shard_block_size = other.m_shard_block_size;
+  m_shard_tail_size = other.m_shard_tail_size;
+  m_gradient_in_shard = other.m_gradient_in_shard;
   m_learning_rate = other.m_learning_rate;
+  m_weight_decay = other.m_weight_decay;
   return *this;
 }
 
@@ -58,9 +210,32 @@ template <typename TensorDataType>
 description data_type_optimizer<TensorDataType>::get_description() const {
   description desc = optimizer::get_description();
   desc.add("Learning rate", m_learning_rate);
+  if (m_weight_decay != TensorDataType(0)) {
+    desc.add("Decoupled weight decay", m_weight_decay);
+  }
+  if (m_gradient_compressor != nullptr) {
+    desc.add("Gradient compression", m_gradient_compressor->get_type());
+  }
+  if (get_optimizer_state_sharded()) {
+    desc.add("Sharded optimizer state", true);
+  }
   return desc;
 }
 
+template <typename TensorDataType>
+size_t data_type_optimizer<TensorDataType>::get_memory_usage(El::Device device) const {
+  size_t bytes = (get_local_memory_usage(m_gradient, device)
+                  + get_local_memory_usage(m_gradient_v, device)
+                  + get_local_memory_usage(m_gradient_shard, device)
+                  + get_local_memory_usage(m_values_shard, device));
+  // get_state_matrices is non-const so subclasses can swap the
+  // matrices, but listing them does not modify the optimizer
+  for (const auto* m : const_cast<data_type_optimizer*>(this)->get_state_matrices()) {
+    bytes += get_local_memory_usage(*m, device);
+  }
+  return bytes;
+}
+
 template <typename TensorDataType>
 auto data_type_optimizer<TensorDataType>::get_weights() -> WeightsType& {
   // Item 3, p. 23 in "Effective C++", 3rd ed., by Scott Meyers
@@ -100,6 +275,30 @@ auto data_type_optimizer<TensorDataType>::get_gradient() -> AbsDistMatrixType& {
   }
 
   // Return gradient
+  if (get_optimizer_state_sharded()) {
+    if (!m_gradient_in_shard) {
+      // Full gradient is already summed, so just take this rank's part
+      switch (m_gradient->GetLocalDevice()) {
+      case El::Device::CPU:
+        copy_to_shard<TensorDataType, El::Device::CPU>(
+          m_gradient->LockedMatrix(), m_gradient_shard->Matrix(),
+          m_shard_block_size, m_shard_tail_size,
+          m_gradient->RedundantComm());
+        break;
+#ifdef LBANN_HAS_GPU
+      case El::Device::GPU:
+        copy_to_shard<TensorDataType, El::Device::GPU>(
+          m_gradient->LockedMatrix(), m_gradient_shard->Matrix(),
+          m_shard_block_size, m_shard_tail_size,
+          m_gradient->RedundantComm());
+        break;
+#endif // LBANN_HAS_GPU
+      default: LBANN_ERROR("invalid device");
+      }
+      m_gradient_in_shard = true;
+    }
+    return *m_gradient_shard;
+  }
   return *m_gradient;
 
 }
@@ -136,6 +335,7 @@ void data_type_optimizer<TensorDataType>::add_to_gradient(const AbsDistMatrixTyp
   if (get_gradient_status() == optimizer_gradient_status::allreduce_started) {
     finish_gradient_allreduce();
   }
+  if (m_gradient_in_shard) { all_gather_gradient(); }
   switch (get_gradient_status()) {
   case optimizer_gradient_status::ready:
     if (allreduce_needed) {
@@ -174,6 +374,45 @@ void data_type_optimizer<TensorDataType>::add_to_gradient(const AbsDistMatrixTyp
 
 }
 
+template <typename TensorDataType>
+void data_type_optimizer<TensorDataType>::add_to_sparse_gradient(
+  const std::vector<El::Int>& cols,
+  const AbsMatrixType& gradient,
+  TensorDataType scale,
+  bool allreduce_needed) {
+  if (m_gradient == nullptr) {
+    LBANN_ERROR("attempted to access gradient before it is set up");
+  }
+  if (scale == DataType(0)) { return; }
+
+  // Sum contribution over redundant communicator
+  sparse_gradient<TensorDataType> contribution(gradient.Height(),
+                                               gradient.GetDevice());
+  contribution.add(cols, gradient, scale);
+  if (allreduce_needed) {
+    contribution.allreduce(get_comm(), m_gradient->RedundantComm());
+  }
+
+  // Sparse steps work on whole local columns of the values and
+  // optimizer state, so fall back to a dense contribution otherwise
+  const auto& dist = m_gradient->DistData();
+  if (get_optimizer_state_sharded() || dist.colDist != El::STAR) {
+    std::unique_ptr<AbsDistMatrixType> dense(
+      AbsDistMatrixType::Instantiate(dist));
+    El::Zeros(*dense, m_gradient->Height(), m_gradient->Width());
+    contribution.add_to(dense->Matrix());
+    add_to_gradient(*dense);
+    return;
+  }
+
+  if (m_sparse_gradient == nullptr) {
+    m_sparse_gradient = make_unique<sparse_gradient<TensorDataType>>(
+      m_gradient->Height(), m_gradient->GetLocalDevice());
+  }
+  m_sparse_gradient->add(contribution.get_cols(), contribution.get_values());
+
+}
+
 template <typename TensorDataType>
 void data_type_optimizer<TensorDataType>::clear_gradient() {
   if (get_gradient_status() == optimizer_gradient_status::allreduce_started) {
@@ -181,6 +420,11 @@ void data_type_optimizer<TensorDataType>::clear_gradient() {
   }
   set_gradient_status(optimizer_gradient_status::cleared);
   get_gradient_sources().clear();
+  m_gradient_in_shard = false;
+  if (m_sparse_gradient != nullptr) { m_sparse_gradient->clear(); }
+  if (m_weights != nullptr && m_weights->has_master_weights()) {
+    m_weights->get_master_weights().get_optimizer()->clear_gradient();
+  }
 }
 
 template <typename TensorDataType>
@@ -195,6 +439,7 @@ auto data_type_optimizer<TensorDataType>::get_gradient_buffer(TensorDataType& bu
   if (get_gradient_status() == optimizer_gradient_status::allreduce_started) {
     finish_gradient_allreduce();
   }
+  if (m_gradient_in_shard) { all_gather_gradient(); }
   // Determine scaling factor and transition state.
   switch (get_gradient_status()) {
   case optimizer_gradient_status::ready:
@@ -230,7 +475,15 @@ auto data_type_optimizer<TensorDataType>::get_gradient_buffer(TensorDataType& bu
 template <typename TensorDataType>
 void data_type_optimizer<TensorDataType>::remove_gradient_source(const void* source) {
   optimizer::remove_gradient_source(source);
-  if (get_gradient_sources().empty()) {
+  if (get_gradient_sources().empty() && !get_gradient_allreduce_deferred()) {
+    start_gradient_allreduce();
+  }
+}
+
+template <typename TensorDataType>
+void data_type_optimizer<TensorDataType>::set_gradient_allreduce_deferred(bool defer) {
+  optimizer::set_gradient_allreduce_deferred(defer);
+  if (!defer && get_gradient_sources().empty()) {
     start_gradient_allreduce();
   }
 }
@@ -261,6 +514,47 @@ void data_type_optimizer<TensorDataType>::setup(WeightsType* w) {
   }
 #endif // HYDROGEN_HAVE_CUB
 
+  // Gradient fusion
+  int bucket_mb = 25;
+  if (options::get()->has_int("gradient_bucket_mb")) {
+    bucket_mb = options::get()->get_int("gradient_bucket_mb");
+  }
+  if (bucket_mb < 0) {
+    LBANN_ERROR("--gradient_bucket_mb must be non-negative; got ", bucket_mb);
+  }
+  m_gradient_bucket_capacity = size_t(bucket_mb) << 20;
+
+  // Optimizer state sharding
+  // Note: Derived optimizers allocate their state like the matrix
+  // returned by get_gradient, so this must be done before their
+  // setup.
+  m_gradient_shard.reset();
+  m_values_shard.reset();
+  m_gradient_in_shard = false;
+  if (options::get()->get_bool("shard_optimizer_state")
+      && !m_weights->has_master_weights()
+      && values.DistData().colDist == El::STAR
+      && values.DistData().rowDist == El::STAR
+      && values.RedundantSize() > 1
+      && values.Contiguous() && m_gradient->Contiguous()) {
+    const El::Int size = height * width;
+    const El::Int procs = values.RedundantSize();
+    m_shard_block_size = size / procs;
+    m_shard_tail_size = size - m_shard_block_size * procs;
+    if (m_shard_grid == nullptr) {
+      m_shard_grid = std::make_shared<El::Grid>(MPI_COMM_SELF);
+    }
+    auto shard_dist = values.DistData();
+    shard_dist.grid = m_shard_grid.get();
+    shard_dist.colAlign = 0;
+    shard_dist.rowAlign = 0;
+    shard_dist.root = 0;
+    m_gradient_shard.reset(AbsDistMatrixType::Instantiate(shard_dist));
+    m_gradient_shard->Resize(m_shard_block_size + m_shard_tail_size, 1);
+    m_values_shard.reset(AbsDistMatrixType::Instantiate(shard_dist));
+    m_values_shard->Resize(m_shard_block_size + m_shard_tail_size, 1);
+  }
+
 }
 
 template <typename TensorDataType>
@@ -277,9 +571,52 @@ template <typename TensorDataType>
 void data_type_optimizer<TensorDataType>::start_gradient_allreduce() {
   switch (get_gradient_status()) {
   case optimizer_gradient_status::allreduce_needed:
-    get_comm().nb_allreduce(*m_gradient,
-                            m_gradient->RedundantComm(),
-                            m_gradient_allreduce_req);
+    if (!get_gradient_allreduce_enabled()) {
+      if (get_optimizer_state_sharded()) {
+        LBANN_ERROR("gradient allreduces can not be disabled "
+                    "with a sharded optimizer state");
+      }
+      // Local gradient as an estimate of the full mini-batch gradient
+      // Note: Contributions that do not need an allreduce were
+      // scaled down by the redundant size when they were added.
+      El::Scale(El::To<TensorDataType>(m_gradient->RedundantSize()),
+                *m_gradient);
+      set_gradient_status(optimizer_gradient_status::ready);
+      break;
+    }
+    if (get_optimizer_state_sharded()) {
+      reduce_scatter_gradient();
+      set_gradient_status(optimizer_gradient_status::ready);
+      break;
+    }
+    if (get_track_gradient_norms()) {
+      // As when the allreduce is disabled, the local gradient scaled
+      // by the redundant size estimates the mini-batch gradient
+      const double scale = m_gradient->RedundantSize();
+      set_local_gradient_norm2(
+        scale * scale * local_squared_norm(m_gradient->LockedMatrix()));
+    }
+    if (m_gradient_compressor != nullptr) {
+      inc_gradient_bytes_saved(
+        m_gradient_compressor->allreduce(get_comm(), *m_gradient));
+    } else {
+      const size_t local_bytes = (sizeof(TensorDataType)
+                                  * m_gradient->LocalHeight()
+                                  * m_gradient->LocalWidth());
+      if (m_gradient->RedundantSize() > 1
+          && local_bytes > 0
+          && local_bytes < m_gradient_bucket_capacity) {
+        m_gradient_bucket = gradient_bucket<TensorDataType>::enqueue(
+          get_comm(),
+          *m_gradient,
+          m_gradient_bucket_capacity,
+          m_gradient_bucket_offset);
+      } else {
+        get_comm().nb_allreduce(*m_gradient,
+                                m_gradient->RedundantComm(),
+                                m_gradient_allreduce_req);
+      }
+    }
     set_gradient_status(optimizer_gradient_status::allreduce_started);
     break;
   case optimizer_gradient_status::ready:
@@ -295,7 +632,17 @@ template <typename TensorDataType>
 void data_type_optimizer<TensorDataType>::finish_gradient_allreduce() {
   switch (get_gradient_status()) {
   case optimizer_gradient_status::allreduce_started:
-    get_comm().wait(m_gradient_allreduce_req);
+    if (m_gradient_bucket != nullptr) {
+      m_gradient_bucket->unpack(get_comm(),
+                                *m_gradient,
+                                m_gradient_bucket_offset);
+      m_gradient_bucket.reset();
+    } else {
+      get_comm().wait(m_gradient_allreduce_req);
+    }
+    if (get_track_gradient_norms()) {
+      set_global_gradient_norm2(local_squared_norm(m_gradient->LockedMatrix()));
+    }
     set_gradient_status(optimizer_gradient_status::ready);
     break;
   case optimizer_gradient_status::ready:
@@ -317,10 +664,215 @@ void data_type_optimizer<TensorDataType>::step() {
     LBANN_ERROR("attempted to perform optimization step without weights");
   }
   const auto start_time = get_time();
-  step_compute(m_weights->get_values(), get_gradient());
+  if (m_weights->has_master_weights()) {
+    // The master optimizer steps the fp32 master values
+    auto& master_opt = *m_weights->get_master_weights().get_optimizer();
+    load_master_gradient();
+    master_opt.set_learning_rate(El::To<float>(get_learning_rate()));
+    master_opt.set_weight_decay(El::To<float>(get_weight_decay()));
+    master_opt.step();
+    flush_fused_optimizer_steps();
+    m_weights->copy_values_from_master();
+    inc_step_time(get_time() - start_time);
+    return;
+  }
+  if (m_sparse_gradient != nullptr && !m_sparse_gradient->empty()) {
+    if (get_gradient_status() == optimizer_gradient_status::cleared) {
+      sparse_step();
+      inc_step_time(get_time() - start_time);
+      return;
+    }
+    m_sparse_gradient->add_to(get_gradient().Matrix());
+    m_sparse_gradient->clear();
+  }
+  if (get_optimizer_state_sharded()) {
+    const auto& gradient = get_gradient();
+    copy_values_to_shard();
+    apply_step(*m_values_shard, gradient);
+    flush_fused_optimizer_steps();
+    all_gather_values();
+  } else {
+    apply_step(m_weights->get_values(), get_gradient());
+  }
   inc_step_time(get_time() - start_time);
 }
 
+template <typename TensorDataType>
+void data_type_optimizer<TensorDataType>::apply_step(AbsDistMatrixType& values,
+                                                     const AbsDistMatrixType& gradient) {
+  if (m_weight_decay != TensorDataType(0) && !fuses_weight_decay()) {
+    El::Scale(TensorDataType(1) - m_learning_rate * m_weight_decay, values);
+  }
+  step_compute(values, gradient);
+}
+
+template <typename TensorDataType>
+void data_type_optimizer<TensorDataType>::load_master_gradient() {
+  auto& master_opt = *m_weights->get_master_weights().get_optimizer();
+  if (master_opt.get_gradient_status() != optimizer_gradient_status::cleared) {
+    return;
+  }
+  auto& gradient = get_gradient();
+  if (m_sparse_gradient != nullptr && !m_sparse_gradient->empty()) {
+    m_sparse_gradient->add_to(gradient.Matrix());
+    m_sparse_gradient->clear();
+  }
+  float buf_scale, in_scale;
+  El::Copy(gradient, master_opt.get_gradient_buffer(buf_scale, in_scale));
+}
+
+template <typename TensorDataType>
+void data_type_optimizer<TensorDataType>::enqueue_gradient_unscaling() {
+  using QueueType = gradient_unscale_queue<TensorDataType>;
+  if (m_weights->has_master_weights()) {
+    // Unscale in single precision so small gradients do not underflow
+    load_master_gradient();
+    m_weights->get_master_weights().get_optimizer()->enqueue_gradient_unscaling();
+    return;
+  }
+  if (m_sparse_gradient != nullptr && !m_sparse_gradient->empty()) {
+    QueueType::enqueue(m_sparse_gradient->get_values());
+  }
+  if (get_gradient_status() != optimizer_gradient_status::cleared) {
+    QueueType::enqueue(get_gradient().Matrix());
+  }
+}
+
+template <typename TensorDataType>
+void data_type_optimizer<TensorDataType>::sparse_step() {
+  using SparseType = sparse_gradient<TensorDataType>;
+  const auto& cols = m_sparse_gradient->get_cols();
+  auto& values = m_weights->get_values();
+  const El::Int height = values.LocalHeight();
+  const El::Int width = cols.size();
+
+  // Touched columns are stored in matrices on a single-process grid
+  if (m_shard_grid == nullptr) {
+    m_shard_grid = std::make_shared<El::Grid>(MPI_COMM_SELF);
+  }
+  auto dist = values.DistData();
+  dist.colDist = El::STAR;
+  dist.rowDist = El::STAR;
+  dist.grid = m_shard_grid.get();
+  dist.colAlign = 0;
+  dist.rowAlign = 0;
+  dist.root = 0;
+
+  // Matrices with the touched columns
+  std::unique_ptr<AbsDistMatrixType> values_cols(
+    AbsDistMatrixType::Instantiate(dist));
+  values_cols->Resize(height, width);
+  SparseType::gather_columns(values.LockedMatrix(), cols,
+                             values_cols->Matrix());
+  std::unique_ptr<AbsDistMatrixType> gradient_cols(
+    AbsDistMatrixType::Instantiate(dist));
+  gradient_cols->Resize(height, width);
+  El::Copy(m_sparse_gradient->get_values(), gradient_cols->Matrix());
+  const auto state = get_state_matrices();
+  std::vector<std::unique_ptr<AbsDistMatrixType>> state_cols;
+  for (const auto& s : state) {
+    state_cols.emplace_back(AbsDistMatrixType::Instantiate(dist));
+    state_cols.back()->Resize(height, width);
+    SparseType::gather_columns((*s)->LockedMatrix(), cols,
+                               state_cols.back()->Matrix());
+    std::swap(*s, state_cols.back());
+  }
+
+  // Apply step to touched columns and write them back
+  apply_step(*values_cols, *gradient_cols);
+  flush_fused_optimizer_steps();
+  for (size_t i = 0; i < state.size(); ++i) {
+    std::swap(*state[i], state_cols[i]);
+    SparseType::scatter_columns(state_cols[i]->LockedMatrix(), cols,
+                                (*state[i])->Matrix());
+  }
+  SparseType::scatter_columns(values_cols->LockedMatrix(), cols,
+                              values.Matrix());
+
+}
+
+template <typename TensorDataType>
+void data_type_optimizer<TensorDataType>::reduce_scatter_gradient() {
+  const auto& comm = m_gradient->RedundantComm();
+  switch (m_gradient->GetLocalDevice()) {
+  case El::Device::CPU:
+    reduce_scatter_to_shard<TensorDataType, El::Device::CPU>(
+      m_gradient->LockedMatrix(), m_gradient_shard->Matrix(),
+      m_shard_block_size, m_shard_tail_size, comm);
+    break;
+#ifdef LBANN_HAS_GPU
+  case El::Device::GPU:
+    reduce_scatter_to_shard<TensorDataType, El::Device::GPU>(
+      m_gradient->LockedMatrix(), m_gradient_shard->Matrix(),
+      m_shard_block_size, m_shard_tail_size, comm);
+    break;
+#endif // LBANN_HAS_GPU
+  default: LBANN_ERROR("invalid device");
+  }
+  m_gradient_in_shard = true;
+}
+
+template <typename TensorDataType>
+void data_type_optimizer<TensorDataType>::all_gather_gradient() {
+  const auto& comm = m_gradient->RedundantComm();
+  switch (m_gradient->GetLocalDevice()) {
+  case El::Device::CPU:
+    all_gather_from_shard<TensorDataType, El::Device::CPU>(
+      get_comm(), m_gradient_shard->LockedMatrix(), m_gradient->Matrix(),
+      m_shard_block_size, m_shard_tail_size, comm);
+    break;
+#ifdef LBANN_HAS_GPU
+  case El::Device::GPU:
+    all_gather_from_shard<TensorDataType, El::Device::GPU>(
+      get_comm(), m_gradient_shard->LockedMatrix(), m_gradient->Matrix(),
+      m_shard_block_size, m_shard_tail_size, comm);
+    break;
+#endif // LBANN_HAS_GPU
+  default: LBANN_ERROR("invalid device");
+  }
+  m_gradient_in_shard = false;
+}
+
+template <typename TensorDataType>
+void data_type_optimizer<TensorDataType>::copy_values_to_shard() {
+  const auto& values = m_weights->get_values();
+  switch (values.GetLocalDevice()) {
+  case El::Device::CPU:
+    copy_to_shard<TensorDataType, El::Device::CPU>(
+      values.LockedMatrix(), m_values_shard->Matrix(),
+      m_shard_block_size, m_shard_tail_size, values.RedundantComm());
+    break;
+#ifdef LBANN_HAS_GPU
+  case El::Device::GPU:
+    copy_to_shard<TensorDataType, El::Device::GPU>(
+      values.LockedMatrix(), m_values_shard->Matrix(),
+      m_shard_block_size, m_shard_tail_size, values.RedundantComm());
+    break;
+#endif // LBANN_HAS_GPU
+  default: LBANN_ERROR("invalid device");
+  }
+}
+
+template <typename TensorDataType>
+void data_type_optimizer<TensorDataType>::all_gather_values() {
+  auto& values = m_weights->get_values();
+  switch (values.GetLocalDevice()) {
+  case El::Device::CPU:
+    all_gather_from_shard<TensorDataType, El::Device::CPU>(
+      get_comm(), m_values_shard->LockedMatrix(), values.Matrix(),
+      m_shard_block_size, m_shard_tail_size, values.RedundantComm());
+    break;
+#ifdef LBANN_HAS_GPU
+  case El::Device::GPU:
+    all_gather_from_shard<TensorDataType, El::Device::GPU>(
+      get_comm(), m_values_shard->LockedMatrix(), values.Matrix(),
+      m_shard_block_size, m_shard_tail_size, values.RedundantComm());
+    break;
+#endif // LBANN_HAS_GPU
+  default: LBANN_ERROR("invalid device");
+  }
+}
+
 // =============================
 // Checkpointing
 // =============================
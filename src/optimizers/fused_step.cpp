@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/optimizers/fused_step.hpp"
+#include "lbann/utils/options.hpp"
+
+namespace lbann {
+
+bool use_fused_optimizer_step() {
+  auto* opts = options::get();
+  return (opts->get_bool("fused_optimizer_step")
+          || opts->get_bool("pipelined_weight_updates"));
+}
+
+void flush_fused_optimizer_steps() {
+#ifdef LBANN_HAS_CUDA
+#define PROTO(T) fused_step_queue<T>::flush()
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+#undef PROTO
+#undef LBANN_INSTANTIATE_GPU_HALF
+#endif // LBANN_HAS_CUDA
+}
+
+#ifdef LBANN_HAS_CUDA
+void flush_fused_optimizer_steps(cudaStream_t stream) {
+#define PROTO(T) fused_step_queue<T>::flush(stream)
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+#undef PROTO
+#undef LBANN_INSTANTIATE_GPU_HALF
+}
+#endif // LBANN_HAS_CUDA
+
+} // namespace lbann
@@ -0,0 +1,214 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#define LBANN_FUSED_STEP_INSTANTIATE
+#include "lbann/optimizers/fused_step.hpp"
+#include "lbann/utils/cuda.hpp"
+#include "lbann/utils/exception.hpp"
+
+namespace lbann {
+
+namespace {
+
+/** Number of entries processed by one CUDA block. */
+constexpr size_t chunk_size = 65536;
+constexpr size_t block_size = 256;
+constexpr size_t max_tensors = 24;
+constexpr size_t max_blocks = 256;
+
+/** @brief Kernel argument listing the tensors of one launch.
+ *
+ *  Block @c i processes chunk @c block_chunk[i] of tensor
+ *  @c block_tensor[i]. CUDA limits kernel arguments to 4 KB.
+ */
+template <typename TensorDataType>
+struct fused_step_table {
+  fused_step_tensor<TensorDataType> tensors[max_tensors];
+  int block_tensor[max_blocks];
+  int block_chunk[max_blocks];
+};
+
+template <fused_step_kind Kind, typename TensorDataType>
+__global__ void fused_step_kernel(fused_step_table<TensorDataType> table) {
+  const auto& t = table.tensors[table.block_tensor[blockIdx.x]];
+  const size_t start = table.block_chunk[blockIdx.x] * chunk_size;
+  const size_t end = (start + chunk_size < t.size
+                      ? start + chunk_size
+                      : t.size);
+  const TensorDataType one(1);
+  for (size_t pos = start + threadIdx.x; pos < end; pos += blockDim.x) {
+    auto& x = t.values[pos];
+    const auto& g = t.gradient[pos];
+    const auto x_decay = t.decay * x;
+    switch (Kind) {
+    case fused_step_kind::momentum:
+      {
+        auto& v = t.state1[pos];
+        v = t.hyper1 * v + g;
+        x -= t.learning_rate * v;
+      }
+      break;
+    case fused_step_kind::nesterov:
+      {
+        auto& v = t.state1[pos];
+        v = t.hyper1 * v + g;
+        x -= t.learning_rate * (t.hyper1 * v + g);
+      }
+      break;
+    case fused_step_kind::adam:
+      {
+        const auto& g_eps = g + t.eps;
+        auto& m1 = t.state1[pos];
+        auto& m2 = t.state2[pos];
+        m1 = t.hyper1 * m1 + (one - t.hyper1) * g_eps;
+        m2 = t.hyper2 * m2 + (one - t.hyper2) * g_eps * g_eps;
+        x -= t.learning_rate * m1 / (cuda::sqrt(m2) + t.eps);
+      }
+      break;
+    case fused_step_kind::adagrad:
+      {
+        auto& c = t.state1[pos];
+        c += g * g;
+        x -= t.learning_rate * g / (cuda::sqrt(c) + t.eps);
+      }
+      break;
+    case fused_step_kind::rmsprop:
+      {
+        auto& c = t.state1[pos];
+        c = t.hyper1 * c + (one - t.hyper1) * g * g;
+        x -= t.learning_rate * g / (cuda::sqrt(c) + t.eps);
+      }
+      break;
+    }
+    x -= x_decay;
+  }
+}
+
+template <typename TensorDataType>
+void launch_fused_step(fused_step_kind kind,
+                       const fused_step_table<TensorDataType>& table,
+                       size_t num_blocks,
+                       cudaStream_t stream) {
+  static_assert(sizeof(fused_step_table<TensorDataType>) <= 4096,
+                "fused step table exceeds CUDA kernel argument limit");
+  if (num_blocks == 0) { return; }
+  switch (kind) {
+  case fused_step_kind::momentum:
+    fused_step_kernel<fused_step_kind::momentum, TensorDataType>
+      <<<num_blocks, block_size, 0, stream>>>(table);
+    break;
+  case fused_step_kind::nesterov:
+    fused_step_kernel<fused_step_kind::nesterov, TensorDataType>
+      <<<num_blocks, block_size, 0, stream>>>(table);
+    break;
+  case fused_step_kind::adam:
+    fused_step_kernel<fused_step_kind::adam, TensorDataType>
+      <<<num_blocks, block_size, 0, stream>>>(table);
+    break;
+  case fused_step_kind::adagrad:
+    fused_step_kernel<fused_step_kind::adagrad, TensorDataType>
+      <<<num_blocks, block_size, 0, stream>>>(table);
+    break;
+  case fused_step_kind::rmsprop:
+    fused_step_kernel<fused_step_kind::rmsprop, TensorDataType>
+      <<<num_blocks, block_size, 0, stream>>>(table);
+    break;
+  default: LBANN_ERROR("invalid fused optimization step");
+  }
+}
+
+constexpr fused_step_kind all_kinds[] = {
+  fused_step_kind::momentum,
+  fused_step_kind::nesterov,
+  fused_step_kind::adam,
+  fused_step_kind::adagrad,
+  fused_step_kind::rmsprop
+};
+
+} // namespace
+
+template <typename TensorDataType>
+auto fused_step_queue<TensorDataType>::get_queue(fused_step_kind kind)
+  -> std::vector<TensorType>& {
+  static std::vector<TensorType> queues[sizeof(all_kinds)/sizeof(all_kinds[0])];
+  return queues[static_cast<int>(kind)];
+}
+
+template <typename TensorDataType>
+void fused_step_queue<TensorDataType>::enqueue(fused_step_kind kind,
+                                               const TensorType& tensor) {
+  if (tensor.size > 0) {
+    get_queue(kind).push_back(tensor);
+  }
+}
+
+template <typename TensorDataType>
+void fused_step_queue<TensorDataType>::flush(cudaStream_t stream) {
+  fused_step_table<TensorDataType> table;
+  for (const auto& kind : all_kinds) {
+    auto& queue = get_queue(kind);
+    if (queue.empty()) { continue; }
+
+    // Fill tables with tensor chunks, launching whenever a table is
+    // full. Large tensors may be split across launches.
+    size_t num_tensors = 0, num_blocks = 0;
+    for (const auto& t : queue) {
+      const size_t num_chunks = (t.size + chunk_size - 1) / chunk_size;
+      bool in_table = false;
+      for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+        if (!in_table) {
+          if (num_tensors == max_tensors) {
+            launch_fused_step(kind, table, num_blocks, stream);
+            num_tensors = 0;
+            num_blocks = 0;
+          }
+          table.tensors[num_tensors++] = t;
+          in_table = true;
+        }
+        table.block_tensor[num_blocks] = num_tensors - 1;
+        table.block_chunk[num_blocks] = chunk;
+        if (++num_blocks == max_blocks) {
+          launch_fused_step(kind, table, num_blocks, stream);
+          num_tensors = 0;
+          num_blocks = 0;
+          in_table = false;
+        }
+      }
+    }
+    launch_fused_step(kind, table, num_blocks, stream);
+    queue.clear();
+
+  }
+}
+
+#define PROTO(T)                     \
+  template class fused_step_queue<T>
+
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
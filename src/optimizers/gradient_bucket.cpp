@@ -0,0 +1,222 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#define LBANN_GRADIENT_BUCKET_INSTANTIATE
+#include "lbann/optimizers/gradient_bucket.hpp"
+#include "lbann/utils/exception.hpp"
+#include <algorithm>
+
+namespace lbann {
+
+namespace {
+
+/** @brief Buckets that have not been launched yet.
+ *
+ *  Kept in creation order, which is the same on every rank, so that
+ *  buckets on different communicators are launched in a consistent
+ *  order.
+ */
+template <typename TensorDataType>
+std::vector<std::shared_ptr<gradient_bucket<TensorDataType>>>& get_open_buckets() {
+  static std::vector<std::shared_ptr<gradient_bucket<TensorDataType>>> buckets;
+  return buckets;
+}
+
+template <typename TensorDataType, El::Device Device>
+void copy_to_segment(const El::AbstractMatrix<TensorDataType>& local,
+                     El::AbstractMatrix<TensorDataType>& buffer,
+                     El::Int offset) {
+  using MatrixType = El::Matrix<TensorDataType, Device>;
+  MatrixType segment;
+  segment.Attach(local.Height(), local.Width(),
+                 static_cast<MatrixType&>(buffer).Buffer() + offset,
+                 local.Height());
+  El::Copy(local, segment);
+}
+
+template <typename TensorDataType, El::Device Device>
+void copy_from_segment(const El::AbstractMatrix<TensorDataType>& buffer,
+                       El::Int offset,
+                       El::AbstractMatrix<TensorDataType>& local) {
+  using MatrixType = El::Matrix<TensorDataType, Device>;
+  MatrixType segment;
+  segment.LockedAttach(local.Height(), local.Width(),
+                       static_cast<const MatrixType&>(buffer).LockedBuffer() + offset,
+                       local.Height());
+  El::Copy(segment, local);
+}
+
+} // namespace
+
+template <typename TensorDataType>
+gradient_bucket<TensorDataType>::gradient_bucket(const El::mpi::Comm& comm,
+                                                 El::Device device)
+  : m_comm(comm), m_device(device) {}
+
+template <typename TensorDataType>
+auto gradient_bucket<TensorDataType>::enqueue(lbann_comm& comm,
+                                              const AbsDistMatrixType& gradient,
+                                              size_t capacity,
+                                              El::Int& offset)
+  -> std::shared_ptr<gradient_bucket> {
+  const auto& redundant_comm = gradient.RedundantComm();
+  const auto device = gradient.GetLocalDevice();
+  auto& buckets = get_open_buckets<TensorDataType>();
+  auto it = std::find_if(buckets.begin(), buckets.end(),
+                         [&](const std::shared_ptr<gradient_bucket>& b) {
+                           return (&b->m_comm == &redundant_comm
+                                   && b->m_device == device);
+                         });
+  if (it == buckets.end()) {
+    buckets.push_back(std::make_shared<gradient_bucket>(redundant_comm, device));
+    it = buckets.end() - 1;
+  }
+
+  // Add gradient to bucket
+  auto bucket_ptr = *it;
+  offset = bucket_ptr->m_size;
+  bucket_ptr->m_gradients.push_back(&gradient);
+  bucket_ptr->m_size += gradient.LocalHeight() * gradient.LocalWidth();
+
+  // Launch allreduce if bucket is full
+  if (bucket_ptr->m_size * sizeof(TensorDataType) >= capacity) {
+    bucket_ptr->launch(comm);
+  }
+  return bucket_ptr;
+
+}
+
+template <typename TensorDataType>
+void gradient_bucket<TensorDataType>::launch(lbann_comm& comm) {
+  if (m_launched) { return; }
+  m_launched = true;
+
+  // Close bucket so later gradients go into a new one
+  auto& buckets = get_open_buckets<TensorDataType>();
+  buckets.erase(std::remove_if(buckets.begin(), buckets.end(),
+                               [this](const std::shared_ptr<gradient_bucket>& b) {
+                                 return b.get() == this;
+                               }),
+                buckets.end());
+
+  // Pack local matrices into a contiguous buffer
+  switch (m_device) {
+  case El::Device::CPU:
+    m_buffer.reset(new El::Matrix<TensorDataType, El::Device::CPU>());
+    break;
+#ifdef LBANN_HAS_GPU
+  case El::Device::GPU:
+    m_buffer.reset(new El::Matrix<TensorDataType, El::Device::GPU>());
+#ifdef HYDROGEN_HAVE_CUB
+    m_buffer->SetMemoryMode(1); // CUB GPU memory pool
+#endif // HYDROGEN_HAVE_CUB
+    break;
+#endif // LBANN_HAS_GPU
+  default: LBANN_ERROR("invalid device");
+  }
+  m_buffer->Resize(m_size, 1);
+  El::Int offset = 0;
+  for (const auto* gradient : m_gradients) {
+    const auto& local = gradient->LockedMatrix();
+    if (local.Height() > 0 && local.Width() > 0) {
+      switch (m_device) {
+      case El::Device::CPU:
+        copy_to_segment<TensorDataType, El::Device::CPU>(local, *m_buffer, offset);
+        break;
+#ifdef LBANN_HAS_GPU
+      case El::Device::GPU:
+        copy_to_segment<TensorDataType, El::Device::GPU>(local, *m_buffer, offset);
+        break;
+#endif // LBANN_HAS_GPU
+      default: LBANN_ERROR("invalid device");
+      }
+    }
+    offset += local.Height() * local.Width();
+  }
+  m_gradients.clear();
+
+  comm.nb_allreduce(*m_buffer, m_comm, m_req);
+
+}
+
+template <typename TensorDataType>
+void gradient_bucket<TensorDataType>::launch_all(lbann_comm& comm) {
+  auto buckets = get_open_buckets<TensorDataType>();
+  for (auto& b : buckets) {
+    b->launch(comm);
+  }
+}
+
+template <typename TensorDataType>
+void gradient_bucket<TensorDataType>::wait(lbann_comm& comm) {
+  launch(comm);
+  if (!m_finished) {
+    comm.wait(m_req);
+    m_finished = true;
+  }
+}
+
+template <typename TensorDataType>
+void gradient_bucket<TensorDataType>::unpack(lbann_comm& comm,
+                                             AbsDistMatrixType& gradient,
+                                             El::Int offset) {
+  wait(comm);
+  auto& local = gradient.Matrix();
+  if (offset + local.Height() * local.Width() > m_size) {
+    LBANN_ERROR("gradient does not fit in bucket ",
+                "(offset=",offset,", size=",local.Height() * local.Width(),
+                ", bucket size=",m_size,")");
+  }
+  if (local.Height() < 1 || local.Width() < 1) { return; }
+  switch (m_device) {
+  case El::Device::CPU:
+    copy_from_segment<TensorDataType, El::Device::CPU>(*m_buffer, offset, local);
+    break;
+#ifdef LBANN_HAS_GPU
+  case El::Device::GPU:
+    copy_from_segment<TensorDataType, El::Device::GPU>(*m_buffer, offset, local);
+    break;
+#endif // LBANN_HAS_GPU
+  default: LBANN_ERROR("invalid device");
+  }
+}
+
+#define PROTO(T)                         \
+  template class gradient_bucket<T>
+
+#define LBANN_INSTANTIATE_CPU_HALF
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+#undef PROTO
+
+void launch_gradient_buckets(lbann_comm& comm) {
+#define PROTO(T) gradient_bucket<T>::launch_all(comm)
+#include "lbann/macros/instantiate.hpp"
+#undef PROTO
+}
+
+} // namespace lbann
@@ -0,0 +1,375 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#define LBANN_GRADIENT_COMPRESSOR_INSTANTIATE
+#include "lbann/optimizers/gradient_compressor.hpp"
+#include "lbann/utils/exception.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace lbann {
+
+namespace {
+
+/** Bytes sent by each process in a ring allreduce. */
+size_t ring_allreduce_bytes(size_t num_bytes, int num_procs) {
+  return 2 * num_bytes * (num_procs - 1) / num_procs;
+}
+
+std::uint32_t float_bits(float x) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  return bits;
+}
+
+float bits_float(std::uint32_t bits) {
+  float x;
+  std::memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+/** IEEE single to half precision, rounding to nearest even. */
+std::uint16_t float_to_half(float x) {
+  const std::uint32_t bits = float_bits(x);
+  const std::uint16_t sign = (bits >> 16) & 0x8000;
+  const std::uint32_t abs_bits = bits & 0x7FFFFFFF;
+  if (abs_bits >= 0x7F800000) {
+    // Inf or NaN
+    return sign | 0x7C00 | (abs_bits > 0x7F800000 ? 0x0200 : 0);
+  }
+  if (abs_bits >= 0x477FF000) {
+    // Overflow after rounding
+    return sign | 0x7C00;
+  }
+  if (abs_bits < 0x38800000) {
+    // Subnormal or zero
+    if (abs_bits < 0x33000000) { return sign; }
+    const std::uint32_t exponent = abs_bits >> 23;
+    const std::uint32_t mantissa = (abs_bits & 0x007FFFFF) | 0x00800000;
+    const std::uint32_t shift = 126 - exponent;
+    std::uint32_t half = mantissa >> shift;
+    const std::uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const std::uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half & 1))) {
+      ++half;
+    }
+    return sign | half;
+  }
+  std::uint32_t half = (abs_bits - 0x38000000) >> 13;
+  const std::uint32_t remainder = abs_bits & 0x1FFF;
+  if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+    ++half;
+  }
+  return sign | half;
+}
+
+float half_to_float(std::uint16_t x) {
+  const std::uint32_t sign = std::uint32_t(x & 0x8000) << 16;
+  const std::uint32_t exponent = (x >> 10) & 0x1F;
+  const std::uint32_t mantissa = x & 0x03FF;
+  if (exponent == 0x1F) {
+    return bits_float(sign | 0x7F800000 | (mantissa << 13));
+  }
+  if (exponent == 0) {
+    // Subnormal or zero
+    const float value = std::ldexp(float(mantissa), -24);
+    return sign ? -value : value;
+  }
+  return bits_float(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+/** IEEE single precision to bfloat16, rounding to nearest even. */
+std::uint16_t float_to_bfloat16(float x) {
+  const std::uint32_t bits = float_bits(x);
+  if ((bits & 0x7FFFFFFF) > 0x7F800000) {
+    // Keep NaN quiet
+    return (bits >> 16) | 0x0040;
+  }
+  const std::uint32_t rounding = 0x7FFF + ((bits >> 16) & 1);
+  return (bits + rounding) >> 16;
+}
+
+float bfloat16_to_float(std::uint16_t x) {
+  return bits_float(std::uint32_t(x) << 16);
+}
+
+} // namespace
+
+template <typename TensorDataType>
+size_t gradient_compressor<TensorDataType>::allreduce(lbann_comm& comm,
+                                                      AbsDistMatrixType& gradient) {
+  const auto& c = gradient.RedundantComm();
+  const int num_procs = El::mpi::Size(c);
+  auto& local = gradient.Matrix();
+  const El::Int height = local.Height();
+  const El::Int width = local.Width();
+  if (num_procs == 1 || height < 1 || width < 1) { return 0; }
+
+  // Contiguous host copy in single precision
+  El::Matrix<TensorDataType, El::Device::CPU> host;
+  El::Copy(local, host);
+  const El::Int ldim = host.LDim();
+  m_values.resize(height * width);
+  for (El::Int col = 0; col < width; ++col) {
+    const auto* src = host.LockedBuffer() + col * ldim;
+    auto* dst = m_values.data() + col * height;
+    for (El::Int row = 0; row < height; ++row) {
+      dst[row] = static_cast<float>(src[row]);
+    }
+  }
+
+  const size_t payload = allreduce_values(comm, c, m_values);
+
+  // Copy sum back into gradient
+  for (El::Int col = 0; col < width; ++col) {
+    const auto* src = m_values.data() + col * height;
+    auto* dst = host.Buffer() + col * ldim;
+    for (El::Int row = 0; row < height; ++row) {
+      dst[row] = static_cast<TensorDataType>(src[row]);
+    }
+  }
+  El::Copy(host, local);
+
+  const size_t uncompressed = ring_allreduce_bytes(
+    sizeof(TensorDataType) * m_values.size(), num_procs);
+  return (uncompressed > payload ? uncompressed - payload : 0);
+
+}
+
+// =============================
+// Half precision
+// =============================
+
+template <typename TensorDataType>
+std::uint16_t half_precision_compressor<TensorDataType>::encode(float x) const {
+  return m_bfloat16 ? float_to_bfloat16(x) : float_to_half(x);
+}
+
+template <typename TensorDataType>
+float half_precision_compressor<TensorDataType>::decode(std::uint16_t x) const {
+  return m_bfloat16 ? bfloat16_to_float(x) : half_to_float(x);
+}
+
+template <typename TensorDataType>
+size_t half_precision_compressor<TensorDataType>::allreduce_values(
+  lbann_comm& comm,
+  const El::mpi::Comm& c,
+  std::vector<float>& values) {
+  const int num_procs = El::mpi::Size(c);
+  const int rank = El::mpi::Rank(c);
+  const int right = (rank + 1) % num_procs;
+  const int left = (rank + num_procs - 1) % num_procs;
+  const size_t size = values.size();
+  auto chunk_begin = [&](int chunk) -> size_t {
+    return size * chunk / num_procs;
+  };
+  auto chunk_size = [&](int chunk) -> size_t {
+    return chunk_begin(chunk + 1) - chunk_begin(chunk);
+  };
+  const size_t max_chunk_size = (size + num_procs - 1) / num_procs;
+  std::vector<std::uint16_t> send_buf(max_chunk_size), recv_buf(max_chunk_size);
+  size_t bytes_sent = 0;
+
+  // Exchange encoded chunks with neighbors in the ring
+  auto exchange = [&](int send_chunk, int recv_chunk) {
+    const size_t send_size = chunk_size(send_chunk);
+    const size_t recv_size = chunk_size(recv_chunk);
+    const float* src = values.data() + chunk_begin(send_chunk);
+    for (size_t i = 0; i < send_size; ++i) {
+      send_buf[i] = encode(src[i]);
+    }
+    El::mpi::SendRecv(
+      reinterpret_cast<El::byte*>(send_buf.data()),
+      static_cast<int>(send_size * sizeof(std::uint16_t)),
+      right,
+      reinterpret_cast<El::byte*>(recv_buf.data()),
+      static_cast<int>(recv_size * sizeof(std::uint16_t)),
+      left,
+      c, El::SyncInfo<El::Device::CPU>{});
+    bytes_sent += send_size * sizeof(std::uint16_t);
+  };
+
+  // Reduce-scatter
+  for (int step = 0; step < num_procs - 1; ++step) {
+    const int send_chunk = (rank + num_procs - step) % num_procs;
+    const int recv_chunk = (rank + 2 * num_procs - step - 1) % num_procs;
+    exchange(send_chunk, recv_chunk);
+    float* dst = values.data() + chunk_begin(recv_chunk);
+    for (size_t i = 0; i < chunk_size(recv_chunk); ++i) {
+      dst[i] += decode(recv_buf[i]);
+    }
+  }
+
+  // Round the owned chunk so that all processes agree on its value
+  {
+    const int chunk = (rank + 1) % num_procs;
+    float* dst = values.data() + chunk_begin(chunk);
+    for (size_t i = 0; i < chunk_size(chunk); ++i) {
+      dst[i] = decode(encode(dst[i]));
+    }
+  }
+
+  // Allgather
+  for (int step = 0; step < num_procs - 1; ++step) {
+    const int send_chunk = (rank + num_procs + 1 - step) % num_procs;
+    const int recv_chunk = (rank + num_procs - step) % num_procs;
+    exchange(send_chunk, recv_chunk);
+    float* dst = values.data() + chunk_begin(recv_chunk);
+    for (size_t i = 0; i < chunk_size(recv_chunk); ++i) {
+      dst[i] = decode(recv_buf[i]);
+    }
+  }
+
+  return bytes_sent;
+
+}
+
+// =============================
+// Top-k sparsification
+// =============================
+
+template <typename TensorDataType>
+topk_compressor<TensorDataType>::topk_compressor(double ratio)
+  : m_ratio(ratio) {
+  if (ratio <= 0 || ratio > 1) {
+    LBANN_ERROR("top-k gradient compression ratio must be in (0,1], ",
+                "but got ", ratio);
+  }
+}
+
+template <typename TensorDataType>
+size_t topk_compressor<TensorDataType>::allreduce_values(
+  lbann_comm& comm,
+  const El::mpi::Comm& c,
+  std::vector<float>& values) {
+  const int num_procs = El::mpi::Size(c);
+  const size_t size = values.size();
+  const size_t k = std::min(
+    size,
+    std::max(size_t(1), static_cast<size_t>(std::ceil(m_ratio * size))));
+
+  // Add error feedback and choose largest entries
+  if (m_residual.size() != size) {
+    m_residual.assign(size, 0.f);
+  }
+  for (size_t i = 0; i < size; ++i) {
+    m_residual[i] += values[i];
+  }
+  std::vector<int> indices(size);
+  std::iota(indices.begin(), indices.end(), 0);
+  std::nth_element(indices.begin(), indices.begin() + (k - 1), indices.end(),
+                   [this](int a, int b) {
+                     return std::fabs(m_residual[a]) > std::fabs(m_residual[b]);
+                   });
+  indices.resize(k);
+  std::vector<float> send_values(k);
+  for (size_t i = 0; i < k; ++i) {
+    send_values[i] = m_residual[indices[i]];
+    m_residual[indices[i]] = 0.f;
+  }
+
+  // Sum sparse contributions
+  std::vector<int> recv_indices(k * num_procs);
+  std::vector<float> recv_values(k * num_procs);
+  comm.all_gather(indices.data(), k, recv_indices.data(), k, c);
+  comm.all_gather(send_values.data(), k, recv_values.data(), k, c);
+  std::fill(values.begin(), values.end(), 0.f);
+  for (size_t i = 0; i < recv_indices.size(); ++i) {
+    values[recv_indices[i]] += recv_values[i];
+  }
+
+  const size_t bytes_sent = k * (sizeof(int) + sizeof(float));
+  return bytes_sent;
+
+}
+
+// =============================
+// Sign compression
+// =============================
+
+template <typename TensorDataType>
+size_t sign_compressor<TensorDataType>::allreduce_values(
+  lbann_comm& comm,
+  const El::mpi::Comm& c,
+  std::vector<float>& values) {
+  const int num_procs = El::mpi::Size(c);
+  const size_t size = values.size();
+  const size_t num_bytes = (size + 7) / 8;
+
+  // Add error feedback and quantize
+  if (m_residual.size() != size) {
+    m_residual.assign(size, 0.f);
+  }
+  double sum_abs = 0;
+  for (size_t i = 0; i < size; ++i) {
+    m_residual[i] += values[i];
+    sum_abs += std::fabs(m_residual[i]);
+  }
+  float scale = static_cast<float>(sum_abs / size);
+  std::vector<El::byte> signs(num_bytes, 0);
+  for (size_t i = 0; i < size; ++i) {
+    if (m_residual[i] >= 0.f) {
+      signs[i / 8] |= El::byte(1) << (i % 8);
+      m_residual[i] -= scale;
+    } else {
+      m_residual[i] += scale;
+    }
+  }
+
+  // Sum quantized contributions
+  std::vector<El::byte> recv_signs(num_bytes * num_procs);
+  std::vector<float> recv_scales(num_procs);
+  comm.all_gather(signs.data(), num_bytes, recv_signs.data(), num_bytes, c);
+  comm.all_gather(scale, recv_scales, c);
+  std::fill(values.begin(), values.end(), 0.f);
+  for (int proc = 0; proc < num_procs; ++proc) {
+    const auto* proc_signs = recv_signs.data() + proc * num_bytes;
+    const float proc_scale = recv_scales[proc];
+    for (size_t i = 0; i < size; ++i) {
+      const bool positive = (proc_signs[i / 8] >> (i % 8)) & 1;
+      values[i] += positive ? proc_scale : -proc_scale;
+    }
+  }
+
+  const size_t bytes_sent = num_bytes + sizeof(float);
+  return bytes_sent;
+
+}
+
+#define PROTO(T)                                \
+  template class gradient_compressor<T>;        \
+  template class half_precision_compressor<T>;  \
+  template class topk_compressor<T>;            \
+  template class sign_compressor<T>
+
+#define LBANN_INSTANTIATE_CPU_HALF
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#define LBANN_GRADIENT_UNSCALING_INSTANTIATE
+#include "lbann/optimizers/gradient_unscaling.hpp"
+#include "lbann/utils/exception.hpp"
+
+#include <cmath>
+
+namespace lbann {
+
+template <typename TensorDataType>
+auto gradient_unscale_queue<TensorDataType>::get_queue(El::Device device)
+  -> std::vector<MatrixType*>& {
+  static std::vector<MatrixType*> cpu_queue;
+#ifdef LBANN_HAS_GPU
+  static std::vector<MatrixType*> gpu_queue;
+#endif // LBANN_HAS_GPU
+  switch (device) {
+  case El::Device::CPU: return cpu_queue;
+#ifdef LBANN_HAS_GPU
+  case El::Device::GPU: return gpu_queue;
+#endif // LBANN_HAS_GPU
+  default: LBANN_ERROR("invalid device");
+  }
+}
+
+template <typename TensorDataType>
+void gradient_unscale_queue<TensorDataType>::enqueue(MatrixType& gradient) {
+  if (gradient.Height() > 0 && gradient.Width() > 0) {
+    get_queue(gradient.GetDevice()).push_back(&gradient);
+  }
+}
+
+template <typename TensorDataType>
+bool gradient_unscale_queue<TensorDataType>::flush(TensorDataType scale) {
+  bool finite = true;
+  auto& cpu_queue = get_queue(El::Device::CPU);
+  if (!cpu_queue.empty()) {
+    finite = flush_cpu(cpu_queue, scale) && finite;
+    cpu_queue.clear();
+  }
+#ifdef LBANN_HAS_GPU
+  auto& gpu_queue = get_queue(El::Device::GPU);
+  if (!gpu_queue.empty()) {
+    finite = flush_gpu(gpu_queue, scale) && finite;
+    gpu_queue.clear();
+  }
+#endif // LBANN_HAS_GPU
+  return finite;
+}
+
+template <typename TensorDataType>
+bool gradient_unscale_queue<TensorDataType>::flush_cpu(
+  std::vector<MatrixType*>& queue,
+  TensorDataType scale) {
+  int num_nonfinite = 0;
+  for (auto* mat : queue) {
+    const El::Int height = mat->Height();
+    const El::Int width = mat->Width();
+    const El::Int ldim = mat->LDim();
+    auto* __restrict__ buffer = mat->Buffer();
+    LBANN_OMP_PARALLEL_FOR_ARGS(reduction(+:num_nonfinite) collapse(2))
+    for (El::Int col = 0; col < width; ++col) {
+      for (El::Int row = 0; row < height; ++row) {
+        auto& x = buffer[row + col * ldim];
+        x *= scale;
+        if (!std::isfinite(El::To<EvalType>(x))) { ++num_nonfinite; }
+      }
+    }
+  }
+  return num_nonfinite == 0;
+}
+
+bool flush_gradient_unscaling(EvalType scale) {
+  bool finite = true;
+#define PROTO(T)                                                        \
+  finite = gradient_unscale_queue<T>::flush(El::To<T>(scale)) && finite
+#define LBANN_INSTANTIATE_CPU_HALF
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+#undef PROTO
+#undef LBANN_INSTANTIATE_CPU_HALF
+#undef LBANN_INSTANTIATE_GPU_HALF
+  return finite;
+}
+
+#define PROTO(T)                           \
+  template class gradient_unscale_queue<T>
+
+#define LBANN_INSTANTIATE_CPU_HALF
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
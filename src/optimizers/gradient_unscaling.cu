@@ -0,0 +1,167 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#define LBANN_GRADIENT_UNSCALING_INSTANTIATE
+#include "lbann/optimizers/gradient_unscaling.hpp"
+#include "lbann/utils/cuda.hpp"
+#include "lbann/utils/exception.hpp"
+
+namespace lbann {
+
+namespace {
+
+/** Number of entries processed by one CUDA block. */
+constexpr size_t chunk_size = 65536;
+constexpr size_t block_size = 256;
+constexpr size_t max_matrices = 48;
+constexpr size_t max_blocks = 256;
+
+template <typename TensorDataType>
+struct unscale_matrix {
+  TensorDataType* buffer;
+  size_t height;
+  size_t size;
+  size_t ldim;
+};
+
+/** @brief Kernel argument listing the matrices of one launch.
+ *
+ *  Block @c i processes chunk @c block_chunk[i] of matrix
+ *  @c block_matrix[i]. CUDA limits kernel arguments to 4 KB.
+ */
+template <typename TensorDataType>
+struct unscale_table {
+  unscale_matrix<TensorDataType> matrices[max_matrices];
+  int block_matrix[max_blocks];
+  int block_chunk[max_blocks];
+};
+
+template <typename TensorDataType>
+__global__ void unscale_kernel(unscale_table<TensorDataType> table,
+                               TensorDataType scale,
+                               int* __restrict__ nonfinite) {
+  const auto& m = table.matrices[table.block_matrix[blockIdx.x]];
+  const size_t start = table.block_chunk[blockIdx.x] * chunk_size;
+  const size_t end = (start + chunk_size < m.size
+                      ? start + chunk_size
+                      : m.size);
+  bool finite = true;
+  for (size_t pos = start + threadIdx.x; pos < end; pos += blockDim.x) {
+    const size_t row = pos % m.height;
+    const size_t col = pos / m.height;
+    auto& x = m.buffer[row + col * m.ldim];
+    x *= scale;
+    finite = finite && cuda::isfinite(x);
+  }
+  if (!finite) { *nonfinite = 1; }
+}
+
+template <typename TensorDataType>
+void launch_unscale(const unscale_table<TensorDataType>& table,
+                    size_t num_blocks,
+                    TensorDataType scale,
+                    int* nonfinite) {
+  static_assert(sizeof(unscale_table<TensorDataType>) <= 4096,
+                "unscale table exceeds CUDA kernel argument limit");
+  if (num_blocks == 0) { return; }
+  unscale_kernel<TensorDataType>
+    <<<num_blocks, block_size, 0, El::GPUManager::Stream()>>>(
+      table, scale, nonfinite);
+}
+
+} // namespace
+
+template <typename TensorDataType>
+bool gradient_unscale_queue<TensorDataType>::flush_gpu(
+  std::vector<MatrixType*>& queue,
+  TensorDataType scale) {
+  auto&& stream = El::GPUManager::Stream();
+  cuda::thrust::vector<int> nonfinite(1);
+  CHECK_CUDA(cudaMemsetAsync(nonfinite.data().get(), 0, sizeof(int), stream));
+
+  // Fill tables with matrix chunks, launching whenever a table is
+  // full. Large matrices may be split across launches.
+  unscale_table<TensorDataType> table;
+  size_t num_matrices = 0, num_blocks = 0;
+  for (auto* mat : queue) {
+    const unscale_matrix<TensorDataType> m = {
+      mat->Buffer(),
+      static_cast<size_t>(mat->Height()),
+      static_cast<size_t>(mat->Height() * mat->Width()),
+      static_cast<size_t>(mat->LDim())};
+    const size_t num_chunks = (m.size + chunk_size - 1) / chunk_size;
+    bool in_table = false;
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+      if (!in_table) {
+        if (num_matrices == max_matrices) {
+          launch_unscale(table, num_blocks, scale, nonfinite.data().get());
+          num_matrices = 0;
+          num_blocks = 0;
+        }
+        table.matrices[num_matrices++] = m;
+        in_table = true;
+      }
+      table.block_matrix[num_blocks] = num_matrices - 1;
+      table.block_chunk[num_blocks] = chunk;
+      if (++num_blocks == max_blocks) {
+        launch_unscale(table, num_blocks, scale, nonfinite.data().get());
+        num_matrices = 0;
+        num_blocks = 0;
+        in_table = false;
+      }
+    }
+  }
+  launch_unscale(table, num_blocks, scale, nonfinite.data().get());
+
+  // Only the flag is copied back to the host
+  int host_nonfinite = 0;
+  CHECK_CUDA(cudaMemcpyAsync(&host_nonfinite,
+                             nonfinite.data().get(),
+                             sizeof(int),
+                             cudaMemcpyDeviceToHost,
+                             stream));
+  CHECK_CUDA(cudaStreamSynchronize(stream));
+  return host_nonfinite == 0;
+}
+
+#ifdef LBANN_HAS_HALF
+template <>
+bool gradient_unscale_queue<cpu_fp16>::flush_gpu(
+  std::vector<MatrixType*>&, cpu_fp16) {
+  LBANN_ERROR("Can't call this function with cpu_fp16!");
+  return false;
+}
+#endif // LBANN_HAS_HALF
+
+#define PROTO(T)                                                        \
+  template bool gradient_unscale_queue<T>::flush_gpu(                   \
+    std::vector<El::AbstractMatrix<T>*>&, T)
+
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
@@ -58,7 +58,16 @@ hypergradient_adam<TensorDataType>::hypergradient_adam(const hypergradient_adam&
     m_moment1(other.m_moment1 ? other.m_moment1->Copy() : nullptr),
     m_moment2(other.m_moment2 ? other.m_moment2->Copy() : nullptr),
     m_old_gradient(other.m_old_gradient ?
-                   other.m_old_gradient->Copy() : nullptr) {}
+                   other.m_old_gradient->Copy() : nullptr) {
+  this->set_learning_rate(other.get_current_learning_rate());
+}
+
+template <typename TensorDataType>
+hypergradient_adam<TensorDataType>::~hypergradient_adam() {
+#ifdef LBANN_HAS_CUDA
+  free_device_state();
+#endif // LBANN_HAS_CUDA
+}
 
 template <typename TensorDataType>
 hypergradient_adam<TensorDataType>& hypergradient_adam<TensorDataType>::operator=(const hypergradient_adam<TensorDataType>& other) {
@@ -73,12 +82,34 @@ hypergradient_adam<TensorDataType>& hypergradient_adam<TensorDataType>::operator
   m_moment2.reset(other.m_moment2 ? other.m_moment2->Copy() : nullptr);
   m_old_gradient.reset(other.m_old_gradient ?
                        other.m_old_gradient->Copy() : nullptr);
+  this->set_learning_rate(other.get_current_learning_rate());
+#ifdef LBANN_HAS_CUDA
+  free_device_state();
+#endif // LBANN_HAS_CUDA
   return *this;
 }
 
+template <typename TensorDataType>
+TensorDataType hypergradient_adam<TensorDataType>::get_current_learning_rate() const {
+#ifdef LBANN_HAS_CUDA
+  if (m_device_state != nullptr) { return get_device_learning_rate(); }
+#endif // LBANN_HAS_CUDA
+  return this->get_learning_rate();
+}
+
+template <typename TensorDataType>
+void hypergradient_adam<TensorDataType>::sync_learning_rate() {
+  const auto learning_rate = get_current_learning_rate();
+  this->set_learning_rate(learning_rate);
+#ifdef LBANN_HAS_CUDA
+  m_device_learning_rate_source = learning_rate;
+#endif // LBANN_HAS_CUDA
+}
+
 template <typename TensorDataType>
 description hypergradient_adam<TensorDataType>::get_description() const {
   auto desc = OptimizerType::get_description();
+  desc.add("Current learning rate", get_current_learning_rate());
   desc.add("Hypergradient learning rate", m_hyper_learning_rate);
   desc.add("beta1", m_beta1);
   desc.add("beta2", m_beta2);
@@ -101,16 +132,22 @@ void hypergradient_adam<TensorDataType>::setup(WeightsType* w) {
 template <typename TensorDataType>
 void hypergradient_adam<TensorDataType>::step_compute(AbsDistMatrixType& values,
                                                       const AbsDistMatrixType& gradient) {
-  if (values.GetLocalDevice() != El::Device::CPU) {
-    LBANN_ERROR("hypergradient Adam is only supported on CPU");
-  }
-
   // Precompute the bias correction.
   m_current_beta1 *= m_beta1;
   m_current_beta2 *= m_beta2;
   const TensorDataType correction = El::Sqrt(TensorDataType(1.) - m_current_beta2) /
                               (TensorDataType(1.) - m_current_beta1);
 
+  switch (values.GetLocalDevice()) {
+  case El::Device::CPU: break;
+#ifdef LBANN_HAS_CUDA
+  case El::Device::GPU: step_compute_gpu(values, gradient, correction); return;
+#endif // LBANN_HAS_CUDA
+  default:
+    LBANN_ERROR("unsupported device type "
+                "(", static_cast<int>(values.GetLocalDevice()), ")");
+  }
+
   // Get local matrix data
   const size_t local_height = values.LocalHeight();
   const size_t local_width = values.LocalWidth();
@@ -151,6 +188,7 @@ void hypergradient_adam<TensorDataType>::step_compute(AbsDistMatrixType& values,
 
 template <typename TensorDataType>
 bool hypergradient_adam<TensorDataType>::save_to_checkpoint_shared(persist& p, std::string name_prefix) {
+  sync_learning_rate();
   if (this->get_comm().am_trainer_master()) {
     write_cereal_archive(*this, p, "hypergradient_adam.xml");
   }
@@ -171,6 +209,9 @@ bool hypergradient_adam<TensorDataType>::save_to_checkpoint_shared(persist& p, s
 template <typename TensorDataType>
 bool hypergradient_adam<TensorDataType>::load_from_checkpoint_shared(persist& p, std::string name_prefix) {
   load_from_shared_cereal_archive(*this, p, this->get_comm(), "hypergradient_adam.xml");
+#ifdef LBANN_HAS_CUDA
+  free_device_state();
+#endif // LBANN_HAS_CUDA
 
   char l_name[512];
   sprintf(l_name, "%s_optimizer_adam_moment1_%lldx%lld.bin", name_prefix.c_str(), m_moment1->Height(), m_moment2->Width());
@@ -186,6 +227,7 @@ bool hypergradient_adam<TensorDataType>::load_from_checkpoint_shared(persist& p,
 
 template <typename TensorDataType>
 bool hypergradient_adam<TensorDataType>::save_to_checkpoint_distributed(persist& p, std::string name_prefix) {
+  sync_learning_rate();
   write_cereal_archive(*this, p, "hypergradient_adam.xml");
 
   char l_name[512];
@@ -204,6 +246,9 @@ bool hypergradient_adam<TensorDataType>::save_to_checkpoint_distributed(persist&
 template <typename TensorDataType>
 bool hypergradient_adam<TensorDataType>::load_from_checkpoint_distributed(persist& p, std::string name_prefix) {
   read_cereal_archive(*this, p, "hypergradient_adam.xml");
+#ifdef LBANN_HAS_CUDA
+  free_device_state();
+#endif // LBANN_HAS_CUDA
 
   char l_name[512];
   sprintf(l_name, "%s_optimizer_adam_moment1_%lldx%lld", name_prefix.c_str(), m_moment1->Height(), m_moment2->Width());
@@ -0,0 +1,206 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/optimizers/hypergradient_adam.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <algorithm>
+
+namespace lbann {
+
+namespace {
+
+/** Local dot product, accumulated into @c result. */
+template <size_t bsize, typename TensorDataType>
+__global__ void dot_kernel(size_t height,
+                           size_t width,
+                           const TensorDataType * __restrict__ x,
+                           size_t x_ldim,
+                           const TensorDataType * __restrict__ y,
+                           size_t y_ldim,
+                           TensorDataType * __restrict__ result) {
+  const size_t gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const size_t num_threads = blockDim.x * gridDim.x;
+  TensorDataType sum = TensorDataType(0);
+  for (size_t pos = gid; pos < height * width; pos += num_threads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    sum += x[row + col * x_ldim] * y[row + col * y_ldim];
+  }
+  sum = cuda::block_reduce<bsize,1,1>(sum);
+  if (threadIdx.x == 0) { cuda::atomic_add(result, sum); }
+}
+
+/** state[0] += hyper_learning_rate * state[1] */
+template <typename TensorDataType>
+__global__ void learning_rate_kernel(TensorDataType hyper_learning_rate,
+                                     TensorDataType * __restrict__ state) {
+  state[0] += hyper_learning_rate * state[1];
+}
+
+template <typename TensorDataType>
+__global__ void hypergradient_adam_kernel(size_t height,
+                                          size_t width,
+                                          TensorDataType correction,
+                                          TensorDataType eps,
+                                          TensorDataType beta1,
+                                          TensorDataType beta2,
+                                          const TensorDataType * __restrict__ learning_rate,
+                                          TensorDataType * __restrict__ values,
+                                          size_t values_ldim,
+                                          const TensorDataType * __restrict__ gradient,
+                                          size_t gradient_ldim,
+                                          TensorDataType * __restrict__ moment1,
+                                          size_t moment1_ldim,
+                                          TensorDataType * __restrict__ moment2,
+                                          size_t moment2_ldim,
+                                          TensorDataType * __restrict__ old_gradient,
+                                          size_t old_gradient_ldim) {
+  const size_t gid = threadIdx.x + blockIdx.x * blockDim.x;
+  if (gid < height * width) {
+    const auto& row = gid % height;
+    const auto& col = gid / height;
+    const auto lr = *learning_rate;
+    const auto& g = gradient[row + col * gradient_ldim] + eps;
+    auto& m1 = moment1[row + col * moment1_ldim];
+    auto& m2 = moment2[row + col * moment2_ldim];
+    auto& old_c = old_gradient[row + col * old_gradient_ldim];
+    auto& x = values[row + col * values_ldim];
+    m1 = beta1 * m1 + (TensorDataType(1) - beta1) * g;
+    m2 = beta2 * m2 + (TensorDataType(1) - beta2) * g * g;
+    old_c = correction * m1 / (cuda::sqrt(m2) + eps);
+    x -= lr * old_c;
+  }
+}
+
+} // namespace
+
+template <typename TensorDataType>
+void hypergradient_adam<TensorDataType>::step_compute_gpu(AbsDistMatrixType& values,
+                                                          const AbsDistMatrixType& gradient,
+                                                          const TensorDataType& correction) {
+  auto&& stream = El::GPUManager::Stream();
+
+  // Send the host learning rate if it is new
+  const auto host_learning_rate = this->get_learning_rate();
+  if (m_device_state == nullptr) {
+    CHECK_CUDA(cudaMalloc(&m_device_state, 2 * sizeof(TensorDataType)));
+    m_device_learning_rate_source = host_learning_rate;
+    CHECK_CUDA(cudaMemcpyAsync(m_device_state, &host_learning_rate,
+                               sizeof(TensorDataType),
+                               cudaMemcpyHostToDevice, stream));
+  } else if (host_learning_rate != m_device_learning_rate_source) {
+    m_device_learning_rate_source = host_learning_rate;
+    CHECK_CUDA(cudaMemcpyAsync(m_device_state, &host_learning_rate,
+                               sizeof(TensorDataType),
+                               cudaMemcpyHostToDevice, stream));
+  }
+
+  // Hypergradient, reduced on the device
+  const size_t local_height = values.LocalHeight();
+  const size_t local_width = values.LocalWidth();
+  const size_t local_size = local_height * local_width;
+  constexpr size_t block_size = 256;
+  CHECK_CUDA(cudaMemsetAsync(m_device_state + 1, 0,
+                             sizeof(TensorDataType), stream));
+  if (local_size > 0) {
+    const size_t grid_size = std::min((local_size + block_size - 1) / block_size,
+                                      size_t(65535));
+    dot_kernel<block_size><<<grid_size, block_size, 0, stream>>>(
+      local_height, local_width,
+      gradient.LockedBuffer(), gradient.LDim(),
+      m_old_gradient->LockedBuffer(), m_old_gradient->LDim(),
+      m_device_state + 1);
+  }
+  El::Matrix<TensorDataType, El::Device::GPU> dot;
+  dot.Attach(1, 1, m_device_state + 1, 1);
+  this->get_comm().allreduce(dot, values.DistComm());
+
+  // Learning rate update and Adam step
+  learning_rate_kernel<<<1, 1, 0, stream>>>(m_hyper_learning_rate,
+                                             m_device_state);
+  if (local_size > 0) {
+    const size_t grid_size = (local_size + block_size - 1) / block_size;
+    hypergradient_adam_kernel<<<grid_size, block_size, 0, stream>>>(
+      local_height, local_width, correction, m_eps, m_beta1, m_beta2,
+      m_device_state,
+      values.Buffer(), values.LDim(),
+      gradient.LockedBuffer(), gradient.LDim(),
+      m_moment1->Buffer(), m_moment1->LDim(),
+      m_moment2->Buffer(), m_moment2->LDim(),
+      m_old_gradient->Buffer(), m_old_gradient->LDim());
+  }
+  CHECK_CUDA(cudaGetLastError());
+
+}
+
+template <typename TensorDataType>
+TensorDataType hypergradient_adam<TensorDataType>::get_device_learning_rate() const {
+  TensorDataType learning_rate;
+  auto&& stream = El::GPUManager::Stream();
+  CHECK_CUDA(cudaMemcpyAsync(&learning_rate, m_device_state,
+                             sizeof(TensorDataType),
+                             cudaMemcpyDeviceToHost, stream));
+  CHECK_CUDA(cudaStreamSynchronize(stream));
+  return learning_rate;
+}
+
+template <typename TensorDataType>
+void hypergradient_adam<TensorDataType>::free_device_state() {
+  if (m_device_state != nullptr) {
+    CHECK_CUDA(cudaFree(m_device_state));
+    m_device_state = nullptr;
+  }
+}
+
+#ifdef LBANN_HAS_HALF
+template <>
+void hypergradient_adam<cpu_fp16>::step_compute_gpu(AbsDistMatrixType&,
+                                                    const AbsDistMatrixType&,
+                                                    const cpu_fp16&) {
+  LBANN_ERROR("Can't call this function with cpu_fp16!");
+}
+template <>
+cpu_fp16 hypergradient_adam<cpu_fp16>::get_device_learning_rate() const {
+  LBANN_ERROR("Can't call this function with cpu_fp16!");
+  return cpu_fp16(0.);
+}
+template <>
+void hypergradient_adam<cpu_fp16>::free_device_state() {}
+#endif // LBANN_HAS_HALF
+
+#define PROTO(T)                                                \
+  template void hypergradient_adam<T>::step_compute_gpu(        \
+    El::AbstractDistMatrix<T>&,                                 \
+    const El::AbstractDistMatrix<T>&, const T&);                \
+  template T hypergradient_adam<T>::get_device_learning_rate() const; \
+  template void hypergradient_adam<T>::free_device_state()
+
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
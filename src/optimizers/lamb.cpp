@@ -0,0 +1,269 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/optimizers/lamb.hpp"
+#include "lbann/utils/exception.hpp"
+#include "lbann/utils/memory.hpp"
+
+#include <cmath>
+
+namespace lbann {
+
+template <typename TensorDataType>
+lamb<TensorDataType>::lamb(TensorDataType learning_rate,
+                           TensorDataType beta1,
+                           TensorDataType beta2,
+                           TensorDataType eps,
+                           TensorDataType weight_decay)
+  : OptimizerType(learning_rate),
+    m_beta1(beta1),
+    m_beta2(beta2),
+    m_eps(eps),
+    m_weight_decay(weight_decay),
+    m_current_beta1(1.),
+    m_current_beta2(1.) {}
+
+template <typename TensorDataType>
+lamb<TensorDataType>::lamb(const lamb& other)
+  : OptimizerType(other),
+    m_beta1(other.m_beta1),
+    m_beta2(other.m_beta2),
+    m_eps(other.m_eps),
+    m_weight_decay(other.m_weight_decay),
+    m_current_beta1(other.m_current_beta1),
+    m_current_beta2(other.m_current_beta2),
+    m_moment1(other.m_moment1 ? other.m_moment1->Copy() : nullptr),
+    m_moment2(other.m_moment2 ? other.m_moment2->Copy() : nullptr) {}
+
+template <typename TensorDataType>
+lamb<TensorDataType>& lamb<TensorDataType>::operator=(const lamb<TensorDataType>& other) {
+  OptimizerType::operator=(other);
+  m_beta1 = other.m_beta1;
+  m_beta2 = other.m_beta2;
+  m_eps = other.m_eps;
+  m_weight_decay = other.m_weight_decay;
+  m_current_beta1 = other.m_current_beta1;
+  m_current_beta2 = other.m_current_beta2;
+  m_moment1.reset(other.m_moment1 ? other.m_moment1->Copy() : nullptr);
+  m_moment2.reset(other.m_moment2 ? other.m_moment2->Copy() : nullptr);
+  return *this;
+}
+
+template <typename TensorDataType>
+description lamb<TensorDataType>::get_description() const {
+  auto desc = OptimizerType::get_description();
+  desc.add("beta1", m_beta1);
+  desc.add("beta2", m_beta2);
+  desc.add("eps", m_eps);
+  desc.add("Weight decay", m_weight_decay);
+  return desc;
+}
+
+template <typename TensorDataType>
+void lamb<TensorDataType>::setup(WeightsType* w) {
+  OptimizerType::setup(w);
+  const auto& gradient = this->get_gradient();
+  m_moment1.reset(AbsDistMatrixType::Instantiate(gradient.DistData()));
+  m_moment2.reset(AbsDistMatrixType::Instantiate(gradient.DistData()));
+  El::Zeros(*m_moment1, gradient.Height(), gradient.Width());
+  El::Zeros(*m_moment2, gradient.Height(), gradient.Width());
+}
+
+template <typename TensorDataType>
+void lamb<TensorDataType>::step_compute(AbsDistMatrixType& values,
+                                        const AbsDistMatrixType& gradient) {
+  // Bias corrections
+  m_current_beta1 *= m_beta1;
+  m_current_beta2 *= m_beta2;
+  const TensorDataType correction1 = TensorDataType(1.) - m_current_beta1;
+  const TensorDataType correction2 = TensorDataType(1.) - m_current_beta2;
+
+  switch (values.GetLocalDevice()) {
+  case El::Device::CPU:
+    step_compute_cpu(values, gradient, correction1, correction2);
+    break;
+#ifdef LBANN_HAS_CUDA
+  case El::Device::GPU:
+    step_compute_gpu(values, gradient, correction1, correction2);
+    break;
+#endif // LBANN_HAS_CUDA
+  default:
+    LBANN_ERROR("unsupported device type "
+                "(", static_cast<int>(values.GetLocalDevice()), ")");
+  }
+}
+
+template <typename TensorDataType>
+void lamb<TensorDataType>::step_compute_cpu(AbsDistMatrixType& values,
+                                            const AbsDistMatrixType& gradient,
+                                            const TensorDataType& correction1,
+                                            const TensorDataType& correction2) {
+
+  // Get local matrix data
+  const size_t local_height = values.LocalHeight();
+  const size_t local_width = values.LocalWidth();
+  auto* __restrict__ values_buffer = values.Buffer();
+  const size_t values_ldim = values.LDim();
+  const auto* __restrict__ gradient_buffer = gradient.LockedBuffer();
+  const size_t gradient_ldim = gradient.LDim();
+  auto* __restrict__ moment1_buffer = m_moment1->Buffer();
+  const size_t moment1_ldim = m_moment1->LDim();
+  auto* __restrict__ moment2_buffer = m_moment2->Buffer();
+  const size_t moment2_ldim = m_moment2->LDim();
+
+  // Update moments and accumulate squared norms of weights and
+  // update in one pass
+  EvalType values_sqsum = 0, update_sqsum = 0;
+  LBANN_OMP_PARALLEL_FOR_ARGS(reduction(+:values_sqsum,update_sqsum) collapse(2))
+  for (size_t col = 0; col < local_width; ++col) {
+    for (size_t row = 0; row < local_height; ++row) {
+      const auto& x = values_buffer[row+col*values_ldim];
+      const auto& g = gradient_buffer[row+col*gradient_ldim];
+      auto& m1 = moment1_buffer[row+col*moment1_ldim];
+      auto& m2 = moment2_buffer[row+col*moment2_ldim];
+      m1 = m_beta1 * m1 + (TensorDataType(1.) - m_beta1) * g;
+      m2 = m_beta2 * m2 + (TensorDataType(1.) - m_beta2) * g * g;
+      const EvalType u = ((m1 / correction1)
+                          / (El::Sqrt(m2 / correction2) + m_eps)
+                          + m_weight_decay * x);
+      const EvalType xd = x;
+      values_sqsum += xd * xd;
+      update_sqsum += u * u;
+    }
+  }
+  EvalType sqsums[2] = {values_sqsum, update_sqsum};
+  this->get_comm().allreduce(sqsums, 2, values.DistComm());
+
+  // Layer-wise trust ratio
+  const EvalType w_norm = std::sqrt(sqsums[0]);
+  const EvalType u_norm = std::sqrt(sqsums[1]);
+  EvalType trust = 1;
+  if (w_norm > EvalType(0) && u_norm > EvalType(0)) {
+    trust = w_norm / u_norm;
+  }
+  const auto scale = this->get_learning_rate() * TensorDataType(trust);
+
+  // LAMB step
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (size_t col = 0; col < local_width; ++col) {
+    for (size_t row = 0; row < local_height; ++row) {
+      auto& x = values_buffer[row+col*values_ldim];
+      const auto& m1 = moment1_buffer[row+col*moment1_ldim];
+      const auto& m2 = moment2_buffer[row+col*moment2_ldim];
+      const auto u = ((m1 / correction1)
+                      / (El::Sqrt(m2 / correction2) + m_eps)
+                      + m_weight_decay * x);
+      x -= scale * u;
+    }
+  }
+
+}
+
+// =============================================
+// Checkpointing
+// =============================================
+
+template <typename TensorDataType>
+bool lamb<TensorDataType>::save_to_checkpoint_shared(persist& p, std::string name_prefix) {
+  if (this->get_comm().am_trainer_master()) {
+    write_cereal_archive(*this, p, "lamb.xml");
+  }
+
+  char l_name[512];
+  sprintf(l_name, "%s_optimizer_lamb_moment1_%lldx%lld", name_prefix.c_str(), m_moment1->Height(), m_moment1->Width());
+  p.write_distmat(persist_type::train, l_name, m_moment1.get());
+
+  sprintf(l_name, "%s_optimizer_lamb_moment2_%lldx%lld", name_prefix.c_str(), m_moment2->Height(), m_moment2->Width());
+  p.write_distmat(persist_type::train, l_name, m_moment2.get());
+
+  return true;
+}
+
+template <typename TensorDataType>
+bool lamb<TensorDataType>::load_from_checkpoint_shared(persist& p, std::string name_prefix) {
+  load_from_shared_cereal_archive(*this, p, this->get_comm(), "lamb.xml");
+
+  char l_name[512];
+  sprintf(l_name, "%s_optimizer_lamb_moment1_%lldx%lld.bin", name_prefix.c_str(), m_moment1->Height(), m_moment1->Width());
+  p.read_distmat(persist_type::train, l_name, m_moment1.get());
+
+  sprintf(l_name, "%s_optimizer_lamb_moment2_%lldx%lld.bin", name_prefix.c_str(), m_moment2->Height(), m_moment2->Width());
+  p.read_distmat(persist_type::train, l_name, m_moment2.get());
+
+  return true;
+}
+
+template <typename TensorDataType>
+bool lamb<TensorDataType>::save_to_checkpoint_distributed(persist& p, std::string name_prefix) {
+  write_cereal_archive(*this, p, "lamb.xml");
+
+  char l_name[512];
+  sprintf(l_name, "%s_optimizer_lamb_moment1_%lldx%lld", name_prefix.c_str(), m_moment1->LocalHeight(), m_moment1->LocalWidth());
+  p.write_rank_distmat(persist_type::train, l_name, *m_moment1);
+
+  sprintf(l_name, "%s_optimizer_lamb_moment2_%lldx%lld", name_prefix.c_str(), m_moment2->LocalHeight(), m_moment2->LocalWidth());
+  p.write_rank_distmat(persist_type::train, l_name, *m_moment2);
+
+  return true;
+}
+
+template <typename TensorDataType>
+bool lamb<TensorDataType>::load_from_checkpoint_distributed(persist& p, std::string name_prefix) {
+  read_cereal_archive(*this, p, "lamb.xml");
+
+  char l_name[512];
+  sprintf(l_name, "%s_optimizer_lamb_moment1_%lldx%lld", name_prefix.c_str(), m_moment1->LocalHeight(), m_moment1->LocalWidth());
+  p.read_rank_distmat(persist_type::train, l_name, *m_moment1);
+
+  sprintf(l_name, "%s_optimizer_lamb_moment2_%lldx%lld", name_prefix.c_str(), m_moment2->LocalHeight(), m_moment2->LocalWidth());
+  p.read_rank_distmat(persist_type::train, l_name, *m_moment2);
+
+  return true;
+}
+
+template <typename TensorDataType>
+std::unique_ptr<optimizer>
+build_lamb_optimizer_from_pbuf(
+  google::protobuf::Message const& msg) {
+  const auto& params = dynamic_cast<lbann_data::Optimizer::LAMB const&>(msg);
+  return make_unique<lamb<TensorDataType>>(TensorDataType(params.learn_rate()),
+                                           TensorDataType(params.beta1()),
+                                           TensorDataType(params.beta2()),
+                                           TensorDataType(params.eps()),
+                                           TensorDataType(params.weight_decay()));
+}
+
+#define PROTO(T)                                \
+  template class lamb<T>;                       \
+  template std::unique_ptr<optimizer>           \
+  build_lamb_optimizer_from_pbuf<T>(            \
+    google::protobuf::Message const&)
+
+#define LBANN_INSTANTIATE_CPU_HALF
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+} // namespace lbann
@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/optimizers/lamb.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <algorithm>
+
+namespace lbann {
+
+namespace {
+
+/** Update moments and accumulate the local squared norms of the
+ *  weights and the update into @c sqsums[0] and @c sqsums[1].
+ */
+template <size_t bsize, typename TensorDataType>
+__global__ void lamb_moments_kernel(size_t height,
+                                    size_t width,
+                                    TensorDataType correction1,
+                                    TensorDataType correction2,
+                                    TensorDataType eps,
+                                    TensorDataType beta1,
+                                    TensorDataType beta2,
+                                    TensorDataType weight_decay,
+                                    const TensorDataType * __restrict__ values,
+                                    size_t values_ldim,
+                                    const TensorDataType * __restrict__ gradient,
+                                    size_t gradient_ldim,
+                                    TensorDataType * __restrict__ moment1,
+                                    size_t moment1_ldim,
+                                    TensorDataType * __restrict__ moment2,
+                                    size_t moment2_ldim,
+                                    TensorDataType * __restrict__ sqsums) {
+  const size_t gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const size_t num_threads = blockDim.x * gridDim.x;
+  TensorDataType values_sqsum = TensorDataType(0);
+  TensorDataType update_sqsum = TensorDataType(0);
+  for (size_t pos = gid; pos < height * width; pos += num_threads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    const auto& x = values[row + col * values_ldim];
+    const auto& g = gradient[row + col * gradient_ldim];
+    auto& m1 = moment1[row + col * moment1_ldim];
+    auto& m2 = moment2[row + col * moment2_ldim];
+    m1 = beta1 * m1 + (TensorDataType(1) - beta1) * g;
+    m2 = beta2 * m2 + (TensorDataType(1) - beta2) * g * g;
+    const auto u = ((m1 / correction1)
+                    / (cuda::sqrt(m2 / correction2) + eps)
+                    + weight_decay * x);
+    values_sqsum += x * x;
+    update_sqsum += u * u;
+  }
+  values_sqsum = cuda::block_reduce<bsize,1,1>(values_sqsum);
+  __syncthreads();
+  update_sqsum = cuda::block_reduce<bsize,1,1>(update_sqsum);
+  if (threadIdx.x == 0) {
+    cuda::atomic_add(&sqsums[0], values_sqsum);
+    cuda::atomic_add(&sqsums[1], update_sqsum);
+  }
+}
+
+template <typename TensorDataType>
+__global__ void lamb_kernel(size_t height,
+                            size_t width,
+                            TensorDataType learning_rate,
+                            TensorDataType correction1,
+                            TensorDataType correction2,
+                            TensorDataType eps,
+                            TensorDataType weight_decay,
+                            const TensorDataType * __restrict__ sqsums,
+                            TensorDataType * __restrict__ values,
+                            size_t values_ldim,
+                            const TensorDataType * __restrict__ moment1,
+                            size_t moment1_ldim,
+                            const TensorDataType * __restrict__ moment2,
+                            size_t moment2_ldim) {
+  const size_t gid = threadIdx.x + blockIdx.x * blockDim.x;
+  if (gid < height * width) {
+    const auto w_norm = cuda::sqrt(sqsums[0]);
+    const auto u_norm = cuda::sqrt(sqsums[1]);
+    auto trust = TensorDataType(1);
+    if (w_norm > TensorDataType(0) && u_norm > TensorDataType(0)) {
+      trust = w_norm / u_norm;
+    }
+    const auto& row = gid % height;
+    const auto& col = gid / height;
+    const auto& m1 = moment1[row + col * moment1_ldim];
+    const auto& m2 = moment2[row + col * moment2_ldim];
+    auto& x = values[row + col * values_ldim];
+    const auto u = ((m1 / correction1)
+                    / (cuda::sqrt(m2 / correction2) + eps)
+                    + weight_decay * x);
+    x -= learning_rate * trust * u;
+  }
+}
+
+} // namespace
+
+template <typename TensorDataType>
+void lamb<TensorDataType>::step_compute_gpu(AbsDistMatrixType& values,
+                                            const AbsDistMatrixType& gradient,
+                                            const TensorDataType& correction1,
+                                            const TensorDataType& correction2) {
+
+  // Get matrix dimensions
+  const size_t local_height = values.LocalHeight();
+  const size_t local_width = values.LocalWidth();
+  const size_t local_size = local_height * local_width;
+  constexpr size_t block_size = 256;
+  auto&& stream = El::GPUManager::Stream();
+
+  // Moment update with squared norms of weights and update, reduced
+  // on the device. Every rank joins the allreduce, even with no
+  // local data.
+  El::Matrix<TensorDataType, El::Device::GPU> sqsums;
+  sqsums.SetMemoryMode(1); // CUB GPU memory pool
+  sqsums.Resize(2, 1);
+  CHECK_CUDA(cudaMemsetAsync(sqsums.Buffer(), 0,
+                             2 * sizeof(TensorDataType), stream));
+  if (local_size > 0) {
+    const size_t grid_size = std::min((local_size + block_size - 1) / block_size,
+                                      size_t(65535));
+    lamb_moments_kernel<block_size><<<grid_size, block_size, 0, stream>>>(
+      local_height, local_width,
+      correction1, correction2, m_eps, m_beta1, m_beta2, m_weight_decay,
+      values.LockedBuffer(), values.LDim(),
+      gradient.LockedBuffer(), gradient.LDim(),
+      m_moment1->Buffer(), m_moment1->LDim(),
+      m_moment2->Buffer(), m_moment2->LDim(),
+      sqsums.Buffer());
+  }
+  this->get_comm().allreduce(sqsums, values.DistComm());
+
+  // LAMB step; the trust ratio is computed in the kernel
+  if (local_size > 0) {
+    const size_t grid_size = (local_size + block_size - 1) / block_size;
+    lamb_kernel<<<grid_size, block_size, 0, stream>>>(
+      local_height, local_width,
+      this->get_learning_rate(), correction1, correction2,
+      m_eps, m_weight_decay,
+      sqsums.LockedBuffer(),
+      values.Buffer(), values.LDim(),
+      m_moment1->LockedBuffer(), m_moment1->LDim(),
+      m_moment2->LockedBuffer(), m_moment2->LDim());
+  }
+  CHECK_CUDA(cudaGetLastError());
+
+}
+
+#ifdef LBANN_HAS_HALF
+template <>
+void lamb<cpu_fp16>::step_compute_gpu(AbsDistMatrixType&,
+                                      const AbsDistMatrixType&,
+                                      const cpu_fp16&,
+                                      const cpu_fp16&) {
+  LBANN_ERROR("Can't call this function with cpu_fp16!");
+}
+#endif // LBANN_HAS_HALF
+
+#define PROTO(T)                                        \
+  template void lamb<T>::step_compute_gpu(              \
+    El::AbstractDistMatrix<T>&,                         \
+    const El::AbstractDistMatrix<T>&, const T&, const T&)
+
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
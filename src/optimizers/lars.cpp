@@ -0,0 +1,227 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/optimizers/lars.hpp"
+#include "lbann/utils/exception.hpp"
+#include "lbann/utils/memory.hpp"
+
+#include <cmath>
+
+namespace lbann {
+
+template <typename TensorDataType>
+lars<TensorDataType>::lars(TensorDataType learning_rate,
+                           TensorDataType momentum,
+                           TensorDataType weight_decay,
+                           TensorDataType eta,
+                           TensorDataType eps)
+  : OptimizerType(learning_rate),
+    m_momentum(momentum),
+    m_weight_decay(weight_decay),
+    m_eta(eta),
+    m_eps(eps) {}
+
+template <typename TensorDataType>
+lars<TensorDataType>::lars(const lars& other)
+  : OptimizerType(other),
+    m_momentum(other.m_momentum),
+    m_weight_decay(other.m_weight_decay),
+    m_eta(other.m_eta),
+    m_eps(other.m_eps),
+    m_velocity(other.m_velocity ? other.m_velocity->Copy() : nullptr) {}
+
+template <typename TensorDataType>
+lars<TensorDataType>& lars<TensorDataType>::operator=(const lars<TensorDataType>& other) {
+  OptimizerType::operator=(other);
+  m_momentum = other.m_momentum;
+  m_weight_decay = other.m_weight_decay;
+  m_eta = other.m_eta;
+  m_eps = other.m_eps;
+  m_velocity.reset(other.m_velocity ?
+                   other.m_velocity->Copy() : nullptr);
+  return *this;
+}
+
+template <typename TensorDataType>
+description lars<TensorDataType>::get_description() const {
+  auto desc = OptimizerType::get_description();
+  desc.add("Momentum", m_momentum);
+  desc.add("Weight decay", m_weight_decay);
+  desc.add("Trust coefficient", m_eta);
+  desc.add("eps", m_eps);
+  return desc;
+}
+
+template <typename TensorDataType>
+void lars<TensorDataType>::setup(WeightsType* w) {
+  OptimizerType::setup(w);
+  const auto& gradient = this->get_gradient();
+  m_velocity.reset(AbsDistMatrixType::Instantiate(gradient.DistData()));
+  El::Zeros(*m_velocity, gradient.Height(), gradient.Width());
+}
+
+template <typename TensorDataType>
+void lars<TensorDataType>::step_compute(AbsDistMatrixType& values,
+                                        const AbsDistMatrixType& gradient) {
+  switch (values.GetLocalDevice()) {
+  case El::Device::CPU: step_compute_cpu(values, gradient); break;
+#ifdef LBANN_HAS_CUDA
+  case El::Device::GPU: step_compute_gpu(values, gradient); break;
+#endif // LBANN_HAS_CUDA
+  default:
+    LBANN_ERROR("unsupported device type "
+                "(", static_cast<int>(values.GetLocalDevice()), ")");
+  }
+}
+
+template <typename TensorDataType>
+void lars<TensorDataType>::step_compute_cpu(AbsDistMatrixType& values,
+                                            const AbsDistMatrixType& gradient) {
+
+  // Get local matrix data
+  const size_t local_height = values.LocalHeight();
+  const size_t local_width = values.LocalWidth();
+  auto* __restrict__ values_buffer = values.Buffer();
+  const size_t values_ldim = values.LDim();
+  const auto* __restrict__ gradient_buffer = gradient.LockedBuffer();
+  const size_t gradient_ldim = gradient.LDim();
+  auto* __restrict__ velocity_buffer = m_velocity->Buffer();
+  const size_t velocity_ldim = m_velocity->LDim();
+
+  // Squared norms of weights and gradient in one pass and one
+  // allreduce
+  EvalType values_sqsum = 0, gradient_sqsum = 0;
+  LBANN_OMP_PARALLEL_FOR_ARGS(reduction(+:values_sqsum,gradient_sqsum) collapse(2))
+  for (size_t col = 0; col < local_width; ++col) {
+    for (size_t row = 0; row < local_height; ++row) {
+      const EvalType x = values_buffer[row+col*values_ldim];
+      const EvalType g = gradient_buffer[row+col*gradient_ldim];
+      values_sqsum += x * x;
+      gradient_sqsum += g * g;
+    }
+  }
+  EvalType sqsums[2] = {values_sqsum, gradient_sqsum};
+  this->get_comm().allreduce(sqsums, 2, values.DistComm());
+
+  // Layer-wise trust ratio
+  const EvalType w_norm = std::sqrt(sqsums[0]);
+  const EvalType g_norm = std::sqrt(sqsums[1]);
+  EvalType trust = 1;
+  if (w_norm > EvalType(0) && g_norm > EvalType(0)) {
+    trust = (EvalType(m_eta) * w_norm
+             / (g_norm + EvalType(m_weight_decay) * w_norm + EvalType(m_eps)));
+  }
+  const auto scale = this->get_learning_rate() * TensorDataType(trust);
+
+  // Momentum step with the scaled gradient
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (size_t col = 0; col < local_width; ++col) {
+    for (size_t row = 0; row < local_height; ++row) {
+      auto& x = values_buffer[row+col*values_ldim];
+      const auto& g = gradient_buffer[row+col*gradient_ldim];
+      auto& v = velocity_buffer[row+col*velocity_ldim];
+      v = m_momentum * v + scale * (g + m_weight_decay * x);
+      x -= v;
+    }
+  }
+
+}
+
+// =============================================
+// Checkpointing
+// =============================================
+
+template <typename TensorDataType>
+bool lars<TensorDataType>::save_to_checkpoint_shared(persist& p, std::string name_prefix) {
+  if (this->get_comm().am_trainer_master()) {
+    write_cereal_archive(*this, p, "lars.xml");
+  }
+
+  char l_name[512];
+  sprintf(l_name, "%s_optimizer_velocity_%lldx%lld", name_prefix.c_str(), m_velocity->Height(), m_velocity->Width());
+  p.write_distmat(persist_type::train, l_name, m_velocity.get());
+
+  return true;
+}
+
+template <typename TensorDataType>
+bool lars<TensorDataType>::load_from_checkpoint_shared(persist& p, std::string name_prefix) {
+  load_from_shared_cereal_archive(*this, p, this->get_comm(), "lars.xml");
+
+  char l_name[512];
+  sprintf(l_name, "%s_optimizer_velocity_%lldx%lld.bin", name_prefix.c_str(), m_velocity->Height(), m_velocity->Width());
+  p.read_distmat(persist_type::train, l_name, m_velocity.get());
+
+  return true;
+}
+
+template <typename TensorDataType>
+bool lars<TensorDataType>::save_to_checkpoint_distributed(persist& p, std::string name_prefix) {
+  write_cereal_archive(*this, p, "lars.xml");
+
+  char l_name[512];
+  sprintf(l_name, "%s_optimizer_velocity_%lldx%lld", name_prefix.c_str(), m_velocity->LocalHeight(), m_velocity->LocalWidth());
+  p.write_rank_distmat(persist_type::train, l_name, *m_velocity);
+
+  return true;
+}
+
+template <typename TensorDataType>
+bool lars<TensorDataType>::load_from_checkpoint_distributed(persist& p, std::string name_prefix) {
+  read_cereal_archive(*this, p, "lars.xml");
+
+  char l_name[512];
+  sprintf(l_name, "%s_optimizer_velocity_%lldx%lld", name_prefix.c_str(), m_velocity->LocalHeight(), m_velocity->LocalWidth());
+  p.read_rank_distmat(persist_type::train, l_name, *m_velocity);
+
+  return true;
+}
+
+template <typename TensorDataType>
+std::unique_ptr<optimizer>
+build_lars_optimizer_from_pbuf(
+  google::protobuf::Message const& msg) {
+  const auto& params = dynamic_cast<lbann_data::Optimizer::LARS const&>(msg);
+  const auto eta = (params.eta() > 0 ? params.eta() : 0.001);
+  const auto eps = (params.eps() > 0 ? params.eps() : 1e-8);
+  return make_unique<lars<TensorDataType>>(TensorDataType(params.learn_rate()),
+                                           TensorDataType(params.momentum()),
+                                           TensorDataType(params.weight_decay()),
+                                           TensorDataType(eta),
+                                           TensorDataType(eps));
+}
+
+#define PROTO(T)                                \
+  template class lars<T>;                       \
+  template std::unique_ptr<optimizer>           \
+  build_lars_optimizer_from_pbuf<T>(            \
+    google::protobuf::Message const&)
+
+#define LBANN_INSTANTIATE_CPU_HALF
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+} // namespace lbann
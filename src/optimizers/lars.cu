@@ -0,0 +1,165 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/optimizers/lars.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <algorithm>
+
+namespace lbann {
+
+namespace {
+
+/** Local squared norms of @c x and @c y, accumulated into
+ *  @c sqsums[0] and @c sqsums[1].
+ */
+template <size_t bsize, typename TensorDataType>
+__global__ void sqsums_kernel(size_t height,
+                              size_t width,
+                              const TensorDataType * __restrict__ x,
+                              size_t x_ldim,
+                              const TensorDataType * __restrict__ y,
+                              size_t y_ldim,
+                              TensorDataType * __restrict__ sqsums) {
+  const size_t gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const size_t num_threads = blockDim.x * gridDim.x;
+  TensorDataType x_sqsum = TensorDataType(0);
+  TensorDataType y_sqsum = TensorDataType(0);
+  for (size_t pos = gid; pos < height * width; pos += num_threads) {
+    const auto& row = pos % height;
+    const auto& col = pos / height;
+    const auto& xi = x[row + col * x_ldim];
+    const auto& yi = y[row + col * y_ldim];
+    x_sqsum += xi * xi;
+    y_sqsum += yi * yi;
+  }
+  x_sqsum = cuda::block_reduce<bsize,1,1>(x_sqsum);
+  __syncthreads();
+  y_sqsum = cuda::block_reduce<bsize,1,1>(y_sqsum);
+  if (threadIdx.x == 0) {
+    cuda::atomic_add(&sqsums[0], x_sqsum);
+    cuda::atomic_add(&sqsums[1], y_sqsum);
+  }
+}
+
+template <typename TensorDataType>
+__global__ void lars_kernel(size_t height,
+                            size_t width,
+                            TensorDataType learning_rate,
+                            TensorDataType momentum,
+                            TensorDataType weight_decay,
+                            TensorDataType eta,
+                            TensorDataType eps,
+                            const TensorDataType * __restrict__ sqsums,
+                            TensorDataType * __restrict__ values,
+                            size_t values_ldim,
+                            const TensorDataType * __restrict__ gradient,
+                            size_t gradient_ldim,
+                            TensorDataType * __restrict__ velocity,
+                            size_t velocity_ldim) {
+  const size_t gid = threadIdx.x + blockIdx.x * blockDim.x;
+  if (gid < height * width) {
+    const auto w_norm = cuda::sqrt(sqsums[0]);
+    const auto g_norm = cuda::sqrt(sqsums[1]);
+    auto trust = TensorDataType(1);
+    if (w_norm > TensorDataType(0) && g_norm > TensorDataType(0)) {
+      trust = eta * w_norm / (g_norm + weight_decay * w_norm + eps);
+    }
+    const auto scale = learning_rate * trust;
+    const auto& row = gid % height;
+    const auto& col = gid / height;
+    const auto& g = gradient[row + col * gradient_ldim];
+    auto& v = velocity[row + col * velocity_ldim];
+    auto& x = values[row + col * values_ldim];
+    v = momentum * v + scale * (g + weight_decay * x);
+    x -= v;
+  }
+}
+
+} // namespace
+
+template <typename TensorDataType>
+void lars<TensorDataType>::step_compute_gpu(AbsDistMatrixType& values,
+                                            const AbsDistMatrixType& gradient) {
+
+  // Get matrix dimensions
+  const size_t local_height = values.LocalHeight();
+  const size_t local_width = values.LocalWidth();
+  const size_t local_size = local_height * local_width;
+  constexpr size_t block_size = 256;
+  auto&& stream = El::GPUManager::Stream();
+
+  // Squared norms of weights and gradient, reduced on the device.
+  // Every rank joins the allreduce, even with no local data.
+  El::Matrix<TensorDataType, El::Device::GPU> sqsums;
+  sqsums.SetMemoryMode(1); // CUB GPU memory pool
+  sqsums.Resize(2, 1);
+  CHECK_CUDA(cudaMemsetAsync(sqsums.Buffer(), 0,
+                             2 * sizeof(TensorDataType), stream));
+  if (local_size > 0) {
+    const size_t grid_size = std::min((local_size + block_size - 1) / block_size,
+                                      size_t(65535));
+    sqsums_kernel<block_size><<<grid_size, block_size, 0, stream>>>(
+      local_height, local_width,
+      values.LockedBuffer(), values.LDim(),
+      gradient.LockedBuffer(), gradient.LDim(),
+      sqsums.Buffer());
+  }
+  this->get_comm().allreduce(sqsums, values.DistComm());
+
+  // Momentum step; the trust ratio is computed in the kernel
+  if (local_size > 0) {
+    const size_t grid_size = (local_size + block_size - 1) / block_size;
+    lars_kernel<<<grid_size, block_size, 0, stream>>>(
+      local_height, local_width,
+      this->get_learning_rate(), m_momentum, m_weight_decay, m_eta, m_eps,
+      sqsums.LockedBuffer(),
+      values.Buffer(), values.LDim(),
+      gradient.LockedBuffer(), gradient.LDim(),
+      m_velocity->Buffer(), m_velocity->LDim());
+  }
+  CHECK_CUDA(cudaGetLastError());
+
+}
+
+#ifdef LBANN_HAS_HALF
+template <>
+void lars<cpu_fp16>::step_compute_gpu(AbsDistMatrixType&,
+                                      const AbsDistMatrixType&) {
+  LBANN_ERROR("Can't call this function with cpu_fp16!");
+}
+#endif // LBANN_HAS_HALF
+
+#define PROTO(T)                                \
+  template void lars<T>::step_compute_gpu(      \
+    El::AbstractDistMatrix<T>&,                 \
+    const El::AbstractDistMatrix<T>&)
+
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
@@ -51,7 +51,9 @@ optimizer::optimizer(const optimizer& other)
   : m_comm(other.m_comm),
     m_gradient_sources(other.m_gradient_sources),
     m_gradient_status(other.m_gradient_status),
-    m_step_time(other.m_step_time) {
+    m_step_time(other.m_step_time),
+    m_gradient_bytes_saved(other.m_gradient_bytes_saved),
+    m_gradient_allreduce_enabled(other.m_gradient_allreduce_enabled) {
   if (m_gradient_status == optimizer_gradient_status::allreduce_started) {
     LBANN_ERROR("attempted to copy optimizer while a "
                 "gradient allreduce is in progress");
@@ -63,6 +65,8 @@ optimizer& optimizer::operator=(const optimizer& other) {
   m_gradient_sources = other.m_gradient_sources;
   m_gradient_status = other.m_gradient_status;
   m_step_time = other.m_step_time;
+  m_gradient_bytes_saved = other.m_gradient_bytes_saved;
+  m_gradient_allreduce_enabled = other.m_gradient_allreduce_enabled;
   if (m_gradient_status == optimizer_gradient_status::allreduce_started) {
     LBANN_ERROR("attempted to copy optimizer while a "
                 "gradient allreduce is in progress");
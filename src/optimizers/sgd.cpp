@@ -112,6 +112,7 @@ void sgd<TensorDataType>::momentum_step_cpu(AbsDistMatrixType& values,
 
   // Get local matrix data
   const auto& learning_rate = this->get_learning_rate();
+  const auto decay = learning_rate * this->get_weight_decay();
   const size_t local_height = values.LocalHeight();
   const size_t local_width = values.LocalWidth();
   auto* __restrict__ values_buffer = values.Buffer();
@@ -130,7 +131,7 @@ void sgd<TensorDataType>::momentum_step_cpu(AbsDistMatrixType& values,
         const auto& g = gradient_buffer[i];
         auto& v = velocity_buffer[i];
         v = m_momentum * v + g;
-        x -= learning_rate * (m_momentum * v + g);
+        x -= learning_rate * (m_momentum * v + g) + decay * x;
       }
 
     } else {
@@ -142,7 +143,7 @@ void sgd<TensorDataType>::momentum_step_cpu(AbsDistMatrixType& values,
         const auto& g = gradient_buffer[i];
         auto& v = velocity_buffer[i];
         v = m_momentum * v + g;
-        x -= learning_rate * v;
+        x -= learning_rate * v + decay * x;
       }
 
     }
@@ -161,7 +162,7 @@ void sgd<TensorDataType>::momentum_step_cpu(AbsDistMatrixType& values,
         v = m_momentum * v + g;
         x -= (m_nesterov ?
               learning_rate * (m_momentum * v + g) :
-              learning_rate * v);
+              learning_rate * v) + decay * x;
       }
     }
 
@@ -25,6 +25,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lbann/optimizers/sgd.hpp"
+#include "lbann/optimizers/fused_step.hpp"
 
 namespace lbann {
 
@@ -35,6 +36,7 @@ __global__ void momentum_noncontiguous_kernel(size_t height,
                                               size_t width,
                                               TensorDataType learning_rate,
                                               TensorDataType momentum,
+                                              TensorDataType decay,
                                               TensorDataType * __restrict__ values,
                                               size_t values_ldim,
                                               const TensorDataType * __restrict__ gradient,
@@ -49,7 +51,7 @@ __global__ void momentum_noncontiguous_kernel(size_t height,
     auto& v = velocity[row + col * velocity_ldim];
     auto& x = values[row + col * values_ldim];
     v = momentum * v + g;
-    x -= learning_rate * v;
+    x -= learning_rate * v + decay * x;
   }
 }
 
@@ -57,6 +59,7 @@ template <typename TensorDataType>
 __global__ void momentum_contiguous_kernel(size_t size,
                                            TensorDataType learning_rate,
                                            TensorDataType momentum,
+                                           TensorDataType decay,
                                            TensorDataType * __restrict__ values,
                                            const TensorDataType * __restrict__ gradient,
                                            TensorDataType * __restrict__ velocity) {
@@ -66,7 +69,7 @@ __global__ void momentum_contiguous_kernel(size_t size,
     auto& v = velocity[gid];
     auto& x = values[gid];
     v = momentum * v + g;
-    x -= learning_rate * v;
+    x -= learning_rate * v + decay * x;
   }
 }
 
@@ -75,6 +78,7 @@ __global__ void nesterov_kernel(size_t height,
                                 size_t width,
                                 TensorDataType learning_rate,
                                 TensorDataType momentum,
+                                TensorDataType decay,
                                 TensorDataType * __restrict__ values,
                                 size_t values_ldim,
                                 const TensorDataType * __restrict__ gradient,
@@ -90,7 +94,7 @@ __global__ void nesterov_kernel(size_t height,
     auto& v = velocity[row + col * velocity_ldim];
     auto& x = values[row + col * values_ldim];
     v = momentum * v + g;
-    x -= learning_rate * (momentum * v + g);
+    x -= learning_rate * (momentum * v + g) + decay * x;
   }
 }
 
@@ -106,6 +110,21 @@ void sgd<TensorDataType>::momentum_step_gpu(AbsDistMatrixType& values,
   const size_t local_size = local_height * local_width;
   if (local_size <= 0) { return; }
 
+  const auto decay = this->get_learning_rate() * this->get_weight_decay();
+
+  // Defer to a fused kernel if possible
+  if (use_fused_optimizer_step()
+      && values.Contiguous() && gradient.Contiguous()
+      && m_velocity->Contiguous()) {
+    fused_step_queue<TensorDataType>::enqueue(
+      (m_nesterov ? fused_step_kind::nesterov : fused_step_kind::momentum),
+      {values.Buffer(), gradient.LockedBuffer(),
+       m_velocity->Buffer(), nullptr, local_size,
+       this->get_learning_rate(), m_momentum,
+       TensorDataType(0), TensorDataType(0), decay});
+    return;
+  }
+
   // Launch CUDA kernels for momentum SGD or NAG
   constexpr size_t block_size = 256;
   const size_t grid_size = (local_size + block_size - 1) / block_size;
@@ -113,7 +132,7 @@ void sgd<TensorDataType>::momentum_step_gpu(AbsDistMatrixType& values,
   if (m_nesterov) {
     nesterov_kernel<TensorDataType><<<grid_size, block_size, 0, stream>>>(
       local_height, local_width,
-      this->get_learning_rate(), m_momentum,
+      this->get_learning_rate(), m_momentum, decay,
       values.Buffer(), values.LDim(),
       gradient.LockedBuffer(), gradient.LDim(),
       m_velocity->Buffer(), m_velocity->LDim());
@@ -121,12 +140,12 @@ void sgd<TensorDataType>::momentum_step_gpu(AbsDistMatrixType& values,
     if (values.Contiguous() && gradient.Contiguous()
         && m_velocity->Contiguous()) {
       momentum_contiguous_kernel<TensorDataType><<<grid_size, block_size, 0, stream>>>(
-        local_size, this->get_learning_rate(), m_momentum,
+        local_size, this->get_learning_rate(), m_momentum, decay,
         values.Buffer(), gradient.LockedBuffer(), m_velocity->Buffer());
     } else {
       momentum_noncontiguous_kernel<TensorDataType><<<grid_size, block_size, 0, stream>>>(
         local_height, local_width,
-        this->get_learning_rate(), m_momentum,
+        this->get_learning_rate(), m_momentum, decay,
         values.Buffer(), values.LDim(),
         gradient.LockedBuffer(), gradient.LDim(),
         m_velocity->Buffer(), m_velocity->LDim());
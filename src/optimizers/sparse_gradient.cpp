@@ -0,0 +1,286 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#define LBANN_SPARSE_GRADIENT_INSTANTIATE
+#include "lbann/optimizers/sparse_gradient.hpp"
+#include "lbann/utils/exception.hpp"
+#include "lbann/utils/memory.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace lbann {
+
+namespace {
+
+/** @brief Sorted unique indices and each index's position in them. */
+void merge_indices(const std::vector<El::Int>& indices,
+                   std::vector<El::Int>& unique_indices,
+                   std::vector<El::Int>& positions) {
+  unique_indices = indices;
+  std::sort(unique_indices.begin(), unique_indices.end());
+  unique_indices.erase(std::unique(unique_indices.begin(),
+                                   unique_indices.end()),
+                       unique_indices.end());
+  positions.resize(indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    positions[i] = std::distance(unique_indices.begin(),
+                                 std::lower_bound(unique_indices.begin(),
+                                                  unique_indices.end(),
+                                                  indices[i]));
+  }
+}
+
+template <typename TensorDataType, El::Device Device>
+void all_gather_columns(const El::AbstractMatrix<TensorDataType>& local,
+                        El::AbstractMatrix<TensorDataType>& gathered,
+                        std::vector<int> counts,
+                        std::vector<int> displs,
+                        const El::mpi::Comm& c) {
+  using MatrixType = El::Matrix<TensorDataType, Device>;
+  const auto& local_ = static_cast<const MatrixType&>(local);
+  auto& gathered_ = static_cast<MatrixType&>(gathered);
+  const int height = local.Height();
+  for (auto& count : counts) { count *= height; }
+  for (auto& displ : displs) { displ *= height; }
+  El::mpi::AllGather(local_.LockedBuffer(), local_.Height() * local_.Width(),
+                     gathered_.Buffer(), counts.data(), displs.data(),
+                     c, El::SyncInfoFromMatrix(gathered_));
+}
+
+} // namespace
+
+template <typename TensorDataType>
+sparse_gradient<TensorDataType>::sparse_gradient(El::Int height,
+                                                 El::Device device)
+  : m_height(height), m_device(device), m_values(make_matrix()) {
+  m_values->Resize(m_height, 0);
+}
+
+template <typename TensorDataType>
+sparse_gradient<TensorDataType>::sparse_gradient(const sparse_gradient& other)
+  : m_height(other.m_height),
+    m_device(other.m_device),
+    m_cols(other.m_cols),
+    m_values(make_matrix()) {
+  El::Copy(*other.m_values, *m_values);
+}
+
+template <typename TensorDataType>
+auto sparse_gradient<TensorDataType>::operator=(const sparse_gradient& other)
+  -> sparse_gradient& {
+  m_height = other.m_height;
+  m_device = other.m_device;
+  m_cols = other.m_cols;
+  m_values = make_matrix();
+  El::Copy(*other.m_values, *m_values);
+  return *this;
+}
+
+template <typename TensorDataType>
+auto sparse_gradient<TensorDataType>::make_matrix() const
+  -> std::unique_ptr<AbsMatrixType> {
+  switch (m_device) {
+  case El::Device::CPU:
+    return make_unique<El::Matrix<TensorDataType, El::Device::CPU>>();
+#ifdef LBANN_HAS_GPU
+  case El::Device::GPU:
+    {
+      auto m = make_unique<El::Matrix<TensorDataType, El::Device::GPU>>();
+#ifdef HYDROGEN_HAVE_CUB
+      m->SetMemoryMode(1); // CUB GPU memory pool
+#endif // HYDROGEN_HAVE_CUB
+      return std::move(m);
+    }
+#endif // LBANN_HAS_GPU
+  default: LBANN_ERROR("invalid device");
+  }
+  return nullptr;
+}
+
+template <typename TensorDataType>
+void sparse_gradient<TensorDataType>::clear() {
+  m_cols.clear();
+  m_values->Resize(m_height, 0);
+}
+
+template <typename TensorDataType>
+void sparse_gradient<TensorDataType>::add(const std::vector<El::Int>& cols,
+                                          const AbsMatrixType& values,
+                                          TensorDataType scale) {
+  if (values.Height() != m_height
+      || values.Width() != static_cast<El::Int>(cols.size())) {
+    LBANN_ERROR("attempted to add a ",
+                values.Height(), " x ", values.Width(), " matrix "
+                "with ", cols.size(), " column indices "
+                "to a sparse gradient with ", m_height, " rows");
+  }
+  if (cols.empty()) { return; }
+
+  // Merge column indices
+  std::vector<El::Int> all_cols(m_cols);
+  all_cols.insert(all_cols.end(), cols.begin(), cols.end());
+  std::vector<El::Int> new_cols, positions;
+  merge_indices(all_cols, new_cols, positions);
+  const std::vector<El::Int> old_positions(positions.begin(),
+                                           positions.begin() + m_cols.size());
+  const std::vector<El::Int> add_positions(positions.begin() + m_cols.size(),
+                                           positions.end());
+
+  // Accumulate columns
+  auto new_values = make_matrix();
+  El::Zeros(*new_values, m_height, new_cols.size());
+  add_columns(*m_values, old_positions, TensorDataType(1), *new_values);
+  add_columns(values, add_positions, scale, *new_values);
+  m_cols = std::move(new_cols);
+  m_values = std::move(new_values);
+
+}
+
+template <typename TensorDataType>
+void sparse_gradient<TensorDataType>::allreduce(lbann_comm& comm,
+                                                const El::mpi::Comm& c) {
+  if (El::mpi::Size(c) <= 1) { return; }
+
+  // Gather column indices
+  int num_cols = m_cols.size();
+  std::vector<int> counts(El::mpi::Size(c));
+  comm.all_gather(num_cols, counts, c);
+  std::vector<int> displs(counts.size() + 1, 0);
+  std::partial_sum(counts.begin(), counts.end(), displs.begin() + 1);
+  const int total_cols = displs.back();
+  displs.pop_back();
+  if (total_cols == 0) { return; }
+  // Note: lbann_comm::all_gather rejects empty vectors, but ranks
+  // may not touch any columns.
+  std::vector<El::Int> all_cols(total_cols);
+  El::mpi::AllGather(m_cols.data(), num_cols,
+                     all_cols.data(), counts.data(), displs.data(),
+                     c, El::SyncInfo<El::Device::CPU>{});
+
+  // Gather nonzero columns
+  auto gathered = make_matrix();
+  gathered->Resize(m_height, total_cols);
+  switch (m_device) {
+  case El::Device::CPU:
+    all_gather_columns<TensorDataType, El::Device::CPU>(
+      *m_values, *gathered, counts, displs, c);
+    break;
+#ifdef LBANN_HAS_GPU
+  case El::Device::GPU:
+    all_gather_columns<TensorDataType, El::Device::GPU>(
+      *m_values, *gathered, counts, displs, c);
+    break;
+#endif // LBANN_HAS_GPU
+  default: LBANN_ERROR("invalid device");
+  }
+
+  // Sum columns with the same index
+  m_cols.clear();
+  m_values->Resize(m_height, 0);
+  add(all_cols, *gathered);
+
+}
+
+template <typename TensorDataType>
+void sparse_gradient<TensorDataType>::add_to(AbsMatrixType& dense) const {
+  add_columns(*m_values, m_cols, TensorDataType(1), dense);
+}
+
+template <typename TensorDataType>
+void sparse_gradient<TensorDataType>::add_columns(const AbsMatrixType& src,
+                                                  const std::vector<El::Int>& dst_cols,
+                                                  TensorDataType scale,
+                                                  AbsMatrixType& dst) {
+  if (dst_cols.empty()) { return; }
+  switch (dst.GetDevice()) {
+  case El::Device::CPU:
+    {
+      const El::Int height = src.Height();
+      for (size_t j = 0; j < dst_cols.size(); ++j) {
+        const auto* __restrict__ x = src.LockedBuffer(0, j);
+        auto* __restrict__ y = dst.Buffer(0, dst_cols[j]);
+        for (El::Int i = 0; i < height; ++i) {
+          y[i] += scale * x[i];
+        }
+      }
+    }
+    break;
+#ifdef LBANN_HAS_CUDA
+  case El::Device::GPU: add_columns_gpu(src, dst_cols, scale, dst); break;
+#endif // LBANN_HAS_CUDA
+  default: LBANN_ERROR("invalid device");
+  }
+}
+
+template <typename TensorDataType>
+void sparse_gradient<TensorDataType>::gather_columns(const AbsMatrixType& src,
+                                                     const std::vector<El::Int>& cols,
+                                                     AbsMatrixType& dst) {
+  if (cols.empty()) { return; }
+  switch (dst.GetDevice()) {
+  case El::Device::CPU:
+    LBANN_OMP_PARALLEL_FOR
+    for (size_t j = 0; j < cols.size(); ++j) {
+      std::copy_n(src.LockedBuffer(0, cols[j]), src.Height(),
+                  dst.Buffer(0, j));
+    }
+    break;
+#ifdef LBANN_HAS_CUDA
+  case El::Device::GPU: gather_columns_gpu(src, cols, dst); break;
+#endif // LBANN_HAS_CUDA
+  default: LBANN_ERROR("invalid device");
+  }
+}
+
+template <typename TensorDataType>
+void sparse_gradient<TensorDataType>::scatter_columns(const AbsMatrixType& src,
+                                                      const std::vector<El::Int>& cols,
+                                                      AbsMatrixType& dst) {
+  if (cols.empty()) { return; }
+  switch (dst.GetDevice()) {
+  case El::Device::CPU:
+    LBANN_OMP_PARALLEL_FOR
+    for (size_t j = 0; j < cols.size(); ++j) {
+      std::copy_n(src.LockedBuffer(0, j), src.Height(),
+                  dst.Buffer(0, cols[j]));
+    }
+    break;
+#ifdef LBANN_HAS_CUDA
+  case El::Device::GPU: scatter_columns_gpu(src, cols, dst); break;
+#endif // LBANN_HAS_CUDA
+  default: LBANN_ERROR("invalid device");
+  }
+}
+
+#define PROTO(T)                     \
+  template class sparse_gradient<T>
+
+#define LBANN_INSTANTIATE_CPU_HALF
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
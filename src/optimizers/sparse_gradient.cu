@@ -0,0 +1,186 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#define LBANN_SPARSE_GRADIENT_INSTANTIATE
+#include "lbann/optimizers/sparse_gradient.hpp"
+#include "lbann/utils/cuda.hpp"
+#include "lbann/utils/exception.hpp"
+
+namespace lbann {
+
+namespace {
+
+/** @brief Copy column indices to GPU memory. */
+cuda::thrust::vector<El::Int> copy_cols_to_gpu(const std::vector<El::Int>& cols) {
+  auto&& stream = El::GPUManager::Stream();
+  cuda::thrust::vector<El::Int> device_cols(cols.size());
+  CHECK_CUDA(cudaMemcpyAsync(device_cols.data().get(),
+                             cols.data(),
+                             cols.size() * sizeof(El::Int),
+                             cudaMemcpyHostToDevice,
+                             stream));
+  return device_cols;
+}
+
+/** Grid dimensions: (height / bsize) x num_cols */
+template <typename TensorDataType>
+__global__ void add_columns_kernel(El::Int height,
+                                   El::Int num_cols,
+                                   TensorDataType scale,
+                                   const TensorDataType* __restrict__ src,
+                                   El::Int src_ldim,
+                                   const El::Int* __restrict__ dst_cols,
+                                   TensorDataType* __restrict__ dst,
+                                   El::Int dst_ldim) {
+  const El::Int gidx = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int nthreadsx = blockDim.x * gridDim.x;
+  for (El::Int j = blockIdx.y; j < num_cols; j += gridDim.y) {
+    const auto& dst_col = dst_cols[j];
+    for (El::Int i = gidx; i < height; i += nthreadsx) {
+      cuda::atomic_add(&dst[i + dst_col * dst_ldim],
+                       scale * src[i + j * src_ldim]);
+    }
+  }
+}
+
+/** Grid dimensions: (height / bsize) x num_cols */
+template <typename TensorDataType, bool Gather>
+__global__ void copy_columns_kernel(El::Int height,
+                                    El::Int num_cols,
+                                    const TensorDataType* __restrict__ src,
+                                    El::Int src_ldim,
+                                    const El::Int* __restrict__ cols,
+                                    TensorDataType* __restrict__ dst,
+                                    El::Int dst_ldim) {
+  const El::Int gidx = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int nthreadsx = blockDim.x * gridDim.x;
+  for (El::Int j = blockIdx.y; j < num_cols; j += gridDim.y) {
+    const auto& src_col = Gather ? cols[j] : j;
+    const auto& dst_col = Gather ? j : cols[j];
+    for (El::Int i = gidx; i < height; i += nthreadsx) {
+      dst[i + dst_col * dst_ldim] = src[i + src_col * src_ldim];
+    }
+  }
+}
+
+dim3 get_grid_dims(El::Int height, El::Int num_cols, size_t block_size) {
+  dim3 grid_dims;
+  grid_dims.x = (height + block_size - 1) / block_size;
+  grid_dims.y = std::min(num_cols, El::Int(65535));
+  return grid_dims;
+}
+
+template <typename TensorDataType, bool Gather>
+void copy_columns(const El::AbstractMatrix<TensorDataType>& src,
+                  const std::vector<El::Int>& cols,
+                  El::AbstractMatrix<TensorDataType>& dst) {
+  const El::Int height = src.Height();
+  const El::Int num_cols = cols.size();
+  if (height <= 0 || num_cols <= 0) { return; }
+  const auto device_cols = copy_cols_to_gpu(cols);
+  constexpr size_t block_size = 256;
+  copy_columns_kernel<TensorDataType, Gather>
+    <<<get_grid_dims(height, num_cols, block_size), block_size,
+       0, El::GPUManager::Stream()>>>(
+      height, num_cols,
+      src.LockedBuffer(), src.LDim(),
+      device_cols.data().get(),
+      dst.Buffer(), dst.LDim());
+}
+
+} // namespace
+
+template <typename TensorDataType>
+void sparse_gradient<TensorDataType>::add_columns_gpu(const AbsMatrixType& src,
+                                                      const std::vector<El::Int>& dst_cols,
+                                                      TensorDataType scale,
+                                                      AbsMatrixType& dst) {
+  const El::Int height = src.Height();
+  const El::Int num_cols = dst_cols.size();
+  if (height <= 0 || num_cols <= 0) { return; }
+  const auto device_cols = copy_cols_to_gpu(dst_cols);
+  constexpr size_t block_size = 256;
+  add_columns_kernel<TensorDataType>
+    <<<get_grid_dims(height, num_cols, block_size), block_size,
+       0, El::GPUManager::Stream()>>>(
+      height, num_cols, scale,
+      src.LockedBuffer(), src.LDim(),
+      device_cols.data().get(),
+      dst.Buffer(), dst.LDim());
+}
+
+template <typename TensorDataType>
+void sparse_gradient<TensorDataType>::gather_columns_gpu(const AbsMatrixType& src,
+                                                         const std::vector<El::Int>& cols,
+                                                         AbsMatrixType& dst) {
+  copy_columns<TensorDataType, true>(src, cols, dst);
+}
+
+template <typename TensorDataType>
+void sparse_gradient<TensorDataType>::scatter_columns_gpu(const AbsMatrixType& src,
+                                                          const std::vector<El::Int>& cols,
+                                                          AbsMatrixType& dst) {
+  copy_columns<TensorDataType, false>(src, cols, dst);
+}
+
+#ifdef LBANN_HAS_HALF
+template <>
+void sparse_gradient<cpu_fp16>::add_columns_gpu(const AbsMatrixType&,
+                                                const std::vector<El::Int>&,
+                                                cpu_fp16,
+                                                AbsMatrixType&) {
+  LBANN_ERROR("Can't call this function with cpu_fp16!");
+}
+template <>
+void sparse_gradient<cpu_fp16>::gather_columns_gpu(const AbsMatrixType&,
+                                                   const std::vector<El::Int>&,
+                                                   AbsMatrixType&) {
+  LBANN_ERROR("Can't call this function with cpu_fp16!");
+}
+template <>
+void sparse_gradient<cpu_fp16>::scatter_columns_gpu(const AbsMatrixType&,
+                                                    const std::vector<El::Int>&,
+                                                    AbsMatrixType&) {
+  LBANN_ERROR("Can't call this function with cpu_fp16!");
+}
+#endif // LBANN_HAS_HALF
+
+#define PROTO(T)                                                \
+  template void sparse_gradient<T>::add_columns_gpu(            \
+    const El::AbstractMatrix<T>&, const std::vector<El::Int>&,  \
+    T, El::AbstractMatrix<T>&);                                 \
+  template void sparse_gradient<T>::gather_columns_gpu(         \
+    const El::AbstractMatrix<T>&, const std::vector<El::Int>&,  \
+    El::AbstractMatrix<T>&);                                    \
+  template void sparse_gradient<T>::scatter_columns_gpu(        \
+    const El::AbstractMatrix<T>&, const std::vector<El::Int>&,  \
+    El::AbstractMatrix<T>&)
+
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
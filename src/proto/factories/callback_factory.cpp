@@ -26,6 +26,7 @@
 
 // Get the declarations of all the builders for registration
 #include "lbann/callbacks/callback.hpp"
+#include "lbann/callbacks/autotune_io.hpp"
 #include "lbann/callbacks/check_dataset.hpp"
 #include "lbann/callbacks/check_gradients.hpp"
 #include "lbann/callbacks/check_init.hpp"
@@ -33,6 +34,7 @@
 #include "lbann/callbacks/check_nan.hpp"
 #include "lbann/callbacks/check_small.hpp"
 #include "lbann/callbacks/checkpoint.hpp"
+#include "lbann/callbacks/comm_profiler.hpp"
 #include "lbann/callbacks/confusion_matrix.hpp"
 #include "lbann/callbacks/debug.hpp"
 #include "lbann/callbacks/debug_io.hpp"
@@ -42,27 +44,36 @@
 #include "lbann/callbacks/dump_outputs.hpp"
 #include "lbann/callbacks/dump_weights.hpp"
 #include "lbann/callbacks/early_stopping.hpp"
+#include "lbann/callbacks/elastic_resize.hpp"
+#include "lbann/callbacks/export_activations.hpp"
+#include "lbann/callbacks/gpu_layer_timer.hpp"
 #include "lbann/callbacks/gpu_memory_usage.hpp"
 #include "lbann/callbacks/hang.hpp"
 #include "lbann/callbacks/imcomm.hpp"
 #include "lbann/callbacks/learning_rate.hpp"
 #include "lbann/callbacks/ltfb.hpp"
+#include "lbann/callbacks/memory_accounting.hpp"
 #include "lbann/callbacks/mixup.hpp"
 #include "lbann/callbacks/monitor_io.hpp"
+#include "lbann/callbacks/parallel_plan.hpp"
+#include "lbann/callbacks/pbt.hpp"
 #include "lbann/callbacks/perturb_adam.hpp"
 #include "lbann/callbacks/perturb_dropout.hpp"
 #include "lbann/callbacks/print_model_description.hpp"
 #include "lbann/callbacks/print_statistics.hpp"
 #include "lbann/callbacks/profiler.hpp"
+#include "lbann/callbacks/quantize_int8.hpp"
 #include "lbann/callbacks/replace_weights.hpp"
 #include "lbann/callbacks/save_images.hpp"
 #include "lbann/callbacks/save_model.hpp"
 #include "lbann/callbacks/load_model.hpp"
 #include "lbann/callbacks/save_topk_models.hpp"
+#include "lbann/callbacks/straggler_detection.hpp"
 #include "lbann/callbacks/summary.hpp"
 #include "lbann/callbacks/sync_layers.hpp"
 #include "lbann/callbacks/timeline.hpp"
 #include "lbann/callbacks/timer.hpp"
+#include "lbann/callbacks/trace.hpp"
 #include "lbann/callbacks/variable_minibatch.hpp"
 
 #include "lbann/proto/factories.hpp"
@@ -98,6 +109,8 @@ void register_default_builders(factory_type& factory)
   using namespace callback;
   factory.register_builder("CallbackAdaptiveLearningRate",
                            build_adaptive_learning_rate_callback_from_pbuf);
+  factory.register_builder("CallbackAutotuneIO",
+                           build_autotune_io_callback_from_pbuf);
   factory.register_builder("CallbackCheckDataset",
                            build_check_dataset_callback_from_pbuf);
   factory.register_builder("CallbackCheckGradients",
@@ -110,6 +123,8 @@ void register_default_builders(factory_type& factory)
                            build_check_nan_callback_from_pbuf);
   factory.register_builder("CallbackCheckSmall",
                            build_check_small_callback_from_pbuf);
+  factory.register_builder("CallbackCommProfiler",
+                           build_comm_profiler_callback_from_pbuf);
   factory.register_builder("CallbackConfusionMatrix",
                            build_confusion_matrix_callback_from_pbuf);
   factory.register_builder("CallbackDebug",
@@ -132,6 +147,12 @@ void register_default_builders(factory_type& factory)
                            build_dump_weights_callback_from_pbuf);
   factory.register_builder("CallbackEarlyStopping",
                            build_early_stopping_callback_from_pbuf);
+  factory.register_builder("CallbackElasticResize",
+                           build_elastic_resize_callback_from_pbuf);
+  factory.register_builder("CallbackExportActivations",
+                           build_export_activations_callback_from_pbuf);
+  factory.register_builder("CallbackGPULayerTimer",
+                           build_gpu_layer_timer_callback_from_pbuf);
   factory.register_builder("CallbackGPUMemoryUsage",
                            build_gpu_memory_usage_callback_from_pbuf);
   factory.register_builder("CallbackHang",
@@ -143,13 +164,21 @@ void register_default_builders(factory_type& factory)
     build_linear_growth_learning_rate_callback_from_pbuf);
   factory.register_builder("CallbackLTFB",
                            build_ltfb_callback_from_pbuf);
+  factory.register_builder("CallbackMemoryAccounting",
+                           build_memory_accounting_callback_from_pbuf);
   factory.register_builder("CallbackMinibatchSchedule",
                            build_minibatch_schedule_callback_from_pbuf);
   factory.register_builder("CallbackMixup",
                            build_mixup_callback_from_pbuf);
+  factory.register_builder("CallbackNoiseScaleMinibatch",
+                           build_noise_scale_minibatch_callback_from_pbuf);
   factory.register_builder(
     "CallbackOptimizerwiseAdaptiveLearningRate",
     build_optimizerwise_adaptive_learning_rate_callback_from_pbuf);
+  factory.register_builder("CallbackParallelPlan",
+                           build_parallel_plan_callback_from_pbuf);
+  factory.register_builder("CallbackPBT",
+                           build_pbt_callback_from_pbuf);
   factory.register_builder("CallbackPerturbAdam",
                            build_perturb_adam_callback_from_pbuf);
   factory.register_builder("CallbackPerturbDropout",
@@ -162,6 +191,8 @@ void register_default_builders(factory_type& factory)
                            build_print_statistics_callback_from_pbuf);
   factory.register_builder("CallbackProfiler",
                            build_profiler_callback_from_pbuf);
+  factory.register_builder("CallbackQuantizeInt8",
+                           build_quantize_int8_callback_from_pbuf);
   factory.register_builder("CallbackReplaceWeights",
                            build_replace_weights_callback_from_pbuf);
   factory.register_builder("CallbackSaveImages",
@@ -176,12 +207,16 @@ void register_default_builders(factory_type& factory)
                            build_step_learning_rate_callback_from_pbuf);
   factory.register_builder("CallbackStepMinibatch",
                            build_step_minibatch_callback_from_pbuf);
+  factory.register_builder("CallbackStragglerDetection",
+                           build_straggler_detection_callback_from_pbuf);
   factory.register_builder("CallbackSummary",
                            build_summary_callback_from_pbuf);
   factory.register_builder("CallbackSyncLayers",
                            build_sync_layers_callback_from_pbuf);
   factory.register_builder("CallbackTimeline",
                            build_timeline_callback_from_pbuf);
+  factory.register_builder("CallbackTrace",
+                           build_trace_callback_from_pbuf);
   factory.register_builder("CallbackTimer",
                            build_timer_callback_from_pbuf);
 }
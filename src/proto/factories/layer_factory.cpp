@@ -64,6 +64,7 @@
 #include "lbann/layers/math/unary.hpp"
 #include "lbann/layers/misc/channelwise_mean.hpp"
 #include "lbann/layers/misc/channelwise_softmax.hpp"
+#include "lbann/layers/misc/scaled_dot_product_attention.hpp"
 #include "lbann/layers/misc/covariance.hpp"
 #include "lbann/layers/misc/mini_batch_index.hpp"
 #include "lbann/layers/misc/mini_batch_size.hpp"
@@ -250,7 +251,7 @@ private:
     LBANN_REGISTER_DEFAULT_BUILDER(BooleanFalseNegative, boolean_false_negative);
     LBANN_REGISTER_DEFAULT_BUILDER(BooleanFalsePositive, boolean_false_positive);
     LBANN_REGISTER_DEFAULT_BUILDER(CategoricalAccuracy, categorical_accuracy);
-    LBANN_REGISTER_DEFAULT_BUILDER(CrossEntropy, cross_entropy);
+    LBANN_REGISTER_BUILDER(CrossEntropy, cross_entropy);
     LBANN_REGISTER_DEFAULT_BUILDER(L1Norm, l1_norm);
     LBANN_REGISTER_DEFAULT_BUILDER(L2Norm2, l2_norm2);
     LBANN_REGISTER_DEFAULT_BUILDER(MeanAbsoluteError, mean_absolute_error);
@@ -264,6 +265,7 @@ private:
     LBANN_REGISTER_BUILDER(ChannelwiseSoftmax, channelwise_softmax);
     LBANN_REGISTER_DEFAULT_BUILDER(MiniBatchIndex, mini_batch_index);
     LBANN_REGISTER_DEFAULT_BUILDER(MiniBatchSize, mini_batch_size);
+    LBANN_REGISTER_BUILDER(ScaledDotProductAttention, scaled_dot_product_attention);
 
   }
 
@@ -593,7 +595,8 @@ std::unique_ptr<Layer> construct_layer_legacy(
   }
   if (proto_layer.has_dropout()) {
     const auto& params = proto_layer.dropout();
-    return lbann::make_unique<dropout<TensorDataType, Layout, Device>>(comm, params.keep_prob());
+    return lbann::make_unique<dropout<TensorDataType, Layout, Device>>(
+      comm, params.keep_prob(), params.regenerate_mask());
   }
   if (proto_layer.has_local_response_normalization()) {
  const auto& params = proto_layer.local_response_normalization();
@@ -614,11 +617,15 @@ std::unique_ptr<Layer> construct_layer_legacy(
     const auto& keep_prob = params.keep_prob();
     const auto& alpha = params.alpha();
     const auto& scale = params.scale();
+    using LayerType = selu_dropout<TensorDataType, Layout, Device>;
+    std::unique_ptr<LayerType> layer;
     if (alpha != 0.0 && scale != 0.0) {
-      return lbann::make_unique<selu_dropout<TensorDataType, Layout, Device>>(comm, keep_prob, alpha, scale);
+      layer = lbann::make_unique<LayerType>(comm, keep_prob, alpha, scale);
     } else {
-      return lbann::make_unique<selu_dropout<TensorDataType, Layout, Device>>(comm, keep_prob);
+      layer = lbann::make_unique<LayerType>(comm, keep_prob);
     }
+    layer->set_regenerate_mask(params.regenerate_mask());
+    return layer;
   }
   if (proto_layer.has_entrywise_batch_normalization()) {
     const auto& params = proto_layer.entrywise_batch_normalization();
@@ -705,19 +712,19 @@ std::unique_ptr<Layer> construct_layer_legacy(
     }
   }
   if (proto_layer.has_argmax()) {
-    if (Layout == data_layout::DATA_PARALLEL && Device == El::Device::CPU) {
-      return lbann::make_unique<argmax_layer<TensorDataType, data_layout::DATA_PARALLEL, El::Device::CPU>>(comm);
+    if (Layout == data_layout::DATA_PARALLEL) {
+      return lbann::make_unique<argmax_layer<TensorDataType, data_layout::DATA_PARALLEL, Device>>(comm);
     } else {
       LBANN_ERROR("argmax layer is only supported with "
-                  "a data-parallel layout and on CPU");
+                  "a data-parallel layout");
     }
   }
   if (proto_layer.has_argmin()) {
-    if (Layout == data_layout::DATA_PARALLEL && Device == El::Device::CPU) {
-      return lbann::make_unique<argmin_layer<TensorDataType, data_layout::DATA_PARALLEL, El::Device::CPU>>(comm);
+    if (Layout == data_layout::DATA_PARALLEL) {
+      return lbann::make_unique<argmin_layer<TensorDataType, data_layout::DATA_PARALLEL, Device>>(comm);
     } else {
       LBANN_ERROR("argmin layer is only supported with "
-                  "a data-parallel layout and on CPU");
+                  "a data-parallel layout");
     }
   }
   if (proto_layer.has_one_hot()) {
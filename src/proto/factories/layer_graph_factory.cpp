@@ -30,12 +30,17 @@
 #include "lbann/layers/learning/fully_connected.hpp"
 #include "lbann/layers/transform/pooling.hpp"
 #include "lbann/layers/transform/unpooling.hpp"
+#include "lbann/utils/options.hpp"
 
 #include <model.pb.h>
 #include <trainer.pb.h>
 
+#include <algorithm>
+#include <iostream>
+#include <set>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace lbann {
@@ -134,15 +139,223 @@ void setup_unpooling_pointers(lbann_comm* comm,
   }
 }
 
+/** Whether a layer is implemented for both data layouts and only
+ *  acts entry-wise or passes tensors through, so that it can take
+ *  the layout of its neighbors. */
+bool is_layout_agnostic(const lbann_data::Layer& proto_layer) {
+  static const std::unordered_set<std::string> types = {
+    // Transform layers
+    "identity", "split", "sum", "weighted_sum", "hadamard",
+    "stop_gradient",
+    // Activation layers
+    "elu", "leaky_relu", "log_sigmoid", "relu", "selu", "sigmoid",
+    "softplus", "softsign",
+    // Regularization layers
+    "dropout",
+    // Math layers
+    "abs", "negative", "sign", "round", "ceil", "floor", "reciprocal",
+    "square", "sqrt", "rsqrt", "safe_reciprocal", "exp", "expm1", "log",
+    "log1p", "cos", "sin", "tan", "acos", "asin", "atan", "cosh", "sinh",
+    "tanh", "acosh", "asinh", "atanh", "add", "subtract", "multiply",
+    "divide", "mod", "pow", "safe_divide", "squared_difference", "max",
+    "min", "clamp"};
+  const auto* oneof = proto_layer.GetDescriptor()->FindOneofByName("layer_type");
+  const auto* field = proto_layer.GetReflection()->GetOneofFieldDescriptor(
+    proto_layer, oneof);
+  return field != nullptr && types.count(field->name()) > 0;
+}
+
+/** Whether some layer data layouts are left to
+ *  @c propagate_data_layouts. */
+bool has_auto_data_layouts(const lbann_data::Model& proto_model) {
+  if (options::get()->get_bool("propagate_data_layouts")) { return true; }
+  for (const auto& proto_layer : proto_model.layer()) {
+    if (proto_layer.data_layout() == "auto") { return true; }
+  }
+  return false;
+}
+
+/** @brief Choose data layouts that avoid redistributions.
+ *
+ *  Every connection between layers with different data layouts
+ *  redistributes the activations in forward prop and the error
+ *  signals in backprop. Layout-agnostic layers (see
+ *  @c is_layout_agnostic) with data layout "auto", or with no data
+ *  layout if --propagate_data_layouts is set, take the layout shared
+ *  by most of their already-decided neighbors, so chains of them
+ *  between model-parallel layers no longer bounce through the
+ *  data-parallel layout. Undecided layers are data-parallel.
+ *
+ *  Reports how many redistributions per step are removed. Where
+ *  tensor sizes are known from the prototext (fully-connected layers
+ *  and entry-wise layers after them), the bytes saved are reported as
+ *  well.
+ */
+void propagate_data_layouts(lbann_data::Model& proto_model,
+                            int mini_batch_size,
+                            bool master) {
+  const bool propagate_unset = options::get()->get_bool("propagate_data_layouts");
+  const int num_layers = proto_model.layer_size();
+  std::unordered_map<std::string, int> indices;
+  for (int i=0; i<num_layers; ++i) {
+    indices[proto_model.layer(i).name()] = i;
+  }
+
+  // Connections (parent, child), given on either end
+  std::set<std::pair<int,int>> edges;
+  for (int i=0; i<num_layers; ++i) {
+    const auto& proto_layer = proto_model.layer(i);
+    for (const auto& name : parse_list<std::string>(proto_layer.parents())) {
+      if (indices.count(name) > 0) { edges.emplace(indices[name], i); }
+    }
+    for (const auto& name : parse_list<std::string>(proto_layer.children())) {
+      if (indices.count(name) > 0) { edges.emplace(i, indices[name]); }
+    }
+  }
+  std::vector<std::vector<int>> parents(num_layers), children(num_layers);
+  for (const auto& e : edges) {
+    parents[e.second].push_back(e.first);
+    children[e.first].push_back(e.second);
+  }
+
+  // Fixed layouts
+  // Note: Undecided layers are marked with an empty layout.
+  std::vector<std::string> layouts(num_layers);
+  std::vector<bool> is_auto(num_layers, false);
+  for (int i=0; i<num_layers; ++i) {
+    const auto& proto_layer = proto_model.layer(i);
+    const auto& layout = proto_layer.data_layout();
+    const bool agnostic = is_layout_agnostic(proto_layer);
+    if (agnostic && (layout == "auto" || (layout.empty() && propagate_unset))) {
+      is_auto[i] = true;
+    } else if (layout.empty() || layout == "auto") {
+      layouts[i] = to_string(data_layout::DATA_PARALLEL);
+    } else {
+      layouts[i] = to_string(data_layout_from_string(layout));
+    }
+  }
+  const auto default_layouts = [&] {
+    auto l = layouts;
+    for (auto& s : l) {
+      if (s.empty()) { s = to_string(data_layout::DATA_PARALLEL); }
+    }
+    return l;
+  }();
+
+  // Decide layers from their neighbors until nothing changes
+  // Note: Ties go to the parents' layout.
+  for (bool changed = true; changed; ) {
+    changed = false;
+    for (int i=0; i<num_layers; ++i) {
+      if (!is_auto[i] || !layouts[i].empty()) { continue; }
+      std::unordered_map<std::string, int> votes;
+      std::string parent_layout;
+      for (const auto& j : parents[i]) {
+        if (layouts[j].empty()) { continue; }
+        votes[layouts[j]] += 2;
+        if (parent_layout.empty()) { parent_layout = layouts[j]; }
+      }
+      for (const auto& j : children[i]) {
+        if (!layouts[j].empty()) { votes[layouts[j]] += 2; }
+      }
+      if (votes.empty()) { continue; }
+      if (!parent_layout.empty()) { ++votes[parent_layout]; }
+      layouts[i] = std::max_element(
+        votes.begin(), votes.end(),
+        [](const std::pair<const std::string,int>& a,
+           const std::pair<const std::string,int>& b) {
+          return a.second < b.second;
+        })->first;
+      changed = true;
+    }
+  }
+  for (auto& s : layouts) {
+    if (s.empty()) { s = to_string(data_layout::DATA_PARALLEL); }
+  }
+
+  // Tensor sizes known from the prototext
+  std::vector<double> sizes(num_layers, 0.0);
+  for (int iter=0; iter<num_layers; ++iter) {
+    bool changed = false;
+    for (int i=0; i<num_layers; ++i) {
+      if (sizes[i] > 0) { continue; }
+      const auto& proto_layer = proto_model.layer(i);
+      if (proto_layer.has_fully_connected()) {
+        sizes[i] = proto_layer.fully_connected().num_neurons();
+      } else if (is_layout_agnostic(proto_layer) && !parents[i].empty()) {
+        sizes[i] = sizes[parents[i].front()];
+      }
+      changed = changed || sizes[i] > 0;
+    }
+    if (!changed) { break; }
+  }
+
+  // Count redistributions before and after
+  // Note: Each connection redistributes in forward and backward prop.
+  int num_before = 0, num_after = 0, num_unknown = 0;
+  double bytes_saved = 0;
+  for (const auto& e : edges) {
+    const bool before = default_layouts[e.first] != default_layouts[e.second];
+    const bool after = layouts[e.first] != layouts[e.second];
+    num_before += before ? 2 : 0;
+    num_after += after ? 2 : 0;
+    if (before != after) {
+      const double bytes = (2.0 * sizes[e.first] * mini_batch_size
+                            * sizeof(DataType));
+      bytes_saved += before ? bytes : -bytes;
+      if (sizes[e.first] <= 0) { ++num_unknown; }
+    }
+  }
+
+  // Update prototext
+  int num_model_parallel = 0;
+  for (int i=0; i<num_layers; ++i) {
+    if (!is_auto[i] && proto_model.layer(i).data_layout() != "auto") {
+      continue;
+    }
+    proto_model.mutable_layer(i)->set_data_layout(layouts[i]);
+    if (layouts[i] == to_string(data_layout::MODEL_PARALLEL)) {
+      ++num_model_parallel;
+    }
+  }
+  if (master) {
+    std::cout << "data layout propagation: "
+              << num_model_parallel << " layers set to model-parallel, "
+              << num_before << " -> " << num_after
+              << " tensor redistributions per step";
+    if (num_before != num_after) {
+      std::cout << " (" << bytes_saved / (1 << 20) << " MB per step saved";
+      if (num_unknown > 0) {
+        std::cout << ", not counting " << num_unknown
+                  << " connections with unknown sizes";
+      }
+      std::cout << ")";
+    }
+    std::cout << std::endl;
+  }
+}
+
 } // namespace
 
 std::vector<std::unique_ptr<Layer>> construct_layer_graph(
   lbann_comm* comm,
   int training_dr_linearized_data_size,
   const lbann_data::Trainer& proto_trainer,
-  const lbann_data::Model& proto_model) {
+  const lbann_data::Model& proto_model_in) {
   std::stringstream err;
 
+  // Resolve data layouts left to the layout propagation
+  // Note: The prototext is only copied if it needs to change.
+  lbann_data::Model propagated_model;
+  const bool propagate = has_auto_data_layouts(proto_model_in);
+  if (propagate) {
+    propagated_model = proto_model_in;
+    propagate_data_layouts(propagated_model,
+                           proto_trainer.mini_batch_size(),
+                           comm->am_world_master());
+  }
+  const auto& proto_model = propagate ? propagated_model : proto_model_in;
+
   // List of layers
   std::vector<std::unique_ptr<Layer>> layers;
   layers.reserve(proto_model.layer_size());
@@ -192,6 +405,17 @@ std::vector<std::unique_ptr<Layer>> construct_layer_graph(
 #endif // LBANN_HAS_GPU
 
     auto proto_datatype = proto_layer.datatype();
+#ifdef LBANN_HAS_GPU_FP16
+    // With --mixed_precision, single-precision GPU layers compute in
+    // half precision. Evaluation layers are kept in single precision
+    // since objective function terms and metrics read their values.
+    if (proto_datatype == lbann_data::FLOAT
+        && device == El::Device::GPU
+        && !proto_layer.has_evaluation()
+        && options::get()->get_bool("mixed_precision")) {
+      proto_datatype = lbann_data::FP16;
+    }
+#endif // LBANN_HAS_GPU_FP16
 
     // Construct layer
     std::unique_ptr<Layer> l;
@@ -257,6 +481,17 @@ std::vector<std::unique_ptr<Layer>> construct_layer_graph(
       #endif
       l->freeze();
     }
+    if (proto_layer.recompute_activations()) {
+      l->set_recompute_activations(true);
+    }
+    const auto& precision = proto_layer.transfer_precision();
+    if (precision == "fp16") {
+      l->set_transfer_precision(transfer_precision::half);
+    } else if (!precision.empty() && precision != "fp32") {
+      err << "layer \"" << name << "\" has invalid transfer precision "
+          << "\"" << precision << "\" (expected fp32 or fp16)";
+      LBANN_ERROR(err.str());
+    }
     // Add layer to list
     layers.emplace_back(std::move(l));
 
@@ -30,6 +30,7 @@
 
 #include "lbann/objective_functions/layer_term.hpp"
 #include "lbann/objective_functions/weight_regularization/l2.hpp"
+#include "lbann/utils/options.hpp"
 
 #include <objective_functions.pb.h>
 
@@ -45,7 +46,9 @@ construct_objective_function(const lbann_data::ObjectiveFunction& proto_obj) {
   // Weight regularization terms
   for (int i=0; i<proto_obj.l2_weight_regularization_size(); ++i) {
     const auto& params = proto_obj.l2_weight_regularization(i);
-    obj->add_term(new l2_weight_regularization(params.scale_factor()));
+    obj->add_term(new l2_weight_regularization(params.scale_factor(),
+                                               params.decoupled(),
+                                               params.evaluation_interval()));
   }
 
   // Layer terms
@@ -54,6 +57,25 @@ construct_objective_function(const lbann_data::ObjectiveFunction& proto_obj) {
     obj->add_term(new layer_term(params.scale_factor()));
   }
 
+  // Loss scaling
+  // Note: Loss scaling is needed to train with --mixed_precision,
+  // so it is enabled by default in that case.
+  if (proto_obj.has_loss_scaling()) {
+    const auto& params = proto_obj.loss_scaling();
+    obj->set_loss_scale(params.initial_scale() > 0.0
+                        ? params.initial_scale()
+                        : 65536.0);
+    if (params.dynamic()) {
+      obj->set_dynamic_loss_scaling(
+        params.growth_factor() > 0.0 ? params.growth_factor() : 2.0,
+        params.backoff_factor() > 0.0 ? params.backoff_factor() : 0.5,
+        params.growth_interval() > 0 ? params.growth_interval() : 2000);
+    }
+  } else if (options::get()->get_bool("mixed_precision")) {
+    obj->set_loss_scale(65536.0);
+    obj->set_dynamic_loss_scaling();
+  }
+
   // Return objective function
   return obj;
 
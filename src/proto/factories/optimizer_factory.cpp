@@ -31,6 +31,8 @@
 #include "lbann/optimizers/adagrad.hpp"
 #include "lbann/optimizers/adam.hpp"
 #include "lbann/optimizers/hypergradient_adam.hpp"
+#include "lbann/optimizers/lamb.hpp"
+#include "lbann/optimizers/lars.hpp"
 #include "lbann/optimizers/rmsprop.hpp"
 #include "lbann/optimizers/sgd.hpp"
 
@@ -73,6 +75,8 @@ private:
     factory_.register_builder("Adam", build_adam_optimizer_from_pbuf<T>);
     factory_.register_builder("HypergradientAdam",
                               build_hypergradient_adam_optimizer_from_pbuf<T>);
+    factory_.register_builder("LAMB", build_lamb_optimizer_from_pbuf<T>);
+    factory_.register_builder("LARS", build_lars_optimizer_from_pbuf<T>);
     factory_.register_builder("RMSprop", build_rmsprop_optimizer_from_pbuf<T>);
     factory_.register_builder("SGD", build_sgd_optimizer_from_pbuf<T>);
   }
@@ -33,6 +33,7 @@
 #include "lbann/proto/helpers.hpp"
 #include "lbann/proto/datatype_helpers.hpp"
 #include "lbann/utils/factory.hpp"
+#include "lbann/utils/options.hpp"
 
 #include <weights.pb.h>
 
@@ -110,6 +111,30 @@ construct_initializer(const lbann_data::Weights& proto_weights) {
   return factory.create_object(msg.GetDescriptor()->name(), msg);
 }
 
+/* Construct a gradient compressor specified with prototext. */
+template <typename TensorDataType>
+std::unique_ptr<gradient_compressor<TensorDataType>>
+construct_gradient_compressor(const lbann_data::Weights& proto_weights) {
+  const auto& msg = proto_weights.gradient_compression();
+  using proto_type = lbann_data::GradientCompression;
+  switch (msg.compression_type_case()) {
+  case proto_type::kHalfPrecision:
+    return make_unique<half_precision_compressor<TensorDataType>>(false);
+  case proto_type::kBfloat16:
+    return make_unique<half_precision_compressor<TensorDataType>>(true);
+  case proto_type::kTopk:
+    {
+      const double ratio = msg.topk().ratio();
+      return make_unique<topk_compressor<TensorDataType>>(
+        ratio > 0 ? ratio : 0.01);
+    }
+  case proto_type::kSign:
+    return make_unique<sign_compressor<TensorDataType>>();
+  default:
+    return nullptr;
+  }
+}
+
 } // namespace
 
 std::unique_ptr<weights> construct_weights(
@@ -119,6 +144,16 @@ std::unique_ptr<weights> construct_weights(
   std::stringstream err;
 
   auto proto_datatype = proto_weights.datatype();
+  const bool mixed_precision = options::get()->get_bool("mixed_precision");
+#ifdef LBANN_HAS_GPU_FP16
+  // With --mixed_precision, weights of half-precision layers are
+  // stored in half precision with single-precision master values.
+  if (proto_datatype == lbann_data::FLOAT && mixed_precision) {
+    proto_datatype = lbann_data::FP16;
+  }
+#endif // LBANN_HAS_GPU_FP16
+  const bool use_master_weights
+    = (mixed_precision && proto_datatype == lbann_data::FP16);
 
   // Instantiate weights
   //  auto w = make_unique<data_type_weights<DataType>>(comm);
@@ -139,6 +174,16 @@ std::unique_ptr<weights> construct_weights(
         opt = (helpers::has_oneof(opt_msg, "optimizer_type")                  \
           ? construct_optimizer<TensorDataType>(opt_msg)                      \
           : nullptr);                                                         \
+        if (opt != nullptr && proto_weights.has_gradient_compression()) {     \
+          auto& dt_opt = dynamic_cast<data_type_optimizer<TensorDataType>&>(  \
+            *opt);                                                            \
+          dt_opt.set_gradient_compressor(                                     \
+            construct_gradient_compressor<TensorDataType>(proto_weights));   \
+        }                                                                     \
+        if (opt != nullptr && use_master_weights) {                           \
+          auto& dt_w = dynamic_cast<data_type_weights<TensorDataType>&>(*w);  \
+          dt_w.set_master_optimizer(construct_optimizer<float>(opt_msg));     \
+        }                                                                     \
       }                                                                       \
     } while (0)
 
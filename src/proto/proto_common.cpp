@@ -32,6 +32,8 @@
 #include "lbann/proto/init_image_data_readers.hpp"
 #include "lbann/proto/factories.hpp"
 #include "lbann/utils/file_utils.hpp"
+#include "lbann/utils/distconv.hpp"
+#include "lbann/utils/metadata_bundle.hpp"
 
 #include <lbann.pb.h>
 #include <reader.pb.h>
@@ -41,6 +43,7 @@
 #include <google/protobuf/text_format.h>
 
 #include <functional>
+#include <iomanip>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -294,6 +297,20 @@ void init_data_readers(
           parse_list<int>(readme.synth_response_dimensions()),
           shuffle);
       }
+    } else if (name == "stream") {
+      if (readme.num_labels() != 0) {
+        reader = new data_reader_stream(
+          readme.num_samples(),
+          parse_list<int>(readme.synth_dimensions()),
+          readme.num_labels(),
+          shuffle);
+      } else {
+        reader = new data_reader_stream(
+          readme.num_samples(),
+          parse_list<int>(readme.synth_dimensions()),
+          parse_list<int>(readme.synth_response_dimensions()),
+          shuffle);
+      }
     } else if (name == "mesh") {
       reader = new mesh_reader(shuffle);
     } else if (name == "python") {
@@ -375,6 +392,20 @@ void init_data_readers(
 
     reader->set_master(master);
 
+#ifdef LBANN_HAS_DISTCONV
+    // Each process of a spatially partitioned input layer reads its
+    // own sub-volume of every sample.
+    if (dc::is_spatial_parallel_io_enabled()) {
+      if (!reader->supports_spatial_partitions()) {
+        LBANN_ERROR("spatially-parallel input is enabled, but the ",
+                    reader->get_type(), " data reader cannot read "
+                    "partial samples");
+      }
+      reader->set_spatial_partition(dc::get_number_of_io_partitions(),
+                                    dc::get_io_partition_index(*comm));
+    }
+#endif // LBANN_HAS_DISTCONV
+
     reader->load();
 
     if (readme.role() == "train") {
@@ -524,9 +555,65 @@ void init_data_readers(
   }
 }
 
+namespace {
+
+/** @brief Read a prototext file through the binary cache
+ *
+ *  The cache file is keyed by the text and the build, since the
+ *  binary encoding depends on the compiled protobuf schema.
+ *  @returns False if the file could not be read or parsed.
+ */
+bool read_cached_prototext_file(const std::string& fn,
+                                const std::string& cache_dir,
+                                lbann_data::LbannPB& pb,
+                                const bool master)
+{
+  std::vector<char> text;
+  if (!load_file(fn, text)) { return false; }
+
+  metadata_bundle::key k;
+  k.add(std::string(text.begin(), text.end()));
+#ifdef LBANN_VERSION
+  k.add(std::string(LBANN_MAKE_STR(LBANN_VERSION)));
+#endif
+  k.add(std::string(__DATE__ " " __TIME__));
+  k.add(static_cast<int>(GOOGLE_PROTOBUF_VERSION));
+  std::ostringstream path;
+  path << cache_dir << "/prototext_" << std::hex << std::setw(16)
+       << std::setfill('0') << k.value() << ".bin";
+
+  metadata_bundle cached;
+  if (cached.load(path.str(), k.value())) {
+    std::string bytes;
+    cached.get(bytes);
+    if (pb.ParseFromString(bytes)) { return true; }
+  }
+
+  const std::string text_str(text.begin(), text.end());
+  if (!google::protobuf::TextFormat::ParseFromString(text_str, &pb)) {
+    return false;
+  }
+  if (master) {
+    file::make_directory(cache_dir);
+    metadata_bundle bundle;
+    bundle.put(pb.SerializeAsString());
+    bundle.save(path.str(), k.value());
+  }
+  return true;
+}
+
+} // namespace
+
 void read_prototext_file(const std::string& fn, lbann_data::LbannPB& pb, const bool master)
 {
   std::ostringstream err;
+  options *opts = options::get();
+  if (opts->has_string("prototext_cache_dir")
+      && read_cached_prototext_file(fn,
+                                    opts->get_string("prototext_cache_dir"),
+                                    pb, master)) {
+    return;
+  }
   int fd = open(fn.c_str(), O_RDONLY);
   if (fd == -1) {
     if (master) {
@@ -773,7 +860,56 @@ void get_cmdline_overrides(const lbann_comm& comm, lbann_data::LbannPB& p)
   if(opts->get_bool("serialize_io")) {
     model->set_serialize_io(opts->get_bool("serialize_io"));
   }
+  if (opts->has_string("parallel_plan")) {
+    apply_parallel_plan(comm, p, opts->get_string("parallel_plan"));
+  }
+
+}
+
+void apply_parallel_plan(const lbann_comm& comm,
+                         lbann_data::LbannPB& p,
+                         const std::string& plan_file)
+{
+  const bool master = comm.am_world_master();
+  lbann_data::LbannPB plan;
+  read_prototext_file(plan_file, plan, master);
+
+  lbann_data::Model *model = p.mutable_model();
+  std::unordered_map<std::string, lbann_data::Layer*> layers;
+  for (int j=0; j<model->layer_size(); j++) {
+    lbann_data::Layer *l = model->mutable_layer(j);
+    layers[l->name()] = l;
+  }
 
+  int num_applied = 0;
+  for (const auto& planned : plan.model().layer()) {
+    auto it = layers.find(planned.name());
+    if (it == layers.end()) {
+      if (master) {
+        LBANN_WARNING("parallel plan ", plan_file, " has layer \"",
+                      planned.name(), "\", which is not in the model");
+      }
+      continue;
+    }
+    lbann_data::Layer *l = it->second;
+    if (!planned.data_layout().empty()) {
+      l->set_data_layout(planned.data_layout());
+    }
+    // Only the distributions the planner chooses are replaced
+    if (planned.has_parallel_strategy()) {
+      const auto& from = planned.parallel_strategy();
+      auto *to = l->mutable_parallel_strategy();
+      to->set_sample_groups(from.sample_groups());
+      to->set_height_groups(from.height_groups());
+      to->set_depth_groups(from.depth_groups());
+    }
+    ++num_applied;
+  }
+  if (master) {
+    std::cout << "applied parallel plan " << plan_file << " to "
+              << num_applied << " of " << model->layer_size()
+              << " layers" << std::endl;
+  }
 }
 
 void print_parameters(const lbann_comm& comm, lbann_data::LbannPB& p)
@@ -841,15 +977,61 @@ void print_help(std::ostream& os)
        "  --num_epochs=<int>\n"
        "  --hydrogen_block_size=<int>\n"
        "  --procs_per_trainer=<int>\n"
+       "  --trainer_placement=<string>\n"
+       "      contiguous (default): trainers are blocks of consecutive ranks\n"
+       "      topology: trainers are blocks of ranks ordered by node and NUMA\n"
+       "      domain, so each trainer spans as few nodes as possible\n"
        "  --num_parallel_readers=<int>\n"
        "  --num_io_threads=<int>\n"
        "      # of threads used for I/O by the data readers\n"
+       "  --numa_placement=<string>\n"
+       "      none (default), first_touch or interleave: how the pages of the\n"
+       "      activation memory plan and of the data store's shared segments\n"
+       "      are spread over NUMA domains (interleave needs hwloc)\n"
+       "  --partition_cores\n"
+       "      split the cores each process is bound to between OpenMP compute\n"
+       "      threads and pinned I/O threads (--num_io_threads of them), so\n"
+       "      they do not compete; I/O jobs run single-threaded OpenMP regions\n"
        "  --serialize_io=<bool>\n"
        "      force data readers to use a single thread for I/O\n"
        "  --disable_background_io_activity=<bool>\n"
        "      prevent the input layers from fetching data in the background\n"
+       "  --metric_sync_interval=<int>\n"
+       "      accumulate metric values (on the GPU for GPU layers) and add\n"
+       "      them to the statistics every <int> steps and at epoch and\n"
+       "      evaluation end, instead of reading them every step (default: 1)\n"
+       "  --metadata_cache_dir=<string>\n"
+       "      cache the sample metadata that csv and smiles data readers share\n"
+       "      at startup in this directory (ideally node-local), keyed by the\n"
+       "      input files and reader parameters; reruns load it from disk\n"
+       "  --prototext_cache_dir=<string>\n"
+       "      cache parsed prototext files in binary form in this directory,\n"
+       "      keyed by the text and the build; reruns and restarts skip the\n"
+       "      text parsing\n"
        "  --disable_cuda=<bool>\n"
        "     has no effect unless lbann was compiled with: LBANN_HAS_CUDNN\n"
+       "  --gpu_caching_allocator\n"
+       "      allocate GPU layer outputs, the cuDNN workspace, and Thrust\n"
+       "      buffers from a caching allocator with size classes and\n"
+       "      per-stream free lists; the gpu_memory_usage callback prints\n"
+       "      its statistics\n"
+       "  --gpu_arena_mb=<int>\n"
+       "      with --gpu_caching_allocator, reserve one <int> MiB region of\n"
+       "      GPU memory at first use and carve blocks from it first\n"
+       "  --pinned_memory_mb=<int>\n"
+       "      cap on the pinned host memory the staging buffer pool holds for\n"
+       "      input buffers, checkpoint and dump staging, and metric readback;\n"
+       "      larger requests get pageable memory (default: 2048)\n"
+       "  --hierarchical_allreduce\n"
+       "      reduce within each node, then across nodes, then broadcast\n"
+       "      within each node for large allreduces\n"
+       "  --hierarchical_allreduce_min_bytes=<int>\n"
+       "      with --hierarchical_allreduce, smaller allreduces stay flat;\n"
+       "      comm-benchmarks suggests a value (default: 1048576)\n"
+       "  --deterministic\n"
+       "      bit-reproducible run: fixed-order host allreduces, autotuned\n"
+       "      deterministic cuDNN algorithms, and counter-based dropout\n"
+       "      masks; always on if built with LBANN_DETERMINISTIC\n"
        "  --random_seed=<int>\n"
        "  --objective_function<string>\n"
        "      <string> must be: categorical_cross_entropy or mean_squared_error\n"
@@ -857,12 +1039,44 @@ void print_help(std::ostream& os)
        "      <string> must be: data_parallel or model_parallel\n"
        "      note: this will be applied to all layers, metrics (and others)\n"
        "            that take DATA_PARALLEL or MODEL_PARALLEL as a template parameter\n"
+       "  --fuse_crop_concatenate\n"
+       "      concatenate layers read the crop window of crop layers with a\n"
+       "      constant position directly (e.g. U-Net skip connections), and\n"
+       "      the crop layers are removed\n"
+       "  --propagate_data_layouts\n"
+       "      entry-wise layers without a data_layout take the layout of their\n"
+       "      neighbors to avoid redistributions (as with data_layout: \"auto\")\n"
+       "  --parallel_plan=<string>\n"
+       "      set layer data layouts and parallel strategies from a plan\n"
+       "      written by the parallel_plan callback\n"
+       "  --estimate\n"
+       "      set up the model, print its description with estimated FLOPs,\n"
+       "      memory per process, communication volume and step time, and\n"
+       "      exit without training\n"
+       "  --estimate_calibration=<string>\n"
+       "      with --estimate, use layer rates and allreduce bandwidth from a\n"
+       "      benchmark JSON report (see benchmarks/)\n"
        "  --print_affinity\n"
        "      display information on how OpenMP threads are provisioned\n"
+       "  --sampling_profile=<string>\n"
+       "      sample call stacks of the main and I/O threads and write folded\n"
+       "      stacks for flame graphs to <string>.<rank>.folded\n"
+       "  --sampling_profile_hz=<float>\n"
+       "      samples per second of each thread's CPU time (default: 99)\n"
        "  --use_data_store \n"
        "      Enables the data store in-memory structure\n"
        "  --preload_data_store \n"
        "      Preloads the data store in-memory structure during data reader load time\n"
+       "  --data_store_quantize=<string>\n"
+       "      Comma-separated name:type pairs; floating-point fields of the\n"
+       "      data store samples whose path contains <name> are stored as\n"
+       "      <type>: uint8 (scaled to each sample's range), fp16 or bf16,\n"
+       "      and restored when they are fetched\n"
+       "  --data_store_background_preload=<int>\n"
+       "      When not preloading, a background thread loads the samples of the\n"
+       "      first epoch into the data store ahead of the mini-batches that\n"
+       "      fetch them, at up to <int> samples per second per rank. Supported\n"
+       "      by the mesh and pilot2_molecular readers\n"
        "  --super_node \n"
        "      Enables the data store in-memory structure to use the supernode exchange structure\n"
        "  --write_sample_list \n"
@@ -894,6 +1108,9 @@ void print_help(std::ostream& os)
        "  --label_filename_train=<string> --label_filename_test=<string>\n"
        "  --data_reader_percent=<float>\n"
        "  --share_testing_data_readers=<bool:[0|1]>\n"
+       "  --mesh_pack_channels\n"
+       "      mesh reader: pack each sample's channel and target files into one\n"
+       "      file under packed<suffix>/ at load time, if not already packed\n"
        "\n"
        "Callbacks:\n"
        "  --image_dir=<string>\n"
@@ -214,6 +214,24 @@ void trainer::for_each_execution_context(std::function<void(observer_ptr<executi
   }
 }
 
+void trainer::transfer_execution_contexts(observer_ptr<model> old_model,
+                                          observer_ptr<model> new_model) {
+  // Inserting may rehash the map, so collect the contexts first
+  std::vector<std::pair<execution_mode, std::unique_ptr<execution_context>>> contexts;
+  for (auto it = m_model_execution_context.begin();
+       it != m_model_execution_context.end();) {
+    if (it->first.first == old_model) {
+      contexts.emplace_back(it->first.second, std::move(it->second));
+      it = m_model_execution_context.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (auto&& c : contexts) {
+    c.second->set_terminate_training(false);
+    m_model_execution_context[std::make_pair(new_model, c.first)] = std::move(c.second);
+  }
+}
 
 ////////////////////////////////////////////////////////////
 // Evaluation and training
@@ -248,6 +266,20 @@ void trainer::evaluate(observer_ptr<model> model, execution_mode mode, El::Int n
   sgd.get()->evaluate(static_cast<sgd_execution_context&>(*(m_model_execution_context[key].get())), *model, get_data_coordinator(), mode, num_batches);
 }
 
+void trainer::begin_evaluation_on_snapshot(observer_ptr<model> model, execution_mode mode) {
+  auto sgd = make_unique<sgd_training_algorithm>();
+  auto key = check_and_build_execution_context(*sgd.get(), model, mode);
+  DataReaderMetaData dr_metadata = get_data_coordinator().get_dr_metadata();
+  sgd.get()->setup_models({model}, get_max_mini_batch_size(), dr_metadata);
+  sgd.get()->begin_evaluation_on_snapshot(static_cast<sgd_execution_context&>(*(m_model_execution_context[key].get())), *model, get_data_coordinator(), mode);
+}
+
+bool trainer::evaluate_on_snapshot(observer_ptr<model> model, execution_mode mode, El::Int num_batches) {
+  auto sgd = make_unique<sgd_training_algorithm>();
+  auto key = check_and_build_execution_context(*sgd.get(), model, mode);
+  return sgd.get()->evaluate_on_snapshot(static_cast<sgd_execution_context&>(*(m_model_execution_context[key].get())), *model, get_data_coordinator(), num_batches);
+}
+
 // =============================================
 // Checkpointing
 // =============================================
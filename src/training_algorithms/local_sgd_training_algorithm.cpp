@@ -0,0 +1,221 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/training_algorithms/local_sgd_training_algorithm.hpp"
+#include "lbann/models/model.hpp"
+#include "lbann/weights/data_type_weights.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace lbann {
+
+local_sgd_training_algorithm::local_sgd_training_algorithm(
+  size_t sync_interval,
+  bool intertrainer,
+  bool adaptive,
+  size_t max_sync_interval,
+  double divergence_target,
+  bool async)
+  : m_sync_interval(sync_interval),
+    m_intertrainer(intertrainer),
+    m_adaptive(adaptive),
+    m_max_sync_interval(std::max(max_sync_interval, sync_interval)),
+    m_divergence_target(divergence_target),
+    m_async(async) {
+  if (sync_interval < 1) {
+    LBANN_ERROR("local SGD requires a synchronization interval of at least 1");
+  }
+  if (adaptive && divergence_target <= 0) {
+    LBANN_ERROR("adaptive local SGD requires a positive divergence target");
+  }
+}
+
+void local_sgd_training_algorithm::apply(execution_context& context,
+                                         model& model,
+                                         data_coordinator& dc,
+                                         execution_mode mode,
+                                         termination_criteria const& term_criteria) {
+  if (mode != execution_mode::training) {
+    sgd_training_algorithm::apply(context, model, dc, mode, term_criteria);
+    return;
+  }
+
+  // Replicas within a trainer step with their local gradients
+  std::vector<std::pair<optimizer*, bool>> allreduce_enabled;
+  if (m_intertrainer) {
+    broadcast_weights(model);
+  } else {
+    for (weights* w : model.get_weights()) {
+      auto* opt = w->get_optimizer();
+      if (opt != nullptr) {
+        allreduce_enabled.emplace_back(opt, opt->get_gradient_allreduce_enabled());
+        opt->set_gradient_allreduce_enabled(false);
+      }
+    }
+  }
+
+  m_steps_since_sync = 0;
+  sgd_training_algorithm::apply(context, model, dc, mode, term_criteria);
+  if (!m_pending.empty()) {
+    finish_average_weights(model);
+  }
+  if (m_steps_since_sync > 0) {
+    average_weights(model);
+  }
+
+  for (auto& opt_flag : allreduce_enabled) {
+    opt_flag.first->set_gradient_allreduce_enabled(opt_flag.second);
+  }
+}
+
+bool local_sgd_training_algorithm::train_mini_batch(sgd_execution_context& c,
+                                                    model& model,
+                                                    data_coordinator& dc) {
+  const bool finished = sgd_training_algorithm::train_mini_batch(c, model, dc);
+  if (++m_steps_since_sync >= m_sync_interval) {
+    if (m_async) {
+      if (!m_pending.empty()) {
+        adapt_sync_interval(finish_average_weights(model));
+      }
+      start_average_weights(model);
+    } else {
+      adapt_sync_interval(average_weights(model));
+    }
+  }
+  return finished;
+}
+
+void local_sgd_training_algorithm::adapt_sync_interval(double divergence) {
+  if (!m_adaptive) { return; }
+  if (divergence < m_divergence_target / 2) {
+    m_sync_interval = std::min(2 * m_sync_interval, m_max_sync_interval);
+  } else if (divergence > m_divergence_target) {
+    m_sync_interval = std::max(m_sync_interval / 2, size_t(1));
+  }
+}
+
+void local_sgd_training_algorithm::start_average_weights(model& m) {
+  m.apply_pending_weight_updates();
+  auto& comm = *m.get_comm();
+  for (weights* w : m.get_weights()) {
+    if (!w->has_optimizer()) { continue; }
+    auto& dt_w = dynamic_cast<data_type_weights<DataType>&>(*w);
+    pending_average p;
+    p.w = w;
+    p.sent.reset(dt_w.get_values().Copy());
+    p.sum.reset(dt_w.get_values().Copy());
+    if (m_intertrainer) {
+      comm.nb_intertrainer_sum_matrix(*p.sum, p.req);
+    } else {
+      comm.nb_allreduce(*p.sum, p.sum->RedundantComm(), p.req);
+    }
+    m_pending.push_back(std::move(p));
+  }
+  m_steps_since_sync = 0;
+}
+
+double local_sgd_training_algorithm::finish_average_weights(model& m) {
+  m.apply_pending_weight_updates();
+  auto& comm = *m.get_comm();
+  double sums[2] = {0, 0};  // Squared distance and squared norm
+  for (auto& p : m_pending) {
+    comm.wait(p.req);
+    auto& dt_w = dynamic_cast<data_type_weights<DataType>&>(*p.w);
+    auto& avg = *p.sum;
+    const DataType scale = DataType(1) / (m_intertrainer ?
+                                          comm.get_num_trainers() :
+                                          avg.RedundantSize());
+    El::Scale(scale, avg);
+    if (m_adaptive) {
+      CPUMat local_avg, local_diff;
+      El::Copy(avg.LockedMatrix(), local_avg);
+      El::Copy(p.sent->LockedMatrix(), local_diff);
+      El::Axpy(DataType(-1), local_avg, local_diff);
+      const double diff_norm = El::FrobeniusNorm(local_diff);
+      const double avg_norm = El::FrobeniusNorm(local_avg);
+      sums[0] += diff_norm * diff_norm;
+      sums[1] += avg_norm * avg_norm;
+    }
+    // w - w_sent + avg(w_sent), keeping the progress since the snapshot
+    auto values = to_unique_ptr(dt_w.get_values().Copy());
+    El::Axpy(DataType(-1), *p.sent, *values);
+    El::Axpy(DataType(1), avg, *values);
+    dt_w.set_values(*values);
+  }
+  m_pending.clear();
+
+  if (!m_adaptive) { return 0; }
+  comm.allreduce(sums, 2, comm.get_world_comm());
+  return (sums[1] > 0 ? std::sqrt(sums[0] / sums[1]) : 0);
+}
+
+double local_sgd_training_algorithm::average_weights(model& m) {
+  m.apply_pending_weight_updates();
+  auto& comm = *m.get_comm();
+  double sums[2] = {0, 0};  // Squared distance and squared norm
+  for (weights* w : m.get_weights()) {
+    if (!w->has_optimizer()) { continue; }
+    auto& dt_w = dynamic_cast<data_type_weights<DataType>&>(*w);
+    auto values = to_unique_ptr(dt_w.get_values().Copy());
+    if (m_intertrainer) {
+      comm.intertrainer_sum_matrix(*values);
+      El::Scale(DataType(1) / comm.get_num_trainers(), *values);
+    } else {
+      comm.allreduce(*values, values->RedundantComm());
+      El::Scale(DataType(1) / values->RedundantSize(), *values);
+    }
+    if (m_adaptive) {
+      CPUMat local_avg, local_diff;
+      El::Copy(values->LockedMatrix(), local_avg);
+      El::Copy(dt_w.get_values().LockedMatrix(), local_diff);
+      El::Axpy(DataType(-1), local_avg, local_diff);
+      const double diff_norm = El::FrobeniusNorm(local_diff);
+      const double avg_norm = El::FrobeniusNorm(local_avg);
+      sums[0] += diff_norm * diff_norm;
+      sums[1] += avg_norm * avg_norm;
+    }
+    dt_w.set_values(*values);
+  }
+  m_steps_since_sync = 0;
+
+  if (!m_adaptive) { return 0; }
+  comm.allreduce(sums, 2, comm.get_world_comm());
+  return (sums[1] > 0 ? std::sqrt(sums[0] / sums[1]) : 0);
+}
+
+void local_sgd_training_algorithm::broadcast_weights(model& m) {
+  auto& comm = *m.get_comm();
+  if (comm.get_num_trainers() == 1) { return; }
+  for (weights* w : m.get_weights()) {
+    auto& dt_w = dynamic_cast<data_type_weights<DataType>&>(*w);
+    auto values = to_unique_ptr(dt_w.get_values().Copy());
+    comm.intertrainer_broadcast_matrix(*values, 0);
+    dt_w.set_values(*values);
+  }
+}
+
+}  // namespace lbann
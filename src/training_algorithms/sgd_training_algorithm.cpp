@@ -27,6 +27,9 @@
 #include "lbann/training_algorithms/sgd_training_algorithm.hpp"
 #include "lbann/models/model.hpp"
 #include "lbann/callbacks/callback.hpp"
+#include "lbann/utils/options.hpp"
+#include <algorithm>
+#include <mutex>
 
 namespace lbann {
 
@@ -65,6 +68,18 @@ void sgd_training_algorithm::train(sgd_execution_context& c,
   model.reset_mode(c, execution_mode::training);
   dc.reset_mode(c);
 
+  // Validation can be interleaved with the next epoch's training
+  // Note: Validation mini-batches then run on a snapshot of the
+  // weights from the end of the epoch, so training does not stall at
+  // epoch boundaries.
+  int interleaved_validation_steps = 0;
+  if (options::get()->has_int("interleaved_validation_steps")) {
+    interleaved_validation_steps = options::get()->get_int("interleaved_validation_steps");
+  }
+  auto key = c.get_trainer().check_and_build_execution_context(c, model, execution_mode::validation);
+  auto& evaluation_context = static_cast<sgd_execution_context&>(c.get_trainer().get_execution_context(key));
+  bool validation_pending = false;
+
   do_train_begin_cbs(model);
   for (size_t epoch = c.get_epoch(); epoch < num_epochs; ++epoch) {
     if (c.get_terminate_training()) { break; }
@@ -76,21 +91,42 @@ void sgd_training_algorithm::train(sgd_execution_context& c,
     do_epoch_begin_cbs(model);
 
     // Training iterations
-    if (num_batches > 0) {
-      for (size_t i = 0; i < num_batches; i++) { train_mini_batch(c, model, dc); }
-    } else {
-      while (!train_mini_batch(c, model, dc)) {}
+    bool finished = false;
+    for (size_t i = 0; num_batches > 0 ? i < num_batches : !finished; ++i) {
+      finished = train_mini_batch(c, model, dc);
+      if (validation_pending) {
+        validation_pending = !evaluate_on_snapshot(evaluation_context, model, dc,
+                                                   interleaved_validation_steps);
+      }
     }
 
     // Finalize epoch
     c.inc_epoch();
+    model.apply_pending_weight_updates();
     model.reconcile_weight_values();
     do_epoch_end_cbs(model);
 
     // Evaluate on validation set
-    auto key = c.get_trainer().check_and_build_execution_context(c, model, execution_mode::validation);
-    auto& evaluation_context = static_cast<sgd_execution_context&>(c.get_trainer().get_execution_context(key));
-    evaluate(evaluation_context, model, dc, execution_mode::validation);
+    if (validation_pending) {
+      evaluate_on_snapshot(evaluation_context, model, dc, 0);
+    }
+    if (interleaved_validation_steps > 0
+        && model.is_execution_mode_valid(execution_mode::validation)) {
+      begin_evaluation_on_snapshot(evaluation_context, model, dc,
+                                   execution_mode::validation);
+      validation_pending = true;
+    } else {
+      evaluate(evaluation_context, model, dc, execution_mode::validation);
+    }
+    if (evaluation_context.get_terminate_training()) {
+      c.set_terminate_training(true);
+    }
+  }
+  if (validation_pending) {
+    evaluate_on_snapshot(evaluation_context, model, dc, 0);
+  }
+  if (evaluation_context.get_terminate_training()) {
+    c.set_terminate_training(true);
   }
   do_train_end_cbs(model);
 }
@@ -106,7 +142,27 @@ bool sgd_training_algorithm::train_mini_batch(sgd_execution_context& c,
   dc.reset_mode(c);
   do_batch_begin_cbs(model, execution_mode::training);
 
-  bool finished;
+  bool finished = false;
+
+  // Accumulate gradients over micro-batches before the optimization
+  // step
+  // Note: The last step of an epoch may have fewer micro-batches.
+  int num_micro_batches = 1;
+  if (options::get()->has_int("num_micro_batches")) {
+    num_micro_batches = options::get()->get_int("num_micro_batches");
+  }
+  if (num_micro_batches < 1) {
+    LBANN_ERROR("--num_micro_batches must be positive; got ",
+                num_micro_batches);
+  }
+  const auto* dr = dc.get_data_reader(execution_mode::training);
+  if (num_micro_batches > 1 && dr != nullptr) {
+    std::lock_guard<std::mutex> guard(dc.dr_mutex);
+    const int remaining = (dr->get_num_iterations_per_epoch()
+                           - dr->get_current_step_in_epoch());
+    num_micro_batches = std::max(1, std::min(num_micro_batches, remaining));
+  }
+  const EvalType gradient_scale = EvalType(1) / num_micro_batches;
 
 #if defined(LBANN_HAVE_OMP_TASKLOOP)
   LBANN_OMP_PARALLEL
@@ -114,27 +170,53 @@ bool sgd_training_algorithm::train_mini_batch(sgd_execution_context& c,
     #pragma omp single
     {
 #endif
-  // Forward prop step
   model.clear_gradients();
-  model.forward_prop(execution_mode::training);
-  // Result is not needed until the end of the mini-batch.
-  model.get_objective_function()->start_evaluation(execution_mode::training,
-                                                    c.get_current_mini_batch_size());
-
-  // Backward prop step
-  model.get_objective_function()->differentiate();
-  model.backward_prop();
-  model.get_objective_function()->compute_weight_regularization();
+  for (int micro_batch = 0; micro_batch < num_micro_batches; ++micro_batch) {
+
+    // Allreduce the accumulated gradients during the last
+    // micro-batch's backprop
+    if (num_micro_batches > 1) {
+      model.set_gradient_allreduces_deferred(micro_batch < num_micro_batches - 1);
+    }
+
+    // Note: A CUDA graph records the gradient buffers' scaling
+    // factors, so it can not accumulate gradients.
+    if (num_micro_batches == 1 && model.using_training_graph()) {
+      // Forward and backward prop steps
+      // Note: The GPU work may be replayed from a CUDA graph, so the
+      // objective function is only evaluated afterwards.
+      model.get_objective_function()->differentiate();
+      model.forward_backward_prop_with_graph();
+      model.get_objective_function()->start_evaluation(execution_mode::training,
+                                                        c.get_current_mini_batch_size());
+    } else {
+      // Forward prop step
+      model.forward_prop(execution_mode::training);
+      // Result is not needed until the end of the mini-batch.
+      model.get_objective_function()->start_evaluation(execution_mode::training,
+                                                        c.get_current_mini_batch_size());
+
+      // Backward prop step
+      model.get_objective_function()->differentiate(gradient_scale);
+      model.backward_prop();
+    }
 
-  // Finish evaluation.
-  model.get_objective_function()->finish_evaluation(execution_mode::training,
-                                                     c.get_current_mini_batch_size());
-  model.evaluate_metrics(execution_mode::training,
-                          c.get_current_mini_batch_size());
+    // Finish evaluation.
+    model.get_objective_function()->finish_evaluation(execution_mode::training,
+                                                       c.get_current_mini_batch_size());
+    model.evaluate_metrics(execution_mode::training,
+                            c.get_current_mini_batch_size());
+
+    finished = model.update_layers();
+    if (finished) { break; }
+  }
+  if (num_micro_batches > 1) {
+    model.set_gradient_allreduces_deferred(false);
+  }
+  model.get_objective_function()->compute_weight_regularization();
 
   // Update step
   model.update_weights();
-  finished = model.update_layers();
 #if defined(LBANN_HAVE_OMP_TASKLOOP)
     }
   }
@@ -174,6 +256,43 @@ void sgd_training_algorithm::evaluate(sgd_execution_context& c,
   do_evaluate_end_cbs(model, mode);
 }
 
+void sgd_training_algorithm::begin_evaluation_on_snapshot(sgd_execution_context& c,
+                                                          model& model,
+                                                          data_coordinator& dc,
+                                                          execution_mode mode) {
+  for (auto* w : model.get_weights()) {
+    w->save_snapshot();
+  }
+  model.reset_epoch_statistics(mode);
+  model.reset_mode(c, mode);
+  dc.reset_mode(c);
+  do_evaluate_begin_cbs(model, mode);
+}
+
+bool sgd_training_algorithm::evaluate_on_snapshot(sgd_execution_context& c,
+                                                  model& model,
+                                                  data_coordinator& dc,
+                                                  size_t num_batches) {
+  const auto mode = c.get_execution_mode();
+  const auto& weights_list = model.get_weights();
+  for (auto* w : weights_list) {
+    w->swap_snapshot();
+  }
+  bool finished = false;
+  for (size_t i = 0; !finished && (num_batches == 0 || i < num_batches); ++i) {
+    finished = evaluate_mini_batch(c, model, dc, mode);
+  }
+  if (finished) {
+    c.inc_epoch();
+    do_evaluate_end_cbs(model, mode);
+  }
+  for (auto* w : weights_list) {
+    w->swap_snapshot();
+    if (finished) { w->clear_snapshot(); }
+  }
+  return finished;
+}
+
 bool sgd_training_algorithm::evaluate_mini_batch(sgd_execution_context& c,
                                                  model& model,
                                                  data_coordinator& dc,
@@ -221,6 +340,7 @@ void sgd_training_algorithm::do_evaluate_begin_cbs(model& model, execution_mode
 }
 
 void sgd_training_algorithm::do_evaluate_end_cbs(model& model, execution_mode mode) {
+  model.synchronize_metrics();
   for (const auto& cb : model.get_callbacks()) {
     switch (mode) {
     case execution_mode::validation:
@@ -240,6 +360,7 @@ void sgd_training_algorithm::do_epoch_begin_cbs(model& model) {
 }
 
 void sgd_training_algorithm::do_epoch_end_cbs(model& model) {
+  model.synchronize_metrics();
   for (const auto& cb : model.get_callbacks()) {
     cb->on_epoch_end(&model);
   }
@@ -105,6 +105,28 @@ void normalize::apply(utils::type_erased_matrix& data, CPUMat& out,
   }
 }
 
+void normalize::apply_batch(CPUMat& data, const std::vector<size_t>& dims) {
+  if (dims.size() == 3 && m_means.size() != dims[0]) {
+    LBANN_ERROR("Normalize channels does not match data");
+  } else if (dims.size() != 3 && m_means.size() != 1) {
+    LBANN_ERROR("Transform data has no channels, cannot normalize with multiple channels");
+  }
+  const size_t num_channels = m_means.size();
+  const size_t size = data.Height() / num_channels;
+  // Same arithmetic as apply(), so batching does not change results
+  for (El::Int col = 0; col < data.Width(); ++col) {
+    DataType* __restrict__ buf = data.Buffer(0, col);
+    for (size_t channel = 0; channel < num_channels; ++channel) {
+      const DataType mean = m_means[channel];
+      const DataType std = m_stds[channel];
+      DataType* __restrict__ channel_buf = buf + channel*size;
+      for (size_t i = 0; i < size; ++i) {
+        channel_buf[i] = (channel_buf[i] - mean) / std;
+      }
+    }
+  }
+}
+
 std::unique_ptr<transform>
 build_normalize_transform_from_pbuf(google::protobuf::Message const& msg) {
   auto& pb_trans = dynamic_cast<lbann_data::Transform::Normalize const&>(msg);
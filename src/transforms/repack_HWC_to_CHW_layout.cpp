@@ -26,6 +26,7 @@
 
 #include "lbann/transforms/repack_HWC_to_CHW_layout.hpp"
 #include "lbann/utils/opencv.hpp"
+#include "lbann/transforms/vision/layout_kernels.hpp"
 
 namespace lbann {
 namespace transform {
@@ -50,34 +51,12 @@ void repack_HWC_to_CHW_layout::apply(utils::type_erased_matrix& data, CPUMat& ou
   if (static_cast<size_t>(out.Height() * out.Width()) != out_size) {
     LBANN_ERROR("Transform output does not have sufficient space.");
   }
-  DataType* __restrict__ dst_buf = out.Buffer();
+  if (dims[0] < 1 || dims[0] > 4) {
+    LBANN_ERROR("Unsupported number of channels");
+  }
   // Pack an interleave multi-channel data structure into a
   // channel-strided data structure
-  const size_t size = dims[1] * dims[2];
-  for (size_t row = 0; row < dims[1]; ++row) {
-    for (size_t col = 0; col < dims[2]; ++col) {
-      int N = dims[0];
-      // Multiply by N because there are N channels.
-      const size_t src_base = N*(row + col*dims[1]);
-      const size_t dst_base = row + col*dims[1];
-      switch(N) {
-      case 4:
-        dst_buf[dst_base + 3*size] = src_buf[src_base + 3];
-        [[fallthrough]];
-      case 3:
-        dst_buf[dst_base + 2*size] = src_buf[src_base + 2];
-        [[fallthrough]];
-      case 2:
-        dst_buf[dst_base + size] = src_buf[src_base + 1];
-        [[fallthrough]];
-      case 1:
-        dst_buf[dst_base] = src_buf[src_base];
-        break;
-      default:
-        LBANN_ERROR("Unsupported number of channels");
-      }
-    }
-  }
+  deinterleave_channels(src_buf, dims[0], dims[1] * dims[2], out.Buffer());
 }
 
 }  // namespace transform
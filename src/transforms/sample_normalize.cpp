@@ -46,6 +46,19 @@ void sample_normalize::apply(utils::type_erased_matrix& data, std::vector<size_t
   }
 }
 
+void sample_normalize::apply_batch(CPUMat& data, const std::vector<size_t>&) {
+  const El::Int height = data.Height();
+  for (El::Int col = 0; col < data.Width(); ++col) {
+    auto sample = data(El::IR(0, height), El::IR(col, col + 1));
+    DataType mean, stdev;
+    entrywise_mean_and_stdev(sample, mean, stdev);
+    DataType* __restrict__ buf = sample.Buffer();
+    for (El::Int i = 0; i < height; ++i) {
+      buf[i] = (buf[i] - mean) / stdev;
+    }
+  }
+}
+
 std::unique_ptr<transform>
 build_sample_normalize_transform_from_pbuf(google::protobuf::Message const&) {
   return make_unique<sample_normalize>();
@@ -46,6 +46,20 @@ void scale::apply(utils::type_erased_matrix& data, std::vector<size_t>&) {
   }
 }
 
+void scale::apply_batch(CPUMat& data, const std::vector<size_t>&) {
+  const El::Int height = data.Height();
+  const El::Int ldim = data.LDim();
+  // Contiguous columns are scaled as one long vector
+  const El::Int num_cols = (height == ldim) ? 1 : data.Width();
+  const El::Int size = (height == ldim) ? height * data.Width() : height;
+  for (El::Int col = 0; col < num_cols; ++col) {
+    DataType* __restrict__ buf = data.Buffer() + col * ldim;
+    for (El::Int i = 0; i < size; ++i) {
+      buf[i] *= m_scale;
+    }
+  }
+}
+
 std::unique_ptr<transform>
 build_scale_transform_from_pbuf(google::protobuf::Message const& msg) {
   auto const& params = dynamic_cast<lbann_data::Transform::Scale const&>(msg);
@@ -44,5 +44,19 @@ void scale_and_translate::apply(utils::type_erased_matrix& data, std::vector<siz
   }
 }
 
+void scale_and_translate::apply_batch(CPUMat& data, const std::vector<size_t>&) {
+  const El::Int height = data.Height();
+  const El::Int ldim = data.LDim();
+  // Contiguous columns are processed as one long vector
+  const El::Int num_cols = (height == ldim) ? 1 : data.Width();
+  const El::Int size = (height == ldim) ? height * data.Width() : height;
+  for (El::Int col = 0; col < num_cols; ++col) {
+    DataType* __restrict__ buf = data.Buffer() + col * ldim;
+    for (El::Int i = 0; i < size; ++i) {
+      buf[i] = m_scale * buf[i] + m_translate;
+    }
+  }
+}
+
 }  // namespace transform
 }  // namespace lbann
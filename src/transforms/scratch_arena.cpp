@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/transforms/scratch_arena.hpp"
+
+#include <cstdint>
+
+namespace lbann {
+namespace transform {
+
+constexpr size_t scratch_arena::alignment;
+
+scratch_arena& scratch_arena::get() {
+  static thread_local scratch_arena arena;
+  return arena;
+}
+
+void scratch_arena::reserve(size_t bytes) {
+  if (bytes <= m_capacity) {
+    return;
+  }
+  m_buffer.reset(new uint8_t[bytes + alignment]);
+  const auto addr = reinterpret_cast<uintptr_t>(m_buffer.get());
+  m_base = m_buffer.get() + (alignment - addr % alignment) % alignment;
+  m_capacity = bytes;
+}
+
+uint8_t* scratch_arena::allocate(size_t bytes) {
+  // Keep every allocation cache-line aligned
+  const size_t padded = (bytes + alignment - 1) / alignment * alignment;
+  m_requested += padded;
+  if (m_used + padded <= m_capacity) {
+    uint8_t* ptr = m_base + m_used;
+    m_used += padded;
+    return ptr;
+  }
+  m_overflow.emplace_back(new uint8_t[padded]);
+  return m_overflow.back().get();
+}
+
+void scratch_arena::reset() {
+  const size_t needed = m_requested;
+  m_used = 0;
+  m_requested = 0;
+  if (!m_overflow.empty() || needed > m_capacity) {
+    m_overflow.clear();
+    reserve(needed);
+  }
+}
+
+scratch_scope::scratch_scope(size_t reserve_bytes)
+  : m_arena(scratch_arena::get()), m_owner(!m_arena.m_active) {
+  if (m_owner) {
+    m_arena.reserve(reserve_bytes);
+    m_arena.m_active = true;
+  }
+}
+
+scratch_scope::~scratch_scope() {
+  if (m_owner) {
+    m_arena.m_active = false;
+    m_arena.reset();
+  }
+}
+
+El::Matrix<uint8_t> make_scratch_matrix(size_t size) {
+  scratch_arena& arena = scratch_arena::get();
+  if (!arena.active() || size == 0) {
+    return El::Matrix<uint8_t>(size, 1);
+  }
+  // A view, so the arena keeps ownership of the memory
+  return El::Matrix<uint8_t>(size, 1, arena.allocate(size), size);
+}
+
+}  // namespace transform
+}  // namespace lbann
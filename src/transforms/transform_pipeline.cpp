@@ -25,13 +25,36 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lbann/transforms/transform_pipeline.hpp"
+#include "lbann/transforms/scratch_arena.hpp"
 #include "lbann/utils/exception.hpp"
+#include "lbann/utils/io_profile.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
 
 namespace lbann {
 namespace transform {
 
+namespace {
+thread_local bool defer_batch = false;
+}  // namespace
+
+deferred_batch_scope::deferred_batch_scope(bool enable) : m_prev(defer_batch) {
+  defer_batch = m_prev || enable;
+}
+
+deferred_batch_scope::~deferred_batch_scope() {
+  defer_batch = m_prev;
+}
+
+bool deferred_batch_scope::active() {
+  return defer_batch;
+}
+
 transform_pipeline::transform_pipeline(const transform_pipeline& other) :
-  m_expected_out_dims(other.m_expected_out_dims) {
+  m_expected_out_dims(other.m_expected_out_dims),
+  m_fuse(other.m_fuse) {
   for (const auto& trans : other.m_transforms) {
     m_transforms.emplace_back(trans->copy());
   }
@@ -40,6 +63,7 @@ transform_pipeline::transform_pipeline(const transform_pipeline& other) :
 transform_pipeline& transform_pipeline::operator=(
   const transform_pipeline& other) {
   m_expected_out_dims = other.m_expected_out_dims;
+  m_fuse = other.m_fuse;
   m_transforms.clear();
   for (const auto& trans : other.m_transforms) {
     m_transforms.emplace_back(trans->copy());
@@ -49,8 +73,10 @@ transform_pipeline& transform_pipeline::operator=(
 
 void transform_pipeline::apply(utils::type_erased_matrix& data,
                                std::vector<size_t>& dims) {
-  for (auto& trans : m_transforms) {
-    trans->apply(data, dims);
+  io_profile::scope profile(io_profile::stage::transform);
+  const size_t num_transforms = get_num_per_sample();
+  for (size_t i = 0; i < num_transforms; ++i) {
+    m_transforms[i]->apply(data, dims);
   }
   assert_expected_out_dims(dims);
 }
@@ -62,11 +88,25 @@ void transform_pipeline::apply(CPUMat& data, std::vector<size_t>& dims) {
 }
 
 void transform_pipeline::apply(El::Matrix<uint8_t>& data, CPUMat& out_data,
-                               std::vector<size_t>& dims) {
+                               std::vector<size_t>& dims, size_t first) {
+  io_profile::scope profile(io_profile::stage::transform);
+  if (m_fuse && supports_fuse(first) && dims.size() == 3 && dims[0] == 3) {
+    apply_fused(data, out_data, dims, first);
+    return;
+  }
+  // Intermediate images come from this thread's arena; they are all
+  // consumed by the time out_data is written
+  size_t expected_size = 0;
+  if (!m_expected_out_dims.empty()) {
+    expected_size = std::accumulate(m_expected_out_dims.begin(),
+                                    m_expected_out_dims.end(),
+                                    size_t{1}, std::multiplies<size_t>());
+  }
+  scratch_scope scratch(4*expected_size);
   utils::type_erased_matrix m = utils::type_erased_matrix(std::move(data));
-  if (!m_transforms.empty()) {
+  if (first < m_transforms.size()) {
     bool applied_non_inplace = false;
-    size_t i = 0;
+    size_t i = first;
     for (; !applied_non_inplace && i < m_transforms.size(); ++i) {
       if (m_transforms[i]->supports_non_inplace()) {
         applied_non_inplace = true;
@@ -82,7 +122,8 @@ void transform_pipeline::apply(El::Matrix<uint8_t>& data, CPUMat& out_data,
       // Apply the remaining transforms.
       // TODO(pp): Prevent out_data from being resized/reallocated.
       m = utils::type_erased_matrix(std::move(out_data));
-      for (; i < m_transforms.size(); ++i) {
+      const size_t num_transforms = get_num_per_sample();
+      for (; i < num_transforms; ++i) {
         m_transforms[i]->apply(m, dims);
       }
       out_data = std::move(m.template get<DataType>());
@@ -93,6 +134,124 @@ void transform_pipeline::apply(El::Matrix<uint8_t>& data, CPUMat& out_data,
   assert_expected_out_dims(dims);
 }
 
+void transform_pipeline::apply_fused(El::Matrix<uint8_t>& data,
+                                     CPUMat& out_data,
+                                     std::vector<size_t>& dims,
+                                     size_t first) {
+  const size_t in_h = dims[1];
+  const size_t in_w = dims[2];
+  if (static_cast<size_t>(data.Height() * data.Width()) != 3*in_h*in_w) {
+    LBANN_ERROR("Image does not match its dims");
+  }
+  fused_image_op op;
+  fuse(op, dims, first);
+  if (static_cast<size_t>(out_data.Height() * out_data.Width())
+      != dims[0]*dims[1]*dims[2]) {
+    LBANN_ERROR("Transform output does not have sufficient space.");
+  }
+  if (!out_data.Contiguous()) {
+    LBANN_ERROR("Fused transforms do not support non-contiguous destination.");
+  }
+  apply_fused_image_op(op, data.LockedBuffer(), in_h, in_w, dims[1], dims[2],
+                       out_data.Buffer());
+}
+
+size_t transform_pipeline::get_batch_start() const {
+  size_t start = m_transforms.size();
+  while (start > 0 && m_transforms[start-1]->supports_batch()) {
+    --start;
+  }
+  for (size_t i = 0; i < m_transforms.size(); ++i) {
+    if (m_transforms[i]->supports_non_inplace()) {
+      start = std::max(start, i + 1);
+      break;
+    }
+  }
+  return start;
+}
+
+size_t transform_pipeline::get_num_per_sample() const {
+  if (deferred_batch_scope::active() && supports_batch()) {
+    return get_batch_start();
+  }
+  return m_transforms.size();
+}
+
+bool transform_pipeline::supports_batch() const {
+  return !m_expected_out_dims.empty()
+    && get_batch_start() < m_transforms.size();
+}
+
+void transform_pipeline::apply_batch(CPUMat& data) const {
+  io_profile::scope profile(io_profile::stage::transform);
+  if (!supports_batch()) {
+    LBANN_ERROR("Transform pipeline has no batchable transforms");
+  }
+  const size_t sample_size = std::accumulate(
+    m_expected_out_dims.begin(), m_expected_out_dims.end(),
+    size_t{1}, std::multiplies<size_t>());
+  if (static_cast<size_t>(data.Height()) != sample_size) {
+    LBANN_ERROR("Batch of ", data.Height(), "-entry samples does not match "
+                "the expected ", sample_size, " entries");
+  }
+  for (size_t i = get_batch_start(); i < m_transforms.size(); ++i) {
+    m_transforms[i]->apply_batch(data, m_expected_out_dims);
+  }
+}
+
+bool transform_pipeline::supports_fuse(size_t first) const {
+  if (first >= m_transforms.size()) {
+    return false;
+  }
+  for (size_t i = first; i < m_transforms.size(); ++i) {
+    if (!m_transforms[i]->supports_fuse()) {
+      return false;
+    }
+  }
+  const std::string last = m_transforms.back()->get_type();
+  return last == "to_lbann_layout" || last == "normalize_to_lbann_layout";
+}
+
+void transform_pipeline::fuse(fused_image_op& op, std::vector<size_t>& dims,
+                              size_t first) const {
+  op = fused_image_op();
+  for (size_t i = first; i < m_transforms.size(); ++i) {
+    if (op.to_lbann_layout) {
+      LBANN_ERROR("Cannot fuse transforms after conversion to LBANN's layout");
+    }
+    m_transforms[i]->fuse(op, dims);
+  }
+  if (!op.to_lbann_layout) {
+    LBANN_ERROR("Fused transforms must end with conversion to LBANN's layout");
+  }
+  if (!m_expected_out_dims.empty() && dims != m_expected_out_dims) {
+    LBANN_ERROR("Fused transforms do not produce the expected dims");
+  }
+}
+
+size_t transform_pipeline::get_deterministic_prefix() const {
+  size_t prefix = 0;
+  while (prefix < m_transforms.size()
+         && m_transforms[prefix]->is_deterministic()
+         && !m_transforms[prefix]->supports_non_inplace()) {
+    ++prefix;
+  }
+  return prefix;
+}
+
+void transform_pipeline::apply_deterministic_prefix(El::Matrix<uint8_t>& data,
+                                                    std::vector<size_t>& dims) {
+  const size_t prefix = get_deterministic_prefix();
+  if (prefix == 0) {
+    return;
+  }
+  utils::type_erased_matrix m = utils::type_erased_matrix(std::move(data));
+  for (size_t i = 0; i < prefix; ++i) {
+    m_transforms[i]->apply(m, dims);
+  }
+  data = std::move(m.template get<uint8_t>());
+}
+
 void transform_pipeline::assert_expected_out_dims(
   const std::vector<size_t>& dims) {
   if (!m_expected_out_dims.empty() && dims != m_expected_out_dims) {
@@ -0,0 +1,40 @@
+// MUST include this
+#include <catch2/catch.hpp>
+
+// File being tested
+#include <lbann/transforms/scratch_arena.hpp>
+
+TEST_CASE("Testing transform scratch arena", "[preproc]") {
+  using lbann::transform::make_scratch_matrix;
+  using lbann::transform::scratch_arena;
+  using lbann::transform::scratch_scope;
+
+  SECTION("heap matrices outside a scope") {
+    auto mat = make_scratch_matrix(16);
+    REQUIRE(mat.Height() == 16);
+    REQUIRE_FALSE(mat.Viewing());
+  }
+
+  SECTION("arena matrices inside a scope") {
+    scratch_scope scope(1024);
+    auto a = make_scratch_matrix(100);
+    auto b = make_scratch_matrix(100);
+    REQUIRE(a.Viewing());
+    REQUIRE(b.Viewing());
+    // Allocations are aligned and do not overlap
+    REQUIRE(reinterpret_cast<uintptr_t>(a.Buffer()) % 64 == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(b.Buffer()) % 64 == 0);
+    REQUIRE(b.Buffer() >= a.Buffer() + 100);
+  }
+
+  SECTION("arena grows to the largest sample") {
+    {
+      scratch_scope scope(64);
+      auto a = make_scratch_matrix(64);
+      auto b = make_scratch_matrix(4096);
+      REQUIRE(b.Viewing());
+    }
+    REQUIRE(scratch_arena::get().capacity() >= 64 + 4096);
+    REQUIRE_FALSE(scratch_arena::get().active());
+  }
+}
@@ -27,6 +27,7 @@
 #include "lbann/transforms/vision/adjust_contrast.hpp"
 #include "lbann/utils/memory.hpp"
 #include "lbann/utils/opencv.hpp"
+#include "lbann/transforms/scratch_arena.hpp"
 
 #include <transforms.pb.h>
 
@@ -60,7 +61,7 @@ void adjust_contrast::apply(utils::type_erased_matrix& data, std::vector<size_t>
   } else {
     std::vector<size_t> gray_dims = {1, dims[1], dims[2]};
     const size_t size = utils::get_linearized_size(gray_dims);
-    auto gray_real = El::Matrix<uint8_t>(size, 1);
+    auto gray_real = make_scratch_matrix(size);
     cv::Mat gray = utils::get_opencv_mat(gray_real, gray_dims);
     cv::cvtColor(src, gray, cv::COLOR_BGR2GRAY);
     const uint8_t* __restrict__ gray_buf = gray.ptr();
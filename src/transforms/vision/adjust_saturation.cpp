@@ -27,6 +27,7 @@
 #include "lbann/transforms/vision/adjust_saturation.hpp"
 #include "lbann/utils/memory.hpp"
 #include "lbann/utils/opencv.hpp"
+#include "lbann/transforms/scratch_arena.hpp"
 
 #include <transforms.pb.h>
 
@@ -52,7 +53,7 @@ void adjust_saturation::apply(utils::type_erased_matrix& data, std::vector<size_
     // the grayscale value of each pixel.
     std::vector<size_t> gray_dims = {1, dims[1], dims[2]};
     const size_t gray_size = utils::get_linearized_size(gray_dims);
-    auto gray_real = El::Matrix<uint8_t>(gray_size, 1);
+    auto gray_real = make_scratch_matrix(gray_size);
     cv::Mat gray = utils::get_opencv_mat(gray_real, gray_dims);
     cv::cvtColor(src, gray, cv::COLOR_BGR2GRAY);
     const uint8_t* __restrict__ gray_buf = gray.ptr();
@@ -27,6 +27,7 @@
 #include "lbann/transforms/vision/center_crop.hpp"
 #include "lbann/utils/memory.hpp"
 #include "lbann/utils/opencv.hpp"
+#include "lbann/transforms/scratch_arena.hpp"
 
 #include <transforms.pb.h>
 
@@ -44,7 +45,7 @@ void center_crop::apply(utils::type_erased_matrix& data, std::vector<size_t>& di
     LBANN_ERROR(ss.str());
   }
   std::vector<size_t> new_dims = {dims[0], m_h, m_w};
-  auto dst_real = El::Matrix<uint8_t>(utils::get_linearized_size(new_dims), 1);
+  auto dst_real = make_scratch_matrix(utils::get_linearized_size(new_dims));
   cv::Mat dst = utils::get_opencv_mat(dst_real, new_dims);
   // Compute upper-left corner of crop.
   const size_t x = std::round(float(src.cols - m_w) / 2.0);
@@ -65,6 +66,18 @@ void center_crop::apply(utils::type_erased_matrix& data, std::vector<size_t>& di
   dims = new_dims;
 }
 
+void center_crop::fuse(fused_image_op& op, std::vector<size_t>& dims) const {
+  if (dims[1] <= m_h || dims[2] <= m_w) {
+    std::stringstream ss;
+    ss << "Center crop to " << m_h << "x" << m_w
+       << " applied to input " << dims[1] << "x" << dims[2];
+    LBANN_ERROR(ss.str());
+  }
+  op.crop(std::round(float(dims[2] - m_w) / 2.0),
+          std::round(float(dims[1] - m_h) / 2.0));
+  dims = {dims[0], m_h, m_w};
+}
+
 std::unique_ptr<transform>
 build_center_crop_transform_from_pbuf(google::protobuf::Message const& msg) {
   auto const& params = dynamic_cast<lbann_data::Transform::CenterCrop const&>(msg);
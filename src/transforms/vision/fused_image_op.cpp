@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/transforms/vision/fused_image_op.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lbann {
+namespace transform {
+
+namespace {
+
+/** Source coordinates and weights along one axis of the output. */
+struct axis_sample {
+  size_t i0;
+  size_t i1;
+  float w1;
+};
+
+void compute_axis_samples(float offset, float stride, size_t in_size,
+                          size_t out_size, std::vector<axis_sample>& samples) {
+  samples.resize(out_size);
+  const float max_coord = float(in_size - 1);
+  for (size_t i = 0; i < out_size; ++i) {
+    const float coord = std::min(std::max(offset + stride*i, 0.0f), max_coord);
+    const size_t i0 = static_cast<size_t>(coord);
+    samples[i].i0 = i0;
+    samples[i].i1 = std::min(i0 + 1, in_size - 1);
+    samples[i].w1 = coord - i0;
+  }
+}
+
+/** True if the op only moves whole pixels (crops and flips). */
+bool is_pixel_aligned(const fused_image_op& op) {
+  return std::abs(op.x_stride) == 1.0f && std::abs(op.y_stride) == 1.0f
+    && op.x_offset == std::floor(op.x_offset)
+    && op.y_offset == std::floor(op.y_offset);
+}
+
+}  // namespace
+
+void apply_fused_image_op(const fused_image_op& op, const uint8_t* image,
+                          size_t height, size_t width,
+                          size_t out_h, size_t out_w, DataType* out) {
+  const uint8_t* __restrict__ src = image;
+  DataType* __restrict__ dst = out;
+  const size_t size = out_h * out_w;
+  constexpr float scale = 1.0f / 255.0f;
+  float mul[3], add[3];
+  for (size_t c = 0; c < 3; ++c) {
+    mul[c] = scale / op.stds[c];
+    add[c] = -op.means[c] / op.stds[c];
+  }
+
+  // Rows of the output are walked contiguously within each column, as
+  // LBANN's layout stores them
+  std::vector<axis_sample> xs, ys;
+  compute_axis_samples(op.x_offset, op.x_stride, width, out_w, xs);
+  compute_axis_samples(op.y_offset, op.y_stride, height, out_h, ys);
+  if (is_pixel_aligned(op)) {
+    for (size_t col = 0; col < out_w; ++col) {
+      for (size_t row = 0; row < out_h; ++row) {
+        const uint8_t* p = src + 3*(ys[row].i0*width + xs[col].i0);
+        const size_t dst_base = row + col*out_h;
+        dst[dst_base] = p[0]*mul[0] + add[0];
+        dst[dst_base + size] = p[1]*mul[1] + add[1];
+        dst[dst_base + 2*size] = p[2]*mul[2] + add[2];
+      }
+    }
+    return;
+  }
+  for (size_t col = 0; col < out_w; ++col) {
+    const size_t x0 = 3*xs[col].i0;
+    const size_t x1 = 3*xs[col].i1;
+    const float wx = xs[col].w1;
+    for (size_t row = 0; row < out_h; ++row) {
+      const uint8_t* top = src + 3*ys[row].i0*width;
+      const uint8_t* bottom = src + 3*ys[row].i1*width;
+      const float wy = ys[row].w1;
+      const size_t dst_base = row + col*out_h;
+      for (size_t c = 0; c < 3; ++c) {
+        const float t = (1.0f - wx)*top[x0 + c] + wx*top[x1 + c];
+        const float b = (1.0f - wx)*bottom[x0 + c] + wx*bottom[x1 + c];
+        dst[dst_base + c*size] = ((1.0f - wy)*t + wy*b)*mul[c] + add[c];
+      }
+    }
+  }
+}
+
+}  // namespace transform
+}  // namespace lbann
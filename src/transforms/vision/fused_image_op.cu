@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/transforms/vision/fused_image_op.hpp"
+
+namespace lbann {
+namespace transform {
+
+namespace {
+
+/** Bilinearly sample channel c at (x, y), clamping to the border. */
+__device__ __forceinline__ float sample_bilinear(const uint8_t* __restrict__ image,
+                                                 int height, int width,
+                                                 float x, float y, int c) {
+  x = fminf(fmaxf(x, 0.0f), float(width - 1));
+  y = fminf(fmaxf(y, 0.0f), float(height - 1));
+  const int x0 = int(x);
+  const int y0 = int(y);
+  const int x1 = min(x0 + 1, width - 1);
+  const int y1 = min(y0 + 1, height - 1);
+  const float fx = x - x0;
+  const float fy = y - y0;
+  const float top = (1.0f - fx) * image[3*(y0*width + x0) + c]
+    + fx * image[3*(y0*width + x1) + c];
+  const float bottom = (1.0f - fx) * image[3*(y1*width + x0) + c]
+    + fx * image[3*(y1*width + x1) + c];
+  return (1.0f - fy) * top + fy * bottom;
+}
+
+/** Grid is (output pixels, samples); one thread per output pixel. */
+__global__ void fused_image_kernel(const fused_image_task* __restrict__ tasks,
+                                   int out_h, int out_w,
+                                   DataType* __restrict__ out, El::Int out_ldim) {
+  const int pixel = blockIdx.x * blockDim.x + threadIdx.x;
+  const int sample = blockIdx.y;
+  if (pixel >= out_h * out_w) { return; }
+  const fused_image_task& task = tasks[sample];
+  const fused_image_op& op = task.op;
+  // LBANN's layout: channels, then columns, then rows
+  const int row = pixel % out_h;
+  const int col = pixel / out_h;
+  const float x = op.x_offset + op.x_stride * col;
+  const float y = op.y_offset + op.y_stride * row;
+  DataType* __restrict__ dst = out + sample * out_ldim;
+  constexpr float scale = 1.0f / 255.0f;
+  for (int c = 0; c < 3; ++c) {
+    const float v = sample_bilinear(task.image, task.height, task.width, x, y, c);
+    dst[c * out_h * out_w + pixel] = (v * scale - op.means[c]) / op.stds[c];
+  }
+}
+
+}  // namespace
+
+void apply_fused_image_ops(const fused_image_task* tasks, size_t num_tasks,
+                           size_t out_h, size_t out_w,
+                           DataType* out, El::Int out_ldim,
+                           cudaStream_t stream) {
+  if (num_tasks == 0 || out_h == 0 || out_w == 0) { return; }
+  constexpr int block_size = 256;
+  dim3 grid((out_h * out_w + block_size - 1) / block_size, num_tasks);
+  fused_image_kernel<<<grid, block_size, 0, stream>>>(
+    tasks, out_h, out_w, out, out_ldim);
+  CHECK_CUDA(cudaGetLastError());
+}
+
+}  // namespace transform
+}  // namespace lbann
@@ -28,6 +28,7 @@
 #include "lbann/transforms/vision/grayscale.hpp"
 #include "lbann/utils/memory.hpp"
 #include "lbann/utils/opencv.hpp"
+#include "lbann/transforms/scratch_arena.hpp"
 
 namespace lbann {
 namespace transform {
@@ -38,7 +39,7 @@ void grayscale::apply(utils::type_erased_matrix& data, std::vector<size_t>& dims
     return;  // Only one channel: Already grayscale.
   }
   std::vector<size_t> new_dims = {1, dims[1], dims[2]};
-  auto dst_real = El::Matrix<uint8_t>(utils::get_linearized_size(new_dims), 1);
+  auto dst_real = make_scratch_matrix(utils::get_linearized_size(new_dims));
   cv::Mat dst = utils::get_opencv_mat(dst_real, new_dims);
   cv::cvtColor(src, dst, cv::COLOR_BGR2GRAY);
   data.emplace<uint8_t>(std::move(dst_real));
@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/transforms/vision/layout_kernels.hpp"
+#include "lbann/utils/exception.hpp"
+
+#include <algorithm>
+
+// Build the kernels for several x86 instruction sets and let the
+// loader pick one (GCC's function multi-versioning). Elsewhere the
+// baseline is used, which includes NEON on aarch64.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define LBANN_LAYOUT_CLONES \
+  __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define LBANN_LAYOUT_CLONES
+#endif
+
+namespace lbann {
+namespace transform {
+
+namespace {
+
+/** Tile edge; chosen by benchmarking 224x224-class images. */
+constexpr size_t tile_size = 16;
+
+template <size_t C>
+inline __attribute__((always_inline))
+void interleaved_to_lbann_layout_impl(const uint8_t* __restrict__ src,
+                                      size_t height, size_t width,
+                                      const float* scale, const float* bias,
+                                      DataType* __restrict__ dst) {
+  const size_t size = height * width;
+  float s[C], b[C];
+  for (size_t c = 0; c < C; ++c) {
+    s[c] = scale[c];
+    b[c] = bias[c];
+  }
+  // Convert a tile into tile[c][row][col] (vectorizing along the
+  // contiguous source row), then transpose it out of L1
+  DataType tile[C][tile_size][tile_size];
+  for (size_t row0 = 0; row0 < height; row0 += tile_size) {
+    const size_t rows = std::min(tile_size, height - row0);
+    for (size_t col0 = 0; col0 < width; col0 += tile_size) {
+      const size_t cols = std::min(tile_size, width - col0);
+      for (size_t r = 0; r < rows; ++r) {
+        const uint8_t* __restrict__ in = src + C*((row0 + r)*width + col0);
+        for (size_t j = 0; j < cols; ++j) {
+          for (size_t c = 0; c < C; ++c) {
+            tile[c][r][j] = in[C*j + c] * s[c] + b[c];
+          }
+        }
+      }
+      for (size_t c = 0; c < C; ++c) {
+        DataType* __restrict__ out = dst + c*size + col0*height + row0;
+        for (size_t j = 0; j < cols; ++j) {
+          for (size_t r = 0; r < rows; ++r) {
+            out[j*height + r] = tile[c][r][j];
+          }
+        }
+      }
+    }
+  }
+}
+
+template <size_t C>
+inline __attribute__((always_inline))
+void deinterleave_channels_impl(const DataType* __restrict__ src,
+                                size_t num_pixels,
+                                DataType* __restrict__ dst) {
+  for (size_t c = 0; c < C; ++c) {
+    DataType* __restrict__ out = dst + c*num_pixels;
+    for (size_t i = 0; i < num_pixels; ++i) {
+      out[i] = src[C*i + c];
+    }
+  }
+}
+
+}  // namespace
+
+LBANN_LAYOUT_CLONES
+void interleaved_to_lbann_layout(const uint8_t* src, size_t channels,
+                                 size_t height, size_t width,
+                                 const float* scale, const float* bias,
+                                 DataType* dst) {
+  switch (channels) {
+  case 1:
+    interleaved_to_lbann_layout_impl<1>(src, height, width, scale, bias, dst);
+    break;
+  case 2:
+    interleaved_to_lbann_layout_impl<2>(src, height, width, scale, bias, dst);
+    break;
+  case 3:
+    interleaved_to_lbann_layout_impl<3>(src, height, width, scale, bias, dst);
+    break;
+  case 4:
+    interleaved_to_lbann_layout_impl<4>(src, height, width, scale, bias, dst);
+    break;
+  default:
+    LBANN_ERROR("Unsupported number of channels");
+  }
+}
+
+LBANN_LAYOUT_CLONES
+void deinterleave_channels(const DataType* src, size_t channels,
+                           size_t num_pixels, DataType* dst) {
+  switch (channels) {
+  case 1:
+    deinterleave_channels_impl<1>(src, num_pixels, dst);
+    break;
+  case 2:
+    deinterleave_channels_impl<2>(src, num_pixels, dst);
+    break;
+  case 3:
+    deinterleave_channels_impl<3>(src, num_pixels, dst);
+    break;
+  case 4:
+    deinterleave_channels_impl<4>(src, num_pixels, dst);
+    break;
+  default:
+    LBANN_ERROR("Unsupported number of channels");
+  }
+}
+
+}  // namespace transform
+}  // namespace lbann
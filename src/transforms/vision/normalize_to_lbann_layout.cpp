@@ -28,6 +28,7 @@
 #include "lbann/proto/proto_common.hpp"
 #include "lbann/utils/memory.hpp"
 #include "lbann/utils/opencv.hpp"
+#include "lbann/transforms/vision/layout_kernels.hpp"
 
 #include <transforms.pb.h>
 
@@ -63,35 +64,30 @@ void normalize_to_lbann_layout::apply(utils::type_erased_matrix& data,
   if (static_cast<size_t>(out.Height() * out.Width()) != out_size) {
     LBANN_ERROR("Transform output does not have sufficient space.");
   }
-  DataType* __restrict__ dst_buf = out.Buffer();
-  const float scale = 1.0f / 255.0f;
-  if (dims[0] == 1) {
-    // Greyscale.
-    const DataType mean = m_means[0];
-    const DataType std = m_stds[0];
-    for (size_t row = 0; row < dims[1]; ++row) {
-      for (size_t col = 0; col < dims[2]; ++col) {
-        dst_buf[row + col*dims[1]] =
-          (src_buf[row*dims[2] + col] * scale - mean) / std;
-      }
-    }
-  } else {
-    // RGB/three-channel.
-    const size_t size = dims[1] * dims[2];
-    for (size_t row = 0; row < dims[1]; ++row) {
-      for (size_t col = 0; col < dims[2]; ++col) {
-        // Multiply by 3 because there are three channels.
-        const size_t src_base = 3*(row*dims[2] + col);
-        const size_t dst_base = row + col*dims[1];
-        dst_buf[dst_base] =
-          (src_buf[src_base] * scale - m_means[0]) / m_stds[0];
-        dst_buf[dst_base + size] =
-          (src_buf[src_base + 1] * scale - m_means[1]) / m_stds[1];
-        dst_buf[dst_base + 2*size] =
-          (src_buf[src_base + 2] * scale - m_means[2]) / m_stds[2];
-      }
-    }
+  const size_t channels = (dims.size() == 3) ? dims[0] : 1;
+  if (channels > 4) {
+    LBANN_ERROR("NormalizeToLBANNLayout does not support ", channels, " channels.");
   }
+  // (x/255 - mean) / std as a single multiply-add
+  float scale[4], bias[4];
+  for (size_t c = 0; c < channels; ++c) {
+    scale[c] = 1.0f / (255.0f * m_stds[c]);
+    bias[c] = -m_means[c] / m_stds[c];
+  }
+  interleaved_to_lbann_layout(src_buf, channels, dims[1], dims[2],
+                              scale, bias, out.Buffer());
+}
+
+void normalize_to_lbann_layout::fuse(fused_image_op& op,
+                                     std::vector<size_t>& dims) const {
+  if (dims[0] != 3 || m_means.size() != 3) {
+    LBANN_ERROR("Fused NormalizeToLBANNLayout only supports three-channel images");
+  }
+  for (size_t c = 0; c < 3; ++c) {
+    op.means[c] = m_means[c];
+    op.stds[c] = m_stds[c];
+  }
+  op.to_lbann_layout = true;
 }
 
 std::unique_ptr<transform>
@@ -27,6 +27,7 @@
 #include "lbann/transforms/vision/random_crop.hpp"
 #include "lbann/utils/memory.hpp"
 #include "lbann/utils/opencv.hpp"
+#include "lbann/transforms/scratch_arena.hpp"
 
 #include <transforms.pb.h>
 
@@ -42,7 +43,7 @@ void random_crop::apply(utils::type_erased_matrix& data, std::vector<size_t>& di
     LBANN_ERROR(ss.str());
   }
   std::vector<size_t> new_dims = {dims[0], m_h, m_w};
-  auto dst_real = El::Matrix<uint8_t>(utils::get_linearized_size(new_dims), 1);
+  auto dst_real = make_scratch_matrix(utils::get_linearized_size(new_dims));
   cv::Mat dst = utils::get_opencv_mat(dst_real, new_dims);
   // Select the upper-left corner of the crop.
   const size_t x = transform::get_uniform_random_int(0, dims[2] - m_w + 1);
@@ -63,6 +64,19 @@ void random_crop::apply(utils::type_erased_matrix& data, std::vector<size_t>& di
   dims = new_dims;
 }
 
+void random_crop::fuse(fused_image_op& op, std::vector<size_t>& dims) const {
+  if (dims[1] <= m_h || dims[2] <= m_w) {
+    std::stringstream ss;
+    ss << "Random crop to " << m_h << "x" << m_w
+       << " applied to input " << dims[1] << "x" << dims[2];
+    LBANN_ERROR(ss.str());
+  }
+  const size_t x = transform::get_uniform_random_int(0, dims[2] - m_w + 1);
+  const size_t y = transform::get_uniform_random_int(0, dims[1] - m_h + 1);
+  op.crop(x, y);
+  dims = {dims[0], m_h, m_w};
+}
+
 std::unique_ptr<transform>
 build_random_crop_transform_from_pbuf(google::protobuf::Message const& msg) {
   auto const& params =
@@ -27,6 +27,7 @@
 #include "lbann/transforms/vision/random_resized_crop.hpp"
 #include "lbann/utils/memory.hpp"
 #include "lbann/utils/opencv.hpp"
+#include "lbann/transforms/scratch_arena.hpp"
 
 #include <transforms.pb.h>
 
@@ -39,9 +40,44 @@ void random_resized_crop::apply(utils::type_erased_matrix& data,
                                 std::vector<size_t>& dims) {
   cv::Mat src = utils::get_opencv_mat(data, dims);
   std::vector<size_t> new_dims = {dims[0], m_h, m_w};
-  auto dst_real = El::Matrix<uint8_t>(utils::get_linearized_size(new_dims), 1);
+  auto dst_real = make_scratch_matrix(utils::get_linearized_size(new_dims));
   cv::Mat dst = utils::get_opencv_mat(dst_real, new_dims);
-  size_t x = 0, y = 0, h = 0, w = 0;
+  size_t x, y, h, w;
+  select_crop(dims, x, y, h, w);
+  // Sanity check.
+  if (x >= static_cast<size_t>(src.cols) ||
+      y >= static_cast<size_t>(src.rows) ||
+      (x + w) > static_cast<size_t>(src.cols) ||
+      (y + h) > static_cast<size_t>(src.rows)) {
+    std::stringstream ss;
+    ss << "Bad crop dimensions for " << src.rows << "x" << src.cols << ": "
+       << h << "x" << w << " at (" << x << "," << y << ")";
+    LBANN_ERROR(ss.str());
+  }
+  // This is just a view.
+  cv::Mat tmp = src(cv::Rect(x, y, w, h));
+  cv::resize(tmp, dst, dst.size(), 0, 0, cv::INTER_LINEAR);
+  // Sanity check.
+  if (dst.ptr() != dst_real.Buffer()) {
+    LBANN_ERROR("Did not resize into dst_real.");
+  }
+  data.emplace<uint8_t>(std::move(dst_real));
+  dims = new_dims;
+}
+
+void random_resized_crop::fuse(fused_image_op& op,
+                               std::vector<size_t>& dims) const {
+  size_t x, y, h, w;
+  select_crop(dims, x, y, h, w);
+  op.crop(x, y);
+  op.resize(h, w, m_h, m_w);
+  dims = {dims[0], m_h, m_w};
+}
+
+void random_resized_crop::select_crop(const std::vector<size_t>& dims,
+                                      size_t& x, size_t& y,
+                                      size_t& h, size_t& w) const {
+  x = 0; y = 0; h = 0; w = 0;
   const size_t area = dims[1]*dims[2];
   // There's a chance this can fail, so we only make ten attempts.
   for (int attempt = 0; attempt < 10; ++attempt) {
@@ -63,34 +99,13 @@ void random_resized_crop::apply(utils::type_erased_matrix& data,
     h = 0;
     w = 0;
   }
-  bool fallback = false;
   // Fallback.
   if (h == 0) {
-    fallback = true;
     w = std::min(dims[1], dims[2]);
     h = w;
     x = (dims[2] - w) / 2;
     y = (dims[1] - h) / 2;
   }
-  // Sanity check.
-  if (x >= static_cast<size_t>(src.cols) ||
-      y >= static_cast<size_t>(src.rows) ||
-      (x + w) > static_cast<size_t>(src.cols) ||
-      (y + h) > static_cast<size_t>(src.rows)) {
-    std::stringstream ss;
-    ss << "Bad crop dimensions for " << src.rows << "x" << src.cols << ": "
-       << h << "x" << w << " at (" << x << "," << y << ") fallback=" << fallback;
-    LBANN_ERROR(ss.str());
-  }
-  // This is just a view.
-  cv::Mat tmp = src(cv::Rect(x, y, w, h));
-  cv::resize(tmp, dst, dst.size(), 0, 0, cv::INTER_LINEAR);
-  // Sanity check.
-  if (dst.ptr() != dst_real.Buffer()) {
-    LBANN_ERROR("Did not resize into dst_real.");
-  }
-  data.emplace<uint8_t>(std::move(dst_real));
-  dims = new_dims;
 }
 
 std::unique_ptr<transform>
@@ -27,6 +27,7 @@
 #include "lbann/transforms/vision/resize.hpp"
 #include "lbann/utils/memory.hpp"
 #include "lbann/utils/opencv.hpp"
+#include "lbann/transforms/scratch_arena.hpp"
 
 #include <transforms.pb.h>
 
@@ -38,13 +39,18 @@ namespace transform {
 void resize::apply(utils::type_erased_matrix& data, std::vector<size_t>& dims) {
   cv::Mat src = utils::get_opencv_mat(data, dims);
   std::vector<size_t> new_dims = {dims[0], m_h, m_w};
-  auto dst_real = El::Matrix<uint8_t>(utils::get_linearized_size(new_dims), 1);
+  auto dst_real = make_scratch_matrix(utils::get_linearized_size(new_dims));
   cv::Mat dst = utils::get_opencv_mat(dst_real, new_dims);
   cv::resize(src, dst, dst.size(), 0, 0, cv::INTER_LINEAR);
   data.emplace<uint8_t>(std::move(dst_real));
   dims = new_dims;
 }
 
+void resize::fuse(fused_image_op& op, std::vector<size_t>& dims) const {
+  op.resize(dims[1], dims[2], m_h, m_w);
+  dims = {dims[0], m_h, m_w};
+}
+
 std::unique_ptr<transform>
 build_resize_transform_from_pbuf(google::protobuf::Message const& msg) {
   auto const& params = dynamic_cast<lbann_data::Transform::Resize const&>(msg);
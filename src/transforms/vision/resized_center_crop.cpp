@@ -27,6 +27,7 @@
 #include "lbann/transforms/vision/resized_center_crop.hpp"
 #include "lbann/utils/memory.hpp"
 #include "lbann/utils/opencv.hpp"
+#include "lbann/transforms/scratch_arena.hpp"
 
 #include <transforms.pb.h>
 
@@ -38,7 +39,7 @@ namespace transform {
 void resized_center_crop::apply(utils::type_erased_matrix& data, std::vector<size_t>& dims) {
   cv::Mat src = utils::get_opencv_mat(data, dims);
   std::vector<size_t> new_dims = {dims[0], m_crop_h, m_crop_w};
-  auto dst_real = El::Matrix<uint8_t>(utils::get_linearized_size(new_dims), 1);
+  auto dst_real = make_scratch_matrix(utils::get_linearized_size(new_dims));
   cv::Mat dst = utils::get_opencv_mat(dst_real, new_dims);
   // This computes the projected crop area in the original image, crops it,
   // then resizes it.
@@ -67,6 +68,18 @@ void resized_center_crop::apply(utils::type_erased_matrix& data, std::vector<siz
   dims = new_dims;
 }
 
+void resized_center_crop::fuse(fused_image_op& op,
+                               std::vector<size_t>& dims) const {
+  const float zoom = std::min(float(dims[1]) / float(m_h),
+                              float(dims[2]) / float(m_w));
+  const size_t zoom_h = m_crop_h*zoom;
+  const size_t zoom_w = m_crop_w*zoom;
+  op.crop(std::round(float(dims[2] - zoom_w) / 2.0f),
+          std::round(float(dims[1] - zoom_h) / 2.0f));
+  op.resize(zoom_h, zoom_w, m_crop_h, m_crop_w);
+  dims = {dims[0], m_crop_h, m_crop_w};
+}
+
 std::unique_ptr<transform>
 build_resized_center_crop_transform_from_pbuf(google::protobuf::Message const& msg) {
   auto const& params = dynamic_cast<lbann_data::Transform::ResizedCenterCrop const&>(msg);
@@ -27,6 +27,7 @@
 #include "lbann/transforms/vision/to_lbann_layout.hpp"
 #include "lbann/utils/memory.hpp"
 #include "lbann/utils/opencv.hpp"
+#include "lbann/transforms/vision/layout_kernels.hpp"
 
 namespace lbann {
 namespace transform {
@@ -52,29 +53,20 @@ void to_lbann_layout::apply(utils::type_erased_matrix& data, CPUMat& out,
   if (static_cast<size_t>(out.Height() * out.Width()) != out_size) {
     LBANN_ERROR("Transform output does not have sufficient space.");
   }
-  DataType* __restrict__ dst_buf = out.Buffer();
-  const float scale = 1.0f / 255.0f;
-  if (dims[0] == 1) {
-    // Greyscale.
-    for (size_t row = 0; row < dims[1]; ++row) {
-      for (size_t col = 0; col < dims[2]; ++col) {
-        dst_buf[row + col*dims[1]] = src_buf[row*dims[2] + col] * scale;
-      }
-    }
-  } else {
-    // RGB/three-channel.
-    const size_t size = dims[1] * dims[2];
-    for (size_t row = 0; row < dims[1]; ++row) {
-      for (size_t col = 0; col < dims[2]; ++col) {
-        // Multiply by 3 because there are three channels.
-        const size_t src_base = 3*(row*dims[2] + col);
-        const size_t dst_base = row + col*dims[1];
-        dst_buf[dst_base] = src_buf[src_base] * scale;
-        dst_buf[dst_base + size] = src_buf[src_base + 1] * scale;
-        dst_buf[dst_base + 2*size] = src_buf[src_base + 2] * scale;
-      }
-    }
+  if (dims[0] < 1 || dims[0] > 4) {
+    LBANN_ERROR("ToLBANNLayout does not support ", dims[0], " channels.");
   }
+  const float scale[4] = {1.0f / 255.0f, 1.0f / 255.0f, 1.0f / 255.0f, 1.0f / 255.0f};
+  const float bias[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  interleaved_to_lbann_layout(src_buf, dims[0], dims[1], dims[2],
+                              scale, bias, out.Buffer());
+}
+
+void to_lbann_layout::fuse(fused_image_op& op, std::vector<size_t>& dims) const {
+  if (dims[0] != 3) {
+    LBANN_ERROR("Fused ToLBANNLayout only supports three-channel images");
+  }
+  op.to_lbann_layout = true;
 }
 
 std::unique_ptr<transform>
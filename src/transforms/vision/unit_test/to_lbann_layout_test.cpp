@@ -79,4 +79,28 @@ TEST_CASE("Testing to LBANN layout", "[preproc]") {
       }
     }
   }
+
+  SECTION("matrix larger than a tile") {
+    // Sizes that are not multiples of the kernel's tile size
+    const size_t height = 37, width = 21;
+    El::Matrix<uint8_t>& img = mat.template get<uint8_t>();
+    img.Resize(3*height*width, 1);
+    for (El::Int i = 0; i < img.Height(); ++i) {
+      img(i, 0) = static_cast<uint8_t>((7*i) % 256);
+    }
+    const El::Matrix<uint8_t> orig = img;
+    std::vector<size_t> dims = {3, height, width};
+    auto tll = lbann::transform::to_lbann_layout();
+    REQUIRE_NOTHROW(tll.apply(mat, dims));
+    const lbann::DataType* buf = mat.template get<lbann::DataType>().LockedBuffer();
+    for (size_t channel = 0; channel < 3; ++channel) {
+      for (size_t col = 0; col < width; ++col) {
+        for (size_t row = 0; row < height; ++row) {
+          const lbann::DataType expected =
+            orig(3*(row*width + col) + channel, 0) * (1.0f / 255.0f);
+          REQUIRE(buf[height*width*channel + row + col*height] == expected);
+        }
+      }
+    }
+  }
 }
@@ -5,10 +5,15 @@
 #include <lbann/transforms/transform_pipeline.hpp>
 #include <lbann/transforms/vision/resized_center_crop.hpp>
 #include <lbann/transforms/vision/to_lbann_layout.hpp>
+#include <lbann/transforms/vision/center_crop.hpp>
+#include <lbann/transforms/vision/horizontal_flip.hpp>
+#include <lbann/transforms/vision/resize.hpp>
+#include <lbann/transforms/vision/normalize_to_lbann_layout.hpp>
 #include <lbann/transforms/scale.hpp>
 #include <lbann/transforms/normalize.hpp>
 #include <lbann/utils/memory.hpp>
 #include "helper.hpp"
+#include <cmath>
 
 TEST_CASE("Testing vision transform pipeline", "[preproc]") {
   lbann::transform::transform_pipeline p;
@@ -43,3 +48,83 @@ TEST_CASE("Testing vision transform pipeline", "[preproc]") {
     }
   }
 }
+
+TEST_CASE("Testing fused vision transform pipeline", "[preproc]") {
+  El::Matrix<uint8_t> image;
+  image.Resize(6*8*3, 1);
+  for (El::Int i = 0; i < image.Height(); ++i) {
+    image(i, 0) = static_cast<uint8_t>((37*i) % 256);
+  }
+  auto apply = [&image](lbann::transform::transform_pipeline& p, bool fuse,
+                        lbann::CPUMat& out) {
+    El::Matrix<uint8_t> data = image;
+    std::vector<size_t> dims = {3, 6, 8};
+    out.Resize(3*4*4, 1);
+    p.set_fuse(fuse);
+    p.apply(data, out, dims);
+    REQUIRE(dims == std::vector<size_t>({3, 4, 4}));
+  };
+
+  SECTION("crops and flips match exactly") {
+    lbann::transform::transform_pipeline p;
+    p.add_transform(lbann::make_unique<lbann::transform::center_crop>(4, 4));
+    p.add_transform(lbann::make_unique<lbann::transform::horizontal_flip>(1.0f));
+    p.add_transform(lbann::make_unique<lbann::transform::to_lbann_layout>());
+    REQUIRE(p.supports_fuse());
+    lbann::CPUMat fused, unfused;
+    apply(p, true, fused);
+    apply(p, false, unfused);
+    for (El::Int i = 0; i < fused.Height(); ++i) {
+      REQUIRE(fused(i, 0) == unfused(i, 0));
+    }
+  }
+  SECTION("resizes match up to rounding") {
+    lbann::transform::transform_pipeline p;
+    p.add_transform(lbann::make_unique<lbann::transform::resize>(4, 4));
+    p.add_transform(lbann::make_unique<lbann::transform::normalize_to_lbann_layout>(
+                      std::vector<float>({0.5f, 0.5f, 0.5f}),
+                      std::vector<float>({0.25f, 0.25f, 0.25f})));
+    REQUIRE(p.supports_fuse());
+    lbann::CPUMat fused, unfused;
+    apply(p, true, fused);
+    apply(p, false, unfused);
+    // OpenCV rounds the resized image to uint8
+    for (El::Int i = 0; i < fused.Height(); ++i) {
+      REQUIRE(std::abs(fused(i, 0) - unfused(i, 0)) <= 4.0f / 255.0f);
+    }
+  }
+}
+
+TEST_CASE("Testing batched vision transform pipeline", "[preproc]") {
+  lbann::transform::transform_pipeline p;
+  p.add_transform(lbann::make_unique<lbann::transform::to_lbann_layout>());
+  p.add_transform(lbann::make_unique<lbann::transform::scale>(2.0f));
+  p.add_transform(lbann::make_unique<lbann::transform::normalize>(
+                    std::vector<float>({0.5f, 0.25f, 0.125f}),
+                    std::vector<float>({2.0f, 3.0f, 4.0f})));
+  REQUIRE_FALSE(p.supports_batch());
+  p.set_expected_out_dims({3, 5, 4});
+  REQUIRE(p.supports_batch());
+
+  // Two samples, transformed per sample and as a batch
+  lbann::CPUMat per_sample(3*5*4, 2), batched(3*5*4, 2);
+  for (El::Int col = 0; col < 2; ++col) {
+    for (int deferred = 0; deferred < 2; ++deferred) {
+      El::Matrix<uint8_t> image(3*5*4, 1);
+      for (El::Int i = 0; i < image.Height(); ++i) {
+        image(i, 0) = static_cast<uint8_t>((11*i + 3*col) % 256);
+      }
+      std::vector<size_t> dims = {3, 5, 4};
+      lbann::CPUMat& X = deferred ? batched : per_sample;
+      auto X_v = X(El::IR(0, X.Height()), El::IR(col, col + 1));
+      lbann::transform::deferred_batch_scope defer(deferred);
+      p.apply(image, X_v, dims);
+    }
+  }
+  REQUIRE_NOTHROW(p.apply_batch(batched));
+  for (El::Int col = 0; col < 2; ++col) {
+    for (El::Int row = 0; row < per_sample.Height(); ++row) {
+      REQUIRE(batched(row, col) == per_sample(row, col));
+    }
+  }
+}
@@ -27,6 +27,7 @@
 #include "lbann/transforms/vision/vertical_flip.hpp"
 #include "lbann/utils/memory.hpp"
 #include "lbann/utils/opencv.hpp"
+#include "lbann/transforms/scratch_arena.hpp"
 
 #include <transforms.pb.h>
 
@@ -36,13 +37,19 @@ namespace transform {
 void vertical_flip::apply(utils::type_erased_matrix& data, std::vector<size_t>& dims) {
   if (transform::get_bool_random(m_p)) {
     cv::Mat src = utils::get_opencv_mat(data, dims);
-    auto dst_real = El::Matrix<uint8_t>(utils::get_linearized_size(dims), 1);
+    auto dst_real = make_scratch_matrix(utils::get_linearized_size(dims));
     cv::Mat dst = utils::get_opencv_mat(dst_real, dims);
     cv::flip(src, dst, 0);
     data.emplace<uint8_t>(std::move(dst_real));
   }
 }
 
+void vertical_flip::fuse(fused_image_op& op, std::vector<size_t>& dims) const {
+  if (transform::get_bool_random(m_p)) {
+    op.flip_vertical(dims[1]);
+  }
+}
+
 std::unique_ptr<transform>
 build_vertical_flip_transform_from_pbuf(google::protobuf::Message const& msg) {
   auto const& params = dynamic_cast<lbann_data::Transform::VerticalFlip const&>(msg);
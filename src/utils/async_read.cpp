@@ -0,0 +1,236 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/utils/async_read.hpp"
+#include "lbann/utils/exception.hpp"
+#include "lbann/utils/io_profile.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef LBANN_HAS_IO_URING
+#include <liburing.h>
+#endif // LBANN_HAS_IO_URING
+
+namespace lbann {
+namespace file {
+
+namespace {
+
+/** @brief Largest single read; longer files take several. */
+constexpr size_t max_read_size = size_t{1} << 30;
+
+/** @brief Closes a batch's files and clears its queue on scope exit,
+ *  also when a read throws.
+ */
+class batch_guard {
+public:
+  batch_guard(std::vector<std::string>& paths,
+              std::vector<El::Matrix<uint8_t>*>& bufs,
+              std::vector<int>& fds)
+    : m_paths(paths), m_bufs(bufs), m_fds(fds) {}
+  ~batch_guard() {
+    for (const int fd : m_fds) {
+      if (fd >= 0) { close(fd); }
+    }
+    m_fds.clear();
+    m_paths.clear();
+    m_bufs.clear();
+  }
+private:
+  std::vector<std::string>& m_paths;
+  std::vector<El::Matrix<uint8_t>*>& m_bufs;
+  std::vector<int>& m_fds;
+};
+
+/** @brief Read the rest of a file with blocking reads. */
+void pread_remaining(int fd, const std::string& path,
+                     El::Matrix<uint8_t>& buf, size_t& offset) {
+  const size_t size = buf.Height();
+  while (offset < size) {
+    const size_t count = std::min(size - offset, max_read_size);
+    const ssize_t n = pread(fd, buf.Buffer() + offset, count, offset);
+    if (n < 0) {
+      if (errno == EINTR) { continue; }
+      LBANN_ERROR("could not read file ", path, " (", std::strerror(errno), ")");
+    }
+    if (n == 0) {
+      LBANN_ERROR("unexpected end of file ", path,
+                  " after ", offset, " of ", size, " bytes");
+    }
+    offset += n;
+  }
+}
+
+#ifdef LBANN_HAS_IO_URING
+
+/** @brief Entries in each thread's submission queue. Batches with
+ *  more files keep this many reads in flight.
+ */
+constexpr unsigned ring_depth = 128;
+
+/** @brief A thread's io_uring instance. */
+class uring {
+public:
+  uring() { m_ok = (io_uring_queue_init(ring_depth, &m_ring, 0) == 0); }
+  ~uring() {
+    if (m_ok) { io_uring_queue_exit(&m_ring); }
+  }
+  uring(const uring&) = delete;
+  uring& operator=(const uring&) = delete;
+  /** @brief False if io_uring is unavailable, e.g. on kernels older
+   *  than 5.1 or where seccomp forbids it.
+   */
+  bool ok() const noexcept { return m_ok; }
+  io_uring* get() noexcept { return &m_ring; }
+private:
+  io_uring m_ring;
+  bool m_ok;
+};
+
+/** @brief The calling thread's ring, set up on first use. */
+uring& get_thread_ring() {
+  thread_local uring ring;
+  return ring;
+}
+
+/** @brief Read the files with every read submitted up front.
+ *
+ *  If a read fails, the reads still in flight are drained before
+ *  throwing, since the kernel writes into the caller's buffers.
+ */
+void uring_read(io_uring* ring,
+                const std::vector<std::string>& paths,
+                const std::vector<El::Matrix<uint8_t>*>& bufs,
+                const std::vector<int>& fds,
+                std::vector<size_t>& offsets) {
+  const size_t num_files = paths.size();
+  std::vector<size_t> retry;
+  std::string error_message;
+  size_t next = 0;
+  size_t in_flight = 0;
+  auto submit = [&](size_t i) -> bool {
+    io_uring_sqe* sqe = io_uring_get_sqe(ring);
+    if (sqe == nullptr) { return false; }
+    auto& buf = *bufs[i];
+    const size_t count = std::min(size_t(buf.Height()) - offsets[i],
+                                  max_read_size);
+    io_uring_prep_read(sqe, fds[i], buf.Buffer() + offsets[i],
+                       count, offsets[i]);
+    io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(i));
+    ++in_flight;
+    return true;
+  };
+  while (true) {
+    if (error_message.empty()) {
+      while (!retry.empty() && submit(retry.back())) { retry.pop_back(); }
+      for (; next < num_files; ++next) {
+        if (offsets[next] == size_t(bufs[next]->Height())) { continue; }
+        if (!submit(next)) { break; }
+      }
+    }
+    if (in_flight == 0) { break; }
+    const int status = io_uring_submit_and_wait(ring, 1);
+    if (status < 0 && status != -EINTR) {
+      LBANN_ERROR("io_uring submission failed (", std::strerror(-status), ")");
+    }
+    io_uring_cqe* cqe;
+    while (io_uring_peek_cqe(ring, &cqe) == 0) {
+      const auto i = reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe));
+      const int res = cqe->res;
+      io_uring_cqe_seen(ring, cqe);
+      --in_flight;
+      if (res == -EINTR || res == -EAGAIN) {
+        retry.push_back(i);
+      } else if (res < 0) {
+        error_message = "could not read file " + paths[i]
+          + " (" + std::strerror(-res) + ")";
+      } else if (res == 0) {
+        error_message = "unexpected end of file " + paths[i];
+      } else {
+        offsets[i] += res;
+        if (offsets[i] < size_t(bufs[i]->Height())) { retry.push_back(i); }
+      }
+    }
+  }
+  if (!error_message.empty()) { LBANN_ERROR(error_message); }
+}
+
+#endif // LBANN_HAS_IO_URING
+
+} // namespace <anon>
+
+void batch_file_reader::add(std::string path, El::Matrix<uint8_t>& buf) {
+  m_paths.emplace_back(std::move(path));
+  m_bufs.push_back(&buf);
+}
+
+void batch_file_reader::read() {
+  io_profile::scope profile(io_profile::stage::read);
+  const size_t num_files = m_paths.size();
+  m_fds.assign(num_files, -1);
+  m_offsets.assign(num_files, 0);
+  batch_guard guard(m_paths, m_bufs, m_fds);
+
+  // Open everything first so the buffers can be sized
+  for (size_t i = 0; i < num_files; ++i) {
+    m_fds[i] = open(m_paths[i].c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_fds[i] < 0) {
+      LBANN_ERROR("could not open file ", m_paths[i],
+                  " (", std::strerror(errno), ")");
+    }
+    struct stat st;
+    if (fstat(m_fds[i], &st) != 0) {
+      LBANN_ERROR("could not stat file ", m_paths[i],
+                  " (", std::strerror(errno), ")");
+    }
+    m_bufs[i]->Resize(st.st_size, 1);
+  }
+
+#ifdef LBANN_HAS_IO_URING
+  auto& ring = get_thread_ring();
+  if (ring.ok()) {
+    uring_read(ring.get(), m_paths, m_bufs, m_fds, m_offsets);
+    return;
+  }
+#endif // LBANN_HAS_IO_URING
+
+  // Start readahead of every file before blocking on the first
+  for (size_t i = 0; i < num_files; ++i) {
+    posix_fadvise(m_fds[i], 0, 0, POSIX_FADV_WILLNEED);
+  }
+  for (size_t i = 0; i < num_files; ++i) {
+    pread_remaining(m_fds[i], m_paths[i], *m_bufs[i], m_offsets[i]);
+  }
+}
+
+} // namespace file
+} // namespace lbann
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/utils/batched_gemm.hpp"
+
+namespace lbann {
+
+namespace {
+
+/** Products with at most this many multiply-adds are computed
+ *  without calling BLAS. */
+constexpr El::Int small_gemm_size = 32 * 32 * 32;
+
+/** Dense matrix product for small column-major matrices. */
+template <typename TensorDataType>
+void small_gemm(bool transa, bool transb,
+                El::Int m, El::Int n, El::Int k,
+                TensorDataType alpha,
+                const TensorDataType* __restrict__ A, El::Int lda,
+                const TensorDataType* __restrict__ B, El::Int ldb,
+                TensorDataType beta,
+                TensorDataType* __restrict__ C, El::Int ldc) {
+  const TensorDataType zero = El::TypeTraits<TensorDataType>::Zero();
+  for (El::Int j = 0; j < n; ++j) {
+    auto* __restrict__ c = &C[j*ldc];
+    if (beta == zero) {
+      std::fill(c, c+m, zero);
+    } else {
+      for (El::Int i = 0; i < m; ++i) { c[i] *= beta; }
+    }
+    for (El::Int p = 0; p < k; ++p) {
+      const auto& b = alpha * (transb ? B[j+p*ldb] : B[p+j*ldb]);
+      if (transa) {
+        for (El::Int i = 0; i < m; ++i) { c[i] += A[p+i*lda] * b; }
+      } else {
+        const auto* __restrict__ a = &A[p*lda];
+        for (El::Int i = 0; i < m; ++i) { c[i] += a[i] * b; }
+      }
+    }
+  }
+}
+
+} // namespace <anon>
+
+template <typename TensorDataType>
+void gemm_strided_batched(El::Orientation transa, El::Orientation transb,
+                          El::Int m, El::Int n, El::Int k,
+                          TensorDataType alpha,
+                          const TensorDataType* A, El::Int lda,
+                          El::Int strideA,
+                          const TensorDataType* B, El::Int ldb,
+                          El::Int strideB,
+                          TensorDataType beta,
+                          TensorDataType* C, El::Int ldc,
+                          El::Int strideC,
+                          El::Int batch_count) {
+  if (m < 1 || n < 1 || batch_count < 1) { return; }
+  const bool transa_ = (transa != El::NORMAL);
+  const bool transb_ = (transb != El::NORMAL);
+  if (m * n * k <= small_gemm_size) {
+    LBANN_OMP_PARALLEL_FOR
+    for (El::Int i = 0; i < batch_count; ++i) {
+      small_gemm(transa_, transb_, m, n, k,
+                 alpha, A + i*strideA, lda, B + i*strideB, ldb,
+                 beta, C + i*strideC, ldc);
+    }
+  }
+  else {
+    using LocalMat = El::Matrix<TensorDataType, El::Device::CPU>;
+    LBANN_OMP_PARALLEL_FOR
+    for (El::Int i = 0; i < batch_count; ++i) {
+      LocalMat A_v, B_v, C_v;
+      A_v.LockedAttach(transa_ ? k : m, transa_ ? m : k,
+                       A + i*strideA, lda);
+      B_v.LockedAttach(transb_ ? n : k, transb_ ? k : n,
+                       B + i*strideB, ldb);
+      C_v.Attach(m, n, C + i*strideC, ldc);
+      El::Gemm(transa, transb, alpha, A_v, B_v, beta, C_v);
+    }
+  }
+}
+
+#define PROTO(T)                                                \
+  template void gemm_strided_batched<T>(                        \
+    El::Orientation, El::Orientation,                           \
+    El::Int, El::Int, El::Int,                                  \
+    T, const T*, El::Int, El::Int,                              \
+    const T*, El::Int, El::Int,                                 \
+    T, T*, El::Int, El::Int, El::Int)
+
+#define LBANN_INSTANTIATE_CPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/utils/broadcast.hpp"
+#include "lbann/utils/exception.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+namespace lbann {
+
+constexpr int broadcast_map::max_dims;
+
+namespace {
+
+/** Pad dimensions with leading ones. */
+std::vector<int> pad_dims(const std::vector<int>& dims, size_t num_dims) {
+  std::vector<int> padded(num_dims - dims.size(), 1);
+  padded.insert(padded.end(), dims.begin(), dims.end());
+  return padded;
+}
+
+} // namespace <anon>
+
+bool is_broadcastable(const std::vector<int>& input_dims,
+                      const std::vector<int>& output_dims) {
+  if (input_dims.size() > output_dims.size()) { return false; }
+  const auto& padded = pad_dims(input_dims, output_dims.size());
+  for (size_t d = 0; d < padded.size(); ++d) {
+    if (padded[d] < 1 || padded[d] > output_dims[d]) { return false; }
+  }
+  return true;
+}
+
+std::vector<int> get_broadcast_dims(const std::vector<int>& dims1,
+                                    const std::vector<int>& dims2) {
+  if (dims1.empty() || dims2.empty()) {
+    LBANN_ERROR("attempted to broadcast an empty tensor");
+  }
+  const size_t num_dims = std::max(dims1.size(), dims2.size());
+  const auto& padded1 = pad_dims(dims1, num_dims);
+  const auto& padded2 = pad_dims(dims2, num_dims);
+  std::vector<int> dims(num_dims);
+  for (size_t d = 0; d < num_dims; ++d) {
+    dims[d] = std::max(padded1[d], padded2[d]);
+  }
+  return dims;
+}
+
+broadcast_map make_broadcast_map(const std::vector<int>& input_dims,
+                                 const std::vector<int>& output_dims) {
+  broadcast_map map;
+  if (input_dims == output_dims) { return map; }
+  if (!is_broadcastable(input_dims, output_dims)) {
+    std::stringstream err;
+    err << "attempted to broadcast a ";
+    for (size_t d = 0; d < input_dims.size(); ++d) {
+      err << (d > 0 ? "x" : "") << input_dims[d];
+    }
+    err << " tensor to a ";
+    for (size_t d = 0; d < output_dims.size(); ++d) {
+      err << (d > 0 ? "x" : "") << output_dims[d];
+    }
+    err << " tensor";
+    LBANN_ERROR(err.str());
+  }
+
+  // Merge neighboring dimensions that are not broadcast, innermost
+  // first
+  const auto& padded = pad_dims(input_dims, output_dims.size());
+  if (padded == output_dims) { return map; }
+  std::vector<El::Int> merged_in, merged_out;
+  bool last_is_full = false;
+  for (size_t i = padded.size(); i-- > 0;) {
+    const bool is_full = (padded[i] == output_dims[i]);
+    if (is_full && last_is_full) {
+      merged_in.back() *= padded[i];
+      merged_out.back() *= output_dims[i];
+    } else {
+      merged_in.push_back(padded[i]);
+      merged_out.push_back(output_dims[i]);
+    }
+    last_is_full = is_full;
+  }
+  if (merged_in.size() > static_cast<size_t>(broadcast_map::max_dims)) {
+    LBANN_ERROR("attempted to broadcast with ",merged_in.size()," ",
+                "dimensions after merging, but at most ",
+                broadcast_map::max_dims," are supported");
+  }
+
+  // Dimensions and packed strides, outermost first
+  map.num_dims = merged_in.size();
+  El::Int stride = 1;
+  for (int d = 0; d < map.num_dims; ++d) {
+    const int i = map.num_dims - 1 - d;
+    map.input_dims[i] = merged_in[d];
+    map.output_dims[i] = merged_out[d];
+    map.input_strides[i] = stride;
+    stride *= merged_in[d];
+  }
+  return map;
+
+}
+
+} // namespace lbann
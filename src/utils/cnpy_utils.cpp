@@ -25,6 +25,9 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lbann/utils/cnpy_utils.hpp"
+#include "lbann/utils/mapped_file.hpp"
+#include <cstdint>
+#include <cstring>
 
 namespace lbann {
 namespace cnpy_utils {
@@ -83,5 +86,167 @@ std::string show_shape(const cnpy::NpyArray& na) {
   return ret;
 }
 
+namespace {
+
+template<typename T>
+T read_le(const char* p) {
+  T v;
+  std::memcpy(&v, p, sizeof(T));
+  return v;
+}
+
+/**
+ * Parse the header of the .npy data at buf, filling in the metadata of
+ * view. Return the number of header bytes, i.e., the offset of the data.
+ */
+size_t parse_npy_header(const char* buf, size_t size, npy_view& view) {
+  if (size < 10u || std::memcmp(buf, "\x93NUMPY", 6) != 0) {
+    LBANN_ERROR("not a numpy array file");
+  }
+  const int major = static_cast<unsigned char>(buf[6]);
+  const size_t start = (major == 1) ? 10u : 12u;
+  const size_t len = (major == 1) ? read_le<uint16_t>(buf + 8)
+                                  : read_le<uint32_t>(buf + 8);
+  if (start + len > size) {
+    LBANN_ERROR("truncated numpy array header");
+  }
+  const std::string header(buf + start, len);
+
+  const size_t descr = header.find("'descr'");
+  const size_t type_start = header.find('\'', header.find(':', descr)) + 1;
+  if (descr == std::string::npos || type_start == 0u) {
+    LBANN_ERROR("numpy array header has no descr: ", header);
+  }
+  if (header[type_start] == '>') {
+    LBANN_ERROR("big-endian numpy arrays are not supported");
+  }
+  view.word_size = std::stoul(header.substr(type_start + 2));
+
+  const size_t fortran = header.find("'fortran_order'");
+  view.fortran_order = (fortran != std::string::npos)
+    && (header.compare(header.find(':', fortran) + 2, 4, "True") == 0);
+
+  const size_t shape_start = header.find('(', header.find("'shape'"));
+  const size_t shape_end = header.find(')', shape_start);
+  if (shape_start == std::string::npos || shape_end == std::string::npos) {
+    LBANN_ERROR("numpy array header has no shape: ", header);
+  }
+  view.shape.clear();
+  const std::string shape = header.substr(shape_start + 1, shape_end - shape_start - 1);
+  for (size_t pos = 0u; pos < shape.size(); ) {
+    const size_t next = std::min(shape.find(',', pos), shape.size());
+    if (shape.find_first_of("0123456789", pos) < next) {
+      view.shape.push_back(std::stoul(shape.substr(pos, next - pos)));
+    }
+    pos = next + 1u;
+  }
+  return start + len;
+}
+
+/// View the .npy data at offset in file.
+npy_view map_npy_at(const std::shared_ptr<mapped_file>& file, size_t offset) {
+  npy_view view;
+  const size_t header_size =
+    parse_npy_header(file->data() + offset, file->size() - offset, view);
+  size_t num_bytes = view.word_size;
+  for (const size_t s : view.shape) {
+    num_bytes *= s;
+  }
+  if (offset + header_size + num_bytes > file->size()) {
+    LBANN_ERROR("numpy array data is truncated");
+  }
+  view.m_data = file->data() + offset + header_size;
+  view.m_owner = file;
+  return view;
+}
+
+} // end of anonymous namespace
+
+npy_view make_npy_view(const cnpy::NpyArray& na) {
+  npy_view view;
+  view.shape = na.shape;
+  view.word_size = na.word_size;
+  view.fortran_order = na.fortran_order;
+  view.m_data = na.data_holder->data();
+  view.m_owner = na.data_holder;
+  return view;
+}
+
+npy_view mmap_npy(const std::string& filename) {
+  return map_npy_at(std::make_shared<mapped_file>(filename), 0u);
+}
+
+std::map<std::string, npy_view> mmap_npz(const std::string& filename) {
+  auto file = std::make_shared<mapped_file>(filename);
+  const char* buf = file->data();
+  const size_t size = file->size();
+
+  // Find the end of central directory record, before any comment
+  const size_t eocd_size = 22u;
+  if (size < eocd_size) {
+    LBANN_ERROR(filename, " is not a zip archive");
+  }
+  size_t eocd = size - eocd_size;
+  while (read_le<uint32_t>(buf + eocd) != 0x06054b50u) {
+    if (eocd == 0u || size - eocd > eocd_size + 0xffffu) {
+      LBANN_ERROR(filename, " is not a zip archive");
+    }
+    --eocd;
+  }
+  uint64_t num_entries = read_le<uint16_t>(buf + eocd + 10);
+  uint64_t cd_offset = read_le<uint32_t>(buf + eocd + 16);
+  // Large archives keep the real values in the zip64 records
+  if (eocd >= 20u && read_le<uint32_t>(buf + eocd - 20) == 0x07064b50u) {
+    const uint64_t eocd64 = read_le<uint64_t>(buf + eocd - 20 + 8);
+    num_entries = read_le<uint64_t>(buf + eocd64 + 32);
+    cd_offset = read_le<uint64_t>(buf + eocd64 + 48);
+  }
+
+  std::map<std::string, npy_view> arrays;
+  size_t entry = cd_offset;
+  for (uint64_t i = 0u; i < num_entries; ++i) {
+    if (entry + 46u > size || read_le<uint32_t>(buf + entry) != 0x02014b50u) {
+      LBANN_ERROR("corrupt central directory in ", filename);
+    }
+    const uint16_t method = read_le<uint16_t>(buf + entry + 10);
+    uint64_t compressed_size = read_le<uint32_t>(buf + entry + 20);
+    uint64_t uncompressed_size = read_le<uint32_t>(buf + entry + 24);
+    const uint16_t name_len = read_le<uint16_t>(buf + entry + 28);
+    const uint16_t extra_len = read_le<uint16_t>(buf + entry + 30);
+    const uint16_t comment_len = read_le<uint16_t>(buf + entry + 32);
+    uint64_t local_offset = read_le<uint32_t>(buf + entry + 42);
+    std::string name(buf + entry + 46, name_len);
+
+    // The zip64 extra field holds, in order, whichever of the sizes
+    // and offset overflowed
+    for (size_t extra = entry + 46 + name_len;
+         extra + 4u <= entry + 46 + name_len + extra_len; ) {
+      const uint16_t id = read_le<uint16_t>(buf + extra);
+      const uint16_t len = read_le<uint16_t>(buf + extra + 2);
+      if (id == 0x0001u) {
+        const char* p = buf + extra + 4;
+        if (uncompressed_size == 0xffffffffu) { uncompressed_size = read_le<uint64_t>(p); p += 8; }
+        if (compressed_size == 0xffffffffu) { compressed_size = read_le<uint64_t>(p); p += 8; }
+        if (local_offset == 0xffffffffu) { local_offset = read_le<uint64_t>(p); }
+      }
+      extra += 4u + len;
+    }
+    if (method != 0u || compressed_size != uncompressed_size) {
+      LBANN_ERROR("cannot mmap ", name, " in ", filename,
+                  ": it is compressed (save with numpy.savez, not savez_compressed)");
+    }
+
+    const size_t local_name_len = read_le<uint16_t>(buf + local_offset + 26);
+    const size_t local_extra_len = read_le<uint16_t>(buf + local_offset + 28);
+    const size_t data_offset = local_offset + 30 + local_name_len + local_extra_len;
+    if (name.size() > 4u && name.compare(name.size() - 4, 4, ".npy") == 0) {
+      name.resize(name.size() - 4);
+    }
+    arrays[name] = map_npy_at(file, data_offset);
+    entry += 46u + name_len + extra_len + comment_len;
+  }
+  return arrays;
+}
+
 } // end of namespace cnpy_utils
 } // end of namespace lbann
@@ -0,0 +1,269 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/utils/comm_profile.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+namespace lbann {
+namespace comm_profile {
+
+namespace details {
+std::atomic<bool> enabled{false};
+} // namespace details
+
+namespace {
+
+/** Seconds on a monotonic clock. */
+double now() {
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+thread_local const std::string* current_context = nullptr;
+
+/** Record of one operation. */
+struct record {
+  collective op;
+  size_t bytes;
+  int comm_size;
+  const char* algorithm;
+  /** Name of the triggering layer or weights, if any. */
+  std::string context;
+  double start = 0;
+  double launch_end = 0;
+  double wait_start = -1;
+  double finish = 0;
+};
+
+struct profile_state {
+  std::mutex mutex;
+  uint64_t next_id = 1;
+  std::unordered_map<uint64_t, record> in_flight;
+  std::vector<record> completed;
+  double last_report = 0;
+};
+
+profile_state& state() {
+  static profile_state s;
+  return s;
+}
+
+/** Index of the highest set bit, so sizes in [2^k, 2^(k+1)) share a
+ *  class. */
+int size_class(size_t bytes) {
+  int k = 0;
+  while (bytes > 1) { bytes >>= 1; ++k; }
+  return k;
+}
+
+} // namespace
+
+std::string to_string(collective op) {
+  switch (op) {
+  case collective::allreduce:    return "allreduce";
+  case collective::nb_allreduce: return "nb_allreduce";
+  case collective::broadcast:    return "broadcast";
+  case collective::sendrecv:     return "sendrecv";
+  }
+  return "unknown";
+}
+
+void enable() {
+  auto& s = state();
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.in_flight.clear();
+    s.completed.clear();
+    s.last_report = now();
+  }
+  details::enabled.store(true, std::memory_order_relaxed);
+}
+
+void disable() {
+  details::enabled.store(false, std::memory_order_relaxed);
+  auto& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  s.in_flight.clear();
+  s.completed.clear();
+}
+
+context::context(const std::string& name)
+  : m_active(enabled()), m_prev(current_context) {
+  if (m_active) {
+    m_name = name;
+    current_context = &m_name;
+  }
+}
+
+context::~context() {
+  if (m_active) { current_context = m_prev; }
+}
+
+blocking_op::blocking_op(collective op, size_t bytes, int comm_size,
+                         const char* algorithm) noexcept
+  : m_op(op), m_bytes(bytes), m_comm_size(comm_size),
+    m_algorithm(algorithm), m_context(current_context),
+    m_start(enabled() ? now() : -1) {}
+
+blocking_op::~blocking_op() {
+  if (m_start < 0 || !enabled()) { return; }
+  record r;
+  r.op = m_op;
+  r.bytes = m_bytes;
+  r.comm_size = m_comm_size;
+  r.algorithm = m_algorithm;
+  if (m_context != nullptr) { r.context = *m_context; }
+  r.start = m_start;
+  r.finish = now();
+  r.launch_end = r.finish;
+  r.wait_start = r.finish;
+  auto& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  s.completed.emplace_back(std::move(r));
+}
+
+uint64_t launch_begin(collective op, size_t bytes, int comm_size,
+                      const char* algorithm) {
+  if (!enabled()) { return 0; }
+  record r;
+  r.op = op;
+  r.bytes = bytes;
+  r.comm_size = comm_size;
+  r.algorithm = algorithm;
+  if (current_context != nullptr) { r.context = *current_context; }
+  r.start = now();
+  auto& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  const auto id = s.next_id++;
+  s.in_flight.emplace(id, std::move(r));
+  return id;
+}
+
+void launch_end(uint64_t id) {
+  if (id == 0) { return; }
+  const auto t = now();
+  auto& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  auto it = s.in_flight.find(id);
+  if (it != s.in_flight.end()) { it->second.launch_end = t; }
+}
+
+void wait_begin(uint64_t id) {
+  if (id == 0) { return; }
+  const auto t = now();
+  auto& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  auto it = s.in_flight.find(id);
+  if (it != s.in_flight.end() && it->second.wait_start < 0) {
+    it->second.wait_start = t;
+  }
+}
+
+void complete(uint64_t id) {
+  if (id == 0) { return; }
+  const auto t = now();
+  auto& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  auto it = s.in_flight.find(id);
+  if (it == s.in_flight.end()) { return; }
+  auto& r = it->second;
+  r.finish = t;
+  if (r.wait_start < 0) { r.wait_start = t; }
+  s.completed.emplace_back(std::move(r));
+  s.in_flight.erase(it);
+}
+
+report collect() {
+  std::vector<record> records;
+  double last_report;
+  const auto t = now();
+  {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    records.swap(s.completed);
+    last_report = s.last_report;
+    s.last_report = t;
+  }
+
+  report rep;
+  rep.wall_time = t - last_report;
+  std::map<std::tuple<collective,std::string,int>, size_class_stats> classes;
+  std::unordered_map<std::string, context_stats> contexts;
+  for (const auto& r : records) {
+    const double time = r.finish - r.start;
+    const double exposed = (r.launch_end - r.start) + (r.finish - r.wait_start);
+    rep.comm_time += time;
+    rep.exposed_time += exposed;
+
+    const auto k = size_class(r.bytes);
+    auto& sc = classes[std::make_tuple(r.op, std::string(r.algorithm), k)];
+    sc.op = r.op;
+    sc.algorithm = r.algorithm;
+    sc.min_bytes = size_t(1) << k;
+    ++sc.count;
+    sc.bytes += r.bytes;
+    sc.time += time;
+    double bus_bytes = r.bytes;
+    if ((r.op == collective::allreduce || r.op == collective::nb_allreduce)
+        && r.comm_size > 0) {
+      bus_bytes *= 2.0 * (r.comm_size - 1) / r.comm_size;
+    }
+    // Accumulate bus bytes here; divided by time below
+    sc.bus_bandwidth += bus_bytes;
+
+    const std::string name = r.context.empty() ? "(none)" : r.context;
+    auto& cs = contexts[name];
+    cs.name = name;
+    ++cs.count;
+    cs.bytes += r.bytes;
+    cs.time += time;
+    cs.exposed_time += exposed;
+  }
+  for (auto& kv : classes) {
+    auto& sc = kv.second;
+    sc.bus_bandwidth = sc.time > 0 ? sc.bus_bandwidth / sc.time : 0;
+    rep.size_classes.push_back(sc);
+  }
+  for (auto& kv : contexts) {
+    rep.contexts.push_back(std::move(kv.second));
+  }
+  std::sort(rep.contexts.begin(), rep.contexts.end(),
+            [](const context_stats& a, const context_stats& b) {
+              return a.exposed_time > b.exposed_time;
+            });
+  return rep;
+}
+
+} // namespace comm_profile
+} // namespace lbann
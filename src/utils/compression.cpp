@@ -0,0 +1,197 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/utils/compression.hpp"
+#include "lbann/utils/exception.hpp"
+#include "lbann/utils/omp_pragma.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#ifdef LBANN_HAS_ZLIB
+#include <zlib.h>
+#endif // LBANN_HAS_ZLIB
+
+namespace lbann {
+namespace utils {
+
+#ifdef LBANN_HAS_ZLIB
+
+bool have_compression() { return true; }
+
+void compress_bytes(const void* src, std::size_t src_size,
+                    std::vector<unsigned char>& dst) {
+  uLongf dst_size = compressBound(src_size);
+  dst.resize(dst_size);
+  const int status = compress2(dst.data(), &dst_size,
+                               static_cast<const Bytef*>(src), src_size,
+                               Z_BEST_SPEED);
+  if (status != Z_OK) {
+    LBANN_ERROR("zlib compress2 failed with status ", status);
+  }
+  dst.resize(dst_size);
+}
+
+void decompress_bytes(const void* src, std::size_t src_size,
+                      void* dst, std::size_t dst_size) {
+  uLongf size = dst_size;
+  const int status = uncompress(static_cast<Bytef*>(dst), &size,
+                                static_cast<const Bytef*>(src), src_size);
+  if (status != Z_OK) {
+    LBANN_ERROR("zlib uncompress failed with status ", status);
+  }
+  if (size != dst_size) {
+    LBANN_ERROR("decompressed ", size, " bytes, but expected ", dst_size);
+  }
+}
+
+void compress_blocks(const void* src, std::size_t src_size,
+                     std::vector<unsigned char>& dst,
+                     std::size_t block_size) {
+  if (block_size == 0) {
+    LBANN_ERROR("compression block size must be positive");
+  }
+  const std::uint64_t num_blocks = (src_size + block_size - 1) / block_size;
+  const std::size_t header_size = (2 + num_blocks) * sizeof(std::uint64_t);
+  const uLong max_block_size = compressBound(block_size);
+
+  // Compress each block into its own slot
+  const auto* src_bytes = static_cast<const Bytef*>(src);
+  std::vector<unsigned char> slots(num_blocks * max_block_size);
+  std::vector<std::uint64_t> sizes(num_blocks);
+  std::vector<int> status(num_blocks, Z_OK);
+  LBANN_OMP_PARALLEL_FOR_ARGS(schedule(dynamic))
+  for (std::uint64_t b = 0; b < num_blocks; ++b) {
+    const std::size_t offset = b * block_size;
+    const std::size_t size = std::min(block_size, src_size - offset);
+    uLongf slot_size = max_block_size;
+    status[b] = compress2(&slots[b * max_block_size], &slot_size,
+                          src_bytes + offset, size, Z_BEST_SPEED);
+    sizes[b] = slot_size;
+  }
+  for (const auto& s : status) {
+    if (s != Z_OK) {
+      LBANN_ERROR("zlib compress2 failed with status ", s);
+    }
+  }
+
+  // Header followed by the compressed blocks
+  std::size_t total_size = header_size;
+  for (const auto& size : sizes) { total_size += size; }
+  dst.resize(total_size);
+  const std::uint64_t block_info[2] = {block_size, num_blocks};
+  std::memcpy(dst.data(), block_info, sizeof(block_info));
+  std::memcpy(dst.data() + sizeof(block_info), sizes.data(),
+              num_blocks * sizeof(std::uint64_t));
+  std::size_t offset = header_size;
+  for (std::uint64_t b = 0; b < num_blocks; ++b) {
+    std::memcpy(dst.data() + offset, &slots[b * max_block_size], sizes[b]);
+    offset += sizes[b];
+  }
+}
+
+void decompress_blocks(const void* src, std::size_t src_size,
+                       void* dst, std::size_t dst_size) {
+  const auto* src_bytes = static_cast<const unsigned char*>(src);
+  std::uint64_t block_info[2];
+  if (src_size < sizeof(block_info)) {
+    LBANN_ERROR("compressed buffer is too small (", src_size, " bytes)");
+  }
+  std::memcpy(block_info, src_bytes, sizeof(block_info));
+  const std::uint64_t block_size = block_info[0];
+  const std::uint64_t num_blocks = block_info[1];
+  const std::size_t header_size = (2 + num_blocks) * sizeof(std::uint64_t);
+  if (block_size == 0
+      || src_size < header_size
+      || num_blocks != (dst_size + block_size - 1) / block_size) {
+    LBANN_ERROR("compressed buffer does not hold ", dst_size, " bytes");
+  }
+
+  // Find each block
+  std::vector<std::uint64_t> sizes(num_blocks);
+  std::memcpy(sizes.data(), src_bytes + sizeof(block_info),
+              num_blocks * sizeof(std::uint64_t));
+  std::vector<std::size_t> offsets(num_blocks + 1, header_size);
+  for (std::uint64_t b = 0; b < num_blocks; ++b) {
+    offsets[b+1] = offsets[b] + sizes[b];
+  }
+  if (offsets.back() != src_size) {
+    LBANN_ERROR("compressed buffer has ", src_size, " bytes, "
+                "but its blocks have ", offsets.back(), " bytes");
+  }
+
+  // Decompress blocks in parallel
+  auto* dst_bytes = static_cast<Bytef*>(dst);
+  std::vector<int> status(num_blocks, Z_OK);
+  LBANN_OMP_PARALLEL_FOR_ARGS(schedule(dynamic))
+  for (std::uint64_t b = 0; b < num_blocks; ++b) {
+    const std::size_t offset = b * block_size;
+    const std::size_t size = std::min<std::size_t>(block_size, dst_size - offset);
+    uLongf out_size = size;
+    status[b] = uncompress(dst_bytes + offset, &out_size,
+                           src_bytes + offsets[b], sizes[b]);
+    if (status[b] == Z_OK && out_size != size) {
+      status[b] = Z_DATA_ERROR;
+    }
+  }
+  for (const auto& s : status) {
+    if (s != Z_OK) {
+      LBANN_ERROR("zlib uncompress failed with status ", s);
+    }
+  }
+}
+
+#else
+
+bool have_compression() { return false; }
+
+void compress_bytes(const void*, std::size_t, std::vector<unsigned char>&) {
+  LBANN_ERROR("LBANN was not built with compression support; "
+              "reconfigure with LBANN_WITH_ZLIB=ON");
+}
+
+void decompress_bytes(const void*, std::size_t, void*, std::size_t) {
+  LBANN_ERROR("LBANN was not built with compression support; "
+              "reconfigure with LBANN_WITH_ZLIB=ON");
+}
+
+void compress_blocks(const void*, std::size_t, std::vector<unsigned char>&,
+                     std::size_t) {
+  LBANN_ERROR("LBANN was not built with compression support; "
+              "reconfigure with LBANN_WITH_ZLIB=ON");
+}
+
+void decompress_blocks(const void*, std::size_t, void*, std::size_t) {
+  LBANN_ERROR("LBANN was not built with compression support; "
+              "reconfigure with LBANN_WITH_ZLIB=ON");
+}
+
+#endif // LBANN_HAS_ZLIB
+
+}// namespace utils
+}// namespace lbann
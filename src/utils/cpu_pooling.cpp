@@ -0,0 +1,455 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/utils/cpu_pooling.hpp"
+#include "lbann/utils/exception.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace lbann {
+
+namespace {
+
+/** Pooling geometry with three spatial dimensions.
+ *  Tensors with fewer dimensions get leading singleton dimensions.
+ */
+struct geometry {
+  std::array<int,3> input_dims, output_dims, window_dims, pads, strides;
+  int input_size, output_size, window_size;
+};
+
+geometry make_geometry(int num_dims,
+                       const int* input_dims,
+                       const int* pads,
+                       const int* window_dims,
+                       const int* window_strides) {
+  if (num_dims < 1 || num_dims > 3) {
+    LBANN_ERROR("CPU pooling supports 1 to 3 spatial dimensions, ",
+                "but got ", num_dims);
+  }
+  geometry g;
+  g.input_dims.fill(1);
+  g.window_dims.fill(1);
+  g.pads.fill(0);
+  g.strides.fill(1);
+  const int shift = 3 - num_dims;
+  for (int d = 0; d < num_dims; ++d) {
+    g.input_dims[d+shift] = input_dims[d];
+    g.window_dims[d+shift] = window_dims[d];
+    g.pads[d+shift] = pads[d];
+    g.strides[d+shift] = window_strides[d];
+  }
+  for (int d = 0; d < 3; ++d) {
+    const int effective_dim = (g.input_dims[d] + 2 * g.pads[d]
+                               - g.window_dims[d] + 1);
+    g.output_dims[d] = (effective_dim + g.strides[d] - 1) / g.strides[d];
+  }
+  g.input_size = g.input_dims[0] * g.input_dims[1] * g.input_dims[2];
+  g.output_size = g.output_dims[0] * g.output_dims[1] * g.output_dims[2];
+  g.window_size = g.window_dims[0] * g.window_dims[1] * g.window_dims[2];
+  return g;
+}
+
+/** Range of output positions along the innermost dimension whose
+ *  window entry @c k lies inside the input tensor.
+ */
+void innermost_range(const geometry& g, int k, int& begin, int& end) {
+  const auto& stride = g.strides[2];
+  const int shift = g.pads[2] - k;
+  begin = shift > 0 ? (shift + stride - 1) / stride : 0;
+  const int last = g.input_dims[2] - 1 + shift;
+  end = last >= 0 ? last / stride + 1 : 0;
+  begin = std::min(begin, g.output_dims[2]);
+  end = std::max(std::min(end, g.output_dims[2]), begin);
+}
+
+/** Whether window entry (k0,k1) of output row (o0,o1) lies inside
+ *  the input tensor, and the offset of its input row.
+ */
+bool input_row(const geometry& g, int o0, int o1, int k0, int k1, int& offset) {
+  const int i0 = o0 * g.strides[0] - g.pads[0] + k0;
+  const int i1 = o1 * g.strides[1] - g.pads[1] + k1;
+  offset = (i0 * g.input_dims[1] + i1) * g.input_dims[2];
+  return (0 <= i0 && i0 < g.input_dims[0]
+          && 0 <= i1 && i1 < g.input_dims[1]);
+}
+
+/** Input position of a window offset, or -1 if it is padding. */
+int input_position(const geometry& g, int o0, int o1, int o2, int offset) {
+  const int k2 = offset % g.window_dims[2];
+  offset /= g.window_dims[2];
+  const int k1 = offset % g.window_dims[1];
+  const int k0 = offset / g.window_dims[1];
+  const int i0 = o0 * g.strides[0] - g.pads[0] + k0;
+  const int i1 = o1 * g.strides[1] - g.pads[1] + k1;
+  const int i2 = o2 * g.strides[2] - g.pads[2] + k2;
+  if (i0 < 0 || i0 >= g.input_dims[0]
+      || i1 < 0 || i1 >= g.input_dims[1]
+      || i2 < 0 || i2 >= g.input_dims[2]) {
+    return -1;
+  }
+  return (i0 * g.input_dims[1] + i1) * g.input_dims[2] + i2;
+}
+
+template <typename TensorDataType, typename IndexType>
+void max_pool_channel(const geometry& g,
+                      const TensorDataType* __restrict__ input,
+                      TensorDataType* __restrict__ output,
+                      IndexType* __restrict__ indices) {
+  const auto zero = El::TypeTraits<TensorDataType>::Zero();
+  const int stride = g.strides[2];
+  for (int o0 = 0; o0 < g.output_dims[0]; ++o0) {
+    for (int o1 = 0; o1 < g.output_dims[1]; ++o1) {
+      const int output_row = (o0 * g.output_dims[1] + o1) * g.output_dims[2];
+      auto* __restrict__ y = output + output_row;
+      auto* __restrict__ idx = indices + output_row;
+      for (int k0 = 0; k0 < g.window_dims[0]; ++k0) {
+        for (int k1 = 0; k1 < g.window_dims[1]; ++k1) {
+          int input_row_offset;
+          const bool valid = input_row(g, o0, o1, k0, k1, input_row_offset);
+          for (int k2 = 0; k2 < g.window_dims[2]; ++k2) {
+            const auto offset = static_cast<IndexType>(
+              (k0 * g.window_dims[1] + k1) * g.window_dims[2] + k2);
+            int begin = 0, end = 0;
+            if (valid) { innermost_range(g, k2, begin, end); }
+            const auto* x = (valid
+                             ? input + input_row_offset + k2 - g.pads[2]
+                             : input);
+
+            // The first window entry initializes the maxima
+            if (offset == 0) {
+              for (int o2 = 0; o2 < begin; ++o2) { y[o2] = zero; }
+              for (int o2 = begin; o2 < end; ++o2) { y[o2] = x[o2 * stride]; }
+              for (int o2 = end; o2 < g.output_dims[2]; ++o2) { y[o2] = zero; }
+              for (int o2 = 0; o2 < g.output_dims[2]; ++o2) { idx[o2] = 0; }
+              continue;
+            }
+
+            // Padding entries are zero
+            const auto update = [&] (int o2, const TensorDataType& val) {
+              const bool greater = val > y[o2];
+              y[o2] = greater ? val : y[o2];
+              idx[o2] = greater ? offset : idx[o2];
+            };
+            for (int o2 = 0; o2 < begin; ++o2) { update(o2, zero); }
+            for (int o2 = begin; o2 < end; ++o2) { update(o2, x[o2 * stride]); }
+            for (int o2 = end; o2 < g.output_dims[2]; ++o2) { update(o2, zero); }
+
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename TensorDataType>
+void average_pool_channel(const geometry& g,
+                          const TensorDataType* __restrict__ input,
+                          TensorDataType* __restrict__ output) {
+  const auto scale = El::To<TensorDataType>(1. / g.window_size);
+  const int stride = g.strides[2];
+  std::fill(output, output + g.output_size,
+            El::TypeTraits<TensorDataType>::Zero());
+  for (int o0 = 0; o0 < g.output_dims[0]; ++o0) {
+    for (int o1 = 0; o1 < g.output_dims[1]; ++o1) {
+      auto* __restrict__ y = output + (o0 * g.output_dims[1] + o1) * g.output_dims[2];
+      for (int k0 = 0; k0 < g.window_dims[0]; ++k0) {
+        for (int k1 = 0; k1 < g.window_dims[1]; ++k1) {
+          int input_row_offset;
+          if (!input_row(g, o0, o1, k0, k1, input_row_offset)) { continue; }
+          for (int k2 = 0; k2 < g.window_dims[2]; ++k2) {
+            int begin, end;
+            innermost_range(g, k2, begin, end);
+            const auto* x = input + input_row_offset + k2 - g.pads[2];
+            for (int o2 = begin; o2 < end; ++o2) { y[o2] += x[o2 * stride]; }
+          }
+        }
+      }
+      for (int o2 = 0; o2 < g.output_dims[2]; ++o2) { y[o2] *= scale; }
+    }
+  }
+}
+
+template <typename TensorDataType>
+void average_pool_backward_channel(const geometry& g,
+                                   const TensorDataType* __restrict__ gradient_wrt_output,
+                                   TensorDataType* __restrict__ gradient_wrt_input) {
+  const auto scale = El::To<TensorDataType>(1. / g.window_size);
+  const int stride = g.strides[2];
+  std::fill(gradient_wrt_input, gradient_wrt_input + g.input_size,
+            El::TypeTraits<TensorDataType>::Zero());
+  for (int o0 = 0; o0 < g.output_dims[0]; ++o0) {
+    for (int o1 = 0; o1 < g.output_dims[1]; ++o1) {
+      const auto* __restrict__ dy
+        = gradient_wrt_output + (o0 * g.output_dims[1] + o1) * g.output_dims[2];
+      for (int k0 = 0; k0 < g.window_dims[0]; ++k0) {
+        for (int k1 = 0; k1 < g.window_dims[1]; ++k1) {
+          int input_row_offset;
+          if (!input_row(g, o0, o1, k0, k1, input_row_offset)) { continue; }
+          for (int k2 = 0; k2 < g.window_dims[2]; ++k2) {
+            int begin, end;
+            innermost_range(g, k2, begin, end);
+            auto* dx = gradient_wrt_input + input_row_offset + k2 - g.pads[2];
+            for (int o2 = begin; o2 < end; ++o2) {
+              dx[o2 * stride] += dy[o2] * scale;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+
+template <typename TensorDataType, typename IndexType>
+void max_pool_forward(const CPUMatDT<TensorDataType>& input,
+                      CPUMatDT<TensorDataType>& output,
+                      IndexType* indices,
+                      int num_channels,
+                      int num_dims,
+                      const int* input_dims,
+                      const int* pads,
+                      const int* window_dims,
+                      const int* window_strides) {
+  const auto g = make_geometry(num_dims, input_dims, pads,
+                               window_dims, window_strides);
+  const El::Int width = input.Width();
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (El::Int sample = 0; sample < width; ++sample) {
+    for (int channel = 0; channel < num_channels; ++channel) {
+      max_pool_channel(
+        g,
+        input.LockedBuffer(channel * g.input_size, sample),
+        output.Buffer(channel * g.output_size, sample),
+        indices + (sample * num_channels + channel) * g.output_size);
+    }
+  }
+}
+
+template <typename TensorDataType, typename IndexType>
+void max_pool_backward(const CPUMatDT<TensorDataType>& gradient_wrt_output,
+                       const IndexType* indices,
+                       CPUMatDT<TensorDataType>& gradient_wrt_input,
+                       int num_channels,
+                       int num_dims,
+                       const int* input_dims,
+                       const int* pads,
+                       const int* window_dims,
+                       const int* window_strides) {
+  const auto g = make_geometry(num_dims, input_dims, pads,
+                               window_dims, window_strides);
+  const El::Int width = gradient_wrt_output.Width();
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (El::Int sample = 0; sample < width; ++sample) {
+    for (int channel = 0; channel < num_channels; ++channel) {
+      const auto* dy = gradient_wrt_output.LockedBuffer(channel * g.output_size, sample);
+      const auto* idx = indices + (sample * num_channels + channel) * g.output_size;
+      auto* dx = gradient_wrt_input.Buffer(channel * g.input_size, sample);
+      std::fill(dx, dx + g.input_size, El::TypeTraits<TensorDataType>::Zero());
+      for (int o0 = 0; o0 < g.output_dims[0]; ++o0) {
+        for (int o1 = 0; o1 < g.output_dims[1]; ++o1) {
+          for (int o2 = 0; o2 < g.output_dims[2]; ++o2) {
+            const int o = (o0 * g.output_dims[1] + o1) * g.output_dims[2] + o2;
+            const int i = input_position(g, o0, o1, o2, idx[o]);
+            if (i >= 0) { dx[i] += dy[o]; }
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename TensorDataType>
+void average_pool_forward(const CPUMatDT<TensorDataType>& input,
+                          CPUMatDT<TensorDataType>& output,
+                          int num_channels,
+                          int num_dims,
+                          const int* input_dims,
+                          const int* pads,
+                          const int* window_dims,
+                          const int* window_strides) {
+  const auto g = make_geometry(num_dims, input_dims, pads,
+                               window_dims, window_strides);
+  const El::Int width = input.Width();
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (El::Int sample = 0; sample < width; ++sample) {
+    for (int channel = 0; channel < num_channels; ++channel) {
+      average_pool_channel(
+        g,
+        input.LockedBuffer(channel * g.input_size, sample),
+        output.Buffer(channel * g.output_size, sample));
+    }
+  }
+}
+
+template <typename TensorDataType>
+void average_pool_backward(const CPUMatDT<TensorDataType>& gradient_wrt_output,
+                           CPUMatDT<TensorDataType>& gradient_wrt_input,
+                           int num_channels,
+                           int num_dims,
+                           const int* input_dims,
+                           const int* pads,
+                           const int* window_dims,
+                           const int* window_strides) {
+  const auto g = make_geometry(num_dims, input_dims, pads,
+                               window_dims, window_strides);
+  const El::Int width = gradient_wrt_output.Width();
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (El::Int sample = 0; sample < width; ++sample) {
+    for (int channel = 0; channel < num_channels; ++channel) {
+      average_pool_backward_channel(
+        g,
+        gradient_wrt_output.LockedBuffer(channel * g.output_size, sample),
+        gradient_wrt_input.Buffer(channel * g.input_size, sample));
+    }
+  }
+}
+
+template <typename TensorDataType, typename IndexType>
+void max_unpool_forward(const CPUMatDT<TensorDataType>& input,
+                        const IndexType* indices,
+                        CPUMatDT<TensorDataType>& output,
+                        int num_channels,
+                        int num_dims,
+                        const int* output_dims,
+                        const int* pads,
+                        const int* window_dims,
+                        const int* window_strides) {
+
+  // Note: The geometry describes the paired pooling layer, so its
+  // input is this function's output.
+  const auto g = make_geometry(num_dims, output_dims, pads,
+                               window_dims, window_strides);
+  const auto zero = El::TypeTraits<TensorDataType>::Zero();
+  const El::Int width = input.Width();
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (El::Int sample = 0; sample < width; ++sample) {
+    for (int channel = 0; channel < num_channels; ++channel) {
+      const auto* x = input.LockedBuffer(channel * g.output_size, sample);
+      const auto* idx = indices + (sample * num_channels + channel) * g.output_size;
+      auto* y = output.Buffer(channel * g.input_size, sample);
+
+      // Gather from the windows containing each output entry
+      for (int i0 = 0; i0 < g.input_dims[0]; ++i0) {
+        for (int i1 = 0; i1 < g.input_dims[1]; ++i1) {
+          for (int i2 = 0; i2 < g.input_dims[2]; ++i2) {
+            const std::array<int,3> pos = {i0, i1, i2};
+            std::array<int,3> first, last;
+            for (int d = 0; d < 3; ++d) {
+              const int p = pos[d] + g.pads[d];
+              first[d] = std::max((p - g.window_dims[d] + g.strides[d]) / g.strides[d], 0);
+              last[d] = std::min(p / g.strides[d], g.output_dims[d] - 1);
+            }
+            TensorDataType val = zero;
+            bool initialized = false;
+            for (int o0 = first[0]; o0 <= last[0]; ++o0) {
+              for (int o1 = first[1]; o1 <= last[1]; ++o1) {
+                for (int o2 = first[2]; o2 <= last[2]; ++o2) {
+                  const int offset
+                    = (((i0 + g.pads[0] - o0 * g.strides[0]) * g.window_dims[1]
+                        + (i1 + g.pads[1] - o1 * g.strides[1])) * g.window_dims[2]
+                       + (i2 + g.pads[2] - o2 * g.strides[2]));
+                  const int o = (o0 * g.output_dims[1] + o1) * g.output_dims[2] + o2;
+                  const auto contribution = (static_cast<int>(idx[o]) == offset
+                                             ? x[o] : zero);
+                  val = initialized ? std::max(val, contribution) : contribution;
+                  initialized = true;
+                }
+              }
+            }
+            y[(i0 * g.input_dims[1] + i1) * g.input_dims[2] + i2] = val;
+          }
+        }
+      }
+
+    }
+  }
+}
+
+template <typename TensorDataType, typename IndexType>
+void max_unpool_backward(const CPUMatDT<TensorDataType>& gradient_wrt_output,
+                         const IndexType* indices,
+                         CPUMatDT<TensorDataType>& gradient_wrt_input,
+                         int num_channels,
+                         int num_dims,
+                         const int* output_dims,
+                         const int* pads,
+                         const int* window_dims,
+                         const int* window_strides) {
+  const auto g = make_geometry(num_dims, output_dims, pads,
+                               window_dims, window_strides);
+  const auto zero = El::TypeTraits<TensorDataType>::Zero();
+  const El::Int width = gradient_wrt_output.Width();
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (El::Int sample = 0; sample < width; ++sample) {
+    for (int channel = 0; channel < num_channels; ++channel) {
+      const auto* dy = gradient_wrt_output.LockedBuffer(channel * g.input_size, sample);
+      const auto* idx = indices + (sample * num_channels + channel) * g.output_size;
+      auto* dx = gradient_wrt_input.Buffer(channel * g.output_size, sample);
+      for (int o0 = 0; o0 < g.output_dims[0]; ++o0) {
+        for (int o1 = 0; o1 < g.output_dims[1]; ++o1) {
+          for (int o2 = 0; o2 < g.output_dims[2]; ++o2) {
+            const int o = (o0 * g.output_dims[1] + o1) * g.output_dims[2] + o2;
+            const int i = input_position(g, o0, o1, o2, idx[o]);
+            dx[o] = i >= 0 ? dy[i] : zero;
+          }
+        }
+      }
+    }
+  }
+}
+
+#define PROTO_INDEX(T, IndexType)                                       \
+  template void max_pool_forward<T, IndexType>(                         \
+    const CPUMatDT<T>&, CPUMatDT<T>&, IndexType*,                       \
+    int, int, const int*, const int*, const int*, const int*);          \
+  template void max_pool_backward<T, IndexType>(                        \
+    const CPUMatDT<T>&, const IndexType*, CPUMatDT<T>&,                 \
+    int, int, const int*, const int*, const int*, const int*);          \
+  template void max_unpool_forward<T, IndexType>(                       \
+    const CPUMatDT<T>&, const IndexType*, CPUMatDT<T>&,                 \
+    int, int, const int*, const int*, const int*, const int*);          \
+  template void max_unpool_backward<T, IndexType>(                      \
+    const CPUMatDT<T>&, const IndexType*, CPUMatDT<T>&,                 \
+    int, int, const int*, const int*, const int*, const int*)
+
+#define PROTO(T)                                                        \
+  PROTO_INDEX(T, unsigned char);                                        \
+  PROTO_INDEX(T, int);                                                  \
+  template void average_pool_forward<T>(                                \
+    const CPUMatDT<T>&, CPUMatDT<T>&,                                   \
+    int, int, const int*, const int*, const int*, const int*);          \
+  template void average_pool_backward<T>(                               \
+    const CPUMatDT<T>&, CPUMatDT<T>&,                                   \
+    int, int, const int*, const int*, const int*, const int*)
+
+#define LBANN_INSTANTIATE_CPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
@@ -77,6 +77,75 @@ void event_wrapper::synchronize() {
 
 cudaEvent_t& event_wrapper::get_event() { return m_event; }
 
+////////////////////////////////////////////////////////////
+// CUDA graph wrapper
+////////////////////////////////////////////////////////////
+
+graph_wrapper::~graph_wrapper() {
+  if (m_graph_exec != nullptr) { cudaGraphExecDestroy(m_graph_exec); }
+}
+
+void graph_wrapper::begin_capture(cudaStream_t stream) {
+  m_stream = stream;
+  // Relaxed mode lets the memory pool allocate while capturing
+  CHECK_CUDA(cudaStreamBeginCapture(m_stream, cudaStreamCaptureModeRelaxed));
+}
+
+bool graph_wrapper::end_capture() {
+  cudaGraph_t graph = nullptr;
+  const auto status = cudaStreamEndCapture(m_stream, &graph);
+  if (status == cudaErrorStreamCaptureInvalidated) {
+    cudaGetLastError(); // Clear error
+    if (graph != nullptr) { cudaGraphDestroy(graph); }
+    reset();
+    return false;
+  }
+  CHECK_CUDA(status);
+
+  // Update executable graph if possible, since it is much cheaper
+  // than instantiating a new one
+  bool updated = false;
+  if (m_graph_exec != nullptr) {
+#if CUDART_VERSION >= 12000
+    cudaGraphExecUpdateResultInfo result_info;
+    updated = (cudaGraphExecUpdate(m_graph_exec, graph, &result_info)
+               == cudaSuccess);
+#else
+    cudaGraphNode_t error_node;
+    cudaGraphExecUpdateResult result;
+    updated = (cudaGraphExecUpdate(m_graph_exec, graph, &error_node, &result)
+               == cudaSuccess);
+#endif // CUDART_VERSION >= 12000
+    if (!updated) {
+      cudaGetLastError(); // Clear error
+      reset();
+    }
+  }
+  if (!updated) {
+#if CUDART_VERSION >= 11040
+    CHECK_CUDA(cudaGraphInstantiateWithFlags(&m_graph_exec, graph, 0));
+#else
+    CHECK_CUDA(cudaGraphInstantiate(&m_graph_exec, graph, nullptr, nullptr, 0));
+#endif // CUDART_VERSION >= 11040
+  }
+  CHECK_CUDA(cudaGraphDestroy(graph));
+  return true;
+}
+
+void graph_wrapper::launch() {
+  if (m_graph_exec == nullptr) {
+    LBANN_ERROR("attempted to launch a CUDA graph before capturing it");
+  }
+  CHECK_CUDA(cudaGraphLaunch(m_graph_exec, m_stream));
+}
+
+void graph_wrapper::reset() {
+  if (m_graph_exec != nullptr) {
+    CHECK_CUDA(cudaGraphExecDestroy(m_graph_exec));
+    m_graph_exec = nullptr;
+  }
+}
+
 } // namespace cuda
 } // namespace lbann
 
@@ -26,10 +26,19 @@
 
 #include "lbann/utils/cudnn.hpp"
 #include "lbann/utils/number_theory.hpp"
+#include "lbann/comm.hpp"
+#include "lbann/utils/options.hpp"
 
 #include "El.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <initializer_list>
 #include <iostream>
 #include <map>
+#include <mutex>
+#include <sstream>
 #include <unordered_map>
 #include <tuple>
 
@@ -63,6 +72,23 @@ struct handle_wrapper {
 /** Global instance of cuDNN handle. */
 std::unique_ptr<handle_wrapper> handle_instance;
 
+/** Device workspace shared by all cuDNN calls. */
+struct workspace_wrapper {
+  void* buffer = nullptr;
+  size_t size = 0;
+  /** Memory from the caching allocator, if it is enabled. */
+  cuda::cached_buffer cached;
+  workspace_wrapper() = default;
+  workspace_wrapper(const workspace_wrapper&) = delete;
+  workspace_wrapper& operator=(const workspace_wrapper&) = delete;
+  ~workspace_wrapper() {
+    if (buffer != nullptr && cached.get() == nullptr) { cudaFree(buffer); }
+  }
+};
+
+/** Global instance of cuDNN workspace. */
+std::unique_ptr<workspace_wrapper> workspace_instance;
+
 } // namespace
 
 void initialize() {
@@ -70,6 +96,7 @@ void initialize() {
 }
 
 void destroy() {
+  workspace_instance.reset();
   handle_instance.reset();
 }
 
@@ -257,7 +284,11 @@ layer_tensor_manager<TensorDataType>::layer_tensor_manager(const layer_tensor_ma
     m_prev_activations(other.m_prev_activations.size(), nullptr),
     m_activations(other.m_activations.size(), nullptr),
     m_prev_error_signals(other.m_prev_error_signals.size(), nullptr),
-    m_error_signals(other.m_error_signals.size(), nullptr) {
+    m_error_signals(other.m_error_signals.size(), nullptr),
+    m_prev_activations_keys(other.m_prev_activations_keys),
+    m_activations_keys(other.m_activations_keys),
+    m_prev_error_signals_keys(other.m_prev_error_signals_keys),
+    m_error_signals_keys(other.m_error_signals_keys) {
   for (size_t i = 0; i < m_prev_activations.size(); ++i) {
     copy_tensor_desc(other.m_prev_activations[i], m_prev_activations[i]);
   }
@@ -299,6 +330,10 @@ layer_tensor_manager<TensorDataType>& layer_tensor_manager<TensorDataType>::oper
   for (size_t i = 0; i < m_error_signals.size(); ++i) {
     copy_tensor_desc(other.m_error_signals[i], m_error_signals[i]);
   }
+  m_prev_activations_keys = other.m_prev_activations_keys;
+  m_activations_keys = other.m_activations_keys;
+  m_prev_error_signals_keys = other.m_prev_error_signals_keys;
+  m_error_signals_keys = other.m_error_signals_keys;
 
   return *this;
 }
@@ -345,6 +380,8 @@ void layer_tensor_manager<TensorDataType>::set_num_parents(int num_parents) {
   }
   m_prev_activations.resize(num_parents, nullptr);
   m_error_signals.resize(num_parents, nullptr);
+  m_prev_activations_keys.resize(num_parents);
+  m_error_signals_keys.resize(num_parents);
 }
 
 template <typename TensorDataType>
@@ -366,6 +403,8 @@ void layer_tensor_manager<TensorDataType>::set_num_children(int num_children) {
   }
   m_activations.resize(num_children, nullptr);
   m_prev_error_signals.resize(num_children, nullptr);
+  m_activations_keys.resize(num_children);
+  m_prev_error_signals_keys.resize(num_children);
 }
 
 ////////////////////////////////////////////////////////////
@@ -379,10 +418,29 @@ data_parallel_layer_tensor_manager<TensorDataType>
 
 namespace {
 
+/** Check whether a tensor descriptor was last set with a shape.
+ *  The key is updated if not.
+ */
+bool is_tensor_desc_current(const cudnnTensorDescriptor_t& desc,
+                            std::vector<int>& key,
+                            std::initializer_list<int> shape,
+                            const std::vector<int>& dims = {}) {
+  if (desc != nullptr
+      && key.size() == shape.size() + dims.size()
+      && std::equal(shape.begin(), shape.end(), key.begin())
+      && std::equal(dims.begin(), dims.end(), key.begin() + shape.size())) {
+    return true;
+  }
+  key.assign(shape.begin(), shape.end());
+  key.insert(key.end(), dims.begin(), dims.end());
+  return false;
+}
+
 /** Set a cuDNN tensor descriptor for a data-parallel data layout.
  */
 template <typename TensorDataType>
 void set_data_parallel_tensor_desc(cudnnTensorDescriptor_t& desc,
+                                   std::vector<int>& key,
                                    std::vector<int> dims,
                                    const El::AbstractMatrix<TensorDataType>& local_data) {
 #ifdef LBANN_DEBUG
@@ -391,12 +449,17 @@ void set_data_parallel_tensor_desc(cudnnTensorDescriptor_t& desc,
   }
 #endif // LBANN_DEBUG
   if (local_data.Height() > 0 && local_data.Width() > 0) {
+    const int width = local_data.Width();
+    const int ldim = local_data.LDim();
+    if (is_tensor_desc_current(desc, key, {width, ldim}, dims)) {
+      return;
+    }
     std::vector<int> strides(dims.size(), 1);
     for(int i = strides.size() - 1; i > 0; --i) {
       strides[i-1] = strides[i] * dims[i];
     }
-    dims.insert(dims.begin(), local_data.Width());
-    strides.insert(strides.begin(), local_data.LDim());
+    dims.insert(dims.begin(), width);
+    strides.insert(strides.begin(), ldim);
     set_tensor_desc<TensorDataType>(desc, dims, strides);
   }
 }
@@ -412,7 +475,8 @@ cudnnTensorDescriptor_t& data_parallel_layer_tensor_manager<TensorDataType>::get
   const auto& dims = this->m_layer->get_input_dims(parent_index);
   this->set_num_parents(this->m_layer->get_num_parents());
   auto& desc = this->m_prev_activations[parent_index];
-  set_data_parallel_tensor_desc<TensorDataType>(desc, dims, local_data);
+  auto& key = this->m_prev_activations_keys[parent_index];
+  set_data_parallel_tensor_desc<TensorDataType>(desc, key, dims, local_data);
   return desc;
 }
 
@@ -425,7 +489,8 @@ cudnnTensorDescriptor_t& data_parallel_layer_tensor_manager<TensorDataType>::get
   const auto& dims = this->m_layer->get_output_dims(child_index);
   this->set_num_children(this->m_layer->get_num_children());
   auto& desc = this->m_activations[child_index];
-  set_data_parallel_tensor_desc<TensorDataType>(desc, dims, local_data);
+  auto& key = this->m_activations_keys[child_index];
+  set_data_parallel_tensor_desc<TensorDataType>(desc, key, dims, local_data);
   return desc;
 }
 
@@ -438,7 +503,8 @@ cudnnTensorDescriptor_t& data_parallel_layer_tensor_manager<TensorDataType>::get
   const auto& dims = this->m_layer->get_output_dims(child_index);
   this->set_num_children(this->m_layer->get_num_children());
   auto& desc = this->m_prev_error_signals[child_index];
-  set_data_parallel_tensor_desc<TensorDataType>(desc, dims, local_data);
+  auto& key = this->m_prev_error_signals_keys[child_index];
+  set_data_parallel_tensor_desc<TensorDataType>(desc, key, dims, local_data);
   return desc;
 }
 
@@ -451,7 +517,8 @@ cudnnTensorDescriptor_t& data_parallel_layer_tensor_manager<TensorDataType>::get
   const auto& dims = this->m_layer->get_input_dims(parent_index);
   this->set_num_parents(this->m_layer->get_num_parents());
   auto& desc = this->m_error_signals[parent_index];
-  set_data_parallel_tensor_desc<TensorDataType>(desc, dims, local_data);
+  auto& key = this->m_error_signals_keys[parent_index];
+  set_data_parallel_tensor_desc<TensorDataType>(desc, key, dims, local_data);
   return desc;
 }
 
@@ -474,6 +541,7 @@ namespace {
  */
 template <typename TensorDataType>
 void set_entrywise_tensor_desc(cudnnTensorDescriptor_t& desc,
+                               std::vector<int>& key,
                                const El::AbstractMatrix<TensorDataType>& local_data) {
 #ifdef LBANN_DEBUG
   if (local_data.GetDevice() != El::Device::GPU) {
@@ -484,6 +552,9 @@ void set_entrywise_tensor_desc(cudnnTensorDescriptor_t& desc,
   const int width = local_data.Width();
   const int ldim = local_data.LDim();
   if (height > 0 && width > 0) {
+    if (is_tensor_desc_current(desc, key, {height, width, ldim})) {
+      return;
+    }
 
     // Factorize height into three factors
     // Note: factorization is memoized
@@ -511,7 +582,8 @@ cudnnTensorDescriptor_t& entrywise_layer_tensor_manager<TensorDataType>::get_pre
   const auto& local_data = this->m_layer->get_local_prev_activations(parent_index);
   this->set_num_parents(this->m_layer->get_num_parents());
   auto& desc = this->m_prev_activations[parent_index];
-  set_entrywise_tensor_desc<TensorDataType>(desc, local_data);
+  auto& key = this->m_prev_activations_keys[parent_index];
+  set_entrywise_tensor_desc<TensorDataType>(desc, key, local_data);
   return desc;
 }
 
@@ -523,7 +595,8 @@ cudnnTensorDescriptor_t& entrywise_layer_tensor_manager<TensorDataType>::get_act
   const auto& local_data = this->m_layer->get_local_activations(child_index);
   this->set_num_children(this->m_layer->get_num_children());
   auto& desc = this->m_activations[child_index];
-  set_entrywise_tensor_desc<TensorDataType>(desc, local_data);
+  auto& key = this->m_activations_keys[child_index];
+  set_entrywise_tensor_desc<TensorDataType>(desc, key, local_data);
   return desc;
 }
 
@@ -535,7 +608,8 @@ cudnnTensorDescriptor_t& entrywise_layer_tensor_manager<TensorDataType>::get_pre
   const auto& local_data = this->m_layer->get_local_prev_error_signals(child_index);
   this->set_num_children(this->m_layer->get_num_children());
   auto& desc = this->m_prev_error_signals[child_index];
-  set_entrywise_tensor_desc<TensorDataType>(desc, local_data);
+  auto& key = this->m_prev_error_signals_keys[child_index];
+  set_entrywise_tensor_desc<TensorDataType>(desc, key, local_data);
   return desc;
 }
 
@@ -547,10 +621,44 @@ cudnnTensorDescriptor_t& entrywise_layer_tensor_manager<TensorDataType>::get_err
   const auto& local_data = this->m_layer->get_local_error_signals(parent_index);
   this->set_num_parents(this->m_layer->get_num_parents());
   auto& desc = this->m_error_signals[parent_index];
-  set_entrywise_tensor_desc<TensorDataType>(desc, local_data);
+  auto& key = this->m_error_signals_keys[parent_index];
+  set_entrywise_tensor_desc<TensorDataType>(desc, key, local_data);
   return desc;
 }
 
+////////////////////////////////////////////////////////////
+// cuDNN workspace
+////////////////////////////////////////////////////////////
+
+void* get_workspace(size_t size) {
+  if (!workspace_instance) { workspace_instance.reset(new workspace_wrapper()); }
+  auto& ws = *workspace_instance;
+  if (size > ws.size) {
+    CHECK_CUDA(cudaSetDevice(El::GPUManager::Device()));
+    if (cuda::caching_allocator::enabled()) {
+      // The old buffer is reused after the pending calls on the
+      // stream
+      ws.buffer = ws.cached.reserve(size);
+      ws.size = size;
+      return ws.buffer;
+    }
+    if (ws.buffer != nullptr) {
+      // cudaFree synchronizes the device, so pending calls are done
+      // with the old buffer
+      CHECK_CUDA(cudaFree(ws.buffer));
+      ws.buffer = nullptr;
+      ws.size = 0;
+    }
+    CHECK_CUDA(cudaMalloc(&ws.buffer, size));
+    ws.size = size;
+  }
+  return ws.buffer;
+}
+
+size_t get_workspace_size() noexcept {
+  return workspace_instance ? workspace_instance->size : 0;
+}
+
 ////////////////////////////////////////////////////////////
 // cuDNN algorithm selection
 ////////////////////////////////////////////////////////////
@@ -567,6 +675,22 @@ std::vector<cudnnConvolutionBwdFilterAlgo_t> nondet_bwd_filter_algos = {
   CUDNN_CONVOLUTION_BWD_FILTER_ALGO_3
 };
 
+// Autotuned times of the chosen deterministic algorithms and of the
+// fastest algorithms overall.
+deterministic_overhead overhead;
+std::mutex overhead_mutex;
+
+/** Whether cuDNN reports an algorithm as nondeterministic, or it is
+ *  known to be. */
+template <typename AlgoType, typename PerfType>
+bool is_nondeterministic(const PerfType& p,
+                         const std::vector<AlgoType>& nondeterministic_algos) {
+  return (p.determinism == CUDNN_NON_DETERMINISTIC
+          || std::find(nondeterministic_algos.begin(),
+                       nondeterministic_algos.end(),
+                       p.algo) != nondeterministic_algos.end());
+}
+
 template <typename AlgoType, typename PerfType>
 AlgoType find_best_heuristic_algorithm(
   const std::vector<PerfType>& perf_results,
@@ -578,9 +702,7 @@ AlgoType find_best_heuristic_algorithm(
     if (p.status != CUDNN_STATUS_SUCCESS) {
       continue;
     }
-    if (deterministic &&
-        std::find(nondeterministic_algos.begin(), nondeterministic_algos.end(),
-                  p.algo) != nondeterministic_algos.end()) {
+    if (deterministic && is_nondeterministic(p, nondeterministic_algos)) {
       continue;
     }
     if (p.memory > max_ws_size) {
@@ -601,6 +723,7 @@ AlgoType find_best_algorithm(
   bool deterministic,
   size_t max_ws_size) {
   std::map<AlgoType, float> time_map;
+  std::map<AlgoType, float> unconstrained_time;
   for (const auto& p : perf_results) {
     if (p.status != CUDNN_STATUS_SUCCESS) {
       // If an algorithm fails, we still add it in case the failure is
@@ -608,12 +731,11 @@ AlgoType find_best_algorithm(
       time_map[p.algo] = std::numeric_limits<float>::max();
       continue;
     }
-    if (deterministic &&
-        std::find(nondeterministic_algos.begin(), nondeterministic_algos.end(),
-                  p.algo) != nondeterministic_algos.end()) {
+    if (p.memory > max_ws_size) {
       continue;
     }
-    if (p.memory > max_ws_size) {
+    unconstrained_time[p.algo] += p.time;
+    if (deterministic && is_nondeterministic(p, nondeterministic_algos)) {
       continue;
     }
     if (time_map.count(p.algo) == 0) {
@@ -638,6 +760,16 @@ AlgoType find_best_algorithm(
   if (min_time == std::numeric_limits<float>::max()) {
     LBANN_ERROR("No valid convolution algorithms.");
   }
+  if (deterministic) {
+    float min_unconstrained_time = min_time;
+    for (const auto& x : unconstrained_time) {
+      min_unconstrained_time = std::min(min_unconstrained_time, x.second);
+    }
+    std::lock_guard<std::mutex> lock(overhead_mutex);
+    overhead.deterministic_ms += min_time;
+    overhead.nondeterministic_ms += min_unconstrained_time;
+    ++overhead.num_selections;
+  }
   return best_algo;
 }
 
@@ -804,8 +936,251 @@ cudnnConvolutionBwdFilterAlgo_t get_bwd_filter_algo_autotune(
                              deterministic, ws_size);
 }
 
+/** Autotuned algorithms, keyed by convolution problem.
+ *
+ *  Entries are shared by every layer on this process with the same
+ *  problem. If a cache file has been loaded, entries tuned during
+ *  this run are written back to it in @c save_algorithm_cache.
+ */
+struct algorithm_cache {
+  /** Cache file. Empty if the cache is not persistent. */
+  std::string path;
+  std::unordered_map<std::string, int> algos;
+  /** Entries that were not in the cache file. */
+  std::vector<std::string> new_keys;
+};
+
+algorithm_cache& get_algorithm_cache() {
+  static algorithm_cache cache;
+  return cache;
+}
+
+/** GPU model and cuDNN version.
+ *  Tuned algorithms are only reused on matching systems.
+ */
+const std::string& get_system_key() {
+  static const std::string key = [] {
+    cudaDeviceProp prop;
+    CHECK_CUDA(cudaGetDeviceProperties(&prop, El::GPUManager::Device()));
+    std::string name(prop.name);
+    std::replace_if(name.begin(), name.end(),
+                    [](char c) { return std::isspace(c) || c == ','; },
+                    '_');
+    std::ostringstream ss;
+    ss << name << ",sm" << prop.major << prop.minor
+       << ",cudnn" << cudnnGetVersion();
+    return ss.str();
+  }();
+  return key;
+}
+
+void write_desc_key(std::ostream& os, const cudnnTensorDescriptor_t& desc) {
+  cudnnDataType_t data_type;
+  int num_dims;
+  std::vector<int> dims(CUDNN_DIM_MAX), strides(CUDNN_DIM_MAX);
+  CHECK_CUDNN(cudnnGetTensorNdDescriptor(desc, CUDNN_DIM_MAX, &data_type,
+                                         &num_dims, dims.data(),
+                                         strides.data()));
+  os << ",t" << static_cast<int>(data_type);
+  for (int i = 0; i < num_dims; ++i) { os << "," << dims[i]; }
+  for (int i = 0; i < num_dims; ++i) { os << "," << strides[i]; }
+}
+
+void write_desc_key(std::ostream& os, const cudnnFilterDescriptor_t& desc) {
+  cudnnDataType_t data_type;
+  cudnnTensorFormat_t format;
+  int num_dims;
+  std::vector<int> dims(CUDNN_DIM_MAX);
+  CHECK_CUDNN(cudnnGetFilterNdDescriptor(desc, CUDNN_DIM_MAX, &data_type,
+                                         &format, &num_dims, dims.data()));
+  os << ",f" << static_cast<int>(data_type) << "," << static_cast<int>(format);
+  for (int i = 0; i < num_dims; ++i) { os << "," << dims[i]; }
+}
+
+void write_desc_key(std::ostream& os, const cudnnConvolutionDescriptor_t& desc) {
+  int num_dims;
+  std::vector<int> pads(CUDNN_DIM_MAX), strides(CUDNN_DIM_MAX),
+    dilations(CUDNN_DIM_MAX);
+  cudnnConvolutionMode_t mode;
+  cudnnDataType_t compute_type;
+  int num_groups;
+  cudnnMathType_t math_type;
+  CHECK_CUDNN(cudnnGetConvolutionNdDescriptor(desc, CUDNN_DIM_MAX, &num_dims,
+                                              pads.data(), strides.data(),
+                                              dilations.data(), &mode,
+                                              &compute_type));
+  CHECK_CUDNN(cudnnGetConvolutionGroupCount(desc, &num_groups));
+  CHECK_CUDNN(cudnnGetConvolutionMathType(desc, &math_type));
+  os << ",c" << static_cast<int>(mode) << "," << static_cast<int>(compute_type)
+     << "," << num_groups << "," << static_cast<int>(math_type);
+  for (int i = 0; i < num_dims; ++i) {
+    os << "," << pads[i] << "," << strides[i] << "," << dilations[i];
+  }
+}
+
+/** Key for an autotuned convolution algorithm.
+ *
+ *  @param x_desc Convolution input (or its gradient).
+ *  @param w_desc Convolution kernel (or its gradient).
+ *  @param y_desc Convolution output (or its gradient).
+ */
+std::string get_algorithm_key(const std::string& kind,
+                              bool deterministic,
+                              size_t ws_size,
+                              const cudnnTensorDescriptor_t& x_desc,
+                              const cudnnFilterDescriptor_t& w_desc,
+                              const cudnnConvolutionDescriptor_t& conv_desc,
+                              const cudnnTensorDescriptor_t& y_desc) {
+  std::ostringstream ss;
+  ss << kind << "," << get_system_key()
+     << "," << (deterministic ? "det" : "nondet") << "," << ws_size;
+  write_desc_key(ss, x_desc);
+  write_desc_key(ss, w_desc);
+  write_desc_key(ss, conv_desc);
+  write_desc_key(ss, y_desc);
+  return ss.str();
+}
+
+bool find_cached_algorithm(const std::string& key, int& algo) {
+  const auto& algos = get_algorithm_cache().algos;
+  const auto it = algos.find(key);
+  if (it == algos.end()) { return false; }
+  algo = it->second;
+  return true;
+}
+
+void add_cached_algorithm(const std::string& key, int algo) {
+  auto& cache = get_algorithm_cache();
+  if (cache.algos.emplace(key, algo).second) {
+    cache.new_keys.push_back(key);
+  }
+}
+
+/** Parse "key algo" lines into the cache. */
+void parse_algorithm_cache(const std::string& contents) {
+  auto& algos = get_algorithm_cache().algos;
+  std::istringstream in(contents);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') { continue; }
+    std::istringstream line_ss(line);
+    std::string key;
+    int algo;
+    if (line_ss >> key >> algo) { algos.emplace(key, algo); }
+  }
+}
+
+/** Workspace limit for algorithm selection (bytes).
+ *  Set with --cudnn_workspace_mb (default 1 GB).
+ */
+size_t get_autotune_workspace_limit() {
+  static const size_t limit
+    = size_t(options::get()->get_int("cudnn_workspace_mb", 1024)) << 20;
+  return limit;
+}
+
+/** Temporary device buffer for autotuning.
+ *
+ *  Allocated directly rather than through the shared workspace or
+ *  the CUB memory pool, so it is released once tuning finishes. If
+ *  the limit doesn't fit in memory, the largest power-of-two fraction
+ *  of it that does is used.
+ */
+struct autotune_workspace {
+  void* buffer = nullptr;
+  size_t size;
+  autotune_workspace(size_t limit) : size(limit) {
+    while (size >= (size_t(1) << 20)
+           && cudaMalloc(&buffer, size) != cudaSuccess) {
+      cudaGetLastError(); // Clear the allocation error
+      buffer = nullptr;
+      size /= 2;
+    }
+    if (buffer == nullptr) { size = 0; }
+  }
+  autotune_workspace(const autotune_workspace&) = delete;
+  autotune_workspace& operator=(const autotune_workspace&) = delete;
+  ~autotune_workspace() {
+    if (buffer != nullptr) { cudaFree(buffer); }
+  }
+};
+
 }  // namespace
 
+void load_algorithm_cache(lbann_comm& comm, const std::string& path) {
+  auto& cache = get_algorithm_cache();
+  cache.path = path;
+  std::string contents;
+  if (comm.am_world_master()) {
+    std::ifstream in(path);
+    if (in) {
+      std::ostringstream ss;
+      ss << in.rdbuf();
+      contents = ss.str();
+    }
+  }
+  comm.world_broadcast(comm.get_world_master(), contents);
+  parse_algorithm_cache(contents);
+  cache.new_keys.clear();
+  if (comm.am_world_master()) {
+    std::cout << "loaded " << cache.algos.size() << " cuDNN convolution "
+              << "algorithms from " << path << std::endl;
+  }
+}
+
+void save_algorithm_cache(lbann_comm& comm) {
+  auto& cache = get_algorithm_cache();
+  if (cache.path.empty()) { return; }
+
+  // Gather newly tuned entries on world master. Every rank sends a
+  // trailing newline so no contribution is empty.
+  std::ostringstream ss;
+  for (const auto& key : cache.new_keys) {
+    ss << key << " " << cache.algos[key] << "\n";
+  }
+  ss << "\n";
+  const auto& local_str = ss.str();
+  std::vector<char> local(local_str.begin(), local_str.end());
+  int local_size = local.size();
+  std::vector<int> counts(comm.get_procs_in_world());
+  comm.all_gather(local_size, counts, comm.get_world_comm());
+  std::vector<int> displs(counts.size(), 0);
+  for (size_t i = 1; i < counts.size(); ++i) {
+    displs[i] = displs[i-1] + counts[i-1];
+  }
+  std::vector<char> global(displs.back() + counts.back());
+  comm.all_gather(local, global, counts, displs, comm.get_world_comm());
+  cache.new_keys.clear();
+  if (!comm.am_world_master()) { return; }
+
+  // Write the merged cache to a temporary file and move it into
+  // place, so an interrupted write cannot corrupt the cache
+  const auto num_loaded = cache.algos.size();
+  parse_algorithm_cache(std::string(global.begin(), global.end()));
+  std::vector<std::pair<std::string,int>> entries(cache.algos.begin(),
+                                                  cache.algos.end());
+  std::sort(entries.begin(), entries.end());
+  const auto tmp_path = cache.path + ".tmp";
+  {
+    std::ofstream out(tmp_path);
+    if (!out) {
+      LBANN_WARNING("could not write cuDNN algorithm cache to ", tmp_path);
+      return;
+    }
+    out << "# cuDNN convolution algorithms (key algorithm)\n";
+    for (const auto& e : entries) {
+      out << e.first << " " << e.second << "\n";
+    }
+  }
+  if (std::rename(tmp_path.c_str(), cache.path.c_str()) != 0) {
+    LBANN_WARNING("could not move cuDNN algorithm cache to ", cache.path);
+    return;
+  }
+  std::cout << "saved " << entries.size() << " cuDNN convolution algorithms "
+            << "(" << entries.size() - num_loaded << " new) to "
+            << cache.path << std::endl;
+}
+
 cudnnConvolutionFwdAlgo_t get_fwd_algorithm(
   bool autotune,
   bool deterministic,
@@ -815,16 +1190,24 @@ cudnnConvolutionFwdAlgo_t get_fwd_algorithm(
   const void* kernel,
   const cudnnConvolutionDescriptor_t& conv_desc,
   const cudnnTensorDescriptor_t& output_desc,
-  void* output,
-  size_t ws_size,
-  void* ws) {
+  void* output) {
+  const size_t ws_size = get_autotune_workspace_limit();
   if (autotune) {
-    return get_fwd_algo_autotune(deterministic,
-                                 input_desc, input,
-                                 kernel_desc, kernel,
-                                 conv_desc,
-                                 output_desc, output,
-                                 ws_size, ws);
+    const auto key = get_algorithm_key("fwd", deterministic, ws_size,
+                                       input_desc, kernel_desc, conv_desc,
+                                       output_desc);
+    int algo;
+    if (!find_cached_algorithm(key, algo)) {
+      autotune_workspace ws(ws_size);
+      algo = get_fwd_algo_autotune(deterministic,
+                                   input_desc, input,
+                                   kernel_desc, kernel,
+                                   conv_desc,
+                                   output_desc, output,
+                                   ws.size, ws.buffer);
+      add_cached_algorithm(key, algo);
+    }
+    return static_cast<cudnnConvolutionFwdAlgo_t>(algo);
   } else {
     return get_fwd_algo_heuristic(deterministic, input_desc, kernel_desc,
                                   conv_desc, output_desc, ws_size);
@@ -840,16 +1223,24 @@ cudnnConvolutionBwdDataAlgo_t get_bwd_data_algorithm(
   const void* prev_error_signal,
   const cudnnConvolutionDescriptor_t& conv_desc,
   const cudnnTensorDescriptor_t& error_signal_desc,
-  void* error_signal,
-  size_t ws_size,
-  void* ws) {
+  void* error_signal) {
+  const size_t ws_size = get_autotune_workspace_limit();
   if (autotune) {
-    return get_bwd_data_algo_autotune(deterministic,
-                                      kernel_desc, kernel,
-                                      prev_error_signal_desc, prev_error_signal,
-                                      conv_desc,
-                                      error_signal_desc, error_signal,
-                                      ws_size, ws);
+    const auto key = get_algorithm_key("bwd_data", deterministic, ws_size,
+                                       error_signal_desc, kernel_desc,
+                                       conv_desc, prev_error_signal_desc);
+    int algo;
+    if (!find_cached_algorithm(key, algo)) {
+      autotune_workspace ws(ws_size);
+      algo = get_bwd_data_algo_autotune(deterministic,
+                                        kernel_desc, kernel,
+                                        prev_error_signal_desc, prev_error_signal,
+                                        conv_desc,
+                                        error_signal_desc, error_signal,
+                                        ws.size, ws.buffer);
+      add_cached_algorithm(key, algo);
+    }
+    return static_cast<cudnnConvolutionBwdDataAlgo_t>(algo);
   } else {
     return get_bwd_data_algo_heuristic(deterministic, kernel_desc,
                                        prev_error_signal_desc, conv_desc,
@@ -866,16 +1257,24 @@ cudnnConvolutionBwdFilterAlgo_t get_bwd_filter_algorithm(
   const void* prev_error_signal,
   const cudnnConvolutionDescriptor_t& conv_desc,
   const cudnnFilterDescriptor_t& kernel_gradient_desc,
-  void* kernel_gradient,
-  size_t ws_size,
-  void* ws) {
+  void* kernel_gradient) {
+  const size_t ws_size = get_autotune_workspace_limit();
   if (autotune) {
-    return get_bwd_filter_algo_autotune(deterministic,
-                                        input_desc, input,
-                                        prev_error_signal_desc, prev_error_signal,
-                                        conv_desc,
-                                        kernel_gradient_desc, kernel_gradient,
-                                        ws_size, ws);
+    const auto key = get_algorithm_key("bwd_filter", deterministic, ws_size,
+                                       input_desc, kernel_gradient_desc,
+                                       conv_desc, prev_error_signal_desc);
+    int algo;
+    if (!find_cached_algorithm(key, algo)) {
+      autotune_workspace ws(ws_size);
+      algo = get_bwd_filter_algo_autotune(deterministic,
+                                          input_desc, input,
+                                          prev_error_signal_desc, prev_error_signal,
+                                          conv_desc,
+                                          kernel_gradient_desc, kernel_gradient,
+                                          ws.size, ws.buffer);
+      add_cached_algorithm(key, algo);
+    }
+    return static_cast<cudnnConvolutionBwdFilterAlgo_t>(algo);
   } else {
     return get_bwd_filter_algo_heuristic(deterministic, input_desc,
                                          prev_error_signal_desc, conv_desc,
@@ -887,6 +1286,11 @@ namespace {
 cudnnMathType_t default_tensor_ops_mode = CUDNN_DEFAULT_MATH;
 }
 
+deterministic_overhead get_deterministic_overhead() {
+  std::lock_guard<std::mutex> lock(overhead_mutex);
+  return overhead;
+}
+
 void default_to_tensor_ops() noexcept
 {
   default_tensor_ops_mode = CUDNN_TENSOR_OP_MATH_ALLOW_CONVERSION;
@@ -909,6 +1313,7 @@ cudnnMathType_t get_default_convolution_math_type() noexcept
 #include "lbann/macros/instantiate.hpp"
 
 } // namespace cudnn
+
 } // namespace lbann
 
 #endif // LBANN_HAS_CUDNN
@@ -54,6 +54,9 @@ HaloExchangeMethod opt_halo_exchange = HaloExchangeMethod::AL;
 ShuffleMethod opt_tensor_shuffler = ShuffleMethod::AL;
 #endif // DISTCONV_HAS_P2P
 int opt_rank_stride = 1;
+// Compute the interior of convolutions while halos are exchanged and
+// the boundary once they arrive
+bool opt_overlap_halo_exchange = false;
 bool opt_evaluate_performance = false;
 std::string opt_convolution_fwd_algorithm("DEFAULT");
 std::string opt_convolution_bwd_data_algorithm("DEFAULT");
@@ -63,7 +66,9 @@ std::string opt_synthetic_data_reader_randgen("MINSTD");
 int opt_num_pre_generated_synthetic_data = 0;
 bool opt_deterministic = false;
 int opt_num_io_partitions = 1;
-bool opt_cosmoflow_parallel_io = false;
+// Input layers skip the sample-to-spatial shuffle since readers read
+// their own sub-volumes (formerly CosmoFlow parallel I/O)
+bool opt_spatial_parallel_io = false;
 
 void set_options() {
   if (options_set) return;
@@ -80,6 +85,9 @@ void set_options() {
   if (env) {
     opt_rank_stride = std::atoi(env);
   }
+  if (std::getenv("LBANN_DISTCONV_OVERLAP_HALO_EXCHANGE")) {
+    opt_overlap_halo_exchange = true;
+  }
   if (std::getenv("LBANN_DISTCONV_EVALUATE_PERFORMANCE")) {
     opt_evaluate_performance = true;
   }
@@ -111,9 +119,14 @@ void set_options() {
   if (env) {
     opt_num_io_partitions = std::atoi(env);
   }
+  env = getenv("LBANN_DISTCONV_SPATIAL_PARALLEL_IO");
+  if (env) {
+    opt_spatial_parallel_io = true;
+  }
+  // Deprecated name
   env = getenv("LBANN_DISTCONV_COSMOFLOW_PARALLEL_IO");
   if (env) {
-    opt_cosmoflow_parallel_io = true;
+    opt_spatial_parallel_io = true;
   }
   options_set = true;
 }
@@ -125,6 +138,7 @@ void print_options(std::ostream &os) {
     ss << "  halo_exchange:" << opt_halo_exchange << "\n";
     ss << "  tensor_shuffler:" << opt_tensor_shuffler << "\n";
     ss << "  rank_stride:" << opt_rank_stride << "\n";
+    ss << "  overlap_halo_exchange: " << opt_overlap_halo_exchange << "\n";
     ss << "  evaluate_performance: "
        << opt_evaluate_performance << "\n";
     ss << "  convolution_fwd_algorithm: "
@@ -148,8 +162,8 @@ void print_options(std::ostream &os) {
     ss << "  num_io_partitions: "
        << opt_num_io_partitions
        << std::endl;
-    ss << "  cosmoflow_parallel_io: "
-       << opt_cosmoflow_parallel_io
+    ss << "  spatial_parallel_io: "
+       << opt_spatial_parallel_io
        << std::endl;
     os << ss.str();
   }
@@ -292,10 +306,18 @@ void initialize(MPI_Comm comm) {
       mpi_comm, El::GPUManager::Stream());
   ::distconv::cudnn::Options backend_opts;
   backend_opts.m_deterministic = opt_deterministic;
+  backend_opts.m_overlap_halo_exchange = opt_overlap_halo_exchange;
   backend_instance = new Backend(
       mpi_comm, lbann::cudnn::get_handle(),
       El::GPUManager::Stream(), backend_opts);
   print_options(std::cout);
+  if (opt_overlap_halo_exchange
+      && opt_halo_exchange == HaloExchangeMethod::MPI
+      && is_mpi_root()) {
+    LBANN_WARNING("LBANN_DISTCONV_OVERLAP_HALO_EXCHANGE has little effect "
+                  "with MPI halo exchanges, which block the host; "
+                  "use AL, P2P or HYBRID");
+  }
   initialized = true;
 }
 
@@ -368,8 +390,16 @@ int get_number_of_io_partitions() {
   return opt_num_io_partitions;
 }
 
+bool is_spatial_parallel_io_enabled() {
+  return opt_spatial_parallel_io;
+}
+
 bool is_cosmoflow_parallel_io_enabled() {
-  return opt_cosmoflow_parallel_io;
+  return is_spatial_parallel_io_enabled();
+}
+
+int get_io_partition_index(const lbann_comm &comm) {
+  return get_input_rank(comm) % get_number_of_io_partitions();
 }
 
 Al::mpicuda_backend::comm_type &get_mpicuda() {
@@ -417,7 +447,7 @@ TensorShuffler<TensorDataType> *get_tensor_shuffler(const TensorDev<TensorDataTy
 }
 
 MPI_Comm get_input_comm(const lbann_comm &comm) {
-  if (!is_cosmoflow_parallel_io_enabled() || get_rank_stride() == 1) {
+  if (!is_spatial_parallel_io_enabled() || get_rank_stride() == 1) {
     return comm.get_trainer_comm().GetMPIComm();
   } else {
     return get_mpi_comm();
@@ -425,7 +455,7 @@ MPI_Comm get_input_comm(const lbann_comm &comm) {
 }
 
 int get_input_rank(const lbann_comm &comm) {
-  if (!is_cosmoflow_parallel_io_enabled() || get_rank_stride() == 1) {
+  if (!is_spatial_parallel_io_enabled() || get_rank_stride() == 1) {
     return comm.get_rank_in_trainer();
   } else {
     return get_mpi_rank();
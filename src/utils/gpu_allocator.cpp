@@ -0,0 +1,280 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/utils/gpu_allocator.hpp"
+
+#ifdef LBANN_HAS_GPU
+
+#include "lbann/utils/cuda.hpp"
+#include "lbann/utils/exception.hpp"
+#include "lbann/utils/options.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace lbann {
+namespace cuda {
+
+caching_allocator& caching_allocator::instance() {
+  static caching_allocator alloc;
+  return alloc;
+}
+
+bool caching_allocator::enabled() {
+  static const bool use_allocator
+    = options::get()->get_bool("gpu_caching_allocator");
+  return use_allocator;
+}
+
+caching_allocator::caching_allocator() {
+  auto* opts = options::get();
+  if (opts->has_int("gpu_arena_mb") && opts->get_int("gpu_arena_mb") > 0) {
+    reserve(size_t(opts->get_int("gpu_arena_mb")) << 20);
+  }
+}
+
+caching_allocator::~caching_allocator() {
+  // The CUDA runtime may already be shutting down, so errors are
+  // ignored
+  for (auto& stream_list : m_free) {
+    for (auto& size_list : stream_list.second) {
+      for (auto& b : size_list.second) {
+        if (!b.in_arena) { cudaFree(b.ptr); }
+        if (b.freed != nullptr) { cudaEventDestroy(b.freed); }
+      }
+    }
+  }
+  for (auto& entry : m_live) {
+    const auto& b = entry.second;
+    if (!b.in_arena) { cudaFree(b.ptr); }
+    if (b.freed != nullptr) { cudaEventDestroy(b.freed); }
+  }
+  if (m_arena != nullptr) { cudaFree(m_arena); }
+}
+
+size_t caching_allocator::round_up(size_t bytes) noexcept {
+  constexpr size_t min_size = 512;
+  constexpr size_t fine_size = size_t(1) << 20;
+  size_t size = min_size;
+  while (size < bytes) { size *= 2; }
+  if (size <= fine_size) { return size; }
+  // Quarter steps between size/2 and size
+  const size_t step = size / 8;
+  return (bytes + step - 1) / step * step;
+}
+
+void* caching_allocator::allocate(size_t bytes, cudaStream_t stream) {
+  if (bytes == 0) { return nullptr; }
+  const auto size = round_up(bytes);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  block b;
+  if (take_cached(size, stream, b)) {
+    m_stats.cached_bytes -= size;
+    ++m_stats.num_reuses;
+  }
+  else {
+    b.ptr = allocate_new(size, b.in_arena);
+    b.size = size;
+  }
+  b.requested = bytes;
+  b.stream = stream;
+  m_live[b.ptr] = b;
+  m_stats.live_bytes += size;
+  m_stats.requested_bytes += bytes;
+  m_stats.peak_live_bytes = std::max(m_stats.peak_live_bytes,
+                                     m_stats.live_bytes);
+  ++m_stats.num_allocations;
+  return b.ptr;
+}
+
+void caching_allocator::deallocate(void* ptr) {
+  if (ptr == nullptr) { return; }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_live.find(ptr);
+  if (it == m_live.end()) {
+    LBANN_ERROR("attempted to free GPU memory at ", ptr,
+                ", which the caching allocator did not allocate");
+  }
+  auto b = it->second;
+  m_live.erase(it);
+  m_stats.live_bytes -= b.size;
+  m_stats.requested_bytes -= b.requested;
+
+  // Other streams can reuse the block once this event is done
+  if (b.freed == nullptr) {
+    CHECK_CUDA(cudaEventCreateWithFlags(&b.freed, cudaEventDisableTiming));
+  }
+  CHECK_CUDA(cudaEventRecord(b.freed, b.stream));
+  m_free[b.stream][b.size].push_back(b);
+  m_stats.cached_bytes += b.size;
+}
+
+bool caching_allocator::take_cached(size_t size,
+                                    cudaStream_t stream,
+                                    block& b) {
+
+  // Blocks freed on this stream can be used right away
+  auto& own_list = m_free[stream];
+  auto own_it = own_list.find(size);
+  if (own_it != own_list.end() && !own_it->second.empty()) {
+    b = own_it->second.back();
+    own_it->second.pop_back();
+    return true;
+  }
+
+  // Blocks freed on other streams must wait for their event
+  for (auto& stream_list : m_free) {
+    if (stream_list.first == stream) { continue; }
+    auto it = stream_list.second.find(size);
+    if (it == stream_list.second.end()) { continue; }
+    auto& blocks = it->second;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      const auto status = cudaEventQuery(blocks[i].freed);
+      if (status == cudaErrorNotReady) { continue; }
+      CHECK_CUDA(status);
+      b = blocks[i];
+      blocks[i] = blocks.back();
+      blocks.pop_back();
+      return true;
+    }
+  }
+  return false;
+
+}
+
+void* caching_allocator::allocate_new(size_t size, bool& in_arena) {
+
+  // Carve the block from the arena if it fits
+  if (m_arena != nullptr && m_arena_used + size <= m_stats.reserved_bytes) {
+    in_arena = true;
+    void* ptr = m_arena + m_arena_used;
+    m_arena_used += size;
+    return ptr;
+  }
+  in_arena = false;
+
+  // Release the cache and try again if the device is full
+  CHECK_CUDA(cudaSetDevice(El::GPUManager::Device()));
+  void* ptr = nullptr;
+  auto status = cudaMalloc(&ptr, size);
+  if (status == cudaErrorMemoryAllocation) {
+    cudaGetLastError();
+    release_cached_locked();
+    status = cudaMalloc(&ptr, size);
+  }
+  if (status != cudaSuccess) {
+    cudaGetLastError();
+    LBANN_ERROR("could not allocate ", size, " B of GPU memory "
+                "(", cudaGetErrorString(status), "); the caching "
+                "allocator holds ", m_stats.live_bytes, " B in use and ",
+                m_stats.cached_bytes, " B cached");
+  }
+  ++m_stats.num_mallocs;
+  return ptr;
+
+}
+
+void caching_allocator::reserve(size_t bytes) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_arena != nullptr || bytes == 0) { return; }
+  bytes = (bytes + 511) / 512 * 512;
+  CHECK_CUDA(cudaSetDevice(El::GPUManager::Device()));
+  void* ptr = nullptr;
+  CHECK_CUDA(cudaMalloc(&ptr, bytes));
+  m_arena = static_cast<char*>(ptr);
+  m_arena_used = 0;
+  m_stats.reserved_bytes = bytes;
+  ++m_stats.num_mallocs;
+}
+
+void caching_allocator::release_cached() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  release_cached_locked();
+}
+
+void caching_allocator::release_cached_locked() {
+  // cudaFree synchronizes the device, so pending work on the blocks
+  // is done. Arena blocks stay cached.
+  for (auto& stream_list : m_free) {
+    for (auto& size_list : stream_list.second) {
+      auto& blocks = size_list.second;
+      std::vector<block> kept;
+      for (auto& b : blocks) {
+        if (b.in_arena) {
+          kept.push_back(b);
+          continue;
+        }
+        CHECK_CUDA(cudaFree(b.ptr));
+        CHECK_CUDA(cudaEventDestroy(b.freed));
+        m_stats.cached_bytes -= b.size;
+        ++m_stats.num_frees;
+      }
+      blocks = std::move(kept);
+    }
+  }
+}
+
+allocator_statistics caching_allocator::get_statistics() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+cached_buffer::cached_buffer(cached_buffer&& other) noexcept
+  : m_ptr(other.m_ptr), m_capacity(other.m_capacity) {
+  other.m_ptr = nullptr;
+  other.m_capacity = 0;
+}
+
+cached_buffer& cached_buffer::operator=(cached_buffer&& other) noexcept {
+  if (this != &other) {
+    reset();
+    std::swap(m_ptr, other.m_ptr);
+    std::swap(m_capacity, other.m_capacity);
+  }
+  return *this;
+}
+
+void* cached_buffer::reserve(size_t bytes, cudaStream_t stream) {
+  if (bytes > m_capacity) {
+    reset();
+    m_ptr = caching_allocator::instance().allocate(bytes, stream);
+    m_capacity = caching_allocator::round_up(bytes);
+  }
+  return m_ptr;
+}
+
+void cached_buffer::reset() {
+  if (m_ptr != nullptr) {
+    caching_allocator::instance().deallocate(m_ptr);
+    m_ptr = nullptr;
+    m_capacity = 0;
+  }
+}
+
+} // namespace cuda
+} // namespace lbann
+
+#endif // LBANN_HAS_GPU
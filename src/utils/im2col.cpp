@@ -28,6 +28,8 @@
 #include "lbann/utils/im2col.hpp"
 #include "lbann/utils/exception.hpp"
 
+#include <algorithm>
+
 namespace lbann {
 
 template <typename TensorDataType>
@@ -452,6 +454,80 @@ void im2col_2d(const TensorDataType *__restrict__ input_buffer,
 
 }
 
+template <typename TensorDataType>
+void im2col_2d_block(const TensorDataType *__restrict__ input_buffer,
+                     TensorDataType *__restrict__ output_buffer,
+                     const int input_dim_x,
+                     const int input_dim_y,
+                     const int input_pad_x,
+                     const int input_pad_y,
+                     const int num_channels,
+                     const int window_dim_x,
+                     const int window_dim_y,
+                     const int offset_stride_x,
+                     const int offset_stride_y,
+                     const int first_offset,
+                     const int num_offsets) {
+
+  // im2col parameters
+  const int offset_start_x = -input_pad_x;
+  const int offset_start_y = -input_pad_y;
+  const int offset_end_x = input_dim_x + input_pad_x - window_dim_x + 1;
+  const int offset_num_x = (offset_end_x - offset_start_x + offset_stride_x - 1) / offset_stride_x;
+  const int output_height = num_channels * window_dim_x * window_dim_y;
+
+  // Iterate through output matrix columns
+  // Note: Each window row is contiguous in both the input and output
+  // buffers, so the valid range is copied with a vectorizable loop
+  // and only the padded edges are handled separately.
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE3
+  for(int col = 0; col < num_offsets; ++col) {
+    for(int channel = 0; channel < num_channels; ++channel) {
+      for(int window_pos_y = 0; window_pos_y < window_dim_y; ++window_pos_y) {
+        const int offset = first_offset + col;
+        const int offset_pos_x = offset_start_x + (offset % offset_num_x) * offset_stride_x;
+        const int offset_pos_y = offset_start_y + (offset / offset_num_x) * offset_stride_y;
+        const int input_pos_y = offset_pos_y + window_pos_y;
+        TensorDataType *__restrict__ output_row
+          = &output_buffer[(window_pos_y * window_dim_x
+                            + channel * window_dim_x * window_dim_y)
+                           + col * output_height];
+        if(input_pos_y < 0 || input_pos_y >= input_dim_y) {
+          std::fill(output_row, output_row + window_dim_x, TensorDataType(0.));
+          continue;
+        }
+        const TensorDataType *__restrict__ input_row
+          = &input_buffer[input_pos_y * input_dim_x
+                          + channel * input_dim_x * input_dim_y];
+        const int window_begin = std::min(std::max(-offset_pos_x, 0), window_dim_x);
+        const int window_end = std::max(std::min(input_dim_x - offset_pos_x, window_dim_x),
+                                        window_begin);
+        for(int window_pos_x = 0; window_pos_x < window_begin; ++window_pos_x) {
+          output_row[window_pos_x] = TensorDataType(0.);
+        }
+        for(int window_pos_x = window_begin; window_pos_x < window_end; ++window_pos_x) {
+          output_row[window_pos_x] = input_row[offset_pos_x + window_pos_x];
+        }
+        for(int window_pos_x = window_end; window_pos_x < window_dim_x; ++window_pos_x) {
+          output_row[window_pos_x] = TensorDataType(0.);
+        }
+      }
+    }
+  }
+
+}
+
+int get_im2col_block_size(const int col_height,
+                          const int col_width,
+                          const size_t type_size) {
+  constexpr size_t block_bytes = 256 * 1024;
+  constexpr int block_align = 16;
+  const int max_cols = block_bytes / (col_height * type_size);
+  int block_size = (max_cols / block_align) * block_align;
+  block_size = std::max(block_size, block_align);
+  return std::min(block_size, col_width);
+}
+
 template <typename TensorDataType>
 void col2im_1x1(const TensorDataType * input_buffer,
                 TensorDataType * output_buffer,
@@ -572,6 +648,9 @@ void col2im_2d(const TensorDataType *__restrict__ input_buffer,
     const T*, T*, int, int, const int*);                            \
   template void im2col_2d(                                          \
     const T*, T*, int, int, int, int, int, int, int, int, int);     \
+  template void im2col_2d_block(                                    \
+    const T*, T*, int, int, int, int, int, int, int, int, int,      \
+    int, int);                                                      \
   template void col2im_1x1(                                         \
     const T*, T*, int, int, const int*);                            \
   template void col2im_2d(                                          \
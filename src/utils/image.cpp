@@ -29,6 +29,7 @@
 #include <opencv2/imgcodecs.hpp>
 #include "lbann/utils/image.hpp"
 #include "lbann/utils/exception.hpp"
+#include "lbann/utils/io_profile.hpp"
 #include "lbann/utils/opencv.hpp"
 
 namespace lbann {
@@ -187,12 +188,17 @@ void load_image(const std::string& filename, El::Matrix<uint8_t>& dst,
   // Load the encoded image.
   El::Matrix<uint8_t> buf;
   size_t encoded_size;
-  read_file_to_buf(filename, buf, encoded_size);
+  {
+    io_profile::scope profile(io_profile::stage::read);
+    read_file_to_buf(filename, buf, encoded_size);
+  }
+  io_profile::scope profile(io_profile::stage::decode);
   opencv_decode(buf, dst, dims, filename);
 }
 
 void decode_image(El::Matrix<uint8_t>& src, El::Matrix<uint8_t>& dst,
                   std::vector<size_t>& dims) {
+  io_profile::scope profile(io_profile::stage::decode);
   opencv_decode(src, dst, dims, "encoded image");
 }
 
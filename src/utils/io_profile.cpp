@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/utils/io_profile.hpp"
+
+#include <memory>
+#include <mutex>
+
+namespace lbann {
+namespace io_profile {
+
+namespace details {
+std::atomic<bool> enabled(false);
+} // namespace details
+
+namespace {
+
+/** Counters of one thread. Only the owning thread writes. */
+struct counters {
+  std::atomic<uint64_t> busy_ns{0};
+  std::atomic<uint64_t> stage_ns[num_stages];
+  std::atomic<uint64_t> num_samples{0};
+  int depth[num_stages] = {};
+  counters() {
+    for (auto& t : stage_ns) { t.store(0, std::memory_order_relaxed); }
+  }
+};
+
+std::mutex registry_mutex;
+/** Never shrinks, so counters outlive their threads. */
+std::vector<std::unique_ptr<counters>>& registry() {
+  static std::vector<std::unique_ptr<counters>> r;
+  return r;
+}
+
+counters& local_counters() {
+  thread_local counters* c = nullptr;
+  if (c == nullptr) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry().emplace_back(new counters());
+    c = registry().back().get();
+  }
+  return *c;
+}
+
+inline void add(std::atomic<uint64_t>& counter, uint64_t value) {
+  counter.store(counter.load(std::memory_order_relaxed) + value,
+                std::memory_order_relaxed);
+}
+
+} // namespace
+
+namespace details {
+
+void add_stage_time(stage s, uint64_t ns) {
+  add(local_counters().stage_ns[static_cast<size_t>(s)], ns);
+}
+
+void add_busy_time(uint64_t ns) {
+  add(local_counters().busy_ns, ns);
+}
+
+int& stage_depth(stage s) {
+  return local_counters().depth[static_cast<size_t>(s)];
+}
+
+} // namespace details
+
+const char* to_string(stage s) {
+  switch (s) {
+  case stage::read:      return "read";
+  case stage::decode:    return "decode";
+  case stage::transform: return "transform";
+  default:               return "unknown";
+  }
+}
+
+void enable() {
+  details::enabled.store(true, std::memory_order_relaxed);
+}
+
+void disable() {
+  details::enabled.store(false, std::memory_order_relaxed);
+}
+
+void add_samples(size_t num_samples) {
+  if (enabled()) {
+    add(local_counters().num_samples, num_samples);
+  }
+}
+
+double thread_stats::other_time() const {
+  double t = busy_time;
+  for (const auto& s : stage_time) { t -= s; }
+  return t > 0 ? t : 0;
+}
+
+std::vector<thread_stats> snapshot() {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  std::vector<thread_stats> stats;
+  stats.reserve(registry().size());
+  for (const auto& c : registry()) {
+    thread_stats s;
+    s.busy_time = c->busy_ns.load(std::memory_order_relaxed) * 1e-9;
+    for (size_t i = 0; i < num_stages; ++i) {
+      s.stage_time[i] = c->stage_ns[i].load(std::memory_order_relaxed) * 1e-9;
+    }
+    s.num_samples = c->num_samples.load(std::memory_order_relaxed);
+    stats.push_back(s);
+  }
+  return stats;
+}
+
+} // namespace io_profile
+} // namespace lbann
@@ -27,17 +27,27 @@
 #include "lbann/utils/lbann_library.hpp"
 
 #include "lbann/proto/factories.hpp"
+#include "lbann/trainers/trainer.hpp"
+#include "lbann/utils/cudnn.hpp"
+#include "lbann/utils/determinism.hpp"
 #include "lbann/utils/omp_diagnostics.hpp"
 #include "lbann/utils/threads/thread_utils.hpp"
+#include "lbann/utils/timer.hpp"
 #include "lbann/callbacks/callback.hpp"
 #include "lbann/callbacks/checkpoint.hpp"
 #include "lbann/callbacks/dump_weights.hpp"
+#include "lbann/callbacks/elastic_resize.hpp"
 #include "lbann/callbacks/save_model.hpp"
 #include "lbann/callbacks/load_model.hpp"
+#include "lbann/weights/data_type_weights.hpp"
 
 #include <lbann.pb.h>
 #include <model.pb.h>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 namespace lbann {
 
 /// Construct a trainer that contains a lbann comm object and threadpool
@@ -55,7 +65,25 @@ std::unique_ptr<trainer> construct_trainer(lbann_comm *comm,
     }
 
     // Set up the communicator and split the grid if necessary
+    if (opts->has_string("trainer_placement")) {
+      const auto placement = opts->get_string("trainer_placement");
+      if (placement == "topology") {
+        comm->set_trainer_placement(trainer_placement::topology);
+      } else if (placement == "contiguous") {
+        comm->set_trainer_placement(trainer_placement::contiguous);
+      } else {
+        LBANN_ERROR("invalid trainer placement \"", placement, "\" ",
+                    "(expected \"contiguous\" or \"topology\")");
+      }
+    }
     comm->split_trainers(procs_per_trainer);
+    if (opts->get_bool("hierarchical_allreduce")) {
+      comm->set_allreduce_algorithm(
+        allreduce_algorithm::hierarchical,
+        opts->get_int("hierarchical_allreduce_min_bytes", 1 << 20));
+    }
+    const bool deterministic = deterministic_mode();
+    comm->set_deterministic_reductions(deterministic);
     if (pb_trainer->num_parallel_readers() > procs_per_trainer) {
       pb_trainer->set_num_parallel_readers(procs_per_trainer);
     }
@@ -82,6 +110,10 @@ std::unique_ptr<trainer> construct_trainer(lbann_comm *comm,
     if (procs_per_trainer != comm->get_procs_per_trainer()) {
       comm->split_trainers(procs_per_trainer);
     }
+    const auto placement_report = comm->describe_trainer_placement();
+    if (comm->am_world_master()) {
+      std::cout << "Trainer placement: " << placement_report << std::endl;
+    }
 
     // Display how the OpenMP threads are provisioned
     // if (opts->has_string("print_affinity")) {
@@ -147,35 +179,32 @@ std::unique_ptr<trainer> construct_trainer(lbann_comm *comm,
     }
 
     // Initialize models differently if needed.
-#ifndef LBANN_DETERMINISTIC
     if (!pb_trainer->random_init_trainers_identically()) {
-      hash_combine(random_seed, comm->get_trainer_rank());
-      // Reseed here so that setup is done with this new seed.
-      init_random(random_seed);
-      init_data_seq_random(random_seed);
-    }
-#else
-    if (!pb_trainer->random_init_trainers_identically()) {
-      if(comm->am_trainer_master()) {
+      if (!deterministic) {
+        hash_combine(random_seed, comm->get_trainer_rank());
+        // Reseed here so that setup is done with this new seed.
+        init_random(random_seed);
+        init_data_seq_random(random_seed);
+      } else if (comm->am_trainer_master()) {
         std::cout << "WARNING: forcing 'random_init_trainers_identically' " <<
           "due to sequential consistency" << std::endl;
       }
     }
-#endif
 
-#ifndef LBANN_DETERMINISTIC
-    // Under normal conditions, reinitialize the random number generator so
-    // that regularization techniques (e.g. dropout) generate unique patterns
-    // on different ranks.
-    init_random(random_seed + comm->get_rank_in_world());
-#else
-    if(comm->am_world_master()) {
+    if (!deterministic) {
+      // Under normal conditions, reinitialize the random number generator so
+      // that regularization techniques (e.g. dropout) generate unique patterns
+      // on different ranks.
+      init_random(random_seed + comm->get_rank_in_world());
+    } else if (comm->am_world_master()) {
+      // Every rank keeps the same seed, so the counter-based RNG gives
+      // the same values for the same global entries on any grid.
       std::cout <<
         "--------------------------------------------------------------------------------\n"
-        "ALERT: executing in sequentially consistent mode -- performance will suffer\n"
+        "ALERT: executing in sequentially consistent mode with fixed-order\n"
+        "       reductions and deterministic cuDNN algorithms\n"
         "--------------------------------------------------------------------------------\n";
     }
-#endif
 
     trainer->setup(std::move(io_thread_pool));
 
@@ -215,6 +244,33 @@ std::unique_ptr<thread_pool> construct_io_thread_pool(lbann_comm *comm, options
     }
   }
 
+  auto io_thread_pool = make_unique<thread_pool>();
+
+  // Give compute and I/O threads their own cores
+  if (opts->get_bool("partition_cores")) {
+    int requested_io_threads = num_io_threads;
+    if (opts->has_int("num_io_threads")
+        && opts->get_int("num_io_threads") > 0) {
+      requested_io_threads = opts->get_int("num_io_threads");
+    }
+    const auto cores = partition_process_cores(requested_io_threads);
+    if (!cores.io_cpus.empty()) {
+      pin_omp_threads(*comm, cores.compute_cpus);
+      if(comm->am_world_master()) {
+        std::cout << "\tNum. Compute Threads: " << cores.compute_cpus.size()
+                  << ", Num. I/O Threads: " << cores.io_cpus.size()
+                  << " (Partitioned Cores)" << std::endl;
+      }
+      io_thread_pool->set_worker_omp_threads(1);
+      io_thread_pool->launch_threads_on_cpus(cores.io_cpus);
+      return io_thread_pool;
+    }
+    if(comm->am_world_master()) {
+      LBANN_WARNING("could not partition the cores of each process, "
+                    "so --partition_cores has no effect");
+    }
+  }
+
   auto io_threads_offset = free_core_offset(comm);
 
   if(comm->am_world_master()) {
@@ -222,7 +278,6 @@ std::unique_ptr<thread_pool> construct_io_thread_pool(lbann_comm *comm, options
       " (Limited to # Unused Compute Cores or 1)" << std::endl;
   }
 
-  auto io_thread_pool = make_unique<thread_pool>();
   io_thread_pool->launch_pinned_threads(num_io_threads, io_threads_offset);
 
   return io_thread_pool;
@@ -267,6 +322,13 @@ std::unique_ptr<model> build_model_from_prototext(
   // User feedback
   print_parameters(*comm, pb);
 
+#ifdef LBANN_HAS_CUDNN
+  // Reuse convolution algorithms tuned in previous runs
+  if (opts->has_string("cudnn_algo_cache")) {
+    cudnn::load_algorithm_cache(*comm, opts->get_string("cudnn_algo_cache"));
+  }
+#endif // LBANN_HAS_CUDNN
+
   // Initalize model
   std::unique_ptr<model> ret_model = proto::construct_model(comm,
                                                             training_dr_linearized_data_size,
@@ -353,6 +415,144 @@ std::unique_ptr<model> build_model_from_prototext(
   return ret_model;
 }
 
+std::unique_ptr<model> resize_trainer(
+  int procs_per_trainer,
+  std::unique_ptr<model> old_model,
+  trainer& t,
+  int argc, char **argv,
+  lbann_data::LbannPB &pb,
+  lbann_comm *comm,
+  options *opts,
+  int training_dr_linearized_data_size) {
+
+  const double start = get_time();
+
+  // Nothing may refer to the old grid once it is freed
+  for (auto mode : {execution_mode::training, execution_mode::validation,
+                    execution_mode::testing}) {
+    old_model->collect_background_data_fetch(mode);
+  }
+  callback::replicated_model_state state;
+  state.save(*old_model);
+  // Only used as the key of the old model's execution contexts
+  const observer_ptr<model> old_key = old_model.get();
+  old_model.reset();
+
+  // Regroup the processes and repartition the data
+  comm->split_trainers(procs_per_trainer);
+  t.get_data_coordinator().resize_trainer();
+
+  // Rebuild the model on the new grid
+  auto new_model = build_model_from_prototext(argc, argv, pb.mutable_trainer(), pb,
+                                              comm, opts, t.get_io_thread_pool(),
+                                              t.get_callbacks_with_ownership(),
+                                              training_dr_linearized_data_size);
+  DataReaderMetaData dr_metadata = t.get_data_coordinator().get_dr_metadata();
+  new_model->setup(t.get_max_mini_batch_size(), dr_metadata);
+  state.restore(*new_model);
+  t.transfer_execution_contexts(old_key, new_model.get());
+
+  if (comm->am_world_master()) {
+    std::cout << "resized to " << comm->get_num_trainers() << " trainers of "
+              << comm->get_procs_per_trainer() << " processes in "
+              << get_time() - start << " s" << std::endl;
+  }
+  return new_model;
+}
+
+std::shared_ptr<void> share_weights_on_node(model& m, lbann_comm& comm) {
+  if (comm.get_procs_per_trainer() != 1) {
+    LBANN_ERROR("node-shared weights require one process per trainer, ",
+                "but there are ", comm.get_procs_per_trainer());
+  }
+  const auto& node_comm = comm.get_node_comm();
+  const bool leader = comm.get_rank_in_node() == 0;
+
+  // Lay out the CPU weights of the model in the segment
+  constexpr size_t alignment = 64;
+  std::vector<data_type_weights<DataType>*> shared;
+  std::vector<size_t> offsets;
+  size_t seg_size = 0;
+  for (auto* w : m.get_weights()) {
+    auto* dtw = dynamic_cast<data_type_weights<DataType>*>(w);
+    if (dtw == nullptr) { continue; }
+    const auto& values = static_cast<const data_type_weights<DataType>&>(*dtw).get_values();
+    if (values.GetLocalDevice() != El::Device::CPU
+        || dynamic_cast<const El::ElementalMatrix<DataType>*>(&values) == nullptr) {
+      continue;
+    }
+    shared.push_back(dtw);
+    offsets.push_back(seg_size);
+    const size_t bytes = values.LocalHeight() * values.LocalWidth() * sizeof(DataType);
+    seg_size += (bytes + alignment - 1) / alignment * alignment;
+  }
+  if (comm.allreduce(seg_size, node_comm, El::mpi::MAX)
+      != comm.allreduce(seg_size, node_comm, El::mpi::MIN)) {
+    LBANN_ERROR("node-shared weights need the same model on every "
+                "process of the node");
+  }
+  if (seg_size == 0) {
+    return nullptr;
+  }
+
+  // The name must be unique across models and nodes
+  const int leader_rank = El::mpi::Translate(node_comm, 0, comm.get_world_comm());
+  const std::string seg_name = "/lbann_weights_" + m.get_name() + "_"
+                               + std::to_string(leader_rank);
+  if (leader) {
+    //in case a previous run was aborted
+    shm_unlink(seg_name.c_str());
+    const int fd = shm_open(seg_name.c_str(), O_CREAT | O_RDWR | O_EXCL, 0600);
+    if (fd == -1) {
+      LBANN_ERROR("shm_open failed for ", seg_name);
+    }
+    if (ftruncate(fd, seg_size) != 0) {
+      LBANN_ERROR("ftruncate failed for size: ", seg_size);
+    }
+    void* seg = mmap(nullptr, seg_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (seg == MAP_FAILED) {
+      LBANN_ERROR("mmap failed for ", seg_name);
+    }
+    for (size_t i = 0; i < shared.size(); ++i) {
+      const auto& values = static_cast<const data_type_weights<DataType>&>(*shared[i]).get_values();
+      El::Matrix<DataType> dst;
+      dst.Attach(values.LocalHeight(), values.LocalWidth(),
+                 reinterpret_cast<DataType*>(static_cast<char*>(seg) + offsets[i]),
+                 std::max(values.LocalHeight(), El::Int(1)));
+      El::Copy(values.LockedMatrix(), dst);
+    }
+    munmap(seg, seg_size);
+  }
+  comm.barrier(node_comm);
+
+  const int fd = shm_open(seg_name.c_str(), O_RDONLY, 0600);
+  if (fd == -1) {
+    LBANN_ERROR("shm_open failed for ", seg_name);
+  }
+  void* seg = mmap(nullptr, seg_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (seg == MAP_FAILED) {
+    LBANN_ERROR("mmap failed for ", seg_name);
+  }
+  comm.barrier(node_comm);
+  if (leader) {
+    shm_unlink(seg_name.c_str());
+  }
+
+  for (size_t i = 0; i < shared.size(); ++i) {
+    shared[i]->attach_values(
+      reinterpret_cast<DataType*>(static_cast<char*>(seg) + offsets[i]));
+  }
+  if (comm.am_world_master()) {
+    std::cout << "model \"" << m.get_name() << "\": sharing "
+              << shared.size() << " weights (" << seg_size / (1 << 20)
+              << " MB) between the " << comm.get_procs_per_node()
+              << " processes of each node" << std::endl;
+  }
+  return std::shared_ptr<void>(seg, [seg_size](void* p) { munmap(p, seg_size); });
+}
+
 void print_lbann_configuration(lbann_comm *comm, int io_threads_per_process, int io_threads_offset) {
   // Report hardware settings
   std::cout << "Hardware properties (for master process)" << std::endl
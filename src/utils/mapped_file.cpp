@@ -0,0 +1,65 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/utils/mapped_file.hpp"
+#include "lbann/utils/exception.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lbann {
+
+mapped_file::mapped_file(const std::string& filename) {
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LBANN_ERROR("failed to open ", filename, ": ", std::strerror(errno));
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    LBANN_ERROR("failed to stat ", filename, ": ", std::strerror(errno));
+  }
+  m_size = st.st_size;
+  if (m_size > 0) {
+    m_addr = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (m_addr == MAP_FAILED) {
+    LBANN_ERROR("failed to mmap ", filename, ": ", std::strerror(errno));
+  }
+}
+
+mapped_file::~mapped_file() {
+  if (m_addr != nullptr && m_addr != MAP_FAILED) {
+    munmap(m_addr, m_size);
+  }
+}
+
+} // namespace lbann
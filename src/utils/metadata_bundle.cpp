@@ -0,0 +1,155 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/utils/metadata_bundle.hpp"
+#include "lbann/utils/file_utils.hpp"
+#include "lbann/utils/options.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lbann {
+
+namespace {
+
+/** Marks cache files and their format version. */
+constexpr char cache_magic[8] = {'L','B','M','E','T','A','1','\0'};
+
+} // namespace
+
+metadata_bundle::key& metadata_bundle::key::add_bytes(const void* data,
+                                                      size_t size) {
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    m_hash ^= bytes[i];
+    m_hash *= 1099511628211ull;
+  }
+  return *this;
+}
+
+metadata_bundle::key& metadata_bundle::key::add(const std::string& str) {
+  add(static_cast<uint64_t>(str.size()));
+  return add_bytes(str.data(), str.size());
+}
+
+metadata_bundle::key& metadata_bundle::key::add_file(const std::string& path) {
+  add(path);
+  struct stat st;
+  if (stat(path.c_str(), &st) == 0) {
+    add(static_cast<int64_t>(st.st_size));
+    add(static_cast<int64_t>(st.st_mtime));
+  }
+  return *this;
+}
+
+void metadata_bundle::save(const std::string& path, uint64_t k) const {
+  // Write to a temporary file and rename, so concurrent writers and
+  // readers never see a partial file
+  const std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+  std::ofstream out(tmp_path.c_str(), std::ios::binary);
+  if (!out) {
+    LBANN_WARNING("could not write metadata cache file ", tmp_path);
+    return;
+  }
+  const uint64_t size = m_buffer.size();
+  out.write(cache_magic, sizeof(cache_magic));
+  out.write(reinterpret_cast<const char*>(&k), sizeof(k));
+  out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  out.write(m_buffer.data(), m_buffer.size());
+  out.close();
+  if (!out || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    LBANN_WARNING("could not write metadata cache file ", path);
+  }
+}
+
+bool metadata_bundle::load(const std::string& path, uint64_t k) {
+  std::ifstream in(path.c_str(), std::ios::binary);
+  if (!in) { return false; }
+  char magic[sizeof(cache_magic)];
+  uint64_t file_key = 0, size = 0;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char*>(&file_key), sizeof(file_key));
+  in.read(reinterpret_cast<char*>(&size), sizeof(size));
+  if (!in || std::memcmp(magic, cache_magic, sizeof(magic)) != 0
+      || file_key != k) {
+    return false;
+  }
+  std::vector<char> buffer(size);
+  in.read(buffer.data(), size);
+  if (!in) { return false; }
+  m_buffer = std::move(buffer);
+  m_read_pos = 0;
+  return true;
+}
+
+bool metadata_bundle::load_cached(lbann_comm& comm, const El::mpi::Comm& c,
+                                  const std::string& name, const key& k) {
+  auto* opts = options::get();
+  if (!opts->has_string("metadata_cache_dir")) { return false; }
+  const auto dir = opts->get_string("metadata_cache_dir");
+  std::ostringstream ss;
+  ss << dir << "/" << name << "_" << std::hex << std::setw(16)
+     << std::setfill('0') << k.value() << ".lbmeta";
+  m_cache_path = ss.str();
+  m_cache_key = k.value();
+
+  // Everyone must have the bundle, or it is shared again
+  int loaded = load(m_cache_path, m_cache_key) ? 1 : 0;
+  loaded = comm.allreduce(loaded, c, El::mpi::MIN);
+  if (!loaded) {
+    m_buffer.clear();
+    m_read_pos = 0;
+  }
+  return loaded != 0;
+}
+
+void metadata_bundle::share(lbann_comm& comm, const El::mpi::Comm& c,
+                            int root) {
+  uint64_t size = m_buffer.size();
+  comm.broadcast(root, size, c);
+  m_buffer.resize(size);
+  for (uint64_t offset = 0; offset < size; offset += INT_MAX) {
+    const int count = static_cast<int>(std::min(size - offset,
+                                                uint64_t(INT_MAX)));
+    comm.broadcast<char>(root, m_buffer.data() + offset, count, c);
+  }
+  m_read_pos = 0;
+
+  if (!m_cache_path.empty() && comm.get_rank_in_node() == 0) {
+    file::make_directory(file::extract_parent_directory(m_cache_path));
+    save(m_cache_path, m_cache_key);
+  }
+}
+
+} // namespace lbann
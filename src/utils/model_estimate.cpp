@@ -0,0 +1,302 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/utils/model_estimate.hpp"
+
+#include "lbann/callbacks/parallel_plan.hpp"
+#include "lbann/comm.hpp"
+#include "lbann/layers/layer.hpp"
+#include "lbann/models/model.hpp"
+#include "lbann/optimizers/optimizer.hpp"
+#include "lbann/utils/exception.hpp"
+#include "lbann/utils/parallel_plan.hpp"
+#include "lbann/weights/weights.hpp"
+
+#include <conduit/conduit.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+
+namespace lbann {
+
+namespace {
+
+namespace planner = ::lbann::parallel_plan;
+
+/** Rates measured by the benchmarks. */
+struct calibration {
+  /** Achieved FLOP/s of each layer type. */
+  std::map<std::string, double> flop_rates;
+  /** Allreduce bus bandwidth in bytes/s (0 if not measured). */
+  double bandwidth = 0.0;
+};
+
+/** JSON booleans are parsed as strings. */
+bool is_true(const conduit::Node& n) {
+  return (n.dtype().is_string() ? n.as_string() == "true"
+          : n.to_int64() != 0);
+}
+
+/** Read a JSON report written by the benchmarks. */
+calibration read_calibration(const std::string& filename, bool using_gpus) {
+  std::ifstream fs(filename);
+  if (!fs) {
+    LBANN_ERROR("could not open benchmark report ", filename);
+  }
+  std::stringstream text;
+  text << fs.rdbuf();
+  conduit::Node report;
+  try {
+    report.parse(text.str(), "json");
+  }
+  catch (conduit::Error const& e) {
+    LBANN_ERROR("could not parse benchmark report ", filename,
+                " (", e.message(), ")");
+  }
+  const std::string device = using_gpus ? "GPU" : "CPU";
+
+  // Mean rate of each layer type over the benchmark configurations,
+  // assuming back prop does twice the work of forward prop
+  calibration cal;
+  std::map<std::string, std::pair<double, int>> sums;
+  if (report.has_child("benchmarks")) {
+    const auto& benchmarks = report["benchmarks"];
+    for (conduit::index_t i = 0; i < benchmarks.number_of_children(); ++i) {
+      const auto& b = benchmarks.child(i);
+      if (b["device"].as_string() != device) { continue; }
+      const double fp = b["forward_prop"]["gflops"].to_double();
+      const double bp = b["backward_prop"]["gflops"].to_double();
+      if (fp <= 0 || bp <= 0) { continue; }
+      auto& sum = sums[b["layer_type"].as_string()];
+      sum.first += 3e9 / (1 / fp + 2 / bp);
+      sum.second += 1;
+    }
+  }
+  for (const auto& s : sums) {
+    cal.flop_rates[s.first] = s.second.first / s.second.second;
+  }
+
+  // Fastest allreduce
+  if (report.has_child("collectives")) {
+    const auto& collectives = report["collectives"];
+    for (conduit::index_t i = 0; i < collectives.number_of_children(); ++i) {
+      const auto& c = collectives.child(i);
+      if (c["operation"].as_string() != "allreduce"
+          || c["device"].as_string() != device
+          || !is_true(c["valid"])) {
+        continue;
+      }
+      cal.bandwidth = std::max(cal.bandwidth,
+                               1e9 * c["bus_gbytes_per_sec"].to_double());
+    }
+  }
+  return cal;
+}
+
+double product(const std::vector<int>& dims) {
+  return std::accumulate(dims.begin(), dims.end(), 1.0,
+                         std::multiplies<double>());
+}
+
+/** Entries of a tensor held by each process. */
+double local_entries(const std::vector<int>& dims,
+                     const planner::choice& c,
+                     const planner::machine& m) {
+  const double size = product(dims);
+  const double P = m.num_procs;
+  const double N = m.mini_batch_size;
+  if (c.layout == data_layout::MODEL_PARALLEL) {
+    return N * std::ceil(size / P);
+  }
+  const double sample_groups = std::max(P / c.spatial_groups, 1.0);
+  return std::ceil(N / sample_groups) * size / c.spatial_groups;
+}
+
+size_t memory_usage(const weights& w) {
+  size_t bytes = w.get_memory_usage(El::Device::CPU);
+#ifdef LBANN_HAS_GPU
+  bytes += w.get_memory_usage(El::Device::GPU);
+#endif // LBANN_HAS_GPU
+  return bytes;
+}
+
+size_t memory_usage(const optimizer& opt) {
+  size_t bytes = opt.get_memory_usage(El::Device::CPU);
+#ifdef LBANN_HAS_GPU
+  bytes += opt.get_memory_usage(El::Device::GPU);
+#endif // LBANN_HAS_GPU
+  return bytes;
+}
+
+std::string format_bytes(double bytes) {
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(1);
+  if (bytes >= 1024. * 1024. * 1024.) {
+    ss << bytes / (1024. * 1024. * 1024.) << " GiB";
+  } else {
+    ss << bytes / (1024. * 1024.) << " MiB";
+  }
+  return ss.str();
+}
+
+} // namespace
+
+model_estimate estimate_model(const model& m,
+                              int mini_batch_size,
+                              const std::string& calibration_file) {
+  const auto& comm = *m.get_comm();
+  const auto layers = m.get_layers();
+  const size_t num_layers = layers.size();
+  bool using_gpus = false;
+  for (const auto* l : layers) { using_gpus = using_gpus || l->using_gpus(); }
+
+  // Machine description, with the same defaults as the parallel_plan
+  // callback
+  planner::machine mach;
+  mach.num_procs = comm.get_procs_per_trainer();
+  mach.mini_batch_size = std::max(mini_batch_size, 1);
+  mach.entry_size = sizeof(DataType);
+  mach.flop_rate = using_gpus ? 1e13 : 1e11;
+  calibration cal;
+  if (!calibration_file.empty()) {
+    cal = read_calibration(calibration_file, using_gpus);
+    if (cal.bandwidth > 0) { mach.bandwidth = cal.bandwidth; }
+  }
+
+  // Layer descriptions. Calibrated layers scale their FLOPs so the
+  // cost model sees the measured rate.
+  std::unordered_map<const Layer*, size_t> index;
+  for (size_t i = 0; i < num_layers; ++i) { index[layers[i]] = i; }
+  std::vector<planner::layer_info> infos;
+  std::vector<double> flops(num_layers);
+  std::vector<bool> calibrated(num_layers, false);
+  infos.reserve(num_layers);
+  for (size_t i = 0; i < num_layers; ++i) {
+    const auto& l = *layers[i];
+    infos.push_back(callback::describe_layer_for_plan(l));
+    for (const auto* p : l.get_parent_layers()) {
+      infos.back().parents.push_back(index.at(p));
+    }
+    flops[i] = infos.back().flops * mach.mini_batch_size;
+    const auto it = cal.flop_rates.find(infos.back().type);
+    if (it != cal.flop_rates.end()) {
+      infos.back().flops *= mach.flop_rate / it->second;
+      calibrated[i] = true;
+    }
+  }
+  std::vector<planner::choice> choices;
+  for (const auto& info : infos) { choices.push_back(info.current); }
+  const auto p = planner::evaluate(infos, choices, mach);
+
+  model_estimate e;
+  e.model_name = m.get_name();
+  e.num_procs = mach.num_procs;
+  e.mini_batch_size = mach.mini_batch_size;
+  e.flop_rate = mach.flop_rate;
+  e.bandwidth = mach.bandwidth;
+  e.step_time = p.total;
+  std::set<const weights*> counted;
+  for (size_t i = 0; i < num_layers; ++i) {
+    const auto& l = *layers[i];
+    const auto& info = infos[i];
+    layer_estimate le;
+    le.name = info.name;
+    le.type = info.type;
+    le.flops = flops[i];
+    le.calibrated = calibrated[i];
+    le.compute_time = p.layer_costs[i].compute;
+    le.comm_time = p.layer_costs[i].comm + p.redistribution_costs[i];
+
+    // Outputs, and error signals if there are parents
+    le.activation_bytes = (local_entries(info.output_dims, info.current, mach)
+                           * mach.entry_size);
+    if (l.get_num_parents() > 0) {
+      le.activation_bytes += (local_entries(info.input_dims, info.current, mach)
+                              * mach.entry_size);
+    }
+
+    // Shared weights are counted with their first layer
+    for (const auto* w : extract_weights(l)) {
+      if (!counted.insert(w).second) { continue; }
+      le.weight_bytes += memory_usage(*w);
+      const auto* opt = w->get_optimizer();
+      if (opt != nullptr) { le.optimizer_bytes += memory_usage(*opt); }
+    }
+
+    le.comm_bytes = planner::layer_comm_bytes(info, info.current, mach);
+    for (const auto& j : info.parents) {
+      le.comm_bytes += planner::redistribution_bytes(infos[j], infos[j].current,
+                                                     info.current, mach);
+    }
+
+    e.flops += le.flops;
+    e.activation_bytes += le.activation_bytes;
+    e.weight_bytes += le.weight_bytes;
+    e.optimizer_bytes += le.optimizer_bytes;
+    e.comm_bytes += le.comm_bytes;
+    e.layers.push_back(std::move(le));
+  }
+  return e;
+}
+
+void print_model_estimate(const model_estimate& e, std::ostream& os) {
+  const std::string prefix = e.model_name + " estimate : ";
+  std::stringstream msg;
+  msg << std::scientific << std::setprecision(3);
+  msg << prefix << e.num_procs << " processes per trainer, mini-batch size "
+      << e.mini_batch_size << ", " << e.flop_rate << " FLOP/s and "
+      << e.bandwidth << " B/s per process\n";
+  for (const auto& l : e.layers) {
+    msg << prefix << l.name << " (" << l.type << ") : "
+        << l.flops << " FLOPs, "
+        << l.compute_time << "s compute"
+        << (l.calibrated ? " (calibrated), " : ", ")
+        << l.comm_time << "s comm, "
+        << format_bytes(l.comm_bytes) << " sent, "
+        << format_bytes(l.activation_bytes) << " activations, "
+        << format_bytes(l.weight_bytes + l.optimizer_bytes)
+        << " weights and optimizer\n";
+  }
+  msg << prefix << "step time " << e.step_time << "s, "
+      << e.flops << " FLOPs per step, "
+      << format_bytes(e.comm_bytes) << " sent per process per step\n";
+  msg << prefix << "memory per process " << format_bytes(e.memory_bytes())
+      << " (activations " << format_bytes(e.activation_bytes)
+      << ", weights " << format_bytes(e.weight_bytes)
+      << ", optimizer " << format_bytes(e.optimizer_bytes) << ")\n";
+  os << msg.str() << std::flush;
+}
+
+} // namespace lbann
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/utils/numa.hpp"
+#include "lbann/utils/exception.hpp"
+#include "lbann/utils/omp_pragma.hpp"
+#include "lbann/utils/options.hpp"
+
+#if defined(LBANN_TOPO_AWARE)
+#include <hwloc.h>
+#endif // LBANN_TOPO_AWARE
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+namespace lbann {
+namespace numa {
+
+namespace {
+
+/** Zero pages in the same static OpenMP schedule as compute loops. */
+void first_touch(unsigned char* ptr, size_t bytes) {
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  const size_t num_pages = (bytes + page_size - 1) / page_size;
+  LBANN_OMP_PARALLEL_FOR
+  for (size_t i = 0; i < num_pages; ++i) {
+    const size_t offset = i * page_size;
+    std::memset(ptr + offset, 0, std::min(page_size, bytes - offset));
+  }
+}
+
+#if defined(LBANN_TOPO_AWARE)
+/** Topology shared by all calls (loading it is slow). */
+hwloc_topology_t get_topology() {
+  static hwloc_topology_t topo;
+  static std::once_flag flag;
+  std::call_once(flag, [] {
+      hwloc_topology_init(&topo);
+      hwloc_topology_load(topo);
+    });
+  return topo;
+}
+#endif // LBANN_TOPO_AWARE
+
+} // namespace
+
+placement placement_from_string(const std::string& str) {
+  if (str == "none")        { return placement::none; }
+  if (str == "first_touch") { return placement::first_touch; }
+  if (str == "interleave")  { return placement::interleave; }
+  LBANN_ERROR("invalid NUMA placement \"", str, "\" "
+              "(expected none, first_touch or interleave)");
+  return placement::none;
+}
+
+placement get_placement() {
+  auto* opts = options::get();
+  if (opts->has_string("numa_placement")) {
+    return placement_from_string(opts->get_string("numa_placement"));
+  }
+  return placement::none;
+}
+
+void place_pages(void* ptr, size_t bytes, placement p) {
+  if (ptr == nullptr || bytes == 0 || p == placement::none) { return; }
+  auto* buffer = static_cast<unsigned char*>(ptr);
+#if defined(LBANN_TOPO_AWARE)
+  if (p == placement::interleave) {
+    auto topo = get_topology();
+    if (hwloc_get_nbobjs_by_type(topo, HWLOC_OBJ_NUMANODE) <= 1) { return; }
+    // Only whole pages can be bound
+    const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+    const auto begin = reinterpret_cast<uintptr_t>(buffer);
+    const auto aligned_begin = (begin + page_size - 1) / page_size * page_size;
+    const auto aligned_end = (begin + bytes) / page_size * page_size;
+    if (aligned_end > aligned_begin
+        && hwloc_set_area_membind(topo,
+                                  reinterpret_cast<void*>(aligned_begin),
+                                  aligned_end - aligned_begin,
+                                  hwloc_topology_get_topology_cpuset(topo),
+                                  HWLOC_MEMBIND_INTERLEAVE, 0) == 0) {
+      return;
+    }
+  }
+#endif // LBANN_TOPO_AWARE
+  first_touch(buffer, bytes);
+}
+
+} // namespace numa
+} // namespace lbann
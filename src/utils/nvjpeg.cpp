@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/utils/nvjpeg.hpp"
+
+#ifdef LBANN_HAS_NVJPEG
+
+#include "lbann/utils/exception.hpp"
+
+#define CHECK_NVJPEG(nvjpeg_call)                                       \
+  do {                                                                  \
+    const nvjpegStatus_t status_CHECK_NVJPEG = (nvjpeg_call);           \
+    if (status_CHECK_NVJPEG != NVJPEG_STATUS_SUCCESS) {                 \
+      LBANN_ERROR("nvJPEG error (", static_cast<int>(status_CHECK_NVJPEG), \
+                  ") in ", #nvjpeg_call);                               \
+    }                                                                   \
+  } while (0)
+
+namespace lbann {
+
+nvjpeg_image_decoder::nvjpeg_image_decoder() {
+  CHECK_NVJPEG(nvjpegCreateSimple(&m_handle));
+  CHECK_NVJPEG(nvjpegJpegStateCreate(m_handle, &m_state));
+}
+
+nvjpeg_image_decoder::~nvjpeg_image_decoder() {
+  // Errors are ignored: this may run at thread exit, after CUDA has
+  // been shut down
+  if (m_images != nullptr) { cudaFree(m_images); }
+  if (m_tasks != nullptr) { cudaFree(m_tasks); }
+  nvjpegJpegStateDestroy(m_state);
+  nvjpegDestroy(m_handle);
+}
+
+std::vector<size_t> nvjpeg_image_decoder::get_dims(const uint8_t* data,
+                                                   size_t size) {
+  int num_components;
+  nvjpegChromaSubsampling_t subsampling;
+  int widths[NVJPEG_MAX_COMPONENT];
+  int heights[NVJPEG_MAX_COMPONENT];
+  CHECK_NVJPEG(nvjpegGetImageInfo(m_handle, data, size, &num_components,
+                                  &subsampling, widths, heights));
+  // Always decoded to three interleaved channels
+  return {3, static_cast<size_t>(heights[0]), static_cast<size_t>(widths[0])};
+}
+
+void nvjpeg_image_decoder::reserve(void** buffer, size_t& capacity,
+                                   size_t bytes, cudaStream_t stream) {
+  if (bytes <= capacity) {
+    return;
+  }
+  // Work still queued on the stream may use the old buffer
+  CHECK_CUDA(cudaStreamSynchronize(stream));
+  if (*buffer != nullptr) {
+    CHECK_CUDA(cudaFree(*buffer));
+  }
+  // Over-allocate a little, since image sizes vary between batches
+  capacity = bytes + bytes / 4;
+  CHECK_CUDA(cudaMalloc(buffer, capacity));
+}
+
+void nvjpeg_image_decoder::decode_and_transform(
+  const std::vector<const uint8_t*>& data,
+  const std::vector<size_t>& sizes,
+  const std::vector<std::vector<size_t>>& dims,
+  const std::vector<transform::fused_image_op>& ops,
+  size_t out_h, size_t out_w,
+  El::Matrix<DataType, El::Device::GPU>& out,
+  cudaStream_t stream) {
+  const size_t num_images = data.size();
+  if (num_images == 0) {
+    return;
+  }
+  if (static_cast<size_t>(out.Width()) < num_images
+      || static_cast<size_t>(out.Height()) != 3*out_h*out_w) {
+    LBANN_ERROR("output matrix is ", out.Height(), "x", out.Width(),
+                ", but ", num_images, " images of ", 3*out_h*out_w,
+                " entries are to be decoded");
+  }
+
+  // Lay the decoded images out back to back
+  std::vector<size_t> offsets(num_images);
+  size_t total = 0;
+  for (size_t i = 0; i < num_images; ++i) {
+    offsets[i] = total;
+    total += dims[i][0] * dims[i][1] * dims[i][2];
+  }
+  reserve(&m_images, m_images_capacity, total, stream);
+  reserve(&m_tasks, m_tasks_capacity,
+          num_images * sizeof(transform::fused_image_task), stream);
+
+  uint8_t* images = static_cast<uint8_t*>(m_images);
+  m_destinations.assign(num_images, nvjpegImage_t());
+  m_host_tasks.resize(num_images);
+  for (size_t i = 0; i < num_images; ++i) {
+    m_destinations[i].channel[0] = images + offsets[i];
+    m_destinations[i].pitch[0] = dims[i][0] * dims[i][2];
+    m_host_tasks[i].image = images + offsets[i];
+    m_host_tasks[i].height = dims[i][1];
+    m_host_tasks[i].width = dims[i][2];
+    m_host_tasks[i].op = ops[i];
+  }
+
+  CHECK_NVJPEG(nvjpegDecodeBatchedInitialize(m_handle, m_state, num_images,
+                                             1, NVJPEG_OUTPUT_BGRI));
+  CHECK_NVJPEG(nvjpegDecodeBatched(m_handle, m_state, data.data(),
+                                   sizes.data(), m_destinations.data(),
+                                   stream));
+  // Copies from pageable memory are staged before this returns, so
+  // m_host_tasks may be reused immediately
+  CHECK_CUDA(cudaMemcpyAsync(m_tasks, m_host_tasks.data(),
+                             num_images * sizeof(transform::fused_image_task),
+                             cudaMemcpyHostToDevice, stream));
+  transform::apply_fused_image_ops(
+    static_cast<const transform::fused_image_task*>(m_tasks), num_images,
+    out_h, out_w, out.Buffer(), out.LDim(), stream);
+}
+
+} // namespace lbann
+
+#endif // LBANN_HAS_NVJPEG
@@ -26,11 +26,124 @@
 
 #include "lbann/utils/nvshmem.hpp"
 #ifdef LBANN_HAS_NVSHMEM
+#include "lbann/utils/cuda.hpp"
 #include "lbann/utils/exception.hpp"
 
+#include <algorithm>
+#include <cstdint>
+
 namespace lbann {
 namespace nvshmem {
 
+namespace {
+
+bool initialized = false;
+
+/** Symmetric workspace for all-to-alls.
+ *
+ *  Holds the send buffer, the receive buffer and one arrival signal
+ *  per source process. Signals are set to the call count, so they
+ *  never need to be reset. The kernel metadata lives in ordinary
+ *  device memory.
+ */
+struct workspace {
+  unsigned char* send = nullptr;
+  unsigned char* recv = nullptr;
+  uint64_t* signals = nullptr;
+  size_t bytes = 0;
+  int num_signals = 0;
+  uint64_t epoch = 0;
+  size_t* meta = nullptr;
+  int* pes = nullptr;
+  int meta_procs = 0;
+};
+workspace ws;
+
+void free_workspace() {
+  if (ws.send != nullptr) { nvshmem_free(ws.send); }
+  if (ws.recv != nullptr) { nvshmem_free(ws.recv); }
+  if (ws.signals != nullptr) { nvshmem_free(ws.signals); }
+  if (ws.meta != nullptr) { CHECK_CUDA(cudaFree(ws.meta)); }
+  if (ws.pes != nullptr) { CHECK_CUDA(cudaFree(ws.pes)); }
+  ws = workspace();
+}
+
+/** Grow the kernel metadata buffers (local). */
+void reserve_metadata(int num_procs) {
+  if (num_procs <= ws.meta_procs) { return; }
+  if (ws.meta != nullptr) { CHECK_CUDA(cudaFree(ws.meta)); }
+  if (ws.pes != nullptr) { CHECK_CUDA(cudaFree(ws.pes)); }
+  CHECK_CUDA(cudaMalloc(&ws.meta, 3 * num_procs * sizeof(size_t)));
+  CHECK_CUDA(cudaMalloc(&ws.pes, num_procs * sizeof(int)));
+  ws.meta_procs = num_procs;
+}
+
+/** Grow the workspace (collective over all processes). */
+void reserve_workspace(size_t bytes) {
+  int num_pes = nvshmem_n_pes();
+  unsigned long long bytes_needed = bytes;
+  MPI_Allreduce(MPI_IN_PLACE, &bytes_needed, 1, MPI_UNSIGNED_LONG_LONG,
+                MPI_MAX, MPI_COMM_WORLD);
+  if (bytes_needed <= ws.bytes && ws.num_signals == num_pes) {
+    return;
+  }
+  if (ws.send != nullptr) { nvshmem_free(ws.send); }
+  if (ws.recv != nullptr) { nvshmem_free(ws.recv); }
+  if (ws.signals != nullptr) { nvshmem_free(ws.signals); }
+  ws.bytes = std::max({static_cast<size_t>(bytes_needed), 2 * ws.bytes,
+                       size_t{1} << 16});
+  ws.send = static_cast<unsigned char*>(nvshmem_malloc(ws.bytes));
+  ws.recv = static_cast<unsigned char*>(nvshmem_malloc(ws.bytes));
+  ws.signals = static_cast<uint64_t*>(nvshmem_calloc(num_pes, sizeof(uint64_t)));
+  if (ws.send == nullptr || ws.recv == nullptr || ws.signals == nullptr) {
+    LBANN_ERROR("failed to allocate ", ws.bytes, " B NVSHMEM workspace");
+  }
+  ws.num_signals = num_pes;
+  // Signals were zeroed, so the epoch restarts
+  ws.epoch = 0;
+}
+
+/** One thread block per destination: put the block's bytes into the
+ *  peer's receive buffer and signal the arrival. Destinations are
+ *  staggered so that processes do not all target the same peer. */
+__global__ void put_kernel(const unsigned char* __restrict__ send,
+                           unsigned char* recv,
+                           const size_t* __restrict__ send_displs,
+                           const size_t* __restrict__ send_bytes,
+                           const size_t* __restrict__ remote_displs,
+                           const int* __restrict__ pes,
+                           int num_procs,
+                           int my_proc,
+                           uint64_t* signals,
+                           int my_pe,
+                           uint64_t epoch) {
+  for (int i = blockIdx.x; i < num_procs; i += gridDim.x) {
+    const int dst = (my_proc + i) % num_procs;
+    nvshmemx_putmem_signal_nbi_block(recv + remote_displs[dst],
+                                     send + send_displs[dst],
+                                     send_bytes[dst],
+                                     signals + my_pe,
+                                     epoch,
+                                     NVSHMEM_SIGNAL_SET,
+                                     pes[dst]);
+  }
+  // The send buffer may be reused once the puts are complete
+  nvshmem_quiet();
+}
+
+/** Wait until every source has signaled this epoch. */
+__global__ void wait_kernel(const int* __restrict__ pes,
+                            int num_procs,
+                            uint64_t* signals,
+                            uint64_t epoch) {
+  const int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i < num_procs) {
+    nvshmem_signal_wait_until(signals + pes[i], NVSHMEM_CMP_GE, epoch);
+  }
+}
+
+} // namespace
+
 void initialize(MPI_Comm comm) {
   nvshmemx_init_attr_t attr;
   attr.mpi_comm = &comm;
@@ -38,10 +151,95 @@ void initialize(MPI_Comm comm) {
   if (status != 0) {
     LBANN_ERROR("failed to initialize NVSHMEM (status ",status,")");
   }
+  initialized = true;
 }
 
 void finalize() {
+  free_workspace();
   nvshmem_finalize();
+  initialized = false;
+}
+
+bool is_initialized() noexcept {
+  return initialized;
+}
+
+void all_to_all(const void* send,
+                const std::vector<size_t>& send_bytes,
+                void* recv,
+                const std::vector<size_t>& recv_bytes,
+                const El::mpi::Comm& c,
+                cudaStream_t stream) {
+  if (!initialized) {
+    LBANN_ERROR("NVSHMEM all-to-all called before NVSHMEM was initialized");
+  }
+  const int num_procs = El::mpi::Size(c);
+  const int my_proc = El::mpi::Rank(c);
+
+  // Displacements in the local buffers
+  std::vector<size_t> send_displs(num_procs+1, 0), recv_displs(num_procs+1, 0);
+  for (int i = 0; i < num_procs; ++i) {
+    send_displs[i+1] = send_displs[i] + send_bytes[i];
+    recv_displs[i+1] = recv_displs[i] + recv_bytes[i];
+  }
+
+  // Each destination tells us where our bytes go in its buffer
+  std::vector<unsigned long long> my_displs(recv_displs.begin(),
+                                            recv_displs.end() - 1);
+  std::vector<unsigned long long> remote_displs(num_procs);
+  MPI_Alltoall(my_displs.data(), 1, MPI_UNSIGNED_LONG_LONG,
+               remote_displs.data(), 1, MPI_UNSIGNED_LONG_LONG,
+               c.GetMPIComm());
+
+  // NVSHMEM processes are world ranks (see lbann::initialize)
+  std::vector<int> ranks(num_procs), pes(num_procs);
+  for (int i = 0; i < num_procs; ++i) { ranks[i] = i; }
+  MPI_Group group, world_group;
+  MPI_Comm_group(c.GetMPIComm(), &group);
+  MPI_Comm_group(MPI_COMM_WORLD, &world_group);
+  MPI_Group_translate_ranks(group, num_procs, ranks.data(),
+                            world_group, pes.data());
+  MPI_Group_free(&group);
+  MPI_Group_free(&world_group);
+
+  reserve_workspace(std::max(send_displs.back(), recv_displs.back()));
+  const uint64_t epoch = ++ws.epoch;
+
+  // Metadata for the kernels
+  std::vector<size_t> meta;
+  meta.reserve(3 * num_procs);
+  meta.insert(meta.end(), send_displs.begin(), send_displs.end() - 1);
+  meta.insert(meta.end(), send_bytes.begin(), send_bytes.end());
+  meta.insert(meta.end(), remote_displs.begin(), remote_displs.end());
+  reserve_metadata(num_procs);
+  auto* meta_dev = ws.meta;
+  auto* pes_dev = ws.pes;
+  CHECK_CUDA(cudaMemcpyAsync(meta_dev, meta.data(),
+                             meta.size() * sizeof(size_t),
+                             cudaMemcpyHostToDevice, stream));
+  CHECK_CUDA(cudaMemcpyAsync(pes_dev, pes.data(), num_procs * sizeof(int),
+                             cudaMemcpyHostToDevice, stream));
+
+  // Put, wait for arrivals, unpack
+  if (send_displs.back() > 0) {
+    CHECK_CUDA(cudaMemcpyAsync(ws.send, send, send_displs.back(),
+                               cudaMemcpyDeviceToDevice, stream));
+  }
+  const int my_pe = nvshmem_my_pe();
+  put_kernel<<<std::min(num_procs, 32), 256, 0, stream>>>(
+    ws.send, ws.recv,
+    meta_dev, meta_dev + num_procs, meta_dev + 2 * num_procs,
+    pes_dev, num_procs, my_proc, ws.signals, my_pe, epoch);
+  wait_kernel<<<(num_procs + 127) / 128, 128, 0, stream>>>(
+    pes_dev, num_procs, ws.signals, epoch);
+  if (recv_displs.back() > 0) {
+    CHECK_CUDA(cudaMemcpyAsync(recv, ws.recv, recv_displs.back(),
+                               cudaMemcpyDeviceToDevice, stream));
+  }
+
+  // The next call may overwrite the workspace as soon as peers reach
+  // it, so the unpack must be complete before returning
+  CHECK_CUDA(cudaStreamSynchronize(stream));
 }
 
 } // namespace nvshmem
@@ -0,0 +1,243 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/utils/parallel_plan.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+
+namespace lbann {
+namespace parallel_plan {
+namespace {
+
+double product(const std::vector<int>& dims) {
+  return std::accumulate(dims.begin(), dims.end(), 1.0,
+                         std::multiplies<double>());
+}
+
+double log2_procs(const machine& m) {
+  return m.num_procs > 1 ? std::log2(double(m.num_procs)) : 0.0;
+}
+
+/** Processes with work to do. */
+double busy_procs(const layer_info& l, const choice& c, const machine& m) {
+  if (c.layout == data_layout::MODEL_PARALLEL) {
+    return m.num_procs;
+  }
+  const double sample_groups = m.num_procs / c.spatial_groups;
+  const double height = (l.output_dims.size() >= 2
+                         ? l.output_dims[1] : 1);
+  return std::max(std::min(double(m.mini_batch_size), sample_groups)
+                  * std::min(double(c.spatial_groups), height),
+                  1.0);
+}
+
+} // namespace
+
+std::vector<choice> candidates(const layer_info& l, const machine& m) {
+  std::vector<choice> cands = {choice{}};
+  if (m.num_procs <= 1) { return cands; }
+  if (l.model_parallel) {
+    cands.push_back({data_layout::MODEL_PARALLEL, 1});
+  }
+  if (l.spatial && l.output_dims.size() >= 3) {
+    const int height = std::min(l.input_dims.size() >= 2 ? l.input_dims[1] : 1,
+                                l.output_dims[1]);
+    for (int g = 2; g <= m.num_procs; g *= 2) {
+      if (m.num_procs % g != 0) { break; }
+      if (height / g < std::max(2 * l.halo, 1)) { break; }
+      cands.push_back({data_layout::DATA_PARALLEL, g});
+    }
+  }
+  return cands;
+}
+
+namespace {
+
+/** Bytes sent by each process and messages on its critical path. */
+struct traffic {
+  double bytes = 0.0;
+  double messages = 0.0;
+};
+
+traffic layer_traffic(const layer_info& l, const choice& c, const machine& m) {
+  traffic t;
+  const double P = m.num_procs;
+  const double N = m.mini_batch_size;
+  if (P <= 1) { return t; }
+  if (c.layout == data_layout::MODEL_PARALLEL) {
+    // Gather inputs and reduce outputs in forward prop, the reverse
+    // in backward prop
+    const double entries = N * (product(l.input_dims) + product(l.output_dims));
+    t.bytes = 2 * (P - 1) / P * entries * m.entry_size;
+    t.messages = 4 * log2_procs(m);
+  } else {
+    if (l.num_weights > 0) {
+      t.bytes += 2 * (P - 1) / P * l.num_weights * m.entry_size;
+      t.messages += 2 * log2_procs(m);
+    }
+    if (c.spatial_groups > 1 && l.halo > 0 && l.input_dims.size() >= 2) {
+      const double row = product(l.input_dims) / l.input_dims[1];
+      const double local_samples = std::ceil(N / (P / c.spatial_groups));
+      // Both neighbors, forward and backward prop
+      t.bytes += 4 * l.halo * row * local_samples * m.entry_size;
+      t.messages += 4;
+    }
+  }
+  return t;
+}
+
+traffic redistribution_traffic(const layer_info& parent,
+                               const choice& from,
+                               const choice& to,
+                               const machine& m) {
+  traffic t;
+  if (from == to || m.num_procs <= 1) { return t; }
+  const double P = m.num_procs;
+  const double bytes = (product(parent.output_dims) * m.mini_batch_size
+                        * m.entry_size);
+  // All-to-all of the local tensor, for activations and error signals
+  t.bytes = 2 * bytes / P * (P - 1) / P;
+  t.messages = 2 * log2_procs(m);
+  return t;
+}
+
+double seconds(const traffic& t, const machine& m) {
+  return t.bytes / m.bandwidth + t.messages * m.latency;
+}
+
+} // namespace
+
+cost layer_cost(const layer_info& l, const choice& c, const machine& m) {
+  cost result;
+  const double N = m.mini_batch_size;
+
+  // Compute
+  if (l.measured_time >= 0) {
+    result.compute = (l.measured_time
+                      * busy_procs(l, l.current, m)
+                      / busy_procs(l, c, m));
+  } else {
+    result.compute = l.flops * N / (busy_procs(l, c, m) * m.flop_rate);
+  }
+
+  // Communication
+  result.comm = seconds(layer_traffic(l, c, m), m);
+  return result;
+}
+
+double layer_comm_bytes(const layer_info& l, const choice& c,
+                        const machine& m) {
+  return layer_traffic(l, c, m).bytes;
+}
+
+double redistribution_cost(const layer_info& parent,
+                           const choice& from,
+                           const choice& to,
+                           const machine& m) {
+  return seconds(redistribution_traffic(parent, from, to, m), m);
+}
+
+double redistribution_bytes(const layer_info& parent,
+                            const choice& from,
+                            const choice& to,
+                            const machine& m) {
+  return redistribution_traffic(parent, from, to, m).bytes;
+}
+
+plan evaluate(const std::vector<layer_info>& layers,
+              const std::vector<choice>& choices,
+              const machine& m) {
+  plan p;
+  p.choices = choices;
+  p.layer_costs.resize(layers.size());
+  p.redistribution_costs.assign(layers.size(), 0.0);
+  for (size_t i = 0; i < layers.size(); ++i) {
+    p.layer_costs[i] = layer_cost(layers[i], choices[i], m);
+    for (const auto& j : layers[i].parents) {
+      p.redistribution_costs[i] += redistribution_cost(layers[j],
+                                                       choices[j],
+                                                       choices[i],
+                                                       m);
+    }
+    p.total += p.layer_costs[i].total() + p.redistribution_costs[i];
+  }
+  return p;
+}
+
+plan search(const std::vector<layer_info>& layers,
+            const machine& m,
+            size_t max_sweeps) {
+  const size_t num_layers = layers.size();
+  std::vector<std::vector<size_t>> children(num_layers);
+  std::vector<choice> choices(num_layers);
+  for (size_t i = 0; i < num_layers; ++i) {
+    choices[i] = layers[i].current;
+    for (const auto& j : layers[i].parents) {
+      children[j].push_back(i);
+    }
+  }
+
+  // Cost that depends on one layer's choice
+  auto local_cost = [&](size_t i, const choice& c) {
+    double total = layer_cost(layers[i], c, m).total();
+    for (const auto& j : layers[i].parents) {
+      total += redistribution_cost(layers[j], choices[j], c, m);
+    }
+    for (const auto& j : children[i]) {
+      total += redistribution_cost(layers[i], c, choices[j], m);
+    }
+    return total;
+  };
+
+  for (size_t sweep = 0; sweep < max_sweeps; ++sweep) {
+    bool changed = false;
+    for (size_t i = 0; i < num_layers; ++i) {
+      auto best = choices[i];
+      auto best_cost = local_cost(i, best);
+      for (const auto& c : candidates(layers[i], m)) {
+        const auto c_cost = local_cost(i, c);
+        if (c_cost < best_cost * (1 - 1e-9)) {
+          best = c;
+          best_cost = c_cost;
+        }
+      }
+      if (best != choices[i]) {
+        choices[i] = best;
+        changed = true;
+      }
+    }
+    if (!changed) { break; }
+  }
+
+  return evaluate(layers, choices, m);
+}
+
+} // namespace parallel_plan
+} // namespace lbann
@@ -0,0 +1,206 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/utils/pinned_memory.hpp"
+#include "lbann/utils/exception.hpp"
+#include "lbann/utils/options.hpp"
+
+#ifdef LBANN_HAS_GPU
+#include "lbann/utils/cuda.hpp"
+#endif // LBANN_HAS_GPU
+
+#include <cstdlib>
+#include <utility>
+
+namespace lbann {
+
+namespace {
+
+/** Allocate page-locked host memory, or null if it fails. */
+void* pin(size_t size) {
+  void* ptr = nullptr;
+#ifdef LBANN_HAS_GPU
+  if (cudaMallocHost(&ptr, size) != cudaSuccess) {
+    cudaGetLastError();
+    ptr = nullptr;
+  }
+#else
+  ptr = std::malloc(size);
+#endif // LBANN_HAS_GPU
+  return ptr;
+}
+
+void unpin(void* ptr) {
+#ifdef LBANN_HAS_GPU
+  CHECK_CUDA(cudaFreeHost(ptr));
+#else
+  std::free(ptr);
+#endif // LBANN_HAS_GPU
+}
+
+} // namespace
+
+pinned_memory_pool::lease::lease(lease&& other) noexcept
+  : m_ptr(other.m_ptr), m_size(other.m_size), m_pinned(other.m_pinned) {
+  other.m_ptr = nullptr;
+  other.m_size = 0;
+}
+
+pinned_memory_pool::lease&
+pinned_memory_pool::lease::operator=(lease&& other) noexcept {
+  if (this != &other) {
+    reset();
+    std::swap(m_ptr, other.m_ptr);
+    std::swap(m_size, other.m_size);
+    std::swap(m_pinned, other.m_pinned);
+  }
+  return *this;
+}
+
+void pinned_memory_pool::lease::reset() {
+  if (m_ptr != nullptr) {
+    pinned_memory_pool::instance().give_back(m_ptr, m_size, m_pinned);
+    m_ptr = nullptr;
+    m_size = 0;
+  }
+}
+
+pinned_memory_pool& pinned_memory_pool::instance() {
+  static pinned_memory_pool pool;
+  return pool;
+}
+
+pinned_memory_pool::pinned_memory_pool()
+  : m_capacity(size_t(options::get()->get_int("pinned_memory_mb", 2048)) << 20) {}
+
+pinned_memory_pool::~pinned_memory_pool() {
+  // The CUDA runtime may already be shutting down, so errors are
+  // ignored
+  for (auto& size_list : m_free) {
+    for (auto* ptr : size_list.second) {
+#ifdef LBANN_HAS_GPU
+      cudaFreeHost(ptr);
+#else
+      std::free(ptr);
+#endif // LBANN_HAS_GPU
+    }
+  }
+}
+
+size_t pinned_memory_pool::round_up(size_t bytes) noexcept {
+  size_t size = 4096;
+  while (size < bytes) { size *= 2; }
+  return size;
+}
+
+pinned_memory_pool::lease pinned_memory_pool::acquire(size_t bytes) {
+  if (bytes == 0) { return lease(); }
+  const auto size = round_up(bytes);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_stats.num_leases;
+
+  // Reuse a free buffer of the same size class
+  auto it = m_free.find(size);
+  if (it != m_free.end() && !it->second.empty()) {
+    auto* ptr = it->second.back();
+    it->second.pop_back();
+    m_stats.cached_bytes -= size;
+    m_stats.leased_bytes += size;
+    ++m_stats.num_reuses;
+    return lease(ptr, size, true);
+  }
+
+  // Pin new memory if it fits under the cap
+  if (m_stats.pinned_bytes + size > m_capacity) { release_cached_locked(); }
+  if (m_stats.pinned_bytes + size <= m_capacity) {
+    auto* ptr = pin(size);
+    if (ptr != nullptr) {
+      m_stats.pinned_bytes += size;
+      m_stats.leased_bytes += size;
+      ++m_stats.num_pins;
+      return lease(ptr, size, true);
+    }
+  }
+
+  // Fall back to pageable memory
+  auto* ptr = std::malloc(bytes);
+  if (ptr == nullptr) {
+    LBANN_ERROR("could not allocate ", bytes, " B of host memory");
+  }
+  ++m_stats.num_pageable;
+  return lease(ptr, bytes, false);
+}
+
+void pinned_memory_pool::give_back(void* ptr, size_t size, bool pinned) {
+  if (!pinned) {
+    std::free(ptr);
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stats.leased_bytes -= size;
+  if (m_stats.pinned_bytes > m_capacity) {
+    unpin(ptr);
+    m_stats.pinned_bytes -= size;
+  }
+  else {
+    m_free[size].push_back(ptr);
+    m_stats.cached_bytes += size;
+  }
+}
+
+void pinned_memory_pool::release_cached() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  release_cached_locked();
+}
+
+void pinned_memory_pool::release_cached_locked() {
+  for (auto& size_list : m_free) {
+    for (auto* ptr : size_list.second) {
+      unpin(ptr);
+      m_stats.pinned_bytes -= size_list.first;
+      m_stats.cached_bytes -= size_list.first;
+    }
+  }
+  m_free.clear();
+}
+
+size_t pinned_memory_pool::get_capacity() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_capacity;
+}
+
+void pinned_memory_pool::set_capacity(size_t bytes) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_capacity = bytes;
+  if (m_stats.pinned_bytes > m_capacity) { release_cached_locked(); }
+}
+
+pinned_memory_statistics pinned_memory_pool::get_statistics() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+} // namespace lbann
@@ -0,0 +1,198 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/utils/pipeline.hpp"
+#include "lbann/utils/exception.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace lbann {
+namespace pipeline {
+
+std::string to_string(schedule_type type) {
+  switch (type) {
+  case schedule_type::gpipe:                    return "GPipe";
+  case schedule_type::one_forward_one_backward: return "1F1B";
+  default: LBANN_ERROR("invalid pipeline schedule type");
+  }
+  return "";
+}
+
+std::vector<size_t> balance_stages(const std::vector<double>& costs,
+                                   size_t num_stages) {
+  const size_t num_layers = costs.size();
+  if (num_stages == 0) {
+    LBANN_ERROR("pipelines must have at least one stage");
+  }
+  if (num_layers == 0) { return {}; }
+  num_stages = std::min(num_stages, num_layers);
+
+  // Cost of layers [0,i)
+  std::vector<double> prefix(num_layers + 1, 0.);
+  for (size_t i = 0; i < num_layers; ++i) {
+    prefix[i+1] = prefix[i] + costs[i];
+  }
+
+  // Dynamic programming over the number of stages
+  // Note: best[j][i] is the minimum cost of the most expensive stage
+  // when layers [0,i) are split into j+1 stages and starts[j][i] is
+  // the first layer of the last of those stages.
+  std::vector<std::vector<double>> best(num_stages,
+                                        std::vector<double>(num_layers + 1));
+  std::vector<std::vector<size_t>> starts(num_stages,
+                                          std::vector<size_t>(num_layers + 1, 0));
+  for (size_t i = 1; i <= num_layers; ++i) {
+    best[0][i] = prefix[i];
+  }
+  for (size_t j = 1; j < num_stages; ++j) {
+    for (size_t i = j + 1; i <= num_layers; ++i) {
+      best[j][i] = std::numeric_limits<double>::infinity();
+      for (size_t t = j; t < i; ++t) {
+        const double cost = std::max(best[j-1][t], prefix[i] - prefix[t]);
+        if (cost < best[j][i]) {
+          best[j][i] = cost;
+          starts[j][i] = t;
+        }
+      }
+    }
+  }
+
+  // Recover the stage boundaries
+  std::vector<size_t> stage_starts(num_stages, 0);
+  size_t end = num_layers;
+  for (size_t j = num_stages - 1; j > 0; --j) {
+    stage_starts[j] = starts[j][end];
+    end = stage_starts[j];
+  }
+  return stage_starts;
+}
+
+std::vector<operation> get_schedule(schedule_type type,
+                                    int stage,
+                                    int num_stages,
+                                    int num_micro_batches) {
+  if (num_stages < 1 || stage < 0 || stage >= num_stages) {
+    LBANN_ERROR("invalid pipeline stage ", stage, " ",
+                "of ", num_stages, " stages");
+  }
+  if (num_micro_batches < 1) {
+    LBANN_ERROR("pipelines must have at least one micro-batch");
+  }
+  std::vector<operation> ops;
+  ops.reserve(2 * num_micro_batches);
+  switch (type) {
+  case schedule_type::gpipe:
+    for (int m = 0; m < num_micro_batches; ++m) {
+      ops.push_back({true, m});
+    }
+    for (int m = num_micro_batches - 1; m >= 0; --m) {
+      ops.push_back({false, m});
+    }
+    break;
+  case schedule_type::one_forward_one_backward:
+    {
+      const int warmup = std::min(num_stages - stage - 1, num_micro_batches);
+      for (int m = 0; m < warmup; ++m) {
+        ops.push_back({true, m});
+      }
+      for (int m = warmup; m < num_micro_batches; ++m) {
+        ops.push_back({true, m});
+        ops.push_back({false, m - warmup});
+      }
+      for (int m = num_micro_batches - warmup; m < num_micro_batches; ++m) {
+        ops.push_back({false, m});
+      }
+    }
+    break;
+  default: LBANN_ERROR("invalid pipeline schedule type");
+  }
+  return ops;
+}
+
+double estimate_step_time(schedule_type type,
+                          const std::vector<double>& forward_times,
+                          const std::vector<double>& backward_times,
+                          int num_micro_batches) {
+  const int num_stages = forward_times.size();
+  if (backward_times.size() != forward_times.size()) {
+    LBANN_ERROR("got forward times for ", forward_times.size(), " ",
+                "pipeline stages and backward times for ",
+                backward_times.size(), " stages");
+  }
+  if (num_stages == 0) { return 0.; }
+
+  // Finish times of passes, negative if not yet run
+  std::vector<std::vector<operation>> schedules;
+  for (int s = 0; s < num_stages; ++s) {
+    schedules.push_back(get_schedule(type, s, num_stages, num_micro_batches));
+  }
+  std::vector<std::vector<double>> forward_done(
+    num_stages, std::vector<double>(num_micro_batches, -1.));
+  std::vector<std::vector<double>> backward_done(
+    num_stages, std::vector<double>(num_micro_batches, -1.));
+  std::vector<double> stage_times(num_stages, 0.);
+  std::vector<size_t> next_ops(num_stages, 0);
+
+  // Run each stage's passes as soon as their inputs are ready
+  size_t num_remaining = 2 * num_stages * num_micro_batches;
+  while (num_remaining > 0) {
+    bool progress = false;
+    for (int s = 0; s < num_stages; ++s) {
+      while (next_ops[s] < schedules[s].size()) {
+        const auto& op = schedules[s][next_ops[s]];
+        const int m = op.micro_batch;
+        double ready;
+        if (op.forward) {
+          ready = (s > 0 ? forward_done[s-1][m] : 0.);
+        } else {
+          ready = (s < num_stages - 1
+                   ? backward_done[s+1][m]
+                   : forward_done[s][m]);
+        }
+        if (ready < 0.) { break; }
+        const double start = std::max(stage_times[s], ready);
+        if (op.forward) {
+          stage_times[s] = start + forward_times[s];
+          forward_done[s][m] = stage_times[s];
+        } else {
+          stage_times[s] = start + backward_times[s];
+          backward_done[s][m] = stage_times[s];
+        }
+        ++next_ops[s];
+        --num_remaining;
+        progress = true;
+      }
+    }
+    if (!progress) {
+      LBANN_ERROR("the ", to_string(type), " pipeline schedule deadlocked");
+    }
+  }
+  return *std::max_element(stage_times.begin(), stage_times.end());
+}
+
+} // namespace pipeline
+} // namespace lbann
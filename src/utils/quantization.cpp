@@ -0,0 +1,205 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/utils/quantization.hpp"
+#include "lbann/utils/exception.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace lbann {
+namespace utils {
+
+storage_type parse_storage_type(const std::string& name) {
+  if (name == "uint8") { return storage_type::uint8; }
+  if (name == "fp16") { return storage_type::fp16; }
+  if (name == "bf16") { return storage_type::bf16; }
+  LBANN_ERROR("unknown storage type \"", name, "\"; "
+              "expected uint8, fp16 or bf16");
+  return storage_type::uint8;
+}
+
+std::string to_string(storage_type t) {
+  switch (t) {
+  case storage_type::uint8: return "uint8";
+  case storage_type::fp16:  return "fp16";
+  case storage_type::bf16:  return "bf16";
+  }
+  return "";
+}
+
+std::size_t storage_type_size(storage_type t) {
+  return t == storage_type::uint8 ? 1 : 2;
+}
+
+namespace {
+
+uint32_t float_bits(float x) {
+  uint32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  return bits;
+}
+
+float bits_float(uint32_t bits) {
+  float x;
+  std::memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+} // namespace
+
+uint16_t float_to_half(float x) {
+  const uint32_t bits = float_bits(x);
+  const uint16_t sign = (bits >> 16) & 0x8000;
+  const uint32_t abs_bits = bits & 0x7fffffff;
+  if (abs_bits >= 0x7f800000) {
+    // Inf stays inf; NaN stays a quiet NaN
+    return sign | 0x7c00 | (abs_bits > 0x7f800000 ? 0x200 : 0);
+  }
+  if (abs_bits >= 0x477ff000) {
+    // Rounds past the largest half (65504)
+    return sign | 0x7c00;
+  }
+  if (abs_bits < 0x38800000) {
+    // Subnormal half: the 0.5 offset aligns the mantissa at bit 0 of
+    // the float, whose round-to-nearest-even does the rounding
+    const float shifted = bits_float(abs_bits) + 0.5f;
+    return sign | static_cast<uint16_t>(float_bits(shifted) - 0x3f000000);
+  }
+  // Normal half: rebias the exponent and round the mantissa to even
+  const uint32_t odd = (abs_bits >> 13) & 1;
+  const uint32_t rounded = abs_bits + 0xfff + odd;
+  return sign | static_cast<uint16_t>((rounded - 0x38000000) >> 13);
+}
+
+float half_to_float(uint16_t bits) {
+  const uint32_t sign = uint32_t(bits & 0x8000) << 16;
+  const uint32_t exponent = (bits >> 10) & 0x1f;
+  const uint32_t mantissa = bits & 0x3ff;
+  if (exponent == 0x1f) {
+    return bits_float(sign | 0x7f800000 | (mantissa << 13));
+  }
+  if (exponent == 0) {
+    // Zero or subnormal: mantissa * 2^-24
+    const float x = std::ldexp(static_cast<float>(mantissa), -24);
+    return bits_float(sign | float_bits(x));
+  }
+  return bits_float(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+uint16_t float_to_bf16(float x) {
+  const uint32_t bits = float_bits(x);
+  if ((bits & 0x7fffffff) > 0x7f800000) {
+    return static_cast<uint16_t>((bits >> 16) | 0x40);
+  }
+  const uint32_t odd = (bits >> 16) & 1;
+  return static_cast<uint16_t>((bits + 0x7fff + odd) >> 16);
+}
+
+float bf16_to_float(uint16_t bits) {
+  return bits_float(uint32_t(bits) << 16);
+}
+
+template <typename T>
+void quantize(const T* src, std::size_t n, storage_type t, void* dst,
+              double& scale, double& offset) {
+  scale = 1;
+  offset = 0;
+  switch (t) {
+  case storage_type::uint8: {
+    auto* out = static_cast<uint8_t*>(dst);
+    if (n == 0) { return; }
+    const auto minmax = std::minmax_element(src, src + n);
+    offset = *minmax.first;
+    const double range = double(*minmax.second) - offset;
+    scale = range > 0 ? range / 255 : 1;
+    const double inv_scale = 1 / scale;
+    for (std::size_t i = 0; i < n; ++i) {
+      const double q = std::round((src[i] - offset) * inv_scale);
+      out[i] = static_cast<uint8_t>(std::min(std::max(q, 0.0), 255.0));
+    }
+    break;
+  }
+  case storage_type::fp16: {
+    auto* out = static_cast<uint16_t*>(dst);
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = float_to_half(static_cast<float>(src[i]));
+    }
+    break;
+  }
+  case storage_type::bf16: {
+    auto* out = static_cast<uint16_t*>(dst);
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = float_to_bf16(static_cast<float>(src[i]));
+    }
+    break;
+  }
+  }
+}
+
+template <typename T>
+void dequantize(const void* src, std::size_t n, storage_type t,
+                double scale, double offset, T* dst) {
+  switch (t) {
+  case storage_type::uint8: {
+    const auto* in = static_cast<const uint8_t*>(src);
+    for (std::size_t i = 0; i < n; ++i) {
+      dst[i] = static_cast<T>(in[i] * scale + offset);
+    }
+    break;
+  }
+  case storage_type::fp16: {
+    const auto* in = static_cast<const uint16_t*>(src);
+    for (std::size_t i = 0; i < n; ++i) {
+      dst[i] = static_cast<T>(half_to_float(in[i]));
+    }
+    break;
+  }
+  case storage_type::bf16: {
+    const auto* in = static_cast<const uint16_t*>(src);
+    for (std::size_t i = 0; i < n; ++i) {
+      dst[i] = static_cast<T>(bf16_to_float(in[i]));
+    }
+    break;
+  }
+  }
+}
+
+#define PROTO(T)                                                        \
+  template void quantize<T>(const T*, std::size_t, storage_type, void*, \
+                            double&, double&);                          \
+  template void dequantize<T>(const void*, std::size_t, storage_type,   \
+                              double, double, T*)
+
+PROTO(float);
+PROTO(double);
+
+#undef PROTO
+
+}// namespace utils
+}// namespace lbann
@@ -29,7 +29,11 @@
 #include "lbann/utils/random.hpp"
 #include "lbann/io/file_io.hpp"
 #include "lbann/utils/hash.hpp"
+#include "lbann/utils/omp_pragma.hpp"
+#include "lbann/utils/philox.hpp"
+#include <mpi.h>
 #include <thread>
+#include <type_traits>
 
 namespace {
 #ifdef __ICC
@@ -330,118 +334,226 @@ void init_io_random(int seed) {
   ::fast_io_generator_inited = false;
 }
 
+namespace {
+
+template <typename TensorDataType>
+void philox_mask_apply_local(const El::Matrix<TensorDataType, El::Device::CPU>& input,
+                             El::Matrix<TensorDataType, El::Device::CPU>& output,
+                             El::Int global_height,
+                             El::Int col_shift, El::Int col_stride,
+                             El::Int row_shift, El::Int row_stride,
+                             double keep_prob,
+                             uint64_t seed,
+                             TensorDataType keep_scale,
+                             TensorDataType keep_shift,
+                             TensorDataType drop_value) {
+  const float prob = keep_prob;
+  const El::Int local_height = input.Height();
+  const El::Int local_width = input.Width();
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (El::Int col = 0; col < local_width; ++col) {
+    for (El::Int row = 0; row < local_height; ++row) {
+      const uint64_t index = ((col_shift + row * col_stride)
+                              + (row_shift + col * row_stride) * global_height);
+      const auto& x = input(row, col);
+      output(row, col) = (philox::uniform(seed, index) < prob
+                          ? keep_scale * x + keep_shift
+                          : drop_value);
+    }
+  }
+}
+
+} // namespace
+
+#ifdef LBANN_HAS_GPU
+template <typename TensorDataType>
+void philox_mask_apply_local(const El::Matrix<TensorDataType, El::Device::GPU>& input,
+                             El::Matrix<TensorDataType, El::Device::GPU>& output,
+                             El::Int global_height,
+                             El::Int col_shift, El::Int col_stride,
+                             El::Int row_shift, El::Int row_stride,
+                             double keep_prob,
+                             uint64_t seed,
+                             TensorDataType keep_scale,
+                             TensorDataType keep_shift,
+                             TensorDataType drop_value);
+#endif // LBANN_HAS_GPU
+
+template <typename TensorDataType, El::Device Device>
+void philox_mask_apply(const El::AbstractDistMatrix<TensorDataType>& input,
+                       El::AbstractDistMatrix<TensorDataType>& output,
+                       double keep_prob,
+                       uint64_t seed,
+                       TensorDataType keep_scale,
+                       TensorDataType keep_shift,
+                       TensorDataType drop_value) {
+  if (input.Height() != output.Height()
+      || input.Width() != output.Width()
+      || input.ColShift() != output.ColShift()
+      || input.ColStride() != output.ColStride()
+      || input.RowShift() != output.RowShift()
+      || input.RowStride() != output.RowStride()) {
+    LBANN_ERROR("philox_mask_apply requires matrices with ",
+                "matching dimensions and distributions");
+  }
+  using LocalMatrixType = El::Matrix<TensorDataType, Device>;
+  const auto& local_input = static_cast<const LocalMatrixType&>(input.LockedMatrix());
+  auto& local_output = static_cast<LocalMatrixType&>(output.Matrix());
+  philox_mask_apply_local(local_input, local_output,
+                          input.Height(),
+                          input.ColShift(), input.ColStride(),
+                          input.RowShift(), input.RowStride(),
+                          keep_prob, seed,
+                          keep_scale, keep_shift, drop_value);
+}
+
+uint64_t get_philox_seed() {
+  auto& gen = get_generator();
+  const uint64_t hi = gen();
+  const uint64_t lo = gen();
+  return (hi << 32) | lo;
+}
+
+namespace {
+
+template <typename TensorDataType>
+void philox_fill_local(El::Matrix<TensorDataType, El::Device::CPU>& local_mat,
+                       El::Int global_height,
+                       El::Int col_shift, El::Int col_stride,
+                       El::Int row_shift, El::Int row_stride,
+                       philox::distribution dist,
+                       double a, double b,
+                       uint64_t seed) {
+  using ComputeType = typename std::conditional<
+    std::is_same<TensorDataType, double>::value, double, float>::type;
+  const ComputeType a_ = a, b_ = b;
+  const El::Int local_height = local_mat.Height();
+  const El::Int local_width = local_mat.Width();
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (El::Int col = 0; col < local_width; ++col) {
+    for (El::Int row = 0; row < local_height; ++row) {
+      const uint64_t index = ((col_shift + row * col_stride)
+                              + (row_shift + col * row_stride) * global_height);
+      local_mat(row, col) = static_cast<TensorDataType>(
+        philox::sample<ComputeType>(dist, a_, b_, seed, index));
+    }
+  }
+}
+
+} // namespace
+
+#ifdef LBANN_HAS_GPU
+template <typename TensorDataType>
+void philox_fill_local(El::Matrix<TensorDataType, El::Device::GPU>& local_mat,
+                       El::Int global_height,
+                       El::Int col_shift, El::Int col_stride,
+                       El::Int row_shift, El::Int row_stride,
+                       philox::distribution dist,
+                       double a, double b,
+                       uint64_t seed);
+#endif // LBANN_HAS_GPU
+
+namespace {
+
+/** Fill local entries on the device that owns them. */
+template <typename TensorDataType>
+struct philox_fill_impl {
+  static void apply(El::AbstractDistMatrix<TensorDataType>& mat,
+                    philox::distribution dist, double a, double b,
+                    uint64_t seed) {
+    switch (mat.GetLocalDevice()) {
+    case El::Device::CPU:
+      philox_fill_local(
+        static_cast<El::Matrix<TensorDataType, El::Device::CPU>&>(mat.Matrix()),
+        mat.Height(), mat.ColShift(), mat.ColStride(),
+        mat.RowShift(), mat.RowStride(), dist, a, b, seed);
+      break;
+#ifdef LBANN_HAS_GPU
+    case El::Device::GPU:
+      philox_fill_local(
+        static_cast<El::Matrix<TensorDataType, El::Device::GPU>&>(mat.Matrix()),
+        mat.Height(), mat.ColShift(), mat.ColStride(),
+        mat.RowShift(), mat.RowStride(), dist, a, b, seed);
+      break;
+#endif // LBANN_HAS_GPU
+    default: LBANN_ERROR("invalid device");
+    }
+  }
+};
+
+#ifdef LBANN_HAS_HALF
+template <>
+struct philox_fill_impl<cpu_fp16> {
+  static void apply(El::AbstractDistMatrix<cpu_fp16>& mat,
+                    philox::distribution dist, double a, double b,
+                    uint64_t seed) {
+    if (mat.GetLocalDevice() != El::Device::CPU) {
+      LBANN_ERROR("invalid device");
+    }
+    philox_fill_local(
+      static_cast<El::Matrix<cpu_fp16, El::Device::CPU>&>(mat.Matrix()),
+      mat.Height(), mat.ColShift(), mat.ColStride(),
+      mat.RowShift(), mat.RowStride(), dist, a, b, seed);
+  }
+};
+#endif // LBANN_HAS_HALF
+
+/** @brief Fill a matrix from a counter-based RNG.
+ *
+ *  Each process generates its local entries from the global entry
+ *  indices, with OpenMP threads on the CPU or a kernel on the GPU.
+ *  One seed is drawn from the global generator and shared over the
+ *  grid, so redundant copies agree and the entries do not depend on
+ *  the matrix distribution.
+ */
+template <typename TensorDataType>
+void philox_fill(El::AbstractDistMatrix<TensorDataType>& mat,
+                 El::Int m, El::Int n,
+                 philox::distribution dist,
+                 double a, double b) {
+  mat.Resize(m, n);
+  uint64_t seed = get_philox_seed();
+  MPI_Bcast(&seed, 1, MPI_UINT64_T, 0,
+            mat.Grid().ViewingComm().GetMPIComm());
+  philox_fill_impl<TensorDataType>::apply(mat, dist, a, b, seed);
+}
+
+} // namespace
+
 template <typename TensorDataType>
 void gaussian_fill(El::AbstractDistMatrix<TensorDataType>& mat, El::Int m, El::Int n,
                    TensorDataType mean, TensorDataType stddev) {
-#ifndef LBANN_DETERMINISTIC
-  El::Gaussian(mat, m, n, mean, stddev);
-#else
-  gaussian_fill_procdet(mat, m, n, mean, stddev);
-#endif  // LBANN_PARALLEL_DETERMINISTIC
+  philox_fill(mat, m, n, philox::distribution::gaussian,
+              static_cast<double>(mean), static_cast<double>(stddev));
 }
 
 template <typename TensorDataType>
 void bernoulli_fill(El::AbstractDistMatrix<TensorDataType>& mat, El::Int m, El::Int n, double p) {
-#ifndef LBANN_DETERMINISTIC
-  El::Bernoulli(mat, m, n, p);
-#else
-  bernoulli_fill_procdet(mat, m, n, p);
-#endif  // LBANN_PARALLEL_DETERMINISTIC
+  philox_fill(mat, m, n, philox::distribution::bernoulli, p, 0.);
 }
 
 template <typename TensorDataType>
 void uniform_fill(El::AbstractDistMatrix<TensorDataType>& mat, El::Int m, El::Int n,
                   TensorDataType center, TensorDataType radius) {
-#ifndef LBANN_DETERMINISTIC
-  El::Uniform(mat, m, n, center, radius);
-#else
-  uniform_fill_procdet(mat, m, n, center, radius);
-#endif  // LBANN_PARALLEL_DETERMINISTIC
+  philox_fill(mat, m, n, philox::distribution::uniform,
+              static_cast<double>(center), static_cast<double>(radius));
 }
 
 template <typename TensorDataType>
 void gaussian_fill_procdet(El::AbstractDistMatrix<TensorDataType>& mat, El::Int m, El::Int n,
                            TensorDataType mean, TensorDataType stddev) {
-#if defined(LBANN_HAS_GPU_FP16) && defined(LBANN_HAS_HALF)
-  using RandDataType = typename std::conditional<
-    El::Or<std::is_same<TensorDataType,cpu_fp16>,
-           std::is_same<TensorDataType,fp16>>::value,
-    float, TensorDataType>::type;
-#elif defined(LBANN_HAS_GPU_FP16)
-  using RandDataType = typename std::conditional<
-    std::is_same<TensorDataType,fp16>::value,
-    float, TensorDataType>::type;
-#elif defined(LBANN_HAS_HALF)
-  using RandDataType = typename std::conditional<
-    std::is_same<TensorDataType,cpu_fp16>::value,
-    float, TensorDataType>::type;
-#else
-  using RandDataType = TensorDataType;
-#endif // LBANN_HAS_GPU_FP16
-
-  CircMatDT<RandDataType, El::Device::CPU> vals(m, n, mat.Grid(), 0);
-  if (vals.Participating()) {
-    auto& local_vals = vals.Matrix();
-    auto& gen = get_generator();
-    std::normal_distribution<RandDataType> dist(mean, stddev);
-    for (El::Int col = 0; col < local_vals.Width(); ++col) {
-      for (El::Int row = 0; row < local_vals.Height(); ++row) {
-        local_vals(row, col) = dist(gen);
-      }
-    }
-  }
-  El::Copy(vals, mat);
+  gaussian_fill(mat, m, n, mean, stddev);
 }
 
 template <typename TensorDataType>
 void bernoulli_fill_procdet(El::AbstractDistMatrix<TensorDataType>& mat, El::Int m, El::Int n, double p) {
-  CircMatDT<TensorDataType, El::Device::CPU> vals(m, n, mat.Grid(), 0);
-  if (vals.Participating()) {
-    auto& local_vals = vals.Matrix();
-    auto& gen = get_generator();
-    std::bernoulli_distribution dist(p);
-    for (El::Int col = 0; col < local_vals.Width(); ++col) {
-      for (El::Int row = 0; row < local_vals.Height(); ++row) {
-        local_vals(row, col) = El::To<TensorDataType>(dist(gen));
-      }
-    }
-  }
-  El::Copy(vals, mat);
+  bernoulli_fill(mat, m, n, p);
 }
 
 template <typename TensorDataType>
 void uniform_fill_procdet(El::AbstractDistMatrix<TensorDataType>& mat, El::Int m, El::Int n,
                           TensorDataType center, TensorDataType radius) {
-#if defined(LBANN_HAS_GPU_FP16) && defined(LBANN_HAS_HALF)
-  using RandDataType = typename std::conditional<
-    El::Or<std::is_same<TensorDataType,cpu_fp16>,
-           std::is_same<TensorDataType,fp16>>::value,
-    float, TensorDataType>::type;
-#elif defined(LBANN_HAS_GPU_FP16)
-  using RandDataType = typename std::conditional<
-    std::is_same<TensorDataType,fp16>::value,
-    float, TensorDataType>::type;
-#elif defined(LBANN_HAS_HALF)
-  using RandDataType = typename std::conditional<
-    std::is_same<TensorDataType,cpu_fp16>::value,
-    float, TensorDataType>::type;
-#else
-  using RandDataType = TensorDataType;
-#endif // LBANN_HAS_GPU_FP16
-
-  CircMatDT<RandDataType, El::Device::CPU> vals(m, n, mat.Grid(), 0);
-  if (vals.Participating()) {
-    auto& local_vals = vals.Matrix();
-    auto& gen = get_generator();
-    std::uniform_real_distribution<RandDataType> dist(center - radius,
-                                                      center + radius);
-    for (El::Int col = 0; col < local_vals.Width(); ++col) {
-      for (El::Int row = 0; row < local_vals.Height(); ++row) {
-        local_vals(row, col) = dist(gen);
-      }
-    }
-  }
-  El::Copy(vals, mat);
+  uniform_fill(mat, m, n, center, radius);
 }
 
 #define PROTO(T)                                                                                                  \
@@ -455,5 +567,14 @@ void uniform_fill_procdet(El::AbstractDistMatrix<TensorDataType>& mat, El::Int m
 #define LBANN_INSTANTIATE_CPU_HALF
 #define LBANN_INSTANTIATE_GPU_HALF
 #include "lbann/macros/instantiate.hpp"
+#undef PROTO
+#undef LBANN_INSTANTIATE_CPU_HALF
+#undef LBANN_INSTANTIATE_GPU_HALF
+
+#define PROTO_DEVICE(T, Device)                                         \
+  template void philox_mask_apply<T, Device>(                           \
+    const El::AbstractDistMatrix<T>&, El::AbstractDistMatrix<T>&,       \
+    double, uint64_t, T, T, T)
+#include "lbann/macros/instantiate_device.hpp"
 
 }  // namespace lbann
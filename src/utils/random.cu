@@ -0,0 +1,162 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/utils/random.hpp"
+#include "lbann/utils/cuda.hpp"
+#include "lbann/utils/philox.hpp"
+
+#include <type_traits>
+
+namespace lbann {
+
+namespace {
+
+template <typename TensorDataType>
+__global__ void philox_mask_kernel(El::Int local_height,
+                                   El::Int local_width,
+                                   El::Int global_height,
+                                   El::Int col_shift, El::Int col_stride,
+                                   El::Int row_shift, El::Int row_stride,
+                                   float keep_prob,
+                                   uint64_t seed,
+                                   TensorDataType keep_scale,
+                                   TensorDataType keep_shift,
+                                   TensorDataType drop_value,
+                                   const TensorDataType* __restrict__ input,
+                                   El::Int input_ldim,
+                                   TensorDataType* __restrict__ output,
+                                   El::Int output_ldim) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int nthreads = blockDim.x * gridDim.x;
+  const El::Int size = local_height * local_width;
+  for (El::Int pos = gid; pos < size; pos += nthreads) {
+    const auto row = pos % local_height;
+    const auto col = pos / local_height;
+    const uint64_t index = ((col_shift + row * col_stride)
+                            + (row_shift + col * row_stride) * global_height);
+    const auto& x = input[row + col * input_ldim];
+    output[row + col * output_ldim] = (philox::uniform(seed, index) < keep_prob
+                                       ? keep_scale * x + keep_shift
+                                       : drop_value);
+  }
+}
+
+template <typename TensorDataType, typename ComputeType>
+__global__ void philox_fill_kernel(El::Int local_height,
+                                   El::Int local_width,
+                                   El::Int global_height,
+                                   El::Int col_shift, El::Int col_stride,
+                                   El::Int row_shift, El::Int row_stride,
+                                   philox::distribution dist,
+                                   ComputeType a, ComputeType b,
+                                   uint64_t seed,
+                                   TensorDataType* __restrict__ mat,
+                                   El::Int mat_ldim) {
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int nthreads = blockDim.x * gridDim.x;
+  const El::Int size = local_height * local_width;
+  for (El::Int pos = gid; pos < size; pos += nthreads) {
+    const auto row = pos % local_height;
+    const auto col = pos / local_height;
+    const uint64_t index = ((col_shift + row * col_stride)
+                            + (row_shift + col * row_stride) * global_height);
+    mat[row + col * mat_ldim] = static_cast<TensorDataType>(
+      philox::sample<ComputeType>(dist, a, b, seed, index));
+  }
+}
+
+} // namespace
+
+template <typename TensorDataType>
+void philox_fill_local(El::Matrix<TensorDataType, El::Device::GPU>& local_mat,
+                       El::Int global_height,
+                       El::Int col_shift, El::Int col_stride,
+                       El::Int row_shift, El::Int row_stride,
+                       philox::distribution dist,
+                       double a, double b,
+                       uint64_t seed) {
+  using ComputeType = typename std::conditional<
+    std::is_same<TensorDataType, double>::value, double, float>::type;
+  const auto& local_height = local_mat.Height();
+  const auto& local_width = local_mat.Width();
+  if (local_height < 1 || local_width < 1) { return; }
+  const El::Int size = local_height * local_width;
+  constexpr El::Int block_size = 256;
+  dim3 block_dims, grid_dims;
+  block_dims.x = block_size;
+  grid_dims.x = (size + block_size - 1) / block_size;
+  CHECK_CUDA(cudaSetDevice(El::GPUManager::Device()));
+  philox_fill_kernel<<<grid_dims, block_dims, 0, El::GPUManager::Stream()>>>(
+    local_height, local_width, global_height,
+    col_shift, col_stride, row_shift, row_stride,
+    dist, static_cast<ComputeType>(a), static_cast<ComputeType>(b), seed,
+    local_mat.Buffer(), local_mat.LDim());
+}
+
+template <typename TensorDataType>
+void philox_mask_apply_local(const El::Matrix<TensorDataType, El::Device::GPU>& input,
+                             El::Matrix<TensorDataType, El::Device::GPU>& output,
+                             El::Int global_height,
+                             El::Int col_shift, El::Int col_stride,
+                             El::Int row_shift, El::Int row_stride,
+                             double keep_prob,
+                             uint64_t seed,
+                             TensorDataType keep_scale,
+                             TensorDataType keep_shift,
+                             TensorDataType drop_value) {
+  const auto& local_height = input.Height();
+  const auto& local_width = input.Width();
+  if (local_height < 1 || local_width < 1) { return; }
+  const El::Int size = local_height * local_width;
+  constexpr El::Int block_size = 256;
+  dim3 block_dims, grid_dims;
+  block_dims.x = block_size;
+  grid_dims.x = (size + block_size - 1) / block_size;
+  CHECK_CUDA(cudaSetDevice(El::GPUManager::Device()));
+  philox_mask_kernel<<<grid_dims, block_dims, 0, El::GPUManager::Stream()>>>(
+    local_height, local_width, global_height,
+    col_shift, col_stride, row_shift, row_stride,
+    static_cast<float>(keep_prob), seed,
+    keep_scale, keep_shift, drop_value,
+    input.LockedBuffer(), input.LDim(),
+    output.Buffer(), output.LDim());
+}
+
+#define PROTO(T)                                                        \
+  template void philox_mask_apply_local<T>(                             \
+    const El::Matrix<T, El::Device::GPU>&, El::Matrix<T, El::Device::GPU>&, \
+    El::Int, El::Int, El::Int, El::Int, El::Int,                        \
+    double, uint64_t, T, T, T);                                         \
+  template void philox_fill_local<T>(                                   \
+    El::Matrix<T, El::Device::GPU>&,                                    \
+    El::Int, El::Int, El::Int, El::Int, El::Int,                        \
+    philox::distribution, double, double, uint64_t)
+
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
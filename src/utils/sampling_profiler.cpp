@@ -0,0 +1,320 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/utils/sampling_profiler.hpp"
+#include "lbann/utils/exception.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif // __linux__
+
+namespace lbann {
+namespace sampling_profiler {
+
+#ifdef __linux__
+
+namespace {
+
+/** Deepest stack recorded. */
+constexpr int max_depth = 64;
+/** Frames of the signal handler and the kernel's signal trampoline
+ *  at the top of each stack. */
+constexpr int skipped_frames = 2;
+
+struct sample {
+  int depth;
+  void* frames[max_depth];
+};
+
+/** Per-thread sample ring, written by the signal handler and read by
+ *  @c write_folded_stacks. */
+struct thread_state {
+  std::string name;
+  pid_t tid = 0;
+  pthread_t thread;
+  bool alive = true;
+  timer_t timer;
+  bool has_timer = false;
+  std::vector<sample> ring;
+  size_t mask = 0;
+  std::atomic<uint64_t> head{0};
+  std::atomic<uint64_t> tail{0};
+  std::atomic<uint64_t> dropped{0};
+};
+
+struct profiler_state {
+  std::mutex mutex;
+  bool running = false;
+  long interval_ns = 0;
+  size_t capacity = 0;
+  struct sigaction prev_action;
+  std::vector<std::unique_ptr<thread_state>> threads;
+  /** Samples drained from the rings, keyed by folded stack. */
+  std::map<std::string, uint64_t> folded;
+  /** Symbol names, keyed by address. */
+  std::unordered_map<void*, std::string> symbols;
+};
+
+profiler_state& state() {
+  static profiler_state s;
+  return s;
+}
+
+thread_local thread_state* this_thread_state = nullptr;
+
+void handle_sigprof(int, siginfo_t*, void*) {
+  const int saved_errno = errno;
+  auto* t = this_thread_state;
+  if (t != nullptr && !t->ring.empty()) {
+    const auto h = t->head.load(std::memory_order_relaxed);
+    if (h - t->tail.load(std::memory_order_acquire) > t->mask) {
+      t->dropped.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      auto& s = t->ring[h & t->mask];
+      s.depth = backtrace(s.frames, max_depth);
+      t->head.store(h + 1, std::memory_order_release);
+    }
+  }
+  errno = saved_errno;
+}
+
+/** Arm a timer on a thread's CPU-time clock. Caller holds the
+ *  lock. */
+void arm_timer(profiler_state& s, thread_state& t) {
+  if (t.has_timer || !t.alive) { return; }
+  if (t.ring.empty()) {
+    t.ring.resize(s.capacity);
+    t.mask = s.capacity - 1;
+  }
+  clockid_t clock;
+  if (pthread_getcpuclockid(t.thread, &clock) != 0) {
+    LBANN_WARNING("could not get CPU clock of thread ", t.name);
+    return;
+  }
+  struct sigevent sev = {};
+  sev.sigev_notify = SIGEV_THREAD_ID;
+  sev.sigev_signo = SIGPROF;
+#ifdef sigev_notify_thread_id
+  sev.sigev_notify_thread_id = t.tid;
+#else
+  sev._sigev_un._tid = t.tid;
+#endif // sigev_notify_thread_id
+  if (timer_create(clock, &sev, &t.timer) != 0) {
+    LBANN_WARNING("could not create profiling timer for thread ", t.name);
+    return;
+  }
+  struct itimerspec spec = {};
+  spec.it_interval.tv_sec = s.interval_ns / 1000000000L;
+  spec.it_interval.tv_nsec = s.interval_ns % 1000000000L;
+  spec.it_value = spec.it_interval;
+  timer_settime(t.timer, 0, &spec, nullptr);
+  t.has_timer = true;
+}
+
+/** Caller holds the lock. */
+void disarm_timer(thread_state& t) {
+  if (t.has_timer) {
+    timer_delete(t.timer);
+    t.has_timer = false;
+  }
+}
+
+const std::string& symbolize(profiler_state& s, void* addr) {
+  auto it = s.symbols.find(addr);
+  if (it != s.symbols.end()) { return it->second; }
+  std::string name;
+  Dl_info info;
+  if (dladdr(addr, &info) != 0 && info.dli_sname != nullptr) {
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr,
+                                          nullptr, &status);
+    name = (status == 0 && demangled != nullptr) ? demangled : info.dli_sname;
+    free(demangled);
+  } else {
+    std::ostringstream ss;
+    if (dladdr(addr, &info) != 0 && info.dli_fname != nullptr) {
+      std::string lib = info.dli_fname;
+      ss << lib.substr(lib.find_last_of('/') + 1) << "+";
+      addr = reinterpret_cast<void*>(
+        reinterpret_cast<char*>(addr) - reinterpret_cast<char*>(info.dli_fbase));
+    }
+    ss << addr;
+    name = ss.str();
+  }
+  // ';' separates frames in folded stacks
+  for (auto& c : name) {
+    if (c == ';') { c = ':'; }
+  }
+  return s.symbols.emplace(addr, std::move(name)).first->second;
+}
+
+/** Move samples from the rings into the folded stacks. Caller holds
+ *  the lock. */
+void drain(profiler_state& s) {
+  for (auto& t : s.threads) {
+    auto tail = t->tail.load(std::memory_order_relaxed);
+    const auto head = t->head.load(std::memory_order_acquire);
+    for (; tail < head; ++tail) {
+      const auto& smp = t->ring[tail & t->mask];
+      std::string key = t->name;
+      // Return addresses point after the call, so step back into it
+      for (int i = smp.depth - 1; i >= skipped_frames; --i) {
+        key += ';';
+        key += symbolize(s, reinterpret_cast<char*>(smp.frames[i]) - 1);
+      }
+      ++s.folded[key];
+      t->tail.store(tail + 1, std::memory_order_release);
+    }
+  }
+}
+
+} // namespace
+
+void start(double frequency, size_t capacity) {
+  auto& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  if (s.running) { return; }
+  if (frequency <= 0) {
+    LBANN_ERROR("invalid sampling frequency (", frequency, ")");
+  }
+  s.interval_ns = static_cast<long>(1e9 / frequency);
+  if (s.capacity == 0) {
+    s.capacity = 1;
+    while (s.capacity < capacity) { s.capacity *= 2; }
+  }
+
+  // backtrace loads the unwinder on its first call, which is not
+  // safe in a signal handler
+  void* frames[1];
+  backtrace(frames, 1);
+
+  struct sigaction action = {};
+  action.sa_sigaction = handle_sigprof;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGPROF, &action, &s.prev_action);
+
+  s.running = true;
+  for (auto& t : s.threads) { arm_timer(s, *t); }
+}
+
+void stop() {
+  auto& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  if (!s.running) { return; }
+  for (auto& t : s.threads) { disarm_timer(*t); }
+  s.running = false;
+  sigaction(SIGPROF, &s.prev_action, nullptr);
+}
+
+bool running() {
+  auto& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  return s.running;
+}
+
+void write_folded_stacks(const std::string& filename) {
+  auto& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  drain(s);
+  std::ofstream out(filename);
+  if (!out) {
+    LBANN_ERROR("could not open ", filename, " for writing");
+  }
+  for (const auto& kv : s.folded) {
+    out << kv.first << " " << kv.second << "\n";
+  }
+}
+
+uint64_t num_dropped() {
+  auto& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  uint64_t dropped = 0;
+  for (const auto& t : s.threads) {
+    dropped += t->dropped.load(std::memory_order_relaxed);
+  }
+  return dropped;
+}
+
+thread_registration::thread_registration(const std::string& name) {
+  auto& s = state();
+  std::unique_ptr<thread_state> t(new thread_state);
+  t->name = name;
+  t->tid = static_cast<pid_t>(syscall(SYS_gettid));
+  t->thread = pthread_self();
+  // Touch the thread-local pointer before the handler can run, since
+  // the first access may allocate
+  this_thread_state = t.get();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  if (s.running) { arm_timer(s, *t); }
+  m_state = t.get();
+  s.threads.emplace_back(std::move(t));
+}
+
+thread_registration::~thread_registration() {
+  auto& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  auto* t = static_cast<thread_state*>(m_state);
+  this_thread_state = nullptr;
+  disarm_timer(*t);
+  t->alive = false;
+}
+
+#else // !__linux__
+
+void start(double, size_t) {
+  LBANN_WARNING("the sampling profiler is only supported on Linux");
+}
+void stop() {}
+bool running() { return false; }
+void write_folded_stacks(const std::string&) {}
+uint64_t num_dropped() { return 0; }
+thread_registration::thread_registration(const std::string&)
+  : m_state(nullptr) {}
+thread_registration::~thread_registration() {}
+
+#endif // __linux__
+
+} // namespace sampling_profiler
+} // namespace lbann
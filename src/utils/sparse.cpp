@@ -0,0 +1,230 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lbann/utils/sparse.hpp"
+#include "lbann/utils/exception.hpp"
+#include "lbann/utils/omp_pragma.hpp"
+
+namespace lbann {
+
+namespace {
+
+/** Scale a strided vector, overwriting it if the scale is zero. */
+template <typename TensorDataType>
+void scale_vector(El::Int size, TensorDataType beta,
+                  TensorDataType* x, El::Int stride) {
+  const auto zero = El::TypeTraits<TensorDataType>::Zero();
+  const auto one = El::TypeTraits<TensorDataType>::One();
+  if (beta == zero) {
+    for (El::Int i = 0; i < size; ++i) { x[i*stride] = zero; }
+  } else if (beta != one) {
+    for (El::Int i = 0; i < size; ++i) { x[i*stride] *= beta; }
+  }
+}
+
+} // namespace <anon>
+
+template <typename TensorDataType>
+void compress_mini_batch(
+  const El::Matrix<TensorDataType, El::Device::CPU>& dense,
+  sparse_mini_batch<TensorDataType>& sparse) {
+  const auto zero = El::TypeTraits<TensorDataType>::Zero();
+  const El::Int height = dense.Height();
+  const El::Int width = dense.Width();
+  const El::Int ldim = dense.LDim();
+  const auto* __restrict__ dense_buffer = dense.LockedBuffer();
+  sparse.num_features = height;
+  sparse.num_samples = width;
+
+  // Count nonzeros in each sample
+  sparse.row_offsets.assign(width+1, 0);
+  LBANN_OMP_PARALLEL_FOR
+  for (El::Int col = 0; col < width; ++col) {
+    El::Int count = 0;
+    for (El::Int row = 0; row < height; ++row) {
+      if (dense_buffer[row + col*ldim] != zero) { ++count; }
+    }
+    sparse.row_offsets[col+1] = count;
+  }
+  for (El::Int col = 0; col < width; ++col) {
+    sparse.row_offsets[col+1] += sparse.row_offsets[col];
+  }
+
+  // Copy nonzeros
+  const El::Int nnz = sparse.row_offsets[width];
+  sparse.col_indices.resize(nnz);
+  sparse.values.resize(nnz);
+  LBANN_OMP_PARALLEL_FOR
+  for (El::Int col = 0; col < width; ++col) {
+    El::Int pos = sparse.row_offsets[col];
+    for (El::Int row = 0; row < height; ++row) {
+      const auto& x = dense_buffer[row + col*ldim];
+      if (x != zero) {
+        sparse.col_indices[pos] = row;
+        sparse.values[pos] = x;
+        ++pos;
+      }
+    }
+  }
+
+}
+
+template <typename TensorDataType>
+void sparse_gemm(El::Orientation orientation_w,
+                 TensorDataType alpha,
+                 const El::Matrix<TensorDataType, El::Device::CPU>& W,
+                 const sparse_mini_batch<TensorDataType>& input,
+                 TensorDataType beta,
+                 El::Matrix<TensorDataType, El::Device::CPU>& Y) {
+  const bool transpose = (orientation_w != El::NORMAL);
+  const El::Int height = Y.Height();
+  const El::Int width = Y.Width();
+  if ((transpose ? W.Height() : W.Width()) != input.num_features
+      || (transpose ? W.Width() : W.Height()) != height
+      || input.num_samples != width) {
+    LBANN_ERROR("attempted sparse GEMM with a ",
+                W.Height(),"x",W.Width()," matrix",
+                (transpose ? " (transposed)" : ""),", ",
+                "a ",input.num_features,"x",input.num_samples," ",
+                "sparse mini-batch, and ",
+                "a ",height,"x",width," output");
+  }
+  const auto* __restrict__ w_buffer = W.LockedBuffer();
+  const El::Int w_ldim = W.LDim();
+  auto* __restrict__ y_buffer = Y.Buffer();
+  const El::Int y_ldim = Y.LDim();
+  LBANN_OMP_PARALLEL_FOR
+  for (El::Int col = 0; col < width; ++col) {
+    auto* __restrict__ y = &y_buffer[col*y_ldim];
+    scale_vector(height, beta, y, 1);
+    const El::Int begin = input.row_offsets[col];
+    const El::Int end = input.row_offsets[col+1];
+    if (transpose) {
+      // Dot products with columns of W
+      for (El::Int row = 0; row < height; ++row) {
+        const auto* __restrict__ w = &w_buffer[row*w_ldim];
+        auto sum = El::TypeTraits<TensorDataType>::Zero();
+        for (El::Int pos = begin; pos < end; ++pos) {
+          sum += input.values[pos] * w[input.col_indices[pos]];
+        }
+        y[row] += alpha * sum;
+      }
+    } else {
+      // Linear combination of columns of W
+      for (El::Int pos = begin; pos < end; ++pos) {
+        const auto* __restrict__ w = &w_buffer[input.col_indices[pos]*w_ldim];
+        const auto scale = alpha * input.values[pos];
+        for (El::Int row = 0; row < height; ++row) {
+          y[row] += scale * w[row];
+        }
+      }
+    }
+  }
+}
+
+template <typename TensorDataType>
+void sparse_gemm_gradient(bool transpose,
+                          TensorDataType alpha,
+                          const El::Matrix<TensorDataType, El::Device::CPU>& D,
+                          const sparse_mini_batch<TensorDataType>& input,
+                          TensorDataType beta,
+                          El::Matrix<TensorDataType, El::Device::CPU>& G) {
+  const El::Int num_features = input.num_features;
+  const El::Int num_samples = input.num_samples;
+  const El::Int size = D.Height();
+  if (D.Width() != num_samples
+      || (transpose ? G.Height() : G.Width()) != num_features
+      || (transpose ? G.Width() : G.Height()) != size) {
+    LBANN_ERROR("attempted sparse GEMM gradient with a ",
+                D.Height(),"x",D.Width()," matrix, ",
+                "a ",input.num_features,"x",input.num_samples," ",
+                "sparse mini-batch, and ",
+                "a ",G.Height(),"x",G.Width()," output",
+                (transpose ? " (transposed)" : ""));
+  }
+
+  // Group nonzeros by feature, so each feature's gradient is
+  // accumulated by one thread
+  std::vector<El::Int> feature_offsets(num_features+1, 0);
+  for (const auto& feature : input.col_indices) {
+    ++feature_offsets[feature+1];
+  }
+  for (El::Int k = 0; k < num_features; ++k) {
+    feature_offsets[k+1] += feature_offsets[k];
+  }
+  std::vector<El::Int> samples(input.num_nonzeros());
+  std::vector<TensorDataType> values(input.num_nonzeros());
+  {
+    std::vector<El::Int> pos(feature_offsets.begin(), feature_offsets.end()-1);
+    for (El::Int col = 0; col < num_samples; ++col) {
+      for (El::Int i = input.row_offsets[col];
+           i < input.row_offsets[col+1];
+           ++i) {
+        const auto& p = pos[input.col_indices[i]]++;
+        samples[p] = col;
+        values[p] = input.values[i];
+      }
+    }
+  }
+
+  // Accumulate outer products
+  const auto* __restrict__ d_buffer = D.LockedBuffer();
+  const El::Int d_ldim = D.LDim();
+  auto* __restrict__ g_buffer = G.Buffer();
+  const El::Int g_ldim = G.LDim();
+  const El::Int g_stride = transpose ? g_ldim : 1;
+  LBANN_OMP_PARALLEL_FOR
+  for (El::Int k = 0; k < num_features; ++k) {
+    auto* __restrict__ g = (transpose
+                            ? &g_buffer[k]
+                            : &g_buffer[k*g_ldim]);
+    scale_vector(size, beta, g, g_stride);
+    for (El::Int p = feature_offsets[k]; p < feature_offsets[k+1]; ++p) {
+      const auto* __restrict__ d = &d_buffer[samples[p]*d_ldim];
+      const auto scale = alpha * values[p];
+      for (El::Int i = 0; i < size; ++i) {
+        g[i*g_stride] += scale * d[i];
+      }
+    }
+  }
+
+}
+
+#define PROTO(T)                                                        \
+  template struct sparse_mini_batch<T>;                                 \
+  template void compress_mini_batch<T>(                                 \
+    const El::Matrix<T, El::Device::CPU>&, sparse_mini_batch<T>&);      \
+  template void sparse_gemm<T>(                                         \
+    El::Orientation, T, const El::Matrix<T, El::Device::CPU>&,          \
+    const sparse_mini_batch<T>&, T, El::Matrix<T, El::Device::CPU>&);   \
+  template void sparse_gemm_gradient<T>(                                \
+    bool, T, const El::Matrix<T, El::Device::CPU>&,                     \
+    const sparse_mini_batch<T>&, T, El::Matrix<T, El::Device::CPU>&)
+
+#define LBANN_INSTANTIATE_CPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
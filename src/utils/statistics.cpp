@@ -73,18 +73,34 @@ void entrywise_mean_and_stdev(const AbsDistMat& data,
   const El::Int local_height = data.LocalHeight();
   const El::Int local_width = data.LocalWidth();
 
-  // Local matrices
-  const Mat& local_data = data.LockedMatrix();
-
   // Compute sums over matrix entries
   DataType sum = 0;
   DataType sqsum = 0;
-  LBANN_OMP_PARALLEL_FOR_ARGS(reduction(+:sum,sqsum) collapse(2))
-  for(El::Int col = 0; col < local_width; ++col) {
-    for(El::Int row = 0; row < local_height; ++row) {
-      const DataType val = local_data(row, col);
-      sum += val;
-      sqsum += val * val;
+#ifdef LBANN_HAS_GPU
+  if (data.GetLocalDevice() == El::Device::GPU) {
+    // Reduce on the device and only copy the results to the host
+    if (local_height > 0 && local_width > 0) {
+      El::Matrix<double, El::Device::GPU> workspace, stats(4, 1);
+      local_stats_gpu(
+        static_cast<const El::Matrix<DataType, El::Device::GPU>&>(data.LockedMatrix()),
+        workspace, stats);
+      El::Matrix<double, El::Device::CPU> host_stats;
+      El::Copy(stats, host_stats);
+      sum = host_stats(0, 0);
+      sqsum = host_stats(1, 0);
+    }
+  }
+  else
+#endif // LBANN_HAS_GPU
+  {
+    const Mat& local_data = static_cast<const Mat&>(data.LockedMatrix());
+    LBANN_OMP_PARALLEL_FOR_ARGS(reduction(+:sum,sqsum) collapse(2))
+    for(El::Int col = 0; col < local_width; ++col) {
+      for(El::Int row = 0; row < local_height; ++row) {
+        const DataType val = local_data(row, col);
+        sum += val;
+        sqsum += val * val;
+      }
     }
   }
   DataType sum_sqsum[2] = {sum, sqsum};  // Pack to do one allreduce.
@@ -418,4 +434,45 @@ void columnwise_covariance(const AbsDistMat& data1,
 }
 
 
+running_statistics::running_statistics(size_t num_bins, double lo, double hi)
+  : m_lo(lo), m_hi(hi), m_histogram(num_bins, 0.0) {
+  if (num_bins > 0 && !(hi > lo)) {
+    LBANN_ERROR("histogram range [", lo, ", ", hi, ") is empty");
+  }
+}
+
+void running_statistics::merge(const running_statistics& other) {
+  if (other.m_histogram.size() != m_histogram.size()
+      || (!m_histogram.empty()
+          && (other.m_lo != m_lo || other.m_hi != m_hi))) {
+    LBANN_ERROR("cannot merge statistics with different histograms");
+  }
+  if (other.m_count == 0) { return; }
+  const double count = m_count + other.m_count;
+  const double delta = other.m_mean - m_mean;
+  m_mean += delta * other.m_count / count;
+  m_m2 += other.m_m2 + delta * delta * m_count * other.m_count / count;
+  m_count = count;
+  m_min = std::min(m_min, other.m_min);
+  m_max = std::max(m_max, other.m_max);
+  for (size_t i = 0; i < m_histogram.size(); ++i) {
+    m_histogram[i] += other.m_histogram[i];
+  }
+}
+
+void running_statistics::pack(std::vector<double>& buffer) const {
+  buffer.insert(buffer.end(), {m_count, m_mean, m_m2, m_min, m_max});
+  buffer.insert(buffer.end(), m_histogram.begin(), m_histogram.end());
+}
+
+const double* running_statistics::unpack(const double* buffer) {
+  m_count = buffer[0];
+  m_mean = buffer[1];
+  m_m2 = buffer[2];
+  m_min = buffer[3];
+  m_max = buffer[4];
+  std::copy(buffer + 5, buffer + 5 + m_histogram.size(), m_histogram.begin());
+  return buffer + packed_size();
+}
+
 }
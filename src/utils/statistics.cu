@@ -0,0 +1,252 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/utils/statistics.hpp"
+#include "lbann/utils/cuda.hpp"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace lbann {
+
+namespace {
+
+/** Upper bound on blocks for the first pass of local_stats_gpu. */
+constexpr El::Int max_stats_blocks = 256;
+
+template <typename T> __device__ __forceinline__
+double to_double(const T& x) { return static_cast<double>(x); }
+#ifdef LBANN_HAS_GPU_FP16
+template <> __device__ __forceinline__
+double to_double<__half>(const __half& x) { return __half2float(x); }
+#endif // LBANN_HAS_GPU_FP16
+
+/** @brief Sum, sum of squares, min, and max for each CUDA block.
+ *
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: (at most max_stats_blocks) x 1 x 1
+ *
+ *  partials is a 4 x gridDim.x matrix.
+ */
+template <El::Int bsize, typename TensorDataType>
+__global__ void partial_stats_kernel(El::Int height,
+                                     El::Int width,
+                                     const TensorDataType* __restrict__ vals,
+                                     El::Int vals_ldim,
+                                     double* __restrict__ partials) {
+  const El::Int tid = threadIdx.x;
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int nthreads = blockDim.x * gridDim.x;
+
+  // Local statistics for each thread
+  double sum = 0.0, sqsum = 0.0, min = DBL_MAX, max = -DBL_MAX;
+  const El::Int size = height * width;
+  for (El::Int i = gid; i < size; i += nthreads) {
+    const auto& row = i % height;
+    const auto& col = i / height;
+    const double val = to_double(vals[row + col * vals_ldim]);
+    sum += val;
+    sqsum += val * val;
+    min = cuda::min(min, val);
+    max = cuda::max(max, val);
+  }
+
+  // Shared memory reduction to get statistics for each block
+  __shared__ double shared_sum[bsize];
+  __shared__ double shared_sqsum[bsize];
+  __shared__ double shared_min[bsize];
+  __shared__ double shared_max[bsize];
+  shared_sum[tid] = sum;
+  shared_sqsum[tid] = sqsum;
+  shared_min[tid] = min;
+  shared_max[tid] = max;
+  for (El::Int stride = bsize / 2; stride > 0; stride /= 2) {
+    __syncthreads();
+    if (tid < stride) {
+      shared_sum[tid] += shared_sum[tid + stride];
+      shared_sqsum[tid] += shared_sqsum[tid + stride];
+      shared_min[tid] = cuda::min(shared_min[tid], shared_min[tid + stride]);
+      shared_max[tid] = cuda::max(shared_max[tid], shared_max[tid + stride]);
+    }
+  }
+  if (tid == 0) {
+    partials[4 * blockIdx.x] = shared_sum[0];
+    partials[4 * blockIdx.x + 1] = shared_sqsum[0];
+    partials[4 * blockIdx.x + 2] = shared_min[0];
+    partials[4 * blockIdx.x + 3] = shared_max[0];
+  }
+
+}
+
+/** @brief Combine per-block statistics.
+ *
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Grid dimensions: 1 x 1 x 1
+ */
+template <El::Int bsize>
+__global__ void combine_stats_kernel(El::Int num_partials,
+                                     const double* __restrict__ partials,
+                                     double* __restrict__ stats) {
+  const El::Int tid = threadIdx.x;
+  __shared__ double shared_sum[bsize];
+  __shared__ double shared_sqsum[bsize];
+  __shared__ double shared_min[bsize];
+  __shared__ double shared_max[bsize];
+  double sum = 0.0, sqsum = 0.0, min = DBL_MAX, max = -DBL_MAX;
+  for (El::Int i = tid; i < num_partials; i += bsize) {
+    sum += partials[4 * i];
+    sqsum += partials[4 * i + 1];
+    min = cuda::min(min, partials[4 * i + 2]);
+    max = cuda::max(max, partials[4 * i + 3]);
+  }
+  shared_sum[tid] = sum;
+  shared_sqsum[tid] = sqsum;
+  shared_min[tid] = min;
+  shared_max[tid] = max;
+  for (El::Int stride = bsize / 2; stride > 0; stride /= 2) {
+    __syncthreads();
+    if (tid < stride) {
+      shared_sum[tid] += shared_sum[tid + stride];
+      shared_sqsum[tid] += shared_sqsum[tid + stride];
+      shared_min[tid] = cuda::min(shared_min[tid], shared_min[tid + stride]);
+      shared_max[tid] = cuda::max(shared_max[tid], shared_max[tid + stride]);
+    }
+  }
+  if (tid == 0) {
+    stats[0] = shared_sum[0];
+    stats[1] = shared_sqsum[0];
+    stats[2] = shared_min[0];
+    stats[3] = shared_max[0];
+  }
+}
+
+/** @brief Count matrix entries in histogram buckets.
+ *
+ *  Each block accumulates counts in shared memory before adding them
+ *  to the output, so popular buckets do not serialize on global
+ *  atomics.
+ *
+ *  Block dimensions: bsize x 1 x 1
+ *
+ *  Dynamic shared memory: (num_edges + 1) unsigned ints
+ */
+template <El::Int bsize, typename TensorDataType>
+__global__ void histogram_kernel(El::Int height,
+                                 El::Int width,
+                                 const TensorDataType* __restrict__ vals,
+                                 El::Int vals_ldim,
+                                 El::Int num_edges,
+                                 const double* __restrict__ edges,
+                                 double* __restrict__ counts) {
+  extern __shared__ unsigned int shared_counts[];
+  const El::Int tid = threadIdx.x;
+  const El::Int gid = threadIdx.x + blockIdx.x * blockDim.x;
+  const El::Int nthreads = blockDim.x * gridDim.x;
+  for (El::Int i = tid; i <= num_edges; i += bsize) {
+    shared_counts[i] = 0;
+  }
+  __syncthreads();
+  const El::Int size = height * width;
+  for (El::Int i = gid; i < size; i += nthreads) {
+    const auto& row = i % height;
+    const auto& col = i / height;
+    const double val = to_double(vals[row + col * vals_ldim]);
+    // Upper bound
+    El::Int lo = 0, hi = num_edges;
+    while (lo < hi) {
+      const El::Int mid = (lo + hi) / 2;
+      if (edges[mid] <= val) { lo = mid + 1; }
+      else { hi = mid; }
+    }
+    atomicAdd(&shared_counts[lo], 1u);
+  }
+  __syncthreads();
+  for (El::Int i = tid; i <= num_edges; i += bsize) {
+    if (shared_counts[i] > 0) {
+      cuda::atomic_add(&counts[i], static_cast<double>(shared_counts[i]));
+    }
+  }
+}
+
+} // namespace
+
+template <typename TensorDataType>
+void local_stats_gpu(const El::Matrix<TensorDataType, El::Device::GPU>& mat,
+                     El::Matrix<double, El::Device::GPU>& workspace,
+                     El::Matrix<double, El::Device::GPU>& stats) {
+  constexpr El::Int block_size = 256;
+  const El::Int size = mat.Height() * mat.Width();
+  const El::Int grid_size = std::min((size + block_size - 1) / block_size,
+                                     max_stats_blocks);
+  if (workspace.Height() != 4 || workspace.Width() < max_stats_blocks) {
+    workspace.Resize(4, max_stats_blocks);
+  }
+  auto&& stream = El::GPUManager::Stream();
+  CHECK_CUDA(cudaSetDevice(El::GPUManager::Device()));
+  partial_stats_kernel<block_size>
+    <<<grid_size, block_size, 0, stream>>>(
+      mat.Height(), mat.Width(), mat.LockedBuffer(), mat.LDim(),
+      workspace.Buffer());
+  combine_stats_kernel<block_size>
+    <<<1, block_size, 0, stream>>>(
+      grid_size, workspace.LockedBuffer(), stats.Buffer());
+}
+
+template <typename TensorDataType>
+void local_histogram_gpu(const El::Matrix<TensorDataType, El::Device::GPU>& mat,
+                         const El::Matrix<double, El::Device::GPU>& edges,
+                         El::Matrix<double, El::Device::GPU>& counts) {
+  El::Zero(counts);
+  constexpr El::Int block_size = 256;
+  const El::Int size = mat.Height() * mat.Width();
+  const El::Int grid_size = std::min((size + block_size - 1) / block_size,
+                                     El::Int{1024});
+  const El::Int num_edges = edges.Height();
+  auto&& stream = El::GPUManager::Stream();
+  CHECK_CUDA(cudaSetDevice(El::GPUManager::Device()));
+  histogram_kernel<block_size>
+    <<<grid_size, block_size, (num_edges + 1) * sizeof(unsigned int), stream>>>(
+      mat.Height(), mat.Width(), mat.LockedBuffer(), mat.LDim(),
+      num_edges, edges.LockedBuffer(), counts.Buffer());
+}
+
+#define PROTO(T)                                                        \
+  template void local_stats_gpu<T>(                                     \
+    const El::Matrix<T, El::Device::GPU>&,                              \
+    El::Matrix<double, El::Device::GPU>&,                               \
+    El::Matrix<double, El::Device::GPU>&);                              \
+  template void local_histogram_gpu<T>(                                 \
+    const El::Matrix<T, El::Device::GPU>&,                              \
+    const El::Matrix<double, El::Device::GPU>&,                         \
+    El::Matrix<double, El::Device::GPU>&)
+
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+} // namespace lbann
@@ -26,14 +26,26 @@
 
 #include "lbann/utils/summary.hpp"
 
+#include <cmath>
+
 namespace lbann {
 
 #ifdef LBANN_HAS_TBINF
 
+namespace {
+
+#ifdef LBANN_HAS_GPU
+/** Matrices whose statistics can be pending on the device at once. */
+constexpr El::Int device_stats_capacity = 256;
+#endif // LBANN_HAS_GPU
+
+} // namespace
+
 lbann_summary::lbann_summary(std::string logdir, lbann_comm *comm)
   : m_comm(comm) {
   if (m_comm->am_world_master()) {
     m_sw = new TBinf::SummaryWriter(logdir);
+    m_writer = std::thread(&lbann_summary::write_events, this);
   } else {
     m_sw = nullptr;
   }
@@ -42,282 +54,268 @@ lbann_summary::lbann_summary(std::string logdir, lbann_comm *comm)
 
 lbann_summary::~lbann_summary() {
   flush();
+  if (m_writer.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(m_writer_mutex);
+      m_writer_stop = true;
+    }
+    m_writer_cv.notify_one();
+    m_writer.join();
+  }
   if (m_sw != nullptr) {
     delete m_sw;
   }
 }
 
-void lbann_summary::flush() {
-  flush_means();
-  flush_mins();
-  flush_maxes();
-  flush_stdevs();
-  flush_scalars();
-  flush_sum_scalars();
-  flush_scalar_alls();
-  flush_histograms();
-  if (m_sw != nullptr) {
+void lbann_summary::write_events() {
+  std::unique_lock<std::mutex> lock(m_writer_mutex);
+  while (true) {
+    m_writer_cv.wait(lock, [this] {
+      return m_writer_stop || !m_writer_queue.empty();
+    });
+    if (m_writer_queue.empty()) {
+      return;
+    }
+    event_batch batch = std::move(m_writer_queue.front());
+    m_writer_queue.pop_front();
+    lock.unlock();
+    for (const auto& e : batch.scalars) {
+      m_sw->add_scalar(e.tag, e.value, e.step);
+    }
+    for (const auto& e : batch.histograms) {
+      m_sw->add_histogram(e.tag, e.buckets, e.min, e.max, e.num,
+                          e.sum, e.sqsum, e.step);
+    }
     m_sw->flush();
+    lock.lock();
   }
 }
 
-void lbann_summary::flush_means() {
-  if (m_pending_means.empty()) {
-    return;
+#ifdef LBANN_HAS_GPU
+El::Int lbann_summary::next_device_slot() {
+  if (m_device_stats.IsEmpty()) {
+    m_device_stats.Resize(NUM_STAT_FIELDS, device_stats_capacity);
   }
-  std::vector<float> local_sums;
-  for (const auto& op : m_pending_means) {
-    local_sums.push_back(op.local);
+  if (m_num_device_stats == m_device_stats.Width()) {
+    resolve_device_stats();
   }
-  if (m_comm->am_trainer_master()) {
-    std::vector<float> global_sums(local_sums.size());
-    m_comm->trainer_reduce(local_sums.data(), local_sums.size(),
-                           global_sums.data());
-    // Compute the means in-place.
-    for (unsigned i = 0; i < global_sums.size(); ++i) {
-      global_sums[i] /= m_pending_means[i].num;
-    }
-    gather_scalar_summary(m_pending_means, global_sums);
-  } else {
-    m_comm->trainer_reduce(local_sums.data(), local_sums.size(),
-                         m_comm->get_trainer_master());
-  }
-  m_pending_means.clear();
+  return m_num_device_stats++;
 }
+#endif // LBANN_HAS_GPU
 
-void lbann_summary::flush_mins() {
-  if (m_pending_mins.empty()) {
+void lbann_summary::resolve_device_stats() {
+#ifdef LBANN_HAS_GPU
+  if (m_num_device_stats == 0) {
     return;
   }
-  std::vector<float> local_mins;
-  for (const auto& op : m_pending_mins) {
-    local_mins.push_back(op.local);
-  }
-  if (m_comm->am_trainer_master()) {
-    std::vector<float> global_mins(local_mins.size());
-    m_comm->trainer_reduce(local_mins.data(), local_mins.size(),
-                           global_mins.data(), El::mpi::MIN);
-    gather_scalar_summary(m_pending_mins, global_mins);
-  } else {
-    m_comm->trainer_reduce(local_mins.data(), local_mins.size(),
-                           m_comm->get_trainer_master(), El::mpi::MIN);
+  // One copy (and synchronization) for all pending statistics
+  El::Matrix<double, El::Device::CPU> stats;
+  El::Copy(m_device_stats(El::ALL, El::IR(0, m_num_device_stats)), stats);
+  const auto resolve = [&stats](std::vector<pending_op>& ops,
+                                int field, int field2) {
+    for (auto& op : ops) {
+      if (op.slot >= 0) {
+        op.local = stats(field, op.slot);
+        if (field2 >= 0) { op.local2 = stats(field2, op.slot); }
+        op.slot = -1;
+      }
+    }
+  };
+  resolve(m_pending_means, STAT_SUM, -1);
+  resolve(m_pending_mins, STAT_MIN, -1);
+  resolve(m_pending_maxes, STAT_MAX, -1);
+  resolve(m_pending_stdevs, STAT_SUM, STAT_SQSUM);
+  resolve(m_pending_sum_scalars, STAT_SQSUM, -1);
+  for (auto& op : m_pending_histograms) {
+    if (op.slot >= 0) {
+      op.sum = stats(STAT_SUM, op.slot);
+      op.sqsum = stats(STAT_SQSUM, op.slot);
+      op.min = stats(STAT_MIN, op.slot);
+      op.max = stats(STAT_MAX, op.slot);
+      op.slot = -1;
+    }
+    if (!op.device_buckets.IsEmpty()) {
+      El::Matrix<double, El::Device::CPU> buckets;
+      El::Copy(op.device_buckets, buckets);
+      op.buckets.assign(buckets.LockedBuffer(),
+                        buckets.LockedBuffer() + buckets.Height());
+      op.device_buckets.Empty();
+    }
   }
-  m_pending_mins.clear();
+  m_num_device_stats = 0;
+#endif // LBANN_HAS_GPU
 }
 
-void lbann_summary::flush_maxes() {
-  if (m_pending_maxes.empty()) {
-    return;
-  }
-  std::vector<float> local_maxes;
-  for (const auto& op : m_pending_maxes) {
-    local_maxes.push_back(op.local);
-  }
-  if (m_comm->am_trainer_master()) {
-    std::vector<float> global_maxes(local_maxes.size());
-    m_comm->trainer_reduce(local_maxes.data(), local_maxes.size(),
-                           global_maxes.data(), El::mpi::MAX);
-    gather_scalar_summary(m_pending_maxes, global_maxes);
-  } else {
-    m_comm->trainer_reduce(local_maxes.data(), local_maxes.size(),
-                           m_comm->get_trainer_master(), El::mpi::MAX);
-  }
-  m_pending_maxes.clear();
-}
+void lbann_summary::flush() {
+  resolve_device_stats();
 
-void lbann_summary::flush_stdevs() {
-  if (m_pending_stdevs.empty()) {
-    return;
-  }
-  std::vector<float> local_sums;
-  std::vector<float> local_sqsums;
+  // Pack everything that is reduced within the trainer into one sum
+  // reduction and one max reduction (minima are negated)
+  std::vector<double> sums, maxes;
+  for (const auto& op : m_pending_means) { sums.push_back(op.local); }
   for (const auto& op : m_pending_stdevs) {
-    local_sums.push_back(op.local);
-    local_sqsums.push_back(op.local2);
+    sums.push_back(op.local);
+    sums.push_back(op.local2);
   }
-  if (m_comm->am_trainer_master()) {
-    // Compute the model sample standard deviation as:
-    // sqrt[1/(n-1) (sqsum - (1/n)*sum^2)]
-    // The n-1 is to use an unbiased variance estimate.
-    // This unrolls the usual formulation of standard deviation some, to avoid
-    // global operations when pushing the operation.
-    std::vector<float> global_sums(local_sums.size());
-    std::vector<float> global_sqsums(local_sqsums.size());
-    m_comm->trainer_reduce(local_sums.data(), local_sums.size(),
-                           global_sums.data());
-    m_comm->trainer_reduce(local_sqsums.data(), local_sqsums.size(),
-                           global_sqsums.data());
-    // Re-use the global_sums vector for the standard deviation.
-    for (unsigned i = 0; i < global_sums.size(); ++i) {
-      global_sums[i] = El::Sqrt(
-                         (global_sqsums[i] -
-                          global_sums[i] * global_sums[i] / m_pending_stdevs[i].num) /
-                         (m_pending_stdevs[i].num - 1));
-    }
-    gather_scalar_summary(m_pending_stdevs, global_sums);
-  } else {
-    m_comm->trainer_reduce(local_sums.data(), local_sums.size(),
-                         m_comm->get_trainer_master());
-    m_comm->trainer_reduce(local_sqsums.data(), local_sqsums.size(),
-                         m_comm->get_trainer_master());
+  for (const auto& op : m_pending_sum_scalars) { sums.push_back(op.local); }
+  for (const auto& op : m_pending_histograms) {
+    sums.push_back(op.sum);
+    sums.push_back(op.sqsum);
+    sums.insert(sums.end(), op.buckets.begin(), op.buckets.end());
   }
-  m_pending_stdevs.clear();
-}
-
-void lbann_summary::flush_scalars() {
-  if (m_pending_scalars.empty()) {
-    return;
+  for (const auto& op : m_pending_mins) { maxes.push_back(-op.local); }
+  for (const auto& op : m_pending_maxes) { maxes.push_back(op.local); }
+  for (const auto& op : m_pending_histograms) {
+    maxes.push_back(-op.min);
+    maxes.push_back(op.max);
   }
-  if (m_comm->am_trainer_master()) {
-    std::vector<float> local_scalars;
-    for (const auto& op : m_pending_scalars) {
-      local_scalars.push_back(op.local);
+  const bool trainer_master = m_comm->am_trainer_master();
+  std::vector<double> global_sums(trainer_master ? sums.size() : 0);
+  std::vector<double> global_maxes(trainer_master ? maxes.size() : 0);
+  if (!sums.empty()) {
+    if (trainer_master) {
+      m_comm->trainer_reduce(sums.data(), sums.size(), global_sums.data());
+    } else {
+      m_comm->trainer_reduce(sums.data(), sums.size(),
+                             m_comm->get_trainer_master());
     }
-    gather_scalar_summary(m_pending_scalars, local_scalars);
-  }
-  m_pending_scalars.clear();
-}
-
-void lbann_summary::flush_sum_scalars() {
-  if (m_pending_sum_scalars.empty()) {
-    return;
-  }
-  std::vector<float> local_sums;
-  for (const auto& op : m_pending_sum_scalars) {
-    local_sums.push_back(op.local);
   }
-  if (m_comm->am_trainer_master()) {
-    std::vector<float> global_sums(local_sums.size());
-    m_comm->trainer_reduce(local_sums.data(), local_sums.size(),
-                           global_sums.data());
-    gather_scalar_summary(m_pending_sum_scalars, global_sums);
-  } else {
-    m_comm->trainer_reduce(local_sums.data(), local_sums.size(),
-                           m_comm->get_trainer_master());
+  if (!maxes.empty()) {
+    if (trainer_master) {
+      m_comm->trainer_reduce(maxes.data(), maxes.size(),
+                             global_maxes.data(), El::mpi::MAX);
+    } else {
+      m_comm->trainer_reduce(maxes.data(), maxes.size(),
+                             m_comm->get_trainer_master(), El::mpi::MAX);
+    }
   }
-  m_pending_sum_scalars.clear();
-}
 
-void lbann_summary::flush_scalar_alls() {
-  if (m_pending_scalar_alls.empty()) {
-    return;
-  }
-  // Gather from every process to world master.
-  std::vector<float> local_scalars;
-  for (const auto& op : m_pending_scalar_alls) {
-    local_scalars.push_back(op.local);
-  }
-  if (m_comm->am_world_master()) {
-    std::vector<float> scalars(
-      m_comm->get_procs_in_world()*local_scalars.size());
-    m_comm->gather(local_scalars.data(), local_scalars.size(),
-                   scalars.data(), m_comm->get_world_comm());
-    for (size_t i = 0; i < scalars.size(); ++i) {
-      int rank = i / local_scalars.size();
-      int model = rank / m_comm->get_procs_per_trainer();
-      int pos = i % local_scalars.size();
-      m_sw->add_scalar(
-        prepend_model("rank" + std::to_string(rank) + "/" +
-                      m_pending_scalar_alls[pos].tag, model),
-        scalars[i], m_pending_scalar_alls[pos].step);
+  // Trainer masters compute the summaries and gather them to the
+  // world master in one message
+  if (trainer_master) {
+    std::vector<double> results;
+    size_t i_sum = 0, i_max = 0;
+    for (const auto& op : m_pending_means) {
+      results.push_back(global_sums[i_sum++] / op.num);
+    }
+    for (size_t i = 0; i < m_pending_mins.size(); ++i) {
+      results.push_back(-global_maxes[i_max++]);
+    }
+    for (size_t i = 0; i < m_pending_maxes.size(); ++i) {
+      results.push_back(global_maxes[i_max++]);
+    }
+    for (const auto& op : m_pending_stdevs) {
+      // Compute the model sample standard deviation as:
+      // sqrt[1/(n-1) (sqsum - (1/n)*sum^2)]
+      // The n-1 is to use an unbiased variance estimate.
+      // This unrolls the usual formulation of standard deviation some, to avoid
+      // global operations when pushing the operation.
+      const double sum = global_sums[i_sum++];
+      const double sqsum = global_sums[i_sum++];
+      results.push_back(std::sqrt((sqsum - sum * sum / op.num)
+                                  / (op.num - 1)));
+    }
+    for (const auto& op : m_pending_scalars) { results.push_back(op.local); }
+    for (size_t i = 0; i < m_pending_sum_scalars.size(); ++i) {
+      results.push_back(global_sums[i_sum++]);
+    }
+    for (const auto& op : m_pending_histograms) {
+      results.push_back(-global_maxes[i_max++]);
+      results.push_back(global_maxes[i_max++]);
+      results.push_back(global_sums[i_sum++]);
+      results.push_back(global_sums[i_sum++]);
+      results.insert(results.end(),
+                     global_sums.begin() + i_sum,
+                     global_sums.begin() + i_sum + op.buckets.size());
+      i_sum += op.buckets.size();
     }
-  } else {
-    m_comm->gather(local_scalars.data(), local_scalars.size(),
-                   m_comm->get_world_master(), m_comm->get_world_comm());
-  }
-  m_pending_scalar_alls.clear();
-}
 
-void lbann_summary::flush_histograms() {
-  if (m_pending_histograms.empty()) {
-    return;
-  }
-  std::vector<float> local_mins;
-  std::vector<float> local_maxes;
-  std::vector<float> local_sums;
-  std::vector<float> local_sqsums;
-  std::vector<float> buckets;
-  for (const auto& op : m_pending_histograms) {
-    local_mins.push_back(op.min);
-    local_maxes.push_back(op.max);
-    local_sums.push_back(op.sum);
-    local_sqsums.push_back(op.sqsum);
-    buckets.insert(buckets.end(), op.buckets.begin(), op.buckets.end());
+    if (!results.empty()) {
+      if (m_comm->am_world_master()) {
+        std::vector<double> all_results(
+          m_comm->get_num_trainers() * results.size());
+        m_comm->intertrainer_gather(results.data(), results.size(),
+                                    all_results.data());
+        event_batch batch;
+        for (int model = 0; model < m_comm->get_num_trainers(); ++model) {
+          const double* r = &all_results[model * results.size()];
+          const auto add_scalars = [&](const std::vector<pending_op>& ops) {
+            for (const auto& op : ops) {
+              batch.scalars.push_back({prepend_model(op.tag, model),
+                                       static_cast<float>(*r++), op.step});
+            }
+          };
+          add_scalars(m_pending_means);
+          add_scalars(m_pending_mins);
+          add_scalars(m_pending_maxes);
+          add_scalars(m_pending_stdevs);
+          add_scalars(m_pending_scalars);
+          add_scalars(m_pending_sum_scalars);
+          for (const auto& op : m_pending_histograms) {
+            histogram_event e;
+            e.tag = prepend_model(op.tag, model);
+            e.min = r[0];
+            e.max = r[1];
+            e.sum = r[2];
+            e.sqsum = r[3];
+            e.num = op.num;
+            e.step = op.step;
+            e.buckets.assign(r + 4, r + 4 + op.buckets.size());
+            r += 4 + op.buckets.size();
+            batch.histograms.push_back(std::move(e));
+          }
+        }
+        {
+          std::lock_guard<std::mutex> lock(m_writer_mutex);
+          m_writer_queue.push_back(std::move(batch));
+        }
+        m_writer_cv.notify_one();
+      } else {
+        m_comm->intertrainer_gather(results.data(), results.size(),
+                                    m_comm->get_intertrainer_master());
+      }
+    }
   }
-  if (m_comm->am_trainer_master()) {
-    std::vector<float> model_mins(local_mins.size());
-    std::vector<float> model_maxes(local_maxes.size());
-    std::vector<float> model_sums(local_sums.size());
-    std::vector<float> model_sqsums(local_sqsums.size());
-    std::vector<float> model_buckets(buckets.size());
-    m_comm->trainer_reduce(local_mins.data(), local_mins.size(),
-                         model_mins.data(), El::mpi::MIN);
-    m_comm->trainer_reduce(local_maxes.data(), local_maxes.size(),
-                         model_maxes.data(), El::mpi::MAX);
-    m_comm->trainer_reduce(local_sums.data(), model_sums.size(),
-                         model_sums.data());
-    m_comm->trainer_reduce(local_sqsums.data(), local_sqsums.size(),
-                         model_sqsums.data());
-    m_comm->trainer_reduce(buckets.data(), buckets.size(),
-                         model_buckets.data());
-    // Gather to the world master for writing out.
+
+  // Scalars from every process are gathered to the world master.
+  if (!m_pending_scalar_alls.empty()) {
+    std::vector<float> local_scalars;
+    for (const auto& op : m_pending_scalar_alls) {
+      local_scalars.push_back(op.local);
+    }
     if (m_comm->am_world_master()) {
-      std::vector<float> global_mins(
-        m_comm->get_num_trainers() * model_mins.size());
-      std::vector<float> global_maxes(
-        m_comm->get_num_trainers() * model_maxes.size());
-      std::vector<float> global_sums(
-        m_comm->get_num_trainers() * model_sums.size());
-      std::vector<float> global_sqsums(
-        m_comm->get_num_trainers() * model_sqsums.size());
-      std::vector<float> global_buckets(
-        m_comm->get_num_trainers() * model_buckets.size());
-      m_comm->intertrainer_gather(model_mins.data(), model_mins.size(),
-                                global_mins.data());
-      m_comm->intertrainer_gather(model_maxes.data(), model_maxes.size(),
-                                global_maxes.data());
-      m_comm->intertrainer_gather(model_sums.data(), model_sums.size(),
-                                global_sums.data());
-      m_comm->intertrainer_gather(model_sqsums.data(), model_sqsums.size(),
-                                global_sqsums.data());
-      m_comm->intertrainer_gather(model_buckets.data(), model_buckets.size(),
-                                global_buckets.data());
-      for (unsigned i = 0; i < global_mins.size(); ++i) {
-        int model = i / m_pending_histograms.size();
-        unsigned ops_pos = i % m_pending_histograms.size();
-        std::vector<float> tmp_buckets(
-          global_buckets.begin() + i*m_histogram_buckets.size(),
-          global_buckets.begin() + (i+1)*m_histogram_buckets.size());
-        m_sw->add_histogram(prepend_model(m_pending_histograms[ops_pos].tag, model),
-                            tmp_buckets, global_mins[i], global_maxes[i],
-                            m_pending_histograms[ops_pos].num,
-                            global_sums[i], global_sqsums[i],
-                            m_pending_histograms[ops_pos].step);
+      std::vector<float> scalars(
+        m_comm->get_procs_in_world()*local_scalars.size());
+      m_comm->gather(local_scalars.data(), local_scalars.size(),
+                     scalars.data(), m_comm->get_world_comm());
+      event_batch batch;
+      for (size_t i = 0; i < scalars.size(); ++i) {
+        int rank = i / local_scalars.size();
+        int model = rank / m_comm->get_procs_per_trainer();
+        int pos = i % local_scalars.size();
+        batch.scalars.push_back(
+          {prepend_model("rank" + std::to_string(rank) + "/" +
+                         m_pending_scalar_alls[pos].tag, model),
+           scalars[i], m_pending_scalar_alls[pos].step});
+      }
+      {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        m_writer_queue.push_back(std::move(batch));
       }
+      m_writer_cv.notify_one();
     } else {
-      m_comm->intertrainer_gather(model_mins.data(), model_mins.size(),
-                                m_comm->get_intertrainer_master());
-      m_comm->intertrainer_gather(model_maxes.data(), model_maxes.size(),
-                                m_comm->get_intertrainer_master());
-      m_comm->intertrainer_gather(model_sums.data(), model_sums.size(),
-                                m_comm->get_intertrainer_master());
-      m_comm->intertrainer_gather(model_sqsums.data(), model_sqsums.size(),
-                                m_comm->get_intertrainer_master());
-      m_comm->intertrainer_gather(model_buckets.data(), model_buckets.size(),
-                                m_comm->get_intertrainer_master());
+      m_comm->gather(local_scalars.data(), local_scalars.size(),
+                     m_comm->get_world_master(), m_comm->get_world_comm());
     }
-  } else {
-    m_comm->trainer_reduce(local_mins.data(), local_mins.size(),
-                         m_comm->get_trainer_master(), El::mpi::MIN);
-    m_comm->trainer_reduce(local_maxes.data(), local_maxes.size(),
-                         m_comm->get_trainer_master(), El::mpi::MAX);
-    m_comm->trainer_reduce(local_sums.data(), local_sums.size(),
-                         m_comm->get_trainer_master());
-    m_comm->trainer_reduce(local_sqsums.data(), local_sqsums.size(),
-                         m_comm->get_trainer_master());
-    m_comm->trainer_reduce(buckets.data(), buckets.size(),
-                         m_comm->get_trainer_master());
   }
+
+  m_pending_means.clear();
+  m_pending_mins.clear();
+  m_pending_maxes.clear();
+  m_pending_stdevs.clear();
+  m_pending_scalars.clear();
+  m_pending_sum_scalars.clear();
+  m_pending_scalar_alls.clear();
   m_pending_histograms.clear();
 }
 
@@ -326,37 +324,6 @@ std::string lbann_summary::prepend_model(const std::string tag,
   return "model" + std::to_string(model) + "/" + tag;
 }
 
-void lbann_summary::gather_scalar_summary(
-  const std::vector<pending_op>& ops, std::vector<float>& scalars) {
-  if (m_comm->am_world_master()) {
-    std::vector<float> data(m_comm->get_num_trainers() * scalars.size());
-    m_comm->intertrainer_gather(scalars.data(), scalars.size(), data.data());
-    for (unsigned i = 0; i < data.size(); ++i) {
-      int model = i / ops.size();
-      unsigned ops_pos = i % ops.size();
-      m_sw->add_scalar(prepend_model(ops[ops_pos].tag, model),
-                       data[i], ops[ops_pos].step);
-    }
-  } else {
-    m_comm->intertrainer_gather(scalars.data(), scalars.size(),
-                              m_comm->get_intertrainer_master());
-  }
-}
-
-void lbann_summary::gather_scalar_summary(const std::string tag,
-                                          float s,
-                                          int step) {
-  if (m_comm->am_world_master()) {
-    std::vector<float> data(m_comm->get_num_trainers());
-    m_comm->intertrainer_gather(s, data);
-    for (size_t model = 0; model < data.size(); ++model) {
-      m_sw->add_scalar(prepend_model(tag, model), data[model], step);
-    }
-  } else {
-    m_comm->intertrainer_gather(s, m_comm->get_intertrainer_master());
-  }
-}
-
 #endif  // LBANN_HAS_TBINF
 
 }  // namespace lbann
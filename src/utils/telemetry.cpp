@@ -0,0 +1,273 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/utils/telemetry.hpp"
+#include "lbann/utils/exception.hpp"
+
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace lbann {
+namespace telemetry {
+
+namespace details {
+std::atomic<bool> enabled(false);
+} // namespace details
+
+namespace {
+
+/** @brief Single-producer, single-consumer ring of events.
+ *
+ *  Only the owning thread pushes and only the flusher pops.
+ */
+struct ring {
+  ring(size_t capacity, uint32_t tid)
+    : events(capacity), mask(capacity - 1), tid(tid) {}
+  std::vector<event> events;
+  const uint64_t mask;
+  const uint32_t tid;
+  /** Number of events pushed. Written by the owning thread. */
+  std::atomic<uint64_t> head{0};
+  /** Number of events popped. Written by the flusher. */
+  std::atomic<uint64_t> tail{0};
+  std::atomic<uint64_t> dropped{0};
+};
+
+/** Global tracing state. */
+struct state {
+  std::mutex mutex;
+  /** Interned region names, indexed by ID. */
+  std::vector<std::string> names;
+  std::unordered_map<std::string, region_id> ids;
+  /** Rings of the current session. */
+  std::vector<std::shared_ptr<ring>> rings;
+  /** Incremented by every start, so threads register new rings. */
+  std::atomic<uint64_t> session{0};
+  size_t ring_capacity = 0;
+  uint64_t dropped = 0;
+
+  std::ofstream out;
+  int pid = 0;
+  bool first_event = true;
+  uint64_t start_ticks = 0;
+  double ticks_per_us = 1;
+
+  std::thread flusher;
+  std::condition_variable flusher_cv;
+  bool flusher_stop = false;
+};
+
+state& get_state() {
+  static state s;
+  return s;
+}
+
+thread_local std::shared_ptr<ring> local_ring;
+thread_local uint64_t local_session = 0;
+
+const char* category_name(category cat) {
+  switch (cat) {
+  case category::forward_prop:  return "fp";
+  case category::backward_prop: return "bp";
+  case category::optimizer:     return "opt";
+  case category::io:            return "io";
+  case category::comm:          return "comm";
+  default:                      return "other";
+  }
+}
+
+void write_json_string(std::ostream& os, const std::string& str) {
+  os << '"';
+  for (const auto& c : str) {
+    if (c == '"' || c == '\\') { os << '\\' << c; }
+    else if (static_cast<unsigned char>(c) < 0x20) { os << ' '; }
+    else { os << c; }
+  }
+  os << '"';
+}
+
+/** Move events from the rings to the output file. */
+void flush(state& s) {
+  std::vector<std::shared_ptr<ring>> rings;
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    rings = s.rings;
+  }
+  std::vector<event> events;
+  for (const auto& r : rings) {
+    const auto tail = r->tail.load(std::memory_order_relaxed);
+    const auto head = r->head.load(std::memory_order_acquire);
+    events.clear();
+    for (auto i = tail; i < head; ++i) {
+      events.push_back(r->events[i & r->mask]);
+    }
+    r->tail.store(head, std::memory_order_release);
+    if (events.empty()) { continue; }
+    std::lock_guard<std::mutex> lock(s.mutex);
+    for (const auto& e : events) {
+      s.out << (s.first_event ? "\n" : ",\n");
+      s.first_event = false;
+      s.out << "{\"name\":";
+      write_json_string(s.out,
+                        e.region < s.names.size() ? s.names[e.region] : "?");
+      const double ts = (e.begin - s.start_ticks) / s.ticks_per_us;
+      const double dur = (e.end - e.begin) / s.ticks_per_us;
+      s.out << ",\"cat\":\"" << category_name(e.cat) << "\""
+            << ",\"ph\":\"X\",\"pid\":" << s.pid
+            << ",\"tid\":" << r->tid
+            << ",\"ts\":" << ts << ",\"dur\":" << dur << "}";
+    }
+  }
+}
+
+/** Timestamp counter ticks per microsecond. */
+double calibrate_ticks() {
+  using clock = std::chrono::steady_clock;
+  const auto t0 = ticks();
+  const auto c0 = clock::now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const auto t1 = ticks();
+  const auto c1 = clock::now();
+  const double us = std::chrono::duration<double, std::micro>(c1 - c0).count();
+  return (t1 > t0 && us > 0) ? (t1 - t0) / us : 1.0;
+}
+
+} // namespace
+
+void details::record(const event& e) noexcept {
+  auto& s = get_state();
+  const auto session = s.session.load(std::memory_order_acquire);
+  if (local_session != session) {
+    // First event of this thread in the session
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (!enabled.load(std::memory_order_relaxed)) { return; }
+    local_ring = std::make_shared<ring>(s.ring_capacity, s.rings.size());
+    s.rings.push_back(local_ring);
+    local_session = session;
+  }
+  auto& r = *local_ring;
+  const auto head = r.head.load(std::memory_order_relaxed);
+  const auto tail = r.tail.load(std::memory_order_acquire);
+  if (head - tail > r.mask) {
+    r.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  r.events[head & r.mask] = e;
+  r.head.store(head + 1, std::memory_order_release);
+}
+
+region_id intern(const std::string& name) {
+  auto& s = get_state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  const auto it = s.ids.find(name);
+  if (it != s.ids.end()) { return it->second; }
+  const auto id = static_cast<region_id>(s.names.size());
+  s.names.push_back(name);
+  s.ids.emplace(name, id);
+  return id;
+}
+
+void start(const std::string& filename,
+           int pid,
+           size_t ring_capacity,
+           double flush_interval) {
+  auto& s = get_state();
+  if (enabled()) {
+    LBANN_ERROR("telemetry was started twice");
+  }
+  s.out.open(filename);
+  if (!s.out.is_open()) {
+    LBANN_ERROR("failed to open telemetry output file (", filename, ")");
+  }
+  s.out << std::fixed << std::setprecision(3);
+  s.out << "{\"traceEvents\":[";
+  size_t capacity = 1;
+  while (capacity < ring_capacity) { capacity *= 2; }
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.rings.clear();
+    s.dropped = 0;
+    s.ring_capacity = capacity;
+    s.pid = pid;
+    s.first_event = true;
+    s.flusher_stop = false;
+  }
+  s.ticks_per_us = calibrate_ticks();
+  s.start_ticks = ticks();
+  s.session.fetch_add(1, std::memory_order_release);
+  details::enabled.store(true, std::memory_order_release);
+
+  const auto interval = std::chrono::duration<double>(flush_interval);
+  s.flusher = std::thread([&s, interval]() {
+      std::unique_lock<std::mutex> lock(s.mutex);
+      while (!s.flusher_stop) {
+        s.flusher_cv.wait_for(lock, interval);
+        lock.unlock();
+        flush(s);
+        lock.lock();
+      }
+    });
+}
+
+void stop() {
+  auto& s = get_state();
+  if (!enabled()) { return; }
+  details::enabled.store(false, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.flusher_stop = true;
+  }
+  s.flusher_cv.notify_all();
+  s.flusher.join();
+  flush(s);
+  std::lock_guard<std::mutex> lock(s.mutex);
+  for (const auto& r : s.rings) {
+    s.dropped += r->dropped.load(std::memory_order_relaxed);
+  }
+  s.rings.clear();
+  s.out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  s.out.close();
+}
+
+uint64_t num_dropped() {
+  auto& s = get_state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  uint64_t dropped = s.dropped;
+  for (const auto& r : s.rings) {
+    dropped += r->dropped.load(std::memory_order_relaxed);
+  }
+  return dropped;
+}
+
+} // namespace telemetry
+} // namespace lbann
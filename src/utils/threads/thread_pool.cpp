@@ -1,7 +1,11 @@
 #include "lbann/utils/threads/thread_pool.hpp"
+#include "lbann/utils/sampling_profiler.hpp"
+
+#include <omp.h>
 
 #include <algorithm>
 #include <iostream>
+#include <string>
 
 namespace lbann {
 
@@ -94,6 +98,32 @@ void thread_pool::launch_pinned_threads(
 #endif// LBANN_HAS_PTHREAD_AFFINITY_SUPPORT
 }
 
+void thread_pool::launch_threads_on_cpus(const std::vector<int>& cpus) {
+  m_thread_cpus = cpus;
+#ifdef LBANN_HAS_PTHREAD_AFFINITY_SUPPORT
+  threads_.reserve(cpus.size());
+  m_work_group.reserve(cpus.size());
+  m_thread_id_to_local_id_map.reserve(cpus.size());
+  try
+  {
+    for (size_type cnt = 0; cnt < cpus.size(); ++cnt) {
+      cpu_set_t cpuset;
+      CPU_ZERO(&cpuset);
+      CPU_SET(cpus[cnt], &cpuset);
+      threads_.emplace_back(&thread_pool::do_thread_work_pinned_thread_,
+                            this, cnt, cpuset);
+    }
+  }
+  catch(...)
+  {
+    all_work_done_ = true;
+    throw;
+  }
+#else
+  launch_threads(cpus.size());
+#endif // LBANN_HAS_PTHREAD_AFFINITY_SUPPORT
+}
+
 void thread_pool::reap_threads() {
   all_work_done_ = true;
   do {
@@ -113,17 +143,33 @@ void thread_pool::reap_threads() {
 
 void thread_pool::relaunch_pinned_threads(size_type num_threads) {
   reap_threads();
+  if (!m_thread_cpus.empty()) {
+    num_threads = std::min(std::max(num_threads, size_type{1}),
+                           m_thread_cpus.size());
+    launch_threads_on_cpus(std::vector<int>(m_thread_cpus.begin(),
+                                            m_thread_cpus.begin() + num_threads));
+    return;
+  }
   launch_pinned_threads(num_threads, m_threads_offset);
   return;
 }
 
+void thread_pool::setup_worker_omp_threads_() {
+  if (m_worker_omp_threads > 0) {
+    omp_set_num_threads(m_worker_omp_threads);
+  }
+}
+
 void thread_pool::do_thread_work_()
 {
+  setup_worker_omp_threads_();
+  sampling_profiler::thread_registration profile("thread_pool");
+  type_erased_function task;
   while (not all_work_done_)
   {
-    auto task = global_work_queue_.wait_and_pop();
-    if (task) {
-      (*task)();
+    if (global_work_queue_.wait_and_pop(task)) {
+      task();
+      task = type_erased_function();
     }
   }
 }
@@ -139,22 +185,80 @@ void thread_pool::do_thread_work_pinned_thread_(int tid, cpu_set_t cpu_set)
               << error << std::endl;
   }
 
+  setup_worker_omp_threads_();
   {
     std::lock_guard<std::mutex> guard(m_thread_map_mutex);
     // Establish a local thread id
     std::thread::id this_id = std::this_thread::get_id();
     m_thread_id_to_local_id_map[this_id] = tid;
   }
+  sampling_profiler::thread_registration profile(
+    "thread_pool_" + std::to_string(tid));
+  type_erased_function task;
   while (not all_work_done_)
   {
-    auto task = global_work_queue_.wait_and_pop();
-    if (task) {
-      (*task)();
+    if (global_work_queue_.wait_and_pop(task)) {
+      task();
+      task = type_erased_function();
     }
   }
 }
 #endif // LBANN_HAS_PTHREAD_AFFINITY_SUPPORT
 
+void thread_pool::partition_work(size_t n, size_t chunk_size, int num_workers) {
+  if (num_workers < 1) { num_workers = 1; }
+  if (chunk_size < 1) { chunk_size = 1; }
+  while (m_work_deques.size() < static_cast<size_t>(num_workers)) {
+    m_work_deques.emplace_back(new work_deque);
+  }
+  for (auto& q : m_work_deques) {
+    q->chunks.clear();
+  }
+
+  // Deal out contiguous runs of chunks, so that each worker starts
+  // on its own region and only steals once that is exhausted
+  const size_t num_chunks = (n + chunk_size - 1) / chunk_size;
+  const size_t per_worker = num_chunks / num_workers;
+  const size_t extra = num_chunks % num_workers;
+  size_t chunk = 0;
+  for (int w = 0; w < num_workers; ++w) {
+    const size_t my_chunks = per_worker + (static_cast<size_t>(w) < extra ? 1 : 0);
+    for (size_t j = 0; j < my_chunks; ++j, ++chunk) {
+      const size_t begin = chunk * chunk_size;
+      m_work_deques[w]->chunks.emplace_back(begin, std::min(begin + chunk_size, n));
+    }
+  }
+}
+
+bool thread_pool::get_next_chunk(int worker, size_t& begin, size_t& end) {
+  const int num_deques = static_cast<int>(m_work_deques.size());
+  if (num_deques == 0) {
+    return false;
+  }
+  worker = worker % num_deques;
+  {
+    work_deque& mine = *m_work_deques[worker];
+    std::lock_guard<std::mutex> guard(mine.mutex);
+    if (!mine.chunks.empty()) {
+      begin = mine.chunks.front().first;
+      end = mine.chunks.front().second;
+      mine.chunks.pop_front();
+      return true;
+    }
+  }
+  for (int j = 1; j < num_deques; ++j) {
+    work_deque& victim = *m_work_deques[(worker + j) % num_deques];
+    std::lock_guard<std::mutex> guard(victim.mutex);
+    if (!victim.chunks.empty()) {
+      begin = victim.chunks.back().first;
+      end = victim.chunks.back().second;
+      victim.chunks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
 int thread_pool::get_local_thread_id() {
   std::thread::id this_id = std::this_thread::get_id();
   return m_thread_id_to_local_id_map[this_id];
@@ -25,8 +25,12 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lbann/utils/threads/thread_utils.hpp"
+#include <algorithm>
+#include <cstdlib>
 #include <thread>
 #include <omp.h>
+#include <pthread.h>
+#include <sched.h>
 
 namespace lbann {
 
@@ -64,4 +68,54 @@ int free_core_offset(const lbann_comm *comm) {
   return io_threads_offset;
 }
 
+core_partition partition_process_cores(int num_io_threads) {
+  core_partition partition;
+#ifdef LBANN_HAS_PTHREAD_AFFINITY_SUPPORT
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuset) != 0) {
+    return partition;
+  }
+  std::vector<int> cpus;
+  for (int j = 0; j < CPU_SETSIZE; ++j) {
+    if (CPU_ISSET(j, &cpuset)) { cpus.push_back(j); }
+  }
+
+  int aluminum_threads = 0;
+#ifdef LBANN_HAS_ALUMINUM
+  aluminum_threads = 1;
+#endif // LBANN_HAS_ALUMINUM
+
+  // Keep at least one CPU for compute
+  const int num_cpus = cpus.size();
+  num_io_threads = std::min(std::max(num_io_threads, 1),
+                            num_cpus - aluminum_threads - 1);
+  if (num_io_threads < 1) { return partition; }
+  const int num_compute = num_cpus - aluminum_threads - num_io_threads;
+  partition.compute_cpus.assign(cpus.begin(), cpus.begin() + num_compute);
+  partition.io_cpus.assign(cpus.end() - num_io_threads, cpus.end());
+#endif // LBANN_HAS_PTHREAD_AFFINITY_SUPPORT
+  return partition;
+}
+
+void pin_omp_threads(lbann_comm& comm, const std::vector<int>& cpus) {
+  if (cpus.empty()) { return; }
+  const int num_threads = cpus.size();
+  comm.set_default_threads_per_proc(num_threads);
+#ifdef LBANN_HAS_PTHREAD_AFFINITY_SUPPORT
+  if (std::getenv("OMP_PLACES") != nullptr
+      || std::getenv("OMP_PROC_BIND") != nullptr) {
+    return;
+  }
+  // OpenMP runtimes reuse their threads, so the binding sticks
+  #pragma omp parallel num_threads(num_threads)
+  {
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpus[omp_get_thread_num()], &cpuset);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+  }
+#endif // LBANN_HAS_PTHREAD_AFFINITY_SUPPORT
+}
+
 } // namespace lbann
@@ -0,0 +1,56 @@
+// MUST include this
+#include <catch2/catch.hpp>
+
+// File being tested
+#include <lbann/utils/broadcast.hpp>
+
+TEST_CASE("Broadcast maps", "[broadcast][utilities]") {
+
+  SECTION("Matching dimensions give the identity") {
+    const auto map = lbann::make_broadcast_map({2,3,4}, {2,3,4});
+    CHECK(map.is_identity());
+    CHECK(map(17) == 17);
+  }
+
+  SECTION("Missing leading dimensions are broadcast") {
+    const auto map = lbann::make_broadcast_map({4}, {3,4});
+    CHECK_FALSE(map.is_identity());
+    for (El::Int i = 0; i < 12; ++i) {
+      CHECK(map(i) == i % 4);
+    }
+  }
+
+  SECTION("Dimensions of size 1 are broadcast") {
+    const auto map = lbann::make_broadcast_map({3,1}, {3,4});
+    for (El::Int i = 0; i < 12; ++i) {
+      CHECK(map(i) == i / 4);
+    }
+  }
+
+  SECTION("Tessellated dimensions wrap around") {
+    const auto map = lbann::make_broadcast_map({2,3}, {4,6});
+    for (El::Int i = 0; i < 4; ++i) {
+      for (El::Int j = 0; j < 6; ++j) {
+        CHECK(map(i*6+j) == (i%2)*3 + (j%3));
+      }
+    }
+  }
+
+  SECTION("Neighboring dimensions are merged") {
+    const auto map = lbann::make_broadcast_map({1,2,3,4,5,6},
+                                               {7,2,3,4,5,6});
+    CHECK(map.num_dims <= lbann::broadcast_map::max_dims);
+    CHECK(map(2*3*4*5*6 + 11) == 11);
+  }
+
+  SECTION("Shapes") {
+    CHECK(lbann::is_broadcastable({1,4}, {3,4}));
+    CHECK(lbann::is_broadcastable({2,4}, {6,4}));
+    CHECK_FALSE(lbann::is_broadcastable({5}, {4}));
+    CHECK_FALSE(lbann::is_broadcastable({2,3,4}, {3,4}));
+    CHECK(lbann::get_broadcast_dims({3,1}, {4})
+          == std::vector<int>({3,4}));
+    CHECK_THROWS(lbann::make_broadcast_map({5}, {4}));
+  }
+
+}
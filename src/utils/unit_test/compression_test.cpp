@@ -0,0 +1,63 @@
+#include <catch2/catch.hpp>
+
+#include <lbann/utils/compression.hpp>
+
+#include <cstring>
+#include <vector>
+
+TEST_CASE("Compression round trip", "[utilities][compression]")
+{
+  std::vector<float> values(4096);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = static_cast<float>(i % 17);
+  }
+  const size_t num_bytes = values.size()*sizeof(float);
+
+  std::vector<unsigned char> compressed;
+  lbann::utils::compress_bytes(values.data(), num_bytes, compressed);
+  CHECK(compressed.size() < num_bytes);
+
+  std::vector<float> restored(values.size(), -1.f);
+  lbann::utils::decompress_bytes(compressed.data(), compressed.size(),
+                                 restored.data(), num_bytes);
+  CHECK(std::memcmp(values.data(), restored.data(), num_bytes) == 0);
+
+  SECTION("Wrong uncompressed size is an error")
+  {
+    CHECK_THROWS(
+      lbann::utils::decompress_bytes(compressed.data(), compressed.size(),
+                                     restored.data(), num_bytes/2));
+  }
+}
+
+TEST_CASE("Block compression round trip", "[utilities][compression]")
+{
+  std::vector<float> values(10000);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = static_cast<float>(i % 29);
+  }
+  const size_t num_bytes = values.size()*sizeof(float);
+
+  // Small blocks so the last one is partial
+  std::vector<unsigned char> compressed;
+  lbann::utils::compress_blocks(values.data(), num_bytes, compressed, 4096);
+  CHECK(compressed.size() < num_bytes);
+
+  std::vector<float> restored(values.size(), -1.f);
+  lbann::utils::decompress_blocks(compressed.data(), compressed.size(),
+                                  restored.data(), num_bytes);
+  CHECK(std::memcmp(values.data(), restored.data(), num_bytes) == 0);
+
+  SECTION("Wrong uncompressed size is an error")
+  {
+    CHECK_THROWS(
+      lbann::utils::decompress_blocks(compressed.data(), compressed.size(),
+                                      restored.data(), num_bytes/2));
+  }
+  SECTION("Truncated buffer is an error")
+  {
+    CHECK_THROWS(
+      lbann::utils::decompress_blocks(compressed.data(), compressed.size()-1,
+                                      restored.data(), num_bytes));
+  }
+}
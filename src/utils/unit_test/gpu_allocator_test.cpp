@@ -0,0 +1,47 @@
+#include <catch2/catch.hpp>
+
+#include <lbann/utils/gpu_allocator.hpp>
+
+using lbann::cuda::allocator_statistics;
+using lbann::cuda::caching_allocator;
+
+TEST_CASE("Caching allocator size classes", "[utilities][gpu]")
+{
+  SECTION("Small requests use powers of two from 512 B")
+  {
+    CHECK(caching_allocator::round_up(1) == 512);
+    CHECK(caching_allocator::round_up(512) == 512);
+    CHECK(caching_allocator::round_up(513) == 1024);
+    CHECK(caching_allocator::round_up(3000) == 4096);
+    CHECK(caching_allocator::round_up(size_t(1) << 20) == (size_t(1) << 20));
+  }
+
+  SECTION("Large requests use quarter steps")
+  {
+    const size_t mib = size_t(1) << 20;
+    CHECK(caching_allocator::round_up(mib + 1) == mib + mib / 4);
+    CHECK(caching_allocator::round_up(mib + mib / 4) == mib + mib / 4);
+    CHECK(caching_allocator::round_up(3 * mib) == 3 * mib);
+    CHECK(caching_allocator::round_up(7 * mib + 1) == 8 * mib);
+  }
+
+  SECTION("Classes cover their requests")
+  {
+    for (size_t bytes = 1; bytes < (size_t(1) << 26); bytes = bytes * 3 + 7) {
+      const auto size = caching_allocator::round_up(bytes);
+      CHECK(size >= bytes);
+      CHECK(size % 512 == 0);
+      CHECK(size < 2 * bytes + 512);
+    }
+  }
+}
+
+TEST_CASE("Caching allocator fragmentation", "[utilities][gpu]")
+{
+  allocator_statistics stats;
+  CHECK(stats.fragmentation() == 0.0);
+  stats.live_bytes = 1024;
+  stats.requested_bytes = 512;
+  stats.cached_bytes = 1024;
+  CHECK(stats.fragmentation() == Approx(0.75));
+}
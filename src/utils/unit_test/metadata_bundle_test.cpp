@@ -0,0 +1,71 @@
+// MUST include this
+#include <catch2/catch.hpp>
+
+// File being tested
+#include <lbann/utils/metadata_bundle.hpp>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+TEST_CASE ("Testing metadata bundles", "[metadata][utilities]") {
+
+  const std::vector<int> index = {3, 1, 4, 1, 5, 9, 2, 6};
+  const std::vector<double> responses = {0.5, -1.25};
+  const std::string header = "id,smiles,label";
+
+  lbann::metadata_bundle bundle;
+  bundle.put(size_t{42});
+  bundle.put(index);
+  bundle.put(std::vector<char>());
+  bundle.put(header);
+  bundle.put(responses);
+
+  SECTION ("put/get round trip") {
+    size_t num;
+    std::vector<int> index_out;
+    std::vector<char> empty_out = {'x'};
+    std::string header_out;
+    std::vector<double> responses_out;
+    bundle.get(num);
+    bundle.get(index_out);
+    bundle.get(empty_out);
+    bundle.get(header_out);
+    bundle.get(responses_out);
+    CHECK(num == 42);
+    CHECK(index_out == index);
+    CHECK(empty_out.empty());
+    CHECK(header_out == header);
+    CHECK(responses_out == responses);
+    CHECK_THROWS(bundle.get(num));
+  }
+
+  SECTION ("save/load") {
+    const std::string path = "metadata_bundle_test.lbmeta";
+    bundle.save(path, 1234);
+
+    lbann::metadata_bundle wrong_key;
+    CHECK_FALSE(wrong_key.load(path, 4321));
+    CHECK_FALSE(wrong_key.load(path + ".missing", 1234));
+
+    lbann::metadata_bundle loaded;
+    REQUIRE(loaded.load(path, 1234));
+    CHECK(loaded.size() == bundle.size());
+    size_t num;
+    std::vector<int> index_out;
+    loaded.get(num);
+    loaded.get(index_out);
+    CHECK(num == 42);
+    CHECK(index_out == index);
+    std::remove(path.c_str());
+  }
+
+  SECTION ("keys") {
+    lbann::metadata_bundle::key a, b, c;
+    a.add(std::string("data.csv")).add(1);
+    b.add(std::string("data.csv")).add(1);
+    c.add(std::string("data.csv")).add(2);
+    CHECK(a.value() == b.value());
+    CHECK(a.value() != c.value());
+  }
+}
@@ -0,0 +1,117 @@
+// MUST include this
+#include <catch2/catch.hpp>
+
+// File being tested
+#include <lbann/utils/threads/mpmc_queue.hpp>
+#include <lbann/utils/threads/type_erased_function.hpp>
+
+#include <array>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+TEST_CASE ("Testing the lock-free work queue", "[threads][utilities]") {
+
+  SECTION ("values come out in order") {
+    lbann::mpmc_queue<int> queue(8);
+    CHECK(queue.capacity() == 8);
+    CHECK(queue.empty());
+    for (int i=0; i<5; ++i) {
+      queue.push(i);
+    }
+    int value;
+    for (int i=0; i<5; ++i) {
+      REQUIRE(queue.try_pop(value));
+      CHECK(value == i);
+    }
+    CHECK_FALSE(queue.try_pop(value));
+    CHECK(queue.empty());
+  }
+
+  SECTION ("a full ring overflows") {
+    lbann::mpmc_queue<int> queue(4);
+    std::vector<int> seen(10, 0);
+    for (int i=0; i<10; ++i) {
+      queue.push(i);
+    }
+    int value;
+    while (queue.try_pop(value)) {
+      ++seen[value];
+    }
+    for (const auto& count : seen) {
+      CHECK(count == 1);
+    }
+  }
+
+  SECTION ("many producers and consumers") {
+    lbann::mpmc_queue<int> queue(16);
+    const int num_threads = 4, per_thread = 2000;
+    std::vector<std::atomic<int>> seen(num_threads * per_thread);
+    for (auto& s : seen) { s = 0; }
+    std::vector<std::thread> threads;
+    for (int t=0; t<num_threads; ++t) {
+      threads.emplace_back([&queue, t, per_thread] {
+          for (int i=0; i<per_thread; ++i) {
+            queue.push(t * per_thread + i);
+          }
+        });
+      threads.emplace_back([&queue, &seen, per_thread] {
+          int value;
+          for (int i=0; i<per_thread; ++i) {
+            if (queue.wait_and_pop(value)) { ++seen[value]; }
+          }
+        });
+    }
+    for (auto& t : threads) { t.join(); }
+    for (const auto& s : seen) {
+      CHECK(s == 1);
+    }
+    CHECK(queue.empty());
+  }
+
+  SECTION ("stopped consumers return") {
+    lbann::mpmc_queue<int> queue;
+    bool popped = true;
+    std::thread consumer([&queue, &popped] {
+        int value;
+        popped = queue.wait_and_pop(value);
+      });
+    queue.wake_all(true);
+    consumer.join();
+    CHECK_FALSE(popped);
+  }
+}
+
+TEST_CASE ("Testing type-erased functions", "[threads][utilities]") {
+
+  SECTION ("small and large functions") {
+    int calls = 0;
+    std::array<char, 256> big{};
+    big[0] = 1;
+    lbann::type_erased_function small_f([&calls] { ++calls; });
+    lbann::type_erased_function large_f([&calls, big] { calls += big[0]; });
+    small_f();
+    large_f();
+    CHECK(calls == 2);
+
+    // Moved functions still work and leave the source empty
+    lbann::type_erased_function moved_small(std::move(small_f));
+    lbann::type_erased_function moved_large;
+    moved_large = std::move(large_f);
+    CHECK_FALSE(small_f);
+    CHECK_FALSE(large_f);
+    moved_small();
+    moved_large();
+    CHECK(calls == 4);
+  }
+
+  SECTION ("packaged tasks") {
+    std::packaged_task<int()> task([] { return 42; });
+    auto future = task.get_future();
+    lbann::type_erased_function f(std::move(task));
+    lbann::type_erased_function g(std::move(f));
+    g();
+    CHECK(future.get() == 42);
+  }
+}
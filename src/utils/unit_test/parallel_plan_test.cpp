@@ -0,0 +1,109 @@
+// MUST include this
+#include <catch2/catch.hpp>
+
+// File being tested
+#include <lbann/utils/parallel_plan.hpp>
+
+namespace pp = lbann::parallel_plan;
+
+namespace {
+
+pp::layer_info fully_connected(const std::string& name,
+                               int input_size, int output_size) {
+  pp::layer_info l;
+  l.name = name;
+  l.type = "fully connected";
+  l.input_dims = {input_size};
+  l.output_dims = {output_size};
+  l.num_weights = double(input_size) * output_size;
+  l.flops = 6 * l.num_weights;
+  l.model_parallel = true;
+  return l;
+}
+
+pp::machine make_machine(int num_procs, int mini_batch_size) {
+  pp::machine m;
+  m.num_procs = num_procs;
+  m.mini_batch_size = mini_batch_size;
+  return m;
+}
+
+} // namespace
+
+TEST_CASE("Parallel strategy search picks sensible layouts",
+          "[parallel_plan][utilities]") {
+
+  SECTION("Large fully-connected layer with small mini-batch") {
+    const std::vector<pp::layer_info> layers = {
+      fully_connected("fc", 16384, 16384)};
+    const auto p = pp::search(layers, make_machine(64, 64));
+    CHECK(p.choices[0].layout == lbann::data_layout::MODEL_PARALLEL);
+  }
+
+  SECTION("Small fully-connected layer with large mini-batch") {
+    const std::vector<pp::layer_info> layers = {
+      fully_connected("fc", 256, 256)};
+    const auto p = pp::search(layers, make_machine(64, 4096));
+    CHECK(p.choices[0].layout == lbann::data_layout::DATA_PARALLEL);
+    CHECK(p.choices[0].spatial_groups == 1);
+  }
+
+  SECTION("Convolution with fewer samples than processes") {
+    pp::layer_info conv;
+    conv.name = "conv";
+    conv.type = "convolution";
+    conv.input_dims = {16, 128, 128, 128};
+    conv.output_dims = {16, 128, 128, 128};
+    conv.num_weights = 16 * 16 * 27;
+    conv.flops = 6 * conv.num_weights * 128 * 128 * 128;
+    conv.spatial = true;
+    conv.halo = 1;
+    const auto p = pp::search({conv}, make_machine(64, 8));
+    CHECK(p.choices[0].spatial_groups > 1);
+    CHECK(64 % p.choices[0].spatial_groups == 0);
+  }
+
+  SECTION("Single process keeps layers data-parallel") {
+    const std::vector<pp::layer_info> layers = {
+      fully_connected("fc", 16384, 16384)};
+    const auto p = pp::search(layers, make_machine(1, 1));
+    CHECK(p.choices[0] == pp::choice{});
+    CHECK(p.layer_costs[0].comm == 0.0);
+  }
+
+}
+
+TEST_CASE("Parallel strategy costs", "[parallel_plan][utilities]") {
+
+  const auto parent = fully_connected("parent", 1024, 1024);
+  const auto m = make_machine(16, 256);
+  const pp::choice dp, mp{lbann::data_layout::MODEL_PARALLEL, 1};
+
+  SECTION("No redistribution between identical choices") {
+    CHECK(pp::redistribution_cost(parent, dp, dp, m) == 0.0);
+    CHECK(pp::redistribution_cost(parent, mp, mp, m) == 0.0);
+    CHECK(pp::redistribution_cost(parent, dp, mp, m) > 0.0);
+  }
+
+  SECTION("Evaluation adds layer and redistribution costs") {
+    auto child = fully_connected("child", 1024, 1024);
+    child.parents = {0};
+    const auto p = pp::evaluate({parent, child}, {dp, mp}, m);
+    const double expected = (p.layer_costs[0].total()
+                             + p.layer_costs[1].total()
+                             + p.redistribution_costs[1]);
+    CHECK(p.redistribution_costs[0] == 0.0);
+    CHECK(p.redistribution_costs[1] > 0.0);
+    CHECK(p.total == Approx(expected));
+  }
+
+  SECTION("Data-parallel traffic is the gradient allreduce") {
+    // Ring allreduce of 1024*1024 floats over 16 processes
+    const double bytes = 2.0 * 15 / 16 * parent.num_weights * 4;
+    CHECK(pp::layer_comm_bytes(parent, dp, m) == Approx(bytes));
+    CHECK(pp::layer_comm_bytes(parent, dp, make_machine(1, 256)) == 0.0);
+    CHECK(pp::redistribution_bytes(parent, dp, dp, m) == 0.0);
+    CHECK(pp::redistribution_bytes(parent, dp, mp, m) > 0.0);
+  }
+
+}
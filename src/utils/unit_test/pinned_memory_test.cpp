@@ -0,0 +1,96 @@
+#include <catch2/catch.hpp>
+
+#include <lbann/utils/pinned_memory.hpp>
+
+#include <utility>
+
+using lbann::pinned_host_matrix;
+using lbann::pinned_memory_pool;
+
+TEST_CASE("Pinned memory pool", "[utilities][memory]")
+{
+  auto& pool = pinned_memory_pool::instance();
+  pool.release_cached();
+
+  SECTION("Requests use powers of two from 4 KiB")
+  {
+    CHECK(pinned_memory_pool::round_up(1) == 4096);
+    CHECK(pinned_memory_pool::round_up(4096) == 4096);
+    CHECK(pinned_memory_pool::round_up(4097) == 8192);
+    CHECK(pinned_memory_pool::round_up(100000) == 131072);
+  }
+
+  SECTION("Returned buffers are reused")
+  {
+    void* ptr = nullptr;
+    {
+      auto lease = pool.acquire(5000);
+      REQUIRE(lease.get() != nullptr);
+      CHECK(lease.size() == 8192);
+      CHECK(lease.is_pinned());
+      ptr = lease.get();
+    }
+    const auto reuses = pool.get_statistics().num_reuses;
+    auto lease = pool.acquire(6000);
+    CHECK(lease.get() == ptr);
+    CHECK(pool.get_statistics().num_reuses == reuses + 1);
+    CHECK(pool.get_statistics().leased_bytes >= 8192);
+  }
+
+  SECTION("Requests over the cap get pageable memory")
+  {
+    const auto capacity = pool.get_capacity();
+    pool.set_capacity(16384);
+    auto small = pool.acquire(16384);
+    auto large = pool.acquire(100);
+    CHECK(small.is_pinned());
+    CHECK_FALSE(large.is_pinned());
+    CHECK(large.get() != nullptr);
+    small.reset();
+    large.reset();
+    pool.set_capacity(capacity);
+  }
+
+  SECTION("Empty requests get no buffer")
+  {
+    auto lease = pool.acquire(0);
+    CHECK(lease.get() == nullptr);
+    CHECK(lease.size() == 0);
+  }
+}
+
+TEST_CASE("Pinned host matrix", "[utilities][memory]")
+{
+  pinned_host_matrix<float> mat(3, 4);
+  REQUIRE(mat.Height() == 3);
+  REQUIRE(mat.Width() == 4);
+  for (int j = 0; j < 4; ++j) {
+    for (int i = 0; i < 3; ++i) {
+      mat.Matrix()(i, j) = float(i + 3*j);
+    }
+  }
+
+  SECTION("Copies own their entries")
+  {
+    pinned_host_matrix<float> copy(mat);
+    CHECK(copy.LockedMatrix().LockedBuffer() != mat.LockedMatrix().LockedBuffer());
+    copy.Matrix()(0, 0) = -1.f;
+    CHECK(mat.LockedMatrix()(0, 0) == 0.f);
+    CHECK(copy.LockedMatrix()(2, 3) == 11.f);
+  }
+
+  SECTION("Moves keep the buffer")
+  {
+    const auto* buffer = mat.LockedMatrix().LockedBuffer();
+    pinned_host_matrix<float> moved(std::move(mat));
+    CHECK(moved.LockedMatrix().LockedBuffer() == buffer);
+    CHECK(moved.LockedMatrix()(1, 2) == 7.f);
+  }
+
+  SECTION("Shrinking keeps the buffer")
+  {
+    const auto* buffer = mat.LockedMatrix().LockedBuffer();
+    mat.Resize(2, 2);
+    CHECK(mat.LockedMatrix().LockedBuffer() == buffer);
+  }
+}
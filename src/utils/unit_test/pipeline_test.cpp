@@ -0,0 +1,80 @@
+// MUST include this
+#include <catch2/catch.hpp>
+
+// File being tested
+#include <lbann/utils/pipeline.hpp>
+
+#include <algorithm>
+#include <set>
+
+using lbann::pipeline::schedule_type;
+
+TEST_CASE ("Testing pipeline stage balancing", "[pipeline][utilities]") {
+
+  SECTION ("Stages minimize the most expensive stage") {
+    CHECK(lbann::pipeline::balance_stages({1,1,1,1}, 2)
+          == std::vector<size_t>({0, 2}));
+    CHECK(lbann::pipeline::balance_stages({1,2,3,4,5}, 3)
+          == std::vector<size_t>({0, 3, 4}));
+    CHECK(lbann::pipeline::balance_stages({4,1,1,1,1}, 2)
+          == std::vector<size_t>({0, 1}));
+  }
+
+  SECTION ("Every stage has a layer") {
+    CHECK(lbann::pipeline::balance_stages({1,1}, 5)
+          == std::vector<size_t>({0, 1}));
+    CHECK(lbann::pipeline::balance_stages({}, 3).empty());
+  }
+
+}
+
+TEST_CASE ("Testing pipeline schedules", "[pipeline][utilities]") {
+
+  const int num_stages = 4;
+  const int num_micro_batches = 6;
+  SECTION ("Each stage runs every pass once") {
+    for (const auto& type : {schedule_type::gpipe,
+                             schedule_type::one_forward_one_backward}) {
+      for (int stage = 0; stage < num_stages; ++stage) {
+        const auto ops = lbann::pipeline::get_schedule(
+          type, stage, num_stages, num_micro_batches);
+        REQUIRE(ops.size() == size_t(2 * num_micro_batches));
+        std::set<int> forward, backward;
+        size_t max_in_flight = 0;
+        for (const auto& op : ops) {
+          if (op.forward) {
+            CHECK(forward.insert(op.micro_batch).second);
+          } else {
+            CHECK(forward.count(op.micro_batch));
+            CHECK(backward.insert(op.micro_batch).second);
+          }
+          max_in_flight = std::max(max_in_flight,
+                                   forward.size() - backward.size());
+        }
+        CHECK(forward.size() == size_t(num_micro_batches));
+        CHECK(backward.size() == size_t(num_micro_batches));
+        if (type == schedule_type::gpipe) {
+          CHECK(max_in_flight == size_t(num_micro_batches));
+        } else {
+          CHECK(max_in_flight == size_t(num_stages - stage));
+        }
+      }
+    }
+  }
+
+  SECTION ("Step time includes the pipeline bubble") {
+    const std::vector<double> forward(num_stages, 1.), backward(num_stages, 2.);
+    const double expected = (num_micro_batches + num_stages - 1) * 3.;
+    CHECK(lbann::pipeline::estimate_step_time(
+            schedule_type::gpipe, forward, backward, num_micro_batches)
+          == Approx(expected));
+    CHECK(lbann::pipeline::estimate_step_time(
+            schedule_type::one_forward_one_backward, forward, backward,
+            num_micro_batches)
+          == Approx(expected));
+    CHECK(lbann::pipeline::estimate_step_time(
+            schedule_type::gpipe, {1.}, {2.}, 4)
+          == Approx(12.));
+  }
+
+}
@@ -0,0 +1,79 @@
+// MUST include this
+#include <catch2/catch.hpp>
+
+// File being tested
+#include <lbann/utils/quantization.hpp>
+
+#include <cmath>
+#include <vector>
+
+using lbann::utils::storage_type;
+
+TEST_CASE ("Testing reduced-precision sample storage", "[quantization][utilities]") {
+
+  SECTION ("fp16 conversion") {
+    CHECK(lbann::utils::float_to_half(0.f) == 0x0000);
+    CHECK(lbann::utils::float_to_half(-0.f) == 0x8000);
+    CHECK(lbann::utils::float_to_half(1.f) == 0x3c00);
+    CHECK(lbann::utils::float_to_half(-2.f) == 0xc000);
+    CHECK(lbann::utils::float_to_half(65504.f) == 0x7bff);
+    CHECK(lbann::utils::float_to_half(1e6f) == 0x7c00);
+    CHECK(lbann::utils::float_to_half(std::ldexp(1.f, -24)) == 0x0001);
+    CHECK(lbann::utils::float_to_half(std::ldexp(1.f, -14)) == 0x0400);
+    // Ties round to even
+    CHECK(lbann::utils::float_to_half(1.f + std::ldexp(1.f, -11)) == 0x3c00);
+    CHECK(lbann::utils::float_to_half(1.f + 3*std::ldexp(1.f, -11)) == 0x3c02);
+    CHECK(std::isnan(lbann::utils::half_to_float(
+                       lbann::utils::float_to_half(std::nanf("")))));
+    for (uint32_t bits = 0; bits < 0x7c00; ++bits) {
+      const float x = lbann::utils::half_to_float(bits);
+      CHECK(lbann::utils::float_to_half(x) == bits);
+    }
+  }
+
+  SECTION ("bf16 conversion") {
+    CHECK(lbann::utils::float_to_bf16(1.f) == 0x3f80);
+    CHECK(lbann::utils::bf16_to_float(0x3f80) == 1.f);
+    CHECK(lbann::utils::float_to_bf16(1.f + std::ldexp(1.f, -8)) == 0x3f80);
+    CHECK(lbann::utils::float_to_bf16(1.f + 3*std::ldexp(1.f, -8)) == 0x3f82);
+  }
+
+  SECTION ("round trips stay within the precision of the type") {
+    std::vector<float> values;
+    for (int i = 0; i < 1000; ++i) {
+      values.push_back(std::sin(0.01f * i) * 40.f + 3.f);
+    }
+    for (auto t : {storage_type::uint8, storage_type::fp16, storage_type::bf16}) {
+      std::vector<unsigned char> stored(values.size() * lbann::utils::storage_type_size(t));
+      double scale, offset;
+      lbann::utils::quantize(values.data(), values.size(), t, stored.data(),
+                             scale, offset);
+      std::vector<double> restored(values.size());
+      lbann::utils::dequantize(stored.data(), values.size(), t, scale, offset,
+                               restored.data());
+      const double tolerance = (t == storage_type::uint8 ? 80.0 / 255 / 2
+                                : t == storage_type::fp16 ? 43.0 / 2048
+                                : 43.0 / 256);
+      for (size_t i = 0; i < values.size(); ++i) {
+        CHECK(std::abs(restored[i] - values[i]) <= tolerance + 1e-6);
+      }
+    }
+  }
+
+  SECTION ("constant values are exact in uint8") {
+    std::vector<float> values(10, 7.5f);
+    std::vector<uint8_t> stored(values.size());
+    double scale, offset;
+    lbann::utils::quantize(values.data(), values.size(), storage_type::uint8,
+                           stored.data(), scale, offset);
+    std::vector<float> restored(values.size());
+    lbann::utils::dequantize(stored.data(), values.size(), storage_type::uint8,
+                             scale, offset, restored.data());
+    CHECK(restored == values);
+  }
+
+  SECTION ("storage types parse") {
+    CHECK(lbann::utils::parse_storage_type("bf16") == storage_type::bf16);
+    CHECK(lbann::utils::to_string(storage_type::fp16) == "fp16");
+  }
+}
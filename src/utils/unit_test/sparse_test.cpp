@@ -0,0 +1,93 @@
+// MUST include this
+#include <catch2/catch.hpp>
+
+// File being tested
+#include <lbann/utils/sparse.hpp>
+
+namespace {
+
+using MatType = El::Matrix<double, El::Device::CPU>;
+
+/** Matrix with a deterministic pattern of zeros. */
+MatType make_sparse_matrix(El::Int height, El::Int width) {
+  MatType X(height, width);
+  for (El::Int col = 0; col < width; ++col) {
+    for (El::Int row = 0; row < height; ++row) {
+      X(row, col) = ((row + 3*col) % 5 == 0) ? double(row - col) + 0.5 : 0.;
+    }
+  }
+  return X;
+}
+
+MatType make_dense_matrix(El::Int height, El::Int width) {
+  MatType A(height, width);
+  for (El::Int col = 0; col < width; ++col) {
+    for (El::Int row = 0; row < height; ++row) {
+      A(row, col) = 0.25 * row - 0.125 * col + 1.;
+    }
+  }
+  return A;
+}
+
+void check_equal(const MatType& A, const MatType& B) {
+  REQUIRE(A.Height() == B.Height());
+  REQUIRE(A.Width() == B.Width());
+  for (El::Int col = 0; col < A.Width(); ++col) {
+    for (El::Int row = 0; row < A.Height(); ++row) {
+      CHECK(A(row, col) == Approx(B(row, col)));
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("Sparse mini-batch GEMMs", "[sparse][utilities]") {
+
+  const El::Int num_features = 13, num_samples = 7, num_outputs = 4;
+  const auto X = make_sparse_matrix(num_features, num_samples);
+  lbann::sparse_mini_batch<double> sparse;
+  lbann::compress_mini_batch(X, sparse);
+
+  SECTION("Compression") {
+    CHECK(sparse.num_features == num_features);
+    CHECK(sparse.num_samples == num_samples);
+    El::Int nnz = 0;
+    for (El::Int col = 0; col < num_samples; ++col) {
+      for (El::Int row = 0; row < num_features; ++row) {
+        if (X(row, col) != 0.) { ++nnz; }
+      }
+    }
+    CHECK(sparse.num_nonzeros() == nnz);
+    CHECK(sparse.density() < 0.5);
+  }
+
+  SECTION("Forward product") {
+    const auto W = make_dense_matrix(num_outputs, num_features);
+    MatType Y_dense, Y_sparse(num_outputs, num_samples);
+    El::Gemm(El::NORMAL, El::NORMAL, 2., W, X, 0., Y_dense);
+    El::Fill(Y_sparse, 1.);
+    lbann::sparse_gemm(El::NORMAL, 2., W, sparse, 0., Y_sparse);
+    check_equal(Y_sparse, Y_dense);
+
+    const auto WT = make_dense_matrix(num_features, num_outputs);
+    El::Gemm(El::TRANSPOSE, El::NORMAL, 1., WT, X, 0., Y_dense);
+    lbann::sparse_gemm(El::TRANSPOSE, 1., WT, sparse, 0., Y_sparse);
+    check_equal(Y_sparse, Y_dense);
+  }
+
+  SECTION("Gradient product") {
+    const auto D = make_dense_matrix(num_outputs, num_samples);
+    auto G_dense = make_dense_matrix(num_outputs, num_features);
+    auto G_sparse = G_dense;
+    El::Gemm(El::NORMAL, El::TRANSPOSE, 0.5, D, X, 2., G_dense);
+    lbann::sparse_gemm_gradient(false, 0.5, D, sparse, 2., G_sparse);
+    check_equal(G_sparse, G_dense);
+
+    auto GT_dense = make_dense_matrix(num_features, num_outputs);
+    auto GT_sparse = GT_dense;
+    El::Gemm(El::NORMAL, El::TRANSPOSE, 1., X, D, 1., GT_dense);
+    lbann::sparse_gemm_gradient(true, 1., D, sparse, 1., GT_sparse);
+    check_equal(GT_sparse, GT_dense);
+  }
+
+}
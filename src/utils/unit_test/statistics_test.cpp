@@ -0,0 +1,70 @@
+// MUST include this
+#include <catch2/catch.hpp>
+
+// File being tested
+#include <lbann/utils/statistics.hpp>
+
+#include <vector>
+
+TEST_CASE ("Testing mergeable streaming statistics", "[statistics][utilities]") {
+
+  std::vector<double> values;
+  for (int i=0; i<1000; ++i) {
+    values.push_back(1e6 + (i*37 % 101) * 0.25);
+  }
+  double mean = 0, var = 0;
+  for (const auto& x : values) { mean += x; }
+  mean /= values.size();
+  for (const auto& x : values) { var += (x-mean)*(x-mean); }
+  var /= values.size();
+
+  SECTION ("single pass") {
+    lbann::running_statistics stats;
+    for (const auto& x : values) { stats.add(x); }
+    CHECK(stats.count() == values.size());
+    CHECK(stats.mean() == Approx(mean));
+    CHECK(stats.variance() == Approx(var));
+    CHECK(stats.min() == 1e6);
+    CHECK(stats.max() == 1e6 + 25.0);
+  }
+
+  SECTION ("merge matches a single pass") {
+    std::vector<lbann::running_statistics> parts(7);
+    for (size_t i=0; i<values.size(); ++i) {
+      parts[(i*i) % parts.size()].add(values[i]);
+    }
+    lbann::running_statistics stats;
+    stats.merge(lbann::running_statistics());
+    for (const auto& p : parts) { stats.merge(p); }
+    CHECK(stats.count() == values.size());
+    CHECK(stats.mean() == Approx(mean));
+    CHECK(stats.variance() == Approx(var));
+    CHECK(stats.min() == 1e6);
+    CHECK(stats.max() == 1e6 + 25.0);
+  }
+
+  SECTION ("histograms") {
+    lbann::running_statistics a(4, 0.0, 4.0), b(4, 0.0, 4.0);
+    a.add(-1.0);
+    a.add(0.5);
+    b.add(3.5);
+    b.add(10.0);
+    a.merge(b);
+    CHECK(a.histogram() == std::vector<double>{2, 0, 0, 2});
+    lbann::running_statistics c(3, 0.0, 4.0);
+    CHECK_THROWS(a.merge(c));
+  }
+
+  SECTION ("pack and unpack") {
+    lbann::running_statistics a(2, 0.0, 1.0), b(2, 0.0, 1.0);
+    for (const auto& x : {0.1, 0.2, 0.9}) { a.add(x); }
+    std::vector<double> buffer;
+    a.pack(buffer);
+    CHECK(buffer.size() == a.packed_size());
+    CHECK(b.unpack(buffer.data()) == buffer.data() + buffer.size());
+    CHECK(b.count() == a.count());
+    CHECK(b.mean() == a.mean());
+    CHECK(b.variance() == a.variance());
+    CHECK(b.histogram() == a.histogram());
+  }
+}
@@ -0,0 +1,47 @@
+// MUST include this
+#include <catch2/catch.hpp>
+
+// File being tested
+#include <lbann/utils/threads/thread_pool.hpp>
+
+#include <vector>
+
+TEST_CASE ("Testing the thread pool's work-stealing chunks", "[threads][utilities]") {
+
+  lbann::thread_pool pool;
+
+  SECTION ("each item is handed out exactly once") {
+    const size_t n = 103;
+    pool.partition_work(n, 4, 3);
+    std::vector<int> seen(n, 0);
+    size_t begin, end;
+    // Worker 0 drains its own deque, then steals everything else
+    while (pool.get_next_chunk(0, begin, end)) {
+      CHECK(begin < end);
+      CHECK(end - begin <= 4);
+      for (size_t i=begin; i<end; ++i) {
+        ++seen[i];
+      }
+    }
+    for (size_t i=0; i<n; ++i) {
+      CHECK(seen[i] == 1);
+    }
+    CHECK_FALSE(pool.get_next_chunk(1, begin, end));
+  }
+
+  SECTION ("workers start on their own contiguous region") {
+    pool.partition_work(12, 2, 3);
+    size_t begin, end;
+    REQUIRE(pool.get_next_chunk(1, begin, end));
+    CHECK(begin == 4);
+    CHECK(end == 6);
+    REQUIRE(pool.get_next_chunk(2, begin, end));
+    CHECK(begin == 8);
+    // Repartitioning discards whatever was left
+    pool.partition_work(2, 8, 1);
+    REQUIRE(pool.get_next_chunk(0, begin, end));
+    CHECK(begin == 0);
+    CHECK(end == 2);
+    CHECK_FALSE(pool.get_next_chunk(0, begin, end));
+  }
+}
@@ -0,0 +1,202 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014-2019, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory.
+// Written by the LBANN Research Team (B. Van Essen, et al.) listed in
+// the CONTRIBUTORS file. <lbann-dev@llnl.gov>
+//
+// LLNL-CODE-697807.
+// All rights reserved.
+//
+// This file is part of LBANN: Livermore Big Artificial Neural Network
+// Toolkit. For details, see http://software.llnl.gov/LBANN or
+// https://github.com/LLNL/LBANN.
+//
+// Licensed under the Apache License, Version 2.0 (the "Licensee"); you
+// may not use this file except in compliance with the License.  You may
+// obtain a copy of the License at:
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the license.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "lbann/utils/winograd.hpp"
+
+namespace lbann {
+
+namespace {
+
+// 1D transforms from Lavin and Gray, "Fast Algorithms for
+// Convolutional Neural Networks" (2016). Each 2D transform applies
+// the 1D transform to the columns and then to the rows of a tile.
+
+/** Input transform (B^T d) of 6 entries. */
+template <typename T>
+inline void input_transform_1d(const T* d, int ds, T* r, int rs) {
+  const T d0 = d[0], d1 = d[ds], d2 = d[2*ds];
+  const T d3 = d[3*ds], d4 = d[4*ds], d5 = d[5*ds];
+  r[0]    = T(4)*d0 - T(5)*d2 + d4;
+  r[rs]   = -T(4)*d1 - T(4)*d2 + d3 + d4;
+  r[2*rs] = T(4)*d1 - T(4)*d2 - d3 + d4;
+  r[3*rs] = -T(2)*d1 - d2 + T(2)*d3 + d4;
+  r[4*rs] = T(2)*d1 - d2 - T(2)*d3 + d4;
+  r[5*rs] = T(4)*d1 - T(5)*d3 + d5;
+}
+
+/** Filter transform (G g) of 3 entries into 6. */
+template <typename T>
+inline void filter_transform_1d(const T* g, int gs, T* r, int rs) {
+  const T g0 = g[0], g1 = g[gs], g2 = g[2*gs];
+  r[0]    = g0 / T(4);
+  r[rs]   = -(g0 + g1 + g2) / T(6);
+  r[2*rs] = -(g0 - g1 + g2) / T(6);
+  r[3*rs] = g0 / T(24) + g1 / T(12) + g2 / T(6);
+  r[4*rs] = g0 / T(24) - g1 / T(12) + g2 / T(6);
+  r[5*rs] = g2;
+}
+
+/** Output transform (A^T m) of 6 entries into 4. */
+template <typename T>
+inline void output_transform_1d(const T* m, int ms, T* r, int rs) {
+  const T m0 = m[0], m1 = m[ms], m2 = m[2*ms];
+  const T m3 = m[3*ms], m4 = m[4*ms], m5 = m[5*ms];
+  r[0]    = m0 + m1 + m2 + m3 + m4;
+  r[rs]   = m1 - m2 + T(2)*m3 - T(2)*m4;
+  r[2*rs] = m1 + m2 + T(4)*m3 + T(4)*m4;
+  r[3*rs] = m1 - m2 + T(8)*m3 - T(8)*m4 + m5;
+}
+
+} // namespace
+
+template <typename TensorDataType>
+void winograd_f4x4_3x3_transform_filters(
+  const TensorDataType * kernel_buffer,
+  TensorDataType * transformed_buffer,
+  const int num_input_channels,
+  const int num_output_channels) {
+  using T = TensorDataType;
+  const int matrix_size = num_output_channels * num_input_channels;
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (int in_c = 0; in_c < num_input_channels; ++in_c) {
+    for (int out_c = 0; out_c < num_output_channels; ++out_c) {
+      const T* g = &kernel_buffer[9 * (in_c + out_c * num_input_channels)];
+      T tmp[6*3], u[6*6];
+      for (int x = 0; x < 3; ++x) {
+        filter_transform_1d(&g[x], 3, &tmp[x], 3);
+      }
+      for (int y = 0; y < 6; ++y) {
+        filter_transform_1d(&tmp[3*y], 1, &u[6*y], 1);
+      }
+      const int index = out_c + in_c * num_output_channels;
+      for (int i = 0; i < 36; ++i) {
+        transformed_buffer[index + i * matrix_size] = u[i];
+      }
+    }
+  }
+}
+
+template <typename TensorDataType>
+void winograd_f4x4_3x3_convolution(
+  const TensorDataType * input_buffer,
+  const TensorDataType * transformed_filters,
+  TensorDataType * output_buffer,
+  const int num_input_channels,
+  const int num_output_channels,
+  const int input_dim_y,
+  const int input_dim_x,
+  const int pad_y,
+  const int pad_x) {
+  using T = TensorDataType;
+  const int C = num_input_channels;
+  const int K = num_output_channels;
+  const int output_dim_y = input_dim_y + 2 * pad_y - 2;
+  const int output_dim_x = input_dim_x + 2 * pad_x - 2;
+  const int num_tiles_y = (output_dim_y + 3) / 4;
+  const int num_tiles_x = (output_dim_x + 3) / 4;
+  const int P = num_tiles_y * num_tiles_x;
+
+  // Transform input tiles into 36 matrices of size C x P
+  CPUMatDT<T> transformed_input(C * P, 36);
+  T* V = transformed_input.Buffer();
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (int c = 0; c < C; ++c) {
+    for (int p = 0; p < P; ++p) {
+      const int y0 = (p / num_tiles_x) * 4 - pad_y;
+      const int x0 = (p % num_tiles_x) * 4 - pad_x;
+      const T* channel = &input_buffer[c * input_dim_y * input_dim_x];
+      T d[6*6], tmp[6*6], v[6*6];
+      for (int y = 0; y < 6; ++y) {
+        for (int x = 0; x < 6; ++x) {
+          const int in_y = y0 + y, in_x = x0 + x;
+          const bool valid = (0 <= in_y && in_y < input_dim_y
+                              && 0 <= in_x && in_x < input_dim_x);
+          d[6*y+x] = valid ? channel[in_x + in_y * input_dim_x] : T(0);
+        }
+      }
+      for (int x = 0; x < 6; ++x) {
+        input_transform_1d(&d[x], 6, &tmp[x], 6);
+      }
+      for (int y = 0; y < 6; ++y) {
+        input_transform_1d(&tmp[6*y], 1, &v[6*y], 1);
+      }
+      for (int i = 0; i < 36; ++i) {
+        V[c + p * C + i * C * P] = v[i];
+      }
+    }
+  }
+
+  // Multiply transformed filters and inputs, one GEMM per tile entry
+  CPUMatDT<T> products(K * P, 36);
+  T* M = products.Buffer();
+  const auto one = El::TypeTraits<T>::One();
+  const auto zero = El::TypeTraits<T>::Zero();
+  for (int i = 0; i < 36; ++i) {
+    const CPUMatDT<T> U_i(K, C, &transformed_filters[i * K * C], K);
+    const CPUMatDT<T> V_i(C, P, &V[i * C * P], C);
+    CPUMatDT<T> M_i(K, P, &M[i * K * P], K);
+    El::Gemm(El::NORMAL, El::NORMAL, one, U_i, V_i, zero, M_i);
+  }
+
+  // Transform products into output tiles
+  LBANN_OMP_PARALLEL_FOR_COLLAPSE2
+  for (int k = 0; k < K; ++k) {
+    for (int p = 0; p < P; ++p) {
+      const int y0 = (p / num_tiles_x) * 4;
+      const int x0 = (p % num_tiles_x) * 4;
+      T m[6*6], tmp[4*6], y[4*4];
+      for (int i = 0; i < 36; ++i) {
+        m[i] = M[k + p * K + i * K * P];
+      }
+      for (int x = 0; x < 6; ++x) {
+        output_transform_1d(&m[x], 6, &tmp[x], 6);
+      }
+      for (int r = 0; r < 4; ++r) {
+        output_transform_1d(&tmp[6*r], 1, &y[4*r], 1);
+      }
+      T* channel = &output_buffer[k * output_dim_y * output_dim_x];
+      for (int r = 0; r < 4 && y0 + r < output_dim_y; ++r) {
+        for (int s = 0; s < 4 && x0 + s < output_dim_x; ++s) {
+          channel[(x0 + s) + (y0 + r) * output_dim_x] = y[4*r+s];
+        }
+      }
+    }
+  }
+
+}
+
+#define PROTO(T)                                                    \
+  template void winograd_f4x4_3x3_transform_filters<T>(             \
+    const T*, T*, int, int);                                        \
+  template void winograd_f4x4_3x3_convolution<T>(                   \
+    const T*, const T*, T*, int, int, int, int, int, int)
+
+#define LBANN_INSTANTIATE_CPU_HALF
+#define LBANN_INSTANTIATE_GPU_HALF
+#include "lbann/macros/instantiate.hpp"
+
+}  // namespace lbann
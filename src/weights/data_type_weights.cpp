@@ -28,6 +28,8 @@
 #include "lbann/weights/data_type_weights.hpp"
 #include "lbann/optimizers/optimizer.hpp"
 #include "lbann/utils/exception.hpp"
+#include "lbann/utils/memory.hpp"
+#include "lbann/utils/memory_usage.hpp"
 #include "lbann/io/file_io.hpp"
 
 #include <layers.pb.h>
@@ -75,8 +77,10 @@ template <typename TensorDataType>
 data_type_weights<TensorDataType>::data_type_weights(const WeightsType& other)
   : weights(other) {
 
+  // Share the weight matrix until either copy writes to it
+  m_values = other.m_values;
+
   // Deep copies
-  m_values.reset(other.m_values ? other.m_values->Copy() : nullptr);
   m_initializer.reset(other.m_initializer ?
                       other.m_initializer->copy() : nullptr);
   m_optimizer.reset(other.m_optimizer ?
@@ -84,15 +88,25 @@ data_type_weights<TensorDataType>::data_type_weights(const WeightsType& other)
   if (m_optimizer != nullptr) {
     m_optimizer->set_weights(this);
   }
+  m_master_weights.reset(other.m_master_weights ?
+                         other.m_master_weights->copy() : nullptr);
+
+}
 
+template <typename TensorDataType>
+data_type_weights<TensorDataType>::~data_type_weights() {
+  untie_values();
 }
 
 template <typename TensorDataType>
 auto data_type_weights<TensorDataType>::operator=(const WeightsType& other) -> WeightsType& {
   weights::operator=(other);
+  untie_values();
+
+  // Share the weight matrix until either copy writes to it
+  m_values = other.m_values;
 
   // Deep copies
-  m_values.reset(other.m_values ? other.m_values->Copy() : nullptr);
   m_initializer.reset(other.m_initializer ?
                       other.m_initializer->copy() : nullptr);
   m_optimizer.reset(other.m_optimizer ?
@@ -100,6 +114,8 @@ auto data_type_weights<TensorDataType>::operator=(const WeightsType& other) -> W
   if (m_optimizer != nullptr) {
     m_optimizer->set_weights(this);
   }
+  m_master_weights.reset(other.m_master_weights ?
+                         other.m_master_weights->copy() : nullptr);
 
   return *this;
 }
@@ -121,6 +137,16 @@ description data_type_weights<TensorDataType>::get_description() const {
   return desc;
 }
 
+template <typename TensorDataType>
+size_t data_type_weights<TensorDataType>::get_memory_usage(El::Device device) const {
+  size_t bytes = (get_local_memory_usage(m_values, device)
+                  + get_local_memory_usage(m_snapshot_values, device));
+  if (m_master_weights != nullptr) {
+    bytes += m_master_weights->get_memory_usage(device);
+  }
+  return bytes;
+}
+
 // -----------------------------------------------
 // Dimension accessors
 // -----------------------------------------------
@@ -205,6 +231,150 @@ void data_type_weights<TensorDataType>::set_optimizer(
     m_optimizer.reset();
 }
 
+template <typename TensorDataType>
+void data_type_weights<TensorDataType>::set_master_optimizer(
+  std::unique_ptr<optimizer>&& opt) {
+  if (m_values != nullptr) {
+    LBANN_ERROR("attempted to add master weights to weights \"",
+                get_name(), "\" after setup");
+  }
+  if (opt == nullptr) {
+    m_master_weights.reset();
+    return;
+  }
+  m_master_weights = make_unique<data_type_weights<float>>(&get_comm());
+  m_master_weights->set_optimizer(std::move(opt));
+}
+
+template <typename TensorDataType>
+data_type_weights<float>& data_type_weights<TensorDataType>::get_master_weights() {
+  if (m_master_weights == nullptr) {
+    LBANN_ERROR("attempted to access master weights of weights \"",
+                get_name(), "\", which has none");
+  }
+  return *m_master_weights;
+}
+
+template <typename TensorDataType>
+void data_type_weights<TensorDataType>::detach_values() {
+  if (m_values == nullptr || m_values.use_count() == 1) {
+    return;
+  }
+  if (m_tied_weights == nullptr) {
+    m_values.reset(m_values->Copy());
+    return;
+  }
+  // Only holders outside the tied group (copies, snapshots) need to
+  // keep the current values
+  if (m_values.use_count() == static_cast<long>(m_tied_weights->size())) {
+    return;
+  }
+  std::shared_ptr<AbsDistMatrixType> values(m_values->Copy());
+  for (auto* w : *m_tied_weights) {
+    w->m_values = values;
+  }
+}
+
+template <typename TensorDataType>
+void data_type_weights<TensorDataType>::attach_values(TensorDataType* buffer) {
+  if (m_values == nullptr) {
+    LBANN_ERROR("attempted to attach the values of weights \"", get_name(), "\" ",
+                "to external memory before setup");
+  }
+  if (dynamic_cast<El::ElementalMatrix<TensorDataType>*>(m_values.get()) == nullptr
+      || m_values->GetLocalDevice() != El::Device::CPU) {
+    LBANN_ERROR("attempted to attach the values of weights \"", get_name(), "\" ",
+                "to external memory, which needs an element-wise "
+                "distributed matrix on the CPU");
+  }
+  if (has_tied_values()) {
+    LBANN_ERROR("attempted to attach the values of weights \"", get_name(), "\" ",
+                "to external memory, but they are tied to other weights");
+  }
+  // Copies of the weights keep the current matrix
+  std::shared_ptr<AbsDistMatrixType> values(
+    m_values->Construct(m_values->Grid(), m_values->Root()));
+  values->AlignWith(*m_values);
+  dynamic_cast<El::ElementalMatrix<TensorDataType>&>(*values).Attach(
+    m_values->Height(), m_values->Width(), m_values->Grid(),
+    m_values->ColAlign(), m_values->RowAlign(), buffer,
+    std::max(m_values->LocalHeight(), El::Int(1)), m_values->Root());
+  m_values = std::move(values);
+  clear_initialization_pending();
+}
+
+template <typename TensorDataType>
+void data_type_weights<TensorDataType>::untie_values() {
+  if (m_tied_weights == nullptr) {
+    return;
+  }
+  auto& group = *m_tied_weights;
+  group.erase(std::remove(group.begin(), group.end(), this), group.end());
+  m_tied_weights.reset();
+}
+
+template <typename TensorDataType>
+void data_type_weights<TensorDataType>::tie_values(WeightsType& other) {
+  if (&other == this
+      || (m_tied_weights != nullptr && m_tied_weights == other.m_tied_weights)) {
+    return;
+  }
+  if (m_values == nullptr || other.m_values == nullptr) {
+    LBANN_ERROR("attempted to tie weights \"", get_name(), "\" ",
+                "to weights \"", other.get_name(), "\" before setup");
+  }
+  const auto dist = get_matrix_distribution();
+  const auto other_dist = other.get_matrix_distribution();
+  if (m_values->Height() != other.m_values->Height()
+      || m_values->Width() != other.m_values->Width()
+      || dist.colDist != other_dist.colDist
+      || dist.rowDist != other_dist.rowDist
+      || dist.device != other_dist.device) {
+    LBANN_ERROR("attempted to tie weights \"", get_name(), "\" ",
+                "to weights \"", other.get_name(), "\", ",
+                "which have a different shape or distribution");
+  }
+  if ((m_master_weights == nullptr) != (other.m_master_weights == nullptr)) {
+    LBANN_ERROR("attempted to tie weights \"", get_name(), "\" ",
+                "to weights \"", other.get_name(), "\", ",
+                "but only one of them has master weights");
+  }
+  if (m_master_weights != nullptr) {
+    m_master_weights->tie_values(*other.m_master_weights);
+  }
+
+  // Move this group (or just these weights) into the other's group
+  if (other.m_tied_weights == nullptr) {
+    other.m_tied_weights = std::make_shared<std::vector<WeightsType*>>(
+      1, &other);
+  }
+  std::vector<WeightsType*> joining{this};
+  if (m_tied_weights != nullptr) {
+    joining = *m_tied_weights;
+  }
+  for (auto* w : joining) {
+    w->m_tied_weights = other.m_tied_weights;
+    w->m_values = other.m_values;
+    other.m_tied_weights->push_back(w);
+  }
+  clear_initialization_pending();
+}
+
+template <typename TensorDataType>
+void data_type_weights<TensorDataType>::copy_values_from_master() {
+  if (m_master_weights != nullptr) {
+    detach_values();
+    El::Copy(m_master_weights->get_values(), *m_values);
+  }
+}
+
+template <typename TensorDataType>
+void data_type_weights<TensorDataType>::copy_values_to_master() {
+  if (m_master_weights != nullptr) {
+    El::Copy(*m_values, m_master_weights->get_values());
+  }
+}
+
 // -----------------------------------------------
 // Setup
 // -----------------------------------------------
@@ -228,10 +398,12 @@ void data_type_weights<TensorDataType>::setup() {
                                                 matrix_dist.device));
   m_values->AlignWith(matrix_dist);
   m_values->Resize(get_matrix_height(), get_matrix_width());
-  if (m_initializer != nullptr) {
-    m_initializer->fill(*m_values);
-  } else {
-    El::Zero(*m_values);
+  if (!is_initialization_pending()) {
+    if (m_initializer != nullptr) {
+      m_initializer->fill(*m_values);
+    } else {
+      El::Zero(*m_values);
+    }
   }
 
   // Setup optimizer
@@ -239,6 +411,32 @@ void data_type_weights<TensorDataType>::setup() {
     m_optimizer->setup(this);
   }
 
+  // Setup master weights with the initial values
+  if (m_master_weights != nullptr) {
+    m_master_weights->set_name(get_name() + "_master");
+    m_master_weights->set_dims(get_matrix_height_dims(),
+                               get_matrix_width_dims());
+    m_master_weights->set_matrix_distribution(matrix_dist);
+    m_master_weights->setup();
+    copy_values_to_master();
+  }
+
+}
+
+template <typename TensorDataType>
+void data_type_weights<TensorDataType>::initialize_values() {
+  if (m_values == nullptr) {
+    LBANN_ERROR("attempted to initialize values of "
+                "weights \"",get_name(),"\" before setup");
+  }
+  detach_values();
+  if (m_initializer != nullptr) {
+    m_initializer->fill(*m_values);
+  } else {
+    El::Zero(*m_values);
+  }
+  copy_values_to_master();
+  clear_initialization_pending();
 }
 
 // -----------------------------------------------
@@ -247,6 +445,7 @@ void data_type_weights<TensorDataType>::setup() {
 
 template <typename TensorDataType>
 auto data_type_weights<TensorDataType>::get_values() -> AbsDistMatrixType& {
+  detach_values();
   return const_cast<AbsDistMatrixType&>(static_cast<const data_type_weights&>(*this).get_values());
 }
 template <typename TensorDataType>
@@ -263,6 +462,8 @@ auto data_type_weights<TensorDataType>::get_values() const
 template <typename TensorDataType>
 void data_type_weights<TensorDataType>::set_values(const AbsDistMatrixType& values) {
   El::Copy(values, get_values());
+  copy_values_to_master();
+  clear_initialization_pending();
 }
 
 template <typename TensorDataType>
@@ -333,11 +534,19 @@ void data_type_weights<TensorDataType>::set_value(TensorDataType value, int row,
   if (values.IsLocal(row, col)) {
     values.SetLocal(values.LocalRow(row), values.LocalCol(col), value);
   }
+  if (m_master_weights != nullptr) {
+    m_master_weights->set_value(El::To<float>(value), row, col);
+  }
 
 }
 
 template <typename TensorDataType>
 void data_type_weights<TensorDataType>::reconcile_values() {
+  if (m_master_weights != nullptr) {
+    m_master_weights->reconcile_values();
+    copy_values_from_master();
+    return;
+  }
   auto& values = get_values();
   if (values.RedundantSize() > 1) {
     El::Scale(TensorDataType(1. / values.RedundantSize()), values);
@@ -354,6 +563,30 @@ void data_type_weights<TensorDataType>::reconcile_values(Al::request& req) {
   }
 }
 
+template <typename TensorDataType>
+void data_type_weights<TensorDataType>::save_snapshot() {
+  if (m_values == nullptr) {
+    LBANN_ERROR("attempted to save a snapshot of weights \"", get_name(), "\" ",
+                "before they are setup");
+  }
+  // The snapshot shares the weight matrix until the next write
+  m_snapshot_values = m_values;
+}
+
+template <typename TensorDataType>
+void data_type_weights<TensorDataType>::swap_snapshot() {
+  if (m_snapshot_values == nullptr) {
+    LBANN_ERROR("attempted to swap values of weights \"", get_name(), "\" ",
+                "with a snapshot, but no snapshot has been saved");
+  }
+  std::swap(m_values, m_snapshot_values);
+}
+
+template <typename TensorDataType>
+void data_type_weights<TensorDataType>::clear_snapshot() {
+  m_snapshot_values.reset();
+}
+
 // -----------------------------------------------
 // Checkpointing
 // -----------------------------------------------
@@ -417,7 +650,10 @@ bool data_type_weights<TensorDataType>::load_from_checkpoint_shared(lbann::persi
   auto f_name = El::BuildString("weights_", get_name(), "_",
                                 m_values->Height(), "x", m_values->Width(),
                                 ".bin");
+  detach_values();
   p.read_distmat(persist_type::model, f_name.c_str(), m_values.get());
+  copy_values_to_master();
+  clear_initialization_pending();
   if (m_optimizer != nullptr) {
     m_optimizer->load_from_checkpoint_shared(p, get_name());
   }
@@ -444,7 +680,10 @@ bool data_type_weights<TensorDataType>::load_from_save(std::string const& ckpt_d
       throw lbann_exception(std::string("Failed to read weight matrix: ") + full_path);
       return false;
     }
+    detach_values();
     El::Read(*m_values,full_path, El::BINARY, true);
+    copy_values_to_master();
+    clear_initialization_pending();
   }
   return true;
 }
@@ -468,7 +707,10 @@ bool data_type_weights<TensorDataType>::load_from_checkpoint_distributed(lbann::
   auto l_name = El::BuildString("weights_", get_name(),
                                 "_", m_values->LocalHeight(),
                                 "x", m_values->LocalWidth(), ".bin");
+  detach_values();
   p.read_rank_distmat(persist_type::model, l_name.c_str(), *m_values);
+  copy_values_to_master();
+  clear_initialization_pending();
   if (m_optimizer != nullptr) {
     m_optimizer->load_from_checkpoint_distributed(p, get_name());
   }
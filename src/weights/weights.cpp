@@ -63,7 +63,8 @@ std::string get_dims_string(const std::vector<int>& matrix_height_dims,
 
 weights::weights()
   : m_comm(nullptr),
-    m_frozen(false) {
+    m_frozen(false),
+    m_initialization_pending(false) {
 
   // Initialize weights name
   static int num_weights = 0;
@@ -86,7 +87,8 @@ weights::weights(const weights& other)
     m_matrix_height_dims(other.m_matrix_height_dims),
     m_matrix_width_dims(other.m_matrix_width_dims),
     m_matrix_dist(other.m_matrix_dist),
-    m_frozen(other.m_frozen) {
+    m_frozen(other.m_frozen),
+    m_initialization_pending(other.m_initialization_pending) {
 
 }
 
@@ -97,6 +99,7 @@ weights& weights::operator=(const weights& other) {
   m_matrix_width_dims = other.m_matrix_width_dims;
   m_matrix_dist = other.m_matrix_dist;
   m_frozen = other.m_frozen;
+  m_initialization_pending = other.m_initialization_pending;
 
   return *this;
 }
@@ -0,0 +1,45 @@
+#include "lbann/data_readers/data_reader_smiles.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+// Tokenize a SMILES file offline into the binary cache that
+// smiles_data_reader maps with --smiles_token_cache. The cache is written
+// next to the input as <smiles_file>.lbtok, which is where the reader looks.
+
+int main(int argc, char** argv)
+{
+  if (argc < 3) {
+    std::cout << "Usage .... exec smiles_file vocab_file [delimiter: c|t|0]" << std::endl
+              << "the first line of smiles_file is treated as a header" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const std::string smiles_file = argv[1];
+  const std::string vocab_file = argv[2];
+  char delimiter = '\0';
+  if (argc > 3) {
+    switch (argv[3][0]) {
+      case 'c' : delimiter = ','; break;
+      case 't' : delimiter = '\t'; break;
+      case '0' : delimiter = '\0'; break;
+      default :
+        std::cerr << "invalid delimiter; should be 'c', 't', '0'" << std::endl;
+        return EXIT_FAILURE;
+    }
+  }
+
+  try {
+    std::unordered_map<char, short> vocab;
+    short pad, unk, bos, eos;
+    lbann::smiles_data_reader::read_vocab(vocab_file, vocab, pad, unk, bos, eos);
+    const size_t n = lbann::smiles_data_reader::write_token_cache(
+      smiles_file, smiles_file + ".lbtok", vocab, unk, delimiter, true);
+    std::cout << "wrote " << n << " samples to " << smiles_file << ".lbtok" << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,258 @@
+#include "lbann/lbann.hpp"
+#include "lbann/utils/image.hpp"
+#include "lbann/utils/jag_utils.hpp"
+#include "lbann/utils/statistics.hpp"
+#include "lbann/utils/threads/thread_pool.hpp"
+#include "conduit/conduit.hpp"
+#include "conduit/conduit_relay.hpp"
+#include "conduit/conduit_relay_io_hdf5.hpp"
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Compute per-channel mean, standard deviation, min, max and, optionally,
+// histograms of a dataset in one streaming pass. The files are striped
+// over the MPI ranks and over each rank's threads; every thread keeps its
+// own running_statistics, which are merged on the rank and then gathered
+// to the world master. The result is written as the normalize or
+// normalize_to_lbann_layout transform that consumes it.
+//
+// Images (--image_list) are in OpenCV channel order, as the transforms
+// expect, and are scaled by --scale (default 1/255) to match the output
+// of to_lbann_layout. For conduit bundles (--bundle_list) each of --fields
+// is one channel.
+
+using namespace lbann;
+
+namespace {
+
+using channel_statistics = std::vector<running_statistics>;
+
+// The HDF5 library is not assumed to be thread-safe
+std::mutex hdf5_mutex;
+
+channel_statistics make_statistics(size_t num_channels, size_t num_bins,
+                                   double lo, double hi) {
+  return channel_statistics(num_channels, running_statistics(num_bins, lo, hi));
+}
+
+void add_image(const std::string& filename, double scale,
+               channel_statistics& stats) {
+  El::Matrix<uint8_t> image;
+  std::vector<size_t> dims;
+  load_image(filename, image, dims);
+  const size_t num_channels = dims[0];
+  if (num_channels != stats.size()) {
+    LBANN_ERROR(filename, " has ", num_channels, " channels, but --channels=",
+                stats.size());
+  }
+  // OpenCV images are interleaved
+  const uint8_t* buf = image.LockedBuffer();
+  const size_t size = dims[0] * dims[1] * dims[2];
+  for (size_t i = 0; i < size; i += num_channels) {
+    for (size_t c = 0; c < num_channels; ++c) {
+      stats[c].add(buf[i + c] * scale);
+    }
+  }
+}
+
+void add_bundle(const std::string& filename,
+                const std::vector<std::string>& fields, double scale,
+                channel_statistics& stats) {
+  std::vector<conduit::Node> values(fields.size());
+  std::vector<std::string> cnames;
+  hid_t hnd;
+  {
+    std::lock_guard<std::mutex> lock(hdf5_mutex);
+    hnd = conduit::relay::io::hdf5_open_file_for_read(filename);
+    conduit::relay::io::hdf5_group_list_child_names(hnd, "/", cnames);
+  }
+  conduit::Node n_ok, tmp;
+  for (const auto& name : cnames) {
+    {
+      std::lock_guard<std::mutex> lock(hdf5_mutex);
+      const std::string key_ok = "/" + name + "/performance/success";
+      if (!conduit::relay::io::hdf5_has_path(hnd, key_ok)) {
+        continue;
+      }
+      conduit::relay::io::hdf5_read(hnd, key_ok, n_ok);
+      if (n_ok.to_int64() != 1) {
+        continue;
+      }
+      for (size_t f = 0; f < fields.size(); ++f) {
+        conduit::relay::io::hdf5_read(hnd, "/" + name + "/" + fields[f], values[f]);
+      }
+    }
+    for (size_t f = 0; f < fields.size(); ++f) {
+      values[f].to_float64_array(tmp);
+      const conduit::float64_array a = tmp.value();
+      for (conduit::index_t i = 0; i < a.number_of_elements(); ++i) {
+        stats[f].add(a[i] * scale);
+      }
+    }
+  }
+  std::lock_guard<std::mutex> lock(hdf5_mutex);
+  conduit::relay::io::hdf5_close_file(hnd);
+}
+
+std::string join(const channel_statistics& stats,
+                 double (running_statistics::*get)() const) {
+  std::stringstream ss;
+  ss << std::setprecision(6);
+  for (size_t c = 0; c < stats.size(); ++c) {
+    ss << (c > 0 ? " " : "") << (stats[c].*get)();
+  }
+  return ss.str();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  world_comm_ptr comm = initialize(argc, argv, lbann_default_random_seed);
+  const bool master = comm->am_world_master();
+
+  try {
+    options *opts = options::get();
+    opts->init(argc, argv);
+    const bool images = opts->has_string("image_list");
+    if (!(images || (opts->has_string("bundle_list") && opts->has_string("fields")))) {
+      if (master) {
+        std::cout << "usage: " << argv[0] << "\n"
+          "    --image_list=<string> [--image_dir=<string>] [--channels=<int>]\n"
+          "  or\n"
+          "    --bundle_list=<string> --fields=<string>\n"
+          "  [--output=<string>] [--num_threads=<int>] [--scale=<double>]\n"
+          "  [--histogram_bins=<int> --histogram_min=<double> --histogram_max=<double>]\n"
+          "where: image_list has one '<image path> <label>' per line, relative\n"
+          "       to image_dir; channels defaults to 3\n"
+          "       bundle_list has one conduit HDF5 bundle per line and fields\n"
+          "       is a comma-separated list of per-sample paths, e.g.\n"
+          "       'inputs/t_end,outputs/images/(0.0, 0.0)/0.0/emi'\n"
+          "       values are multiplied by scale (1/255 for images, 1 otherwise)\n"
+          "function: writes <output>.prototext (default: normalization) with\n"
+          "          the normalize transform and <output>.txt with the\n"
+          "          per-channel count, mean, stdev, min, max and histogram\n";
+      }
+      return EXIT_SUCCESS;
+    }
+
+    std::vector<std::string> fields;
+    if (!images) {
+      std::stringstream ss(opts->get_string("fields"));
+      std::string f;
+      while (std::getline(ss, f, ',')) {
+        if (!f.empty()) { fields.push_back(f); }
+      }
+    }
+    const size_t num_channels = images ? opts->get_int("channels", 3) : fields.size();
+    const double scale = opts->get_double("scale", images ? 1.0/255.0 : 1.0);
+    const size_t num_bins = opts->get_int("histogram_bins", 0);
+    const double hist_lo = opts->get_double("histogram_min", 0.0);
+    const double hist_hi = opts->get_double("histogram_max", 1.0);
+    const int num_threads = opts->get_int("num_threads", 4);
+    const std::string output = opts->get_string("output", "normalization");
+
+    // Every rank gets the list; image lines keep only the path
+    std::vector<std::string> filenames;
+    read_filelist(comm.get(), opts->get_string(images ? "image_list" : "bundle_list"),
+                  filenames);
+    if (images) {
+      std::vector<std::string> paths;
+      const std::string dir = opts->get_string("image_dir", "");
+      for (size_t i = 0; i < filenames.size(); i += 2) {
+        paths.push_back(dir + filenames[i]);
+      }
+      filenames.swap(paths);
+    }
+
+    // One task per thread, each with its own accumulators
+    const int rank = comm->get_rank_in_world();
+    const int np = comm->get_procs_in_world();
+    const double tm1 = get_time();
+    thread_pool pool(num_threads);
+    std::vector<std::future<channel_statistics>> tasks;
+    for (int t = 0; t < num_threads; ++t) {
+      tasks.emplace_back(pool.submit_job([&, t]() {
+        auto stats = make_statistics(num_channels, num_bins, hist_lo, hist_hi);
+        for (size_t j = rank + size_t(t)*np; j < filenames.size();
+             j += size_t(np)*num_threads) {
+          if (images) {
+            add_image(filenames[j], scale, stats);
+          } else {
+            add_bundle(filenames[j], fields, scale, stats);
+          }
+        }
+        return stats;
+      }));
+    }
+    auto stats = make_statistics(num_channels, num_bins, hist_lo, hist_hi);
+    for (auto& t : tasks) {
+      const auto part = t.get();
+      for (size_t c = 0; c < num_channels; ++c) {
+        stats[c].merge(part[c]);
+      }
+    }
+
+    // Gather the packed accumulators on the master and merge them
+    std::vector<double> packed;
+    for (const auto& s : stats) { s.pack(packed); }
+    std::vector<double> all(master ? packed.size() * np : 0);
+    MPI_Gather(packed.data(), packed.size(), MPI_DOUBLE,
+               all.data(), packed.size(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    const double tm2 = get_time();
+
+    if (master) {
+      auto total = make_statistics(num_channels, num_bins, hist_lo, hist_hi);
+      auto part = make_statistics(num_channels, num_bins, hist_lo, hist_hi);
+      const double* buf = all.data();
+      for (int r = 0; r < np; ++r) {
+        for (size_t c = 0; c < num_channels; ++c) {
+          buf = part[c].unpack(buf);
+          total[c].merge(part[c]);
+        }
+      }
+
+      std::ofstream out(output + ".prototext");
+      out << "# written by compute_normalization from " << filenames.size()
+          << (images ? " images\n" : " bundles\n")
+          << (images ? "normalize_to_lbann_layout {\n" : "normalize {\n")
+          << "  means: \"" << join(total, &running_statistics::mean) << "\"\n"
+          << "  stddevs: \"" << join(total, &running_statistics::stdev) << "\"\n"
+          << "}\n";
+      out.close();
+
+      std::ofstream table(output + ".txt");
+      table << "# channel count mean stdev min max";
+      if (num_bins > 0) {
+        table << " histogram(" << num_bins << " bins in [" << hist_lo << ", "
+              << hist_hi << "))";
+      }
+      table << "\n" << std::setprecision(8);
+      for (size_t c = 0; c < num_channels; ++c) {
+        const auto& s = total[c];
+        table << (images ? std::to_string(c) : fields[c]) << " " << s.count()
+              << " " << s.mean() << " " << s.stdev() << " " << s.min()
+              << " " << s.max();
+        for (const auto& h : s.histogram()) { table << " " << h; }
+        table << "\n";
+      }
+      table.close();
+
+      std::cout << "computed statistics of " << filenames.size() << " files on "
+                << np << " ranks x " << num_threads << " threads in "
+                << tm2 - tm1 << " s; wrote " << output << ".prototext and "
+                << output << ".txt" << std::endl;
+    }
+
+  } catch (std::exception const &e) {
+    El::ReportException(e);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
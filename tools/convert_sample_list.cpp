@@ -0,0 +1,87 @@
+#include "lbann/data_readers/sample_list_binary.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Convert a text inclusion sample list (CONDUIT_HDF5_INCLUSION) into the
+// binary, indexed format read by lbann::sample_list_binary. Exclusion
+// lists do not name their included samples, so they cannot be converted
+// without opening every bundle.
+
+int main(int argc, char** argv)
+{
+  if (argc < 3) {
+    std::cout << "Usage .... exec input_sample_list output_binary_sample_list" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const std::string input_file = argv[1];
+  const std::string output_file = argv[2];
+
+  std::ifstream infile(input_file);
+  if (!infile) {
+    std::cerr << "can't open file : " << input_file << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::string type_line, count_line, dir_line;
+  if (!std::getline(infile, type_line) || !std::getline(infile, count_line)
+      || !std::getline(infile, dir_line)) {
+    std::cerr << input_file << " does not have a sample list header" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string list_type;
+  std::stringstream(type_line) >> list_type;
+  std::transform(list_type.begin(), list_type.end(), list_type.begin(), ::toupper);
+  if (list_type.find("EXCLUSION") != std::string::npos) {
+    std::cerr << "only inclusion lists can be converted" << std::endl;
+    return EXIT_FAILURE;
+  }
+  size_t num_included = 0, num_excluded = 0, num_files = 0;
+  std::stringstream(count_line) >> num_included >> num_excluded >> num_files;
+  std::string file_dir;
+  std::stringstream(dir_line) >> file_dir;
+
+  std::vector<lbann::sample_list_binary::file_entry> files;
+  files.reserve(num_files);
+  size_t cnt_samples = 0;
+  std::string line;
+  while (files.size() < num_files && std::getline(infile, line)) {
+    std::stringstream sstr(line);
+    lbann::sample_list_binary::file_entry f;
+    size_t included = 0, excluded = 0;
+    if (!(sstr >> f.name >> included >> excluded)) {
+      continue; // empty line
+    }
+    f.total_samples = included + excluded;
+    f.samples.reserve(included);
+    std::string sample;
+    while (sstr >> sample) {
+      f.samples.push_back(sample);
+    }
+    if (f.samples.size() != included) {
+      std::cerr << "file " << f.name << " lists " << f.samples.size()
+                << " samples but declares " << included << std::endl;
+      return EXIT_FAILURE;
+    }
+    cnt_samples += included;
+    files.push_back(std::move(f));
+  }
+
+  if (files.size() != num_files || cnt_samples != num_included) {
+    std::cerr << "header declares " << num_files << " files and " << num_included
+              << " samples, but found " << files.size() << " and " << cnt_samples
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  lbann::sample_list_binary::write(output_file, file_dir, files);
+  std::cout << "Wrote " << cnt_samples << " samples in " << files.size()
+            << " files to " << output_file << std::endl;
+  return EXIT_SUCCESS;
+}